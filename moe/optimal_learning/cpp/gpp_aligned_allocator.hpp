@@ -0,0 +1,97 @@
+/*!
+  \file gpp_aligned_allocator.hpp
+  \rst
+  AlignedAllocator, a ``std::allocator`` replacement for the large matrices of a fitted model and its states (cholesky
+  factors, ``K^-1 * y``, ``K_*``, hyperparameter gradients of ``K``), and AlignedVector, the ``std::vector`` using it.
+
+  Every allocation starts on a kAlignment (64 byte) boundary: one cache line, and one AVX-512 register, so the first
+  column of a matrix never straddles lines and SIMD kernels may use aligned loads on it.
+
+  Allocations of at least kHugePageThreshold bytes are rounded up to whole huge pages, aligned to a huge page, and
+  advised (``madvise(MADV_HUGEPAGE)``) to be backed by transparent huge pages.  A 200 MB cholesky factor then spans
+  ~100 TLB entries instead of ~50,000, which matters for the column sweeps of the factorization, the triangular solves,
+  and GEMM.  The advice is a hint: where transparent huge pages are unavailable (or ``MADV_HUGEPAGE`` is not defined)
+  the memory is ordinary, still aligned.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_ALIGNED_ALLOCATOR_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_ALIGNED_ALLOCATOR_HPP_
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Stateless allocator returning kAlignment-aligned memory, huge-page backed above kHugePageThreshold; see the file
+  comments.  All instances compare equal, so AlignedVector swaps and moves like ``std::vector``.
+\endrst*/
+template <typename T>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  //! alignment of every allocation, in bytes: one cache line, one AVX-512 register
+  static constexpr std::size_t kAlignment = 64;
+  //! size of a (x86-64) transparent huge page, in bytes
+  static constexpr std::size_t kHugePageSize = 2*1024*1024;
+  //! allocations of at least this many bytes are huge-page aligned and advised; smaller ones would waste most of a page
+  static constexpr std::size_t kHugePageThreshold = kHugePageSize;
+
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) noexcept {  // NOLINT(runtime/explicit): rebinding must be implicit
+  }
+
+  T * allocate(std::size_t n) {
+    if (unlikely(n > std::numeric_limits<std::size_t>::max()/sizeof(T))) {
+      throw std::bad_alloc();
+    }
+    std::size_t num_bytes = n*sizeof(T);
+    std::size_t alignment = kAlignment;
+    if (num_bytes >= kHugePageThreshold) {
+      num_bytes = (num_bytes + kHugePageSize - 1)/kHugePageSize*kHugePageSize;
+      alignment = kHugePageSize;
+    }
+    void * memory = nullptr;
+    if (unlikely(posix_memalign(&memory, alignment, num_bytes == 0 ? alignment : num_bytes) != 0)) {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (alignment == kHugePageSize) {
+      madvise(memory, num_bytes, MADV_HUGEPAGE);  // a hint; failure leaves ordinary pages
+    }
+#endif
+    return static_cast<T *>(memory);
+  }
+
+  void deallocate(T * memory, std::size_t OL_UNUSED(n)) noexcept {
+    std::free(memory);
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) noexcept {
+  return false;
+}
+
+//! ``std::vector`` whose storage comes from AlignedAllocator
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_ALIGNED_ALLOCATOR_HPP_
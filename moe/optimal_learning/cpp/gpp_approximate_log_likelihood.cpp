@@ -0,0 +1,488 @@
+/*!
+  \file gpp_approximate_log_likelihood.cpp
+  \rst
+  This file contains the ApproximateLogMarginalLikelihoodEvaluator and ApproximateLogMarginalLikelihoodState member
+  functions: matrix-free products with ``K``, Jacobi-preconditioned conjugate gradients, stochastic Lanczos quadrature
+  for ``\log(det(K))``, and the Hutchinson-estimated gradient.  See gpp_approximate_log_likelihood.hpp for an overview.
+\endrst*/
+
+#include "gpp_approximate_log_likelihood.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <boost/random/uniform_int.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {  // utilities for the stochastic estimators
+
+//! target number of rows of ``K`` generated per block by CovarianceMatrixVectorMultiply()
+constexpr int kCovarianceBlockRows = 64;
+
+//! maximum number of implicit QL sweeps per eigenvalue in TridiagonalEigenvaluesFirstComponents()
+constexpr int kMaxQLIterations = 60;
+
+/*!\rst
+  Number of points whose rows make up one block of ``K`` in CovarianceMatrixVectorMultiply().
+\endrst*/
+OL_WARN_UNUSED_RESULT int NumPointsPerCovarianceBlock(int num_derivatives, int num_sampled) noexcept {
+  return std::max(1, std::min(num_sampled, kCovarianceBlockRows/(num_derivatives+1)));
+}
+
+/*!\rst
+  Computes the eigenvalues of a symmetric tridiagonal matrix ``T`` and the first component of each (unit) eigenvector,
+  using the implicit QL algorithm (Numerical Recipes, tqli).  Only the first row of the eigenvector matrix is
+  accumulated, which is all Gauss quadrature needs: ``e_0^T f(T) e_0 = \sum_k V_{0k}^2 f(\lambda_k)``.
+
+  \param
+    :size: order of ``T``
+    :diagonal[size]: diagonal of ``T``
+    :subdiagonal[size]: subdiagonal of ``T`` in entries ``[0, size-1)``; the last entry is ignored
+  \output
+    :diagonal[size]: eigenvalues of ``T``
+    :subdiagonal[size]: destroyed
+    :first_components[size]: ``V_{0k}``, first component of the ``k``-th eigenvector
+\endrst*/
+OL_NONNULL_POINTERS void TridiagonalEigenvaluesFirstComponents(int size, double * restrict diagonal,
+                                                               double * restrict subdiagonal,
+                                                               double * restrict first_components) noexcept {
+  std::fill(first_components, first_components + size, 0.0);
+  first_components[0] = 1.0;
+  subdiagonal[size-1] = 0.0;
+
+  for (int l = 0; l < size; ++l) {
+    int iteration = 0;
+    int m;
+    do {
+      // look for a single small subdiagonal element to split the matrix
+      for (m = l; m < size-1; ++m) {
+        const double diagonal_scale = std::fabs(diagonal[m]) + std::fabs(diagonal[m+1]);
+        if (std::fabs(subdiagonal[m]) <= std::numeric_limits<double>::epsilon()*diagonal_scale) {
+          break;
+        }
+      }
+      if (m != l) {
+        if (unlikely(iteration++ == kMaxQLIterations)) {
+          break;  // accept the current (nearly converged) values
+        }
+        // form the implicit Wilkinson shift
+        double g = (diagonal[l+1] - diagonal[l])/(2.0*subdiagonal[l]);
+        double r = std::hypot(g, 1.0);
+        g = diagonal[m] - diagonal[l] + subdiagonal[l]/(g + std::copysign(r, g));
+        double s = 1.0, c = 1.0, p = 0.0;
+        int i;
+        for (i = m-1; i >= l; --i) {
+          double f = s*subdiagonal[i];
+          const double b = c*subdiagonal[i];
+          r = std::hypot(f, g);
+          subdiagonal[i+1] = r;
+          if (r == 0.0) {  // recover from underflow
+            diagonal[i+1] -= p;
+            subdiagonal[m] = 0.0;
+            break;
+          }
+          s = f/r;
+          c = g/r;
+          g = diagonal[i+1] - p;
+          r = (diagonal[i] - g)*s + 2.0*c*b;
+          p = s*r;
+          diagonal[i+1] = g + p;
+          g = c*r - b;
+
+          // apply the rotation to the first row of the eigenvector matrix
+          f = first_components[i+1];
+          first_components[i+1] = s*first_components[i] + c*f;
+          first_components[i] = c*first_components[i] - s*f;
+        }
+        if (r == 0.0 && i >= l) {
+          continue;
+        }
+        diagonal[l] -= p;
+        subdiagonal[l] = g;
+        subdiagonal[m] = 0.0;
+      }
+    } while (m != l);
+  }
+}
+
+}  // end unnamed namespace
+
+ApproximateLogMarginalLikelihoodEvaluator::ApproximateLogMarginalLikelihoodEvaluator(
+    double const * restrict points_sampled_in,
+    double const * restrict points_sampled_value_in,
+    int const * derivatives_in,
+    int num_derivatives_in,
+    int dim_in, int num_sampled_in,
+    const ApproximateLogLikelihoodParameters& parameters)
+    : dim_(dim_in),
+      num_sampled_(num_sampled_in),
+      num_derivatives_(num_derivatives_in),
+      derivatives_(derivatives_in, derivatives_in + num_derivatives_in),
+      num_probes_(parameters.num_probes),
+      num_lanczos_steps_(parameters.num_lanczos_steps),
+      max_num_cg_steps_(parameters.max_num_cg_steps),
+      cg_tolerance_(parameters.cg_tolerance),
+      points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
+      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + (num_derivatives_in+1)*num_sampled_in),
+      probes_() {
+  if (unlikely(num_probes_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one probe vector.", num_probes_, 1);
+  }
+  if (unlikely(num_lanczos_steps_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one Lanczos step.", num_lanczos_steps_, 1);
+  }
+  if (unlikely(max_num_cg_steps_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one conjugate gradient step.", max_num_cg_steps_, 1);
+  }
+
+  // Rademacher probes: entries are +/-1 with equal probability
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  probes_.resize(num_probes_*num_rows);
+  UniformRandomGenerator uniform_generator(parameters.probe_seed);
+  boost::uniform_int<int> uniform_sign(0, 1);
+  for (auto& entry : probes_) {
+    entry = 2.0*uniform_sign(uniform_generator.engine) - 1.0;
+  }
+}
+
+void ApproximateLogMarginalLikelihoodEvaluator::CovarianceMatrixVectorMultiply(
+    StateType * log_likelihood_state, double const * restrict vector, double * restrict product) const noexcept {
+  const int block_size = num_derivatives_+1;
+  const int num_rows = num_sampled_*block_size;
+  const int num_points_per_block = NumPointsPerCovarianceBlock(num_derivatives_, num_sampled_);
+  const CovarianceInterface& covariance = *log_likelihood_state->covariance_ptr;
+
+  for (int i = 0; i < num_sampled_; i += num_points_per_block) {
+    const int num_points_this_block = std::min(num_points_per_block, num_sampled_ - i);
+    const int num_rows_this_block = num_points_this_block*block_size;
+    // rows [i*block_size, (i + num_points_this_block)*block_size) of K (without noise), stored column-major
+    covariance.CovarianceMatrix(points_sampled_.data() + i*dim_, points_sampled_.data(), dim_,
+                                num_points_this_block, num_sampled_, derivatives_.data(), num_derivatives_,
+                                derivatives_.data(), num_derivatives_, log_likelihood_state->covariance_block.data());
+    GeneralMatrixVectorMultiply(log_likelihood_state->covariance_block.data(), 'N', vector, 1.0, 0.0,
+                                num_rows_this_block, num_rows, num_rows_this_block, product + i*block_size);
+  }
+
+  // noise and jitter on the diagonal, matching LogMarginalLikelihoodEvaluator
+  for (int i = 0; i < num_sampled_; ++i) {
+    for (int m = 0; m < block_size; ++m) {
+      const int row = i*block_size + m;
+      product[row] += (log_likelihood_state->noise_variance[m] + 1.0e-6)*vector[row];
+    }
+  }
+}
+
+int ApproximateLogMarginalLikelihoodEvaluator::PreconditionedConjugateGradientSolve(
+    StateType * log_likelihood_state, double const * restrict rhs, double * restrict solution) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  double const * restrict preconditioner = log_likelihood_state->preconditioner.data();
+  double * restrict residual = log_likelihood_state->work_vectors.data();
+  double * restrict preconditioned_residual = residual + num_rows;
+  double * restrict search_direction = preconditioned_residual + num_rows;
+  double * restrict K_search_direction = search_direction + num_rows;
+
+  std::fill(solution, solution + num_rows, 0.0);
+  std::copy(rhs, rhs + num_rows, residual);
+  for (int i = 0; i < num_rows; ++i) {
+    preconditioned_residual[i] = residual[i]/preconditioner[i];
+  }
+  std::copy(preconditioned_residual, preconditioned_residual + num_rows, search_direction);
+  double residual_dot = DotProduct(residual, preconditioned_residual, num_rows);
+  const double stopping_norm = cg_tolerance_*VectorNorm(rhs, num_rows);
+
+  int num_steps = 0;
+  while (num_steps < max_num_cg_steps_ && VectorNorm(residual, num_rows) > stopping_norm) {
+    CovarianceMatrixVectorMultiply(log_likelihood_state, search_direction, K_search_direction);
+    const double step_size = residual_dot/DotProduct(search_direction, K_search_direction, num_rows);
+    VectorAXPY(num_rows, step_size, search_direction, solution);
+    VectorAXPY(num_rows, -step_size, K_search_direction, residual);
+    for (int i = 0; i < num_rows; ++i) {
+      preconditioned_residual[i] = residual[i]/preconditioner[i];
+    }
+    const double residual_dot_new = DotProduct(residual, preconditioned_residual, num_rows);
+    const double beta = residual_dot_new/residual_dot;
+    residual_dot = residual_dot_new;
+    for (int i = 0; i < num_rows; ++i) {
+      search_direction[i] = preconditioned_residual[i] + beta*search_direction[i];
+    }
+    ++num_steps;
+  }
+  return num_steps;
+}
+
+double ApproximateLogMarginalLikelihoodEvaluator::LanczosLogQuadrature(StateType * log_likelihood_state,
+                                                                       double const * restrict probe) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const int max_num_steps = std::min(num_lanczos_steps_, num_rows);
+  double const * restrict preconditioner = log_likelihood_state->preconditioner.data();
+  // not restrict: the three Lanczos vectors rotate through the same buffers
+  double * lanczos_previous = log_likelihood_state->work_vectors.data();
+  double * lanczos_current = lanczos_previous + num_rows;
+  double * lanczos_next = lanczos_current + num_rows;
+  double * restrict scaled_vector = lanczos_next + num_rows;
+
+  std::vector<double> diagonal(max_num_steps);
+  std::vector<double> subdiagonal(max_num_steps);
+  std::vector<double> first_components(max_num_steps);
+
+  const double probe_norm = VectorNorm(probe, num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    lanczos_current[i] = probe[i]/probe_norm;
+  }
+  std::fill(lanczos_previous, lanczos_previous + num_rows, 0.0);
+
+  int num_steps = 0;
+  double beta = 0.0;
+  while (num_steps < max_num_steps) {
+    // lanczos_next := \tilde{K} * v = P^{-1/2} * K * P^{-1/2} * v
+    for (int i = 0; i < num_rows; ++i) {
+      scaled_vector[i] = lanczos_current[i]/std::sqrt(preconditioner[i]);
+    }
+    CovarianceMatrixVectorMultiply(log_likelihood_state, scaled_vector, lanczos_next);
+    for (int i = 0; i < num_rows; ++i) {
+      lanczos_next[i] /= std::sqrt(preconditioner[i]);
+    }
+
+    const double alpha = DotProduct(lanczos_next, lanczos_current, num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+      lanczos_next[i] -= alpha*lanczos_current[i] + beta*lanczos_previous[i];
+    }
+    diagonal[num_steps] = alpha;
+    ++num_steps;
+
+    beta = VectorNorm(lanczos_next, num_rows);
+    // an invariant subspace was found: the quadrature is exact with the steps taken so far
+    if (beta <= std::numeric_limits<double>::epsilon()*std::fabs(alpha)) {
+      break;
+    }
+    subdiagonal[num_steps-1] = beta;
+    std::swap(lanczos_previous, lanczos_current);
+    std::swap(lanczos_current, lanczos_next);
+    VectorScale(num_rows, 1.0/beta, lanczos_current);
+  }
+
+  TridiagonalEigenvaluesFirstComponents(num_steps, diagonal.data(), subdiagonal.data(), first_components.data());
+  double quadrature = 0.0;
+  for (int k = 0; k < num_steps; ++k) {
+    // \tilde{K} is SPD; round-off can still leave tiny Ritz values at or below 0
+    const double eigenvalue = std::max(diagonal[k], std::numeric_limits<double>::min());
+    quadrature += Square(first_components[k])*std::log(eigenvalue);
+  }
+  return Square(probe_norm)*quadrature;
+}
+
+void ApproximateLogMarginalLikelihoodEvaluator::FillLogLikelihoodState(StateType * log_likelihood_state) const {
+  const int block_size = num_derivatives_+1;
+  const int num_rows = num_sampled_*block_size;
+  const CovarianceInterface& covariance = *log_likelihood_state->covariance_ptr;
+
+  // Jacobi preconditioner: diag(K), one covariance tile per point
+  std::vector<double> covariance_tile(Square(block_size));
+  for (int i = 0; i < num_sampled_; ++i) {
+    covariance.Covariance(points_sampled_.data() + i*dim_, derivatives_.data(), num_derivatives_,
+                          points_sampled_.data() + i*dim_, derivatives_.data(), num_derivatives_,
+                          covariance_tile.data());
+    for (int m = 0; m < block_size; ++m) {
+      log_likelihood_state->preconditioner[i*block_size + m] = covariance_tile[m + m*block_size] +
+          log_likelihood_state->noise_variance[m] + 1.0e-6;
+    }
+  }
+
+  // y := points_sampled_value - mean, centered exactly as in LogMarginalLikelihoodEvaluator
+  double mean = 0.0;
+  for (int i = 0; i < num_sampled_; ++i) {
+    mean += points_sampled_value_[i*block_size];
+  }
+  mean /= num_sampled_;
+  std::copy(points_sampled_value_.begin(), points_sampled_value_.end(), log_likelihood_state->y.begin());
+  for (int i = 0; i < num_sampled_; ++i) {
+    log_likelihood_state->y[i*block_size] -= mean;
+  }
+
+  PreconditionedConjugateGradientSolve(log_likelihood_state, log_likelihood_state->y.data(),
+                                       log_likelihood_state->K_inv_y.data());
+
+  // \log(det(K)) = \sum_i \log(P_ii) + tr(\log(\tilde{K})), the trace from SLQ; K^-1 z_j is kept for the gradient
+  double log_determinant = 0.0;
+  for (int i = 0; i < num_rows; ++i) {
+    log_determinant += std::log(log_likelihood_state->preconditioner[i]);
+  }
+  double trace_log = 0.0;
+  for (int j = 0; j < num_probes_; ++j) {
+    double const * restrict probe = probes_.data() + j*num_rows;
+    trace_log += LanczosLogQuadrature(log_likelihood_state, probe);
+    PreconditionedConjugateGradientSolve(log_likelihood_state, probe,
+                                         log_likelihood_state->K_inv_probes.data() + j*num_rows);
+  }
+  log_likelihood_state->log_determinant = log_determinant + trace_log/static_cast<double>(num_probes_);
+}
+
+/*!\rst
+  ``log p(y | X, \theta) = -\frac{1}{2} * y^T * K^-1 * y - \frac{1}{2} * \log(det(K)) - \frac{n}{2} * \log(2*pi)``,
+  with ``K^-1 * y`` from PCG and ``\log(det(K))`` from SLQ (both computed in FillLogLikelihoodState()).
+\endrst*/
+double ApproximateLogMarginalLikelihoodEvaluator::ComputeLogLikelihood(
+    const StateType& log_likelihood_state) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const double log_marginal_term1 = -0.5*DotProduct(log_likelihood_state.y.data(),
+                                                    log_likelihood_state.K_inv_y.data(), num_rows);
+  const double log_marginal_term2 = -0.5*log_likelihood_state.log_determinant;
+  const double log_marginal_term3 = -0.5*static_cast<double>(num_rows)*kLog2Pi;
+  return log_marginal_term1 + log_marginal_term2 + log_marginal_term3;
+}
+
+/*!\rst
+  Computes (see LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood())::
+
+    \pderiv{log(p(y | X, \theta))}{\theta_k} = \frac{1}{2} * trace([\alpha\alpha^T - K^{-1}] * \pderiv{K}{\theta_k})
+
+  with ``K^{-1}`` replaced by its Hutchinson estimate ``\frac{1}{n_z} \sum_j (K^-1 z_j) z_j^T`` (symmetrized).  So the
+  weight on ``\pderiv{K_{rs}}{\theta_k}`` is
+
+  ``W_{rs} = \alpha_r \alpha_s - \frac{1}{2 n_z} \sum_j [(K^-1 z_j)_r z_{js} + (K^-1 z_j)_s z_{jr}]``
+
+  which is generated on the fly (``O(n_z)`` per entry) while streaming the lower triangle of ``\pderiv{K}{\theta}`` tiles;
+  no ``N \times N`` matrix is stored.
+\endrst*/
+void ApproximateLogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood(
+    StateType * log_likelihood_state, double * restrict grad_log_marginal) const noexcept {
+  const int block_size = num_derivatives_+1;
+  const int num_rows = num_sampled_*block_size;
+  const int num_covariance_hyperparameters = log_likelihood_state->covariance_ptr->GetNumberOfHyperparameters();
+  double const * restrict alpha = log_likelihood_state->K_inv_y.data();
+
+  // transpose the probes (and their solves) to [N][num_probes] so each weight reads contiguous memory
+  std::vector<double> probes_by_row(num_rows*num_probes_);
+  std::vector<double> K_inv_probes_by_row(num_rows*num_probes_);
+  for (int j = 0; j < num_probes_; ++j) {
+    for (int r = 0; r < num_rows; ++r) {
+      probes_by_row[r*num_probes_ + j] = probes_[j*num_rows + r];
+      K_inv_probes_by_row[r*num_probes_ + j] = log_likelihood_state->K_inv_probes[j*num_rows + r];
+    }
+  }
+  const double probe_normalization = 0.5/static_cast<double>(num_probes_);
+  auto weight = [&](int row, int col) {
+    double const * restrict probe_row = probes_by_row.data() + row*num_probes_;
+    double const * restrict probe_col = probes_by_row.data() + col*num_probes_;
+    double const * restrict solve_row = K_inv_probes_by_row.data() + row*num_probes_;
+    double const * restrict solve_col = K_inv_probes_by_row.data() + col*num_probes_;
+    double K_inv_estimate = 0.0;
+    for (int j = 0; j < num_probes_; ++j) {
+      K_inv_estimate += solve_row[j]*probe_col[j] + solve_col[j]*probe_row[j];
+    }
+    return alpha[row]*alpha[col] - probe_normalization*K_inv_estimate;
+  };
+
+  std::vector<double> grad_covariance(num_covariance_hyperparameters*Square(block_size));
+  std::fill(grad_log_marginal, grad_log_marginal + num_covariance_hyperparameters + block_size, 0.0);
+  for (int i = 0; i < num_sampled_; ++i) {  // col
+    for (int j = i; j < num_sampled_; ++j) {  // row
+      log_likelihood_state->covariance_ptr->HyperparameterGradCovariance(
+          points_sampled_.data() + j*dim_, derivatives_.data(), num_derivatives_,
+          points_sampled_.data() + i*dim_, derivatives_.data(), num_derivatives_, grad_covariance.data());
+      // off-diagonal tiles also stand in for their (unvisited) mirror image in the upper triangle
+      const double symmetry_factor = (i == j) ? 1.0 : 2.0;
+      for (int n = 0; n < block_size; ++n) {
+        for (int m = 0; m < block_size; ++m) {
+          const double tile_weight = symmetry_factor*weight(j*block_size + m, i*block_size + n);
+          double const * restrict grad_covariance_ptr = grad_covariance.data() + (m + n*block_size)*num_covariance_hyperparameters;
+          for (int i_hyper = 0; i_hyper < num_covariance_hyperparameters; ++i_hyper) {
+            grad_log_marginal[i_hyper] += tile_weight*grad_covariance_ptr[i_hyper];
+          }
+        }
+      }
+    }
+  }
+
+  // the m-th noise hyperparameter's dK/d\theta is 1 on the diagonal entries of the m-th derivative block and 0 elsewhere
+  for (int i = 0; i < num_sampled_; ++i) {
+    for (int m = 0; m < block_size; ++m) {
+      const int row = i*block_size + m;
+      grad_log_marginal[num_covariance_hyperparameters + m] += weight(row, row);
+    }
+  }
+  VectorScale(num_covariance_hyperparameters + block_size, 0.5, grad_log_marginal);
+}
+
+void ApproximateLogMarginalLikelihoodEvaluator::ComputeHessianLogLikelihood(
+    StateType * OL_UNUSED(log_likelihood_state), double * restrict OL_UNUSED(hessian_log_marginal)) const {
+  OL_THROW_EXCEPTION(OptimalLearningException,
+                     "ApproximateLogMarginalLikelihoodEvaluator::ComputeHessianLogLikelihood is NOT IMPLEMENTED.");
+}
+
+void ApproximateLogMarginalLikelihoodState::SetHyperparameters(const EvaluatorType& log_likelihood_eval,
+                                                               double const * restrict hyperparameters) {
+  // update hyperparameters
+  covariance_ptr->SetHyperparameters(hyperparameters);
+  hyperparameters += covariance_ptr->GetNumberOfHyperparameters();
+  for (int i = 0; i < log_likelihood_eval.num_derivatives()+1; ++i) {
+    noise_variance[i] = hyperparameters[i];
+  }
+
+  // evaluate derived quantities
+  log_likelihood_eval.FillLogLikelihoodState(this);
+}
+
+void ApproximateLogMarginalLikelihoodState::SetupState(const EvaluatorType& log_likelihood_eval,
+                                                       double const * restrict hyperparameters) {
+  if (unlikely(num_sampled != log_likelihood_eval.num_sampled()) ||
+      unlikely(num_derivatives != log_likelihood_eval.num_derivatives()) ||
+      unlikely(num_probes != log_likelihood_eval.num_probes())) {
+    num_sampled = log_likelihood_eval.num_sampled();
+    num_derivatives = log_likelihood_eval.num_derivatives();
+    num_probes = log_likelihood_eval.num_probes();
+    num_hyperparameters = covariance_ptr->GetNumberOfHyperparameters() + num_derivatives + 1;
+    const int num_rows = num_sampled*(num_derivatives+1);
+    K_inv_y.resize(num_rows);
+    y.resize(num_rows);
+    K_inv_probes.resize(num_probes*num_rows);
+    preconditioner.resize(num_rows);
+    covariance_block.resize(NumPointsPerCovarianceBlock(num_derivatives, num_sampled)*(num_derivatives+1)*num_rows);
+    work_vectors.resize(4*num_rows);
+  }
+
+  // set hyperparameters and derived quantities
+  SetHyperparameters(log_likelihood_eval, hyperparameters);
+}
+
+ApproximateLogMarginalLikelihoodState::ApproximateLogMarginalLikelihoodState(
+    const EvaluatorType& log_likelihood_eval, const CovarianceInterface& covariance_in,
+    const std::vector<double> noise_variance_in)
+    : dim(log_likelihood_eval.dim()),
+      num_sampled(log_likelihood_eval.num_sampled()),
+      num_derivatives(log_likelihood_eval.num_derivatives()),
+      num_hyperparameters(covariance_in.GetNumberOfHyperparameters() + num_derivatives + 1),
+      num_probes(log_likelihood_eval.num_probes()),
+      covariance_ptr(covariance_in.Clone()),
+      noise_variance(noise_variance_in),
+      K_inv_y(num_sampled*(num_derivatives+1)),
+      y(num_sampled*(num_derivatives+1)),
+      K_inv_probes(num_probes*num_sampled*(num_derivatives+1)),
+      preconditioner(num_sampled*(num_derivatives+1)),
+      log_determinant(0.0),
+      covariance_block(NumPointsPerCovarianceBlock(num_derivatives, num_sampled)*(num_derivatives+1)*
+                       num_sampled*(num_derivatives+1)),
+      work_vectors(4*num_sampled*(num_derivatives+1)) {
+  std::vector<double> hyperparameters(num_hyperparameters);
+  covariance_ptr->GetHyperparameters(hyperparameters.data());
+  for (int i = 0; i < num_derivatives+1; ++i) {
+    hyperparameters[i + covariance_in.GetNumberOfHyperparameters()] = noise_variance_in[i];
+  }
+  SetupState(log_likelihood_eval, hyperparameters.data());
+}
+
+ApproximateLogMarginalLikelihoodState::ApproximateLogMarginalLikelihoodState(
+    ApproximateLogMarginalLikelihoodState&& OL_UNUSED(other)) = default;
+
+}  // end namespace optimal_learning
@@ -0,0 +1,462 @@
+/*!
+  \file gpp_approximate_log_likelihood.hpp
+  \rst
+  1. OVERVIEW
+  2. ESTIMATORS
+  3. COST AND ACCURACY
+  4. CITATIONS
+
+  **1. OVERVIEW**
+
+  LogMarginalLikelihoodEvaluator (gpp_model_selection.hpp) factors ``K`` exactly: ``O(N^3)`` time and ``O(N^2)`` memory
+  per likelihood evaluation, where ``N = num_sampled*(num_derivatives+1)`` is the number of observations.  Once ``N``
+  grows past ~20,000 (e.g., gradient observations on large logs), neither is affordable, let alone once per thread
+  in multistarted hyperparameter optimization.
+
+  ApproximateLogMarginalLikelihoodEvaluator computes the same objective,
+
+  ``log p(y | X, \theta) = -\frac{1}{2} y^T K^-1 y - \frac{1}{2} \log(det(K)) - \frac{N}{2} \log(2\pi)``
+
+  and its gradient wrt the hyperparameters, without ever forming ``K``.  Every estimator below only needs products
+  ``K v``, which are computed matrix-free: ``K`` is generated a block of rows at a time with the batched
+  CovarianceInterface::CovarianceMatrix() kernel, applied, and discarded.  So memory is ``O(N)`` (times the number of
+  probe vectors) and the Evaluator/State pair drops into any of the hyperparameter optimizers templated on a log
+  likelihood evaluator (e.g., MultistartGradientDescentHyperparameterOptimization(),
+  MultistartLBFGSBHyperparameterOptimization()).
+
+  Conventions (mean subtraction, the ``10^{-6}`` diagonal jitter, hyperparameter ordering: covariance hyperparameters
+  followed by the ``num_derivatives+1`` noise variances) match LogMarginalLikelihoodEvaluator exactly, so the two
+  evaluators agree up to the estimation error described below.
+
+  **2. ESTIMATORS**
+
+  a. ``K^-1 y`` (and ``K^-1 z``): preconditioned conjugate gradients (PCG) with the Jacobi (diagonal) preconditioner
+     ``P = diag(K)``.  Iteration stops when ``||r|| <= cg_tolerance * ||b||`` or after ``max_num_cg_steps``.
+  b. ``\log(det(K))``: stochastic Lanczos quadrature (SLQ).  With ``\tilde{K} = P^{-1/2} K P^{-1/2}``,
+     ``\log(det(K)) = \sum_i \log(P_ii) + tr(\log(\tilde{K}))``, and the trace is estimated with Rademacher probes
+     ``z_j``: ``tr(\log(\tilde{K})) \approx \frac{1}{n_z} \sum_j z_j^T \log(\tilde{K}) z_j``.  Each quadratic form comes
+     from ``m = num_lanczos_steps`` Lanczos iterations started at ``z_j/||z_j||``: with ``T = V \Lambda V^T`` the
+     resulting tridiagonal matrix, ``z_j^T \log(\tilde{K}) z_j \approx ||z_j||^2 \sum_k V_{0k}^2 \log(\lambda_k)``
+     (Gauss quadrature).
+  c. ``tr(K^-1 \pderiv{K}{\theta_k})``: Hutchinson, ``\approx \frac{1}{n_z} \sum_j (K^-1 z_j)^T \pderiv{K}{\theta_k} z_j``,
+     re-using the SLQ probes and PCG for ``K^-1 z_j``.  The gradient,
+     ``\frac{1}{2} \alpha^T \pderiv{K}{\theta_k} \alpha - \frac{1}{2} tr(K^-1 \pderiv{K}{\theta_k})``, is then streamed over
+     the ``\pderiv{K}{\theta_k}`` tiles exactly like the exact gradient, without storing any ``N \times N`` matrix.
+
+  The probes are drawn ONCE, when the evaluator is constructed (from ``probe_seed``), and shared by every state.  So the
+  approximate objective is a deterministic, smooth function of the hyperparameters (common random numbers), which
+  gradient-based optimizers and line searches rely on.
+
+  **3. COST AND ACCURACY**
+
+  Each ``K v`` costs ``O(N^2 dim)``.  A likelihood evaluation needs ``(n_z + 1)`` PCG solves and ``n_z`` Lanczos runs, so
+  ``O((n_z (cg + m) + cg) N^2 dim)`` time; the gradient adds one streamed pass over the ``\pderiv{K}{\theta}`` tiles,
+  ``O(N^2 (n_hyper + n_z))``.  PCG and Lanczos converge quickly when ``K`` is well conditioned (large noise, short length
+  scales) and slowly when it is not; ``max_num_cg_steps`` bounds the work either way (results are then approximate).
+
+  SLQ and Hutchinson are unbiased (up to Lanczos truncation) with standard deviation ``O(1/\sqrt{n_z})``; for log
+  determinants of GP kernels a few tens of probes and ``m \approx 20-50`` Lanczos steps are typically accurate to well
+  under a percent.  Use the exact evaluator whenever ``N`` admits a Cholesky factorization.
+
+  **4. CITATIONS**
+
+  a. Fast Estimation of tr(f(A)) via Stochastic Lanczos Quadrature. Shashanka Ubaru, Jie Chen, Yousef Saad.
+     SIAM Journal on Matrix Analysis and Applications, 38(4):1075-1099, 2017.
+  b. A Stochastic Estimator of the Trace of the Influence Matrix for Laplacian Smoothing Splines. M. F. Hutchinson.
+     Communications in Statistics - Simulation and Computation, 19(2):433-450, 1990.
+  c. Scalable Log Determinants for Gaussian Process Kernel Learning. Kun Dong, David Eriksson, Hannes Nickisch,
+     David Bindel, Andrew Gordon Wilson. Advances in Neural Information Processing Systems 30, 2017.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Container to hold parameters that specify the behavior of the stochastic estimators in
+  ApproximateLogMarginalLikelihoodEvaluator.  See the file comments for how each is used.
+\endrst*/
+struct ApproximateLogLikelihoodParameters {
+  //! suggested default for num_probes (used by the Python interface)
+  static constexpr int kDefaultNumProbes = 16;
+  //! suggested default for num_lanczos_steps (used by the Python interface)
+  static constexpr int kDefaultNumLanczosSteps = 30;
+  //! suggested default for max_num_cg_steps (used by the Python interface)
+  static constexpr int kDefaultMaxNumCGSteps = 500;
+  //! suggested default for cg_tolerance (used by the Python interface)
+  static constexpr double kDefaultCGTolerance = 1.0e-8;
+  //! suggested default for probe_seed (used by the Python interface)
+  static constexpr UniformRandomGenerator::EngineType::result_type kDefaultProbeSeed = 314;
+
+  // Users must set parameters explicitly.
+  ApproximateLogLikelihoodParameters() = delete;
+
+  /*!\rst
+    Construct an ApproximateLogLikelihoodParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  ApproximateLogLikelihoodParameters(int num_probes_in, int num_lanczos_steps_in, int max_num_cg_steps_in,
+                                     double cg_tolerance_in,
+                                     UniformRandomGenerator::EngineType::result_type probe_seed_in)
+      : num_probes(num_probes_in),
+        num_lanczos_steps(num_lanczos_steps_in),
+        max_num_cg_steps(max_num_cg_steps_in),
+        cg_tolerance(cg_tolerance_in),
+        probe_seed(probe_seed_in) {
+  }
+
+  ApproximateLogLikelihoodParameters(ApproximateLogLikelihoodParameters&& OL_UNUSED(other)) = default;
+
+  // estimator control
+  //! number of Rademacher probe vectors for the log determinant and trace estimates (suggest: 10-50)
+  int num_probes;
+  //! number of Lanczos iterations per probe (suggest: 20-50)
+  int num_lanczos_steps;
+
+  // solver control
+  //! maximum number of conjugate gradient iterations per solve (suggest: a few hundred)
+  int max_num_cg_steps;
+  //! stop conjugate gradients when ``||r|| <= cg_tolerance * ||b||`` (suggest: 1.0e-6 - 1.0e-10)
+  double cg_tolerance;
+
+  //! seed for the probe vectors; probes are fixed for the lifetime of the evaluator
+  UniformRandomGenerator::EngineType::result_type probe_seed;
+};
+
+struct ApproximateLogMarginalLikelihoodState;
+
+/*!\rst
+  Class for computing an approximation of the Log Marginal Likelihood (and its gradient wrt hyperparameters) with
+  matrix-free stochastic estimators; see the file comments.  Drop-in replacement for LogMarginalLikelihoodEvaluator
+  when ``K`` is too large to factor.
+\endrst*/
+class ApproximateLogMarginalLikelihoodEvaluator final {
+ public:
+  //! string name of this log likelihood evaluator for logging
+  constexpr static char const * kName = "approximate_log_marginal_likelihood";
+
+  using StateType = ApproximateLogMarginalLikelihoodState;
+
+  /*!\rst
+    Constructs an ApproximateLogMarginalLikelihoodEvaluator object.  All inputs are required; no default constructor
+    nor copy/assignment are allowed.  Draws the Rademacher probe vectors.
+
+    \param
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_derivatives+1][num_sampled]: values (and observed derivatives) of the already-sampled points
+      :derivatives[num_derivatives]: indices of the observed derivative components
+      :num_derivatives: number of observed derivative components
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+      :parameters: estimator and solver settings
+    \raise
+      LowerBoundException<int>: if ``num_probes``, ``num_lanczos_steps``, or ``max_num_cg_steps`` is less than 1
+  \endrst*/
+  ApproximateLogMarginalLikelihoodEvaluator(double const * restrict points_sampled_in,
+                                            double const * restrict points_sampled_value_in,
+                                            int const * derivatives_in,
+                                            int num_derivatives_in,
+                                            int dim_in, int num_sampled_in,
+                                            const ApproximateLogLikelihoodParameters& parameters) OL_NONNULL_POINTERS;
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_sampled_;
+  }
+
+  int num_derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_derivatives_;
+  }
+
+  int num_probes() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_probes_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeLogLikelihood(); see that function for details.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * log_likelihood_state) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return ComputeLogLikelihood(*log_likelihood_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradLogLikelihood(); see that function for details.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * log_likelihood_state,
+                                    double * restrict grad_log_marginal) const noexcept OL_NONNULL_POINTERS {
+    ComputeGradLogLikelihood(log_likelihood_state, grad_log_marginal);
+  }
+
+  /*!\rst
+    Wrapper for ComputeHessianLogLikelihood(); see that function for details.
+  \endrst*/
+  void ComputeHessianObjectiveFunction(StateType * log_likelihood_state,
+                                       double * restrict hessian_log_marginal) const OL_NONNULL_POINTERS {
+    ComputeHessianLogLikelihood(log_likelihood_state, hessian_log_marginal);
+  }
+
+  /*!\rst
+    Sets up the ApproximateLogMarginalLikelihoodState object: solves for ``K^-1 y`` and ``K^-1 z_j`` (PCG) and estimates
+    ``\log(det(K))`` (SLQ).  ASSUMES all needed space is ALREADY ALLOCATED.
+
+    This function should not be called directly; instead use ApproximateLogMarginalLikelihoodState::SetupState.
+
+    \param
+      :log_likelihood_state[1]: constructed state object with appropriate sized allocations
+    \output
+      :log_likelihood_state[1]: fully configured state object, ready for use by this class's member functions
+  \endrst*/
+  void FillLogLikelihoodState(StateType * log_likelihood_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes the (estimated) log marginal likelihood, ``log(p(y | X, \theta))``; see
+    LogMarginalLikelihoodEvaluator::ComputeLogLikelihood().  ``O(N)`` given the state.
+
+    \param
+      :log_likelihood_state: properly configured state oboject
+    \return
+      estimate of the natural log of the marginal likelihood of the GP model
+  \endrst*/
+  double ComputeLogLikelihood(const StateType& log_likelihood_state) const noexcept OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Computes the (estimated) partial derivatives of the log marginal likelihood with respect to each hyperparameter;
+    see LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood().
+
+    \param
+      :log_likelihood_state[1]: properly configured state oboject
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+      :grad_log_marginal[n_hyper]: gradient of log marginal likelihood wrt each hyperparameter (covariance, then noise)
+  \endrst*/
+  void ComputeGradLogLikelihood(StateType * log_likelihood_state,
+                                double * restrict grad_log_marginal) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    NOT IMPLEMENTED.
+    Exists so that the multistart optimizers can be instantiated generically; select gradient descent or L-BFGS-B.
+
+    \raise
+      OptimalLearningException: always
+  \endrst*/
+  void ComputeHessianLogLikelihood(StateType * log_likelihood_state,
+                                   double * restrict hessian_log_marginal) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes ``K v`` without forming ``K``: rows of ``K`` are generated in blocks with
+    CovarianceInterface::CovarianceMatrix(), applied, and discarded.
+
+    \param
+      :log_likelihood_state[1]: state holding the covariance, noise, and the row-block buffer
+      :vector[N]: the vector to multiply
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+      :product[N]: ``K * vector``
+  \endrst*/
+  void CovarianceMatrixVectorMultiply(StateType * log_likelihood_state, double const * restrict vector,
+                                      double * restrict product) const noexcept OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ApproximateLogMarginalLikelihoodEvaluator);
+
+ private:
+  /*!\rst
+    Solves ``K x = b`` with Jacobi-preconditioned conjugate gradients, starting from ``x = 0``.
+
+    \param
+      :log_likelihood_state[1]: state with ``preconditioner`` filled
+      :rhs[N]: right hand side, ``b``
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+      :solution[N]: ``K^-1 b`` (approximate if PCG did not converge in ``max_num_cg_steps_``)
+    \return
+      number of PCG iterations taken
+  \endrst*/
+  int PreconditionedConjugateGradientSolve(StateType * log_likelihood_state, double const * restrict rhs,
+                                           double * restrict solution) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Estimates ``z^T \log(\tilde{K}) z`` with ``num_lanczos_steps_`` steps of Lanczos (Gauss quadrature), where
+    ``\tilde{K} = P^{-1/2} K P^{-1/2}``.
+
+    \param
+      :log_likelihood_state[1]: state with ``preconditioner`` filled
+      :probe[N]: the probe vector, ``z``
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+    \return
+      the estimate of ``z^T \log(\tilde{K}) z``
+  \endrst*/
+  double LanczosLogQuadrature(StateType * log_likelihood_state,
+                              double const * restrict probe) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of points_sampled)
+  const int dim_;
+  //! number of points in points_sampled
+  int num_sampled_;
+
+  //! number of derivatives' observations
+  int num_derivatives_;
+
+  // the index of the derivatives observed.
+  std::vector<int> derivatives_;
+
+  // estimator settings
+  //! number of probe vectors
+  int num_probes_;
+  //! number of Lanczos iterations per probe
+  int num_lanczos_steps_;
+  //! maximum number of PCG iterations per solve
+  int max_num_cg_steps_;
+  //! relative residual tolerance for PCG
+  double cg_tolerance_;
+
+  // state variables
+  //! coordinates of already-sampled points, X
+  std::vector<double> points_sampled_;
+  //! function values at points_sampled, y
+  std::vector<double> points_sampled_value_;
+  //! Rademacher probe vectors ``z_j``, ``[num_probes][N]``
+  std::vector<double> probes_;
+};
+
+/*!\rst
+  State object for ApproximateLogMarginalLikelihoodEvaluator.  Same layout and hyperparameter ordering as
+  LogMarginalLikelihoodState, but holds only ``O(N * num_probes)`` data: no covariance matrix or factorization.
+
+  See general comments on State structs in gpp_common.hpp's header docs.
+\endrst*/
+struct ApproximateLogMarginalLikelihoodState final {
+  using EvaluatorType = ApproximateLogMarginalLikelihoodEvaluator;
+
+  /*!\rst
+    Constructs an ApproximateLogMarginalLikelihoodState object with a specified covariance object (in particular, new
+    hyperparameters).  Ensures all state variables & temporaries are properly sized.
+    Properly sets all state variables so that the Evaluator can be used to compute log marginal likelihood, gradients, etc.
+
+    .. WARNING:: This object's state is INVALIDATED if the log_likelihood_eval used in construction is mutated!
+      SetupState() should be called again in such a situation.
+
+    \param
+      :log_likelihood_eval: ApproximateLogMarginalLikelihoodEvaluator object that this state is being used with
+      :covariance_in: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+      :noise_variance_in[num_derivatives+1]: noise variance of the function value, then of each observed derivative
+  \endrst*/
+  ApproximateLogMarginalLikelihoodState(const EvaluatorType& log_likelihood_eval,
+                                        const CovarianceInterface& covariance_in,
+                                        const std::vector<double> noise_variance_in);
+
+  ApproximateLogMarginalLikelihoodState(ApproximateLogMarginalLikelihoodState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_hyperparameters;
+  }
+
+  void SetCurrentPoint(const EvaluatorType& log_likelihood_eval,
+                       double const * restrict hyperparameters) OL_NONNULL_POINTERS {
+    SetHyperparameters(log_likelihood_eval, hyperparameters);
+  }
+
+  void GetCurrentPoint(double * restrict hyperparameters) OL_NONNULL_POINTERS {
+    GetHyperparameters(hyperparameters);
+  }
+
+  /*!\rst
+    Get hyperparameters of underlying covariance function.
+
+    \output
+      :hyperparameters[num_hyperparameters]: covariance's hyperparameters, then the noise variances
+  \endrst*/
+  void GetHyperparameters(double * restrict hyperparameters) const noexcept OL_NONNULL_POINTERS {
+    covariance_ptr->GetHyperparameters(hyperparameters);
+    hyperparameters += covariance_ptr->GetNumberOfHyperparameters();
+    for (int i = 0; i < num_derivatives+1; ++i) {
+      hyperparameters[i] = noise_variance[i];
+    }
+  }
+
+  /*!\rst
+    Change the hyperparameters of the underlying covariance function.
+    Update the state's derived quantities to be consistent with the new hyperparameters.
+
+    \param
+      :log_likelihood_eval: ApproximateLogMarginalLikelihoodEvaluator object that this state is being used with
+      :hyperparameters[num_hyperparameters]: hyperparameters to change to
+  \endrst*/
+  void SetHyperparameters(const EvaluatorType& log_likelihood_eval,
+                          double const * restrict hyperparameters) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Configures this state object with new hyperparameters.
+    Ensures all state variables & temporaries are properly sized.
+    Properly sets all state variables for log likelihood (+ gradient) evaluation.
+
+    .. WARNING:: This object's state is INVALIDATED if the log_likelihood used in SetupState is mutated!
+      SetupState() should be called again in such a situation.
+
+    \param
+      :log_likelihood_eval: log likelihood evaluator object that describes the training/already-measured data
+      :hyperparameters[num_hyperparameters]: hyperparameters to change to
+  \endrst*/
+  void SetupState(const EvaluatorType& log_likelihood_eval,
+                  double const * restrict hyperparameters) OL_NONNULL_POINTERS;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of points_sampled)
+  const int dim;
+  //! number of points in points_sampled
+  int num_sampled;
+
+  //! number of derivatives' observations
+  int num_derivatives;
+
+  //! number of hyperparameters of covariance; i.e., covariance_ptr->GetNumberOfHyperparameters()
+  // + the number of variances
+  int num_hyperparameters;
+
+  //! number of probe vectors
+  int num_probes;
+
+  // state variables
+  //! covariance class (for computing covariance and its gradients)
+  std::unique_ptr<CovarianceInterface> covariance_ptr;
+
+  std::vector<double> noise_variance;
+
+  // derived variables
+  //! ``K^-1 * (y-mean)``, from PCG
+  std::vector<double> K_inv_y;
+  //! y-mean
+  std::vector<double> y;
+  //! ``K^-1 * z_j`` for each probe, ``[num_probes][N]``, from PCG
+  std::vector<double> K_inv_probes;
+  //! Jacobi preconditioner, ``diag(K)``
+  std::vector<double> preconditioner;
+  //! SLQ estimate of ``\log(det(K))``
+  double log_determinant;
+
+  // temporary storage: preallocated space used by ApproximateLogMarginalLikelihoodEvaluator's member functions
+  //! a block of rows of ``K``, ``[block_rows][N]``
+  std::vector<double> covariance_block;
+  //! PCG/Lanczos work vectors, ``[4][N]``
+  std::vector<double> work_vectors;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ApproximateLogMarginalLikelihoodState);
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_HPP_
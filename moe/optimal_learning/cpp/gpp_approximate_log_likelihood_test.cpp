@@ -0,0 +1,181 @@
+/*!
+  \file gpp_approximate_log_likelihood_test.cpp
+  \rst
+  Routines to test the functions in gpp_approximate_log_likelihood.cpp.
+
+  All tests run on GP data drawn from a known prior (MockGaussianProcessPriorData) with one gradient observation per
+  point, and enough points that ``K`` spans several row blocks of the matrix-free product:
+
+  * ApproximateLogMarginalLikelihoodEvaluator::CovarianceMatrixVectorMultiply() matches a product with the explicitly
+    built covariance matrix,
+  * the conjugate gradient solution ``K^-1 y`` matches LogMarginalLikelihoodState::K_inv_y,
+  * with many probes, the stochastic log likelihood and gradient agree with LogMarginalLikelihoodEvaluator to within
+    their (deterministic, since the probes are seeded) estimation error.
+\endrst*/
+
+#include "gpp_approximate_log_likelihood_test.hpp"
+
+#include <cmath>
+
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_approximate_log_likelihood.hpp"
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_model_selection.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Compares the approximate evaluator against the exact one on the same data; see the file comments.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ApproximateLogMarginalLikelihoodAccuracyTest() {
+  const int dim = 2;
+  const int num_sampled = 45;
+  std::vector<int> derivatives = {1};
+  const int num_derivatives = derivatives.size();
+  const int num_rows = num_sampled*(num_derivatives+1);
+
+  UniformRandomGenerator uniform_generator(5323);
+  boost::uniform_real<double> uniform_double_hyperparameter(0.5, 1.5);
+  boost::uniform_real<double> uniform_double_lower_bound(-2.0, 0.5);
+  boost::uniform_real<double> uniform_double_upper_bound(2.0, 3.5);
+  MockGaussianProcessPriorData<TensorProductDomain> mock_gp_data(SquareExponential(dim, 1.0, 1.0), derivatives,
+                                                                 num_derivatives, dim, num_sampled,
+                                                                 uniform_double_lower_bound, uniform_double_upper_bound,
+                                                                 uniform_double_hyperparameter, &uniform_generator);
+  // moderate noise keeps K well conditioned, as in the large problems this estimator targets
+  const std::vector<double> noise_variance = {0.1, 0.1};
+  double const * points_sampled = mock_gp_data.gaussian_process_ptr->points_sampled().data();
+  double const * points_sampled_value = mock_gp_data.gaussian_process_ptr->points_sampled_value().data();
+
+  LogMarginalLikelihoodEvaluator log_likelihood_eval(points_sampled, points_sampled_value, derivatives.data(),
+                                                     num_derivatives, dim, num_sampled);
+  LogMarginalLikelihoodState log_likelihood_state(log_likelihood_eval, *mock_gp_data.covariance_ptr, noise_variance);
+
+  ApproximateLogLikelihoodParameters approximate_parameters(400, 40, 500, 1.0e-12, 8231);
+  ApproximateLogMarginalLikelihoodEvaluator approximate_eval(points_sampled, points_sampled_value, derivatives.data(),
+                                                             num_derivatives, dim, num_sampled, approximate_parameters);
+  ApproximateLogMarginalLikelihoodState approximate_state(approximate_eval, *mock_gp_data.covariance_ptr, noise_variance);
+
+  int total_errors = 0;
+  int current_errors = 0;
+
+  // matrix-free K * v against the explicit covariance matrix (plus noise and jitter)
+  std::vector<double> covariance_matrix(Square(num_rows));
+  mock_gp_data.covariance_ptr->CovarianceMatrix(points_sampled, points_sampled, dim, num_sampled, num_sampled,
+                                                derivatives.data(), num_derivatives, derivatives.data(), num_derivatives,
+                                                covariance_matrix.data());
+  for (int i = 0; i < num_sampled; ++i) {
+    for (int m = 0; m < num_derivatives+1; ++m) {
+      const int row = i*(num_derivatives+1) + m;
+      covariance_matrix[row + row*num_rows] += noise_variance[m] + 1.0e-6;
+    }
+  }
+  std::vector<double> vector(num_rows);
+  boost::uniform_real<double> uniform_double_vector(-1.0, 1.0);
+  for (auto& entry : vector) {
+    entry = uniform_double_vector(uniform_generator.engine);
+  }
+  std::vector<double> product_truth(num_rows);
+  std::vector<double> product(num_rows);
+  GeneralMatrixVectorMultiply(covariance_matrix.data(), 'N', vector.data(), 1.0, 0.0, num_rows, num_rows, num_rows,
+                              product_truth.data());
+  approximate_eval.CovarianceMatrixVectorMultiply(&approximate_state, vector.data(), product.data());
+  for (int i = 0; i < num_rows; ++i) {
+    if (!CheckDoubleWithinRelative(product[i], product_truth[i], 1.0e-13)) {
+      ++current_errors;
+    }
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("matrix-free covariance product failed\n");
+  }
+  total_errors += current_errors;
+
+  // PCG K^-1 y against the cholesky solve
+  current_errors = 0;
+  for (int i = 0; i < num_rows; ++i) {
+    if (!CheckDoubleWithinRelative(approximate_state.K_inv_y[i], log_likelihood_state.K_inv_y[i], 1.0e-6)) {
+      ++current_errors;
+    }
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("conjugate gradient solve failed\n");
+  }
+  total_errors += current_errors;
+
+  // estimated log likelihood and gradient
+  current_errors = 0;
+  const double log_likelihood = log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state);
+  const double approximate_log_likelihood = approximate_eval.ComputeLogLikelihood(approximate_state);
+  if (!CheckDoubleWithinRelative(approximate_log_likelihood, log_likelihood, 2.0e-2)) {
+    ++current_errors;
+  }
+
+  const int num_hyperparameters = log_likelihood_state.GetProblemSize();
+  std::vector<double> grad_log_likelihood(num_hyperparameters);
+  std::vector<double> approximate_grad_log_likelihood(num_hyperparameters);
+  log_likelihood_eval.ComputeGradLogLikelihood(&log_likelihood_state, grad_log_likelihood.data());
+  approximate_eval.ComputeGradLogLikelihood(&approximate_state, approximate_grad_log_likelihood.data());
+  // Hutchinson errors are absolute (not per-component relative), so compare against the gradient's size
+  const double grad_norm = VectorNorm(grad_log_likelihood.data(), num_hyperparameters);
+  for (int i = 0; i < num_hyperparameters; ++i) {
+    if (!CheckDoubleWithin(approximate_grad_log_likelihood[i], grad_log_likelihood[i], 5.0e-2*grad_norm)) {
+      ++current_errors;
+    }
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("approximate log likelihood/gradient too far from exact: %.18E vs %.18E\n",
+                              approximate_log_likelihood, log_likelihood);
+    PrintMatrix(approximate_grad_log_likelihood.data(), 1, num_hyperparameters);
+    PrintMatrix(grad_log_likelihood.data(), 1, num_hyperparameters);
+  }
+  total_errors += current_errors;
+
+  // the probes are fixed: re-evaluating at the same hyperparameters reproduces the estimate exactly
+  current_errors = 0;
+  std::vector<double> hyperparameters(num_hyperparameters);
+  approximate_state.GetCurrentPoint(hyperparameters.data());
+  approximate_state.SetCurrentPoint(approximate_eval, hyperparameters.data());
+  if (!CheckDoubleWithin(approximate_eval.ComputeLogLikelihood(approximate_state), approximate_log_likelihood, 0.0)) {
+    ++current_errors;
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("approximate log likelihood is not deterministic\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunApproximateLogLikelihoodTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = ApproximateLogMarginalLikelihoodAccuracyTest();
+  total_errors += current_errors;
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("approximate log likelihood tests failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("approximate log likelihood tests passed\n");
+  }
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,26 @@
+/*!
+  \file gpp_approximate_log_likelihood_test.hpp
+  \rst
+  Functions for testing gpp_approximate_log_likelihood's functionality: the matrix-free covariance products, the
+  conjugate gradient solve, and agreement of the stochastic log likelihood and gradient estimates with
+  LogMarginalLikelihoodEvaluator.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the approximate log marginal likelihood tests.
+
+  \return
+    number of test failures: 0 if the approximate log likelihood is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunApproximateLogLikelihoodTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_APPROXIMATE_LOG_LIKELIHOOD_TEST_HPP_
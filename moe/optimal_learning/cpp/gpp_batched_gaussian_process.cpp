@@ -0,0 +1,490 @@
+/*!
+  \file gpp_batched_gaussian_process.cpp
+  \rst
+  Implementation of BatchedGaussianProcess (see gpp_batched_gaussian_process.hpp).  Every innermost loop runs over the
+  kProblemBlockSize lanes of a block with unit stride; the outer loops mirror the single-problem code in gpp_math.cpp
+  and gpp_linear_algebra.cpp.
+\endrst*/
+
+#include "gpp_batched_gaussian_process.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
+
+namespace optimal_learning {
+
+BatchedGaussianProcess::BatchedGaussianProcess(double const * restrict hyperparameters,
+                                               double const * restrict points_sampled,
+                                               double const * restrict points_sampled_value,
+                                               double const * restrict noise_variance,
+                                               int const * restrict num_sampled, int dim, int num_problems,
+                                               int max_num_threads)
+    : dim_(dim),
+      num_problems_(num_problems),
+      num_blocks_((num_problems + kProblemBlockSize - 1)/kProblemBlockSize),
+      max_num_sampled_(num_problems > 0 ? *std::max_element(num_sampled, num_sampled + num_problems) : 0),
+      points_sampled_(num_blocks_*max_num_sampled_*dim_*kProblemBlockSize),
+      point_mask_(num_blocks_*max_num_sampled_*kProblemBlockSize),
+      K_chol_(num_blocks_*Square(max_num_sampled_)*kProblemBlockSize),
+      K_inv_y_(num_blocks_*max_num_sampled_*kProblemBlockSize),
+      inverse_lengths_sq_(num_blocks_*dim_*kProblemBlockSize),
+      alpha_(num_blocks_*kProblemBlockSize),
+      mean_(num_blocks_*kProblemBlockSize),
+      best_so_far_(num_blocks_*kProblemBlockSize) {
+  if (unlikely(num_problems_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one problem.", num_problems_, 1);
+  }
+  std::vector<int> first_point_index(num_problems_);
+  int num_points = 0;
+  for (int problem = 0; problem < num_problems_; ++problem) {
+    if (unlikely(num_sampled[problem] < 1)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "Every problem needs at least one sampled point.",
+                         num_sampled[problem], 1);
+    }
+    first_point_index[problem] = num_points;
+    num_points += num_sampled[problem];
+  }
+
+  ParallelForEachIndex(max_num_threads, num_blocks_, [&](int block) {
+      BuildBlock(block, hyperparameters, points_sampled, points_sampled_value, noise_variance, num_sampled,
+                 first_point_index.data());
+    });
+}
+
+/*!\rst
+  Padded rows keep the zero point, mask, and value they were constructed with; padded lanes get unit hyperparameters and
+  no points.  ``K`` is then ``mask_i * mask_j * cov(x_i, x_j)`` plus ``\sigma_n^2`` (real rows) or 1 (padded rows) on
+  the diagonal, factored by a right-looking cholesky (as in ComputeCholeskyFactorL()) on all lanes at once.
+\endrst*/
+void BatchedGaussianProcess::BuildBlock(int block, double const * restrict hyperparameters,
+                                        double const * restrict points_sampled,
+                                        double const * restrict points_sampled_value,
+                                        double const * restrict noise_variance, int const * restrict num_sampled,
+                                        int const * restrict first_point_index) {
+  const int lanes = kProblemBlockSize;
+  const int size = max_num_sampled_;
+  double * restrict points = points_sampled_.data() + block*size*dim_*lanes;
+  double * restrict mask = point_mask_.data() + block*size*lanes;
+  double * restrict chol = K_chol_.data() + block*Square(size)*lanes;
+  double * restrict K_inv_y = K_inv_y_.data() + block*size*lanes;
+  double * restrict inverse_lengths_sq = inverse_lengths_sq_.data() + block*dim_*lanes;
+  double * restrict alpha = alpha_.data() + block*lanes;
+  double * restrict mean = mean_.data() + block*lanes;
+  double * restrict best_so_far = best_so_far_.data() + block*lanes;
+  double noise[kProblemBlockSize];
+
+  for (int l = 0; l < lanes; ++l) {
+    const int problem = block*lanes + l;
+    if (problem >= num_problems_) {
+      alpha[l] = 1.0;
+      noise[l] = 0.0;
+      for (int d = 0; d < dim_; ++d) {
+        inverse_lengths_sq[d*lanes + l] = 1.0;
+      }
+      mean[l] = 0.0;
+      best_so_far[l] = 0.0;
+      continue;
+    }
+
+    double const * restrict problem_hyperparameters = hyperparameters + problem*(1 + dim_);
+    alpha[l] = problem_hyperparameters[0];
+    for (int d = 0; d < dim_; ++d) {
+      inverse_lengths_sq[d*lanes + l] = 1.0/Square(problem_hyperparameters[1 + d]);
+    }
+    noise[l] = noise_variance[problem];
+
+    const int problem_num_sampled = num_sampled[problem];
+    double const * restrict problem_points = points_sampled + first_point_index[problem]*dim_;
+    double const * restrict problem_values = points_sampled_value + first_point_index[problem];
+    mean[l] = 0.0;
+    best_so_far[l] = std::numeric_limits<double>::max();
+    for (int i = 0; i < problem_num_sampled; ++i) {
+      mean[l] += problem_values[i];
+      best_so_far[l] = std::fmin(best_so_far[l], problem_values[i]);
+    }
+    mean[l] /= problem_num_sampled;
+
+    for (int i = 0; i < problem_num_sampled; ++i) {
+      mask[i*lanes + l] = 1.0;
+      for (int d = 0; d < dim_; ++d) {
+        points[(i*dim_ + d)*lanes + l] = problem_points[i*dim_ + d];
+      }
+      K_inv_y[i*lanes + l] = problem_values[i] - mean[l];
+    }
+  }
+
+  // lower triangle of K
+  for (int j = 0; j < size; ++j) {
+    double const * restrict point_j = points + j*dim_*lanes;
+    double const * restrict mask_j = mask + j*lanes;
+    for (int i = j; i < size; ++i) {
+      double const * restrict point_i = points + i*dim_*lanes;
+      double const * restrict mask_i = mask + i*lanes;
+      double * restrict entry = chol + (i + j*size)*lanes;
+      double norm_sq[kProblemBlockSize] = {0.0};
+      for (int d = 0; d < dim_; ++d) {
+        for (int l = 0; l < lanes; ++l) {
+          const double difference = point_i[d*lanes + l] - point_j[d*lanes + l];
+          norm_sq[l] += difference*difference*inverse_lengths_sq[d*lanes + l];
+        }
+      }
+      for (int l = 0; l < lanes; ++l) {
+        entry[l] = mask_i[l]*mask_j[l]*alpha[l]*std::exp(-0.5*norm_sq[l]);
+      }
+      if (i == j) {
+        for (int l = 0; l < lanes; ++l) {
+          entry[l] += mask_i[l]*noise[l] + (1.0 - mask_i[l]);
+        }
+      }
+    }
+  }
+
+  for (int k = 0; k < size; ++k) {
+    double * restrict diagonal = chol + (k + k*size)*lanes;
+    for (int l = 0; l < lanes; ++l) {
+      if (unlikely(!(diagonal[l] > 0.0))) {
+        // padded rows are decoupled with unit diagonal, so the failure is in lane l's real rows
+        const int problem = block*lanes + l;
+        const int problem_size = num_sampled[problem];
+        std::vector<double> problem_chol(Square(problem_size));
+        for (int jj = 0; jj < problem_size; ++jj) {
+          for (int ii = 0; ii < problem_size; ++ii) {
+            problem_chol[ii + jj*problem_size] = chol[(ii + jj*size)*lanes + l];
+          }
+        }
+        OL_THROW_EXCEPTION(SingularMatrixException,
+                           "Covariance matrix (K) of a batched problem singular. Check for duplicate points_sampled "
+                           "(with 0 noise) and/or extreme hyperparameter values.",
+                           problem_chol.data(), problem_size, k + 1);
+      }
+    }
+    for (int l = 0; l < lanes; ++l) {
+      diagonal[l] = std::sqrt(diagonal[l]);
+    }
+    for (int i = k + 1; i < size; ++i) {
+      double * restrict entry = chol + (i + k*size)*lanes;
+      for (int l = 0; l < lanes; ++l) {
+        entry[l] /= diagonal[l];
+      }
+    }
+    for (int j = k + 1; j < size; ++j) {
+      double const * restrict chol_jk = chol + (j + k*size)*lanes;
+      for (int i = j; i < size; ++i) {
+        double * restrict entry = chol + (i + j*size)*lanes;
+        double const * restrict chol_ik = chol + (i + k*size)*lanes;
+        for (int l = 0; l < lanes; ++l) {
+          entry[l] -= chol_ik[l]*chol_jk[l];
+        }
+      }
+    }
+  }
+
+  // K^-1 * (y - mean): L \ then L^T \ (as in CholeskyFactorLMatrixVectorSolve())
+  for (int j = 0; j < size; ++j) {
+    double const * restrict diagonal = chol + (j + j*size)*lanes;
+    for (int l = 0; l < lanes; ++l) {
+      K_inv_y[j*lanes + l] /= diagonal[l];
+    }
+    for (int i = j + 1; i < size; ++i) {
+      double const * restrict chol_ij = chol + (i + j*size)*lanes;
+      for (int l = 0; l < lanes; ++l) {
+        K_inv_y[i*lanes + l] -= chol_ij[l]*K_inv_y[j*lanes + l];
+      }
+    }
+  }
+  for (int j = size - 1; j >= 0; --j) {
+    for (int i = j + 1; i < size; ++i) {
+      double const * restrict chol_ij = chol + (i + j*size)*lanes;
+      for (int l = 0; l < lanes; ++l) {
+        K_inv_y[j*lanes + l] -= chol_ij[l]*K_inv_y[i*lanes + l];
+      }
+    }
+    double const * restrict diagonal = chol + (j + j*size)*lanes;
+    for (int l = 0; l < lanes; ++l) {
+      K_inv_y[j*lanes + l] /= diagonal[l];
+    }
+  }
+}
+
+/*!\rst
+  Per lane: ``k_i = \alpha exp(-r_i^2/2)`` (0 on padded rows), ``\mu = mean + k^T K^-1 y``, ``v = L^-1 k``,
+  ``\sigma^2 = \alpha - v^T v``; then EI as in OnePotentialSampleExpectedImprovementEvaluator.  For the gradient,
+  ``w = L^-T v = K^-1 k`` and ``\nabla k_i = k_i (x_i - x)/L^2``, so ``\nabla \mu = \sum_i \nabla k_i (K^-1 y)_i``,
+  ``\nabla \sigma = -\sum_i \nabla k_i w_i / \sigma`` and ``\nabla EI = -\nabla \mu \Phi(z) + \nabla \sigma \phi(z)``.
+\endrst*/
+void BatchedGaussianProcess::ComputeBlockExpectedImprovement(int block, double const * restrict points,
+                                                             double * restrict scratch,
+                                                             double * restrict expected_improvement,
+                                                             double * restrict grad_expected_improvement) const noexcept {
+  const int lanes = kProblemBlockSize;
+  const int size = max_num_sampled_;
+  double const * restrict points_sampled = points_sampled_.data() + block*size*dim_*lanes;
+  double const * restrict mask = point_mask_.data() + block*size*lanes;
+  double const * restrict chol = K_chol_.data() + block*Square(size)*lanes;
+  double const * restrict K_inv_y = K_inv_y_.data() + block*size*lanes;
+  double const * restrict inverse_lengths_sq = inverse_lengths_sq_.data() + block*dim_*lanes;
+  double const * restrict alpha = alpha_.data() + block*lanes;
+  double const * restrict mean = mean_.data() + block*lanes;
+  double const * restrict best_so_far = best_so_far_.data() + block*lanes;
+  double * restrict kernel = scratch;
+  double * restrict solution = scratch + size*lanes;
+
+  double to_sample_mean[kProblemBlockSize];
+  double to_sample_var[kProblemBlockSize];
+  for (int l = 0; l < lanes; ++l) {
+    to_sample_mean[l] = mean[l];
+    to_sample_var[l] = alpha[l];
+  }
+  for (int i = 0; i < size; ++i) {
+    double norm_sq[kProblemBlockSize] = {0.0};
+    for (int d = 0; d < dim_; ++d) {
+      for (int l = 0; l < lanes; ++l) {
+        const double difference = points[d*lanes + l] - points_sampled[(i*dim_ + d)*lanes + l];
+        norm_sq[l] += difference*difference*inverse_lengths_sq[d*lanes + l];
+      }
+    }
+    for (int l = 0; l < lanes; ++l) {
+      kernel[i*lanes + l] = mask[i*lanes + l]*alpha[l]*std::exp(-0.5*norm_sq[l]);
+      to_sample_mean[l] += kernel[i*lanes + l]*K_inv_y[i*lanes + l];
+      solution[i*lanes + l] = kernel[i*lanes + l];
+    }
+  }
+
+  // v = L \ k
+  for (int j = 0; j < size; ++j) {
+    double const * restrict diagonal = chol + (j + j*size)*lanes;
+    for (int l = 0; l < lanes; ++l) {
+      solution[j*lanes + l] /= diagonal[l];
+      to_sample_var[l] -= Square(solution[j*lanes + l]);
+    }
+    for (int i = j + 1; i < size; ++i) {
+      double const * restrict chol_ij = chol + (i + j*size)*lanes;
+      for (int l = 0; l < lanes; ++l) {
+        solution[i*lanes + l] -= chol_ij[l]*solution[j*lanes + l];
+      }
+    }
+  }
+
+  const double minimum_variance = grad_expected_improvement == nullptr ?
+      OnePotentialSampleExpectedImprovementEvaluator::kMinimumVarianceEI :
+      OnePotentialSampleExpectedImprovementEvaluator::kMinimumVarianceGradEI;
+  const double kInverseSqrt2 = 1.0/std::sqrt(2.0);
+  const double kInverseSqrt2Pi = 1.0/std::sqrt(2.0*kPi);
+  double sigma[kProblemBlockSize];
+  double cdf_z[kProblemBlockSize];
+  double pdf_z[kProblemBlockSize];
+  for (int l = 0; l < lanes; ++l) {
+    sigma[l] = std::sqrt(std::fmax(minimum_variance, to_sample_var[l]));
+    const double improvement = best_so_far[l] - to_sample_mean[l];
+    const double z = improvement/sigma[l];
+    cdf_z[l] = 0.5*std::erfc(-z*kInverseSqrt2);
+    pdf_z[l] = kInverseSqrt2Pi*std::exp(-0.5*z*z);
+    expected_improvement[l] = std::fmax(0.0, improvement*cdf_z[l] + sigma[l]*pdf_z[l]);
+  }
+  if (grad_expected_improvement == nullptr) {
+    return;
+  }
+
+  // w = L^T \ v
+  for (int j = size - 1; j >= 0; --j) {
+    for (int i = j + 1; i < size; ++i) {
+      double const * restrict chol_ij = chol + (i + j*size)*lanes;
+      for (int l = 0; l < lanes; ++l) {
+        solution[j*lanes + l] -= chol_ij[l]*solution[i*lanes + l];
+      }
+    }
+    double const * restrict diagonal = chol + (j + j*size)*lanes;
+    for (int l = 0; l < lanes; ++l) {
+      solution[j*lanes + l] /= diagonal[l];
+    }
+  }
+
+  for (int d = 0; d < dim_; ++d) {
+    double grad_mean[kProblemBlockSize] = {0.0};
+    double grad_var_half[kProblemBlockSize] = {0.0};
+    for (int i = 0; i < size; ++i) {
+      for (int l = 0; l < lanes; ++l) {
+        const double grad_kernel = kernel[i*lanes + l]*inverse_lengths_sq[d*lanes + l]*
+            (points_sampled[(i*dim_ + d)*lanes + l] - points[d*lanes + l]);
+        grad_mean[l] += grad_kernel*K_inv_y[i*lanes + l];
+        grad_var_half[l] -= grad_kernel*solution[i*lanes + l];
+      }
+    }
+    for (int l = 0; l < lanes; ++l) {
+      grad_expected_improvement[d*lanes + l] = -grad_mean[l]*cdf_z[l] + grad_var_half[l]/sigma[l]*pdf_z[l];
+    }
+  }
+}
+
+void BatchedGaussianProcess::ComputeExpectedImprovement(double const * restrict points, int max_num_threads,
+                                                        double * restrict expected_improvement,
+                                                        double * restrict grad_expected_improvement) const {
+  const int lanes = kProblemBlockSize;
+  ParallelForEachIndex(max_num_threads, num_blocks_, [&](int block) {
+      const int num_lanes = std::min(lanes, num_problems_ - block*lanes);
+      std::vector<double> scratch(2*max_num_sampled_*lanes);
+      std::vector<double> block_points(dim_*lanes, 0.0);
+      std::vector<double> block_grad(dim_*lanes);
+      double block_expected_improvement[kProblemBlockSize];
+      for (int l = 0; l < num_lanes; ++l) {
+        for (int d = 0; d < dim_; ++d) {
+          block_points[d*lanes + l] = points[(block*lanes + l)*dim_ + d];
+        }
+      }
+
+      ComputeBlockExpectedImprovement(block, block_points.data(), scratch.data(), block_expected_improvement,
+                                      grad_expected_improvement == nullptr ? nullptr : block_grad.data());
+      for (int l = 0; l < num_lanes; ++l) {
+        expected_improvement[block*lanes + l] = block_expected_improvement[l];
+        if (grad_expected_improvement != nullptr) {
+          for (int d = 0; d < dim_; ++d) {
+            grad_expected_improvement[(block*lanes + l)*dim_ + d] = block_grad[d*lanes + l];
+          }
+        }
+      }
+    });
+}
+
+/*!\rst
+  Each step is GradientDescentOptimization()'s: ``\alpha_n = pre_mult * (n+1)^{-\gamma}``, the step
+  ``\alpha_n \nabla EI`` is limited to ``max_relative_change`` times the distance to the nearest wall, and a lane stops
+  once its step norm falls below ``tolerance/max_num_steps``.  Lanes that have stopped take zero steps until the whole
+  block has stopped (or max_num_steps is reached); padded lanes start at the center of ``[0, 1]^dim``.  Up to
+  ``max_num_restarts`` such descents follow one another, as in GradientDescentOptimizer::Optimize(); a lane stops
+  restarting once a descent moves it by at most ``tolerance``.
+\endrst*/
+void BatchedGaussianProcess::MultistartExpectedImprovementOptimization(
+    const GradientDescentParameters& gd_parameters, ClosedInterval const * restrict domains, int max_num_threads,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_points,
+    double * restrict best_expected_improvement) const {
+  const int lanes = kProblemBlockSize;
+  const int num_multistarts = gd_parameters.num_multistarts;
+
+  // initial guesses are drawn serially so that they do not depend on the thread count
+  std::vector<double> initial_guesses(num_problems_*num_multistarts*dim_);
+  for (int problem = 0; problem < num_problems_; ++problem) {
+    TensorProductDomain domain(domains + problem*dim_, dim_);
+    domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
+                                         initial_guesses.data() + problem*num_multistarts*dim_);
+  }
+
+  const double step_tolerance = gd_parameters.tolerance/static_cast<double>(gd_parameters.max_num_steps);
+  ParallelForEachIndex(max_num_threads, num_blocks_, [&](int block) {
+      const int num_lanes = std::min(lanes, num_problems_ - block*lanes);
+      std::vector<double> scratch(2*max_num_sampled_*lanes);
+      std::vector<double> lower(dim_*lanes, 0.0), upper(dim_*lanes, 1.0);
+      std::vector<double> current_point(dim_*lanes), grad_expected_improvement(dim_*lanes);
+      std::vector<double> best_point(dim_*lanes, 0.5);
+      double expected_improvement[kProblemBlockSize];
+      double best_block_expected_improvement[kProblemBlockSize];
+      double active[kProblemBlockSize];
+      double norm_step_sq[kProblemBlockSize];
+      std::fill(best_block_expected_improvement, best_block_expected_improvement + lanes,
+                -std::numeric_limits<double>::infinity());
+      std::vector<double> restart_point(dim_*lanes);
+      double restarting[kProblemBlockSize];
+      // keeps each lane's point if its EI (value only, as ComputeExpectedImprovement() reports it) is the best so far
+      auto update_best = [&](double const * restrict candidate_expected_improvement) {
+        for (int l = 0; l < lanes; ++l) {
+          if (candidate_expected_improvement[l] > best_block_expected_improvement[l]) {
+            best_block_expected_improvement[l] = candidate_expected_improvement[l];
+            for (int d = 0; d < dim_; ++d) {
+              best_point[d*lanes + l] = current_point[d*lanes + l];
+            }
+          }
+        }
+      };
+      for (int l = 0; l < num_lanes; ++l) {
+        for (int d = 0; d < dim_; ++d) {
+          lower[d*lanes + l] = domains[(block*lanes + l)*dim_ + d].min;
+          upper[d*lanes + l] = domains[(block*lanes + l)*dim_ + d].max;
+        }
+      }
+
+      for (int start = 0; start < num_multistarts; ++start) {
+        std::fill(current_point.begin(), current_point.end(), 0.5);
+        for (int l = 0; l < num_lanes; ++l) {
+          for (int d = 0; d < dim_; ++d) {
+            current_point[d*lanes + l] = initial_guesses[((block*lanes + l)*num_multistarts + start)*dim_ + d];
+          }
+        }
+        // the start itself is a candidate: descent from a start with high EI can overshoot into a region where EI ~ 0
+        ComputeBlockExpectedImprovement(block, current_point.data(), scratch.data(), expected_improvement, nullptr);
+        update_best(expected_improvement);
+
+        // restarts as in GradientDescentOptimizer::Optimize(): a lane stops restarting once a restart moves it by at
+        // most tolerance
+        std::fill(restarting, restarting + lanes, 1.0);
+        for (int restart = 0; restart < gd_parameters.max_num_restarts; ++restart) {
+          std::copy(current_point.begin(), current_point.end(), restart_point.begin());
+          std::copy(restarting, restarting + lanes, active);
+          for (int step = 0; step < gd_parameters.max_num_steps; ++step) {
+            const double alpha_n = gd_parameters.pre_mult*std::pow(static_cast<double>(step + 1), -gd_parameters.gamma);
+            ComputeBlockExpectedImprovement(block, current_point.data(), scratch.data(), expected_improvement,
+                                            grad_expected_improvement.data());
+            std::fill(norm_step_sq, norm_step_sq + lanes, 0.0);
+            for (int d = 0; d < dim_; ++d) {
+              for (int l = 0; l < lanes; ++l) {
+                const int index = d*lanes + l;
+                const double limit = gd_parameters.max_relative_change*
+                    std::fmin(current_point[index] - lower[index], upper[index] - current_point[index]);
+                const double desired_step = std::fmin(limit, std::fmax(-limit,
+                    active[l]*alpha_n*grad_expected_improvement[index]));
+                const double next_coordinate = std::fmin(upper[index], std::fmax(lower[index],
+                    current_point[index] + desired_step));
+                norm_step_sq[l] += Square(next_coordinate - current_point[index]);
+                current_point[index] = next_coordinate;
+              }
+            }
+            double num_active = 0.0;
+            for (int l = 0; l < lanes; ++l) {
+              active[l] = norm_step_sq[l] < Square(step_tolerance) ? 0.0 : active[l];
+              num_active += active[l];
+            }
+            if (num_active == 0.0) {
+              break;
+            }
+          }
+
+          double num_restarting = 0.0;
+          std::fill(norm_step_sq, norm_step_sq + lanes, 0.0);
+          for (int d = 0; d < dim_; ++d) {
+            for (int l = 0; l < lanes; ++l) {
+              norm_step_sq[l] += Square(current_point[d*lanes + l] - restart_point[d*lanes + l]);
+            }
+          }
+          for (int l = 0; l < lanes; ++l) {
+            restarting[l] = norm_step_sq[l] <= Square(gd_parameters.tolerance) ? 0.0 : restarting[l];
+            num_restarting += restarting[l];
+          }
+          if (num_restarting == 0.0) {
+            break;
+          }
+        }
+
+        ComputeBlockExpectedImprovement(block, current_point.data(), scratch.data(), expected_improvement, nullptr);
+        update_best(expected_improvement);
+      }
+
+      for (int l = 0; l < num_lanes; ++l) {
+        best_expected_improvement[block*lanes + l] = best_block_expected_improvement[l];
+        for (int d = 0; d < dim_; ++d) {
+          best_next_points[(block*lanes + l)*dim_ + d] = best_point[d*lanes + l];
+        }
+      }
+    });
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,188 @@
+/*!
+  \file gpp_batched_gaussian_process.hpp
+  \rst
+  1. OVERVIEW
+  2. STORAGE
+  3. EXPECTED IMPROVEMENT OPTIMIZATION
+
+  **1. OVERVIEW**
+
+  Many small, independent optimization problems (e.g., thousands of tuning problems with ``num_sampled < 100`` and
+  ``dim <= 5``) are dominated by per-problem overhead when each builds its own GaussianProcess and runs its own
+  multistart EI optimization: every covariance matrix, cholesky factor, and triangular solve is tiny, so the loops are
+  too short to vectorize and the per-call setup costs as much as the arithmetic.
+
+  BatchedGaussianProcess builds and factors all of the problems' GPs in one call and evaluates/optimizes 1,0-EI for all of
+  them at once.  Each problem is the same model as a GaussianProcess with a SquareExponential covariance, scalar noise,
+  and no derivative observations (constant prior mean equal to the mean of its ``points_sampled_value``); EI is the
+  analytic 1,0-EI of OnePotentialSampleExpectedImprovementEvaluator with ``best_so_far = min(points_sampled_value)``.
+
+  **2. STORAGE**
+
+  Problems are grouped into blocks of kProblemBlockSize "lanes".  Within a block, every per-problem array is
+  interleaved, lane index fastest: e.g., entry ``(i, j)`` of the cholesky factor of lane ``l`` is at
+  ``K_chol[(i + j*max_num_sampled)*kProblemBlockSize + l]``.  So every loop of the factorization, the solves, and EI runs
+  over the lanes with unit stride and no data-dependent branches, which the compiler vectorizes across problems; and
+  each block is one contiguous slab of memory, so threads working on different blocks touch disjoint memory.
+
+  Problems with fewer than ``max_num_sampled`` points are padded with decoupled rows (unit diagonal, zero covariance
+  with everything, zero value), which leave the posterior unchanged; a trailing partial block is padded with empty
+  problems whose results are discarded.
+
+  **3. EXPECTED IMPROVEMENT OPTIMIZATION**
+
+  MultistartExpectedImprovementOptimization() runs the restarted gradient descent of GradientDescentOptimizer::Optimize()
+  on every problem of a block in lockstep (each lane stops moving once its step falls below tolerance), one multistart at
+  a time, keeping each lane's best point among the starts and the results of descent.  Blocks are independent and are distributed over threads.  Initial guesses are drawn
+  up front, per problem, from its domain, so results do not depend on the number of threads.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_HPP_
+
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  ``num_problems`` independent GPs (SquareExponential covariance, no derivative observations) stored and evaluated
+  together; see the file comments.  Immutable after construction, so the const methods may be called concurrently.
+\endrst*/
+class BatchedGaussianProcess final {
+ public:
+  //! number of problems ("lanes") interleaved in one block; 8 doubles fill one AVX-512 register (two AVX2 registers)
+  static constexpr int kProblemBlockSize = 8;
+
+  BatchedGaussianProcess() = delete;
+
+  /*!\rst
+    Builds and factors the covariance matrices of all problems.  Inputs are in the usual (per-problem, row-major)
+    layout, problems concatenated; they are copied into the interleaved layout.
+
+    \param
+      :hyperparameters[num_problems][1 + dim]: each problem's SquareExponential ``\alpha`` then its ``dim`` length scales
+      :points_sampled[sum(num_sampled)][dim]: each problem's sampled points, concatenated in problem order
+      :points_sampled_value[sum(num_sampled)]: function values at points_sampled
+      :noise_variance[num_problems]: each problem's ``\sigma_n^2``
+      :num_sampled[num_problems]: number of sampled points of each problem, >= 1
+      :dim: spatial dimension (shared by all problems)
+      :num_problems: number of problems
+      :max_num_threads: maximum number of threads to build the blocks with
+    \raise
+      SingularMatrixException if some problem's covariance matrix is singular (the matrix is that problem's)
+  \endrst*/
+  BatchedGaussianProcess(double const * restrict hyperparameters, double const * restrict points_sampled,
+                         double const * restrict points_sampled_value, double const * restrict noise_variance,
+                         int const * restrict num_sampled, int dim, int num_problems, int max_num_threads);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_problems() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_problems_;
+  }
+
+  //! largest num_sampled over the problems; the padded size of every problem's covariance matrix
+  int max_num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_num_sampled_;
+  }
+
+  /*!\rst
+    Computes 1,0-EI (and optionally its gradient) of every problem at one point per problem.
+
+    \param
+      :points[num_problems][dim]: the point at which to evaluate each problem's EI
+      :max_num_threads: maximum number of threads
+    \output
+      :expected_improvement[num_problems]: EI of each problem at its point
+      :grad_expected_improvement[num_problems][dim]: gradient of each EI wrt its point; nullptr to skip
+  \endrst*/
+  void ComputeExpectedImprovement(double const * restrict points, int max_num_threads,
+                                  double * restrict expected_improvement,
+                                  double * restrict grad_expected_improvement) const;
+
+  /*!\rst
+    Maximizes 1,0-EI of every problem over its (tensor product) domain with multistarted gradient descent.
+
+    Uses ``num_multistarts``, ``max_num_steps``, ``max_num_restarts``, ``gamma``, ``pre_mult``,
+    ``max_relative_change``, and ``tolerance`` of ``gd_parameters`` as GradientDescentOptimizer::Optimize() does; steps
+    that would leave the domain are clamped to it.  ``num_steps_averaged`` is ignored, as it is there (averaging is not
+    implemented), and so is ``deadline``.  Each problem's result is the best of its starts and of the points descent
+    reaches from them, so its EI is never below that of any start.
+
+    \param
+      :gd_parameters: gradient descent parameters shared by all problems
+      :domains[num_problems][dim]: each problem's domain
+      :max_num_threads: maximum number of threads
+      :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for the initial guesses
+    \output
+      :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+      :best_next_points[num_problems][dim]: each problem's best point found
+      :best_expected_improvement[num_problems]: EI of each problem at its best point
+  \endrst*/
+  void MultistartExpectedImprovementOptimization(const GradientDescentParameters& gd_parameters,
+                                                 ClosedInterval const * restrict domains, int max_num_threads,
+                                                 UniformRandomGenerator * uniform_generator,
+                                                 double * restrict best_next_points,
+                                                 double * restrict best_expected_improvement) const;
+
+ private:
+  /*!\rst
+    Builds and factors the (padded) covariance matrices of one block and solves for ``K^-1 * (y - mean)``.
+  \endrst*/
+  void BuildBlock(int block, double const * restrict hyperparameters, double const * restrict points_sampled,
+                  double const * restrict points_sampled_value, double const * restrict noise_variance,
+                  int const * restrict num_sampled, int const * restrict first_point_index);
+
+  /*!\rst
+    EI (and optionally its gradient) of every lane of ``block`` at interleaved ``points``.
+
+    \param
+      :block: index of the block
+      :points[dim][kProblemBlockSize]: one point per lane, interleaved
+      :scratch[2*max_num_sampled*kProblemBlockSize]: temporary storage
+    \output
+      :expected_improvement[kProblemBlockSize]: EI of each lane
+      :grad_expected_improvement[dim][kProblemBlockSize]: gradient of each lane's EI, interleaved; nullptr to skip
+  \endrst*/
+  void ComputeBlockExpectedImprovement(int block, double const * restrict points, double * restrict scratch,
+                                       double * restrict expected_improvement,
+                                       double * restrict grad_expected_improvement) const noexcept;
+
+  //! spatial dimension
+  int dim_;
+  //! number of (real) problems
+  int num_problems_;
+  //! number of blocks of kProblemBlockSize problems (the last one possibly padded)
+  int num_blocks_;
+  //! largest num_sampled; every problem is padded to this many points
+  int max_num_sampled_;
+
+  // per block, lane index fastest
+  //! ``[num_blocks][max_num_sampled][dim][kProblemBlockSize]`` sampled points (0 in padded rows)
+  std::vector<double> points_sampled_;
+  //! ``[num_blocks][max_num_sampled][kProblemBlockSize]`` 1.0 for real points, 0.0 for padded rows
+  std::vector<double> point_mask_;
+  //! ``[num_blocks][max_num_sampled^2][kProblemBlockSize]`` cholesky factors of ``K`` (column-major lower triangles)
+  std::vector<double> K_chol_;
+  //! ``[num_blocks][max_num_sampled][kProblemBlockSize]`` ``K^-1 * (y - mean)``
+  std::vector<double> K_inv_y_;
+  //! ``[num_blocks][dim][kProblemBlockSize]`` ``1/L_d^2`` for each problem's length scales
+  std::vector<double> inverse_lengths_sq_;
+  //! ``[num_blocks][kProblemBlockSize]`` signal variance ``\alpha``
+  std::vector<double> alpha_;
+  //! ``[num_blocks][kProblemBlockSize]`` prior mean (mean of points_sampled_value)
+  std::vector<double> mean_;
+  //! ``[num_blocks][kProblemBlockSize]`` ``min(points_sampled_value)``, EI's best_so_far
+  std::vector<double> best_so_far_;
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_HPP_
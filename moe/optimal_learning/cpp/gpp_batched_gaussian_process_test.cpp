@@ -0,0 +1,289 @@
+/*!
+  \file gpp_batched_gaussian_process_test.cpp
+  \rst
+  Routines to test the functions in gpp_batched_gaussian_process.cpp:
+
+  * BatchedGaussianProcess's EI and its gradient match OnePotentialSampleExpectedImprovementEvaluator on a
+    GaussianProcess built from each problem's data, for problems of different sizes spread over several (partial)
+    blocks, and
+  * MultistartExpectedImprovementOptimization() stays in each problem's domain, reports the EI at the point it returns,
+    improves on every one of its initial guesses, and does not depend on the number of threads.
+\endrst*/
+
+#include "gpp_batched_gaussian_process_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_batched_gaussian_process.hpp"
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Training data for ``num_problems`` problems of different sizes: random SquareExponential hyperparameters and noise,
+  points uniform in each problem's domain, and values from a smooth function of the points (different per problem).
+\endrst*/
+struct BatchedProblems {
+  BatchedProblems(int dim_in, int num_problems_in, int min_num_sampled, int max_num_sampled,
+                  UniformRandomGenerator * uniform_generator)
+      : dim(dim_in),
+        num_problems(num_problems_in),
+        num_sampled(num_problems),
+        hyperparameters(num_problems*(1 + dim)),
+        noise_variance(num_problems),
+        domains(num_problems*dim) {
+    boost::uniform_real<double> uniform_double(0.0, 1.0);
+    for (int problem = 0; problem < num_problems; ++problem) {
+      num_sampled[problem] = min_num_sampled + (7*problem) % (max_num_sampled - min_num_sampled + 1);
+      hyperparameters[problem*(1 + dim)] = 0.5 + 1.5*uniform_double(uniform_generator->engine);
+      for (int d = 0; d < dim; ++d) {
+        hyperparameters[problem*(1 + dim) + 1 + d] = 0.3 + 1.2*uniform_double(uniform_generator->engine);
+        domains[problem*dim + d] = {-1.0 + 0.1*problem, 1.0 + 0.1*problem};
+      }
+      noise_variance[problem] = 1.0e-2*(1 + problem % 3);
+
+      for (int i = 0; i < num_sampled[problem]; ++i) {
+        double value = 0.0;
+        for (int d = 0; d < dim; ++d) {
+          const ClosedInterval& interval = domains[problem*dim + d];
+          const double coordinate = interval.min + interval.Length()*uniform_double(uniform_generator->engine);
+          points_sampled.push_back(coordinate);
+          value += std::sin((1.0 + 0.3*problem)*coordinate + d);
+        }
+        points_sampled_value.push_back(value);
+      }
+    }
+  }
+
+  //! offset of each problem's first point in points_sampled (in points)
+  int FirstPointIndex(int problem) const {
+    int first_point_index = 0;
+    for (int p = 0; p < problem; ++p) {
+      first_point_index += num_sampled[p];
+    }
+    return first_point_index;
+  }
+
+  int dim;
+  int num_problems;
+  std::vector<int> num_sampled;
+  std::vector<double> hyperparameters;
+  std::vector<double> noise_variance;
+  std::vector<ClosedInterval> domains;
+  std::vector<double> points_sampled;
+  std::vector<double> points_sampled_value;
+};
+
+/*!\rst
+  Checks BatchedGaussianProcess::ComputeExpectedImprovement() against OnePotentialSampleExpectedImprovementEvaluator
+  on each problem's GaussianProcess, with 1 and several threads.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int BatchedExpectedImprovementTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  // two full blocks and a partial one
+  const int num_problems = 2*BatchedGaussianProcess::kProblemBlockSize + 3;
+  const double tolerance = 1.0e-10;
+
+  UniformRandomGenerator uniform_generator(31415);
+  BatchedProblems problems(dim, num_problems, 1, 15, &uniform_generator);
+  boost::uniform_real<double> uniform_double(-1.0, 1.0);
+  std::vector<double> points(num_problems*dim);
+  for (auto& coordinate : points) {
+    coordinate = uniform_double(uniform_generator.engine);
+  }
+
+  for (int max_num_threads : {1, 4}) {
+    BatchedGaussianProcess batched_gaussian_process(problems.hyperparameters.data(), problems.points_sampled.data(),
+                                                    problems.points_sampled_value.data(),
+                                                    problems.noise_variance.data(), problems.num_sampled.data(), dim,
+                                                    num_problems, max_num_threads);
+    std::vector<double> expected_improvement(num_problems), grad_expected_improvement(num_problems*dim);
+    std::vector<double> expected_improvement_no_grad(num_problems);
+    batched_gaussian_process.ComputeExpectedImprovement(points.data(), max_num_threads, expected_improvement.data(),
+                                                        grad_expected_improvement.data());
+    batched_gaussian_process.ComputeExpectedImprovement(points.data(), max_num_threads,
+                                                        expected_improvement_no_grad.data(), nullptr);
+
+    for (int problem = 0; problem < num_problems; ++problem) {
+      const int first_point_index = problems.FirstPointIndex(problem);
+      const int num_sampled = problems.num_sampled[problem];
+      double const * points_sampled_value = problems.points_sampled_value.data() + first_point_index;
+      SquareExponential sqexp_covariance(dim, problems.hyperparameters[problem*(1 + dim)],
+                                         problems.hyperparameters.data() + problem*(1 + dim) + 1);
+      std::vector<int> derivatives;  // values only
+      GaussianProcess gaussian_process(sqexp_covariance, problems.points_sampled.data() + first_point_index*dim,
+                                       points_sampled_value, problems.noise_variance.data() + problem,
+                                       derivatives.data(), derivatives.size(), dim, num_sampled);
+      const double best_so_far = *std::min_element(points_sampled_value, points_sampled_value + num_sampled);
+      OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
+      OnePotentialSampleExpectedImprovementState ei_state(ei_evaluator, points.data() + problem*dim, true);
+      std::vector<double> grad_ei_truth(dim);
+      const double ei_truth = ei_evaluator.ComputeExpectedImprovement(&ei_state);
+      ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_ei_truth.data());
+
+      if (!CheckDoubleWithinRelative(expected_improvement[problem], ei_truth, tolerance) ||
+          !CheckDoubleWithinRelative(expected_improvement_no_grad[problem], ei_truth, tolerance)) {
+        OL_ERROR_PRINTF("problem %d: batched EI %.18E, truth %.18E\n", problem, expected_improvement[problem],
+                        ei_truth);
+        ++total_errors;
+      }
+      for (int d = 0; d < dim; ++d) {
+        if (!CheckDoubleWithin(grad_expected_improvement[problem*dim + d], grad_ei_truth[d], tolerance)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks BatchedGaussianProcess::MultistartExpectedImprovementOptimization() with ``gd_parameters``: results lie in each
+  problem's domain, the reported EI is the EI at the returned point, the EI found is at least the EI at each of the
+  initial guesses (which are regenerated here from the same seed), and the results are identical with 1 and several
+  threads.
+
+  \param
+    :gd_parameters: gradient descent parameters to optimize with
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int BatchedExpectedImprovementOptimizationTest(const GradientDescentParameters& gd_parameters) {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_problems = BatchedGaussianProcess::kProblemBlockSize + 3;
+
+  UniformRandomGenerator uniform_generator(2718);
+  BatchedProblems problems(dim, num_problems, 3, 8, &uniform_generator);
+  const int num_multistarts = gd_parameters.num_multistarts;
+
+  std::vector<double> best_next_points(num_problems*dim), best_expected_improvement(num_problems);
+  std::vector<double> best_next_points_threaded(num_problems*dim), best_expected_improvement_threaded(num_problems);
+  BatchedGaussianProcess batched_gaussian_process(problems.hyperparameters.data(), problems.points_sampled.data(),
+                                                  problems.points_sampled_value.data(), problems.noise_variance.data(),
+                                                  problems.num_sampled.data(), dim, num_problems, 1);
+  UniformRandomGenerator optimizer_uniform_generator(1234);
+  batched_gaussian_process.MultistartExpectedImprovementOptimization(gd_parameters, problems.domains.data(), 1,
+                                                                     &optimizer_uniform_generator,
+                                                                     best_next_points.data(),
+                                                                     best_expected_improvement.data());
+  optimizer_uniform_generator.SetExplicitSeed(1234);
+  batched_gaussian_process.MultistartExpectedImprovementOptimization(gd_parameters, problems.domains.data(), 4,
+                                                                     &optimizer_uniform_generator,
+                                                                     best_next_points_threaded.data(),
+                                                                     best_expected_improvement_threaded.data());
+  if (best_next_points_threaded != best_next_points ||
+      best_expected_improvement_threaded != best_expected_improvement) {
+    OL_ERROR_PRINTF("batched EI optimization depends on the number of threads\n");
+    ++total_errors;
+  }
+
+  std::vector<double> expected_improvement_at_best(num_problems);
+  batched_gaussian_process.ComputeExpectedImprovement(best_next_points.data(), 1, expected_improvement_at_best.data(),
+                                                      nullptr);
+
+  // the initial guesses, drawn in the same order as MultistartExpectedImprovementOptimization() draws them
+  std::vector<double> initial_guesses(num_problems*num_multistarts*dim);
+  optimizer_uniform_generator.SetExplicitSeed(1234);
+  for (int problem = 0; problem < num_problems; ++problem) {
+    TensorProductDomain domain(problems.domains.data() + problem*dim, dim);
+    domain.GenerateUniformPointsInDomain(num_multistarts, &optimizer_uniform_generator,
+                                         initial_guesses.data() + problem*num_multistarts*dim);
+  }
+  std::vector<double> start_points(num_problems*dim), start_expected_improvement(num_problems);
+  std::vector<double> best_start_expected_improvement(num_problems, 0.0);
+  for (int start = 0; start < num_multistarts; ++start) {
+    for (int problem = 0; problem < num_problems; ++problem) {
+      std::copy(initial_guesses.data() + (problem*num_multistarts + start)*dim,
+                initial_guesses.data() + (problem*num_multistarts + start + 1)*dim,
+                start_points.data() + problem*dim);
+    }
+    batched_gaussian_process.ComputeExpectedImprovement(start_points.data(), 4, start_expected_improvement.data(),
+                                                        nullptr);
+    for (int problem = 0; problem < num_problems; ++problem) {
+      best_start_expected_improvement[problem] = std::max(best_start_expected_improvement[problem],
+                                                          start_expected_improvement[problem]);
+    }
+  }
+
+  for (int problem = 0; problem < num_problems; ++problem) {
+    for (int d = 0; d < dim; ++d) {
+      if (!problems.domains[problem*dim + d].IsInside(best_next_points[problem*dim + d])) {
+        ++total_errors;
+      }
+    }
+    if (!CheckDoubleWithinRelative(best_expected_improvement[problem], expected_improvement_at_best[problem], 0.0)) {
+      ++total_errors;
+    }
+    if (best_expected_improvement[problem] < best_start_expected_improvement[problem]) {
+      OL_ERROR_PRINTF("problem %d: optimized EI %.18E below initial guess EI %.18E\n", problem,
+                      best_expected_improvement[problem], best_start_expected_improvement[problem]);
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunBatchedGaussianProcessTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = BatchedExpectedImprovementTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("batched GP EI failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("batched GP EI\n");
+  }
+  total_errors += current_errors;
+
+  {
+    GradientDescentParameters gd_parameters(20, 300, 1, 0, 0.7, 1.0, 0.7, 1.0e-9);
+    current_errors = BatchedExpectedImprovementOptimizationTest(gd_parameters);
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("batched GP EI optimization failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("batched GP EI optimization\n");
+  }
+  total_errors += current_errors;
+
+  {
+    // large steps overshoot from good starts into regions where EI ~ 0; restarts continue from there
+    GradientDescentParameters gd_parameters(20, 300, 3, 0, 0.1, 200.0, 1.0, 1.0e-9);
+    current_errors = BatchedExpectedImprovementOptimizationTest(gd_parameters);
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("batched GP EI optimization (large steps, restarts) failed with %d errors\n",
+                              current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("batched GP EI optimization (large steps, restarts)\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
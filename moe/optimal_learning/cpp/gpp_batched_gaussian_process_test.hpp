@@ -0,0 +1,26 @@
+/*!
+  \file gpp_batched_gaussian_process_test.hpp
+  \rst
+  Functions for testing gpp_batched_gaussian_process's functionality: BatchedGaussianProcess's EI (and gradient) matches
+  OnePotentialSampleExpectedImprovementEvaluator on the equivalent GaussianProcess for every problem, and its multistart
+  EI optimization finds each problem's maximum, independent of the number of threads.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the batched GP tests.
+
+  \return
+    number of test failures: 0 if BatchedGaussianProcess is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunBatchedGaussianProcessTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_BATCHED_GAUSSIAN_PROCESS_TEST_HPP_
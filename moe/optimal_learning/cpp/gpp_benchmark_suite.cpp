@@ -0,0 +1,506 @@
+/*!
+  \file gpp_benchmark_suite.cpp
+  \rst
+  ``moe/optimal_learning/cpp/gpp_benchmark_suite.cpp``
+
+  Micro- and macro-benchmarks for the hot paths of this project, with machine-readable (JSON or CSV) output so that
+  runs across versions (of MOE, the compiler, BLAS, etc.) can be compared to catch performance regressions.
+
+  The suite covers:
+
+  1. dense linear algebra at several sizes: cholesky factorization, triangular solve (TRSM), and GEMM
+  2. covariance matrix builds, with and without gradient observations
+  3. q,p-EI (MC), KG, and KG-MCMC evaluation and gradients
+  4. the log marginal likelihood gradient (with respect to hyperparameters)
+  5. a full multistart KG suggestion (ComputeKGOptimalPointsToSample)
+
+  Usage::
+
+    gpp_benchmarks [--format=json|csv] [--output=FILE] [--filter=SUBSTRING] [--min-time=SECONDS] [--threads=N]
+
+  * ``--format``: output format; default json
+  * ``--output``: write results to FILE instead of stdout
+  * ``--filter``: only run benchmarks whose name contains SUBSTRING
+  * ``--min-time``: minimum measured time per benchmark; default 0.5
+  * ``--threads``: max_num_threads for the multithreaded benchmarks (KG-MCMC, multistart); default 1
+
+  Each benchmark is called once to warm up. Then calls are grouped into batches of ``calls_per_batch`` (chosen so a
+  batch takes at least 1ms) and batches are repeated until ``--min-time`` has elapsed (at least kMinNumBatches times).
+  Reported times are per call: the min, median, and mean over batches. Setup (building GPs, evaluators, random
+  inputs) is not timed; the per-call copy of the input matrix is included in the cholesky and TRSM timings (they
+  factor/solve in place).
+
+  All inputs are drawn from fixed seeds, so every run does the same work.
+\endrst*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_knowledge_gradient_optimization.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_model_selection.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+using namespace optimal_learning;  // NOLINT, i'm lazy in this file which has no external linkage anyway
+
+namespace {
+
+//! minimum number of timed batches per benchmark
+constexpr int kMinNumBatches = 5;
+//! a batch of calls must take at least this long; keeps clock overhead out of sub-microsecond benchmarks
+constexpr double kMinBatchSeconds = 1.0e-3;
+
+//! results are accumulated here so the compiler cannot discard benchmarked work
+volatile double benchmark_sink = 0.0;
+
+struct BenchmarkOptions {
+  bool csv = false;
+  std::string output;
+  std::string filter;
+  double min_time = 0.5;
+  int max_num_threads = 1;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  std::string parameters;
+  int calls_per_batch;
+  int num_batches;
+  double min_seconds;
+  double median_seconds;
+  double mean_seconds;
+};
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*!\rst
+  Times ``call`` (see the file comments for the batching scheme) and appends the result, unless ``name`` does not
+  match ``options.filter``.
+\endrst*/
+void RunBenchmark(const BenchmarkOptions& options, const std::string& name, const std::string& parameters,
+                  const std::function<void()>& call, std::vector<BenchmarkResult> * results) {
+  if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+    return;
+  }
+
+  // warm up and calibrate the batch size
+  auto start = std::chrono::steady_clock::now();
+  call();
+  double elapsed = SecondsSince(start);
+  int calls_per_batch = 1;
+  while (elapsed < kMinBatchSeconds && calls_per_batch < (1 << 24)) {
+    calls_per_batch *= 2;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls_per_batch; ++i) {
+      call();
+    }
+    elapsed = SecondsSince(start);
+  }
+
+  std::vector<double> batch_seconds;
+  double total_seconds = 0.0;
+  while (static_cast<int>(batch_seconds.size()) < kMinNumBatches || total_seconds < options.min_time) {
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls_per_batch; ++i) {
+      call();
+    }
+    elapsed = SecondsSince(start);
+    total_seconds += elapsed;
+    batch_seconds.push_back(elapsed / calls_per_batch);
+  }
+
+  BenchmarkResult result;
+  result.name = name;
+  result.parameters = parameters;
+  result.calls_per_batch = calls_per_batch;
+  result.num_batches = batch_seconds.size();
+  result.mean_seconds = total_seconds / (calls_per_batch * result.num_batches);
+  std::sort(batch_seconds.begin(), batch_seconds.end());
+  result.min_seconds = batch_seconds.front();
+  result.median_seconds = batch_seconds[batch_seconds.size() / 2];
+  results->push_back(result);
+
+  std::fprintf(stderr, "%-32s %-40s %.6E s\n", name.c_str(), parameters.c_str(), result.median_seconds);
+}
+
+std::vector<double> RandomVector(int size, double min, double max, UniformRandomGenerator * uniform_generator) {
+  boost::uniform_real<double> uniform_double(min, max);
+  std::vector<double> result(size);
+  for (auto& entry : result) {
+    entry = uniform_double(uniform_generator->engine);
+  }
+  return result;
+}
+
+/*!\rst
+  Cholesky, TRSM, and GEMM on ``size x size`` matrices.
+\endrst*/
+void LinearAlgebraBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult> * results) {
+  UniformRandomGenerator uniform_generator(314);
+  for (int size : {32, 64, 128, 256, 512}) {
+    const std::string parameters = "n=" + std::to_string(size);
+    // SPD matrix: A * A^T + n * I
+    const std::vector<double> random_matrix = RandomVector(size*size, -1.0, 1.0, &uniform_generator);
+    std::vector<double> spd_matrix(size*size);
+    GeneralMatrixMatrixMultiply(random_matrix.data(), 'T', random_matrix.data(), 1.0, 0.0, size, size, size,
+                                spd_matrix.data());
+    for (int i = 0; i < size; ++i) {
+      spd_matrix[i*size + i] += size;
+    }
+    std::vector<double> cholesky_factor(spd_matrix);
+    if (ComputeCholeskyFactorL(size, cholesky_factor.data()) != 0) {
+      OL_ERROR_PRINTF("benchmark matrix is not SPD (n = %d)\n", size);
+      std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<double> workspace(size*size);
+    RunBenchmark(options, "cholesky", parameters, [&]() {
+        std::copy(spd_matrix.begin(), spd_matrix.end(), workspace.begin());
+        benchmark_sink = ComputeCholeskyFactorL(size, workspace.data());
+      }, results);
+
+    // K with value + 3 derivative rows per point
+    RunBenchmark(options, "block_cholesky", parameters + " point_block_size=4", [&]() {
+        std::copy(spd_matrix.begin(), spd_matrix.end(), workspace.begin());
+        benchmark_sink = ComputeBlockCholeskyFactorL(size, 4, workspace.data());
+      }, results);
+
+    RunBenchmark(options, "trsm", parameters + " nrhs=" + std::to_string(size), [&]() {
+        std::copy(random_matrix.begin(), random_matrix.end(), workspace.begin());
+        TriangularMatrixMatrixSolve(cholesky_factor.data(), 'N', size, size, size, workspace.data());
+        benchmark_sink = workspace[0];
+      }, results);
+
+    RunBenchmark(options, "gemm", parameters, [&]() {
+        GeneralMatrixMatrixMultiply(random_matrix.data(), 'N', spd_matrix.data(), 1.0, 0.0, size, size, size,
+                                    workspace.data());
+        benchmark_sink = workspace[0];
+      }, results);
+  }
+}
+
+/*!\rst
+  Training covariance ``K(X, X)`` builds, without gradients and with all ``dim`` gradients observed.
+\endrst*/
+void CovarianceBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult> * results) {
+  const int dim = 3;
+  UniformRandomGenerator uniform_generator(314);
+  SquareExponential covariance(dim, 1.0, 0.8);
+  const std::vector<int> all_derivatives = {0, 1, 2};
+  for (int num_sampled : {50, 200}) {
+    const std::vector<double> points_sampled = RandomVector(dim*num_sampled, -1.0, 1.0, &uniform_generator);
+    for (int num_derivatives : {0, dim}) {
+      const int num_rows = num_sampled*(1 + num_derivatives);
+      std::vector<double> covariance_matrix(num_rows*num_rows);
+      RunBenchmark(options, "covariance_build", "dim=3 num_sampled=" + std::to_string(num_sampled) +
+                   " num_derivatives=" + std::to_string(num_derivatives), [&]() {
+          BuildMixCovarianceMatrix(covariance, points_sampled.data(), points_sampled.data(), dim, num_sampled,
+                                   num_sampled, all_derivatives.data(), num_derivatives, all_derivatives.data(),
+                                   num_derivatives, covariance_matrix.data());
+          benchmark_sink = covariance_matrix[0];
+        }, results);
+    }
+  }
+}
+
+/*!\rst
+  q,p-EI (MC), KG, and KG-MCMC values and gradients, plus the log marginal likelihood gradient.
+\endrst*/
+void AcquisitionBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult> * results) {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+  const int num_sampled = 50;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const double best_so_far = -4.0;
+
+  MockExpectedImprovementEnvironment environment;
+  environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, 0);
+  std::vector<double> lengths(dim, 1.3);
+  std::vector<double> noise_variance(1, 0.1);
+  SquareExponential covariance(dim, 2.8, lengths.data());
+  GaussianProcess gaussian_process(covariance, environment.points_sampled(), environment.points_sampled_value(),
+                                   noise_variance.data(), nullptr, 0, dim, num_sampled);
+  std::vector<double> grad(dim*num_to_sample);
+
+  // q,p-EI
+  {
+    const int num_mc_iterations = 10000;
+    const std::string parameters = "dim=3 num_sampled=50 q=2 p=1 num_mc=" + std::to_string(num_mc_iterations);
+    ExpectedImprovementEvaluator ei_evaluator(gaussian_process, num_mc_iterations, best_so_far);
+    NormalRNG normal_rng(3141);
+    ExpectedImprovementEvaluator::StateType ei_state(ei_evaluator, environment.points_to_sample(),
+                                                     environment.points_being_sampled(), num_to_sample,
+                                                     num_being_sampled, true, &normal_rng);
+    RunBenchmark(options, "qei_value", parameters, [&]() {
+        benchmark_sink = ei_evaluator.ComputeExpectedImprovement(&ei_state);
+      }, results);
+    RunBenchmark(options, "qei_gradient", parameters, [&]() {
+        ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad.data());
+        benchmark_sink = grad[0];
+      }, results);
+  }
+
+  // 1,0-EI screen of a large candidate list
+  {
+    const int num_candidates = 100000;
+    const std::string parameters = "dim=3 num_sampled=50 q=1 p=0 num_candidates=" + std::to_string(num_candidates) +
+        " threads=" + std::to_string(options.max_num_threads);
+    UniformRandomGenerator candidate_generator(2718);
+    const std::vector<double> candidates = RandomVector(dim*num_candidates, -5.0, 5.0, &candidate_generator);
+    ThreadSchedule thread_schedule(options.max_num_threads, omp_sched_static);
+    std::vector<NormalRNG> normal_rng_vec(options.max_num_threads);
+    std::vector<double> function_values(num_candidates);
+    std::vector<double> best_next_point(dim);
+    RunBenchmark(options, "ei_point_list", parameters, [&]() {
+        bool found_flag = false;
+        EvaluateEIAtPointList(gaussian_process, thread_schedule, candidates.data(), nullptr, num_candidates, 1, 0,
+                              best_so_far, 0, &found_flag, normal_rng_vec.data(), function_values.data(),
+                              best_next_point.data());
+        benchmark_sink = best_next_point[0];
+      }, results);
+  }
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-5.0, 5.0));
+  DomainType domain(domain_bounds.data(), dim);
+  GradientDescentParameters inner_parameters(1, 50, 1, 10, 0.7, 1.0, 0.7, 1.0e-1);
+  const int num_pts = 10;
+  const int num_mc_iterations = 16;
+  UniformRandomGenerator uniform_generator(314);
+
+  // KG
+  {
+    const std::string parameters = "dim=3 num_sampled=50 q=2 p=1 num_pts=10 num_mc=" +
+        std::to_string(num_mc_iterations);
+    const std::vector<double> discrete_pts = RandomVector(dim*num_pts, -5.0, 5.0, &uniform_generator);
+    KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, 0, discrete_pts.data(), num_pts,
+                                                        num_mc_iterations, domain, inner_parameters, best_so_far,
+                                                        KnowledgeGradientInnerMode::kGradientDescent, 0, 1);
+    NormalRNG normal_rng(3141);
+    KnowledgeGradientEvaluator<DomainType>::StateType kg_state(kg_evaluator, environment.points_to_sample(),
+                                                               environment.points_being_sampled(), num_to_sample,
+                                                               num_being_sampled, num_pts, nullptr, 0, true,
+                                                               &normal_rng);
+    RunBenchmark(options, "kg_value", parameters, [&]() {
+        benchmark_sink = kg_evaluator.ComputeKnowledgeGradient(&kg_state);
+      }, results);
+    RunBenchmark(options, "kg_gradient", parameters, [&]() {
+        kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad.data());
+        benchmark_sink = grad[0];
+      }, results);
+  }
+
+  // KG-MCMC
+  {
+    const int num_mcmc = 4;
+    const std::string parameters = "dim=3 num_sampled=50 q=2 p=1 num_pts=10 num_mc=" +
+        std::to_string(num_mc_iterations) + " num_mcmc=" + std::to_string(num_mcmc) + " threads=" +
+        std::to_string(options.max_num_threads);
+    std::vector<double> hypers_mcmc(num_mcmc*(dim + 1));
+    std::vector<double> noises_mcmc(num_mcmc);
+    for (int i = 0; i < num_mcmc; ++i) {
+      hypers_mcmc[i*(dim + 1)] = 2.0 + 0.2*i;
+      for (int d = 0; d < dim; ++d) {
+        hypers_mcmc[i*(dim + 1) + 1 + d] = 1.0 + 0.1*i + 0.05*d;
+      }
+      noises_mcmc[i] = 0.1 + 0.01*i;
+    }
+    GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc,
+                                              environment.points_sampled(), environment.points_sampled_value(),
+                                              nullptr, 0, dim, num_sampled, options.max_num_threads);
+    const std::vector<double> discrete_pts = RandomVector(dim*num_pts*num_mcmc, -5.0, 5.0, &uniform_generator);
+    std::vector<double> best_so_far_mcmc(num_mcmc, best_so_far);
+    std::vector<KnowledgeGradientEvaluator<DomainType>> kg_evaluator_lst;
+    KnowledgeGradientMCMCEvaluator<DomainType> kg_evaluator(gaussian_process_mcmc, 0, discrete_pts.data(), num_pts,
+                                                            num_mc_iterations, domain, inner_parameters,
+                                                            best_so_far_mcmc.data(), &kg_evaluator_lst,
+                                                            options.max_num_threads);
+    NormalRNG normal_rng(3141);
+    std::vector<KnowledgeGradientEvaluator<DomainType>::StateType> kg_state_lst;
+    KnowledgeGradientMCMCEvaluator<DomainType>::StateType kg_state(kg_evaluator, environment.points_to_sample(),
+                                                                   environment.points_being_sampled(), num_to_sample,
+                                                                   num_being_sampled, num_pts, nullptr, 0, true,
+                                                                   &normal_rng, &kg_state_lst);
+    RunBenchmark(options, "kg_mcmc_value", parameters, [&]() {
+        benchmark_sink = kg_evaluator.ComputeKnowledgeGradient(&kg_state);
+      }, results);
+    RunBenchmark(options, "kg_mcmc_gradient", parameters, [&]() {
+        kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad.data());
+        benchmark_sink = grad[0];
+      }, results);
+  }
+
+  // log marginal likelihood gradient
+  for (int num_sampled_likelihood : {50, 200}) {
+    MockExpectedImprovementEnvironment likelihood_environment;
+    likelihood_environment.Initialize(dim, 1, 0, num_sampled_likelihood, 0);
+    LogMarginalLikelihoodEvaluator log_likelihood_eval(likelihood_environment.points_sampled(),
+                                                       likelihood_environment.points_sampled_value(), nullptr, 0,
+                                                       dim, num_sampled_likelihood);
+    LogMarginalLikelihoodState log_likelihood_state(log_likelihood_eval, covariance, noise_variance);
+    std::vector<double> grad_log_likelihood(log_likelihood_state.GetProblemSize());
+    RunBenchmark(options, "log_likelihood_gradient", "dim=3 num_sampled=" + std::to_string(num_sampled_likelihood),
+                 [&]() {
+        log_likelihood_eval.ComputeGradLogLikelihood(&log_likelihood_state, grad_log_likelihood.data());
+        benchmark_sink = grad_log_likelihood[0];
+      }, results);
+  }
+
+}
+
+/*!\rst
+  One full multistart KG suggestion: LHC-seeded gradient descent on KG, each KG evaluation solving its inner problems.
+\endrst*/
+void SuggestionBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult> * results) {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_to_sample = 1;
+  const int num_being_sampled = 0;
+  const int num_pts = 10;
+  const int num_mc_iterations = 8;
+  const int num_lhc_samples = 20;
+  const double best_so_far = -4.0;
+
+  MockExpectedImprovementEnvironment environment;
+  environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, 0);
+  std::vector<double> noise_variance(1, 0.1);
+  SquareExponential covariance(dim, 2.8, 1.3);
+  GaussianProcess gaussian_process(covariance, environment.points_sampled(), environment.points_sampled_value(),
+                                   noise_variance.data(), nullptr, 0, dim, num_sampled);
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-5.0, 5.0));
+  DomainType domain(domain_bounds.data(), dim);
+  GradientDescentParameters outer_parameters(4, 20, 1, 5, 0.7, 1.0, 0.7, 1.0e-3);
+  GradientDescentParameters inner_parameters(1, 50, 1, 10, 0.7, 1.0, 0.7, 1.0e-1);
+  ThreadSchedule thread_schedule(options.max_num_threads, omp_sched_dynamic);
+
+  UniformRandomGenerator setup_generator(314);
+  const std::vector<double> discrete_pts = RandomVector(dim*num_pts, -5.0, 5.0, &setup_generator);
+  std::vector<double> best_points_to_sample(dim*num_to_sample);
+
+  UniformRandomGenerator uniform_generator(314);
+  std::vector<NormalRNG> normal_rng_vec(options.max_num_threads);
+  RunBenchmark(options, "kg_multistart_suggestion", "dim=3 num_sampled=20 q=1 p=0 num_pts=10 num_mc=8 multistarts=4 "
+               "threads=" + std::to_string(options.max_num_threads), [&]() {
+      // reseed so every call does the same work
+      uniform_generator.SetExplicitSeed(314);
+      for (int i = 0; i < options.max_num_threads; ++i) {
+        normal_rng_vec[i].SetExplicitSeed(3141 + i);
+      }
+      bool found_flag = false;
+      ComputeKGOptimalPointsToSample(gaussian_process, 0, outer_parameters, inner_parameters, domain, domain,
+                                     thread_schedule, environment.points_being_sampled(), discrete_pts.data(),
+                                     num_to_sample, num_being_sampled, num_pts, best_so_far, num_mc_iterations,
+                                     false, num_lhc_samples, &found_flag, &uniform_generator, normal_rng_vec.data(),
+                                     best_points_to_sample.data());
+      benchmark_sink = best_points_to_sample[0];
+    }, results);
+}
+
+void WriteJson(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options, std::FILE * file) {
+  std::fprintf(file, "{\n  \"context\": {\"max_num_threads\": %d, \"min_time\": %.6g, \"blas\": %s, \"profiling\": %s},\n",
+               options.max_num_threads, options.min_time,
+#ifdef OL_BLAS_ENABLED
+               "true",
+#else
+               "false",
+#endif
+               kProfilingEnabled ? "true" : "false");
+  std::fprintf(file, "  \"benchmarks\": [\n");
+  for (std::vector<BenchmarkResult>::size_type i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    std::fprintf(file, "    {\"name\": \"%s\", \"parameters\": \"%s\", \"calls_per_batch\": %d, \"num_batches\": %d, "
+                 "\"min_seconds\": %.9E, \"median_seconds\": %.9E, \"mean_seconds\": %.9E}%s\n",
+                 result.name.c_str(), result.parameters.c_str(), result.calls_per_batch, result.num_batches,
+                 result.min_seconds, result.median_seconds, result.mean_seconds,
+                 i + 1 < results.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+}
+
+void WriteCsv(const std::vector<BenchmarkResult>& results, std::FILE * file) {
+  std::fprintf(file, "name,parameters,calls_per_batch,num_batches,min_seconds,median_seconds,mean_seconds\n");
+  for (const auto& result : results) {
+    std::fprintf(file, "%s,\"%s\",%d,%d,%.9E,%.9E,%.9E\n", result.name.c_str(), result.parameters.c_str(),
+                 result.calls_per_batch, result.num_batches, result.min_seconds, result.median_seconds,
+                 result.mean_seconds);
+  }
+}
+
+//! \return true and sets ``*value`` if ``argument`` is ``--flag=value``
+bool ParseFlag(const char * argument, const char * flag, std::string * value) {
+  const std::size_t length = std::strlen(flag);
+  if (std::strncmp(argument, flag, length) == 0 && argument[length] == '=') {
+    *value = argument + length + 1;
+    return true;
+  }
+  return false;
+}
+
+}  // end unnamed namespace
+
+int main(int argc, char ** argv) {
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; ++i) {
+    std::string value;
+    if (ParseFlag(argv[i], "--format", &value) && (value == "json" || value == "csv")) {
+      options.csv = value == "csv";
+    } else if (ParseFlag(argv[i], "--output", &value)) {
+      options.output = value;
+    } else if (ParseFlag(argv[i], "--filter", &value)) {
+      options.filter = value;
+    } else if (ParseFlag(argv[i], "--min-time", &value)) {
+      options.min_time = std::atof(value.c_str());
+    } else if (ParseFlag(argv[i], "--threads", &value) && std::atoi(value.c_str()) > 0) {
+      options.max_num_threads = std::atoi(value.c_str());
+    } else {
+      std::fprintf(stderr, "usage: %s [--format=json|csv] [--output=FILE] [--filter=SUBSTRING] [--min-time=SECONDS] "
+                   "[--threads=N]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<BenchmarkResult> results;
+  LinearAlgebraBenchmarks(options, &results);
+  CovarianceBenchmarks(options, &results);
+  AcquisitionBenchmarks(options, &results);
+  SuggestionBenchmarks(options, &results);
+
+  std::FILE * file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "could not open %s\n", options.output.c_str());
+    return EXIT_FAILURE;
+  }
+  if (options.csv) {
+    WriteCsv(results, file);
+  } else {
+    WriteJson(results, options, file);
+  }
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
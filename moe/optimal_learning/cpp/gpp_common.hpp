@@ -679,6 +679,20 @@ namespace optimal_learning {
 #define OL_NORETURN
 #endif
 
+/*!\rst
+  gcc macro to compile AVX-512 and AVX2 clones of a (vectorizable) hot loop next to the baseline version; the dynamic
+  loader picks the best clone the running CPU supports.  This keeps wide vector code available when the library is
+  built without ``-march=native`` (e.g., on OS X, see CMakeLists.txt) or for a machine older than the one it runs on.
+
+  Requires ifunc support (gcc >= 6 on x86-64 ELF targets); elsewhere it expands to nothing and only the baseline is built.
+\endrst*/
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) && (__GNUC__ >= 6) && \
+    defined(__x86_64__) && defined(__ELF__)
+#define OL_TARGET_CLONES_AVX __attribute__((__target_clones__("avx512f", "avx2", "default")))
+#else
+#define OL_TARGET_CLONES_AVX
+#endif
+
 /*!\rst
   icc ``C++11`` support before v14.x.x is incomplete and does not support the ``override`
   or ``final`` specifiers (although "final" appears to work). See:
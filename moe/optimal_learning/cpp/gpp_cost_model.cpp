@@ -0,0 +1,226 @@
+/*!
+  \file gpp_cost_model.cpp
+  \rst
+  Implementations of the cost models in gpp_cost_model.hpp.
+\endrst*/
+
+#include "gpp_cost_model.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_math.hpp"
+
+namespace optimal_learning {
+
+FidelityProductCostModel::FidelityProductCostModel(int dim, int num_fidelity)
+    : dim_(dim), num_fidelity_(num_fidelity) {
+  if (unlikely(num_fidelity_ < 0 || num_fidelity_ > dim_)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "num_fidelity must be in [0, dim].", num_fidelity_, 0, dim_);
+  }
+}
+
+void FidelityProductCostModel::ComputeCostOfPoints(double const * restrict points, int num_points,
+                                                   double * restrict cost) const {
+  for (int i = 0; i < num_points; ++i) {
+    double point_cost = 1.0;
+    for (int j = dim_ - num_fidelity_; j < dim_; ++j) {
+      point_cost *= points[i*dim_ + j];
+    }
+    cost[i] = point_cost;
+  }
+}
+
+void FidelityProductCostModel::ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                                       double * restrict grad_cost) const {
+  std::fill(grad_cost, grad_cost + dim_*num_points, 0.0);
+  for (int i = 0; i < num_points; ++i) {
+    double const * restrict point = points + i*dim_;
+    // product of the other fidelity coordinates, so that a coordinate at 0 has a well-defined derivative
+    for (int j = dim_ - num_fidelity_; j < dim_; ++j) {
+      double partial = 1.0;
+      for (int k = dim_ - num_fidelity_; k < dim_; ++k) {
+        if (k != j) {
+          partial *= point[k];
+        }
+      }
+      grad_cost[i*dim_ + j] = partial;
+    }
+  }
+}
+
+CostModelInterface * FidelityProductCostModel::Clone() const {
+  return new FidelityProductCostModel(*this);
+}
+
+GaussianProcessCostModel::GaussianProcessCostModel(const GaussianProcess& gaussian_process, bool log_cost)
+    : gaussian_process_(gaussian_process.Clone()), log_cost_(log_cost) {
+}
+
+void GaussianProcessCostModel::ComputeCostOfPoints(double const * restrict points, int num_points,
+                                                   double * restrict cost) const {
+  // callers (e.g., the KG evaluators) already run in parallel, so the batch is predicted on the calling thread
+  const int max_num_threads = 1;
+  std::vector<double> variance_of_points(num_points);
+  gaussian_process_->PredictMarginals(points, num_points, max_num_threads, cost, variance_of_points.data());
+  if (log_cost_) {
+    for (int i = 0; i < num_points; ++i) {
+      cost[i] = std::exp(cost[i]);
+    }
+  }
+}
+
+void GaussianProcessCostModel::ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                                       double * restrict grad_cost) const {
+  const int dim = gaussian_process_->dim();
+  const int num_to_sample = 1;
+  const int num_derivatives = 1;
+  PointsToSampleState points_to_sample_state(*gaussian_process_, points, num_to_sample, nullptr, 0, num_derivatives);
+  for (int i = 0; i < num_points; ++i) {
+    if (i > 0) {
+      points_to_sample_state.SetupState(*gaussian_process_, points + i*dim, num_to_sample, 0, num_derivatives);
+    }
+    double * restrict grad_point_cost = grad_cost + i*dim;
+    gaussian_process_->ComputeGradMeanOfPoints(points_to_sample_state, grad_point_cost);
+    if (log_cost_) {
+      double mean;
+      gaussian_process_->ComputeMeanOfPoints(points_to_sample_state, &mean);
+      const double point_cost = std::exp(mean);
+      for (int d = 0; d < dim; ++d) {
+        grad_point_cost[d] *= point_cost;
+      }
+    }
+  }
+}
+
+CostModelInterface * GaussianProcessCostModel::Clone() const {
+  return new GaussianProcessCostModel(*gaussian_process_, log_cost_);
+}
+
+TabulatedCostModel::TabulatedCostModel(int dim, int num_fidelity, int const * restrict num_grid_points,
+                                       double const * restrict grid_points, double const * restrict table)
+    : dim_(dim),
+      num_fidelity_(num_fidelity),
+      num_grid_points_(num_grid_points, num_grid_points + std::max(num_fidelity, 0)),
+      grid_offsets_(std::max(num_fidelity, 0)),
+      table_strides_(std::max(num_fidelity, 0)) {
+  if (unlikely(num_fidelity_ < 1 || num_fidelity_ > dim_)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "num_fidelity must be in [1, dim].", num_fidelity_, 1, dim_);
+  }
+
+  int num_points_total = 0;
+  int table_size = 1;
+  for (int f = 0; f < num_fidelity_; ++f) {
+    if (unlikely(num_grid_points_[f] < 2)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "Each fidelity coordinate needs at least 2 grid points.",
+                         num_grid_points_[f], 2);
+    }
+    grid_offsets_[f] = num_points_total;
+    table_strides_[f] = table_size;
+    num_points_total += num_grid_points_[f];
+    table_size *= num_grid_points_[f];
+  }
+
+  grid_points_.assign(grid_points, grid_points + num_points_total);
+  for (int f = 0; f < num_fidelity_; ++f) {
+    double const * restrict axis = grid_points_.data() + grid_offsets_[f];
+    for (int i = 1; i < num_grid_points_[f]; ++i) {
+      if (unlikely(!(axis[i] > axis[i-1]))) {
+        OL_THROW_EXCEPTION(LowerBoundException<double>, "Grid points must be strictly increasing.", axis[i],
+                           axis[i-1]);
+      }
+    }
+  }
+  table_.assign(table, table + table_size);
+}
+
+void TabulatedCostModel::LocateInGrid(double const * restrict point, int * restrict cell_offset,
+                                      double * restrict weight, double * restrict inverse_width) const noexcept {
+  *cell_offset = 0;
+  for (int f = 0; f < num_fidelity_; ++f) {
+    const double coordinate = point[dim_ - num_fidelity_ + f];
+    double const * restrict axis = grid_points_.data() + grid_offsets_[f];
+    const int num_axis_points = num_grid_points_[f];
+    // cell [axis[cell], axis[cell+1]) containing coordinate; the last cell also owns its upper end
+    const int cell = std::min(std::max(static_cast<int>(std::upper_bound(axis, axis + num_axis_points, coordinate) -
+                                                        axis) - 1, 0), num_axis_points - 2);
+    const double width = axis[cell+1] - axis[cell];
+    const double position = (coordinate - axis[cell])/width;
+    if (position < 0.0 || position > 1.0) {
+      weight[f] = std::min(std::max(position, 0.0), 1.0);
+      inverse_width[f] = 0.0;
+    } else {
+      weight[f] = position;
+      inverse_width[f] = 1.0/width;
+    }
+    *cell_offset += cell*table_strides_[f];
+  }
+}
+
+void TabulatedCostModel::ComputeCostOfPoints(double const * restrict points, int num_points,
+                                             double * restrict cost) const {
+  const int num_corners = 1 << num_fidelity_;
+  std::vector<double> weight(num_fidelity_);
+  std::vector<double> inverse_width(num_fidelity_);
+  for (int i = 0; i < num_points; ++i) {
+    int cell_offset;
+    LocateInGrid(points + i*dim_, &cell_offset, weight.data(), inverse_width.data());
+    double point_cost = 0.0;
+    for (int corner = 0; corner < num_corners; ++corner) {
+      double corner_weight = 1.0;
+      int table_index = cell_offset;
+      for (int f = 0; f < num_fidelity_; ++f) {
+        if ((corner >> f) & 1) {
+          corner_weight *= weight[f];
+          table_index += table_strides_[f];
+        } else {
+          corner_weight *= 1.0 - weight[f];
+        }
+      }
+      point_cost += corner_weight*table_[table_index];
+    }
+    cost[i] = point_cost;
+  }
+}
+
+void TabulatedCostModel::ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                                 double * restrict grad_cost) const {
+  const int num_corners = 1 << num_fidelity_;
+  std::vector<double> weight(num_fidelity_);
+  std::vector<double> inverse_width(num_fidelity_);
+  std::fill(grad_cost, grad_cost + dim_*num_points, 0.0);
+  for (int i = 0; i < num_points; ++i) {
+    int cell_offset;
+    LocateInGrid(points + i*dim_, &cell_offset, weight.data(), inverse_width.data());
+    double * restrict grad_fidelity = grad_cost + i*dim_ + dim_ - num_fidelity_;
+    for (int corner = 0; corner < num_corners; ++corner) {
+      int table_index = cell_offset;
+      for (int f = 0; f < num_fidelity_; ++f) {
+        if ((corner >> f) & 1) {
+          table_index += table_strides_[f];
+        }
+      }
+      // d/dx_f of this corner's weight: the other coordinates' weights times +-1/width along f
+      for (int f = 0; f < num_fidelity_; ++f) {
+        double corner_weight = ((corner >> f) & 1) ? inverse_width[f] : -inverse_width[f];
+        for (int g = 0; g < num_fidelity_; ++g) {
+          if (g != f) {
+            corner_weight *= ((corner >> g) & 1) ? weight[g] : 1.0 - weight[g];
+          }
+        }
+        grad_fidelity[f] += corner_weight*table_[table_index];
+      }
+    }
+  }
+}
+
+CostModelInterface * TabulatedCostModel::Clone() const {
+  return new TabulatedCostModel(*this);
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,247 @@
+/*!
+  \file gpp_cost_model.hpp
+  \rst
+  1. OVERVIEW
+  2. MODELS
+  3. USE IN KNOWLEDGE GRADIENT
+
+  **1. OVERVIEW**
+
+  Multi-fidelity optimization divides an acquisition function by the cost of the samples it proposes, so that a cheap,
+  low-fidelity sample can beat an expensive, high-fidelity one.  CostModelInterface is the extension point for that
+  cost: it evaluates the (positive) cost of a batch of points, and the gradient of each point's cost wrt that point,
+  in one call.  Points have the full spatial dimension; the fidelity parameters are the last ``num_fidelity``
+  coordinates (as in KnowledgeGradientMCMCEvaluator).
+
+  **2. MODELS**
+
+  a. FidelityProductCostModel: the product of the fidelity coordinates.  This is the fixed cost previously built
+     into KnowledgeGradientMCMCEvaluator; with ``num_fidelity = 0`` every point costs 1.
+  b. GaussianProcessCostModel: the posterior mean of a GaussianProcess fit to observed costs (or, more usefully, to
+     log-costs, e.g., log-runtime, in which case the cost is ``exp(\mu(x))``).  Values come from
+     GaussianProcess::PredictMarginals(), so a batch shares its covariance tiles and triangular solves.
+  c. TabulatedCostModel: costs tabulated on a tensor grid over the fidelity coordinates (e.g., measured runtimes at
+     a few training-set sizes and epoch counts), multilinearly interpolated between grid points and held constant
+     outside the grid.
+
+  **3. USE IN KNOWLEDGE GRADIENT**
+
+  KnowledgeGradientMCMCEvaluator takes an optional CostModelInterface (FidelityProductCostModel by default) and
+  divides KG by the largest cost among the ``q`` points to sample; see KnowledgeGradientMCMCEvaluator::ComputeCost().
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_math.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Abstract class for the cost of sampling a point.  Implementations are immutable after construction, so a single
+  object may be shared (by const reference) across threads.
+\endrst*/
+class CostModelInterface {
+ public:
+  virtual ~CostModelInterface() = default;
+
+  /*!\rst
+    \return
+      the spatial dimension of the points this model accepts
+  \endrst*/
+  virtual int dim() const noexcept OL_WARN_UNUSED_RESULT = 0;
+
+  /*!\rst
+    Computes the cost of each point.
+
+    \param
+      :points[dim][num_points]: points at which to evaluate the cost
+      :num_points: number of points
+    \output
+      :cost[num_points]: cost of each point
+  \endrst*/
+  virtual void ComputeCostOfPoints(double const * restrict points, int num_points,
+                                   double * restrict cost) const OL_NONNULL_POINTERS = 0;
+
+  /*!\rst
+    Computes the gradient of each point's cost wrt that point's coordinates (a point's cost does not depend on the
+    other points).
+
+    \param
+      :points[dim][num_points]: points at which to evaluate the gradient of the cost
+      :num_points: number of points
+    \output
+      :grad_cost[dim][num_points]: ``grad_cost[d][i]`` is ``\pderiv{cost(x_i)}{x_{d,i}}``
+  \endrst*/
+  virtual void ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                       double * restrict grad_cost) const OL_NONNULL_POINTERS = 0;
+
+  /*!\rst
+    For implementing the virtual (copy) constructor idiom.
+
+    \return
+      Pointer to a constructed object that is a subclass of CostModelInterface
+  \endrst*/
+  virtual CostModelInterface * Clone() const OL_WARN_UNUSED_RESULT = 0;
+};
+
+/*!\rst
+  ``cost(x) = \prod_{j = dim - num_fidelity}^{dim - 1} x_j``, the product of the fidelity coordinates.
+\endrst*/
+class FidelityProductCostModel final : public CostModelInterface {
+ public:
+  /*!\rst
+    \param
+      :dim: spatial dimension of a point (including the fidelity coordinates)
+      :num_fidelity: number of trailing coordinates of a point that are fidelity parameters
+    \raise
+      BoundsException if ``num_fidelity`` is not in ``[0, dim]``
+  \endrst*/
+  FidelityProductCostModel(int dim, int num_fidelity);
+
+  virtual int dim() const noexcept override OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_fidelity() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_fidelity_;
+  }
+
+  virtual void ComputeCostOfPoints(double const * restrict points, int num_points,
+                                   double * restrict cost) const override OL_NONNULL_POINTERS;
+
+  virtual void ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                       double * restrict grad_cost) const override OL_NONNULL_POINTERS;
+
+  virtual CostModelInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+ private:
+  //! spatial dimension of a point
+  int dim_;
+  //! number of trailing fidelity coordinates
+  int num_fidelity_;
+};
+
+/*!\rst
+  The posterior mean of a GaussianProcess fit to observed costs: ``cost(x) = \mu(x)`` or, if ``log_cost``,
+  ``cost(x) = exp(\mu(x))`` (the GP was fit to log-costs, which keeps the cost positive).
+
+  Costs are computed with GaussianProcess::PredictMarginals().  Gradients use ComputeGradMeanOfPoints() one point at a
+  time (so duplicate points are allowed); ``\nabla exp(\mu) = exp(\mu) \nabla \mu``.
+\endrst*/
+class GaussianProcessCostModel final : public CostModelInterface {
+ public:
+  /*!\rst
+    \param
+      :gaussian_process: GP fit to observed (log-)costs over full-dimensional points; this model keeps its own copy
+      :log_cost: true if ``gaussian_process`` models ``log(cost)``
+  \endrst*/
+  GaussianProcessCostModel(const GaussianProcess& gaussian_process, bool log_cost);
+
+  virtual int dim() const noexcept override OL_WARN_UNUSED_RESULT {
+    return gaussian_process_->dim();
+  }
+
+  const GaussianProcess& gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return *gaussian_process_;
+  }
+
+  bool log_cost() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return log_cost_;
+  }
+
+  virtual void ComputeCostOfPoints(double const * restrict points, int num_points,
+                                   double * restrict cost) const override OL_NONNULL_POINTERS;
+
+  virtual void ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                       double * restrict grad_cost) const override OL_NONNULL_POINTERS;
+
+  virtual CostModelInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+ private:
+  //! GP over the (log-)costs
+  std::unique_ptr<GaussianProcess> gaussian_process_;
+  //! true if gaussian_process_ models log(cost)
+  bool log_cost_;
+};
+
+/*!\rst
+  Costs tabulated on a tensor grid over the fidelity coordinates and interpolated multilinearly (piecewise-linear in
+  each fidelity coordinate; the non-fidelity coordinates are ignored).  Outside the grid, each coordinate is clamped
+  to the grid's range, so the cost is constant there and its gradient is 0.
+
+  In each cell, the cost is a sum over the cell's ``2^num_fidelity`` corners, so evaluation costs
+  ``O(num_fidelity*(log(num_grid_points) + 2^num_fidelity))`` per point.  On a grid line (where the cost is only
+  one-sided differentiable), the gradient is that of the cell above the line (below it, at the top of the grid).
+\endrst*/
+class TabulatedCostModel final : public CostModelInterface {
+ public:
+  /*!\rst
+    \param
+      :dim: spatial dimension of a point (including the fidelity coordinates)
+      :num_fidelity: number of trailing coordinates of a point that are fidelity parameters
+      :num_grid_points[num_fidelity]: number of grid points along each fidelity coordinate
+      :grid_points[sum(num_grid_points)]: strictly increasing grid points of the first fidelity coordinate, then of the
+        second, etc.
+      :table[num_grid_points[0]][num_grid_points[1]]...: positive cost at each grid node; the FIRST fidelity coordinate
+        varies fastest
+    \raise
+      BoundsException if ``num_fidelity`` is not in ``[1, dim]`` or any ``num_grid_points`` is < 2;
+      LowerBoundException if grid points are not strictly increasing
+  \endrst*/
+  TabulatedCostModel(int dim, int num_fidelity, int const * restrict num_grid_points,
+                     double const * restrict grid_points, double const * restrict table) OL_NONNULL_POINTERS;
+
+  virtual int dim() const noexcept override OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_fidelity() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_fidelity_;
+  }
+
+  virtual void ComputeCostOfPoints(double const * restrict points, int num_points,
+                                   double * restrict cost) const override OL_NONNULL_POINTERS;
+
+  virtual void ComputeGradCostOfPoints(double const * restrict points, int num_points,
+                                       double * restrict grad_cost) const override OL_NONNULL_POINTERS;
+
+  virtual CostModelInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+ private:
+  /*!\rst
+    Locates the fidelity coordinates of ``point`` in the grid.
+
+    \param
+      :point[dim]: point to locate
+    \output
+      :cell_offset[1]: table index of the cell's lowest corner
+      :weight[num_fidelity]: position of each fidelity coordinate within its cell, in ``[0, 1]``
+      :inverse_width[num_fidelity]: ``1/(cell width)`` along each fidelity coordinate; 0 where the coordinate was clamped
+  \endrst*/
+  void LocateInGrid(double const * restrict point, int * restrict cell_offset, double * restrict weight,
+                    double * restrict inverse_width) const noexcept OL_NONNULL_POINTERS;
+
+  //! spatial dimension of a point
+  int dim_;
+  //! number of trailing fidelity coordinates
+  int num_fidelity_;
+  //! number of grid points along each fidelity coordinate
+  std::vector<int> num_grid_points_;
+  //! offset of each fidelity coordinate's points in grid_points_
+  std::vector<int> grid_offsets_;
+  //! table index stride of each fidelity coordinate
+  std::vector<int> table_strides_;
+  //! grid points of every fidelity coordinate, concatenated
+  std::vector<double> grid_points_;
+  //! cost at each grid node, first fidelity coordinate fastest
+  std::vector<double> table_;
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_HPP_
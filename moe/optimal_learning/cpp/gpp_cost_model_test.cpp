@@ -0,0 +1,382 @@
+/*!
+  \file gpp_cost_model_test.cpp
+  \rst
+  Routines to test the functions in gpp_cost_model.cpp:
+
+  * FidelityProductCostModel is the product of the fidelity coordinates (1 without fidelity coordinates),
+  * TabulatedCostModel reproduces its table at the grid nodes, interpolates linearly along grid lines, and is constant
+    outside the grid,
+  * GaussianProcessCostModel matches the GP's mean (or its exponential),
+  * every model's gradient matches finite differences, and
+  * KnowledgeGradientMCMCEvaluator divides KG by its cost model's cost and differentiates that cost at the most expensive
+    point.
+\endrst*/
+
+#include "gpp_cost_model_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_cost_model.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_knowledge_gradient_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks ``cost_model``'s gradient against central differences of its cost at each of ``points``.  Also checks that
+  Clone() gives the same costs.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int CheckGradCostModel(const CostModelInterface& cost_model, double const * restrict points,
+                                             int num_points) {
+  int total_errors = 0;
+  const int dim = cost_model.dim();
+  const double epsilon = 1.0e-6;
+  std::vector<double> grad_cost(dim*num_points);
+  cost_model.ComputeGradCostOfPoints(points, num_points, grad_cost.data());
+
+  std::vector<double> perturbed_point(dim);
+  double cost_plus, cost_minus;
+  for (int i = 0; i < num_points; ++i) {
+    std::copy(points + i*dim, points + (i+1)*dim, perturbed_point.begin());
+    for (int d = 0; d < dim; ++d) {
+      perturbed_point[d] += epsilon;
+      cost_model.ComputeCostOfPoints(perturbed_point.data(), 1, &cost_plus);
+      perturbed_point[d] -= 2.0*epsilon;
+      cost_model.ComputeCostOfPoints(perturbed_point.data(), 1, &cost_minus);
+      perturbed_point[d] += epsilon;
+      const double finite_difference = (cost_plus - cost_minus)/(2.0*epsilon);
+      if (!CheckDoubleWithinRelativeWithThreshold(grad_cost[i*dim + d], finite_difference, 1.0e-6, 1.0e-7)) {
+        OL_ERROR_PRINTF("point %d, dim %d: grad cost %.18E, finite difference %.18E\n", i, d, grad_cost[i*dim + d],
+                        finite_difference);
+        ++total_errors;
+      }
+    }
+  }
+
+  std::unique_ptr<CostModelInterface> clone(cost_model.Clone());
+  std::vector<double> cost(num_points), cost_clone(num_points);
+  cost_model.ComputeCostOfPoints(points, num_points, cost.data());
+  clone->ComputeCostOfPoints(points, num_points, cost_clone.data());
+  for (int i = 0; i < num_points; ++i) {
+    if (!CheckDoubleWithinRelative(cost_clone[i], cost[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks FidelityProductCostModel's values and gradients, with and without fidelity coordinates.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int FidelityProductCostModelTest() {
+  int total_errors = 0;
+  const int dim = 4;
+  const int num_points = 3;
+  const double points[dim*num_points] = {0.3, -1.2, 0.5, 0.25,
+                                         2.0, 0.7, 1.0, 1.0,
+                                         -0.4, 1.1, 0.0, 0.8};
+
+  FidelityProductCostModel product_cost_model(dim, 2);
+  std::vector<double> cost(num_points);
+  product_cost_model.ComputeCostOfPoints(points, num_points, cost.data());
+  for (int i = 0; i < num_points; ++i) {
+    if (!CheckDoubleWithinRelative(cost[i], points[i*dim + 2]*points[i*dim + 3], 0.0)) {
+      ++total_errors;
+    }
+  }
+  // the third point has a fidelity coordinate at 0; its derivative wrt that coordinate is the other one
+  std::vector<double> grad_cost(dim*num_points);
+  product_cost_model.ComputeGradCostOfPoints(points, num_points, grad_cost.data());
+  if (!CheckDoubleWithinRelative(grad_cost[2*dim + 2], points[2*dim + 3], 0.0)) {
+    ++total_errors;
+  }
+  total_errors += CheckGradCostModel(product_cost_model, points, num_points);
+
+  FidelityProductCostModel unit_cost_model(dim, 0);
+  unit_cost_model.ComputeCostOfPoints(points, num_points, cost.data());
+  unit_cost_model.ComputeGradCostOfPoints(points, num_points, grad_cost.data());
+  for (int i = 0; i < num_points; ++i) {
+    if (!CheckDoubleWithinRelative(cost[i], 1.0, 0.0)) {
+      ++total_errors;
+    }
+  }
+  for (const auto entry : grad_cost) {
+    if (!CheckDoubleWithin(entry, 0.0, 0.0)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks TabulatedCostModel on a 3 x 4 grid over 2 fidelity coordinates: table values at the nodes, linear
+  interpolation along a grid line, clamping outside the grid, and gradients inside each cell.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int TabulatedCostModelTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_fidelity = 2;
+  const int num_grid_points[num_fidelity] = {3, 4};
+  const double grid_points[3 + 4] = {0.1, 0.5, 1.0,
+                                     1.0, 2.0, 4.0, 8.0};
+  std::vector<double> table(3*4);
+  for (int j = 0; j < 4; ++j) {
+    for (int i = 0; i < 3; ++i) {
+      table[i + 3*j] = 1.0 + i + 0.5*j*j + 0.3*i*j;
+    }
+  }
+  TabulatedCostModel tabulated_cost_model(dim, num_fidelity, num_grid_points, grid_points, table.data());
+
+  std::vector<double> point(dim, 0.7);
+  double cost;
+  for (int j = 0; j < 4; ++j) {
+    for (int i = 0; i < 3; ++i) {
+      point[1] = grid_points[i];
+      point[2] = grid_points[3 + j];
+      tabulated_cost_model.ComputeCostOfPoints(point.data(), 1, &cost);
+      if (!CheckDoubleWithinRelative(cost, table[i + 3*j], 1.0e-15)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // a quarter of the way along the first coordinate's second cell, on the third line of the second coordinate
+  point[1] = 0.625;
+  point[2] = 4.0;
+  tabulated_cost_model.ComputeCostOfPoints(point.data(), 1, &cost);
+  if (!CheckDoubleWithinRelative(cost, 0.75*table[1 + 3*2] + 0.25*table[2 + 3*2], 1.0e-14)) {
+    ++total_errors;
+  }
+
+  // beyond the grid: clamped to the nearest node, zero gradient
+  point[1] = 3.0;
+  point[2] = -1.0;
+  tabulated_cost_model.ComputeCostOfPoints(point.data(), 1, &cost);
+  if (!CheckDoubleWithinRelative(cost, table[2], 1.0e-15)) {
+    ++total_errors;
+  }
+  std::vector<double> grad_cost(dim);
+  tabulated_cost_model.ComputeGradCostOfPoints(point.data(), 1, grad_cost.data());
+  for (const auto entry : grad_cost) {
+    if (!CheckDoubleWithin(entry, 0.0, 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  // points strictly inside cells (where the interpolant is smooth), plus one clamped in a single coordinate
+  const int num_points = 4;
+  const double points[dim*num_points] = {0.3, 0.2, 1.5,
+                                         -2.0, 0.8, 3.1,
+                                         1.7, 0.45, 6.2,
+                                         0.0, 0.9, 11.0};
+  total_errors += CheckGradCostModel(tabulated_cost_model, points, num_points);
+  return total_errors;
+}
+
+/*!\rst
+  Checks GaussianProcessCostModel against the GP's mean (and its exponential, for a log-cost GP) and checks its
+  gradients, for a GP with derivative observations.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessCostModelTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 12;
+  const int num_points = 5;
+  std::vector<int> derivatives = {1};
+  const int num_derivatives = derivatives.size();
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_points, 0, num_sampled, num_derivatives);
+  std::vector<double> noise_variance(num_derivatives + 1, 1.0e-3);
+  std::vector<double> lengths(dim, 2.3);
+  SquareExponential sqexp_covariance(dim, 1.7, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), derivatives.data(),
+                                   num_derivatives, dim, num_sampled);
+
+  std::vector<double> mean(num_points);
+  PointsToSampleState points_to_sample_state(gaussian_process, EI_environment.points_to_sample(), num_points, nullptr,
+                                             0, 0);
+  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+
+  std::vector<double> cost(num_points);
+  for (const bool log_cost : {false, true}) {
+    GaussianProcessCostModel gp_cost_model(gaussian_process, log_cost);
+    gp_cost_model.ComputeCostOfPoints(EI_environment.points_to_sample(), num_points, cost.data());
+    for (int i = 0; i < num_points; ++i) {
+      if (!CheckDoubleWithinRelative(cost[i], log_cost ? std::exp(mean[i]) : mean[i], 1.0e-12)) {
+        ++total_errors;
+      }
+    }
+    total_errors += CheckGradCostModel(gp_cost_model, EI_environment.points_to_sample(), num_points);
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks that KnowledgeGradientMCMCEvaluator divides KG by its cost model: with the same normal draws, KG times the cost
+  is the same for the default (fidelity product) and a tabulated cost model, and ComputeGradCost() is the model's
+  gradient at the most expensive point to sample.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int KnowledgeGradientMCMCCostModelTest() {
+  using DomainType = TensorProductDomain;
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_fidelity = 1;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int num_sampled = 8;
+  const int num_pts = 6;
+  const int num_mc_iter = 20;
+  const int num_mcmc = 2;
+
+  MockExpectedImprovementEnvironment KG_environment;
+  KG_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, 0);
+  // positive fidelities, the second point the more expensive one
+  std::vector<double> points_to_sample(KG_environment.points_to_sample(),
+                                       KG_environment.points_to_sample() + dim*num_to_sample);
+  points_to_sample[dim - 1] = 0.4;
+  points_to_sample[2*dim - 1] = 0.7;
+
+  std::vector<double> hypers_mcmc(num_mcmc*(dim + 1));
+  std::vector<double> noises_mcmc(num_mcmc);
+  for (int i = 0; i < num_mcmc; ++i) {
+    hypers_mcmc[i*(dim + 1)] = 2.0 + 0.2*i;
+    for (int d = 0; d < dim; ++d) {
+      hypers_mcmc[i*(dim + 1) + 1 + d] = 1.0 + 0.1*i + 0.05*d;
+    }
+    noises_mcmc[i] = 0.1 + 0.01*i;
+  }
+  GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc,
+                                            KG_environment.points_sampled(), KG_environment.points_sampled_value(),
+                                            nullptr, 0, dim, num_sampled, 1);
+
+  std::vector<ClosedInterval> domain_bounds(dim - num_fidelity, ClosedInterval(-5.0, 5.0));
+  DomainType domain(domain_bounds.data(), dim - num_fidelity);
+  GradientDescentParameters gd_params(1, 50, 1, 10, 0.7, 1.0, 0.7, 1.0e-1);
+
+  UniformRandomGenerator uniform_generator(314);
+  boost::uniform_real<double> uniform_double(-5.0, 5.0);
+  std::vector<double> discrete_pts((dim - num_fidelity)*num_pts*num_mcmc);
+  for (auto& entry : discrete_pts) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+  std::vector<double> best_so_far(num_mcmc, 7.0);
+
+  const int num_grid_points[num_fidelity] = {3};
+  const double grid_points[3] = {0.0, 0.5, 1.0};
+  const double table[3] = {0.2, 1.0, 4.0};
+  TabulatedCostModel tabulated_cost_model(dim, num_fidelity, num_grid_points, grid_points, table);
+  CostModelInterface const * cost_models[2] = {nullptr, &tabulated_cost_model};
+  // fidelity product: the second point's fidelity; table: interpolated at 0.7
+  const double expected_cost[2] = {0.7, 1.0 + 0.4*(4.0 - 1.0)};
+
+  double scaled_KG[2];
+  for (int m = 0; m < 2; ++m) {
+    std::vector<KnowledgeGradientEvaluator<DomainType>> kg_evaluator_lst;
+    KnowledgeGradientMCMCEvaluator<DomainType> kg_evaluator(gaussian_process_mcmc, num_fidelity, discrete_pts.data(),
+                                                            num_pts, num_mc_iter, domain, gd_params, best_so_far.data(),
+                                                            &kg_evaluator_lst, 1, kNoGpu, cost_models[m]);
+    NormalRNG normal_rng(3141);
+    std::vector<KnowledgeGradientEvaluator<DomainType>::StateType> kg_state_lst;
+    KnowledgeGradientMCMCEvaluator<DomainType>::StateType kg_state(kg_evaluator, points_to_sample.data(),
+                                                                   KG_environment.points_being_sampled(), num_to_sample,
+                                                                   num_being_sampled, num_pts, nullptr, 0, true,
+                                                                   &normal_rng, &kg_state_lst);
+    const double cost = kg_evaluator.ComputeCost(&kg_state);
+    if (!CheckDoubleWithinRelative(cost, expected_cost[m], 1.0e-15)) {
+      ++total_errors;
+    }
+    scaled_KG[m] = kg_evaluator.ComputeKnowledgeGradient(&kg_state)*cost;
+
+    std::vector<double> grad_cost(dim*num_to_sample);
+    kg_evaluator.ComputeGradCost(&kg_state, grad_cost.data());
+    std::vector<double> grad_cost_model(dim);
+    kg_evaluator.cost_model().ComputeGradCostOfPoints(points_to_sample.data() + dim, 1, grad_cost_model.data());
+    for (int d = 0; d < dim; ++d) {
+      if (!CheckDoubleWithin(grad_cost[d], 0.0, 0.0) ||
+          !CheckDoubleWithinRelative(grad_cost[dim + d], grad_cost_model[d], 0.0)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  if (!std::isfinite(scaled_KG[0]) || !CheckDoubleWithinRelative(scaled_KG[1], scaled_KG[0], 1.0e-14)) {
+    ++total_errors;
+  }
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunCostModelTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = FidelityProductCostModelTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("fidelity product cost model failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("fidelity product cost model\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = TabulatedCostModelTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("tabulated cost model failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("tabulated cost model\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = GaussianProcessCostModelTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP cost model failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP cost model\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = KnowledgeGradientMCMCCostModelTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("KG MCMC cost models failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("KG MCMC cost models\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
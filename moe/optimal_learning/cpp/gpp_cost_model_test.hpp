@@ -0,0 +1,25 @@
+/*!
+  \file gpp_cost_model_test.hpp
+  \rst
+  Functions for testing gpp_cost_model's functionality: each cost model's values are correct, its gradients match
+  finite differences, and KnowledgeGradientMCMCEvaluator divides KG by the model's cost.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the cost model tests.
+
+  \return
+    number of test failures: 0 if cost models are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunCostModelTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_COST_MODEL_TEST_HPP_
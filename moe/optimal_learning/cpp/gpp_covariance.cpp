@@ -2,7 +2,7 @@
   \file gpp_covariance.cpp
   \rst
   This file contains function definitions for the Covariance, GradCovariance,
-  and HyperparameterGradCovariance member
+  HyperparameterGradCovariance, and HyperparameterHessianCovariance member
   functions of CovarianceInterface subclasses.  It also contains a few utilities for computing common mathematical quantities
   and initialization.
 
@@ -20,11 +20,16 @@
 
 #include <cmath>
 
+#include <algorithm>
 #include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "gpp_common.hpp"
 #include "gpp_exception.hpp"
+#include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
@@ -34,18 +39,22 @@ namespace {
   ``p1, p2 = point 1 & 2``; ``W = weight``.
   Equivalent to ``\|p1 - p2\|_2`` if all entries of W are 1.0.
 
+  ``kDim > 0`` fixes the size at compile time (so the loop unrolls); ``kDim = 0`` reads it from ``size_in``.
+
   \param
     :point_one[size]: the vector p1
     :point_two[size]: the vector p2
     :weights[size]: the vector W, i.e., the scaling to apply to each term of the norm
-    :size: number of dimensions in point
+    :size_in: number of dimensions in point
   \return
     the weighted ``L_2``-norm of the vector difference ``p1 - p2``.
 \endrst*/
+template <int kDim>
 OL_PURE_FUNCTION OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT double
 NormSquaredWithInverseWeights(double const * restrict point_one,
                               double const * restrict point_two,
-                              double const * restrict weights, int size) noexcept {
+                              double const * restrict weights, int size_in) noexcept {
+  const int size = kDim > 0 ? kDim : size_in;
   // calculates the one norm of two vectors (point_one and point_two of size size)
   double norm = 0.0;
 
@@ -92,14 +101,883 @@ OL_NONNULL_POINTERS void InitializeCovariance(int dim, double alpha,
   }
 }
 
+/*!\rst
+  Hessian block of the Square Exponential, ``\pderiv{^2 cov(x_1, x_2)}{x_{1,m} \partial x_{2,n}}``, for every pair of
+  observed derivatives.  Branch-free: the ``\delta_{mn}`` term is a select, so the loop over ``m`` (contiguous in the
+  output) vectorizes (with gathers on AVX2/AVX-512).
+
+  \param
+    :point_one[dim]: first spatial coordinate
+    :derivatives_one[num_derivatives_one]: dimensions of the derivatives observed at point_one
+    :num_derivatives_one: number of derivatives observed at point_one
+    :point_two[dim]: second spatial coordinate
+    :derivatives_two[num_derivatives_two]: dimensions of the derivatives observed at point_two
+    :num_derivatives_two: number of derivatives observed at point_two
+    :lengths_sq[dim]: squared length scales, ``L_d^2``
+    :kernel: ``cov(x_1, x_2)`` (function values only)
+    :leading_dim: distance between the starts of consecutive columns of cov_block
+  \output
+    :cov_block[leading_dim][1+num_derivatives_two]: entries ``(m+1, n+1)`` overwritten with the Hessian block
+\endrst*/
+OL_TARGET_CLONES_AVX void SquareExponentialHessianBlock(double const * restrict point_one,
+                                                        int const * restrict derivatives_one, int num_derivatives_one,
+                                                        double const * restrict point_two,
+                                                        int const * restrict derivatives_two, int num_derivatives_two,
+                                                        double const * restrict lengths_sq, double kernel,
+                                                        int leading_dim, double * restrict cov_block) noexcept {
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = (point_one[index2] - point_two[index2])/lengths_sq[index2];
+    const double diagonal_term = kernel/lengths_sq[index2];
+    double * restrict cov_col = cov_block + 1 + (n+1)*leading_dim;
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      cov_col[m] = ((point_two[index1] - point_one[index1])/lengths_sq[index1])*derivative_point_two*kernel +
+          (index1 == index2 ? diagonal_term : 0.0);
+    }
+  }
+}
+
+/*!\rst
+  Body of SquareExponential::Covariance(); ``kDim`` as in NormSquaredWithInverseWeights().
+\endrst*/
+template <int kDim>
+OL_TARGET_CLONES_AVX void SquareExponentialCovarianceKernel(double const * restrict point_one,
+                                                            int const * restrict derivatives_one,
+                                                            int num_derivatives_one,
+                                                            double const * restrict point_two,
+                                                            int const * restrict derivatives_two,
+                                                            int num_derivatives_two,
+                                                            double const * restrict lengths_sq, double alpha,
+                                                            int dim, double * restrict cov) noexcept {
+  // correct by the kernel value
+  const double norm_val = NormSquaredWithInverseWeights<kDim>(point_one, point_two, lengths_sq, dim);
+  const double kernel = alpha*std::exp(-0.5*norm_val);
+
+  cov[0] = kernel;
+
+  // the derivative factors ``(x_2 - x_1)/L^2`` are recomputed where needed (rather than kept in temporaries) so that
+  // this function does no heap allocation
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    cov[m+1] = kernel*((point_two[index1] - point_one[index1])/lengths_sq[index1]);
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    cov[(n+1)*(1+num_derivatives_one)] = kernel*((point_one[index2] - point_two[index2])/lengths_sq[index2]);
+  }
+
+  // the Hessian matrix
+  SquareExponentialHessianBlock(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                num_derivatives_two, lengths_sq, kernel, 1+num_derivatives_one, cov);
+}
+
+/*!\rst
+  Body of SquareExponential::GradCovariance(); ``kDim`` as in NormSquaredWithInverseWeights().
+
+  The output is ordered ``[dim][1+num_derivatives_one][1+num_derivatives_two]``, so each block's loop over the spatial
+  index ``i`` is unit-stride.  Those loops only compute the terms shared by every ``i``; the ``\delta_{i,index}`` terms
+  touch at most two entries per block, which are recomputed afterward with the full expression.  The inner loops are then
+  branch-free and vectorize; OL_TARGET_CLONES_AVX adds AVX2/AVX-512 builds selected at load time.
+
+  Each entry is evaluated with the same operations, in the same order, as the per-entry formula; clones may differ
+  only in the last bit, where the compiler contracts a multiply-add differently.
+\endrst*/
+template <int kDim>
+OL_TARGET_CLONES_AVX void SquareExponentialGradCovarianceKernel(double const * restrict point_one,
+                                                                int const * restrict derivatives_one,
+                                                                int num_derivatives_one,
+                                                                double const * restrict point_two,
+                                                                int const * restrict derivatives_two,
+                                                                int num_derivatives_two,
+                                                                double const * restrict lengths_sq, double alpha,
+                                                                int dim_in, double * restrict grad_cov) noexcept {
+  const int dim = kDim > 0 ? kDim : dim_in;
+  const double kernel = alpha*std::exp(-0.5*NormSquaredWithInverseWeights<kDim>(point_one, point_two, lengths_sq,
+                                                                                dim));
+  // ``(x_{2,i} - x_{1,i})/L_i^2``, evaluated on demand so that this function does no heap allocation
+  auto distance = [point_one, point_two, lengths_sq](int i) {
+    return (point_two[i] - point_one[i])/lengths_sq[i];
+  };
+  const int block_stride_two = dim*(num_derivatives_one+1);
+
+  for (int i = 0; i < dim; ++i) {
+    grad_cov[i] = distance(i)*kernel;
+  }
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const double derivative_point_one = distance(index1);
+    double * restrict grad_block = grad_cov + (m+1)*dim;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i] = distance(i)*derivative_point_one*kernel;
+    }
+    grad_block[index1] -= kernel/lengths_sq[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = -distance(index2);
+    double * restrict grad_block = grad_cov + (n+1)*block_stride_two;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i] = distance(i)*derivative_point_two*kernel;
+    }
+    grad_block[index2] += kernel/lengths_sq[index2];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = -distance(index2);
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      const double derivative_point_one = distance(index1);
+      const double product = index1 == index2 ? derivative_point_one*derivative_point_two + 1.0/lengths_sq[index1] :
+          derivative_point_one*derivative_point_two;
+      double * restrict grad_block = grad_cov + (m+1)*dim + (n+1)*block_stride_two;
+      for (int i = 0; i < dim; ++i) {
+        grad_block[i] = product*distance(i)*kernel;
+      }
+
+      auto full_entry = [&](int i) {
+        double entry = product*distance(i);
+        if (i == index1) {
+          entry -= derivative_point_two/lengths_sq[index1];
+        }
+        if (i == index2) {
+          entry += derivative_point_one/lengths_sq[index2];
+        }
+        return entry*kernel;
+      };
+      grad_block[index1] = full_entry(index1);
+      grad_block[index2] = full_entry(index2);
+    }
+  }
+}
+
+/*!\rst
+  Body of SquareExponential::HyperparameterGradCovariance(); ``kDim`` as in NormSquaredWithInverseWeights().
+
+  Same structure as SquareExponentialGradCovarianceKernel(): per block, a branch-free unit-stride loop over the length
+  scales computes the common ``cov * ((x_{1,i} - x_{2,i})/L_i)^2/L_i`` term, then the (at most two) entries with
+  ``i`` equal to an observed derivative's dimension are corrected in scalar code, in the per-entry formula's order.
+\endrst*/
+template <int kDim>
+OL_TARGET_CLONES_AVX void SquareExponentialHyperparameterGradCovarianceKernel(double const * restrict point_one,
+                                                                              int const * restrict derivatives_one,
+                                                                              int num_derivatives_one,
+                                                                              double const * restrict point_two,
+                                                                              int const * restrict derivatives_two,
+                                                                              int num_derivatives_two,
+                                                                              double const * restrict lengths,
+                                                                              double const * restrict lengths_sq,
+                                                                              double alpha, int dim_in,
+                                                                              double * restrict grad_hyperparameter_cov) noexcept {
+  const int dim = kDim > 0 ? kDim : dim_in;
+  const double kernel = alpha*std::exp(-0.5*NormSquaredWithInverseWeights<kDim>(point_one, point_two, lengths_sq,
+                                                                                dim));
+  // entries of Covariance(point_one, point_two) are evaluated on demand (instead of into a temporary) so this function,
+  // which runs once per pair of points when building hyperparameter gradients, does no heap allocation
+  auto covariance_entry = [&](int m, int n) {
+    // m, n index the [1+num_derivatives_one][1+num_derivatives_two] covariance block; 0 is the function value
+    if (m == 0 && n == 0) {
+      return kernel;
+    }
+    const int index1 = m > 0 ? derivatives_one[m-1] : 0;
+    const int index2 = n > 0 ? derivatives_two[n-1] : 0;
+    if (n == 0) {
+      return kernel*((point_two[index1] - point_one[index1])/lengths_sq[index1]);
+    }
+    if (m == 0) {
+      return kernel*((point_one[index2] - point_two[index2])/lengths_sq[index2]);
+    }
+    double entry = ((point_two[index1] - point_one[index1])/lengths_sq[index1])*
+        ((point_one[index2] - point_two[index2])/lengths_sq[index2])*kernel;
+    if (index1 == index2) {
+      entry += kernel/lengths_sq[index2];
+    }
+    return entry;
+  };
+  // fills one [dim+1] block: d/d\alpha, then the length-scale terms shared by every dimension
+  auto fill_block = [=](double cov_entry, double * restrict grad_block) {
+    grad_block[0] = cov_entry/alpha;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i+1] = cov_entry*Square((point_one[i] - point_two[i])/lengths[i])/lengths[i];
+    }
+  };
+  const int block_stride_two = (dim+1)*(num_derivatives_one+1);
+
+  // deriv wrt alpha does not have the same form as the length terms, special case it
+  fill_block(kernel, grad_hyperparameter_cov);
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    double * restrict grad_block = grad_hyperparameter_cov + (m+1)*(dim+1);
+    fill_block(covariance_entry(m+1, 0), grad_block);
+    grad_block[index1+1] -= (2*kernel*(point_two[index1]-point_one[index1])/lengths_sq[index1])/lengths[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    double * restrict grad_block = grad_hyperparameter_cov + (n+1)*block_stride_two;
+    fill_block(covariance_entry(0, n+1), grad_block);
+    grad_block[index2+1] -= (2*kernel*(point_one[index2]-point_two[index2])/lengths_sq[index2])/lengths[index2];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double cov_n = covariance_entry(0, n+1);
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      const double cov_m = covariance_entry(m+1, 0);
+      double * restrict grad_block = grad_hyperparameter_cov + (m+1)*(dim+1) + (n+1)*block_stride_two;
+      fill_block(covariance_entry(m+1, n+1), grad_block);
+      if (index1 == index2) {
+        const int i = index1;
+        grad_block[i+1] += ((4*kernel*Square(point_one[i]-point_two[i])/lengths_sq[i])/lengths_sq[i])/lengths[i];
+        grad_block[i+1] -= (2*kernel/lengths_sq[i])/lengths[i];
+      } else {
+        grad_block[index1+1] -= (2*cov_n*(point_two[index1]-point_one[index1])/lengths_sq[index1])/lengths[index1];
+        grad_block[index2+1] -= (2*cov_m*(point_one[index2]-point_two[index2])/lengths_sq[index2])/lengths[index2];
+      }
+    }
+  }
+}
+
+/*!\rst
+  A radial kernel ``f(r) = \alpha k(r)``, ``r = \|L^{-1}(x_1 - x_2)\|_2``, and the derivatives needed to differentiate it
+  through the length-scaled distance.  Every covariance block (and its spatial/hyperparameter gradients) of a radial
+  kernel with gradient observations is a polynomial in ``v_i = (x_{1,i} - x_{2,i})/L_i^2`` with these coefficients, so
+  the Matern kernels share their block code (the Radial* functions below) and differ only in a ``struct`` providing
+  ``Value(r, alpha)`` (``f`` only) and ``Evaluate(r, alpha)`` (all of RadialKernelValues).
+\endrst*/
+struct RadialKernelValues {
+  //! ``f(r)``, the covariance
+  double f;
+  //! ``g(r) = f'(r)/r``
+  double g;
+  //! ``h(r) = g'(r)/r``
+  double h;
+  //! ``q(r) = h'(r)/r``
+  double q;
+};
+
+/*!\rst
+  Distances below this are treated as 0 in the (removable or direction-dependent) ``1/r`` singularities of
+  RadialKernelValues; the terms they multiply vanish as ``r \rightarrow 0``.
+\endrst*/
+static constexpr double kMinimumRadialDistance = 1.0e-100;
+
+/*!\rst
+  Matern ``\nu = 3/2``: ``f = \alpha (1 + \sqrt{3} r) \exp(-\sqrt{3} r)``.  ``h, q`` are singular at ``r = 0``, but
+  only ever multiply products of ``v`` that vanish faster.
+\endrst*/
+struct MaternNu1p5Radial {
+  static double Value(double r, double alpha) noexcept {
+    return alpha*(1.0 + kSqrt3*r)*std::exp(-kSqrt3*r);
+  }
+
+  static RadialKernelValues Evaluate(double r, double alpha) noexcept {
+    const double exp_part = alpha*std::exp(-kSqrt3*r);
+    RadialKernelValues values;
+    values.f = (1.0 + kSqrt3*r)*exp_part;
+    values.g = -3.0*exp_part;
+    if (unlikely(r < kMinimumRadialDistance)) {
+      values.h = 0.0;
+      values.q = 0.0;
+    } else {
+      values.h = 3.0*kSqrt3*exp_part/r;
+      values.q = -3.0*kSqrt3*(1.0 + kSqrt3*r)*exp_part/(r*r*r);
+    }
+    return values;
+  }
+};
+
+/*!\rst
+  Matern ``\nu = 5/2``: ``f = \alpha (1 + \sqrt{5} r + \frac{5}{3} r^2) \exp(-\sqrt{5} r)``.  Only ``q`` is singular
+  at ``r = 0``.
+\endrst*/
+struct MaternNu2p5Radial {
+  static double Value(double r, double alpha) noexcept {
+    return alpha*(1.0 + kSqrt5*r + 5.0/3.0*r*r)*std::exp(-kSqrt5*r);
+  }
+
+  static RadialKernelValues Evaluate(double r, double alpha) noexcept {
+    const double exp_part = alpha*std::exp(-kSqrt5*r);
+    RadialKernelValues values;
+    values.f = (1.0 + kSqrt5*r + 5.0/3.0*r*r)*exp_part;
+    values.g = -5.0/3.0*(1.0 + kSqrt5*r)*exp_part;
+    values.h = 25.0/3.0*exp_part;
+    values.q = unlikely(r < kMinimumRadialDistance) ? 0.0 : -25.0/3.0*kSqrt5*exp_part/r;
+    return values;
+  }
+};
+
+/*!\rst
+  Covariance block of a radial kernel with gradient observations:
+
+  ``cov = f``, ``\pderiv{cov}{x_{1,m}} = g v_m``, ``\pderiv{cov}{x_{2,n}} = -g v_n``,
+  ``\pderiv{^2 cov}{x_{1,m} \partial x_{2,n}} = -(h v_m v_n + \delta_{mn} g / L_m^2)``.
+
+  The operations are ordered so that swapping ``x_1, x_2`` (and the derivative lists) yields exactly the transpose.
+
+  \param
+    :point_one[dim]: first spatial coordinate
+    :derivatives_one[num_derivatives_one]: dimensions of the derivatives observed at point_one
+    :num_derivatives_one: number of derivatives observed at point_one
+    :point_two[dim]: second spatial coordinate
+    :derivatives_two[num_derivatives_two]: dimensions of the derivatives observed at point_two
+    :num_derivatives_two: number of derivatives observed at point_two
+    :lengths_sq[dim]: squared length scales, ``L_d^2``
+    :values: the radial kernel (and derivatives) at ``r(x_1, x_2)``
+    :leading_dim: distance between the starts of consecutive columns of cov_block
+  \output
+    :cov_block[leading_dim][1+num_derivatives_two]: entries ``(0..num_derivatives_one, 0..num_derivatives_two)``
+      overwritten with the covariance block
+\endrst*/
+OL_TARGET_CLONES_AVX void RadialCovarianceBlock(double const * restrict point_one,
+                                                int const * restrict derivatives_one, int num_derivatives_one,
+                                                double const * restrict point_two,
+                                                int const * restrict derivatives_two, int num_derivatives_two,
+                                                double const * restrict lengths_sq, const RadialKernelValues& values,
+                                                int leading_dim, double * restrict cov_block) noexcept {
+  cov_block[0] = values.f;
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    cov_block[m+1] = values.g*((point_one[index1] - point_two[index1])/lengths_sq[index1]);
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = (point_one[index2] - point_two[index2])/lengths_sq[index2];
+    const double diagonal_term = values.g/lengths_sq[index2];
+    double * restrict cov_col = cov_block + (n+1)*leading_dim;
+    cov_col[0] = -(values.g*derivative_point_two);
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      const double derivative_point_one = (point_one[index1] - point_two[index1])/lengths_sq[index1];
+      cov_col[m+1] = -(values.h*(derivative_point_one*derivative_point_two) +
+                       (index1 == index2 ? diagonal_term : 0.0));
+    }
+  }
+}
+
+/*!\rst
+  Body of MaternNu1p5::Covariance() and MaternNu2p5::Covariance(); see RadialCovarianceBlock().
+\endrst*/
+template <typename Radial>
+void RadialCovariance(double const * restrict point_one, int const * restrict derivatives_one,
+                      int num_derivatives_one, double const * restrict point_two,
+                      int const * restrict derivatives_two, int num_derivatives_two,
+                      double const * restrict lengths_sq, double alpha, int dim, double * restrict cov) noexcept {
+  const double r = std::sqrt(NormSquaredWithInverseWeights<0>(point_one, point_two, lengths_sq, dim));
+  RadialCovarianceBlock(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                        num_derivatives_two, lengths_sq, Radial::Evaluate(r, alpha), 1+num_derivatives_one, cov);
+}
+
+/*!\rst
+  Body of MaternNu1p5::CovarianceMatrix() and MaternNu2p5::CovarianceMatrix(); same structure as
+  SquareExponential::CovarianceMatrix(): squared distances between length-scaled points are accumulated in unit-stride
+  loops over whole columns, the (block) upper triangle of a symmetric matrix is mirrored instead of recomputed, and the
+  derivative blocks come from RadialCovarianceBlock().
+\endrst*/
+template <typename Radial>
+void RadialCovarianceMatrix(const ScaledPointsTranspose& scaled_one, double const * restrict points_two,
+                            int num_points_two,
+                            int const * restrict derivatives_one, int num_derivatives_one,
+                            int const * restrict derivatives_two, int num_derivatives_two,
+                            double const * restrict lengths, double const * restrict lengths_sq, double alpha,
+                            int dim, double * restrict cov_matrix) noexcept {
+  double const * restrict points_one = scaled_one.points;
+  const int num_points_one = scaled_one.num_points;
+  if (unlikely(num_points_one == 0 || num_points_two == 0)) {
+    return;
+  }
+
+  const bool symmetric = points_one == points_two && num_points_one == num_points_two &&
+      num_derivatives_one == num_derivatives_two &&
+      (num_derivatives_one == 0 || derivatives_one == derivatives_two);
+  const int block_size_one = 1 + num_derivatives_one;
+  const int block_size_two = 1 + num_derivatives_two;
+  const int num_rows = num_points_one*block_size_one;
+  const int num_cols = num_points_two*block_size_two;
+
+  std::vector<double> inverse_lengths(dim);
+  for (int d = 0; d < dim; ++d) {
+    inverse_lengths[d] = 1.0/lengths[d];
+  }
+
+  // without derivatives the kernel matrix *is* the output; otherwise keep the distances separately
+  const bool values_only = num_derivatives_one == 0 && num_derivatives_two == 0;
+  std::vector<double> distance_temp(values_only ? 0 : num_points_one*num_points_two);
+  double * distance = values_only ? cov_matrix : distance_temp.data();
+
+  for (int j = 0; j < num_points_two; ++j) {
+    double * restrict distance_col = distance + j*num_points_one;
+    double const * restrict point_two = points_two + j*dim;
+    const int i_start = symmetric ? j : 0;
+    std::fill(distance_col + i_start, distance_col + num_points_one, 0.0);
+    for (int d = 0; d < dim; ++d) {
+      double const * restrict scaled_one_row = scaled_one.scaled_points.data() + d*scaled_one.leading_dim;
+      const double scaled_two = point_two[d]*inverse_lengths[d];
+      for (int i = i_start; i < num_points_one; ++i) {
+        distance_col[i] += Square(scaled_one_row[i] - scaled_two);
+      }
+    }
+    for (int i = i_start; i < num_points_one; ++i) {
+      distance_col[i] = std::sqrt(distance_col[i]);
+    }
+    if (values_only) {
+      for (int i = i_start; i < num_points_one; ++i) {
+        distance_col[i] = Radial::Value(distance_col[i], alpha);
+      }
+    }
+  }
+
+  if (!values_only) {
+    for (int j = 0; j < num_points_two; ++j) {
+      double const * restrict point_two = points_two + j*dim;
+      const int i_start = symmetric ? j : 0;
+      for (int i = i_start; i < num_points_one; ++i) {
+        RadialCovarianceBlock(points_one + i*dim, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                              num_derivatives_two, lengths_sq, Radial::Evaluate(distance[i + j*num_points_one], alpha),
+                              num_rows, cov_matrix + i*block_size_one + j*block_size_two*num_rows);
+      }
+    }
+  }
+
+  if (symmetric) {
+    // mirror the strictly upper blocks from the computed lower blocks
+    for (int col = 0; col < num_cols; ++col) {
+      const int row_end = (col/block_size_two)*block_size_one;
+      for (int row = 0; row < row_end; ++row) {
+        cov_matrix[row + col*num_rows] = cov_matrix[col + row*num_rows];
+      }
+    }
+  }
+}
+
+/*!\rst
+  Body of MaternNu1p5::GradCovariance() and MaternNu2p5::GradCovariance().  Differentiating RadialCovarianceBlock()
+  wrt ``x_{1,i}`` (with ``\pderiv{g}{x_{1,i}} = h v_i``, ``\pderiv{h}{x_{1,i}} = q v_i``):
+
+  ``g v_i``, ``h v_i v_m + \delta_{im} g/L_m^2``, ``-(h v_i v_n + \delta_{in} g/L_n^2)``, and
+  ``-(q v_i v_m v_n + h (\delta_{im} v_n/L_m^2 + \delta_{in} v_m/L_n^2) + \delta_{mn} h v_i / L_m^2)``.
+
+  Output ordering and the base-loop-plus-fixup structure are as in SquareExponentialGradCovarianceKernel().
+\endrst*/
+template <typename Radial>
+OL_TARGET_CLONES_AVX void RadialGradCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one, int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two, int num_derivatives_two,
+                                               double const * restrict lengths_sq, double alpha, int dim,
+                                               double * restrict grad_cov) noexcept {
+  const RadialKernelValues values = Radial::Evaluate(
+      std::sqrt(NormSquaredWithInverseWeights<0>(point_one, point_two, lengths_sq, dim)), alpha);
+  // ``v_i = (x_{1,i} - x_{2,i})/L_i^2``, evaluated on demand so that this function does no heap allocation
+  auto distance = [point_one, point_two, lengths_sq](int i) {
+    return (point_one[i] - point_two[i])/lengths_sq[i];
+  };
+  const int block_stride_two = dim*(num_derivatives_one+1);
+
+  for (int i = 0; i < dim; ++i) {
+    grad_cov[i] = values.g*distance(i);
+  }
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const double coefficient = values.h*distance(index1);
+    double * restrict grad_block = grad_cov + (m+1)*dim;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i] = coefficient*distance(i);
+    }
+    grad_block[index1] += values.g/lengths_sq[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double coefficient = -(values.h*distance(index2));
+    double * restrict grad_block = grad_cov + (n+1)*block_stride_two;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i] = coefficient*distance(i);
+    }
+    grad_block[index2] -= values.g/lengths_sq[index2];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = distance(index2);
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      const double derivative_point_one = distance(index1);
+      const double product = values.q*(derivative_point_one*derivative_point_two) +
+          (index1 == index2 ? values.h/lengths_sq[index1] : 0.0);
+      double * restrict grad_block = grad_cov + (m+1)*dim + (n+1)*block_stride_two;
+      for (int i = 0; i < dim; ++i) {
+        grad_block[i] = -(product*distance(i));
+      }
+
+      auto full_entry = [&](int i) {
+        double entry = product*distance(i);
+        if (i == index1) {
+          entry += values.h*derivative_point_two/lengths_sq[index1];
+        }
+        if (i == index2) {
+          entry += values.h*derivative_point_one/lengths_sq[index2];
+        }
+        return -entry;
+      };
+      grad_block[index1] = full_entry(index1);
+      grad_block[index2] = full_entry(index2);
+    }
+  }
+}
+
+/*!\rst
+  Body of MaternNu1p5::HyperparameterGradCovariance() and MaternNu2p5::HyperparameterGradCovariance().  Every entry is
+  linear in ``\alpha``; wrt ``L_j``, ``\pderiv{r}{L_j} = -w_j/r`` with ``w_j = ((x_{1,j} - x_{2,j})/L_j)^2/L_j`` and
+  ``\pderiv{v_m}{L_j} = -2 \delta_{mj} v_m / L_m``, so each block is a common ``c w_j`` term (filled by a unit-stride
+  loop) plus corrections at the (at most two) observed dimensions.
+\endrst*/
+template <typename Radial>
+OL_TARGET_CLONES_AVX void RadialHyperparameterGradCovariance(double const * restrict point_one,
+                                                             int const * restrict derivatives_one,
+                                                             int num_derivatives_one,
+                                                             double const * restrict point_two,
+                                                             int const * restrict derivatives_two,
+                                                             int num_derivatives_two,
+                                                             double const * restrict lengths,
+                                                             double const * restrict lengths_sq,
+                                                             double alpha, int dim,
+                                                             double * restrict grad_hyperparameter_cov) noexcept {
+  const RadialKernelValues values = Radial::Evaluate(
+      std::sqrt(NormSquaredWithInverseWeights<0>(point_one, point_two, lengths_sq, dim)), alpha);
+  auto distance = [point_one, point_two, lengths_sq](int i) {
+    return (point_one[i] - point_two[i])/lengths_sq[i];
+  };
+  // fills one [dim+1] block: d/d\alpha, then the length-scale terms shared by every dimension
+  auto fill_block = [=](double cov_entry, double coefficient, double * restrict grad_block) {
+    grad_block[0] = cov_entry/alpha;
+    for (int i = 0; i < dim; ++i) {
+      grad_block[i+1] = coefficient*(Square((point_one[i] - point_two[i])/lengths[i])/lengths[i]);
+    }
+  };
+  const int block_stride_two = (dim+1)*(num_derivatives_one+1);
+
+  fill_block(values.f, -values.g, grad_hyperparameter_cov);
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const double derivative_point_one = distance(index1);
+    double * restrict grad_block = grad_hyperparameter_cov + (m+1)*(dim+1);
+    fill_block(values.g*derivative_point_one, -(values.h*derivative_point_one), grad_block);
+    grad_block[index1+1] -= 2.0*values.g*derivative_point_one/lengths[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = distance(index2);
+    double * restrict grad_block = grad_hyperparameter_cov + (n+1)*block_stride_two;
+    fill_block(-(values.g*derivative_point_two), values.h*derivative_point_two, grad_block);
+    grad_block[index2+1] += 2.0*values.g*derivative_point_two/lengths[index2];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const double derivative_point_two = distance(index2);
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      const double product = distance(index1)*derivative_point_two;
+      const bool diagonal = index1 == index2;
+      double * restrict grad_block = grad_hyperparameter_cov + (m+1)*(dim+1) + (n+1)*block_stride_two;
+      fill_block(-(values.h*product + (diagonal ? values.g/lengths_sq[index1] : 0.0)),
+                 values.q*product + (diagonal ? values.h/lengths_sq[index1] : 0.0), grad_block);
+      grad_block[index1+1] += 2.0*values.h*product/lengths[index1];
+      grad_block[index2+1] += 2.0*values.h*product/lengths[index2];
+      if (diagonal) {
+        grad_block[index1+1] += 2.0*values.g/(lengths_sq[index1]*lengths[index1]);
+      }
+    }
+  }
+}
+
+/*!\rst
+  Draws frequencies ``w = z / (L \sqrt{u / \kappa})`` with ``z ~ N(0, I)`` and ``u ~ \chi^2_{\kappa}``: the multivariate
+  Student-t with ``\kappa`` degrees of freedom and scale ``L^{-1}``, which is the (normalized) spectral density of the
+  Matern covariance with ``\nu = \kappa/2``.  ``\kappa = 0`` denotes the ``\nu \rightarrow \infty`` limit, ``w ~ N(0, L^{-2})``,
+  i.e., the square exponential.
+
+  ``\kappa`` is an integer for every covariance in this file, so ``u`` is a sum of ``\kappa`` squared normals.
+
+  \param
+    :dim: the number of spatial dimensions
+    :num_frequencies: number of frequencies to draw
+    :degrees_of_freedom: ``\kappa = 2\nu``; 0 for the square exponential
+    :lengths[dim]: the length scales, one per spatial dimension
+    :normal_rng[1]: a NormalRNGInterface object that will provide the ~N(0,1) random numbers
+  \output
+    :normal_rng[1]: NormalRNGInterface object will have its state changed due to random draws
+    :frequencies[dim][num_frequencies]: the drawn frequencies
+\endrst*/
+OL_NONNULL_POINTERS void SampleStudentTFrequencies(int dim, int num_frequencies, int degrees_of_freedom,
+                                                   double const * restrict lengths, NormalRNGInterface * normal_rng,
+                                                   double * restrict frequencies) {
+  normal_rng->Fill(frequencies, dim*num_frequencies);
+  for (int j = 0; j < num_frequencies; ++j) {
+    double scale = 1.0;
+    if (degrees_of_freedom > 0) {
+      double chi_squared = 0.0;
+      for (int k = 0; k < degrees_of_freedom; ++k) {
+        chi_squared += Square((*normal_rng)());
+      }
+      scale = std::sqrt(degrees_of_freedom/chi_squared);
+    }
+    for (int d = 0; d < dim; ++d) {
+      frequencies[j*dim + d] *= scale/lengths[d];
+    }
+  }
+}
+
 }  // end unnamed namespace
 
+PairwiseDifferences::PairwiseDifferences(double const * restrict points_in, int dim_in, int num_points_in,
+                                         int const * restrict derivatives_in, int num_derivatives_in)
+    : dim(dim_in),
+      num_points(num_points_in),
+      num_pairs(num_points_in*(num_points_in+1)/2),
+      num_derivatives(num_derivatives_in),
+      derivatives(derivatives_in, derivatives_in + num_derivatives_in),
+      points(points_in, points_in + dim_in*num_points_in),
+      squared_differences() {
+  if (static_cast<double>(dim)*static_cast<double>(num_pairs) > kMaxSquaredDifferencesSize) {
+    return;
+  }
+
+  squared_differences.resize(dim*num_pairs);
+  for (int d = 0; d < dim; ++d) {
+    double * restrict squared_differences_row = squared_differences.data() + d*num_pairs;
+    for (int i = 0; i < num_points; ++i) {
+      const double coordinate_i = points[i*dim + d];
+      for (int j = i; j < num_points; ++j) {
+        *squared_differences_row++ = Square(points[j*dim + d] - coordinate_i);
+      }
+    }
+  }
+}
+
+CrossPairwiseDifferences::CrossPairwiseDifferences(int dim_in)
+    : dim(dim_in),
+      num_points_one(0),
+      num_points_two(0),
+      points_one(nullptr),
+      points_two(),
+      squared_differences() {
+}
+
+void CrossPairwiseDifferences::SetPoints(double const * restrict points_one_in, int num_points_one_in,
+                                         double const * restrict points_two_in, int num_points_two_in) {
+  num_points_one = num_points_one_in;
+  num_points_two = num_points_two_in;
+  points_one = points_one_in;
+  points_two.assign(points_two_in, points_two_in + dim*num_points_two_in);
+  squared_differences.clear();
+
+  const int num_pairs = num_points_one*num_points_two;
+  if (static_cast<double>(dim)*static_cast<double>(num_pairs) > PairwiseDifferences::kMaxSquaredDifferencesSize) {
+    return;
+  }
+
+  squared_differences.resize(dim*num_pairs);
+  for (int d = 0; d < dim; ++d) {
+    double * restrict squared_differences_row = squared_differences.data() + d*num_pairs;
+    for (int j = 0; j < num_points_two; ++j) {
+      const double coordinate_j = points_two[j*dim + d];
+      for (int i = 0; i < num_points_one; ++i) {
+        *squared_differences_row++ = Square(coordinate_j - points_one[i*dim + d]);
+      }
+    }
+  }
+}
+
+bool CrossPairwiseDifferences::Matches(double const * restrict points_one_in, int num_points_one_in,
+                                       double const * restrict points_two_in, int num_points_two_in) const noexcept {
+  if (points_one_in != points_one || num_points_one_in != num_points_one || num_points_two_in != num_points_two) {
+    return false;
+  }
+  return std::equal(points_two.begin(), points_two.end(), points_two_in);
+}
+
+ScaledPointsTranspose::ScaledPointsTranspose()
+    : dim(0),
+      num_points(0),
+      leading_dim(0),
+      points(nullptr),
+      scaled_points() {
+}
+
+void ScaledPointsTranspose::SetPoints(double const * restrict points_in, int dim_in, int num_points_in,
+                                      double const * restrict lengths) {
+  dim = dim_in;
+  num_points = num_points_in;
+  leading_dim = (num_points_in + kRowPadding - 1)/kRowPadding*kRowPadding;
+  points = points_in;
+  scaled_points.assign(dim*leading_dim, 0.0);
+  for (int d = 0; d < dim; ++d) {
+    double * restrict scaled_row = scaled_points.data() + d*leading_dim;
+    const double inverse_length = 1.0/lengths[d];
+    for (int i = 0; i < num_points; ++i) {
+      scaled_row[i] = points[i*dim + d]*inverse_length;
+    }
+  }
+}
+
+void CovarianceInterface::ScalePointsTranspose(double const * restrict OL_UNUSED(points), int OL_UNUSED(num_points),
+                                               ScaledPointsTranspose * scaled_points) const {
+  *scaled_points = ScaledPointsTranspose();
+}
+
+void CovarianceInterface::CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                                         double const * restrict points_two, int num_points_two,
+                                                         int const * restrict derivatives_one, int num_derivatives_one,
+                                                         int const * restrict derivatives_two, int num_derivatives_two,
+                                                         double * restrict cov_matrix) const noexcept {
+  CovarianceMatrix(scaled_one.points, points_two, scaled_one.dim, scaled_one.num_points, num_points_two,
+                   derivatives_one, num_derivatives_one, derivatives_two, num_derivatives_two, cov_matrix);
+}
+
+void CovarianceInterface::CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                                int const * restrict derivatives_one, int num_derivatives_one,
+                                                int const * restrict derivatives_two, int num_derivatives_two,
+                                                double * restrict cov_matrix) const noexcept {
+  CovarianceMatrix(differences.points_one, differences.points_two.data(), differences.dim,
+                   differences.num_points_one, differences.num_points_two,
+                   derivatives_one, num_derivatives_one, derivatives_two, num_derivatives_two, cov_matrix);
+}
+
+void CovarianceInterface::SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                                    double * restrict cov_matrix) const noexcept {
+  BuildSymmetricCovarianceMatrixInParallel(*this, differences.points.data(), differences.dim, differences.num_points,
+                                           differences.derivatives.data(), differences.num_derivatives, cov_matrix);
+}
+
+void CovarianceInterface::CovarianceMatrix(double const * restrict points_one,
+                                           double const * restrict points_two,
+                                           int dim, int num_points_one, int num_points_two,
+                                           int const * restrict derivatives_one,
+                                           int num_derivatives_one,
+                                           int const * restrict derivatives_two,
+                                           int num_derivatives_two,
+                                           double * restrict cov_matrix) const noexcept {
+  const int block_size_one = 1 + num_derivatives_one;
+  const int block_size_two = 1 + num_derivatives_two;
+  const int num_rows = num_points_one*block_size_one;
+  std::vector<double> cov_temp(block_size_one*block_size_two);
+  for (int j = 0; j < num_points_two; ++j) {
+    for (int i = 0; i < num_points_one; ++i) {
+      Covariance(points_one + i*dim, derivatives_one, num_derivatives_one,
+                 points_two + j*dim, derivatives_two, num_derivatives_two, cov_temp.data());
+      double * restrict cov_block = cov_matrix + i*block_size_one + j*block_size_two*num_rows;
+      for (int n = 0; n < block_size_two; ++n) {
+        for (int m = 0; m < block_size_one; ++m) {
+          cov_block[m + n*num_rows] = cov_temp[m + n*block_size_one];
+        }
+      }
+    }
+  }
+}
+
+void CovarianceInterface::HyperparameterHessianCovariance(double const * restrict point_one,
+                                                          int const * restrict derivatives_one,
+                                                          int num_derivatives_one,
+                                                          double const * restrict point_two,
+                                                          int const * restrict derivatives_two,
+                                                          int num_derivatives_two,
+                                                          double * restrict hessian_hyperparameter_cov) const noexcept {
+  const int num_hyperparameters = GetNumberOfHyperparameters();
+  const int num_entries = (1 + num_derivatives_one)*(1 + num_derivatives_two);
+  std::unique_ptr<CovarianceInterface> perturbed_covariance(Clone());
+  std::vector<double> hyperparameters(num_hyperparameters);
+  GetHyperparameters(hyperparameters.data());
+  std::vector<double> grad_plus(num_hyperparameters*num_entries);
+  std::vector<double> grad_minus(num_hyperparameters*num_entries);
+
+  // column l of each entry's hessian is the central difference of the hyperparameter gradient in the direction of \theta_l
+  for (int l = 0; l < num_hyperparameters; ++l) {
+    const double theta_l = hyperparameters[l];
+    // step ~ cbrt(machine epsilon) balances truncation against cancellation error
+    const double h = 6.0e-6*std::fmax(std::fabs(theta_l), 1.0e-3);
+    hyperparameters[l] = theta_l + h;
+    perturbed_covariance->SetHyperparameters(hyperparameters.data());
+    perturbed_covariance->HyperparameterGradCovariance(point_one, derivatives_one, num_derivatives_one, point_two,
+                                                       derivatives_two, num_derivatives_two, grad_plus.data());
+    hyperparameters[l] = theta_l - h;
+    perturbed_covariance->SetHyperparameters(hyperparameters.data());
+    perturbed_covariance->HyperparameterGradCovariance(point_one, derivatives_one, num_derivatives_one, point_two,
+                                                       derivatives_two, num_derivatives_two, grad_minus.data());
+    hyperparameters[l] = theta_l;
+
+    for (int e = 0; e < num_entries; ++e) {
+      for (int i = 0; i < num_hyperparameters; ++i) {
+        hessian_hyperparameter_cov[i + l*num_hyperparameters + e*Square(num_hyperparameters)] =
+            (grad_plus[i + e*num_hyperparameters] - grad_minus[i + e*num_hyperparameters])/(2.0*h);
+      }
+    }
+  }
+
+  // the exact hessian is symmetric; average away the differencing error that breaks the symmetry
+  for (int e = 0; e < num_entries; ++e) {
+    double * restrict hessian_block = hessian_hyperparameter_cov + e*Square(num_hyperparameters);
+    for (int l = 0; l < num_hyperparameters; ++l) {
+      for (int i = l + 1; i < num_hyperparameters; ++i) {
+        const double average = 0.5*(hessian_block[i + l*num_hyperparameters] + hessian_block[l + i*num_hyperparameters]);
+        hessian_block[i + l*num_hyperparameters] = average;
+        hessian_block[l + i*num_hyperparameters] = average;
+      }
+    }
+  }
+}
+
+/*!\rst
+  The per-pair kernels of one SquareExponential specialization (see SquareExponential::kMaxSpecializedDim).
+\endrst*/
+struct SquareExponential::KernelTable {
+  template <int kDim>
+  static KernelTable Make() noexcept {
+    return {&SquareExponentialCovarianceKernel<kDim>, &SquareExponentialGradCovarianceKernel<kDim>,
+            &SquareExponentialHyperparameterGradCovarianceKernel<kDim>};
+  }
+
+  void (*covariance)(double const * restrict point_one, int const * restrict derivatives_one, int num_derivatives_one,
+                     double const * restrict point_two, int const * restrict derivatives_two, int num_derivatives_two,
+                     double const * restrict lengths_sq, double alpha, int dim, double * restrict cov);
+  void (*grad_covariance)(double const * restrict point_one, int const * restrict derivatives_one,
+                          int num_derivatives_one, double const * restrict point_two,
+                          int const * restrict derivatives_two, int num_derivatives_two,
+                          double const * restrict lengths_sq, double alpha, int dim, double * restrict grad_cov);
+  void (*hyperparameter_grad_covariance)(double const * restrict point_one, int const * restrict derivatives_one,
+                                         int num_derivatives_one, double const * restrict point_two,
+                                         int const * restrict derivatives_two, int num_derivatives_two,
+                                         double const * restrict lengths, double const * restrict lengths_sq,
+                                         double alpha, int dim, double * restrict grad_hyperparameter_cov);
+};
+
 void SquareExponential::Initialize() {
   InitializeCovariance(dim_, alpha_, lengths_, lengths_sq_.data());
+
+  // entry kDim holds the kernels compiled for dim == kDim; entry 0 holds the generic (runtime dim) kernels
+  static const KernelTable kernel_tables[kMaxSpecializedDim + 1] = {
+    KernelTable::Make<0>(), KernelTable::Make<1>(), KernelTable::Make<2>(), KernelTable::Make<3>(),
+    KernelTable::Make<4>(), KernelTable::Make<5>(), KernelTable::Make<6>(), KernelTable::Make<7>(),
+    KernelTable::Make<8>(), KernelTable::Make<9>(), KernelTable::Make<10>(), KernelTable::Make<11>(),
+    KernelTable::Make<12>(), KernelTable::Make<13>(), KernelTable::Make<14>(), KernelTable::Make<15>(),
+    KernelTable::Make<16>(),
+  };
+  kernels_ = &kernel_tables[dim_ <= kMaxSpecializedDim ? dim_ : 0];
 }
 
 SquareExponential::SquareExponential(int dim, double alpha, std::vector<double> lengths)
-    : dim_(dim), alpha_(alpha), lengths_(lengths), lengths_sq_(dim) {
+    : dim_(dim), alpha_(alpha), lengths_(lengths), lengths_sq_(dim), kernels_(nullptr) {
   Initialize();
 }
 
@@ -125,44 +1003,218 @@ void SquareExponential::Covariance(double const * restrict point_one,
                                    int const * restrict derivatives_two,
                                    int num_derivatives_two,
                                    double * restrict cov) const noexcept {
-  // correct by the kernel value
-  const double norm_val = NormSquaredWithInverseWeights(point_one, point_two, lengths_sq_.data(), dim_);
-  const double kernel = alpha_*std::exp(-0.5*norm_val);
+  kernels_->covariance(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                       num_derivatives_two, lengths_sq_.data(), alpha_, dim_, cov);
+}
 
-  cov[0] = kernel;
+/*
+  Batched Square Exponential.  Points are scaled once, ``z = x/L``, so that
+  ``(x_1 - x_2)^T * L^{-1} * (x_1 - x_2) = \|z_1 - z_2\|_2^2``; distances and exponentials are then evaluated in
+  unit-stride loops over whole columns of the output.  The first list's scaled copy is a ScaledPointsTranspose, which
+  callers building against the same list repeatedly keep and pass to CovarianceMatrixOfScaledPoints().  Gradient and Hessian blocks reuse the kernel values as in Covariance().
+
+  We deliberately do not expand ``\|z_1 - z_2\|^2 = \|z_1\|^2 + \|z_2\|^2 - 2 z_1^T z_2`` and use GEMM: the cancellation
+  makes the kernel noisy (non-smooth) for nearby points, which the ill-conditioned solves against ``K`` amplify.
+*/
+void SquareExponential::CovarianceMatrix(double const * restrict points_one,
+                                         double const * restrict points_two,
+                                         int OL_UNUSED(dim), int num_points_one, int num_points_two,
+                                         int const * restrict derivatives_one,
+                                         int num_derivatives_one,
+                                         int const * restrict derivatives_two,
+                                         int num_derivatives_two,
+                                         double * restrict cov_matrix) const noexcept {
+  if (unlikely(num_points_one == 0 || num_points_two == 0)) {
+    return;
+  }
+
+  ScaledPointsTranspose scaled_one;
+  scaled_one.SetPoints(points_one, dim_, num_points_one, lengths_.data());
+  CovarianceMatrixOfScaledPoints(scaled_one, points_two, num_points_two, derivatives_one, num_derivatives_one,
+                                 derivatives_two, num_derivatives_two, cov_matrix);
+}
+
+void SquareExponential::ScalePointsTranspose(double const * restrict points, int num_points,
+                                             ScaledPointsTranspose * scaled_points) const {
+  scaled_points->SetPoints(points, dim_, num_points, lengths_.data());
+}
+
+void SquareExponential::CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                                       double const * restrict points_two, int num_points_two,
+                                                       int const * restrict derivatives_one, int num_derivatives_one,
+                                                       int const * restrict derivatives_two, int num_derivatives_two,
+                                                       double * restrict cov_matrix) const noexcept {
+  double const * restrict points_one = scaled_one.points;
+  const int num_points_one = scaled_one.num_points;
+  if (unlikely(num_points_one == 0 || num_points_two == 0)) {
+    return;
+  }
 
-  int index1 = 0;
-  int index2 = 0;
+  // same point list on both sides: only compute the (block) lower triangle and mirror it
+  const bool symmetric = points_one == points_two && num_points_one == num_points_two &&
+      num_derivatives_one == num_derivatives_two &&
+      (num_derivatives_one == 0 || derivatives_one == derivatives_two);
+  const int block_size_one = 1 + num_derivatives_one;
+  const int block_size_two = 1 + num_derivatives_two;
+  const int num_rows = num_points_one*block_size_one;
+  const int num_cols = num_points_two*block_size_two;
 
-  std::vector<double> derivatives_point_one(num_derivatives_one);
-  for (int m = 0; m < num_derivatives_one; ++m){
-    index1 = derivatives_one[m];
-    derivatives_point_one[m] = (point_two[index1] - point_one[index1])/lengths_sq_[index1];
-    cov[m+1] = cov[0]*derivatives_point_one[m];
+  std::vector<double> inverse_lengths(dim_);
+  for (int d = 0; d < dim_; ++d) {
+    inverse_lengths[d] = 1.0/lengths_[d];
   }
 
-  std::vector<double> derivatives_point_two(num_derivatives_two);
-  for (int n = 0; n < num_derivatives_two; ++n){
-    index2 = derivatives_two[n];
-    derivatives_point_two[n] = (point_one[index2] - point_two[index2])/lengths_sq_[index2];
-    cov[(n+1)*(1+num_derivatives_one)] = cov[0]*derivatives_point_two[n];
+  // without derivatives the kernel matrix *is* the output; otherwise build it separately and scatter
+  const bool values_only = num_derivatives_one == 0 && num_derivatives_two == 0;
+  std::vector<double> kernel_temp(values_only ? 0 : num_points_one*num_points_two);
+  double * kernel = values_only ? cov_matrix : kernel_temp.data();
+
+  // column j of kernel: squared scaled distances from every z1_i to z2_j, accumulated one dimension at a time so the
+  // inner loops run unit-stride over points (and vectorize), then exponentiated in one contiguous pass
+  for (int j = 0; j < num_points_two; ++j) {
+    double * restrict kernel_col = kernel + j*num_points_one;
+    double const * restrict point_two = points_two + j*dim_;
+    const int i_start = symmetric ? j : 0;
+    std::fill(kernel_col + i_start, kernel_col + num_points_one, 0.0);
+    for (int d = 0; d < dim_; ++d) {
+      double const * restrict scaled_one_row = scaled_one.scaled_points.data() + d*scaled_one.leading_dim;
+      const double scaled_two = point_two[d]*inverse_lengths[d];
+      for (int i = i_start; i < num_points_one; ++i) {
+        kernel_col[i] += Square(scaled_one_row[i] - scaled_two);
+      }
+    }
+    for (int i = i_start; i < num_points_one; ++i) {
+      kernel_col[i] = alpha_*std::exp(-0.5*kernel_col[i]);
+    }
   }
 
-  // the Hessian matrix
-  int index_one = 0;
-  int index_two = 0;
-  for (int i = 0; i < num_derivatives_one; ++i) {
-    for (int j = 0; j < num_derivatives_two; ++j) {
-      index_one = derivatives_one[i];
-      index_two = derivatives_two[j];
-      cov[(i+1)+(j+1)*(1+num_derivatives_one)] = derivatives_point_one[i]*derivatives_point_two[j]*kernel;
-      if(index_one == index_two){
-        cov[(i+1)+(j+1)*(1+num_derivatives_one)] += kernel/lengths_sq_[index_two];
+  if (!values_only) {
+    std::vector<double> grad_one(num_derivatives_one);
+    std::vector<double> grad_two(num_derivatives_two);
+    for (int j = 0; j < num_points_two; ++j) {
+      double const * restrict point_two = points_two + j*dim_;
+      const int i_start = symmetric ? j : 0;
+      for (int i = i_start; i < num_points_one; ++i) {
+        double const * restrict point_one = points_one + i*dim_;
+        const double kernel_value = kernel[i + j*num_points_one];
+        double * restrict cov_block = cov_matrix + i*block_size_one + j*block_size_two*num_rows;
+
+        cov_block[0] = kernel_value;
+        for (int m = 0; m < num_derivatives_one; ++m) {
+          const int index = derivatives_one[m];
+          grad_one[m] = (point_two[index] - point_one[index])/lengths_sq_[index];
+          cov_block[m+1] = kernel_value*grad_one[m];
+        }
+        for (int n = 0; n < num_derivatives_two; ++n) {
+          const int index = derivatives_two[n];
+          grad_two[n] = (point_one[index] - point_two[index])/lengths_sq_[index];
+          cov_block[(n+1)*num_rows] = kernel_value*grad_two[n];
+        }
+
+        // the Hessian block
+        SquareExponentialHessianBlock(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                      num_derivatives_two, lengths_sq_.data(), kernel_value, num_rows, cov_block);
+      }
+    }
+  }
+
+  if (symmetric) {
+    // mirror the strictly upper blocks from the computed lower blocks
+    for (int col = 0; col < num_cols; ++col) {
+      const int row_end = (col/block_size_two)*block_size_one;
+      for (int row = 0; row < row_end; ++row) {
+        cov_matrix[row + col*num_rows] = cov_matrix[col + row*num_rows];
       }
     }
   }
 }
 
+void SquareExponential::CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                              int const * restrict derivatives_one, int num_derivatives_one,
+                                              int const * restrict derivatives_two, int num_derivatives_two,
+                                              double * restrict cov_matrix) const noexcept {
+  // derivative blocks also need the signed differences; those are cheap next to the hessian blocks, so we only
+  // short-circuit the (common) values-only case
+  if (differences.squared_differences.empty() || num_derivatives_one != 0 || num_derivatives_two != 0) {
+    CovarianceInterface::CrossCovarianceMatrix(differences, derivatives_one, num_derivatives_one,
+                                               derivatives_two, num_derivatives_two, cov_matrix);
+    return;
+  }
+
+  // pair p = i + j*num_points_one is exactly entry (i, j) of the column-major [num_points_two][num_points_one] output
+  const int num_pairs = differences.num_points_one*differences.num_points_two;
+  std::fill(cov_matrix, cov_matrix + num_pairs, 0.0);
+  for (int d = 0; d < dim_; ++d) {
+    double const * restrict squared_differences_row = differences.squared_differences.data() + d*num_pairs;
+    const double inverse_length_sq = 1.0/lengths_sq_[d];
+    for (int p = 0; p < num_pairs; ++p) {
+      cov_matrix[p] += squared_differences_row[p]*inverse_length_sq;
+    }
+  }
+  for (int p = 0; p < num_pairs; ++p) {
+    cov_matrix[p] = alpha_*std::exp(-0.5*cov_matrix[p]);
+  }
+}
+
+void SquareExponential::SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                                  double * restrict cov_matrix) const noexcept {
+  if (!differences.cached()) {
+    CovarianceInterface::SymmetricCovarianceMatrix(differences, cov_matrix);
+    return;
+  }
+
+  const int num_points = differences.num_points;
+  const int num_pairs = differences.num_pairs;
+  const int num_derivatives = differences.num_derivatives;
+  int const * restrict derivatives = differences.derivatives.data();
+  const int block_size = 1 + num_derivatives;
+  const int num_rows = num_points*block_size;
+
+  // kernel_p = alpha * exp(-1/2 * \sum_d sqdiff_{p,d} / L_d^2): unit-stride over pairs, one dimension at a time
+  std::vector<double> kernel(num_pairs, 0.0);
+  for (int d = 0; d < dim_; ++d) {
+    double const * restrict squared_differences_row = differences.squared_differences.data() + d*num_pairs;
+    const double inverse_length_sq = 1.0/lengths_sq_[d];
+    for (int p = 0; p < num_pairs; ++p) {
+      kernel[p] += squared_differences_row[p]*inverse_length_sq;
+    }
+  }
+  for (int p = 0; p < num_pairs; ++p) {
+    kernel[p] = alpha_*std::exp(-0.5*kernel[p]);
+  }
+
+  // scatter the (block) lower triangle, pair p = (i, j) filling block row j of block column i
+  int p = 0;
+  for (int i = 0; i < num_points; ++i) {
+    double const * restrict point_two = differences.points.data() + i*dim_;
+    for (int j = i; j < num_points; ++j, ++p) {
+      const double kernel_value = kernel[p];
+      double * restrict cov_block = cov_matrix + j*block_size + i*block_size*num_rows;
+      cov_block[0] = kernel_value;
+      if (num_derivatives == 0) {
+        continue;
+      }
+
+      double const * restrict point_one = differences.points.data() + j*dim_;
+      for (int m = 0; m < num_derivatives; ++m) {
+        const int index = derivatives[m];
+        cov_block[m+1] = kernel_value*(point_two[index] - point_one[index])/lengths_sq_[index];
+        cov_block[(m+1)*num_rows] = kernel_value*(point_one[index] - point_two[index])/lengths_sq_[index];
+      }
+      SquareExponentialHessianBlock(point_one, derivatives, num_derivatives, point_two, derivatives,
+                                    num_derivatives, lengths_sq_.data(), kernel_value, num_rows, cov_block);
+    }
+  }
+
+  // mirror the strictly upper blocks from the computed lower blocks
+  for (int col = 0; col < num_rows; ++col) {
+    const int row_end = (col/block_size)*block_size;
+    for (int row = 0; row < row_end; ++row) {
+      cov_matrix[row + col*num_rows] = cov_matrix[col + row*num_rows];
+    }
+  }
+}
+
 /*
   Gradient of Square Exponential (wrt ``x_1``):
   ``\pderiv{cov(x_1, x_2)}{x_{1,i}} = (x_{2,i} - x_{1,i}) / L_{i}^2 * cov(x_1, x_2)``
@@ -175,62 +1227,8 @@ void SquareExponential::GradCovariance(double const * restrict point_one,
                                        int const * restrict derivatives_two,
                                        int num_derivatives_two,
                                        double * restrict grad_cov) const noexcept {
-  //std::vector<double> cov((1+num_derivatives_one)*(1+num_derivatives_two));
-  const double norm_val = NormSquaredWithInverseWeights(point_one, point_two, lengths_sq_.data(), dim_);
-  const double kernel = alpha_*std::exp(-0.5*norm_val);
-
-  int index1 = 0;
-  int index2 = 0;
-
-  std::vector<double> derivatives_point_one(num_derivatives_one);
-  for (int m = 0; m < num_derivatives_one; ++m){
-    index1 = derivatives_one[m];
-    derivatives_point_one[m] = (point_two[index1] - point_one[index1])/lengths_sq_[index1];
-  }
-  std::vector<double> derivatives_point_two(num_derivatives_two);
-  for (int n = 0; n < num_derivatives_two; ++n){
-    index2 = derivatives_two[n];
-    derivatives_point_two[n] = (point_one[index2] - point_two[index2])/lengths_sq_[index2];
-  }
-
-  for (int i = 0; i < dim_; ++i) {
-    // ditance between point one and point two at the dim i
-    const double distance_i = (point_two[i] - point_one[i])/lengths_sq_[i];
-    grad_cov[i] = distance_i*kernel;
-
-    for (int m = 0; m < num_derivatives_one; ++m){
-      index1 = derivatives_one[m];
-      grad_cov[i + (m+1)*dim_] = distance_i*derivatives_point_one[m]*kernel;
-      if (i == index1){
-        grad_cov[i + (m+1)*dim_] -= kernel/lengths_sq_[index1];
-      }
-    }
-    for (int n =0; n < num_derivatives_two; ++n){
-      index2 = derivatives_two[n];
-      grad_cov[i + (n+1)*dim_*(num_derivatives_one+1)] = distance_i*derivatives_point_two[n]*kernel;
-      if (i == index2){
-        grad_cov[i + (n+1)*dim_*(num_derivatives_one+1)] += kernel/lengths_sq_[index2];
-      }
-    }
-    for (int m = 0; m < num_derivatives_one; ++m){
-      index1 = derivatives_one[m];
-      for (int n = 0; n < num_derivatives_two; ++n){
-        index2 = derivatives_two[n];
-        grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] = derivatives_point_one[m]*derivatives_point_two[n];
-        if (index1 == index2){
-          grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] += 1.0/lengths_sq_[index1];
-        }
-        grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] *= distance_i;
-        if (index1 == i){
-          grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] -= derivatives_point_two[n]/lengths_sq_[index1];
-        }
-        if (index2 == i){
-          grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] += derivatives_point_one[m]/lengths_sq_[index2];
-        }
-        grad_cov[i+ (m+1)*dim_ + (n+1)*dim_*(num_derivatives_one+1)] *= kernel;
-      }
-    }
-  }
+  kernels_->grad_covariance(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                            num_derivatives_two, lengths_sq_.data(), alpha_, dim_, grad_cov);
 }
 
 /*
@@ -245,151 +1243,724 @@ void SquareExponential::GradCovariance(double const * restrict point_one,
 void SquareExponential::HyperparameterGradCovariance(double const * restrict point_one, int const * restrict derivatives_one, int num_derivatives_one,
                                                      double const * restrict point_two, int const * restrict derivatives_two, int num_derivatives_two,
                                                      double * restrict grad_hyperparameter_cov) const noexcept {
-  double * cov_matrix = new double[(num_derivatives_one+1)*(num_derivatives_two+1)]();
-  Covariance(point_one, derivatives_one, num_derivatives_one,
-             point_two, derivatives_two, num_derivatives_two, cov_matrix);
+  kernels_->hyperparameter_grad_covariance(point_one, derivatives_one, num_derivatives_one, point_two,
+                                           derivatives_two, num_derivatives_two, lengths_.data(), lengths_sq_.data(),
+                                           alpha_, dim_, grad_hyperparameter_cov);
+}
 
-  int index1 = 0;
-  int index2 = 0;
+/*
+  Hessian of Square Exponential (wrt hyperparameters (``alpha, L``)):
+  every entry of the covariance block has the form ``cov(x_1, x_2) * F(L)``, where ``F`` is 1 (function value block), a
+  single ``\pm(x_{1,a} - x_{2,a})/L_a^2`` (gradient blocks), or their product plus ``\delta_{ab}/L_a^2`` (Hessian block).
+  With ``g_i = \pderiv{\log(cov)}{L_i} = (x_{1,i} - x_{2,i})^2 / L_i^3``:
+  ``\mixpderiv{cov * F}{\alpha}{\alpha} = 0``
+  ``\mixpderiv{cov * F}{\alpha}{L_i} = cov * (g_i F + \pderiv{F}{L_i}) / \alpha``
+  ``\mixpderiv{cov * F}{L_i}{L_j} = cov * ((g_i g_j - \delta_{ij} 3 g_i / L_i) F + g_i \pderiv{F}{L_j} + g_j \pderiv{F}{L_i} + \mixpderiv{F}{L_i}{L_j})``
+  ``F`` only depends on (at most) two length scales, and each of its terms is a monomial in them, so its derivatives
+  are closed form: ``\pderiv{L^{-p}}{L} = -p L^{-p-1}``.
 
-  // deriv wrt alpha does not have the same form as the length terms, special case it
-  grad_hyperparameter_cov[0] = cov_matrix[0]/alpha_;
+  output:
+  double: (dim+1) * (dim+1) * (num_derivatives_one+1) * (num_derivatives_two+1)
+*/
+void SquareExponential::HyperparameterHessianCovariance(double const * restrict point_one,
+                                                        int const * restrict derivatives_one,
+                                                        int num_derivatives_one,
+                                                        double const * restrict point_two,
+                                                        int const * restrict derivatives_two,
+                                                        int num_derivatives_two,
+                                                        double * restrict hessian_hyperparameter_cov) const noexcept {
+  const int num_hyperparameters = dim_ + 1;
+  const int block_size_one = 1 + num_derivatives_one;
+  const double kernel = alpha_*std::exp(-0.5*NormSquaredWithInverseWeights<0>(point_one, point_two, lengths_sq_.data(),
+                                                                               dim_));
+  std::vector<double> log_kernel_grad(dim_);
   for (int i = 0; i < dim_; ++i) {
-    grad_hyperparameter_cov[i+1] = cov_matrix[0]*Square((point_one[i] - point_two[i])/lengths_[i])/lengths_[i];
+    log_kernel_grad[i] = Square(point_one[i] - point_two[i])/(lengths_sq_[i]*lengths_[i]);
+  }
+
+  // F and its (sparse) derivatives: grad_F[s] = \pderiv{F}{L_{sparse_dims[s]}}, likewise hess_F
+  int sparse_dims[2];
+  double grad_F[2];
+  double hess_F[2][2];
+  for (int n = 0; n < 1 + num_derivatives_two; ++n) {
+    for (int m = 0; m < block_size_one; ++m) {
+      double F = 1.0;
+      int num_sparse = 0;
+      if ((m == 0) != (n == 0)) {
+        // gradient block: F = c * L_a^-2
+        const int a = m > 0 ? derivatives_one[m-1] : derivatives_two[n-1];
+        F = m > 0 ? (point_two[a] - point_one[a])/lengths_sq_[a] : (point_one[a] - point_two[a])/lengths_sq_[a];
+        num_sparse = 1;
+        sparse_dims[0] = a;
+        grad_F[0] = -2.0*F/lengths_[a];
+        hess_F[0][0] = 6.0*F/lengths_sq_[a];
+      } else if (m > 0) {
+        const int a = derivatives_one[m-1];
+        const int b = derivatives_two[n-1];
+        const double F_a = (point_two[a] - point_one[a])/lengths_sq_[a];
+        const double F_b = (point_one[b] - point_two[b])/lengths_sq_[b];
+        if (a != b) {
+          // F = c * L_a^-2 * L_b^-2
+          F = F_a*F_b;
+          num_sparse = 2;
+          sparse_dims[0] = a;
+          sparse_dims[1] = b;
+          grad_F[0] = -2.0*F/lengths_[a];
+          grad_F[1] = -2.0*F/lengths_[b];
+          hess_F[0][0] = 6.0*F/lengths_sq_[a];
+          hess_F[1][1] = 6.0*F/lengths_sq_[b];
+          hess_F[0][1] = hess_F[1][0] = 4.0*F/(lengths_[a]*lengths_[b]);
+        } else {
+          // F = c * L_a^-4 + L_a^-2
+          const double term_quartic = F_a*F_b;
+          const double term_quadratic = 1.0/lengths_sq_[a];
+          F = term_quartic + term_quadratic;
+          num_sparse = 1;
+          sparse_dims[0] = a;
+          grad_F[0] = (-4.0*term_quartic - 2.0*term_quadratic)/lengths_[a];
+          hess_F[0][0] = (20.0*term_quartic + 6.0*term_quadratic)/lengths_sq_[a];
+        }
+      }
+
+      double * restrict hessian_block = hessian_hyperparameter_cov + (m + n*block_size_one)*Square(num_hyperparameters);
+      // dense part: F * \mixpderiv{cov}{\theta_i}{\theta_j}
+      hessian_block[0] = 0.0;
+      for (int j = 0; j < dim_; ++j) {
+        hessian_block[(j+1)*num_hyperparameters] = kernel*log_kernel_grad[j]*F/alpha_;
+        for (int i = j; i < dim_; ++i) {
+          const double entry = kernel*log_kernel_grad[i]*log_kernel_grad[j]*F;
+          hessian_block[(i+1) + (j+1)*num_hyperparameters] = entry;
+          hessian_block[(j+1) + (i+1)*num_hyperparameters] = entry;
+        }
+        hessian_block[(j+1) + (j+1)*num_hyperparameters] -= kernel*3.0*log_kernel_grad[j]/lengths_[j]*F;
+      }
+      // sparse part: rows/columns of the length scales that F depends on
+      for (int s = 0; s < num_sparse; ++s) {
+        const int a = sparse_dims[s];
+        hessian_block[(a+1)*num_hyperparameters] += kernel*grad_F[s]/alpha_;
+        for (int j = 0; j < dim_; ++j) {
+          const double cross_term = kernel*log_kernel_grad[j]*grad_F[s];
+          hessian_block[(a+1) + (j+1)*num_hyperparameters] += cross_term;
+          hessian_block[(j+1) + (a+1)*num_hyperparameters] += cross_term;
+        }
+      }
+      // (separate pass so mirrored entries see the same sequence of additions and stay exactly symmetric)
+      for (int s = 0; s < num_sparse; ++s) {
+        for (int t = 0; t < num_sparse; ++t) {
+          hessian_block[(sparse_dims[s]+1) + (sparse_dims[t]+1)*num_hyperparameters] += kernel*hess_F[s][t];
+        }
+      }
+      for (int i = 0; i < dim_; ++i) {
+        hessian_block[i+1] = hessian_block[(i+1)*num_hyperparameters];
+      }
+    }
+  }
+}
+
+double SquareExponential::SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                                    double * restrict frequencies) const {
+  SampleStudentTFrequencies(dim_, num_frequencies, 0, lengths_.data(), normal_rng, frequencies);
+  return alpha_;
+}
+
+CovarianceInterface * SquareExponential::Clone() const {
+  return new SquareExponential(*this);
+}
+
+void MaternNu1p5::Initialize() {
+  InitializeCovariance(dim_, alpha_, lengths_, lengths_sq_.data());
+}
+
+MaternNu1p5::MaternNu1p5(int dim, double alpha, std::vector<double> lengths)
+    : dim_(dim), alpha_(alpha), lengths_(lengths), lengths_sq_(dim) {
+  Initialize();
+}
+
+MaternNu1p5::MaternNu1p5(int dim, double alpha, double const * restrict lengths)
+    : MaternNu1p5(dim, alpha, std::vector<double>(lengths, lengths + dim)) {
+}
+
+MaternNu1p5::MaternNu1p5(int dim, double alpha, double length)
+    : MaternNu1p5(dim, alpha, std::vector<double>(dim, length)) {
+}
+
+MaternNu1p5::MaternNu1p5(const MaternNu1p5& OL_UNUSED(source)) = default;
+
+void MaternNu1p5::Covariance(double const * restrict point_one,
+                             int const * restrict derivatives_one,
+                             int num_derivatives_one,
+                             double const * restrict point_two,
+                             int const * restrict derivatives_two,
+                             int num_derivatives_two,
+                             double * restrict cov) const noexcept {
+  RadialCovariance<MaternNu1p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                      num_derivatives_two, lengths_sq_.data(), alpha_, dim_, cov);
+}
+
+void MaternNu1p5::CovarianceMatrix(double const * restrict points_one,
+                                   double const * restrict points_two,
+                                   int OL_UNUSED(dim), int num_points_one, int num_points_two,
+                                   int const * restrict derivatives_one,
+                                   int num_derivatives_one,
+                                   int const * restrict derivatives_two,
+                                   int num_derivatives_two,
+                                   double * restrict cov_matrix) const noexcept {
+  ScaledPointsTranspose scaled_one;
+  scaled_one.SetPoints(points_one, dim_, num_points_one, lengths_.data());
+  RadialCovarianceMatrix<MaternNu1p5Radial>(scaled_one, points_two, num_points_two, derivatives_one, num_derivatives_one,
+                                            derivatives_two, num_derivatives_two, lengths_.data(), lengths_sq_.data(),
+                                            alpha_, dim_, cov_matrix);
+}
+
+void MaternNu1p5::ScalePointsTranspose(double const * restrict points, int num_points,
+                                       ScaledPointsTranspose * scaled_points) const {
+  scaled_points->SetPoints(points, dim_, num_points, lengths_.data());
+}
+
+void MaternNu1p5::CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                                 double const * restrict points_two, int num_points_two,
+                                                 int const * restrict derivatives_one, int num_derivatives_one,
+                                                 int const * restrict derivatives_two, int num_derivatives_two,
+                                                 double * restrict cov_matrix) const noexcept {
+  RadialCovarianceMatrix<MaternNu1p5Radial>(scaled_one, points_two, num_points_two, derivatives_one, num_derivatives_one,
+                                            derivatives_two, num_derivatives_two, lengths_.data(), lengths_sq_.data(),
+                                            alpha_, dim_, cov_matrix);
+}
+
+void MaternNu1p5::GradCovariance(double const * restrict point_one,
+                                 int const * restrict derivatives_one,
+                                 int num_derivatives_one,
+                                 double const * restrict point_two,
+                                 int const * restrict derivatives_two,
+                                 int num_derivatives_two,
+                                 double * restrict grad_cov) const noexcept {
+  RadialGradCovariance<MaternNu1p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                          num_derivatives_two, lengths_sq_.data(), alpha_, dim_, grad_cov);
+}
+
+void MaternNu1p5::HyperparameterGradCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one,
+                                               int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two,
+                                               int num_derivatives_two,
+                                               double * restrict grad_hyperparameter_cov) const noexcept {
+  RadialHyperparameterGradCovariance<MaternNu1p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two,
+                                                        derivatives_two, num_derivatives_two, lengths_.data(),
+                                                        lengths_sq_.data(), alpha_, dim_, grad_hyperparameter_cov);
+}
+
+double MaternNu1p5::SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                              double * restrict frequencies) const {
+  SampleStudentTFrequencies(dim_, num_frequencies, 3, lengths_.data(), normal_rng, frequencies);
+  return alpha_;
+}
+
+CovarianceInterface * MaternNu1p5::Clone() const {
+  return new MaternNu1p5(*this);
+}
+
+void MaternNu2p5::Initialize() {
+  InitializeCovariance(dim_, alpha_, lengths_, lengths_sq_.data());
+}
+
+MaternNu2p5::MaternNu2p5(int dim, double alpha, std::vector<double> lengths)
+    : dim_(dim), alpha_(alpha), lengths_(lengths), lengths_sq_(dim) {
+  Initialize();
+}
+
+MaternNu2p5::MaternNu2p5(int dim, double alpha, double const * restrict lengths)
+    : MaternNu2p5(dim, alpha, std::vector<double>(lengths, lengths + dim)) {
+}
+
+MaternNu2p5::MaternNu2p5(int dim, double alpha, double length)
+    : MaternNu2p5(dim, alpha, std::vector<double>(dim, length)) {
+}
+
+MaternNu2p5::MaternNu2p5(const MaternNu2p5& OL_UNUSED(source)) = default;
+
+void MaternNu2p5::Covariance(double const * restrict point_one,
+                             int const * restrict derivatives_one,
+                             int num_derivatives_one,
+                             double const * restrict point_two,
+                             int const * restrict derivatives_two,
+                             int num_derivatives_two,
+                             double * restrict cov) const noexcept {
+  RadialCovariance<MaternNu2p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                      num_derivatives_two, lengths_sq_.data(), alpha_, dim_, cov);
+}
+
+void MaternNu2p5::CovarianceMatrix(double const * restrict points_one,
+                                   double const * restrict points_two,
+                                   int OL_UNUSED(dim), int num_points_one, int num_points_two,
+                                   int const * restrict derivatives_one,
+                                   int num_derivatives_one,
+                                   int const * restrict derivatives_two,
+                                   int num_derivatives_two,
+                                   double * restrict cov_matrix) const noexcept {
+  ScaledPointsTranspose scaled_one;
+  scaled_one.SetPoints(points_one, dim_, num_points_one, lengths_.data());
+  RadialCovarianceMatrix<MaternNu2p5Radial>(scaled_one, points_two, num_points_two, derivatives_one, num_derivatives_one,
+                                            derivatives_two, num_derivatives_two, lengths_.data(), lengths_sq_.data(),
+                                            alpha_, dim_, cov_matrix);
+}
+
+void MaternNu2p5::ScalePointsTranspose(double const * restrict points, int num_points,
+                                       ScaledPointsTranspose * scaled_points) const {
+  scaled_points->SetPoints(points, dim_, num_points, lengths_.data());
+}
+
+void MaternNu2p5::CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                                 double const * restrict points_two, int num_points_two,
+                                                 int const * restrict derivatives_one, int num_derivatives_one,
+                                                 int const * restrict derivatives_two, int num_derivatives_two,
+                                                 double * restrict cov_matrix) const noexcept {
+  RadialCovarianceMatrix<MaternNu2p5Radial>(scaled_one, points_two, num_points_two, derivatives_one, num_derivatives_one,
+                                            derivatives_two, num_derivatives_two, lengths_.data(), lengths_sq_.data(),
+                                            alpha_, dim_, cov_matrix);
+}
+
+void MaternNu2p5::GradCovariance(double const * restrict point_one,
+                                 int const * restrict derivatives_one,
+                                 int num_derivatives_one,
+                                 double const * restrict point_two,
+                                 int const * restrict derivatives_two,
+                                 int num_derivatives_two,
+                                 double * restrict grad_cov) const noexcept {
+  RadialGradCovariance<MaternNu2p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two, derivatives_two,
+                                          num_derivatives_two, lengths_sq_.data(), alpha_, dim_, grad_cov);
+}
+
+void MaternNu2p5::HyperparameterGradCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one,
+                                               int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two,
+                                               int num_derivatives_two,
+                                               double * restrict grad_hyperparameter_cov) const noexcept {
+  RadialHyperparameterGradCovariance<MaternNu2p5Radial>(point_one, derivatives_one, num_derivatives_one, point_two,
+                                                        derivatives_two, num_derivatives_two, lengths_.data(),
+                                                        lengths_sq_.data(), alpha_, dim_, grad_hyperparameter_cov);
+}
+
+double MaternNu2p5::SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                              double * restrict frequencies) const {
+  SampleStudentTFrequencies(dim_, num_frequencies, 5, lengths_.data(), normal_rng, frequencies);
+  return alpha_;
+}
+
+CovarianceInterface * MaternNu2p5::Clone() const {
+  return new MaternNu2p5(*this);
+}
+
+
+void AdditiveSquareExponential::Initialize() {
+  const int num_groups_in = num_groups();
+  if (num_groups_in < 1) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "AdditiveSquareExponential needs at least one group.", num_groups_in, 1);
+  }
+  for (int g = 0; g < num_groups_in; ++g) {
+    // validates dim, lengths (size and sign), and alpha_g; fills lengths_sq_
+    InitializeCovariance(dim_, alphas_[g], lengths_, lengths_sq_.data());
   }
 
-  for (int m = 0; m < num_derivatives_one; ++m){
-    grad_hyperparameter_cov[(m+1)*(dim_+1)] = cov_matrix[m+1]/alpha_;
-    index1 = derivatives_one[m];
-    for (int i = 0; i < dim_; ++i) {
-      grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)] = cov_matrix[m+1]*
-                                                    Square((point_one[i] - point_two[i])/lengths_[i])/lengths_[i];
-      if (index1 == i){
-        grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)] -= (2*cov_matrix[0]*(point_two[i]-point_one[i])/lengths_sq_[i])/lengths_[i];
+  group_of_dim_.assign(dim_, -1);
+  hyperparameter_index_of_dim_.assign(dim_, -1);
+  for (int g = 0; g < num_groups_in; ++g) {
+    const int group_size = group_offsets_[g+1] - group_offsets_[g];
+    if (group_size < 1) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "Empty group of dimensions.", group_size, 1);
+    }
+    for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+      const int d = group_dims_[k];
+      if (d < 0 || d >= dim_) {
+        OL_THROW_EXCEPTION(BoundsException<int>, "Group dimension index out of range.", d, 0, dim_ - 1);
+      }
+      if (group_of_dim_[d] != -1) {
+        OL_THROW_EXCEPTION(InvalidValueException<int>, "Dimension belongs to more than one group.", group_of_dim_[d], -1);
       }
+      group_of_dim_[d] = g;
+      // group g's alpha precedes its lengths, after the g earlier alphas and every earlier group's lengths
+      hyperparameter_index_of_dim_[d] = g + 1 + k;
     }
   }
+}
 
-  for (int n = 0; n < num_derivatives_two; ++n){
-    grad_hyperparameter_cov[(n+1)*(dim_+1)*(num_derivatives_one+1)] = cov_matrix[(n+1)*(num_derivatives_one+1)]/alpha_;
-    index2 = derivatives_two[n];
-    for (int i = 0; i < dim_; ++i){
-      grad_hyperparameter_cov[i+1+(n+1)*(dim_+1)*(num_derivatives_one+1)] = cov_matrix[(n+1)*(num_derivatives_one+1)]*
-                                                                         Square((point_one[i] - point_two[i])/lengths_[i])/lengths_[i];
-      if (index2 == i){
-        grad_hyperparameter_cov[i+1+(n+1)*(dim_+1)*(num_derivatives_one+1)] -= (2*cov_matrix[0]*(point_one[i]-point_two[i])/lengths_sq_[i])/lengths_[i];
+AdditiveSquareExponential::AdditiveSquareExponential(int dim, const std::vector<std::vector<int> >& groups,
+                                                     std::vector<double> alphas, std::vector<double> lengths)
+    : dim_(dim),
+      group_dims_(),
+      group_offsets_(1, 0),
+      group_of_dim_(),
+      hyperparameter_index_of_dim_(),
+      alphas_(alphas),
+      lengths_(lengths),
+      lengths_sq_(lengths.size()) {
+  if (alphas_.size() != groups.size()) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Number of groups (truth) and number of alphas do not match.",
+                       alphas_.size(), groups.size());
+  }
+  for (const auto& group : groups) {
+    group_dims_.insert(group_dims_.end(), group.begin(), group.end());
+    group_offsets_.push_back(group_dims_.size());
+  }
+  Initialize();
+}
+
+AdditiveSquareExponential::AdditiveSquareExponential(const AdditiveSquareExponential& OL_UNUSED(source)) = default;
+
+double AdditiveSquareExponential::GroupKernel(int group, double const * restrict point_one,
+                                              double const * restrict point_two) const noexcept {
+  double norm_sq = 0.0;
+  for (int k = group_offsets_[group]; k < group_offsets_[group+1]; ++k) {
+    const int d = group_dims_[k];
+    norm_sq += Square(point_one[d] - point_two[d])/lengths_sq_[d];
+  }
+  return alphas_[group]*std::exp(-0.5*norm_sq);
+}
+
+void AdditiveSquareExponential::AccumulatePairKernels(double const * restrict squared_differences, int num_pairs,
+                                                      double * restrict kernel) const {
+  std::vector<double> norm_sq(num_pairs);
+  for (int g = 0; g < num_groups(); ++g) {
+    std::fill(norm_sq.begin(), norm_sq.end(), 0.0);
+    for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+      const int d = group_dims_[k];
+      double const * restrict squared_differences_row = squared_differences + d*num_pairs;
+      const double inverse_length_sq = 1.0/lengths_sq_[d];
+      for (int p = 0; p < num_pairs; ++p) {
+        norm_sq[p] += squared_differences_row[p]*inverse_length_sq;
       }
     }
+    const double alpha = alphas_[g];
+    for (int p = 0; p < num_pairs; ++p) {
+      kernel[p] += alpha*std::exp(-0.5*norm_sq[p]);
+    }
   }
+}
 
-  for (int m = 0; m < num_derivatives_one; ++m){
-    index1 = derivatives_one[m];
-    for (int n = 0; n < num_derivatives_two; ++n){
-      index2 = derivatives_two[n];
-      grad_hyperparameter_cov[(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] = cov_matrix[m+1+(n+1)*(num_derivatives_one+1)]/alpha_;
-      for (int i = 0; i < dim_; ++i){
-        grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] = cov_matrix[m+1+(n+1)*(num_derivatives_one+1)]*
-                                                                                    Square((point_one[i] - point_two[i])/lengths_[i])/lengths_[i];
-        if (index1 == index2){
-          if (index1 == i){
-            grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] += ((4*cov_matrix[0]*Square(point_one[i]-point_two[i])/
-                                                                                         lengths_sq_[i])/lengths_sq_[i])/lengths_[i];
-            grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] -= (2*cov_matrix[0]/lengths_sq_[i])/lengths_[i];
-          }
-        }
-        else{
-          if (index1 == i){
-            grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] -= (2*cov_matrix[(n+1)*(num_derivatives_one+1)]*
-                                                                                         (point_two[i]-point_one[i])/lengths_sq_[i])/lengths_[i];
-          }
-          if (index2 == i){
-            grad_hyperparameter_cov[i+1+(m+1)*(dim_+1)+(n+1)*(dim_+1)*(num_derivatives_one+1)] -= (2*cov_matrix[m+1]*
-                                                                                         (point_one[i]-point_two[i])/lengths_sq_[i])/lengths_[i];
-          }
-        }
+/*
+  With f_g the group kernel and v_d = (x_{1,d} - x_{2,d})/L_d^2, the SquareExponential blocks restricted to one group:
+  cov = \sum_g f_g, d/dx_{1,m} = -f_{g(m)} v_m, d/dx_{2,n} = f_{g(n)} v_n,
+  d^2/dx_{1,m} dx_{2,n} = [g(m) == g(n)] f_{g(m)} (\delta_{mn}/L_m^2 - v_m v_n); ungrouped dimensions contribute 0.
+*/
+void AdditiveSquareExponential::Covariance(double const * restrict point_one,
+                                           int const * restrict derivatives_one,
+                                           int num_derivatives_one,
+                                           double const * restrict point_two,
+                                           int const * restrict derivatives_two,
+                                           int num_derivatives_two,
+                                           double * restrict cov) const noexcept {
+  auto distance = [this, point_one, point_two](int i) {
+    return (point_one[i] - point_two[i])/lengths_sq_[i];
+  };
+  const int leading_dim = 1 + num_derivatives_one;
+
+  cov[0] = 0.0;
+  for (int g = 0; g < num_groups(); ++g) {
+    cov[0] += GroupKernel(g, point_one, point_two);
+  }
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const int group = group_of_dim_[index1];
+    cov[m+1] = group < 0 ? 0.0 : -(GroupKernel(group, point_one, point_two)*distance(index1));
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const int group = group_of_dim_[index2];
+    double * restrict cov_col = cov + (n+1)*leading_dim;
+    if (group < 0) {
+      std::fill(cov_col, cov_col + leading_dim, 0.0);
+      continue;
+    }
+    const double kernel = GroupKernel(group, point_one, point_two);
+    const double derivative_point_two = distance(index2);
+    cov_col[0] = kernel*derivative_point_two;
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      if (group_of_dim_[index1] != group) {
+        cov_col[m+1] = 0.0;
+      } else {
+        cov_col[m+1] = kernel*((index1 == index2 ? 1.0/lengths_sq_[index1] : 0.0) -
+                               distance(index1)*derivative_point_two);
       }
     }
   }
+}
+
+void AdditiveSquareExponential::SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                                          double * restrict cov_matrix) const noexcept {
+  if (!differences.cached() || differences.num_derivatives != 0) {
+    CovarianceInterface::SymmetricCovarianceMatrix(differences, cov_matrix);
+    return;
+  }
 
-  delete [] cov_matrix;
+  const int num_points = differences.num_points;
+  std::vector<double> kernel(differences.num_pairs, 0.0);
+  AccumulatePairKernels(differences.squared_differences.data(), differences.num_pairs, kernel.data());
+  // pairs run down the lower triangle, column by column
+  int p = 0;
+  for (int i = 0; i < num_points; ++i) {
+    for (int j = i; j < num_points; ++j, ++p) {
+      cov_matrix[j + i*num_points] = kernel[p];
+      cov_matrix[i + j*num_points] = kernel[p];
+    }
+  }
 }
 
-CovarianceInterface * SquareExponential::Clone() const {
-  return new SquareExponential(*this);
+void AdditiveSquareExponential::CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                                      int const * restrict derivatives_one, int num_derivatives_one,
+                                                      int const * restrict derivatives_two, int num_derivatives_two,
+                                                      double * restrict cov_matrix) const noexcept {
+  if (differences.squared_differences.empty() || num_derivatives_one != 0 || num_derivatives_two != 0) {
+    CovarianceInterface::CrossCovarianceMatrix(differences, derivatives_one, num_derivatives_one,
+                                               derivatives_two, num_derivatives_two, cov_matrix);
+    return;
+  }
+
+  // pair p = i + j*num_points_one is exactly entry (i, j) of the column-major [num_points_two][num_points_one] output
+  const int num_pairs = differences.num_points_one*differences.num_points_two;
+  std::fill(cov_matrix, cov_matrix + num_pairs, 0.0);
+  AccumulatePairKernels(differences.squared_differences.data(), num_pairs, cov_matrix);
 }
 
-//void MaternNu2p5::Initialize() {
-//  InitializeCovariance(dim_, alpha_, lengths_, lengths_sq_.data());
-//}
-//
-//MaternNu2p5::MaternNu2p5(int dim, double alpha, std::vector<double> lengths)
-//    : dim_(dim), alpha_(alpha), lengths_(lengths), lengths_sq_(dim) {
-//  Initialize();
-//}
-//
-//MaternNu2p5::MaternNu2p5(int dim, double alpha, double const * restrict lengths)
-//    : MaternNu2p5(dim, alpha, std::vector<double>(lengths, lengths + dim)) {
-//}
-//
-//MaternNu2p5::MaternNu2p5(int dim, double alpha, double length)
-//    : MaternNu2p5(dim, alpha, std::vector<double>(dim, length)) {
-//}
-//
-//MaternNu2p5::MaternNu2p5(const MaternNu2p5& OL_UNUSED(source)) = default;
-//
-//double MaternNu2p5::Covariance(double const * restrict point_one,
-//                               double const * restrict point_two) const noexcept {
-//  const double norm_val = NormSquaredWithInverseWeights(point_one, point_two, lengths_sq_.data(), dim_);
-//  const double matern_arg = kSqrt5 * std::sqrt(norm_val);
-//
-//  return alpha_*(1.0 + matern_arg + 5.0/3.0*norm_val)*std::exp(-matern_arg);
-//}
-//
-//void MaternNu2p5::GradCovariance(double const * restrict point_one,
-//                                 double const * restrict point_two,
-//                                 double * restrict grad_cov) const noexcept {
-//  const double norm_val = NormSquaredWithInverseWeights(point_one, point_two, lengths_sq_.data(), dim_);
-//  if (norm_val == 0.0) {
-//    std::fill(grad_cov, grad_cov + dim_, 0.0);
-//    return;
-//  }
-//  const double matern_arg = kSqrt5 * std::sqrt(norm_val);
-//  const double poly_part = matern_arg + 5.0/3.0*norm_val;
-//  const double exp_part = std::exp(-matern_arg);
-//
-//  for (int i = 0; i < dim_; ++i) {
-//    const double dr2_dxi = 2.0*(point_one[i] - point_two[i])/lengths_sq_[i];
-//    const double dr_dxi = 0.5*dr2_dxi/std::sqrt(norm_val);
-//    grad_cov[i] = alpha_*exp_part*(5.0/3.0*dr2_dxi - poly_part*kSqrt5*dr_dxi);
-//  }
-//}
-//
-//void MaternNu2p5::HyperparameterGradCovariance(double const * restrict point_one,
-//                                               double const * restrict point_two,
-//                                               double * restrict grad_hyperparameter_cov) const noexcept {
-//  const double norm_val = NormSquaredWithInverseWeights(point_one, point_two, lengths_sq_.data(), dim_);
-//  if (norm_val == 0.0) {
-//    grad_hyperparameter_cov[0] = 1.0;
-//    std::fill(grad_hyperparameter_cov+1, grad_hyperparameter_cov + 1+dim_, 0.0);
-//    return;
-//  }
-//  const double matern_arg = kSqrt5 * std::sqrt(norm_val);
-//  const double poly_part = matern_arg + 5.0/3.0*norm_val;
-//  const double exp_part = std::exp(-matern_arg);
-//
-//  // deriv wrt alpha does not have the same form as the length terms, special case it
-//  grad_hyperparameter_cov[0] = (1.0 + poly_part) * exp_part;
-//  // terms from differentiating Covariance wrt spatial dimensions; since exp(x) is the derivative's identity, some cancellation of
-//  // analytic 0s is possible (and desired since it reduces compute-time and is more accurate)
-//  for (int i = 0; i < dim_; ++i) {
-//    const double dr2_dleni = -2.0*Square((point_one[i] - point_two[i])/lengths_[i])/lengths_[i];
-//    const double dr_dleni = 0.5*dr2_dleni/std::sqrt(norm_val);
-//    grad_hyperparameter_cov[i+1] = alpha_*exp_part*(5.0/3.0*dr2_dleni - poly_part*kSqrt5*dr_dleni);
-//  }
-//}
-//
-//CovarianceInterface * MaternNu2p5::Clone() const {
-//  return new MaternNu2p5(*this);
-//}
+/*
+  Differentiating the blocks of Covariance() wrt x_{1,i} (only i in the block's group contributes; with
+  d f_g/dx_{1,i} = -f_g v_i and d v_m/dx_{1,i} = \delta_{im}/L_m^2):
+  -f v_i, f (v_i v_m - \delta_{im}/L_m^2), f (\delta_{in}/L_n^2 - v_i v_n), and
+  -f (v_i (\delta_{mn}/L_m^2 - v_m v_n) + \delta_{im} v_n/L_m^2 + \delta_{in} v_m/L_n^2).
+*/
+void AdditiveSquareExponential::GradCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one,
+                                               int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two,
+                                               int num_derivatives_two,
+                                               double * restrict grad_cov) const noexcept {
+  auto distance = [this, point_one, point_two](int i) {
+    return (point_one[i] - point_two[i])/lengths_sq_[i];
+  };
+  const int block_stride_two = dim_*(num_derivatives_one+1);
+  std::fill(grad_cov, grad_cov + block_stride_two*(num_derivatives_two+1), 0.0);
+
+  for (int g = 0; g < num_groups(); ++g) {
+    const double kernel = GroupKernel(g, point_one, point_two);
+    for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+      const int i = group_dims_[k];
+      grad_cov[i] = -(kernel*distance(i));
+    }
+  }
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const int group = group_of_dim_[index1];
+    if (group < 0) {
+      continue;
+    }
+    const double kernel = GroupKernel(group, point_one, point_two);
+    const double coefficient = kernel*distance(index1);
+    double * restrict grad_block = grad_cov + (m+1)*dim_;
+    for (int k = group_offsets_[group]; k < group_offsets_[group+1]; ++k) {
+      const int i = group_dims_[k];
+      grad_block[i] = coefficient*distance(i);
+    }
+    grad_block[index1] -= kernel/lengths_sq_[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const int group = group_of_dim_[index2];
+    if (group < 0) {
+      continue;
+    }
+    const double kernel = GroupKernel(group, point_one, point_two);
+    const double derivative_point_two = distance(index2);
+    double * restrict grad_col = grad_cov + (n+1)*block_stride_two;
+    for (int k = group_offsets_[group]; k < group_offsets_[group+1]; ++k) {
+      const int i = group_dims_[k];
+      grad_col[i] = -(kernel*derivative_point_two*distance(i));
+    }
+    grad_col[index2] += kernel/lengths_sq_[index2];
+
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      if (group_of_dim_[index1] != group) {
+        continue;
+      }
+      const double derivative_point_one = distance(index1);
+      const double hessian_entry = (index1 == index2 ? 1.0/lengths_sq_[index1] : 0.0) -
+          derivative_point_one*derivative_point_two;
+      double * restrict grad_block = grad_col + (m+1)*dim_;
+      for (int k = group_offsets_[group]; k < group_offsets_[group+1]; ++k) {
+        const int i = group_dims_[k];
+        grad_block[i] = -(kernel*hessian_entry*distance(i));
+      }
+      grad_block[index1] -= kernel*derivative_point_two/lengths_sq_[index1];
+      grad_block[index2] -= kernel*derivative_point_one/lengths_sq_[index2];
+    }
+  }
+}
+
+/*
+  Each block of Covariance() is c = f_g * (polynomial in v), so d/d\alpha_g = c/\alpha_g and d/dL_j = c w_j (j in the
+  group, w_j = (x_{1,j} - x_{2,j})^2/L_j^3) plus the d v/dL_j = -2 \delta v/L_j corrections at the observed dimensions.
+  Hyperparameters of other groups get 0.
+*/
+void AdditiveSquareExponential::HyperparameterGradCovariance(double const * restrict point_one,
+                                                             int const * restrict derivatives_one,
+                                                             int num_derivatives_one,
+                                                             double const * restrict point_two,
+                                                             int const * restrict derivatives_two,
+                                                             int num_derivatives_two,
+                                                             double * restrict grad_hyperparameter_cov) const noexcept {
+  auto distance = [this, point_one, point_two](int i) {
+    return (point_one[i] - point_two[i])/lengths_sq_[i];
+  };
+  const int num_hyperparameters = GetNumberOfHyperparameters();
+  // fills group g's entries of one [num_hyperparameters] block from the block's covariance entry
+  auto fill_group = [=](int g, double cov_entry, double * restrict grad_block) {
+    grad_block[group_offsets_[g] + g] = cov_entry/alphas_[g];
+    for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+      const int j = group_dims_[k];
+      grad_block[g + 1 + k] = cov_entry*(Square((point_one[j] - point_two[j])/lengths_[j])/lengths_[j]);
+    }
+  };
+  const int block_stride_two = num_hyperparameters*(num_derivatives_one+1);
+  std::fill(grad_hyperparameter_cov, grad_hyperparameter_cov + block_stride_two*(num_derivatives_two+1), 0.0);
+
+  for (int g = 0; g < num_groups(); ++g) {
+    fill_group(g, GroupKernel(g, point_one, point_two), grad_hyperparameter_cov);
+  }
+
+  for (int m = 0; m < num_derivatives_one; ++m) {
+    const int index1 = derivatives_one[m];
+    const int group = group_of_dim_[index1];
+    if (group < 0) {
+      continue;
+    }
+    const double kernel = GroupKernel(group, point_one, point_two);
+    const double derivative_point_one = distance(index1);
+    double * restrict grad_block = grad_hyperparameter_cov + (m+1)*num_hyperparameters;
+    fill_group(group, -(kernel*derivative_point_one), grad_block);
+    grad_block[hyperparameter_index_of_dim_[index1]] += 2.0*kernel*derivative_point_one/lengths_[index1];
+  }
+
+  for (int n = 0; n < num_derivatives_two; ++n) {
+    const int index2 = derivatives_two[n];
+    const int group = group_of_dim_[index2];
+    if (group < 0) {
+      continue;
+    }
+    const double kernel = GroupKernel(group, point_one, point_two);
+    const double derivative_point_two = distance(index2);
+    double * restrict grad_col = grad_hyperparameter_cov + (n+1)*block_stride_two;
+    fill_group(group, kernel*derivative_point_two, grad_col);
+    grad_col[hyperparameter_index_of_dim_[index2]] -= 2.0*kernel*derivative_point_two/lengths_[index2];
+
+    for (int m = 0; m < num_derivatives_one; ++m) {
+      const int index1 = derivatives_one[m];
+      if (group_of_dim_[index1] != group) {
+        continue;
+      }
+      const double product = distance(index1)*derivative_point_two;
+      const bool diagonal = index1 == index2;
+      double * restrict grad_block = grad_col + (m+1)*num_hyperparameters;
+      fill_group(group, kernel*((diagonal ? 1.0/lengths_sq_[index1] : 0.0) - product), grad_block);
+      grad_block[hyperparameter_index_of_dim_[index1]] += 2.0*kernel*product/lengths_[index1];
+      grad_block[hyperparameter_index_of_dim_[index2]] += 2.0*kernel*product/lengths_[index2];
+      if (diagonal) {
+        grad_block[hyperparameter_index_of_dim_[index1]] -= 2.0*kernel/(lengths_sq_[index1]*lengths_[index1]);
+      }
+    }
+  }
+}
+
+double AdditiveSquareExponential::SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                                            double * restrict frequencies) const {
+  // k = \sum_g \alpha_g k_g, so its normalized spectral density is the \alpha-weighted mixture of the groups'
+  double alpha_total = 0.0;
+  for (double alpha : alphas_) {
+    alpha_total += alpha;
+  }
+
+  const double kInverseSqrt2 = 1.0/std::sqrt(2.0);
+  std::fill(frequencies, frequencies + dim_*num_frequencies, 0.0);
+  for (int j = 0; j < num_frequencies; ++j) {
+    // Phi(z) ~ U(0, 1) picks the mixture component
+    const double uniform = 0.5*std::erfc(-(*normal_rng)()*kInverseSqrt2);
+    double cumulative = 0.0;
+    int group = 0;
+    for (; group < num_groups() - 1; ++group) {
+      cumulative += alphas_[group]/alpha_total;
+      if (uniform < cumulative) {
+        break;
+      }
+    }
+    for (int k = group_offsets_[group]; k < group_offsets_[group+1]; ++k) {
+      const int d = group_dims_[k];
+      frequencies[j*dim_ + d] = (*normal_rng)()/lengths_[d];
+    }
+  }
+  return alpha_total;
+}
+
+CovarianceInterface * AdditiveSquareExponential::Clone() const {
+  return new AdditiveSquareExponential(*this);
+}
+
+namespace {
+
+//! points per side of the tiles built by BuildSymmetricCovarianceMatrixInParallel()
+constexpr int kSymmetricCovarianceTileSize = 256;
+
+}  // end unnamed namespace
+
+void BuildSymmetricCovarianceMatrixInParallel(const CovarianceInterface& covariance, double const * restrict points,
+                                              int dim, int num_points, int const * restrict derivatives,
+                                              int num_derivatives, double * restrict cov_matrix) noexcept {
+  const int num_tiles = (num_points + kSymmetricCovarianceTileSize - 1)/kSymmetricCovarianceTileSize;
+  if (num_tiles < 2) {
+    covariance.CovarianceMatrix(points, points, dim, num_points, num_points, derivatives, num_derivatives,
+                                derivatives, num_derivatives, cov_matrix);
+    return;
+  }
+
+  // (tile row, tile column) of every tile on or below the diagonal
+  std::vector<std::pair<int, int>> lower_tiles;
+  lower_tiles.reserve(num_tiles*(num_tiles + 1)/2);
+  for (int tile_j = 0; tile_j < num_tiles; ++tile_j) {
+    for (int tile_i = tile_j; tile_i < num_tiles; ++tile_i) {
+      lower_tiles.emplace_back(tile_i, tile_j);
+    }
+  }
+
+  const int block_size = 1 + num_derivatives;
+  const int num_rows = num_points*block_size;
+  ParallelForEachIndex(NumThreadsForInnerLoops(), static_cast<int>(lower_tiles.size()), [&](int t) {
+      const int first_i = lower_tiles[t].first*kSymmetricCovarianceTileSize;
+      const int first_j = lower_tiles[t].second*kSymmetricCovarianceTileSize;
+      const int num_points_i = std::min(kSymmetricCovarianceTileSize, num_points - first_i);
+      const int num_points_j = std::min(kSymmetricCovarianceTileSize, num_points - first_j);
+      const int tile_rows = num_points_i*block_size;
+      const int tile_cols = num_points_j*block_size;
+      std::vector<double> tile(tile_rows*tile_cols);
+      covariance.CovarianceMatrix(points + first_i*dim, points + first_j*dim, dim, num_points_i, num_points_j,
+                                  derivatives, num_derivatives, derivatives, num_derivatives, tile.data());
+
+      const bool mirror = first_i != first_j;
+      for (int c = 0; c < tile_cols; ++c) {
+        const int col = first_j*block_size + c;
+        for (int r = 0; r < tile_rows; ++r) {
+          const int row = first_i*block_size + r;
+          cov_matrix[row + col*num_rows] = tile[r + c*tile_rows];
+          if (mirror) {
+            cov_matrix[col + row*num_rows] = tile[r + c*tile_rows];
+          }
+        }
+      }
+    });
+}
 
 }  // end namespace optimal_learning
\ No newline at end of file
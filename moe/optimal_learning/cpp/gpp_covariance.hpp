@@ -2,8 +2,9 @@
   \file gpp_covariance.hpp
   \rst
   This file specifies CovarianceInterface, the interface for all covariance functions used by the optimal learning
-  code base.  It defines two main covariance functions subclassing this interface, Square Exponential,
-  and Matern with \nu = 2.5. We denote a generic covariance function as: ``k(x,x')``
+  code base.  It defines four covariance functions subclassing this interface: Square Exponential,
+  Matern with \nu = 1.5 and \nu = 2.5, and an additive sum of Square Exponentials over disjoint groups of dimensions.
+  We denote a generic covariance function as: ``k(x,x')``
 
   Covariance functions have a few fundamental properties (see references at the bottom for full details).  In short,
   they are SPSD (symmetric positive semi-definite): ``k(x,x') = k(x', x)`` for any ``x, x'`` and
@@ -29,9 +30,10 @@
   Then we can incoporate the gradients' observations into the GP model. The Bayesian optimization algorithms carry on.
   See details in (3).
 
-  Currently, all covariance functions in this file require ``dim+1`` hyperparameters: ``\alpha, L_1, ... L_d``. ``\alpha``
-  is ``\sigma_f^2``, the signal variance. ``L_1, ... , L_d`` are the length scales, one per spatial dimension.  We do not
-  currently support non-axis-aligned anisotropy.
+  Except for AdditiveSquareExponential, the covariance functions in this file require ``dim+1`` hyperparameters:
+  ``\alpha, L_1, ... L_d``. ``\alpha`` is ``\sigma_f^2``, the signal variance. ``L_1, ... , L_d`` are the length scales,
+  one per spatial dimension.  AdditiveSquareExponential has one ``\alpha`` per group of dimensions, followed by that
+  group's length scales.  We do not currently support non-axis-aligned anisotropy.
 
   Specifying hyperparameters is tricky because changing them fundamentally changes the behavior of the GP.
   gpp_model_selection.hpp provides some functions for evaluating/optimizing hyperparameters based on the current training data.
@@ -51,6 +53,165 @@
 
 namespace optimal_learning {
 
+class NormalRNGInterface;
+
+/*!\rst
+  Hyperparameter-independent geometry of one list of points, shared by every covariance matrix built over that list.
+
+  Model selection (e.g., EvaluateLogLikelihoodAtPointList(), LatinHypercubeSearchHyperparameterOptimization()) rebuilds
+  ``K(X, X)`` of the same training points for many hyperparameters, on many threads.  The squared coordinate differences
+  ``(x_{j,d} - x_{i,d})^2`` do not depend on the hyperparameters, so we compute them once here and covariances that can
+  use them (see CovarianceInterface::SymmetricCovarianceMatrix()) only rescale and exponentiate the cached tensor.
+
+  Pairs are the lower triangle ``j >= i`` of the point list, numbered column by column: pair ``p`` runs over
+  ``(i=0, j=0), (i=0, j=1), ..., (i=0, j=num_points-1), (i=1, j=1), ...``.
+
+  The cache costs ``dim * num_points * (num_points+1)/2`` doubles; past kMaxSquaredDifferencesSize it is not built
+  (``squared_differences`` is empty) and consumers fall back to working from the raw points.
+\endrst*/
+struct PairwiseDifferences final {
+  //! largest ``dim * num_pairs`` for which the squared differences are cached (256MB)
+  static constexpr int kMaxSquaredDifferencesSize = 1 << 25;
+
+  /*!\rst
+    Copies the points (and the derivative indices observed at each point) and caches their squared differences.
+
+    \param
+      :points_in[dim][num_points]: the point list
+      :dim_in: spatial dimension of a point
+      :num_points_in: number of points
+      :derivatives_in[num_derivatives_in]: which derivatives are observed at every point
+      :num_derivatives_in: number of derivatives observed at every point
+  \endrst*/
+  PairwiseDifferences(double const * restrict points_in, int dim_in, int num_points_in,
+                      int const * restrict derivatives_in, int num_derivatives_in);
+
+  //! true if squared_differences holds the cache (otherwise only the raw points are available)
+  bool cached() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return !squared_differences.empty();
+  }
+
+  //! spatial dimension of a point
+  int dim;
+  //! number of points
+  int num_points;
+  //! number of (unordered, self-inclusive) pairs, ``num_points*(num_points+1)/2``
+  int num_pairs;
+  //! number of derivatives observed at every point
+  int num_derivatives;
+  //! which derivatives are observed at every point
+  std::vector<int> derivatives;
+  //! the point list
+  std::vector<double> points;
+  //! ``(x_{j,d} - x_{i,d})^2`` of pair ``p = (i, j)``, stored as ``squared_differences[num_pairs][dim]`` (pairs contiguous)
+  std::vector<double> squared_differences;
+};
+
+/*!\rst
+  Hyperparameter-independent geometry between two point lists, e.g., the training points ``X`` and the points ``Xs`` at
+  which a GP is being evaluated: the squared coordinate differences ``(x_{j,d} - x_{i,d})^2`` of every pair
+  ``(x_i in points_one, x_j in points_two)``.
+
+  GaussianProcessMCMC evaluates one GP per hyperparameter sample, all over the same ``X``, at the same ``Xs``; the MCMC
+  states fill one of these per evaluation point and every member's ``K(X, Xs)`` build reads it (see
+  CovarianceInterface::CrossCovarianceMatrix() and PointsToSampleState::cross_differences) instead of redoing the
+  difference work ``num_mcmc`` times.
+
+  Pair ``(i, j)`` is numbered ``i + j*num_points_one``, the column-major index of ``K(X, Xs)`` without derivatives.  As
+  with PairwiseDifferences, the cache is skipped (``squared_differences`` is empty) past
+  PairwiseDifferences::kMaxSquaredDifferencesSize.
+\endrst*/
+struct CrossPairwiseDifferences final {
+  //! Constructs an empty cache (no points); fill it with SetPoints().
+  explicit CrossPairwiseDifferences(int dim_in);
+
+  /*!\rst
+    Refills the cache for a new pair of point lists.  ``points_one`` is NOT copied (it is the training data, which
+    outlives the cache and is identified by address); ``points_two`` is.
+
+    \param
+      :points_one_in[dim][num_points_one]: first point list (e.g., ``points_sampled``)
+      :num_points_one_in: number of points in ``points_one``
+      :points_two_in[dim][num_points_two]: second point list (e.g., ``points_to_sample``)
+      :num_points_two_in: number of points in ``points_two``
+  \endrst*/
+  void SetPoints(double const * restrict points_one_in, int num_points_one_in,
+                 double const * restrict points_two_in, int num_points_two_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \return
+      true if the cache holds the squared differences between these two point lists (``points_one`` by address,
+      ``points_two`` by value)
+  \endrst*/
+  bool Matches(double const * restrict points_one_in, int num_points_one_in,
+               double const * restrict points_two_in, int num_points_two_in) const noexcept OL_WARN_UNUSED_RESULT;
+
+  //! spatial dimension of a point
+  int dim;
+  //! number of points in points_one
+  int num_points_one;
+  //! number of points in points_two
+  int num_points_two;
+  //! first point list (not owned)
+  double const * points_one;
+  //! second point list
+  std::vector<double> points_two;
+  //! ``(x_{j,d} - x_{i,d})^2`` of pair ``p = i + j*num_points_one``, stored as ``squared_differences[num_pairs][dim]``
+  //! (pairs contiguous)
+  std::vector<double> squared_differences;
+};
+
+/*!\rst
+  Length-scaled copy of a point list (e.g., a GP's ``points_sampled``) in structure-of-arrays layout:
+  ``scaled_points[d*leading_dim + i] = x_{i,d} / L_d``.  Each coordinate of all the points is one contiguous row, so
+  covariance matrix builds run unit-stride over the whole list for each point of the other list (and vectorize) instead
+  of walking one short ``[dim]`` row per pair.  Rows are zero-padded to a multiple of kRowPadding points, so each row
+  starts at the same offset modulo a vector register.
+
+  Filled by CovarianceInterface::ScalePointsTranspose() for that covariance's hyperparameters (refill it after they
+  change) and read by CovarianceInterface::CovarianceMatrixOfScaledPoints().  As with CrossPairwiseDifferences, the
+  points are NOT copied; they are identified by address.  ``scaled_points`` is empty if the covariance does not use
+  this layout.
+\endrst*/
+struct ScaledPointsTranspose final {
+  //! rows of scaled_points are padded to a multiple of this many points (8 doubles fill one AVX-512 register)
+  static constexpr int kRowPadding = 8;
+
+  //! Constructs an empty copy (no points); fill it with SetPoints() or CovarianceInterface::ScalePointsTranspose().
+  ScaledPointsTranspose();
+
+  /*!\rst
+    Refills the copy for a new point list and length scales.
+
+    \param
+      :points_in[dim][num_points]: the point list (not copied; must outlive this object's use)
+      :dim_in: spatial dimension of a point
+      :num_points_in: number of points
+      :lengths[dim]: the length scales ``L``
+  \endrst*/
+  void SetPoints(double const * restrict points_in, int dim_in, int num_points_in,
+                 double const * restrict lengths) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \return
+      true if this holds a scaled copy of these points (by address and count)
+  \endrst*/
+  bool Matches(double const * restrict points_in, int num_points_in) const noexcept OL_WARN_UNUSED_RESULT {
+    return !scaled_points.empty() && points_in == points && num_points_in == num_points;
+  }
+
+  //! spatial dimension of a point
+  int dim;
+  //! number of points
+  int num_points;
+  //! length of each row of scaled_points: num_points rounded up to a multiple of kRowPadding
+  int leading_dim;
+  //! the point list (not owned)
+  double const * points;
+  //! ``[dim][leading_dim]`` length-scaled coordinates, padding entries 0
+  std::vector<double> scaled_points;
+};
+
 /*!\rst
   Abstract class to enable evaluation of covariance functions--supports the evaluation of the covariance between two
   points, as well as the gradient with respect to those coordinates and gradient/hessian with respect to the
@@ -61,7 +222,8 @@ namespace optimal_learning {
 
   Hyperparameters (denoted ``\theta_j``) are stored as class member data by subclasses.
 
-  This class has *only* pure virtual functions, making it abstract. Users cannot instantiate this class directly.
+  This class is abstract: apart from CovarianceMatrix() (which has a pairwise default implementation), all of its
+  functions are pure virtual. Users cannot instantiate this class directly.
 \endrst*/
 class CovarianceInterface {
  public:
@@ -93,6 +255,122 @@ class CovarianceInterface {
                           int num_derivatives_two,
                           double * restrict cov) const noexcept OL_WARN_UNUSED_RESULT = 0;
 
+  /*!\rst
+    Computes the joint covariance matrix of two lists of points, with each point contributing its function value
+    and the derivatives listed in derivatives_one (resp. derivatives_two).  Block ``(i, j)`` of the output is
+    ``Covariance(points_one_i, points_two_j)``; i.e., this is the "mix" covariance matrix built by
+    BuildMixCovarianceMatrix() in gpp_math.cpp.
+
+    The default implementation calls Covariance() once per pair of points.  Subclasses should override it when the
+    covariance can share work across pairs (e.g., computing all pairwise distances at once).
+
+    When ``points_one == points_two`` (same pointer, count, and derivatives), the output is symmetric and
+    implementations may exploit that; the full matrix is still filled.
+
+    \param
+      :points_one[dim][num_points_one]: first list of points
+      :points_two[dim][num_points_two]: second list of points
+      :dim: spatial dimension of a point
+      :num_points_one: number of points in points_one
+      :num_points_two: number of points in points_two
+      :derivatives_one[num_derivatives_one]: which derivatives of points_one are available
+      :num_derivatives_one: int, the number of derivatives of each point in points_one
+      :derivatives_two[num_derivatives_two]: which derivatives of points_two are available
+      :num_derivatives_two: int, the number of derivatives of each point in points_two
+    \output
+      :cov_matrix[num_points_one*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]:
+      covariance between the function values and gradients of every pair of input points
+  \endrst*/
+  virtual void CovarianceMatrix(double const * restrict points_one,
+                                double const * restrict points_two,
+                                int dim, int num_points_one, int num_points_two,
+                                int const * restrict derivatives_one,
+                                int num_derivatives_one,
+                                int const * restrict derivatives_two,
+                                int num_derivatives_two,
+                                double * restrict cov_matrix) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes the symmetric covariance matrix ``K(X, X)`` of the point list cached in ``differences`` (including the
+    derivative observations listed there); i.e., the same output as
+    ``CovarianceMatrix(X, X, dim, n, n, derivatives, num_derivatives, derivatives, num_derivatives, cov_matrix)``.
+
+    The default implementation calls CovarianceMatrix() on tiles of ``differences.points`` in parallel (see
+    BuildSymmetricCovarianceMatrixInParallel()).  Subclasses whose kernels depend on the points only through
+    ``(x_{j,d} - x_{i,d})^2`` should override it to skip recomputing those differences.
+
+    \param
+      :differences: the point list and its cached squared coordinate differences
+    \output
+      :cov_matrix[n*(1+num_derivatives)][n*(1+num_derivatives)]: covariance matrix of the point list, with
+        ``n = differences.num_points``
+  \endrst*/
+  virtual void SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                         double * restrict cov_matrix) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes the cross covariance matrix ``K(X1, X2)`` of the two point lists cached in ``differences``; i.e., the same
+    output as ``CovarianceMatrix(X1, X2, dim, n1, n2, derivatives_one, num_derivatives_one, derivatives_two,
+    num_derivatives_two, cov_matrix)``.
+
+    The default implementation calls CovarianceMatrix() on the points.  Subclasses whose kernels depend on the points
+    only through ``(x_{j,d} - x_{i,d})^2`` should override it to skip recomputing those differences.
+
+    \param
+      :differences: the two point lists and their cached squared coordinate differences
+      :derivatives_one[num_derivatives_one]: which derivatives are observed at the points of ``X1``
+      :num_derivatives_one: number of derivatives observed at the points of ``X1``
+      :derivatives_two[num_derivatives_two]: which derivatives are observed at the points of ``X2``
+      :num_derivatives_two: number of derivatives observed at the points of ``X2``
+    \output
+      :cov_matrix[n2*(1+num_derivatives_two)][n1*(1+num_derivatives_one)]: covariance matrix between the lists
+  \endrst*/
+  virtual void CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                     int const * restrict derivatives_one, int num_derivatives_one,
+                                     int const * restrict derivatives_two, int num_derivatives_two,
+                                     double * restrict cov_matrix) const noexcept;
+
+  /*!\rst
+    Fills ``scaled_points`` with ``points`` in the layout that CovarianceMatrixOfScaledPoints() reads, for the current
+    hyperparameters, so that repeated builds against the same list (e.g., a GP's ``points_sampled`` against each new
+    ``points_to_sample``) skip rescaling and transposing it.
+
+    The default implementation leaves ``scaled_points`` empty: the covariance does not use the layout and callers
+    should call CovarianceMatrix() instead.  Subclasses whose kernels depend on ``x / L`` should override it.
+
+    \param
+      :points[dim][num_points]: list of points (not copied)
+      :num_points: number of points
+    \output
+      :scaled_points[1]: the scaled copy of ``points``; empty if this covariance does not use it
+  \endrst*/
+  virtual void ScalePointsTranspose(double const * restrict points, int num_points,
+                                    ScaledPointsTranspose * scaled_points) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes the same output as ``CovarianceMatrix(scaled_one.points, points_two, dim, scaled_one.num_points,
+    num_points_two, ...)`` from a (non-empty) ``scaled_one`` filled by this covariance's ScalePointsTranspose().
+
+    The default implementation calls CovarianceMatrix() on ``scaled_one.points``.
+
+    \param
+      :scaled_one: the first list of points and its scaled copy
+      :points_two[dim][num_points_two]: second list of points
+      :num_points_two: number of points in points_two
+      :derivatives_one[num_derivatives_one]: which derivatives of the first list are available
+      :num_derivatives_one: int, the number of derivatives of each point in the first list
+      :derivatives_two[num_derivatives_two]: which derivatives of points_two are available
+      :num_derivatives_two: int, the number of derivatives of each point in points_two
+    \output
+      :cov_matrix[scaled_one.num_points*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]:
+      covariance between the function values and gradients of every pair of input points
+  \endrst*/
+  virtual void CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                              double const * restrict points_two, int num_points_two,
+                                              int const * restrict derivatives_one, int num_derivatives_one,
+                                              int const * restrict derivatives_two, int num_derivatives_two,
+                                              double * restrict cov_matrix) const noexcept OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the gradient of this.Covariance(point_one, point_two) with respect to the FIRST argument, point_one.
 
@@ -156,6 +434,35 @@ class CovarianceInterface {
                                             int num_derivatives_two,
                                             double * restrict grad_hyperparameter_cov) const noexcept OL_NONNULL_POINTERS = 0;
 
+  /*!\rst
+    Similar to HyperparameterGradCovariance(), except that it computes the Hessian (second derivatives) w.r.t. the
+    hyperparameters.  For a fixed entry ``(j, k)`` of the covariance block, the ``n_hyper X n_hyper`` matrix of mixed partials
+    is symmetric; and as in HyperparameterGradCovariance(), swapping point_one and point_two only transposes the block.
+
+    The default implementation central-differences HyperparameterGradCovariance() on a Clone() with perturbed
+    hyperparameters; subclasses with a closed form (e.g., SquareExponential) should override it.
+
+    Let ``n_hyper = this.GetNumberOfHyperparameters()``.
+
+    \param
+      :point_one[dim]: first spatial coordinate
+      :derivatives_one[dim]: which derivatives of point_one are available
+      :num_derivatives_one: int, the number of derivatives of point one
+      :point_two[dim]: second spatial coordinate
+      :derivatives_two[dim]: which derivatives of point_two are available
+      :num_derivatives_two: int, the number of derivatives of point two
+    \output
+      :hessian_hyperparameter_cov[n_hyper][n_hyper][1+num_derivatives_one][1+num_derivatives_two]:
+      (i, l, j, k)-th entry is ``\mixpderiv{cov(x_1, x_2)(j, k)}{\theta_i}{\theta_l}``
+  \endrst*/
+  virtual void HyperparameterHessianCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one,
+                                               int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two,
+                                               int num_derivatives_two,
+                                               double * restrict hessian_hyperparameter_cov) const noexcept OL_NONNULL_POINTERS;
+
   /*!\rst
     Sets the hyperparameters.  Hyperparameter ordering is defined implicitly by GetHyperparameters: ``[alpha=\sigma_f^2, length_0, ..., length_{n-1}]``
 
@@ -172,6 +479,23 @@ class CovarianceInterface {
   \endrst*/
   virtual void GetHyperparameters(double * restrict hyperparameters) const noexcept OL_NONNULL_POINTERS = 0;
 
+  /*!\rst
+    Draws frequencies ``w`` from the spectral density of this (stationary) covariance, normalized to a probability
+    density.  By Bochner's theorem, ``k(x, x') = \alpha E_w[\cos(w^T (x - x'))]``, so ``\alpha`` and these draws define
+    a random Fourier feature approximation of ``k`` (see gpp_posterior_sample.hpp).
+
+    \param
+      :num_frequencies: number of frequencies to draw
+      :normal_rng[1]: a NormalRNGInterface object that will provide the ~N(0,1) random numbers
+    \output
+      :normal_rng[1]: NormalRNGInterface object will have its state changed due to random draws
+      :frequencies[dim][num_frequencies]: i.i.d. draws from the normalized spectral density
+    \return
+      ``\alpha = k(x, x)``, the signal variance
+  \endrst*/
+  virtual double SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                           double * restrict frequencies) const OL_NONNULL_POINTERS = 0;
+
   /*!\rst
     For implementing the virtual (copy) constructor idiom.
 
@@ -190,10 +514,17 @@ class CovarianceInterface {
 
   This covariance object has ``dim+1`` hyperparameters: ``\alpha, lengths_i``
 
+  The per-pair kernels (Covariance(), GradCovariance(), HyperparameterGradCovariance()) are compiled once per
+  ``dim <= kMaxSpecializedDim`` (so their loops over dimensions unroll and stay in registers) and once for general
+  ``dim``; the constructor picks the matching set.
+
   See CovarianceInterface for descriptions of the virtual functions.
 \endrst*/
 class SquareExponential final : public CovarianceInterface {
  public:
+  //! largest ``dim`` with dedicated (compile-time dimension) kernels; larger ``dim`` use the general kernels
+  static constexpr int kMaxSpecializedDim = 16;
+
   /*!\rst
     Constructs a SquareExponential object with constant length-scale across all dimensions.
 
@@ -234,6 +565,41 @@ class SquareExponential final : public CovarianceInterface {
                           int num_derivatives_two,
                           double * restrict cov) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
 
+  // batched covariance of two point lists; points are length-scaled once and distances/exponentials run over whole columns
+  // [num_points_one*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrix(double const * restrict points_one,
+                                double const * restrict points_two,
+                                int dim, int num_points_one, int num_points_two,
+                                int const * restrict derivatives_one,
+                                int num_derivatives_one,
+                                int const * restrict derivatives_two,
+                                int num_derivatives_two,
+                                double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // length-scaled SoA copy of points, ``x / L``, read by CovarianceMatrixOfScaledPoints()
+  virtual void ScalePointsTranspose(double const * restrict points, int num_points,
+                                    ScaledPointsTranspose * scaled_points) const override OL_NONNULL_POINTERS;
+
+  // CovarianceMatrix() of the pre-scaled first list; the scaled rows are read in place
+  // [scaled_one.num_points*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                              double const * restrict points_two, int num_points_two,
+                                              int const * restrict derivatives_one, int num_derivatives_one,
+                                              int const * restrict derivatives_two, int num_derivatives_two,
+                                              double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // K(X, X) as a scaled exponential of the cached squared differences: kernel_p = alpha * exp(-1/2 * sum_d sqdiff_{p,d} / L_d^2)
+  // [n*(1+num_derivatives)][n*(1+num_derivatives)]
+  virtual void SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                         double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // K(X1, X2) (no derivative observations) as a scaled exponential of the cached squared differences
+  // [n2*(1+num_derivatives_two)][n1*(1+num_derivatives_one)]
+  virtual void CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                     int const * restrict derivatives_one, int num_derivatives_one,
+                                     int const * restrict derivatives_two, int num_derivatives_two,
+                                     double * restrict cov_matrix) const noexcept override;
+
   // gradient of the covariance function wrt point_one (tensor)
   // [dim][1+num_derivatives_one][1+num_derivatives_two]
   virtual void GradCovariance(double const * restrict point_one,
@@ -259,6 +625,16 @@ class SquareExponential final : public CovarianceInterface {
                                             int num_derivatives_two,
                                             double * restrict grad_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
 
+  // hessian of the covariance function wrt the hyperparameters (tensor)
+  // [GetNumberOfHyperparameters()][GetNumberOfHyperparameters()][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void HyperparameterHessianCovariance(double const * restrict point_one,
+                                               int const * restrict derivatives_one,
+                                               int num_derivatives_one,
+                                               double const * restrict point_two,
+                                               int const * restrict derivatives_two,
+                                               int num_derivatives_two,
+                                               double * restrict hessian_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
+
   // set the hyperparameters in the GP as a given array (hyperparameters)
   virtual void SetHyperparameters(double const * restrict hyperparameters) noexcept override OL_NONNULL_POINTERS {
     alpha_ = hyperparameters[0];
@@ -278,6 +654,11 @@ class SquareExponential final : public CovarianceInterface {
     }
   }
 
+  // frequencies ~ N(0, L^{-2}), the spectral density of the square exponential
+  // [dim][num_frequencies]
+  virtual double SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                           double * restrict frequencies) const override OL_NONNULL_POINTERS;
+
   virtual CovarianceInterface * Clone() const override OL_WARN_UNUSED_RESULT;
 
   OL_DISALLOW_DEFAULT_AND_ASSIGN(SquareExponential);
@@ -290,6 +671,318 @@ class SquareExponential final : public CovarianceInterface {
   \endrst*/
   void Initialize();
 
+  //! per-pair kernels for this ``dim_``; defined in gpp_covariance.cpp
+  struct KernelTable;
+
+  //! dimension of the problem
+  int dim_;
+  //! ``\sigma_f^2``, signal variance
+  double alpha_;
+  //! length scales, one per dimension
+  std::vector<double> lengths_;
+  //! square of the length scales, one per dimension
+  std::vector<double> lengths_sq_;
+  //! kernels specialized for ``dim_`` (or the general ones), chosen by Initialize()
+  KernelTable const * kernels_;
+};
+
+/*!\rst
+  Implements a case of the Matern class of covariance functions with ``\nu = 3/2`` (smoothness parameter):
+
+  ``cov_{\nu=3/2}(r) = \alpha (1 + \sqrt{3} r) \exp(-\sqrt{3} r)``, where ``r = \|L^{-1}(x_1 - x_2)\|_2`` and ``L`` is the diagonal
+  matrix of length scales, as in SquareExponential.
+
+  This kernel is exactly twice differentiable at ``r = 0``, which is what gradient observations need (the Hessian block
+  of the joint kernel exists).  GradCovariance() of the Hessian block needs a third derivative, which does not exist at
+  ``r = 0``; there (more precisely, for ``r < 1.0e-100``) it returns the symmetric limit, 0, for those terms.
+
+  Matern kernels are rougher than SquareExponential, so their covariance matrices are much better conditioned (smaller
+  nugget/jitter, fewer SingularMatrixException) on dense or nearly-duplicated samples.  CovarianceMatrix() is batched
+  like SquareExponential's.
+
+  This covariance object has ``dim+1`` hyperparameters: ``\alpha, lengths_i``
+
+  See CovarianceInterface for descriptions of the virtual functions.
+\endrst*/
+class MaternNu1p5 final : public CovarianceInterface {
+ public:
+  /*!\rst
+    Constructs a MaternNu1p5 object with constant length-scale across all dimensions.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha`` (e.g., signal variance, ``\sigma_f^2``)
+      :length: the constant length scale to use for all hyperparameter length scales
+  \endrst*/
+  MaternNu1p5(int dim, double alpha, double length);
+
+  /*!\rst
+    Constructs a MaternNu1p5 object with the specified hyperparameters.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
+      :lengths[dim]: the hyperparameter length scales, one per spatial dimension
+  \endrst*/
+  MaternNu1p5(int dim, double alpha, double const * restrict lengths) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Constructs a MaternNu1p5 object with the specified hyperparameters.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
+      :lengths: the hyperparameter length scales, one per spatial dimension
+  \endrst*/
+  MaternNu1p5(int dim, double alpha, std::vector<double> lengths);
+
+  // covariance function of point_one and point_two
+  // [1+num_derivatives_one][1+num_derivatives_two]
+  virtual void Covariance(double const * restrict point_one,
+                          int const * restrict derivatives_one,
+                          int num_derivatives_one,
+                          double const * restrict point_two,
+                          int const * restrict derivatives_two,
+                          int num_derivatives_two,
+                          double * restrict cov) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  // batched covariance of two point lists; distances run over whole columns as in SquareExponential
+  // [num_points_one*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrix(double const * restrict points_one,
+                                double const * restrict points_two,
+                                int dim, int num_points_one, int num_points_two,
+                                int const * restrict derivatives_one,
+                                int num_derivatives_one,
+                                int const * restrict derivatives_two,
+                                int num_derivatives_two,
+                                double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // length-scaled SoA copy of points, ``x / L``, read by CovarianceMatrixOfScaledPoints()
+  virtual void ScalePointsTranspose(double const * restrict points, int num_points,
+                                    ScaledPointsTranspose * scaled_points) const override OL_NONNULL_POINTERS;
+
+  // CovarianceMatrix() of the pre-scaled first list; the scaled rows are read in place
+  // [scaled_one.num_points*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                              double const * restrict points_two, int num_points_two,
+                                              int const * restrict derivatives_one, int num_derivatives_one,
+                                              int const * restrict derivatives_two, int num_derivatives_two,
+                                              double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // gradient of the covariance function wrt point_one (tensor)
+  // [dim][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void GradCovariance(double const * restrict point_one,
+                              int const * restrict derivatives_one,
+                              int num_derivatives_one,
+                              double const * restrict point_two,
+                              int const * restrict derivatives_two,
+                              int num_derivatives_two,
+                              double * restrict grad_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // return the number of hyperparameters, dim+1
+  virtual int GetNumberOfHyperparameters() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return 1 + dim_;
+  }
+
+  // gradient of the covariance function wrt the hyperparameter (tensor)
+  // [GetNumberOfHyperparameters()][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void HyperparameterGradCovariance(double const * restrict point_one,
+                                            int const * restrict derivatives_one,
+                                            int num_derivatives_one,
+                                            double const * restrict point_two,
+                                            int const * restrict derivatives_two,
+                                            int num_derivatives_two,
+                                            double * restrict grad_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // set the hyperparameters in the GP as a given array (hyperparameters)
+  virtual void SetHyperparameters(double const * restrict hyperparameters) noexcept override OL_NONNULL_POINTERS {
+    alpha_ = hyperparameters[0];
+    hyperparameters += 1;
+    for (int i = 0; i < dim_; ++i) {
+      lengths_[i] = hyperparameters[i];
+      lengths_sq_[i] = Square(hyperparameters[i]);
+    }
+  }
+
+  // return an array, which tells us the hyperparameters of the GP
+  virtual void GetHyperparameters(double * restrict hyperparameters) const noexcept override OL_NONNULL_POINTERS {
+    hyperparameters[0] = alpha_;
+    hyperparameters += 1;
+    for (int i = 0; i < dim_; ++i) {
+      hyperparameters[i] = lengths_[i];
+    }
+  }
+
+  // frequencies ~ multivariate Student-t with 2\nu = 3 degrees of freedom and scale L^{-1}
+  // [dim][num_frequencies]
+  virtual double SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                           double * restrict frequencies) const override OL_NONNULL_POINTERS;
+
+  virtual CovarianceInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_ASSIGN(MaternNu1p5);
+
+ private:
+  explicit MaternNu1p5(const MaternNu1p5& source);
+
+  /*!\rst
+    Validate and initialize class data members.
+  \endrst*/
+  void Initialize();
+
+  //! dimension of the problem
+  int dim_;
+  //! ``\sigma_f^2``, signal variance
+  double alpha_;
+  //! length scales, one per dimension
+  std::vector<double> lengths_;
+  //! square of the length scales, one per dimension
+  std::vector<double> lengths_sq_;
+};
+
+/*!\rst
+  Implements a case of the Matern class of covariance functions with ``\nu = 5/2`` (smoothness parameter):
+
+  ``cov_{\nu=5/2}(r) = \alpha (1 + \sqrt{5} r + \frac{5}{3} r^2) \exp(-\sqrt{5} r)``, where ``r = \|L^{-1}(x_1 - x_2)\|_2`` and ``L`` is the diagonal
+  matrix of length scales, as in SquareExponential.
+
+  This kernel is four times differentiable at ``r = 0``, so every block (including GradCovariance() of the Hessian
+  block with gradient observations) is well-defined everywhere.
+
+  Matern kernels are rougher than SquareExponential, so their covariance matrices are much better conditioned (smaller
+  nugget/jitter, fewer SingularMatrixException) on dense or nearly-duplicated samples.  CovarianceMatrix() is batched
+  like SquareExponential's.
+
+  This covariance object has ``dim+1`` hyperparameters: ``\alpha, lengths_i``
+
+  See CovarianceInterface for descriptions of the virtual functions.
+\endrst*/
+class MaternNu2p5 final : public CovarianceInterface {
+ public:
+  /*!\rst
+    Constructs a MaternNu2p5 object with constant length-scale across all dimensions.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha`` (e.g., signal variance, ``\sigma_f^2``)
+      :length: the constant length scale to use for all hyperparameter length scales
+  \endrst*/
+  MaternNu2p5(int dim, double alpha, double length);
+
+  /*!\rst
+    Constructs a MaternNu2p5 object with the specified hyperparameters.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
+      :lengths[dim]: the hyperparameter length scales, one per spatial dimension
+  \endrst*/
+  MaternNu2p5(int dim, double alpha, double const * restrict lengths) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Constructs a MaternNu2p5 object with the specified hyperparameters.
+
+    \param
+      :dim: the number of spatial dimensions
+      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
+      :lengths: the hyperparameter length scales, one per spatial dimension
+  \endrst*/
+  MaternNu2p5(int dim, double alpha, std::vector<double> lengths);
+
+  // covariance function of point_one and point_two
+  // [1+num_derivatives_one][1+num_derivatives_two]
+  virtual void Covariance(double const * restrict point_one,
+                          int const * restrict derivatives_one,
+                          int num_derivatives_one,
+                          double const * restrict point_two,
+                          int const * restrict derivatives_two,
+                          int num_derivatives_two,
+                          double * restrict cov) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  // batched covariance of two point lists; distances run over whole columns as in SquareExponential
+  // [num_points_one*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrix(double const * restrict points_one,
+                                double const * restrict points_two,
+                                int dim, int num_points_one, int num_points_two,
+                                int const * restrict derivatives_one,
+                                int num_derivatives_one,
+                                int const * restrict derivatives_two,
+                                int num_derivatives_two,
+                                double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // length-scaled SoA copy of points, ``x / L``, read by CovarianceMatrixOfScaledPoints()
+  virtual void ScalePointsTranspose(double const * restrict points, int num_points,
+                                    ScaledPointsTranspose * scaled_points) const override OL_NONNULL_POINTERS;
+
+  // CovarianceMatrix() of the pre-scaled first list; the scaled rows are read in place
+  // [scaled_one.num_points*(1+num_derivatives_one)][num_points_two*(1+num_derivatives_two)]
+  virtual void CovarianceMatrixOfScaledPoints(const ScaledPointsTranspose& scaled_one,
+                                              double const * restrict points_two, int num_points_two,
+                                              int const * restrict derivatives_one, int num_derivatives_one,
+                                              int const * restrict derivatives_two, int num_derivatives_two,
+                                              double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // gradient of the covariance function wrt point_one (tensor)
+  // [dim][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void GradCovariance(double const * restrict point_one,
+                              int const * restrict derivatives_one,
+                              int num_derivatives_one,
+                              double const * restrict point_two,
+                              int const * restrict derivatives_two,
+                              int num_derivatives_two,
+                              double * restrict grad_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // return the number of hyperparameters, dim+1
+  virtual int GetNumberOfHyperparameters() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return 1 + dim_;
+  }
+
+  // gradient of the covariance function wrt the hyperparameter (tensor)
+  // [GetNumberOfHyperparameters()][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void HyperparameterGradCovariance(double const * restrict point_one,
+                                            int const * restrict derivatives_one,
+                                            int num_derivatives_one,
+                                            double const * restrict point_two,
+                                            int const * restrict derivatives_two,
+                                            int num_derivatives_two,
+                                            double * restrict grad_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // set the hyperparameters in the GP as a given array (hyperparameters)
+  virtual void SetHyperparameters(double const * restrict hyperparameters) noexcept override OL_NONNULL_POINTERS {
+    alpha_ = hyperparameters[0];
+    hyperparameters += 1;
+    for (int i = 0; i < dim_; ++i) {
+      lengths_[i] = hyperparameters[i];
+      lengths_sq_[i] = Square(hyperparameters[i]);
+    }
+  }
+
+  // return an array, which tells us the hyperparameters of the GP
+  virtual void GetHyperparameters(double * restrict hyperparameters) const noexcept override OL_NONNULL_POINTERS {
+    hyperparameters[0] = alpha_;
+    hyperparameters += 1;
+    for (int i = 0; i < dim_; ++i) {
+      hyperparameters[i] = lengths_[i];
+    }
+  }
+
+  // frequencies ~ multivariate Student-t with 2\nu = 5 degrees of freedom and scale L^{-1}
+  // [dim][num_frequencies]
+  virtual double SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                           double * restrict frequencies) const override OL_NONNULL_POINTERS;
+
+  virtual CovarianceInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_ASSIGN(MaternNu2p5);
+
+ private:
+  explicit MaternNu2p5(const MaternNu2p5& source);
+
+  /*!\rst
+    Validate and initialize class data members.
+  \endrst*/
+  void Initialize();
+
   //! dimension of the problem
   int dim_;
   //! ``\sigma_f^2``, signal variance
@@ -300,122 +993,214 @@ class SquareExponential final : public CovarianceInterface {
   std::vector<double> lengths_sq_;
 };
 
-///*!\rst
-//  Implements a case of the Matern class of covariance functions with \nu = 5/2 (smoothness parameter).
-//  See docs for ``MaternNu1p5`` for more details on the Matern class of covariance fucntions.
-//
-//  ``cov_{\nu=5/2}(r) = (1 + \sqrt{5}\frac{r}[l} + \frac{5}{3}\frac{r^2}{l^2})\exp(-\sqrt{5}\frac{r}{l})``
-//
-//  We also implement the augmented kernel function with the gradient obervations.
-//
-//  See CovarianceInterface for descriptions of the virtual functions.
-//\endrst*/
-//class MaternNu2p5 final : public CovarianceInterface {
-// public:
-//  /*!\rst
-//    Constructs a MaternNu2p5 object with constant length-scale across all dimensions.
-//
-//    \param
-//      :dim: the number of spatial dimensions
-//      :alpha: the hyperparameter ``\alpha`` (e.g., signal variance, ``\sigma_f^2``)
-//      :length: the constant length scale to use for all hyperparameter length scales
-//  \endrst*/
-//  MaternNu2p5(int dim, double alpha, double length);
-//
-//  /*!\rst
-//    Constructs a MaternNu2p5 object with the specified hyperparameters.
-//
-//    \param
-//      :dim: the number of spatial dimensions
-//      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
-//      :lengths[dim]: the hyperparameter length scales, one per spatial dimension
-//  \endrst*/
-//  MaternNu2p5(int dim, double alpha, double const * restrict lengths) OL_NONNULL_POINTERS;
-//
-//  /*!\rst
-//    Constructs a MaternNu2p5 object with the specified hyperparameters.
-//
-//    \param
-//      :dim: the number of spatial dimensions
-//      :alpha: the hyperparameter ``\alpha``, (e.g., signal variance, ``\sigma_f^2``)
-//      :lengths: the hyperparameter length scales, one per spatial dimension
-//  \endrst*/
-//  MaternNu2p5(int dim, double alpha, std::vector<double> lengths);
-//
-//  // covariance function of point_one and point_two
-//  // [1+num_derivatives_one][1+num_derivatives_two]
-//  virtual void Covariance(double const * restrict point_one,
-//                          int const * restrict derivatives_one,
-//                          int length_one,
-//                          double const * restrict point_two,
-//                          int const * restrict derivatives_two,
-//                          int length_two,
-//                          double * restrict cov) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
-//
-//  // gradient of the covariance function wrt point_one (tensor)
-//  // [dim][1+num_derivatives_one][1+num_derivatives_two]
-//  virtual void GradCovariance(double const * restrict point_one,
-//                              int const * restrict derivatives_one,
-//                              int length_one,
-//                              double const * restrict point_two,
-//                              int const * restrict derivatives_two,
-//                              int length_two,
-//                              double * restrict grad_cov) const noexcept override OL_NONNULL_POINTERS;
-//
-//  // return the number of hyperparameters, dim+1
-//  virtual int GetNumberOfHyperparameters() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-//    return dim_ + 1;
-//  }
-//
-//  // gradient of the covariance function wrt the hyperparameter (tensor)
-//  // [GetNumberOfHyperparameters()][1+num_derivatives_one][1+num_derivatives_two]
-//  virtual void HyperparameterGradCovariance(double const * restrict point_one,
-//                                            int const * restrict derivatives_one,
-//                                            int length_one,
-//                                            double const * restrict point_two,
-//                                            int const * restrict derivatives_two,
-//                                            int length_two,
-//                                            double * restrict grad_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
-//
-//  virtual void SetHyperparameters(double const * restrict hyperparameters) noexcept override OL_NONNULL_POINTERS {
-//    alpha_ = hyperparameters[0];
-//
-//    hyperparameters += 1;
-//    for (int i = 0; i < dim_; ++i) {
-//      lengths_[i] = hyperparameters[i];
-//      lengths_sq_[i] = Square(hyperparameters[i]);
-//    }
-//  }
-//
-//  virtual void GetHyperparameters(double * restrict hyperparameters) const noexcept override OL_NONNULL_POINTERS {
-//    hyperparameters[0] = alpha_;
-//    hyperparameters += 1;
-//    for (int i = 0; i < dim_; ++i) {
-//      hyperparameters[i] = lengths_[i];
-//    }
-//  }
-//
-//  virtual CovarianceInterface * Clone() const override;
-//
-// private:
-//  explicit MaternNu2p5(const MaternNu2p5& source);
-//
-//  /*!\rst
-//    Validate and initialize class data members.
-//  \endrst*/
-//  void Initialize();
-//
-//  //! dimension of the problem
-//  int dim_;
-//  //! ``\sigma_f^2``, signal variance
-//  double alpha_;
-//  //! length scales, one per dimension
-//  std::vector<double> lengths_;
-//  //! square of the length scales, one per dimension
-//  std::vector<double> lengths_sq_;
-//
-//  OL_DISALLOW_DEFAULT_AND_ASSIGN(MaternNu2p5);
-//};
+/*!\rst
+  Implements an additive square exponential covariance over disjoint groups of dimensions ``G_0, ..., G_{m-1}``:
+  ``cov(x_1, x_2) = \sum_g \alpha_g * \exp(-1/2 * \sum_{d \in G_g} (x_{1,d} - x_{2,d})^2 / L_d^2)``
+
+  i.e., the prior is ``f(x) = \sum_g f_g(x_{G_g})`` with independent low-dimensional SquareExponential components.  In
+  high dimension, a single SquareExponential needs data at the scale of every length simultaneously; an additive
+  model only needs each group's (low-dimensional) projection to be covered, so it generalizes from far fewer samples.
+  Dimensions that belong to no group are ignored (the model does not depend on them).
+
+  Every derivative and hyperparameter entry involves at most the groups of the dimensions it references: e.g.,
+  ``\pderiv{cov}{x_{1,m}}`` only needs the kernel of ``m``'s group, and the gradient wrt a group's hyperparameters is zero
+  in every derivative block referencing another group.  Covariance(), GradCovariance(), and
+  HyperparameterGradCovariance() evaluate only those groups; SymmetricCovarianceMatrix() and CrossCovarianceMatrix()
+  accumulate the cached squared differences group by group (values only; derivative observations use the pairwise
+  defaults).
+
+  Since the posterior mean of an additive model is additive too, callers can optimize acquisition functions one group
+  at a time (block coordinate ascent over the groups' coordinates); num_groups() and group_dimensions() expose the
+  structure for that.
+
+  This covariance object has ``num_groups + (number of grouped dimensions)`` hyperparameters, ordered group by group:
+  ``\alpha_0, L_{G_0[0]}, L_{G_0[1]}, ..., \alpha_1, L_{G_1[0]}, ...``
+
+  See CovarianceInterface for descriptions of the virtual functions.
+\endrst*/
+class AdditiveSquareExponential final : public CovarianceInterface {
+ public:
+  /*!\rst
+    Constructs an AdditiveSquareExponential object with the specified groups and hyperparameters.
+
+    \param
+      :dim: the number of spatial dimensions
+      :groups[num_groups]: the dimensions of each group; groups are nonempty, disjoint, and their entries lie in ``[0, dim)``
+      :alphas[num_groups]: the signal variance ``\alpha_g`` of each group
+      :lengths[dim]: the length scales, one per spatial dimension (entries of ungrouped dimensions are unused, but must
+        still be positive)
+    \raise
+      BoundsException if a dimension index is out of range; InvalidValueException if the groups overlap or the sizes
+      of alphas/lengths do not match; LowerBoundException if there are no groups, a group is empty, or an ``\alpha``
+      or a length is not positive
+  \endrst*/
+  AdditiveSquareExponential(int dim, const std::vector<std::vector<int> >& groups, std::vector<double> alphas,
+                            std::vector<double> lengths);
+
+  //! number of groups of dimensions (additive components)
+  int num_groups() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return static_cast<int>(alphas_.size());
+  }
+
+  /*!\rst
+    \param
+      :group: index of the group, in ``[0, num_groups())``
+    \output
+      :num_group_dimensions[1]: number of dimensions in the group
+    \return
+      pointer to the group's dimension indices (valid for the lifetime of this object)
+  \endrst*/
+  int const * group_dimensions(int group, int * num_group_dimensions) const noexcept OL_NONNULL_POINTERS {
+    *num_group_dimensions = group_offsets_[group+1] - group_offsets_[group];
+    return group_dims_.data() + group_offsets_[group];
+  }
+
+  // covariance function of point_one and point_two
+  // [1+num_derivatives_one][1+num_derivatives_two]
+  virtual void Covariance(double const * restrict point_one,
+                          int const * restrict derivatives_one,
+                          int num_derivatives_one,
+                          double const * restrict point_two,
+                          int const * restrict derivatives_two,
+                          int num_derivatives_two,
+                          double * restrict cov) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  // K(X, X) (no derivative observations) accumulated group by group from the cached squared differences
+  // [n*(1+num_derivatives)][n*(1+num_derivatives)]
+  virtual void SymmetricCovarianceMatrix(const PairwiseDifferences& differences,
+                                         double * restrict cov_matrix) const noexcept override OL_NONNULL_POINTERS;
+
+  // K(X1, X2) (no derivative observations) accumulated group by group from the cached squared differences
+  // [n2*(1+num_derivatives_two)][n1*(1+num_derivatives_one)]
+  virtual void CrossCovarianceMatrix(const CrossPairwiseDifferences& differences,
+                                     int const * restrict derivatives_one, int num_derivatives_one,
+                                     int const * restrict derivatives_two, int num_derivatives_two,
+                                     double * restrict cov_matrix) const noexcept override;
+
+  // gradient of the covariance function wrt point_one (tensor)
+  // [dim][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void GradCovariance(double const * restrict point_one,
+                              int const * restrict derivatives_one,
+                              int num_derivatives_one,
+                              double const * restrict point_two,
+                              int const * restrict derivatives_two,
+                              int num_derivatives_two,
+                              double * restrict grad_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // return the number of hyperparameters, num_groups + number of grouped dimensions
+  virtual int GetNumberOfHyperparameters() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_groups() + static_cast<int>(group_dims_.size());
+  }
+
+  // gradient of the covariance function wrt the hyperparameter (tensor)
+  // [GetNumberOfHyperparameters()][1+num_derivatives_one][1+num_derivatives_two]
+  virtual void HyperparameterGradCovariance(double const * restrict point_one,
+                                            int const * restrict derivatives_one,
+                                            int num_derivatives_one,
+                                            double const * restrict point_two,
+                                            int const * restrict derivatives_two,
+                                            int num_derivatives_two,
+                                            double * restrict grad_hyperparameter_cov) const noexcept override OL_NONNULL_POINTERS;
+
+  // set the hyperparameters in the GP as a given array (hyperparameters), group by group
+  virtual void SetHyperparameters(double const * restrict hyperparameters) noexcept override OL_NONNULL_POINTERS {
+    for (int g = 0; g < num_groups(); ++g) {
+      alphas_[g] = *hyperparameters++;
+      for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+        lengths_[group_dims_[k]] = *hyperparameters;
+        lengths_sq_[group_dims_[k]] = Square(*hyperparameters++);
+      }
+    }
+  }
+
+  // return an array, which tells us the hyperparameters of the GP, group by group
+  virtual void GetHyperparameters(double * restrict hyperparameters) const noexcept override OL_NONNULL_POINTERS {
+    for (int g = 0; g < num_groups(); ++g) {
+      *hyperparameters++ = alphas_[g];
+      for (int k = group_offsets_[g]; k < group_offsets_[g+1]; ++k) {
+        *hyperparameters++ = lengths_[group_dims_[k]];
+      }
+    }
+  }
+
+  // frequencies from the mixture (weights \alpha_g / \sum \alpha) of the groups' spectral densities, N(0, L_{G_g}^{-2})
+  // on the group's dimensions and 0 elsewhere
+  // [dim][num_frequencies]
+  virtual double SampleSpectralFrequencies(int num_frequencies, NormalRNGInterface * normal_rng,
+                                           double * restrict frequencies) const override OL_NONNULL_POINTERS;
+
+  virtual CovarianceInterface * Clone() const override OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_ASSIGN(AdditiveSquareExponential);
+
+ private:
+  explicit AdditiveSquareExponential(const AdditiveSquareExponential& source);
+
+  /*!\rst
+    Validate and initialize class data members.
+  \endrst*/
+  void Initialize();
+
+  /*!\rst
+    \return
+      ``\alpha_g * \exp(-1/2 * \sum_{d \in G_g} (x_{1,d} - x_{2,d})^2 / L_d^2)``, group ``g``'s term of the covariance
+  \endrst*/
+  double GroupKernel(int group, double const * restrict point_one,
+                     double const * restrict point_two) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Adds ``\sum_g \alpha_g \exp(-1/2 \sum_{d \in G_g} sqdiff_{p,d} / L_d^2)`` to ``kernel[p]`` for every pair.
+
+    \param
+      :squared_differences[num_pairs][dim]: cached squared differences, pairs contiguous
+      :num_pairs: number of pairs
+    \output
+      :kernel[num_pairs]: covariance of every pair
+  \endrst*/
+  void AccumulatePairKernels(double const * restrict squared_differences, int num_pairs,
+                             double * restrict kernel) const OL_NONNULL_POINTERS;
+
+  //! dimension of the problem
+  int dim_;
+  //! dimensions of every group, concatenated in group order
+  std::vector<int> group_dims_;
+  //! group ``g`` is ``group_dims_[group_offsets_[g], group_offsets_[g+1])``
+  std::vector<int> group_offsets_;
+  //! group of each dimension; -1 for ungrouped dimensions
+  std::vector<int> group_of_dim_;
+  //! index of each (grouped) dimension's length scale in the hyperparameter list
+  std::vector<int> hyperparameter_index_of_dim_;
+  //! ``\sigma_f^2`` of each group
+  std::vector<double> alphas_;
+  //! length scales, one per dimension
+  std::vector<double> lengths_;
+  //! square of the length scales, one per dimension
+  std::vector<double> lengths_sq_;
+};
+
+/*!\rst
+  Computes the symmetric covariance matrix ``K(X, X)`` of a point list, the same output as
+  ``covariance.CovarianceMatrix(X, X, dim, n, n, derivatives, num_derivatives, derivatives, num_derivatives, cov_matrix)``,
+  in parallel over tiles of point pairs.
+
+  ``K`` is cut into square tiles of (up to) 256 points on a side.  Each tile on or below the diagonal is one
+  CovarianceMatrix() call on the two point sub-lists (so the diagonal tiles still take the symmetric shortcut) and one
+  iteration of ParallelForEachIndex() with NumThreadsForInnerLoops() threads; off-diagonal tiles are mirrored into the
+  upper triangle.  Point lists shorter than two tiles are built by a single CovarianceMatrix() call.
+
+  \param
+    :covariance: the covariance function
+    :points[dim][num_points]: list of points
+    :dim: spatial dimension of a point
+    :num_points: number of points
+    :derivatives[num_derivatives]: which derivatives are observed at every point
+    :num_derivatives: number of derivatives observed at every point
+  \output
+    :cov_matrix[num_points*(1+num_derivatives)][num_points*(1+num_derivatives)]: covariance matrix of the point list
+\endrst*/
+void BuildSymmetricCovarianceMatrixInParallel(const CovarianceInterface& covariance, double const * restrict points,
+                                              int dim, int num_points, int const * restrict derivatives,
+                                              int num_derivatives, double * restrict cov_matrix) noexcept;
 
 }  // end namespace optimal_learning
 
@@ -1,16 +1,23 @@
 /*!
   \file gpp_covariance_test.cpp
   \rst
-  This file contains two template classes: one supporting computing covariance and its analytic spatial derivatives, and the other
-  for covariance and its analytic hyperparameter derivatives.  Then through a matched pair of template functions, we ping
+  This file contains three template classes: one supporting computing covariance and its analytic spatial derivatives, one
+  for covariance and its analytic hyperparameter derivatives, and one for those derivatives and the hyperparameter hessian.  Then through a matched pair of template functions, we ping
   the analytic derivatives using finite differences for validation.  (The pinging is done through PingDerivatve() in test_utils.hpp.)
 
-  The Run.*() functions invoke the derivative ping funtions on all of the covariance functions declared in gpp_covariance.hpp.
+  The Run.*() functions invoke the derivative ping funtions on all of the covariance functions declared in gpp_covariance.hpp
+  (SquareExponential at every dimension with its own specialized kernels, and one beyond; MaternNu1p5 and MaternNu2p5).
+  RunCovarianceMatrixTests() additionally checks batched CovarianceMatrix() (and SymmetricCovarianceMatrix()) overrides
+  against the pairwise default,
+  RunCovarianceDerivativeSubsetTests() checks that derivative blocks do not depend on which other derivatives are observed,
+  RunAdditiveCovarianceTests() checks AdditiveSquareExponential against its groups' SquareExponential kernels,
+  and CovarianceHotPathBenchmark() reports timings for the per-pair kernels.
 \endrst*/
 
 #include "gpp_covariance_test.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <string>
 #include <stdexcept>
 #include <vector>
@@ -261,14 +268,138 @@ class PingGradCovarianceHyperparameters final : public PingableMatrixInputVector
   CovarianceClass covariance_;
 };
 
+/*!\rst
+  Supports evaluating the hyperparameter gradient of a covariance function, Covariance.HyperparameterGradCovariance() and
+  its hessian, Covariance.HyperparameterHessianCovariance()
+
+  Same structure as PingGradCovarianceHyperparameters, one derivative higher: the "function" is the
+  ``n_hyper * Square(1+num_derivatives)`` vector of hyperparameter gradients, so the analytic "gradient" is the hessian.
+\endrst*/
+template <typename CovarianceClass>
+class PingHessianCovarianceHyperparameters final : public PingableMatrixInputVectorOutputInterface {
+ public:
+  PingHessianCovarianceHyperparameters(double const * restrict point1, double const * restrict point2,
+                                       int const * derivatives, int num_derivatives, int dim) OL_NONNULL_POINTERS
+      : dim_(dim),
+        num_hyperparameters_(0),
+        hessian_already_computed_(false),
+        derivatives_(derivatives, derivatives+num_derivatives),
+        num_derivatives_(num_derivatives),
+        point1_(point1, point1 + dim),
+        point2_(point2, point2 + dim),
+        hessian_hyperparameter_covariance_(),
+        covariance_(dim, 1.0, 1.0) {
+    num_hyperparameters_ = covariance_.GetNumberOfHyperparameters();
+    hessian_hyperparameter_covariance_.resize(Square(num_hyperparameters_)*Square(1+num_derivatives));
+  }
+
+  virtual void GetInputSizes(int * num_rows, int * num_cols) const noexcept override OL_NONNULL_POINTERS {
+    *num_rows = num_hyperparameters_;
+    *num_cols = 1;
+  }
+
+  virtual int GetGradientsSize() const noexcept override OL_WARN_UNUSED_RESULT {
+    return num_hyperparameters_*GetOutputSize();
+  }
+
+  virtual int GetOutputSize() const noexcept override OL_WARN_UNUSED_RESULT {
+    return num_hyperparameters_*Square(1+num_derivatives_);
+  }
+
+  virtual void EvaluateAndStoreAnalyticGradient(double const * restrict hyperparameters, double * restrict gradients) noexcept override OL_NONNULL_POINTERS_LIST(2) {
+    if (hessian_already_computed_ == true) {
+      OL_WARNING_PRINTF("WARNING: hessian_covariance data already set.  Overwriting...\n");
+    }
+    hessian_already_computed_ = true;
+
+    covariance_.SetHyperparameters(hyperparameters);
+    covariance_.HyperparameterHessianCovariance(point1_.data(), derivatives_.data(), num_derivatives_,
+                                                point2_.data(), derivatives_.data(), num_derivatives_,
+                                                hessian_hyperparameter_covariance_.data());
+
+    if (gradients != nullptr) {
+      std::copy(hessian_hyperparameter_covariance_.begin(), hessian_hyperparameter_covariance_.end(), gradients);
+    }
+  }
+
+  /*!\rst
+    Checks that each entry's hessian is symmetric (in the hyperparameter indexes) and that swapping the points
+    transposes the derivative blocks.
+  \endrst*/
+  int CheckSymmetry() const OL_WARN_UNUSED_RESULT {
+    if (hessian_already_computed_ == false) {
+      OL_THROW_EXCEPTION(OptimalLearningException, "PingHessianCovarianceHyperparameters::CheckSymmetry() called BEFORE EvaluateAndStoreAnalyticGradient. NO DATA!");
+    }
+    const int block_size = 1 + num_derivatives_;
+    const int hessian_size = Square(num_hyperparameters_);
+    std::vector<double> hessian_transpose(hessian_hyperparameter_covariance_.size());
+    covariance_.HyperparameterHessianCovariance(point2_.data(), derivatives_.data(), num_derivatives_,
+                                                point1_.data(), derivatives_.data(), num_derivatives_,
+                                                hessian_transpose.data());
+
+    int total_errors = 0;
+    for (int m = 0; m < block_size; ++m) {
+      for (int n = 0; n < block_size; ++n) {
+        double const * hessian_block = hessian_hyperparameter_covariance_.data() + (m + n*block_size)*hessian_size;
+        double const * hessian_block_transpose = hessian_transpose.data() + (n + m*block_size)*hessian_size;
+        for (int i = 0; i < num_hyperparameters_; ++i) {
+          for (int l = 0; l < num_hyperparameters_; ++l) {
+            if (!CheckDoubleWithinRelative(hessian_block[i + l*num_hyperparameters_],
+                                           hessian_block[l + i*num_hyperparameters_], 0.0) ||
+                !CheckDoubleWithinRelative(hessian_block[i + l*num_hyperparameters_],
+                                           hessian_block_transpose[i + l*num_hyperparameters_], 1.0e-13)) {
+              ++total_errors;
+              OL_PARTIAL_FAILURE_PRINTF("row %d and col %d and hypers %d, %d\n", m, n, i, l);
+            }
+          }
+        }
+      }
+    }
+    return total_errors;
+  }
+
+  virtual double GetAnalyticGradient(int row_index, int OL_UNUSED(column_index), int output_index) const override OL_WARN_UNUSED_RESULT {
+    if (hessian_already_computed_ == false) {
+      OL_THROW_EXCEPTION(OptimalLearningException, "PingHessianCovarianceHyperparameters::GetAnalyticGradient() called BEFORE EvaluateAndStoreAnalyticGradient. NO DATA!");
+    }
+
+    // output_index = i_hyper + entry*num_hyperparameters_ enumerates the gradient; row_index is the differentiated hyperparameter
+    const int i_hyper = output_index % num_hyperparameters_;
+    const int entry = output_index / num_hyperparameters_;
+    return hessian_hyperparameter_covariance_[i_hyper + row_index*num_hyperparameters_ + entry*Square(num_hyperparameters_)];
+  }
+
+  virtual void EvaluateFunction(double const * restrict hyperparameters, double * restrict function_values) const noexcept override OL_NONNULL_POINTERS {
+    CovarianceClass covariance_local(dim_, hyperparameters[0], hyperparameters + 1);
+
+    covariance_local.HyperparameterGradCovariance(point1_.data(), derivatives_.data(), num_derivatives_,
+                                                  point2_.data(), derivatives_.data(), num_derivatives_, function_values);
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PingHessianCovarianceHyperparameters);
+
+ private:
+  int dim_;
+  int num_hyperparameters_;
+  bool hessian_already_computed_;
+
+  std::vector<int> derivatives_;
+  int num_derivatives_;
+
+  std::vector<double> point1_;
+  std::vector<double> point2_;
+  std::vector<double> hessian_hyperparameter_covariance_;
+
+  CovarianceClass covariance_;
+};
+
 template <typename PingCovarianceClass>
-OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterDerivativesTest(char const * class_name, int num_hyperparameters, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
-  const int dim = 3;
+OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterDerivativesTest(char const * class_name, int dim, int num_hyperparameters, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
   int errors_this_iteration = 0;
   int total_errors = 0;
 
   int* derivatives = new int[3]{0, 1, 2};
-  int num_derivatives = 3;
+  int num_derivatives = std::min(dim, 3);
 
   std::vector<double> hyperparameters(num_hyperparameters);
 
@@ -309,26 +440,25 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterDeriva
 }
 
 template <typename PingCovarianceClass>
-OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterGradientsTest(char const * class_name, int num_hyperparameters, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
-  const int dim = 3;
+OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterGradientsTest(char const * class_name, int dim, int num_hyperparameters, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
   int errors_this_iteration = 0;
   int total_errors = 0;
   std::vector<double> hyperparameters(num_hyperparameters);
 
   int* derivatives = new int[3]{0, 1, 2};
-  int num_derivatives = 3;
+  int num_derivatives = std::min(dim, 3);
 
   UniformRandomGenerator uniform_generator(31415);
   boost::uniform_real<double> uniform_double(3.0, 5.0);
 
   {
     // check that at r = x1 - x2 = 0, the gradient wrt alpha is 1.0 and wrt length scales is 0.0
-    double point3[dim] = {0.0};
-    double point4[dim] = {0.0};
+    std::vector<double> point3(dim, 0.0);
+    std::vector<double> point4(dim, 0.0);
     for (int j = 0; j < num_hyperparameters; ++j) {
       hyperparameters[j] = uniform_double(uniform_generator.engine);
     }
-    PingCovarianceClass covariance_evaluator2(point3, point4, derivatives, num_derivatives, dim);
+    PingCovarianceClass covariance_evaluator2(point3.data(), point4.data(), derivatives, num_derivatives, dim);
 
     covariance_evaluator2.EvaluateAndStoreAnalyticGradient(hyperparameters.data(), nullptr);
     errors_this_iteration = PingDerivative(covariance_evaluator2, hyperparameters.data(), epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
@@ -351,7 +481,7 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterGradie
     total_errors += errors_this_iteration;
   }
 
-  total_errors += PingCovarianceHyperparameterDerivativesTest<PingCovarianceClass>(class_name, num_hyperparameters, epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
+  total_errors += PingCovarianceHyperparameterDerivativesTest<PingCovarianceClass>(class_name, dim, num_hyperparameters, epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
 
   if (total_errors != 0) {
     OL_PARTIAL_FAILURE_PRINTF("%s covariance hyperparameter gradient pings failed with %d errors\n", class_name, total_errors);
@@ -363,6 +493,26 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterGradie
   return total_errors;
 }
 
+/*!\rst
+  Pings the hyperparameter hessian of a covariance function (against finite differences of its hyperparameter gradient)
+  at randomly generated point pairs and hyperparameters, with gradient observations in (up to) three dimensions.
+
+  \return
+    number of pings that failed
+\endrst*/
+template <typename PingCovarianceClass>
+OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterHessianTest(char const * class_name, int dim, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
+  int total_errors = PingCovarianceHyperparameterDerivativesTest<PingCovarianceClass>(class_name, dim, dim + 1, epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("%s covariance hyperparameter hessian pings failed with %d errors\n", class_name, total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("%s covariance hyperparameter hessian pings passed\n", class_name);
+  }
+
+  return total_errors;
+}
+
 /*!\rst
   Pings the gradient of covariance functions to check their validity.
   Test cases include a couple of simple hand-checked cases as well as a run
@@ -372,17 +522,16 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceHyperparameterGradie
     number of pings that failed
 \endrst*/
 template <typename PingCovarianceClass>
-OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceSpatialDerivativesTest(char const * class_name, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
-  const  int dim = 3;
-  double point1[dim] = {0.2, -1.7, 0.91};
-  double point2[dim] = {-2.1, 0.32, 1.12};
-  double point3[dim] = {0.0};
-  double point4[dim] = {0.0};
+OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceSpatialDerivativesTest(char const * class_name, int dim, double epsilon[2], double tolerance_fine, double tolerance_coarse, double input_output_ratio) {
+  double point1[3] = {0.2, -1.7, 0.91};
+  double point2[3] = {-2.1, 0.32, 1.12};
+  std::vector<double> point3(dim, 0.0);
+  std::vector<double> point4(dim, 0.0);
   int errors_this_iteration;
   int total_errors = 0;
 
   int* derivatives = new int[3]{0, 1, 2};
-  int num_derivatives = 3;
+  int num_derivatives = std::min(dim, 3);
 
   std::vector<double> lengths(dim);
   double alpha = 2.80723;
@@ -390,7 +539,7 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceSpatialDerivativesTe
   UniformRandomGenerator uniform_generator(31415);
   boost::uniform_real<double> uniform_double(0.5, 2.5);
 
-  {
+  if (dim == 3) {
     // hand-checked test-case
     for (int j = 0; j < dim; ++j) {
       lengths[j] = uniform_double(uniform_generator.engine);
@@ -410,10 +559,10 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int PingCovarianceSpatialDerivativesTe
     for (int j = 0; j < dim; ++j) {
       lengths[j] = uniform_double(uniform_generator.engine);
     }
-    PingCovarianceClass covariance_evaluator2(lengths.data(), point4, derivatives, num_derivatives, alpha, dim);
-    covariance_evaluator2.EvaluateAndStoreAnalyticGradient(point3, nullptr);
+    PingCovarianceClass covariance_evaluator2(lengths.data(), point4.data(), derivatives, num_derivatives, alpha, dim);
+    covariance_evaluator2.EvaluateAndStoreAnalyticGradient(point3.data(), nullptr);
 
-    errors_this_iteration = PingDerivative(covariance_evaluator2, point3, epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
+    errors_this_iteration = PingDerivative(covariance_evaluator2, point3.data(), epsilon, tolerance_fine, tolerance_coarse, input_output_ratio);
     for (int j = 0; j < dim; ++j) {
       if (covariance_evaluator2.GetAnalyticGradient(j, 0, 0) != 0.0) {
         errors_this_iteration += 1;
@@ -478,18 +627,20 @@ OL_WARN_UNUSED_RESULT int RunCovarianceSpatialDerivativesTests() {
   int total_errors = 0;
   int current_errors = 0;
 
-  {
+  // every dimension-specialized SquareExponential kernel set, plus the general one (dim > kMaxSpecializedDim)
+  for (int dim = 1; dim <= SquareExponential::kMaxSpecializedDim + 1; ++dim) {
     double epsilon_square_exponential[2] = {1.0e-2, 1.0e-3};
-    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<SquareExponential> >("Square Exponential", epsilon_square_exponential, 4.0e-3, 1.0e-2, 1.0e-18);
+    const std::string class_name = "Square Exponential (dim " + std::to_string(dim) + ")";
+    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<SquareExponential> >(class_name.c_str(), dim, epsilon_square_exponential, 4.0e-3, 1.0e-2, 1.0e-18);
     if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging sqexp covariance failed with %d errors\n", current_errors);
+      OL_PARTIAL_FAILURE_PRINTF("pinging sqexp covariance (dim %d) failed with %d errors\n", dim, current_errors);
     }
     total_errors += current_errors;
   }
-/*
+
   {
     double epsilon_matern_nu_1p5[2] = {1.0e-2, 1.0e-3};
-    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<MaternNu1p5> >("Matern nu=1.5", epsilon_matern_nu_1p5, 4.0e-3, 1.0e-2, 1.0e-18);
+    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<MaternNu1p5> >("Matern nu=1.5", 3, epsilon_matern_nu_1p5, 4.0e-3, 1.0e-2, 1.0e-18);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging matern 1.5 covariance failed with %d errors\n", current_errors);
     }
@@ -498,12 +649,12 @@ OL_WARN_UNUSED_RESULT int RunCovarianceSpatialDerivativesTests() {
 
   {
     double epsilon_matern_nu_2p5[2] = {1.0e-2, 1.0e-3};
-    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<MaternNu2p5> >("Matern nu=2.5", epsilon_matern_nu_2p5, 4.0e-3, 1.0e-2, 1.0e-18);
+    current_errors = PingCovarianceSpatialDerivativesTest<PingCovarianceSpatialDerivatives<MaternNu2p5> >("Matern nu=2.5", 3, epsilon_matern_nu_2p5, 4.0e-3, 1.0e-2, 1.0e-18);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging matern 2.5 covariance failed with %d errors\n", current_errors);
     }
     total_errors += current_errors;
-  }*/
+  }
 
   return total_errors;
 }
@@ -523,7 +674,7 @@ OL_WARN_UNUSED_RESULT int RunCovarianceHyperparameterDerivativesTests() noexcept
 /*
   {
     double epsilon_square_exponential_hyperparameters[2] = {5.0e-2, 1.0e-2};
-    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<SquareExponentialSingleLength> >("Square Exponential Single Length", 2, epsilon_square_exponential_hyperparameters, 4.0e-3, 4.0e-3, 5.0e-15);
+    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<SquareExponentialSingleLength> >("Square Exponential Single Length", 3, 2, epsilon_square_exponential_hyperparameters, 4.0e-3, 4.0e-3, 5.0e-15);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging sqexp covariance single length hyperparameters failed with %d errors\n", current_errors);
     }
@@ -531,19 +682,20 @@ OL_WARN_UNUSED_RESULT int RunCovarianceHyperparameterDerivativesTests() noexcept
   }
 */
 
-  {
+  // every dimension-specialized SquareExponential kernel set, plus the general one (dim > kMaxSpecializedDim)
+  for (int dim = 1; dim <= SquareExponential::kMaxSpecializedDim + 1; ++dim) {
     double epsilon_square_exponential_hyperparameters[2] = {9.0e-3, 2.0e-3};
-    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<SquareExponential> >("Square Exponential", 4, epsilon_square_exponential_hyperparameters, 4.0e-3, 5.0e-3, 3.0e-14);
+    const std::string class_name = "Square Exponential (dim " + std::to_string(dim) + ")";
+    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<SquareExponential> >(class_name.c_str(), dim, dim + 1, epsilon_square_exponential_hyperparameters, 4.0e-3, 5.0e-3, 3.0e-14);
     if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging sqexp covariance hyperparameters failed with %d errors\n", current_errors);
+      OL_PARTIAL_FAILURE_PRINTF("pinging sqexp covariance (dim %d) hyperparameters failed with %d errors\n", dim, current_errors);
     }
     total_errors += current_errors;
   }
 
-/*
   {
     double epsilon_matern_nu_1p5_hyperparameters[2] = {3.0e-2, 4.0e-3};
-    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<MaternNu1p5> >("Matern nu=1.5", 4, epsilon_matern_nu_1p5_hyperparameters, 4.0e-3, 5.0e-3, 3.0e-14);
+    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<MaternNu1p5> >("Matern nu=1.5", 3, 4, epsilon_matern_nu_1p5_hyperparameters, 4.0e-3, 5.0e-3, 3.0e-14);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=1.5 covariance hyperparameters failed with %d errors\n", current_errors);
     }
@@ -552,7 +704,7 @@ OL_WARN_UNUSED_RESULT int RunCovarianceHyperparameterDerivativesTests() noexcept
 
   {
     double epsilon_matern_nu_2p5_hyperparameters[2] = {5.0e-2, 1.0e-2};
-    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<MaternNu2p5> >("Matern nu=2.5", 4, epsilon_matern_nu_2p5_hyperparameters, 3.0e-3, 4.0e-3, 3.0e-14);
+    current_errors = PingCovarianceHyperparameterGradientsTest<PingGradCovarianceHyperparameters<MaternNu2p5> >("Matern nu=2.5", 3, 4, epsilon_matern_nu_2p5_hyperparameters, 3.0e-3, 4.0e-3, 3.0e-14);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=2.5 covariance hyperparameters failed with %d errors\n", current_errors);
     }
@@ -560,9 +712,13 @@ OL_WARN_UNUSED_RESULT int RunCovarianceHyperparameterDerivativesTests() noexcept
   }
 
 
-  {
+  // SquareExponential's closed-form hessian (a specialized and the general dimension), then the Matern kernels, which use
+  // the finite-difference CovarianceInterface default (its exact zeros, e.g., d^2/d\alpha^2, carry ~1e-13 differencing
+  // noise, hence the larger input_output_ratio)
+  for (int dim : {3, SquareExponential::kMaxSpecializedDim + 1}) {
     double epsilon_square_exponential_hyperparameters[2] = {9.0e-3, 2.0e-3};
-    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<SquareExponential> >("Square Exponential", 4, epsilon_square_exponential_hyperparameters, 4.0e-3, 5.0e-3, 8.0e-15);
+    const std::string class_name = "Square Exponential (dim " + std::to_string(dim) + ")";
+    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<SquareExponential> >(class_name.c_str(), dim, epsilon_square_exponential_hyperparameters, 4.0e-3, 5.0e-3, 3.0e-14);
     if (current_errors != 0) {
       OL_PARTIAL_FAILURE_PRINTF("pinging sqexp hessian covariance hyperparameters failed with %d errors\n", current_errors);
     }
@@ -570,32 +726,502 @@ OL_WARN_UNUSED_RESULT int RunCovarianceHyperparameterDerivativesTests() noexcept
   }
 
   {
-    double epsilon_square_exponential_hyperparameters[2] = {5.0e-2, 8.0e-3};
-    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<SquareExponentialSingleLength> >("Square Exponential Single Length", 4, epsilon_square_exponential_hyperparameters, 4.0e-3, 5.0e-3, 5.0e-15);
+    double epsilon_matern_nu_1p5_hyperparameters[2] = {3.0e-2, 4.0e-3};
+    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<MaternNu1p5> >("Matern nu=1.5", 3, epsilon_matern_nu_1p5_hyperparameters, 5.0e-3, 6.0e-3, 1.0e-12);
     if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging sqexp single length hessian covariance hyperparameters failed with %d errors\n", current_errors);
+      OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=1.5 hessian covariance hyperparameters failed with %d errors\n", current_errors);
     }
     total_errors += current_errors;
   }
 
   {
-    double epsilon_matern_nu_1p5_hyperparameters[2] = {4.5e-2, 8.0e-3};
-    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<MaternNu1p5> >("Matern nu=1.5", 4, epsilon_matern_nu_1p5_hyperparameters, 5.0e-3, 6.0e-3, 5.0e-15);
+    double epsilon_matern_nu_2p5_hyperparameters[2] = {5.0e-2, 1.0e-2};
+    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<MaternNu2p5> >("Matern nu=2.5", 3, epsilon_matern_nu_2p5_hyperparameters, 4.0e-3, 5.0e-3, 1.0e-12);
     if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=1.5 hessian covariance hyperparameters failed with %d errors\n", current_errors);
+      OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=2.5 hessian covariance hyperparameters failed with %d errors\n", current_errors);
     }
     total_errors += current_errors;
   }
+  return total_errors;
+}
 
-  {
-    double epsilon_matern_nu_2p5_hyperparameters[2] = {2.5e-2, 4.0e-3};
-    current_errors = PingCovarianceHyperparameterHessianTest<PingHessianCovarianceHyperparameters<MaternNu2p5> >("Matern nu=2.5", 4, epsilon_matern_nu_2p5_hyperparameters, 4.0e-3, 5.0e-3, 5.0e-15);
-    if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging matern nu=2.5 hessian covariance hyperparameters failed with %d errors\n", current_errors);
+/*!\rst
+  Times the covariance kernels on the per-pair hot path of hyperparameter optimization
+  (``BuildHyperparameterGradCovarianceMatrix()`` in gpp_model_selection.cpp calls HyperparameterGradCovariance() once per
+  pair of training points).  These kernels are heap-allocation free, so the timing is dominated by arithmetic; a regression
+  that reintroduces per-call temporaries shows up here as a several-fold slowdown.
+
+  Timings are reported via OL_VERBOSE_PRINTF; nothing is checked.
+\endrst*/
+void CovarianceHotPathBenchmark() {
+  const int dim = 3;
+  const int num_points = 400;
+  const int derivatives[2] = {0, 2};
+  const int num_derivatives = 2;
+
+  UniformRandomGenerator uniform_generator(1414);
+  boost::uniform_real<double> uniform_double(-2.0, 2.0);
+  std::vector<double> points(dim*num_points);
+  for (auto& entry : points) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+  SquareExponential covariance(dim, 1.3, 0.8);
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters();
+
+  // accumulate into a checksum so the calls cannot be optimized away
+  std::vector<double> grad_hyperparameter_cov(num_hyperparameters*Square(1 + num_derivatives));
+  std::vector<double> cov(Square(1 + num_derivatives));
+  double checksum = 0.0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_points; ++i) {
+    for (int j = 0; j < num_points; ++j) {
+      covariance.Covariance(points.data() + i*dim, derivatives, num_derivatives,
+                            points.data() + j*dim, derivatives, num_derivatives, cov.data());
+      checksum += cov[0];
     }
-    total_errors += current_errors;
   }
-*/
+  const double covariance_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_points; ++i) {
+    for (int j = 0; j < num_points; ++j) {
+      covariance.HyperparameterGradCovariance(points.data() + i*dim, derivatives, num_derivatives,
+                                              points.data() + j*dim, derivatives, num_derivatives,
+                                              grad_hyperparameter_cov.data());
+      checksum += grad_hyperparameter_cov[0];
+    }
+  }
+  const double hyperparameter_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  OL_VERBOSE_PRINTF("%d^2 pairs: Covariance %.3e s, HyperparameterGradCovariance %.3e s (checksum %.3e)\n",
+                    num_points, covariance_time, hyperparameter_time, checksum);
+}
+
+/*!\rst
+  Test that the batched CovarianceMatrix() overrides (SquareExponential, MaternNu1p5, MaternNu2p5) agree with the pairwise
+  default (CovarianceInterface::CovarianceMatrix(), which loops over Covariance()).
+
+  Checks a "mix" (two different point lists) case and the symmetric (same list on both sides) case, each with and without
+  derivative observations; the mix and symmetric cases are also built by CrossCovarianceMatrix() and
+  SymmetricCovarianceMatrix() from CrossPairwiseDifferences and PairwiseDifferences caches, and the mix case by
+  CovarianceMatrixOfScaledPoints() from a ScaledPointsTranspose (which every covariance but AdditiveSquareExponential
+  fills).
+
+  \return
+    Number of covariance functions where the batched and pairwise covariance matrices differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunCovarianceMatrixTests() {
+  const int dim = 4;
+  const int num_points_one = 37;
+  const int num_points_two = 23;
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(8675309);
+  boost::uniform_real<double> uniform_double_length(0.5, 2.5);
+  boost::uniform_real<double> uniform_double_point(-4.0, 4.0);
+
+  std::vector<double> lengths(dim);
+  for (auto& length : lengths) {
+    length = uniform_double_length(uniform_generator.engine);
+  }
+  std::vector<double> points_one(dim*num_points_one);
+  for (auto& entry : points_one) {
+    entry = uniform_double_point(uniform_generator.engine);
+  }
+  std::vector<double> points_two(dim*num_points_two);
+  for (auto& entry : points_two) {
+    entry = uniform_double_point(uniform_generator.engine);
+  }
+
+  const int derivatives_one[2] = {0, 2};
+  const int derivatives_two[3] = {3, 0, 1};
+  const int num_derivatives_cases[2][2] = {{0, 0}, {2, 3}};
+
+  SquareExponential square_exponential(dim, 1.7, lengths);
+  MaternNu1p5 matern_nu_1p5(dim, 1.7, lengths);
+  MaternNu2p5 matern_nu_2p5(dim, 1.7, lengths);
+  AdditiveSquareExponential additive_square_exponential(dim, {{2, 0}, {3}}, {1.1, 0.6}, lengths);
+  const CovarianceInterface * const covariances[4] = {&square_exponential, &matern_nu_1p5, &matern_nu_2p5,
+                                                      &additive_square_exponential};
+  int total_errors = 0;
+  for (const CovarianceInterface * covariance_pointer : covariances) {
+    const CovarianceInterface& covariance = *covariance_pointer;
+    for (const auto& num_derivatives : num_derivatives_cases) {
+      const int num_rows = num_points_one*(1 + num_derivatives[0]);
+      const int num_cols = num_points_two*(1 + num_derivatives[1]);
+      std::vector<double> cov_batched(num_rows*num_cols);
+      std::vector<double> cov_pairwise(num_rows*num_cols);
+
+      // mix covariance
+      covariance.CovarianceMatrix(points_one.data(), points_two.data(), dim, num_points_one, num_points_two,
+                                  derivatives_one, num_derivatives[0], derivatives_two, num_derivatives[1],
+                                  cov_batched.data());
+      covariance.CovarianceInterface::CovarianceMatrix(points_one.data(), points_two.data(), dim, num_points_one,
+                                                       num_points_two, derivatives_one, num_derivatives[0],
+                                                       derivatives_two, num_derivatives[1], cov_pairwise.data());
+      for (int i = 0; i < num_rows*num_cols; ++i) {
+        if (!CheckDoubleWithin(cov_batched[i], cov_pairwise[i], tolerance)) {
+          ++total_errors;
+        }
+      }
+
+      // mix covariance from a kept, length-scaled copy of points_one (covariances that do not use one leave it empty)
+      ScaledPointsTranspose scaled_one;
+      covariance.ScalePointsTranspose(points_one.data(), num_points_one, &scaled_one);
+      if (scaled_one.Matches(points_one.data(), num_points_one)) {
+        std::fill(cov_batched.begin(), cov_batched.end(), 0.0);
+        covariance.CovarianceMatrixOfScaledPoints(scaled_one, points_two.data(), num_points_two, derivatives_one,
+                                                  num_derivatives[0], derivatives_two, num_derivatives[1],
+                                                  cov_batched.data());
+        for (int i = 0; i < num_rows*num_cols; ++i) {
+          if (!CheckDoubleWithin(cov_batched[i], cov_pairwise[i], tolerance)) {
+            ++total_errors;
+          }
+        }
+      } else if (covariance_pointer != &additive_square_exponential) {
+        ++total_errors;
+      }
+
+      // mix covariance from cached squared differences
+      CrossPairwiseDifferences cross_differences(dim);
+      cross_differences.SetPoints(points_one.data(), num_points_one, points_two.data(), num_points_two);
+      if (!cross_differences.Matches(points_one.data(), num_points_one, points_two.data(), num_points_two)) {
+        ++total_errors;
+      }
+      covariance.CrossCovarianceMatrix(cross_differences, derivatives_one, num_derivatives[0], derivatives_two,
+                                       num_derivatives[1], cov_batched.data());
+      for (int i = 0; i < num_rows*num_cols; ++i) {
+        if (!CheckDoubleWithin(cov_batched[i], cov_pairwise[i], tolerance)) {
+          ++total_errors;
+        }
+      }
+
+      // symmetric covariance
+      const int num_rows_symmetric = num_points_one*(1 + num_derivatives[0]);
+      cov_batched.resize(Square(num_rows_symmetric));
+      cov_pairwise.resize(Square(num_rows_symmetric));
+      covariance.CovarianceMatrix(points_one.data(), points_one.data(), dim, num_points_one, num_points_one,
+                                  derivatives_one, num_derivatives[0], derivatives_one, num_derivatives[0],
+                                  cov_batched.data());
+      covariance.CovarianceInterface::CovarianceMatrix(points_one.data(), points_one.data(), dim, num_points_one,
+                                                       num_points_one, derivatives_one, num_derivatives[0],
+                                                       derivatives_one, num_derivatives[0], cov_pairwise.data());
+      for (int i = 0; i < Square(num_rows_symmetric); ++i) {
+        if (!CheckDoubleWithin(cov_batched[i], cov_pairwise[i], tolerance)) {
+          ++total_errors;
+        }
+      }
+
+      // symmetric covariance from cached squared differences
+      PairwiseDifferences pairwise_differences(points_one.data(), dim, num_points_one, derivatives_one,
+                                               num_derivatives[0]);
+      covariance.SymmetricCovarianceMatrix(pairwise_differences, cov_batched.data());
+      for (int i = 0; i < Square(num_rows_symmetric); ++i) {
+        if (!CheckDoubleWithin(cov_batched[i], cov_pairwise[i], tolerance)) {
+          ++total_errors;
+        }
+      }
+    }
+
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Test that BuildSymmetricCovarianceMatrixInParallel() agrees with a single symmetric CovarianceMatrix() call on a point
+  list long enough to be cut into several tiles (including a partial last tile), with and without derivative
+  observations.
+
+  \return
+    Number of entries that differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunParallelCovarianceMatrixTests() {
+  const int dim = 3;
+  const int num_points = 600;
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(31415);
+  boost::uniform_real<double> uniform_double_point(-4.0, 4.0);
+  std::vector<double> points(dim*num_points);
+  for (auto& entry : points) {
+    entry = uniform_double_point(uniform_generator.engine);
+  }
+
+  const int derivatives[2] = {0, 2};
+  const int num_derivatives_cases[2] = {0, 2};
+
+  SquareExponential square_exponential(dim, 1.3, {0.8, 1.5, 2.1});
+  MaternNu2p5 matern_nu_2p5(dim, 1.3, {0.8, 1.5, 2.1});
+  const CovarianceInterface * const covariances[2] = {&square_exponential, &matern_nu_2p5};
+  int total_errors = 0;
+  for (const CovarianceInterface * covariance_pointer : covariances) {
+    for (const int num_derivatives : num_derivatives_cases) {
+      const int num_rows = num_points*(1 + num_derivatives);
+      std::vector<double> cov_parallel(Square(num_rows), -1.0);
+      std::vector<double> cov_serial(Square(num_rows));
+      BuildSymmetricCovarianceMatrixInParallel(*covariance_pointer, points.data(), dim, num_points, derivatives,
+                                               num_derivatives, cov_parallel.data());
+      covariance_pointer->CovarianceMatrix(points.data(), points.data(), dim, num_points, num_points, derivatives,
+                                           num_derivatives, derivatives, num_derivatives, cov_serial.data());
+      for (int i = 0; i < Square(num_rows); ++i) {
+        if (!CheckDoubleWithin(cov_parallel[i], cov_serial[i], tolerance)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Test that the derivative blocks of SquareExponential's Covariance(), GradCovariance(), and HyperparameterGradCovariance()
+  depend only on which dimensions are observed: the blocks for derivative lists that are unordered subsets of
+  ``{0, ..., dim-1}`` must equal the matching entries of the full (gradient-enhanced, ``num_derivatives = dim``) blocks.
+  This exercises the ``index == i`` corrections of the vectorized kernels at every position.
+
+  Entries are computed by the same operations either way, so they must agree exactly.
+
+  \return
+    Number of entries that differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunCovarianceDerivativeSubsetTests() {
+  const int dim = 5;
+  const int num_pairs = 6;
+  const double tolerance = 0.0;
+
+  UniformRandomGenerator uniform_generator(2718);
+  boost::uniform_real<double> uniform_double_length(0.5, 2.5);
+  boost::uniform_real<double> uniform_double_point(-2.0, 2.0);
+
+  std::vector<double> lengths(dim);
+  for (auto& length : lengths) {
+    length = uniform_double_length(uniform_generator.engine);
+  }
+  SquareExponential covariance(dim, 1.4, lengths);
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters();
+
+  std::vector<int> derivatives_full(dim);
+  for (int d = 0; d < dim; ++d) {
+    derivatives_full[d] = d;
+  }
+  const std::vector<int> derivatives_one = {3, 0};
+  const std::vector<int> derivatives_two = {4, 3, 1};
+  const int num_derivatives_one = derivatives_one.size();
+  const int num_derivatives_two = derivatives_two.size();
+  // block index in the subset -> block index in the full list (0 is the function value)
+  std::vector<int> full_index_one(1, 0), full_index_two(1, 0);
+  for (int index : derivatives_one) {
+    full_index_one.push_back(index + 1);
+  }
+  for (int index : derivatives_two) {
+    full_index_two.push_back(index + 1);
+  }
+
+  std::vector<double> cov_full(Square(dim+1)), cov(full_index_one.size()*full_index_two.size());
+  std::vector<double> grad_full(dim*Square(dim+1)), grad(dim*cov.size());
+  std::vector<double> grad_hyper_full(num_hyperparameters*Square(dim+1)), grad_hyper(num_hyperparameters*cov.size());
+  std::vector<double> point_one(dim), point_two(dim);
+
+  int total_errors = 0;
+  for (int k = 0; k < num_pairs; ++k) {
+    for (int d = 0; d < dim; ++d) {
+      point_one[d] = uniform_double_point(uniform_generator.engine);
+      // the last pair has x_1 = x_2
+      point_two[d] = k == num_pairs - 1 ? point_one[d] : uniform_double_point(uniform_generator.engine);
+    }
+
+    covariance.Covariance(point_one.data(), derivatives_full.data(), dim, point_two.data(), derivatives_full.data(), dim,
+                          cov_full.data());
+    covariance.Covariance(point_one.data(), derivatives_one.data(), num_derivatives_one, point_two.data(),
+                          derivatives_two.data(), num_derivatives_two, cov.data());
+    covariance.GradCovariance(point_one.data(), derivatives_full.data(), dim, point_two.data(), derivatives_full.data(),
+                              dim, grad_full.data());
+    covariance.GradCovariance(point_one.data(), derivatives_one.data(), num_derivatives_one, point_two.data(),
+                              derivatives_two.data(), num_derivatives_two, grad.data());
+    covariance.HyperparameterGradCovariance(point_one.data(), derivatives_full.data(), dim, point_two.data(),
+                                            derivatives_full.data(), dim, grad_hyper_full.data());
+    covariance.HyperparameterGradCovariance(point_one.data(), derivatives_one.data(), num_derivatives_one,
+                                            point_two.data(), derivatives_two.data(), num_derivatives_two,
+                                            grad_hyper.data());
+
+    for (int n = 0; n <= num_derivatives_two; ++n) {
+      for (int m = 0; m <= num_derivatives_one; ++m) {
+        const int block = m + n*(1 + num_derivatives_one);
+        const int block_full = full_index_one[m] + full_index_two[n]*(dim+1);
+        if (!CheckDoubleWithin(cov[block], cov_full[block_full], tolerance)) {
+          ++total_errors;
+        }
+        for (int i = 0; i < dim; ++i) {
+          if (!CheckDoubleWithin(grad[i + block*dim], grad_full[i + block_full*dim], tolerance)) {
+            ++total_errors;
+          }
+        }
+        for (int i = 0; i < num_hyperparameters; ++i) {
+          if (!CheckDoubleWithin(grad_hyper[i + block*num_hyperparameters],
+                                 grad_hyper_full[i + block_full*num_hyperparameters], tolerance)) {
+            ++total_errors;
+          }
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Test that AdditiveSquareExponential is the sum of its groups' SquareExponential kernels: Covariance(), GradCovariance(),
+  and HyperparameterGradCovariance() (with gradient observations in grouped and ungrouped dimensions) must match the
+  per-group SquareExponential outputs on the projected points, scattered to the full dimensions, derivative blocks, and
+  hyperparameter list.  (The SquareExponential kernels are pinged above.)
+
+  \return
+    Number of entries that differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunAdditiveCovarianceTests() {
+  const int dim = 6;
+  const int num_pairs = 6;
+  const double tolerance = 1.0e-13;
+  // dimension 3 is in no group
+  const std::vector<std::vector<int> > groups = {{4, 0}, {2}, {5, 1}};
+  const std::vector<double> alphas = {1.3, 0.7, 2.1};
+
+  UniformRandomGenerator uniform_generator(314);
+  boost::uniform_real<double> uniform_double_length(0.5, 2.5);
+  boost::uniform_real<double> uniform_double_point(-2.0, 2.0);
+
+  std::vector<double> lengths(dim);
+  for (auto& length : lengths) {
+    length = uniform_double_length(uniform_generator.engine);
+  }
+  AdditiveSquareExponential covariance(dim, groups, alphas, lengths);
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters();
+
+  int total_errors = 0;
+  if (num_hyperparameters != 8 || covariance.num_groups() != 3) {
+    ++total_errors;
+  }
+
+  const std::vector<int> derivatives_one = {0, 3, 5, 4};
+  const std::vector<int> derivatives_two = {4, 2, 0};
+  const int num_derivatives_one = derivatives_one.size();
+  const int num_derivatives_two = derivatives_two.size();
+  const int num_blocks = (1 + num_derivatives_one)*(1 + num_derivatives_two);
+
+  std::vector<double> cov(num_blocks), grad(dim*num_blocks), grad_hyper(num_hyperparameters*num_blocks);
+  std::vector<double> cov_expected(num_blocks), grad_expected(dim*num_blocks);
+  std::vector<double> grad_hyper_expected(num_hyperparameters*num_blocks);
+  std::vector<double> point_one(dim), point_two(dim);
+
+  for (int k = 0; k < num_pairs; ++k) {
+    for (int d = 0; d < dim; ++d) {
+      point_one[d] = uniform_double_point(uniform_generator.engine);
+      // the last pair has x_1 = x_2
+      point_two[d] = k == num_pairs - 1 ? point_one[d] : uniform_double_point(uniform_generator.engine);
+    }
+
+    covariance.Covariance(point_one.data(), derivatives_one.data(), num_derivatives_one, point_two.data(),
+                          derivatives_two.data(), num_derivatives_two, cov.data());
+    covariance.GradCovariance(point_one.data(), derivatives_one.data(), num_derivatives_one, point_two.data(),
+                              derivatives_two.data(), num_derivatives_two, grad.data());
+    covariance.HyperparameterGradCovariance(point_one.data(), derivatives_one.data(), num_derivatives_one,
+                                            point_two.data(), derivatives_two.data(), num_derivatives_two,
+                                            grad_hyper.data());
+
+    std::fill(cov_expected.begin(), cov_expected.end(), 0.0);
+    std::fill(grad_expected.begin(), grad_expected.end(), 0.0);
+    std::fill(grad_hyper_expected.begin(), grad_hyper_expected.end(), 0.0);
+    int hyperparameter_offset = 0;
+    for (int g = 0; g < static_cast<int>(groups.size()); ++g) {
+      const std::vector<int>& group = groups[g];
+      const int group_dim = group.size();
+      std::vector<double> group_lengths(group_dim), group_point_one(group_dim), group_point_two(group_dim);
+      // local derivative lists and, per local block index, the block index in the full lists
+      std::vector<int> group_derivatives_one, group_derivatives_two;
+      std::vector<int> full_index_one(1, 0), full_index_two(1, 0);
+      for (int i = 0; i < group_dim; ++i) {
+        group_lengths[i] = lengths[group[i]];
+        group_point_one[i] = point_one[group[i]];
+        group_point_two[i] = point_two[group[i]];
+      }
+      for (int m = 0; m < num_derivatives_one; ++m) {
+        const auto position = std::find(group.begin(), group.end(), derivatives_one[m]);
+        if (position != group.end()) {
+          group_derivatives_one.push_back(position - group.begin());
+          full_index_one.push_back(m + 1);
+        }
+      }
+      for (int n = 0; n < num_derivatives_two; ++n) {
+        const auto position = std::find(group.begin(), group.end(), derivatives_two[n]);
+        if (position != group.end()) {
+          group_derivatives_two.push_back(position - group.begin());
+          full_index_two.push_back(n + 1);
+        }
+      }
+      const int group_num_derivatives_one = group_derivatives_one.size();
+      const int group_num_derivatives_two = group_derivatives_two.size();
+      const int group_num_blocks = (1 + group_num_derivatives_one)*(1 + group_num_derivatives_two);
+
+      SquareExponential group_covariance(group_dim, alphas[g], group_lengths);
+      std::vector<double> group_cov(group_num_blocks), group_grad(group_dim*group_num_blocks);
+      std::vector<double> group_grad_hyper((1 + group_dim)*group_num_blocks);
+      group_covariance.Covariance(group_point_one.data(), group_derivatives_one.data(), group_num_derivatives_one,
+                                  group_point_two.data(), group_derivatives_two.data(), group_num_derivatives_two,
+                                  group_cov.data());
+      group_covariance.GradCovariance(group_point_one.data(), group_derivatives_one.data(), group_num_derivatives_one,
+                                      group_point_two.data(), group_derivatives_two.data(), group_num_derivatives_two,
+                                      group_grad.data());
+      group_covariance.HyperparameterGradCovariance(group_point_one.data(), group_derivatives_one.data(),
+                                                    group_num_derivatives_one, group_point_two.data(),
+                                                    group_derivatives_two.data(), group_num_derivatives_two,
+                                                    group_grad_hyper.data());
+
+      for (int n = 0; n <= group_num_derivatives_two; ++n) {
+        for (int m = 0; m <= group_num_derivatives_one; ++m) {
+          const int block = m + n*(1 + group_num_derivatives_one);
+          const int block_full = full_index_one[m] + full_index_two[n]*(1 + num_derivatives_one);
+          cov_expected[block_full] += group_cov[block];
+          for (int i = 0; i < group_dim; ++i) {
+            grad_expected[group[i] + block_full*dim] += group_grad[i + block*group_dim];
+          }
+          for (int i = 0; i < 1 + group_dim; ++i) {
+            grad_hyper_expected[hyperparameter_offset + i + block_full*num_hyperparameters] +=
+                group_grad_hyper[i + block*(1 + group_dim)];
+          }
+        }
+      }
+      hyperparameter_offset += 1 + group_dim;
+    }
+
+    for (int i = 0; i < num_blocks; ++i) {
+      if (!CheckDoubleWithin(cov[i], cov_expected[i], tolerance)) {
+        ++total_errors;
+      }
+    }
+    for (int i = 0; i < dim*num_blocks; ++i) {
+      if (!CheckDoubleWithin(grad[i], grad_expected[i], tolerance)) {
+        ++total_errors;
+      }
+    }
+    for (int i = 0; i < num_hyperparameters*num_blocks; ++i) {
+      if (!CheckDoubleWithin(grad_hyper[i], grad_hyper_expected[i], tolerance)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // hyperparameters round trip, group by group
+  std::vector<double> hyperparameters(num_hyperparameters), hyperparameters_round_trip(num_hyperparameters);
+  for (int i = 0; i < num_hyperparameters; ++i) {
+    hyperparameters[i] = 1.0 + 0.25*i;
+  }
+  covariance.SetHyperparameters(hyperparameters.data());
+  covariance.GetHyperparameters(hyperparameters_round_trip.data());
+  if (hyperparameters != hyperparameters_round_trip) {
+    ++total_errors;
+  }
+
   return total_errors;
 }
 
@@ -617,6 +1243,32 @@ int RunCovarianceTests() {
   }
   total_errors += current_errors;
 
+  current_errors = RunCovarianceMatrixTests();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("Batched covariance matrix failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = RunParallelCovarianceMatrixTests();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("Parallel covariance matrix failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = RunCovarianceDerivativeSubsetTests();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("Covariance derivative subsets failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = RunAdditiveCovarianceTests();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("Additive covariance failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  CovarianceHotPathBenchmark();
+
   return total_errors;
 }
 
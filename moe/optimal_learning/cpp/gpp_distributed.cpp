@@ -0,0 +1,122 @@
+/*!
+  \file gpp_distributed.cpp
+  \rst
+  Implementation of DistributedContext (see gpp_distributed.hpp).  With ``OL_MPI_ENABLED``, the collectives of a
+  context over a communicator call MPI; the serial context (and every context without MPI support) skips them.
+\endrst*/
+
+#include "gpp_distributed.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#include "gpp_common.hpp"
+#include "gpp_exception.hpp"
+
+namespace optimal_learning {
+
+#ifdef OL_MPI_ENABLED
+DistributedContext::DistributedContext() noexcept : rank_(0), size_(1), communicator_(MPI_COMM_NULL) {
+}
+
+DistributedContext::DistributedContext(MPI_Comm communicator) : rank_(0), size_(1), communicator_(communicator) {
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  if (unlikely(initialized == 0)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "MPI must be initialized before constructing a DistributedContext.");
+  }
+  MPI_Comm_rank(communicator_, &rank_);
+  MPI_Comm_size(communicator_, &size_);
+}
+
+DistributedContext DistributedContext::World() {
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  return initialized != 0 ? DistributedContext(MPI_COMM_WORLD) : DistributedContext();
+}
+
+void DistributedContext::SumInPlace(double * values, int size) const {
+  if (communicator_ != MPI_COMM_NULL && size > 0) {
+    MPI_Allreduce(MPI_IN_PLACE, values, size, MPI_DOUBLE, MPI_SUM, communicator_);
+  }
+}
+
+bool DistributedContext::AnyOf(bool flag) const {
+  if (communicator_ == MPI_COMM_NULL) {
+    return flag;
+  }
+  int any = flag ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &any, 1, MPI_INT, MPI_LOR, communicator_);
+  return any != 0;
+}
+
+int DistributedContext::ArgMaxRank(double value) const {
+  if (communicator_ == MPI_COMM_NULL) {
+    return 0;
+  }
+  // MPI_MAXLOC breaks ties toward the smaller index
+  struct {
+    double value;
+    int rank;
+  } value_and_rank = {value, rank_};
+  MPI_Allreduce(MPI_IN_PLACE, &value_and_rank, 1, MPI_DOUBLE_INT, MPI_MAXLOC, communicator_);
+  return value_and_rank.rank;
+}
+
+void DistributedContext::Broadcast(int root, double * values, int size) const {
+  if (communicator_ != MPI_COMM_NULL && size > 0) {
+    MPI_Bcast(values, size, MPI_DOUBLE, root, communicator_);
+  }
+}
+#else
+DistributedContext::DistributedContext() noexcept : rank_(0), size_(1) {
+}
+
+DistributedContext DistributedContext::World() {
+  return DistributedContext();
+}
+
+void DistributedContext::SumInPlace(double * OL_UNUSED(values), int OL_UNUSED(size)) const {
+}
+
+bool DistributedContext::AnyOf(bool flag) const {
+  return flag;
+}
+
+int DistributedContext::ArgMaxRank(double OL_UNUSED(value)) const {
+  return 0;
+}
+
+void DistributedContext::Broadcast(int OL_UNUSED(root), double * OL_UNUSED(values), int OL_UNUSED(size)) const {
+}
+#endif
+
+void DistributedContext::BlockRange(int num_items, int * begin, int * end) const noexcept {
+  const int block_size = num_items / size_;
+  const int remainder = num_items % size_;
+  *begin = rank_*block_size + std::min(rank_, remainder);
+  *end = *begin + block_size + (rank_ < remainder ? 1 : 0);
+}
+
+void DistributedContext::AllGatherBlocks(int num_items, int item_size, double * items) const {
+  if (size_ == 1) {
+    return;
+  }
+  // every entry is nonzero on at most one rank, so the sums are exact
+  int begin, end;
+  BlockRange(num_items, &begin, &end);
+  std::fill(items, items + begin*item_size, 0.0);
+  std::fill(items + end*item_size, items + num_items*item_size, 0.0);
+  SumInPlace(items, num_items*item_size);
+}
+
+void DistributedContext::RethrowIfAnyFailed(std::exception_ptr captured_exception) const {
+  if (AnyOf(captured_exception != nullptr)) {
+    if (captured_exception != nullptr) {
+      std::rethrow_exception(captured_exception);
+    }
+    OL_THROW_EXCEPTION(OptimalLearningException, "Failed on another rank.");
+  }
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,189 @@
+/*!
+  \file gpp_distributed.hpp
+  \rst
+  1. OVERVIEW
+  2. WHAT GETS DISTRIBUTED
+  3. BUILDING
+
+  **1. OVERVIEW**
+
+  Threads (OpenMP or the WorkStealingScheduler) only reach the cores of one process.  The largest suggestions (e.g.,
+  q,p-KG over a GaussianProcessMCMC with many hyperparameter samples and hundreds of multistarts) can instead be spread
+  over several processes, possibly on several nodes, that communicate through MPI.
+
+  DistributedContext is the handle to such a group of processes ("ranks").  Every rank holds its own copy of the
+  fitted model: e.g., each one loads the same binary snapshot (see gpp_model_snapshot.hpp) or refits from the same
+  data, and builds the same evaluators.  The ranks then split the work and combine their results with collective
+  reductions (sums, a max-location, broadcasts), so every rank ends up with the same answer.
+
+  Every member function of DistributedContext is a COLLECTIVE operation: all ranks of the context must call it, in the
+  same order, with the same sizes.  A rank that skips one (e.g., because it threw) deadlocks the others.
+
+  **2. WHAT GETS DISTRIBUTED**
+
+  a. Multistarts: MultistartOptimizer<...>::MultistartOptimizeDistributed() gives each rank a contiguous block of the
+     initial guesses (see DistributedContext::BlockRange()), runs MultistartOptimize() on it, and combines the ranks'
+     best points with DistributedContext::ArgMaxRank() and Broadcast().  The ranks' threads still parallelize within
+     each block.
+
+  b. MCMC hyperparameter samples: ExpectedImprovementMCMCEvaluator and KnowledgeGradientMCMCEvaluator optionally take a
+     DistributedContext; each rank then evaluates only its block of the samples and the per-sample values (and
+     gradients) are combined with AllGatherBlocks() before the usual reduction in sample order.  Every evaluation is a
+     collective, so the ranks must run the same optimization in lockstep (same initial guesses and seeds); use this
+     when there are fewer multistarts than ranks, or combine it with (a) over separate contexts.
+
+  **3. BUILDING**
+
+  MPI support is compiled in with ``OL_MPI_ENABLED`` (cmake: ``-D MOE_USE_MPI=1``).  Without it, every context is the
+  serial context, rank 0 of 1, whose collectives are no-ops; so code written against DistributedContext runs unchanged
+  in a single process.  With it, MPI must be initialized (``MPI_Init_thread()``) before a context over a communicator
+  is constructed; the collectives are called from one thread per rank (``MPI_THREAD_FUNNELED`` is enough).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_HPP_
+
+#ifdef OL_MPI_ENABLED
+#include <mpi.h>  // NOLINT(build/include_order)
+#endif
+
+#include <exception>
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  A group of processes (ranks) that split work and combine results with collective reductions; see the file comments.
+  Cheap to copy; copies refer to the same group.
+\endrst*/
+class DistributedContext final {
+ public:
+  /*!\rst
+    Constructs the serial context: rank 0 of 1.  Its collectives are no-ops.
+  \endrst*/
+  DistributedContext() noexcept;
+
+#ifdef OL_MPI_ENABLED
+  /*!\rst
+    Constructs a context over an MPI communicator.
+
+    \param
+      :communicator: the ranks of this context; MPI must be initialized and the communicator must outlive the context
+    \raise
+      OptimalLearningException if MPI is not initialized
+  \endrst*/
+  explicit DistributedContext(MPI_Comm communicator);
+#endif
+
+  /*!\rst
+    The context over every process of the job: ``MPI_COMM_WORLD`` if MPI support is compiled in and MPI is
+    initialized, the serial context otherwise.
+
+    \return
+      the world context
+  \endrst*/
+  static DistributedContext World() OL_WARN_UNUSED_RESULT;
+
+  //! index of this process in the context, in ``[0, size())``
+  int rank() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return rank_;
+  }
+
+  //! number of processes in the context
+  int size() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return size_;
+  }
+
+  /*!\rst
+    This rank's share of ``num_items`` items: a contiguous block, in rank order, whose sizes differ by at most 1.
+    Ranks past ``num_items`` get an empty block.  Not a collective.
+
+    \param
+      :num_items: number of items to split
+    \output
+      :begin[1]: first item of this rank's block
+      :end[1]: one past the last item of this rank's block
+  \endrst*/
+  void BlockRange(int num_items, int * begin, int * end) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Sums ``values`` elementwise over the ranks; every rank receives the sums.
+
+    \param
+      :values[size]: this rank's values
+      :size: number of values
+    \output
+      :values[size]: sums over the ranks
+  \endrst*/
+  void SumInPlace(double * values, int size) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \param
+      :flag: this rank's flag
+    \return
+      true if ``flag`` is true on any rank
+  \endrst*/
+  bool AnyOf(bool flag) const OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    The rank holding the largest ``value``; ties go to the lowest rank.  ``-infinity`` is allowed (e.g., for a rank
+    with nothing to report); NaN is not.
+
+    \param
+      :value: this rank's value
+    \return
+      the rank of the largest value
+  \endrst*/
+  int ArgMaxRank(double value) const OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Copies ``values`` from rank ``root`` to every rank.
+
+    \param
+      :root: rank whose values are sent
+      :values[size]: the values to send (on ``root``)
+      :size: number of values
+    \output
+      :values[size]: ``root``'s values
+  \endrst*/
+  void Broadcast(int root, double * values, int size) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Completes an array of ``num_items`` items (of ``item_size`` doubles each) of which every rank computed its block
+    (see BlockRange()): every rank receives every block.  Items outside this rank's block are ignored on input.
+
+    \param
+      :num_items: number of items
+      :item_size: doubles per item
+      :items[item_size][num_items]: items of this rank's block
+    \output
+      :items[item_size][num_items]: every rank's block
+  \endrst*/
+  void AllGatherBlocks(int num_items, int item_size, double * items) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Propagates a failure on any rank to every rank, so that no rank is left waiting in a later collective: call it
+    after capturing (rather than propagating) the exceptions of a rank's share of the work.
+
+    \param
+      :captured_exception: this rank's exception, nullptr if it succeeded
+    \raise
+      ``captured_exception`` if it is not nullptr; OptimalLearningException if another rank failed
+  \endrst*/
+  void RethrowIfAnyFailed(std::exception_ptr captured_exception) const;
+
+ private:
+  //! index of this process
+  int rank_;
+  //! number of processes
+  int size_;
+#ifdef OL_MPI_ENABLED
+  //! the ranks of this context; MPI_COMM_NULL for the serial context
+  MPI_Comm communicator_;
+#endif
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_HPP_
@@ -0,0 +1,237 @@
+/*!
+  \file gpp_distributed_test.cpp
+  \rst
+  Routines to test the functions in gpp_distributed.cpp:
+
+  * the serial context is rank 0 of 1, owns every item, and its collectives leave their inputs unchanged,
+  * DistributedContext::BlockRange() splits items into contiguous blocks, in rank order, covering every item once,
+  * the collectives (sums, AnyOf(), ArgMaxRank(), Broadcast(), AllGatherBlocks()) combine the ranks' values, and
+  * RethrowIfAnyFailed() rethrows this rank's exception and is silent when no rank failed.
+
+  The tests use DistributedContext::World(), so they check the MPI collectives when run under ``mpirun`` with
+  ``OL_MPI_ENABLED``; every expected value is written for any number of ranks.
+\endrst*/
+
+#include "gpp_distributed_test.hpp"
+
+#include <cmath>
+
+#include <exception>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_distributed.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_logging.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks the serial context: rank 0 of 1, one block holding every item, no-op collectives.
+
+  \return
+    number of test failures
+\endrst*/
+int SerialContextTest() {
+  int total_errors = 0;
+  const DistributedContext context;
+  if (context.rank() != 0 || context.size() != 1) {
+    ++total_errors;
+  }
+
+  int begin, end;
+  context.BlockRange(7, &begin, &end);
+  if (begin != 0 || end != 7) {
+    ++total_errors;
+  }
+
+  std::vector<double> values = {1.5, -2.0, 3.25};
+  const std::vector<double> original_values(values);
+  context.SumInPlace(values.data(), values.size());
+  context.Broadcast(0, values.data(), values.size());
+  context.AllGatherBlocks(values.size(), 1, values.data());
+  if (values != original_values) {
+    ++total_errors;
+  }
+
+  if (context.AnyOf(false) || !context.AnyOf(true) || context.ArgMaxRank(-INFINITY) != 0) {
+    ++total_errors;
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks BlockRange() over the world context: blocks are contiguous, in rank order, differ in size by at most 1, and
+  together cover every item exactly once (including fewer items than ranks).
+
+  \return
+    number of test failures
+\endrst*/
+int BlockRangeTest() {
+  int total_errors = 0;
+  const DistributedContext context = DistributedContext::World();
+  const int num_items_list[] = {0, 1, context.size() - 1, context.size(), 3*context.size() + 2, 101};
+  for (const int num_items : num_items_list) {
+    int begin, end;
+    context.BlockRange(num_items, &begin, &end);
+    const int block_size = end - begin;
+    if (begin < 0 || end > num_items || block_size < num_items/context.size() ||
+        block_size > num_items/context.size() + 1) {
+      ++total_errors;
+    }
+
+    // each item counted once, and each block starts where the previous rank's ended
+    std::vector<double> counts(num_items, 0.0);
+    for (int i = begin; i < end; ++i) {
+      counts[i] += 1.0;
+    }
+    std::vector<double> ends(context.size(), 0.0);
+    ends[context.rank()] = end;
+    if (num_items > 0) {
+      context.SumInPlace(counts.data(), num_items);
+    }
+    context.SumInPlace(ends.data(), context.size());
+    for (const double count : counts) {
+      if (count != 1.0) {
+        ++total_errors;
+      }
+    }
+    if (begin != (context.rank() == 0 ? 0 : static_cast<int>(ends[context.rank() - 1]))) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks SumInPlace(), AnyOf(), ArgMaxRank() (including ties), Broadcast(), and AllGatherBlocks() over the world
+  context.
+
+  \return
+    number of test failures
+\endrst*/
+int CollectivesTest() {
+  int total_errors = 0;
+  const DistributedContext context = DistributedContext::World();
+  const int rank = context.rank();
+  const int size = context.size();
+
+  double rank_sum = rank;
+  context.SumInPlace(&rank_sum, 1);
+  if (rank_sum != 0.5*size*(size - 1)) {
+    ++total_errors;
+  }
+
+  if (!context.AnyOf(rank == size - 1) || context.AnyOf(false)) {
+    ++total_errors;
+  }
+
+  // the largest value wins; ties go to the lowest rank
+  if (context.ArgMaxRank(rank) != size - 1 || context.ArgMaxRank(1.0) != 0 ||
+      context.ArgMaxRank(rank == 0 ? -INFINITY : 2.0) != (size > 1 ? 1 : 0)) {
+    ++total_errors;
+  }
+
+  double broadcast_values[2] = {static_cast<double>(rank), -1.0*rank};
+  context.Broadcast(size - 1, broadcast_values, 2);
+  if (broadcast_values[0] != size - 1 || broadcast_values[1] != -1.0*(size - 1)) {
+    ++total_errors;
+  }
+
+  // each rank fills its block (and garbage elsewhere); everyone receives every block
+  const int num_items = 2*size + 1;
+  const int item_size = 3;
+  int begin, end;
+  context.BlockRange(num_items, &begin, &end);
+  std::vector<double> items(num_items*item_size, -7.0);
+  for (int i = begin; i < end; ++i) {
+    for (int k = 0; k < item_size; ++k) {
+      items[i*item_size + k] = 10.0*i + k;
+    }
+  }
+  context.AllGatherBlocks(num_items, item_size, items.data());
+  for (int i = 0; i < num_items; ++i) {
+    for (int k = 0; k < item_size; ++k) {
+      if (items[i*item_size + k] != 10.0*i + k) {
+        ++total_errors;
+      }
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks RethrowIfAnyFailed(): silent when no rank failed, rethrows this rank's exception when every rank failed.
+
+  \return
+    number of test failures
+\endrst*/
+int RethrowIfAnyFailedTest() {
+  int total_errors = 0;
+  const DistributedContext context = DistributedContext::World();
+  try {
+    context.RethrowIfAnyFailed(nullptr);
+  } catch (const std::exception&) {
+    ++total_errors;
+  }
+
+  std::exception_ptr captured_exception;
+  try {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "test failure.", -1, 0);
+  } catch (const std::exception&) {
+    captured_exception = std::current_exception();
+  }
+  try {
+    // increment errors: we must catch an exception to decrement
+    total_errors += 1;
+    context.RethrowIfAnyFailed(captured_exception);
+  } catch (const LowerBoundException<int>&) {
+    total_errors -= 1;
+  }
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunDistributedTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = SerialContextTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("serial distributed context failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("serial distributed context\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = BlockRangeTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("distributed block range failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("distributed block range\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = CollectivesTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("distributed collectives failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("distributed collectives\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = RethrowIfAnyFailedTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("distributed failure propagation failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("distributed failure propagation\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
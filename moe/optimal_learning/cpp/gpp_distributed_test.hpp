@@ -0,0 +1,25 @@
+/*!
+  \file gpp_distributed_test.hpp
+  \rst
+  Functions for testing gpp_distributed's functionality: DistributedContext's block partition and collectives, on the
+  world context (the serial context unless MPI support is compiled in and the tests run under ``mpirun``).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the DistributedContext tests.  A collective when run over several ranks.
+
+  \return
+    number of test failures: 0 if the partition and collectives are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunDistributedTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_DISTRIBUTED_TEST_HPP_
@@ -6,7 +6,10 @@
 
 #include "gpp_domain.hpp"
 
+#include <cmath>
+
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <vector>
 
@@ -14,11 +17,12 @@
 #include "gpp_exception.hpp"
 #include "gpp_geometry.hpp"
 #include "gpp_logging.hpp"
+#include "gpp_random.hpp"
 
 namespace optimal_learning {
 
 TensorProductDomain::TensorProductDomain(ClosedInterval const * restrict domain, int dim_in)
-    : dim_(dim_in), domain_(domain, domain + dim_) {
+    : dim_(dim_in), domain_(domain, domain + dim_), start_point_sampling_(StartPointSampling::kLatinHypercube) {
   bool is_empty = std::any_of(domain_.begin(), domain_.end(), [](ClosedInterval interval) {
       return interval.IsEmpty();
     });
@@ -57,10 +61,21 @@ bool TensorProductDomain::GeneratePointInDomain(UniformRandomGenerator * uniform
 int TensorProductDomain::GenerateUniformPointsInDomain(int num_points,
                                                        UniformRandomGenerator * uniform_generator,
                                                        double * restrict random_points) const {
+  if (start_point_sampling_ == StartPointSampling::kSobol && dim_ <= SobolNormalRNG::kMaxDimension) {
+    // a fresh scramble per call keeps repeated calls independent, as with the latin hypercube
+    return GenerateSobolPointsInDomain(num_points, 0, uniform_generator->engine(), random_points);
+  }
   ComputeLatinHypercubePointsInDomain(domain_.data(), dim_, num_points, uniform_generator, random_points);
   return num_points;
 }
 
+int TensorProductDomain::GenerateSobolPointsInDomain(int num_points, std::uint32_t first_index,
+                                                     UniformRandomGenerator::EngineType::result_type scramble_seed,
+                                                     double * restrict random_points) const {
+  ComputeSobolPointsInDomain(domain_.data(), dim_, num_points, first_index, scramble_seed, random_points);
+  return num_points;
+}
+
 void TensorProductDomain::LimitUpdate(double max_relative_change, double const * restrict current_point,
                                       double * restrict update_vector) const {
   for (int j = 0; j < dim_; ++j) {
@@ -104,6 +119,83 @@ void TensorProductDomain::LimitUpdate(double max_relative_change, double const *
   }
 }
 
+TrustRegionDomain::TrustRegionDomain(const TensorProductDomain& domain, double const * restrict center)
+    : TrustRegionDomain(domain, center, kInitialLength, kDefaultSuccessTolerance,
+                        domain.dim() > kMinimumFailureTolerance ? domain.dim() : kMinimumFailureTolerance) {
+}
+
+TrustRegionDomain::TrustRegionDomain(const TensorProductDomain& domain, double const * restrict center,
+                                     double length, int success_tolerance, int failure_tolerance)
+    : domain_(domain),
+      local_domain_(domain),
+      center_(domain.dim()),
+      length_(length),
+      success_tolerance_(success_tolerance),
+      failure_tolerance_(failure_tolerance),
+      num_successes_(0),
+      num_failures_(0) {
+  if (!(length_ > 0.0 && length_ <= kWholeDomainLength)) {
+    OL_THROW_EXCEPTION(BoundsException<double>, "Trust region length out of bounds.", length_, 0.0,
+                       kWholeDomainLength);
+  }
+  if (success_tolerance_ < 1) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "success_tolerance must be positive.", success_tolerance_, 1);
+  }
+  if (failure_tolerance_ < 1) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "failure_tolerance must be positive.", failure_tolerance_, 1);
+  }
+  SetCenter(center);
+}
+
+void TrustRegionDomain::SetCenter(double const * restrict center) {
+  for (int j = 0; j < dim(); ++j) {
+    const ClosedInterval& interval = domain_.GetInterval(j);
+    center_[j] = std::fmin(std::fmax(center[j], interval.min), interval.max);
+  }
+  UpdateLocalDomain();
+}
+
+void TrustRegionDomain::UpdateLength(bool improved) {
+  if (improved) {
+    ++num_successes_;
+    num_failures_ = 0;
+  } else {
+    ++num_failures_;
+    num_successes_ = 0;
+  }
+
+  if (num_successes_ >= success_tolerance_) {
+    // a length above kMaximumLength (set at construction) is not shrunk by success
+    length_ = std::fmax(length_, std::fmin(2.0*length_, kMaximumLength));
+    num_successes_ = 0;
+  } else if (num_failures_ >= failure_tolerance_) {
+    length_ *= 0.5;
+    num_failures_ = 0;
+  } else {
+    return;
+  }
+  UpdateLocalDomain();
+}
+
+void TrustRegionDomain::Reset(double const * restrict center) {
+  length_ = kInitialLength;
+  num_successes_ = 0;
+  num_failures_ = 0;
+  SetCenter(center);
+}
+
+void TrustRegionDomain::UpdateLocalDomain() {
+  std::vector<ClosedInterval> local_bounds(dim(), {0.0, 0.0});
+  for (int j = 0; j < dim(); ++j) {
+    const ClosedInterval& interval = domain_.GetInterval(j);
+    // center_ is inside interval, so the clipped box is never empty
+    const double half_width = 0.5*length_*interval.Length();
+    local_bounds[j].min = std::fmax(center_[j] - half_width, interval.min);
+    local_bounds[j].max = std::fmin(center_[j] + half_width, interval.max);
+  }
+  local_domain_.SetDomain(local_bounds.data());
+}
+
 SimplexIntersectTensorProductDomain::SimplexIntersectTensorProductDomain(ClosedInterval const * restrict domain,
                                                                          int dim_in)
     : dim_(dim_in), tensor_product_domain_(domain, dim_), simplex_plane_(dim_) {
@@ -138,6 +230,15 @@ SimplexIntersectTensorProductDomain::SimplexIntersectTensorProductDomain(ClosedI
   }
 
   tensor_product_domain_.SetDomain(domain_local.data());
+
+  // Rejection from the box accepts vol(intersection)/vol(box) of its draws; rejection from the simplex accepts
+  // vol(intersection)/vol(simplex).  The intersection cancels in their ratio, so sample from the smaller body.
+  double log_box_volume = 0.0;
+  for (int i = 0; i < dim_; ++i) {
+    log_box_volume += std::log(domain_local[i].Length());
+  }
+  double log_simplex_volume = -std::lgamma(static_cast<double>(dim_ + 1));  // vol(unit d-simplex) = 1/d!
+  sample_simplex_first_ = log_box_volume > log_simplex_volume;
 }
 
 int SimplexIntersectTensorProductDomain::GetMaxNumberOfBoundaryPlanes() const {
@@ -170,8 +271,13 @@ bool SimplexIntersectTensorProductDomain::GeneratePointInDomain(UniformRandomGen
   // The intersection between tensor product region and simplex can be *very* small so that rejection
   // sampling has a low rate of success. We do not want to wait "forever."
   for (int i = 0; i < 10000 && point_found == false; ++i) {
-    tensor_product_domain_.GeneratePointInDomain(uniform_generator, random_point);
-    point_found = CheckPointInUnitSimplex(random_point, dim_);  // stop if the point is inside the simplex too
+    if (sample_simplex_first_) {
+      ComputeUniformPointsInUnitSimplex(dim_, 1, uniform_generator, random_point);
+      point_found = tensor_product_domain_.CheckPointInside(random_point);  // stop if the point is inside the box too
+    } else {
+      tensor_product_domain_.GeneratePointInDomain(uniform_generator, random_point);
+      point_found = CheckPointInUnitSimplex(random_point, dim_);  // stop if the point is inside the simplex too
+    }
   }
   return point_found;
 }
@@ -179,11 +285,10 @@ bool SimplexIntersectTensorProductDomain::GeneratePointInDomain(UniformRandomGen
 int SimplexIntersectTensorProductDomain::GenerateUniformPointsInDomain(int num_points,
                                                                        UniformRandomGenerator * uniform_generator,
                                                                        double * restrict random_points) const {
-  // ASSUME: most of the tensor product domain lies inside the simplex domain
-  // TODO(GH-155): if the opposite is true (most of the simplex lies inside the tensor prod),
-  // then we need to instead draw a uniform sample from the simplex first, then reject
-  // based on the tensor product region.
+  // candidates come from whichever of the tensor product region and the simplex is smaller (see ctor), and are
+  // rejected against the other
   int num_points_local = std::max(10, num_points);
+  const int max_num_points_local = kMaxCandidatePointRatio*num_points_local;
   std::vector<double> random_points_local(num_points_local*dim_);
 
   const int max_num_attempts = 10;
@@ -191,14 +296,19 @@ int SimplexIntersectTensorProductDomain::GenerateUniformPointsInDomain(int num_p
   for (int j = 0; j < max_num_attempts; ++j) {
     random_points_local.resize(num_points_local*dim_);
     num_points_generated = 0;
-    // generate points in the tensor product domain
-    num_points_local = tensor_product_domain_.GenerateUniformPointsInDomain(num_points_local, uniform_generator, random_points_local.data());
+    if (sample_simplex_first_) {
+      ComputeUniformPointsInUnitSimplex(dim_, num_points_local, uniform_generator, random_points_local.data());
+    } else {
+      num_points_local = tensor_product_domain_.GenerateUniformPointsInDomain(num_points_local, uniform_generator, random_points_local.data());
+    }
 
     double * current_random_point = random_points;
     double const * current_random_point_local = random_points_local.data();
-    // now reject points that are not also in the simplex
+    // now reject points that are not also in the other body
     for (int i = 0; i < num_points_local; ++i) {
-      if (CheckPointInUnitSimplex(current_random_point_local, dim_) == true) {
+      bool point_inside = sample_simplex_first_ ? tensor_product_domain_.CheckPointInside(current_random_point_local) :
+          CheckPointInUnitSimplex(current_random_point_local, dim_);
+      if (point_inside == true) {
         std::copy(current_random_point_local, current_random_point_local + dim_, current_random_point);
         current_random_point += dim_;
         ++num_points_generated;
@@ -221,6 +331,8 @@ int SimplexIntersectTensorProductDomain::GenerateUniformPointsInDomain(int num_p
       } else {
         num_points_local = static_cast<int>(std::ceil(static_cast<double>(num_points_local) / generation_ratio));
       }
+      // bound the work (and memory) per attempt; failing to meet kPointGenerationRatio is allowed
+      num_points_local = std::min(num_points_local, max_num_points_local);
     }
   }
 
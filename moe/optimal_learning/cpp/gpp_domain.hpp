@@ -18,6 +18,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <vector>
 
@@ -39,6 +40,17 @@ enum class DomainTypes {
   kSimplex = 1,
 };
 
+/*!\rst
+  How a domain's GenerateUniformPointsInDomain() spreads points (e.g., multistart initial guesses) over the domain.
+\endrst*/
+enum class StartPointSampling {
+  //! latin hypercube: exactly one point per row/column "slice" (ComputeLatinHypercubePointsInDomain)
+  kLatinHypercube = 0,
+  //! scrambled Sobol sequence (ComputeSobolPointsInDomain); lower discrepancy, so more even coverage for the same count.
+  //! Falls back to kLatinHypercube for ``dim > SobolNormalRNG::kMaxDimension``.
+  kSobol = 1,
+};
+
 /*!\rst
   A dummy domain; commonly paired with the NullOptimizer. Use when domain is irrelevant.
 
@@ -98,6 +110,16 @@ class TensorProductDomain {
   \endrst*/
   void SetDomain(ClosedInterval const * restrict domain) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    \param
+      :index: coordinate index, in ``[0, dim)``
+    \return
+      the bounds ``[x_index_{min}, x_index_{max}]`` of the ``index``-th coordinate
+  \endrst*/
+  const ClosedInterval& GetInterval(int index) const OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return domain_[index];
+  }
+
   /*!\rst
     Maximum number of planes that define the boundary of this domain.
     Used for testing.
@@ -169,6 +191,39 @@ class TensorProductDomain {
   int GenerateUniformPointsInDomain(int num_points, UniformRandomGenerator * uniform_generator,
                                     double * restrict random_points) const OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Generates points ``first_index, ..., first_index + num_points - 1`` of the scrambled Sobol sequence selected by
+    ``scramble_seed`` (see ComputeSobolPointsInDomain()).  Calls with the same seed and disjoint index ranges give
+    disjoint pieces of one low-discrepancy set, so e.g. each thread can generate its own block of start points.
+
+    \param
+      :num_points: number of points to generate
+      :first_index: index (in the sequence) of the first point
+      :scramble_seed: seed for the randomized scrambling
+      :random_points[dim][num_points]: properly sized array
+    \output
+      :random_points[dim][num_points]: point with coordinates inside the domain
+    \return
+      number of points generated (always num_points; ok to not use this result)
+  \endrst*/
+  int GenerateSobolPointsInDomain(int num_points, std::uint32_t first_index,
+                                  UniformRandomGenerator::EngineType::result_type scramble_seed,
+                                  double * restrict random_points) const OL_NONNULL_POINTERS;
+
+  StartPointSampling start_point_sampling() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return start_point_sampling_;
+  }
+
+  /*!\rst
+    Select how GenerateUniformPointsInDomain() spreads its points.  Defaults to StartPointSampling::kLatinHypercube.
+
+    \param
+      :start_point_sampling: the sampling scheme to use
+  \endrst*/
+  void SetStartPointSampling(StartPointSampling start_point_sampling) noexcept {
+    start_point_sampling_ = start_point_sampling;
+  }
+
   /*!\rst
     Changes update_vector so that:
 
@@ -196,6 +251,8 @@ class TensorProductDomain {
   int dim_;
   //! the list of ClosedInterval that define the boundaries of this tensor product domain
   std::vector<ClosedInterval> domain_;
+  //! how GenerateUniformPointsInDomain() spreads its points
+  StartPointSampling start_point_sampling_;
 };
 
 /*!\rst
@@ -210,7 +267,9 @@ class TensorProductDomain {
 
   (Implying that ``x_i <= 1 \forall i``)
 
-  ASSUMPTION: most of the volume of the tensor product region lies inside the simplex region.
+  Random points are drawn by rejection: uniformly from whichever of the (clipped) tensor product region and the simplex
+  has smaller volume, keeping those that also lie in the other.  That choice maximizes the acceptance rate, so point
+  generation stays cheap whether the box is mostly inside the simplex or the simplex is mostly inside the box.
 \endrst*/
 class SimplexIntersectTensorProductDomain {
   //! GenerateUniformPointsInDomain() is happy if ratio*requested_points number of points is generated
@@ -219,6 +278,8 @@ class SimplexIntersectTensorProductDomain {
   static constexpr double kValidPointRatioFloor = 0.2;
   //! 1/kValidPointRatioFloor; the most we'll increase the number of requested points on a retry
   static constexpr int kMaxPointRatioGrowth = 5;
+  //! in GenerateUniformPointsInDomain(), never draw more than this many candidates per requested point in one attempt
+  static constexpr int kMaxCandidatePointRatio = 1000;
   //! attempt to scale down the step-size (or distance to wall) by this factor when a domain-exiting (i.e., invalid) step is requested
   static constexpr double kInvalidStepScaleFactor = 0.5;
   //! small tweak to relative_change (to prevent max_relative_change == 1.0 exactly; see LimitUpdate comments)
@@ -284,7 +345,7 @@ class SimplexIntersectTensorProductDomain {
   /*!\rst
     Generates "point" such that CheckPointInside(point) returns true.
 
-    Uses rejection sampling so point generation may fail.
+    Uses rejection sampling (see class comments) so point generation may fail.
 
     \param
       :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
@@ -302,7 +363,8 @@ class SimplexIntersectTensorProductDomain {
     Generates AT MOST num_points points in the domain (i.e., such that CheckPointInside(point) returns true).  The points
     will be uniformly distributed.
 
-    Uses rejection sampling so we are not guaranteed to generate num_points samples.
+    Uses rejection sampling (see class comments) so we are not guaranteed to generate num_points samples.
+    When candidates come from the simplex, StartPointSampling does not apply: they are i.i.d. uniform.
 
     \param
       :num_points: number of random points to generate
@@ -317,6 +379,21 @@ class SimplexIntersectTensorProductDomain {
   int GenerateUniformPointsInDomain(int num_points, UniformRandomGenerator * uniform_generator,
                                     double * restrict random_points) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
 
+  StartPointSampling start_point_sampling() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return tensor_product_domain_.start_point_sampling();
+  }
+
+  /*!\rst
+    Select how the candidate points of GenerateUniformPointsInDomain() are spread when they are drawn from the tensor
+    product region (see class comments).  Defaults to StartPointSampling::kLatinHypercube.
+
+    \param
+      :start_point_sampling: the sampling scheme to use
+  \endrst*/
+  void SetStartPointSampling(StartPointSampling start_point_sampling) noexcept {
+    tensor_product_domain_.SetStartPointSampling(start_point_sampling);
+  }
+
   /*!\rst
     Changes update_vector so that:
 
@@ -346,6 +423,248 @@ class SimplexIntersectTensorProductDomain {
   TensorProductDomain tensor_product_domain_;
   //! the plane defining the simplex
   Plane simplex_plane_;
+  //! true if random points are drawn from the simplex and rejected against the tensor product region (instead of vice versa)
+  bool sample_simplex_first_;
+};
+
+/*!\rst
+  A trust region inside a TensorProductDomain: the box of side ``length * (x_j_{max} - x_j_{min})`` in each coordinate,
+  centered on ``center`` (e.g., the incumbent, the best point sampled so far) and clipped to the tensor product domain.
+
+  In high dimensions, multistart initial guesses spread over the whole domain mostly land where the acquisition function
+  is flat, and gradient descent spends its evaluations there.  Optimizing over a TrustRegionDomain instead concentrates
+  the start points, the latin hypercube search, and the optimizer paths around ``center``.  The DomainType interface
+  (CheckPointInside(), GeneratePointInDomain(), LimitUpdate(), ...) is that of the current box, so this class works
+  anywhere a TensorProductDomain does, including inside RepeatedDomain.
+
+  The box resizes with the outcome of each round of optimization (see UpdateLength()), as in TuRBO (Eriksson et al.
+  2019): ``success_tolerance`` consecutive improvements double ``length`` (up to kMaximumLength) and
+  ``failure_tolerance`` consecutive failures halve it.  Once ``length < kMinimumLength``, NeedsRestart() returns true
+  and the caller should Reset() the region (e.g., around a new center).
+
+  .. Note:: the box is fixed while an optimizer holds a const reference to this object; call SetCenter(),
+    UpdateLength(), and Reset() between optimizations.
+\endrst*/
+class TrustRegionDomain {
+ public:
+  //! initial (and post-Reset()) side length, relative to the tensor product domain's widths
+  static constexpr double kInitialLength = 0.8;
+  //! side lengths below this mean the region has collapsed onto ``center`` (see NeedsRestart())
+  static constexpr double kMinimumLength = 0.0078125;
+  //! UpdateLength() never grows the side length above this
+  static constexpr double kMaximumLength = 1.6;
+  //! from any center, a box of this side length covers the whole tensor product domain (e.g., for an inner domain)
+  static constexpr double kWholeDomainLength = 2.0;
+  //! default number of consecutive improvements that doubles the side length
+  static constexpr int kDefaultSuccessTolerance = 3;
+  //! default number of consecutive failures that halves the side length is ``max(kMinimumFailureTolerance, dim)``
+  static constexpr int kMinimumFailureTolerance = 4;
+
+  //! string name of this domain for logging
+  constexpr static char const * kName = "trust_region";
+
+  TrustRegionDomain() = delete;  // no default ctor; a trust region needs a domain and a center
+
+  /*!\rst
+    Constructs a TrustRegionDomain of side ``kInitialLength`` with the default tolerances.
+
+    \param
+      :domain: the tensor product domain to stay inside (copied)
+      :center[dim]: center of the trust region; clipped to ``domain``
+  \endrst*/
+  TrustRegionDomain(const TensorProductDomain& domain, double const * restrict center);
+
+  /*!\rst
+    Constructs a TrustRegionDomain.
+
+    \param
+      :domain: the tensor product domain to stay inside (copied)
+      :center[dim]: center of the trust region; clipped to ``domain``
+      :length: side length, relative to ``domain``'s widths, in ``(0, kWholeDomainLength]``
+      :success_tolerance: number of consecutive improvements that doubles ``length``, >= 1
+      :failure_tolerance: number of consecutive failures that halves ``length``, >= 1
+    \raise
+      BoundsException if ``length`` is outside ``(0, kWholeDomainLength]``;
+      LowerBoundException if ``success_tolerance < 1`` or ``failure_tolerance < 1``
+  \endrst*/
+  TrustRegionDomain(const TensorProductDomain& domain, double const * restrict center, double length,
+                    int success_tolerance, int failure_tolerance);
+
+  int dim() const OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return domain_.dim();
+  }
+
+  //! the current side length, relative to the tensor product domain's widths
+  double length() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return length_;
+  }
+
+  //! the center of the trust region, ``[dim]``
+  const std::vector<double>& center() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return center_;
+  }
+
+  //! the current box: the trust region clipped to the tensor product domain
+  const TensorProductDomain& local_domain() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return local_domain_;
+  }
+
+  /*!\rst
+    \return
+      true if the region has shrunk below ``kMinimumLength`` and should be Reset()
+  \endrst*/
+  bool NeedsRestart() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return length_ < kMinimumLength;
+  }
+
+  /*!\rst
+    Moves the trust region (e.g., to a new incumbent) without changing its size.
+
+    \param
+      :center[dim]: new center; clipped to the tensor product domain
+  \endrst*/
+  void SetCenter(double const * restrict center) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Records the outcome of one round of optimization over this region and resizes it: ``success_tolerance``
+    consecutive improvements double the side length (capped at kMaximumLength) and ``failure_tolerance``
+    consecutive failures halve it.  An improvement clears the failure count and vice versa; a resize clears both.
+
+    \param
+      :improved: true if the round improved on the incumbent
+  \endrst*/
+  void UpdateLength(bool improved);
+
+  /*!\rst
+    Restarts the trust region: side ``kInitialLength`` around ``center``, with no recorded successes or failures.
+
+    \param
+      :center[dim]: new center; clipped to the tensor product domain
+  \endrst*/
+  void Reset(double const * restrict center) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Maximum number of planes that define the boundary of this domain (those of the current box).
+
+    \return
+      max number of planes defining the boundary of this domain
+  \endrst*/
+  int GetMaxNumberOfBoundaryPlanes() const OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return local_domain_.GetMaxNumberOfBoundaryPlanes();
+  }
+
+  /*!\rst
+    Fills an input array with all bounding planes of the current box.
+
+    \param
+      :planes[max_num_bound]: properly allocated space: max_num_bound Plane objects in dim spatial dimensions
+    \output
+      :planes[max_num_bound]: array of planes of this domain
+  \endrst*/
+  void GetBoundaryPlanes(Plane * restrict planes) const OL_NONNULL_POINTERS {
+    local_domain_.GetBoundaryPlanes(planes);
+  }
+
+  /*!\rst
+    Check if a point is inside the current box/on its boundary or outside.
+
+    \param
+      :point[dim]: point to check
+    \return
+      true if point is inside the domain or on its boundary, false otherwise
+  \endrst*/
+  bool CheckPointInside(double const * restrict point) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return local_domain_.CheckPointInside(point);
+  }
+
+  /*!\rst
+    Generates "point" such that CheckPointInside(point) returns true.
+
+    \param
+      :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+      :random_point[dim]: properly sized array
+    \output
+      :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+      :random_point[dim]: point with coordinates inside the domain
+    \return
+      true if point generation succeeded
+  \endrst*/
+  bool GeneratePointInDomain(UniformRandomGenerator * uniform_generator,
+                             double * restrict random_point) const OL_NONNULL_POINTERS {
+    return local_domain_.GeneratePointInDomain(uniform_generator, random_point);
+  }
+
+  /*!\rst
+    Generates num_points points uniformly distributed in the current box; see
+    TensorProductDomain::GenerateUniformPointsInDomain().
+
+    \param
+      :num_points: number of random points to generate
+      :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+      :random_points[dim][num_points]: properly sized array
+    \output
+      :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+      :random_points[dim][num_points]: point with coordinates inside the domain
+    \return
+      number of points generated (always num_points; ok to not use this result)
+  \endrst*/
+  int GenerateUniformPointsInDomain(int num_points, UniformRandomGenerator * uniform_generator,
+                                    double * restrict random_points) const OL_NONNULL_POINTERS {
+    return local_domain_.GenerateUniformPointsInDomain(num_points, uniform_generator, random_points);
+  }
+
+  StartPointSampling start_point_sampling() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return local_domain_.start_point_sampling();
+  }
+
+  /*!\rst
+    Select how GenerateUniformPointsInDomain() spreads its points.  Defaults to that of the input domain.
+
+    \param
+      :start_point_sampling: the sampling scheme to use
+  \endrst*/
+  void SetStartPointSampling(StartPointSampling start_point_sampling) noexcept {
+    local_domain_.SetStartPointSampling(start_point_sampling);
+  }
+
+  /*!\rst
+    Changes update_vector so that ``point_new = point + update_vector`` stays inside the current box; see
+    TensorProductDomain::LimitUpdate().
+
+    \param
+      :max_relative_change: max change allowed per update (as a relative fraction of current distance to boundary)
+      :current_point[dim]: starting point
+      :update_vector[dim]: proposed update
+    \output
+      :update_vector[dim]: modified update so that the final point remains inside the domain
+  \endrst*/
+  void LimitUpdate(double max_relative_change, double const * restrict current_point,
+                   double * restrict update_vector) const OL_NONNULL_POINTERS {
+    local_domain_.LimitUpdate(max_relative_change, current_point, update_vector);
+  }
+
+ private:
+  /*!\rst
+    Recomputes local_domain_ from center_ and length_.
+  \endrst*/
+  void UpdateLocalDomain();
+
+  //! the tensor product domain the trust region stays inside
+  TensorProductDomain domain_;
+  //! the current box: the trust region clipped to domain_
+  TensorProductDomain local_domain_;
+  //! ``[dim]`` center of the trust region
+  std::vector<double> center_;
+  //! side length of the trust region, relative to domain_'s widths
+  double length_;
+  //! number of consecutive improvements that doubles length_
+  int success_tolerance_;
+  //! number of consecutive failures that halves length_
+  int failure_tolerance_;
+  //! number of consecutive improvements recorded since length_ last changed
+  int num_successes_;
+  //! number of consecutive failures recorded since length_ last changed
+  int num_failures_;
 };
 
 /*!\rst
@@ -452,20 +771,20 @@ class RepeatedDomain {
   \endrst*/
   bool GeneratePointInDomain(UniformRandomGenerator * uniform_generator, double * restrict random_point) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
     for (int i = 0; i < num_repeats_; ++i) {
-      if (unlikely(domain_->GeneratePointInDomain(uniform_generator, random_point) == false)) {
+      if (unlikely(domain_->GeneratePointInDomain(uniform_generator, random_point + i*dim()) == false)) {
         return false;
       }
-      random_point += dim();
     }
 
-    // order the first dim
-    std::vector<double> temp(num_repeats_);
+    // order the repeats by their first coordinate; whole points move so each stays inside domain_
+    std::vector<double> temp(random_point, random_point + num_repeats_*dim());
+    std::vector<int> order(num_repeats_);
     for (int i = 0; i < num_repeats_; ++i) {
-      temp[i] = random_point[i*dim()];
+      order[i] = i;
     }
-    std::sort(temp.begin(), temp.end());
+    std::sort(order.begin(), order.end(), [&temp, this](int a, int b) { return temp[a*dim()] < temp[b*dim()]; });
     for (int i = 0; i < num_repeats_; ++i) {
-      random_point[i*dim()] = temp[i];
+      std::copy(temp.begin() + order[i]*dim(), temp.begin() + (order[i] + 1)*dim(), random_point + i*dim());
     }
 
     return true;
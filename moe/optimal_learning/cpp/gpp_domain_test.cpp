@@ -44,6 +44,8 @@
 
 #include "gpp_domain_test.hpp"
 
+#include <cmath>
+
 #include <algorithm>
 #include <limits>
 #include <vector>
@@ -52,6 +54,7 @@
 
 #include "gpp_common.hpp"
 #include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
 #include "gpp_geometry.hpp"
 #include "gpp_linear_algebra.hpp"
 #include "gpp_logging.hpp"
@@ -976,6 +979,284 @@ OL_WARN_UNUSED_RESULT int InvalidRepeatedDomainTests() {
   return num_errors;
 }
 
+/*!\rst
+  Check StartPointSampling::kSobol point generation:
+
+  * every 1D projection of the first ``2^m`` points is stratified: each cell ``[k/2^m, (k+1)/2^m)`` of each edge holds one point
+  * GenerateSobolPointsInDomain() with an offset reproduces the matching block of a longer sequence (skip-ahead)
+  * GenerateUniformPointsInDomain() honors the option for both domain types, and falls back to a latin hypercube above
+    ``SobolNormalRNG::kMaxDimension``
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SobolPointsInDomainTest() {
+  int total_errors = 0;
+  const int dim = 5;
+  const int log_num_points = 8;
+  const int num_points = 1 << log_num_points;
+  const UniformRandomGenerator::EngineType::result_type scramble_seed = 2718;
+  std::vector<ClosedInterval> domain_bounds = {{-1.0, 1.0}, {0.1, 0.2}, {3.0, 7.5}, {-5.0, -4.0}, {0.0, 1.0}};
+  TensorProductDomain domain(domain_bounds.data(), dim);
+
+  std::vector<double> points(num_points*dim);
+  domain.GenerateSobolPointsInDomain(num_points, 0, scramble_seed, points.data());
+  std::vector<int> counts(num_points);
+  for (int j = 0; j < dim; ++j) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int i = 0; i < num_points; ++i) {
+      double relative = (points[i*dim + j] - domain_bounds[j].min) / domain_bounds[j].Length();
+      ++counts[std::min(num_points - 1, static_cast<int>(relative * num_points))];
+    }
+    if (std::any_of(counts.begin(), counts.end(), [](int count) { return count != 1; })) {
+      OL_ERROR_PRINTF("coordinate %d of the Sobol points is not stratified\n", j);
+      ++total_errors;
+    }
+  }
+
+  const int block_size = 64;
+  std::vector<double> block(block_size*dim);
+  for (int first_index : {block_size, 3*block_size + 5}) {
+    domain.GenerateSobolPointsInDomain(block_size, first_index, scramble_seed, block.data());
+    int num_points_compared = std::min(block_size, num_points - first_index);
+    if (!std::equal(block.begin(), block.begin() + num_points_compared*dim, points.begin() + first_index*dim)) {
+      OL_ERROR_PRINTF("block at %d differs from the full sequence\n", first_index);
+      ++total_errors;
+    }
+  }
+
+  UniformRandomGenerator uniform_generator(3143);
+  domain.SetStartPointSampling(StartPointSampling::kSobol);
+  if (domain.GenerateUniformPointsInDomain(num_points, &uniform_generator, points.data()) != num_points) {
+    ++total_errors;
+  }
+  for (int i = 0; i < num_points; ++i) {
+    if (!domain.CheckPointInside(points.data() + i*dim)) {
+      ++total_errors;
+    }
+  }
+
+  std::vector<ClosedInterval> simplex_bounds = {{0.0, 0.5}, {0.0, 0.3}, {0.1, 0.4}, {0.0, 0.2}, {0.0, 0.6}};
+  SimplexIntersectTensorProductDomain simplex_domain(simplex_bounds.data(), dim);
+  simplex_domain.SetStartPointSampling(StartPointSampling::kSobol);
+  int num_simplex_points = simplex_domain.GenerateUniformPointsInDomain(num_points, &uniform_generator, points.data());
+  if (num_simplex_points == 0) {
+    ++total_errors;
+  }
+  for (int i = 0; i < num_simplex_points; ++i) {
+    if (!simplex_domain.CheckPointInside(points.data() + i*dim)) {
+      ++total_errors;
+    }
+  }
+
+  const int large_dim = SobolNormalRNG::kMaxDimension + 4;
+  std::vector<ClosedInterval> large_bounds(large_dim, {-2.0, 3.0});
+  TensorProductDomain large_domain(large_bounds.data(), large_dim);
+  large_domain.SetStartPointSampling(StartPointSampling::kSobol);
+  std::vector<double> large_points(num_points*large_dim);
+  if (large_domain.GenerateUniformPointsInDomain(num_points, &uniform_generator, large_points.data()) != num_points) {
+    ++total_errors;
+  }
+  for (int i = 0; i < num_points; ++i) {
+    if (!large_domain.CheckPointInside(large_points.data() + i*large_dim)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Check SimplexIntersectTensorProductDomain point generation when the simplex is a tiny fraction of the tensor product
+  region (in 12D, the unit simplex fills ``1/12! ~ 2e-9`` of the unit cube, so rejection from the box cannot succeed):
+  both GeneratePointInDomain() and GenerateUniformPointsInDomain() must still produce valid points.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SimplexSmallFractionOfBoxTest() {
+  int total_errors = 0;
+  const int dim = 12;
+  const int num_points = 200;
+  UniformRandomGenerator uniform_generator(3143);
+  std::vector<double> points(num_points*dim);
+
+  for (double upper_bound : {1.0, 0.3}) {
+    std::vector<ClosedInterval> domain_bounds(dim, {0.0, upper_bound});
+    SimplexIntersectTensorProductDomain domain(domain_bounds.data(), dim);
+
+    if (!domain.GeneratePointInDomain(&uniform_generator, points.data()) || !domain.CheckPointInside(points.data())) {
+      ++total_errors;
+    }
+
+    int num_generated = domain.GenerateUniformPointsInDomain(num_points, &uniform_generator, points.data());
+    if (num_generated < 0.9*num_points) {
+      OL_ERROR_PRINTF("box [0, %.2f]^%d: generated %d of %d points\n", upper_bound, dim, num_generated, num_points);
+      ++total_errors;
+    }
+    for (int i = 0; i < num_generated; ++i) {
+      if (!domain.CheckPointInside(points.data() + i*dim)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Check TrustRegionDomain:
+
+  * the box is centered on the (clipped) center, clipped to the tensor product domain, and at most ``length`` wide
+  * generated points (alone and through RepeatedDomain) and limited updates stay inside the box
+  * UpdateLength() doubles the length after ``success_tolerance`` consecutive successes (up to kMaximumLength), halves
+    it after ``failure_tolerance`` consecutive failures, and an interrupted streak changes nothing; NeedsRestart()
+    and Reset()
+  * invalid lengths and tolerances are rejected
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int TrustRegionDomainTest() {
+  int total_errors = 0;
+  const int dim = 5;
+  const int num_points = 40;
+  const int num_repeats = 3;
+  std::vector<ClosedInterval> domain_bounds = {{-1.0, 1.0}, {0.1, 0.2}, {3.0, 7.5}, {-5.0, -4.0}, {0.0, 1.0}};
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  // near a corner in the first coordinates, outside the domain in the last
+  const std::vector<double> center = {-0.9, 0.11, 5.0, -4.5, 1.5};
+  UniformRandomGenerator uniform_generator(2314);
+
+  TrustRegionDomain trust_region(domain, center.data());
+  const auto check_box = [&]() {
+    int num_errors = 0;
+    for (int j = 0; j < dim; ++j) {
+      const ClosedInterval& box = trust_region.local_domain().GetInterval(j);
+      const double center_j = std::fmin(std::fmax(center[j], domain_bounds[j].min), domain_bounds[j].max);
+      const double half_width = 0.5*trust_region.length()*domain_bounds[j].Length();
+      if (trust_region.center()[j] != center_j || !box.IsInside(center_j) ||
+          !CheckDoubleWithin(box.min, std::fmax(center_j - half_width, domain_bounds[j].min), 1.0e-14) ||
+          !CheckDoubleWithin(box.max, std::fmin(center_j + half_width, domain_bounds[j].max), 1.0e-14)) {
+        OL_ERROR_PRINTF("length %.4f, coordinate %d: box [%.6f, %.6f]\n", trust_region.length(), j, box.min, box.max);
+        ++num_errors;
+      }
+    }
+    return num_errors;
+  };
+  total_errors += check_box();
+
+  std::vector<double> points(num_repeats*num_points*dim);
+  trust_region.GenerateUniformPointsInDomain(num_points, &uniform_generator, points.data());
+  for (int i = 0; i < num_points; ++i) {
+    if (!trust_region.CheckPointInside(points.data() + i*dim) || !domain.CheckPointInside(points.data() + i*dim)) {
+      ++total_errors;
+    }
+  }
+  std::vector<double> update(dim);
+  for (int i = 0; i < num_points; ++i) {
+    double * point = points.data() + i*dim;
+    for (int j = 0; j < dim; ++j) {
+      update[j] = (j % 2 == 0 ? 3.0 : -3.0)*domain_bounds[j].Length();
+    }
+    trust_region.LimitUpdate(1.0, point, update.data());
+    for (int j = 0; j < dim; ++j) {
+      point[j] += update[j];
+    }
+    if (!trust_region.CheckPointInside(point)) {
+      ++total_errors;
+    }
+  }
+
+  RepeatedDomain<TrustRegionDomain> repeated_domain(trust_region, num_repeats);
+  int num_generated = repeated_domain.GenerateUniformPointsInDomain(num_points, &uniform_generator, points.data());
+  if (!repeated_domain.GeneratePointInDomain(&uniform_generator, points.data() + (num_points - 1)*num_repeats*dim)) {
+    ++total_errors;
+  }
+  for (int i = 0; i < num_generated; ++i) {
+    if (!repeated_domain.CheckPointInside(points.data() + i*num_repeats*dim)) {
+      ++total_errors;
+    }
+  }
+
+  // the default failure_tolerance is max(4, dim) = dim
+  const int success_tolerance = TrustRegionDomain::kDefaultSuccessTolerance;
+  const double initial_length = TrustRegionDomain::kInitialLength;
+  const std::vector<bool> outcomes = {
+    true, true, false,               // interrupted: no change
+    true, true, true,                // 3 successes: 0.8 -> 1.6
+    true, true, true,                // capped at 1.6
+    false, false, false, false, true,  // interrupted: no change
+    false, false, false, false, false};  // dim failures: 1.6 -> 0.8
+  const std::vector<double> lengths = {
+    initial_length, initial_length, initial_length,
+    initial_length, initial_length, 2.0*initial_length,
+    2.0*initial_length, 2.0*initial_length, 2.0*initial_length,
+    2.0*initial_length, 2.0*initial_length, 2.0*initial_length, 2.0*initial_length, 2.0*initial_length,
+    2.0*initial_length, 2.0*initial_length, 2.0*initial_length, 2.0*initial_length, initial_length};
+  for (int i = 0; i < static_cast<int>(outcomes.size()); ++i) {
+    trust_region.UpdateLength(outcomes[i]);
+    if (trust_region.length() != lengths[i]) {
+      OL_ERROR_PRINTF("update %d: length %.4f, expected %.4f\n", i, trust_region.length(), lengths[i]);
+      ++total_errors;
+    }
+  }
+  total_errors += check_box();
+
+  int num_halvings = 0;
+  while (!trust_region.NeedsRestart()) {
+    for (int i = 0; i < dim; ++i) {
+      trust_region.UpdateLength(false);
+    }
+    ++num_halvings;
+  }
+  // 0.8 * 2^-7 = 0.00625 < 2^-7
+  if (num_halvings != 7) {
+    OL_ERROR_PRINTF("collapsed after %d halvings\n", num_halvings);
+    ++total_errors;
+  }
+  total_errors += check_box();
+  trust_region.Reset(center.data());
+  if (trust_region.length() != initial_length || trust_region.NeedsRestart()) {
+    ++total_errors;
+  }
+  total_errors += check_box();
+
+  // a whole-domain region (e.g., an inner domain) keeps its length on success
+  TrustRegionDomain whole_domain(domain, center.data(), TrustRegionDomain::kWholeDomainLength, 1, 1);
+  whole_domain.UpdateLength(true);
+  for (int j = 0; j < dim; ++j) {
+    if (whole_domain.length() != TrustRegionDomain::kWholeDomainLength ||
+        whole_domain.local_domain().GetInterval(j).min != domain_bounds[j].min ||
+        whole_domain.local_domain().GetInterval(j).max != domain_bounds[j].max) {
+      ++total_errors;
+    }
+  }
+
+  const std::vector<double> invalid_lengths = {0.0, -0.5, 2.5};
+  for (double length : invalid_lengths) {
+    try {
+      TrustRegionDomain invalid(domain, center.data(), length, success_tolerance, dim);
+      ++total_errors;
+    } catch (const BoundsException<double>& exception) {
+    }
+  }
+  for (int tolerance : {0, -1}) {
+    try {
+      TrustRegionDomain invalid(domain, center.data(), initial_length, tolerance, dim);
+      ++total_errors;
+    } catch (const LowerBoundException<int>& exception) {
+    }
+    try {
+      TrustRegionDomain invalid(domain, center.data(), initial_length, success_tolerance, tolerance);
+      ++total_errors;
+    } catch (const LowerBoundException<int>& exception) {
+    }
+  }
+
+  return total_errors;
+}
+
 /*!\rst
   Wrapper around test functions for the RepeatedDomain class.
 
@@ -1040,6 +1321,24 @@ int DomainTests() {
   }
   total_errors += current_errors;
 
+  current_errors = SobolPointsInDomainTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("Sobol start point generation failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = SimplexSmallFractionOfBoxTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("SimplexIntersectTensorProductDomain sampling a small simplex failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = TrustRegionDomainTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("TrustRegionDomain failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
   // run RepeatedDomain tests
   total_errors += RepeatedDomainTests();
 
@@ -107,4 +107,14 @@ SingularMatrixException::SingularMatrixException(char const * line_info, char co
   AppendCustomMessageAndDebugInfo(line_info, func_info, custom_message);
 }
 
+OptimalLearningCudaException::OptimalLearningCudaException(char const * line_info, char const * func_info,
+                                                           char const * custom_message, int cuda_error_code_in,
+                                                           char const * cuda_error_string, char const * cuda_line_info,
+                                                           char const * cuda_func_info)
+    : OptimalLearningException(kName), cuda_error_code_(cuda_error_code_in) {
+  message_ += ": CUDA error " + std::to_string(cuda_error_code_) + " (" + cuda_error_string + ") at " +
+      cuda_line_info + " in " + cuda_func_info + ".\n";
+  AppendCustomMessageAndDebugInfo(line_info, func_info, custom_message);
+}
+
 }  // end namespace optimal_learning
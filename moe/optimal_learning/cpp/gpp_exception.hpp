@@ -504,6 +504,53 @@ class SingularMatrixException : public OptimalLearningException {
   std::vector<double> matrix_;
 };
 
+/*!\rst
+  **Overview**
+
+  Exception to capture a failed call into the CUDA layer (``gpu/gpp_cuda_math.hpp``), e.g., no device, out of device
+  memory, or a kernel launch failure. Stores the ``cudaError_t`` (as int) reported by the CUDA runtime.
+
+  **Message Format**
+
+  The ``what()`` message is formatted in the class ctor (capitals indicate variable information)::
+
+    R"%%(
+    OptimalLearningCudaException: CUDA error ERROR_CODE (CUDA_ERROR_STRING) at CUDA_FILE_LINE_INFO in CUDA_FUNCTION.
+    CUSTOM_MESSAGE FUNCTION_NAME FILE_LINE_INFO
+    )%%"
+\endrst*/
+class OptimalLearningCudaException : public OptimalLearningException {
+ public:
+  //! String name of this exception for logging.
+  constexpr static char const * kName = "OptimalLearningCudaException";
+
+  /*!\rst
+    Constructs an OptimalLearningCudaException object with extra fields to flesh out the what() message.
+
+    \param
+      :line_info[]: ptr to char array containing __FILE__ and __LINE__ info; e.g., from OL_STRINGIFY_FILE_AND_LINE
+      :func_info[]: optional ptr to char array from OL_CURRENT_FUNCTION_NAME or similar
+      :custom_message[]: optional ptr to char array with any additional text/info to print/log
+      :cuda_error_code: the cudaError_t of the failed call
+      :cuda_error_string[]: description of ``cuda_error_code`` (cudaGetErrorString())
+      :cuda_line_info[]: file and line of the failed CUDA call
+      :cuda_func_info[]: name of the function making the failed CUDA call
+  \endrst*/
+  OptimalLearningCudaException(char const * line_info, char const * func_info, char const * custom_message,
+                               int cuda_error_code_in, char const * cuda_error_string, char const * cuda_line_info,
+                               char const * cuda_func_info);
+
+  int cuda_error_code() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return cuda_error_code_;
+  }
+
+  OL_DISALLOW_DEFAULT_AND_ASSIGN(OptimalLearningCudaException);
+
+ private:
+  //! the cudaError_t of the failed call
+  int cuda_error_code_;
+};
+
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_EXCEPTION_HPP_
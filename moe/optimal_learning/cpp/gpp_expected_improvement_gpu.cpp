@@ -0,0 +1,254 @@
+/*!
+  \file gpp_expected_improvement_gpu.cpp
+  \rst
+  Host side of the GPU q,p-EI evaluator; see gpp_expected_improvement_gpu.hpp. Everything that touches the device is
+  under ``#ifdef OL_GPU_ENABLED``; without it, the entry points throw.
+\endrst*/
+
+#include "gpp_expected_improvement_gpu.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+#ifdef OL_GPU_ENABLED
+/*!\rst
+  Draws a 64-bit device seed from ``uniform_rng`` (its engine produces 32 bits per call).
+\endrst*/
+uint64_t DrawDeviceSeed(UniformRandomGenerator * uniform_rng) {
+  const uint64_t high = uniform_rng->engine();
+  const uint64_t low = uniform_rng->engine();
+  return (high << 32) | low;
+}
+
+/*!\rst
+  Computes the GP mean & the Cholesky factor of the GP variance (with the same ``1.0e-6`` jitter as
+  ExpectedImprovementEvaluator) at ``ei_state->union_of_points``.
+\endrst*/
+void ComputeMeanAndCholeskyVariance(const GaussianProcess& gaussian_process, CudaExpectedImprovementState * ei_state) {
+  const int num_union = ei_state->num_union;
+  gaussian_process.ComputeMeanOfPoints(ei_state->points_to_sample_state, ei_state->to_sample_mean.data());
+  gaussian_process.ComputeVarianceOfPoints(&(ei_state->points_to_sample_state),
+                                           ei_state->points_to_sample_state.gradients.data(),
+                                           ei_state->points_to_sample_state.num_gradients_to_sample,
+                                           ei_state->cholesky_to_sample_var.data());
+
+  // Adding the variance of measurement noise to the covariance matrix
+  for (int i = 0; i < num_union; ++i) {
+    ei_state->cholesky_to_sample_var[i + i*num_union] += 1.0e-6;
+  }
+
+  int leading_minor_index = ComputeCholeskyFactorL(num_union, ei_state->cholesky_to_sample_var.data());
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample/being_sampled or points_to_sample/being_sampled duplicating points_sampled with 0 noise.", ei_state->cholesky_to_sample_var.data(), num_union, leading_minor_index);
+  }
+}
+#endif
+
+}  // end unnamed namespace
+
+#ifdef OL_GPU_ENABLED
+
+void CudaSelectDevice(int which_gpu) {
+  int num_devices = 0;
+  OL_CUDA_ERROR_THROW(CudaGetDeviceCount(&num_devices));
+  if (unlikely(which_gpu < 0 || which_gpu >= num_devices)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "Invalid GPU device ID.", which_gpu, 0, num_devices - 1);
+  }
+  OL_CUDA_ERROR_THROW(CudaSetDevice(which_gpu));
+}
+
+template <typename ValueType>
+CudaDevicePointer<ValueType>::CudaDevicePointer(int num_elements) : ptr_(nullptr), num_elements_(0) {
+  Reserve(num_elements);
+}
+
+template <typename ValueType>
+CudaDevicePointer<ValueType>::~CudaDevicePointer() {
+  // never throw from a destructor; a failed free would only leak device memory
+  CudaFreeDeviceMemory(ptr_);
+}
+
+template <typename ValueType>
+void CudaDevicePointer<ValueType>::Reserve(int num_elements) {
+  if (num_elements <= num_elements_) {
+    return;
+  }
+  OL_CUDA_ERROR_THROW(CudaFreeDeviceMemory(ptr_));
+  ptr_ = nullptr;
+  num_elements_ = 0;
+  void * new_ptr = nullptr;
+  OL_CUDA_ERROR_THROW(CudaMallocDeviceMemory(num_elements*sizeof(ValueType), &new_ptr));
+  ptr_ = static_cast<ValueType *>(new_ptr);
+  num_elements_ = num_elements;
+}
+
+#else
+
+void CudaSelectDevice(int OL_UNUSED(which_gpu)) {
+  OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+}
+
+template <typename ValueType>
+CudaDevicePointer<ValueType>::CudaDevicePointer(int num_elements) : ptr_(nullptr), num_elements_(0) {
+  Reserve(num_elements);
+}
+
+template <typename ValueType>
+CudaDevicePointer<ValueType>::~CudaDevicePointer() = default;
+
+template <typename ValueType>
+void CudaDevicePointer<ValueType>::Reserve(int num_elements) {
+  if (num_elements > num_elements_) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+  }
+}
+
+#endif
+
+template <typename ValueType>
+CudaDevicePointer<ValueType>::CudaDevicePointer(CudaDevicePointer&& other) noexcept
+    : ptr_(other.ptr_), num_elements_(other.num_elements_) {
+  other.ptr_ = nullptr;
+  other.num_elements_ = 0;
+}
+
+template class CudaDevicePointer<double>;
+template class CudaDevicePointer<int>;
+
+CudaExpectedImprovementEvaluator::CudaExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in,
+                                                                   int num_mc_iterations, double best_so_far,
+                                                                   int which_gpu)
+    : dim_(gaussian_process_in.dim()),
+      num_mc_iterations_(num_mc_iterations),
+      best_so_far_(best_so_far),
+      which_gpu_(which_gpu),
+      gaussian_process_(&gaussian_process_in) {
+  CudaSelectDevice(which_gpu_);
+}
+
+CudaExpectedImprovementEvaluator::CudaExpectedImprovementEvaluator(CudaExpectedImprovementEvaluator&& other)
+    : dim_(other.dim_),
+      num_mc_iterations_(other.num_mc_iterations_),
+      best_so_far_(other.best_so_far_),
+      which_gpu_(other.which_gpu_),
+      gaussian_process_(other.gaussian_process_) {
+}
+
+#ifdef OL_GPU_ENABLED
+
+double CudaExpectedImprovementEvaluator::ComputeExpectedImprovement(StateType * ei_state) const {
+  ComputeMeanAndCholeskyVariance(*gaussian_process_, ei_state);
+
+  double EI_val = 0.0;
+  OL_CUDA_ERROR_THROW(CudaGetEI(ei_state->to_sample_mean.data(), ei_state->cholesky_to_sample_var.data(),
+                                ei_state->num_union, num_mc_iterations_, DrawDeviceSeed(ei_state->uniform_rng),
+                                best_so_far_, ei_state->configure_for_test, ei_state->gpu_mu.ptr(),
+                                ei_state->gpu_chol_var.ptr(), ei_state->random_number_ei.data(),
+                                ei_state->gpu_random_number_ei.ptr(), ei_state->gpu_ei_storage.ptr(), &EI_val));
+  return EI_val;
+}
+
+void CudaExpectedImprovementEvaluator::ComputeGradExpectedImprovement(StateType * ei_state,
+                                                                      double * restrict grad_EI) const {
+  ComputeMeanAndCholeskyVariance(*gaussian_process_, ei_state);
+  gaussian_process_->ComputeGradMeanOfPoints(ei_state->points_to_sample_state, ei_state->grad_mu.data());
+  gaussian_process_->ComputeGradCholeskyVarianceOfPoints(&(ei_state->points_to_sample_state),
+                                                         ei_state->cholesky_to_sample_var.data(),
+                                                         ei_state->grad_chol_decomp.data());
+
+  OL_CUDA_ERROR_THROW(CudaGetGradEI(ei_state->to_sample_mean.data(), ei_state->grad_mu.data(),
+                                    ei_state->cholesky_to_sample_var.data(), ei_state->grad_chol_decomp.data(),
+                                    ei_state->num_union, ei_state->num_to_sample, dim_, num_mc_iterations_,
+                                    DrawDeviceSeed(ei_state->uniform_rng), best_so_far_,
+                                    ei_state->configure_for_test, ei_state->gpu_mu.ptr(),
+                                    ei_state->gpu_grad_mu.ptr(), ei_state->gpu_chol_var.ptr(),
+                                    ei_state->gpu_grad_chol_var.ptr(), ei_state->random_number_grad_ei.data(),
+                                    ei_state->gpu_random_number_grad_ei.ptr(),
+                                    ei_state->gpu_grad_ei_storage.ptr(), grad_EI));
+}
+
+#else
+
+double CudaExpectedImprovementEvaluator::ComputeExpectedImprovement(StateType * OL_UNUSED(ei_state)) const {
+  OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+}
+
+void CudaExpectedImprovementEvaluator::ComputeGradExpectedImprovement(StateType * OL_UNUSED(ei_state),
+                                                                      double * restrict OL_UNUSED(grad_EI)) const {
+  OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+}
+
+#endif
+
+CudaExpectedImprovementState::CudaExpectedImprovementState(const EvaluatorType& ei_evaluator,
+                                                           double const * restrict points_to_sample,
+                                                           double const * restrict points_being_sampled,
+                                                           int num_to_sample_in, int num_being_sampled_in,
+                                                           bool configure_for_gradients,
+                                                           UniformRandomGenerator * uniform_rng_in,
+                                                           bool configure_for_test_in)
+    : dim(ei_evaluator.dim()),
+      num_to_sample(num_to_sample_in),
+      num_being_sampled(num_being_sampled_in),
+      num_derivatives(configure_for_gradients ? num_to_sample : 0),
+      num_union(num_to_sample + num_being_sampled),
+      union_of_points(ExpectedImprovementState::BuildUnionOfPoints(points_to_sample, points_being_sampled,
+                                                                   num_to_sample, num_being_sampled, dim)),
+      points_to_sample_state(*ei_evaluator.gaussian_process(), union_of_points.data(), num_union,
+                             nullptr, 0, num_derivatives, configure_for_gradients),
+      uniform_rng(uniform_rng_in),
+      configure_for_test(configure_for_test_in),
+      to_sample_mean(num_union),
+      grad_mu(dim*num_derivatives),
+      cholesky_to_sample_var(Square(num_union)),
+      grad_chol_decomp(dim*Square(num_union)*num_derivatives),
+      random_number_ei(configure_for_test ? num_union*ei_evaluator.num_mc_iterations() : 0),
+      random_number_grad_ei(configure_for_test && configure_for_gradients ?
+                            num_union*ei_evaluator.num_mc_iterations() : 0),
+      gpu_mu(num_union),
+      gpu_chol_var(Square(num_union)),
+      gpu_grad_mu(dim*num_derivatives),
+      gpu_grad_chol_var(dim*Square(num_union)*num_derivatives),
+      gpu_ei_storage(kCudaEINumThreads),
+      gpu_grad_ei_storage(configure_for_gradients ? dim*num_derivatives*kCudaEINumThreads : 0),
+      gpu_random_number_ei(random_number_ei.size()),
+      gpu_random_number_grad_ei(random_number_grad_ei.size()) {
+}
+
+CudaExpectedImprovementState::CudaExpectedImprovementState(CudaExpectedImprovementState&& OL_UNUSED(other)) = default;
+
+void CudaExpectedImprovementState::SetCurrentPoint(const EvaluatorType& ei_evaluator,
+                                                   double const * restrict points_to_sample) {
+  // update points_to_sample in union_of_points
+  std::copy(points_to_sample, points_to_sample + num_to_sample*dim, union_of_points.data());
+
+  // evaluate derived quantities for the GP
+  points_to_sample_state.PrepareState(*ei_evaluator.gaussian_process(), union_of_points.data(),
+                                      num_union, 0, num_derivatives, (num_derivatives>0));
+  ei_evaluator.gaussian_process()->FillPointsToSampleState(&points_to_sample_state);
+}
+
+void CudaExpectedImprovementState::SetupState(const EvaluatorType& ei_evaluator,
+                                              double const * restrict points_to_sample) {
+  if (unlikely(dim != ei_evaluator.dim())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, ei_evaluator.dim());
+  }
+
+  SetCurrentPoint(ei_evaluator, points_to_sample);
+}
+
+}  // end namespace optimal_learning
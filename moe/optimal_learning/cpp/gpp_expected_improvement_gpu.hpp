@@ -0,0 +1,476 @@
+/*!
+  \file gpp_expected_improvement_gpu.hpp
+  \rst
+  GPU (CUDA) versions of the q,p-EI evaluator and state, and their optimization entry points; see gpp_math.hpp for the
+  CPU versions and for the description of EI.
+
+  CudaExpectedImprovementEvaluator has the same interface as ExpectedImprovementEvaluator (so the optimizers in
+  gpp_optimization.hpp accept it). The GP quantities (mean, variance, their gradients, and the cholesky factor) are
+  computed on the host exactly as in ExpectedImprovementEvaluator; the monte-carlo loop (drawing normals, forming
+  ``\mu + L * normals``, and accumulating the improvement and its gradient) runs on the device, with each device
+  thread handling a strided subset of the iterations. See ``gpu/gpp_cuda_math.hpp`` for the kernels.
+
+  Unlike ExpectedImprovementState, CudaExpectedImprovementState draws a fresh device seed from its
+  UniformRandomGenerator on every evaluation, so repeated evaluations at the same point differ by MC noise. With
+  ``configure_for_test``, the normals used are copied back to the host (``random_number_ei``, ``random_number_grad_ei``)
+  so tests can replay them through the CPU evaluator.
+
+  This file is always compiled. Without the compiler option ``OL_GPU_ENABLED`` (cmake ``-D MOE_USE_GPU=1``), asking for
+  a GPU (constructing a GPU evaluator, or a KG evaluator with ``which_gpu >= 0``) throws OptimalLearningException.
+
+  .. NOTE:: one device serves one host thread at a time here, so the optimizers below always run single-threaded
+    (the ``thread_schedule`` only supplies the schedule type).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_HPP_
+
+#include <cstdint>
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpu/gpp_cuda_math.hpp"
+
+/*!\rst
+  Evaluates ``X`` (a call returning CudaError); on failure, throws OptimalLearningCudaException.
+  Only usable inside namespace optimal_learning (like OL_THROW_EXCEPTION).
+\endrst*/
+#define OL_CUDA_ERROR_THROW(X) do {                                     \
+    CudaError _ol_cuda_error = (X);                                     \
+    if (unlikely(_ol_cuda_error.err != 0)) {                            \
+      OL_THROW_EXCEPTION(OptimalLearningCudaException, "CUDA call failed.", _ol_cuda_error.err, \
+                         CudaGetErrorString(_ol_cuda_error.err), _ol_cuda_error.file_and_line_info, \
+                         _ol_cuda_error.func_info);                     \
+    }                                                                   \
+  } while (0)
+
+namespace optimal_learning {
+
+//! ``which_gpu`` value that keeps a computation on the CPU
+constexpr int kNoGpu = -1;
+
+/*!\rst
+  Makes device ``which_gpu`` current for the calling host thread.
+
+  \param
+    :which_gpu: device ID, ``>= 0``
+  \raise
+    OptimalLearningException if built without ``OL_GPU_ENABLED``; OptimalLearningCudaException if the device cannot be
+    selected
+\endrst*/
+void CudaSelectDevice(int which_gpu);
+
+/*!\rst
+  RAII owner of an array of ``ValueType`` in device memory. Only ``double`` and ``int`` are instantiated.
+\endrst*/
+template <typename ValueType>
+class CudaDevicePointer final {
+ public:
+  /*!\rst
+    Allocates ``num_elements`` values on the current device; ``num_elements == 0`` allocates nothing.
+
+    \raise
+      OptimalLearningException if ``num_elements > 0`` and built without ``OL_GPU_ENABLED``;
+      OptimalLearningCudaException if the allocation fails
+  \endrst*/
+  explicit CudaDevicePointer(int num_elements);
+
+  CudaDevicePointer(CudaDevicePointer&& other) noexcept;
+
+  ~CudaDevicePointer();
+
+  /*!\rst
+    Ensures the buffer holds at least ``num_elements`` values; contents are not preserved when it grows.
+  \endrst*/
+  void Reserve(int num_elements);
+
+  ValueType * ptr() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return ptr_;
+  }
+
+  int num_elements() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_elements_;
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(CudaDevicePointer);
+
+ private:
+  //! device memory; nullptr if nothing is allocated
+  ValueType * ptr_;
+  //! number of values allocated
+  int num_elements_;
+};
+
+extern template class CudaDevicePointer<double>;
+extern template class CudaDevicePointer<int>;
+
+struct CudaExpectedImprovementState;
+
+/*!\rst
+  GPU counterpart of ExpectedImprovementEvaluator (q,p-EI by monte-carlo); see the file comments.
+\endrst*/
+class CudaExpectedImprovementEvaluator final {
+ public:
+  using StateType = CudaExpectedImprovementState;
+
+  /*!\rst
+    Constructs a CudaExpectedImprovementEvaluator object and selects the device.
+
+    \param
+      :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+        that describes the underlying GP
+      :num_mc_iterations: number of monte carlo iterations
+      :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :which_gpu: device ID, ``>= 0``
+    \raise
+      see CudaSelectDevice()
+  \endrst*/
+  CudaExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in, int num_mc_iterations,
+                                   double best_so_far, int which_gpu);
+
+  CudaExpectedImprovementEvaluator(CudaExpectedImprovementEvaluator&& other);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_mc_iterations() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_mc_iterations_;
+  }
+
+  double best_so_far() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return best_so_far_;
+  }
+
+  int which_gpu() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return which_gpu_;
+  }
+
+  const GaussianProcess * gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return gaussian_process_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeExpectedImprovement(); see that function for details.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * ei_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return ComputeExpectedImprovement(ei_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradExpectedImprovement(); see that function for details.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS {
+    ComputeGradExpectedImprovement(ei_state, grad_EI);
+  }
+
+  /*!\rst
+    Computes q,p-EI; see ExpectedImprovementEvaluator::ComputeExpectedImprovement().
+
+    \param
+      :ei_state[1]: properly configured state object
+    \output
+      :ei_state[1]: state with temporary storage modified; ``uniform_rng`` modified (one seed drawn)
+    \return
+      the expected improvement from sampling ``points_to_sample`` with ``points_being_sampled`` concurrent experiments
+  \endrst*/
+  double ComputeExpectedImprovement(StateType * ei_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Computes the gradient of q,p-EI wrt ``points_to_sample``; see ExpectedImprovementEvaluator::ComputeGradExpectedImprovement().
+
+    \param
+      :ei_state[1]: properly configured state object (``configure_for_gradients`` must have been true)
+    \output
+      :ei_state[1]: state with temporary storage modified; ``uniform_rng`` modified (one seed drawn)
+      :grad_EI[dim][num_to_sample]: gradient of EI
+  \endrst*/
+  void ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(CudaExpectedImprovementEvaluator);
+
+ private:
+  //! spatial dimension (e.g., entries per point of points_sampled)
+  const int dim_;
+  //! number of monte carlo iterations
+  const int num_mc_iterations_;
+  //! best (minimum) objective function value (in points_sampled_value)
+  const double best_so_far_;
+  //! device ID
+  const int which_gpu_;
+  //! pointer to gaussian process used in EI computations
+  const GaussianProcess * gaussian_process_;
+};
+
+/*!\rst
+  State object for CudaExpectedImprovementEvaluator; holds the same host temporaries as ExpectedImprovementState plus
+  their device copies (allocated once, at construction).
+\endrst*/
+struct CudaExpectedImprovementState final {
+  using EvaluatorType = CudaExpectedImprovementEvaluator;
+
+  /*!\rst
+    Constructs a CudaExpectedImprovementState; see ExpectedImprovementState's constructor.
+
+    \param
+      :ei_evaluator: expected improvement evaluator object that specifies the parameters & GP for EI evaluation
+      :points_to_sample[dim][num_to_sample]: points at which to evaluate EI and/or its gradient
+      :points_being_sampled[dim][num_being_sampled]: points being sampled in concurrent experiments
+      :num_to_sample: number of potential future samples; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
+      :num_being_sampled: number of points being sampled in concurrent experiments (i.e., the "p" in q,p-EI)
+      :configure_for_gradients: true if this object will be used to compute gradients, false otherwise
+      :uniform_rng[1]: source of the device seeds (one draw per evaluation)
+      :configure_for_test: true to copy the device normals back to ``random_number_ei``/``random_number_grad_ei``
+  \endrst*/
+  CudaExpectedImprovementState(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample,
+                               double const * restrict points_being_sampled, int num_to_sample_in,
+                               int num_being_sampled_in, bool configure_for_gradients,
+                               UniformRandomGenerator * uniform_rng_in, bool configure_for_test_in);
+
+  CudaExpectedImprovementState(CudaExpectedImprovementState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim*num_to_sample;
+  }
+
+  /*!\rst
+    \output
+      :points_to_sample[dim][num_to_sample]: potential future samples whose EI (and/or gradients) are being evaluated
+  \endrst*/
+  void GetCurrentPoint(double * restrict points_to_sample) const noexcept OL_NONNULL_POINTERS {
+    std::copy(union_of_points.data(), union_of_points.data() + num_to_sample*dim, points_to_sample);
+  }
+
+  /*!\rst
+    Change the potential samples whose EI (and/or gradient) are being evaluated and update the GP-derived quantities.
+  \endrst*/
+  void SetCurrentPoint(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Checks the evaluator matches this state, then SetCurrentPoint().
+  \endrst*/
+  void SetupState(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample) OL_NONNULL_POINTERS;
+
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim;
+  //! number of potential future samples; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
+  const int num_to_sample;
+  //! number of points being sampled concurrently (i.e., the "p" in q,p-EI)
+  const int num_being_sampled;
+  //! number of derivative terms desired (usually 0 for no derivatives or num_to_sample)
+  const int num_derivatives;
+  //! number of points in union_of_points: num_to_sample + num_being_sampled
+  const int num_union;
+
+  //! points currently being sampled; this is the union of the points represented by "q" and "p" in q,p-EI
+  //! ``points_to_sample`` is stored first in memory, immediately followed by ``points_being_sampled``
+  std::vector<double> union_of_points;
+
+  //! gaussian process state
+  GaussianProcess::StateType points_to_sample_state;
+
+  //! source of the device seeds
+  UniformRandomGenerator * uniform_rng;
+  //! true to copy the device normals back to the host
+  const bool configure_for_test;
+
+  // temporary storage: preallocated space used by CudaExpectedImprovementEvaluator's member functions
+  //! the mean of the GP evaluated at union_of_points
+  std::vector<double> to_sample_mean;
+  //! the gradient of the GP mean evaluated at union_of_points, wrt union_of_points[0:num_to_sample]
+  std::vector<double> grad_mu;
+  //! the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points
+  std::vector<double> cholesky_to_sample_var;
+  //! the gradient of the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points wrt union_of_points[0:num_to_sample]
+  std::vector<double> grad_chol_decomp;
+  //! normals used by the last EI evaluation (if configure_for_test)
+  std::vector<double> random_number_ei;
+  //! normals used by the last grad EI evaluation (if configure_for_test)
+  std::vector<double> random_number_grad_ei;
+
+  //! device copies of the host temporaries and per-device-thread partial sums
+  CudaDevicePointer<double> gpu_mu;
+  CudaDevicePointer<double> gpu_chol_var;
+  CudaDevicePointer<double> gpu_grad_mu;
+  CudaDevicePointer<double> gpu_grad_chol_var;
+  CudaDevicePointer<double> gpu_ei_storage;
+  CudaDevicePointer<double> gpu_grad_ei_storage;
+  CudaDevicePointer<double> gpu_random_number_ei;
+  CudaDevicePointer<double> gpu_random_number_grad_ei;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(CudaExpectedImprovementState);
+};
+
+/*!\rst
+  GPU version of ComputeOptimalPointsToSampleWithRandomStarts() (gpp_math.hpp): multistart gradient descent on q,p-EI
+  from ``optimizer_parameters.num_multistarts`` random starts, with every EI and grad EI evaluation on device
+  ``which_gpu``. Runs single-threaded (see file comments).
+
+  \param
+    see ComputeOptimalPointsToSampleWithRandomStarts(); ``which_gpu`` is the device ID
+  \output
+    :found_flag[1]: true if best_next_point corresponds to a nonzero EI
+    :uniform_generator[1]: state modified (start points and device seeds)
+    :best_next_point[dim][num_to_sample]: points yielding the best EI according to MGD
+\endrst*/
+template <typename DomainType>
+void CudaComputeOptimalPointsToSampleWithRandomStarts(const GaussianProcess& gaussian_process,
+                                                      const GradientDescentParameters& optimizer_parameters,
+                                                      const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                                      double const * restrict points_being_sampled,
+                                                      int num_to_sample, int num_being_sampled, double best_so_far,
+                                                      int max_int_steps, int which_gpu, bool * restrict found_flag,
+                                                      UniformRandomGenerator * uniform_generator,
+                                                      double * restrict best_next_point) {
+  const int dim = gaussian_process.dim();
+  std::vector<double> starting_points(dim*optimizer_parameters.num_multistarts*num_to_sample);
+
+  // GenerateUniformPointsInDomain() is allowed to return fewer than the requested number of multistarts
+  RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  int num_multistarts = repeated_domain.GenerateUniformPointsInDomain(optimizer_parameters.num_multistarts,
+                                                                      uniform_generator, starting_points.data());
+
+  CudaExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far, which_gpu);
+  std::vector<CudaExpectedImprovementState> ei_state_vector;
+  ei_state_vector.emplace_back(ei_evaluator, starting_points.data(), points_being_sampled, num_to_sample,
+                               num_being_sampled, true, uniform_generator, false);
+
+  // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
+  OptimizationIOContainer io_container(ei_state_vector[0].GetProblemSize(), 0.0, starting_points.data());
+
+  ThreadSchedule single_thread_schedule(1, thread_schedule.schedule, thread_schedule.chunk_size);
+  GradientDescentOptimizer<CudaExpectedImprovementEvaluator, RepeatedDomain<DomainType> > gd_opt;
+  MultistartOptimizer<GradientDescentOptimizer<CudaExpectedImprovementEvaluator, RepeatedDomain<DomainType> > > multistart_optimizer;
+  multistart_optimizer.MultistartOptimize(gd_opt, ei_evaluator, optimizer_parameters, repeated_domain,
+                                          single_thread_schedule, starting_points.data(), num_multistarts,
+                                          ei_state_vector.data(), nullptr, &io_container);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+#ifdef OL_WARNING_PRINT
+  if (false == *found_flag) {
+    OL_WARNING_PRINTF("WARNING: %s DID NOT CONVERGE\n", OL_CURRENT_FUNCTION_NAME);
+    OL_WARNING_PRINTF("First multistart point was returned:\n");
+    PrintMatrixTrans(starting_points.data(), num_to_sample, dim);
+  }
+#endif
+}
+
+/*!\rst
+  GPU version of ComputeOptimalPointsToSampleViaLatinHypercubeSearch() (gpp_math.hpp): evaluates q,p-EI at
+  ``num_multistarts`` random points on device ``which_gpu`` and returns the best. Runs single-threaded.
+
+  \param
+    see ComputeOptimalPointsToSampleViaLatinHypercubeSearch(); ``which_gpu`` is the device ID
+  \output
+    :found_flag[1]: true if best_next_point corresponds to a nonzero EI
+    :uniform_generator[1]: state modified (points and device seeds)
+    :best_next_point[dim][num_to_sample]: points yielding the best EI according to dumb search
+\endrst*/
+template <typename DomainType>
+void CudaComputeOptimalPointsToSampleViaLatinHypercubeSearch(const GaussianProcess& gaussian_process,
+                                                             const DomainType& domain,
+                                                             const ThreadSchedule& thread_schedule,
+                                                             double const * restrict points_being_sampled,
+                                                             int num_multistarts, int num_to_sample,
+                                                             int num_being_sampled, double best_so_far,
+                                                             int max_int_steps, int which_gpu,
+                                                             bool * restrict found_flag,
+                                                             UniformRandomGenerator * uniform_generator,
+                                                             double * restrict best_next_point) {
+  std::vector<double> initial_guesses(gaussian_process.dim()*num_multistarts*num_to_sample);
+  RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  num_multistarts = repeated_domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
+                                                                  initial_guesses.data());
+
+  CudaExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far, which_gpu);
+  std::vector<CudaExpectedImprovementState> ei_state_vector;
+  ei_state_vector.emplace_back(ei_evaluator, initial_guesses.data(), points_being_sampled, num_to_sample,
+                               num_being_sampled, false, uniform_generator, false);
+
+  // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
+  OptimizationIOContainer io_container(ei_state_vector[0].GetProblemSize(), 0.0, initial_guesses.data());
+
+  ThreadSchedule single_thread_schedule(1, thread_schedule.schedule, thread_schedule.chunk_size);
+  NullOptimizer<CudaExpectedImprovementEvaluator, RepeatedDomain<DomainType> > null_opt;
+  typename NullOptimizer<CudaExpectedImprovementEvaluator, RepeatedDomain<DomainType> >::ParameterStruct null_parameters;
+  MultistartOptimizer<NullOptimizer<CudaExpectedImprovementEvaluator, RepeatedDomain<DomainType> > > multistart_optimizer;
+  multistart_optimizer.MultistartOptimize(null_opt, ei_evaluator, null_parameters, repeated_domain,
+                                          single_thread_schedule, initial_guesses.data(), num_multistarts,
+                                          ei_state_vector.data(), nullptr, &io_container);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+}
+
+/*!\rst
+  GPU version of ComputeOptimalPointsToSample() (gpp_math.hpp): multistart gradient descent on device ``which_gpu``,
+  falling back on latin hypercube search if it fails (or if ``lhc_search_only``).
+
+  \param
+    see ComputeOptimalPointsToSample(); ``which_gpu`` is the device ID
+  \output
+    :found_flag[1]: true if best_points_to_sample corresponds to a nonzero EI if sampled simultaneously
+    :uniform_generator[1]: state modified
+    :best_points_to_sample[num_to_sample*dim]: point yielding the best EI
+\endrst*/
+template <typename DomainType>
+void CudaComputeOptimalPointsToSample(const GaussianProcess& gaussian_process,
+                                      const GradientDescentParameters& optimizer_parameters,
+                                      const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                      double const * restrict points_being_sampled,
+                                      int num_to_sample, int num_being_sampled, double best_so_far,
+                                      int max_int_steps, bool lhc_search_only, int num_lhc_samples, int which_gpu,
+                                      bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
+                                      double * restrict best_points_to_sample) {
+  if (unlikely(num_to_sample <= 0)) {
+    return;
+  }
+
+  bool found_flag_local = false;
+  if (lhc_search_only == false) {
+    CudaComputeOptimalPointsToSampleWithRandomStarts(gaussian_process, optimizer_parameters, domain, thread_schedule,
+                                                     points_being_sampled, num_to_sample, num_being_sampled,
+                                                     best_so_far, max_int_steps, which_gpu, &found_flag_local,
+                                                     uniform_generator, best_points_to_sample);
+  }
+
+  // past the optimizer's deadline, return gradient descent's result instead of starting a search
+  const bool out_of_time = optimizer_parameters.deadline.Expired();
+  // if gradient descent EI optimization failed (with time left) OR we're only doing latin hypercube searches
+  if ((found_flag_local == false && !out_of_time) || lhc_search_only == true) {
+    if (unlikely(lhc_search_only == false)) {
+      OL_WARNING_PRINTF("WARNING: %d,%d-EI opt DID NOT CONVERGE\n", num_to_sample, num_being_sampled);
+      OL_WARNING_PRINTF("Attempting latin hypercube search\n");
+    }
+
+    if (num_lhc_samples > 0) {
+      CudaComputeOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, domain, thread_schedule,
+                                                              points_being_sampled, num_lhc_samples, num_to_sample,
+                                                              num_being_sampled, best_so_far, max_int_steps,
+                                                              which_gpu, &found_flag_local, uniform_generator,
+                                                              best_points_to_sample);
+
+      // if latin hypercube 'dumb' search failed
+      if (unlikely(found_flag_local == false)) {
+        OL_ERROR_PRINTF("ERROR: %d,%d-EI latin hypercube search FAILED on\n", num_to_sample, num_being_sampled);
+      }
+    } else {
+      OL_WARNING_PRINTF("num_lhc_samples <= 0. Skipping latin hypercube search\n");
+    }
+  }
+
+  // set outputs
+  *found_flag = found_flag_local;
+}
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_HPP_
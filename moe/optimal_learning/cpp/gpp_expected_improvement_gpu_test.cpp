@@ -0,0 +1,271 @@
+/*!
+  \file gpp_expected_improvement_gpu_test.cpp
+  \rst
+  Routines to test the GPU evaluators:
+
+  * with ``OL_GPU_ENABLED``: CudaExpectedImprovementEvaluator's EI and grad EI match ExpectedImprovementEvaluator
+    replaying the device normals (NormalRNGSimulator), and the device discrete KG inner step matches a brute-force
+    search over the discretized set with the same normals;
+  * without it: constructing CudaExpectedImprovementEvaluator, or KnowledgeGradientEvaluator with a device, throws
+    OptimalLearningException.
+\endrst*/
+
+#include "gpp_expected_improvement_gpu_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_expected_improvement_gpu.hpp"
+#include "gpp_knowledge_gradient_inner_optimization.hpp"
+#include "gpp_knowledge_gradient_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! device used by the tests
+constexpr int kTestGpu = 0;
+
+#ifdef OL_GPU_ENABLED
+
+/*!\rst
+  Checks CUDA q,p-EI and its gradient against the CPU evaluator fed the normals the device used.
+
+  \return
+    number of test failures: 0 if the device EI matches the host EI
+\endrst*/
+int CudaExpectedImprovementTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 2;
+  const int num_sampled = 8;
+  const int num_mc_iter = 4000;
+  const double tolerance = 1.0e-12;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, 0);
+
+  std::vector<double> lengths(dim, 1.1);
+  std::vector<double> noise_variance(1, 0.0);
+  SquareExponential sqexp_covariance(dim, 2.0, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                   num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  UniformRandomGenerator uniform_generator(2718);
+  CudaExpectedImprovementEvaluator cuda_ei_evaluator(gaussian_process, num_mc_iter, best_so_far, kTestGpu);
+  CudaExpectedImprovementEvaluator::StateType cuda_ei_state(cuda_ei_evaluator, EI_environment.points_to_sample(),
+                                                            EI_environment.points_being_sampled(), num_to_sample,
+                                                            num_being_sampled, true, &uniform_generator, true);
+  const double cuda_EI = cuda_ei_evaluator.ComputeExpectedImprovement(&cuda_ei_state);
+  std::vector<double> cuda_grad_EI(dim*num_to_sample);
+  cuda_ei_evaluator.ComputeGradExpectedImprovement(&cuda_ei_state, cuda_grad_EI.data());
+
+  ExpectedImprovementEvaluator ei_evaluator(gaussian_process, num_mc_iter, best_so_far);
+  NormalRNGSimulator ei_normal_rng(cuda_ei_state.random_number_ei);
+  ExpectedImprovementEvaluator::StateType ei_state(ei_evaluator, EI_environment.points_to_sample(),
+                                                   EI_environment.points_being_sampled(), num_to_sample,
+                                                   num_being_sampled, true, &ei_normal_rng);
+  if (!CheckDoubleWithinRelative(cuda_EI, ei_evaluator.ComputeExpectedImprovement(&ei_state), tolerance)) {
+    ++total_errors;
+  }
+
+  NormalRNGSimulator grad_ei_normal_rng(cuda_ei_state.random_number_grad_ei);
+  ei_state.normal_rng = &grad_ei_normal_rng;
+  std::vector<double> grad_EI(dim*num_to_sample);
+  ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
+  for (int k = 0; k < dim*num_to_sample; ++k) {
+    if (!CheckDoubleWithinRelative(cuda_grad_EI[k], grad_EI[k], tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the device KG path (KnowledgeGradientInnerMode::kDiscrete): the normals come in antithetic pairs and every
+  iteration's optimum matches a brute-force search with FuturePosteriorMeanEvaluator over the discretized set.
+
+  \return
+    number of test failures: 0 if the device discrete KG step matches the host
+\endrst*/
+int CudaKnowledgeGradientDiscreteTest() {
+  using DomainType = TensorProductDomain;
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int num_sampled = 7;
+  const int num_pts = 12;
+  const int num_mc_iter = 16;
+  const double best_so_far = 7.0;
+  const double tolerance = 1.0e-12;
+
+  MockExpectedImprovementEnvironment KG_environment;
+  KG_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, 0);
+
+  std::vector<double> lengths(dim, 1.3);
+  std::vector<double> noise_variance(1, 0.1);
+  SquareExponential sqexp_covariance(dim, 2.80723, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, KG_environment.points_sampled(), KG_environment.points_sampled_value(),
+                                   noise_variance.data(), nullptr, 0, dim, num_sampled);
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-5.0, 5.0));
+  DomainType domain(domain_bounds.data(), dim);
+  GradientDescentParameters gd_params(1, 250, 3, 15, 0.7, 1.0, 0.7, 1.0e-1);
+
+  UniformRandomGenerator uniform_generator(314);
+  boost::uniform_real<double> uniform_double(-5.0, 5.0);
+  std::vector<double> discrete_pts(dim*num_pts);
+  for (auto& entry : discrete_pts) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+
+  KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, 0, discrete_pts.data(), num_pts, num_mc_iter,
+                                                      domain, gd_params, best_so_far,
+                                                      KnowledgeGradientInnerMode::kDiscrete, 0, 1, kTestGpu);
+  NormalRNG normal_rng(3141);
+  KnowledgeGradientEvaluator<DomainType>::StateType kg_state(kg_evaluator, KG_environment.points_to_sample(),
+                                                             KG_environment.points_being_sampled(), num_to_sample,
+                                                             num_being_sampled, num_pts, nullptr, 0, false, &normal_rng);
+  const double KG = kg_evaluator.ComputeKnowledgeGradient(&kg_state);
+  if (!std::isfinite(KG)) {
+    ++total_errors;
+  }
+
+  const int num_union = kg_state.num_union;
+  for (int i = 1; i < num_mc_iter; i += 2) {
+    for (int j = 0; j < num_union; ++j) {
+      if (kg_state.normals[i*num_union + j] != -kg_state.normals[(i-1)*num_union + j]) {
+        ++total_errors;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_mc_iter; ++i) {
+    FuturePosteriorMeanEvaluator fpm_evaluator(gaussian_process, kg_state.normals.data() + i*num_union,
+                                               kg_state.union_of_points.data(), num_union, nullptr, 0,
+                                               kg_state.cholesky_to_sample_var.data(),
+                                               kg_state.points_to_sample_state.K_inv_times_K_star.data());
+    double best_value = -std::numeric_limits<double>::infinity();
+    for (int j = 0; j < num_union + num_pts; ++j) {
+      FuturePosteriorMeanState fpm_state(fpm_evaluator, 0, kg_evaluator.DiscretizedSetPoint(kg_state, j), false);
+      best_value = std::fmax(best_value, fpm_evaluator.ComputePosteriorMean(&fpm_state));
+    }
+    if (!CheckDoubleWithinRelative(kg_state.best_function_value[i], best_value, tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+#else
+
+/*!\rst
+  Checks that the GPU entry points throw OptimalLearningException when built without ``OL_GPU_ENABLED``.
+
+  \return
+    number of test failures: 0 if every GPU request is refused
+\endrst*/
+int GPUDisabledTest() {
+  using DomainType = TensorProductDomain;
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 5;
+  const int num_pts = 4;
+
+  MockExpectedImprovementEnvironment environment;
+  environment.Initialize(dim, 1, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 1.0);
+  std::vector<double> noise_variance(1, 0.1);
+  SquareExponential sqexp_covariance(dim, 1.0, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, environment.points_sampled(), environment.points_sampled_value(),
+                                   noise_variance.data(), nullptr, 0, dim, num_sampled);
+
+  try {
+    CudaExpectedImprovementEvaluator ei_evaluator(gaussian_process, 100, 0.0, kTestGpu);
+    ++total_errors;
+  } catch (const OptimalLearningException& exception) {
+    // expected
+  }
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-1.0, 1.0));
+  DomainType domain(domain_bounds.data(), dim);
+  GradientDescentParameters gd_params(1, 10, 1, 1, 0.7, 1.0, 0.7, 1.0e-1);
+  std::vector<double> discrete_pts(dim*num_pts, 0.5);
+  try {
+    KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, 0, discrete_pts.data(), num_pts, 8, domain,
+                                                        gd_params, 0.0, KnowledgeGradientInnerMode::kDiscrete, 0, 1,
+                                                        kTestGpu);
+    ++total_errors;
+  } catch (const OptimalLearningException& exception) {
+    // expected
+  }
+
+  // the CPU default is unaffected
+  KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, 0, discrete_pts.data(), num_pts, 8, domain,
+                                                      gd_params, 0.0, KnowledgeGradientInnerMode::kDiscrete, 0, 1);
+  if (kg_evaluator.which_gpu() != kNoGpu) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+#endif
+
+}  // end unnamed namespace
+
+int RunGPUTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+#ifdef OL_GPU_ENABLED
+  current_errors = CudaExpectedImprovementTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("CUDA q,p-EI failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = CudaKnowledgeGradientDiscreteTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("CUDA discrete KG failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+#else
+  current_errors = GPUDisabledTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GPU-disabled checks failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+#endif
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GPU tests failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GPU tests passed\n");
+  }
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,27 @@
+/*!
+  \file gpp_expected_improvement_gpu_test.hpp
+  \rst
+  Functions for testing the GPU evaluators (gpp_expected_improvement_gpu.hpp, gpp_knowledge_gradient_gpu.hpp).
+
+  With ``OL_GPU_ENABLED``, the device results are checked against the CPU evaluators fed the same normals; without it,
+  the tests check that asking for a GPU fails cleanly.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the GPU tests.
+
+  \return
+    number of test failures: 0 if the GPU evaluators are working properly (or, without a GPU build, refuse to run)
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunGPUTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_EXPECTED_IMPROVEMENT_GPU_TEST_HPP_
@@ -8,29 +8,40 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <exception>
 #include <memory>
+#include <vector>
 
 #include <stdlib.h>
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
 ExpectedImprovementMCMCEvaluator::ExpectedImprovementMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc,
                                                                    int num_mc_iterations,
                                                                    double const * best_so_far,
-                                                                   std::vector<typename ExpectedImprovementState::EvaluatorType> * evaluator_vector)
+                                                                   std::vector<typename ExpectedImprovementState::EvaluatorType> * evaluator_vector,
+                                                                   int max_num_threads,
+                                                                   const DistributedContext& distributed_context)
 : dim_(gaussian_process_mcmc.dim()),
   num_mcmc_hypers_(gaussian_process_mcmc.num_mcmc()),
   num_mc_iterations_(num_mc_iterations),
   best_so_far_(best_so_far_list(best_so_far)),
   gaussian_process_mcmc_(&gaussian_process_mcmc),
-  expected_improvement_evaluator_lst(evaluator_vector) {
+  expected_improvement_evaluator_lst(evaluator_vector),
+  max_num_threads_(max_num_threads),
+  distributed_context_(distributed_context) {
     expected_improvement_evaluator_lst->reserve(num_mcmc_hypers_);
     for (int i=0; i<num_mcmc_hypers_; ++i){
       expected_improvement_evaluator_lst->emplace_back(gaussian_process_mcmc_->gaussian_process_lst[i],
@@ -44,9 +55,29 @@ ExpectedImprovementMCMCEvaluator::ExpectedImprovementMCMCEvaluator(const Gaussia
   The discretization usually is: some set + points previous sampled + points being sampled + points to sample
 \endrst*/
 double ExpectedImprovementMCMCEvaluator::ComputeExpectedImprovement(StateType * ei_state) const {
+  int begin, end;
+  distributed_context_.BlockRange(num_mcmc_hypers_, &begin, &end);
+  ei_state->PrepareSampleRNGs();
+
+  // captured rather than propagated so that the cleanup below always runs
+  std::exception_ptr captured_exception;
+  try {
+    ParallelForEachIndex(max_num_threads_, end - begin, [&](int j) {
+        const int i = begin + j;
+        ei_state->sample_values[i] = (*expected_improvement_evaluator_lst)[i].ComputeObjectiveFunction(ei_state->ei_state_list->data() + i);
+      });
+  } catch (const std::exception&) {
+    captured_exception = std::current_exception();
+  }
+
+  ei_state->RestoreSampleRNGs();
+  distributed_context_.RethrowIfAnyFailed(captured_exception);
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, 1, ei_state->sample_values.data());
+
+  // reduce in sample order so the sum does not depend on the thread count
   double ei_value = 0.0;
-  for (int i=0; i<num_mcmc_hypers_; ++i){
-    ei_value += (*expected_improvement_evaluator_lst)[i].ComputeObjectiveFunction((*(ei_state->ei_state_list)).data()+i);
+  for (int i = 0; i < num_mcmc_hypers_; ++i) {
+    ei_value += ei_state->sample_values[i];
   }
   return ei_value/static_cast<double>(num_mcmc_hypers_);
 }
@@ -66,26 +97,61 @@ double ExpectedImprovementMCMCEvaluator::ComputeExpectedImprovement(StateType *
 
   .. Note:: comments here are copied to _compute_grad_knowledge_gradient_monte_carlo() in python_version/knowledge_gradient.py
 \endrst*/
-void ExpectedImprovementMCMCEvaluator::ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const {
-  for (int i=0; i<num_mcmc_hypers_; ++i){
-    std::vector<double> temp(ei_state->dim*ei_state->num_to_sample, 0.0);
-    (*expected_improvement_evaluator_lst)[i].ComputeGradObjectiveFunction((*(ei_state->ei_state_list)).data()+i, temp.data());
-    for (int k = 0; k < ei_state->num_to_sample*dim_; ++k) {
-        grad_EI[k] += temp[k];
+double ExpectedImprovementMCMCEvaluator::ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const {
+  const int problem_size = ei_state->num_to_sample*dim_;
+  int begin, end;
+  distributed_context_.BlockRange(num_mcmc_hypers_, &begin, &end);
+  ei_state->PrepareSampleRNGs();
+
+  // captured rather than propagated so that the cleanup below always runs
+  std::exception_ptr captured_exception;
+  try {
+    ParallelForEachIndex(max_num_threads_, end - begin, [&](int j) {
+        const int i = begin + j;
+        double * restrict sample_grad = ei_state->sample_grads.data() + i*problem_size;
+        std::fill(sample_grad, sample_grad + problem_size, 0.0);
+        ei_state->sample_values[i] = (*expected_improvement_evaluator_lst)[i].ComputeObjectiveAndGradient(ei_state->ei_state_list->data() + i, sample_grad);
+      });
+  } catch (const std::exception&) {
+    captured_exception = std::current_exception();
+  }
+
+  ei_state->RestoreSampleRNGs();
+  distributed_context_.RethrowIfAnyFailed(captured_exception);
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, 1, ei_state->sample_values.data());
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, problem_size, ei_state->sample_grads.data());
+
+  // reduce in sample order so the sums do not depend on the thread count
+  double ei_value = 0.0;
+  std::fill(grad_EI, grad_EI + problem_size, 0.0);
+  for (int i = 0; i < num_mcmc_hypers_; ++i) {
+    ei_value += ei_state->sample_values[i];
+    double const * restrict sample_grad = ei_state->sample_grads.data() + i*problem_size;
+    for (int k = 0; k < problem_size; ++k) {
+      grad_EI[k] += sample_grad[k];
     }
   }
-  for (int k = 0; k < ei_state->num_to_sample*dim_; ++k) {
+  for (int k = 0; k < problem_size; ++k) {
     grad_EI[k] = grad_EI[k]/static_cast<double>(num_mcmc_hypers_);
   }
+  return ei_value/static_cast<double>(num_mcmc_hypers_);
 }
 
 void ExpectedImprovementMCMCState::SetCurrentPoint(const EvaluatorType& ei_evaluator,
                                                    double const * restrict points_to_sample_in) {
   // update current point in union_of_points
-  std::copy(points_to_sample_in, points_to_sample_in + dim, union_of_points.data());
+  std::copy(points_to_sample_in, points_to_sample_in + dim*num_to_sample, union_of_points.data());
+
+  // the samples' GPs share points_sampled, so the differences to union_of_points are computed once for all of them
+  if (num_mcmc > 0) {
+    const GaussianProcess& gaussian_process = *ei_evaluator.expected_improvement_evaluator_list()->at(0).gaussian_process();
+    cross_differences.SetPoints(gaussian_process.points_sampled().data(), gaussian_process.num_sampled(),
+                                union_of_points.data(), num_union);
+  }
 
   // evaluate derived quantities for the GP
   for (int i=0; i<ei_evaluator.num_mcmc();++i){
+    (ei_state_list->at(i)).points_to_sample_state.cross_differences = &cross_differences;
     (ei_state_list->at(i)).SetCurrentPoint(ei_evaluator.expected_improvement_evaluator_list()->at(i), points_to_sample_in);
   }
 }
@@ -100,10 +166,16 @@ ExpectedImprovementMCMCState::ExpectedImprovementMCMCState(const EvaluatorType&
       num_being_sampled(num_being_sampled_in),
       num_derivatives(configure_for_gradients ? num_to_sample : 0),
       num_union(num_to_sample + num_being_sampled),
+      num_mcmc(ei_evaluator.num_mcmc()),
+      normal_rng(normal_rng_in),
+      sample_normal_rng(std::max(num_mcmc - 1, 0)),
       gradients(gradients_in, gradients_in+num_gradients_in),
       num_gradients_to_sample(num_gradients_in),
       union_of_points(BuildUnionOfPoints(points_to_sample, points_being_sampled, num_to_sample, num_being_sampled, dim)),
-      ei_state_list(ei_state_vector) {
+      sample_values(num_mcmc),
+      sample_grads(num_mcmc*dim*num_derivatives),
+      ei_state_list(ei_state_vector),
+      cross_differences(dim) {
   ei_state_list->reserve(ei_evaluator.num_mcmc());
   // evaluate derived quantities for the GP
   for (int i=0; i<ei_evaluator.num_mcmc();++i){
@@ -125,6 +197,19 @@ void ExpectedImprovementMCMCState::SetupState(const EvaluatorType& ei_evaluator,
   SetCurrentPoint(ei_evaluator, points_to_sample);
 }
 
+void ExpectedImprovementMCMCState::PrepareSampleRNGs() {
+  for (int i = 0; i < num_mcmc - 1; ++i) {
+    sample_normal_rng[i] = normal_rng->Clone();
+    (*ei_state_list)[i].normal_rng = sample_normal_rng[i].get();
+  }
+}
+
+void ExpectedImprovementMCMCState::RestoreSampleRNGs() noexcept {
+  for (int i = 0; i < num_mcmc - 1; ++i) {
+    (*ei_state_list)[i].normal_rng = normal_rng;
+  }
+}
+
 OnePotentialSampleExpectedImprovementMCMCEvaluator::OnePotentialSampleExpectedImprovementMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc, double const * best_so_far,
                                                                                                        std::vector<typename OnePotentialSampleExpectedImprovementState::EvaluatorType> * evaluator_vector)
 : dim_(gaussian_process_mcmc.dim()),
@@ -183,13 +268,84 @@ void OnePotentialSampleExpectedImprovementMCMCEvaluator::ComputeGradExpectedImpr
 }
 
 
+/*!\rst
+  The members' ``points_sampled`` are shared (the MCMC samples differ only in hyperparameters), so each tile's
+  CrossPairwiseDifferences are filled once and read by every member's CrossCovarianceMatrix().  A member whose
+  ``points_sampled`` is not shared falls back to building its block directly (see
+  GaussianProcess::PredictMarginalsOfDifferences()).
+\endrst*/
+void OnePotentialSampleExpectedImprovementMCMCEvaluator::ComputeExpectedImprovementOfPoints(
+    double const * restrict points, int num_points, int max_num_threads,
+    double * restrict expected_improvement) const {
+  if (unlikely(num_mcmc_hypers_ <= 0 || num_points <= 0)) {
+    std::fill(expected_improvement, expected_improvement + std::max(num_points, 0), 0.0);
+    return;
+  }
+  const GaussianProcess& first_gaussian_process = gaussian_process_mcmc_->gaussian_process_lst[0];
+  const int tile_size = GaussianProcess::kPredictMarginalsTileSize;
+  const int num_tiles = (num_points + tile_size - 1)/tile_size;
+  const int num_threads = std::max(std::min(max_num_threads, num_tiles), 1);
+  int max_num_rows = 0;
+  for (int i = 0; i < num_mcmc_hypers_; ++i) {
+    const GaussianProcess& gaussian_process = gaussian_process_mcmc_->gaussian_process_lst[i];
+    max_num_rows = std::max(max_num_rows, gaussian_process.num_sampled()*(gaussian_process.num_derivatives() + 1));
+  }
+
+  // per-thread differences and K(X, Xs) tiles, sized up front so that nothing in the parallel region allocates
+  std::vector<CrossPairwiseDifferences> tile_differences;
+  tile_differences.reserve(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    tile_differences.emplace_back(dim_);
+    tile_differences.back().SetPoints(first_gaussian_process.points_sampled().data(),
+                                      first_gaussian_process.num_sampled(), points, std::min(tile_size, num_points));
+  }
+  std::vector<double> tile_storage(num_threads*max_num_rows*tile_size);
+
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic) if(num_threads > 1)
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    const int thread_id = omp_get_thread_num();
+    const int first_point = tile*tile_size;
+    const int this_tile_size = std::min(tile_size, num_points - first_point);
+    double * restrict EI = expected_improvement + first_point;
+    double * restrict scratch = tile_storage.data() + thread_id*max_num_rows*tile_size;
+    CrossPairwiseDifferences& differences = tile_differences[thread_id];
+    differences.SetPoints(first_gaussian_process.points_sampled().data(), first_gaussian_process.num_sampled(),
+                          points + first_point*dim_, this_tile_size);
+
+    double mean[GaussianProcess::kPredictMarginalsTileSize];
+    double variance[GaussianProcess::kPredictMarginalsTileSize];
+    double member_EI[GaussianProcess::kPredictMarginalsTileSize];
+    std::fill(EI, EI + this_tile_size, 0.0);
+    for (int i = 0; i < num_mcmc_hypers_; ++i) {
+      gaussian_process_mcmc_->gaussian_process_lst[i].PredictMarginalsOfDifferences(differences, scratch, mean,
+                                                                                     variance);
+      OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfMarginals(
+          best_so_far_[i], mean, variance, this_tile_size, member_EI);
+      for (int k = 0; k < this_tile_size; ++k) {
+        EI[k] += member_EI[k];
+      }
+    }
+    for (int k = 0; k < this_tile_size; ++k) {
+      EI[k] /= static_cast<double>(num_mcmc_hypers_);
+    }
+  }
+}
+
 void OnePotentialSampleExpectedImprovementMCMCState::SetCurrentPoint(const EvaluatorType& ei_evaluator,
                                                                      double const * restrict point_to_sample_in) {
   // update current point in union_of_points
   std::copy(point_to_sample_in, point_to_sample_in + dim, point_to_sample.data());
 
+  // the samples' GPs share points_sampled, so the differences to point_to_sample are computed once for all of them
+  if (ei_evaluator.num_mcmc() > 0) {
+    const GaussianProcess& gaussian_process = *ei_evaluator.expected_improvement_evaluator_list()->at(0).gaussian_process();
+    cross_differences.SetPoints(gaussian_process.points_sampled().data(), gaussian_process.num_sampled(),
+                                point_to_sample.data(), num_to_sample);
+  }
+
   // evaluate derived quantities for the GP
   for (int i=0; i<ei_evaluator.num_mcmc();++i){
+    (ei_state_list->at(i)).points_to_sample_state.cross_differences = &cross_differences;
     (ei_state_list->at(i)).SetCurrentPoint(ei_evaluator.expected_improvement_evaluator_list()->at(i), point_to_sample_in);
   }
 }
@@ -206,7 +362,8 @@ OnePotentialSampleExpectedImprovementMCMCState::OnePotentialSampleExpectedImprov
     : dim(ei_evaluator.dim()),
       num_derivatives(configure_for_gradients ? num_to_sample : 0),
       point_to_sample(point_to_sample_in, point_to_sample_in + dim),
-      ei_state_list(ei_state_vector) {
+      ei_state_list(ei_state_vector),
+      cross_differences(dim) {
   ei_state_list->reserve(ei_evaluator.num_mcmc());
   // evaluate derived quantities for the GP
   for (int i=0; i<ei_evaluator.num_mcmc();++i){
@@ -238,7 +395,7 @@ void EvaluateEIMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc,
                                double const * restrict points_being_sampled,
                                int num_multistarts, int num_to_sample,
                                int num_being_sampled, double const * best_so_far,
-                               int max_int_steps, bool * restrict found_flag, NormalRNG * normal_rng,
+                               int max_int_steps, bool * restrict found_flag, NormalRNGArray normal_rng,
                                double * restrict function_values,
                                double * restrict best_next_point) {
     if (unlikely(num_multistarts <= 0)) {
@@ -249,37 +406,41 @@ void EvaluateEIMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc,
     DomainType_dummy dummy_domain;
     bool configure_for_gradients = false;
     if (num_to_sample == 1 && num_being_sampled == 0) {
+      // analytic case: one fused sweep over the list and all MCMC samples, with no per-point states
       std::vector<typename OnePotentialSampleExpectedImprovementState::EvaluatorType> ei_evaluator_lst;
 
       OnePotentialSampleExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc,
                                                                       best_so_far, &ei_evaluator_lst);
-
-      int num_derivatives = (*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->num_derivatives();
-      std::vector<int> derivatives((*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->derivatives());
-
-      std::vector<typename OnePotentialSampleExpectedImprovementMCMCEvaluator::StateType> state_vector;
-      std::vector<std::vector<typename OnePotentialSampleExpectedImprovementEvaluator::StateType>> ei_state_vector(thread_schedule.max_num_threads);
-      SetupExpectedImprovementMCMCState(ei_evaluator, initial_guesses, points_being_sampled,
-                                        num_to_sample, num_being_sampled, derivatives.data(), num_derivatives,
-                                        thread_schedule.max_num_threads, configure_for_gradients,
-                                        normal_rng, ei_state_vector.data(), &state_vector);
-
-      // init winner to be first point in set and 'force' its value to be -INFINITY; we cannot do worse than this
-      OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), 0.0, initial_guesses);
-
-      NullOptimizer<OnePotentialSampleExpectedImprovementMCMCEvaluator, DomainType_dummy> null_opt;
-      typename NullOptimizer<OnePotentialSampleExpectedImprovementMCMCEvaluator, DomainType_dummy>::ParameterStruct null_parameters;
-      MultistartOptimizer<NullOptimizer<OnePotentialSampleExpectedImprovementMCMCEvaluator, DomainType_dummy> > multistart_optimizer;
-      multistart_optimizer.MultistartOptimize(null_opt, ei_evaluator, null_parameters,
-                                              dummy_domain, thread_schedule, initial_guesses,
-                                              num_multistarts, state_vector.data(), function_values, &io_container);
-      *found_flag = io_container.found_flag;
-      std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+      std::vector<double> EI_values(function_values == nullptr ? num_multistarts : 0);
+      double * restrict EI = function_values == nullptr ? EI_values.data() : function_values;
+      ei_evaluator.ComputeExpectedImprovementOfPoints(initial_guesses, num_multistarts, thread_schedule.max_num_threads,
+                                                      EI);
+
+      // as in MultistartOptimize() with an initial value of 0.0: the winner starts as the first point, and a later
+      // point must be strictly better to replace it
+      const int dim = gaussian_process_mcmc.dim();
+      double best_objective_value_so_far = 0.0;
+      int best_index = 0;
+      for (int i = 0; i < num_multistarts; ++i) {
+        if (best_objective_value_so_far < EI[i]) {
+          best_objective_value_so_far = EI[i];
+          best_index = i;
+        }
+      }
+      *found_flag = best_objective_value_so_far > 0.0;
+      std::copy(initial_guesses + best_index*dim, initial_guesses + (best_index + 1)*dim, best_next_point);
     } else {
       std::vector<typename ExpectedImprovementState::EvaluatorType> ei_evaluator_lst;
 
+      // short point lists leave the spare cores to the reduction over MCMC samples
+      int num_point_threads, num_sample_threads;
+      SplitThreadBudget(thread_schedule.max_num_threads, num_multistarts, &num_point_threads, &num_sample_threads);
+      ThreadSchedule point_thread_schedule(thread_schedule);
+      point_thread_schedule.max_num_threads = num_point_threads;
+      ScopedNestedParallelism nested_parallelism(num_point_threads > 1 && num_sample_threads > 1);
+
       ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps,
-                                                    best_so_far, &ei_evaluator_lst);
+                                                    best_so_far, &ei_evaluator_lst, num_sample_threads);
 
       int num_derivatives = (*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->num_derivatives();
       std::vector<int> derivatives((*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->derivatives());
@@ -298,7 +459,7 @@ void EvaluateEIMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc,
       typename NullOptimizer<ExpectedImprovementMCMCEvaluator, DomainType_dummy>::ParameterStruct null_parameters;
       MultistartOptimizer<NullOptimizer<ExpectedImprovementMCMCEvaluator, DomainType_dummy> > multistart_optimizer;
       multistart_optimizer.MultistartOptimize(null_opt, ei_evaluator, null_parameters,
-                                              dummy_domain, thread_schedule, initial_guesses,
+                                              dummy_domain, point_thread_schedule, initial_guesses,
                                               num_multistarts, state_vector.data(), function_values, &io_container);
       *found_flag = io_container.found_flag;
       std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
@@ -320,7 +481,7 @@ void ComputeEIMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                         int max_int_steps, bool lhc_search_only,
                                         int num_lhc_samples, bool * restrict found_flag,
                                         UniformRandomGenerator * uniform_generator,
-                                        NormalRNG * normal_rng, double * restrict best_points_to_sample) {
+                                        NormalRNGArray normal_rng, double * restrict best_points_to_sample) {
   if (unlikely(num_to_sample <= 0)) {
     return;
   }
@@ -337,8 +498,10 @@ void ComputeEIMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                                        next_points_to_sample.data());
   }
 
-  // if gradient descent EI optimization failed OR we're only doing latin hypercube searches
-  if (found_flag_local == false || lhc_search_only == true) {
+  // past the optimizer's deadline, return gradient descent's result instead of starting a search
+  const bool out_of_time = optimizer_parameters.deadline.Expired();
+  // if gradient descent EI optimization failed (with time left) OR we're only doing latin hypercube searches
+  if ((found_flag_local == false && !out_of_time) || lhc_search_only == true) {
     if (unlikely(lhc_search_only == false)) {
       OL_WARNING_PRINTF("WARNING: %d,%d-EI opt DID NOT CONVERGE\n", num_to_sample, num_being_sampled);
       OL_WARNING_PRINTF("Attempting latin hypercube search\n");
@@ -378,12 +541,19 @@ template void ComputeEIMCMCOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     double const * best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 template void ComputeEIMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const GradientDescentParameters& optimizer_parameters,
     const SimplexIntersectTensorProductDomain& domain, const ThreadSchedule& thread_schedule,
     double const * restrict points_being_sampled,
     int num_to_sample, int num_being_sampled,
     double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+template void ComputeEIMCMCOptimalPointsToSample(
+    GaussianProcessMCMC& gaussian_process_mcmc, const GradientDescentParameters& optimizer_parameters,
+    const TrustRegionDomain& domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled,
+    int num_to_sample, int num_being_sampled,
+    double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 }  // end namespace optimal_learning
\ No newline at end of file
@@ -129,6 +129,7 @@
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
@@ -161,10 +162,16 @@ class ExpectedImprovementMCMCEvaluator final {
       :num_pts: number of points in discrete_pts
       :num_mc_iterations: number of monte carlo iterations
       :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :max_num_threads: maximum number of threads used to reduce over the MCMC hyperparameter samples; callers running
+        inside a parallel region need nested parallelism enabled (see ScopedNestedParallelism) for values > 1 to help
+      :distributed_context: ranks to spread the MCMC hyperparameter samples over (see gpp_distributed.hpp); with more
+        than one rank, every evaluation is a collective
   \endrst*/
   ExpectedImprovementMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc,
                                    int num_mc_iterations, double const * best_so_far,
-                                   std::vector<typename ExpectedImprovementState::EvaluatorType> * evaluator_vector);
+                                   std::vector<typename ExpectedImprovementState::EvaluatorType> * evaluator_vector,
+                                   int max_num_threads,
+                                   const DistributedContext& distributed_context = DistributedContext());
 
 
   int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
@@ -175,6 +182,10 @@ class ExpectedImprovementMCMCEvaluator final {
     return num_mcmc_hypers_;
   }
 
+  int max_num_threads() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_num_threads_;
+  }
+
   std::vector<ExpectedImprovementEvaluator> * expected_improvement_evaluator_list() const noexcept OL_WARN_UNUSED_RESULT {
     return expected_improvement_evaluator_lst;
   }
@@ -199,8 +210,35 @@ class ExpectedImprovementMCMCEvaluator final {
     ComputeGradExpectedImprovement(ei_state, grad_EI);
   }
 
+  /*!\rst
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp): each sample's EI
+    comes out of its gradient computation (see ExpectedImprovementEvaluator::ComputeObjectiveAndGradient()).
+
+    \param
+      :ei_state[1]: properly configured state object
+    \output
+      :ei_state[1]: state with temporary storage modified; ``normal_rng`` modified
+      :grad_EI[dim][num_to_sample]: gradient of EI (see ComputeGradExpectedImprovement())
+    \return
+      the expected improvement
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS {
+    return ComputeGradExpectedImprovement(ei_state, grad_EI);
+  }
+
   /*!\rst
     Computes the knowledge gradient
+
+    The MCMC samples are spread across ``max_num_threads`` threads.  Every sample but the last draws from its own
+    clone of ``normal_rng`` (see ExpectedImprovementMCMCState::PrepareSampleRNGs()), so all samples start from the
+    same point in the stream, and the per-sample values are summed in sample order: the result does not depend on
+    the number of threads.
+
+    With a DistributedContext of several ranks, each rank evaluates its block of the samples and the per-sample
+    values are gathered before the reduction, so the result does not depend on the number of ranks either.  Only the
+    rank holding the last sample advances ``normal_rng`` past the shared starting point; the ranks' streams may then
+    differ, but their results do not.
+
     \param
       :kg_state[1]: properly configured state object
     \output
@@ -216,6 +254,7 @@ class ExpectedImprovementMCMCEvaluator final {
     concurrent experiments.
 
     ``points_to_sample`` is the "q" and ``points_being_sampled`` is the "p" in q,p-KG.
+    The MCMC samples are reduced as in ComputeExpectedImprovement().
 
     \param
       :kg_state[1]: properly configured state object
@@ -224,8 +263,10 @@ class ExpectedImprovementMCMCEvaluator final {
       :grad_KG[dim][num_to_sample]: gradient of KG, ``\pderiv{KG(Xq \cup Xp)}{Xq_{d,i}}`` where ``Xq`` is ``points_to_sample``
       and ``Xp`` is ``points_being_sampled`` (grad KG from sampling ``points_to_sample`` with
       ``points_being_sampled`` concurrent experiments wrt each dimension of the points in ``points_to_sample``)
+    \return
+      the expected improvement (reduced as in ComputeExpectedImprovement()), a by-product of the per-sample gradients
   \endrst*/
-  void ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
+  double ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ExpectedImprovementMCMCEvaluator);
 
@@ -242,6 +283,10 @@ class ExpectedImprovementMCMCEvaluator final {
   const GaussianProcessMCMC * gaussian_process_mcmc_;
   //! pointer to gaussian process used in KG computations
   std::vector<typename ExpectedImprovementState::EvaluatorType> * expected_improvement_evaluator_lst;
+  //! maximum number of threads used to reduce over the MCMC hyperparameter samples
+  const int max_num_threads_;
+  //! ranks the MCMC hyperparameter samples are spread over
+  const DistributedContext distributed_context_;
 };
 
 /*!\rst
@@ -362,6 +407,18 @@ struct ExpectedImprovementMCMCState final {
   \endrst*/
   void SetupState(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample);
 
+  /*!\rst
+    Points the per-sample states at their sources of randomness for one reduction over the samples.
+    The last sample draws from ``normal_rng`` itself; every other sample draws from a fresh clone of it, taken
+    before any sample runs.  So each sample sees the same stream no matter which thread runs it.
+  \endrst*/
+  void PrepareSampleRNGs();
+
+  /*!\rst
+    Points every per-sample state back at ``normal_rng``; undoes PrepareSampleRNGs().
+  \endrst*/
+  void RestoreSampleRNGs() noexcept;
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   const int dim;
@@ -373,6 +430,13 @@ struct ExpectedImprovementMCMCState final {
   const int num_derivatives;
   //! number of points in union_of_points: num_to_sample + num_being_sampled
   const int num_union;
+  //! number of MCMC hyperparameter samples
+  const int num_mcmc;
+
+  //! the normal RNG shared by the per-sample states
+  NormalRNGInterface * normal_rng;
+  //! per-sample copies of ``normal_rng`` used when reducing over the samples in parallel, ``[num_mcmc - 1]``
+  std::vector<std::unique_ptr<NormalRNGInterface>> sample_normal_rng;
 
   // gradients index
   std::vector<int> gradients;
@@ -383,9 +447,18 @@ struct ExpectedImprovementMCMCState final {
   //! ``points_to_sample`` is stored first in memory, immediately followed by ``points_being_sampled``
   std::vector<double> union_of_points;
 
+  //! EI of each MCMC hyperparameter sample, ``[num_mcmc]``
+  std::vector<double> sample_values;
+  //! grad EI of each MCMC hyperparameter sample, ``[num_mcmc][num_derivatives][dim]``
+  std::vector<double> sample_grads;
+
   //! gaussian process state
   std::vector<typename ExpectedImprovementEvaluator::StateType> * ei_state_list;
 
+  //! squared differences between the (shared) ``points_sampled`` and the current points, filled once per
+  //! SetCurrentPoint() and read by every member state's ``K(X, Xs)`` build
+  CrossPairwiseDifferences cross_differences;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ExpectedImprovementMCMCState);
 };
 
@@ -477,6 +550,26 @@ class OnePotentialSampleExpectedImprovementMCMCEvaluator final {
   \endrst*/
   void ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Computes the MCMC-averaged 1,0-EI at each of ``points``, for screening candidate lists (see
+    EvaluateEIMCMCAtPointList()).
+
+    Matches ComputeExpectedImprovement() at each point (up to round-off) in one fused sweep: candidates are taken in
+    tiles of GaussianProcess::kPredictMarginalsTileSize points, the tile's squared differences to the (shared)
+    ``points_sampled`` are computed once, and then every member GP builds its ``K(X, Xs)`` block from them, predicts the
+    tile's marginals with one matrix-vector product and one triangular solve, and adds its EI to the running sum.
+    There are no per-point or per-member states.
+
+    \param
+      :points[dim][num_points]: points at which to compute EI; may contain duplicates
+      :num_points: number of points
+      :max_num_threads: maximum number of threads to use
+    \output
+      :expected_improvement[num_points]: EI at each point of ``points``
+  \endrst*/
+  void ComputeExpectedImprovementOfPoints(double const * restrict points, int num_points, int max_num_threads,
+                                          double * restrict expected_improvement) const OL_NONNULL_POINTERS;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OnePotentialSampleExpectedImprovementMCMCEvaluator);
 
  private:
@@ -599,6 +692,10 @@ struct OnePotentialSampleExpectedImprovementMCMCState final {
   //! gaussian process state
   std::vector<typename OnePotentialSampleExpectedImprovementEvaluator::StateType> * ei_state_list;
 
+  //! squared differences between the (shared) ``points_sampled`` and the current points, filled once per
+  //! SetCurrentPoint() and read by every member state's ``K(X, Xs)`` build
+  CrossPairwiseDifferences cross_differences;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OnePotentialSampleExpectedImprovementMCMCState);
 };
 
@@ -617,7 +714,7 @@ struct OnePotentialSampleExpectedImprovementMCMCState final {
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
     :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
-    :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
+    :normal_rng[max_num_threads]: a NormalRNGArray of generators that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -630,7 +727,7 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementMCMCState(
     int const * restrict gradients, int num_gradients,
     int max_num_threads,
     bool configure_for_gradients,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     std::vector<typename OnePotentialSampleExpectedImprovementEvaluator::StateType> * ei_state_vector,
     std::vector<typename OnePotentialSampleExpectedImprovementMCMCEvaluator::StateType> * state_vector) {
   state_vector->reserve(max_num_threads);
@@ -638,7 +735,7 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementMCMCState(
     //kg_state_vector.reserve(0);
     state_vector->emplace_back(ei_evaluator, points_to_sample, points_being_sampled, num_to_sample,
                                num_being_sampled, configure_for_gradients,
-                               normal_rng + i, ei_state_vector+i);
+                               &normal_rng[i], ei_state_vector+i);
   }
 }
 
@@ -657,7 +754,7 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementMCMCState(
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
     :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
-    :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
+    :normal_rng[max_num_threads]: a NormalRNGArray of generators that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -670,7 +767,7 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementMCMCState(
     int const * restrict gradients, int num_gradients,
     int max_num_threads,
     bool configure_for_gradients,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     std::vector<typename ExpectedImprovementEvaluator::StateType> * ei_state_vector,
     std::vector<typename ExpectedImprovementMCMCEvaluator::StateType> * state_vector) {
   state_vector->reserve(max_num_threads);
@@ -678,7 +775,7 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementMCMCState(
     //kg_state_vector.reserve(0);
     state_vector->emplace_back(ei_evaluator, points_to_sample, points_being_sampled, num_to_sample,
                                num_being_sampled, gradients, num_gradients, configure_for_gradients,
-                               normal_rng + i, ei_state_vector+i);
+                               &normal_rng[i], ei_state_vector+i);
   }
 }
 
@@ -794,9 +891,11 @@ void RestartedGradientDescentEIMCMCOptimization(const ExpectedImprovementMCMCEva
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :num_refined_starts: number of starts with the best initial EI that gradient descent refines (in parallel);
+      all ``num_multistarts`` are screened in parallel (suggest: 20)
   \output
     :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
     :found_flag[1]: true if ``best_next_point`` corresponds to a nonzero KG
@@ -815,9 +914,10 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
     int num_being_sampled,
     double const * best_so_far,
     int max_int_steps,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     bool * restrict found_flag,
-    double * restrict best_next_point) {
+    double * restrict best_next_point,
+    int num_refined_starts = 20) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
   }
@@ -837,34 +937,11 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
                                       thread_schedule.max_num_threads, configure_for_gradients,
                                       normal_rng, ei_state_vector.data(), &state_vector);
 
-    std::vector<double> EI_starting(num_multistarts);
-    for (int i=0; i<num_multistarts; ++i){
-      state_vector[0].SetCurrentPoint(ei_evaluator, start_point_set + i*num_to_sample*gaussian_process_mcmc.dim());
-      EI_starting[i] = ei_evaluator.ComputeExpectedImprovement(&state_vector[0]);
-    }
-
-    std::priority_queue<std::pair<double, int>> q;
-    int k = 20; // number of indices we need
-    for (int i = 0; i < EI_starting.size(); ++i) {
-      if (i < k){
-        q.push(std::pair<double, int>(-EI_starting[i], i));
-      }
-      else{
-        if (q.top().first > -EI_starting[i]){
-          q.pop();
-          q.push(std::pair<double, int>(-EI_starting[i], i));
-        }
-      }
-    }
-
+    // screen every start on all threads; descend from the best few
+    int k = std::min(num_refined_starts, num_multistarts); // number of indices we need (at most one per multistart)
     std::vector<double> top_k_starting(k*num_to_sample*gaussian_process_mcmc.dim());
-    for (int i = 0; i < k; ++i) {
-      int ki = q.top().second;
-      for (int d = 0; d<num_to_sample*gaussian_process_mcmc.dim(); ++d){
-        top_k_starting[i*num_to_sample*gaussian_process_mcmc.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process_mcmc.dim() + d];
-      }
-      q.pop();
-    }
+    SelectBestStartPoints(ei_evaluator, start_point_set, num_multistarts, k, thread_schedule.max_num_threads,
+                          state_vector.data(), top_k_starting.data());
 
     // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
     OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), 0.0, top_k_starting.data());
@@ -879,8 +956,18 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
     *found_flag = io_container.found_flag;
     std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
   } else {
+    int k = std::min(num_refined_starts, num_multistarts); // number of indices we need (at most one per multistart)
+
+    // multistarts that cannot occupy every core leave the rest to the reduction over MCMC samples
+    int num_multistart_threads, num_sample_threads;
+    SplitThreadBudget(thread_schedule.max_num_threads, k, &num_multistart_threads, &num_sample_threads);
+    ThreadSchedule multistart_thread_schedule(thread_schedule);
+    multistart_thread_schedule.max_num_threads = num_multistart_threads;
+    ScopedNestedParallelism nested_parallelism(num_multistart_threads > 1 && num_sample_threads > 1);
+
     std::vector<typename ExpectedImprovementState::EvaluatorType> ei_evaluator_lst;
-    ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps, best_so_far, &ei_evaluator_lst);
+    ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps, best_so_far, &ei_evaluator_lst,
+                                                  num_sample_threads);
 
     int num_derivatives = (*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->num_derivatives();
     std::vector<int> derivatives((*ei_evaluator.expected_improvement_evaluator_list())[0].gaussian_process()->derivatives());
@@ -892,34 +979,10 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
                                       thread_schedule.max_num_threads, configure_for_gradients,
                                       normal_rng, ei_state_vector.data(), &state_vector);
 
-    std::vector<double> EI_starting(num_multistarts);
-    for (int i=0; i<num_multistarts; ++i){
-      state_vector[0].SetCurrentPoint(ei_evaluator, start_point_set + i*num_to_sample*gaussian_process_mcmc.dim());
-      EI_starting[i] = ei_evaluator.ComputeExpectedImprovement(&state_vector[0]);
-    }
-
-    std::priority_queue<std::pair<double, int>> q;
-    int k = 20; // number of indices we need
-    for (int i = 0; i < EI_starting.size(); ++i) {
-      if (i < k){
-        q.push(std::pair<double, int>(-EI_starting[i], i));
-      }
-      else{
-        if (q.top().first > -EI_starting[i]){
-          q.pop();
-          q.push(std::pair<double, int>(-EI_starting[i], i));
-        }
-      }
-    }
-
+    // screen every start on the multistart threads (each with its share of the MCMC sample threads)
     std::vector<double> top_k_starting(k*num_to_sample*gaussian_process_mcmc.dim());
-    for (int i = 0; i < k; ++i) {
-      int ki = q.top().second;
-      for (int d = 0; d<num_to_sample*gaussian_process_mcmc.dim(); ++d){
-        top_k_starting[i*num_to_sample*gaussian_process_mcmc.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process_mcmc.dim() + d];
-      }
-      q.pop();
-    }
+    SelectBestStartPoints(ei_evaluator, start_point_set, num_multistarts, k, num_multistart_threads,
+                          state_vector.data(), top_k_starting.data());
 
     // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
     OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), 0.0, top_k_starting.data());
@@ -929,7 +992,7 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
     GradientDescentOptimizer<ExpectedImprovementMCMCEvaluator, RepeatedDomain> gd_opt;
     MultistartOptimizer<GradientDescentOptimizer<ExpectedImprovementMCMCEvaluator, RepeatedDomain> > multistart_optimizer;
     multistart_optimizer.MultistartOptimize(gd_opt, ei_evaluator, optimizer_parameters,
-                                            repeated_domain, thread_schedule, top_k_starting.data(),
+                                            repeated_domain, multistart_thread_schedule, top_k_starting.data(),
                                             k, state_vector.data(), nullptr, &io_container);
     *found_flag = io_container.found_flag;
     std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
@@ -961,7 +1024,7 @@ OL_NONNULL_POINTERS void ComputeEIMCMCOptimalPointsToSampleViaMultistartGradient
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -977,7 +1040,7 @@ void EvaluateEIMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc,
                                double const * restrict points_being_sampled,
                                int num_multistarts, int num_to_sample,
                                int num_being_sampled, double const * best_so_far,
-                               int max_int_steps, bool * restrict found_flag, NormalRNG * normal_rng,
+                               int max_int_steps, bool * restrict found_flag, NormalRNGArray normal_rng,
                                double * restrict function_values,
                                double * restrict best_next_point);
 
@@ -1007,7 +1070,7 @@ void EvaluateEIMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc,
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -1024,7 +1087,7 @@ void ComputeEIMCMCOptimalPointsToSampleWithRandomStarts(GaussianProcessMCMC& gau
                                                         int num_to_sample, int num_being_sampled,
                                                         double const * best_so_far,
                                                         int max_int_steps, bool * restrict found_flag,
-                                                        UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng,
+                                                        UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng,
                                                         double * restrict best_next_point) {
 /*
   int grid_size = 100;
@@ -1090,9 +1153,12 @@ void ComputeEIMCMCOptimalPointsToSampleWithRandomStarts(GaussianProcessMCMC& gau
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :tile_size: if positive and less than ``num_multistarts``, stream the candidates in tiles of this many q-sets
+      (see StreamingUniformSearch()) instead of materializing all ``num_multistarts`` of them; 0 (default) for the
+      full list
   \output
     found_flag[1]: true if best_next_point corresponds to a nonzero KG
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -1109,10 +1175,54 @@ void ComputeEIMCMCOptimalPointsToSampleViaLatinHypercubeSearch(GaussianProcessMC
                                                                int max_int_steps,
                                                                bool * restrict found_flag,
                                                                UniformRandomGenerator * uniform_generator,
-                                                               NormalRNG * normal_rng,
-                                                               double * restrict best_next_point) {
-  std::vector<double> initial_guesses(gaussian_process_mcmc.dim()*num_multistarts*num_to_sample);
+                                                               NormalRNGArray normal_rng,
+                                                               double * restrict best_next_point,
+                                                               int tile_size = 0) {
   RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  if (tile_size > 0 && tile_size < num_multistarts) {
+    const int problem_size = gaussian_process_mcmc.dim()*num_to_sample;
+    const int num_tiles = (num_multistarts + tile_size - 1)/tile_size;
+    // the states need a valid point to start from; it is also the answer if no candidate beats EI = 0
+    std::vector<double> initial_point(problem_size);
+    int OL_UNUSED(num_initial_points) = repeated_domain.GenerateUniformPointsInDomain(1, uniform_generator,
+                                                                                      initial_point.data());
+    OptimizationIOContainer io_container(problem_size, 0.0, initial_point.data());
+
+    if (num_to_sample == 1 && num_being_sampled == 0) {
+      // analytic case: each tile goes through the fused 1,0-EI kernel over all MCMC samples, with no per-point states
+      const int num_threads = std::max(std::min(thread_schedule.max_num_threads, num_tiles), 1);
+      std::vector<typename OnePotentialSampleExpectedImprovementState::EvaluatorType> ei_evaluator_lst;
+      OnePotentialSampleExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, best_so_far,
+                                                                      &ei_evaluator_lst);
+      StreamingUniformSearch(repeated_domain, num_multistarts, tile_size, num_threads, uniform_generator,
+                             [&ei_evaluator](int OL_UNUSED(thread_index), double const * points, int num_tile_points,
+                                             double * values) {
+          ei_evaluator.ComputeExpectedImprovementOfPoints(points, num_tile_points, 1, values);
+        }, &io_container);
+    } else {
+      // as in EvaluateEIMCMCAtPointList(): few tiles leave the spare cores to the reduction over MCMC samples
+      int num_threads, num_sample_threads;
+      SplitThreadBudget(thread_schedule.max_num_threads, num_tiles, &num_threads, &num_sample_threads);
+      ScopedNestedParallelism nested_parallelism(num_threads > 1 && num_sample_threads > 1);
+
+      std::vector<typename ExpectedImprovementState::EvaluatorType> ei_evaluator_lst;
+      ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps, best_so_far,
+                                                    &ei_evaluator_lst, num_sample_threads);
+      std::vector<int> derivatives(gaussian_process_mcmc.gaussian_process_lst[0].derivatives());
+      std::vector<typename ExpectedImprovementMCMCEvaluator::StateType> state_vector;
+      std::vector<std::vector<typename ExpectedImprovementEvaluator::StateType>> ei_state_vector(num_threads);
+      SetupExpectedImprovementMCMCState(ei_evaluator, initial_point.data(), points_being_sampled, num_to_sample,
+                                        num_being_sampled, derivatives.data(), derivatives.size(), num_threads,
+                                        false, normal_rng, ei_state_vector.data(), &state_vector);
+      StreamingUniformSearch(ei_evaluator, repeated_domain, num_multistarts, tile_size, num_threads,
+                             state_vector.data(), uniform_generator, &io_container);
+    }
+    *found_flag = io_container.found_flag;
+    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    return;
+  }
+
+  std::vector<double> initial_guesses(gaussian_process_mcmc.dim()*num_multistarts*num_to_sample);
   num_multistarts = repeated_domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
                                                                   initial_guesses.data());
 
@@ -1161,7 +1271,7 @@ void ComputeEIMCMCOptimalPointsToSampleViaLatinHypercubeSearch(GaussianProcessMC
     :lhc_search_only: whether to ONLY use latin hypercube search (and skip gradient descent EI opt)
     :num_lhc_samples: number of samples to draw if/when doing latin hypercube search
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -1180,7 +1290,7 @@ void ComputeEIMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                         int max_int_steps, bool lhc_search_only,
                                         int num_lhc_samples, bool * restrict found_flag,
                                         UniformRandomGenerator * uniform_generator,
-                                        NormalRNG * normal_rng, double * restrict best_points_to_sample);
+                                        NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 // template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
 extern template void ComputeEIMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const GradientDescentParameters& optimizer_parameters,
@@ -1189,14 +1299,21 @@ extern template void ComputeEIMCMCOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     double const * best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 extern template void ComputeEIMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const GradientDescentParameters& optimizer_parameters,
     const SimplexIntersectTensorProductDomain& domain, const ThreadSchedule& thread_schedule,
     double const * restrict points_being_sampled,
     int num_to_sample, int num_being_sampled,
     double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+extern template void ComputeEIMCMCOptimalPointsToSample(
+    GaussianProcessMCMC& gaussian_process_mcmc, const GradientDescentParameters& optimizer_parameters,
+    const TrustRegionDomain& domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled,
+    int num_to_sample, int num_being_sampled,
+    double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_HEURISTIC_EXPECTED_IMPROVEMENT_OPTIMIZATION_HPP_
\ No newline at end of file
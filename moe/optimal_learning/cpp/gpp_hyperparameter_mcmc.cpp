@@ -0,0 +1,235 @@
+/*!
+  \file gpp_hyperparameter_mcmc.cpp
+  \rst
+  This file contains the HyperparameterPrior member functions and the multithreaded driver for slice sampling
+  hyperparameters, SliceSampleHyperparameters().  See gpp_hyperparameter_mcmc.hpp for an overview of the priors and
+  the sampler.
+\endrst*/
+
+#include "gpp_hyperparameter_mcmc.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include <boost/random/cauchy_distribution.hpp>  // NOLINT(build/include_order)
+#include <boost/random/normal_distribution.hpp>  // NOLINT(build/include_order)
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_model_selection.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! log hyperparameters are restricted to ``[-kMaxAbsLogHyperparameter, kMaxAbsLogHyperparameter]``
+constexpr double kMaxAbsLogHyperparameter = 20.0;
+
+/*!\rst
+  Callable for SliceSamplingSweep(): unnormalized log posterior of the hyperparameters,
+  ``\log p(y | X, e^{\phi}) + \log p(\phi)``, as a function of the log hyperparameters ``\phi``.
+
+  Evaluations reuse ``log_likelihood_state`` (and ``hyperparameters``) as scratch space, so one functor (per thread)
+  can serve any number of chains.
+\endrst*/
+class LogHyperparameterPosterior final {
+ public:
+  LogHyperparameterPosterior(const LogMarginalLikelihoodEvaluator& log_likelihood_eval, const HyperparameterPrior& prior,
+                             LogMarginalLikelihoodState * log_likelihood_state, double * hyperparameters)
+      : log_likelihood_eval_(log_likelihood_eval), prior_(prior), log_likelihood_state_(log_likelihood_state),
+        hyperparameters_(hyperparameters) {
+  }
+
+  double operator()(double const * restrict log_hyperparameters) const {
+    const int num_hyperparameters = prior_.num_hyperparameters();
+    for (int i = 0; i < num_hyperparameters; ++i) {
+      if (std::fabs(log_hyperparameters[i]) > kMaxAbsLogHyperparameter) {
+        return -std::numeric_limits<double>::infinity();
+      }
+    }
+
+    const double log_prior = prior_.ComputeLogPrior(log_hyperparameters);
+    if (log_prior == -std::numeric_limits<double>::infinity()) {
+      return log_prior;
+    }
+
+    for (int i = 0; i < num_hyperparameters; ++i) {
+      hyperparameters_[i] = std::exp(log_hyperparameters[i]);
+    }
+    log_likelihood_state_->SetHyperparameters(log_likelihood_eval_, hyperparameters_);
+    const double log_likelihood = log_likelihood_eval_.ComputeLogLikelihood(*log_likelihood_state_);
+    // singular covariance matrices produce nan/inf; treat them as outside the support
+    if (unlikely(!std::isfinite(log_likelihood))) {
+      return -std::numeric_limits<double>::infinity();
+    }
+    return log_prior + log_likelihood;
+  }
+
+ private:
+  const LogMarginalLikelihoodEvaluator& log_likelihood_eval_;
+  const HyperparameterPrior& prior_;
+  LogMarginalLikelihoodState * log_likelihood_state_;
+  double * hyperparameters_;
+};
+
+}  // end unnamed namespace
+
+HyperparameterPrior::HyperparameterPrior(int num_covariance_hyperparameters, int num_noise, double amplitude_mean,
+                                         double amplitude_sigma, double length_scale_min, double length_scale_max,
+                                         double noise_scale)
+    : num_covariance_hyperparameters_(num_covariance_hyperparameters),
+      num_noise_(num_noise),
+      amplitude_mean_(amplitude_mean),
+      amplitude_sigma_(amplitude_sigma),
+      length_scale_min_(length_scale_min),
+      length_scale_max_(length_scale_max),
+      noise_scale_(noise_scale) {
+  if (unlikely(num_covariance_hyperparameters_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need the signal variance hyperparameter.", num_covariance_hyperparameters_, 1);
+  }
+  if (unlikely(!(length_scale_max_ > length_scale_min_))) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Upper bound of the length scale prior must exceed its lower bound.");
+  }
+  if (unlikely(amplitude_sigma_ <= 0.0 || noise_scale_ <= 0.0)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Prior scales must be positive.");
+  }
+}
+
+double HyperparameterPrior::ComputeLogPrior(double const * restrict log_hyperparameters) const noexcept {
+  // signal variance: normal
+  const double scaled_amplitude = (log_hyperparameters[0] - amplitude_mean_)/amplitude_sigma_;
+  double log_prior = -0.5*Square(scaled_amplitude);
+
+  // length scales: tophat
+  for (int i = 1; i < num_covariance_hyperparameters_; ++i) {
+    if (log_hyperparameters[i] < length_scale_min_ || log_hyperparameters[i] > length_scale_max_) {
+      return -std::numeric_limits<double>::infinity();
+    }
+  }
+
+  // noise variances: horseshoe
+  for (int i = num_covariance_hyperparameters_; i < num_covariance_hyperparameters_ + num_noise_; ++i) {
+    const double scaled_noise = noise_scale_*std::exp(-log_hyperparameters[i]);
+    log_prior += std::log(std::log1p(3.0*Square(scaled_noise)));
+  }
+  return log_prior;
+}
+
+void HyperparameterPrior::SampleFromPrior(UniformRandomGenerator * uniform_generator,
+                                          double * restrict log_hyperparameters) const {
+  boost::normal_distribution<double> normal_amplitude(amplitude_mean_, amplitude_sigma_);
+  log_hyperparameters[0] = normal_amplitude(uniform_generator->engine);
+
+  boost::uniform_real<double> uniform_double_length(length_scale_min_, length_scale_max_);
+  for (int i = 1; i < num_covariance_hyperparameters_; ++i) {
+    log_hyperparameters[i] = uniform_double_length(uniform_generator->engine);
+  }
+
+  // horseshoe: sigma_n^2 ~ N(0, (lambda * scale)^2) with local scale lambda ~ HalfCauchy(0, 1)
+  boost::random::cauchy_distribution<double> cauchy_local_scale(0.0, 1.0);
+  boost::normal_distribution<double> normal_unit(0.0, 1.0);
+  for (int i = num_covariance_hyperparameters_; i < num_covariance_hyperparameters_ + num_noise_; ++i) {
+    const double local_scale = std::fabs(cauchy_local_scale(uniform_generator->engine));
+    const double noise = std::fabs(normal_unit(uniform_generator->engine)*local_scale*noise_scale_);
+    // keep the draw strictly inside the sampler's box (and away from log(0))
+    log_hyperparameters[i] = std::max(-kMaxAbsLogHyperparameter,
+                                      std::min(kMaxAbsLogHyperparameter, std::log(noise)));
+  }
+}
+
+void SliceSampleHyperparameters(const LogMarginalLikelihoodEvaluator& log_likelihood_eval,
+                                const CovarianceInterface& covariance, const HyperparameterPrior& prior,
+                                const SliceSamplerParameters& sampler_parameters, int num_chains,
+                                bool sample_noise, bool initialize_from_prior, const ThreadSchedule& thread_schedule,
+                                UniformRandomGenerator * uniform_generator, double * restrict log_hyperparameters,
+                                double * restrict hypers_mcmc, double * restrict noises_mcmc) {
+  const int num_covariance_hyperparameters = covariance.GetNumberOfHyperparameters();
+  const int num_noise = log_likelihood_eval.num_derivatives() + 1;
+  const int num_hyperparameters = num_covariance_hyperparameters + num_noise;
+  if (unlikely(prior.num_hyperparameters() != num_hyperparameters)) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Prior and covariance + noise hyperparameter counts do not match.",
+                       prior.num_hyperparameters(), num_hyperparameters);
+  }
+  // noise variances sit at the end, so holding them fixed means sweeping over a prefix
+  const int num_sampled_coordinates = sample_noise ? num_hyperparameters : num_covariance_hyperparameters;
+
+  // initialization and per-chain seeds are drawn serially so results do not depend on the thread schedule
+  std::vector<double> prior_sample(num_hyperparameters);
+  std::vector<UniformRandomGenerator::EngineType::result_type> chain_seeds(num_chains);
+  for (int i = 0; i < num_chains; ++i) {
+    if (initialize_from_prior) {
+      prior.SampleFromPrior(uniform_generator, prior_sample.data());
+      std::copy(prior_sample.begin(), prior_sample.begin() + num_sampled_coordinates,
+                log_hyperparameters + i*num_hyperparameters);
+    }
+    chain_seeds[i] = uniform_generator->engine();
+  }
+
+  // we need 1 state object per thread; every chain on a thread reuses its buffers
+  std::vector<LogMarginalLikelihoodState> log_likelihood_state_vector;
+  SetupLogLikelihoodState(log_likelihood_eval, covariance, std::vector<double>(num_noise, 1.0),
+                          thread_schedule.max_num_threads, &log_likelihood_state_vector);
+
+  // see MultistartOptimizer<...>::MultistartOptimize() for why exceptions must be captured inside the parallel region
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+  omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
+#pragma omp parallel num_threads(thread_schedule.max_num_threads)
+  {
+    std::vector<double> hyperparameters_scratch(num_hyperparameters);
+    const int thread_id = omp_get_thread_num();
+    LogHyperparameterPosterior log_posterior(log_likelihood_eval, prior, log_likelihood_state_vector.data() + thread_id,
+                                             hyperparameters_scratch.data());
+
+#pragma omp for schedule(runtime)
+    for (int i = 0; i < num_chains; ++i) {
+      try {
+        double * chain_state = log_hyperparameters + i*num_hyperparameters;
+        UniformRandomGenerator chain_generator(chain_seeds[i]);
+
+        double log_posterior_value = log_posterior(chain_state);
+        if (unlikely(log_posterior_value == -std::numeric_limits<double>::infinity())) {
+          OL_THROW_EXCEPTION(OptimalLearningException, "MCMC chain starts outside the support of the posterior.");
+        }
+        const int num_total_sweeps = sampler_parameters.num_burnin_sweeps + sampler_parameters.num_sweeps;
+        for (int sweep = 0; sweep < num_total_sweeps; ++sweep) {
+          SliceSamplingSweep(log_posterior, sampler_parameters, num_sampled_coordinates, chain_state,
+                             &log_posterior_value, &chain_generator);
+        }
+      } catch (...) {
+        std::call_once(exception_capture_flag, [&captured_exception]() noexcept {
+          captured_exception = std::current_exception();
+        });
+      }
+    }
+  }  // end omp parallel
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+
+  for (int i = 0; i < num_chains; ++i) {
+    double const * chain_state = log_hyperparameters + i*num_hyperparameters;
+    for (int j = 0; j < num_covariance_hyperparameters; ++j) {
+      hypers_mcmc[i*num_covariance_hyperparameters + j] = std::exp(chain_state[j]);
+    }
+    for (int j = 0; j < num_noise; ++j) {
+      noises_mcmc[i*num_noise + j] = std::exp(chain_state[num_covariance_hyperparameters + j]);
+    }
+  }
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,309 @@
+/*!
+  \file gpp_hyperparameter_mcmc.hpp
+  \rst
+  1. OVERVIEW
+  2. PRIORS
+  3. SLICE SAMPLING
+  4. CITATIONS
+
+  **1. OVERVIEW**
+
+  The MCMC flavors of EI and KG (gpp_expected_improvement_mcmc_optimization.hpp, gpp_knowledge_gradient_mcmc_optimization.hpp)
+  integrate the acquisition function over the posterior of the GP hyperparameters instead of plugging in a single
+  (maximum likelihood) estimate.  They consume that posterior as a list of samples: GaussianProcessMCMC is built from
+  ``hypers_mcmc[num_mcmc][dim+1]`` (covariance hyperparameters) and ``noises_mcmc[num_mcmc][num_derivatives+1]``
+  (noise variances).
+
+  This file draws those samples natively: SliceSampleHyperparameters() runs ``num_chains`` independent slice sampling
+  chains over ``p(\theta | y, X) \propto p(y | X, \theta) p(\theta)``, where ``p(y | X, \theta)`` is the
+  log marginal likelihood of LogMarginalLikelihoodEvaluator and ``p(\theta)`` is a HyperparameterPrior.  Chains are
+  distributed over threads; each thread reuses a single LogMarginalLikelihoodState (covariance matrix, Cholesky factor,
+  etc.) for every evaluation of every chain it runs, so sampling allocates nothing after setup.
+
+  All sampling happens in (natural) log-hyperparameter space, ``\phi = \log(\theta)``; this makes the positivity
+  constraints implicit and the posterior much closer to unimodal/isotropic.  As in the Python sampler this replaces
+  (cpp_wrappers/log_likelihood_mcmc.py), each ``\phi_i`` is restricted to ``[-20, 20]`` to keep the covariance
+  matrices sane.
+
+  **2. PRIORS**
+
+  HyperparameterPrior mirrors ``DefaultPrior`` (python/default_priors.py), the spearmint-style prior used by the MCMC
+  endpoints, with one prior per hyperparameter group:
+
+  * signal variance (``\phi_0``): normal, ``N(amplitude_mean, amplitude_sigma^2)``
+  * length scales (``\phi_1, ..., \phi_{dim}``): tophat (uniform) over ``[length_scale_min, length_scale_max]``
+  * noise variances (the last ``num_noise`` entries): horseshoe with scale ``noise_scale``, which strongly favors small
+    noise but has heavy tails (Carvalho, Polson, Scott)
+
+  **3. SLICE SAMPLING**
+
+  Slice sampling (Neal) samples from a density ``f`` by alternately drawing a height ``y ~ U(0, f(x))`` and then a new
+  ``x`` uniformly from the "slice" ``{x : f(x) > y}``.  We update one coordinate at a time (a "sweep" updates every
+  coordinate once); the slice along a coordinate is found with Neal's "stepping out" procedure (grow an interval of
+  width ``step_width`` until both ends leave the slice, at most ``max_num_stepping_out`` times per side), after which
+  candidates are drawn from the interval, shrinking it toward the current point on each rejection.
+
+  Unlike Metropolis-Hastings, slice sampling never rejects a move.  It has no proposal scale to tune (a poor
+  ``step_width`` only costs extra likelihood evaluations), and it needs no gradients.  A sweep typically costs ``5-10``
+  log likelihood evaluations per hyperparameter.
+
+  Chains are independent: each is seeded from the caller's UniformRandomGenerator before any thread starts, so results
+  do not depend on the number of threads or the thread schedule.
+
+  **4. CITATIONS**
+
+  a. Slice Sampling. Radford M. Neal. The Annals of Statistics, 31(3):705-767, 2003.
+  b. Practical Bayesian Optimization of Machine Learning Algorithms. Jasper Snoek, Hugo Larochelle, Ryan P. Adams.
+     Advances in Neural Information Processing Systems 25, 2012.
+  c. The horseshoe estimator for sparse signals. Carlos M. Carvalho, Nicholas G. Polson, James G. Scott.
+     Biometrika, 97(2):465-480, 2010.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_HPP_
+
+#include <cmath>
+
+#include <limits>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_model_selection.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Container to hold parameters that specify the behavior of the hyperparameter slice sampler.
+
+  **Iterations**
+
+  Each chain performs ``num_burnin_sweeps`` sweeps (discarded) followed by ``num_sweeps`` more sweeps; the state after
+  the last sweep is the chain's sample.  A sweep is one slice sampling update of every sampled coordinate.
+
+  **Step control**
+
+  ``step_width`` is the initial width of the interval bracketing the slice, in log-hyperparameter units; ``1.0``
+  (a factor of ``e``) suits the usual hyperparameter posteriors.  The interval is grown by at most
+  ``max_num_stepping_out`` widths per side, so the sampler can move at most about
+  ``max_num_stepping_out * step_width`` per coordinate update.
+\endrst*/
+struct SliceSamplerParameters {
+  // Users must set parameters explicitly.
+  SliceSamplerParameters() = delete;
+
+  /*!\rst
+    Construct a SliceSamplerParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  SliceSamplerParameters(int num_burnin_sweeps_in, int num_sweeps_in, double step_width_in, int max_num_stepping_out_in)
+      : num_burnin_sweeps(num_burnin_sweeps_in),
+        num_sweeps(num_sweeps_in),
+        step_width(step_width_in),
+        max_num_stepping_out(max_num_stepping_out_in) {
+  }
+
+  SliceSamplerParameters(SliceSamplerParameters&& OL_UNUSED(other)) = default;
+
+  // iteration control
+  //! number of sweeps to discard before sampling (suggest: a few hundred on the first call, 0 when warm-starting)
+  int num_burnin_sweeps;
+  //! number of sweeps after burn-in; the last one produces the sample (suggest: 10-50)
+  int num_sweeps;
+
+  // step control
+  //! initial width of the slice bracketing interval, in log-hyperparameter units (suggest: 1.0)
+  double step_width;
+  //! maximum number of times the bracket is grown on each side (suggest: 10-50)
+  int max_num_stepping_out;
+};
+
+/*!\rst
+  Prior over (natural) log hyperparameters ``[\phi_{\alpha}, \phi_{L_1}, ..., \phi_{L_d}, \phi_{n_0}, ..., \phi_{n_k}]``,
+  mirroring ``DefaultPrior`` in python/default_priors.py.  See the file comments for the prior on each group.
+
+  The horseshoe density has no closed form; we use (as spearmint does) the tight bound
+  ``\log(\log(1 + 3 (scale/\sigma_n^2)^2))``, evaluated on the noise variance ``\sigma_n^2 = e^{\phi}``.
+  Log densities are up to an additive constant, which slice sampling does not need.
+\endrst*/
+class HyperparameterPrior final {
+ public:
+  /*!\rst
+    Constructs a HyperparameterPrior over ``num_covariance_hyperparameters + num_noise`` log hyperparameters.
+
+    \param
+      :num_covariance_hyperparameters: number of covariance hyperparameters (signal variance + length scales)
+      :num_noise: number of noise variances (num_derivatives + 1)
+      :amplitude_mean: mean of the normal prior on the log signal variance
+      :amplitude_sigma: standard deviation of the normal prior on the log signal variance
+      :length_scale_min: lower bound of the tophat prior on the log length scales
+      :length_scale_max: upper bound of the tophat prior on the log length scales
+      :noise_scale: scale of the horseshoe prior on the noise variances
+  \endrst*/
+  HyperparameterPrior(int num_covariance_hyperparameters, int num_noise, double amplitude_mean, double amplitude_sigma,
+                      double length_scale_min, double length_scale_max, double noise_scale);
+
+  int num_hyperparameters() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_covariance_hyperparameters_ + num_noise_;
+  }
+
+  /*!\rst
+    Computes the log prior density (up to an additive constant) of a point in log-hyperparameter space.
+
+    \param
+      :log_hyperparameters[num_hyperparameters]: natural log of the hyperparameters (covariance, then noise)
+    \return
+      log prior density; ``-infinity`` outside the prior's support
+  \endrst*/
+  double ComputeLogPrior(double const * restrict log_hyperparameters) const noexcept OL_PURE_FUNCTION OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Draws one point (in log-hyperparameter space) from the prior.
+
+    \param
+      :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+    \output
+      :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+      :log_hyperparameters[num_hyperparameters]: a sample from the prior
+  \endrst*/
+  void SampleFromPrior(UniformRandomGenerator * uniform_generator,
+                       double * restrict log_hyperparameters) const OL_NONNULL_POINTERS;
+
+ private:
+  //! number of covariance hyperparameters (signal variance + length scales)
+  int num_covariance_hyperparameters_;
+  //! number of noise variances
+  int num_noise_;
+  //! mean and standard deviation of the normal prior on the log signal variance
+  double amplitude_mean_;
+  double amplitude_sigma_;
+  //! support of the tophat prior on the log length scales
+  double length_scale_min_;
+  double length_scale_max_;
+  //! scale of the horseshoe prior on the noise variances
+  double noise_scale_;
+};
+
+/*!\rst
+  Performs one slice sampling sweep: updates coordinates ``0, ..., num_coordinates-1`` of ``point`` in turn, each with
+  a univariate slice sampling step (stepping out + shrinkage; Neal 2003, Figures 3 and 5).  Coordinates past
+  ``num_coordinates`` are held fixed.
+
+  ``log_density`` is any callable with signature ``double (double const * point)``, returning the log of an
+  unnormalized density at point (``-infinity`` outside its support).
+
+  \param
+    :log_density: callable evaluating the log of the target density
+    :sampler_parameters: SliceSamplerParameters object; only step_width and max_num_stepping_out are used
+    :num_coordinates: number of (leading) coordinates of point to update
+    :point[num_coordinates]: current state of the chain
+    :log_density_value[1]: ``log_density(point)``
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :point[num_coordinates]: new state of the chain
+    :log_density_value[1]: ``log_density(point)`` at the new state
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+\endrst*/
+template <typename LogDensity>
+OL_NONNULL_POINTERS void SliceSamplingSweep(const LogDensity& log_density, const SliceSamplerParameters& sampler_parameters,
+                                            int num_coordinates, double * restrict point, double * restrict log_density_value,
+                                            UniformRandomGenerator * uniform_generator) {
+  // guards the shrinkage loop against a current point that is not (numerically) inside its own slice
+  const int kMaxNumShrinkageSteps = 200;
+  boost::uniform_real<double> uniform_double_unit(0.0, 1.0);
+  const double width = sampler_parameters.step_width;
+
+  for (int i = 0; i < num_coordinates; ++i) {
+    const double x0 = point[i];
+    // slice height, in log space: log(U * f(x0)) = log(f(x0)) - Exp(1)
+    const double log_height = *log_density_value + std::log(uniform_double_unit(uniform_generator->engine));
+
+    // randomly position the initial interval around x0, then step out until both ends leave the slice
+    double left = x0 - width*uniform_double_unit(uniform_generator->engine);
+    double right = left + width;
+    int num_left = static_cast<int>(sampler_parameters.max_num_stepping_out*uniform_double_unit(uniform_generator->engine));
+    int num_right = sampler_parameters.max_num_stepping_out - 1 - num_left;
+    point[i] = left;
+    while (num_left > 0 && log_density(point) > log_height) {
+      left -= width;
+      point[i] = left;
+      --num_left;
+    }
+    point[i] = right;
+    while (num_right > 0 && log_density(point) > log_height) {
+      right += width;
+      point[i] = right;
+      --num_right;
+    }
+
+    // draw from the interval, shrinking it toward x0 on each rejection
+    point[i] = x0;
+    for (int step = 0; step < kMaxNumShrinkageSteps; ++step) {
+      const double x1 = left + (right - left)*uniform_double_unit(uniform_generator->engine);
+      point[i] = x1;
+      const double log_density_x1 = log_density(point);
+      if (log_density_x1 > log_height) {
+        *log_density_value = log_density_x1;
+        break;
+      }
+      point[i] = x0;
+      if (x1 < x0) {
+        left = x1;
+      } else {
+        right = x1;
+      }
+    }
+  }
+}
+
+/*!\rst
+  Draws ``num_chains`` samples from the posterior of the hyperparameters (covariance + noise) given the data in
+  ``log_likelihood_eval``: runs ``num_chains`` independent slice sampling chains (see file comments) and returns the
+  final state of each.  Chains are split over ``thread_schedule.max_num_threads`` threads.
+
+  ``log_hyperparameters`` carries the chains' states in and out, so a later call (e.g., after new points are sampled)
+  can warm-start from the previous states with ``num_burnin_sweeps = 0``.  With ``initialize_from_prior``, the
+  sampled coordinates are instead initialized by draws from ``prior``.
+
+  Outputs are laid out as GaussianProcessMCMC (gpp_knowledge_gradient_mcmc_optimization.hpp) consumes them.
+
+  Let ``n_cov = covariance.GetNumberOfHyperparameters()`` and ``n_hyper = n_cov + num_derivatives + 1``.
+
+  \param
+    :log_likelihood_eval: LogMarginalLikelihoodEvaluator holding the training data
+    :covariance: covariance class whose hyperparameters are sampled (the current values are ignored)
+    :prior: prior over the n_hyper log hyperparameters
+    :sampler_parameters: SliceSamplerParameters object describing burn-in, chain length, and slice step control
+    :num_chains: number of independent chains (and output samples)
+    :sample_noise: true to sample the noise variances; false holds them at their input values
+    :initialize_from_prior: true to initialize the sampled coordinates of every chain from the prior
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+    :log_hyperparameters[num_chains][n_hyper]: initial state of each chain (natural log hyperparameters); the noise
+      entries must be set when ``sample_noise`` is false, all entries must be set unless ``initialize_from_prior``
+  \output
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :log_hyperparameters[num_chains][n_hyper]: final state of each chain
+    :hypers_mcmc[num_chains][n_cov]: covariance hyperparameters of each sample
+    :noises_mcmc[num_chains][num_derivatives+1]: noise variances of each sample
+  \raise
+    InvalidValueException<int> if ``prior.num_hyperparameters() != n_hyper``;
+    OptimalLearningException if a chain starts at a point with zero posterior density.
+    Exceptions thrown from the parallel region are captured and rethrown (as in MultistartOptimizer<...>::MultistartOptimize()).
+\endrst*/
+void SliceSampleHyperparameters(const LogMarginalLikelihoodEvaluator& log_likelihood_eval,
+                                const CovarianceInterface& covariance, const HyperparameterPrior& prior,
+                                const SliceSamplerParameters& sampler_parameters, int num_chains,
+                                bool sample_noise, bool initialize_from_prior, const ThreadSchedule& thread_schedule,
+                                UniformRandomGenerator * uniform_generator, double * restrict log_hyperparameters,
+                                double * restrict hypers_mcmc, double * restrict noises_mcmc) OL_NONNULL_POINTERS;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_HPP_
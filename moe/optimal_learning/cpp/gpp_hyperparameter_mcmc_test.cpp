@@ -0,0 +1,316 @@
+/*!
+  \file gpp_hyperparameter_mcmc_test.cpp
+  \rst
+  Routines to test the functions in gpp_hyperparameter_mcmc.cpp.
+
+  SliceSamplingSweep() is checked on densities with known moments: a product of normals (sample mean and variance)
+  and a tophat (samples never leave the support).
+
+  SliceSampleHyperparameters() is checked on GP data drawn from a known prior (MockGaussianProcessPriorData):
+
+  * samples lie in the prior's support and hypers/noises outputs are ``exp()`` of the chain states,
+  * single and multi-threaded runs produce identical chains,
+  * chains move toward higher posterior density than their prior initialization,
+  * warm starts continue the chains and ``sample_noise = false`` leaves the noise untouched.
+\endrst*/
+
+#include "gpp_hyperparameter_mcmc_test.hpp"
+
+#include <cmath>
+
+#include <limits>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_hyperparameter_mcmc.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_model_selection.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Draws a long chain from a product of independent normals, ``N(1, 0.5^2) x N(-2, 2^2)``, and checks the sample means
+  and variances.  The slice sampler on a normal is nearly independent from sweep to sweep, so the tolerances sit at
+  several standard errors.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SliceSamplingNormalTest() {
+  const int num_sweeps = 20000;
+  const std::vector<double> mean = {1.0, -2.0};
+  const std::vector<double> sigma = {0.5, 2.0};
+  const int num_coordinates = mean.size();
+  SliceSamplerParameters sampler_parameters(0, num_sweeps, 1.0, 20);
+
+  auto log_density = [&mean, &sigma, num_coordinates](double const * point) {
+    double value = 0.0;
+    for (int i = 0; i < num_coordinates; ++i) {
+      value -= 0.5*Square((point[i] - mean[i])/sigma[i]);
+    }
+    return value;
+  };
+
+  UniformRandomGenerator uniform_generator(1781);
+  std::vector<double> point(num_coordinates, 0.0);
+  double log_density_value = log_density(point.data());
+  std::vector<double> sum(num_coordinates, 0.0);
+  std::vector<double> sum_squares(num_coordinates, 0.0);
+  for (int sweep = 0; sweep < num_sweeps; ++sweep) {
+    SliceSamplingSweep(log_density, sampler_parameters, num_coordinates, point.data(), &log_density_value,
+                       &uniform_generator);
+    for (int i = 0; i < num_coordinates; ++i) {
+      sum[i] += point[i];
+      sum_squares[i] += Square(point[i]);
+    }
+  }
+
+  int total_errors = 0;
+  if (!CheckDoubleWithin(log_density_value, log_density(point.data()), 0.0)) {
+    ++total_errors;
+  }
+  for (int i = 0; i < num_coordinates; ++i) {
+    const double sample_mean = sum[i]/static_cast<double>(num_sweeps);
+    const double sample_variance = sum_squares[i]/static_cast<double>(num_sweeps) - Square(sample_mean);
+    if (!CheckDoubleWithin(sample_mean, mean[i], 0.05*sigma[i])) {
+      ++total_errors;
+    }
+    if (!CheckDoubleWithinRelative(sample_variance, Square(sigma[i]), 0.05)) {
+      ++total_errors;
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("slice sampling a product of normals failed with %d errors\n", total_errors);
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Draws a chain from the uniform density on ``[0, 1]`` (a density with hard walls) and checks that no sample leaves the
+  support and that the sample mean is near ``1/2``.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SliceSamplingTophatTest() {
+  const int num_sweeps = 10000;
+  SliceSamplerParameters sampler_parameters(0, num_sweeps, 0.3, 10);
+
+  auto log_density = [](double const * point) {
+    return (point[0] < 0.0 || point[0] > 1.0) ? -std::numeric_limits<double>::infinity() : 0.0;
+  };
+
+  UniformRandomGenerator uniform_generator(2718);
+  double point = 0.25;
+  double log_density_value = log_density(&point);
+  double sum = 0.0;
+  int total_errors = 0;
+  for (int sweep = 0; sweep < num_sweeps; ++sweep) {
+    SliceSamplingSweep(log_density, sampler_parameters, 1, &point, &log_density_value, &uniform_generator);
+    if (point < 0.0 || point > 1.0) {
+      ++total_errors;
+    }
+    sum += point;
+  }
+  if (!CheckDoubleWithin(sum/static_cast<double>(num_sweeps), 0.5, 0.02)) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("slice sampling a tophat failed with %d errors\n", total_errors);
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Samples hyperparameters of a squared exponential GP (with one gradient observation per point) and checks the
+  properties listed in the file comments.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SliceSampleHyperparametersTest() {
+  const int dim = 2;
+  const int num_sampled = 15;
+  std::vector<int> derivatives = {0};
+  const int num_derivatives = derivatives.size();
+  const int num_noise = num_derivatives + 1;
+
+  UniformRandomGenerator uniform_generator(4111);
+  boost::uniform_real<double> uniform_double_hyperparameter(0.5, 1.5);
+  boost::uniform_real<double> uniform_double_lower_bound(-2.0, 0.5);
+  boost::uniform_real<double> uniform_double_upper_bound(2.0, 3.5);
+  MockGaussianProcessPriorData<TensorProductDomain> mock_gp_data(SquareExponential(dim, 1.0, 1.0), derivatives,
+                                                                 num_derivatives, dim, num_sampled,
+                                                                 uniform_double_lower_bound, uniform_double_upper_bound,
+                                                                 uniform_double_hyperparameter, &uniform_generator);
+  LogMarginalLikelihoodEvaluator log_likelihood_eval(mock_gp_data.gaussian_process_ptr->points_sampled().data(),
+                                                     mock_gp_data.gaussian_process_ptr->points_sampled_value().data(),
+                                                     derivatives.data(), num_derivatives, dim, num_sampled);
+
+  const int num_covariance_hyperparameters = mock_gp_data.covariance_ptr->GetNumberOfHyperparameters();
+  const int num_hyperparameters = num_covariance_hyperparameters + num_noise;
+  // the defaults of python/default_priors.py
+  HyperparameterPrior prior(num_covariance_hyperparameters, num_noise, 0.0, 1.0, -2.0, 3.0, 0.1);
+
+  const int num_chains = 8;
+  const int max_num_threads = 4;
+  SliceSamplerParameters sampler_parameters(20, 5, 1.0, 20);
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+  ThreadSchedule single_thread_schedule(1, omp_sched_static);
+
+  std::vector<double> log_hyperparameters(num_chains*num_hyperparameters, 0.0);
+  std::vector<double> hypers_mcmc(num_chains*num_covariance_hyperparameters);
+  std::vector<double> noises_mcmc(num_chains*num_noise);
+
+  // log posterior of a chain state, computed independently of the sampler
+  LogMarginalLikelihoodState log_likelihood_state(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance);
+  std::vector<double> hyperparameters(num_hyperparameters);
+  auto log_posterior = [&](double const * log_hyperparameters_chain) {
+    for (int j = 0; j < num_hyperparameters; ++j) {
+      hyperparameters[j] = std::exp(log_hyperparameters_chain[j]);
+    }
+    log_likelihood_state.SetHyperparameters(log_likelihood_eval, hyperparameters.data());
+    return log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state) + prior.ComputeLogPrior(log_hyperparameters_chain);
+  };
+
+  int total_errors = 0;
+  int current_errors = 0;
+
+  // mean log posterior at the prior draws, from a generator matched to the sampler's (same prior draws)
+  double initial_log_posterior = 0.0;
+  {
+    UniformRandomGenerator uniform_generator_copy(uniform_generator);
+    std::vector<double> prior_sample(num_hyperparameters);
+    for (int i = 0; i < num_chains; ++i) {
+      prior.SampleFromPrior(&uniform_generator_copy, prior_sample.data());
+      initial_log_posterior += log_posterior(prior_sample.data())/static_cast<double>(num_chains);
+      uniform_generator_copy.engine();  // the sampler draws a chain seed after each prior sample
+    }
+  }
+
+  UniformRandomGenerator uniform_generator_single_thread(uniform_generator);
+  SliceSampleHyperparameters(log_likelihood_eval, *mock_gp_data.covariance_ptr, prior, sampler_parameters, num_chains,
+                             true, true, thread_schedule, &uniform_generator, log_hyperparameters.data(),
+                             hypers_mcmc.data(), noises_mcmc.data());
+
+  // support and output layout
+  current_errors = 0;
+  double final_log_posterior = 0.0;
+  for (int i = 0; i < num_chains; ++i) {
+    double const * chain_state = log_hyperparameters.data() + i*num_hyperparameters;
+    const double log_posterior_value = log_posterior(chain_state);
+    if (!std::isfinite(log_posterior_value)) {
+      ++current_errors;
+    }
+    final_log_posterior += log_posterior_value/static_cast<double>(num_chains);
+    for (int j = 0; j < num_covariance_hyperparameters; ++j) {
+      if (!CheckDoubleWithin(hypers_mcmc[i*num_covariance_hyperparameters + j], std::exp(chain_state[j]), 0.0)) {
+        ++current_errors;
+      }
+    }
+    for (int j = 0; j < num_noise; ++j) {
+      if (!CheckDoubleWithin(noises_mcmc[i*num_noise + j], std::exp(chain_state[num_covariance_hyperparameters + j]), 0.0)) {
+        ++current_errors;
+      }
+    }
+  }
+  if (final_log_posterior <= initial_log_posterior) {
+    ++current_errors;
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter samples are invalid (mean log posterior %.18E -> %.18E)\n",
+                              initial_log_posterior, final_log_posterior);
+  }
+  total_errors += current_errors;
+
+  // multithreaded & single threaded give the same chains
+  current_errors = 0;
+  {
+    std::vector<double> log_hyperparameters_single_thread(num_chains*num_hyperparameters, 0.0);
+    std::vector<double> hypers_mcmc_single_thread(num_chains*num_covariance_hyperparameters);
+    std::vector<double> noises_mcmc_single_thread(num_chains*num_noise);
+    SliceSampleHyperparameters(log_likelihood_eval, *mock_gp_data.covariance_ptr, prior, sampler_parameters, num_chains,
+                               true, true, single_thread_schedule, &uniform_generator_single_thread,
+                               log_hyperparameters_single_thread.data(), hypers_mcmc_single_thread.data(),
+                               noises_mcmc_single_thread.data());
+    for (int i = 0; i < num_chains*num_hyperparameters; ++i) {
+      if (!CheckDoubleWithin(log_hyperparameters[i], log_hyperparameters_single_thread[i], 0.0)) {
+        ++current_errors;
+      }
+    }
+    if (uniform_generator != uniform_generator_single_thread) {
+      ++current_errors;
+    }
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("single and multithreaded hyperparameter sampling differ\n");
+  }
+  total_errors += current_errors;
+
+  // warm start without burn-in, holding the noise fixed: chains move, noise does not
+  current_errors = 0;
+  {
+    std::vector<double> log_hyperparameters_warm(log_hyperparameters);
+    SliceSamplerParameters warm_sampler_parameters(0, 3, 1.0, 20);
+    SliceSampleHyperparameters(log_likelihood_eval, *mock_gp_data.covariance_ptr, prior, warm_sampler_parameters,
+                               num_chains, false, false, thread_schedule, &uniform_generator,
+                               log_hyperparameters_warm.data(), hypers_mcmc.data(), noises_mcmc.data());
+    int num_moved = 0;
+    for (int i = 0; i < num_chains; ++i) {
+      for (int j = 0; j < num_hyperparameters; ++j) {
+        const int index = i*num_hyperparameters + j;
+        if (j < num_covariance_hyperparameters) {
+          num_moved += log_hyperparameters_warm[index] != log_hyperparameters[index];
+        } else if (!CheckDoubleWithin(log_hyperparameters_warm[index], log_hyperparameters[index], 0.0)) {
+          ++current_errors;
+        }
+      }
+    }
+    if (num_moved == 0) {
+      ++current_errors;
+    }
+  }
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("warm-started hyperparameter sampling with fixed noise failed\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunHyperparameterMCMCTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = SliceSamplingNormalTest();
+  total_errors += current_errors;
+
+  current_errors = SliceSamplingTophatTest();
+  total_errors += current_errors;
+
+  current_errors = SliceSampleHyperparametersTest();
+  total_errors += current_errors;
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter MCMC tests failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("hyperparameter MCMC tests passed\n");
+  }
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,26 @@
+/*!
+  \file gpp_hyperparameter_mcmc_test.hpp
+  \rst
+  Functions for testing gpp_hyperparameter_mcmc's functionality: the slice sampling sweep (against densities with
+  known moments) and the multithreaded hyperparameter sampler SliceSampleHyperparameters() (output layout, support,
+  determinism across thread counts, warm starts, and fixed noise).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the slice sampler unit tests and the hyperparameter sampling integration tests.
+
+  \return
+    number of test failures: 0 if hyperparameter sampling is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunHyperparameterMCMCTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_HYPERPARAMETER_MCMC_TEST_HPP_
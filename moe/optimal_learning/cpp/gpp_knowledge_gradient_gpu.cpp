@@ -0,0 +1,101 @@
+/*!
+  \file gpp_knowledge_gradient_gpu.cpp
+  \rst
+  Host side of the KG device paths; see gpp_knowledge_gradient_gpu.hpp.
+\endrst*/
+
+#include "gpp_knowledge_gradient_gpu.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gpp_common.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_expected_improvement_gpu.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Derives a seed from the next draw of ``normal_rng`` and then rewinds it, so a state's host draws are unaffected.
+\endrst*/
+uint64_t DrawDeviceSeed(NormalRNGInterface * normal_rng) {
+  double draw = (*normal_rng)();
+  normal_rng->ResetToMostRecentSeed();
+  uint64_t seed;
+  std::memcpy(&seed, &draw, sizeof(seed));
+  return seed;
+}
+
+}  // end unnamed namespace
+
+CudaKnowledgeGradientWorkspace::CudaKnowledgeGradientWorkspace(int which_gpu_in, NormalRNGInterface * normal_rng)
+    : which_gpu(which_gpu_in),
+      seed(0),
+      gpu_normals(0),
+      gpu_chol_inverse_cov(0),
+      gpu_discrete_mean(0),
+      gpu_best_value(0),
+      gpu_winner(0) {
+  if (enabled()) {
+    CudaSelectDevice(which_gpu);
+  }
+  Reseed(normal_rng);
+}
+
+void CudaKnowledgeGradientWorkspace::Reseed(NormalRNGInterface * normal_rng) {
+  if (enabled()) {
+    seed = DrawDeviceSeed(normal_rng);
+  }
+}
+
+#ifdef OL_GPU_ENABLED
+
+void CudaDrawKnowledgeGradientNormals(int num_normals, int num_mc, CudaKnowledgeGradientWorkspace * workspace,
+                                      double * restrict normals) {
+  OL_CUDA_ERROR_THROW(CudaSetDevice(workspace->which_gpu));
+  workspace->gpu_normals.Reserve(num_normals*num_mc);
+  OL_CUDA_ERROR_THROW(CudaGetKnowledgeGradientNormals(num_normals, num_mc, workspace->seed,
+                                                      workspace->gpu_normals.ptr(), normals));
+}
+
+void CudaComputeDiscreteFutureMeanWinners(double const * restrict chol_inverse_cov,
+                                          double const * restrict discrete_mean, int num_normals, int num_discrete,
+                                          int num_mc, CudaKnowledgeGradientWorkspace * workspace,
+                                          double * restrict best_value, int * restrict winner) {
+  OL_CUDA_ERROR_THROW(CudaSetDevice(workspace->which_gpu));
+  workspace->gpu_chol_inverse_cov.Reserve(num_normals*num_discrete);
+  workspace->gpu_discrete_mean.Reserve(num_discrete);
+  workspace->gpu_best_value.Reserve(num_mc);
+  workspace->gpu_winner.Reserve(num_mc);
+  OL_CUDA_ERROR_THROW(CudaGetDiscreteFutureMeanWinners(chol_inverse_cov, discrete_mean, num_normals, num_discrete,
+                                                       num_mc, workspace->gpu_normals.ptr(),
+                                                       workspace->gpu_chol_inverse_cov.ptr(),
+                                                       workspace->gpu_discrete_mean.ptr(),
+                                                       workspace->gpu_best_value.ptr(), workspace->gpu_winner.ptr(),
+                                                       best_value, winner));
+}
+
+#else
+
+void CudaDrawKnowledgeGradientNormals(int OL_UNUSED(num_normals), int OL_UNUSED(num_mc),
+                                      CudaKnowledgeGradientWorkspace * OL_UNUSED(workspace),
+                                      double * restrict OL_UNUSED(normals)) {
+  OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+}
+
+void CudaComputeDiscreteFutureMeanWinners(double const * restrict OL_UNUSED(chol_inverse_cov),
+                                          double const * restrict OL_UNUSED(discrete_mean),
+                                          int OL_UNUSED(num_normals), int OL_UNUSED(num_discrete),
+                                          int OL_UNUSED(num_mc),
+                                          CudaKnowledgeGradientWorkspace * OL_UNUSED(workspace),
+                                          double * restrict OL_UNUSED(best_value),
+                                          int * restrict OL_UNUSED(winner)) {
+  OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
+}
+
+#endif
+
+}  // end namespace optimal_learning
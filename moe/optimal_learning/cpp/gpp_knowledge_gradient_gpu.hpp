@@ -0,0 +1,110 @@
+/*!
+  \file gpp_knowledge_gradient_gpu.hpp
+  \rst
+  Device paths for the parts of KnowledgeGradientEvaluator (gpp_knowledge_gradient_optimization.hpp) that are batched
+  over the monte-carlo iterations: drawing every iteration's normals, and the discrete inner step (one product of
+  ``(L^{-1} \Sigma_n(U, D))^T`` against all of the normals, then each iteration's minimum over ``D``). The inner
+  gradient descent, the GP quantities, and the gradient of KG stay on the host.
+
+  A KnowledgeGradientEvaluator built with ``which_gpu >= 0`` makes each of its states hold a
+  CudaKnowledgeGradientWorkspace; see KnowledgeGradientEvaluator for how the device is used.
+
+  The device normals are keyed by the workspace's ``seed`` (fixed for the life of the state, like the CPU path's
+  ResetToMostRecentSeed()), so every evaluation of a state sees the same draws (common random numbers). They are
+  NOT the draws the state's NormalRNG would produce: device and host KG agree in distribution, not bitwise.
+
+  Without ``OL_GPU_ENABLED``, constructing a workspace for a device throws OptimalLearningException.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_KNOWLEDGE_GRADIENT_GPU_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_KNOWLEDGE_GRADIENT_GPU_HPP_
+
+#include <cstdint>
+
+#include "gpp_common.hpp"
+#include "gpp_expected_improvement_gpu.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Device buffers (grown on demand, never shrunk) and the normals' seed of one KnowledgeGradientState.
+  With ``which_gpu == kNoGpu`` the workspace is inert: it allocates nothing and must not be passed to the functions below.
+\endrst*/
+struct CudaKnowledgeGradientWorkspace final {
+  /*!\rst
+    \param
+      :which_gpu_in: device ID, or kNoGpu
+      :normal_rng[1]: source of the seed (ignored for kNoGpu); its state is restored by ResetToMostRecentSeed()
+    \raise
+      see CudaSelectDevice() (only if ``which_gpu_in != kNoGpu``)
+  \endrst*/
+  CudaKnowledgeGradientWorkspace(int which_gpu_in, NormalRNGInterface * normal_rng);
+
+  CudaKnowledgeGradientWorkspace(CudaKnowledgeGradientWorkspace&& other) = default;
+
+  /*!\rst
+    Draws a new ``seed`` from ``normal_rng`` (no-op if not enabled); ``normal_rng`` is then ResetToMostRecentSeed().
+  \endrst*/
+  void Reseed(NormalRNGInterface * normal_rng);
+
+  bool enabled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return which_gpu != kNoGpu;
+  }
+
+  //! device ID (made current before every device call, so any host thread may use the workspace)
+  const int which_gpu;
+  //! seed of the device normals
+  uint64_t seed;
+
+  //! ``gpu_normals[num_normals][num_mc]``
+  CudaDevicePointer<double> gpu_normals;
+  //! ``gpu_chol_inverse_cov[num_normals][num_discrete]``
+  CudaDevicePointer<double> gpu_chol_inverse_cov;
+  //! ``gpu_discrete_mean[num_discrete]``
+  CudaDevicePointer<double> gpu_discrete_mean;
+  //! ``gpu_best_value[num_mc]``
+  CudaDevicePointer<double> gpu_best_value;
+  //! ``gpu_winner[num_mc]``
+  CudaDevicePointer<int> gpu_winner;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(CudaKnowledgeGradientWorkspace);
+};
+
+/*!\rst
+  Draws the normals for all ``num_mc`` iterations on the device, in antithetic pairs (odd iterations negate the
+  preceding draw, as on the host); they stay on the device for CudaComputeDiscreteFutureMeanWinners().
+
+  \param
+    :num_normals: normals per iteration
+    :num_mc: number of monte-carlo iterations
+    :workspace[1]: enabled workspace
+  \output
+    :workspace[1]: ``gpu_normals`` holds the draws
+    :normals[num_normals][num_mc]: copy of the draws
+\endrst*/
+void CudaDrawKnowledgeGradientNormals(int num_normals, int num_mc, CudaKnowledgeGradientWorkspace * workspace,
+                                      double * restrict normals) OL_NONNULL_POINTERS;
+
+/*!\rst
+  Device version of the last step of KnowledgeGradientEvaluator::ComputeDiscreteOptimalFuturePosteriorMeans(): the
+  future posterior mean of every iteration on the discrete set and its minimum. Uses the normals of the latest
+  CudaDrawKnowledgeGradientNormals() call.
+
+  \param
+    :chol_inverse_cov[num_normals][num_discrete]: ``L^{-1} \Sigma_n(U, D)``
+    :discrete_mean[num_discrete]: ``\mu_n(D)``
+    :num_normals, num_discrete, num_mc: sizes
+    :workspace[1]: enabled workspace
+  \output
+    :best_value[num_mc]: negated minimum future posterior mean of each iteration
+    :winner[num_mc]: index of the minimizing discrete point (lowest index on ties)
+\endrst*/
+void CudaComputeDiscreteFutureMeanWinners(double const * restrict chol_inverse_cov,
+                                          double const * restrict discrete_mean, int num_normals, int num_discrete,
+                                          int num_mc, CudaKnowledgeGradientWorkspace * workspace,
+                                          double * restrict best_value, int * restrict winner) OL_NONNULL_POINTERS;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_KNOWLEDGE_GRADIENT_GPU_HPP_
@@ -17,6 +17,7 @@
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 
 namespace optimal_learning {
 
@@ -90,6 +91,17 @@ void FuturePosteriorMeanEvaluator::ComputeGradPosteriorMean(
   }
 }
 
+void FuturePosteriorMeanEvaluator::ComputeGradObjectiveFunctionBatch(StateType * const * ps_states, int num_states,
+                                                                     double const * restrict points_to_sample,
+                                                                     double * restrict grad_PS) const {
+  for (int k = 0; k < num_states; ++k) {
+    ps_states[k]->SetCurrentPoint(*this, points_to_sample);
+    ComputeGradPosteriorMean(ps_states[k], grad_PS);
+    points_to_sample += ps_states[k]->GetProblemSize();
+    grad_PS += ps_states[k]->GetProblemSize();
+  }
+}
+
 void FuturePosteriorMeanState::Initialize(const EvaluatorType& ps_evaluator) {
   optimal_learning::BuildMixCovarianceMatrix(*(ps_evaluator.gaussian_process()->covariance_ptr_), point_to_sample.data(),
                                              ps_evaluator.gaussian_process()->points_sampled().data(), dim, 1,
@@ -98,7 +110,7 @@ void FuturePosteriorMeanState::Initialize(const EvaluatorType& ps_evaluator) {
                                              ps_evaluator.gaussian_process()->num_derivatives(), K_star.data());
   if (num_derivatives > 0) {
     double * restrict gKs_temp = grad_K_star.data();
-    double * restrict grad_cov_temp = new double[dim*(ps_evaluator.gaussian_process()->num_derivatives()+1)]();
+    double * restrict grad_cov_temp = grad_cov.data();
     for (int j = 0; j < ps_evaluator.gaussian_process()->num_sampled(); ++j) {
       ps_evaluator.gaussian_process()->covariance_ptr_->GradCovariance(point_to_sample.data(), nullptr, 0,
                                                                        ps_evaluator.gaussian_process()->points_sampled().data() + j*dim,
@@ -111,15 +123,14 @@ void FuturePosteriorMeanState::Initialize(const EvaluatorType& ps_evaluator) {
         }
       }
     }
-    delete [] grad_cov_temp;
   }
 }
 
 void FuturePosteriorMeanState::SetCurrentPoint(const EvaluatorType& ps_evaluator,
                                          double const * restrict point_to_sample_in) {
-  // update current point in union_of_points
+  // update the non-fidelity coordinates of point_to_sample; the fidelity coordinates stay at 1.0 from construction
+  // (Reconfigure() keeps num_fidelity fixed)
   std::copy(point_to_sample_in, point_to_sample_in + dim - num_fidelity, point_to_sample.data());
-  std::fill(point_to_sample.data() + dim - num_fidelity, point_to_sample.data() + dim, 1.0);
   // evaluate derived quantities
   Initialize(ps_evaluator);
 }
@@ -135,6 +146,7 @@ FuturePosteriorMeanState::FuturePosteriorMeanState(
     point_to_sample(BuildUnionOfPoints(point_to_sample_in)),
     K_star(ps_evaluator.gaussian_process()->num_sampled()*(1+ps_evaluator.gaussian_process()->num_derivatives())),
     grad_K_star(dim*ps_evaluator.gaussian_process()->num_sampled()*(1+ps_evaluator.gaussian_process()->num_derivatives())),
+    grad_cov(dim*(1+ps_evaluator.gaussian_process()->num_derivatives())),
     randomGenerator() {
   Initialize(ps_evaluator);
 }
@@ -150,6 +162,71 @@ void FuturePosteriorMeanState::SetupState(const EvaluatorType& ps_evaluator,
   SetCurrentPoint(ps_evaluator, point_to_sample_in);
 }
 
+bool FuturePosteriorMeanState::Reconfigure(const EvaluatorType& ps_evaluator, const int num_fidelity_in,
+                                           double const * restrict point_to_sample_in, bool configure_for_gradients) {
+  if (dim != ps_evaluator.dim() || num_fidelity != num_fidelity_in ||
+      num_derivatives != (configure_for_gradients ? num_to_sample : 0)) {
+    return false;
+  }
+
+  const int num_gradients_sampled = ps_evaluator.gaussian_process()->num_derivatives();
+  const int num_observations = ps_evaluator.gaussian_process()->num_sampled()*(1+num_gradients_sampled);
+  K_star.resize(num_observations);
+  grad_K_star.resize(dim*num_observations);
+  grad_cov.resize(dim*(1+num_gradients_sampled));
+  SetCurrentPoint(ps_evaluator, point_to_sample_in);
+  return true;
+}
+
+namespace {
+
+//! largest inner problem size (``dim - num_fidelity``) that ComputeOptimalFuturePosteriorMean() optimizes with
+//! FixedSizeGradientDescentOptimizer; larger problems use GradientDescentOptimizer
+constexpr int kMaxFixedSizeInnerProblem = 8;
+
+/*!\rst
+  Multistart gradient descent on the future posterior mean, dispatching the runtime ``problem_size`` to a
+  FixedSizeGradientDescentOptimizer instantiation: each level handles ``problem_size == kProblemSize`` and defers other
+  sizes to ``kProblemSize - 1``; level 0 (sizes above kMaxFixedSizeInnerProblem) uses GradientDescentOptimizer.  All
+  levels give identical results; the fixed-size ones just run the per-step work with stack buffers and unrolled loops.
+\endrst*/
+template <typename DomainType, int kProblemSize>
+struct FuturePosteriorMeanMultistart {
+  static void Optimize(int problem_size, const FuturePosteriorMeanEvaluator& fpm_evaluator,
+                       const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                       const ThreadSchedule& thread_schedule, double const * restrict initial_guesses,
+                       int num_multistarts, FuturePosteriorMeanState * fpm_state_vector,
+                       OptimizationIOContainer * io_container) {
+    if (problem_size != kProblemSize) {
+      FuturePosteriorMeanMultistart<DomainType, kProblemSize - 1>::Optimize(
+          problem_size, fpm_evaluator, optimizer_parameters, domain, thread_schedule, initial_guesses,
+          num_multistarts, fpm_state_vector, io_container);
+      return;
+    }
+    using Optimizer = FixedSizeGradientDescentOptimizer<FuturePosteriorMeanEvaluator, DomainType, kProblemSize>;
+    Optimizer gd_opt;
+    MultistartOptimizer<Optimizer> multistart_optimizer;
+    multistart_optimizer.MultistartOptimize(gd_opt, fpm_evaluator, optimizer_parameters, domain, thread_schedule,
+                                            initial_guesses, num_multistarts, fpm_state_vector, nullptr, io_container);
+  }
+};
+
+template <typename DomainType>
+struct FuturePosteriorMeanMultistart<DomainType, 0> {
+  static void Optimize(int OL_UNUSED(problem_size), const FuturePosteriorMeanEvaluator& fpm_evaluator,
+                       const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                       const ThreadSchedule& thread_schedule, double const * restrict initial_guesses,
+                       int num_multistarts, FuturePosteriorMeanState * fpm_state_vector,
+                       OptimizationIOContainer * io_container) {
+    GradientDescentOptimizer<FuturePosteriorMeanEvaluator, DomainType> gd_opt;
+    MultistartOptimizer<GradientDescentOptimizer<FuturePosteriorMeanEvaluator, DomainType> > multistart_optimizer;
+    multistart_optimizer.MultistartOptimize(gd_opt, fpm_evaluator, optimizer_parameters, domain, thread_schedule,
+                                            initial_guesses, num_multistarts, fpm_state_vector, nullptr, io_container);
+  }
+};
+
+}  // end unnamed namespace
+
 /*!\rst
   Perform multistart gradient descent (MGD) to solve the q,p-EI problem (see ComputeOptimalPointsToSample and/or
   header docs).  Starts a GD run from each point in ``start_point_set``.  The point corresponding to the
@@ -159,7 +236,7 @@ void FuturePosteriorMeanState::SetupState(const EvaluatorType& ps_evaluator,
 
   This function wraps MultistartOptimizer<>::MultistartOptimize() (see ``gpp_optimization.hpp``), which provides the multistarting
   component. Optimization is done using restarted Gradient Descent, via GradientDescentOptimizer<...>::Optimize() from
-  ``gpp_optimization.hpp``. Please see that file for details on gradient descent and see ``gpp_optimizer_parameters.hpp``
+  ``gpp_optimization.hpp`` (or its FixedSizeGradientDescentOptimizer twin for ``dim - num_fidelity <= 8``). Please see that file for details on gradient descent and see ``gpp_optimizer_parameters.hpp``
   for the meanings of the GradientDescentParameters.
 
   This function (or its wrappers, e.g., ComputeOptimalPointsToSampleWithRandomStarts) are the primary entry-points for
@@ -190,6 +267,11 @@ void FuturePosteriorMeanState::SetupState(const EvaluatorType& ps_evaluator,
     :start_point_set[dim][num_to_sample][num_multistarts]: set of initial guesses for MGD (one block of num_to_sample points per multistart)
     :points_being_sampled[dim][num_being_sampled]: points that are being sampled in concurrent experiments
     :num_multistarts: number of points in set of initial guesses
+    :warm_start_set[dim - num_fidelity][num_warm_starts]: extra initial guesses (e.g., optima of earlier, nearby solves);
+      they are ranked with ``start_point_set`` and win ties against it
+    :num_warm_starts: number of points in ``warm_start_set`` (may be 0)
+    :fpm_state_vector[arbitrary]: states kept from earlier calls (possibly none), reused instead of constructing new ones;
+      callers that solve many inner problems (e.g., one per KG MC iteration) keep one vector per concurrent solve
     :num_to_sample: number of potential future samples; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
     :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
@@ -208,10 +290,14 @@ void ComputeOptimalFuturePosteriorMean(
   int num_derivatives, double const * chol, double const * train_sample,
   const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
   int max_num_threads, double const * restrict start_point_set,
-  int num_multistarts, double * restrict best_function_value, double * restrict best_next_point) {
+  int num_multistarts, double const * restrict warm_start_set, int num_warm_starts,
+  std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+  double * restrict best_function_value, double * restrict best_next_point) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
   }
+  OL_PROFILE_SCOPE(ProfilePhase::kKnowledgeGradientInnerOptimization);
+  OL_PROFILE_COUNT(ProfileCounter::kKnowledgeGradientInnerSolves, 1);
 
   ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
 
@@ -221,13 +307,18 @@ void ComputeOptimalFuturePosteriorMean(
                                              num_to_sample, to_sample_derivatives,
                                              num_derivatives, chol, train_sample);
 
-  std::vector<typename FuturePosteriorMeanEvaluator::StateType> fpm_state_vector;
-  SetupFuturePosteriorMeanState(fpm_evaluator, start_point_set, max_num_threads, configure_for_gradients, num_fidelity, &fpm_state_vector);
+  SetupFuturePosteriorMeanState(fpm_evaluator, start_point_set, max_num_threads, configure_for_gradients, num_fidelity, fpm_state_vector);
+
+  // warm starts are ranked first so that they win ties
+  const int subset_dim = gaussian_process.dim() - num_fidelity;
+  auto starting_point = [=](int i) {
+    return i < num_warm_starts ? warm_start_set + i*subset_dim : start_point_set + (i - num_warm_starts)*subset_dim;
+  };
 
-  std::vector<double> future_mean_starting(num_multistarts);
-  for (int i=0; i<num_multistarts; ++i){
-    fpm_state_vector[0].SetCurrentPoint(fpm_evaluator, start_point_set + i*(gaussian_process.dim()-num_fidelity));
-    future_mean_starting[i] = fpm_evaluator.ComputePosteriorMean(&fpm_state_vector[0]);
+  std::vector<double> future_mean_starting(num_warm_starts + num_multistarts);
+  for (int i = 0; i < num_warm_starts + num_multistarts; ++i) {
+    (*fpm_state_vector)[0].SetCurrentPoint(fpm_evaluator, starting_point(i));
+    future_mean_starting[i] = fpm_evaluator.ComputePosteriorMean(fpm_state_vector->data());
   }
 
   std::priority_queue<std::pair<double, int>> q;
@@ -248,20 +339,17 @@ void ComputeOptimalFuturePosteriorMean(
   for (int i = 0; i < k; ++i) {
     int ki = q.top().second;
     for (int d = 0; d<gaussian_process.dim()-num_fidelity; ++d){
-      top_k_starting[i*(gaussian_process.dim()-num_fidelity) + d] = start_point_set[ki*(gaussian_process.dim()-num_fidelity) + d];
+      top_k_starting[i*(gaussian_process.dim()-num_fidelity) + d] = starting_point(ki)[d];
     }
     q.pop();
   }
 
   // init winner to be first point in set and 'force' its value to be -INFINITY; we cannot do worse than this
-  OptimizationIOContainer io_container(fpm_state_vector[0].GetProblemSize(), -INFINITY, top_k_starting.data());
+  OptimizationIOContainer io_container((*fpm_state_vector)[0].GetProblemSize(), -INFINITY, top_k_starting.data());
 
-  GradientDescentOptimizer<FuturePosteriorMeanEvaluator, DomainType> gd_opt;
-  MultistartOptimizer<GradientDescentOptimizer<FuturePosteriorMeanEvaluator, DomainType> > multistart_optimizer;
-
-  multistart_optimizer.MultistartOptimize(gd_opt, fpm_evaluator, optimizer_parameters,
-                                          domain, thread_schedule, top_k_starting.data(), k,
-                                          fpm_state_vector.data(), nullptr, &io_container);
+  FuturePosteriorMeanMultistart<DomainType, kMaxFixedSizeInnerProblem>::Optimize(
+      subset_dim, fpm_evaluator, optimizer_parameters, domain, thread_schedule, top_k_starting.data(), k,
+      fpm_state_vector->data(), &io_container);
 
   *best_function_value = io_container.best_objective_value_so_far;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
@@ -273,13 +361,29 @@ template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_
                                                 int num_derivatives, double const * chol, double const * train_sample,
                                                 const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
                                                 int max_num_threads, double const * restrict start_point_set,
-                                                int num_multistarts, double * restrict best_function_value,
+                                                int num_multistarts, double const * restrict warm_start_set,
+                                                int num_warm_starts,
+                                                std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                double * restrict best_function_value,
                                                 double * restrict best_next_point);
 template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process, const int num_fidelity, double const * coefficient,
                                                 double const * to_sample, const int num_to_sample, int const * to_sample_derivatives,
                                                 int num_derivatives, double const * chol, double const * train_sample,
                                                 const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
                                                 int max_num_threads, double const * restrict start_point_set,
-                                                int num_multistarts, double * restrict best_function_value,
+                                                int num_multistarts, double const * restrict warm_start_set,
+                                                int num_warm_starts,
+                                                std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                double * restrict best_function_value,
+                                                double * restrict best_next_point);
+template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process, const int num_fidelity, double const * coefficient,
+                                                double const * to_sample, const int num_to_sample, int const * to_sample_derivatives,
+                                                int num_derivatives, double const * chol, double const * train_sample,
+                                                const GradientDescentParameters& optimizer_parameters, const TrustRegionDomain& domain,
+                                                int max_num_threads, double const * restrict start_point_set,
+                                                int num_multistarts, double const * restrict warm_start_set,
+                                                int num_warm_starts,
+                                                std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                double * restrict best_function_value,
                                                 double * restrict best_next_point);
 }  // end namespace optimal_learning
\ No newline at end of file
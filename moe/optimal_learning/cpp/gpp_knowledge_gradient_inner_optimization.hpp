@@ -203,7 +203,7 @@ class FuturePosteriorMeanEvaluator final {
     std::vector<double> temp(num_to_sample*(1+num_derivatives));
     std::copy(coefficient, coefficient + num_to_sample*(1+num_derivatives), temp.data());
 
-    std::vector<double> result(gaussian_process_->get_K_inv_y());
+    std::vector<double> result(gaussian_process_->get_K_inv_y().begin(), gaussian_process_->get_K_inv_y().end());
     int num_observations = gaussian_process_->num_sampled() * (1 + gaussian_process_->num_derivatives());
     GeneralMatrixVectorMultiply(train_sample, 'N', temp.data(), -1.0, 1.0,
                                 num_observations, num_to_sample*(1+num_derivatives),
@@ -225,6 +225,24 @@ class FuturePosteriorMeanEvaluator final {
     ComputeGradPosteriorMean(ps_state, grad_PS);
   }
 
+  /*!\rst
+    Batched ComputeGradObjectiveFunction() for lockstep multistart gradient descent (see
+    GradientDescentOptimizer<...>::OptimizeBatch()): moves ``ps_states[k]`` to the ``k``-th point of ``points_to_sample``
+    and computes the gradient there, for every ``k``.  The future posterior mean needs no solve against the training
+    covariance per point (``coeff_combined_`` already folds it in), so the states are simply processed in turn.
+
+    \param
+      :ps_states[num_states]: pointers to distinct, properly configured state objects
+      :num_states: number of states in the batch
+      :points_to_sample[num_states][dim - num_fidelity]: new point of each state
+    \output
+      :ps_states[num_states]: states moved to their new points; temporary storage modified
+      :grad_PS[num_states][dim - num_fidelity]: gradient at each state's new point
+  \endrst*/
+  void ComputeGradObjectiveFunctionBatch(StateType * const * ps_states, int num_states,
+                                         double const * restrict points_to_sample,
+                                         double * restrict grad_PS) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the expected improvement ``EI(Xs) = E_n[[f^*_n(X) - min(f(Xs_1),...,f(Xs_m))]^+]``
     Uses analytic formulas to evaluate the expected improvement.
@@ -347,6 +365,20 @@ struct FuturePosteriorMeanState final {
   void SetupState(const EvaluatorType& ps_evaluator,
                   double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Reuses this state as if it were newly constructed with these (constructor) arguments, keeping its buffers (they
+    are resized for the evaluator's GP, reallocating only when it has grown).  See ReuseOrConstructStates()
+    (gpp_optimization.hpp).
+
+    \param
+      see the constructor
+    \return
+      true if the state was reconfigured; false (state unchanged) if ``dim``, ``num_fidelity``, or
+      ``configure_for_gradients`` differ
+  \endrst*/
+  bool Reconfigure(const EvaluatorType& ps_evaluator, const int num_fidelity_in, double const * restrict point_to_sample_in,
+                   bool configure_for_gradients) OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   const int dim;
@@ -362,6 +394,8 @@ struct FuturePosteriorMeanState final {
 
   std::vector<double> K_star;
   std::vector<double> grad_K_star;
+  //! the gradient of covariance(point_to_sample, x) wrt point_to_sample, for one sampled point x
+  std::vector<double> grad_cov;
 
   UniformRandomGenerator randomGenerator;
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(FuturePosteriorMeanState);
@@ -381,7 +415,8 @@ struct FuturePosteriorMeanState final {
     :num_being_sampled: number of points being sampled concurrently (i.e., the p in q,p-EI)
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
-    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
+    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0); states it already holds are reused
+      where possible (see ReuseOrConstructStates()), so a vector kept across calls acts as a pool
     :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
@@ -393,10 +428,12 @@ inline OL_NONNULL_POINTERS void SetupFuturePosteriorMeanState(
     bool configure_for_gradients,
     const int num_fidelity,
     std::vector<typename FuturePosteriorMeanEvaluator::StateType> * state_vector) {
-  state_vector->reserve(max_num_threads);
-  for (int i = 0; i < max_num_threads; ++i) {
-    state_vector->emplace_back(fpm_evaluator, num_fidelity, points_to_sample, configure_for_gradients);
-  }
+  using StateType = typename FuturePosteriorMeanEvaluator::StateType;
+  ReuseOrConstructStates(max_num_threads, [&](StateType * state, int OL_UNUSED(i)) {
+      return state->Reconfigure(fpm_evaluator, num_fidelity, points_to_sample, configure_for_gradients);
+    }, [&](std::vector<StateType> * states, int OL_UNUSED(i)) {
+      states->emplace_back(fpm_evaluator, num_fidelity, points_to_sample, configure_for_gradients);
+    }, state_vector);
 }
 
 
@@ -491,7 +528,9 @@ void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process,
                                        int num_derivatives, double const * chol, double const * train_sample,
                                        const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
                                        int max_num_threads, double const * restrict start_point_set,
-                                       int num_multistarts, double * restrict best_function_value, double * restrict best_next_point);
+                                       int num_multistarts, double const * restrict warm_start_set, int num_warm_starts,
+                                       std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                       double * restrict best_function_value, double * restrict best_next_point);
 
 // template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
 extern template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process, const int num_fidelity, double const * coefficient,
@@ -499,14 +538,30 @@ extern template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& ga
                                                        int num_derivatives, double const * chol, double const * train_sample,
                                                        const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
                                                        int max_num_threads, double const * restrict start_point_set,
-                                                       int num_multistarts, double * restrict best_function_value,
+                                                       int num_multistarts, double const * restrict warm_start_set,
+                                                       int num_warm_starts,
+                                                       std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                       double * restrict best_function_value,
                                                        double * restrict best_next_point);
 extern template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process, const int num_fidelity, double const * coefficient,
                                                        double const * to_sample, const int num_to_sample, int const * to_sample_derivatives,
                                                        int num_derivatives, double const * chol, double const * train_sample,
                                                        const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
                                                        int max_num_threads, double const * restrict start_point_set,
-                                                       int num_multistarts, double * restrict best_function_value,
+                                                       int num_multistarts, double const * restrict warm_start_set,
+                                                       int num_warm_starts,
+                                                       std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                       double * restrict best_function_value,
+                                                       double * restrict best_next_point);
+extern template void ComputeOptimalFuturePosteriorMean(const GaussianProcess& gaussian_process, const int num_fidelity, double const * coefficient,
+                                                       double const * to_sample, const int num_to_sample, int const * to_sample_derivatives,
+                                                       int num_derivatives, double const * chol, double const * train_sample,
+                                                       const GradientDescentParameters& optimizer_parameters, const TrustRegionDomain& domain,
+                                                       int max_num_threads, double const * restrict start_point_set,
+                                                       int num_multistarts, double const * restrict warm_start_set,
+                                                       int num_warm_starts,
+                                                       std::vector<FuturePosteriorMeanState> * fpm_state_vector,
+                                                       double * restrict best_function_value,
                                                        double * restrict best_next_point);
 }  // end namespace optimal_learning
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_KNOWLEDGE_GRADIENT_INNER_OPTIMIZATION_HPP_
\ No newline at end of file
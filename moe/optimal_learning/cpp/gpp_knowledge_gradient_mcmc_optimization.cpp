@@ -9,16 +9,25 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <exception>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <stdlib.h>
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
+#include "gpp_cost_model.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
@@ -28,27 +37,81 @@ GaussianProcessMCMC::GaussianProcessMCMC(double const * restrict hypers_mcmc,
                                          double const * restrict points_sampled_value_in,
                                          int const * restrict derivatives_in,
                                          int num_derivatives_in,
-                                         int dim_in, int num_sampled_in)
+                                         int dim_in, int num_sampled_in,
+                                         int max_num_threads)
     : num_mcmc_(number_mcmc),
       dim_(dim_in),
       num_sampled_(num_sampled_in),
-      points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
-      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + num_sampled_in*(num_derivatives_in+1)),
-      derivatives_(derivatives_in, derivatives_in + num_derivatives_in),
-      num_derivatives_(num_derivatives_in) {
+      points_sampled_(std::make_shared<const std::vector<double>>(points_sampled_in, points_sampled_in + num_sampled_in*dim_in)),
+      points_sampled_value_(std::make_shared<const std::vector<double>>(points_sampled_value_in,
+                                                                        points_sampled_value_in + num_sampled_in*(num_derivatives_in+1))),
+      derivatives_(std::make_shared<const std::vector<int>>(derivatives_in, derivatives_in + num_derivatives_in)),
+      num_derivatives_(num_derivatives_in),
+      training_differences_(std::make_shared<const PairwiseDifferences>(points_sampled_in, dim_in, num_sampled_in,
+                                                                        derivatives_in, num_derivatives_in)) {
+  // each GP factorizes its own covariance matrix, so the samples are independent and built concurrently
+  std::vector<std::unique_ptr<GaussianProcess>> gaussian_processes(num_mcmc_);
+
+  ParallelForEachIndex(max_num_threads, num_mcmc_, [&](int i) {
+      double const * hypers = hypers_mcmc + i*(dim_+1);
+      SquareExponential sqexp(dim_, hypers[0], hypers+1);
+      gaussian_processes[i].reset(new GaussianProcess(sqexp, points_sampled_, points_sampled_value_,
+                                                      noises_mcmc + i*(num_derivatives_+1), derivatives_,
+                                                      dim_, num_sampled_, training_differences_));
+    });
+
   gaussian_process_lst.reserve(num_mcmc_);
-  const double * hypers = hypers_mcmc;
-  const double * noises = noises_mcmc;
-  for (int i=0; i<num_mcmc_; ++i){
-    SquareExponential sqexp(dim_, hypers[0], hypers+1);
-    gaussian_process_lst.emplace_back(sqexp, points_sampled_.data(), points_sampled_value_.data(),
-                                      noises, derivatives_.data(), num_derivatives_,
-                                      dim_, num_sampled_);
-    hypers += dim_+1;
-    noises += num_derivatives_+1;
+  for (auto& gaussian_process : gaussian_processes) {
+    gaussian_process_lst.emplace_back(std::move(*gaussian_process));
   }
 }
 
+GaussianProcessMCMC::GaussianProcessMCMC(std::shared_ptr<const std::vector<double>> points_sampled_in,
+                                         std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                                         std::shared_ptr<const std::vector<int>> derivatives_in,
+                                         int dim_in, int num_sampled_in,
+                                         std::shared_ptr<const PairwiseDifferences> training_differences_in,
+                                         std::vector<GaussianProcess>&& gaussian_processes)
+    : gaussian_process_lst(std::move(gaussian_processes)),
+      num_mcmc_(static_cast<int>(gaussian_process_lst.size())),
+      dim_(dim_in),
+      num_sampled_(num_sampled_in),
+      points_sampled_(std::move(points_sampled_in)),
+      points_sampled_value_(std::move(points_sampled_value_in)),
+      derivatives_(std::move(derivatives_in)),
+      num_derivatives_(static_cast<int>(derivatives_->size())),
+      training_differences_(std::move(training_differences_in)) {
+}
+
+void GaussianProcessMCMC::AddPointsToGP(double const * restrict new_points, double const * restrict new_points_value,
+                                        int num_new_points, int max_num_threads) {
+  // extend the shared training data once; every GP then adopts the same extended copy
+  auto points_sampled_new = std::make_shared<std::vector<double>>(*points_sampled_);
+  points_sampled_new->insert(points_sampled_new->end(), new_points, new_points + num_new_points*dim_);
+  points_sampled_ = std::move(points_sampled_new);
+
+  auto points_sampled_value_new = std::make_shared<std::vector<double>>(*points_sampled_value_);
+  points_sampled_value_new->insert(points_sampled_value_new->end(), new_points_value,
+                                   new_points_value + num_new_points*(num_derivatives_+1));
+  points_sampled_value_ = std::move(points_sampled_value_new);
+
+  num_sampled_ += num_new_points;
+  training_differences_ = std::make_shared<const PairwiseDifferences>(points_sampled_->data(), dim_, num_sampled_,
+                                                                      derivatives_->data(), num_derivatives_);
+
+  ParallelForEachIndex(max_num_threads, num_mcmc_, [&](int i) {
+      gaussian_process_lst[i].AddPointsToGP(points_sampled_, points_sampled_value_, num_new_points,
+                                            training_differences_);
+    });
+}
+
+void GaussianProcessMCMC::SetHyperparameters(double const * restrict hypers_mcmc, double const * restrict noises_mcmc,
+                                             int max_num_threads) {
+  ParallelForEachIndex(max_num_threads, num_mcmc_, [&](int i) {
+      gaussian_process_lst[i].SetHyperparameters(hypers_mcmc + i*(dim_+1), noises_mcmc + i*(num_derivatives_+1));
+    });
+}
+
 template <typename DomainType>
 KnowledgeGradientMCMCEvaluator<DomainType>::KnowledgeGradientMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
                                                                            double const * discrete_pts_lst,
@@ -56,7 +119,11 @@ KnowledgeGradientMCMCEvaluator<DomainType>::KnowledgeGradientMCMCEvaluator(const
                                                                            const DomainType& domain,
                                                                            const GradientDescentParameters& optimizer_parameters,
                                                                            double const * best_so_far,
-                                                                           std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> * evaluator_vector)
+                                                                           std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> * evaluator_vector,
+                                                                           int max_num_threads,
+                                                                           int which_gpu,
+                                                                           CostModelInterface const * cost_model,
+                                                                           const DistributedContext& distributed_context)
 : dim_(gaussian_process_mcmc.dim()),
   num_fidelity_(num_fidelity),
   num_mcmc_hypers_(gaussian_process_mcmc.num_mcmc()),
@@ -70,63 +137,38 @@ KnowledgeGradientMCMCEvaluator<DomainType>::KnowledgeGradientMCMCEvaluator(const
   gaussian_process_mcmc_(&gaussian_process_mcmc),
   knowledge_gradient_evaluator_lst(evaluator_vector),
   discrete_pts_lst_(discrete_points_list(discrete_pts_lst, num_pts)),
-  num_pts_(num_pts) {
+  num_pts_(num_pts),
+  max_num_threads_(max_num_threads),
+  cost_model_(cost_model != nullptr ? cost_model->Clone() : new FidelityProductCostModel(dim_, num_fidelity)),
+  distributed_context_(distributed_context) {
+    if (unlikely(cost_model_->dim() != dim_)) {
+      OL_THROW_EXCEPTION(InvalidValueException<int>, "cost model and GP dims do not match.", cost_model_->dim(), dim_);
+    }
     knowledge_gradient_evaluator_lst->reserve(num_mcmc_hypers_);
     double * discrete_pts = discrete_pts_lst_.data();
     for (int i=0; i<num_mcmc_hypers_; ++i){
       knowledge_gradient_evaluator_lst->emplace_back(gaussian_process_mcmc_->gaussian_process_lst[i], num_fidelity_, discrete_pts,
                                                      num_pts_, num_mc_iterations_, domain_, optimizer_parameters_,
-                                                     best_so_far_[i]);
+                                                     best_so_far_[i], KnowledgeGradientInnerMode::kGradientDescent, 0, 1, which_gpu);
       discrete_pts += num_pts_*(dim_-num_fidelity_);
   }
 }
 
-/*!\rst
-  compute the cost.
-\endrst*/
 template <typename DomainType>
 double KnowledgeGradientMCMCEvaluator<DomainType>::ComputeCost(StateType * kg_state) const {
-  if (num_fidelity_ == 0){
-    return 1.0;
-  }
-  else{
-    double cost = 0.0;
-    for (int i=0; i<kg_state->num_to_sample; ++i){
-      double point_cost = 1.0;
-      for (int j=dim_-num_fidelity_; j<dim_; ++j){
-        point_cost *= kg_state->union_of_points[i*dim_ + j];
-      }
-      if (cost < point_cost){
-        cost = point_cost;
-      }
-    }
-    return cost;
-  }
+  cost_model_->ComputeCostOfPoints(kg_state->union_of_points.data(), kg_state->num_to_sample,
+                                   kg_state->cost_of_points.data());
+  return *std::max_element(kg_state->cost_of_points.begin(), kg_state->cost_of_points.end());
 }
 
-/*!\rst
-  compute the gradient of the cost.
-\endrst*/
 template <typename DomainType>
 void KnowledgeGradientMCMCEvaluator<DomainType>::ComputeGradCost(StateType * kg_state, double * restrict grad_cost) const {
-  std::fill(kg_state->gradcost.begin(), kg_state->gradcost.end(), 0.0);
-  if (num_fidelity_ > 0){
-    int index = -1;
-    double cost = 0.0;
-    for (int i=0; i<kg_state->num_to_sample; ++i){
-      double point_cost = 1.0;
-      for (int j=dim_-num_fidelity_; j<dim_; ++j){
-        point_cost *= kg_state->union_of_points[i*dim_ + j];
-      }
-      if (cost < point_cost){
-        cost = point_cost;
-        index = i;
-      }
-    }
-    for (int j=dim_-num_fidelity_; j<dim_; ++j){
-      kg_state->gradcost[index*dim_ + j] = cost/kg_state->union_of_points[index*dim_ + j];
-    }
-  }
+  cost_model_->ComputeCostOfPoints(kg_state->union_of_points.data(), kg_state->num_to_sample,
+                                   kg_state->cost_of_points.data());
+  const int index = std::max_element(kg_state->cost_of_points.begin(), kg_state->cost_of_points.end()) -
+      kg_state->cost_of_points.begin();
+  std::fill(grad_cost, grad_cost + kg_state->num_to_sample*dim_, 0.0);
+  cost_model_->ComputeGradCostOfPoints(kg_state->union_of_points.data() + index*dim_, 1, grad_cost + index*dim_);
 }
 
 /*!\rst
@@ -136,9 +178,29 @@ void KnowledgeGradientMCMCEvaluator<DomainType>::ComputeGradCost(StateType * kg_
 \endrst*/
 template <typename DomainType>
 double KnowledgeGradientMCMCEvaluator<DomainType>::ComputeKnowledgeGradient(StateType * kg_state) const {
+  int begin, end;
+  distributed_context_.BlockRange(num_mcmc_hypers_, &begin, &end);
+  kg_state->PrepareSampleRNGs();
+
+  // captured rather than propagated so that the cleanup below always runs
+  std::exception_ptr captured_exception;
+  try {
+    ParallelForEachIndex(max_num_threads_, end - begin, [&](int j) {
+        const int i = begin + j;
+        kg_state->sample_values[i] = (*knowledge_gradient_evaluator_lst)[i].ComputeObjectiveFunction(kg_state->kg_state_list->data() + i);
+      });
+  } catch (const std::exception&) {
+    captured_exception = std::current_exception();
+  }
+
+  kg_state->RestoreSampleRNGs();
+  distributed_context_.RethrowIfAnyFailed(captured_exception);
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, 1, kg_state->sample_values.data());
+
+  // reduce in sample order so the sum does not depend on the thread count
   double kg_value = 0.0;
-  for (int i=0; i<num_mcmc_hypers_; ++i){
-    kg_value += (*knowledge_gradient_evaluator_lst)[i].ComputeObjectiveFunction((*(kg_state->kg_state_list)).data()+i);
+  for (int i = 0; i < num_mcmc_hypers_; ++i) {
+    kg_value += kg_state->sample_values[i];
   }
   double cost = ComputeCost(kg_state);
   return kg_value/static_cast<double>(num_mcmc_hypers_*cost);
@@ -160,24 +222,53 @@ double KnowledgeGradientMCMCEvaluator<DomainType>::ComputeKnowledgeGradient(Stat
   .. Note:: comments here are copied to _compute_grad_knowledge_gradient_monte_carlo() in python_version/knowledge_gradient.py
 \endrst*/
 template <typename DomainType>
-void KnowledgeGradientMCMCEvaluator<DomainType>::ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const {
+double KnowledgeGradientMCMCEvaluator<DomainType>::ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const {
+  const int problem_size = kg_state->num_to_sample*dim_;
+  int begin, end;
+  distributed_context_.BlockRange(num_mcmc_hypers_, &begin, &end);
+  kg_state->PrepareSampleRNGs();
+
+  // captured rather than propagated so that the cleanup below always runs
+  std::exception_ptr captured_exception;
+  try {
+    ParallelForEachIndex(max_num_threads_, end - begin, [&](int j) {
+        const int i = begin + j;
+        double * restrict sample_grad = kg_state->sample_grads.data() + i*problem_size;
+        std::fill(sample_grad, sample_grad + problem_size, 0.0);
+        kg_state->sample_values[i] = (*knowledge_gradient_evaluator_lst)[i].ComputeGradKnowledgeGradient(kg_state->kg_state_list->data() + i,
+                                                                                                          sample_grad);
+      });
+  } catch (const std::exception&) {
+    captured_exception = std::current_exception();
+  }
+
+  kg_state->RestoreSampleRNGs();
+  distributed_context_.RethrowIfAnyFailed(captured_exception);
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, 1, kg_state->sample_values.data());
+  distributed_context_.AllGatherBlocks(num_mcmc_hypers_, problem_size, kg_state->sample_grads.data());
+
+  // reduce in sample order so the sums do not depend on the thread count
   double KG = 0.0;
-  for (int i=0; i<num_mcmc_hypers_; ++i){
-    std::vector<double> temp(kg_state->dim*kg_state->num_to_sample, 0.0);
-    KG += (*knowledge_gradient_evaluator_lst)[i].ComputeGradKnowledgeGradient((*(kg_state->kg_state_list)).data()+i, temp.data());
-    for (int k = 0; k < kg_state->num_to_sample*dim_; ++k) {
-        grad_KG[k] += temp[k];
+  std::fill(grad_KG, grad_KG + problem_size, 0.0);
+  for (int i = 0; i < num_mcmc_hypers_; ++i) {
+    KG += kg_state->sample_values[i];
+    double const * restrict sample_grad = kg_state->sample_grads.data() + i*problem_size;
+    for (int k = 0; k < problem_size; ++k) {
+      grad_KG[k] += sample_grad[k];
     }
   }
+  const double kg_sum = KG;
   KG /= static_cast<double>(num_mcmc_hypers_);
   // cost and the grad of the cost
   double cost = ComputeCost(kg_state);
   ComputeGradCost(kg_state, kg_state->gradcost.data());
 
-  for (int k = 0; k < kg_state->num_to_sample*dim_; ++k) {
+  for (int k = 0; k < problem_size; ++k) {
     grad_KG[k] = grad_KG[k]/static_cast<double>(num_mcmc_hypers_);
     grad_KG[k] = (grad_KG[k]*cost - KG*kg_state->gradcost[k])/Square(cost);
   }
+  // as in ComputeKnowledgeGradient()
+  return kg_sum/static_cast<double>(num_mcmc_hypers_*cost);
 }
 
 template class KnowledgeGradientMCMCEvaluator<TensorProductDomain>;
@@ -187,10 +278,18 @@ template <typename DomainType>
 void KnowledgeGradientMCMCState<DomainType>::SetCurrentPoint(const EvaluatorType& kg_evaluator,
                                                              double const * restrict points_to_sample_in) {
   // update current point in union_of_points
-  std::copy(points_to_sample_in, points_to_sample_in + dim, union_of_points.data());
+  std::copy(points_to_sample_in, points_to_sample_in + dim*num_to_sample, union_of_points.data());
+
+  // the samples' GPs share points_sampled, so the differences to union_of_points are computed once for all of them
+  if (num_mcmc > 0) {
+    const GaussianProcess& gaussian_process = *kg_evaluator.knowledge_gradient_evaluator_list()->at(0).gaussian_process();
+    cross_differences.SetPoints(gaussian_process.points_sampled().data(), gaussian_process.num_sampled(),
+                                union_of_points.data(), num_union);
+  }
 
   // evaluate derived quantities for the GP
   for (int i=0; i<kg_evaluator.num_mcmc();++i){
+    (kg_state_list->at(i)).points_to_sample_state.cross_differences = &cross_differences;
     (kg_state_list->at(i)).SetCurrentPoint(kg_evaluator.knowledge_gradient_evaluator_list()->at(i), points_to_sample_in);
   }
 }
@@ -207,11 +306,18 @@ KnowledgeGradientMCMCState<DomainType>::KnowledgeGradientMCMCState(const Evaluat
     num_derivatives(configure_for_gradients ? num_to_sample : 0),
     num_union(num_to_sample + num_being_sampled),
     num_pts(num_pts_in),
+    num_mcmc(kg_evaluator.num_mcmc()),
+    normal_rng(normal_rng_in),
+    sample_normal_rng(std::max(num_mcmc - 1, 0)),
     gradients(gradients_in, gradients_in+num_gradients_in),
     num_gradients_to_sample(num_gradients_in),
     union_of_points(BuildUnionOfPoints(points_to_sample, points_being_sampled, num_to_sample, num_being_sampled, dim)),
+    cost_of_points(num_to_sample),
     gradcost(dim*num_derivatives),
-    kg_state_list(kg_state_vector) {
+    sample_values(num_mcmc),
+    sample_grads(num_mcmc*dim*num_derivatives),
+    kg_state_list(kg_state_vector),
+    cross_differences(dim) {
   kg_state_list->reserve(kg_evaluator.num_mcmc());
   // evaluate derived quantities for the GP
   for (int i=0; i<kg_evaluator.num_mcmc();++i){
@@ -235,6 +341,21 @@ void KnowledgeGradientMCMCState<DomainType>::SetupState(const EvaluatorType& kg_
   SetCurrentPoint(kg_evaluator, points_to_sample);
 }
 
+template <typename DomainType>
+void KnowledgeGradientMCMCState<DomainType>::PrepareSampleRNGs() {
+  for (int i = 0; i < num_mcmc - 1; ++i) {
+    sample_normal_rng[i] = normal_rng->Clone();
+    (*kg_state_list)[i].normal_rng = sample_normal_rng[i].get();
+  }
+}
+
+template <typename DomainType>
+void KnowledgeGradientMCMCState<DomainType>::RestoreSampleRNGs() noexcept {
+  for (int i = 0; i < num_mcmc - 1; ++i) {
+    (*kg_state_list)[i].normal_rng = normal_rng;
+  }
+}
+
 template struct KnowledgeGradientMCMCState<TensorProductDomain>;
 template struct KnowledgeGradientMCMCState<SimplexIntersectTensorProductDomain>;
 
@@ -255,7 +376,8 @@ void ComputeKGMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                         int max_int_steps, bool lhc_search_only,
                                         int num_lhc_samples, bool * restrict found_flag,
                                         UniformRandomGenerator * uniform_generator,
-                                        NormalRNG * normal_rng, double * restrict best_points_to_sample) {
+                                        NormalRNGArray normal_rng, double * restrict best_points_to_sample,
+                                        CostModelInterface const * cost_model) {
   if (unlikely(num_to_sample <= 0)) {
     return;
   }
@@ -268,11 +390,13 @@ void ComputeKGMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                                        num_to_sample, num_being_sampled, num_pts,
                                                        best_so_far, max_int_steps,
                                                        &found_flag_local, uniform_generator, normal_rng,
-                                                       next_points_to_sample.data());
+                                                       next_points_to_sample.data(), cost_model);
   }
 
-  // if gradient descent EI optimization failed OR we're only doing latin hypercube searches
-  if (found_flag_local == false || lhc_search_only == true) {
+  // past the optimizer's deadline, return gradient descent's result instead of starting a search
+  const bool out_of_time = optimizer_parameters.deadline.Expired();
+  // if gradient descent EI optimization failed (with time left) OR we're only doing latin hypercube searches
+  if ((found_flag_local == false && !out_of_time) || lhc_search_only == true) {
     if (unlikely(lhc_search_only == false)) {
       OL_WARNING_PRINTF("WARNING: %d,%d-KG opt DID NOT CONVERGE\n", num_to_sample, num_being_sampled);
       OL_WARNING_PRINTF("Attempting latin hypercube search\n");
@@ -289,7 +413,7 @@ void ComputeKGMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                                                 num_lhc_samples, num_to_sample,
                                                                 num_being_sampled, num_pts, best_so_far, max_int_steps,
                                                                 &found_flag_local, uniform_generator,
-                                                                normal_rng, next_points_to_sample.data());
+                                                                normal_rng, next_points_to_sample.data(), cost_model);
 
       // if latin hypercube 'dumb' search failed
       if (unlikely(found_flag_local == false)) {
@@ -314,7 +438,7 @@ template void ComputeKGMCMCOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     int num_pts, double const * best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample, CostModelInterface const * cost_model);
 template void ComputeKGMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
     const GradientDescentParameters& optimizer_parameters_inner,
@@ -322,5 +446,117 @@ template void ComputeKGMCMCOptimalPointsToSample(
     double const * restrict points_being_sampled, double const * discrete_pts,
     int num_to_sample, int num_being_sampled,
     int num_pts, double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample,
+    CostModelInterface const * cost_model);
+
+PosteriorMeanMCMCEvaluator::PosteriorMeanMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc_in)
+    : dim_(gaussian_process_mcmc_in.dim()),
+      num_mcmc_(gaussian_process_mcmc_in.num_mcmc()),
+      gaussian_process_mcmc_(&gaussian_process_mcmc_in) {
+}
+
+double PosteriorMeanMCMCEvaluator::ComputePosteriorMean(StateType * ps_state) const {
+  double posterior_mean = 0.0;
+  for (int k = 0; k < num_mcmc_; ++k) {
+    double to_sample_mean;
+    gaussian_process_mcmc_->gaussian_process_lst[k].ComputeMeanOfPoints(ps_state->points_to_sample_state_list[k],
+                                                                        &to_sample_mean);
+    posterior_mean += to_sample_mean;
+  }
+  return -posterior_mean/static_cast<double>(num_mcmc_);
+}
+
+void PosteriorMeanMCMCEvaluator::ComputeGradPosteriorMean(StateType * ps_state, double * restrict grad_PS) const {
+  const int problem_size = ps_state->GetProblemSize();
+  double * restrict grad_mu = ps_state->grad_mu.data();
+  std::fill(grad_PS, grad_PS + problem_size, 0.0);
+  for (int k = 0; k < num_mcmc_; ++k) {
+    gaussian_process_mcmc_->gaussian_process_lst[k].ComputeGradMeanOfPoints(ps_state->points_to_sample_state_list[k],
+                                                                            grad_mu);
+    for (int d = 0; d < problem_size; ++d) {
+      grad_PS[d] -= grad_mu[d];
+    }
+  }
+  for (int d = 0; d < problem_size; ++d) {
+    grad_PS[d] /= static_cast<double>(num_mcmc_);
+  }
+}
+
+PosteriorMeanMCMCState::PosteriorMeanMCMCState(const EvaluatorType& ps_evaluator, const int num_fidelity_in,
+                                               double const * restrict point_to_sample_in,
+                                               bool configure_for_gradients)
+    : dim(ps_evaluator.dim()),
+      num_fidelity(num_fidelity_in),
+      num_derivatives(configure_for_gradients ? num_to_sample : 0),
+      point_to_sample(dim, 1.0),
+      cross_differences(dim),
+      grad_mu(dim*num_derivatives) {
+  std::copy(point_to_sample_in, point_to_sample_in + dim - num_fidelity, point_to_sample.data());
+  points_to_sample_state_list.reserve(ps_evaluator.num_mcmc());
+  for (const auto& gaussian_process : ps_evaluator.gaussian_process_mcmc()->gaussian_process_lst) {
+    points_to_sample_state_list.emplace_back(gaussian_process, point_to_sample.data(), num_to_sample, nullptr, 0,
+                                             num_derivatives, false, false);
+  }
+}
+
+PosteriorMeanMCMCState::PosteriorMeanMCMCState(PosteriorMeanMCMCState&& OL_UNUSED(other)) = default;
+
+void PosteriorMeanMCMCState::SetCurrentPoint(const EvaluatorType& ps_evaluator,
+                                             double const * restrict point_to_sample_in) {
+  // update the non-fidelity coordinates; the fidelity coordinates stay at 1.0 from construction
+  std::copy(point_to_sample_in, point_to_sample_in + dim - num_fidelity, point_to_sample.data());
+
+  // the GPs share points_sampled, so the differences to point_to_sample are computed once for all of them
+  const GaussianProcessMCMC& gaussian_process_mcmc = *ps_evaluator.gaussian_process_mcmc();
+  cross_differences.SetPoints(gaussian_process_mcmc.points_sampled().data(), gaussian_process_mcmc.num_sampled(),
+                              point_to_sample.data(), num_to_sample);
+  for (int k = 0; k < ps_evaluator.num_mcmc(); ++k) {
+    points_to_sample_state_list[k].cross_differences = &cross_differences;
+    points_to_sample_state_list[k].SetupState(gaussian_process_mcmc.gaussian_process_lst[k], point_to_sample.data(),
+                                              num_to_sample, 0, num_derivatives, false, false);
+  }
+}
+
+void PosteriorMeanMCMCState::SetupState(const EvaluatorType& ps_evaluator,
+                                        double const * restrict point_to_sample_in) {
+  if (unlikely(dim != ps_evaluator.dim())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, ps_evaluator.dim());
+  }
+  if (unlikely(static_cast<int>(points_to_sample_state_list.size()) != ps_evaluator.num_mcmc())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's num_mcmc do not match!",
+                       static_cast<int>(points_to_sample_state_list.size()), ps_evaluator.num_mcmc());
+  }
+
+  SetCurrentPoint(ps_evaluator, point_to_sample_in);
+}
+
+template <typename DomainType>
+void ComputeOptimalPosteriorMeanMCMC(const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+                                     const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                                     const ThreadSchedule& thread_schedule, double const * restrict start_point_set,
+                                     int num_multistarts, double const * restrict discrete_pts, int num_pts,
+                                     int num_refined_starts, bool * restrict found_flag,
+                                     double * restrict best_next_point) {
+  OL_VERBOSE_PRINTF("Posterior Mean MCMC Optimization via %s:\n", OL_CURRENT_FUNCTION_NAME);
+  PosteriorMeanMCMCEvaluator ps_evaluator(gaussian_process_mcmc);
+  MultistartPosteriorMeanOptimization(ps_evaluator, num_fidelity, gaussian_process_mcmc.points_sampled().data(),
+                                      gaussian_process_mcmc.num_sampled(), optimizer_parameters, domain,
+                                      thread_schedule, start_point_set, num_multistarts, discrete_pts, num_pts,
+                                      num_refined_starts, found_flag, best_next_point);
+}
+
+// template explicit instantiation definitions, see gpp_common.hpp header comments, item 6
+template void ComputeOptimalPosteriorMeanMCMC(
+    const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+template void ComputeOptimalPosteriorMeanMCMC(
+    const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+
 }  // end namespace optimal_learning
\ No newline at end of file
@@ -126,9 +126,11 @@
 #include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
+#include "gpp_cost_model.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
@@ -139,12 +141,80 @@
 namespace optimal_learning {
 struct GaussianProcessMCMC final {
  public:
+  /*!\rst
+    Constructs one GaussianProcess per hyperparameter sample. The GPs are built (each one factorizes its own covariance
+    matrix) on up to ``max_num_threads`` threads, and all of them share this object's copy of the training data and of
+    its (hyperparameter-independent) squared differences, from which each GP builds its ``K(X, X)``.
+
+    \param
+      :hypers_mcmc[dim+1][num_mcmc]: covariance hyperparameters (signal variance, then length scales) of each sample
+      :noises_mcmc[num_derivatives+1][num_mcmc]: noise variances of each sample
+      :num_mcmc: number of hyperparameter samples
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_derivatives+1][num_sampled]: values (and observed derivatives) of the already-sampled points
+      :derivatives[num_derivatives]: indices of the dimensions whose derivatives are observed
+      :num_derivatives: number of observed derivatives
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+      :max_num_threads: maximum number of threads used to build the GPs
+  \endrst*/
     GaussianProcessMCMC(double const * restrict hypers_mcmc,
                         double const * restrict noises_mcmc,
                         int num_mcmc, double const * restrict points_sampled_in,
                         double const * restrict points_sampled_value_in,
                         int const * restrict derivatives_in,
-                        int num_derivatives_in, int dim_in, int num_sampled_in) OL_NONNULL_POINTERS;
+                        int num_derivatives_in, int dim_in, int num_sampled_in,
+                        int max_num_threads) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Adopts already-built GPs (e.g., restored from a snapshot, see gpp_model_snapshot.hpp) over the given training data.
+    Every GP must have been built over exactly this (shared) data; this is not checked.
+
+    \param
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_derivatives+1][num_sampled]: values (and observed derivatives) of the already-sampled points
+      :derivatives[num_derivatives]: indices of the dimensions whose derivatives are observed
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+      :training_differences: squared differences of ``points_sampled`` (with ``derivatives``)
+      :gaussian_processes[num_mcmc]: one GP per hyperparameter sample
+  \endrst*/
+    GaussianProcessMCMC(std::shared_ptr<const std::vector<double>> points_sampled_in,
+                        std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                        std::shared_ptr<const std::vector<int>> derivatives_in, int dim_in, int num_sampled_in,
+                        std::shared_ptr<const PairwiseDifferences> training_differences_in,
+                        std::vector<GaussianProcess>&& gaussian_processes);
+
+  /*!\rst
+    Add new (point, value) historical data to every GP. The shared training data is extended once and each GP appends
+    the new rows to its own cholesky factor (see GaussianProcess::AddPointsToGP()); the GPs are updated on up to
+    ``max_num_threads`` threads.
+
+    If any GP update throws (e.g., SingularMatrixException), the exception is rethrown after all updates finish and
+    this object should be discarded.
+
+    \param
+      :new_points[dim][num_new_points]: coordinates of each new point to add
+      :new_points_value[num_derivatives+1][num_new_points]: function values (and observed derivatives) at each new point
+      :num_new_points: number of new points to add
+      :max_num_threads: maximum number of threads used to update the GPs
+  \endrst*/
+    void AddPointsToGP(double const * restrict new_points, double const * restrict new_points_value,
+                       int num_new_points, int max_num_threads) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Replace the hyperparameter samples without rebuilding the GPs or copying the training data; each GP refactors its
+    covariance matrix (see GaussianProcess::SetHyperparameters()) on up to ``max_num_threads`` threads.
+
+    The number of samples is fixed at construction. Exceptions are handled as in AddPointsToGP().
+
+    \param
+      :hypers_mcmc[dim+1][num_mcmc]: covariance hyperparameters (signal variance, then length scales) of each sample
+      :noises_mcmc[num_derivatives+1][num_mcmc]: noise variances of each sample
+      :max_num_threads: maximum number of threads used to update the GPs
+  \endrst*/
+    void SetHyperparameters(double const * restrict hypers_mcmc, double const * restrict noises_mcmc,
+                            int max_num_threads) OL_NONNULL_POINTERS;
 
     int num_mcmc() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
       return num_mcmc_;
@@ -163,15 +233,20 @@ struct GaussianProcessMCMC final {
     }
 
     const std::vector<double>& points_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-      return points_sampled_;
+      return *points_sampled_;
     }
 
     const std::vector<double>& points_sampled_value() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-      return points_sampled_value_;
+      return *points_sampled_value_;
     }
 
     const std::vector<int>& derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-      return derivatives_;
+      return *derivatives_;
+    }
+
+    //! squared differences of points_sampled(), shared by every GP in gaussian_process_lst
+    const PairwiseDifferences& training_differences() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+      return *training_differences_;
     }
 
     std::vector<GaussianProcess> gaussian_process_lst;
@@ -185,16 +260,18 @@ struct GaussianProcessMCMC final {
   //! number of points in ``points_sampled``
   int num_sampled_;
 
-  // state variables for prior
+  // state variables for prior; shared by every GaussianProcess in gaussian_process_lst
   //! coordinates of already-sampled points, ``X``
-  std::vector<double> points_sampled_;
+  std::shared_ptr<const std::vector<double>> points_sampled_;
   //! function values at points_sampled, ``y``
-  std::vector<double> points_sampled_value_;
+  std::shared_ptr<const std::vector<double>> points_sampled_value_;
 
   //! derivatives index
-  std::vector<int> derivatives_;
+  std::shared_ptr<const std::vector<int>> derivatives_;
   //! number of derivatives observations
   int num_derivatives_;
+  //! squared differences of points_sampled_ (with derivatives_), shared by every GaussianProcess in gaussian_process_lst
+  std::shared_ptr<const PairwiseDifferences> training_differences_;
 };
 
 template <typename DomainType>
@@ -222,6 +299,15 @@ class KnowledgeGradientMCMCEvaluator final {
       :num_pts: number of points in discrete_pts
       :num_mc_iterations: number of monte carlo iterations
       :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :max_num_threads: maximum number of threads used to reduce over the MCMC hyperparameter samples; callers running
+        inside a parallel region need nested parallelism enabled (see ScopedNestedParallelism) for values > 1 to help
+      :which_gpu: device passed to every per-hyperparameter KnowledgeGradientEvaluator, or kNoGpu
+      :cost_model: cost of sampling a point (see gpp_cost_model.hpp); this evaluator keeps its own copy.  nullptr means
+        FidelityProductCostModel over the last ``num_fidelity`` coordinates (unit cost if ``num_fidelity = 0``)
+      :distributed_context: ranks to spread the MCMC hyperparameter samples over (see gpp_distributed.hpp); with more
+        than one rank, every evaluation is a collective
+    \raise
+      InvalidValueException<int> if ``cost_model``'s dim differs from the GPs'
   \endrst*/
   explicit KnowledgeGradientMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
                                           double const * discrete_pts_lst,
@@ -229,7 +315,11 @@ class KnowledgeGradientMCMCEvaluator final {
                                           const DomainType& domain,
                                           const GradientDescentParameters& optimizer_parameters,
                                           double const * best_so_far,
-                                          std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> * evaluator_vector);
+                                          std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> * evaluator_vector,
+                                          int max_num_threads,
+                                          int which_gpu = kNoGpu,
+                                          CostModelInterface const * cost_model = nullptr,
+                                          const DistributedContext& distributed_context = DistributedContext());
 
   int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return dim_;
@@ -247,10 +337,18 @@ class KnowledgeGradientMCMCEvaluator final {
     return num_mcmc_hypers_;
   }
 
+  int max_num_threads() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_num_threads_;
+  }
+
   std::vector<KnowledgeGradientEvaluator<DomainType>> * knowledge_gradient_evaluator_list() const noexcept OL_WARN_UNUSED_RESULT {
     return knowledge_gradient_evaluator_lst;
   }
 
+  const CostModelInterface& cost_model() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return *cost_model_;
+  }
+
   std::vector<double> discrete_points_list(double const * discrete_pts_lst,
                                            int num_pts) const noexcept OL_WARN_UNUSED_RESULT {
     std::vector<double> result(num_pts*(dim_-num_fidelity_)*num_mcmc_hypers_);
@@ -265,12 +363,27 @@ class KnowledgeGradientMCMCEvaluator final {
   }
 
   /*!\rst
-    compute the cost.
+    Computes the cost of sampling ``points_to_sample``: the largest cost_model() cost among them (the q samples run
+    concurrently, so the batch takes as long as its most expensive member).
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: state with temporary storage modified
+    \return
+      the cost of sampling ``points_to_sample``
   \endrst*/
   double ComputeCost(StateType * kg_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
 
   /*!\rst
-    compute the gradient of the cost.
+    Computes the gradient of ComputeCost() wrt ``points_to_sample``: the cost_model() gradient at the most expensive
+    point (the first one, on ties) and 0 at the others.
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: state with temporary storage modified
+      :grad_cost[dim][num_to_sample]: gradient of the cost wrt each point of ``points_to_sample``
   \endrst*/
   void ComputeGradCost(StateType * kg_state, double * restrict grad_cost) const OL_NONNULL_POINTERS;
 
@@ -289,7 +402,32 @@ class KnowledgeGradientMCMCEvaluator final {
   }
 
   /*!\rst
-    Computes the knowledge gradient
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp): each sample's
+    gradient also yields its KG (see KnowledgeGradientEvaluator::ComputeObjectiveAndGradient()), and the cost is
+    computed once for both.
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: state with temporary storage modified; ``normal_rng`` modified
+      :grad_KG[dim][num_to_sample]: gradient of KG (see ComputeGradKnowledgeGradient())
+    \return
+      the knowledge gradient divided by the cost
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS {
+    return ComputeGradKnowledgeGradient(kg_state, grad_KG);
+  }
+
+  /*!\rst
+    Computes the knowledge gradient, averaged over the MCMC hyperparameter samples.
+
+    The samples are spread across ``max_num_threads`` threads.  Every sample but the last draws from its own clone of
+    ``normal_rng`` (see KnowledgeGradientMCMCState::PrepareSampleRNGs()) and the per-sample values are summed in
+    sample order, so the result does not depend on the number of threads.
+
+    Likewise over the ranks of a DistributedContext: each rank evaluates its block of the samples and the per-sample
+    values are gathered before the reduction (see ExpectedImprovementMCMCEvaluator::ComputeExpectedImprovement()).
+
     \param
       :kg_state[1]: properly configured state object
     \output
@@ -305,6 +443,7 @@ class KnowledgeGradientMCMCEvaluator final {
     concurrent experiments.
 
     ``points_to_sample`` is the "q" and ``points_being_sampled`` is the "p" in q,p-KG.
+    The MCMC samples are reduced as in ComputeKnowledgeGradient().
 
     \param
       :kg_state[1]: properly configured state object
@@ -313,8 +452,10 @@ class KnowledgeGradientMCMCEvaluator final {
       :grad_KG[dim][num_to_sample]: gradient of KG, ``\pderiv{KG(Xq \cup Xp)}{Xq_{d,i}}`` where ``Xq`` is ``points_to_sample``
       and ``Xp`` is ``points_being_sampled`` (grad KG from sampling ``points_to_sample`` with
       ``points_being_sampled`` concurrent experiments wrt each dimension of the points in ``points_to_sample``)
+    \return
+      the knowledge gradient divided by the cost, a by-product (see ComputeObjectiveAndGradient())
   \endrst*/
-  void ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS;
+  double ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(KnowledgeGradientMCMCEvaluator);
 
@@ -342,6 +483,12 @@ class KnowledgeGradientMCMCEvaluator final {
   std::vector<double> discrete_pts_lst_;
   //! number of points in discrete_pts
   const int num_pts_;
+  //! maximum number of threads used to reduce over the MCMC hyperparameter samples
+  const int max_num_threads_;
+  //! cost of sampling a point, divided out of KG
+  std::unique_ptr<CostModelInterface> cost_model_;
+  //! ranks the MCMC hyperparameter samples are spread over
+  const DistributedContext distributed_context_;
 };
 
 extern template class KnowledgeGradientMCMCEvaluator<TensorProductDomain>;
@@ -466,6 +613,18 @@ struct KnowledgeGradientMCMCState final {
   \endrst*/
   void SetupState(const EvaluatorType& kg_evaluator, double const * restrict points_to_sample);
 
+  /*!\rst
+    Points the per-sample states at their sources of randomness for one reduction over the samples.
+    The last sample draws from ``normal_rng`` itself; every other sample draws from a fresh clone of it, taken
+    before any sample runs.  So each sample sees the same stream no matter which thread runs it.
+  \endrst*/
+  void PrepareSampleRNGs();
+
+  /*!\rst
+    Points every per-sample state back at ``normal_rng``; undoes PrepareSampleRNGs().
+  \endrst*/
+  void RestoreSampleRNGs() noexcept;
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   const int dim;
@@ -479,6 +638,13 @@ struct KnowledgeGradientMCMCState final {
   const int num_union;
   //! number of points in discrete_pts
   const int num_pts;
+  //! number of MCMC hyperparameter samples
+  const int num_mcmc;
+
+  //! the normal RNG shared by the per-sample states
+  NormalRNGInterface * normal_rng;
+  //! per-sample copies of ``normal_rng`` used when reducing over the samples in parallel, ``[num_mcmc - 1]``
+  std::vector<std::unique_ptr<NormalRNGInterface>> sample_normal_rng;
 
   // gradients index
   std::vector<int> gradients;
@@ -489,12 +655,23 @@ struct KnowledgeGradientMCMCState final {
   //! ``points_to_sample`` is stored first in memory, immediately followed by ``points_being_sampled``
   std::vector<double> union_of_points;
 
+  //! cost of each point of ``points_to_sample``, ``[num_to_sample]``
+  std::vector<double> cost_of_points;
   //! track the gradient of the cost function
   std::vector<double> gradcost;
 
+  //! KG of each MCMC hyperparameter sample, ``[num_mcmc]``
+  std::vector<double> sample_values;
+  //! grad KG of each MCMC hyperparameter sample, ``[num_mcmc][num_derivatives][dim]``
+  std::vector<double> sample_grads;
+
   //! gaussian process state
   std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> * kg_state_list;
 
+  //! squared differences between the (shared) ``points_sampled`` and the current points, filled once per
+  //! SetCurrentPoint() and read by every member state's ``K(X, Xs)`` build
+  CrossPairwiseDifferences cross_differences;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(KnowledgeGradientMCMCState);
 };
 extern template struct KnowledgeGradientMCMCState<TensorProductDomain>;
@@ -515,7 +692,7 @@ extern template struct KnowledgeGradientMCMCState<SimplexIntersectTensorProductD
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
     :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
-    :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
+    :normal_rng[max_num_threads]: a NormalRNGArray of generators that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -529,7 +706,7 @@ inline OL_NONNULL_POINTERS void SetupKnowledgeGradientMCMCState(
     int num_pts, int const * restrict gradients, int num_gradients,
     int max_num_threads,
     bool configure_for_gradients,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> * kg_state_vector,
     std::vector<typename KnowledgeGradientMCMCEvaluator<DomainType>::StateType> * state_vector) {
   state_vector->reserve(max_num_threads);
@@ -537,7 +714,7 @@ inline OL_NONNULL_POINTERS void SetupKnowledgeGradientMCMCState(
     //kg_state_vector.reserve(0);
     state_vector->emplace_back(kg_evaluator, points_to_sample, points_being_sampled, num_to_sample,
                                num_being_sampled, num_pts, gradients, num_gradients, configure_for_gradients,
-                               normal_rng + i, kg_state_vector+i);
+                               &normal_rng[i], kg_state_vector+i);
   }
 }
 
@@ -654,9 +831,15 @@ void RestartedGradientDescentKGMCMCOptimization(const KnowledgeGradientMCMCEvalu
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :num_refined_starts: number of starts with the best initial KG that gradient descent refines (in parallel);
+      all ``num_multistarts`` are screened in parallel (suggest: 20)
+    :num_screening_mc_iterations: MC iterations of the first successive-halving screening round (see
+      SuccessiveHalvingSelectStartPoints(); doubled every round up to ``max_int_steps``); 0 screens every start at
+      ``max_int_steps`` (suggest: ``max_int_steps/16`` for hundreds of starts)
+    :cost_model: cost of sampling a point (see KnowledgeGradientMCMCEvaluator); nullptr for the fidelity product
   \output
     :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
     :found_flag[1]: true if ``best_next_point`` corresponds to a nonzero KG
@@ -678,17 +861,30 @@ OL_NONNULL_POINTERS void ComputeKGMCMCOptimalPointsToSampleViaMultistartGradient
     int num_pts,
     double const * best_so_far,
     int max_int_steps,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     bool * restrict found_flag,
-    double * restrict best_next_point) {
+    double * restrict best_next_point,
+    int num_refined_starts = 20,
+    int num_screening_mc_iterations = 0,
+    CostModelInterface const * cost_model = nullptr) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
   }
 
+  int k = std::min(num_refined_starts, num_multistarts); // number of indices we need (at most one per multistart)
+
+  // multistarts that cannot occupy every core leave the rest to the reduction over MCMC samples
+  int num_multistart_threads, num_sample_threads;
+  SplitThreadBudget(thread_schedule.max_num_threads, k, &num_multistart_threads, &num_sample_threads);
+  ThreadSchedule multistart_thread_schedule(thread_schedule);
+  multistart_thread_schedule.max_num_threads = num_multistart_threads;
+  ScopedNestedParallelism nested_parallelism(num_multistart_threads > 1 && num_sample_threads > 1);
+
   bool configure_for_gradients = true;
   std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> kg_evaluator_lst;
   KnowledgeGradientMCMCEvaluator<DomainType> kg_evaluator(gaussian_process_mcmc, num_fidelity, discrete_pts, num_pts, max_int_steps,
-                                                          inner_domain, optimizer_parameters_inner, best_so_far, &kg_evaluator_lst);
+                                                          inner_domain, optimizer_parameters_inner, best_so_far, &kg_evaluator_lst,
+                                                          num_sample_threads, kNoGpu, cost_model);
 
   int num_derivatives = (*kg_evaluator.knowledge_gradient_evaluator_list())[0].gaussian_process()->num_derivatives();
   std::vector<int> derivatives((*kg_evaluator.knowledge_gradient_evaluator_list())[0].gaussian_process()->derivatives());
@@ -700,33 +896,40 @@ OL_NONNULL_POINTERS void ComputeKGMCMCOptimalPointsToSampleViaMultistartGradient
                                   thread_schedule.max_num_threads, configure_for_gradients,
                                   normal_rng, kg_state_vector.data(), &state_vector);
 
-  std::vector<double> KG_starting(num_multistarts);
-  for (int i=0; i<num_multistarts; ++i){
-    state_vector[0].SetCurrentPoint(kg_evaluator, start_point_set + i*num_to_sample*gaussian_process_mcmc.dim());
-    KG_starting[i] = kg_evaluator.ComputeKnowledgeGradient(&state_vector[0]);
-  }
-
-  std::priority_queue<std::pair<double, int>> q;
-  int k = 20; // number of indices we need
-  for (int i = 0; i < KG_starting.size(); ++i) {
-    if (i < k){
-      q.push(std::pair<double, int>(-KG_starting[i], i));
-    }
-    else{
-      if (q.top().first > -KG_starting[i]){
-        q.pop();
-        q.push(std::pair<double, int>(-KG_starting[i], i));
-      }
-    }
-  }
-
+  // screen every start on the multistart threads (each with its share of the MCMC sample threads)
   std::vector<double> top_k_starting(k*num_to_sample*gaussian_process_mcmc.dim());
-  for (int i = 0; i < k; ++i) {
-    int ki = q.top().second;
-    for (int d = 0; d<num_to_sample*gaussian_process_mcmc.dim(); ++d){
-      top_k_starting[i*num_to_sample*gaussian_process_mcmc.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process_mcmc.dim() + d];
-    }
-    q.pop();
+  if (num_screening_mc_iterations > 0 && num_screening_mc_iterations < max_int_steps) {
+    // rounds below the full budget rank on a cheaper evaluator; the last round reuses kg_evaluator's states
+    auto select_at_budget = [&](int num_mc_iterations, double const * candidates, int num_candidates, int num_keep,
+                                double * kept) {
+      if (num_mc_iterations >= max_int_steps) {
+        SelectBestStartPoints(kg_evaluator, candidates, num_candidates, num_keep, num_multistart_threads,
+                              state_vector.data(), kept);
+        return;
+      }
+      std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> screen_evaluator_lst;
+      KnowledgeGradientMCMCEvaluator<DomainType> screen_evaluator(gaussian_process_mcmc, num_fidelity, discrete_pts,
+                                                                  num_pts, num_mc_iterations, inner_domain,
+                                                                  optimizer_parameters_inner, best_so_far,
+                                                                  &screen_evaluator_lst, num_sample_threads, kNoGpu,
+                                                                  cost_model);
+      const bool screen_for_gradients = false;
+      std::vector<typename KnowledgeGradientMCMCEvaluator<DomainType>::StateType> screen_state_vector;
+      std::vector<std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType>>
+          screen_kg_state_vector(thread_schedule.max_num_threads);
+      SetupKnowledgeGradientMCMCState(screen_evaluator, candidates, points_being_sampled,
+                                      num_to_sample, num_being_sampled, num_pts, derivatives.data(), num_derivatives,
+                                      thread_schedule.max_num_threads, screen_for_gradients,
+                                      normal_rng, screen_kg_state_vector.data(), &screen_state_vector);
+      SelectBestStartPoints(screen_evaluator, candidates, num_candidates, num_keep, num_multistart_threads,
+                            screen_state_vector.data(), kept);
+    };
+    SuccessiveHalvingSelectStartPoints(select_at_budget, start_point_set, num_to_sample*gaussian_process_mcmc.dim(),
+                                       num_multistarts, k, num_screening_mc_iterations, max_int_steps,
+                                       top_k_starting.data());
+  } else {
+    SelectBestStartPoints(kg_evaluator, start_point_set, num_multistarts, k, num_multistart_threads,
+                          state_vector.data(), top_k_starting.data());
   }
 
   // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
@@ -737,7 +940,7 @@ OL_NONNULL_POINTERS void ComputeKGMCMCOptimalPointsToSampleViaMultistartGradient
   GradientDescentOptimizer<KnowledgeGradientMCMCEvaluator<DomainType>, RepeatedDomain> gd_opt;
   MultistartOptimizer<GradientDescentOptimizer<KnowledgeGradientMCMCEvaluator<DomainType>, RepeatedDomain> > multistart_optimizer;
   multistart_optimizer.MultistartOptimize(gd_opt, kg_evaluator, optimizer_parameters,
-                                          repeated_domain, thread_schedule, top_k_starting.data(),
+                                          repeated_domain, multistart_thread_schedule, top_k_starting.data(),
                                           k, state_vector.data(), nullptr, &io_container);
   *found_flag = io_container.found_flag;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
@@ -768,7 +971,7 @@ OL_NONNULL_POINTERS void ComputeKGMCMCOptimalPointsToSampleViaMultistartGradient
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -777,6 +980,7 @@ OL_NONNULL_POINTERS void ComputeKGMCMCOptimalPointsToSampleViaMultistartGradient
     :function_values[num_multistarts]: KG evaluated at each point of ``initial_guesses``, in the same order as
       ``initial_guesses``; never dereferenced if nullptr
     :best_next_point[dim][num_to_sample]: points yielding the best KG according to dumb search
+    :cost_model: cost of sampling a point (see KnowledgeGradientMCMCEvaluator); nullptr for the fidelity product
 \endrst*/
 template <typename DomainType>
 void EvaluateKGMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
@@ -787,9 +991,10 @@ void EvaluateKGMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc, const
                                double const * discrete_pts,
                                int num_multistarts, int num_to_sample,
                                int num_being_sampled, int num_pts, double const * best_so_far,
-                               int max_int_steps, bool * restrict found_flag, NormalRNG * normal_rng,
+                               int max_int_steps, bool * restrict found_flag, NormalRNGArray normal_rng,
                                double * restrict function_values,
-                               double * restrict best_next_point) {
+                               double * restrict best_next_point,
+                               CostModelInterface const * cost_model = nullptr) {
     if (unlikely(num_multistarts <= 0)) {
       OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
     }
@@ -799,8 +1004,16 @@ void EvaluateKGMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc, const
     bool configure_for_gradients = false;
     std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> kg_evaluator_lst;
 
+    // short point lists leave the spare cores to the reduction over MCMC samples
+    int num_point_threads, num_sample_threads;
+    SplitThreadBudget(thread_schedule.max_num_threads, num_multistarts, &num_point_threads, &num_sample_threads);
+    ThreadSchedule point_thread_schedule(thread_schedule);
+    point_thread_schedule.max_num_threads = num_point_threads;
+    ScopedNestedParallelism nested_parallelism(num_point_threads > 1 && num_sample_threads > 1);
+
     KnowledgeGradientMCMCEvaluator<DomainType> kg_evaluator(gaussian_process_mcmc, num_fidelity, discrete_pts, num_pts, max_int_steps,
-                                                            inner_domain, optimizer_parameters_inner, best_so_far, &kg_evaluator_lst);
+                                                            inner_domain, optimizer_parameters_inner, best_so_far, &kg_evaluator_lst,
+                                                            num_sample_threads, kNoGpu, cost_model);
 
     int num_derivatives = (*kg_evaluator.knowledge_gradient_evaluator_list())[0].gaussian_process()->num_derivatives();
     std::vector<int> derivatives((*kg_evaluator.knowledge_gradient_evaluator_list())[0].gaussian_process()->derivatives());
@@ -819,7 +1032,7 @@ void EvaluateKGMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc, const
     typename NullOptimizer<KnowledgeGradientMCMCEvaluator<DomainType>, DomainType_dummy>::ParameterStruct null_parameters;
     MultistartOptimizer<NullOptimizer<KnowledgeGradientMCMCEvaluator<DomainType>, DomainType_dummy> > multistart_optimizer;
     multistart_optimizer.MultistartOptimize(null_opt, kg_evaluator, null_parameters,
-                                            dummy_domain, thread_schedule, initial_guesses,
+                                            dummy_domain, point_thread_schedule, initial_guesses,
                                             num_multistarts, state_vector.data(), function_values, &io_container);
     *found_flag = io_container.found_flag;
     std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
@@ -851,9 +1064,10 @@ void EvaluateKGMCMCAtPointList(GaussianProcessMCMC& gaussian_process_mcmc, const
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :cost_model: cost of sampling a point (see KnowledgeGradientMCMCEvaluator); nullptr for the fidelity product
   \output
     :found_flag[1]: true if best_next_point corresponds to a nonzero KG
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -870,8 +1084,9 @@ void ComputeKGMCMCOptimalPointsToSampleWithRandomStarts(GaussianProcessMCMC& gau
                                                         int num_to_sample, int num_being_sampled, int num_pts,
                                                         double const * best_so_far,
                                                         int max_int_steps, bool * restrict found_flag,
-                                                        UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng,
-                                                        double * restrict best_next_point) {
+                                                        UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng,
+                                                        double * restrict best_next_point,
+                                                        CostModelInterface const * cost_model = nullptr) {
 /*  int grid_size = 100;
   std::vector<double> starting_points(gaussian_process_mcmc.dim()*optimizer_parameters.num_multistarts*num_to_sample);
   std::vector<double> temp_points(gaussian_process_mcmc.dim()*grid_size*num_to_sample);
@@ -898,7 +1113,8 @@ void ComputeKGMCMCOptimalPointsToSampleWithRandomStarts(GaussianProcessMCMC& gau
                                                                  points_being_sampled, discrete_pts, num_multistarts,
                                                                  num_to_sample, num_being_sampled, num_pts,
                                                                  best_so_far, max_int_steps,
-                                                                 normal_rng, found_flag, best_next_point);
+                                                                 normal_rng, found_flag, best_next_point,
+                                                                 20, 0, cost_model);
 #ifdef OL_WARNING_PRINT
   if (false == *found_flag) {
     OL_WARNING_PRINTF("WARNING: %s DID NOT CONVERGE\n", OL_CURRENT_FUNCTION_NAME);
@@ -935,9 +1151,13 @@ void ComputeKGMCMCOptimalPointsToSampleWithRandomStarts(GaussianProcessMCMC& gau
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :cost_model: cost of sampling a point (see KnowledgeGradientMCMCEvaluator); nullptr for the fidelity product
+    :tile_size: if positive and less than ``num_multistarts``, stream the candidates in tiles of this many q-sets
+      (see StreamingUniformSearch()) instead of materializing all ``num_multistarts`` of them; 0 (default) for the
+      full list
   \output
     found_flag[1]: true if best_next_point corresponds to a nonzero KG
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -956,17 +1176,50 @@ void ComputeKGMCMCOptimalPointsToSampleViaLatinHypercubeSearch(GaussianProcessMC
                                                                int max_int_steps,
                                                                bool * restrict found_flag,
                                                                UniformRandomGenerator * uniform_generator,
-                                                               NormalRNG * normal_rng,
-                                                               double * restrict best_next_point) {
-  std::vector<double> initial_guesses(gaussian_process_mcmc.dim()*num_multistarts*num_to_sample);
+                                                               NormalRNGArray normal_rng,
+                                                               double * restrict best_next_point,
+                                                               CostModelInterface const * cost_model = nullptr,
+                                                               int tile_size = 0) {
   RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  if (tile_size > 0 && tile_size < num_multistarts) {
+    const int num_tiles = (num_multistarts + tile_size - 1)/tile_size;
+    // as in EvaluateKGMCMCAtPointList(): few tiles leave the spare cores to the reduction over MCMC samples
+    int num_threads, num_sample_threads;
+    SplitThreadBudget(thread_schedule.max_num_threads, num_tiles, &num_threads, &num_sample_threads);
+    ScopedNestedParallelism nested_parallelism(num_threads > 1 && num_sample_threads > 1);
+
+    std::vector<typename KnowledgeGradientState<DomainType>::EvaluatorType> kg_evaluator_lst;
+    KnowledgeGradientMCMCEvaluator<DomainType> kg_evaluator(gaussian_process_mcmc, num_fidelity, discrete_pts, num_pts,
+                                                            max_int_steps, inner_domain, optimizer_parameters_inner,
+                                                            best_so_far, &kg_evaluator_lst, num_sample_threads,
+                                                            kNoGpu, cost_model);
+    std::vector<int> derivatives(gaussian_process_mcmc.gaussian_process_lst[0].derivatives());
+
+    // the states need a valid point to start from; it is also the answer if no candidate is evaluated
+    std::vector<double> initial_point(gaussian_process_mcmc.dim()*num_to_sample);
+    int OL_UNUSED(num_initial_points) = repeated_domain.GenerateUniformPointsInDomain(1, uniform_generator,
+                                                                                      initial_point.data());
+    std::vector<typename KnowledgeGradientMCMCEvaluator<DomainType>::StateType> state_vector;
+    std::vector<std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType>> kg_state_vector(num_threads);
+    SetupKnowledgeGradientMCMCState(kg_evaluator, initial_point.data(), points_being_sampled, num_to_sample,
+                                    num_being_sampled, num_pts, derivatives.data(), derivatives.size(), num_threads,
+                                    false, normal_rng, kg_state_vector.data(), &state_vector);
+    OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), -INFINITY, initial_point.data());
+    StreamingUniformSearch(kg_evaluator, repeated_domain, num_multistarts, tile_size, num_threads,
+                           state_vector.data(), uniform_generator, &io_container);
+    *found_flag = io_container.found_flag;
+    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    return;
+  }
+
+  std::vector<double> initial_guesses(gaussian_process_mcmc.dim()*num_multistarts*num_to_sample);
   num_multistarts = repeated_domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
                                                                   initial_guesses.data());
 
   EvaluateKGMCMCAtPointList(gaussian_process_mcmc, num_fidelity, optimizer_parameters_inner, domain, inner_domain, thread_schedule, initial_guesses.data(),
                             points_being_sampled, discrete_pts, num_multistarts, num_to_sample,
                             num_being_sampled, num_pts, best_so_far, max_int_steps,
-                            found_flag, normal_rng, nullptr, best_next_point);
+                            found_flag, normal_rng, nullptr, best_next_point, cost_model);
 }
 
 
@@ -1008,9 +1261,10 @@ void ComputeKGMCMCOptimalPointsToSampleViaLatinHypercubeSearch(GaussianProcessMC
     :lhc_search_only: whether to ONLY use latin hypercube search (and skip gradient descent EI opt)
     :num_lhc_samples: number of samples to draw if/when doing latin hypercube search
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :cost_model: cost of sampling a point (see KnowledgeGradientMCMCEvaluator); nullptr for the fidelity product
   \output
     :found_flag[1]: true if best_points_to_sample corresponds to a nonzero KG if sampled simultaneously
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -1029,7 +1283,8 @@ void ComputeKGMCMCOptimalPointsToSample(GaussianProcessMCMC& gaussian_process_mc
                                         int max_int_steps, bool lhc_search_only,
                                         int num_lhc_samples, bool * restrict found_flag,
                                         UniformRandomGenerator * uniform_generator,
-                                        NormalRNG * normal_rng, double * restrict best_points_to_sample);
+                                        NormalRNGArray normal_rng, double * restrict best_points_to_sample,
+                                        CostModelInterface const * cost_model = nullptr);
 // template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
 extern template void ComputeKGMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
@@ -1039,7 +1294,7 @@ extern template void ComputeKGMCMCOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     int num_pts, double const * best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample, CostModelInterface const * cost_model);
 extern template void ComputeKGMCMCOptimalPointsToSample(
     GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
     const GradientDescentParameters& optimizer_parameters_inner,
@@ -1047,7 +1302,197 @@ extern template void ComputeKGMCMCOptimalPointsToSample(
     double const * restrict points_being_sampled, double const * discrete_pts,
     int num_to_sample, int num_being_sampled,
     int num_pts, double const * best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample,
+    CostModelInterface const * cost_model);
+
+struct PosteriorMeanMCMCState;
+
+/*!\rst
+  PosteriorMeanEvaluator for the posterior mean averaged over the GPs of a GaussianProcessMCMC (one per hyperparameter
+  sample): ``\mu_{mcmc}(x) = (1/num_mcmc) \sum_k \mu_k(x)``.  As with PosteriorMeanEvaluator, the objective (for the
+  maximizing optimizers) is ``-\mu_{mcmc}``.
+
+  Every GP shares the training points, so a state computes ``x``'s differences to them once per point and every GP's
+  ``K(X, x)`` is built from them (see PosteriorMeanMCMCState::SetCurrentPoint()): one pass over the samples per point.
+
+  This class has no state and is meant to be accessed by const reference only.
+\endrst*/
+class PosteriorMeanMCMCEvaluator final {
+ public:
+  using StateType = PosteriorMeanMCMCState;
+
+  /*!\rst
+    \param
+      :gaussian_process_mcmc: GaussianProcessMCMC object (one GaussianProcess per hyperparameter sample)
+  \endrst*/
+  explicit PosteriorMeanMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc_in);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_mcmc() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_mcmc_;
+  }
+
+  const GaussianProcessMCMC * gaussian_process_mcmc() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return gaussian_process_mcmc_;
+  }
+
+  /*!\rst
+    Wrapper for ComputePosteriorMean(); see that function for details.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * ps_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return ComputePosteriorMean(ps_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradPosteriorMean(); see that function for details.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * ps_state, double * restrict grad_PS) const OL_NONNULL_POINTERS {
+    ComputeGradPosteriorMean(ps_state, grad_PS);
+  }
+
+  /*!\rst
+    \param
+      :ps_state[1]: properly configured state object
+    \output
+      :ps_state[1]: state with temporary storage modified
+    \return
+      ``-\mu_{mcmc}`` at the state's ``point_to_sample``
+  \endrst*/
+  double ComputePosteriorMean(StateType * ps_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    \param
+      :ps_state[1]: properly configured state object (configured for gradients)
+    \output
+      :ps_state[1]: state with temporary storage modified
+      :grad_PS[dim - num_fidelity]: gradient of ``-\mu_{mcmc}`` wrt the non-fidelity coordinates of ``point_to_sample``
+  \endrst*/
+  void ComputeGradPosteriorMean(StateType * ps_state, double * restrict grad_PS) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PosteriorMeanMCMCEvaluator);
+
+ private:
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim_;
+  //! number of hyperparameter samples
+  const int num_mcmc_;
+
+  //! pointer to the GPs whose posterior means are averaged
+  const GaussianProcessMCMC * gaussian_process_mcmc_;
+};
+
+/*!\rst
+  State object for PosteriorMeanMCMCEvaluator: the ONE ``point_to_sample`` being evaluated (its fidelity coordinates
+  fixed to 1.0, as in PosteriorMeanState) and the state of each hyperparameter sample's GP at it.
+  See general comments on State structs in ``gpp_common.hpp``'s header docs.
+\endrst*/
+struct PosteriorMeanMCMCState final {
+  using EvaluatorType = PosteriorMeanMCMCEvaluator;
+
+  /*!\rst
+    Constructs a PosteriorMeanMCMCState object; see PosteriorMeanState's constructor.
+
+    \param
+      :ps_evaluator: evaluator object that specifies the GPs
+      :num_fidelity: number of fidelity coordinates (fixed to 1.0)
+      :point_to_sample[dim - num_fidelity]: point at which to evaluate the posterior mean and/or its gradient
+      :configure_for_gradients: true if this object will be used to compute gradients, false otherwise
+  \endrst*/
+  PosteriorMeanMCMCState(const EvaluatorType& ps_evaluator, const int num_fidelity_in,
+                         double const * restrict point_to_sample_in, bool configure_for_gradients) OL_NONNULL_POINTERS;
+
+  PosteriorMeanMCMCState(PosteriorMeanMCMCState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim - num_fidelity;
+  }
+
+  void GetCurrentPoint(double * restrict point_to_sample_out) const noexcept OL_NONNULL_POINTERS {
+    std::copy(point_to_sample.data(), point_to_sample.data() + dim - num_fidelity, point_to_sample_out);
+  }
+
+  /*!\rst
+    Change the point whose posterior mean (and/or gradient) is being evaluated and update every GP's state to match.
+    The differences between the training points and the new point are computed once, for every GP.
+
+    \param
+      :ps_evaluator: evaluator object that specifies the GPs
+      :point_to_sample[dim - num_fidelity]: point whose posterior mean (and/or gradient) is to be evaluated
+  \endrst*/
+  void SetCurrentPoint(const EvaluatorType& ps_evaluator,
+                       double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    SetCurrentPoint() after checking that ``ps_evaluator`` matches this state's dimension and number of GPs.
+
+    \raise
+      InvalidValueException if the evaluator's and the state's dim or num_mcmc do not match
+  \endrst*/
+  void SetupState(const EvaluatorType& ps_evaluator, double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim;
+  //! dim of the fidelity
+  const int num_fidelity;
+  //! number of points to sample; MUST be 1
+  const int num_to_sample = 1;
+  //! number of derivative terms desired (0 for no derivatives or 1)
+  const int num_derivatives;
+
+  //! point at which to evaluate the posterior mean and/or its gradient (fidelity coordinates at 1.0)
+  std::vector<double> point_to_sample;
+
+  //! state of each hyperparameter sample's GP, ``[num_mcmc]``
+  std::vector<GaussianProcess::StateType> points_to_sample_state_list;
+
+  //! squared differences between the (shared) ``points_sampled`` and ``point_to_sample``, filled once per
+  //! SetCurrentPoint() and read by every member state's ``K(X, x)`` build
+  CrossPairwiseDifferences cross_differences;
+
+  // temporary storage: preallocated space used by PosteriorMeanMCMCEvaluator's member functions
+  //! the gradient of one GP's mean evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_mu;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PosteriorMeanMCMCState);
+};
+
+/*!\rst
+  ComputeOptimalPosteriorMeanMultistart() for the posterior mean averaged over the GPs of ``gaussian_process_mcmc``
+  (see PosteriorMeanMCMCEvaluator): the recommended optimum under hyperparameter uncertainty, found in one
+  optimization rather than one per hyperparameter sample.
+
+  \param
+    :gaussian_process_mcmc: GaussianProcessMCMC object (one GaussianProcess per hyperparameter sample)
+    (the rest as in MultistartPosteriorMeanOptimization())
+  \output
+    :found_flag[1]: true if gradient descent improved on the best candidate
+    :best_next_point[dim - num_fidelity]: the point with the lowest averaged posterior mean found
+\endrst*/
+template <typename DomainType>
+void ComputeOptimalPosteriorMeanMCMC(const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+                                     const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                                     const ThreadSchedule& thread_schedule, double const * restrict start_point_set,
+                                     int num_multistarts, double const * restrict discrete_pts, int num_pts,
+                                     int num_refined_starts, bool * restrict found_flag,
+                                     double * restrict best_next_point);
+// template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
+extern template void ComputeOptimalPosteriorMeanMCMC(
+    const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+extern template void ComputeOptimalPosteriorMeanMCMC(
+    const GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_HEURISTIC_EXPECTED_IMPROVEMENT_OPTIMIZATION_HPP_
\ No newline at end of file
@@ -10,16 +10,24 @@
 #include <cmath>
 
 #include <algorithm>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <vector>
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_posterior_sample.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
@@ -30,10 +38,20 @@ KnowledgeGradientEvaluator<DomainType>::KnowledgeGradientEvaluator(const Gaussia
                                                                    int num_mc_iterations,
                                                                    const DomainType& domain,
                                                                    const GradientDescentParameters& optimizer_parameters,
-                                                                   double best_so_far)
+                                                                   double best_so_far,
+                                                                   KnowledgeGradientInnerMode inner_mode,
+                                                                   int num_warm_starts,
+                                                                   int max_num_threads,
+                                                                   int which_gpu,
+                                                                   std::size_t grad_memory_budget)
   : dim_(gaussian_process_in.dim()),
     num_fidelity_(num_fidelity),
     num_mc_iterations_(num_mc_iterations),
+    inner_mode_(inner_mode),
+    num_warm_starts_(num_warm_starts),
+    max_num_threads_(max_num_threads),
+    which_gpu_(which_gpu),
+    grad_memory_budget_(grad_memory_budget),
     best_so_far_(best_so_far),
     optimizer_parameters_(optimizer_parameters.num_multistarts, optimizer_parameters.max_num_steps,
                           optimizer_parameters.max_num_restarts, optimizer_parameters.num_steps_averaged,
@@ -42,7 +60,31 @@ KnowledgeGradientEvaluator<DomainType>::KnowledgeGradientEvaluator(const Gaussia
     domain_(domain),
     gaussian_process_(&gaussian_process_in),
     discrete_pts_(discrete_points(discrete_pts, num_pts)),
-    num_pts_(num_pts){
+    num_pts_(num_pts),
+    discrete_points_(dim_*num_pts_),
+    discrete_K_star_(gaussian_process_->num_sampled()*(1+gaussian_process_->num_derivatives())*num_pts_),
+    discrete_mean_(num_pts_) {
+  if (which_gpu_ != kNoGpu) {
+    CudaSelectDevice(which_gpu_);
+  }
+
+  // the inner problem always evaluates at fidelity 1.0
+  const int subset_dim = dim_ - num_fidelity_;
+  const int num_observations = gaussian_process_->num_sampled()*(1+gaussian_process_->num_derivatives());
+  for (int j = 0; j < num_pts_; ++j) {
+    double * restrict point = discrete_points_.data() + j*dim_;
+    std::copy(discrete_pts_.data() + j*subset_dim, discrete_pts_.data() + (j+1)*subset_dim, point);
+    std::fill(point + subset_dim, point + dim_, 1.0);
+  }
+
+  // \mu_n(D) = mean + K(X, D)^T K^{-1} y, shared by every state
+  BuildMixCovarianceMatrix(*gaussian_process_->covariance_ptr_, gaussian_process_->points_sampled().data(),
+                           discrete_points_.data(), dim_, gaussian_process_->num_sampled(), num_pts_,
+                           gaussian_process_->derivatives().data(), gaussian_process_->num_derivatives(), nullptr, 0,
+                           discrete_K_star_.data());
+  std::fill(discrete_mean_.begin(), discrete_mean_.end(), gaussian_process_->get_mean());
+  GeneralMatrixVectorMultiply(discrete_K_star_.data(), 'T', gaussian_process_->get_K_inv_y().data(), 1.0, 1.0,
+                              num_observations, num_pts_, num_observations, discrete_mean_.data());
 }
 
 template <typename DomainType>
@@ -50,6 +92,11 @@ KnowledgeGradientEvaluator<DomainType>::KnowledgeGradientEvaluator(KnowledgeGrad
   : dim_(other.dim()),
     num_fidelity_(other.num_fidelity()),
     num_mc_iterations_(other.num_mc_iterations()),
+    inner_mode_(other.inner_mode()),
+    num_warm_starts_(other.num_warm_starts()),
+    max_num_threads_(other.max_num_threads()),
+    which_gpu_(other.which_gpu()),
+    grad_memory_budget_(other.grad_memory_budget()),
     best_so_far_(other.best_so_far()),
     optimizer_parameters_(other.gradient_descent_params().num_multistarts, other.gradient_descent_params().max_num_steps,
                           other.gradient_descent_params().max_num_restarts, other.gradient_descent_params().num_steps_averaged,
@@ -57,8 +104,11 @@ KnowledgeGradientEvaluator<DomainType>::KnowledgeGradientEvaluator(KnowledgeGrad
                           other.gradient_descent_params().max_relative_change, other.gradient_descent_params().tolerance),
     domain_(other.domain()),
     gaussian_process_(other.gaussian_process()),
-    discrete_pts_(other.discrete_pts_copy()),
-    num_pts_(other.number_discrete_pts()){
+    discrete_pts_(std::move(other.discrete_pts_)),
+    num_pts_(other.number_discrete_pts()),
+    discrete_points_(std::move(other.discrete_points_)),
+    discrete_K_star_(std::move(other.discrete_K_star_)),
+    discrete_mean_(std::move(other.discrete_mean_)) {
 }
 
 /*!\rst
@@ -69,7 +119,6 @@ KnowledgeGradientEvaluator<DomainType>::KnowledgeGradientEvaluator(KnowledgeGrad
 template <typename DomainType>
 double KnowledgeGradientEvaluator<DomainType>::ComputeKnowledgeGradient(StateType * kg_state) const {
   int num_union = kg_state->num_union;
-  int num_gradients_to_sample = kg_state->num_gradients_to_sample;
 
   double best_posterior = best_so_far_;
   for (int j = 0; j < num_union; ++j) {
@@ -78,29 +127,185 @@ double KnowledgeGradientEvaluator<DomainType>::ComputeKnowledgeGradient(StateTyp
     }
   }
 
+  ComputeOptimalFuturePosteriorMeans(kg_state);
+
   double aggregate = 0.0;
-  kg_state->normal_rng->ResetToMostRecentSeed();
   for (int i = 0; i < num_mc_iterations_; ++i) {
-    if (i % 2 == 1){
-      for (int j = 0; j < num_union*(1+num_gradients_to_sample); ++j) {
-        kg_state->normals[j + i*num_union*(1+num_gradients_to_sample)] = -kg_state->normals[j + (i-1)*num_union*(1+num_gradients_to_sample)];// - 2.0;
+    aggregate += best_posterior + kg_state->best_function_value[i];
+  }
+  return aggregate/static_cast<double>(num_mc_iterations_);
+}
+
+template <typename DomainType>
+void KnowledgeGradientEvaluator<DomainType>::ComputeOptimalFuturePosteriorMeans(StateType * kg_state) const {
+  const int num_union = kg_state->num_union;
+  const int num_gradients_to_sample = kg_state->num_gradients_to_sample;
+  const int num_normals = num_union*(1+num_gradients_to_sample);
+
+  {
+    OL_PROFILE_SCOPE(ProfilePhase::kMonteCarloSampling);
+    OL_PROFILE_COUNT(ProfileCounter::kMonteCarloSamples, num_mc_iterations_);
+    if (kg_state->gpu_workspace.enabled()) {
+      CudaDrawKnowledgeGradientNormals(num_normals, num_mc_iterations_, &kg_state->gpu_workspace,
+                                       kg_state->normals.data());
+    } else {
+      kg_state->normal_rng->ResetToMostRecentSeed();
+      for (int i = 0; i < num_mc_iterations_; ++i) {
+        double * restrict normals = kg_state->normals.data() + i*num_normals;
+        if (i % 2 == 1) {
+          for (int j = 0; j < num_normals; ++j) {
+            normals[j] = -normals[j - num_normals];
+          }
+        } else {
+          kg_state->normal_rng->Fill(normals, num_normals);
+        }
       }
     }
-    else {
-      for (int j = 0; j < num_union*(1+num_gradients_to_sample); ++j) {
-        kg_state->normals[j + i*num_union*(1+num_gradients_to_sample)] = (*(kg_state->normal_rng))();//- 1.0;
+  }
+
+  if (inner_mode_ == KnowledgeGradientInnerMode::kDiscrete ||
+      inner_mode_ == KnowledgeGradientInnerMode::kDiscreteThenGradientDescent) {
+    ComputeDiscreteOptimalFuturePosteriorMeans(kg_state);
+    if (inner_mode_ == KnowledgeGradientInnerMode::kDiscrete) {
+      return;
+    }
+  } else {
+    // only the start point search uses it; each iteration scans the discretized set with it below
+    ComputeDiscretePosteriorMeanUpdate(kg_state);
+  }
+
+  const bool scan_discretized_set = inner_mode_ == KnowledgeGradientInnerMode::kGradientDescent;
+  const int num_discrete_points = num_union + num_pts_;
+  const int subset_dim = dim_ - num_fidelity_;
+  const int max_num_warm_starts = kg_state->max_num_warm_starts;
+  const int num_warm_start_points = kg_state->num_warm_start_points;
+
+  ParallelForEachIndex(max_num_threads_, num_mc_iterations_, [&](int i) {
+      if (scan_discretized_set) {
+        // future posterior mean on D from the shared mean and update directions: O(num_normals) per point
+        double const * restrict normals = kg_state->normals.data() + i*num_normals;
+        int winner = 0;
+        double best_future_mean = std::numeric_limits<double>::infinity();
+        for (int j = 0; j < num_discrete_points; ++j) {
+          double future_mean = kg_state->discrete_mean[j] +
+              DotProduct(kg_state->discrete_chol_inverse_cov.data() + j*num_normals, normals, num_normals);
+          if (future_mean < best_future_mean) {
+            best_future_mean = future_mean;
+            winner = j;
+          }
+        }
+        kg_state->discrete_winner[i] = winner;
       }
+      double const * start_point_set = DiscretizedSetPoint(*kg_state, kg_state->discrete_winner[i]);
+      double * restrict warm_start_points = kg_state->warm_start_points.data() + i*max_num_warm_starts*subset_dim;
+      ComputeOptimalFuturePosteriorMean(*gaussian_process_, num_fidelity_, kg_state->normals.data() + i*num_normals,
+                                        kg_state->union_of_points.data(), num_union, kg_state->gradients.data(), num_gradients_to_sample,
+                                        kg_state->cholesky_to_sample_var.data(), kg_state->points_to_sample_state.K_inv_times_K_star.data(),
+                                        optimizer_parameters_, domain_, 1, start_point_set, 1,
+                                        warm_start_points, num_warm_start_points, &kg_state->inner_state_vectors[i],
+                                        kg_state->best_function_value.data() + i, kg_state->best_point.data() + i*dim_);
+      if (max_num_warm_starts > 0) {
+        std::copy(kg_state->best_point.data() + i*dim_, kg_state->best_point.data() + i*dim_ + subset_dim,
+                  warm_start_points + kg_state->next_warm_start*subset_dim);
+      }
+    });
+
+  if (max_num_warm_starts > 0) {
+    kg_state->num_warm_start_points = std::min(num_warm_start_points + 1, max_num_warm_starts);
+    kg_state->next_warm_start = (kg_state->next_warm_start + 1) % max_num_warm_starts;
+  }
+}
+
+template <typename DomainType>
+void KnowledgeGradientEvaluator<DomainType>::ComputeDiscretePosteriorMeanUpdate(StateType * kg_state) const {
+  const int num_union = kg_state->num_union;
+  const int num_gradients_to_sample = kg_state->num_gradients_to_sample;
+  const int num_normals = num_union*(1+num_gradients_to_sample);
+  const int num_discrete_points = num_union + num_pts_;
+  const int subset_dim = dim_ - num_fidelity_;
+  const int num_observations = gaussian_process_->num_sampled()*(1+gaussian_process_->num_derivatives());
+  double * restrict discrete_pts_chol_inverse_cov = kg_state->discrete_chol_inverse_cov.data() + num_union*num_normals;
+
+  // subset_union_of_points only holds the non-fidelity coordinates; the inner problem always evaluates at fidelity 1.0
+  for (int j = 0; j < num_union; ++j) {
+    double * restrict point = kg_state->discrete_points.data() + j*dim_;
+    std::copy(kg_state->subset_union_of_points.data() + j*subset_dim,
+              kg_state->subset_union_of_points.data() + (j+1)*subset_dim, point);
+    std::fill(point + subset_dim, point + dim_, 1.0);
+  }
+
+  // \mu_n(D) = mean + K(X, D)^T K^{-1} y; discrete_pts' part was formed at construction
+  BuildMixCovarianceMatrix(*gaussian_process_->covariance_ptr_, gaussian_process_->points_sampled().data(),
+                           kg_state->discrete_points.data(), dim_, gaussian_process_->num_sampled(), num_union,
+                           gaussian_process_->derivatives().data(), gaussian_process_->num_derivatives(), nullptr, 0,
+                           kg_state->discrete_K_star.data());
+  std::fill(kg_state->discrete_mean.begin(), kg_state->discrete_mean.begin() + num_union, gaussian_process_->get_mean());
+  GeneralMatrixVectorMultiply(kg_state->discrete_K_star.data(), 'T', gaussian_process_->get_K_inv_y().data(), 1.0, 1.0,
+                              num_observations, num_union, num_observations, kg_state->discrete_mean.data());
+  std::copy(discrete_mean_.begin(), discrete_mean_.end(), kg_state->discrete_mean.begin() + num_union);
+
+  // L^{-1} \Sigma_n(U, D) = L^{-1} (K(U, D) - (K^{-1} K(X, U))^T K(X, D)), the union's columns and then discrete_pts'
+  BuildMixCovarianceMatrix(*gaussian_process_->covariance_ptr_, kg_state->union_of_points.data(),
+                           kg_state->discrete_points.data(), dim_, num_union, num_union,
+                           kg_state->gradients.data(), num_gradients_to_sample, nullptr, 0,
+                           kg_state->discrete_chol_inverse_cov.data());
+  BuildMixCovarianceMatrix(*gaussian_process_->covariance_ptr_, kg_state->union_of_points.data(),
+                           discrete_points_.data(), dim_, num_union, num_pts_,
+                           kg_state->gradients.data(), num_gradients_to_sample, nullptr, 0,
+                           discrete_pts_chol_inverse_cov);
+  GeneralMatrixMatrixMultiply(kg_state->points_to_sample_state.K_inv_times_K_star.data(), 'T', kg_state->discrete_K_star.data(),
+                              -1.0, 1.0, num_normals, num_observations, num_union,
+                              kg_state->discrete_chol_inverse_cov.data());
+  GeneralMatrixMatrixMultiply(kg_state->points_to_sample_state.K_inv_times_K_star.data(), 'T', discrete_K_star_.data(),
+                              -1.0, 1.0, num_normals, num_observations, num_pts_, discrete_pts_chol_inverse_cov);
+  TriangularMatrixMatrixSolve(kg_state->cholesky_to_sample_var.data(), 'N', num_normals, num_discrete_points, num_normals,
+                              kg_state->discrete_chol_inverse_cov.data());
+}
+
+template <typename DomainType>
+void KnowledgeGradientEvaluator<DomainType>::ComputeDiscreteOptimalFuturePosteriorMeans(StateType * kg_state) const {
+  OL_PROFILE_SCOPE(ProfilePhase::kKnowledgeGradientInnerOptimization);
+  OL_PROFILE_COUNT(ProfileCounter::kKnowledgeGradientInnerSolves, num_mc_iterations_);
+  const int num_union = kg_state->num_union;
+  const int num_normals = num_union*(1+kg_state->num_gradients_to_sample);
+  const int num_discrete_points = num_union + num_pts_;
+  const int subset_dim = dim_ - num_fidelity_;
+
+  ComputeDiscretePosteriorMeanUpdate(kg_state);
+
+  if (kg_state->gpu_workspace.enabled()) {
+    // the device already holds this evaluation's normals
+    CudaComputeDiscreteFutureMeanWinners(kg_state->discrete_chol_inverse_cov.data(), kg_state->discrete_mean.data(),
+                                         num_normals, num_discrete_points, num_mc_iterations_, &kg_state->gpu_workspace,
+                                         kg_state->best_function_value.data(), kg_state->discrete_winner.data());
+    for (int i = 0; i < num_mc_iterations_; ++i) {
+      double const * winner = DiscretizedSetPoint(*kg_state, kg_state->discrete_winner[i]);
+      std::copy(winner, winner + subset_dim, kg_state->best_point.data() + i*dim_);
     }
+    return;
+  }
+
+  // future posterior mean updates for every iteration: (L^{-1} \Sigma_n(U, D))^T * normals
+  GeneralMatrixMatrixMultiply(kg_state->discrete_chol_inverse_cov.data(), 'T', kg_state->normals.data(), 1.0, 0.0,
+                              num_discrete_points, num_normals, num_mc_iterations_, kg_state->discrete_future_mean.data());
 
-    double best_function_value = 0.0;
-    ComputeOptimalFuturePosteriorMean(*gaussian_process_, num_fidelity_, kg_state->normals.data() + i*num_union*(1+num_gradients_to_sample), kg_state->union_of_points.data(),
-                                      num_union, kg_state->gradients.data(), num_gradients_to_sample, kg_state->cholesky_to_sample_var.data(),
-                                      kg_state->points_to_sample_state.K_inv_times_K_star.data(), optimizer_parameters_, domain_,
-                                      1, kg_state->discretized_set.data(), num_union + num_pts_,
-                                      &best_function_value, kg_state->best_point.data());
-    aggregate += best_posterior + best_function_value;
+  for (int i = 0; i < num_mc_iterations_; ++i) {
+    double const * restrict future_mean_update = kg_state->discrete_future_mean.data() + i*num_discrete_points;
+    int winner = 0;
+    double best_future_mean = kg_state->discrete_mean[0] + future_mean_update[0];
+    for (int j = 1; j < num_discrete_points; ++j) {
+      double future_mean = kg_state->discrete_mean[j] + future_mean_update[j];
+      if (future_mean < best_future_mean) {
+        best_future_mean = future_mean;
+        winner = j;
+      }
+    }
+    // FuturePosteriorMeanEvaluator maximizes the negated mean
+    kg_state->best_function_value[i] = -best_future_mean;
+    kg_state->discrete_winner[i] = winner;
+    double const * winner_point = DiscretizedSetPoint(*kg_state, winner);
+    std::copy(winner_point, winner_point + subset_dim, kg_state->best_point.data() + i*dim_);
   }
-  return aggregate/static_cast<double>(num_mc_iterations_);
 }
 
 /*!\rst
@@ -110,9 +315,10 @@ double KnowledgeGradientEvaluator<DomainType>::ComputeKnowledgeGradient(StateTyp
   corresponding ``improvement <= 0.0``.
   Thus ``\nabla(\mu)`` only contributes when the ``winner`` (point w/best improvement this iteration) is the current point.
   That is, the gradient of ``\mu`` at ``x_i`` wrt ``x_j`` is 0 unless ``i == j`` (and only this result is stored in
-  ``kg_state->grad_mu``).  The interaction with ``kg_state->grad_chol_decomp`` is harder to know a priori (like with
-  ``grad_mu``) and has a more complex structure (rank 3 tensor), so the derivative wrt ``x_j`` is computed fully, and
-  the relevant submatrix (indexed by the current ``winner``) is accessed each iteration.
+  ``kg_state->grad_mu``).  The interaction with the cholesky factor ``L`` of the variance and the covariance with each
+  iteration's best point is harder to know a priori; rather than differentiating both wrt every coordinate of every
+  point up front, their adjoints are summed over the mc iterations and backpropagated in reverse mode
+  (ComputeAdjointGradCovarianceOfPoints() per block of iterations, ComputeAdjointGradCholeskyVarianceOfPoints() once).
   .. Note:: comments here are copied to _compute_grad_knowledge_gradient_monte_carlo() in python_version/knowledge_gradient.py
 \endrst*/
 template <typename DomainType>
@@ -128,10 +334,6 @@ double KnowledgeGradientEvaluator<DomainType>::ComputeGradKnowledgeGradient(Stat
     }
   }
 
-  // compute the grad of chol among points to sample.
-  gaussian_process_->ComputeGradCholeskyVarianceOfPoints(&(kg_state->points_to_sample_state),
-                                                         kg_state->cholesky_to_sample_var.data(),
-                                                         kg_state->grad_chol_decomp.data());
   int winner_so_far = -1;
   double best_posterior = best_so_far_;
   for (int j = 0; j < num_union; ++j){
@@ -149,53 +351,58 @@ double KnowledgeGradientEvaluator<DomainType>::ComputeGradKnowledgeGradient(Stat
     }
   }
   std::fill(kg_state->best_point.begin(), kg_state->best_point.end(), 1.0);
+  ComputeOptimalFuturePosteriorMeans(kg_state);
+
   double aggregate = 0.0;
-  kg_state->normal_rng->ResetToMostRecentSeed();
   for (int i = 0; i < num_mc_iterations_; ++i) {
-    if (i % 2 == 1){
-      for (int j = 0; j < num_union*(1+num_gradients_to_sample); ++j) {
-        kg_state->normals[j + i*num_union*(1+num_gradients_to_sample)] = -kg_state->normals[j + (i-1)*num_union*(1+num_gradients_to_sample)];
-      }
-    }
-    else {
-      for (int j = 0; j < num_union*(1+num_gradients_to_sample); ++j) {
-        kg_state->normals[j + i*num_union*(1+num_gradients_to_sample)] = (*(kg_state->normal_rng))();// - 1.0;
-      }
-    }
-
-    double best_function_value = 0.0;
-    ComputeOptimalFuturePosteriorMean(*gaussian_process_, num_fidelity_, kg_state->normals.data() + i*num_union*(1+num_gradients_to_sample),
-                                      kg_state->union_of_points.data(), num_union, kg_state->gradients.data(), num_gradients_to_sample,
-                                      kg_state->cholesky_to_sample_var.data(), kg_state->points_to_sample_state.K_inv_times_K_star.data(), optimizer_parameters_, domain_,
-                                      1, kg_state->discretized_set.data(), num_union + num_pts_,
-                                      &best_function_value, kg_state->best_point.data() + i*dim_);
-    aggregate += best_posterior + best_function_value;
+    aggregate += best_posterior + kg_state->best_function_value[i];
   }  // end for i: num_mc_iterations_
   double KG =aggregate/static_cast<double>(num_mc_iterations_);
 
-  gaussian_process_->ComputeCovarianceOfPoints(&(kg_state->points_to_sample_state), kg_state->best_point.data(), num_mc_iterations_,
-                                               nullptr, 0, false, nullptr, kg_state->chol_inverse_cov.data());
-  TriangularMatrixMatrixSolve(kg_state->cholesky_to_sample_var.data(), 'N', num_union*(1+num_gradients_to_sample), num_mc_iterations_,
-                              num_union*(1+num_gradients_to_sample), kg_state->chol_inverse_cov.data());
-
-  gaussian_process_->ComputeGradInverseCholeskyCovarianceOfPoints(&(kg_state->points_to_sample_state),
-                                                                  kg_state->cholesky_to_sample_var.data(),
-                                                                  kg_state->grad_chol_decomp.data(),
-                                                                  kg_state->chol_inverse_cov.data(),
-                                                                  kg_state->best_point.data(), num_mc_iterations_, false, nullptr,
-                                                                  kg_state->grad_chol_inverse_cov.data());
-
-  // let L_{d,i,j,k} = grad_chol_decomp, d over dim_, i, j over num_union, k over num_to_sample
-  // we want to compute: agg_dx_{d,k} = L_{d,i,j=winner,k} * normals_i
-  // TODO(GH-92): Form this as one GeneralMatrixVectorMultiply() call by storing data as L_{d,i,k,j} if it's faster.
-  double const * restrict grad_chol_decomp_winner_block = kg_state->grad_chol_inverse_cov.data();
-  for (int k = 0; k < kg_state->num_to_sample; ++k) {
-    for (int i = 0; i < num_mc_iterations_; ++i){
-      GeneralMatrixVectorMultiply(grad_chol_decomp_winner_block, 'N', kg_state->normals.data() + i*num_union*(1+num_gradients_to_sample), -1.0, 1.0,
-                                  dim_, num_union*(1+num_gradients_to_sample), dim_, kg_state->aggregate.data() + k*dim_);
-      grad_chol_decomp_winner_block += dim_*num_union*(1+num_gradients_to_sample);
+  // reverse mode: with C = \Sigma(U, best points), Y = L^{-1} * C, and Z the normals, the mc estimate depends on
+  // points_to_sample through -\sum_i Z_{*,i}^T * Y_{*,i}, whose adjoints are
+  //   \bar{C} = -L^{-T} * Z  and  \bar{L} = tril(L^{-T} * Z * Y^T)
+  // \bar{C} is backpropagated per block of mc iterations (its columns belong to different best points);
+  // \bar{L} is summed over all iterations and backpropagated through the cholesky factorization once.
+  // Blocks (grad_block_size iterations each) bound the state's memory by the evaluator's grad_memory_budget().
+  const int num_union_gradients = num_union*(1+num_gradients_to_sample);
+  double * restrict chol_adjoint = kg_state->chol_adjoint.data();
+  std::fill(kg_state->chol_adjoint.begin(), kg_state->chol_adjoint.end(), 0.0);
+  for (int block_start = 0; block_start < num_mc_iterations_; block_start += kg_state->grad_block_size) {
+    const int block_size = std::min(kg_state->grad_block_size, num_mc_iterations_ - block_start);
+    double const * restrict best_point_block = kg_state->best_point.data() + block_start*dim_;
+    double * restrict chol_inverse_cov = kg_state->chol_inverse_cov.data();
+    double * restrict cov_adjoint = kg_state->cov_adjoint.data();
+    gaussian_process_->ComputeCovarianceOfPoints(&(kg_state->points_to_sample_state), best_point_block, block_size,
+                                                 nullptr, 0, false, nullptr, chol_inverse_cov);
+    TriangularMatrixMatrixSolve(kg_state->cholesky_to_sample_var.data(), 'N', num_union_gradients, block_size,
+                                num_union_gradients, chol_inverse_cov);
+
+    // L^{-T} * Z
+    std::copy(kg_state->normals.data() + block_start*num_union_gradients,
+              kg_state->normals.data() + (block_start + block_size)*num_union_gradients, cov_adjoint);
+    TriangularMatrixMatrixSolve(kg_state->cholesky_to_sample_var.data(), 'T', num_union_gradients, block_size,
+                                num_union_gradients, cov_adjoint);
+
+    for (int i = 0; i < block_size; ++i) {
+      double const * restrict chol_inverse_cov_column = chol_inverse_cov + i*num_union_gradients;
+      double * restrict cov_adjoint_column = cov_adjoint + i*num_union_gradients;
+      for (int b = 0; b < num_union_gradients; ++b) {
+        for (int a = b; a < num_union_gradients; ++a) {
+          chol_adjoint[b*num_union_gradients + a] += cov_adjoint_column[a]*chol_inverse_cov_column[b];
+        }
+      }
+      for (int a = 0; a < num_union_gradients; ++a) {
+        cov_adjoint_column[a] = -cov_adjoint_column[a];
+      }
     }
+
+    gaussian_process_->ComputeAdjointGradCovarianceOfPoints(&(kg_state->points_to_sample_state), best_point_block,
+                                                            block_size, cov_adjoint, kg_state->aggregate.data());
   }
+  gaussian_process_->ComputeAdjointGradCholeskyVarianceOfPoints(&(kg_state->points_to_sample_state),
+                                                                kg_state->cholesky_to_sample_var.data(), chol_adjoint,
+                                                                kg_state->aggregate.data());
 
   for (int k = 0; k < kg_state->num_to_sample*dim_; ++k) {
     grad_KG[k] = kg_state->aggregate[k]/static_cast<double>(num_mc_iterations_);
@@ -205,12 +412,14 @@ double KnowledgeGradientEvaluator<DomainType>::ComputeGradKnowledgeGradient(Stat
 
 template class KnowledgeGradientEvaluator<TensorProductDomain>;
 template class KnowledgeGradientEvaluator<SimplexIntersectTensorProductDomain>;
+template class KnowledgeGradientEvaluator<TrustRegionDomain>;
 
 template <typename DomainType>
 void KnowledgeGradientState<DomainType>::SetCurrentPoint(const EvaluatorType& kg_evaluator,
                                                          double const * restrict points_to_sample) {
-  // update points_to_sample in union_of_points
+  // update points_to_sample in union_of_points and subset_union_of_points; points_being_sampled does not move
   std::copy(points_to_sample, points_to_sample + num_to_sample*dim, union_of_points.data());
+  UpdateSubsetUnionOfPoints(kg_evaluator.num_fidelity(), 0, num_to_sample);
 
   // evaluate derived quantities for the GP
   points_to_sample_state.SetupState(*kg_evaluator.gaussian_process(), union_of_points.data(),
@@ -233,21 +442,35 @@ KnowledgeGradientState<DomainType>::KnowledgeGradientState(const EvaluatorType&
     num_gradients_to_sample(num_gradients_in),
     union_of_points(BuildUnionOfPoints(points_to_sample, points_being_sampled,
                                        num_to_sample, num_being_sampled, dim)),
-    subset_union_of_points(SubsetData(union_of_points.data(), num_union, kg_evaluator.num_fidelity())),
-    discretized_set(BuildUnionOfPoints(subset_union_of_points.data(), kg_evaluator.discrete_pts_copy().data(),
-                                       num_union, kg_evaluator.number_discrete_pts(), dim - kg_evaluator.num_fidelity())),
+    subset_union_of_points((dim - kg_evaluator.num_fidelity())*num_union),
     points_to_sample_state(*kg_evaluator.gaussian_process(), union_of_points.data(), num_union,
                            gradients_in, num_gradients_in, num_derivatives, true, configure_for_gradients),
     normal_rng(normal_rng_in),
     cholesky_to_sample_var(Square(num_union*(1+num_gradients_to_sample))),
-    grad_chol_decomp(dim*Square(num_union*(1+num_gradients_to_sample))*num_derivatives),
+    chol_adjoint(Square(num_union*(1+num_gradients_to_sample))),
     to_sample_mean_(num_union),
     grad_mu(dim*num_derivatives),
     aggregate(dim*num_derivatives),
     normals(num_union*(1+num_gradients_to_sample)*num_iterations),
     best_point(dim*num_iterations),
-    chol_inverse_cov(num_iterations*num_union*(1+num_gradients_to_sample)),
-    grad_chol_inverse_cov(dim*num_iterations*num_union*(1+num_gradients_to_sample)*num_derivatives) {
+    best_function_value(num_iterations),
+    discrete_points(dim*num_union),
+    discrete_K_star(kg_evaluator.gaussian_process()->num_sampled()*(1+kg_evaluator.gaussian_process()->num_derivatives())*
+                    num_union),
+    discrete_mean(num_union + kg_evaluator.number_discrete_pts()),
+    discrete_chol_inverse_cov(num_union*(1+num_gradients_to_sample)*(num_union + kg_evaluator.number_discrete_pts())),
+    discrete_future_mean(UsesDiscreteInnerMode(kg_evaluator) ? (num_union + kg_evaluator.number_discrete_pts())*num_iterations : 0),
+    discrete_winner(num_iterations),
+    max_num_warm_starts(NumWarmStarts(kg_evaluator)),
+    num_warm_start_points(0),
+    next_warm_start(0),
+    warm_start_points((dim - kg_evaluator.num_fidelity())*max_num_warm_starts*num_iterations),
+    grad_block_size(GradMonteCarloBlockSize(kg_evaluator, num_union*(1+num_gradients_to_sample), num_derivatives)),
+    chol_inverse_cov(grad_block_size*num_union*(1+num_gradients_to_sample)),
+    cov_adjoint(num_derivatives > 0 ? grad_block_size*num_union*(1+num_gradients_to_sample) : 0),
+    inner_state_vectors(kg_evaluator.inner_mode() == KnowledgeGradientInnerMode::kDiscrete ? 0 : num_iterations),
+    gpu_workspace(kg_evaluator.which_gpu(), normal_rng_in) {
+  UpdateSubsetUnionOfPoints(kg_evaluator.num_fidelity(), 0, num_union);
   PreCompute(kg_evaluator, points_to_sample);
 }
 
@@ -265,6 +488,56 @@ void KnowledgeGradientState<DomainType>::SetupState(const EvaluatorType& kg_eval
   SetCurrentPoint(kg_evaluator, points_to_sample);
 }
 
+template <typename DomainType>
+bool KnowledgeGradientState<DomainType>::Reconfigure(const EvaluatorType& kg_evaluator, double const * restrict points_to_sample,
+                                                     double const * restrict points_being_sampled, int num_to_sample_in,
+                                                     int num_being_sampled_in, int OL_UNUSED(num_pts_in),
+                                                     int const * restrict gradients_in, int num_gradients_in,
+                                                     bool configure_for_gradients, NormalRNGInterface * normal_rng_in) {
+  if (dim != kg_evaluator.dim() || num_to_sample != num_to_sample_in || num_being_sampled != num_being_sampled_in ||
+      num_derivatives != (configure_for_gradients ? num_to_sample : 0) ||
+      num_iterations != kg_evaluator.num_mc_iterations() || max_num_warm_starts != NumWarmStarts(kg_evaluator) ||
+      grad_block_size != GradMonteCarloBlockSize(kg_evaluator, num_union*(1+num_gradients_in), num_derivatives) ||
+      num_gradients_to_sample != num_gradients_in || !std::equal(gradients.begin(), gradients.end(), gradients_in) ||
+      points_to_sample_state.num_gradients_sampled != kg_evaluator.gaussian_process()->num_derivatives() ||
+      gpu_workspace.which_gpu != kg_evaluator.which_gpu()) {
+    return false;
+  }
+
+  const int subset_dim = dim - kg_evaluator.num_fidelity();
+  const int num_pts = kg_evaluator.number_discrete_pts();
+  std::copy(points_to_sample, points_to_sample + dim*num_to_sample, union_of_points.data());
+  std::copy(points_being_sampled, points_being_sampled + dim*num_being_sampled, union_of_points.data() + dim*num_to_sample);
+
+  // SetCurrentPoint() below refreshes the points_to_sample part
+  subset_union_of_points.resize(subset_dim*num_union);
+  UpdateSubsetUnionOfPoints(kg_evaluator.num_fidelity(), num_to_sample, num_union);
+
+  normal_rng = normal_rng_in;
+  gpu_workspace.Reseed(normal_rng);
+
+  const bool uses_discrete_inner_mode = UsesDiscreteInnerMode(kg_evaluator);
+  const int num_discrete_points = num_union + num_pts;
+  const int num_normals = num_union*(1+num_gradients_to_sample);
+  const int num_observations = kg_evaluator.gaussian_process()->num_sampled()*(1+kg_evaluator.gaussian_process()->num_derivatives());
+  discrete_points.resize(dim*num_union);
+  discrete_K_star.resize(num_observations*num_union);
+  discrete_mean.resize(num_discrete_points);
+  discrete_chol_inverse_cov.resize(num_normals*num_discrete_points);
+  discrete_future_mean.resize(uses_discrete_inner_mode ? num_discrete_points*num_iterations : 0);
+  discrete_winner.resize(num_iterations);
+
+  // warm starts belong to one optimization; the new one starts without history
+  num_warm_start_points = 0;
+  next_warm_start = 0;
+  warm_start_points.resize(subset_dim*max_num_warm_starts*num_iterations);
+  inner_state_vectors.resize(kg_evaluator.inner_mode() == KnowledgeGradientInnerMode::kDiscrete ? 0 : num_iterations);
+
+  // recomputes the GP quantities (resized for the evaluator's GP) and the cholesky factor
+  SetCurrentPoint(kg_evaluator, points_to_sample);
+  return true;
+}
+
 template <typename DomainType>
 void KnowledgeGradientState<DomainType>::PreCompute(const EvaluatorType& kg_evaluator,
                                                     double const * restrict points_to_sample) {
@@ -295,6 +568,239 @@ void KnowledgeGradientState<DomainType>::PreCompute(const EvaluatorType& kg_eval
 
 template struct KnowledgeGradientState<TensorProductDomain>;
 template struct KnowledgeGradientState<SimplexIntersectTensorProductDomain>;
+template struct KnowledgeGradientState<TrustRegionDomain>;
+
+namespace {
+
+/*!\rst
+  ``\Phi(r) - \Phi(l)`` for ``l <= r`` (either may be infinite), from whichever tail keeps the difference accurate.
+\endrst*/
+double NormalProbabilityBetween(const boost::math::normal_distribution<double>& normal, double left, double right) {
+  if (left > 0.0) {
+    double upper_left = boost::math::cdf(boost::math::complement(normal, left));
+    double upper_right = std::isinf(right) ? 0.0 : boost::math::cdf(boost::math::complement(normal, right));
+    return upper_left - upper_right;
+  }
+  double lower_left = std::isinf(left) ? 0.0 : boost::math::cdf(normal, left);
+  double lower_right = std::isinf(right) ? 1.0 : boost::math::cdf(normal, right);
+  return lower_right - lower_left;
+}
+
+/*!\rst
+  ``\phi(z)``, which is 0 at ``z = \pm\infty``.
+\endrst*/
+double NormalDensity(const boost::math::normal_distribution<double>& normal, double z) {
+  return std::isinf(z) ? 0.0 : boost::math::pdf(normal, z);
+}
+
+}  // end unnamed namespace
+
+OnePotentialSampleKnowledgeGradientEvaluator::OnePotentialSampleKnowledgeGradientEvaluator(
+    const GaussianProcess& gaussian_process_in, double const * discrete_pts, int num_pts, double best_so_far)
+    : dim_(gaussian_process_in.dim()),
+      num_pts_(num_pts),
+      best_so_far_(best_so_far),
+      normal_(0.0, 1.0),
+      gaussian_process_(&gaussian_process_in),
+      discrete_pts_(discrete_pts, discrete_pts + dim_*num_pts),
+      discrete_mean_(num_pts) {
+  // K(X, discrete_pts) and K^-1 * K(X, discrete_pts) are exactly the Ks quantities of a state at discrete_pts
+  GaussianProcess::StateType discrete_state(gaussian_process_in, discrete_pts_.data(), num_pts_, nullptr, 0, 0, true);
+  gaussian_process_->ComputeMeanOfPoints(discrete_state, discrete_mean_.data());
+  K_inv_times_K_discrete_ = std::move(discrete_state.K_inv_times_K_star);
+}
+
+OnePotentialSampleKnowledgeGradientEvaluator::OnePotentialSampleKnowledgeGradientEvaluator(
+    OnePotentialSampleKnowledgeGradientEvaluator&& other)
+    : dim_(other.dim_),
+      num_pts_(other.num_pts_),
+      best_so_far_(other.best_so_far_),
+      normal_(0.0, 1.0),
+      gaussian_process_(other.gaussian_process_),
+      discrete_pts_(std::move(other.discrete_pts_)),
+      discrete_mean_(std::move(other.discrete_mean_)),
+      K_inv_times_K_discrete_(std::move(other.K_inv_times_K_discrete_)) {
+}
+
+void OnePotentialSampleKnowledgeGradientEvaluator::ComputeFuturePosteriorMeanEnvelope(StateType * kg_state) const {
+  const int num_lines = kg_state->num_lines;
+  gaussian_process_->ComputeMeanOfPoints(kg_state->points_to_sample_state, &kg_state->to_sample_mean);
+  gaussian_process_->ComputeVarianceOfPoints(&(kg_state->points_to_sample_state), nullptr, 0, &kg_state->to_sample_var);
+  // same noise (and jitter) as KnowledgeGradientState::PreCompute()
+  kg_state->cholesky_to_sample_var = std::sqrt(kg_state->to_sample_var + gaussian_process_->noise_variance()[0] + 1.e-6);
+
+  // line 0: the point to sample itself; lines 1..num_pts_: \Sigma_n(x, discrete_pts) / L
+  kg_state->intercept[0] = kg_state->to_sample_mean;
+  kg_state->slope[0] = kg_state->to_sample_var;
+  std::copy(discrete_mean_.begin(), discrete_mean_.end(), kg_state->intercept.begin() + 1);
+  if (num_pts_ > 0) {
+    gaussian_process_->ComputeCovarianceOfPoints(&(kg_state->points_to_sample_state), discrete_pts_.data(), num_pts_,
+                                                 nullptr, 0, true, K_inv_times_K_discrete_.data(),
+                                                 kg_state->slope.data() + 1);
+  }
+  for (int j = 0; j < num_lines; ++j) {
+    kg_state->slope[j] /= kg_state->cholesky_to_sample_var;
+  }
+
+  // lower envelope: by decreasing slope (lowest as Z -> -inf first); among equal slopes only the lowest line can win
+  std::vector<int>& order = kg_state->envelope;
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [kg_state](int i, int j) {
+      return kg_state->slope[i] > kg_state->slope[j] ||
+          (kg_state->slope[i] == kg_state->slope[j] && kg_state->intercept[i] < kg_state->intercept[j]);
+    });
+  // the envelope overwrites order in place: entry k is read before the (at most k-th) envelope slot is written
+  int num_envelope = 0;
+  for (int k = 0; k < num_lines; ++k) {
+    const int line = order[k];
+    if (num_envelope > 0 && kg_state->slope[kg_state->envelope[num_envelope - 1]] == kg_state->slope[line]) {
+      continue;
+    }
+    double breakpoint = -std::numeric_limits<double>::infinity();
+    while (num_envelope > 0) {
+      const int top = kg_state->envelope[num_envelope - 1];
+      breakpoint = (kg_state->intercept[line] - kg_state->intercept[top])/(kg_state->slope[top] - kg_state->slope[line]);
+      if (breakpoint > kg_state->breakpoints[num_envelope - 1]) {
+        break;
+      }
+      // top is never lowest: line undercuts it before it undercuts its predecessor
+      --num_envelope;
+      breakpoint = -std::numeric_limits<double>::infinity();
+    }
+    kg_state->envelope[num_envelope] = line;
+    kg_state->breakpoints[num_envelope] = breakpoint;
+    ++num_envelope;
+  }
+  kg_state->breakpoints[num_envelope] = std::numeric_limits<double>::infinity();
+  kg_state->num_envelope = num_envelope;
+}
+
+/*!\rst
+  Line ``k`` of the envelope is lowest for ``Z`` in ``(c_k, c_{k+1})``, so
+  ``E[\min_j(a_j + b_j Z)] = \sum_k a_k (\Phi(c_{k+1}) - \Phi(c_k)) + b_k (\phi(c_k) - \phi(c_{k+1}))``.
+\endrst*/
+double OnePotentialSampleKnowledgeGradientEvaluator::ComputeKnowledgeGradient(StateType * kg_state) const {
+  ComputeFuturePosteriorMeanEnvelope(kg_state);
+
+  double expected_future_minimum = 0.0;
+  for (int k = 0; k < kg_state->num_envelope; ++k) {
+    const int line = kg_state->envelope[k];
+    const double left = kg_state->breakpoints[k];
+    const double right = kg_state->breakpoints[k + 1];
+    expected_future_minimum += kg_state->intercept[line]*NormalProbabilityBetween(normal_, left, right) +
+        kg_state->slope[line]*(NormalDensity(normal_, left) - NormalDensity(normal_, right));
+  }
+  return std::fmin(best_so_far_, kg_state->to_sample_mean) - expected_future_minimum;
+}
+
+/*!\rst
+  With ``P_k, Q_k`` the probability and first-moment weights of envelope line ``k`` (see ComputeKnowledgeGradient()),
+  ``\nabla E = \sum_k \nabla a_k P_k + \nabla b_k Q_k``.  Only ``a_0 = \mu_n(x)`` depends on ``x``.  For ``j > 0``,
+  ``\nabla b_j`` is the gradient of ``L^{-1} \Sigma_n(x, D_j)`` (GaussianProcess::ComputeGradInverseCholeskyCovarianceOfPoints()).
+  For ``j = 0``, ``b_0 = \Sigma_n(x, x) / L`` with ``L^2 = \Sigma_n(x, x) + \sigma^2``, so
+  ``\nabla b_0 = \nabla L (2 - \Sigma_n(x, x) / L^2)``.
+\endrst*/
+double OnePotentialSampleKnowledgeGradientEvaluator::ComputeGradKnowledgeGradient(StateType * kg_state,
+                                                                                  double * restrict grad_KG) const {
+  ComputeFuturePosteriorMeanEnvelope(kg_state);
+  const double chol_var = kg_state->cholesky_to_sample_var;
+
+  double * restrict grad_mu = kg_state->grad_mu.data();
+  double * restrict grad_chol_decomp = kg_state->grad_chol_decomp.data();
+  double * restrict grad_slope = kg_state->grad_slope.data();
+  gaussian_process_->ComputeGradMeanOfPoints(kg_state->points_to_sample_state, grad_mu);
+  gaussian_process_->ComputeGradCholeskyVarianceOfPoints(&(kg_state->points_to_sample_state), &chol_var, grad_chol_decomp);
+  if (num_pts_ > 0) {
+    gaussian_process_->ComputeGradInverseCholeskyCovarianceOfPoints(&(kg_state->points_to_sample_state), &chol_var,
+                                                                    grad_chol_decomp, kg_state->slope.data() + 1,
+                                                                    discrete_pts_.data(), num_pts_, true,
+                                                                    K_inv_times_K_discrete_.data(), grad_slope + dim_);
+  }
+  const double self_slope_factor = 2.0 - kg_state->to_sample_var/Square(chol_var);
+  for (int d = 0; d < dim_; ++d) {
+    grad_slope[d] = grad_chol_decomp[d]*self_slope_factor;
+  }
+
+  // the current best posterior mean, min(best_so_far, \mu_n(x)), moves only if x holds it
+  if (kg_state->to_sample_mean < best_so_far_) {
+    std::copy(grad_mu, grad_mu + dim_, grad_KG);
+  } else {
+    std::fill(grad_KG, grad_KG + dim_, 0.0);
+  }
+  double expected_future_minimum = 0.0;
+  for (int k = 0; k < kg_state->num_envelope; ++k) {
+    const int line = kg_state->envelope[k];
+    const double left = kg_state->breakpoints[k];
+    const double right = kg_state->breakpoints[k + 1];
+    const double probability = NormalProbabilityBetween(normal_, left, right);
+    const double first_moment = NormalDensity(normal_, left) - NormalDensity(normal_, right);
+    // as in ComputeKnowledgeGradient()
+    expected_future_minimum += kg_state->intercept[line]*probability + kg_state->slope[line]*first_moment;
+    if (line == 0) {
+      for (int d = 0; d < dim_; ++d) {
+        grad_KG[d] -= grad_mu[d]*probability;
+      }
+    }
+    for (int d = 0; d < dim_; ++d) {
+      grad_KG[d] -= grad_slope[d + line*dim_]*first_moment;
+    }
+  }
+  return std::fmin(best_so_far_, kg_state->to_sample_mean) - expected_future_minimum;
+}
+
+OnePotentialSampleKnowledgeGradientState::OnePotentialSampleKnowledgeGradientState(
+    const EvaluatorType& kg_evaluator, double const * restrict point_to_sample_in, bool configure_for_gradients)
+    : dim(kg_evaluator.dim()),
+      num_derivatives(configure_for_gradients ? num_to_sample : 0),
+      num_lines(1 + kg_evaluator.number_discrete_pts()),
+      point_to_sample(point_to_sample_in, point_to_sample_in + dim),
+      points_to_sample_state(*kg_evaluator.gaussian_process(), point_to_sample.data(), num_to_sample,
+                             nullptr, 0, num_derivatives, configure_for_gradients),
+      to_sample_mean(0.0),
+      to_sample_var(0.0),
+      cholesky_to_sample_var(0.0),
+      intercept(num_lines),
+      slope(num_lines),
+      envelope(num_lines),
+      breakpoints(num_lines + 1),
+      num_envelope(0),
+      grad_mu(dim*num_derivatives),
+      grad_chol_decomp(dim*num_derivatives),
+      grad_slope(dim*num_lines*num_derivatives) {
+}
+
+OnePotentialSampleKnowledgeGradientState::OnePotentialSampleKnowledgeGradientState(
+    OnePotentialSampleKnowledgeGradientState&& OL_UNUSED(other)) = default;
+
+void OnePotentialSampleKnowledgeGradientState::SetCurrentPoint(const EvaluatorType& kg_evaluator,
+                                                               double const * restrict point_to_sample_in) {
+  std::copy(point_to_sample_in, point_to_sample_in + dim, point_to_sample.data());
+
+  points_to_sample_state.SetupState(*kg_evaluator.gaussian_process(), point_to_sample.data(),
+                                    num_to_sample, 0, num_derivatives, (num_derivatives>0));
+}
+
+void OnePotentialSampleKnowledgeGradientState::SetupState(const EvaluatorType& kg_evaluator,
+                                                          double const * restrict point_to_sample_in) {
+  if (unlikely(dim != kg_evaluator.dim())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, kg_evaluator.dim());
+  }
+
+  SetCurrentPoint(kg_evaluator, point_to_sample_in);
+}
+
+bool OnePotentialSampleKnowledgeGradientState::Reconfigure(const EvaluatorType& kg_evaluator,
+                                                           double const * restrict point_to_sample_in,
+                                                           bool configure_for_gradients) {
+  if (dim != kg_evaluator.dim() || num_derivatives != (configure_for_gradients ? num_to_sample : 0) ||
+      num_lines != 1 + kg_evaluator.number_discrete_pts() ||
+      points_to_sample_state.num_gradients_sampled != kg_evaluator.gaussian_process()->num_derivatives()) {
+    return false;
+  }
+
+  SetCurrentPoint(kg_evaluator, point_to_sample_in);
+  return true;
+}
 
 PosteriorMeanEvaluator::PosteriorMeanEvaluator(
   const GaussianProcess& gaussian_process_in)
@@ -331,14 +837,29 @@ void PosteriorMeanEvaluator::ComputeGradPosteriorMean(
   }
 }
 
+void PosteriorMeanEvaluator::ComputeGradObjectiveFunctionBatch(StateType * const * ps_states, int num_states,
+                                                               double const * restrict points_to_sample,
+                                                               double * restrict grad_PS) const {
+  SetCurrentPointBatch(*this, ps_states, num_states, points_to_sample);
+  for (int k = 0; k < num_states; ++k) {
+    ComputeGradPosteriorMean(ps_states[k], grad_PS);
+    grad_PS += ps_states[k]->GetProblemSize();
+  }
+}
+
 void PosteriorMeanState::SetCurrentPoint(const EvaluatorType& ps_evaluator,
                                          double const * restrict point_to_sample_in) {
-  // update current point in union_of_points
-  std::copy(point_to_sample_in, point_to_sample_in + dim - num_fidelity, point_to_sample.data());
-  std::fill(point_to_sample.data() + dim - num_fidelity, point_to_sample.data() + dim, 1.0);
+  PrepareCurrentPoint(ps_evaluator, point_to_sample_in);
   // evaluate derived quantities
-  points_to_sample_state.SetupState(*ps_evaluator.gaussian_process(), point_to_sample.data(),
-                                    num_to_sample, 0, num_derivatives, false, false);
+  ps_evaluator.gaussian_process()->FillPointsToSampleState(&points_to_sample_state);
+}
+
+void PosteriorMeanState::PrepareCurrentPoint(const EvaluatorType& ps_evaluator,
+                                             double const * restrict point_to_sample_in) {
+  // update the non-fidelity coordinates of point_to_sample; the fidelity coordinates stay at 1.0 from construction
+  std::copy(point_to_sample_in, point_to_sample_in + dim - num_fidelity, point_to_sample.data());
+  points_to_sample_state.PrepareState(*ps_evaluator.gaussian_process(), point_to_sample.data(),
+                                      num_to_sample, 0, num_derivatives, false, false);
 }
 
 PosteriorMeanState::PosteriorMeanState(
@@ -386,7 +907,7 @@ void PosteriorMeanState::SetupState(const EvaluatorType& ps_evaluator,
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
   \output
     :found_flag[1]: true if best_next_point corresponds to a nonzero EI
@@ -424,6 +945,35 @@ template void ComputeOptimalPosteriorMean(const GaussianProcess& gaussian_proces
                                           const SimplexIntersectTensorProductDomain& domain, double const * restrict initial_guess,
                                           bool * restrict found_flag, double * restrict best_next_point);
 
+template <typename DomainType>
+void ComputeOptimalPosteriorMeanMultistart(const GaussianProcess& gaussian_process, const int num_fidelity,
+                                           const GradientDescentParameters& optimizer_parameters,
+                                           const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                           double const * restrict start_point_set, int num_multistarts,
+                                           double const * restrict discrete_pts, int num_pts, int num_refined_starts,
+                                           bool * restrict found_flag, double * restrict best_next_point) {
+  OL_VERBOSE_PRINTF("Posterior Mean Optimization via %s:\n", OL_CURRENT_FUNCTION_NAME);
+  PosteriorMeanEvaluator ps_evaluator(gaussian_process);
+  MultistartPosteriorMeanOptimization(ps_evaluator, num_fidelity, gaussian_process.points_sampled().data(),
+                                      gaussian_process.num_sampled(), optimizer_parameters, domain, thread_schedule,
+                                      start_point_set, num_multistarts, discrete_pts, num_pts, num_refined_starts,
+                                      found_flag, best_next_point);
+}
+
+// template explicit instantiation definitions, see gpp_common.hpp header comments, item 6
+template void ComputeOptimalPosteriorMeanMultistart(
+    const GaussianProcess& gaussian_process, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+template void ComputeOptimalPosteriorMeanMultistart(
+    const GaussianProcess& gaussian_process, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+
 /*!\rst
   This is a simple wrapper around ComputeKGOptimalPointsToSampleWithRandomStarts() and
   ComputeKGOptimalPointsToSampleViaLatinHypercubeSearch(). That is, this method attempts multistart gradient descent
@@ -441,7 +991,7 @@ void ComputeKGOptimalPointsToSample(const GaussianProcess& gaussian_process, con
                                     int max_int_steps, bool lhc_search_only,
                                     int num_lhc_samples, bool * restrict found_flag,
                                     UniformRandomGenerator * uniform_generator,
-                                    NormalRNG * normal_rng, double * restrict best_points_to_sample) {
+                                    NormalRNGArray normal_rng, double * restrict best_points_to_sample) {
   if (unlikely(num_to_sample <= 0)) {
     return;
   }
@@ -457,8 +1007,10 @@ void ComputeKGOptimalPointsToSample(const GaussianProcess& gaussian_process, con
                                                    next_points_to_sample.data());
   }
 
-  // if gradient descent EI optimization failed OR we're only doing latin hypercube searches
-  if (found_flag_local == false || lhc_search_only == true) {
+  // past the optimizer's deadline, return gradient descent's result instead of starting a search
+  const bool out_of_time = optimizer_parameters.deadline.Expired();
+  // if gradient descent EI optimization failed (with time left) OR we're only doing latin hypercube searches
+  if ((found_flag_local == false && !out_of_time) || lhc_search_only == true) {
     if (unlikely(lhc_search_only == false)) {
       OL_WARNING_PRINTF("WARNING: %d,%d-KG opt DID NOT CONVERGE\n", num_to_sample, num_being_sampled);
       OL_WARNING_PRINTF("Attempting latin hypercube search\n");
@@ -501,12 +1053,152 @@ template void ComputeKGOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 template void ComputeKGOptimalPointsToSample(
     const GaussianProcess& gaussian_process, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
     const GradientDescentParameters& optimizer_parameters_inner,
     const SimplexIntersectTensorProductDomain& domain, const SimplexIntersectTensorProductDomain& inner_domain, const ThreadSchedule& thread_schedule,
     double const * restrict points_being_sampled,double const * discrete_pts,
     int num_to_sample, int num_being_sampled, int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+template void ComputeKGOptimalPointsToSample(
+    const GaussianProcess& gaussian_process, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
+    const GradientDescentParameters& optimizer_parameters_inner,
+    const TrustRegionDomain& domain, const TrustRegionDomain& inner_domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled, double const * discrete_pts,
+    int num_to_sample, int num_being_sampled,
+    int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only,
+    int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+
+namespace {
+
+//! spectral frequencies per sample path in BuildKnowledgeGradientDiscretization()
+constexpr int kDiscretizationNumFeatures = 500;
+//! candidates closer than this (relative to the domain's diagonal) to a chosen point are near-duplicates
+constexpr double kDiscretizationMinRelativeSeparation = 1.0e-3;
+
+}  // end unnamed namespace
+
+int BuildKnowledgeGradientDiscretization(const GaussianProcess& gaussian_process, int num_fidelity,
+                                         const TensorProductDomain& domain,
+                                         const KnowledgeGradientDiscretizationParameters& parameters,
+                                         int max_num_threads, UniformRandomGenerator * uniform_generator,
+                                         std::vector<double> * discrete_pts) {
+  if (unlikely(!(parameters.exclusion_probability > 0.0 && parameters.exclusion_probability < 0.5))) {
+    OL_THROW_EXCEPTION(BoundsException<double>, "exclusion_probability must be in (0, 0.5).",
+                       parameters.exclusion_probability, 0.0, 0.5);
+  }
+  if (unlikely(parameters.min_num_pts < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "min_num_pts must be positive.", parameters.min_num_pts, 1);
+  }
+  if (unlikely(parameters.max_num_pts < parameters.min_num_pts)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "max_num_pts must be at least min_num_pts.", parameters.max_num_pts,
+                       parameters.min_num_pts);
+  }
+
+  const int dim = gaussian_process.dim();
+  const int subset_dim = dim - num_fidelity;
+  const int num_sampled = gaussian_process.num_sampled();
+  const int num_optima = (gaussian_process.is_sparse() || gaussian_process.is_grid()) ? 0 : parameters.num_optima;
+
+  // training points, uniform candidates, sampled optima; the incumbent's neighbors are appended once it is known
+  std::vector<double> candidates(dim*(num_sampled + parameters.num_candidates + num_optima + parameters.num_neighbors));
+  std::copy(gaussian_process.points_sampled().begin(), gaussian_process.points_sampled().begin() + dim*num_sampled,
+            candidates.begin());
+  int num_candidates = num_sampled;
+  if (parameters.num_candidates > 0) {
+    num_candidates += domain.GenerateUniformPointsInDomain(parameters.num_candidates, uniform_generator,
+                                                           candidates.data() + dim*num_candidates);
+  }
+  if (num_optima > 0) {
+    // candidate search only: the optima just need to land in the right basins
+    const LBFGSBParameters lbfgsb_parameters(1, 0, 1, 1, 0.0);
+    SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_optima, kDiscretizationNumFeatures,
+                                         std::max(parameters.num_candidates, 1), lbfgsb_parameters, domain,
+                                         max_num_threads, uniform_generator->engine(),
+                                         candidates.data() + dim*num_candidates);
+    num_candidates += num_optima;
+  }
+  auto set_top_fidelity = [dim, subset_dim](double * points, int num_points) {
+    for (int i = 0; i < num_points; ++i) {
+      std::fill(points + i*dim + subset_dim, points + (i + 1)*dim, 1.0);
+    }
+  };
+  set_top_fidelity(candidates.data(), num_candidates);
+
+  std::vector<double> mean(num_candidates + parameters.num_neighbors);
+  std::vector<double> variance(num_candidates + parameters.num_neighbors);
+  if (num_candidates > 0) {
+    gaussian_process.PredictMarginals(candidates.data(), num_candidates, max_num_threads, mean.data(), variance.data());
+  }
+
+  if (parameters.num_neighbors > 0 && num_candidates > 0) {
+    const int incumbent = std::min_element(mean.begin(), mean.begin() + num_candidates) - mean.begin();
+    double const * incumbent_point = candidates.data() + incumbent*dim;
+    for (int i = 0; i < parameters.num_neighbors; ++i) {
+      double * neighbor = candidates.data() + (num_candidates + i)*dim;
+      for (int d = 0; d < dim; ++d) {
+        const ClosedInterval& interval = domain.GetInterval(d);
+        const double half_width = parameters.neighbor_scale*interval.Length();
+        const double min_value = std::fmax(interval.min, incumbent_point[d] - half_width);
+        const double max_value = std::fmin(interval.max, incumbent_point[d] + half_width);
+        if (max_value > min_value) {
+          boost::uniform_real<double> uniform_double(min_value, max_value);
+          neighbor[d] = uniform_double(uniform_generator->engine);
+        } else {
+          neighbor[d] = min_value;
+        }
+      }
+    }
+    set_top_fidelity(candidates.data() + num_candidates*dim, parameters.num_neighbors);
+    gaussian_process.PredictMarginals(candidates.data() + num_candidates*dim, parameters.num_neighbors,
+                                      max_num_threads, mean.data() + num_candidates,
+                                      variance.data() + num_candidates);
+    num_candidates += parameters.num_neighbors;
+  }
+
+  // P(f < mu*) >= p  <=>  (mu - mu*)/sigma <= z, with z = -\Phi^{-1}(p) > 0
+  const double best_mean = num_candidates > 0 ? *std::min_element(mean.begin(), mean.begin() + num_candidates) : 0.0;
+  const double z = -boost::math::quantile(boost::math::normal(), parameters.exclusion_probability);
+  std::vector<double> standardized_gap(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    const double sigma = std::sqrt(std::fmax(variance[i], 0.0));
+    standardized_gap[i] = (mean[i] - best_mean)/std::fmax(sigma, std::numeric_limits<double>::min());
+  }
+  std::vector<int> order(num_candidates);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&standardized_gap](int i, int j) {
+      return standardized_gap[i] < standardized_gap[j];
+    });
+
+  double diagonal_sq = 0.0;
+  for (int d = 0; d < subset_dim; ++d) {
+    diagonal_sq += Square(domain.GetInterval(d).Length());
+  }
+  const double min_separation_sq = Square(kDiscretizationMinRelativeSeparation)*diagonal_sq;
+
+  discrete_pts->clear();
+  int num_pts = 0;
+  for (int i : order) {
+    if (num_pts == parameters.max_num_pts || (num_pts >= parameters.min_num_pts && standardized_gap[i] > z)) {
+      break;
+    }
+    double const * point = candidates.data() + i*dim;
+    bool near_duplicate = false;
+    for (int j = 0; j < num_pts && !near_duplicate; ++j) {
+      double distance_sq = 0.0;
+      for (int d = 0; d < subset_dim; ++d) {
+        distance_sq += Square(point[d] - (*discrete_pts)[j*subset_dim + d]);
+      }
+      near_duplicate = distance_sq <= min_separation_sq;
+    }
+    if (!near_duplicate) {
+      discrete_pts->insert(discrete_pts->end(), point, point + subset_dim);
+      ++num_pts;
+    }
+  }
+  return num_pts;
+}
+
 }  // end namespace optimal_learning
@@ -116,8 +116,10 @@
 #define MOE_OPTIMAL_LEARNING_CPP_GPP_KNOWLEDGE_GRADIENT_OPTIMIZATION_HPP_
 
 #include <algorithm>
+#include <cstddef>
 #include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <stdlib.h>
@@ -129,8 +131,11 @@
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_knowledge_gradient_gpu.hpp"
+#include "gpp_knowledge_gradient_inner_optimization.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
+#include "gpp_memory_budget.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
 #include "gpp_random.hpp"
@@ -139,6 +144,20 @@ namespace optimal_learning {
 
 template <typename DomainType>
 struct KnowledgeGradientState;
+
+/*!\rst
+  How KnowledgeGradientEvaluator maximizes the future posterior mean in each monte carlo iteration.
+\endrst*/
+enum class KnowledgeGradientInnerMode {
+  //! gradient descent (ComputeOptimalFuturePosteriorMean()) from the best point of the discretized set; the search for
+  //! that point reuses the sample-independent ``L^{-1} \Sigma_n(U, D)``, so it costs O(num_union) per point, not O(N)
+  kGradientDescent = 0,
+  //! exact maximum over the discretized set only; one matrix product covers all monte carlo iterations
+  kDiscrete = 1,
+  //! kDiscrete, then gradient descent from each iteration's discrete winner (same optimum as kGradientDescent)
+  kDiscreteThenGradientDescent = 2,
+};
+
 /*!\rst
   A class to encapsulate the computation of knowledge gradient and its spatial gradient. This class handles the
   general KG computation case using monte carlo integration; it can support q,p-KG optimization. It is designed to work
@@ -147,6 +166,10 @@ struct KnowledgeGradientState;
 
   The random numbers needed for KG computation will be passed as parameters instead of contained as members to make
   multithreading more straightforward.
+
+  The parts of the future posterior mean on ``discrete_pts`` that do not depend on the points to sample (the GP mean
+  there and their covariance with ``points_sampled``) are computed once, at construction, and read by every state and
+  thread.  So, like its states, an evaluator is invalidated if its GaussianProcess is mutated.
 \endrst*/
 template <typename DomainType>
 class KnowledgeGradientEvaluator final {
@@ -162,6 +185,19 @@ class KnowledgeGradientEvaluator final {
       :num_pts: number of points in discrete_pts
       :num_mc_iterations: number of monte carlo iterations
       :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :inner_mode: how the future posterior mean is maximized in each monte carlo iteration
+      :num_warm_starts: number of previous inner optima (per monte carlo iteration) that a KnowledgeGradientState keeps
+        and offers as extra starting points to the next evaluation's gradient descent; 0 disables warm starts
+      :max_num_threads: maximum number of OpenMP threads used to spread the monte carlo iterations (each one an
+        independent inner optimization); 1 runs them serially.  Only takes effect outside of other active parallel regions.
+      :which_gpu: device that draws the normals and runs the discrete inner step (see gpp_knowledge_gradient_gpu.hpp),
+        or kNoGpu to stay on the CPU
+      :grad_memory_budget: bytes each KnowledgeGradientState may spend on the per-iteration covariances (and their
+        adjoints) of ComputeGradKnowledgeGradient(); the mc iterations are processed in blocks that fit (see
+        KnowledgeGradientState::GradMonteCarloBlockSize()).  The gradient does not depend on the block size (up to
+        roundoff).
+    \raise
+      see CudaSelectDevice() if ``which_gpu != kNoGpu``
   \endrst*/
   explicit KnowledgeGradientEvaluator(const GaussianProcess& gaussian_process_in, const int num_fidelity,
                                       double const * discrete_pts,
@@ -169,10 +205,21 @@ class KnowledgeGradientEvaluator final {
                                       int num_mc_iterations,
                                       const DomainType& domain,
                                       const GradientDescentParameters& optimizer_parameters,
-                                      double best_so_far);
+                                      double best_so_far,
+                                      KnowledgeGradientInnerMode inner_mode,
+                                      int num_warm_starts,
+                                      int max_num_threads,
+                                      int which_gpu = kNoGpu,
+                                      std::size_t grad_memory_budget = kDefaultGradMemoryBudget);
 
   KnowledgeGradientEvaluator(KnowledgeGradientEvaluator&& other);
 
+  //! number of warm starts used by the KG optimizers (a single previous optimum already skips most inner descent steps)
+  static constexpr int kDefaultNumWarmStarts = 1;
+  //! default per-state budget (bytes) for the gradient's per-iteration covariances: 64 MiB, so only problems with a
+  //! great many mc iterations or a large q are split into more than one block
+  static constexpr std::size_t kDefaultGradMemoryBudget = static_cast<std::size_t>(64) << 20;
+
   int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return dim_;
   }
@@ -185,6 +232,26 @@ class KnowledgeGradientEvaluator final {
     return num_mc_iterations_;
   }
 
+  KnowledgeGradientInnerMode inner_mode() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return inner_mode_;
+  }
+
+  int num_warm_starts() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_warm_starts_;
+  }
+
+  int max_num_threads() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_num_threads_;
+  }
+
+  int which_gpu() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return which_gpu_;
+  }
+
+  std::size_t grad_memory_budget() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return grad_memory_budget_;
+  }
+
   double best_so_far() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return best_so_far_;
   }
@@ -219,6 +286,24 @@ class KnowledgeGradientEvaluator final {
     return gaussian_process_;
   }
 
+  /*!\rst
+    The discretized set ``D`` searched by the inner problem is the union of points (of ``kg_state``) followed by
+    ``discrete_pts``; the state keeps the former and this evaluator the latter.
+
+    \param
+      :kg_state: state whose discretized set to index
+      :index: index of a point in ``D``, in ``[0, num_union + num_pts)``
+    \return
+      pointer to the non-fidelity coordinates (``dim - num_fidelity`` of them) of point ``index`` of ``D``
+  \endrst*/
+  double const * DiscretizedSetPoint(const StateType& kg_state, int index) const noexcept OL_WARN_UNUSED_RESULT {
+    const int subset_dim = dim_ - num_fidelity_;
+    if (index < kg_state.num_union) {
+      return kg_state.subset_union_of_points.data() + index*subset_dim;
+    }
+    return discrete_pts_.data() + (index - kg_state.num_union)*subset_dim;
+  }
+
   /*!\rst
     Wrapper for ComputeKnowledgeGradient(); see that function for details.
   \endrst*/
@@ -233,6 +318,25 @@ class KnowledgeGradientEvaluator final {
     ComputeGradKnowledgeGradient(kg_state, grad_KG);
   }
 
+  /*!\rst
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp): the gradient's MC
+    loop solves the same inner optimizations (with the same normals) that KG needs, so KG comes at no extra cost.
+    Gradient evaluations warm-start the inner optimizations differently, so with continuous inner optimization the
+    value may differ from ComputeKnowledgeGradient() by the inner solver's tolerance (it is identical for discrete
+    inner optimization).
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: state with temporary storage modified; ``normal_rng`` modified
+      :grad_KG[dim][num_to_sample]: gradient of KG (see ComputeGradKnowledgeGradient())
+    \return
+      the knowledge gradient
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS {
+    return ComputeGradKnowledgeGradient(kg_state, grad_KG);
+  }
+
   /*!\rst
     Computes the knowledge gradient
     \param
@@ -258,18 +362,84 @@ class KnowledgeGradientEvaluator final {
       :grad_KG[dim][num_to_sample]: gradient of KG, ``\pderiv{KG(Xq \cup Xp)}{Xq_{d,i}}`` where ``Xq`` is ``points_to_sample``
       and ``Xp`` is ``points_being_sampled`` (grad KG from sampling ``points_to_sample`` with
       ``points_being_sampled`` concurrent experiments wrt each dimension of the points in ``points_to_sample``)
+    \return
+      the knowledge gradient, a by-product (see ComputeObjectiveAndGradient())
   \endrst*/
   double ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(KnowledgeGradientEvaluator);
 
  private:
+  /*!\rst
+    Draws the normals for every monte carlo iteration (antithetic pairs: odd iterations negate the preceding draw), then
+    solves each iteration's inner problem (ComputeOptimalFuturePosteriorMean()) on up to ``max_num_threads_`` threads.
+
+    The normals are drawn serially, in iteration order, before any inner optimization starts and each iteration writes
+    only its own outputs, so the results do not depend on the number of threads.
+
+    The normal_rng is reset to its most recent seed first, so iteration ``i`` sees the same draw in every evaluation.
+    Its optima from the previous ``num_warm_starts_`` evaluations (kept in ``warm_start_points``) are therefore good
+    starting points when ``points_to_sample`` has barely moved; they compete with the discretized set for the single
+    gradient descent start. Warm starts only ever raise the inner maximum, but they make an evaluation depend on the
+    state's history.
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: ``normals``, ``best_point``, and ``best_function_value`` hold this evaluation's draws and inner optima;
+        ``warm_start_points`` records the optima; ``normal_rng`` modified
+  \endrst*/
+  void ComputeOptimalFuturePosteriorMeans(StateType * kg_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Forms the parts of the future posterior mean on the points ``D`` of the discretized set (see DiscretizedSetPoint())
+    that do not depend on the monte carlo iteration: ``\mu_n(D)`` and ``L^{-1} \Sigma_n(U, D)`` (see
+    ComputeDiscreteOptimalFuturePosteriorMeans()).  Each iteration's value at a point of ``D`` is then ``\mu_n(D_j)``
+    plus one dot product with its normals.
+
+    Only the union's columns of ``\mu_n`` and ``K(X, D)`` are built here; those of ``discrete_pts`` were built at
+    construction.  ``K(U, D)`` and the solve against ``L`` depend on ``U`` and are built for all of ``D``.
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: ``discrete_points``, ``discrete_K_star``, ``discrete_mean``, and ``discrete_chol_inverse_cov`` set
+  \endrst*/
+  void ComputeDiscretePosteriorMeanUpdate(StateType * kg_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Maximizes the future posterior mean exactly over the points ``D`` of the discretized set, for every monte carlo
+    iteration at once (see KnowledgeGradientInnerMode::kDiscrete).
+
+    The future posterior mean after observing ``union_of_points`` (``U``) is ``\mu_n(D) + \Sigma_n(D, U) L^{-T} z``, where
+    ``L`` is ``cholesky_to_sample_var`` and ``z`` is one iteration's normals. The bracketed factor
+    ``(L^{-1} \Sigma_n(U, D))^T`` does not depend on ``z``, so it is formed once and then one GEMM against all of the
+    ``normals`` yields every iteration's values on ``D``.
+
+    \param
+      :kg_state[1]: properly configured state object; ``normals`` must already be drawn
+    \output
+      :kg_state[1]: ``best_function_value``, ``best_point``, and ``discrete_winner`` hold each iteration's discrete
+        optimum; ``discrete_*`` temporaries modified
+  \endrst*/
+  void ComputeDiscreteOptimalFuturePosteriorMeans(StateType * kg_state) const OL_NONNULL_POINTERS;
+
   //! spatial dimension (e.g., entries per point of points_sampled)
   const int dim_;
   //! dim of the fidelity
   const int num_fidelity_;
   //! number of monte carlo iterations
   int num_mc_iterations_;
+  //! how the future posterior mean is maximized in each monte carlo iteration
+  KnowledgeGradientInnerMode inner_mode_;
+  //! number of previous inner optima per monte carlo iteration offered as starting points
+  int num_warm_starts_;
+  //! maximum number of threads used to spread the monte carlo iterations
+  int max_num_threads_;
+  //! device for the normals and the discrete inner step, or kNoGpu
+  int which_gpu_;
+  //! bytes per state for the gradient's per-iteration covariances
+  std::size_t grad_memory_budget_;
 
   //! best (minimum) objective function value (in points_sampled_value)
   double best_so_far_;
@@ -284,10 +454,17 @@ class KnowledgeGradientEvaluator final {
   std::vector<double> discrete_pts_;
   //! number of points in discrete_pts
   const int num_pts_;
+  //! discrete_pts_ with the fidelity coordinates set to 1.0, ``discrete_points_[dim][num_pts]``
+  std::vector<double> discrete_points_;
+  //! covariance between points_sampled and discrete_points_, ``discrete_K_star_[num_sampled*(1+num_derivatives)][num_pts]``
+  std::vector<double> discrete_K_star_;
+  //! GP mean at discrete_points_
+  std::vector<double> discrete_mean_;
 };
 
 extern template class KnowledgeGradientEvaluator<TensorProductDomain>;
 extern template class KnowledgeGradientEvaluator<SimplexIntersectTensorProductDomain>;
+extern template class KnowledgeGradientEvaluator<TrustRegionDomain>;
 
 /*!\rst
   State object for KnowledgeGradientEvaluator.  This tracks the points being sampled in concurrent experiments
@@ -333,6 +510,7 @@ struct KnowledgeGradientState final {
     .. NOTE::
          \* The NormalRNG object must already be seeded.  If multithreaded computation is used for KG, then every state object
          must have a different NormalRNG (different seeds, not just different objects).
+         Passing a SobolNormalRNG of dimension ``(num_to_sample + num_being_sampled)*(1 + num_gradients)`` instead switches the MC integration to quasi-Monte Carlo.
   \endrst*/
   explicit KnowledgeGradientState(const EvaluatorType& kg_evaluator, double const * restrict points_to_sample,
                                   double const * restrict points_being_sampled, int num_to_sample_in,
@@ -367,13 +545,58 @@ struct KnowledgeGradientState final {
     return union_of_points;
   }
 
-  std::vector<double> SubsetData(double const * restrict union_of_points,
-                                 int num_union, int num_fidelity) noexcept OL_WARN_UNUSED_RESULT {
-    std::vector<double> subset_data((dim-num_fidelity)*num_union);
-    for (int i=0; i<num_union; ++i){
-      std::copy(union_of_points + i*dim, union_of_points+i*dim+dim-num_fidelity, subset_data.data()+i*(dim-num_fidelity));
+  /*!\rst
+    \return
+      true if ``kg_evaluator`` maximizes the inner problem over the discretized set for all iterations at once (and
+      thus needs ``discrete_future_mean``)
+  \endrst*/
+  static bool UsesDiscreteInnerMode(const EvaluatorType& kg_evaluator) noexcept OL_WARN_UNUSED_RESULT {
+    return kg_evaluator.inner_mode() != KnowledgeGradientInnerMode::kGradientDescent;
+  }
+
+  /*!\rst
+    \return
+      number of warm starts kept per mc iteration: ``kg_evaluator.num_warm_starts()``, or 0 if no gradient descent runs
+  \endrst*/
+  static int NumWarmStarts(const EvaluatorType& kg_evaluator) noexcept OL_WARN_UNUSED_RESULT {
+    return kg_evaluator.inner_mode() == KnowledgeGradientInnerMode::kDiscrete ? 0 : std::max(kg_evaluator.num_warm_starts(), 0);
+  }
+
+  /*!\rst
+    Each mc iteration of ComputeGradKnowledgeGradient() needs ``num_union_gradients`` doubles of ``chol_inverse_cov``
+    and, if the state is configured for gradients, as many of ``cov_adjoint``.
+
+    \param
+      :kg_evaluator: evaluator whose ``grad_memory_budget()`` and number of mc iterations bound the block
+      :num_union_gradients: ``num_union*(1 + num_gradients_to_sample)``
+      :num_derivatives: number of points the gradient is taken wrt (0 if the state is not configured for gradients)
+    \return
+      number of mc iterations per block: as many as fit in ``kg_evaluator.grad_memory_budget()``, clamped to
+      ``[1, num_mc_iterations]``
+  \endrst*/
+  static int GradMonteCarloBlockSize(const EvaluatorType& kg_evaluator, int num_union_gradients,
+                                     int num_derivatives) noexcept OL_WARN_UNUSED_RESULT {
+    const std::size_t bytes_per_iteration = sizeof(double)*num_union_gradients*(num_derivatives > 0 ? 2 : 1);
+    const std::size_t block_size = kg_evaluator.grad_memory_budget()/bytes_per_iteration;
+    return static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(block_size, kg_evaluator.num_mc_iterations())));
+  }
+
+  /*!\rst
+    Overwrites points ``[first, last)`` of ``subset_union_of_points`` with the non-fidelity coordinates of the same
+    points of ``union_of_points``, in place; other entries are untouched.  SetCurrentPoint() only rewrites the
+    ``num_to_sample`` points that move.
+
+    \param
+      :num_fidelity: number of fidelity coordinates (trailing coordinates of each point) to drop
+      :first: index of the first point to update
+      :last: one past the index of the last point to update
+  \endrst*/
+  void UpdateSubsetUnionOfPoints(int num_fidelity, int first, int last) noexcept {
+    const int subset_dim = dim - num_fidelity;
+    for (int i = first; i < last; ++i) {
+      std::copy(union_of_points.data() + i*dim, union_of_points.data() + i*dim + subset_dim,
+                subset_union_of_points.data() + i*subset_dim);
     }
-    return subset_data;
   }
 
   int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
@@ -416,6 +639,24 @@ struct KnowledgeGradientState final {
   \endrst*/
   void SetupState(const EvaluatorType& kg_evaluator, double const * restrict points_to_sample);
 
+  /*!\rst
+    Reuses this state as if it were newly constructed with these (constructor) arguments, keeping its buffers: the
+    points, RNG, and warm starts are reset, buffers that depend on the evaluator (discrete set, GP
+    size) are resized (reallocating only when they grow), and the derived quantities are recomputed.  The inner
+    optimization states (``inner_state_vectors``) are kept.  See ReuseOrConstructStates() (gpp_optimization.hpp).
+
+    \param
+      see the constructor
+    \return
+      true if the state was reconfigured; false (state unchanged) if ``dim``, ``num_to_sample``, ``num_being_sampled``,
+      ``gradients``, ``configure_for_gradients``, the number of mc iterations, the number of warm starts, the device,
+      the gradient block size, or the GP's number of gradient observations differ
+  \endrst*/
+  bool Reconfigure(const EvaluatorType& kg_evaluator, double const * restrict points_to_sample,
+                   double const * restrict points_being_sampled, int num_to_sample_in, int num_being_sampled_in,
+                   int num_pts_in, int const * restrict gradients_in, int num_gradients_in, bool configure_for_gradients,
+                   NormalRNGInterface * normal_rng_in) OL_WARN_UNUSED_RESULT;
+
   /*!\rst
     Pre-compute to_sample_mean_, and cholesky_to_sample_var
   \endrst*/
@@ -444,9 +685,9 @@ struct KnowledgeGradientState final {
   //! ``points_to_sample`` is stored first in memory, immediately followed by ``points_being_sampled``
   std::vector<double> union_of_points;
 
-  //! discretized set in KG computation
+  //! non-fidelity coordinates of the points heading the discretized set in KG computation (see
+  //! KnowledgeGradientEvaluator::DiscretizedSetPoint()), ``subset_union_of_points[dim - num_fidelity][num_union]``
   std::vector<double> subset_union_of_points;
-  std::vector<double> discretized_set;
 
   //! gaussian process state
   GaussianProcess::StateType points_to_sample_state;
@@ -457,10 +698,8 @@ struct KnowledgeGradientState final {
   // temporary storage: preallocated space used by KnowledgeGradientEvaluator's member functions
   //! the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points
   std::vector<double> cholesky_to_sample_var;
-  //! the gradient of the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points
-  // wrt union_of_points[0:num_to_sample]
-  // (L_{d,*,*,k}^{-1} * L_{d,*,*,k} * L_{d,*,*,k}^{-1})^T
-  std::vector<double> grad_chol_decomp;
+  //! the gradient of the mc estimate wrt cholesky_to_sample_var (lower triangle), backpropagated in reverse mode
+  std::vector<double> chol_adjoint;
   //! the mean of the GP evaluated at discrete_pts and the union_of_points
   std::vector<double> to_sample_mean_;
   //! the gradient of the GP mean evaluated at union_of_points, wrt union_of_points[0:num_to_sample]
@@ -471,16 +710,363 @@ struct KnowledgeGradientState final {
   std::vector<double> normals;
   //! the best point
   std::vector<double> best_point;
-  //! the inverse chol cov for the best point
-  std::vector<double> chol_inverse_cov;
-  //! grad_chol_inverse_cov
-  std::vector<double> grad_chol_inverse_cov;
+  //! optimal future posterior mean found in each mc iteration
+  std::vector<double> best_function_value;
+
+  // temporary storage for KnowledgeGradientInnerMode::kDiscrete*; empty under kGradientDescent
+  //! subset_union_of_points with the fidelity coordinates set to 1.0, ``discrete_points[dim][num_union]``; the
+  //! evaluator holds the rest of the discretized set
+  std::vector<double> discrete_points;
+  //! covariance between points_sampled and discrete_points
+  AlignedVector<double> discrete_K_star;
+  //! GP mean at the discretized set, ``discrete_mean[num_union + num_pts]``
+  std::vector<double> discrete_mean;
+  //! ``L^{-1} \Sigma_n(U, D)``, the inverse-cholesky-scaled posterior covariance of union_of_points and discrete_points
+  AlignedVector<double> discrete_chol_inverse_cov;
+  //! future posterior mean update at discrete_points for each mc iteration (only for UsesDiscreteInnerMode())
+  std::vector<double> discrete_future_mean;
+  //! index (in discrete_points) of the best discrete point of each mc iteration
+  std::vector<int> discrete_winner;
+
+  // inner optima carried over between evaluations; persists across SetCurrentPoint()
+  //! number of warm starts kept per mc iteration
+  const int max_num_warm_starts;
+  //! number of valid entries (per mc iteration) in warm_start_points
+  int num_warm_start_points;
+  //! slot of warm_start_points that the next evaluation overwrites (oldest first)
+  int next_warm_start;
+  //! previous inner optima (non-fidelity coordinates), ``warm_start_points[dim - num_fidelity][max_num_warm_starts][num_iterations]``
+  std::vector<double> warm_start_points;
+  //! number of mc iterations per block of ComputeGradKnowledgeGradient(); see GradMonteCarloBlockSize()
+  const int grad_block_size;
+  //! the inverse chol cov for the best points of one block of mc iterations,
+  //! ``chol_inverse_cov[num_union*(1+num_gradients_to_sample)][grad_block_size]``
+  AlignedVector<double> chol_inverse_cov;
+  //! gradient of the mc estimate wrt the covariance of union_of_points and the best points of one block of mc
+  //! iterations, ``cov_adjoint[num_union*(1+num_gradients_to_sample)][grad_block_size]``
+  std::vector<double> cov_adjoint;
+
+  //! states of each mc iteration's inner optimization (ComputeOptimalFuturePosteriorMean()), kept across evaluations
+  //! so the inner solves reuse them instead of constructing new ones; empty under KnowledgeGradientInnerMode::kDiscrete
+  std::vector<std::vector<FuturePosteriorMeanState>> inner_state_vectors;
+
+  //! device buffers for an evaluator with ``which_gpu() != kNoGpu``; inert otherwise
+  CudaKnowledgeGradientWorkspace gpu_workspace;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(KnowledgeGradientState);
 };
 
 extern template struct KnowledgeGradientState<TensorProductDomain>;
 extern template struct KnowledgeGradientState<SimplexIntersectTensorProductDomain>;
+extern template struct KnowledgeGradientState<TrustRegionDomain>;
+
+struct OnePotentialSampleKnowledgeGradientState;
+
+/*!\rst
+  This is a specialization of the KnowledgeGradientEvaluator class for when the number of potential samples is 1; i.e.,
+  ``num_to_sample == 1`` and the number of concurrent samples is 0; i.e. ``num_being_sampled == 0``, with no fidelity
+  dimensions and no gradient observations.  In other words, this class only supports the computation of 1,0-KG over
+  the discretized set ``D = {x} U discrete_pts``, where ``x`` is ``point_to_sample``.
+
+  Then the future posterior mean at each ``D_j`` is a line in one standard normal ``Z``:
+  ``a_j + b_j Z``, with ``a_j = \mu_n(D_j)`` and ``b_j = \Sigma_n(x, D_j) / \sqrt{\Sigma_n(x, x) + \sigma^2}``.  So
+  ``E_n[\min_j(a_j + b_j Z)]`` is an integral over the lower envelope of these lines, which is computed exactly
+  (Frazier, Powell, and Dayanik): sort the lines by slope, drop the ones that are never lowest, and sum one
+  pdf/cdf term per remaining line.  This takes ``O(M log M)`` for ``M`` lines, after the ``O(N M)`` GP quantities.
+
+  Unlike KnowledgeGradientEvaluator, the inner problem is NOT refined by gradient descent off of ``D``, so this is the
+  KG of the discretization itself and needs no random number generator.
+
+  For other details, see KnowledgeGradientEvaluator for more complete description of what KG is and the outputs of
+  KG and grad KG computations.
+\endrst*/
+class OnePotentialSampleKnowledgeGradientEvaluator final {
+ public:
+  using StateType = OnePotentialSampleKnowledgeGradientState;
+
+  /*!\rst
+    Constructs a OnePotentialSampleKnowledgeGradientEvaluator object.  All inputs are required; no default constructor
+    nor copy/assignment are allowed.
+
+    The GP mean at ``discrete_pts`` and ``K^-1 * K(X, discrete_pts)`` do not depend on ``point_to_sample``; they are
+    computed here once.
+
+    \param
+      :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+        that describes the underlying GP
+      :discrete_pts[dim][num_pts]: the set of points to approximate the KG factor
+      :num_pts: number of points in discrete_pts
+      :best_so_far: value of the best mean value so far in discrete_pts
+  \endrst*/
+  OnePotentialSampleKnowledgeGradientEvaluator(const GaussianProcess& gaussian_process_in, double const * discrete_pts,
+                                               int num_pts, double best_so_far);
+  OnePotentialSampleKnowledgeGradientEvaluator(OnePotentialSampleKnowledgeGradientEvaluator&& other);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int number_discrete_pts() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_pts_;
+  }
+
+  double best_so_far() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return best_so_far_;
+  }
+
+  const GaussianProcess * gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return gaussian_process_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeKnowledgeGradient(); see that function for details.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * kg_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return ComputeKnowledgeGradient(kg_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradKnowledgeGradient(); see that function for details.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS {
+    ComputeGradKnowledgeGradient(kg_state, grad_KG);
+  }
+
+  /*!\rst
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp): both walk the same
+    envelope, so KG is accumulated alongside its gradient.
+
+    \param
+      :kg_state[1]: properly configured state object (configured for gradients)
+    \output
+      :kg_state[1]: state with temporary storage modified
+      :grad_KG[dim]: gradient of KG (see ComputeGradKnowledgeGradient())
+    \return
+      the knowledge gradient, exactly as ComputeKnowledgeGradient() returns it
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS {
+    return ComputeGradKnowledgeGradient(kg_state, grad_KG);
+  }
+
+  /*!\rst
+    Computes the knowledge gradient ``KG(x) = \min(best_so_far, \mu_n(x)) - E_n[\min_{d \in D} \mu_{n+1}(d)]``
+    exactly, from the lower envelope of the future posterior mean lines (see class docs).
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: state with temporary storage modified
+    \return
+      the knowledge gradient from sampling ``point_to_sample``
+  \endrst*/
+  double ComputeKnowledgeGradient(StateType * kg_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Computes the (partial) derivatives of the knowledge gradient with respect to the point to sample.
+
+    The breakpoints of the envelope move with ``x``, but the envelope is continuous there, so only the lines'
+    intercepts and slopes are differentiated.  ``D_0 = x`` moves with ``x`` too, and its slope is differentiated in
+    both arguments of ``\Sigma_n(x, D_0)``.
+
+    \param
+      :kg_state[1]: properly configured state object (configured for gradients)
+    \output
+      :kg_state[1]: state with temporary storage modified
+      :grad_KG[dim]: gradient of KG, ``\pderiv{KG(x)}{x_d}``, where ``x`` is ``point_to_sample``
+    \return
+      the knowledge gradient, a by-product (see ComputeObjectiveAndGradient())
+  \endrst*/
+  double ComputeGradKnowledgeGradient(StateType * kg_state, double * restrict grad_KG) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OnePotentialSampleKnowledgeGradientEvaluator);
+
+ private:
+  /*!\rst
+    Fills ``kg_state``'s future posterior mean lines (``intercept``, ``slope``) and their lower envelope
+    (``envelope``, ``breakpoints``) at the state's current point.
+
+    \param
+      :kg_state[1]: properly configured state object
+    \output
+      :kg_state[1]: ``to_sample_mean``, ``to_sample_var``, ``cholesky_to_sample_var``, ``intercept``, ``slope``,
+        ``envelope``, ``breakpoints``, and ``num_envelope`` set
+  \endrst*/
+  void ComputeFuturePosteriorMeanEnvelope(StateType * kg_state) const OL_NONNULL_POINTERS;
+
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim_;
+  //! number of points in discrete_pts
+  const int num_pts_;
+  //! best (minimum) mean value so far in discrete_pts
+  double best_so_far_;
+
+  //! normal distribution object
+  const boost::math::normal_distribution<double> normal_;
+  //! pointer to gaussian process used in KG computations
+  const GaussianProcess * gaussian_process_;
+
+  //! the set of points to approximate the KG factor, ``discrete_pts_[dim][num_pts]``
+  std::vector<double> discrete_pts_;
+  //! GP mean at discrete_pts
+  std::vector<double> discrete_mean_;
+  //! ``K^-1 * K(X, discrete_pts)``, ``K_inv_times_K_discrete_[num_sampled*(1+num_derivatives)][num_pts]``
+  std::vector<double> K_inv_times_K_discrete_;
+};
+
+/*!\rst
+  State object for OnePotentialSampleKnowledgeGradientEvaluator.  This tracks the *ONE* ``point_to_sample``
+  being evaluated via knowledge gradient.
+
+  The future posterior mean lines are indexed like KnowledgeGradientEvaluator's discretized set: line 0 belongs to
+  ``point_to_sample`` and line ``j > 0`` to ``discrete_pts[j-1]``.
+
+  See general comments on State structs in ``gpp_common.hpp``'s header docs.
+\endrst*/
+struct OnePotentialSampleKnowledgeGradientState final {
+  using EvaluatorType = OnePotentialSampleKnowledgeGradientEvaluator;
+
+  /*!\rst
+    Constructs an OnePotentialSampleKnowledgeGradientState object for the purpose of computing KG
+    (and its gradient) over the specified point to sample.
+
+    .. WARNING::
+         This object is invalidated if the associated kg_evaluator is mutated.  SetupState() should be called to reset.
+
+    .. WARNING::
+         Using this object to compute gradients when ``configure_for_gradients`` := false results in UNDEFINED BEHAVIOR.
+
+    \param
+      :kg_evaluator: knowledge gradient evaluator object that specifies the parameters & GP for KG evaluation
+      :point_to_sample[dim]: point at which to evaluate KG and/or its gradient
+      :configure_for_gradients: true if this object will be used to compute gradients, false otherwise
+  \endrst*/
+  OnePotentialSampleKnowledgeGradientState(const EvaluatorType& kg_evaluator, double const * restrict point_to_sample_in,
+                                           bool configure_for_gradients);
+
+  OnePotentialSampleKnowledgeGradientState(OnePotentialSampleKnowledgeGradientState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim;
+  }
+
+  /*!\rst
+    Get ``point_to_sample``: the potential future sample whose KG (and/or gradients) is being evaluated
+
+    \output
+      :point_to_sample[dim]: potential sample whose KG is being evaluted
+  \endrst*/
+  void GetCurrentPoint(double * restrict point_to_sample_out) const noexcept OL_NONNULL_POINTERS {
+    std::copy(point_to_sample.begin(), point_to_sample.end(), point_to_sample_out);
+  }
+
+  /*!\rst
+    Change the potential sample whose KG (and/or gradient) is being evaluated.
+    Update the state's derived quantities to be consistent with the new point.
+
+    \param
+      :kg_evaluator: knowledge gradient evaluator object that specifies the parameters & GP for KG evaluation
+      :point_to_sample[dim]: potential future sample whose KG (and/or gradients) is being evaluated
+  \endrst*/
+  void SetCurrentPoint(const EvaluatorType& kg_evaluator, double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Configures this state object with a new ``point_to_sample``, the location of the potential sample whose KG is to
+    be evaluated.  Ensures all state variables & temporaries are properly sized.
+
+    .. WARNING::
+         This object's state is INVALIDATED if the kg_evaluator (including the GaussianProcess it depends on) used in
+         SetupState is mutated! SetupState() should be called again in such a situation.
+
+    \param
+      :kg_evaluator: knowledge gradient evaluator object that specifies the parameters & GP for KG evaluation
+      :point_to_sample[dim]: potential future sample whose KG (and/or gradients) is being evaluated
+  \endrst*/
+  void SetupState(const EvaluatorType& kg_evaluator, double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Reuses this state as if it were newly constructed with these (constructor) arguments, keeping its buffers; see
+    KnowledgeGradientState::Reconfigure().
+
+    \param
+      see the constructor
+    \return
+      true if the state was reconfigured; false (state unchanged) if ``dim``, ``configure_for_gradients``, the number
+      of discrete points, or the GP's number of gradient observations differ
+  \endrst*/
+  bool Reconfigure(const EvaluatorType& kg_evaluator, double const * restrict point_to_sample_in,
+                   bool configure_for_gradients) OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim;
+  //! number of points to sample (i.e., the "q" in q,p-KG); MUST be 1
+  const int num_to_sample = 1;
+  //! number of derivative terms desired (usually 0 for no derivatives or num_to_sample)
+  const int num_derivatives;
+  //! number of future posterior mean lines: ``point_to_sample`` and each point of ``discrete_pts``
+  const int num_lines;
+
+  //! point at which to evaluate KG and/or its gradient (e.g., to check its value in future experiments)
+  std::vector<double> point_to_sample;
+
+  //! gaussian process state
+  GaussianProcess::StateType points_to_sample_state;
+
+  // temporary storage: preallocated space used by OnePotentialSampleKnowledgeGradientEvaluator's member functions
+  //! GP mean at point_to_sample
+  double to_sample_mean;
+  //! GP variance at point_to_sample (without noise)
+  double to_sample_var;
+  //! ``\sqrt{to_sample_var + \sigma^2}``, the (1x1) cholesky factor of the variance of the observation at point_to_sample
+  double cholesky_to_sample_var;
+  //! ``a_j``, the current posterior mean at each line's point
+  std::vector<double> intercept;
+  //! ``b_j``, the change in posterior mean at each line's point per unit of the standard normal
+  std::vector<double> slope;
+  //! lines of the lower envelope, in order of increasing Z (decreasing slope)
+  std::vector<int> envelope;
+  //! ``breakpoints[k]``: the Z at which ``envelope[k]`` becomes lowest (``-inf`` for ``k = 0``)
+  std::vector<double> breakpoints;
+  //! number of lines in the envelope
+  int num_envelope;
+  //! the gradient of the GP mean evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_mu;
+  //! the gradient of cholesky_to_sample_var wrt point_to_sample
+  std::vector<double> grad_chol_decomp;
+  //! the gradient of each line's slope wrt point_to_sample, ``grad_slope[dim][num_lines]``
+  std::vector<double> grad_slope;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OnePotentialSampleKnowledgeGradientState);
+};
+
+/*!\rst
+  Set up vector of OnePotentialSampleKnowledgeGradientEvaluator::StateType.
+
+  This is a utility function just for reducing code duplication.
+
+  \param
+    :kg_evaluator: evaluator object associated w/the state objects being constructed
+    :starting_point[dim]: initial point to load into state (must be a valid point for the problem)
+    :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
+    :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
+    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0); states it already holds are reused
+      where possible (see ReuseOrConstructStates()), so a vector kept across calls acts as a pool
+  \output
+    :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
+\endrst*/
+inline OL_NONNULL_POINTERS void SetupKnowledgeGradientState(
+    const OnePotentialSampleKnowledgeGradientEvaluator& kg_evaluator,
+    double const * restrict starting_point,
+    int max_num_threads,
+    bool configure_for_gradients,
+    std::vector<typename OnePotentialSampleKnowledgeGradientEvaluator::StateType> * state_vector) {
+  using StateType = typename OnePotentialSampleKnowledgeGradientEvaluator::StateType;
+  ReuseOrConstructStates(max_num_threads, [&](StateType * state, int OL_UNUSED(i)) {
+      return state->Reconfigure(kg_evaluator, starting_point, configure_for_gradients);
+    }, [&](std::vector<StateType> * states, int OL_UNUSED(i)) {
+      states->emplace_back(kg_evaluator, starting_point, configure_for_gradients);
+    }, state_vector);
+}
 
 struct PosteriorMeanState;
 /*!\rst
@@ -530,6 +1116,24 @@ class PosteriorMeanEvaluator final {
     ComputeGradPosteriorMean(ps_state, grad_PS);
   }
 
+  /*!\rst
+    Batched ComputeGradObjectiveFunction() for lockstep multistart gradient descent (see
+    GradientDescentOptimizer<...>::OptimizeBatch()): moves ``ps_states[k]`` to the ``k``-th point of ``points_to_sample``
+    and computes the gradient there, for every ``k``; the GP quantities of the batch are filled together
+    (SetCurrentPointBatch()).
+
+    \param
+      :ps_states[num_states]: pointers to distinct, properly configured state objects
+      :num_states: number of states in the batch
+      :points_to_sample[num_states][dim - num_fidelity]: new point of each state
+    \output
+      :ps_states[num_states]: states moved to their new points; temporary storage modified
+      :grad_PS[num_states][dim - num_fidelity]: gradient at each state's new point
+  \endrst*/
+  void ComputeGradObjectiveFunctionBatch(StateType * const * ps_states, int num_states,
+                                         double const * restrict points_to_sample,
+                                         double * restrict grad_PS) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the expected improvement ``EI(Xs) = E_n[[f^*_n(X) - min(f(Xs_1),...,f(Xs_m))]^+]``
     Uses analytic formulas to evaluate the expected improvement.
@@ -621,6 +1225,14 @@ struct PosteriorMeanState final {
   void SetCurrentPoint(const EvaluatorType& ps_evaluator,
                        double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    SetCurrentPoint() without filling the GP-derived quantities; see PointsToSampleState::PrepareState().  The state is
+    INVALID until GaussianProcess::FillPointsToSampleStateBatch() fills ``points_to_sample_state`` (SetCurrentPointBatch()
+    does both).
+  \endrst*/
+  void PrepareCurrentPoint(const EvaluatorType& ps_evaluator,
+                           double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
   /*!\rst
     Configures this state object with a new ``point_to_sample``, the location of the potential sample whose EI is to be evaluated.
     Ensures all state variables & temporaries are properly sized.
@@ -678,7 +1290,7 @@ struct PosteriorMeanState final {
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
   \output
     :found_flag[1]: true if best_next_point corresponds to a nonzero EI
@@ -701,6 +1313,126 @@ extern template void ComputeOptimalPosteriorMean(const GaussianProcess& gaussian
                                                  const SimplexIntersectTensorProductDomain& domain, double const * restrict initial_guess,
                                                  bool * restrict found_flag, double * restrict best_next_point);
 
+/*!\rst
+  Shared body of ComputeOptimalPosteriorMeanMultistart() and ComputeOptimalPosteriorMeanMCMC(), for either posterior
+  mean evaluator (PosteriorMeanEvaluator, PosteriorMeanMCMCEvaluator).
+
+  The posterior mean is cheap next to the gradient descent that refines it, so every candidate is screened first, in
+  parallel (SelectBestStartPoints()): the candidates are ``start_point_set``, the training points inside ``domain``
+  (their first ``dim - num_fidelity`` coordinates; the recommended optimum is often at or near one of them), and
+  ``discrete_pts``.  Multistart gradient descent then runs from the ``num_refined_starts`` best on
+  ``thread_schedule``'s threads.  The best candidate is kept unless gradient descent improves on it.
+
+  \param
+    :ps_evaluator: posterior mean evaluator; its states are constructed as ``(ps_evaluator, num_fidelity, point, true)``
+    :num_fidelity: number of fidelity coordinates; they are fixed to 1.0 (the full-fidelity posterior mean)
+    :points_sampled[dim][num_sampled]: training points of the GP(s) behind ``ps_evaluator``
+    :num_sampled: number of training points
+    :optimizer_parameters: GradientDescentParameters object that describes the parameters controlling the optimization;
+      no gradient descent runs if ``max_num_restarts <= 0``
+    :domain: object specifying the domain to optimize over, of dim ``dim - num_fidelity`` (see ``gpp_domain.hpp``)
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :start_point_set[dim - num_fidelity][num_multistarts]: initial guesses, e.g., uniform points in ``domain``
+    :num_multistarts: number of points in ``start_point_set``
+    :discrete_pts[dim - num_fidelity][num_pts]: more candidates (e.g., KG's discretization); nullptr if ``num_pts == 0``
+    :num_pts: number of points in ``discrete_pts``
+    :num_refined_starts: number of candidates with the highest posterior mean objective that gradient descent refines
+      (suggest: 20)
+  \output
+    :found_flag[1]: true if gradient descent improved on the best candidate
+    :best_next_point[dim - num_fidelity]: the point maximizing ``ps_evaluator``'s objective (i.e., minimizing the
+      posterior mean)
+  \raise
+    LowerBoundException<int> if there are no candidates
+\endrst*/
+template <typename PosteriorMeanEvaluatorType, typename DomainType>
+OL_NONNULL_POINTERS_LIST(13, 14) void MultistartPosteriorMeanOptimization(
+    const PosteriorMeanEvaluatorType& ps_evaluator, int num_fidelity, double const * restrict points_sampled,
+    int num_sampled, const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point) {
+  const int dim = ps_evaluator.dim();
+  const int problem_size = dim - num_fidelity;
+  std::vector<double> candidates;
+  candidates.reserve(problem_size*(num_multistarts + num_sampled + num_pts));
+  candidates.insert(candidates.end(), start_point_set, start_point_set + num_multistarts*problem_size);
+  for (int i = 0; i < num_sampled; ++i) {
+    double const * restrict training_point = points_sampled + i*dim;
+    if (domain.CheckPointInside(training_point)) {
+      candidates.insert(candidates.end(), training_point, training_point + problem_size);
+    }
+  }
+  if (num_pts > 0) {
+    candidates.insert(candidates.end(), discrete_pts, discrete_pts + num_pts*problem_size);
+  }
+  const int num_candidates = candidates.size()/problem_size;
+  if (unlikely(num_candidates <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one start point or training point.", num_candidates, 1);
+  }
+
+  using StateType = typename PosteriorMeanEvaluatorType::StateType;
+  bool configure_for_gradients = true;
+  std::vector<StateType> ps_state_vector;
+  ps_state_vector.reserve(thread_schedule.max_num_threads);
+  for (int i = 0; i < thread_schedule.max_num_threads; ++i) {
+    ps_state_vector.emplace_back(ps_evaluator, num_fidelity, candidates.data(), configure_for_gradients);
+  }
+
+  // screen every candidate on all threads; descend from the best few
+  const int k = std::max(1, std::min(num_refined_starts, num_candidates));
+  std::vector<double> refined_starts(k*problem_size);
+  SelectBestStartPoints(ps_evaluator, candidates.data(), num_candidates, k, thread_schedule.max_num_threads,
+                        ps_state_vector.data(), refined_starts.data());
+
+  ps_state_vector[0].SetCurrentPoint(ps_evaluator, refined_starts.data());
+  OptimizationIOContainer io_container(problem_size, ps_evaluator.ComputeObjectiveFunction(ps_state_vector.data()),
+                                       refined_starts.data());
+  if (optimizer_parameters.max_num_restarts > 0) {
+    GradientDescentOptimizer<PosteriorMeanEvaluatorType, DomainType> gd_opt;
+    MultistartOptimizer<GradientDescentOptimizer<PosteriorMeanEvaluatorType, DomainType> > multistart_optimizer;
+    multistart_optimizer.MultistartOptimize(gd_opt, ps_evaluator, optimizer_parameters, domain, thread_schedule,
+                                            refined_starts.data(), k, ps_state_vector.data(), nullptr, &io_container);
+  }
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+}
+
+/*!\rst
+  ComputeOptimalPosteriorMean() from many starts in parallel: screens ``start_point_set``, the training points, and
+  ``discrete_pts``, then runs multistart gradient descent from the best few (see
+  MultistartPosteriorMeanOptimization()).  Use it to report the current recommended optimum after each observation.
+
+  \param
+    :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+      that describes the underlying GP
+    (the rest as in MultistartPosteriorMeanOptimization())
+  \output
+    :found_flag[1]: true if gradient descent improved on the best candidate
+    :best_next_point[dim - num_fidelity]: the point with the lowest posterior mean found
+\endrst*/
+template <typename DomainType>
+void ComputeOptimalPosteriorMeanMultistart(const GaussianProcess& gaussian_process, const int num_fidelity,
+                                           const GradientDescentParameters& optimizer_parameters,
+                                           const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                           double const * restrict start_point_set, int num_multistarts,
+                                           double const * restrict discrete_pts, int num_pts, int num_refined_starts,
+                                           bool * restrict found_flag, double * restrict best_next_point);
+// template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
+extern template void ComputeOptimalPosteriorMeanMultistart(
+    const GaussianProcess& gaussian_process, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+extern template void ComputeOptimalPosteriorMeanMultistart(
+    const GaussianProcess& gaussian_process, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, double const * restrict start_point_set, int num_multistarts,
+    double const * restrict discrete_pts, int num_pts, int num_refined_starts, bool * restrict found_flag,
+    double * restrict best_next_point);
+
 /*!\rst
   Set up vector of KnowledgeGradientEvaluator::StateType.
 
@@ -715,8 +1447,9 @@ extern template void ComputeOptimalPosteriorMean(const GaussianProcess& gaussian
     :num_being_sampled: number of points being sampled concurrently (i.e., the p in q,p-KG)
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
-    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
-    :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
+    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0); states it already holds are reused
+      where possible (see ReuseOrConstructStates()), so a vector kept across calls acts as a pool
+    :normal_rng[max_num_threads]: a NormalRNGArray of generators that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -730,14 +1463,18 @@ inline OL_NONNULL_POINTERS void SetupKnowledgeGradientState(
     int const * restrict gradients, int num_gradients,
     int max_num_threads,
     bool configure_for_gradients,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> * state_vector) {
-  state_vector->reserve(max_num_threads);
-  for (int i = 0; i < max_num_threads; ++i) {
-    state_vector->emplace_back(kg_evaluator, points_to_sample, points_being_sampled, num_to_sample,
-                               num_being_sampled, kg_evaluator.num_mc_iterations(), gradients,
-                               num_gradients, configure_for_gradients, normal_rng + i);
-  }
+  using StateType = typename KnowledgeGradientEvaluator<DomainType>::StateType;
+  ReuseOrConstructStates(max_num_threads, [&](StateType * state, int i) {
+      return state->Reconfigure(kg_evaluator, points_to_sample, points_being_sampled, num_to_sample,
+                                num_being_sampled, kg_evaluator.num_mc_iterations(), gradients,
+                                num_gradients, configure_for_gradients, &normal_rng[i]);
+    }, [&](std::vector<StateType> * states, int i) {
+      states->emplace_back(kg_evaluator, points_to_sample, points_being_sampled, num_to_sample,
+                           num_being_sampled, kg_evaluator.num_mc_iterations(), gradients,
+                           num_gradients, configure_for_gradients, &normal_rng[i]);
+    }, state_vector);
 }
 
 /*!\rst
@@ -822,6 +1559,10 @@ void RestartedGradientDescentKGOptimization(const KnowledgeGradientEvaluator& kg
 
   Users may prefer to call ComputeKGOptimalPointsToSample(), which applies other heuristics to improve robustness.
 
+  As with EI, 1,0-KG (``num_to_sample == 1``, ``num_being_sampled == 0``; here also without fidelity dimensions or
+  gradient observations) uses the exact OnePotentialSampleKnowledgeGradientEvaluator instead of monte carlo; then
+  ``optimizer_parameters_inner``, ``inner_domain``, ``max_int_steps``, and ``normal_rng`` are unused.
+
   Currently, during optimization, we recommend that the coordinates of the initial guesses not differ from the
   coordinates of the optima by more than about 1 order of magnitude. This is a very (VERY!) rough guideline for
   sizing the domain and num_multistarts; i.e., be wary of sets of initial guesses that cover the space too sparsely.
@@ -851,21 +1592,30 @@ void RestartedGradientDescentKGOptimization(const KnowledgeGradientEvaluator& kg
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :num_refined_starts: number of starts with the best initial KG that gradient descent refines (in parallel);
+      all ``num_multistarts`` are screened in parallel (suggest: 1)
+    :num_screening_mc_iterations: MC iterations of the first successive-halving screening round (see
+      SuccessiveHalvingSelectStartPoints(); doubled every round up to ``max_int_steps``); 0 screens every start at
+      ``max_int_steps`` (suggest: ``max_int_steps/16`` for hundreds of starts)
+    :top_points[1]: DiverseTopPoints requesting the best distinct results of the refined starts, or nullptr (the
+      default); at most ``num_refined_starts`` can be found
   \output
     :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
     :found_flag[1]: true if ``best_next_point`` corresponds to a nonzero KG
     :best_next_point[dim][num_to_sample]: points yielding the best KG according to MGD
+    :top_points[1]: up to ``top_points->num_points`` distinct ``[dim][num_to_sample]`` results and their KG, best first
+      (see DiverseTopPoints)
 \endrst*/
 template <typename DomainType>
-OL_NONNULL_POINTERS void ComputeKGOptimalPointsToSampleViaMultistartGradientDescent(
+OL_NONNULL_POINTERS_LIST(8, 9, 10, 18, 19) void ComputeKGOptimalPointsToSampleViaMultistartGradientDescent(
     const GaussianProcess& gaussian_process, const int num_fidelity,
     const GradientDescentParameters& optimizer_parameters,
     const GradientDescentParameters& optimizer_parameters_inner,
     const DomainType& domain, const DomainType& inner_domain,
-    const ThreadSchedule& thread_schedule,
+    const ThreadSchedule& thread_schedule_in,
     double const * restrict start_point_set,
     double const * restrict points_being_sampled,
     double const * discrete_pts,
@@ -875,16 +1625,65 @@ OL_NONNULL_POINTERS void ComputeKGOptimalPointsToSampleViaMultistartGradientDesc
     int num_pts,
     double best_so_far,
     int max_int_steps,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     bool * restrict found_flag,
-    double * restrict best_next_point) {
+    double * restrict best_next_point,
+    int num_refined_starts = 1,
+    int num_screening_mc_iterations = 0,
+    DiverseTopPoints * top_points = nullptr) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
   }
+  ThreadSchedule thread_schedule(thread_schedule_in);
 
   bool configure_for_gradients = true;
+  if (num_to_sample == 1 && num_being_sampled == 0 && num_fidelity == 0 && gaussian_process.num_derivatives() == 0) {
+    // special analytic case: 1,0-KG over the discretization is exact (no MC iterations, no inner optimization)
+    OnePotentialSampleKnowledgeGradientEvaluator kg_evaluator(gaussian_process, discrete_pts, num_pts, best_so_far);
+
+    std::vector<typename OnePotentialSampleKnowledgeGradientEvaluator::StateType> kg_state_vector;
+    SetupKnowledgeGradientState(kg_evaluator, start_point_set, thread_schedule.max_num_threads,
+                                configure_for_gradients, &kg_state_vector);
+
+    // same start selection as the MC path below: descend from the starts with the best KG
+    const int k = std::min(num_refined_starts, num_multistarts);
+    std::vector<double> top_k_starting(k*gaussian_process.dim());
+    SelectBestStartPoints(kg_evaluator, start_point_set, num_multistarts, k, thread_schedule.max_num_threads,
+                          kg_state_vector.data(), top_k_starting.data());
+
+    OptimizationIOContainer io_container(kg_state_vector[0].GetProblemSize(), -INFINITY, top_k_starting.data());
+    if (top_points != nullptr) {
+      io_container.top_points = *top_points;
+    }
+    ThreadSchedule multistart_thread_schedule(std::min(k, thread_schedule.max_num_threads), thread_schedule.schedule,
+                                              thread_schedule.chunk_size, thread_schedule.backend);
+    GradientDescentOptimizer<OnePotentialSampleKnowledgeGradientEvaluator, DomainType> gd_opt;
+    MultistartOptimizer<GradientDescentOptimizer<OnePotentialSampleKnowledgeGradientEvaluator, DomainType> > multistart_optimizer;
+    multistart_optimizer.MultistartOptimize(gd_opt, kg_evaluator, optimizer_parameters,
+                                            domain, multistart_thread_schedule, top_k_starting.data(),
+                                            k, kg_state_vector.data(), nullptr, &io_container);
+    *found_flag = io_container.found_flag;
+    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    if (top_points != nullptr) {
+      *top_points = std::move(io_container.top_points);
+    }
+    return;
+  }
+
+  // under a process memory budget, shrink the gradient's MC blocks, then the thread count (see gpp_memory_budget.hpp)
+  std::size_t grad_memory_budget = KnowledgeGradientEvaluator<DomainType>::kDefaultGradMemoryBudget;
+  AdmitKnowledgeGradientMemory(gaussian_process.dim(), gaussian_process.num_sampled(),
+                               gaussian_process.num_derivatives(), num_to_sample, num_being_sampled, num_pts,
+                               max_int_steps, false, KnowledgeGradientEvaluator<DomainType>::kDefaultNumWarmStarts,
+                               &thread_schedule.max_num_threads, &grad_memory_budget);
+
+  // with few starts surviving to gradient descent (below), the threads are better spent on the KG MC iterations;
+  // consecutive descent steps barely move points_to_sample, so each inner solve warm starts from the previous optimum
   KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts, max_int_steps,
-                                                      inner_domain, optimizer_parameters_inner, best_so_far);
+                                                      inner_domain, optimizer_parameters_inner, best_so_far,
+                                                      KnowledgeGradientInnerMode::kGradientDescent,
+                                                      KnowledgeGradientEvaluator<DomainType>::kDefaultNumWarmStarts,
+                                                      thread_schedule.max_num_threads, kNoGpu, grad_memory_budget);
 
   int num_derivatives = kg_evaluator.gaussian_process()->num_derivatives();
   std::vector<int> derivatives(kg_evaluator.gaussian_process()->derivatives());
@@ -894,47 +1693,154 @@ OL_NONNULL_POINTERS void ComputeKGOptimalPointsToSampleViaMultistartGradientDesc
                               num_to_sample, num_being_sampled, derivatives.data(), num_derivatives,
                               thread_schedule.max_num_threads, configure_for_gradients, normal_rng, &kg_state_vector);
 
-  std::vector<double> KG_starting(num_multistarts);
-  for (int i=0; i<num_multistarts; ++i){
-    kg_state_vector[0].SetCurrentPoint(kg_evaluator, start_point_set + i*num_to_sample*gaussian_process.dim());
-    KG_starting[i] = kg_evaluator.ComputeKnowledgeGradient(&kg_state_vector[0]);
-  }
-
-  std::priority_queue<std::pair<double, int>> q;
-  int k = 1; // number of indices we need
-  for (int i = 0; i < KG_starting.size(); ++i) {
-    if (i < k){
-      q.push(std::pair<double, int>(-KG_starting[i], i));
-    }
-    else{
-      if (q.top().first > -KG_starting[i]){
-        q.pop();
-        q.push(std::pair<double, int>(-KG_starting[i], i));
-      }
-    }
-  }
-
+  // screen every start on all threads (each evaluation's MC loop is then nested, see SelectBestStartPoints());
+  // descend from the best k
+  const int k = std::min(num_refined_starts, num_multistarts);
   std::vector<double> top_k_starting(k*num_to_sample*gaussian_process.dim());
-  for (int i = 0; i < k; ++i) {
-    int ki = q.top().second;
-    for (int d = 0; d<num_to_sample*gaussian_process.dim(); ++d){
-      top_k_starting[i*num_to_sample*gaussian_process.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process.dim() + d];
-    }
-    q.pop();
+  if (num_screening_mc_iterations > 0 && num_screening_mc_iterations < max_int_steps) {
+    // rounds below the full budget rank on a cheaper evaluator; the last round reuses kg_evaluator's states
+    auto select_at_budget = [&](int num_mc_iterations, double const * candidates, int num_candidates, int num_keep,
+                                double * kept) {
+      if (num_mc_iterations >= max_int_steps) {
+        SelectBestStartPoints(kg_evaluator, candidates, num_candidates, num_keep, thread_schedule.max_num_threads,
+                              kg_state_vector.data(), kept);
+        return;
+      }
+      KnowledgeGradientEvaluator<DomainType> screen_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts,
+                                                              num_mc_iterations, inner_domain,
+                                                              optimizer_parameters_inner, best_so_far,
+                                                              kg_evaluator.inner_mode(), kg_evaluator.num_warm_starts(),
+                                                              thread_schedule.max_num_threads);
+      const bool screen_for_gradients = false;
+      std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> screen_state_vector;
+      SetupKnowledgeGradientState(screen_evaluator, candidates, points_being_sampled, num_to_sample,
+                                  num_being_sampled, derivatives.data(), num_derivatives,
+                                  thread_schedule.max_num_threads, screen_for_gradients, normal_rng,
+                                  &screen_state_vector);
+      SelectBestStartPoints(screen_evaluator, candidates, num_candidates, num_keep, thread_schedule.max_num_threads,
+                            screen_state_vector.data(), kept);
+    };
+    SuccessiveHalvingSelectStartPoints(select_at_budget, start_point_set, num_to_sample*gaussian_process.dim(),
+                                       num_multistarts, k, num_screening_mc_iterations, max_int_steps,
+                                       top_k_starting.data());
+  } else {
+    SelectBestStartPoints(kg_evaluator, start_point_set, num_multistarts, k, thread_schedule.max_num_threads,
+                          kg_state_vector.data(), top_k_starting.data());
   }
 
   // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
   OptimizationIOContainer io_container(kg_state_vector[0].GetProblemSize(), -INFINITY, top_k_starting.data());
+  if (top_points != nullptr) {
+    io_container.top_points = *top_points;
+  }
 
+  // k = 1 (one thread) keeps the multistart region inactive so kg_evaluator's MC loop can fork
+  ThreadSchedule multistart_thread_schedule(std::min(k, thread_schedule.max_num_threads), thread_schedule.schedule,
+                                            thread_schedule.chunk_size, thread_schedule.backend);
   using RepeatedDomain = RepeatedDomain<DomainType>;
   RepeatedDomain repeated_domain(domain, num_to_sample);
   GradientDescentOptimizer<KnowledgeGradientEvaluator<DomainType>, RepeatedDomain> gd_opt;
   MultistartOptimizer<GradientDescentOptimizer<KnowledgeGradientEvaluator<DomainType>, RepeatedDomain> > multistart_optimizer;
   multistart_optimizer.MultistartOptimize(gd_opt, kg_evaluator, optimizer_parameters,
-                                          repeated_domain, thread_schedule, top_k_starting.data(),
+                                          repeated_domain, multistart_thread_schedule, top_k_starting.data(),
                                           k, kg_state_vector.data(), nullptr, &io_container);
   *found_flag = io_container.found_flag;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+  if (top_points != nullptr) {
+    *top_points = std::move(io_container.top_points);
+  }
+}
+
+/*!\rst
+  Racing variant of ComputeKGOptimalPointsToSampleViaMultistartGradientDescent() (above): instead of keeping only the
+  start with the best initial KG, EVERY start takes ``racing_parameters.num_steps_per_round`` gradient descent steps
+  per round and the worst are dropped after each round (MultistartOptimizer<...>::MultistartRace()).  The survivors
+  are then optimized with the full ``optimizer_parameters``; the result is the best KG reached by any start.
+
+  Starts are raced in parallel (up to ``thread_schedule.max_num_threads`` at once); the KG MC loop of each evaluation
+  gets the threads the outer loop leaves idle (see MultistartRace()).
+
+  \param
+    :racing_parameters: RacingParameters object that controls the rounds (suggest: 4 rounds of 10 steps dropping 0.5,
+      with 2 survivors)
+    (all other parameters and outputs are as in the non-racing overload)
+\endrst*/
+template <typename DomainType>
+OL_NONNULL_POINTERS void ComputeKGOptimalPointsToSampleViaMultistartGradientDescent(
+    const GaussianProcess& gaussian_process, const int num_fidelity,
+    const GradientDescentParameters& optimizer_parameters,
+    const GradientDescentParameters& optimizer_parameters_inner,
+    const RacingParameters& racing_parameters,
+    const DomainType& domain, const DomainType& inner_domain,
+    const ThreadSchedule& thread_schedule_in,
+    double const * restrict start_point_set,
+    double const * restrict points_being_sampled,
+    double const * discrete_pts,
+    int num_multistarts,
+    int num_to_sample,
+    int num_being_sampled,
+    int num_pts,
+    double best_so_far,
+    int max_int_steps,
+    NormalRNGArray normal_rng,
+    bool * restrict found_flag,
+    double * restrict best_next_point) {
+  if (unlikely(num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
+  }
+  ThreadSchedule thread_schedule(thread_schedule_in);
+
+  // under a process memory budget, shrink the gradient's MC blocks, then the thread count (see gpp_memory_budget.hpp)
+  std::size_t grad_memory_budget = KnowledgeGradientEvaluator<DomainType>::kDefaultGradMemoryBudget;
+  AdmitKnowledgeGradientMemory(gaussian_process.dim(), gaussian_process.num_sampled(),
+                               gaussian_process.num_derivatives(), num_to_sample, num_being_sampled, num_pts,
+                               max_int_steps, false, KnowledgeGradientEvaluator<DomainType>::kDefaultNumWarmStarts,
+                               &thread_schedule.max_num_threads, &grad_memory_budget);
+
+  bool configure_for_gradients = true;
+  KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts, max_int_steps,
+                                                      inner_domain, optimizer_parameters_inner, best_so_far,
+                                                      KnowledgeGradientInnerMode::kGradientDescent,
+                                                      KnowledgeGradientEvaluator<DomainType>::kDefaultNumWarmStarts,
+                                                      thread_schedule.max_num_threads, kNoGpu, grad_memory_budget);
+
+  int num_derivatives = kg_evaluator.gaussian_process()->num_derivatives();
+  std::vector<int> derivatives(kg_evaluator.gaussian_process()->derivatives());
+
+  std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> kg_state_vector;
+  SetupKnowledgeGradientState(kg_evaluator, start_point_set, points_being_sampled,
+                              num_to_sample, num_being_sampled, derivatives.data(), num_derivatives,
+                              thread_schedule.max_num_threads, configure_for_gradients, normal_rng, &kg_state_vector);
+
+  // init winner to be first point in set; any start that is evaluated beats -INFINITY
+  const int problem_size = kg_state_vector[0].GetProblemSize();
+  OptimizationIOContainer io_container(problem_size, -INFINITY, start_point_set);
+
+  using RepeatedDomain = RepeatedDomain<DomainType>;
+  RepeatedDomain repeated_domain(domain, num_to_sample);
+  GradientDescentOptimizer<KnowledgeGradientEvaluator<DomainType>, RepeatedDomain> gd_opt;
+  MultistartOptimizer<GradientDescentOptimizer<KnowledgeGradientEvaluator<DomainType>, RepeatedDomain> > multistart_optimizer;
+
+  // one restart per round: each round continues from the previous round's point with a fresh step size schedule
+  GradientDescentParameters round_parameters(1, racing_parameters.num_steps_per_round, 1,
+                                             optimizer_parameters.num_steps_averaged, optimizer_parameters.gamma,
+                                             optimizer_parameters.pre_mult, optimizer_parameters.max_relative_change,
+                                             optimizer_parameters.tolerance);
+  std::vector<double> survivor_points(num_multistarts*problem_size);
+  const int num_survivors = multistart_optimizer.MultistartRace(gd_opt, kg_evaluator, round_parameters, racing_parameters,
+                                                                repeated_domain, thread_schedule, start_point_set,
+                                                                num_multistarts, kg_state_vector.data(), nullptr,
+                                                                survivor_points.data(), &io_container);
+  const bool found_while_racing = io_container.found_flag;
+
+  ThreadSchedule survivor_thread_schedule(std::min(num_survivors, thread_schedule.max_num_threads),
+                                          thread_schedule.schedule, thread_schedule.chunk_size,
+                                          thread_schedule.backend);
+  multistart_optimizer.MultistartOptimize(gd_opt, kg_evaluator, optimizer_parameters,
+                                          repeated_domain, survivor_thread_schedule, survivor_points.data(),
+                                          num_survivors, kg_state_vector.data(), nullptr, &io_container);
+  *found_flag = found_while_racing || io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
 }
 
 /*!\rst
@@ -962,7 +1868,7 @@ OL_NONNULL_POINTERS void ComputeKGOptimalPointsToSampleViaMultistartGradientDesc
     :num_pts: number of points in discrete_pts
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -980,7 +1886,7 @@ void EvaluateKGAtPointList(const GaussianProcess& gaussian_process, const int nu
                            double const * restrict points_being_sampled,
                            double const * discrete_pts, int num_multistarts, int num_to_sample,
                            int num_being_sampled, int num_pts, double best_so_far,
-                           int max_int_steps, bool * restrict found_flag, NormalRNG * normal_rng,
+                           int max_int_steps, bool * restrict found_flag, NormalRNGArray normal_rng,
                            double * restrict function_values,
                            double * restrict best_next_point) {
   if (unlikely(num_multistarts <= 0)) {
@@ -991,8 +1897,15 @@ void EvaluateKGAtPointList(const GaussianProcess& gaussian_process, const int nu
   DomainType_dummy dummy_domain;
   bool configure_for_gradients = false;
 
+  // with fewer points than threads, evaluate the points one at a time and spread each point's MC iterations instead
+  const bool parallelize_mc_iterations = num_multistarts < thread_schedule.max_num_threads;
+  ThreadSchedule point_list_thread_schedule(parallelize_mc_iterations ? 1 : thread_schedule.max_num_threads,
+                                            thread_schedule.schedule, thread_schedule.chunk_size,
+                                            thread_schedule.backend);
   KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts, max_int_steps,
-                                                      inner_domain, optimizer_parameters_inner, best_so_far);
+                                                      inner_domain, optimizer_parameters_inner, best_so_far,
+                                                      KnowledgeGradientInnerMode::kGradientDescent, 0,
+                                                      parallelize_mc_iterations ? thread_schedule.max_num_threads : 1);
 
   int num_derivatives = kg_evaluator.gaussian_process()->num_derivatives();
   std::vector<int> derivatives(kg_evaluator.gaussian_process()->derivatives());
@@ -1009,12 +1922,82 @@ void EvaluateKGAtPointList(const GaussianProcess& gaussian_process, const int nu
   typename NullOptimizer<KnowledgeGradientEvaluator<DomainType>, DomainType_dummy>::ParameterStruct null_parameters;
   MultistartOptimizer<NullOptimizer<KnowledgeGradientEvaluator<DomainType>, DomainType_dummy> > multistart_optimizer;
   multistart_optimizer.MultistartOptimize(null_opt, kg_evaluator, null_parameters,
-                                          dummy_domain, thread_schedule, initial_guesses,
+                                          dummy_domain, point_list_thread_schedule, initial_guesses,
                                           num_multistarts, kg_state_vector.data(), function_values, &io_container);
   *found_flag = io_container.found_flag;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
 }
 
+/*!\rst
+  Evaluates q,p-KG (and optionally its gradient) at each of ``num_sets`` q-sets of points to sample, against the same
+  ``points_being_sampled`` and ``discrete_pts``.  This is the batched form of looping
+  KnowledgeGradientEvaluator::ComputeObjectiveFunction() (or ComputeObjectiveAndGradient()) over the sets: the evaluator
+  and the per-thread states are built once and the sets are spread over the threads (see EvaluateObjectiveAtPointSets()
+  in gpp_optimization.hpp).  As in EvaluateKGAtPointList(), with fewer sets than threads the spare threads go to each
+  set's MC iterations instead.
+
+  Set ``i`` is evaluated by state (and NormalRNG) ``i % num_threads``, where ``num_threads`` is the smaller of
+  ``thread_schedule.max_num_threads`` and ``num_sets``; so the results are reproducible for a fixed thread count.
+
+  \param
+    :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+      that describes the underlying GP
+    :num_fidelity: number of fidelity dimensions
+    :optimizer_parameters_inner: GradientDescentParameters object that describes the parameters controlling the
+      inner optimization of KG
+    :inner_domain: object specifying the domain of the inner optimization (see ``gpp_domain.hpp``)
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; only ``max_num_threads`` is used
+    :point_sets[dim][num_to_sample][num_sets]: the q-sets at which to compute KG
+    :points_being_sampled[dim][num_being_sampled]: points that are being sampled in concurrent experiments
+    :discrete_pts[dim][num_pts]: points to approximate KG
+    :num_sets: number of q-sets
+    :num_to_sample: number of potential future samples per set; gradients are evaluated wrt these points (i.e., the
+      "q" in q,p-KG)
+    :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-KG)
+    :num_pts: number of points in discrete_pts
+    :best_so_far: value of the best mean value so far in discrete_pts
+    :max_int_steps: maximum number of MC iterations
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
+      the (pesudo)random source for MC integration
+  \output
+    :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
+    :function_values[num_sets]: KG of each set of ``point_sets``, in the same order
+    :gradients[dim][num_to_sample][num_sets]: gradient of KG of each set wrt its points to sample, in the same order;
+      never dereferenced if nullptr
+\endrst*/
+template <typename DomainType>
+void ComputeKnowledgeGradientAtPointSets(const GaussianProcess& gaussian_process, const int num_fidelity,
+                                         const GradientDescentParameters& optimizer_parameters_inner,
+                                         const DomainType& inner_domain, const ThreadSchedule& thread_schedule,
+                                         double const * restrict point_sets,
+                                         double const * restrict points_being_sampled,
+                                         double const * discrete_pts, int num_sets, int num_to_sample,
+                                         int num_being_sampled, int num_pts, double best_so_far,
+                                         int max_int_steps, NormalRNGArray normal_rng,
+                                         double * restrict function_values, double * restrict gradients) {
+  if (unlikely(num_sets <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_sets must be >= 1", num_sets, 1);
+  }
+
+  const bool configure_for_gradients = gradients != nullptr;
+  const int max_num_threads = std::max(thread_schedule.max_num_threads, 1);
+  const int num_threads = std::min(max_num_threads, num_sets);
+  KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts, max_int_steps,
+                                                      inner_domain, optimizer_parameters_inner, best_so_far,
+                                                      KnowledgeGradientInnerMode::kGradientDescent, 0,
+                                                      num_sets < max_num_threads ? max_num_threads : 1);
+
+  int num_derivatives = kg_evaluator.gaussian_process()->num_derivatives();
+  std::vector<int> derivatives(kg_evaluator.gaussian_process()->derivatives());
+
+  std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> kg_state_vector;
+  SetupKnowledgeGradientState(kg_evaluator, point_sets, points_being_sampled,
+                              num_to_sample, num_being_sampled, derivatives.data(), num_derivatives,
+                              num_threads, configure_for_gradients, normal_rng, &kg_state_vector);
+  EvaluateObjectiveAtPointSets(kg_evaluator, point_sets, num_sets, num_threads, kg_state_vector.data(),
+                               function_values, gradients);
+}
+
 /*!\rst
   Perform multistart gradient descent (MGD) to solve the q,p-KG problem (see ComputeKGOptimalPointsToSample and/or
   header docs), starting from ``num_multistarts`` points selected randomly from the within the domain.
@@ -1041,7 +2024,7 @@ void EvaluateKGAtPointList(const GaussianProcess& gaussian_process, const int nu
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -1058,7 +2041,7 @@ void ComputeKGOptimalPointsToSampleWithRandomStarts(const GaussianProcess& gauss
                                                     double const * restrict points_being_sampled, double const * discrete_pts,
                                                     int num_to_sample, int num_being_sampled, int num_pts,
                                                     double best_so_far, int max_int_steps, bool * restrict found_flag,
-                                                    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng,
+                                                    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng,
                                                     double * restrict best_next_point) {
   std::vector<double> starting_points(gaussian_process.dim()*optimizer_parameters.num_multistarts*num_to_sample);
 
@@ -1109,9 +2092,12 @@ void ComputeKGOptimalPointsToSampleWithRandomStarts(const GaussianProcess& gauss
     :best_so_far: value of the best mean value so far in discrete_pts
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
+    :tile_size: if positive and less than ``num_multistarts``, stream the candidates in tiles of this many q-sets
+      (see StreamingUniformSearch()) instead of materializing all ``num_multistarts`` of them; 0 (default) for the
+      full list
   \output
     found_flag[1]: true if best_next_point corresponds to a nonzero KG
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -1130,10 +2116,39 @@ void ComputeKGOptimalPointsToSampleViaLatinHypercubeSearch(const GaussianProcess
                                                            int max_int_steps,
                                                            bool * restrict found_flag,
                                                            UniformRandomGenerator * uniform_generator,
-                                                           NormalRNG * normal_rng,
-                                                           double * restrict best_next_point) {
-  std::vector<double> initial_guesses(gaussian_process.dim()*num_multistarts*num_to_sample);
+                                                           NormalRNGArray normal_rng,
+                                                           double * restrict best_next_point,
+                                                           int tile_size = 0) {
   RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  if (tile_size > 0 && tile_size < num_multistarts) {
+    const int num_tiles = (num_multistarts + tile_size - 1)/tile_size;
+    // as in EvaluateKGAtPointList(): with fewer tiles than threads, spread each point's MC iterations instead
+    const bool parallelize_mc_iterations = num_tiles < thread_schedule.max_num_threads;
+    const int num_threads = parallelize_mc_iterations ? 1 : thread_schedule.max_num_threads;
+    KnowledgeGradientEvaluator<DomainType> kg_evaluator(gaussian_process, num_fidelity, discrete_pts, num_pts,
+                                                        max_int_steps, inner_domain, optimizer_parameters_inner,
+                                                        best_so_far, KnowledgeGradientInnerMode::kGradientDescent, 0,
+                                                        parallelize_mc_iterations ?
+                                                        thread_schedule.max_num_threads : 1);
+    std::vector<int> derivatives(kg_evaluator.gaussian_process()->derivatives());
+
+    // the states need a valid point to start from; it is also the answer if no candidate is evaluated
+    std::vector<double> initial_point(gaussian_process.dim()*num_to_sample);
+    int OL_UNUSED(num_initial_points) = repeated_domain.GenerateUniformPointsInDomain(1, uniform_generator,
+                                                                                      initial_point.data());
+    std::vector<typename KnowledgeGradientEvaluator<DomainType>::StateType> kg_state_vector;
+    SetupKnowledgeGradientState(kg_evaluator, initial_point.data(), points_being_sampled, num_to_sample,
+                                num_being_sampled, derivatives.data(), derivatives.size(), num_threads, false,
+                                normal_rng, &kg_state_vector);
+    OptimizationIOContainer io_container(kg_state_vector[0].GetProblemSize(), -INFINITY, initial_point.data());
+    StreamingUniformSearch(kg_evaluator, repeated_domain, num_multistarts, tile_size, num_threads,
+                           kg_state_vector.data(), uniform_generator, &io_container);
+    *found_flag = io_container.found_flag;
+    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    return;
+  }
+
+  std::vector<double> initial_guesses(gaussian_process.dim()*num_multistarts*num_to_sample);
   num_multistarts = repeated_domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
                                                                   initial_guesses.data());
 
@@ -1182,7 +2197,7 @@ void ComputeKGOptimalPointsToSampleViaLatinHypercubeSearch(const GaussianProcess
     :lhc_search_only: whether to ONLY use latin hypercube search (and skip gradient descent EI opt)
     :num_lhc_samples: number of samples to draw if/when doing latin hypercube search
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
     :noise: variance of measurement noise
   \output
@@ -1203,7 +2218,7 @@ void ComputeKGOptimalPointsToSample(const GaussianProcess& gaussian_process, con
                                     int max_int_steps, bool lhc_search_only,
                                     int num_lhc_samples, bool * restrict found_flag,
                                     UniformRandomGenerator * uniform_generator,
-                                    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+                                    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 // template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
 extern template void ComputeKGOptimalPointsToSample(
     const GaussianProcess& gaussian_process, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
@@ -1213,7 +2228,7 @@ extern template void ComputeKGOptimalPointsToSample(
     int num_to_sample, int num_being_sampled,
     int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 extern template void ComputeKGOptimalPointsToSample(
     const GaussianProcess& gaussian_process, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
     const GradientDescentParameters& optimizer_parameters_inner,
@@ -1221,7 +2236,112 @@ extern template void ComputeKGOptimalPointsToSample(
     double const * restrict points_being_sampled,double const * discrete_pts,
     int num_to_sample, int num_being_sampled,
     int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+extern template void ComputeKGOptimalPointsToSample(
+    const GaussianProcess& gaussian_process, const int num_fidelity, const GradientDescentParameters& optimizer_parameters,
+    const GradientDescentParameters& optimizer_parameters_inner,
+    const TrustRegionDomain& domain, const TrustRegionDomain& inner_domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled, double const * discrete_pts,
+    int num_to_sample, int num_being_sampled,
+    int num_pts, double best_so_far, int max_int_steps, bool lhc_search_only,
+    int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+
+/*!\rst
+  Settings for BuildKnowledgeGradientDiscretization().  The default constructor gives the suggested values.
+\endrst*/
+struct KnowledgeGradientDiscretizationParameters final {
+  //! default number of uniform candidates
+  static constexpr int kDefaultNumCandidates = 1000;
+  //! default number of candidates around the incumbent
+  static constexpr int kDefaultNumNeighbors = 32;
+  //! default half-width of the box around the incumbent, relative to the domain's side lengths
+  static constexpr double kDefaultNeighborScale = 0.05;
+  //! default number of sampled global optima
+  static constexpr int kDefaultNumOptima = 16;
+  //! default smallest discretization
+  static constexpr int kDefaultMinNumPoints = 8;
+  //! default largest discretization
+  static constexpr int kDefaultMaxNumPoints = 128;
+  //! default probability below which a candidate is left out
+  static constexpr double kDefaultExclusionProbability = 0.01;
+
+  KnowledgeGradientDiscretizationParameters()
+      : KnowledgeGradientDiscretizationParameters(kDefaultNumCandidates, kDefaultNumNeighbors, kDefaultNeighborScale,
+                                                  kDefaultNumOptima, kDefaultMinNumPoints, kDefaultMaxNumPoints,
+                                                  kDefaultExclusionProbability) {
+  }
+
+  KnowledgeGradientDiscretizationParameters(int num_candidates_in, int num_neighbors_in, double neighbor_scale_in,
+                                            int num_optima_in, int min_num_pts_in, int max_num_pts_in,
+                                            double exclusion_probability_in)
+      : num_candidates(num_candidates_in),
+        num_neighbors(num_neighbors_in),
+        neighbor_scale(neighbor_scale_in),
+        num_optima(num_optima_in),
+        min_num_pts(min_num_pts_in),
+        max_num_pts(max_num_pts_in),
+        exclusion_probability(exclusion_probability_in) {
+  }
+
+  //! number of uniform (latin hypercube or Sobol, see StartPointSampling) candidates spread over the domain
+  int num_candidates;
+  //! number of uniform candidates in a box around the incumbent (the candidate with the lowest posterior mean)
+  int num_neighbors;
+  //! half-width of that box, relative to the domain's side lengths
+  double neighbor_scale;
+  //! number of approximate global optima (minima) drawn from posterior sample paths (SampleGlobalOptimaViaPathwiseSamples())
+  int num_optima;
+  //! fewest points returned (if there are that many distinct candidates), however unlikely the extra points are
+  int min_num_pts;
+  //! most points returned
+  int max_num_pts;
+  //! the accuracy target, in ``(0, 0.5)``: candidates that fall below the best posterior mean with a smaller (marginal)
+  //! probability are left out
+  double exclusion_probability;
+};
+
+/*!\rst
+  Builds a small ``discrete_pts`` for KnowledgeGradientEvaluator (and the KG optimizers) from the current GP, so that
+  callers do not have to guess how many points are enough.  Every KG evaluation starts (or, with
+  KnowledgeGradientInnerMode::kDiscrete, ends) its inner optimization on ``num_union + num_pts`` points, so a set
+  that only covers the regions where the future posterior mean can plausibly be minimal cuts that work directly.
+
+  Candidates are the training points, ``num_candidates`` uniform points, ``num_optima`` approximate global minima of
+  posterior sample paths, and ``num_neighbors`` points near the incumbent.  With the marginal posterior ``N(mu, sigma^2)``
+  at each, and ``mu*`` the lowest candidate mean, a candidate is kept if ``P(f < mu*) >= exclusion_probability``, i.e.,
+  ``(mu - mu*)/sigma <= z`` with ``z = -\Phi^{-1}(exclusion_probability)``.  Kept candidates are taken in increasing
+  ``(mu - mu*)/sigma`` (most likely to beat ``mu*`` first, so the minimum of the mean always comes first), skipping
+  near-duplicates of points already taken, until ``max_num_pts`` are taken; candidates that fail the test are only
+  taken to reach ``min_num_pts``.  So the size follows from the accuracy target: a confident GP gets a few points around
+  its minimum, an uncertain one up to ``max_num_pts`` spread over the domain.
+
+  Points are evaluated at the top fidelity (the last ``num_fidelity`` coordinates set to 1.0, as
+  KnowledgeGradientEvaluator does) and returned without the fidelity coordinates.  Sample-path optima are skipped for
+  sparse (FITC) and grid (Kronecker) GPs.
+
+  \param
+    :gaussian_process: the GP that KG will be computed for
+    :num_fidelity: number of fidelity coordinates (the last ones) of a point
+    :domain: the domain to cover; the full ``dim``-dimensional domain, fidelity coordinates included
+    :parameters: candidate counts and accuracy target
+    :max_num_threads: maximum number of threads for the sample paths and the predictions, >= 1
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :discrete_pts[dim-num_fidelity][num_pts]: the discretization (resized to fit)
+  \return
+    ``num_pts``, the number of points in ``discrete_pts``
+  \raise
+    BoundsException if ``exclusion_probability`` is not in ``(0, 0.5)``; LowerBoundException if ``min_num_pts < 1`` or
+    ``max_num_pts < min_num_pts``
+\endrst*/
+int BuildKnowledgeGradientDiscretization(const GaussianProcess& gaussian_process, int num_fidelity,
+                                         const TensorProductDomain& domain,
+                                         const KnowledgeGradientDiscretizationParameters& parameters,
+                                         int max_num_threads, UniformRandomGenerator * uniform_generator,
+                                         std::vector<double> * discrete_pts) OL_NONNULL_POINTERS;
+
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_HEURISTIC_EXPECTED_IMPROVEMENT_OPTIMIZATION_HPP_
\ No newline at end of file
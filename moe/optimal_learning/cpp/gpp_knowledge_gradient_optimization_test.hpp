@@ -36,9 +36,99 @@ namespace optimal_learning {
 \endrst*/
 OL_WARN_UNUSED_RESULT int PingKGGeneralTest();
 
+/*!\rst
+  Checks that the gradients (spatial) of the analytic 1,0-KG and of the posterior mean are computed correctly.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int PingAnalyticKGTest();
 
 /*!\rst
-  Checks that the gradients (spatial) of Knowledge Gradient are computed correctly.
+  Checks that spreading the KG monte carlo iterations across threads gives exactly the single-threaded KG and grad KG.
+
+  \return
+    number of test failures: 0 if multithreaded and single-threaded KG MC loops agree
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultithreadedKGMonteCarloTest();
+
+/*!\rst
+  Checks that the discrete KG inner modes find the exact optimum over the discretized set and that polishing the
+  discrete winner reproduces the gradient-descent inner mode.
+
+  \return
+    number of test failures: 0 if the discrete KG inner modes are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int DiscreteKGInnerModeTest();
+
+/*!\rst
+  Checks that KnowledgeGradientState carries the inner optima over between evaluations and that these warm starts never
+  worsen an MC iteration's inner optimum.
+
+  \return
+    number of test failures: 0 if KG warm starts are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int KGWarmStartTest();
+
+/*!\rst
+  Checks that SetupKnowledgeGradientState() and SetupExpectedImprovementState() reuse compatible states (keeping their
+  buffers, evaluating like fresh states) and rebuild incompatible ones.
+
+  \return
+    number of test failures: 0 if state reuse is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int StateReuseTest();
+
+/*!\rst
+  Checks that spreading the MCMC hyperparameter samples of KnowledgeGradientMCMCEvaluator and
+  ExpectedImprovementMCMCEvaluator across threads gives exactly the single-threaded values and gradients.
+
+  \return
+    number of test failures: 0 if multithreaded and single-threaded MCMC reductions agree
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultithreadedMCMCSamplesTest();
+
+/*!\rst
+  Checks the fused screening kernel OnePotentialSampleExpectedImprovementMCMCEvaluator::ComputeExpectedImprovementOfPoints():
+  it matches ComputeExpectedImprovement() with per-point states, gives the same values on 1 and several threads, and
+  EvaluateEIMCMCAtPointList() picks the best of those values.
+
+  \return
+    number of test failures: 0 if the fused kernel agrees with the per-state evaluator
+\endrst*/
+OL_WARN_UNUSED_RESULT int FusedExpectedImprovementMCMCOfPointsTest();
+
+/*!\rst
+  Checks that GaussianProcessMCMC::SetHyperparameters() and GaussianProcessMCMC::AddPointsToGP() reproduce a
+  GaussianProcessMCMC built from scratch, with every sample still sharing one copy of the training data.
+
+  \return
+    number of test failures: 0 if in-place MCMC updates are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessMCMCUpdateTest();
+
+/*!\rst
+  Checks that BuildKnowledgeGradientDiscretization() returns a small set in the domain that keeps the minimum of the
+  posterior mean, and that its size follows the accuracy target.
+
+  \return
+    number of test failures: 0 if the automatic discretization is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int KnowledgeGradientDiscretizationTest();
+
+/*!\rst
+  Checks that the screened, multistart posterior mean optimizers (single GP and MCMC-averaged) find a point at least as
+  good as every training point and the single-start optimizer, and that the averaged evaluator matches its members.
+
+  \return
+    number of test failures: 0 if multistart posterior mean optimization is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int PosteriorMeanMultistartOptimizationTest();
+
+/*!\rst
+  Runs the KG unit tests: analytic 1,0-KG and posterior mean pings, MC-KG threading/blocking/warm start checks,
+  MCMC-averaged KG and EI, and KG discretization and posterior mean optimization.  The MC-KG pings in
+  PingKGGeneralTest() are not included; they do not converge at the ping tolerances.
 
   \return
     number of test failures: 0 if all is working well.
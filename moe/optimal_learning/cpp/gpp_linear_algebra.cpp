@@ -6,13 +6,24 @@
 
   Linear algebra functions currently do not call libraries like the BLAS/LAPACK because for [currently] small problem
   sizes, overhead kills their performance advantage.  Additionally, for the custom implementations on our specific use
-  cases we also gain some performance through more restrictive assumptions on data ordering and no need (due to small
-  problem size) for advanced and complex optimizations like blocking.
+  cases we also gain some performance through more restrictive assumptions on data ordering.
+
+  Small problems run through simple unblocked loops.  Once matrices outgrow the cache (e.g., ``K`` with
+  ``num_sampled*(num_derivatives+1)`` in the thousands), ComputeCholeskyFactorL(), TriangularMatrixMatrixSolve(), and
+  GeneralMatrixMatrixMultiply() switch to blocked algorithms.  These spend nearly all of their time in a single
+  packed, register-tiled matrix-matrix multiply kernel (in the style of GotoBLAS/BLIS): operands are copied into
+  contiguous panels sized for cache and the innermost kernel accumulates a small tile of ``C`` in registers.
 
   However, if/when BLAS is needed, current linear algebra functions are designed to easily map into BLAS calls so they
-  can serve as wrappers later.  This also makes it easy to handle BLAS from different vendors and on different computing
+  can serve as wrappers.  This also makes it easy to handle BLAS from different vendors and on different computing
   environments (e.g., GPUs, Xeon Phi).
 
+  Building with ``-D MOE_USE_BLAS=1`` (defines ``OL_BLAS_ENABLED``) does exactly that for the functions that dominate
+  GP fitting and KG: ComputeCholeskyFactorL() (``dpotrf``), TriangularMatrixMatrixSolve() (``dtrsm``),
+  GeneralMatrixMatrixMultiply() (``dgemm``), SymmetricMatrixVectorMultiply() (``dsymv``), and SPDMatrixInverse()
+  (``dpotri``).  We call the Fortran-77 interface (LP64) directly since every vendor (reference BLAS/LAPACK, OpenBLAS,
+  MKL, BLIS + libFLAME) exports it.  The hand-written kernels remain the default.
+
   See gpp_linear_algebra.hpp file docs and (primarily) gpp_common.hpp for a few important implementation notes
   (e.g., restrict, memory allocation, matrix storage style, etc).  Note the matrix looping idiom (gpp_common.hpp,
   item 8) in particular; in summary, we use::
@@ -29,13 +40,43 @@
 #include "gpp_linear_algebra.hpp"
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "gpp_common.hpp"
 #include "gpp_logging.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_task_scheduler.hpp"
+
+#ifdef OL_BLAS_ENABLED
+// Fortran-77 BLAS/LAPACK entry points. All arguments are passed by reference; the trailing size_t arguments are the
+// hidden lengths of the CHARACTER arguments (always 1 here) that gfortran-compiled libraries expect. Libraries that
+// do not read them (e.g., MKL) ignore the extra arguments.
+extern "C" {
+void dpotrf_(char const * uplo, int const * n, double * A, int const * lda, int * info, size_t uplo_len);
+void dpotri_(char const * uplo, int const * n, double * A, int const * lda, int * info, size_t uplo_len);
+void dtrsm_(char const * side, char const * uplo, char const * transa, char const * diag, int const * m, int const * n,
+            double const * alpha, double const * A, int const * lda, double * B, int const * ldb,
+            size_t side_len, size_t uplo_len, size_t transa_len, size_t diag_len);
+void dtrmm_(char const * side, char const * uplo, char const * transa, char const * diag, int const * m, int const * n,
+            double const * alpha, double const * A, int const * lda, double * B, int const * ldb,
+            size_t side_len, size_t uplo_len, size_t transa_len, size_t diag_len);
+void strmm_(char const * side, char const * uplo, char const * transa, char const * diag, int const * m, int const * n,
+            float const * alpha, float const * A, int const * lda, float * B, int const * ldb,
+            size_t side_len, size_t uplo_len, size_t transa_len, size_t diag_len);
+void dgemm_(char const * transa, char const * transb, int const * m, int const * n, int const * k,
+            double const * alpha, double const * A, int const * lda, double const * B, int const * ldb,
+            double const * beta, double * C, int const * ldc, size_t transa_len, size_t transb_len);
+void dsymv_(char const * uplo, int const * n, double const * alpha, double const * A, int const * lda,
+            double const * x, int const * incx, double const * beta, double * y, int const * incy, size_t uplo_len);
+}  // end extern "C"
+#endif
 
 namespace optimal_learning {
 
@@ -89,33 +130,245 @@ void ZeroUpperTriangle(int size, double * restrict matrix) noexcept {
   }
 }
 
+namespace {  // blocked kernels shared by Cholesky, triangular solve, and matrix-matrix multiply
+
+//! block size for blocked cholesky & triangular solves; matrices smaller than twice this use the unblocked loops
+constexpr int kTriangularBlockSize = 64;
+//! rows of the register tile computed by GeneralMatrixMatrixMultiplyMicroKernel()
+constexpr int kGemmTileM = 8;
+//! columns of the register tile computed by GeneralMatrixMatrixMultiplyMicroKernel()
+constexpr int kGemmTileN = 4;
+//! rows of ``op(A)`` packed at a time (multiple of kGemmTileM); packed ``A`` panel targets L2
+constexpr int kGemmBlockM = 128;
+//! inner dimension packed at a time
+constexpr int kGemmBlockK = 256;
+//! columns of ``op(B)`` packed at a time (multiple of kGemmTileN); packed ``B`` panel targets L3
+constexpr int kGemmBlockN = 512;
+//! GEMMs with fewer multiply-adds than this skip packing and use the gemv-based loop
+constexpr int kGemmBlockedThreshold = 48*48*48;
+//! blocked cholesky of matrices at least this large runs its triangular solves and trailing updates in parallel
+constexpr int kParallelCholeskySize = 512;
+//! rows of ``L_21`` per task in the parallel triangular solve of blocked cholesky
+constexpr int kParallelSolveRows = 256;
+
 /*!\rst
-  Cholesky factorization, ``A = L * L^T`` (see Smith 1995 or Golub, Van Loan 1983, etc.)
-  This implementation uses the outer-product formulation.  The outer-product version is
-  2x slower than gaxpy or dot product style implementations; this is to remain consistent with
-  Smith 1995's formulation of the gradient of cholesky.
+  Computes ``C += alpha * Ap * Bp`` for one ``kGemmTileM x kGemmTileN`` tile of ``C``.
+  ``Ap`` and ``Bp`` are packed panels (see PackMatrixPanel()) so every load in the inner loop is unit-stride and the
+  ``kGemmTileM * kGemmTileN`` accumulators stay in registers.  Only the leading ``m_edge x n_edge`` block of the tile
+  is written back (packed panels are zero-padded at the edges).
+
+  \param
+    :size_k: inner dimension
+    :a_panel[kGemmTileM][size_k]: packed tile-row of ``op(A)``
+    :b_panel[kGemmTileN][size_k]: packed tile-column of ``op(B)``
+    :alpha: scale factor on ``Ap * Bp``
+    :m_edge: number of valid rows in this tile (``<= kGemmTileM``)
+    :n_edge: number of valid columns in this tile (``<= kGemmTileN``)
+    :C[m_edge][n_edge]: tile of ``C`` to update (on entry)
+    :ldc: leading dimension of ``C``
+  \output
+    :C[m_edge][n_edge]: updated tile (on exit)
+\endrst*/
+OL_NONNULL_POINTERS void GeneralMatrixMatrixMultiplyMicroKernel(int size_k, double const * restrict a_panel,
+                                                                double const * restrict b_panel, double alpha,
+                                                                int m_edge, int n_edge, double * restrict C,
+                                                                int ldc) noexcept {
+  double accumulator[kGemmTileN][kGemmTileM] = {};
+  for (int p = 0; p < size_k; ++p) {
+    for (int j = 0; j < kGemmTileN; ++j) {
+      const double b_pj = b_panel[j];
+      for (int i = 0; i < kGemmTileM; ++i) {
+        accumulator[j][i] += a_panel[i]*b_pj;
+      }
+    }
+    a_panel += kGemmTileM;
+    b_panel += kGemmTileN;
+  }
 
-  This implemention is not optimized nor does it pivot when symmetric, indefinite matrices
-  or poorly conditioned SPD matrices are detected.
+  for (int j = 0; j < n_edge; ++j) {
+    for (int i = 0; i < m_edge; ++i) {
+      C[i] += alpha*accumulator[j][i];
+    }
+    C += ldc;
+  }
+}
 
-  Instead, non-SPD matrices trigger an error printed to stdout.
+/*!\rst
+  Copies the ``num_rows x num_cols`` block of ``op(A)`` starting at ``A`` into tile-major panels of height ``tile``:
+  ``packed[r/tile][c][r%tile] = op(A)_{r,c}``.  Rows past ``num_rows`` in the final panel are zero-filled.
+
+  Packing ``op(B)`` for GeneralMatrixMatrixMultiplyMicroKernel() uses this same routine on ``op(B)^T``.
+
+  \param
+    :A[lda][*]: matrix to pack from, offset to the first entry of the block
+    :trans: 'N' to pack ``A``'s block, 'T' to pack ``A^T``'s block
+    :num_rows: rows of ``op(A)`` to pack
+    :num_cols: columns of ``op(A)`` to pack
+    :lda: leading dimension of ``A``
+    :tile: panel height
+  \output
+    :packed[tile*ceil(num_rows/tile)][num_cols]: packed panels
+\endrst*/
+OL_NONNULL_POINTERS void PackMatrixPanel(double const * restrict A, char trans, int num_rows, int num_cols, int lda,
+                                         int tile, double * restrict packed) noexcept {
+  for (int r0 = 0; r0 < num_rows; r0 += tile) {
+    const int height = std::min(tile, num_rows - r0);
+    for (int c = 0; c < num_cols; ++c) {
+      if (trans == 'N') {
+        double const * restrict A_col = A + c*lda + r0;
+        for (int r = 0; r < height; ++r) {
+          packed[r] = A_col[r];
+        }
+      } else {
+        double const * restrict A_row = A + r0*lda + c;
+        for (int r = 0; r < height; ++r) {
+          packed[r] = A_row[r*lda];
+        }
+      }
+      std::fill(packed + height, packed + tile, 0.0);
+      packed += tile;
+    }
+  }
+}
 
-  Should be the same as BLAS call:
-  ``dpotrf('L', size_m, A, size_m, &info);``
-  Implementation is similar to ``dpotf2``, the unblocked version (same arg list as ``dpotrf``).
+/*!\rst
+  Blocked matrix-matrix product ``C += alpha * op(A) * op(B)``.  All matrices are column-major with explicit
+  leading dimensions so that this can operate on sub-blocks (e.g., the trailing matrix in blocked cholesky).
+
+  Loop order follows GotoBLAS: for each ``kGemmBlockK x kGemmBlockN`` block of ``op(B)`` (packed once), sweep
+  ``kGemmBlockM x kGemmBlockK`` blocks of ``op(A)`` (packed once), and apply the micro-kernel over the resulting tiles.
+  ``C`` must not overlap ``A`` or ``B``.
+
+  \param
+    :transA: 'N' for ``op(A) = A``, 'T' for ``op(A) = A^T``
+    :transB: 'N' for ``op(B) = B``, 'T' for ``op(B) = B^T``
+    :size_m: rows of ``op(A), C``
+    :size_n: cols of ``op(B), C``
+    :size_k: cols of ``op(A)``, rows of ``op(B)``
+    :alpha: scale factor on ``op(A) * op(B)``
+    :A, lda: left multiplicand and its leading dimension
+    :B, ldb: right multiplicand and its leading dimension
+    :C[size_m][size_n]: matrix to update (on entry)
+    :ldc: leading dimension of ``C``
+  \output
+    :C[size_m][size_n]: ``C + alpha * op(A) * op(B)`` (on exit)
 \endrst*/
-// TODO(GH-172): change this to be gaxpy or (block) dot-prod style
-// to improve performance & numerical characteristics.
-int ComputeCholeskyFactorL(int size_m, double * restrict chol) noexcept {
+OL_NONNULL_POINTERS void GeneralMatrixMatrixMultiplyBlocked(char transA, char transB, int size_m, int size_n,
+                                                            int size_k, double alpha, double const * restrict A,
+                                                            int lda, double const * restrict B, int ldb,
+                                                            double * restrict C, int ldc) noexcept {
+  if (unlikely(size_m <= 0 || size_n <= 0 || size_k <= 0)) {
+    return;
+  }
+  const int max_block_m = std::min(kGemmBlockM, size_m);
+  const int max_block_n = std::min(kGemmBlockN, size_n);
+  const int max_block_k = std::min(kGemmBlockK, size_k);
+  std::vector<double> packed_A(((max_block_m + kGemmTileM - 1)/kGemmTileM)*kGemmTileM*max_block_k);
+  std::vector<double> packed_B(((max_block_n + kGemmTileN - 1)/kGemmTileN)*kGemmTileN*max_block_k);
+  // op(B)^T = op'(B) where op' flips the transpose flag; packing op(B)^T by rows gives op(B) by columns
+  const char transB_flipped = (transB == 'N') ? 'T' : 'N';
+
+  for (int jb = 0; jb < size_n; jb += kGemmBlockN) {
+    const int block_n = std::min(kGemmBlockN, size_n - jb);
+    for (int pb = 0; pb < size_k; pb += kGemmBlockK) {
+      const int block_k = std::min(kGemmBlockK, size_k - pb);
+      double const * restrict B_block = (transB == 'N') ? B + jb*ldb + pb : B + pb*ldb + jb;
+      PackMatrixPanel(B_block, transB_flipped, block_n, block_k, ldb, kGemmTileN, packed_B.data());
+
+      for (int ib = 0; ib < size_m; ib += kGemmBlockM) {
+        const int block_m = std::min(kGemmBlockM, size_m - ib);
+        double const * restrict A_block = (transA == 'N') ? A + pb*lda + ib : A + ib*lda + pb;
+        PackMatrixPanel(A_block, transA, block_m, block_k, lda, kGemmTileM, packed_A.data());
+
+        for (int jr = 0; jr < block_n; jr += kGemmTileN) {
+          for (int ir = 0; ir < block_m; ir += kGemmTileM) {
+            GeneralMatrixMatrixMultiplyMicroKernel(block_k, packed_A.data() + ir*block_k,
+                                                   packed_B.data() + jr*block_k, alpha,
+                                                   std::min(kGemmTileM, block_m - ir),
+                                                   std::min(kGemmTileN, block_n - jr),
+                                                   C + (jb + jr)*ldc + ib + ir, ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+//! pivots at or below this are rejected as non-positive
+constexpr double kMinimumCholeskyPivot = 1.0e-16;
+//! each jitter escalation multiplies the jitter by this
+constexpr double kCholeskyJitterGrowth = 10.0;
+
+/*!\rst
+  Jitter escalation state of one factorization (see ComputeCholeskyFactorLWithJitter()), in absolute terms.
+\endrst*/
+struct CholeskyJitterState {
+  //! first jitter tried
+  double initial_jitter;
+  //! largest jitter allowed
+  double max_jitter;
+  //! jitter currently added to every pivot; 0 until the first failed pivot
+  double jitter;
+  //! number of pivots that received jitter
+  int num_jittered_pivots;
+};
+
+/*!\rst
+  Raises ``jitter_state->jitter`` (starting from ``initial_jitter``, then by factors of kCholeskyJitterGrowth) until
+  ``pivot + jitter`` is an acceptable pivot.
+
+  \return
+    true if such a jitter ``<= max_jitter`` exists (and ``jitter_state->jitter`` now holds it)
+\endrst*/
+OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT bool EscalateCholeskyJitter(double pivot,
+                                                                      CholeskyJitterState * jitter_state) noexcept {
+  double candidate = jitter_state->jitter == 0.0 ? jitter_state->initial_jitter :
+      kCholeskyJitterGrowth*jitter_state->jitter;
+  if (!(candidate > 0.0)) {
+    return false;
+  }
+  while (candidate <= jitter_state->max_jitter && !(pivot + candidate > kMinimumCholeskyPivot)) {
+    candidate *= kCholeskyJitterGrowth;
+  }
+  if (!(candidate <= jitter_state->max_jitter)) {
+    return false;
+  }
+  jitter_state->jitter = candidate;
+  return true;
+}
+
+/*!\rst
+  Unblocked (outer-product) cholesky factorization of the ``size_m x size_m`` matrix at ``chol`` with leading
+  dimension ``lda``.  See ComputeCholeskyFactorL() for details; this is that function's kernel on diagonal blocks.
+
+  Every pivot passes through here, so this is also where jitter is applied: with a non-null ``jitter_state``, a failed
+  pivot escalates the jitter in place (see EscalateCholeskyJitter()) and every pivot from then on receives the current
+  jitter.  Adding ``E_kk`` to pivot ``k`` when it is reached is the same as adding it to ``A_kk`` up front (diagonal
+  shifts commute with the outer-product updates), so the factorization just continues; nothing is redone.
+
+  \return
+    0 on success, else ``k+1`` where ``k`` is the (local) index of the first non-positive pivot
+\endrst*/
+OL_NONNULL_POINTERS_LIST(3) OL_WARN_UNUSED_RESULT int ComputeCholeskyFactorLUnblocked(
+    int size_m, int lda, double * restrict chol, CholeskyJitterState * jitter_state) noexcept {
   double * restrict chol_temp = chol;
   // Apply outer-product-based Cholesky algorithm: 1/3*N^3 + O(N^2)
-  // Here, L_{ij} = chol[j*size_m + i] is the input matrix (on input) and the cholesky factor of that matrix (on exit).
+  // Here, L_{ij} = chol[j*lda + i] is the input matrix (on input) and the cholesky factor of that matrix (on exit).
   // Define a macro specifying the data layout assumption on L_{ij}. The macro simplifies complex indexing
   // so that OL_CHOL(i, j) reads just like L_{ij}.
-#define OL_CHOL(i, j) chol[((j)*size_m + (i))]
+#define OL_CHOL(i, j) chol[((j)*lda + (i))]
   double A_kk;
+  double pivot_jitter = jitter_state == nullptr ? 0.0 : jitter_state->jitter;
   for (int k = 0; k < size_m; ++k) {
-    if (likely(chol_temp[k] > 1.0e-16)) {
+    if (unlikely(!(chol_temp[k] + pivot_jitter > kMinimumCholeskyPivot)) && jitter_state != nullptr &&
+        EscalateCholeskyJitter(chol_temp[k], jitter_state)) {
+      pivot_jitter = jitter_state->jitter;
+    }
+    if (likely(chol_temp[k] + pivot_jitter > kMinimumCholeskyPivot)) {
+      if (unlikely(pivot_jitter != 0.0)) {
+        chol_temp[k] += pivot_jitter;
+        ++jitter_state->num_jittered_pivots;
+      }
       // L_{kk} = \sqrt(A_{kk})
       A_kk = std::sqrt(chol_temp[k]);
       chol_temp[k] = A_kk;
@@ -133,7 +386,6 @@ int ComputeCholeskyFactorL(int size_m, double * restrict chol) noexcept {
           OL_CHOL(i, j) = OL_CHOL(i, j) - OL_CHOL(i, k) * OL_CHOL(j, k);
         }
       }
-#undef OL_CHOL
     } else {
       // We fail if the matrix is singular. In the outer-product formulation here,
       // you can ignore the "0" diagonal entry and continue, which produces a
@@ -141,12 +393,321 @@ int ComputeCholeskyFactorL(int size_m, double * restrict chol) noexcept {
       OL_ERROR_PRINTF("cholesky matrix singular %.18E ", chol_temp[k]);
       return k + 1;
     }
-    chol_temp += size_m;
+    chol_temp += lda;
   }
+#undef OL_CHOL
 
   return 0;
 }
 
+/*!\rst
+  Right-looking cholesky factorization of the ``size_m x size_m`` matrix at ``chol`` (leading dimension ``lda``) that
+  steps ``block_size`` pivots at a time::
+
+    [ A_11      ]    L_11 = chol(A_11)               (unblocked, block_size x block_size)
+    [ A_21 A_22 ]    L_21 = A_21 * L_11^-T
+                     A_22 = A_22 - L_21 * L_21^T     (one rank-block_size update, lower triangle only)
+
+  Each pass over the trailing matrix applies ``block_size`` rank-1 updates instead of one, so it is read and written
+  ``size_m/block_size`` times rather than ``size_m`` times; the ``block_size`` columns of ``L_21`` stay in cache
+  throughout.  ``block_size == 1`` is ComputeCholeskyFactorLUnblocked().  If ``block_size`` does not divide ``size_m``,
+  the last block is smaller.
+
+  \return
+    0 on success, else ``k+1`` where ``k`` is the (local) index of the first non-positive pivot
+\endrst*/
+OL_NONNULL_POINTERS_LIST(4) OL_WARN_UNUSED_RESULT int ComputeCholeskyFactorLPointBlocked(
+    int size_m, int lda, int block_size, double * restrict chol, CholeskyJitterState * jitter_state) noexcept {
+  if (block_size <= 1) {
+    return ComputeCholeskyFactorLUnblocked(size_m, lda, chol, jitter_state);
+  }
+
+  for (int kb = 0; kb < size_m; kb += block_size) {
+    const int block = std::min(block_size, size_m - kb);
+    const int num_trailing = size_m - kb - block;
+    double * restrict diagonal_block = chol + kb*lda + kb;
+
+    // L_11 = chol(A_11)
+    const int leading_minor_index = ComputeCholeskyFactorLUnblocked(block, lda, diagonal_block, jitter_state);
+    if (unlikely(leading_minor_index != 0)) {
+      return kb + leading_minor_index;
+    }
+    if (num_trailing == 0) {
+      break;
+    }
+
+    // L_21 = A_21 * L_11^-T
+    double * restrict panel = diagonal_block + block;
+    for (int j = 0; j < block; ++j) {
+      double * restrict panel_j = panel + j*lda;
+      const double L_jj = diagonal_block[j*lda + j];
+      for (int i = 0; i < num_trailing; ++i) {
+        panel_j[i] /= L_jj;
+      }
+      for (int l = j+1; l < block; ++l) {
+        const double L_lj = diagonal_block[j*lda + l];
+        double * restrict panel_l = panel + l*lda;
+        for (int i = 0; i < num_trailing; ++i) {
+          panel_l[i] -= L_lj*panel_j[i];
+        }
+      }
+    }
+
+    // A_22 = A_22 - L_21 * L_21^T, column by column: column j of A_22 receives all block rank-1 updates while hot,
+    // four at a time so that each entry is loaded and stored once per four updates
+    double * restrict trailing_matrix = panel + block*lda;
+    for (int j = 0; j < num_trailing; ++j) {
+      double * restrict trailing_matrix_j = trailing_matrix + j*lda;
+      int l = 0;
+      for (; l + 4 <= block; l += 4) {
+        double const * restrict panel_0 = panel + l*lda;
+        double const * restrict panel_1 = panel_0 + lda;
+        double const * restrict panel_2 = panel_1 + lda;
+        double const * restrict panel_3 = panel_2 + lda;
+        const double L_j0 = panel_0[j];
+        const double L_j1 = panel_1[j];
+        const double L_j2 = panel_2[j];
+        const double L_j3 = panel_3[j];
+        for (int i = j; i < num_trailing; ++i) {
+          trailing_matrix_j[i] -= panel_0[i]*L_j0 + panel_1[i]*L_j1 + panel_2[i]*L_j2 + panel_3[i]*L_j3;
+        }
+      }
+      for (; l < block; ++l) {
+        double const * restrict panel_l = panel + l*lda;
+        const double L_jl = panel_l[j];
+        for (int i = j; i < num_trailing; ++i) {
+          trailing_matrix_j[i] -= panel_l[i]*L_jl;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*!\rst
+  Right-looking blocked cholesky factorization (similar to ``dpotrf``) of the ``size_m x size_m`` matrix ``chol``
+  with ``panel_width``-wide block columns; see ComputeCholeskyFactorL().  Diagonal blocks are factored by
+  ComputeCholeskyFactorLPointBlocked() in steps of ``point_block_size``, so ``panel_width`` should be a multiple of
+  ``point_block_size``.
+
+  Matrices of size at least kParallelCholeskySize run the two ``O(n^2 * panel_width)`` steps of each block column as
+  ParallelForEachIndex() loops with NumThreadsForInnerLoops() threads: the triangular solve over chunks of
+  kParallelSolveRows rows of ``L_21``, and the trailing update over the ``panel_width``-wide block columns of ``A_22``.
+  Each task writes disjoint entries with the same operations in the same order as the serial loops, so the factor
+  does not depend on the number of threads.  The diagonal blocks (and so all pivots and jitter) stay serial.
+
+  \return
+    0 on success, else the (1-based) index of the first non-positive pivot
+\endrst*/
+OL_NONNULL_POINTERS_LIST(4) OL_WARN_UNUSED_RESULT int ComputeCholeskyFactorLBlocked(
+    int size_m, int panel_width, int point_block_size, double * restrict chol,
+    CholeskyJitterState * jitter_state) noexcept {
+  const int max_num_threads = size_m >= kParallelCholeskySize ? NumThreadsForInnerLoops() : 1;
+  auto for_each_index = [max_num_threads](int num_iterations, const std::function<void(int)>& body) {
+    if (max_num_threads > 1) {
+      ParallelForEachIndex(max_num_threads, num_iterations, body);
+    } else {
+      for (int i = 0; i < num_iterations; ++i) {
+        body(i);
+      }
+    }
+  };
+
+  for (int kb = 0; kb < size_m; kb += panel_width) {
+    const int block = std::min(panel_width, size_m - kb);
+    const int num_trailing = size_m - kb - block;
+    double * restrict diagonal_block = chol + kb*size_m + kb;
+
+    // L_11 = chol(A_11)
+    const int leading_minor_index = ComputeCholeskyFactorLPointBlocked(block, size_m, point_block_size,
+                                                                       diagonal_block, jitter_state);
+    if (unlikely(leading_minor_index != 0)) {
+      return kb + leading_minor_index;
+    }
+    if (num_trailing == 0) {
+      break;
+    }
+
+    // L_21 = A_21 * L_11^-T, column by column so that all accesses are unit-stride; rows are independent
+    double * restrict panel = diagonal_block + block;
+    const int num_row_chunks = (num_trailing + kParallelSolveRows - 1)/kParallelSolveRows;
+    for_each_index(num_row_chunks, [&](int chunk) {
+        const int first_row = chunk*kParallelSolveRows;
+        const int num_rows = std::min(kParallelSolveRows, num_trailing - first_row);
+        double * restrict panel_rows = panel + first_row;
+        for (int j = 0; j < block; ++j) {
+          double * restrict panel_j = panel_rows + j*size_m;
+          const double L_jj = diagonal_block[j*size_m + j];
+          for (int i = 0; i < num_rows; ++i) {
+            panel_j[i] /= L_jj;
+          }
+          for (int l = j+1; l < block; ++l) {
+            const double L_lj = diagonal_block[j*size_m + l];
+            double * restrict panel_l = panel_rows + l*size_m;
+            for (int i = 0; i < num_rows; ++i) {
+              panel_l[i] -= L_lj*panel_j[i];
+            }
+          }
+        }
+      });
+
+    // A_22 = A_22 - L_21 * L_21^T, one block column at a time; only the lower triangle of A_22 is updated
+    double * restrict trailing_matrix = panel + block*size_m;
+    const int num_block_columns = (num_trailing + panel_width - 1)/panel_width;
+    for_each_index(num_block_columns, [&](int block_column) {
+        const int jb = block_column*panel_width;
+        const int width = std::min(panel_width, num_trailing - jb);
+        // diagonal tile: compute in full then subtract its lower triangle
+        std::vector<double> diagonal_update(Square(width), 0.0);
+        GeneralMatrixMatrixMultiplyBlocked('N', 'T', width, width, block, 1.0, panel + jb, size_m, panel + jb,
+                                           size_m, diagonal_update.data(), width);
+        for (int j = 0; j < width; ++j) {
+          double * restrict trailing_matrix_j = trailing_matrix + (jb + j)*size_m + jb;
+          for (int i = j; i < width; ++i) {
+            trailing_matrix_j[i] -= diagonal_update[j*width + i];
+          }
+        }
+        // tiles below the diagonal
+        if (jb + width < num_trailing) {
+          GeneralMatrixMatrixMultiplyBlocked('N', 'T', num_trailing - jb - width, width, block, -1.0,
+                                             panel + jb + width, size_m, panel + jb, size_m,
+                                             trailing_matrix + jb*size_m + jb + width, size_m);
+        }
+      });
+  }
+
+  return 0;
+}
+
+/*!\rst
+  Body of ComputeBlockCholeskyFactorL() and ComputeCholeskyFactorLWithJitter(); ``jitter_state`` may be nullptr (no
+  jitter), and is passed down to ComputeCholeskyFactorLUnblocked(), which sees every pivot.
+\endrst*/
+OL_NONNULL_POINTERS_LIST(3) OL_WARN_UNUSED_RESULT int ComputeBlockCholeskyFactorLImpl(
+    int size_m, int point_block_size, double * restrict chol, CholeskyJitterState * jitter_state) noexcept {
+  OL_PROFILE_SCOPE(ProfilePhase::kCholeskyFactorization);
+#ifdef OL_BLAS_ENABLED
+  // dpotrf cannot resume after a failed pivot, so jittered factorizations always use the native kernels
+  if (jitter_state == nullptr) {
+    // LAPACK requires leading dimensions >= 1, even for empty matrices
+    const int lda_blas = std::max(1, size_m);
+    int info = 0;
+    dpotrf_("L", &size_m, chol, &lda_blas, &info, 1);
+    if (unlikely(info > 0)) {
+      OL_ERROR_PRINTF("cholesky matrix singular %.18E ", chol[(info-1)*size_m + (info-1)]);
+    }
+    return info;
+  }
+#endif
+
+  point_block_size = std::max(1, point_block_size);
+  if (size_m < 2*kTriangularBlockSize) {
+    return ComputeCholeskyFactorLPointBlocked(size_m, size_m, point_block_size, chol, jitter_state);
+  }
+
+  // whole points per panel; a point block wider than kTriangularBlockSize is its own panel
+  const int panel_width = std::max(1, kTriangularBlockSize/point_block_size)*point_block_size;
+  return ComputeCholeskyFactorLBlocked(size_m, panel_width, point_block_size, chol, jitter_state);
+}
+
+}  // end unnamed namespace
+
+/*!\rst
+  Cholesky factorization, ``A = L * L^T`` (see Smith 1995 or Golub, Van Loan 1983, etc.)
+
+  Small matrices use the unblocked outer-product formulation (ComputeCholeskyFactorLUnblocked(), similar to
+  ``dpotf2``).  Larger matrices use the right-looking blocked algorithm (similar to ``dpotrf``); for each
+  ``kTriangularBlockSize``-wide block column::
+
+    [ A_11      ]    L_11 = chol(A_11)               (unblocked)
+    [ A_21 A_22 ]    L_21 = A_21 * L_11^-T           (triangular solve)
+                     A_22 = A_22 - L_21 * L_21^T     (GEMM; lower triangle only)
+
+  so that ``O(n^3)`` of the work happens in GeneralMatrixMatrixMultiplyBlocked(), in parallel over the block columns
+  of ``A_22`` for large matrices (see ComputeCholeskyFactorLBlocked()).  The factor ``L`` is the same
+  (up to roundoff) either way; the gradient of cholesky (Smith 1995) used elsewhere only depends on ``L``, not on
+  the loop ordering used to compute it.
+
+  This implemention does not pivot when symmetric, indefinite matrices or poorly conditioned SPD matrices are detected.
+
+  Instead, non-SPD matrices trigger an error printed to stdout.
+
+  Should be the same as BLAS call:
+  ``dpotrf('L', size_m, A, size_m, &info);``
+  and is exactly that call when ``OL_BLAS_ENABLED``.  (``dpotrf`` only rejects pivots ``<= 0``, whereas the native
+  kernels also reject pivots ``<= 1.0e-16``.)
+\endrst*/
+int ComputeCholeskyFactorL(int size_m, double * restrict chol) noexcept {
+  return ComputeBlockCholeskyFactorL(size_m, 1, chol);
+}
+
+/*!\rst
+  Same algorithms as ComputeCholeskyFactorL(), with ``point_block_size``-aligned steps: the small-matrix kernel is
+  ComputeCholeskyFactorLPointBlocked() (one rank-``point_block_size`` trailing update per point instead of one
+  rank-1 update per row), and the blocked algorithm's panels hold whole points.  ``point_block_size = 1`` is exactly
+  ComputeCholeskyFactorL().
+\endrst*/
+int ComputeBlockCholeskyFactorL(int size_m, int point_block_size, double * restrict chol) noexcept {
+  return ComputeBlockCholeskyFactorLImpl(size_m, point_block_size, chol, nullptr);
+}
+
+/*!\rst
+  Jitter is applied lazily, pivot by pivot, inside the unblocked kernel (see ComputeCholeskyFactorLUnblocked()); the
+  blocked drivers are unchanged since every pivot passes through that kernel before its column is used.
+\endrst*/
+int ComputeCholeskyFactorLWithJitter(int size_m, int point_block_size, double * restrict chol,
+                                     CholeskyJitter * jitter) noexcept {
+  // jitter is relative to the scale of A, its largest diagonal entry
+  double scale = 0.0;
+  for (int i = 0; i < size_m; ++i) {
+    scale = std::max(scale, chol[i*size_m + i]);
+  }
+  if (!(scale > 0.0)) {
+    scale = 1.0;
+  }
+
+  CholeskyJitterState jitter_state = {jitter->initial_relative_jitter*scale, jitter->max_relative_jitter*scale, 0.0, 0};
+  const int leading_minor_index = ComputeBlockCholeskyFactorLImpl(size_m, point_block_size, chol, &jitter_state);
+  jitter->jitter = jitter_state.jitter;
+  jitter->num_jittered_pivots = jitter_state.num_jittered_pivots;
+  return leading_minor_index;
+}
+
+/*!\rst
+  With ``P = \Phi(L^T * \bar{L})``, ``\bar{A} = sym(L^{-T} * P * L^{-1})``: one triangular multiply and two triangular
+  solves, each with ``trans = 'T'`` (the second solve acts on the transpose of the first's result, since ``X * L^{-1}
+  = (L^{-T} * X^T)^T``).  Murray's blocked loop computes the same thing with better locality for large matrices; the
+  matrices here (a ``q``-EI or ``q``-KG variance) are small.
+\endrst*/
+void CholeskyFactorLAdjoint(int size_m, double const * restrict chol, double * restrict adjoint) noexcept {
+  // P = \Phi(L^T * \bar{L})
+  ZeroUpperTriangle(size_m, adjoint);
+  TriangularMatrixMatrixMultiply(chol, 'T', size_m, size_m, size_m, adjoint);
+  ZeroUpperTriangle(size_m, adjoint);
+  for (int i = 0; i < size_m; ++i) {
+    adjoint[i*size_m + i] *= 0.5;
+  }
+
+  // X = L^{-T} * P, then X^T
+  TriangularMatrixMatrixSolve(chol, 'T', size_m, size_m, size_m, adjoint);
+  for (int j = 0; j < size_m; ++j) {
+    for (int i = j + 1; i < size_m; ++i) {
+      std::swap(adjoint[j*size_m + i], adjoint[i*size_m + j]);
+    }
+  }
+
+  // (X * L^{-1})^T = L^{-T} * X^T; symmetrize
+  TriangularMatrixMatrixSolve(chol, 'T', size_m, size_m, size_m, adjoint);
+  for (int j = 0; j < size_m; ++j) {
+    for (int i = j + 1; i < size_m; ++i) {
+      const double symmetric_part = 0.5*(adjoint[j*size_m + i] + adjoint[i*size_m + j]);
+      adjoint[j*size_m + i] = symmetric_part;
+      adjoint[i*size_m + j] = symmetric_part;
+    }
+  }
+}
+
 /*!\rst
   Solve ``A*x = b`` or ``A^T*x = b`` when ``A`` is lower triangular IN-PLACE.
   Uses the standard "backsolve" technique, instead of forming ``A^-1`` which is
@@ -194,16 +755,197 @@ void TriangularMatrixVectorSolve(double const * restrict A, char trans, int size
 
 
 /*!\rst
-  Calls dtrsv on each column of ``X``, solving ``A * X_i = B_i`` (``X_i`` being ``i``-th column of ``X``).
-  Does not use blocking or any other optimization techniques.
+  For small problems, calls dtrsv on each column of ``X``, solving ``A * X_i = B_i`` (``X_i`` being ``i``-th column of ``X``).
+
+  Larger problems are blocked by ``kTriangularBlockSize`` rows.  For ``trans == 'N'``, working forward::
+
+    X_1 = A_11 \ X_1                 (dtrsv on each column)
+    X_2 = X_2 - A_21 * X_1           (GEMM)
+
+  and for ``trans == 'T'``, working backward from the last block row::
+
+    X_1 = X_1 - A_21^T * X_2         (GEMM)
+    X_1 = A_11^T \ X_1               (dtrsv on each column)
+
+  so that most of the work happens in GeneralMatrixMatrixMultiplyBlocked().
 
   Should be equiv to BLAS call:
-  ``dtrsm('L', 'L', 'N', 'N', size_m, size_n, 1.0, A, lda, B, size_m);``
+  ``dtrsm('L', 'L', trans, 'N', size_m, size_n, 1.0, A, lda, B, size_m);``
 \endrst*/
 void TriangularMatrixMatrixSolve(double const * restrict A, char trans, int size_m, int size_n, int lda, double * restrict X) noexcept {
-  for (int k = 0; k < size_n; ++k) {
-    TriangularMatrixVectorSolve(A, trans, size_m, lda, X);
-    X += size_m;
+#ifdef OL_BLAS_ENABLED
+  const double one = 1.0;
+  const int lda_blas = std::max(1, lda);
+  const int ldb_blas = std::max(1, size_m);
+  dtrsm_("L", "L", &trans, "N", &size_m, &size_n, &one, A, &lda_blas, X, &ldb_blas, 1, 1, 1, 1);
+  return;
+#endif
+
+  if (size_m < 2*kTriangularBlockSize || size_n < kGemmTileN) {
+    for (int k = 0; k < size_n; ++k) {
+      TriangularMatrixVectorSolve(A, trans, size_m, lda, X);
+      X += size_m;
+    }
+    return;
+  }
+
+  if (trans == 'N') {
+    for (int kb = 0; kb < size_m; kb += kTriangularBlockSize) {
+      const int block = std::min(kTriangularBlockSize, size_m - kb);
+      double const * restrict diagonal_block = A + kb*lda + kb;
+      for (int k = 0; k < size_n; ++k) {
+        TriangularMatrixVectorSolve(diagonal_block, 'N', block, lda, X + k*size_m + kb);
+      }
+      if (kb + block < size_m) {
+        GeneralMatrixMatrixMultiplyBlocked('N', 'N', size_m - kb - block, size_n, block, -1.0, diagonal_block + block,
+                                           lda, X + kb, size_m, X + kb + block, size_m);
+      }
+    }
+  } else {
+    for (int kb = ((size_m - 1)/kTriangularBlockSize)*kTriangularBlockSize; kb >= 0; kb -= kTriangularBlockSize) {
+      const int block = std::min(kTriangularBlockSize, size_m - kb);
+      double const * restrict diagonal_block = A + kb*lda + kb;
+      if (kb + block < size_m) {
+        GeneralMatrixMatrixMultiplyBlocked('T', 'N', block, size_n, size_m - kb - block, -1.0, diagonal_block + block,
+                                           lda, X + kb + block, size_m, X + kb, size_m);
+      }
+      for (int k = 0; k < size_n; ++k) {
+        TriangularMatrixVectorSolve(diagonal_block, 'T', block, lda, X + k*size_m + kb);
+      }
+    }
+  }
+}
+
+void PackLowerTriangle(int size_m, double const * restrict A, double * restrict packed) noexcept {
+  for (int j = 0; j < size_m; ++j) {
+    packed = std::copy(A + j*size_m + j, A + (j+1)*size_m, packed);
+  }
+}
+
+void UnpackLowerTriangle(int size_m, double const * restrict packed, double * restrict A) noexcept {
+  for (int j = 0; j < size_m; ++j) {
+    std::fill(A + j*size_m, A + j*size_m + j, 0.0);
+    std::copy(packed, packed + size_m - j, A + j*size_m + j);
+    packed += size_m - j;
+  }
+}
+
+void GatherSymmetricSubmatrix(int size_m, double const * restrict A, int const * restrict indices, int num_indices,
+                              double * restrict A_sub) noexcept {
+  for (int j = 0; j < num_indices; ++j) {
+    double const * restrict A_col = A + indices[j]*size_m;
+    for (int i = j; i < num_indices; ++i) {
+      A_sub[i + j*num_indices] = A_col[indices[i]];
+    }
+  }
+}
+
+void ScatterSubmatrixCholeskyFactor(int size_m, double const * restrict chol_sub, int const * restrict indices,
+                                    int num_indices, double decoupled_diagonal, double * restrict chol) noexcept {
+  std::fill(chol, chol + size_m*size_m, 0.0);
+  for (int i = 0; i < size_m; ++i) {
+    chol[i + i*size_m] = decoupled_diagonal;
+  }
+  for (int j = 0; j < num_indices; ++j) {
+    double * restrict chol_col = chol + indices[j]*size_m;
+    for (int i = j; i < num_indices; ++i) {
+      chol_col[indices[i]] = chol_sub[i + j*num_indices];
+    }
+  }
+}
+
+/*!\rst
+  The loops of TriangularMatrixVectorSolve(), entry for entry; only the column addressing differs.  ``A_j`` below points
+  ``j`` entries before packed column ``j``, so ``A_j[i]`` is entry ``(i, j)`` for ``i >= j`` as in the square layout.
+\endrst*/
+void PackedTriangularMatrixVectorSolve(double const * restrict A, char trans, int size_m, double * restrict x) noexcept {
+  if (trans == 'N') {  // solve A*x = b, A lower tri
+    for (int j = 0; j < size_m; ++j) {
+      double const * restrict A_j = A - j;
+      if (x[j] != 0.0) {
+        x[j] /= A_j[j];
+        const double temp = x[j];
+        for (int i = j+1; i < size_m; ++i) {
+          x[i] = x[i] - temp*A_j[i];
+        }
+      }
+      A += size_m - j;
+    }
+  } else {  // trans == T; solve A^T * x = b, A is lower tri
+    A += PackedTriangleSize(size_m) - 1;  // start of the last column
+    for (int j = size_m-1; j >= 0; --j) {
+      double const * restrict A_j = A - j;
+      double temp = x[j];
+      for (int i = size_m-1; i >= j+1; --i) {
+        temp -= A_j[i]*x[i];
+      }
+      x[j] = temp/A_j[j];
+      A -= size_m - j + 1;
+    }
+  }
+}
+
+/*!\rst
+  Column-oriented: for ``trans == 'N'``, column ``j`` of ``A`` eliminates ``x_j`` from every right hand side (an axpy
+  per column of ``X``); for ``trans == 'T'``, it forms every right hand side's dot product with column ``j``.  Either
+  way each packed column is streamed once, not once per right hand side.  Each column of ``X`` is computed with the
+  same operations, in the same order, as PackedTriangularMatrixVectorSolve().
+\endrst*/
+void PackedTriangularMatrixMatrixSolve(double const * restrict A, char trans, int size_m, int size_n, double * restrict X) noexcept {
+  if (trans == 'N') {
+    for (int j = 0; j < size_m; ++j) {
+      double const * restrict A_j = A - j;
+      for (int k = 0; k < size_n; ++k) {
+        double * restrict x = X + k*size_m;
+        if (x[j] != 0.0) {
+          x[j] /= A_j[j];
+          const double temp = x[j];
+          for (int i = j+1; i < size_m; ++i) {
+            x[i] = x[i] - temp*A_j[i];
+          }
+        }
+      }
+      A += size_m - j;
+    }
+  } else {
+    A += PackedTriangleSize(size_m) - 1;
+    for (int j = size_m-1; j >= 0; --j) {
+      double const * restrict A_j = A - j;
+      for (int k = 0; k < size_n; ++k) {
+        double * restrict x = X + k*size_m;
+        double temp = x[j];
+        for (int i = size_m-1; i >= j+1; --i) {
+          temp -= A_j[i]*x[i];
+        }
+        x[j] = temp/A_j[j];
+      }
+      A -= size_m - j + 1;
+    }
+  }
+}
+
+void PackedTriangularMatrixVectorMultiply(double const * restrict A, char trans, int size_m, double * restrict x) noexcept {
+  if ('N' == trans) {  // compute x = A * x, working backwards so the result can overwrite x
+    A += PackedTriangleSize(size_m) - 1;
+    for (int j = size_m-1; j >= 0; --j) {
+      double const * restrict A_j = A - j;
+      const double temp = x[j];
+      for (int i = size_m-1; i >= j+1; --i) {
+        x[i] += temp*A_j[i];
+      }
+      x[j] *= A_j[j];
+      A -= size_m - j + 1;
+    }
+  } else {  // compute x = A^T * x
+    for (int j = 0; j < size_m; ++j) {
+      double const * restrict A_j = A - j;
+      double temp = x[j]*A_j[j];
+      for (int i = j+1; i < size_m; ++i) {
+        temp += A_j[i]*x[i];
+      }
+      x[j] = temp;
+      A += size_m - j;
+    }
   }
 }
 
@@ -286,6 +1028,70 @@ void TriangularMatrixVectorMultiply(double const * restrict A, char trans, int s
   }  // end if over 'N' and 'T'
 }
 
+namespace {
+
+/*!\rst
+  Hand-written kernel behind both precisions of TriangularMatrixMatrixMultiply().
+
+  The loops mirror TriangularMatrixVectorMultiply() entry for entry (same operations in the same order), so callers
+  that batch many vector products into one matrix product (e.g., Monte Carlo draws in EI) reproduce the per-vector
+  results exactly.
+\endrst*/
+template <typename Scalar>
+OL_NONNULL_POINTERS void TriangularMatrixMatrixMultiplyLoops(Scalar const * restrict A, char trans, int size_m, int size_n,
+                                                             int lda, Scalar * restrict B) noexcept {
+  if ('N' == trans) {  // compute B = A * B
+    for (int k = 0; k < size_n; ++k) {
+      // work backwards (by column of A) to permit computing results in-place
+      for (int j = size_m-1; j >= 0; --j) {
+        const Scalar temp = B[j];
+        for (int i = size_m-1; i >= j+1; --i) {
+          B[i] += temp*A[i + j*lda];
+        }
+        B[j] *= A[j + j*lda];
+      }
+      B += size_m;
+    }
+  } else {  // assume trans == 'T', compute B = A^T * B
+    for (int k = 0; k < size_n; ++k) {
+      for (int j = 0; j < size_m; ++j) {
+        Scalar temp = B[j] * A[j + j*lda];
+        for (int i = j+1; i < size_m; ++i) {
+          temp += A[i + j*lda]*B[i];
+        }
+        B[j] = temp;
+      }
+      B += size_m;
+    }
+  }
+}
+
+}  // end unnamed namespace
+
+void TriangularMatrixMatrixMultiply(double const * restrict A, char trans, int size_m, int size_n, int lda, double * restrict B) noexcept {
+#ifdef OL_BLAS_ENABLED
+  const double one = 1.0;
+  const int lda_blas = std::max(1, lda);
+  const int ldb_blas = std::max(1, size_m);
+  dtrmm_("L", "L", &trans, "N", &size_m, &size_n, &one, A, &lda_blas, B, &ldb_blas, 1, 1, 1, 1);
+  return;
+#endif
+
+  TriangularMatrixMatrixMultiplyLoops(A, trans, size_m, size_n, lda, B);
+}
+
+void TriangularMatrixMatrixMultiply(float const * restrict A, char trans, int size_m, int size_n, int lda, float * restrict B) noexcept {
+#ifdef OL_BLAS_ENABLED
+  const float one = 1.0f;
+  const int lda_blas = std::max(1, lda);
+  const int ldb_blas = std::max(1, size_m);
+  strmm_("L", "L", &trans, "N", &size_m, &size_n, &one, A, &lda_blas, B, &ldb_blas, 1, 1, 1, 1);
+  return;
+#endif
+
+  TriangularMatrixMatrixMultiplyLoops(A, trans, size_m, size_n, lda, B);
+}
+
 /*!\rst
   Special case of GeneralMatrixVectorMultiply for symmetric A (need not be SPD).
   As long as A is stored fully (i.e., upper triangle is valid),
@@ -297,6 +1103,15 @@ void TriangularMatrixVectorMultiply(double const * restrict A, char trans, int s
   ``dsymv('L', size_m, 1.0, A, size_m, x, 1, 0.0, y, 1);``
 \endrst*/
 void SymmetricMatrixVectorMultiply(double const * restrict A, double const * restrict x, int size_m, double * restrict y) noexcept {
+#ifdef OL_BLAS_ENABLED
+  const double one = 1.0;
+  const double zero = 0.0;
+  const int increment = 1;
+  const int lda_blas = std::max(1, size_m);
+  dsymv_("L", &size_m, &one, A, &lda_blas, x, &increment, &zero, y, &increment, 1);
+  return;
+#endif
+
   std::fill(y, y+size_m, 0.0);
   double temp1 = x[0], temp2 = 0.0;
 
@@ -376,12 +1191,34 @@ void GeneralMatrixVectorMultiply(double const * restrict A, char trans, double c
   Does so by computing matrix-vector products of ``A`` with each column of ``B``
   (to generate corresponding column of ``C``).
 
-  Does not use blocking or other advanced optimization techniques.
+  Products with at least ``kGemmBlockedThreshold`` multiply-adds instead go through the packed, cache-blocked
+  GeneralMatrixMatrixMultiplyBlocked().
 
   Should be equivalent to BLAS call:
   ``dgemm('N', 'N', size_m, size_n, size_k, alpha, A, size_m, B, size_k, beta, C, size_m);``
 \endrst*/
 void GeneralMatrixMatrixMultiply(double const * restrict Amat, char transA, double const * restrict Bmat, double alpha, double beta, int size_m, int size_k, int size_n, double * restrict Cmat) noexcept {
+#ifdef OL_BLAS_ENABLED
+  const int lda_blas = std::max(1, (transA == 'N') ? size_m : size_k);
+  const int ldb_blas = std::max(1, size_k);
+  const int ldc_blas = std::max(1, size_m);
+  dgemm_(&transA, "N", &size_m, &size_n, &size_k, &alpha, Amat, &lda_blas, Bmat, &ldb_blas, &beta, Cmat, &ldc_blas, 1, 1);
+  return;
+#endif
+
+  if (static_cast<int64_t>(size_m)*size_k*size_n >= kGemmBlockedThreshold) {
+    if (beta != 1.0) {
+      if (likely(beta == 0.0)) {
+        std::fill(Cmat, Cmat + size_m*size_n, 0.0);
+      } else {
+        VectorScale(size_m*size_n, beta, Cmat);
+      }
+    }
+    const int lda = (transA == 'N') ? size_m : size_k;
+    GeneralMatrixMatrixMultiplyBlocked(transA, 'N', size_m, size_n, size_k, alpha, Amat, lda, Bmat, size_k, Cmat, size_m);
+    return;
+  }
+
   if (transA == 'N') {
     for (int j = 0; j < size_n; ++j) {
       GeneralMatrixVectorMultiply(Amat, 'N', Bmat, alpha, beta, size_m, size_k, size_m, Cmat);
@@ -404,8 +1241,26 @@ void GeneralMatrixMatrixMultiply(double const * restrict Amat, char transA, doub
   This is NOT backward-stable and should NOT be used!  Substantial superfluous
   numerical error can occur for poorly conditioned matrices.
   Caveat: may have utility if you are very certain of what you are doing in the face of [severe] loss of precision
+
+  With ``OL_BLAS_ENABLED``, this calls ``dpotri`` (which fills the lower triangle) and then mirrors the result into
+  the upper triangle.
 \endrst*/
 void SPDMatrixInverse(double const * restrict chol_matrix, int size_m, double * restrict inv_matrix) noexcept {
+#ifdef OL_BLAS_ENABLED
+  for (int j = 0; j < size_m; ++j) {
+    std::copy(chol_matrix + j*size_m + j, chol_matrix + (j+1)*size_m, inv_matrix + j*size_m + j);
+  }
+  const int lda_blas = std::max(1, size_m);
+  int info = 0;
+  dpotri_("L", &size_m, inv_matrix, &lda_blas, &info, 1);
+  for (int j = 0; j < size_m; ++j) {
+    for (int i = j+1; i < size_m; ++i) {
+      inv_matrix[i*size_m + j] = inv_matrix[j*size_m + i];
+    }
+  }
+  return;
+#endif
+
   std::vector<double> L_inv(size_m*size_m);
   TriangularMatrixInverse(chol_matrix, size_m, L_inv.data());
   GeneralMatrixMatrixMultiply(L_inv.data(), 'T', L_inv.data(), 1.0, 0.0, size_m, size_m, size_m, inv_matrix);
@@ -687,4 +1542,113 @@ void PLUMatrixVectorSolve(int r, double const * restrict LU, int const * restric
   // dtrsv_(&upper, &no_trans, &no_unit, &r, LU, &r, b, &inc_one);
 }
 
+/*!\rst
+  Rotations follow Numerical Recipes (3rd ed.), section 11.1: with ``\theta = (A_qq - A_pp)/(2 A_pq)``, the rotation
+  angle's tangent is the smaller root of ``t^2 + 2 t \theta - 1 = 0``, which zeroes ``A_pq`` while keeping the rotation
+  close to the identity.  Sweeps stop once the off-diagonal sum of squares is below ``\epsilon^2`` times the diagonal's.
+\endrst*/
+void SymmetricEigendecomposition(int size_m, double * restrict A, double * restrict eigenvectors,
+                                 double * restrict eigenvalues) noexcept {
+  const int max_num_sweeps = 100;
+  std::fill(eigenvectors, eigenvectors + size_m*size_m, 0.0);
+  for (int i = 0; i < size_m; ++i) {
+    eigenvectors[i*size_m + i] = 1.0;
+  }
+
+  for (int sweep = 0; sweep < max_num_sweeps; ++sweep) {
+    double off_diagonal_norm_sq = 0.0;
+    double diagonal_norm_sq = 0.0;
+    for (int q = 0; q < size_m; ++q) {
+      for (int p = 0; p < q; ++p) {
+        off_diagonal_norm_sq += Square(A[q*size_m + p]);
+      }
+      diagonal_norm_sq += Square(A[q*size_m + q]);
+    }
+    if (off_diagonal_norm_sq <= Square(std::numeric_limits<double>::epsilon())*diagonal_norm_sq) {
+      break;
+    }
+
+    for (int q = 1; q < size_m; ++q) {
+      for (int p = 0; p < q; ++p) {
+        const double A_pq = A[q*size_m + p];
+        if (A_pq == 0.0) {
+          continue;
+        }
+        const double theta = (A[q*size_m + q] - A[p*size_m + p])/(2.0*A_pq);
+        const double tangent = std::copysign(1.0, theta)/(std::fabs(theta) + std::hypot(theta, 1.0));
+        const double cosine = 1.0/std::sqrt(1.0 + Square(tangent));
+        const double sine = tangent*cosine;
+
+        // A := A * J, then A := J^T * A, and Q := Q * J, for the rotation J in the (p, q) plane
+        double * restrict col_p = A + p*size_m;
+        double * restrict col_q = A + q*size_m;
+        for (int k = 0; k < size_m; ++k) {
+          const double A_kp = col_p[k];
+          col_p[k] = cosine*A_kp - sine*col_q[k];
+          col_q[k] = sine*A_kp + cosine*col_q[k];
+        }
+        for (int k = 0; k < size_m; ++k) {
+          const double A_pk = A[k*size_m + p];
+          A[k*size_m + p] = cosine*A_pk - sine*A[k*size_m + q];
+          A[k*size_m + q] = sine*A_pk + cosine*A[k*size_m + q];
+        }
+        double * restrict vector_p = eigenvectors + p*size_m;
+        double * restrict vector_q = eigenvectors + q*size_m;
+        for (int k = 0; k < size_m; ++k) {
+          const double Q_kp = vector_p[k];
+          vector_p[k] = cosine*Q_kp - sine*vector_q[k];
+          vector_q[k] = sine*Q_kp + cosine*vector_q[k];
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < size_m; ++i) {
+    eigenvalues[i] = A[i*size_m + i];
+  }
+}
+
+/*!\rst
+  Factor ``d`` acts on index ``i_d``, whose rows are ``stride = \prod_{e<d} m_e`` apart; every other index (and the
+  column of ``X``) is just a batch, so each factor is one loop over ``M*size_n/(m_d*stride)`` independent
+  ``[m_d x m_d] * [m_d x stride]`` products.  Results ping-pong between ``X`` and ``scratch``.
+\endrst*/
+void KroneckerMatrixMatrixMultiply(double const * restrict factors, int const * restrict factor_sizes, int num_factors,
+                                   char trans, int size_n, double * restrict X, double * restrict scratch) noexcept {
+  int num_rows = 1;
+  for (int d = 0; d < num_factors; ++d) {
+    num_rows *= factor_sizes[d];
+  }
+
+  double * source = X;
+  double * target = scratch;
+  int stride = 1;
+  for (int d = 0; d < num_factors; ++d) {
+    const int size = factor_sizes[d];
+    const int num_batches = (num_rows/(stride*size))*size_n;
+    for (int batch = 0; batch < num_batches; ++batch) {
+      double const * restrict source_batch = source + batch*stride*size;
+      double * restrict target_batch = target + batch*stride*size;
+      for (int a = 0; a < size; ++a) {
+        double * restrict target_row = target_batch + a*stride;
+        std::fill(target_row, target_row + stride, 0.0);
+        for (int b = 0; b < size; ++b) {
+          const double coefficient = trans == 'T' ? factors[a*size + b] : factors[b*size + a];
+          double const * restrict source_row = source_batch + b*stride;
+          for (int i = 0; i < stride; ++i) {
+            target_row[i] += coefficient*source_row[i];
+          }
+        }
+      }
+    }
+    factors += Square(size);
+    stride *= size;
+    std::swap(source, target);
+  }
+
+  if (source != X) {
+    std::copy(source, source + num_rows*size_n, X);
+  }
+}
+
 }  // end namespace optimal_learning
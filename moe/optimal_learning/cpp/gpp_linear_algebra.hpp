@@ -144,6 +144,9 @@ inline OL_PURE_FUNCTION OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT double DotProd
 
   The strict upper triangle of chol is NOT accessed.
 
+  Large matrices (``size_m >= 512``) are factored with ``omp_get_max_threads()`` threads unless called from inside
+  an OpenMP parallel region (see NumThreadsForInnerLoops()); the result does not depend on the number of threads.
+
   \param
     :size_m: dimension of matrix
     :chol[size_m][size_m]: SPD (square) matrix (``A``) (on entry)
@@ -156,6 +159,92 @@ inline OL_PURE_FUNCTION OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT double DotProd
 \endrst*/
 int ComputeCholeskyFactorL(int size_m, double * restrict chol) noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
 
+/*!\rst
+  Computes the cholesky factorization of an SPD matrix made of ``point_block_size x point_block_size`` blocks, e.g., the
+  covariance ``K`` of a GP with gradient observations, where each sampled point contributes a contiguous block of
+  ``point_block_size = 1 + num_derivatives`` rows (its value, then its derivatives).
+
+  Same output (up to roundoff), contract, and return value as ComputeCholeskyFactorL(); the factorization just steps
+  over whole point blocks.  Each trailing update applies a point block's ``point_block_size`` rank-1 updates in one
+  pass, so the trailing matrix is traversed once per point rather than once per row.  If ``point_block_size`` does not
+  divide ``size_m``, the last block is smaller.  ``point_block_size = 1`` is ComputeCholeskyFactorL().
+
+  \param
+    :size_m: dimension of matrix
+    :point_block_size: rows per point block (``>= 1``)
+    :chol[size_m][size_m]: SPD (square) matrix (``A``) (on entry)
+  \output
+    :chol[size_m][size_m]: cholesky factor of ``A`` (``L``), in the lower triangle (on exit)
+  \return
+    0 if successful. Otherwise the matrix is NOT positive definite and this returns ``i``, the
+    index of the ``i``-th leading minor that is not positive definite; the offending point block is
+    ``(i-1)/point_block_size``.
+\endrst*/
+int ComputeBlockCholeskyFactorL(int size_m, int point_block_size,
+                                double * restrict chol) noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Jitter escalation settings (in) and report (out) of ComputeCholeskyFactorLWithJitter().  Settings are relative to
+  the scale of the matrix, its largest diagonal entry.
+\endrst*/
+struct CholeskyJitter {
+  //! first jitter tried when a pivot fails, relative to ``max_i A_ii``; must be positive
+  double initial_relative_jitter;
+  //! largest jitter allowed (the jitter grows 10x per escalation), relative to ``max_i A_ii``; must be finite
+  double max_relative_jitter;
+  //! (output) absolute jitter added to the last jittered pivots; 0 if the matrix factored without jitter
+  double jitter;
+  //! (output) number of pivots that received jitter
+  int num_jittered_pivots;
+};
+
+/*!\rst
+  Same as ComputeBlockCholeskyFactorL(), except that a non-positive pivot does not end the factorization: the jitter is
+  escalated in place (``initial_relative_jitter``, then 10x per step, up to ``max_relative_jitter``, all times
+  ``max_i A_ii``) until the pivot is acceptable, and the factorization resumes from that pivot.  Every later pivot also
+  receives the (current) jitter.
+
+  So one call factors ``L * L^T = A + E``, where ``E`` is diagonal, 0 before the first failed pivot, nondecreasing, and
+  at most ``jitter->jitter``; no part of the factorization is ever redone.  (Restarting with ``A + \delta I`` instead
+  would refactor from scratch once per escalation.)  If the matrix factors without jitter, the result is exactly
+  ComputeBlockCholeskyFactorL()'s and ``jitter->jitter = 0``.
+
+  Always uses the native kernels, even with ``OL_BLAS_ENABLED`` (``dpotrf`` cannot resume).
+
+  \param
+    :size_m: dimension of matrix
+    :point_block_size: rows per point block (``>= 1``); see ComputeBlockCholeskyFactorL()
+    :chol[size_m][size_m]: symmetric (square) matrix (``A``) (on entry)
+    :jitter[1]: escalation settings
+  \output
+    :chol[size_m][size_m]: cholesky factor of ``A + E`` (``L``), in the lower triangle (on exit)
+    :jitter[1]: ``jitter`` and ``num_jittered_pivots`` report the jitter that was used
+  \return
+    0 if successful. Otherwise no jitter up to ``max_relative_jitter`` made the ``i``-th pivot positive and this
+    returns ``i``, as ComputeBlockCholeskyFactorL() does
+\endrst*/
+int ComputeCholeskyFactorLWithJitter(int size_m, int point_block_size, double * restrict chol,
+                                     CholeskyJitter * jitter) noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Reverse-mode (adjoint) differentiation of the cholesky factorization ``L * L^T = A``: given ``\bar{L}``, the gradient
+  of some scalar ``f`` wrt ``L`` (lower triangle), computes ``\bar{A}``, the gradient of ``f`` wrt (symmetric) ``A``, so
+  that ``df = tr(\bar{A} * dA)`` for every symmetric perturbation ``dA``.
+
+  Uses the matrix ("symbolic") form of the adjoint from Murray 2016, *Differentiation of the Cholesky decomposition*:
+  ``\bar{A} = sym(L^{-T} * \Phi(L^T * \bar{L}) * L^{-1})``, where ``\Phi`` keeps the lower triangle and halves the
+  diagonal and ``sym(X) = (X + X^T)/2``.  Costs ``O(size_m^3)``, once, no matter how many variables ``A`` depends on;
+  differentiating ``L`` in forward mode (Smith 1995) costs that much per variable.
+
+  \param
+    :size_m: dimension of the matrices
+    :chol[size_m][size_m]: nonsingular cholesky factor ``L``, in the lower triangle; the upper triangle is not accessed
+    :adjoint[size_m][size_m]: ``\bar{L}``, in the lower triangle; the upper triangle is ignored (on entry)
+  \output
+    :adjoint[size_m][size_m]: ``\bar{A}``, the full symmetric matrix (on exit)
+\endrst*/
+void CholeskyFactorLAdjoint(int size_m, double const * restrict chol, double * restrict adjoint) noexcept OL_NONNULL_POINTERS;
+
 /*!\rst
   Solves the system ``A*x = b`` or ``A^T * x = b`` when ``A`` is lower triangular. ``A`` must be nonsingular.
   Before calling, ``x`` holds the RHS, ``b``.  After return, ``x`` will be OVERWRITTEN with
@@ -249,6 +338,147 @@ inline OL_NONNULL_POINTERS void CholeskyFactorLMatrixMatrixSolve(double const *
   TriangularMatrixMatrixSolve(A, 'T', size_m, size_n, size_m, X);
 }
 
+/*!\rst
+  Number of entries of a ``size_m x size_m`` lower triangle in packed storage, ``size_m*(size_m+1)/2``.
+
+  Packed storage (LAPACK's ``'L'`` packed format) keeps only the lower triangle, column by column: column ``j`` holds
+  rows ``j, ..., size_m-1`` contiguously, so entry ``(i, j)``, ``i >= j``, is at ``packed[i + j*(2*size_m - j - 1)/2]``.
+  It halves the memory of a cholesky factor; the Packed* kernels below read it directly.
+\endrst*/
+inline OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT int PackedTriangleSize(int size_m) noexcept {
+  return size_m*(size_m+1)/2;
+}
+
+/*!\rst
+  Copies the lower triangle of ``A`` into packed storage (see PackedTriangleSize()).  The upper triangle is not read.
+
+  \param
+    :size_m: dimension of ``A``
+    :A[size_m][size_m]: matrix whose lower triangle is packed
+  \output
+    :packed[PackedTriangleSize(size_m)]: the lower triangle of ``A``, packed
+\endrst*/
+void PackLowerTriangle(int size_m, double const * restrict A, double * restrict packed) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Inverse of PackLowerTriangle(): expands a packed lower triangle into a full matrix with a zero upper triangle.
+
+  \param
+    :size_m: dimension of ``A``
+    :packed[PackedTriangleSize(size_m)]: a packed lower triangle
+  \output
+    :A[size_m][size_m]: the lower triangle, with zeros in the strict upper triangle
+\endrst*/
+void UnpackLowerTriangle(int size_m, double const * restrict packed, double * restrict A) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Copies the rows and columns ``indices`` of a symmetric matrix into a dense ``num_indices x num_indices`` matrix, e.g.,
+  the observed entries of a covariance whose other rows are masked out.  Only the lower triangle of ``A`` is read, and
+  only the lower triangle of ``A_sub`` is written.
+
+  \param
+    :size_m: dimension of ``A``
+    :A[size_m][size_m]: symmetric matrix (lower triangle)
+    :indices[num_indices]: rows (and columns) to keep; strictly increasing
+    :num_indices: number of rows to keep
+  \output
+    :A_sub[num_indices][num_indices]: ``A(indices, indices)``, lower triangle
+\endrst*/
+void GatherSymmetricSubmatrix(int size_m, double const * restrict A, int const * restrict indices, int num_indices,
+                              double * restrict A_sub) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Expands the cholesky factor of ``A(indices, indices)`` (e.g., from GatherSymmetricSubmatrix()) into the factor of the
+  ``size_m x size_m`` matrix that agrees with ``A`` on ``indices`` and whose other rows and columns are 0 except for
+  ``decoupled_diagonal^2`` on the diagonal.  Since those rows are decoupled, that factor is exactly ``L_sub`` on
+  ``indices``, ``decoupled_diagonal`` on the other diagonal entries, and 0 elsewhere: factoring a masked system costs
+  ``O(num_indices^3)`` instead of ``O(size_m^3)``.
+
+  \param
+    :size_m: dimension of ``chol``
+    :chol_sub[num_indices][num_indices]: cholesky factor (lower triangle) of ``A(indices, indices)``
+    :indices[num_indices]: rows (and columns) of ``chol_sub``; strictly increasing
+    :num_indices: number of rows of ``chol_sub``
+    :decoupled_diagonal: diagonal entry of ``chol`` in the rows not in ``indices``
+  \output
+    :chol[size_m][size_m]: the expanded factor, with zeros in the strict upper triangle
+\endrst*/
+void ScatterSubmatrixCholeskyFactor(int size_m, double const * restrict chol_sub, int const * restrict indices,
+                                    int num_indices, double decoupled_diagonal,
+                                    double * restrict chol) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Same as TriangularMatrixVectorSolve() (with ``lda = size_m``), except ``A`` is in packed storage.
+
+  \param
+    :A[PackedTriangleSize(size_m)]: packed lower triangular, non-singular matrix
+    :trans: 'N' to solve ``A * x = b``, 'T' to solve ``A^T * x = b``
+    :size_m: dimension of ``A``
+    :x[size_m]: the RHS vector, ``b``
+  \output
+    :x[size_m]: the solution, ``A\b``.
+\endrst*/
+void PackedTriangularMatrixVectorSolve(double const * restrict A, char trans, int size_m, double * restrict x) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Same as TriangularMatrixMatrixSolve() (with ``lda = size_m``), except ``A`` is in packed storage.  Each column of
+  ``A`` is read once for all of the right hand sides.
+
+  \param
+    :A[PackedTriangleSize(size_m)]: packed lower triangular, non-singular matrix
+    :trans: 'N' to solve ``A * X = B``, 'T' to solve ``A^T * X = B``
+    :size_m: dimension of ``A``
+    :size_n: number of columns of ``X, B``
+    :X[size_m][size_n]: the RHS matrix, ``B``
+  \output
+    :X[size_m][size_n]: the solution, ``A\B``.
+\endrst*/
+void PackedTriangularMatrixMatrixSolve(double const * restrict A, char trans, int size_m, int size_n, double * restrict X) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Same as CholeskyFactorLMatrixVectorSolve(), except ``L`` is in packed storage.
+
+  \param
+    :A[PackedTriangleSize(size_m)]: ``L``, the cholesky factor of the system, packed
+    :size_m: dimension of ``A``
+    :x[size_m]: the RHS vector, ``b``
+  \output
+    :x[size_m]: the solution, ``(L * L^T)\b``.
+\endrst*/
+inline OL_NONNULL_POINTERS void PackedCholeskyFactorLMatrixVectorSolve(double const * restrict A, int size_m, double * restrict x) noexcept {
+  PackedTriangularMatrixVectorSolve(A, 'N', size_m, x);
+  PackedTriangularMatrixVectorSolve(A, 'T', size_m, x);
+}
+
+/*!\rst
+  Same as CholeskyFactorLMatrixMatrixSolve(), except ``L`` is in packed storage.
+
+  \param
+    :A[PackedTriangleSize(size_m)]: ``L``, the cholesky factor of the system, packed
+    :size_m: number of rows of ``A, X, B``; number of columns of ``A``
+    :size_n: number of columns of ``X, B``
+    :X[size_m][size_n]: matrix of RHS vectors, ``B``
+  \output
+    :X[size_m][size_n]: matrix of solutions, ``(L * L^T)\B``
+\endrst*/
+inline OL_NONNULL_POINTERS void PackedCholeskyFactorLMatrixMatrixSolve(double const * restrict A, int size_m, int size_n, double * restrict X) noexcept {
+  PackedTriangularMatrixMatrixSolve(A, 'N', size_m, size_n, X);
+  PackedTriangularMatrixMatrixSolve(A, 'T', size_m, size_n, X);
+}
+
+/*!\rst
+  Same as TriangularMatrixVectorMultiply(), except ``A`` is in packed storage.
+
+  \param
+    :A[PackedTriangleSize(size_m)]: packed lower triangular matrix to be multiplied
+    :trans: 'N' for ``A * x``, 'T' for ``A^T * x``
+    :size_m: dimension of ``A, x``
+    :x[size_m]: vector to multiply by ``A``
+  \output
+    :x[size_m]: the product ``A * x`` or ``A^T * x``
+\endrst*/
+void PackedTriangularMatrixVectorMultiply(double const * restrict A, char trans, int size_m, double * restrict x) noexcept OL_NONNULL_POINTERS;
+
 /*!\rst
   Computes ``A * x`` or ``A^T * x`` in-place.
   ``A`` must be lower-triangular.  The vector ``x`` is OVERWRITTEN with the result before return.
@@ -263,6 +493,31 @@ inline OL_NONNULL_POINTERS void CholeskyFactorLMatrixMatrixSolve(double const *
 \endrst*/
 void TriangularMatrixVectorMultiply(double const * restrict A, char trans, int size_m, double * restrict x) noexcept OL_NONNULL_POINTERS;
 
+/*!\rst
+  Computes ``A * B`` or ``A^T * B`` in-place (``A, B`` matrices).
+  ``A`` must be lower-triangular.  The matrix ``B`` is OVERWRITTEN with the result before return.
+
+  Each column of the result is bitwise identical to calling TriangularMatrixVectorMultiply() on the corresponding
+  column of ``B`` (except when ``OL_BLAS_ENABLED``, which calls ``dtrmm``).
+
+  \param
+    :A[size_m][size_m]: lower triangular matrix to be multiplied
+    :trans: 'N' for ``A * B``, 'T' for ``A^T * B``
+    :size_m: dimension of ``A``, rows of ``B``
+    :size_n: columns of ``B``
+    :lda: the first dimension of ``A`` as declared by the caller; ``lda >= size_m``
+    :B[size_m][size_n]: matrix to multiply by ``A``
+  \output
+    :B[size_m][size_n]: the product ``A * B`` or ``A^T * B``
+\endrst*/
+void TriangularMatrixMatrixMultiply(double const * restrict A, char trans, int size_m, int size_n, int lda, double * restrict B) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Single precision version of TriangularMatrixMatrixMultiply() (``strmm`` when ``OL_BLAS_ENABLED``); same inputs and outputs.
+  For consumers that can tolerate float round-off in exchange for half the memory traffic (e.g., Monte Carlo draws in EI).
+\endrst*/
+void TriangularMatrixMatrixMultiply(float const * restrict A, char trans, int size_m, int size_n, int lda, float * restrict B) noexcept OL_NONNULL_POINTERS;
+
 /*!\rst
   Computes ``y = A * x`` (or equivalently ``y = A^T * x``).  This is NOT done in-place.
   A must be symmetric.  Only the lower triangular part of A is read, so there is no need
@@ -395,6 +650,44 @@ int ComputePLUFactorization(int r, int * restrict pivot, double * restrict A) no
 \endrst*/
 void PLUMatrixVectorSolve(int r, double const * restrict LU, int const * restrict pivot, double * restrict b) noexcept OL_NONNULL_POINTERS;
 
+/*!\rst
+  Computes the eigendecomposition ``A = Q * \Lambda * Q^T`` of a symmetric matrix with the cyclic Jacobi method: each
+  sweep zeroes every off-diagonal entry in turn with a plane rotation, until the off-diagonal part is negligible
+  relative to the diagonal.  Each sweep costs ``O(size_m^3)`` and a handful of sweeps suffice, so this is meant for
+  small matrices (e.g., the per-dimension kernels of a grid-structured GaussianProcess), not as a general eigensolver.
+
+  \param
+    :size_m: dimension of ``A``
+    :A[size_m][size_m]: symmetric matrix (both triangles are read)
+  \output
+    :A[size_m][size_m]: destroyed (its diagonal holds the eigenvalues)
+    :eigenvectors[size_m][size_m]: ``Q``; column ``j`` is the unit eigenvector of ``eigenvalues[j]``
+    :eigenvalues[size_m]: ``\Lambda``, in no particular order
+\endrst*/
+void SymmetricEigendecomposition(int size_m, double * restrict A, double * restrict eigenvectors,
+                                 double * restrict eigenvalues) noexcept OL_NONNULL_POINTERS;
+
+/*!\rst
+  Computes ``X := (A_{n-1} \otimes ... \otimes A_1 \otimes A_0) * X`` (or with each ``A_d`` replaced by ``A_d^T``)
+  without forming the Kronecker product.  Row ``i_0 + m_0*(i_1 + m_1*(i_2 + ...))`` of ``X`` (``i_0`` fastest) is
+  entry ``(i_0, i_1, ...)`` of a tensor; each factor multiplies the tensor along its own index, so the product costs
+  ``O(size_n * M * \sum_d m_d)`` for ``M = \prod_d m_d`` rows instead of ``O(size_n * M^2)``.
+
+  \param
+    :factors[\sum_d m_d^2]: the square factors ``A_d`` (column-major), concatenated in order of ``d``
+    :factor_sizes[num_factors]: ``m_d``, the dimension of each factor
+    :num_factors: number of factors, ``n``
+    :trans: whether to multiply by ``A`` ('N') or ``A^T`` ('T')
+    :size_n: number of columns of ``X``
+    :X[M][size_n]: matrix to multiply
+    :scratch[M*size_n]: temporary storage
+  \output
+    :X[M][size_n]: ``A * X`` or ``A^T * X``
+\endrst*/
+void KroneckerMatrixMatrixMultiply(double const * restrict factors, int const * restrict factor_sizes, int num_factors,
+                                   char trans, int size_n, double * restrict X,
+                                   double * restrict scratch) noexcept OL_NONNULL_POINTERS;
+
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_LINEAR_ALGEBRA_HPP_
@@ -25,14 +25,19 @@
 #include "gpp_linear_algebra_test.hpp"
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 
 #include <algorithm>
 #include <limits>
 #include <vector>
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
 
+#include "gpp_aligned_allocator.hpp"
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_exception.hpp"
@@ -1247,6 +1252,720 @@ OL_WARN_UNUSED_RESULT int TestMatrixTrace() noexcept {
   return total_errors;
 }
 
+/*!\rst
+  Test the blocked code paths of ComputeCholeskyFactorL, TriangularMatrixMatrixSolve, and GeneralMatrixMatrixMultiply.
+  These only activate for larger problems, so the sizes here are chosen to straddle the block sizes
+  (and to not be multiples of them).
+
+  1. Cholesky: check ``L * L^T = A`` and that the strict upper triangle of the input is not touched.
+  2. Triangular solve ('N' and 'T'): compare against column-by-column TriangularMatrixVectorSolve.
+  3. Matrix-matrix multiply ('N' and 'T', ``beta != 0``): compare against column-by-column GeneralMatrixVectorMultiply.
+
+  \return
+    number of cases where the blocked and unblocked results differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestBlockedLinearAlgebra() {
+  int total_errors = 0;
+
+  const int num_tests = 3;
+  const int sizes[num_tests] = {128, 150, 203};
+  const int num_rhs = 37;
+  const double tolerance = 1.0e-12;
+
+  UniformRandomGenerator uniform_generator(9513);
+  for (int i = 0; i < num_tests; ++i) {
+    const int size = sizes[i];
+    std::vector<double> spd_matrix(size*size);
+    std::vector<double> cholesky_factor(size*size);
+    std::vector<double> cholesky_factor_T(size*size);
+    std::vector<double> product_matrix(size*size);
+
+    // cholesky
+    BuildRandomSPDMatrix(size, &uniform_generator, spd_matrix.data());
+    ModifyMatrixDiagonal(size, static_cast<double>(size), spd_matrix.data());
+    std::copy(spd_matrix.begin(), spd_matrix.end(), cholesky_factor.begin());
+    for (int col = 0; col < size; ++col) {
+      for (int row = 0; row < col; ++row) {
+        cholesky_factor[col*size + row] = -1.0;  // sentinel: must not be read or written
+      }
+    }
+    if (ComputeCholeskyFactorL(size, cholesky_factor.data()) != 0) {
+      ++total_errors;
+    }
+    for (int col = 0; col < size; ++col) {
+      for (int row = 0; row < col; ++row) {
+        if (cholesky_factor[col*size + row] != -1.0) {
+          ++total_errors;
+        }
+      }
+    }
+    ZeroUpperTriangle(size, cholesky_factor.data());
+    MatrixTranspose(cholesky_factor.data(), size, size, cholesky_factor_T.data());
+    for (int col = 0; col < size; ++col) {
+      GeneralMatrixVectorMultiply(cholesky_factor.data(), 'N', cholesky_factor_T.data() + col*size, 1.0, 0.0,
+                                  size, size, size, product_matrix.data() + col*size);
+    }
+    for (int j = 0; j < size*size; ++j) {
+      if (!CheckDoubleWithinRelative(product_matrix[j], spd_matrix[j], tolerance)) {
+        ++total_errors;
+      }
+    }
+
+    // triangular solve; lda > size exercises the leading dimension handling
+    const int lda = size + 3;
+    std::vector<double> lower_triangular_matrix(lda*size, 0.0);
+    for (int col = 0; col < size; ++col) {
+      std::copy(cholesky_factor.begin() + col*size, cholesky_factor.begin() + (col+1)*size,
+                lower_triangular_matrix.begin() + col*lda);
+    }
+    std::vector<double> rhs(size*num_rhs);
+    std::vector<double> solution(size*num_rhs);
+    std::vector<double> solution_reference(size*num_rhs);
+    BuildRandomVector(size*num_rhs, -1.0, 1.0, &uniform_generator, rhs.data());
+    for (char trans : {'N', 'T'}) {
+      solution = rhs;
+      solution_reference = rhs;
+      TriangularMatrixMatrixSolve(lower_triangular_matrix.data(), trans, size, num_rhs, lda, solution.data());
+      for (int col = 0; col < num_rhs; ++col) {
+        TriangularMatrixVectorSolve(lower_triangular_matrix.data(), trans, size, lda,
+                                    solution_reference.data() + col*size);
+      }
+      // blocked and unblocked solves accumulate in different orders, so compare norm-wise
+      if (!CheckMatrixNormWithin(solution.data(), solution_reference.data(), size, num_rhs,
+                                 tolerance*VectorNorm(solution_reference.data(), size*num_rhs))) {
+        ++total_errors;
+      }
+    }
+
+    // matrix-matrix multiply: C = 0.7 * op(A) * B - 1.3 * C, op(A) is size x (size-5), B is (size-5) x num_rhs
+    const int size_k = size - 5;
+    std::vector<double> matrix_A(size*size_k);
+    std::vector<double> matrix_B(size_k*num_rhs);
+    std::vector<double> matrix_C(size*num_rhs);
+    std::vector<double> matrix_C_reference(size*num_rhs);
+    BuildRandomVector(size*size_k, -1.0, 1.0, &uniform_generator, matrix_A.data());
+    BuildRandomVector(size_k*num_rhs, -1.0, 1.0, &uniform_generator, matrix_B.data());
+    for (char trans : {'N', 'T'}) {
+      BuildRandomVector(size*num_rhs, -1.0, 1.0, &uniform_generator, matrix_C.data());
+      matrix_C_reference = matrix_C;
+      GeneralMatrixMatrixMultiply(matrix_A.data(), trans, matrix_B.data(), 0.7, -1.3, size, size_k, num_rhs,
+                                  matrix_C.data());
+      for (int col = 0; col < num_rhs; ++col) {
+        if (trans == 'N') {
+          GeneralMatrixVectorMultiply(matrix_A.data(), 'N', matrix_B.data() + col*size_k, 0.7, -1.3, size, size_k,
+                                      size, matrix_C_reference.data() + col*size);
+        } else {
+          GeneralMatrixVectorMultiply(matrix_A.data(), 'T', matrix_B.data() + col*size_k, 0.7, -1.3, size_k, size,
+                                      size_k, matrix_C_reference.data() + col*size);
+        }
+      }
+      for (int j = 0; j < size*num_rhs; ++j) {
+        if (!CheckDoubleWithin(matrix_C[j], matrix_C_reference[j], tolerance*size_k)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Test ComputeBlockCholeskyFactorL against ComputeCholeskyFactorL, for point block sizes that do and do not divide
+  the matrix size, on both the small-matrix kernel and the blocked (panel) path.
+
+  1. the factors agree (up to roundoff) and the strict upper triangle of the input is not touched.
+  2. ``point_block_size = 1`` is bitwise ComputeCholeskyFactorL.
+  3. a non-positive pivot is reported at the same leading minor as ComputeCholeskyFactorL.
+
+  \return
+    number of cases where the block and scalar factorizations differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestBlockCholesky() {
+  int total_errors = 0;
+
+  const int num_sizes = 4;
+  const int sizes[num_sizes] = {12, 60, 130, 203};
+  const int num_block_sizes = 5;
+  const int point_block_sizes[num_block_sizes] = {1, 3, 4, 7, 70};
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(3870);
+  for (int i = 0; i < num_sizes; ++i) {
+    const int size = sizes[i];
+    std::vector<double> spd_matrix(size*size);
+    BuildRandomSPDMatrix(size, &uniform_generator, spd_matrix.data());
+    ModifyMatrixDiagonal(size, static_cast<double>(size), spd_matrix.data());
+
+    std::vector<double> cholesky_reference(spd_matrix);
+    if (ComputeCholeskyFactorL(size, cholesky_reference.data()) != 0) {
+      ++total_errors;
+    }
+    ZeroUpperTriangle(size, cholesky_reference.data());
+
+    for (int j = 0; j < num_block_sizes; ++j) {
+      const int point_block_size = point_block_sizes[j];
+      std::vector<double> cholesky_factor(spd_matrix);
+      for (int col = 0; col < size; ++col) {
+        for (int row = 0; row < col; ++row) {
+          cholesky_factor[col*size + row] = -1.0;  // sentinel: must not be read or written
+        }
+      }
+      if (ComputeBlockCholeskyFactorL(size, point_block_size, cholesky_factor.data()) != 0) {
+        ++total_errors;
+      }
+      for (int col = 0; col < size; ++col) {
+        for (int row = 0; row < col; ++row) {
+          if (cholesky_factor[col*size + row] != -1.0) {
+            ++total_errors;
+          }
+        }
+      }
+      ZeroUpperTriangle(size, cholesky_factor.data());
+      const double factor_tolerance = point_block_size == 1 ? 0.0 : tolerance*size;
+      if (!CheckMatrixNormWithin(cholesky_factor.data(), cholesky_reference.data(), size, size,
+                                 factor_tolerance*VectorNorm(cholesky_reference.data(), size*size))) {
+        ++total_errors;
+      }
+
+      // make the leading minor of size bad_index+1 singular; both must stop there
+      const int bad_index = (2*size)/3;
+      std::vector<double> singular_matrix(spd_matrix);
+      singular_matrix[bad_index*size + bad_index] = -1.0;
+      std::vector<double> singular_matrix_reference(singular_matrix);
+      const int info_reference = ComputeCholeskyFactorL(size, singular_matrix_reference.data());
+      const int info = ComputeBlockCholeskyFactorL(size, point_block_size, singular_matrix.data());
+      if (info_reference != bad_index + 1 || info != info_reference) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Test that the parallel blocked cholesky (matrices of size >= 512, see ComputeCholeskyFactorL()) computes exactly the
+  factor that it computes on one thread, for point blocks of 1 and 3, and that the factor reproduces ``A``.
+
+  \return
+    number of cases where the parallel and serial factors differ or ``L * L^T != A``
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestParallelCholesky() {
+  int total_errors = 0;
+
+  const int size = 700;
+  const int num_block_sizes = 2;
+  const int point_block_sizes[num_block_sizes] = {1, 3};
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(2718);
+  std::vector<double> spd_matrix(size*size);
+  BuildRandomSPDMatrix(size, &uniform_generator, spd_matrix.data());
+  ModifyMatrixDiagonal(size, static_cast<double>(size), spd_matrix.data());
+
+  const int max_num_threads = omp_get_max_threads();
+  for (int j = 0; j < num_block_sizes; ++j) {
+    std::vector<double> cholesky_serial(spd_matrix);
+    omp_set_num_threads(1);
+    const int info_serial = ComputeBlockCholeskyFactorL(size, point_block_sizes[j], cholesky_serial.data());
+    omp_set_num_threads(max_num_threads);
+    std::vector<double> cholesky_parallel(spd_matrix);
+    const int info_parallel = ComputeBlockCholeskyFactorL(size, point_block_sizes[j], cholesky_parallel.data());
+    if (info_serial != 0 || info_parallel != 0) {
+      ++total_errors;
+    }
+    ZeroUpperTriangle(size, cholesky_serial.data());
+    ZeroUpperTriangle(size, cholesky_parallel.data());
+    if (!CheckMatrixNormWithin(cholesky_parallel.data(), cholesky_serial.data(), size, size, 0.0)) {
+      ++total_errors;
+    }
+
+    // L * L^T = A
+    std::vector<double> cholesky_transpose(size*size);
+    MatrixTranspose(cholesky_parallel.data(), size, size, cholesky_transpose.data());
+    std::vector<double> product(size*size);
+    GeneralMatrixMatrixMultiply(cholesky_parallel.data(), 'N', cholesky_transpose.data(), 1.0, 0.0, size, size, size,
+                                product.data());
+    if (!CheckMatrixNormWithin(product.data(), spd_matrix.data(), size, size,
+                               tolerance*size*VectorNorm(spd_matrix.data(), size*size))) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Test ComputeCholeskyFactorLWithJitter().
+
+  1. on an SPD matrix, no jitter is used and the factor is bitwise ComputeBlockCholeskyFactorL's.
+  2. on rank-deficient (PSD) matrices ``B * B^T``, on both the small-matrix kernel and the blocked path, the
+     factorization succeeds with some jitter in ``(0, max_relative_jitter * max_i A_ii]`` and
+     ``L * L^T - A`` is diagonal with entries in ``[0, jitter]`` (up to roundoff).
+  3. an indefinite matrix (``-I``) exhausts the jitter budget and reports the failed pivot.
+
+  \return
+    number of cases where the jittered factorization is wrong
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestCholeskyFactorLWithJitter() {
+  int total_errors = 0;
+
+  const int num_sizes = 3;
+  const int sizes[num_sizes] = {20, 77, 150};
+  const int num_block_sizes = 2;
+  const int point_block_sizes[num_block_sizes] = {1, 3};
+  const double tolerance = 1.0e-12;
+
+  UniformRandomGenerator uniform_generator(6512);
+  boost::uniform_real<double> uniform_double(-1.0, 1.0);
+  for (int i = 0; i < num_sizes; ++i) {
+    const int size = sizes[i];
+    for (int j = 0; j < num_block_sizes; ++j) {
+      const int point_block_size = point_block_sizes[j];
+
+      // SPD: no jitter, same factor as the un-jittered routine
+      std::vector<double> spd_matrix(size*size);
+      BuildRandomSPDMatrix(size, &uniform_generator, spd_matrix.data());
+      ModifyMatrixDiagonal(size, static_cast<double>(size), spd_matrix.data());
+      std::vector<double> cholesky_reference(spd_matrix);
+      if (ComputeBlockCholeskyFactorL(size, point_block_size, cholesky_reference.data()) != 0) {
+        ++total_errors;
+      }
+      std::vector<double> cholesky_factor(spd_matrix);
+      CholeskyJitter jitter = {1.0e-10, 1.0e-6, -1.0, -1};
+      if (ComputeCholeskyFactorLWithJitter(size, point_block_size, cholesky_factor.data(), &jitter) != 0 ||
+          jitter.jitter != 0.0 || jitter.num_jittered_pivots != 0 || cholesky_factor != cholesky_reference) {
+        ++total_errors;
+      }
+
+      // PSD with rank size/2: A = B * B^T, B is size x rank
+      const int rank = size/2;
+      std::vector<double> factor_b(size*rank);
+      for (auto& entry : factor_b) {
+        entry = uniform_double(uniform_generator.engine);
+      }
+      std::vector<double> psd_matrix(size*size, 0.0);
+      for (int col = 0; col < size; ++col) {
+        for (int row = 0; row < size; ++row) {
+          for (int k = 0; k < rank; ++k) {
+            psd_matrix[col*size + row] += factor_b[k*size + row]*factor_b[k*size + col];
+          }
+        }
+      }
+      double scale = 0.0;
+      for (int k = 0; k < size; ++k) {
+        scale = std::fmax(scale, psd_matrix[k*size + k]);
+      }
+
+      std::vector<double> jittered_factor(psd_matrix);
+      jitter = {1.0e-10, 1.0e-4, -1.0, -1};
+      if (ComputeCholeskyFactorLWithJitter(size, point_block_size, jittered_factor.data(), &jitter) != 0) {
+        ++total_errors;
+        continue;
+      }
+      if (!(jitter.jitter > 0.0 && jitter.jitter <= jitter.max_relative_jitter*scale*(1.0 + tolerance)) ||
+          jitter.num_jittered_pivots <= 0) {
+        ++total_errors;
+      }
+      ZeroUpperTriangle(size, jittered_factor.data());
+      for (int col = 0; col < size; ++col) {
+        for (int row = col; row < size; ++row) {
+          double product = 0.0;
+          for (int k = 0; k <= col; ++k) {
+            product += jittered_factor[k*size + row]*jittered_factor[k*size + col];
+          }
+          const double perturbation = product - psd_matrix[col*size + row];
+          const double roundoff = tolerance*scale*size;
+          if (row == col) {
+            if (perturbation < -roundoff || perturbation > jitter.jitter + roundoff) {
+              ++total_errors;
+            }
+          } else if (std::fabs(perturbation) > roundoff) {
+            ++total_errors;
+          }
+        }
+      }
+
+      // indefinite: -I cannot be fixed by a small diagonal shift
+      std::vector<double> indefinite_matrix(size*size, 0.0);
+      ModifyMatrixDiagonal(size, -1.0, indefinite_matrix.data());
+      jitter = {1.0e-10, 1.0e-6, -1.0, -1};
+      if (ComputeCholeskyFactorLWithJitter(size, point_block_size, indefinite_matrix.data(), &jitter) != 1) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks CholeskyFactorLAdjoint() against forward-mode differentiation of the cholesky factorization: for a random
+  symmetric direction ``E``, ``dL = L * \Phi(L^{-1} * E * L^{-T})``, and the adjoint must satisfy
+  ``<\bar{L}, dL> = <\bar{A}, E>``.  Also checks that ``\bar{A}`` is symmetric and that the (ignored) upper triangle of
+  the input does not matter.
+
+  \return
+    number of cases where the adjoint is inaccurate
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestCholeskyFactorLAdjoint() {
+  int total_errors = 0;
+
+  const int num_sizes = 4;
+  const int sizes[num_sizes] = {1, 4, 11, 30};
+  const double tolerance = 1.0e-12;
+
+  UniformRandomGenerator uniform_generator(8103);
+  for (int i = 0; i < num_sizes; ++i) {
+    const int size = sizes[i];
+    std::vector<double> chol(size*size);
+    BuildRandomSPDMatrix(size, &uniform_generator, chol.data());
+    ModifyMatrixDiagonal(size, static_cast<double>(size), chol.data());
+    if (ComputeCholeskyFactorL(size, chol.data()) != 0) {
+      ++total_errors;
+      continue;
+    }
+
+    std::vector<double> chol_adjoint(size*size);
+    BuildRandomVector(size*size, -1.0, 1.0, &uniform_generator, chol_adjoint.data());
+    std::vector<double> adjoint(chol_adjoint);
+    CholeskyFactorLAdjoint(size, chol.data(), adjoint.data());
+
+    // upper triangle of the input is ignored
+    std::vector<double> adjoint_lower(chol_adjoint);
+    ZeroUpperTriangle(size, adjoint_lower.data());
+    CholeskyFactorLAdjoint(size, chol.data(), adjoint_lower.data());
+    if (adjoint_lower != adjoint) {
+      ++total_errors;
+    }
+
+    for (int col = 0; col < size; ++col) {
+      for (int row = col + 1; row < size; ++row) {
+        if (adjoint[col*size + row] != adjoint[row*size + col]) {
+          ++total_errors;
+        }
+      }
+    }
+
+    // forward mode: dL = L * \Phi(L^{-1} * E * L^{-T}), E symmetric
+    std::vector<double> direction(size*size);
+    BuildRandomSymmetricMatrix(size, -1.0, 1.0, &uniform_generator, direction.data());
+    std::vector<double> grad_chol(direction);
+    TriangularMatrixMatrixSolve(chol.data(), 'N', size, size, size, grad_chol.data());
+    std::vector<double> grad_chol_transpose(size*size);
+    MatrixTranspose(grad_chol.data(), size, size, grad_chol_transpose.data());
+    TriangularMatrixMatrixSolve(chol.data(), 'N', size, size, size, grad_chol_transpose.data());
+    ZeroUpperTriangle(size, grad_chol_transpose.data());
+    for (int k = 0; k < size; ++k) {
+      grad_chol_transpose[k*size + k] *= 0.5;
+    }
+    TriangularMatrixMatrixMultiply(chol.data(), 'N', size, size, size, grad_chol_transpose.data());
+
+    double forward_derivative = 0.0;
+    double reverse_derivative = 0.0;
+    double scale = 0.0;
+    for (int col = 0; col < size; ++col) {
+      for (int row = col; row < size; ++row) {
+        forward_derivative += chol_adjoint[col*size + row]*grad_chol_transpose[col*size + row];
+        scale += std::fabs(chol_adjoint[col*size + row]*grad_chol_transpose[col*size + row]);
+      }
+      for (int row = 0; row < size; ++row) {
+        reverse_derivative += adjoint[col*size + row]*direction[col*size + row];
+      }
+    }
+    if (std::fabs(reverse_derivative - forward_derivative) > tolerance*scale) {
+      OL_ERROR_PRINTF("size %d: reverse %.18E, forward %.18E\n", size, reverse_derivative, forward_derivative);
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the packed lower-triangular kernels against their square counterparts: PackLowerTriangle() and
+  UnpackLowerTriangle() round trip the lower triangle, and the packed solves and multiplies match
+  TriangularMatrixVectorSolve(), TriangularMatrixMatrixSolve(), TriangularMatrixVectorMultiply(), and the cholesky
+  solves for both ``trans`` values.
+
+  \return
+    number of cases where a packed kernel differs from the square one
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestPackedTriangularMatrix() {
+  int total_errors = 0;
+
+  const int num_sizes = 4;
+  const int sizes[num_sizes] = {1, 3, 10, 33};
+  const int num_rhs = 5;
+  const double tolerance = 1.0e-13;
+  const char transposes[2] = {'N', 'T'};
+
+  UniformRandomGenerator uniform_generator(4019);
+  for (int i = 0; i < num_sizes; ++i) {
+    const int size = sizes[i];
+    std::vector<double> chol(size*size);
+    BuildRandomSPDMatrix(size, &uniform_generator, chol.data());
+    ModifyMatrixDiagonal(size, static_cast<double>(size), chol.data());
+    if (ComputeCholeskyFactorL(size, chol.data()) != 0) {
+      ++total_errors;
+      continue;
+    }
+    ZeroUpperTriangle(size, chol.data());
+
+    std::vector<double> packed(PackedTriangleSize(size));
+    PackLowerTriangle(size, chol.data(), packed.data());
+    std::vector<double> unpacked(size*size, -1.0);
+    UnpackLowerTriangle(size, packed.data(), unpacked.data());
+    if (unpacked != chol) {
+      ++total_errors;
+    }
+
+    std::vector<double> rhs(size*num_rhs);
+    BuildRandomVector(size*num_rhs, -1.0, 1.0, &uniform_generator, rhs.data());
+    for (const char trans : transposes) {
+      std::vector<double> x_square(rhs.begin(), rhs.begin() + size);
+      std::vector<double> x_packed(x_square);
+      TriangularMatrixVectorSolve(chol.data(), trans, size, size, x_square.data());
+      PackedTriangularMatrixVectorSolve(packed.data(), trans, size, x_packed.data());
+      total_errors += CheckMatrixNormWithin(x_packed.data(), x_square.data(), size, 1, tolerance) ? 0 : 1;
+
+      x_square.assign(rhs.begin(), rhs.begin() + size);
+      x_packed = x_square;
+      TriangularMatrixVectorMultiply(chol.data(), trans, size, x_square.data());
+      PackedTriangularMatrixVectorMultiply(packed.data(), trans, size, x_packed.data());
+      total_errors += CheckMatrixNormWithin(x_packed.data(), x_square.data(), size, 1, tolerance) ? 0 : 1;
+
+      std::vector<double> X_square(rhs);
+      std::vector<double> X_packed(rhs);
+      TriangularMatrixMatrixSolve(chol.data(), trans, size, num_rhs, size, X_square.data());
+      PackedTriangularMatrixMatrixSolve(packed.data(), trans, size, num_rhs, X_packed.data());
+      total_errors += CheckMatrixNormWithin(X_packed.data(), X_square.data(), size, num_rhs, tolerance) ? 0 : 1;
+    }
+
+    std::vector<double> x_square(rhs.begin(), rhs.begin() + size);
+    std::vector<double> x_packed(x_square);
+    CholeskyFactorLMatrixVectorSolve(chol.data(), size, x_square.data());
+    PackedCholeskyFactorLMatrixVectorSolve(packed.data(), size, x_packed.data());
+    total_errors += CheckMatrixNormWithin(x_packed.data(), x_square.data(), size, 1, tolerance) ? 0 : 1;
+
+    std::vector<double> X_square(rhs);
+    std::vector<double> X_packed(rhs);
+    CholeskyFactorLMatrixMatrixSolve(chol.data(), size, num_rhs, X_square.data());
+    PackedCholeskyFactorLMatrixMatrixSolve(packed.data(), size, num_rhs, X_packed.data());
+    total_errors += CheckMatrixNormWithin(X_packed.data(), X_square.data(), size, num_rhs, tolerance) ? 0 : 1;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks GatherSymmetricSubmatrix() and ScatterSubmatrixCholeskyFactor(): factoring the gathered submatrix and
+  scattering the factor must match the cholesky factor of the full matrix with the rows and columns off ``indices``
+  replaced by a decoupled diagonal.
+
+  \return
+    number of cases where the scattered factor differs from the full one
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestSubmatrixCholeskyFactor() {
+  int total_errors = 0;
+
+  const int size = 10;
+  const std::vector<int> indices = {0, 2, 3, 7, 9};
+  const int num_indices = indices.size();
+  const double decoupled_diagonal = 3.0;
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(5107);
+  std::vector<double> A(size*size);
+  BuildRandomSPDMatrix(size, &uniform_generator, A.data());
+  ModifyMatrixDiagonal(size, static_cast<double>(size), A.data());
+
+  std::vector<double> A_sub(num_indices*num_indices);
+  GatherSymmetricSubmatrix(size, A.data(), indices.data(), num_indices, A_sub.data());
+  for (int j = 0; j < num_indices; ++j) {
+    for (int i = j; i < num_indices; ++i) {
+      if (A_sub[j*num_indices + i] != A[indices[j]*size + indices[i]]) {
+        ++total_errors;
+      }
+    }
+  }
+  if (ComputeCholeskyFactorL(num_indices, A_sub.data()) != 0) {
+    return total_errors + 1;
+  }
+  std::vector<double> chol(size*size, -1.0);
+  ScatterSubmatrixCholeskyFactor(size, A_sub.data(), indices.data(), num_indices, decoupled_diagonal, chol.data());
+
+  std::vector<double> chol_truth(size*size, 0.0);
+  for (int i = 0; i < size; ++i) {
+    chol_truth[i*size + i] = Square(decoupled_diagonal);
+  }
+  for (int j = 0; j < num_indices; ++j) {
+    for (int i = 0; i < num_indices; ++i) {
+      chol_truth[indices[j]*size + indices[i]] = A[indices[j]*size + indices[i]];
+    }
+  }
+  if (ComputeCholeskyFactorL(size, chol_truth.data()) != 0) {
+    return total_errors + 1;
+  }
+  ZeroUpperTriangle(size, chol_truth.data());
+  if (!CheckMatrixNormWithin(chol.data(), chol_truth.data(), size, size, tolerance)) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks AlignedAllocator: small and empty-then-grown AlignedVector storage is kAlignment-aligned, storage of at least
+  kHugePageThreshold bytes is huge-page aligned, and contents survive growth, copies, and swaps.
+
+  \return
+    number of misaligned or corrupted buffers
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestAlignedAllocator() {
+  int total_errors = 0;
+  using Allocator = AlignedAllocator<double>;
+  auto offset = [](double const * data, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(data) % alignment;
+  };
+
+  const int num_sizes = 4;
+  const std::size_t sizes[num_sizes] = {1, 7, 1000, Allocator::kHugePageThreshold/sizeof(double) + 3};
+  for (int i = 0; i < num_sizes; ++i) {
+    AlignedVector<double> vector(sizes[i]);
+    for (std::size_t j = 0; j < vector.size(); ++j) {
+      vector[j] = static_cast<double>(j);
+    }
+    const std::size_t alignment = sizes[i]*sizeof(double) >= Allocator::kHugePageThreshold ?
+        Allocator::kHugePageSize : Allocator::kAlignment;
+    if (offset(vector.data(), alignment) != 0) {
+      OL_ERROR_PRINTF("size %zu: storage offset %zu from %zu-byte alignment\n", sizes[i],
+                      static_cast<std::size_t>(offset(vector.data(), alignment)), alignment);
+      ++total_errors;
+    }
+
+    AlignedVector<double> grown;
+    for (std::size_t j = 0; j < sizes[i]; ++j) {
+      grown.push_back(vector[j]);
+      if (offset(grown.data(), Allocator::kAlignment) != 0) {
+        ++total_errors;
+        break;
+      }
+    }
+    AlignedVector<double> copy(grown);
+    AlignedVector<double> swapped;
+    swapped.swap(copy);
+    if (grown != vector || swapped != vector || !copy.empty()) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks SymmetricEigendecomposition() on random symmetric (indefinite) matrices and on the (ill-conditioned) prolate
+  matrix: ``Q^T * Q = I`` and ``A * Q = Q * \Lambda``.
+
+  \return
+    number of cases where the decomposition is inaccurate
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestSymmetricEigendecomposition() {
+  int total_errors = 0;
+  const int num_sizes = 4;
+  const int sizes[num_sizes] = {1, 2, 9, 31};
+  const double tolerance = 1.0e-13;
+
+  UniformRandomGenerator uniform_generator(61523);
+  for (int i = 0; i < 2*num_sizes; ++i) {
+    const int size = sizes[i % num_sizes];
+    std::vector<double> matrix(Square(size));
+    if (i < num_sizes) {
+      BuildRandomSymmetricMatrix(size, -1.0, 1.0, &uniform_generator, matrix.data());
+    } else {
+      BuildProlateMatrix(0.3, size, matrix.data());
+    }
+
+    std::vector<double> decomposed(matrix), eigenvectors(Square(size)), eigenvalues(size);
+    SymmetricEigendecomposition(size, decomposed.data(), eigenvectors.data(), eigenvalues.data());
+
+    std::vector<double> gram(Square(size)), identity(Square(size));
+    GeneralMatrixMatrixMultiply(eigenvectors.data(), 'T', eigenvectors.data(), 1.0, 0.0, size, size, size, gram.data());
+    BuildIdentityMatrix(size, identity.data());
+    if (!CheckMatrixNormWithin(gram.data(), identity.data(), size, size, tolerance*size)) {
+      ++total_errors;
+    }
+
+    std::vector<double> product(Square(size)), scaled_eigenvectors(eigenvectors);
+    GeneralMatrixMatrixMultiply(matrix.data(), 'N', eigenvectors.data(), 1.0, 0.0, size, size, size, product.data());
+    for (int j = 0; j < size; ++j) {
+      VectorScale(size, eigenvalues[j], scaled_eigenvectors.data() + j*size);
+    }
+    if (!CheckMatrixNormWithin(product.data(), scaled_eigenvectors.data(), size, size,
+                               tolerance*size*VectorNorm(matrix.data(), Square(size)))) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks KroneckerMatrixMatrixMultiply() (and its transpose) against multiplying by the explicitly formed Kronecker
+  product of three random factors.
+
+  \return
+    number of entries where the two products differ
+\endrst*/
+OL_WARN_UNUSED_RESULT int TestKroneckerMatrixMatrixMultiply() {
+  int total_errors = 0;
+  const int num_factors = 3;
+  const int factor_sizes[num_factors] = {3, 1, 4};
+  const int num_rows = 12;
+  const int num_cols = 5;
+  const int factor_offsets[num_factors] = {0, 9, 10};
+  const double tolerance = 1.0e-14;
+
+  UniformRandomGenerator uniform_generator(9181);
+  std::vector<double> factors(26);
+  BuildRandomVector(factors.size(), -1.0, 1.0, &uniform_generator, factors.data());
+  std::vector<double> matrix(num_rows*num_cols);
+  BuildRandomVector(matrix.size(), -1.0, 1.0, &uniform_generator, matrix.data());
+
+  // kronecker[(i_0, i_1, i_2), (j_0, j_1, j_2)] = \prod_d A_d(i_d, j_d), i_0 fastest
+  std::vector<double> kronecker(Square(num_rows));
+  for (int col = 0; col < num_rows; ++col) {
+    for (int row = 0; row < num_rows; ++row) {
+      double entry = 1.0;
+      for (int d = 0, row_rest = row, col_rest = col; d < num_factors; ++d) {
+        const int size = factor_sizes[d];
+        entry *= factors[factor_offsets[d] + (col_rest % size)*size + row_rest % size];
+        row_rest /= size;
+        col_rest /= size;
+      }
+      kronecker[col*num_rows + row] = entry;
+    }
+  }
+
+  std::vector<double> scratch(num_rows*num_cols), product(num_rows*num_cols), product_truth(num_rows*num_cols);
+  const char transposes[2] = {'N', 'T'};
+  for (char trans : transposes) {
+    product = matrix;
+    KroneckerMatrixMatrixMultiply(factors.data(), factor_sizes, num_factors, trans, num_cols, product.data(),
+                                  scratch.data());
+    GeneralMatrixMatrixMultiply(kronecker.data(), trans, matrix.data(), 1.0, 0.0, num_rows, num_rows, num_cols,
+                                product_truth.data());
+    for (int i = 0; i < num_rows*num_cols; ++i) {
+      if (!CheckDoubleWithinRelative(product[i], product_truth[i], tolerance)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
 }  // end unnamed namespace
 
 int RunLinearAlgebraTests() {
@@ -1297,6 +2016,54 @@ int RunLinearAlgebraTests() {
     OL_PARTIAL_FAILURE_PRINTF("dgemm errors = %d\n", current_errors);
   }
 
+  current_errors = TestBlockedLinearAlgebra();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("blocked dpotrf, dtrsm, dgemm errors = %d\n", current_errors);
+  }
+
+  current_errors = TestBlockCholesky();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("point-block cholesky errors = %d\n", current_errors);
+  }
+
+  current_errors = TestParallelCholesky();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("parallel cholesky errors = %d\n", current_errors);
+  }
+
+  current_errors = TestCholeskyFactorLWithJitter();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("jittered cholesky errors = %d\n", current_errors);
+  }
+
+  current_errors = TestCholeskyFactorLAdjoint();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("cholesky adjoint errors = %d\n", current_errors);
+  }
+
+  current_errors = TestAlignedAllocator();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("aligned allocator errors = %d\n", current_errors);
+  }
+
+  current_errors = TestPackedTriangularMatrix();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("packed triangular matrix errors = %d\n", current_errors);
+  }
+
+  current_errors = TestSubmatrixCholeskyFactor();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("submatrix cholesky factor errors = %d\n", current_errors);
+  }
+
   current_errors = TestSpecialMatrixVectorMultiply();
   total_errors += current_errors;
   if (current_errors != 0) {
@@ -1321,6 +2088,18 @@ int RunLinearAlgebraTests() {
     OL_PARTIAL_FAILURE_PRINTF("PLU Solve errors = %d\n", current_errors);
   }
 
+  current_errors = TestSymmetricEigendecomposition();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("symmetric eigendecomposition errors = %d\n", current_errors);
+  }
+
+  current_errors = TestKroneckerMatrixMatrixMultiply();
+  total_errors += current_errors;
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("kronecker product multiply errors = %d\n", current_errors);
+  }
+
   return total_errors;
 }
 
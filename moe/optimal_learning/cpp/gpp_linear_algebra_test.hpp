@@ -204,6 +204,7 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT bool CheckMatrixIsSymmetric(double con
   * ``y = A * x``, ``A = A^T``
   * ``y = A * x``, ``A`` lower triangular
   * computing `A^T``
+  * blocked (large-size) cholesky, triangular solve, and ``C = A * B``
 
   \return
     number of test failures: 0 if all is working well.
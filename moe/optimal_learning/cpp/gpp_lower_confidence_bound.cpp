@@ -0,0 +1,324 @@
+/*!
+  \file gpp_lower_confidence_bound.cpp
+  \rst
+  Implementation of the LCB evaluators, their states, and the multistart LCB optimizers; see
+  gpp_lower_confidence_bound.hpp for the math.  Both evaluators share the per-GP value/gradient code (at the top of
+  this file) and the optimizers share MultistartLowerConfidenceBoundOptimization().
+\endrst*/
+
+#include "gpp_lower_confidence_bound.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  \param
+    :gaussian_process: GP whose LCB is computed
+    :exploration_weight: ``\beta``
+    :points_to_sample_state[1]: a FULLY CONFIGURED state of ``gaussian_process`` at ONE point
+  \output
+    :points_to_sample_state[1]: state with temporary storage modified
+  \return
+    ``\mu(x) - \beta \sigma(x)`` at the state's point
+\endrst*/
+double LowerConfidenceBoundOfState(const GaussianProcess& gaussian_process, double exploration_weight,
+                                   PointsToSampleState * points_to_sample_state) {
+  double to_sample_mean;
+  double to_sample_var;
+  gaussian_process.ComputeMeanOfPoints(*points_to_sample_state, &to_sample_mean);
+  gaussian_process.ComputeVarianceOfPoints(points_to_sample_state, points_to_sample_state->gradients.data(),
+                                           points_to_sample_state->num_gradients_to_sample, &to_sample_var);
+  to_sample_var = std::fmax(LowerConfidenceBoundEvaluator::kMinimumVarianceLCB, to_sample_var);
+  return to_sample_mean - exploration_weight*std::sqrt(to_sample_var);
+}
+
+/*!\rst
+  Adds ``scale * \nabla (\mu(x) - \beta \sigma(x))`` to ``grad_LCB``.
+
+  \param
+    :gaussian_process: GP whose LCB is differentiated
+    :exploration_weight: ``\beta``
+    :scale: factor applied to the gradient before accumulating it
+    :points_to_sample_state[1]: a FULLY CONFIGURED state of ``gaussian_process`` at ONE point, with ``num_derivatives = 1``
+    :grad_mu[dim]: scratch space
+    :grad_var[dim]: scratch space
+    :grad_LCB[dim]: running sum
+  \output
+    :points_to_sample_state[1]: state with temporary storage modified
+    :grad_LCB[dim]: running sum plus this GP's scaled gradient
+\endrst*/
+void AccumulateGradLowerConfidenceBoundOfState(const GaussianProcess& gaussian_process, double exploration_weight,
+                                               double scale, PointsToSampleState * points_to_sample_state,
+                                               double * restrict grad_mu, double * restrict grad_var,
+                                               double * restrict grad_LCB) {
+  double to_sample_var;
+  gaussian_process.ComputeVarianceOfPoints(points_to_sample_state, points_to_sample_state->gradients.data(),
+                                           points_to_sample_state->num_gradients_to_sample, &to_sample_var);
+  const double sigma = std::sqrt(std::fmax(LowerConfidenceBoundEvaluator::kMinimumVarianceLCB, to_sample_var));
+  gaussian_process.ComputeGradMeanOfPoints(*points_to_sample_state, grad_mu);
+  gaussian_process.ComputeGradVarianceOfPoints(points_to_sample_state, grad_var);
+
+  // d sigma = d var / (2 sigma)
+  const double grad_var_scale = 0.5*exploration_weight/sigma;
+  for (int d = 0; d < gaussian_process.dim(); ++d) {
+    grad_LCB[d] += scale*(grad_mu[d] - grad_var_scale*grad_var[d]);
+  }
+}
+
+/*!\rst
+  Shared body of ComputeLCBOptimalPointToSample() and ComputeLCBMCMCOptimalPointToSample(), for either evaluator.
+  The best screened start is kept unless gradient descent improves on it.
+\endrst*/
+template <typename LowerConfidenceBoundEvaluator, typename DomainType>
+void MultistartLowerConfidenceBoundOptimization(const LowerConfidenceBoundEvaluator& lcb_evaluator,
+                                                const GradientDescentParameters& optimizer_parameters,
+                                                const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                                int num_refined_starts, bool * restrict found_flag,
+                                                UniformRandomGenerator * uniform_generator,
+                                                double * restrict best_next_point) {
+  const int dim = lcb_evaluator.dim();
+  std::vector<double> starting_points(dim*optimizer_parameters.num_multistarts);
+  // GenerateUniformPointsInDomain() is allowed to return fewer than the requested number of multistarts
+  const int num_multistarts = domain.GenerateUniformPointsInDomain(optimizer_parameters.num_multistarts,
+                                                                   uniform_generator, starting_points.data());
+  if (unlikely(num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
+  }
+
+  using StateType = typename LowerConfidenceBoundEvaluator::StateType;
+  bool configure_for_gradients = true;
+  std::vector<StateType> lcb_state_vector;
+  lcb_state_vector.reserve(thread_schedule.max_num_threads);
+  for (int i = 0; i < thread_schedule.max_num_threads; ++i) {
+    lcb_state_vector.emplace_back(lcb_evaluator, starting_points.data(), configure_for_gradients);
+  }
+
+  // screen every start on all threads; descend from the best few
+  const int k = std::max(1, std::min(num_refined_starts, num_multistarts));
+  std::vector<double> refined_starts(k*dim);
+  SelectBestStartPoints(lcb_evaluator, starting_points.data(), num_multistarts, k, thread_schedule.max_num_threads,
+                        lcb_state_vector.data(), refined_starts.data());
+
+  lcb_state_vector[0].SetCurrentPoint(lcb_evaluator, refined_starts.data());
+  OptimizationIOContainer io_container(dim, lcb_evaluator.ComputeObjectiveFunction(lcb_state_vector.data()),
+                                       refined_starts.data());
+
+  GradientDescentOptimizer<LowerConfidenceBoundEvaluator, DomainType> gd_opt;
+  MultistartOptimizer<GradientDescentOptimizer<LowerConfidenceBoundEvaluator, DomainType> > multistart_optimizer;
+  multistart_optimizer.MultistartOptimize(gd_opt, lcb_evaluator, optimizer_parameters, domain, thread_schedule,
+                                          refined_starts.data(), k, lcb_state_vector.data(), nullptr, &io_container);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+}
+
+}  // end unnamed namespace
+
+LowerConfidenceBoundEvaluator::LowerConfidenceBoundEvaluator(const GaussianProcess& gaussian_process_in,
+                                                             double exploration_weight)
+    : dim_(gaussian_process_in.dim()),
+      exploration_weight_(exploration_weight),
+      gaussian_process_(&gaussian_process_in) {
+}
+
+void LowerConfidenceBoundEvaluator::ComputeGradObjectiveFunction(StateType * lcb_state,
+                                                                 double * restrict grad_objective) const {
+  ComputeGradLowerConfidenceBound(lcb_state, grad_objective);
+  for (int d = 0; d < dim_; ++d) {
+    grad_objective[d] = -grad_objective[d];
+  }
+}
+
+double LowerConfidenceBoundEvaluator::ComputeLowerConfidenceBound(StateType * lcb_state) const {
+  return LowerConfidenceBoundOfState(*gaussian_process_, exploration_weight_, &lcb_state->points_to_sample_state);
+}
+
+void LowerConfidenceBoundEvaluator::ComputeGradLowerConfidenceBound(StateType * lcb_state,
+                                                                    double * restrict grad_LCB) const {
+  std::fill(grad_LCB, grad_LCB + dim_, 0.0);
+  AccumulateGradLowerConfidenceBoundOfState(*gaussian_process_, exploration_weight_, 1.0,
+                                            &lcb_state->points_to_sample_state, lcb_state->grad_mu.data(),
+                                            lcb_state->grad_var.data(), grad_LCB);
+}
+
+void LowerConfidenceBoundEvaluator::ComputeLowerConfidenceBoundOfPoints(
+    double const * restrict points, int num_points, int max_num_threads,
+    double * restrict lower_confidence_bound) const {
+  // lower_confidence_bound holds the GP means until they are shifted by the standard deviations
+  std::vector<double> to_sample_var(num_points);
+  gaussian_process_->PredictMarginals(points, num_points, max_num_threads, lower_confidence_bound,
+                                      to_sample_var.data());
+  for (int i = 0; i < num_points; ++i) {
+    lower_confidence_bound[i] -= exploration_weight_*std::sqrt(std::fmax(kMinimumVarianceLCB, to_sample_var[i]));
+  }
+}
+
+LowerConfidenceBoundState::LowerConfidenceBoundState(const EvaluatorType& lcb_evaluator,
+                                                     double const * restrict point_to_sample_in,
+                                                     bool configure_for_gradients)
+    : dim(lcb_evaluator.dim()),
+      num_derivatives(configure_for_gradients ? num_to_sample : 0),
+      point_to_sample(point_to_sample_in, point_to_sample_in + dim),
+      points_to_sample_state(*lcb_evaluator.gaussian_process(), point_to_sample.data(), num_to_sample, nullptr, 0,
+                             num_derivatives),
+      grad_mu(dim*num_derivatives),
+      grad_var(dim*num_derivatives) {
+}
+
+LowerConfidenceBoundState::LowerConfidenceBoundState(LowerConfidenceBoundState&& OL_UNUSED(other)) = default;
+
+void LowerConfidenceBoundState::SetCurrentPoint(const EvaluatorType& lcb_evaluator,
+                                                double const * restrict point_to_sample_in) {
+  std::copy(point_to_sample_in, point_to_sample_in + dim, point_to_sample.data());
+  points_to_sample_state.SetupState(*lcb_evaluator.gaussian_process(), point_to_sample.data(), num_to_sample, 0,
+                                    num_derivatives);
+}
+
+void LowerConfidenceBoundState::SetupState(const EvaluatorType& lcb_evaluator,
+                                           double const * restrict point_to_sample_in) {
+  if (unlikely(dim != lcb_evaluator.dim())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, lcb_evaluator.dim());
+  }
+
+  SetCurrentPoint(lcb_evaluator, point_to_sample_in);
+}
+
+LowerConfidenceBoundMCMCEvaluator::LowerConfidenceBoundMCMCEvaluator(
+    const GaussianProcessMCMC& gaussian_process_mcmc_in, double exploration_weight)
+    : dim_(gaussian_process_mcmc_in.dim()),
+      num_mcmc_(gaussian_process_mcmc_in.num_mcmc()),
+      exploration_weight_(exploration_weight),
+      gaussian_process_mcmc_(&gaussian_process_mcmc_in) {
+}
+
+void LowerConfidenceBoundMCMCEvaluator::ComputeGradObjectiveFunction(StateType * lcb_state,
+                                                                     double * restrict grad_objective) const {
+  ComputeGradLowerConfidenceBound(lcb_state, grad_objective);
+  for (int d = 0; d < dim_; ++d) {
+    grad_objective[d] = -grad_objective[d];
+  }
+}
+
+double LowerConfidenceBoundMCMCEvaluator::ComputeLowerConfidenceBound(StateType * lcb_state) const {
+  double lower_confidence_bound = 0.0;
+  for (int k = 0; k < num_mcmc_; ++k) {
+    lower_confidence_bound += LowerConfidenceBoundOfState(gaussian_process_mcmc_->gaussian_process_lst[k],
+                                                          exploration_weight_,
+                                                          &lcb_state->points_to_sample_state_list[k]);
+  }
+  return lower_confidence_bound/static_cast<double>(num_mcmc_);
+}
+
+void LowerConfidenceBoundMCMCEvaluator::ComputeGradLowerConfidenceBound(StateType * lcb_state,
+                                                                        double * restrict grad_LCB) const {
+  std::fill(grad_LCB, grad_LCB + dim_, 0.0);
+  const double scale = 1.0/static_cast<double>(num_mcmc_);
+  for (int k = 0; k < num_mcmc_; ++k) {
+    AccumulateGradLowerConfidenceBoundOfState(gaussian_process_mcmc_->gaussian_process_lst[k], exploration_weight_,
+                                              scale, &lcb_state->points_to_sample_state_list[k],
+                                              lcb_state->grad_mu.data(), lcb_state->grad_var.data(), grad_LCB);
+  }
+}
+
+LowerConfidenceBoundMCMCState::LowerConfidenceBoundMCMCState(const EvaluatorType& lcb_evaluator,
+                                                             double const * restrict point_to_sample_in,
+                                                             bool configure_for_gradients)
+    : dim(lcb_evaluator.dim()),
+      num_derivatives(configure_for_gradients ? num_to_sample : 0),
+      point_to_sample(point_to_sample_in, point_to_sample_in + dim),
+      grad_mu(dim*num_derivatives),
+      grad_var(dim*num_derivatives) {
+  points_to_sample_state_list.reserve(lcb_evaluator.num_mcmc());
+  for (const auto& gaussian_process : lcb_evaluator.gaussian_process_mcmc()->gaussian_process_lst) {
+    points_to_sample_state_list.emplace_back(gaussian_process, point_to_sample.data(), num_to_sample, nullptr, 0,
+                                             num_derivatives);
+  }
+}
+
+LowerConfidenceBoundMCMCState::LowerConfidenceBoundMCMCState(LowerConfidenceBoundMCMCState&& OL_UNUSED(other)) = default;
+
+void LowerConfidenceBoundMCMCState::SetCurrentPoint(const EvaluatorType& lcb_evaluator,
+                                                    double const * restrict point_to_sample_in) {
+  std::copy(point_to_sample_in, point_to_sample_in + dim, point_to_sample.data());
+  for (int k = 0; k < lcb_evaluator.num_mcmc(); ++k) {
+    points_to_sample_state_list[k].SetupState(lcb_evaluator.gaussian_process_mcmc()->gaussian_process_lst[k],
+                                              point_to_sample.data(), num_to_sample, 0, num_derivatives);
+  }
+}
+
+void LowerConfidenceBoundMCMCState::SetupState(const EvaluatorType& lcb_evaluator,
+                                               double const * restrict point_to_sample_in) {
+  if (unlikely(dim != lcb_evaluator.dim())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, lcb_evaluator.dim());
+  }
+  if (unlikely(static_cast<int>(points_to_sample_state_list.size()) != lcb_evaluator.num_mcmc())) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's num_mcmc do not match!",
+                       static_cast<int>(points_to_sample_state_list.size()), lcb_evaluator.num_mcmc());
+  }
+
+  SetCurrentPoint(lcb_evaluator, point_to_sample_in);
+}
+
+template <typename DomainType>
+void ComputeLCBOptimalPointToSample(const GaussianProcess& gaussian_process, double exploration_weight,
+                                    const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                                    const ThreadSchedule& thread_schedule, int num_refined_starts,
+                                    bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
+                                    double * restrict best_next_point) {
+  OL_VERBOSE_PRINTF("Lower Confidence Bound Optimization via %s:\n", OL_CURRENT_FUNCTION_NAME);
+  LowerConfidenceBoundEvaluator lcb_evaluator(gaussian_process, exploration_weight);
+  MultistartLowerConfidenceBoundOptimization(lcb_evaluator, optimizer_parameters, domain, thread_schedule,
+                                             num_refined_starts, found_flag, uniform_generator, best_next_point);
+}
+
+template <typename DomainType>
+void ComputeLCBMCMCOptimalPointToSample(const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+                                        const GradientDescentParameters& optimizer_parameters,
+                                        const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                        int num_refined_starts, bool * restrict found_flag,
+                                        UniformRandomGenerator * uniform_generator,
+                                        double * restrict best_next_point) {
+  OL_VERBOSE_PRINTF("Lower Confidence Bound MCMC Optimization via %s:\n", OL_CURRENT_FUNCTION_NAME);
+  LowerConfidenceBoundMCMCEvaluator lcb_evaluator(gaussian_process_mcmc, exploration_weight);
+  MultistartLowerConfidenceBoundOptimization(lcb_evaluator, optimizer_parameters, domain, thread_schedule,
+                                             num_refined_starts, found_flag, uniform_generator, best_next_point);
+}
+
+// template explicit instantiation definitions, see gpp_common.hpp header comments, item 6
+template void ComputeLCBOptimalPointToSample(
+    const GaussianProcess& gaussian_process, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+template void ComputeLCBOptimalPointToSample(
+    const GaussianProcess& gaussian_process, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+template void ComputeLCBMCMCOptimalPointToSample(
+    const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+template void ComputeLCBMCMCOptimalPointToSample(
+    const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+
+}  // end namespace optimal_learning
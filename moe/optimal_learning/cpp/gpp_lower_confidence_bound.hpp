@@ -0,0 +1,458 @@
+/*!
+  \file gpp_lower_confidence_bound.hpp
+  \rst
+  1. OVERVIEW
+  2. HYPERPARAMETER AVERAGING
+  3. OPTIMIZATION
+  4. CITATIONS
+
+  **1. OVERVIEW**
+
+  The lower confidence bound (LCB) of a GaussianProcess at a point ``x`` is
+
+  ``LCB(x) = \mu(x) - \beta \sigma(x)``
+
+  where ``\mu`` and ``\sigma^2`` are the GP posterior mean and variance (ComputeMeanOfPoints(), ComputeVarianceOfPoints())
+  and ``\beta >= 0`` (``exploration_weight``) trades exploitation (small ``\beta``) against exploration.  Objective values
+  are MINIMIZED in optimal_learning, so the next point to sample minimizes LCB.  Unlike EI/KG, LCB needs no
+  ``best_so_far`` and no numerical integration: one mean and one variance per evaluation, and its gradient
+
+  ``\nabla LCB(x) = \nabla \mu(x) - \beta \nabla \sigma^2(x) / (2 \sigma(x))``
+
+  comes from ComputeGradMeanOfPoints() and ComputeGradVarianceOfPoints().  The optimizers in gpp_optimization.hpp
+  MAXIMIZE, so LowerConfidenceBoundEvaluator's objective is ``-LCB``.
+
+  **2. HYPERPARAMETER AVERAGING**
+
+  LowerConfidenceBoundMCMCEvaluator averages LCB over the GPs of a GaussianProcessMCMC (one per hyperparameter sample),
+  the same way the MCMC EI and KG evaluators average their acquisition functions:
+
+  ``LCB_{mcmc}(x) = (1/num_mcmc) \sum_k \mu_k(x) - \beta \sigma_k(x)``
+
+  **3. OPTIMIZATION**
+
+  ComputeLCBOptimalPointToSample() and ComputeLCBMCMCOptimalPointToSample() draw
+  ``optimizer_parameters.num_multistarts`` uniform starts in the domain, screen all of them in parallel
+  (SelectBestStartPoints()), and run multistart gradient descent (MultistartOptimizer) from the
+  ``num_refined_starts`` best, all in C++.
+
+  **4. CITATIONS**
+
+  a. Gaussian Process Optimization in the Bandit Setting: No Regret and Experimental Design.
+     Niranjan Srinivas, Andreas Krause, Sham Kakade, and Matthias Seeger.  ICML 2010.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+struct GaussianProcessMCMC;
+struct LowerConfidenceBoundState;
+
+/*!\rst
+  Evaluates ``LCB(x) = \mu(x) - \beta \sigma(x)`` of a GaussianProcess and its spatial gradient; see the file comments.
+  The objective function (for the maximizing optimizers) is ``-LCB``.
+
+  This class has no state and is meant to be accessed by const reference only.
+\endrst*/
+class LowerConfidenceBoundEvaluator final {
+ public:
+  using StateType = LowerConfidenceBoundState;
+
+  //! Minimum allowed variance in LCB and grad LCB; keeps ``\nabla \sigma^2/(2 \sigma)`` finite at the data when
+  //! noise = 0.  Same value as OnePotentialSampleExpectedImprovementEvaluator::kMinimumVarianceGradEI.
+  static constexpr double kMinimumVarianceLCB = 150.0*Square(GaussianProcess::kMinimumStdDev);
+
+  /*!\rst
+    Constructs a LowerConfidenceBoundEvaluator object.  All inputs are required; no default constructor nor
+    copy/assignment are allowed.
+
+    \param
+      :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived
+        quantities) that describes the underlying GP
+      :exploration_weight: ``\beta >= 0``, the number of standard deviations subtracted from the mean
+  \endrst*/
+  LowerConfidenceBoundEvaluator(const GaussianProcess& gaussian_process_in, double exploration_weight);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  double exploration_weight() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return exploration_weight_;
+  }
+
+  const GaussianProcess * gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return gaussian_process_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeLowerConfidenceBound(); returns ``-LCB``.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * lcb_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return -ComputeLowerConfidenceBound(lcb_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradLowerConfidenceBound(); computes ``-\nabla LCB``.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * lcb_state, double * restrict grad_objective) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \param
+      :lcb_state[1]: properly configured state object
+    \output
+      :lcb_state[1]: state with temporary storage modified
+    \return
+      ``LCB(x) = \mu(x) - \beta \sigma(x)`` at the state's ``point_to_sample``
+  \endrst*/
+  double ComputeLowerConfidenceBound(StateType * lcb_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    \param
+      :lcb_state[1]: properly configured state object (configured for gradients)
+    \output
+      :lcb_state[1]: state with temporary storage modified
+      :grad_LCB[dim]: gradient of LCB wrt the state's ``point_to_sample``
+  \endrst*/
+  void ComputeGradLowerConfidenceBound(StateType * lcb_state, double * restrict grad_LCB) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes LCB at each of a list of points, through GaussianProcess::PredictMarginals() (no states); for screening
+    large candidate sets.
+
+    \param
+      :points[dim][num_points]: points at which to evaluate LCB (duplicates are allowed)
+      :num_points: number of points
+      :max_num_threads: maximum number of threads to use, >= 1
+    \output
+      :lower_confidence_bound[num_points]: LCB at each point
+  \endrst*/
+  void ComputeLowerConfidenceBoundOfPoints(double const * restrict points, int num_points, int max_num_threads,
+                                           double * restrict lower_confidence_bound) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LowerConfidenceBoundEvaluator);
+
+ private:
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim_;
+  //! ``\beta``, the number of standard deviations subtracted from the mean
+  const double exploration_weight_;
+
+  //! pointer to gaussian process used in LCB computations
+  const GaussianProcess * gaussian_process_;
+};
+
+/*!\rst
+  State object for LowerConfidenceBoundEvaluator: the ONE ``point_to_sample`` being evaluated and the GP state at it.
+  See general comments on State structs in ``gpp_common.hpp``'s header docs.
+\endrst*/
+struct LowerConfidenceBoundState final {
+  using EvaluatorType = LowerConfidenceBoundEvaluator;
+
+  /*!\rst
+    Constructs a LowerConfidenceBoundState object for computing LCB (and its gradient) at ``point_to_sample``.
+
+    .. WARNING:: This object is invalidated if the associated lcb_evaluator is mutated.  SetupState() should be called to reset.
+
+    .. WARNING::
+         Using this object to compute gradients when ``configure_for_gradients`` := false results in UNDEFINED BEHAVIOR.
+
+    \param
+      :lcb_evaluator: evaluator object that specifies the parameters & GP for LCB evaluation
+      :point_to_sample[dim]: point at which to evaluate LCB and/or its gradient
+      :configure_for_gradients: true if this object will be used to compute gradients, false otherwise
+  \endrst*/
+  LowerConfidenceBoundState(const EvaluatorType& lcb_evaluator, double const * restrict point_to_sample_in,
+                            bool configure_for_gradients) OL_NONNULL_POINTERS;
+
+  LowerConfidenceBoundState(LowerConfidenceBoundState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim;
+  }
+
+  /*!\rst
+    \output
+      :point_to_sample[dim]: point whose LCB (and/or gradient) is being evaluated
+  \endrst*/
+  void GetCurrentPoint(double * restrict point_to_sample_out) const noexcept OL_NONNULL_POINTERS {
+    std::copy(point_to_sample.begin(), point_to_sample.end(), point_to_sample_out);
+  }
+
+  /*!\rst
+    Change the point whose LCB (and/or gradient) is being evaluated and update the GP state to match.
+
+    \param
+      :lcb_evaluator: evaluator object that specifies the parameters & GP for LCB evaluation
+      :point_to_sample[dim]: point whose LCB (and/or gradient) is to be evaluated
+  \endrst*/
+  void SetCurrentPoint(const EvaluatorType& lcb_evaluator,
+                       double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    SetCurrentPoint() after checking that ``lcb_evaluator`` matches this state's dimension.
+
+    \param
+      :lcb_evaluator: evaluator object that specifies the parameters & GP for LCB evaluation
+      :point_to_sample[dim]: point whose LCB (and/or gradient) is to be evaluated
+    \raise
+      InvalidValueException if the evaluator's and the state's dim do not match
+  \endrst*/
+  void SetupState(const EvaluatorType& lcb_evaluator, double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim;
+  //! number of points to sample; MUST be 1
+  const int num_to_sample = 1;
+  //! number of derivative terms desired (0 for no derivatives or 1)
+  const int num_derivatives;
+
+  //! point at which to evaluate LCB and/or its gradient
+  std::vector<double> point_to_sample;
+
+  //! gaussian process state
+  GaussianProcess::StateType points_to_sample_state;
+
+  // temporary storage: preallocated space used by LowerConfidenceBoundEvaluator's member functions
+  //! the gradient of the GP mean evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_mu;
+  //! the gradient of the GP variance evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_var;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LowerConfidenceBoundState);
+};
+
+struct LowerConfidenceBoundMCMCState;
+
+/*!\rst
+  Evaluates the LCB averaged over the GPs of a GaussianProcessMCMC (one per hyperparameter sample) and its spatial
+  gradient; see the file comments.  The objective function (for the maximizing optimizers) is ``-LCB_{mcmc}``.
+
+  This class has no state and is meant to be accessed by const reference only.
+\endrst*/
+class LowerConfidenceBoundMCMCEvaluator final {
+ public:
+  using StateType = LowerConfidenceBoundMCMCState;
+
+  /*!\rst
+    \param
+      :gaussian_process_mcmc: GaussianProcessMCMC object (one GaussianProcess per hyperparameter sample)
+      :exploration_weight: ``\beta >= 0``, the number of standard deviations subtracted from each GP's mean
+  \endrst*/
+  LowerConfidenceBoundMCMCEvaluator(const GaussianProcessMCMC& gaussian_process_mcmc_in, double exploration_weight);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_mcmc() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_mcmc_;
+  }
+
+  double exploration_weight() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return exploration_weight_;
+  }
+
+  const GaussianProcessMCMC * gaussian_process_mcmc() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return gaussian_process_mcmc_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeLowerConfidenceBound(); returns ``-LCB_{mcmc}``.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * lcb_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return -ComputeLowerConfidenceBound(lcb_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradLowerConfidenceBound(); computes ``-\nabla LCB_{mcmc}``.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * lcb_state, double * restrict grad_objective) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \param
+      :lcb_state[1]: properly configured state object
+    \output
+      :lcb_state[1]: state with temporary storage modified
+    \return
+      LCB averaged over the hyperparameter samples, at the state's ``point_to_sample``
+  \endrst*/
+  double ComputeLowerConfidenceBound(StateType * lcb_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    \param
+      :lcb_state[1]: properly configured state object (configured for gradients)
+    \output
+      :lcb_state[1]: state with temporary storage modified
+      :grad_LCB[dim]: gradient of the averaged LCB wrt the state's ``point_to_sample``
+  \endrst*/
+  void ComputeGradLowerConfidenceBound(StateType * lcb_state, double * restrict grad_LCB) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LowerConfidenceBoundMCMCEvaluator);
+
+ private:
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim_;
+  //! number of hyperparameter samples
+  const int num_mcmc_;
+  //! ``\beta``, the number of standard deviations subtracted from each mean
+  const double exploration_weight_;
+
+  //! pointer to the GPs used in LCB computations
+  const GaussianProcessMCMC * gaussian_process_mcmc_;
+};
+
+/*!\rst
+  State object for LowerConfidenceBoundMCMCEvaluator: the ONE ``point_to_sample`` being evaluated and the state of
+  each hyperparameter sample's GP at it.  See general comments on State structs in ``gpp_common.hpp``'s header docs.
+\endrst*/
+struct LowerConfidenceBoundMCMCState final {
+  using EvaluatorType = LowerConfidenceBoundMCMCEvaluator;
+
+  /*!\rst
+    Constructs a LowerConfidenceBoundMCMCState object; see LowerConfidenceBoundState's constructor.
+
+    \param
+      :lcb_evaluator: evaluator object that specifies the parameters & GPs for LCB evaluation
+      :point_to_sample[dim]: point at which to evaluate LCB and/or its gradient
+      :configure_for_gradients: true if this object will be used to compute gradients, false otherwise
+  \endrst*/
+  LowerConfidenceBoundMCMCState(const EvaluatorType& lcb_evaluator, double const * restrict point_to_sample_in,
+                                bool configure_for_gradients) OL_NONNULL_POINTERS;
+
+  LowerConfidenceBoundMCMCState(LowerConfidenceBoundMCMCState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim;
+  }
+
+  void GetCurrentPoint(double * restrict point_to_sample_out) const noexcept OL_NONNULL_POINTERS {
+    std::copy(point_to_sample.begin(), point_to_sample.end(), point_to_sample_out);
+  }
+
+  /*!\rst
+    Change the point whose LCB (and/or gradient) is being evaluated and update every GP's state to match.
+
+    \param
+      :lcb_evaluator: evaluator object that specifies the parameters & GPs for LCB evaluation
+      :point_to_sample[dim]: point whose LCB (and/or gradient) is to be evaluated
+  \endrst*/
+  void SetCurrentPoint(const EvaluatorType& lcb_evaluator,
+                       double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    SetCurrentPoint() after checking that ``lcb_evaluator`` matches this state's dimension and number of GPs.
+
+    \raise
+      InvalidValueException if the evaluator's and the state's dim or num_mcmc do not match
+  \endrst*/
+  void SetupState(const EvaluatorType& lcb_evaluator, double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of ``points_sampled``)
+  const int dim;
+  //! number of points to sample; MUST be 1
+  const int num_to_sample = 1;
+  //! number of derivative terms desired (0 for no derivatives or 1)
+  const int num_derivatives;
+
+  //! point at which to evaluate LCB and/or its gradient
+  std::vector<double> point_to_sample;
+
+  //! state of each hyperparameter sample's GP, ``[num_mcmc]``
+  std::vector<GaussianProcess::StateType> points_to_sample_state_list;
+
+  // temporary storage: preallocated space used by LowerConfidenceBoundMCMCEvaluator's member functions
+  //! the gradient of one GP's mean evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_mu;
+  //! the gradient of one GP's variance evaluated at point_to_sample, wrt point_to_sample
+  std::vector<double> grad_var;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LowerConfidenceBoundMCMCState);
+};
+
+/*!\rst
+  Finds the point minimizing LCB (see file comments) over ``domain``: screens
+  ``optimizer_parameters.num_multistarts`` uniform random starts in parallel, then runs multistart gradient descent
+  from the ``num_refined_starts`` best.
+
+  \param
+    :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+      that describes the underlying GP
+    :exploration_weight: ``\beta >= 0``, the number of standard deviations subtracted from the mean
+    :optimizer_parameters: GradientDescentParameters object that describes the parameters controlling LCB optimization
+      (e.g., number of multistarts, iterations, tolerances, learning rate)
+    :domain: object specifying the domain to optimize over (see ``gpp_domain.hpp``)
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :num_refined_starts: number of starts with the lowest initial LCB that gradient descent refines (suggest: 20)
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :found_flag[1]: true if gradient descent improved on the best start
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :best_next_point[dim]: point with the lowest LCB found
+\endrst*/
+template <typename DomainType>
+void ComputeLCBOptimalPointToSample(const GaussianProcess& gaussian_process, double exploration_weight,
+                                    const GradientDescentParameters& optimizer_parameters, const DomainType& domain,
+                                    const ThreadSchedule& thread_schedule, int num_refined_starts,
+                                    bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
+                                    double * restrict best_next_point) OL_NONNULL_POINTERS;
+
+/*!\rst
+  ComputeLCBOptimalPointToSample() for the LCB averaged over the GPs of ``gaussian_process_mcmc``.
+
+  \param
+    :gaussian_process_mcmc: GaussianProcessMCMC object (one GaussianProcess per hyperparameter sample)
+    (the rest as in ComputeLCBOptimalPointToSample())
+  \output
+    :found_flag[1]: true if gradient descent improved on the best start
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :best_next_point[dim]: point with the lowest averaged LCB found
+\endrst*/
+template <typename DomainType>
+void ComputeLCBMCMCOptimalPointToSample(const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+                                        const GradientDescentParameters& optimizer_parameters,
+                                        const DomainType& domain, const ThreadSchedule& thread_schedule,
+                                        int num_refined_starts, bool * restrict found_flag,
+                                        UniformRandomGenerator * uniform_generator,
+                                        double * restrict best_next_point) OL_NONNULL_POINTERS;
+
+// template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
+extern template void ComputeLCBOptimalPointToSample(
+    const GaussianProcess& gaussian_process, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+extern template void ComputeLCBOptimalPointToSample(
+    const GaussianProcess& gaussian_process, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+extern template void ComputeLCBMCMCOptimalPointToSample(
+    const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const TensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+extern template void ComputeLCBMCMCOptimalPointToSample(
+    const GaussianProcessMCMC& gaussian_process_mcmc, double exploration_weight,
+    const GradientDescentParameters& optimizer_parameters, const SimplexIntersectTensorProductDomain& domain,
+    const ThreadSchedule& thread_schedule, int num_refined_starts, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, double * restrict best_next_point);
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_HPP_
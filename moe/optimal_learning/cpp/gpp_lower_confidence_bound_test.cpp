@@ -0,0 +1,299 @@
+/*!
+  \file gpp_lower_confidence_bound_test.cpp
+  \rst
+  Routines to test the functions in gpp_lower_confidence_bound.cpp:
+
+  * for each covariance type (with derivative observations), LowerConfidenceBoundEvaluator matches
+    ``\mu - \beta\sigma`` computed from the GP directly, ComputeLowerConfidenceBoundOfPoints() matches the state-based
+    value, and the analytic gradient matches finite differences,
+  * LowerConfidenceBoundMCMCEvaluator is the average of the per-GP LCBs (and gradients), and its gradient matches
+    finite differences,
+  * ComputeLCBOptimalPointToSample() and ComputeLCBMCMCOptimalPointToSample() find the minimum of a well-sampled bowl.
+\endrst*/
+
+#include "gpp_lower_confidence_bound_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_lower_confidence_bound.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks ``lcb_evaluator``'s analytic gradient against central differences of its value at ``point``.
+
+  \return
+    number of test failures
+\endrst*/
+template <typename LowerConfidenceBoundEvaluator>
+OL_WARN_UNUSED_RESULT int CheckGradLowerConfidenceBound(const LowerConfidenceBoundEvaluator& lcb_evaluator,
+                                                        double const * restrict point) {
+  int total_errors = 0;
+  const int dim = lcb_evaluator.dim();
+  const double epsilon = 1.0e-6;
+  std::vector<double> perturbed_point(point, point + dim);
+  std::vector<double> grad_LCB(dim);
+  typename LowerConfidenceBoundEvaluator::StateType lcb_state(lcb_evaluator, point, true);
+  lcb_evaluator.ComputeGradLowerConfidenceBound(&lcb_state, grad_LCB.data());
+
+  typename LowerConfidenceBoundEvaluator::StateType lcb_state_value(lcb_evaluator, point, false);
+  for (int d = 0; d < dim; ++d) {
+    perturbed_point[d] += epsilon;
+    lcb_state_value.SetCurrentPoint(lcb_evaluator, perturbed_point.data());
+    const double value_plus = lcb_evaluator.ComputeLowerConfidenceBound(&lcb_state_value);
+    perturbed_point[d] -= 2.0*epsilon;
+    lcb_state_value.SetCurrentPoint(lcb_evaluator, perturbed_point.data());
+    const double value_minus = lcb_evaluator.ComputeLowerConfidenceBound(&lcb_state_value);
+    perturbed_point[d] += epsilon;
+    const double finite_difference = (value_plus - value_minus)/(2.0*epsilon);
+    if (!CheckDoubleWithinRelativeWithThreshold(grad_LCB[d], finite_difference, 1.0e-5, 1.0e-6)) {
+      ++total_errors;
+    }
+  }
+
+  // the optimizer's objective is -LCB
+  std::vector<double> grad_objective(dim);
+  lcb_evaluator.ComputeGradObjectiveFunction(&lcb_state, grad_objective.data());
+  for (int d = 0; d < dim; ++d) {
+    if (!CheckDoubleWithin(grad_objective[d], -grad_LCB[d], 0.0)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks LowerConfidenceBoundEvaluator against the GP's mean and variance and against finite differences, for each
+  covariance type, on a GP with derivative observations.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int LowerConfidenceBoundEvaluatorTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 10;
+  const int num_to_sample = 8;
+  const double exploration_weight = 1.7;
+  std::vector<int> derivatives = {1};
+  const int num_derivatives = derivatives.size();
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_derivatives);
+  std::vector<double> noise_variance(num_derivatives + 1, 1.0e-3);
+  std::vector<double> lengths(dim, 1.3);
+
+  SquareExponential sqexp_covariance(dim, 1.1, lengths.data());
+  MaternNu1p5 matern_15_covariance(dim, 1.1, lengths.data());
+  MaternNu2p5 matern_25_covariance(dim, 1.1, lengths.data());
+  CovarianceInterface const * covariances[3] = {&sqexp_covariance, &matern_15_covariance, &matern_25_covariance};
+  std::vector<double> lower_confidence_bound(num_to_sample);
+  for (auto covariance : covariances) {
+    GaussianProcess gaussian_process(*covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), derivatives.data(),
+                                     num_derivatives, dim, num_sampled);
+    LowerConfidenceBoundEvaluator lcb_evaluator(gaussian_process, exploration_weight);
+    lcb_evaluator.ComputeLowerConfidenceBoundOfPoints(EI_environment.points_to_sample(), num_to_sample, 2,
+                                                      lower_confidence_bound.data());
+    for (int i = 0; i < num_to_sample; ++i) {
+      double const * point = EI_environment.points_to_sample() + i*dim;
+      PointsToSampleState points_to_sample_state(gaussian_process, point, 1, nullptr, 0, 0);
+      double mean;
+      double variance;
+      gaussian_process.ComputeMeanOfPoints(points_to_sample_state, &mean);
+      gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, &variance);
+      const double truth = mean - exploration_weight*std::sqrt(variance);
+
+      LowerConfidenceBoundState lcb_state(lcb_evaluator, point, false);
+      const double value = lcb_evaluator.ComputeLowerConfidenceBound(&lcb_state);
+      if (!CheckDoubleWithinRelative(value, truth, 1.0e-12)) {
+        ++total_errors;
+      }
+      if (!CheckDoubleWithinRelative(lower_confidence_bound[i], value, 1.0e-12)) {
+        ++total_errors;
+      }
+      if (!CheckDoubleWithin(lcb_evaluator.ComputeObjectiveFunction(&lcb_state), -value, 0.0)) {
+        ++total_errors;
+      }
+
+      total_errors += CheckGradLowerConfidenceBound(lcb_evaluator, point);
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that LowerConfidenceBoundMCMCEvaluator's value and gradient are the averages of the per-GP
+  LowerConfidenceBoundEvaluator values and gradients, and that its gradient matches finite differences.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int LowerConfidenceBoundMCMCTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 12;
+  const int num_to_sample = 5;
+  const int num_mcmc = 3;
+  const double exploration_weight = 0.8;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, 0);
+  std::vector<int> no_derivatives;
+  // [dim+1][num_mcmc] hyperparameters and [1][num_mcmc] noise variances
+  std::vector<double> hypers_mcmc = {1.0, 0.8, 1.2, 2.0, 1.1, 0.6, 0.7, 1.5, 0.9};
+  std::vector<double> noises_mcmc = {1.0e-3, 1.0e-2, 5.0e-3};
+  GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc,
+                                            EI_environment.points_sampled(), EI_environment.points_sampled_value(),
+                                            no_derivatives.data(), 0, dim, num_sampled, 1);
+  LowerConfidenceBoundMCMCEvaluator lcb_mcmc_evaluator(gaussian_process_mcmc, exploration_weight);
+
+  std::vector<double> grad_LCB_mcmc(dim);
+  std::vector<double> grad_LCB_average(dim);
+  std::vector<double> grad_LCB(dim);
+  for (int i = 0; i < num_to_sample; ++i) {
+    double const * point = EI_environment.points_to_sample() + i*dim;
+    LowerConfidenceBoundMCMCState lcb_mcmc_state(lcb_mcmc_evaluator, point, true);
+    const double value_mcmc = lcb_mcmc_evaluator.ComputeLowerConfidenceBound(&lcb_mcmc_state);
+    lcb_mcmc_evaluator.ComputeGradLowerConfidenceBound(&lcb_mcmc_state, grad_LCB_mcmc.data());
+
+    double value_average = 0.0;
+    std::fill(grad_LCB_average.begin(), grad_LCB_average.end(), 0.0);
+    for (const auto& gaussian_process : gaussian_process_mcmc.gaussian_process_lst) {
+      LowerConfidenceBoundEvaluator lcb_evaluator(gaussian_process, exploration_weight);
+      LowerConfidenceBoundState lcb_state(lcb_evaluator, point, true);
+      value_average += lcb_evaluator.ComputeLowerConfidenceBound(&lcb_state)/num_mcmc;
+      lcb_evaluator.ComputeGradLowerConfidenceBound(&lcb_state, grad_LCB.data());
+      for (int d = 0; d < dim; ++d) {
+        grad_LCB_average[d] += grad_LCB[d]/num_mcmc;
+      }
+    }
+
+    if (!CheckDoubleWithinRelative(value_mcmc, value_average, 1.0e-13)) {
+      ++total_errors;
+    }
+    for (int d = 0; d < dim; ++d) {
+      if (!CheckDoubleWithinRelativeWithThreshold(grad_LCB_mcmc[d], grad_LCB_average[d], 1.0e-13, 1.0e-14)) {
+        ++total_errors;
+      }
+    }
+
+    total_errors += CheckGradLowerConfidenceBound(lcb_mcmc_evaluator, point);
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Optimizes LCB on a GP fit to the bowl ``\|x - c\|_2^2``, with a single GP and with a GaussianProcessMCMC.  With
+  dense data the posterior is nearly exact, so the optimum must be in the domain and near ``c``.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int LowerConfidenceBoundOptimizationTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 40;
+  const int num_mcmc = 2;
+  const int num_refined_starts = 4;
+  const double exploration_weight = 0.5;
+  const double minimum[dim] = {0.4, -0.6};
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-2.0, 2.0));
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  UniformRandomGenerator uniform_generator(3145);
+  std::vector<double> points_sampled(num_sampled*dim);
+  std::vector<double> points_sampled_value(num_sampled);
+  domain.GenerateUniformPointsInDomain(num_sampled, &uniform_generator, points_sampled.data());
+  for (int i = 0; i < num_sampled; ++i) {
+    points_sampled_value[i] = Square(points_sampled[i*dim] - minimum[0]) + Square(points_sampled[i*dim + 1] - minimum[1]);
+  }
+  std::vector<int> no_derivatives;
+  std::vector<double> hypers_mcmc = {5.0, 4.0, 1.5, 1.2, 1.5, 1.8};
+  std::vector<double> noises_mcmc = {1.0e-4, 1.0e-3};
+  GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc, points_sampled.data(),
+                                            points_sampled_value.data(), no_derivatives.data(), 0, dim, num_sampled,
+                                            1);
+
+  GradientDescentParameters gd_params(50, 300, 5, 15, 0.7, 0.1, 0.7, 1.0e-8);
+  ThreadSchedule thread_schedule(2, omp_sched_static);
+  std::vector<double> best_next_point(dim);
+
+  for (int mode = 0; mode < 2; ++mode) {
+    bool found_flag = false;
+    if (mode == 0) {
+      ComputeLCBOptimalPointToSample(gaussian_process_mcmc.gaussian_process_lst[0], exploration_weight, gd_params,
+                                     domain, thread_schedule, num_refined_starts, &found_flag, &uniform_generator,
+                                     best_next_point.data());
+    } else {
+      ComputeLCBMCMCOptimalPointToSample(gaussian_process_mcmc, exploration_weight, gd_params, domain,
+                                         thread_schedule, num_refined_starts, &found_flag, &uniform_generator,
+                                         best_next_point.data());
+    }
+    if (!domain.CheckPointInside(best_next_point.data())) {
+      ++total_errors;
+    }
+    const double distance = std::sqrt(Square(best_next_point[0] - minimum[0]) +
+                                      Square(best_next_point[1] - minimum[1]));
+    if (distance > 0.1) {
+      OL_ERROR_PRINTF("LCB optimum (%.18E, %.18E) is %.18E from the minimum\n", best_next_point[0],
+                      best_next_point[1], distance);
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunLowerConfidenceBoundTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = LowerConfidenceBoundEvaluatorTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("lower confidence bound evaluator failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("lower confidence bound evaluator\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = LowerConfidenceBoundMCMCTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("lower confidence bound mcmc evaluator failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("lower confidence bound mcmc evaluator\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = LowerConfidenceBoundOptimizationTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("lower confidence bound optimization failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("lower confidence bound optimization\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
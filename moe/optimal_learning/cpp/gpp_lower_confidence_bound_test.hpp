@@ -0,0 +1,26 @@
+/*!
+  \file gpp_lower_confidence_bound_test.hpp
+  \rst
+  Functions for testing gpp_lower_confidence_bound's functionality: LCB values match the GP's mean and variance,
+  analytic gradients match finite differences, MCMC averaging is consistent, and the multistart optimizer finds
+  the minimum of a well-sampled bowl.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the lower confidence bound tests.
+
+  \return
+    number of test failures: 0 if LCB evaluation and optimization are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunLowerConfidenceBoundTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_LOWER_CONFIDENCE_BOUND_TEST_HPP_
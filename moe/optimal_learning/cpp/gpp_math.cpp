@@ -261,11 +261,19 @@
 #include <cmath>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <numeric>
 #include <vector>
 
 #include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
@@ -276,7 +284,9 @@
 #include "gpp_logging.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
@@ -316,22 +326,9 @@ OL_NONNULL_POINTERS void BuildMixCovarianceMatrix(const CovarianceInterface& cov
                                                   int num_derivatives_to_sample,
                                                   double * restrict cov_matrix) noexcept {
   // calculate the covariance matrix defined in gpp_covariance.hpp
-  double * cov_temp = new double[(num_derivatives_sampled+1)*(num_derivatives_to_sample+1)]();
-  for (int j = 0; j < num_to_sample; ++j) { //col
-    for (int i = 0; i < num_sampled; ++i) { //row
-      covariance.Covariance(points_sampled + i*dim, derivatives_sampled, num_derivatives_sampled,
-                            points_to_sample + j*dim, derivatives_to_sample, num_derivatives_to_sample,
-                            cov_temp);
-      for (int m = 0; m < num_derivatives_sampled+1; ++m){
-          for (int n = 0; n < num_derivatives_to_sample+1; ++n){
-              int row = i*(num_derivatives_sampled+1) + m;
-              int col = j*(num_derivatives_to_sample+1) + n;
-              cov_matrix[row+col*num_sampled*(num_derivatives_sampled+1)] = cov_temp[m+n*(num_derivatives_sampled+1)];
-          }
-      }
-    }
-  }
-  delete [] cov_temp;
+  covariance.CovarianceMatrix(points_sampled, points_to_sample, dim, num_sampled, num_to_sample,
+                              derivatives_sampled, num_derivatives_sampled,
+                              derivatives_to_sample, num_derivatives_to_sample, cov_matrix);
 }
 
 namespace {  // utilities for A_{k,j,i}*x_j and building covariance matrices
@@ -380,13 +377,15 @@ OL_NONNULL_POINTERS void SpecialTensorVectorMultiply(double const * restrict ten
   Point list cannot contain duplicates.  Doing so (or providing nearly duplicate points) can lead to
   semi-definite matrices or very poor numerical conditioning.
 
+  Long point lists are built in parallel over tiles of point pairs; see BuildSymmetricCovarianceMatrixInParallel().
+
   \param
     :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
     :points_sampled[dim][num_sampled]: list of points
     :dim: spatial dimension of a point
     :num_sampled: number of points
   \output
-    :cov_matrix[num_sampled][num_sampled]: computed covariance matrix, LOWER TRIANGLE
+    :cov_matrix[num_sampled][num_sampled]: computed covariance matrix (both triangles are filled; callers only rely on the LOWER TRIANGLE)
 \endrst*/
 OL_NONNULL_POINTERS void BuildCovarianceMatrix(const CovarianceInterface& covariance,
                                                double const * restrict points_sampled,
@@ -394,25 +393,9 @@ OL_NONNULL_POINTERS void BuildCovarianceMatrix(const CovarianceInterface& covari
                                                int const * restrict derivatives,
                                                int num_derivatives,
                                                double * restrict cov_matrix) noexcept {
-  // we only work with lower triangular parts of symmetric matrices, so only fill half of it
-  double * cov_temp = new double[(num_derivatives+1)*(num_derivatives+1)]();
-  for (int i = 0; i < num_sampled; ++i) { // col
-    for (int j = i; j < num_sampled; ++j) { //row
-      covariance.Covariance(points_sampled + j*dim, derivatives, num_derivatives,
-                            points_sampled + i*dim, derivatives, num_derivatives,
-                            cov_temp);
-      for (int m = 0; m < num_derivatives+1; ++m){
-          for (int n = 0; n < num_derivatives+1; ++n){
-              int row = j*(num_derivatives+1) + m;
-              int col = i*(num_derivatives+1) + n;
-              if (row>=col){
-                  cov_matrix[row+col*num_sampled*(num_derivatives+1)] = cov_temp[m+n*(num_derivatives+1)];
-              }
-          }
-      }
-    }
-  }
-  delete [] cov_temp;
+  // tiles on the diagonal pass the same point list twice, so the covariance only computes (and mirrors) half of them
+  BuildSymmetricCovarianceMatrixInParallel(covariance, points_sampled, dim, num_sampled, derivatives, num_derivatives,
+                                           cov_matrix);
 }
 
 /*!\rst
@@ -430,36 +413,86 @@ OL_NONNULL_POINTERS void BuildCovarianceMatrixWithNoiseVariance(const Covariance
                                                                 int const * restrict derivatives,
                                                                 int num_derivatives,
                                                                 double * restrict cov_matrix) noexcept {
-  // we only work with lower triangular parts of symmetric matrices, so only fill half of it
-  double * cov_temp = new double[Square(num_derivatives+1)]();
-  for (int i = 0; i < num_sampled; ++i) { // col
-    for (int j = i; j < num_sampled; ++j) { //row
-      covariance.Covariance(points_sampled + j*dim, derivatives, num_derivatives,
-                            points_sampled + i*dim, derivatives, num_derivatives,
-                            cov_temp);
-      for (int m = 0; m < num_derivatives+1; ++m){
-          for (int n = 0; n < num_derivatives+1; ++n){
-              int row = j*(num_derivatives+1) + m;
-              int col = i*(num_derivatives+1) + n;
-              if (row>=col){
-                  cov_matrix[row+col*num_sampled*(num_derivatives+1)] = cov_temp[m+n*(num_derivatives+1)];
-              }
-              if (row == col){
-                  cov_matrix[row+col*num_sampled*(num_derivatives+1)] += noise_variance[m];
-              }
-          }
-      }
+  BuildCovarianceMatrix(covariance, points_sampled, dim, num_sampled, derivatives, num_derivatives, cov_matrix);
+  const int num_rows = num_sampled*(num_derivatives+1);
+  for (int i = 0; i < num_sampled; ++i) {
+    for (int m = 0; m < num_derivatives+1; ++m) {
+      const int row = i*(num_derivatives+1) + m;
+      cov_matrix[row + row*num_rows] += noise_variance[m];
+    }
+  }
+}
+
+/*!\rst
+  \return
+    a GaussianProcess version stamp never returned before (in this process); never 0
+\endrst*/
+std::uint64_t NextGaussianProcessVersion() noexcept {
+  static std::atomic<std::uint64_t> last_version(0);
+  return ++last_version;
+}
+
+/*!\rst
+  Overwrites the cholesky factor ``L`` of ``A`` with that of ``A + x * x^T`` in ``O(size^2)``, one Givens-like
+  rotation per column.  Every step adds to the diagonal, so (unlike a downdate) this cannot fail.
+
+  \param
+    :size: dimension of ``L``
+    :leading_dim: leading dimension of ``chol``, >= size
+    :chol[leading_dim][size]: lower triangular cholesky factor ``L``
+    :x[size]: rank-one update vector
+  \output
+    :chol[leading_dim][size]: cholesky factor of ``L * L^T + x * x^T``
+    :x[size]: overwritten
+\endrst*/
+void CholeskyFactorLRankOneUpdate(int size, int leading_dim, double * restrict chol, double * restrict x) noexcept {
+  for (int k = 0; k < size; ++k) {
+    double * restrict chol_col = chol + k*leading_dim;
+    const double diagonal = std::hypot(chol_col[k], x[k]);
+    const double cosine = diagonal/chol_col[k];
+    const double sine = x[k]/chol_col[k];
+    chol_col[k] = diagonal;
+    for (int i = k + 1; i < size; ++i) {
+      chol_col[i] = (chol_col[i] + sine*x[i])/cosine;
+      x[i] = cosine*x[i] - sine*chol_col[i];
+    }
+  }
+}
+
+/*!\rst
+  Number of points, ``\prod_d grid_sizes[d]``, of a Cartesian grid.
+
+  \raise
+    LowerBoundException if some ``grid_sizes[d] < 1``
+\endrst*/
+int NumberOfGridPoints(int const * restrict grid_sizes, int dim) {
+  int num_points = 1;
+  for (int d = 0; d < dim; ++d) {
+    if (unlikely(grid_sizes[d] < 1)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "Every grid dimension needs at least one coordinate.",
+                         grid_sizes[d], 1);
     }
+    num_points *= grid_sizes[d];
   }
-  delete [] cov_temp;
+  return num_points;
 }
 
 }  // end unnamed namespace
 
 void GaussianProcess::BuildCovarianceMatrixWithNoiseVariance() noexcept {
+  OL_PROFILE_SCOPE(ProfilePhase::kCovarianceMatrixBuild);
+  if (training_differences_ != nullptr && training_differences_->num_points == num_sampled_ &&
+      training_differences_->num_derivatives == num_derivatives_) {
+    covariance_ptr_->SymmetricCovarianceMatrix(*training_differences_, K_chol_.data());
+    const int num_rows = num_sampled_*(num_derivatives_+1);
+    for (int row = 0; row < num_rows; ++row) {
+      K_chol_[row + row*num_rows] += noise_variance_[row % (num_derivatives_+1)];
+    }
+    return;
+  }
   optimal_learning::BuildCovarianceMatrixWithNoiseVariance(*covariance_ptr_, noise_variance_.data(),
-                                                           points_sampled_.data(), dim_, num_sampled_,
-                                                           derivatives_.data(), num_derivatives_,
+                                                           points_sampled_->data(), dim_, num_sampled_,
+                                                           derivatives_->data(), num_derivatives_,
                                                            K_chol_.data());
 }
 
@@ -471,41 +504,476 @@ void GaussianProcess::BuildMixCovarianceMatrix(double const * restrict points_to
                                                int const * restrict derivatives_to_sample,
                                                int num_derivatives_to_sample,
                                                double * restrict covariance_matrix) const noexcept {
-  optimal_learning::BuildMixCovarianceMatrix(*covariance_ptr_, points_sampled_.data(),
+  OL_PROFILE_SCOPE(ProfilePhase::kCovarianceMatrixBuild);
+  if (scaled_points_sampled_.Matches(points_sampled_->data(), num_sampled_)) {
+    covariance_ptr_->CovarianceMatrixOfScaledPoints(scaled_points_sampled_, points_to_sample, num_to_sample,
+                                                    derivatives_->data(), num_derivatives_, derivatives_to_sample,
+                                                    num_derivatives_to_sample, covariance_matrix);
+    return;
+  }
+  optimal_learning::BuildMixCovarianceMatrix(*covariance_ptr_, points_sampled_->data(),
                                              points_to_sample, dim_, num_sampled_,
-                                             num_to_sample, derivatives_.data(), num_derivatives_,
+                                             num_to_sample, derivatives_->data(), num_derivatives_,
                                              derivatives_to_sample, num_derivatives_to_sample,
                                              covariance_matrix);
 }
 
+void GaussianProcess::BuildMixCovarianceMatrixOfState(StateType * points_to_sample_state, int num_points) const noexcept {
+  CrossPairwiseDifferences const * cross_differences = points_to_sample_state->cross_differences;
+  if (cross_differences != nullptr &&
+      cross_differences->Matches(points_sampled_->data(), num_sampled_, points_to_sample_state->points_to_sample.data(),
+                                 points_to_sample_state->num_to_sample)) {
+    OL_PROFILE_SCOPE(ProfilePhase::kCovarianceMatrixBuild);
+    covariance_ptr_->CrossCovarianceMatrix(*cross_differences, derivatives_->data(), num_derivatives_,
+                                           points_to_sample_state->gradients.data(),
+                                           points_to_sample_state->num_gradients_to_sample,
+                                           points_to_sample_state->K_star.data());
+    return;
+  }
+  // each point's columns are contiguous, so the leading num_points points are a prefix of K_star
+  BuildMixCovarianceMatrix(points_to_sample_state->points_to_sample.data(), num_points,
+                           points_to_sample_state->gradients.data(),
+                           points_to_sample_state->num_gradients_to_sample,
+                           points_to_sample_state->K_star.data());
+}
+
+int GaussianProcess::NumReusablePointsOfState(const StateType& points_to_sample_state) const noexcept {
+  if (points_to_sample_state.filled_version != version_ ||
+      points_to_sample_state.filled_points_to_sample.size() != points_to_sample_state.points_to_sample.size()) {
+    return 0;
+  }
+  int num_reusable = 0;
+  for (int j = points_to_sample_state.num_to_sample - 1; j >= 0; --j, ++num_reusable) {
+    auto point = points_to_sample_state.points_to_sample.cbegin() + j*dim_;
+    if (!std::equal(point, point + dim_, points_to_sample_state.filled_points_to_sample.cbegin() + j*dim_)) {
+      break;
+    }
+  }
+  return num_reusable;
+}
+
+void GaussianProcess::MarkPointsToSampleStateFilled(StateType * points_to_sample_state) const {
+  points_to_sample_state->filled_points_to_sample = points_to_sample_state->points_to_sample;
+  points_to_sample_state->filled_version = version_;
+}
+
 void GaussianProcess::RecomputeDerivedVariables() {
+  OL_PROFILE_SCOPE(ProfilePhase::kGaussianProcessFit);
+  version_ = NextGaussianProcessVersion();
+  RecomputeScaledPointsSampled();
+  if (is_sparse()) {
+    RecomputeSparseDerivedVariables();
+    return;
+  }
+  if (is_grid()) {
+    RecomputeGridDerivedVariables();
+    return;
+  }
+
   // resize if needed
-  if (unlikely(static_cast<int>(K_inv_y_.size()) != num_sampled_*(num_derivatives_+1))) {
+  if (unlikely(static_cast<int>(K_chol_.size()) != Square(num_sampled_*(num_derivatives_+1)))) {
     K_chol_.resize(Square(num_sampled_*(num_derivatives_+1)));
     K_inv_y_.resize(num_sampled_*(num_derivatives_+1));
   }
 
   // recompute derived quantities
   BuildCovarianceMatrixWithNoiseVariance();
-  int leading_minor_index = ComputeCholeskyFactorL(num_sampled_*(num_derivatives_+1), K_chol_.data());
+  // each sampled point's value and derivative rows are one contiguous block of K
+  int leading_minor_index;
+  if (!derivative_mask_.empty()) {
+    leading_minor_index = ComputeObservedCholeskyFactor();
+  } else if (cholesky_jitter_.max_relative_jitter > 0.0) {
+    leading_minor_index = ComputeCholeskyFactorLWithJitter(num_sampled_*(num_derivatives_+1), num_derivatives_+1,
+                                                           K_chol_.data(), &cholesky_jitter_);
+    if (unlikely(cholesky_jitter_.jitter != 0.0 && leading_minor_index == 0)) {
+      OL_WARNING_PRINTF("K factored with jitter %.3E on %d pivots\n", cholesky_jitter_.jitter,
+                        cholesky_jitter_.num_jittered_pivots);
+    }
+  } else {
+    cholesky_jitter_.jitter = 0.0;
+    cholesky_jitter_.num_jittered_pivots = 0;
+    leading_minor_index = ComputeBlockCholeskyFactorL(num_sampled_*(num_derivatives_+1), num_derivatives_+1,
+                                                      K_chol_.data());
+  }
   if (unlikely(leading_minor_index != 0)) {
+    OL_ERROR_PRINTF("K is singular in the block of points_sampled[%d]\n", (leading_minor_index-1)/(num_derivatives_+1));
     OL_THROW_EXCEPTION(SingularMatrixException,
                        "Covariance matrix (K) singular. Check for duplicate points_sampled "
                        "(with 0 noise) and/or extreme hyperparameter values.",
                        K_chol_.data(), num_sampled_*(num_derivatives_+1), leading_minor_index);
   }
 
+  PackCholeskyFactor();
+  RecomputeMeanAndKInvY();
+}
+
+void GaussianProcess::RecomputeObservedRows() {
+  observed_rows_.clear();
+  if (derivative_mask_.empty()) {
+    return;
+  }
+  for (int i = 0; i < num_sampled_; ++i) {
+    observed_rows_.push_back(i*(num_derivatives_+1));
+    for (int m = 0; m < num_derivatives_; ++m) {
+      if (derivative_mask_[i*num_derivatives_ + m] != 0) {
+        observed_rows_.push_back(i*(num_derivatives_+1) + 1 + m);
+      }
+    }
+  }
+}
+
+int GaussianProcess::ComputeObservedCholeskyFactor() {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const int num_observed = observed_rows_.size();
+  std::vector<double> observed_chol(Square(num_observed));
+  GatherSymmetricSubmatrix(num_rows, K_chol_.data(), observed_rows_.data(), num_observed, observed_chol.data());
+  int leading_minor_index;
+  if (cholesky_jitter_.max_relative_jitter > 0.0) {
+    // the observed rows of a point are no longer a fixed-size block
+    leading_minor_index = ComputeCholeskyFactorLWithJitter(num_observed, 1, observed_chol.data(), &cholesky_jitter_);
+    if (unlikely(cholesky_jitter_.jitter != 0.0 && leading_minor_index == 0)) {
+      OL_WARNING_PRINTF("K factored with jitter %.3E on %d pivots\n", cholesky_jitter_.jitter,
+                        cholesky_jitter_.num_jittered_pivots);
+    }
+  } else {
+    cholesky_jitter_.jitter = 0.0;
+    cholesky_jitter_.num_jittered_pivots = 0;
+    leading_minor_index = ComputeCholeskyFactorL(num_observed, observed_chol.data());
+  }
+  if (unlikely(leading_minor_index != 0)) {
+    return observed_rows_[leading_minor_index - 1] + 1;
+  }
+  ScatterSubmatrixCholeskyFactor(num_rows, observed_chol.data(), observed_rows_.data(), num_observed,
+                                 kMaskedCholeskyDiagonal, K_chol_.data());
+  return 0;
+}
+
+void GaussianProcess::SetDerivativeMask(int const * restrict derivative_mask) {
+  if (unlikely(is_sparse())) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Sparse (FITC) GPs do not support derivative masks.");
+  }
+  if (num_derivatives_ == 0) {
+    return;
+  }
+  derivative_mask_.resize(num_sampled_*num_derivatives_);
+  for (int i = 0; i < num_sampled_*num_derivatives_; ++i) {
+    derivative_mask_[i] = derivative_mask[i] != 0;
+  }
+  RecomputeObservedRows();
+  RecomputeDerivedVariables();
+}
+
+void GaussianProcess::ClearDerivativeMask() {
+  if (derivative_mask_.empty()) {
+    return;
+  }
+  derivative_mask_.clear();
+  observed_rows_.clear();
+  RecomputeDerivedVariables();
+}
+
+void GaussianProcess::RecomputeScaledPointsSampled() {
+  covariance_ptr_->ScalePointsTranspose(points_sampled_->data(), num_sampled_, &scaled_points_sampled_);
+}
+
+void GaussianProcess::PackCholeskyFactor() {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  if (!packed_cholesky_ || is_grid() || static_cast<int>(K_chol_.size()) != Square(num_rows)) {
+    return;
+  }
+  // swap rather than shrink so the square buffer is actually released
+  AlignedVector<double> packed(PackedTriangleSize(num_rows));
+  PackLowerTriangle(num_rows, K_chol_.data(), packed.data());
+  K_chol_.swap(packed);
+}
+
+void GaussianProcess::UnpackCholeskyFactor() {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  if (!packed_cholesky_ || is_grid() || static_cast<int>(K_chol_.size()) != PackedTriangleSize(num_rows)) {
+    return;
+  }
+  AlignedVector<double> square(Square(num_rows));
+  UnpackLowerTriangle(num_rows, K_chol_.data(), square.data());
+  K_chol_.swap(square);
+}
+
+void GaussianProcess::SetPackedCholeskyStorage(bool packed) {
+  if (packed) {
+    packed_cholesky_ = true;
+    PackCholeskyFactor();
+  } else {
+    UnpackCholeskyFactor();
+    packed_cholesky_ = false;
+  }
+}
+
+void GaussianProcess::RecomputeMeanAndKInvY() {
   mean_ = 0.0;
   for (int i=0; i<num_sampled_; ++i){
-     mean_ += points_sampled_value_[i*(num_derivatives_+1)];
+     mean_ += (*points_sampled_value_)[i*(num_derivatives_+1)];
   }
   mean_ /= num_sampled_;
 
-  std::copy(points_sampled_value_.begin(), points_sampled_value_.end(), K_inv_y_.begin());
+  K_inv_y_.resize(num_sampled_*(num_derivatives_+1));
+  std::copy(points_sampled_value_->begin(), points_sampled_value_->end(), K_inv_y_.begin());
   for (int i=0; i<num_sampled_; ++i){
      K_inv_y_[i*(num_derivatives_+1)] -= mean_;
   }
-  CholeskyFactorLMatrixVectorSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), K_inv_y_.data());
+  // masked derivatives carry no information (and may hold anything, e.g., NaN)
+  for (int i = 0; i < static_cast<int>(derivative_mask_.size()); ++i) {
+    if (derivative_mask_[i] == 0) {
+      K_inv_y_[(i/num_derivatives_)*(num_derivatives_+1) + 1 + i % num_derivatives_] = 0.0;
+    }
+  }
+  if (is_grid()) {
+    SolveCovariance(1, K_inv_y_.data());
+  } else if (packed_cholesky_) {
+    PackedCholeskyFactorLMatrixVectorSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), K_inv_y_.data());
+  } else {
+    CholeskyFactorLMatrixVectorSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), K_inv_y_.data());
+  }
+}
+
+/*!\rst
+  ``K_d`` is the SquareExponential kernel (without ``\alpha``) between the coordinates of dimension ``d``.  Each
+  ``K_d`` is PSD, so eigenvalues below 0 are rounding and are clamped; ``K`` is singular if some entry of
+  ``\Lambda + \sigma_n^2 I`` is not (relatively) positive.
+\endrst*/
+void GaussianProcess::RecomputeGridDerivedVariables() {
+  std::vector<double> hyperparameters(covariance_ptr_->GetNumberOfHyperparameters());
+  covariance_ptr_->GetHyperparameters(hyperparameters.data());
+  const double alpha = hyperparameters[0];
+
+  int num_eigenvector_entries = 0;
+  for (int d = 0; d < dim_; ++d) {
+    num_eigenvector_entries += Square(grid_sizes_[d]);
+  }
+  grid_eigenvectors_.resize(num_eigenvector_entries);
+  std::vector<double> dimension_eigenvalues(grid_coordinates_.size());
+  std::vector<double> kernel;
+  double const * restrict coordinates = grid_coordinates_.data();
+  double * restrict eigenvectors = grid_eigenvectors_.data();
+  double * restrict eigenvalues = dimension_eigenvalues.data();
+  for (int d = 0; d < dim_; ++d) {
+    const int size = grid_sizes_[d];
+    const double inverse_length_sq = 1.0/Square(hyperparameters[1 + d]);
+    kernel.resize(Square(size));
+    for (int j = 0; j < size; ++j) {
+      for (int i = 0; i < size; ++i) {
+        kernel[j*size + i] = std::exp(-0.5*Square(coordinates[i] - coordinates[j])*inverse_length_sq);
+      }
+    }
+    SymmetricEigendecomposition(size, kernel.data(), eigenvectors, eigenvalues);
+    coordinates += size;
+    eigenvectors += Square(size);
+    eigenvalues += size;
+  }
+
+  grid_inverse_sqrt_eigenvalues_.resize(num_sampled_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    double eigenvalue = alpha;
+    for (int d = 0, remaining_index = i, offset = 0; d < dim_; offset += grid_sizes_[d], ++d) {
+      eigenvalue *= std::fmax(dimension_eigenvalues[offset + remaining_index % grid_sizes_[d]], 0.0);
+      remaining_index /= grid_sizes_[d];
+    }
+    eigenvalue += noise_variance_[0];
+    if (unlikely(eigenvalue <= std::numeric_limits<double>::epsilon()*alpha)) {
+      OL_THROW_EXCEPTION(SingularMatrixException,
+                         "Grid covariance matrix (K) singular: it has a nonpositive eigenvalue. Check for repeated "
+                         "grid coordinates (with 0 noise) and/or extreme hyperparameter values.",
+                         &eigenvalue, 1, 1);
+    }
+    grid_inverse_sqrt_eigenvalues_[i] = 1.0/std::sqrt(eigenvalue);
+  }
+
+  RecomputeMeanAndKInvY();
+}
+
+void GaussianProcess::ClearGridStructure() noexcept {
+  grid_sizes_.clear();
+  grid_coordinates_.clear();
+  grid_eigenvectors_.clear();
+  grid_inverse_sqrt_eigenvalues_.clear();
+}
+
+void GaussianProcess::WhitenColumns(int num_columns, double * restrict matrix) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  if (packed_cholesky_ && !is_grid()) {
+    PackedTriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_rows, num_columns, matrix);
+    return;
+  }
+  if (!is_grid()) {
+    TriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_rows, num_columns, num_rows, matrix);
+    return;
+  }
+
+  std::vector<double> scratch(num_rows*num_columns);
+  KroneckerMatrixMatrixMultiply(grid_eigenvectors_.data(), grid_sizes_.data(), dim_, 'T', num_columns, matrix,
+                                scratch.data());
+  for (int j = 0; j < num_columns; ++j) {
+    for (int i = 0; i < num_rows; ++i) {
+      matrix[j*num_rows + i] *= grid_inverse_sqrt_eigenvalues_[i];
+    }
+  }
+}
+
+void GaussianProcess::SolveCovariance(int num_columns, double * restrict matrix) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  if (packed_cholesky_ && !is_grid()) {
+    PackedCholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_rows, num_columns, matrix);
+    return;
+  }
+  if (!is_grid()) {
+    CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_rows, num_columns, matrix);
+    return;
+  }
+
+  std::vector<double> scratch(num_rows*num_columns);
+  KroneckerMatrixMatrixMultiply(grid_eigenvectors_.data(), grid_sizes_.data(), dim_, 'T', num_columns, matrix,
+                                scratch.data());
+  for (int j = 0; j < num_columns; ++j) {
+    for (int i = 0; i < num_rows; ++i) {
+      matrix[j*num_rows + i] *= Square(grid_inverse_sqrt_eigenvalues_[i]);
+    }
+  }
+  KroneckerMatrixMatrixMultiply(grid_eigenvectors_.data(), grid_sizes_.data(), dim_, 'N', num_columns, matrix,
+                                scratch.data());
+}
+
+/*!\rst
+  FITC fit (see the inducing-point constructor in gpp_math.hpp for the model).  With ``L_U = chol(K(U,U))``,
+  ``V = L_U^{-1} * K(U,X) * \Lambda^{-1/2}`` and ``C = V * V^T``:
+
+  | ``\Sigma = L_U^{-T} * (I + C)^{-1} * L_U^{-1}``, so ``K^-1 * y = L_U^{-T} * (I + C)^{-1} * V * \Lambda^{-1/2} * (y - mean)``
+  | ``K(U,U)^{-1} - \Sigma = (L_U * (I + C^{-1}) * L_U^T)^{-1}``, so ``K = K(U,U) + (L_U * P^{-T}) * (L_U * P^{-T})^T``, ``P = chol(C)``
+
+  ``K`` is the covariance of the equivalent pseudo-observations; the mean/variance code only ever sees its factor,
+  ``K_chol_``.  ``C`` and ``V * \Lambda^{-1/2} * (y - mean)`` accumulate over tiles of kSparseTrainingTileSize training
+  points, and ``\Lambda``'s FITC term, ``diag(K(X,X) - Q(X,X))``, is the squared column norm of ``V`` deducted
+  from the prior variance before scaling.
+\endrst*/
+void GaussianProcess::RecomputeSparseDerivedVariables() {
+  const int block_size = num_derivatives_ + 1;
+  const int num_inducing_rows = num_sampled_*block_size;
+  K_chol_.resize(Square(num_inducing_rows));
+  K_inv_y_.resize(num_inducing_rows);
+
+  mean_ = 0.0;
+  for (int i = 0; i < num_training_; ++i) {
+    mean_ += (*training_values_)[i*block_size];
+  }
+  mean_ /= num_training_;
+
+  // K(U,U) (jittered) is kept in K_chol_ until the pseudo-observation covariance is added to it below
+  BuildCovarianceMatrix(*covariance_ptr_, points_sampled_->data(), dim_, num_sampled_, derivatives_->data(),
+                        num_derivatives_, K_chol_.data());
+  std::vector<double> noise_floor(block_size);
+  for (int m = 0; m < block_size; ++m) {
+    noise_floor[m] = std::max(noise_variance_[m], kSparseMinimumRelativeNoise*K_chol_[m + m*num_inducing_rows]);
+  }
+  for (int i = 0; i < num_inducing_rows; ++i) {
+    K_chol_[i + i*num_inducing_rows] *= 1.0 + kInducingPointJitter;
+  }
+  AlignedVector<double> chol_inducing(K_chol_);
+  int leading_minor_index = ComputeCholeskyFactorL(num_inducing_rows, chol_inducing.data());
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException,
+                       "Inducing point covariance matrix K(U,U) singular. Check for duplicate inducing points "
+                       "and/or extreme hyperparameter values.",
+                       chol_inducing.data(), num_inducing_rows, leading_minor_index);
+  }
+  ZeroUpperTriangle(num_inducing_rows, chol_inducing.data());
+
+  const int max_tile_rows = std::min(kSparseTrainingTileSize, num_training_)*block_size;
+  std::vector<double> cross_tile(num_inducing_rows*max_tile_rows);
+  std::vector<double> cross_tile_transpose(num_inducing_rows*max_tile_rows);
+  std::vector<double> scaled_residual(max_tile_rows);
+  std::vector<double> self_covariance(Square(block_size));
+  std::vector<double> projected(Square(num_inducing_rows), 0.0);
+  std::vector<double> projected_residual(num_inducing_rows, 0.0);
+  for (int tile_start = 0; tile_start < num_training_; tile_start += kSparseTrainingTileSize) {
+    const int tile_points = std::min(kSparseTrainingTileSize, num_training_ - tile_start);
+    const int tile_rows = tile_points*block_size;
+    double const * restrict tile = training_points_->data() + tile_start*dim_;
+
+    // V_tile = L_U \ K(U, X_tile), then scaled column by column by \Lambda^{-1/2}
+    optimal_learning::BuildMixCovarianceMatrix(*covariance_ptr_, points_sampled_->data(), tile, dim_, num_sampled_,
+                                               tile_points, derivatives_->data(), num_derivatives_,
+                                               derivatives_->data(), num_derivatives_, cross_tile.data());
+    TriangularMatrixMatrixSolve(chol_inducing.data(), 'N', num_inducing_rows, tile_rows, num_inducing_rows,
+                                cross_tile.data());
+    for (int i = 0; i < tile_points; ++i) {
+      covariance_ptr_->Covariance(tile + i*dim_, derivatives_->data(), num_derivatives_, tile + i*dim_,
+                                  derivatives_->data(), num_derivatives_, self_covariance.data());
+      for (int m = 0; m < block_size; ++m) {
+        const int col = i*block_size + m;
+        double * restrict cross_col = cross_tile.data() + col*num_inducing_rows;
+        const double unexplained_variance = std::max(self_covariance[m + m*block_size] -
+                                                     DotProduct(cross_col, cross_col, num_inducing_rows), 0.0);
+        const double inverse_sqrt_lambda = 1.0/std::sqrt(unexplained_variance + noise_floor[m]);
+        VectorScale(num_inducing_rows, inverse_sqrt_lambda, cross_col);
+        double residual = (*training_values_)[(tile_start + i)*block_size + m];
+        if (m == 0) {
+          residual -= mean_;
+        }
+        scaled_residual[col] = inverse_sqrt_lambda*residual;
+      }
+    }
+
+    GeneralMatrixVectorMultiply(cross_tile.data(), 'N', scaled_residual.data(), 1.0, 1.0, num_inducing_rows,
+                                tile_rows, num_inducing_rows, projected_residual.data());
+    MatrixTranspose(cross_tile.data(), num_inducing_rows, tile_rows, cross_tile_transpose.data());
+    GeneralMatrixMatrixMultiply(cross_tile_transpose.data(), 'T', cross_tile_transpose.data(), 1.0, 1.0,
+                                num_inducing_rows, tile_rows, num_inducing_rows, projected.data());
+  }
+
+  // P = chol(C)
+  std::vector<double> chol_projected(projected);
+  leading_minor_index = ComputeCholeskyFactorL(num_inducing_rows, chol_projected.data());
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException,
+                       "Inducing point approximation singular: the training data do not determine every inducing "
+                       "point. Use fewer inducing points and/or place them near points_sampled.",
+                       chol_projected.data(), num_inducing_rows, leading_minor_index);
+  }
+
+  // K^-1 * y = L_U^{-T} * (I + C)^{-1} * V * \Lambda^{-1/2} * (y - mean); I + C is SPD whenever C is
+  for (int i = 0; i < num_inducing_rows; ++i) {
+    projected[i + i*num_inducing_rows] += 1.0;
+  }
+  leading_minor_index = ComputeCholeskyFactorL(num_inducing_rows, projected.data());
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException, "Inducing point approximation (I + C) singular.",
+                       projected.data(), num_inducing_rows, leading_minor_index);
+  }
+  std::copy(projected_residual.begin(), projected_residual.end(), K_inv_y_.begin());
+  CholeskyFactorLMatrixVectorSolve(projected.data(), num_inducing_rows, K_inv_y_.data());
+  TriangularMatrixVectorSolve(chol_inducing.data(), 'T', num_inducing_rows, num_inducing_rows, K_inv_y_.data());
+
+  // K = K(U,U) + Y^T * Y, Y = P \ L_U^T
+  std::vector<double> pseudo_noise_factor(Square(num_inducing_rows));
+  MatrixTranspose(chol_inducing.data(), num_inducing_rows, num_inducing_rows, pseudo_noise_factor.data());
+  TriangularMatrixMatrixSolve(chol_projected.data(), 'N', num_inducing_rows, num_inducing_rows, num_inducing_rows,
+                              pseudo_noise_factor.data());
+  GeneralMatrixMatrixMultiply(pseudo_noise_factor.data(), 'T', pseudo_noise_factor.data(), 1.0, 1.0,
+                              num_inducing_rows, num_inducing_rows, num_inducing_rows, K_chol_.data());
+  leading_minor_index = ComputeCholeskyFactorL(num_inducing_rows, K_chol_.data());
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException,
+                       "Inducing point pseudo-observation covariance matrix singular. Check for extreme "
+                       "hyperparameter values.",
+                       K_chol_.data(), num_inducing_rows, leading_minor_index);
+  }
+
+  // pseudo-observations, K * (K^-1 * y) + mean, so that points_sampled_value() describes the equivalent dense GP
+  std::vector<double> pseudo_values(K_inv_y_.begin(), K_inv_y_.end());
+  TriangularMatrixVectorMultiply(K_chol_.data(), 'T', num_inducing_rows, pseudo_values.data());
+  TriangularMatrixVectorMultiply(K_chol_.data(), 'N', num_inducing_rows, pseudo_values.data());
+  for (int i = 0; i < num_sampled_; ++i) {
+    pseudo_values[i*block_size] += mean_;
+  }
+  points_sampled_value_ = std::make_shared<const std::vector<double>>(std::move(pseudo_values));
+  PackCholeskyFactor();
 }
 
 GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
@@ -519,14 +987,172 @@ GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
       num_sampled_(num_sampled_in),
       mean_(0.0),
       covariance_ptr_(covariance_in.Clone()),
-      points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
-      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + num_sampled_in*(num_derivatives_in+1)),
-      derivatives_(derivatives_in, derivatives_in + num_derivatives_in),
+      points_sampled_(std::make_shared<const std::vector<double>>(points_sampled_in, points_sampled_in + num_sampled_in*dim_in)),
+      points_sampled_value_(std::make_shared<const std::vector<double>>(points_sampled_value_in,
+                                                                        points_sampled_value_in + num_sampled_in*(num_derivatives_in+1))),
+      derivatives_(std::make_shared<const std::vector<int>>(derivatives_in, derivatives_in + num_derivatives_in)),
       num_derivatives_(num_derivatives_in),
+      values_only_(num_derivatives_ == 0),
       noise_variance_(noise_variance_in, noise_variance_in + num_derivatives_in+1),
+      training_differences_(nullptr),
+      training_points_(nullptr),
+      training_values_(nullptr),
+      num_training_(0),
+      max_num_sampled_(0),
+      window_policy_(GaussianProcessWindowPolicy::kMostRecent),
+      cholesky_jitter_{0.0, 0.0, 0.0, 0},
+      packed_cholesky_(false),
       K_chol_(Square(num_sampled_in*(1+num_derivatives_in))),
       K_inv_y_(num_sampled_in*(1+num_derivatives_in)),
+      version_(0),
+      normal_rng_(kDefaultSeed) {
+  RecomputeDerivedVariables();
+}
+
+GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
+                                 std::shared_ptr<const std::vector<double>> points_sampled_in,
+                                 std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                                 double const * restrict noise_variance_in,
+                                 std::shared_ptr<const std::vector<int>> derivatives_in,
+                                 int dim_in, int num_sampled_in,
+                                 std::shared_ptr<const PairwiseDifferences> training_differences_in)
+    : covariance_ptr_(covariance_in.Clone()),
+      dim_(dim_in),
+      num_sampled_(num_sampled_in),
+      mean_(0.0),
+      points_sampled_(std::move(points_sampled_in)),
+      points_sampled_value_(std::move(points_sampled_value_in)),
+      derivatives_(std::move(derivatives_in)),
+      num_derivatives_(static_cast<int>(derivatives_->size())),
+      values_only_(num_derivatives_ == 0),
+      noise_variance_(noise_variance_in, noise_variance_in + num_derivatives_+1),
+      training_differences_(std::move(training_differences_in)),
+      training_points_(nullptr),
+      training_values_(nullptr),
+      num_training_(0),
+      max_num_sampled_(0),
+      window_policy_(GaussianProcessWindowPolicy::kMostRecent),
+      cholesky_jitter_{0.0, 0.0, 0.0, 0},
+      packed_cholesky_(false),
+      K_chol_(Square(num_sampled_in*(1+num_derivatives_))),
+      K_inv_y_(num_sampled_in*(1+num_derivatives_)),
+      version_(0),
+      normal_rng_(kDefaultSeed) {
+  RecomputeDerivedVariables();
+}
+
+GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
+                                 std::shared_ptr<const std::vector<double>> points_sampled_in,
+                                 std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                                 double const * restrict noise_variance_in,
+                                 std::shared_ptr<const std::vector<int>> derivatives_in,
+                                 int dim_in, int num_sampled_in,
+                                 double mean_in, double const * restrict K_chol_in, double const * restrict K_inv_y_in,
+                                 std::shared_ptr<const PairwiseDifferences> training_differences_in)
+    : covariance_ptr_(covariance_in.Clone()),
+      dim_(dim_in),
+      num_sampled_(num_sampled_in),
+      mean_(mean_in),
+      points_sampled_(std::move(points_sampled_in)),
+      points_sampled_value_(std::move(points_sampled_value_in)),
+      derivatives_(std::move(derivatives_in)),
+      num_derivatives_(static_cast<int>(derivatives_->size())),
+      values_only_(num_derivatives_ == 0),
+      noise_variance_(noise_variance_in, noise_variance_in + num_derivatives_+1),
+      training_differences_(std::move(training_differences_in)),
+      training_points_(nullptr),
+      training_values_(nullptr),
+      num_training_(0),
+      max_num_sampled_(0),
+      window_policy_(GaussianProcessWindowPolicy::kMostRecent),
+      cholesky_jitter_{0.0, 0.0, 0.0, 0},
+      packed_cholesky_(false),
+      K_chol_(K_chol_in, K_chol_in + Square(num_sampled_in*(1+num_derivatives_))),
+      K_inv_y_(K_inv_y_in, K_inv_y_in + num_sampled_in*(1+num_derivatives_)),
+      version_(NextGaussianProcessVersion()),
+      normal_rng_(kDefaultSeed) {
+  RecomputeScaledPointsSampled();
+}
+
+GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
+                                 double const * restrict points_sampled_in,
+                                 double const * restrict points_sampled_value_in,
+                                 double const * restrict noise_variance_in,
+                                 int const * restrict derivatives_in,
+                                 int num_derivatives_in,
+                                 int dim_in, int num_sampled_in,
+                                 double const * restrict inducing_points_in,
+                                 int num_inducing_in)
+    : covariance_ptr_(covariance_in.Clone()),
+      dim_(dim_in),
+      num_sampled_(num_inducing_in),
+      mean_(0.0),
+      points_sampled_(std::make_shared<const std::vector<double>>(inducing_points_in, inducing_points_in + num_inducing_in*dim_in)),
+      points_sampled_value_(nullptr),
+      derivatives_(std::make_shared<const std::vector<int>>(derivatives_in, derivatives_in + num_derivatives_in)),
+      num_derivatives_(num_derivatives_in),
+      values_only_(num_derivatives_ == 0),
+      noise_variance_(noise_variance_in, noise_variance_in + num_derivatives_in+1),
+      training_differences_(nullptr),
+      training_points_(std::make_shared<const std::vector<double>>(points_sampled_in, points_sampled_in + num_sampled_in*dim_in)),
+      training_values_(std::make_shared<const std::vector<double>>(points_sampled_value_in,
+                                                                   points_sampled_value_in + num_sampled_in*(num_derivatives_in+1))),
+      num_training_(num_sampled_in),
+      max_num_sampled_(0),
+      window_policy_(GaussianProcessWindowPolicy::kMostRecent),
+      cholesky_jitter_{0.0, 0.0, 0.0, 0},
+      packed_cholesky_(false),
+      K_chol_(Square(num_inducing_in*(1+num_derivatives_in))),
+      K_inv_y_(num_inducing_in*(1+num_derivatives_in)),
+      version_(0),
+      normal_rng_(kDefaultSeed) {
+  RecomputeDerivedVariables();
+}
+
+GaussianProcess::GaussianProcess(const CovarianceInterface& covariance_in,
+                                 double const * restrict grid_coordinates_in,
+                                 int const * restrict grid_sizes_in,
+                                 double const * restrict points_sampled_value_in,
+                                 double const * restrict noise_variance_in,
+                                 int dim_in)
+    : covariance_ptr_(covariance_in.Clone()),
+      dim_(dim_in),
+      num_sampled_(NumberOfGridPoints(grid_sizes_in, dim_in)),
+      mean_(0.0),
+      points_sampled_(nullptr),
+      points_sampled_value_(std::make_shared<const std::vector<double>>(points_sampled_value_in,
+                                                                        points_sampled_value_in + num_sampled_)),
+      derivatives_(std::make_shared<const std::vector<int>>()),
+      num_derivatives_(0),
+      values_only_(num_derivatives_ == 0),
+      noise_variance_(noise_variance_in, noise_variance_in + 1),
+      training_differences_(nullptr),
+      training_points_(nullptr),
+      training_values_(nullptr),
+      num_training_(0),
+      max_num_sampled_(0),
+      window_policy_(GaussianProcessWindowPolicy::kMostRecent),
+      cholesky_jitter_{0.0, 0.0, 0.0, 0},
+      packed_cholesky_(false),
+      grid_sizes_(grid_sizes_in, grid_sizes_in + dim_in),
+      grid_coordinates_(grid_coordinates_in, grid_coordinates_in + std::accumulate(grid_sizes_in, grid_sizes_in + dim_in, 0)),
+      K_chol_(),
+      K_inv_y_(num_sampled_),
+      version_(0),
       normal_rng_(kDefaultSeed) {
+  if (unlikely(dynamic_cast<const SquareExponential *>(covariance_ptr_.get()) == nullptr)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Grid (Kronecker) GPs require a SquareExponential covariance.");
+  }
+
+  // grid point i_0 + n_0*(i_1 + n_1*(...)) is (x_0[i_0], x_1[i_1], ...)
+  auto points_sampled = std::make_shared<std::vector<double>>(num_sampled_*dim_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    for (int d = 0, remaining_index = i, offset = 0; d < dim_; offset += grid_sizes_[d], ++d) {
+      (*points_sampled)[i*dim_ + d] = grid_coordinates_[offset + remaining_index % grid_sizes_[d]];
+      remaining_index /= grid_sizes_[d];
+    }
+  }
+  points_sampled_ = std::move(points_sampled);
   RecomputeDerivedVariables();
 }
 
@@ -539,9 +1165,26 @@ GaussianProcess::GaussianProcess(const GaussianProcess& source)
       points_sampled_value_(source.points_sampled_value_),
       derivatives_(source.derivatives_),
       num_derivatives_(source.num_derivatives_),
+      values_only_(source.values_only_),
       noise_variance_(source.noise_variance_),
+      training_differences_(source.training_differences_),
+      training_points_(source.training_points_),
+      training_values_(source.training_values_),
+      num_training_(source.num_training_),
+      max_num_sampled_(source.max_num_sampled_),
+      window_policy_(source.window_policy_),
+      cholesky_jitter_(source.cholesky_jitter_),
+      packed_cholesky_(source.packed_cholesky_),
+      derivative_mask_(source.derivative_mask_),
+      observed_rows_(source.observed_rows_),
+      grid_sizes_(source.grid_sizes_),
+      grid_coordinates_(source.grid_coordinates_),
+      grid_eigenvectors_(source.grid_eigenvectors_),
+      grid_inverse_sqrt_eigenvalues_(source.grid_inverse_sqrt_eigenvalues_),
+      scaled_points_sampled_(source.scaled_points_sampled_),
       K_chol_(source.K_chol_),
       K_inv_y_(source.K_inv_y_),
+      version_(source.version_),
       normal_rng_(source.normal_rng_) {
 }
 
@@ -556,54 +1199,128 @@ GaussianProcess::GaussianProcess(const GaussianProcess& source)
   | ``gradient of Ks := C_{d,k,i} = \pderiv{Ks_{k,i}}{Xs_{d,i}}`` (used by grad mean, grad variance)
 \endrst*/
 void GaussianProcess::FillPointsToSampleState(StateType * points_to_sample_state) const {
-  BuildMixCovarianceMatrix(points_to_sample_state->points_to_sample.data(),
-                           points_to_sample_state->num_to_sample,
-                           points_to_sample_state->gradients.data(),
-                           points_to_sample_state->num_gradients_to_sample,
-                           points_to_sample_state->K_star.data());
+  // trailing points unchanged since the last fill (e.g., points_being_sampled) keep their columns
+  const int num_moving = points_to_sample_state->num_to_sample - NumReusablePointsOfState(*points_to_sample_state);
+  const int num_moving_columns = num_moving*(points_to_sample_state->num_gradients_to_sample+1)*
+      num_sampled_*(num_derivatives_+1);
+  BuildMixCovarianceMatrixOfState(points_to_sample_state, num_moving);
 
   if (points_to_sample_state->precomputed){
     // to save on duplicate storage, precompute K^-1 * Ks
-    std::copy(points_to_sample_state->K_star.begin(), points_to_sample_state->K_star.end(),
+    std::copy(points_to_sample_state->K_star.begin(), points_to_sample_state->K_star.begin() + num_moving_columns,
               points_to_sample_state->K_inv_times_K_star.begin());
-    CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1),
-                                     points_to_sample_state->num_to_sample*(points_to_sample_state->num_gradients_to_sample+1),
-                                     points_to_sample_state->K_inv_times_K_star.data());
+    SolveCovariance(num_moving*(points_to_sample_state->num_gradients_to_sample+1),
+                    points_to_sample_state->K_inv_times_K_star.data());
+  }
+  MarkPointsToSampleStateFilled(points_to_sample_state);
+  FillGradientsOfPointsToSampleState(points_to_sample_state);
+}
+
+/*!\rst
+  Same derived quantities as FillPointsToSampleState(), but the ``K^-1 * Ks`` solves of every state with
+  ``precomputed`` set are done together: their ``Ks`` blocks are stacked column-wise into one
+  ``num_sampled x (\sum_k num_to_sample_k)`` right hand side, so the cholesky solve runs as ONE blocked triangular solve
+  (BLAS-3) instead of ``num_states`` narrow ones.  Results match FillPointsToSampleState() up to rounding.
+\endrst*/
+void GaussianProcess::FillPointsToSampleStateBatch(StateType * const * points_to_sample_states, int num_states) const {
+  const int num_observations = num_sampled_*(num_derivatives_+1);
+  // columns of each state that need (re)computing: those of its leading points that moved since its last fill
+  std::vector<int> num_moving_columns(num_states);
+  int total_num_columns = 0;
+  for (int k = 0; k < num_states; ++k) {
+    StateType * points_to_sample_state = points_to_sample_states[k];
+    const int num_moving = points_to_sample_state->num_to_sample - NumReusablePointsOfState(*points_to_sample_state);
+    num_moving_columns[k] = num_moving*(points_to_sample_state->num_gradients_to_sample+1);
+    BuildMixCovarianceMatrixOfState(points_to_sample_state, num_moving);
+    if (points_to_sample_state->precomputed) {
+      total_num_columns += num_moving_columns[k];
+    }
+  }
+
+  if (total_num_columns > 0) {
+    // Ks is stored column-major (one column of length num_observations per point), so blocks stack by concatenation
+    std::vector<double> stacked_K_star;
+    stacked_K_star.reserve(num_observations*total_num_columns);
+    for (int k = 0; k < num_states; ++k) {
+      if (points_to_sample_states[k]->precomputed) {
+        stacked_K_star.insert(stacked_K_star.end(), points_to_sample_states[k]->K_star.begin(),
+                              points_to_sample_states[k]->K_star.begin() + num_moving_columns[k]*num_observations);
+      }
+    }
+    SolveCovariance(total_num_columns, stacked_K_star.data());
+    auto stacked_column = stacked_K_star.cbegin();
+    for (int k = 0; k < num_states; ++k) {
+      if (points_to_sample_states[k]->precomputed) {
+        const int num_entries = num_moving_columns[k]*num_observations;
+        std::copy(stacked_column, stacked_column + num_entries,
+                  points_to_sample_states[k]->K_inv_times_K_star.begin());
+        stacked_column += num_entries;
+      }
+    }
+  }
+
+  for (int k = 0; k < num_states; ++k) {
+    MarkPointsToSampleStateFilled(points_to_sample_states[k]);
+    FillGradientsOfPointsToSampleState(points_to_sample_states[k]);
+  }
+}
+
+void GaussianProcess::FillGradientsOfPointsToSampleState(StateType * points_to_sample_state) const {
+  if (IsValuesOnly(*points_to_sample_state)) {
+    FillGradientsOfPointsToSampleStateImpl<true>(points_to_sample_state);
+  } else {
+    FillGradientsOfPointsToSampleStateImpl<false>(points_to_sample_state);
   }
+}
+
+bool GaussianProcess::IsValuesOnly(const StateType& points_to_sample_state) const noexcept {
+  return values_only_ && points_to_sample_state.num_gradients_to_sample == 0;
+}
+
+template <bool kValuesOnly>
+void GaussianProcess::FillGradientsOfPointsToSampleStateImpl(StateType * points_to_sample_state) const {
   // if we needs to taking derivative w.r.t. points_to_sample
   if (points_to_sample_state->num_derivatives > 0) {
+    const int block_size_to_sample = kValuesOnly ? 1 : points_to_sample_state->num_gradients_to_sample+1;
+    const int block_size_sampled = kValuesOnly ? 1 : num_derivatives_+1;
     double * restrict gKs_temp = points_to_sample_state->grad_K_star.data();
-    double * restrict grad_cov_temp = new double[dim_*(points_to_sample_state->num_gradients_to_sample+1)*(num_derivatives_+1)]();
+    double * restrict grad_cov_temp = points_to_sample_state->grad_cov.data();
     // also precompute C_{d,k,i} = \pderiv{Ks_{k,i}}{Xs_{d,i}}, stored in grad_K_star
     for (int i = 0; i < points_to_sample_state->num_derivatives; ++i) { // dim * num_sample_ * num_derivatives
       for (int j = 0; j < num_sampled_; ++j) {
+        if (kValuesOnly) {
+          // one dim-vector per (i, j), already in grad_K_star's layout: write it in place
+          covariance_ptr_->GradCovariance(points_to_sample_state->points_to_sample.data() + i*dim_,
+                                          points_to_sample_state->gradients.data(), 0,
+                                          points_sampled_->data() + j*dim_, derivatives_->data(), 0,
+                                          gKs_temp + (j + i*num_sampled_)*dim_);
+          continue;
+        }
         covariance_ptr_->GradCovariance(points_to_sample_state->points_to_sample.data() + i*dim_, points_to_sample_state->gradients.data(),
                                         points_to_sample_state->num_gradients_to_sample,
-                                        points_sampled_.data() + j*dim_, derivatives_.data(), num_derivatives_,
+                                        points_sampled_->data() + j*dim_, derivatives_->data(), num_derivatives_,
                                         grad_cov_temp);
-        for (int m = 0; m < points_to_sample_state->num_gradients_to_sample+1; ++m){
-            for (int n = 0; n < num_derivatives_+1; ++n){
-              int row = n + j*(num_derivatives_+1);
-              int col = m + i*(points_to_sample_state->num_gradients_to_sample+1);
+        for (int m = 0; m < block_size_to_sample; ++m){
+            for (int n = 0; n < block_size_sampled; ++n){
+              int row = n + j*block_size_sampled;
+              int col = m + i*block_size_to_sample;
               for (int d = 0; d <dim_; ++d){
-                gKs_temp[d + row*dim_ + col*dim_*num_sampled_*(num_derivatives_+1)] =
-                       grad_cov_temp[d+m*dim_+n*dim_*(points_to_sample_state->num_gradients_to_sample+1)];
+                gKs_temp[d + row*dim_ + col*dim_*num_sampled_*block_size_sampled] =
+                       grad_cov_temp[d+m*dim_+n*dim_*block_size_to_sample];
               }
             }
         }
       }
     }
-    delete [] grad_cov_temp;
 
     if (points_to_sample_state->precomputed_grad_K_inv_times_K_star){
-      const int row = num_sampled_*(num_derivatives_+1);
-      const int col = points_to_sample_state->num_derivatives*(points_to_sample_state->num_gradients_to_sample+1);
-      double * restrict gKs_temp = points_to_sample_state->grad_K_star.data();
+      const int row = num_sampled_*block_size_sampled;
+      const int col = points_to_sample_state->num_derivatives*block_size_to_sample;
       double * restrict g_kinv_Ks_temp = points_to_sample_state->grad_K_inv_times_K_star.data();
+      std::vector<double> transpose_temp(row*dim_, 0.0);
       for (int index = 0; index < col; index++){
-        std::vector<double> transpose_temp(row*dim_, 0.0);
         MatrixTranspose(gKs_temp + index*row*dim_, dim_, row, transpose_temp.data());
-        CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), row, dim_, transpose_temp.data());
+        SolveCovariance(dim_, transpose_temp.data());
         MatrixTranspose(transpose_temp.data(), row, dim_, g_kinv_Ks_temp + index*dim_*row);
       }
     }
@@ -619,6 +1336,12 @@ void GaussianProcess::FillPointsToSampleState(StateType * points_to_sample_state
 \endrst*/
 void GaussianProcess::ComputeMeanOfPoints(const StateType& points_to_sample_state,
                                           double * restrict mean_of_points) const noexcept {
+  if (IsValuesOnly(points_to_sample_state)) {
+    std::fill(mean_of_points, mean_of_points + points_to_sample_state.num_to_sample, mean_);
+    GeneralMatrixVectorMultiply(points_to_sample_state.K_star.data(), 'T', K_inv_y_.data(), 1.0, 1.0, num_sampled_,
+                                points_to_sample_state.num_to_sample, num_sampled_, mean_of_points);
+    return;
+  }
   for (int i=0; i<points_to_sample_state.num_to_sample; ++i){
     for (int j = 0; j<points_to_sample_state.num_gradients_to_sample+1; ++j){
         if (j==0){
@@ -651,6 +1374,12 @@ void GaussianProcess::ComputeMeanOfAdditionalPoints(double const * discrete_pts,
   BuildMixCovarianceMatrix(discrete_pts, num_pts,
                            gradients_discrete_pts, num_gradients_discrete_pts,
                            kt.data());
+  if (values_only_ && num_gradients_discrete_pts == 0) {
+    std::fill(mean_of_points, mean_of_points + num_pts, mean_);
+    GeneralMatrixVectorMultiply(kt.data(), 'T', K_inv_y_.data(), 1.0, 1.0, num_sampled_, num_pts, num_sampled_,
+                                mean_of_points);
+    return;
+  }
   for (int i=0; i<num_pts; ++i){
       for (int j = 0; j<num_gradients_discrete_pts+1; ++j){
           if (j==0){
@@ -735,7 +1464,8 @@ void GaussianProcess::ComputeCovarianceOfPoints(StateType * points_to_sample_sta
   }
   else {
     // Compute K_t
-    double * kt = new double[num_sampled_*(num_derivatives_+1)*num_pts*(num_gradients_discrete_pts+1)]();
+    points_to_sample_state->K_discrete.resize(num_sampled_*(num_derivatives_+1)*num_pts*(num_gradients_discrete_pts+1));
+    double * kt = points_to_sample_state->K_discrete.data();
     BuildMixCovarianceMatrix(discrete_pts, num_pts, gradients_discrete_pts, num_gradients_discrete_pts, kt);
     if (points_to_sample_state->precomputed){
         // compute as Ks^T * (K\ Ks), the 2nd term of which has been precomputed
@@ -748,20 +1478,16 @@ void GaussianProcess::ComputeCovarianceOfPoints(StateType * points_to_sample_sta
                   points_to_sample_state->V.begin());
 
         // V := L^-1 * K_star
-        TriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample+1),
-                                    num_sampled_*(num_derivatives_+1),
-                                    points_to_sample_state->V.data());
+        WhitenColumns(num_to_sample*(num_gradients_to_sample+1), points_to_sample_state->V.data());
 
         // W := L^-1 * K_t
-        TriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_sampled_*(num_derivatives_+1), num_pts*(num_gradients_discrete_pts+1),
-                                    num_sampled_*(num_derivatives_+1), kt);
+        WhitenColumns(num_pts*(num_gradients_discrete_pts+1), kt);
 
         // compute V^T W = (L^-1 * Ks)^T * (L^-1 * Kt).
         GeneralMatrixMatrixMultiply(points_to_sample_state->V.data(), 'T', kt,
                                     -1.0, 1.0, num_to_sample*(num_gradients_to_sample+1),
                                     num_sampled_*(num_derivatives_+1), num_pts*(num_gradients_discrete_pts+1), var_star);
     }
-    delete [] kt;
   }
 }
 
@@ -798,7 +1524,7 @@ void GaussianProcess::ComputeTrain(double const * restrict discrete_pts,
                   int num_pts, int const * restrict gradients_discrete_pts,
                   int num_gradients_discrete_pts, double * restrict var_star) const noexcept {
    BuildMixCovarianceMatrix(discrete_pts, num_pts, gradients_discrete_pts, num_gradients_discrete_pts, var_star);
-   CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), num_pts*(num_gradients_discrete_pts+1), var_star);
+   SolveCovariance(num_pts*(num_gradients_discrete_pts+1), var_star);
 }
 
 /*!\rst
@@ -864,9 +1590,17 @@ void GaussianProcess::ComputeVarianceOfPoints(StateType * points_to_sample_state
                                              gradients_to_sample_part2, num_gradients_to_sample_part2,
                                              var_star);
 
-  double * cov_temp_part2 = new double[(num_sampled_*(num_derivatives_+1)*num_to_sample*(num_gradients_to_sample_part2+1))]();
-  BuildMixCovarianceMatrix(points_to_sample_state->points_to_sample.data(), num_to_sample,
-                           gradients_to_sample_part2, num_gradients_to_sample_part2, cov_temp_part2);
+  // K(X, Xs) with the part2 derivatives is K_star itself when the derivative lists agree (and K_star is not consumed)
+  const bool part2_is_K_star = points_to_sample_state->precomputed &&
+      num_gradients_to_sample_part2 == num_gradients_to_sample &&
+      std::equal(gradients_to_sample_part2, gradients_to_sample_part2 + num_gradients_to_sample_part2,
+                 points_to_sample_state->gradients.begin());
+  std::vector<double> cov_temp_part2;
+  if (!part2_is_K_star) {
+    cov_temp_part2.resize(num_sampled_*(num_derivatives_+1)*num_to_sample*(num_gradients_to_sample_part2+1));
+    BuildMixCovarianceMatrix(points_to_sample_state->points_to_sample.data(), num_to_sample,
+                             gradients_to_sample_part2, num_gradients_to_sample_part2, cov_temp_part2.data());
+  }
 
   // following block computes Vars -= V^T*V, with the exact method depending on what quantities were precomputed
   if (unlikely(points_to_sample_state->precomputed == false)) {
@@ -874,26 +1608,83 @@ void GaussianProcess::ComputeVarianceOfPoints(StateType * points_to_sample_state
               points_to_sample_state->V.begin());
 
     // V := L^-1 * K_star
-    TriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample+1),
-                                num_sampled_*(num_derivatives_+1),
-                                points_to_sample_state->V.data());
+    WhitenColumns(num_to_sample*(num_gradients_to_sample+1), points_to_sample_state->V.data());
 
-    TriangularMatrixMatrixSolve(K_chol_.data(), 'N', num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample_part2+1),
-                                num_sampled_*(num_derivatives_+1),
-                                cov_temp_part2);
+    WhitenColumns(num_to_sample*(num_gradients_to_sample_part2+1), cov_temp_part2.data());
 
     // compute V^T V = (L^-1 * Ks)^T * (L^-1 * Ks).
-    GeneralMatrixMatrixMultiply(points_to_sample_state->V.data(), 'T', cov_temp_part2,
+    GeneralMatrixMatrixMultiply(points_to_sample_state->V.data(), 'T', cov_temp_part2.data(),
                                 -1.0, 1.0, num_to_sample*(num_gradients_to_sample+1),
                                 num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample_part2+1), var_star);
   } else {
     // compute as Ks^T * (K\ Ks), the 2nd term of which has been precomputed
     // this is cheaper than computing V^T * V when K \ Ks is already available
     GeneralMatrixMatrixMultiply(points_to_sample_state->K_inv_times_K_star.data(), 'T',
-                                cov_temp_part2, -1.0, 1.0, num_to_sample*(num_gradients_to_sample+1),
+                                part2_is_K_star ? points_to_sample_state->K_star.data() : cov_temp_part2.data(),
+                                -1.0, 1.0, num_to_sample*(num_gradients_to_sample+1),
                                 num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample_part2+1), var_star);
   }
-  delete [] cov_temp_part2;
+}
+
+void GaussianProcess::PredictMarginals(double const * restrict points, int num_points, int max_num_threads,
+                                       double * restrict mean_of_points, double * restrict variance_of_points) const {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const int num_tiles = (num_points + kPredictMarginalsTileSize - 1)/kPredictMarginalsTileSize;
+  const int num_threads = std::max(std::min(max_num_threads, num_tiles), 1);
+  // one K(X, Xs) tile per thread, allocated up front so that nothing in the parallel region can throw
+  std::vector<double> tile_storage(num_threads*num_rows*kPredictMarginalsTileSize);
+  // candidates contribute function values only
+  const int no_derivatives = 0;
+
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic) if(num_threads > 1)
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    const int first_point = tile*kPredictMarginalsTileSize;
+    const int tile_size = std::min(kPredictMarginalsTileSize, num_points - first_point);
+    double const * restrict tile_points = points + first_point*dim_;
+    double * restrict mean_tile = mean_of_points + first_point;
+    double * restrict V = tile_storage.data() + omp_get_thread_num()*num_rows*kPredictMarginalsTileSize;
+
+    // mus = mean + Ks^T * K^-1 * y
+    BuildMixCovarianceMatrix(tile_points, tile_size, &no_derivatives, 0, V);
+    std::fill(mean_tile, mean_tile + tile_size, mean_);
+    GeneralMatrixVectorMultiply(V, 'T', K_inv_y_.data(), 1.0, 1.0, num_rows, tile_size, num_rows, mean_tile);
+
+    // Vars_ii = Kss_ii - V_i^T * V_i, with V := L^-1 * Ks
+    WhitenColumns(tile_size, V);
+    for (int i = 0; i < tile_size; ++i) {
+      double prior_variance;
+      covariance_ptr_->Covariance(tile_points + i*dim_, &no_derivatives, 0, tile_points + i*dim_, &no_derivatives, 0,
+                                  &prior_variance);
+      variance_of_points[first_point + i] = prior_variance - DotProduct(V + i*num_rows, V + i*num_rows, num_rows);
+    }
+  }
+}
+
+void GaussianProcess::PredictMarginalsOfDifferences(const CrossPairwiseDifferences& cross_differences,
+                                                    double * restrict scratch, double * restrict mean_of_points,
+                                                    double * restrict variance_of_points) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const int num_points = cross_differences.num_points_two;
+  double const * restrict points = cross_differences.points_two.data();
+  const int no_derivatives = 0;
+
+  if (cross_differences.Matches(points_sampled_->data(), num_sampled_, points, num_points)) {
+    OL_PROFILE_SCOPE(ProfilePhase::kCovarianceMatrixBuild);
+    covariance_ptr_->CrossCovarianceMatrix(cross_differences, derivatives_->data(), num_derivatives_, nullptr, 0,
+                                           scratch);
+  } else {
+    BuildMixCovarianceMatrix(points, num_points, &no_derivatives, 0, scratch);
+  }
+  std::fill(mean_of_points, mean_of_points + num_points, mean_);
+  GeneralMatrixVectorMultiply(scratch, 'T', K_inv_y_.data(), 1.0, 1.0, num_rows, num_points, num_rows, mean_of_points);
+
+  WhitenColumns(num_points, scratch);
+  for (int i = 0; i < num_points; ++i) {
+    double prior_variance;
+    covariance_ptr_->Covariance(points + i*dim_, &no_derivatives, 0, points + i*dim_, &no_derivatives, 0,
+                                &prior_variance);
+    variance_of_points[i] = prior_variance - DotProduct(scratch + i*num_rows, scratch + i*num_rows, num_rows);
+  }
 }
 
 /*!\rst
@@ -963,9 +1754,9 @@ void GaussianProcess::ComputeVarianceOfPoints(StateType * points_to_sample_state
   present in our implementation.
 
   The first thing to notice is that the result, ``\pderiv{Vars_{i,j}}{Xs_{d,p}}``, has a lot of 0s.  In particular, only the
-  ``p``-th block row and ``p``-th block column have nonzero entries (blocks are size ``dim``, indexed ``d``).  Currently,
-  we will not be taking advantage of this sparsity because the consumer of DVars, ComputeGradCholeskyVarianceOfPoints(),
-  is not implemented with sparsity in mind.
+  ``p``-th block row and ``p``-th block column have nonzero entries (blocks are size ``dim``, indexed ``d``).  The result
+  is still stored densely, but ComputeGradCholeskyVarianceOfPointsPerPoint() skips the zero blocks in the columns before
+  the ``p``-th, and the adjoints (e.g., ComputeAdjointGradVarianceOfPoints()) never form them.
 
   Similarly, the next thing to notice is that if we ignore the case ``p == i == j``, then we see that the expressions for
   ``p == i`` and ``p == j`` are actually identical (e.g., take the ``p == j`` case and exchange ``j = i`` and ``k = l``).
@@ -1069,7 +1860,8 @@ void GaussianProcess::ComputeGradCovarianceOfPoints(StateType * points_to_sample
 
     if (precomputed == false) {
       // Compute K_t
-      double * kt = new double[num_sampled_*(num_derivatives_+1)*num_pts*(num_gradients_discrete_pts+1)]();
+      points_to_sample_state->K_discrete.resize(num_sampled_*(num_derivatives_+1)*num_pts*(num_gradients_discrete_pts+1));
+      double * kt = points_to_sample_state->K_discrete.data();
       BuildMixCovarianceMatrix(discrete_pts, num_pts, gradients_discrete_pts, num_gradients_discrete_pts, kt);
       if(points_to_sample_state->precomputed_grad_K_inv_times_K_star) {
         for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1081,7 +1873,7 @@ void GaussianProcess::ComputeGradCovarianceOfPoints(StateType * points_to_sample
       }
       else {
         // Compute K^-1 * K_t
-        CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), num_pts*(num_gradients_discrete_pts+1), kt);
+        SolveCovariance(num_pts*(num_gradients_discrete_pts+1), kt);
         for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
             ComputeGradCovarianceOfPointsPerPoint(points_to_sample_state, k, discrete_pts, num_pts,
                                                   gradients_discrete_pts, num_gradients_discrete_pts,
@@ -1089,7 +1881,6 @@ void GaussianProcess::ComputeGradCovarianceOfPoints(StateType * points_to_sample
             grad_var += block_size;
         }
       }
-      delete [] kt;
     }
     else{
         for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1168,9 +1959,9 @@ void GaussianProcess::ComputeGradCovarianceOfPoints(StateType * points_to_sample
   present in our implementation.
 
   The first thing to notice is that the result, ``\pderiv{Vars_{i,j}}{Xs_{d,p}}``, has a lot of 0s.  In particular, only the
-  ``p``-th block row and ``p``-th block column have nonzero entries (blocks are size ``dim``, indexed ``d``).  Currently,
-  we will not be taking advantage of this sparsity because the consumer of DVars, ComputeGradCholeskyVarianceOfPoints(),
-  is not implemented with sparsity in mind.
+  ``p``-th block row and ``p``-th block column have nonzero entries (blocks are size ``dim``, indexed ``d``).  The result
+  is still stored densely, but ComputeGradCholeskyVarianceOfPointsPerPoint() skips the zero blocks in the columns before
+  the ``p``-th, and the adjoints (e.g., ComputeAdjointGradVarianceOfPoints()) never form them.
 
   Similarly, the next thing to notice is that if we ignore the case ``p == i == j``, then we see that the expressions for
   ``p == i`` and ``p == j`` are actually identical (e.g., take the ``p == j`` case and exchange ``j = i`` and ``k = l``).
@@ -1191,11 +1982,13 @@ void GaussianProcess::ComputeGradCovarianceOfPoints(StateType * points_to_sample
 
   Again, only the ``p``-th point of ``points_to_sample`` is differentiated against; ``p`` specfied in ``diff_index``.
 \endrst*/
+template <bool kValuesOnly>
 void GaussianProcess::ComputeGradVarianceOfPointsPerPoint(StateType * points_to_sample_state,
                                                           int diff_index,
                                                           double * restrict grad_var) const noexcept {
   const int num_to_sample = points_to_sample_state->num_to_sample;
-  const int num_gradients_to_sample = points_to_sample_state->num_gradients_to_sample;
+  const int num_gradients_to_sample = kValuesOnly ? 0 : points_to_sample_state->num_gradients_to_sample;
+  const int num_derivatives = kValuesOnly ? 0 : num_derivatives_;
 
   // we only visit a small subset of the entries in this matrix; need to ensure the others are zero'd
   std::fill(grad_var, grad_var + dim_*Square(num_to_sample*(num_gradients_to_sample+1)), 0.0);
@@ -1211,9 +2004,9 @@ void GaussianProcess::ComputeGradVarianceOfPointsPerPoint(StateType * points_to_
   for (int i = 0; i<num_gradients_to_sample+1; ++i){ //col
       int col = diff_index*(num_gradients_to_sample+1)+i;
 
-      GeneralMatrixMatrixMultiply(points_to_sample_state->grad_K_star.data() + col*dim_*num_sampled_*(num_derivatives_+1), 'N',
+      GeneralMatrixMatrixMultiply(points_to_sample_state->grad_K_star.data() + col*dim_*num_sampled_*(num_derivatives+1), 'N',
                                   points_to_sample_state->K_inv_times_K_star.data(), 1.0, 0.0, dim_,
-                                  num_sampled_*(num_derivatives_+1), num_to_sample*(num_gradients_to_sample+1), grad_var_target_column);
+                                  num_sampled_*(num_derivatives+1), num_to_sample*(num_gradients_to_sample+1), grad_var_target_column);
 
       for (int j = 0; j < num_to_sample; ++j) {//row
           for (int n = 0; n < num_gradients_to_sample+1; ++n){//row
@@ -1293,9 +2086,14 @@ void GaussianProcess::ComputeGradVarianceOfPointsPerPoint(StateType * points_to_
 void GaussianProcess::ComputeGradVarianceOfPoints(StateType * points_to_sample_state,
                                                   double * restrict grad_var) const noexcept {
   int block_size = Square(points_to_sample_state->num_to_sample*(points_to_sample_state->num_gradients_to_sample+1))*dim_;
+  const bool values_only = IsValuesOnly(*points_to_sample_state);
   for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
-    ComputeGradVarianceOfPointsPerPoint(points_to_sample_state, k, grad_var);
-    grad_var += block_size;
+    if (values_only) {
+      ComputeGradVarianceOfPointsPerPoint<true>(points_to_sample_state, k, grad_var);
+    } else {
+      ComputeGradVarianceOfPointsPerPoint<false>(points_to_sample_state, k, grad_var);
+    }
+    grad_var += block_size;
   }
 }
 
@@ -1316,7 +2114,11 @@ void GaussianProcess::ComputeGradVarianceOfPoints(StateType * points_to_sample_s
 void GaussianProcess::ComputeGradCholeskyVarianceOfPointsPerPoint(StateType * points_to_sample_state,
                                                                   int diff_index, double const * restrict chol_var,
                                                                   double * restrict grad_chol) const noexcept {
-    ComputeGradVarianceOfPointsPerPoint(points_to_sample_state, diff_index, grad_chol);
+    if (IsValuesOnly(*points_to_sample_state)) {
+      ComputeGradVarianceOfPointsPerPoint<true>(points_to_sample_state, diff_index, grad_chol);
+    } else {
+      ComputeGradVarianceOfPointsPerPoint<false>(points_to_sample_state, diff_index, grad_chol);
+    }
 
     // TODO(GH-173): Try reorganizing Smith's algorithm to use an ordering analogous to the gaxpy
     // formulation of cholesky (currently it's organized like the outer-product version which results in
@@ -1347,9 +2149,14 @@ void GaussianProcess::ComputeGradCholeskyVarianceOfPointsPerPoint(StateType * po
 #define OL_CHOL_VAR(i, j) chol_var[((j)*num_to_sample + (i))]
 #define OL_GRAD_CHOL(m, i, j) grad_chol[((j)*num_to_sample*dim_ + (i)*dim_ + (m))]
 
+    // GV is zero outside the rows and columns [first_row, last_row) of point diff_index, and so is GL in the columns
+    // k < first_row: there, the update below only changes entries in those rows and columns.
+    const int first_row = diff_index*(1+num_gradients_to_sample);
+    const int last_row = first_row + 1 + num_gradients_to_sample;
     for (int k = 0; k < num_to_sample; ++k) {
         // L_kk := L_{kk}
         const double L_kk = OL_CHOL_VAR(k, k);
+        const bool sparse_column = k < first_row;
 
         if (likely(L_kk > kMinimumStdDev)) {
             // differentiates L_kk := L_{kk}
@@ -1368,8 +2175,9 @@ void GaussianProcess::ComputeGradCholeskyVarianceOfPointsPerPoint(StateType * po
 
             // differentiates L_{ij} = L_{ij} - L_{ik}*L_{jk}
             // GL_{mji} = GV_{mji} - GV_{mki}*L_{jk} - L_{ik}*GV_{mkj}
-            for (int j = k+1; j < num_to_sample; ++j) {
-                for (int i = j; i < num_to_sample; ++i) {
+            for (int j = k+1; j < (sparse_column ? last_row : num_to_sample); ++j) {
+                const bool sparse_row = sparse_column && j < first_row;
+                for (int i = (sparse_row ? first_row : j); i < (sparse_row ? last_row : num_to_sample); ++i) {
                     for (int m = 0; m < dim_; ++m) {
                         OL_GRAD_CHOL(m, j, i) = OL_GRAD_CHOL(m, j, i)
                         - OL_GRAD_CHOL(m, k, i)*OL_CHOL_VAR(j, k) - OL_CHOL_VAR(i, k)*OL_GRAD_CHOL(m, k, j);
@@ -1419,7 +2227,13 @@ void GaussianProcess::ComputeGradInverseCholeskyVarianceOfPointsPerPoint(StateTy
     std::vector<double> grad_cov(num_to_sample_gradients * (num_pts+num_to_sample_gradients) * dim_);
     ComputeGradCovarianceOfPointsPerPoint(points_to_sample_state, diff_index, discrete_pts, num_pts, nullptr, 0,
                                           precomputed, kt, grad_cov.data());
-    ComputeGradVarianceOfPointsPerPoint(points_to_sample_state, diff_index, grad_cov.data()+num_to_sample_gradients*num_pts*dim_);
+    if (IsValuesOnly(*points_to_sample_state)) {
+      ComputeGradVarianceOfPointsPerPoint<true>(points_to_sample_state, diff_index,
+                                                grad_cov.data()+num_to_sample_gradients*num_pts*dim_);
+    } else {
+      ComputeGradVarianceOfPointsPerPoint<false>(points_to_sample_state, diff_index,
+                                                 grad_cov.data()+num_to_sample_gradients*num_pts*dim_);
+    }
     for (int i = 0; i < dim_; ++i) {
          //part 1
          double* temp = new double[num_to_sample_gradients*(num_to_sample+num_pts)]();
@@ -1493,7 +2307,8 @@ void GaussianProcess::ComputeGradInverseCholeskyVarianceOfPoints(StateType * poi
 
   if (precomputed == false) {
     // Compute K_t
-    double * kt = new double[num_sampled_*(num_derivatives_+1)*num_pts]();
+    points_to_sample_state->K_discrete.resize(num_sampled_*(num_derivatives_+1)*num_pts);
+    double * kt = points_to_sample_state->K_discrete.data();
     BuildMixCovarianceMatrix(discrete_pts, num_pts, nullptr, 0, kt);
     if(points_to_sample_state->precomputed_grad_K_inv_times_K_star) {
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1504,14 +2319,13 @@ void GaussianProcess::ComputeGradInverseCholeskyVarianceOfPoints(StateType * poi
     }
     else {
       // Compute K^-1 * K_t
-      CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), num_pts, kt);
+      SolveCovariance(num_pts, kt);
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
         ComputeGradInverseCholeskyVarianceOfPointsPerPoint(points_to_sample_state, k, chol_var, var, cov,
                                                            discrete_pts, num_pts, true, kt, grad_chol);
         grad_chol += block_size;
       }
     }
-    delete [] kt;
   }
   else{
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1591,7 +2405,8 @@ void GaussianProcess::ComputeGradInverseCholeskyCovarianceOfPoints(StateType * p
 
   if (precomputed == false) {
     // Compute K_t
-    double * kt = new double[num_sampled_*(num_derivatives_+1)*num_pts]();
+    points_to_sample_state->K_discrete.resize(num_sampled_*(num_derivatives_+1)*num_pts);
+    double * kt = points_to_sample_state->K_discrete.data();
     BuildMixCovarianceMatrix(discrete_pts, num_pts, nullptr, 0, kt);
     if(points_to_sample_state->precomputed_grad_K_inv_times_K_star) {
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1603,7 +2418,7 @@ void GaussianProcess::ComputeGradInverseCholeskyCovarianceOfPoints(StateType * p
     }
     else {
       // Compute K^-1 * K_t
-      CholeskyFactorLMatrixMatrixSolve(K_chol_.data(), num_sampled_*(num_derivatives_+1), num_pts, kt);
+      SolveCovariance(num_pts, kt);
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
         double const * restrict grad_chol_pt = grad_chol + k*Square((points_to_sample_state->num_to_sample)*(points_to_sample_state->num_gradients_to_sample+1))*dim_;
         ComputeGradInverseCholeskyCovarianceOfPointsPerPoint(points_to_sample_state, k, chol_var, grad_chol_pt, chol_inv_times_cov,
@@ -1611,7 +2426,6 @@ void GaussianProcess::ComputeGradInverseCholeskyCovarianceOfPoints(StateType * p
         grad_inverse_chol += block_size;
       }
     }
-    delete [] kt;
   }
   else {
       for (int k = 0; k < points_to_sample_state->num_derivatives; ++k) {
@@ -1623,29 +2437,471 @@ void GaussianProcess::ComputeGradInverseCholeskyCovarianceOfPoints(StateType * p
   }
 }
 
+/*!\rst
+  Since ``\bar{V}`` is symmetric, the ``p``-th point's block row and block column of ``\pderiv{V}{x_p}`` (see
+  ComputeGradVarianceOfPointsPerPoint()) contribute equally, so::
+
+    grad_p += 2 * \sum_{j} \bar{V}_{j,p} * (\pderiv{Kss_{p,j}}{x_p} - \pderiv{Ks_{p,l}}{x_p} * C_{l,j})
+
+  where ``C = K^-1 * Ks`` (K_inv_times_K_star) and ``j`` runs over all (point, derivative) rows.  The second term is
+  ``grad_K_star`` times one column of ``C * \bar{V}``, which is formed once for all ``p``.
+\endrst*/
+void GaussianProcess::ComputeAdjointGradVarianceOfPoints(StateType * points_to_sample_state,
+                                                         double const * restrict var_adjoint,
+                                                         double * restrict grad) const {
+  if (IsValuesOnly(*points_to_sample_state)) {
+    ComputeAdjointGradVarianceOfPointsImpl<true>(points_to_sample_state, var_adjoint, grad);
+  } else {
+    ComputeAdjointGradVarianceOfPointsImpl<false>(points_to_sample_state, var_adjoint, grad);
+  }
+}
+
+template <bool kValuesOnly>
+void GaussianProcess::ComputeAdjointGradVarianceOfPointsImpl(StateType * points_to_sample_state,
+                                                             double const * restrict var_adjoint,
+                                                             double * restrict grad) const {
+  const int num_to_sample = points_to_sample_state->num_to_sample;
+  const int num_gradients_to_sample = kValuesOnly ? 0 : points_to_sample_state->num_gradients_to_sample;
+  const int num_to_sample_gradients = num_to_sample*(num_gradients_to_sample+1);
+  const int num_observations = kValuesOnly ? num_sampled_ : num_sampled_*(num_derivatives_+1);
+  // only the columns of the points being differentiated (the leading ones) are read below
+  const int num_moving_gradients = points_to_sample_state->num_derivatives*(num_gradients_to_sample+1);
+
+  // C * \bar{V}, [num_moving_gradients][num_observations]
+  std::vector<double> cov_times_adjoint(num_observations*num_moving_gradients);
+  GeneralMatrixMatrixMultiply(points_to_sample_state->K_inv_times_K_star.data(), 'N', var_adjoint, 1.0, 0.0,
+                              num_observations, num_to_sample_gradients, num_moving_gradients,
+                              cov_times_adjoint.data());
+
+  std::vector<double> grad_cov(dim_*Square(num_gradients_to_sample+1));
+  for (int p = 0; p < points_to_sample_state->num_derivatives; ++p) {
+    double * restrict grad_p = grad + p*dim_;
+    for (int n = 0; n < num_gradients_to_sample+1; ++n) {
+      const int col = p*(num_gradients_to_sample+1) + n;
+      GeneralMatrixVectorMultiply(points_to_sample_state->grad_K_star.data() + col*dim_*num_observations, 'N',
+                                  cov_times_adjoint.data() + col*num_observations, -2.0, 1.0, dim_, num_observations,
+                                  dim_, grad_p);
+    }
+
+    for (int j = 0; j < num_to_sample; ++j) {
+      covariance_ptr_->GradCovariance(points_to_sample_state->points_to_sample.data() + p*dim_,
+                                      points_to_sample_state->gradients.data(), num_gradients_to_sample,
+                                      points_to_sample_state->points_to_sample.data() + j*dim_,
+                                      points_to_sample_state->gradients.data(), num_gradients_to_sample,
+                                      grad_cov.data());
+      for (int m = 0; m < num_gradients_to_sample+1; ++m) {
+        for (int n = 0; n < num_gradients_to_sample+1; ++n) {
+          const int row = j*(num_gradients_to_sample+1) + m;
+          const int col = p*(num_gradients_to_sample+1) + n;
+          const double weight = 2.0*var_adjoint[col*num_to_sample_gradients + row];
+          for (int d = 0; d < dim_; ++d) {
+            grad_p[d] += weight*grad_cov[d + n*dim_ + m*dim_*(num_gradients_to_sample+1)];
+          }
+        }
+      }
+    }
+  }
+}
+
+void GaussianProcess::ComputeAdjointGradCholeskyVarianceOfPoints(StateType * points_to_sample_state,
+                                                                 double const * restrict chol_var,
+                                                                 double * restrict chol_adjoint,
+                                                                 double * restrict grad) const {
+  const int num_to_sample_gradients = points_to_sample_state->num_to_sample*
+      (points_to_sample_state->num_gradients_to_sample+1);
+  for (int k = 0; k < num_to_sample_gradients; ++k) {
+    if (unlikely(!(chol_var[k*num_to_sample_gradients + k] > kMinimumStdDev))) {
+      OL_ERROR_PRINTF("Grad Cholesky failed; matrix singular. k=%d\n", k);
+      return;
+    }
+  }
+  CholeskyFactorLAdjoint(num_to_sample_gradients, chol_var, chol_adjoint);
+  ComputeAdjointGradVarianceOfPoints(points_to_sample_state, chol_adjoint, grad);
+}
+
+/*!\rst
+  Only the ``p``-th point's rows of ``C`` depend on ``x_p`` (see ComputeGradCovarianceOfPointsPerPoint()), so::
+
+    grad_p += \sum_{i \in p, l} \bar{C}_{i,l} * (\pderiv{Ks(x_i, t_l)}{x_p} - \pderiv{Ks_{i,k}}{x_p} * (K^-1 * Ks(t_l))_k)
+
+  with ``t = discrete_pts``.  The second term is ``grad_K_star`` times one column of
+  ``K^-1 * Ks(t) * \bar{C}^T``, which is formed once for all ``p``.
+\endrst*/
+void GaussianProcess::ComputeAdjointGradCovarianceOfPoints(StateType * points_to_sample_state,
+                                                           double const * restrict discrete_pts, int num_pts,
+                                                           double const * restrict cov_adjoint,
+                                                           double * restrict grad) const {
+  const int num_gradients_to_sample = points_to_sample_state->num_gradients_to_sample;
+  const int num_to_sample_gradients = points_to_sample_state->num_to_sample*(num_gradients_to_sample+1);
+  const int num_observations = num_sampled_*(num_derivatives_+1);
+  // only the rows of \bar{C} of the points being differentiated (the leading ones) are read below
+  const int num_moving_gradients = points_to_sample_state->num_derivatives*(num_gradients_to_sample+1);
+
+  // K^-1 * Ks(t); the discrete points carry no derivatives
+  std::vector<int> discrete_gradients;
+  points_to_sample_state->K_discrete.resize(num_observations*num_pts);
+  double * restrict kt = points_to_sample_state->K_discrete.data();
+  BuildMixCovarianceMatrix(discrete_pts, num_pts, discrete_gradients.data(), discrete_gradients.size(), kt);
+  SolveCovariance(num_pts, kt);
+
+  // K^-1 * Ks(t) * \bar{C}^T over the moving rows of \bar{C}, [num_moving_gradients][num_observations]
+  std::vector<double> cov_adjoint_transpose(num_pts*num_moving_gradients);
+  for (int row = 0; row < num_moving_gradients; ++row) {
+    for (int l = 0; l < num_pts; ++l) {
+      cov_adjoint_transpose[row*num_pts + l] = cov_adjoint[l*num_to_sample_gradients + row];
+    }
+  }
+  std::vector<double> kt_times_adjoint(num_observations*num_moving_gradients);
+  GeneralMatrixMatrixMultiply(kt, 'N', cov_adjoint_transpose.data(), 1.0, 0.0, num_observations, num_pts,
+                              num_moving_gradients, kt_times_adjoint.data());
+
+  std::vector<double> grad_cov(dim_*(num_gradients_to_sample+1));
+  for (int p = 0; p < points_to_sample_state->num_derivatives; ++p) {
+    double * restrict grad_p = grad + p*dim_;
+    for (int m = 0; m < num_gradients_to_sample+1; ++m) {
+      const int row = p*(num_gradients_to_sample+1) + m;
+      GeneralMatrixVectorMultiply(points_to_sample_state->grad_K_star.data() + row*dim_*num_observations, 'N',
+                                  kt_times_adjoint.data() + row*num_observations, -1.0, 1.0, dim_, num_observations,
+                                  dim_, grad_p);
+    }
+
+    for (int l = 0; l < num_pts; ++l) {
+      covariance_ptr_->GradCovariance(points_to_sample_state->points_to_sample.data() + p*dim_,
+                                      points_to_sample_state->gradients.data(), num_gradients_to_sample,
+                                      discrete_pts + l*dim_, discrete_gradients.data(), discrete_gradients.size(),
+                                      grad_cov.data());
+      for (int m = 0; m < num_gradients_to_sample+1; ++m) {
+        const double weight = cov_adjoint[l*num_to_sample_gradients + p*(num_gradients_to_sample+1) + m];
+        for (int d = 0; d < dim_; ++d) {
+          grad_p[d] += weight*grad_cov[d + m*dim_];
+        }
+      }
+    }
+  }
+}
+
+/*!\rst
+  Appends the new points to the existing cholesky factor instead of refactoring from scratch.
+
+  Partition the updated covariance as::
+
+    K' = [ K_11   K_12 ]   L' = [ L_11    0   ]
+         [ K_21   K_22 ]        [ L_21   L_22 ]
+
+  where ``K_11 = L_11 * L_11^T`` is the already-factored prior.  Then ``L_21^T = L_11 \ K_12`` (triangular solve,
+  ``O(N^2*k)``) and ``L_22 = chol(K_22 - L_21 * L_21^T)`` (Schur complement, ``O(N*k^2 + k^3)``).  Here ``N`` and ``k``
+  count (point, derivative) rows, i.e., ``num_sampled*(num_derivatives+1)`` and ``num_new_points*(num_derivatives+1)``.
+
+  ``mean_`` changes with every new point, so ``K^-1 * y`` is re-solved against ``L'`` (two triangular solves, ``O(N^2)``).
+
+  If the Schur complement is not SPD (e.g., a new point nearly duplicates an old one), we fall back to
+  RecomputeDerivedVariables(), which refactors ``K'`` and throws SingularMatrixException if that fails too.
+\endrst*/
 void GaussianProcess::AddPointsToGP(double const * restrict new_points,
                                     double const * restrict new_points_value,
 //                                    double const * restrict new_points_noise_variance,
                                     int num_new_points) {
+  // the training data may be shared with other GPs, so it is replaced by an extended copy rather than modified;
+  // in FITC mode the new points join the training data, not the inducing points
+  auto points_sampled_new = std::make_shared<std::vector<double>>(is_sparse() ? *training_points_ : *points_sampled_);
+  points_sampled_new->insert(points_sampled_new->end(), new_points, new_points + num_new_points*dim_);
+
+  auto points_sampled_value_new = std::make_shared<std::vector<double>>(is_sparse() ? *training_values_ :
+                                                                        *points_sampled_value_);
+  points_sampled_value_new->insert(points_sampled_value_new->end(), new_points_value,
+                                   new_points_value + num_new_points*(num_derivatives_+1));
+
+//  noise_variance_.resize(num_sampled_);
+//  std::copy_backward(new_points_noise_variance, new_points_noise_variance + num_new_points, noise_variance_.end());
+
+  AddPointsToGP(std::move(points_sampled_new), std::move(points_sampled_value_new), num_new_points);
+  EnforceSlidingWindow();
+}
+
+void GaussianProcess::AddPointsToGP(std::shared_ptr<const std::vector<double>> points_sampled_in,
+                                    std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                                    int num_new_points,
+                                    std::shared_ptr<const PairwiseDifferences> training_differences_in) {
+  version_ = NextGaussianProcessVersion();
+  training_differences_ = std::move(training_differences_in);
+  if (is_sparse()) {
+    // the inducing points are fixed, so the approximation is refit against the extended training data
+    training_points_ = std::move(points_sampled_in);
+    training_values_ = std::move(points_sampled_value_in);
+    num_training_ += num_new_points;
+    RecomputeSparseDerivedVariables();
+    return;
+  }
+
+  const int num_old_sampled = num_sampled_;
+  const int old_size = num_old_sampled*(num_derivatives_+1);
+  const int new_size = num_new_points*(num_derivatives_+1);
+  const int total_size = old_size + new_size;
+  if (!derivative_mask_.empty()) {
+    // new points observe every derivative
+    derivative_mask_.resize((num_old_sampled + num_new_points)*num_derivatives_, 1);
+  }
+
+  // the factor is extended in square form (and re-packed below)
+  UnpackCholeskyFactor();
+
   // update sizes
   num_sampled_ += num_new_points;
+  RecomputeObservedRows();
 
   // update state variables
-  points_sampled_.resize(num_sampled_*dim_);
-  std::copy_backward(new_points, new_points + num_new_points*dim_, points_sampled_.end());
+  points_sampled_ = std::move(points_sampled_in);
+  points_sampled_value_ = std::move(points_sampled_value_in);
+  double const * restrict new_points = points_sampled_->data() + num_old_sampled*dim_;
+
+  if (unlikely(is_grid() && num_new_points > 0)) {
+    // the extended data are no longer a full grid
+    ClearGridStructure();
+    RecomputeDerivedVariables();
+    return;
+  }
+  if (unlikely(num_old_sampled == 0 || num_new_points == 0)) {
+    RecomputeDerivedVariables();
+    return;
+  }
 
-  points_sampled_value_.resize(num_sampled_*(num_derivatives_+1));
-  std::copy_backward(new_points_value, new_points_value + num_new_points*(num_derivatives_+1), points_sampled_value_.end());
+  // L_21^T = L_11 \ K_12, K_12 = cov(X_old, X_new)
+  std::vector<double> chol_cross(old_size*new_size);
+  optimal_learning::BuildMixCovarianceMatrix(*covariance_ptr_, points_sampled_->data(), new_points, dim_,
+                                             num_old_sampled, num_new_points, derivatives_->data(), num_derivatives_,
+                                             derivatives_->data(), num_derivatives_, chol_cross.data());
+  // masked rows are decoupled from every other observation
+  for (int i = 0; i < num_old_sampled*num_derivatives_ && !derivative_mask_.empty(); ++i) {
+    if (derivative_mask_[i] == 0) {
+      const int row = (i/num_derivatives_)*(num_derivatives_+1) + 1 + i % num_derivatives_;
+      for (int j = 0; j < new_size; ++j) {
+        chol_cross[row + j*old_size] = 0.0;
+      }
+    }
+  }
+  TriangularMatrixMatrixSolve(K_chol_.data(), 'N', old_size, new_size, old_size, chol_cross.data());
+
+  // L_22 = chol(K_22 - L_21 * L_21^T)
+  std::vector<double> chol_schur(Square(new_size));
+  optimal_learning::BuildCovarianceMatrixWithNoiseVariance(*covariance_ptr_, noise_variance_.data(), new_points, dim_,
+                                                           num_new_points, derivatives_->data(), num_derivatives_,
+                                                           chol_schur.data());
+  GeneralMatrixMatrixMultiply(chol_cross.data(), 'T', chol_cross.data(), -1.0, 1.0, new_size, old_size, new_size,
+                              chol_schur.data());
+  if (unlikely(ComputeBlockCholeskyFactorL(new_size, num_derivatives_+1, chol_schur.data()) != 0)) {
+    RecomputeDerivedVariables();
+    return;
+  }
 
-//  noise_variance_.resize(num_sampled_);
-//  std::copy_backward(new_points_noise_variance, new_points_noise_variance + num_new_points, noise_variance_.end());
+  // re-lay out K_chol_ with leading dimension total_size; walk columns backward so the resize can be done in place
+  K_chol_.resize(Square(total_size));
+  for (int j = total_size - 1; j >= 0; --j) {
+    double * chol_col = K_chol_.data() + j*total_size;
+    if (j < old_size) {
+      std::copy_backward(K_chol_.data() + j*old_size, K_chol_.data() + (j+1)*old_size, chol_col + old_size);
+      for (int i = 0; i < new_size; ++i) {
+        chol_col[old_size + i] = chol_cross[j + i*old_size];
+      }
+    } else {
+      std::fill(chol_col, chol_col + total_size, 0.0);
+      std::copy(chol_schur.data() + (j-old_size)*new_size + (j-old_size), chol_schur.data() + (j-old_size+1)*new_size,
+                chol_col + j);
+    }
+  }
+  // the upper triangle is never read, but keep it zero like a freshly built factor
+  for (int j = 0; j < old_size; ++j) {
+    std::fill(K_chol_.data() + j*total_size, K_chol_.data() + j*total_size + j, 0.0);
+  }
 
-  // recompute derived quantities
-  // TODO(GH-192): Insert the new covariance (and cholesky covariance) rows into the current matrix  (O(N^2))
-  // instead of recomputing everything (O(N^3)).
-  RecomputeDerivedVariables();
+  PackCholeskyFactor();
+  RecomputeScaledPointsSampled();
+  RecomputeMeanAndKInvY();
+}
+
+/*!\rst
+  Removes the points from the existing cholesky factor instead of refactoring from scratch.
+
+  Partition the covariance around the ``b`` rows of one removed point::
+
+    K = [ K_11   K_12   K_13 ]   L = [ L_11    0      0   ]
+        [ K_21   K_22   K_23 ]       [ L_21   L_22    0   ]
+        [ K_31   K_32   K_33 ]       [ L_31   L_32   L_33 ]
+
+  Deleting the middle block row and column leaves ``[K_11 K_13; K_31 K_33]``, whose factor is
+  ``[L_11 0; L_31 L_33']`` with ``L_33' * L_33'^T = L_33 * L_33^T + L_32 * L_32^T``: ``b`` rank-one *updates* of the
+  trailing factor (``O(N^2*b)``), which unlike general downdates cannot lose positive definiteness.  The factor is
+  then compacted in place to leading dimension ``N - b``.  Points are removed last to first so the earlier indices
+  stay valid.
+
+  ``mean_`` changes with the data, so ``K^-1 * y`` is re-solved against the new factor (``O(N^2)``).
+\endrst*/
+void GaussianProcess::RemovePointsFromGP(int const * restrict indices, int num_points_to_remove) {
+  const int num_points = num_training_points();
+  if (unlikely(num_points_to_remove < 0 || num_points_to_remove >= num_points)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "Must remove fewer points than the GP holds.", num_points_to_remove, 0,
+                       num_points - 1);
+  }
+  for (int i = 0; i < num_points_to_remove; ++i) {
+    const int min_index = i == 0 ? 0 : indices[i-1] + 1;
+    if (unlikely(indices[i] < min_index || indices[i] >= num_points)) {
+      OL_THROW_EXCEPTION(BoundsException<int>, "Indices of points to remove must be strictly increasing and in range.",
+                         indices[i], min_index, num_points - 1);
+    }
+  }
+  if (unlikely(num_points_to_remove == 0)) {
+    return;
+  }
+
+  // the training data may be shared with other GPs, so it is replaced by a reduced copy rather than modified
+  const int block_size = num_derivatives_ + 1;
+  const std::vector<double>& points_old = is_sparse() ? *training_points_ : *points_sampled_;
+  const std::vector<double>& values_old = is_sparse() ? *training_values_ : *points_sampled_value_;
+  auto points_kept = std::make_shared<std::vector<double>>();
+  auto values_kept = std::make_shared<std::vector<double>>();
+  points_kept->reserve((num_points - num_points_to_remove)*dim_);
+  values_kept->reserve((num_points - num_points_to_remove)*block_size);
+  std::vector<int> derivative_mask_kept;
+  for (int i = 0, next_removed = 0; i < num_points; ++i) {
+    if (next_removed < num_points_to_remove && indices[next_removed] == i) {
+      ++next_removed;
+      continue;
+    }
+    points_kept->insert(points_kept->end(), points_old.begin() + i*dim_, points_old.begin() + (i+1)*dim_);
+    values_kept->insert(values_kept->end(), values_old.begin() + i*block_size, values_old.begin() + (i+1)*block_size);
+    if (!derivative_mask_.empty()) {
+      derivative_mask_kept.insert(derivative_mask_kept.end(), derivative_mask_.begin() + i*num_derivatives_,
+                                  derivative_mask_.begin() + (i+1)*num_derivatives_);
+    }
+  }
+  training_differences_ = nullptr;
+
+  if (is_sparse()) {
+    // the inducing points are fixed, so the approximation is refit against the reduced training data
+    training_points_ = std::move(points_kept);
+    training_values_ = std::move(values_kept);
+    num_training_ -= num_points_to_remove;
+    RecomputeDerivedVariables();
+    return;
+  }
+  if (is_grid()) {
+    // the reduced data are no longer a full grid
+    ClearGridStructure();
+    num_sampled_ -= num_points_to_remove;
+    points_sampled_ = std::move(points_kept);
+    points_sampled_value_ = std::move(values_kept);
+    RecomputeDerivedVariables();
+    return;
+  }
+
+  UnpackCholeskyFactor();
+  int size = num_sampled_*block_size;
+  std::vector<double> update_column(size);
+  for (int r = num_points_to_remove - 1; r >= 0; --r) {
+    const int row_begin = indices[r]*block_size;
+    const int row_end = row_begin + block_size;
+
+    // L_33' = chol(L_33 * L_33^T + L_32 * L_32^T), one column of L_32 at a time
+    double * restrict chol_trailing = K_chol_.data() + row_end*size + row_end;
+    for (int j = row_begin; j < row_end; ++j) {
+      std::copy(K_chol_.data() + j*size + row_end, K_chol_.data() + (j+1)*size, update_column.data());
+      CholeskyFactorLRankOneUpdate(size - row_end, size, chol_trailing, update_column.data());
+    }
+
+    // drop the block's rows and columns; every entry moves to a lower address, so walk forward
+    const int new_size = size - block_size;
+    for (int j = 0; j < new_size; ++j) {
+      double const * source_col = K_chol_.data() + (j < row_begin ? j : j + block_size)*size;
+      double * chol_col = K_chol_.data() + j*new_size;
+      for (int i = 0; i < new_size; ++i) {
+        chol_col[i] = source_col[i < row_begin ? i : i + block_size];
+      }
+    }
+    size = new_size;
+  }
+  K_chol_.resize(Square(size));
+
+  num_sampled_ -= num_points_to_remove;
+  points_sampled_ = std::move(points_kept);
+  points_sampled_value_ = std::move(values_kept);
+  derivative_mask_.swap(derivative_mask_kept);
+  RecomputeObservedRows();
+  version_ = NextGaussianProcessVersion();
+  PackCholeskyFactor();
+  RecomputeScaledPointsSampled();
+  RecomputeMeanAndKInvY();
+}
+
+void GaussianProcess::SetSlidingWindow(int max_num_sampled_in, GaussianProcessWindowPolicy window_policy_in) {
+  if (unlikely(max_num_sampled_in < 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "max_num_sampled must be nonnegative (0 = no window).",
+                       max_num_sampled_in, 0);
+  }
+  if (unlikely(is_sparse() && window_policy_in == GaussianProcessWindowPolicy::kMostInformative)) {
+    OL_THROW_EXCEPTION(InvalidValueException<int>, "Sparse (FITC) GPs only support kMostRecent windows.",
+                       static_cast<int>(window_policy_in), static_cast<int>(GaussianProcessWindowPolicy::kMostRecent));
+  }
+  max_num_sampled_ = max_num_sampled_in;
+  window_policy_ = window_policy_in;
+  EnforceSlidingWindow();
+}
+
+void GaussianProcess::SetCholeskyJitter(double initial_relative_jitter, double max_relative_jitter) {
+  if (unlikely(!(max_relative_jitter >= 0.0) || max_relative_jitter == std::numeric_limits<double>::infinity())) {
+    OL_THROW_EXCEPTION(BoundsException<double>, "max_relative_jitter must be finite and nonnegative (0 = no jitter).",
+                       max_relative_jitter, 0.0, std::numeric_limits<double>::max());
+  }
+  if (unlikely(max_relative_jitter > 0.0 &&
+               !(initial_relative_jitter > 0.0 && initial_relative_jitter <= max_relative_jitter))) {
+    OL_THROW_EXCEPTION(BoundsException<double>, "initial_relative_jitter must be in (0, max_relative_jitter].",
+                       initial_relative_jitter, std::numeric_limits<double>::min(), max_relative_jitter);
+  }
+  cholesky_jitter_.initial_relative_jitter = initial_relative_jitter;
+  cholesky_jitter_.max_relative_jitter = max_relative_jitter;
+}
+
+/*!\rst
+  kMostRecent evicts the leading (oldest) points.  kMostInformative evicts the points with the largest
+  ``[K^-1]_{ii}`` on their function value row: ``1/[K^-1]_{ii}`` is the leave-one-out predictive variance of that
+  value, so these are the points the others already predict best.  ``[K^-1]_{ii} = |L^-1 e_i|^2`` costs one
+  triangular solve per point (``O(N^3)`` in all), so all excess points are chosen from a single solve rather than
+  greedily.
+\endrst*/
+void GaussianProcess::EnforceSlidingWindow() {
+  const int num_excess = num_training_points() - max_num_sampled_;
+  if (max_num_sampled_ == 0 || num_excess <= 0) {
+    return;
+  }
+
+  std::vector<int> indices(num_excess);
+  if (window_policy_ == GaussianProcessWindowPolicy::kMostRecent) {
+    std::iota(indices.begin(), indices.end(), 0);
+  } else {
+    const int block_size = num_derivatives_ + 1;
+    const int size = num_sampled_*block_size;
+    std::vector<double> inverse_chol_columns(size*num_sampled_, 0.0);
+    for (int i = 0; i < num_sampled_; ++i) {
+      inverse_chol_columns[i*size + i*block_size] = 1.0;
+    }
+    WhitenColumns(num_sampled_, inverse_chol_columns.data());
+
+    std::vector<double> precision(num_sampled_);
+    for (int i = 0; i < num_sampled_; ++i) {
+      double const * column = inverse_chol_columns.data() + i*size;
+      precision[i] = std::inner_product(column, column + size, column, 0.0);
+    }
+    std::vector<int> order(num_sampled_);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + num_excess, order.end(), [&precision](int a, int b) {
+      return precision[a] > precision[b];
+    });
+    std::copy(order.begin(), order.begin() + num_excess, indices.begin());
+    std::sort(indices.begin(), indices.end());
+  }
+  RemovePointsFromGP(indices.data(), num_excess);
 }
 
+namespace {  // sampling cores shared by GaussianProcess and GaussianProcessSampler; they read the GP only
+
 /*!\rst
   Samples function values from a GPP given a list of points.
 
@@ -1658,63 +2914,61 @@ void GaussianProcess::AddPointsToGP(double const * restrict new_points,
   of a single point. Then we iterate through the remaining points in points_sampled, generating gpp_mean, gpp_variance,
   and a sample function value.
 \endrst*/
-void GaussianProcess::SamplePointFromGP(double const * restrict point_to_sample,
-//                                      double noise_variance_this_point,
-                                        double * results) noexcept {
-  double * gpp_variance = new double[Square(1+num_derivatives_)]();
-  double * gpp_mean = new double[1+num_derivatives_]();
+void SamplePointFromGPCore(const GaussianProcess& gaussian_process, double const * restrict point_to_sample,
+                           NormalRNG * normal_rng, std::vector<double> * scratch, double * results) noexcept {
+  const int num_derivatives_gp = gaussian_process.num_derivatives();
+  // temporaries live in scratch so repeated sampling does no heap work
+  scratch->resize(Square(1+num_derivatives_gp) + 2*(1+num_derivatives_gp));
+  double * gpp_variance = scratch->data();
+  double * gpp_mean = gpp_variance + Square(1+num_derivatives_gp);
   const int num_to_sample = 1;  // we will only draw 1 point at a time from the GP
-  double * random_sample = new double[1+num_derivatives_]();
-  for (int i = 0; i < 1+num_derivatives_; ++i){
-      random_sample[i] = normal_rng_();
-      results[i] = 0;
-  }
-
-  if (unlikely(num_sampled_ == 0)) {
-    BuildCovarianceMatrix(*covariance_ptr_, point_to_sample, dim_, num_to_sample,
-                          derivatives_.data(), num_derivatives_, gpp_variance);
-    ComputeCholeskyFactorL(1+num_derivatives_, gpp_variance);
-    TriangularMatrixVectorMultiply(gpp_variance, 'N', num_derivatives_+1, random_sample);
-    for (int i = 0; i < 1+num_derivatives_; ++i){
+  double * random_sample = gpp_mean + (1+num_derivatives_gp);
+  normal_rng->Fill(random_sample, 1+num_derivatives_gp);
+  std::fill(results, results + 1+num_derivatives_gp, 0.0);
+
+  int const * derivatives = gaussian_process.derivatives().data();
+  if (unlikely(gaussian_process.num_sampled() == 0)) {
+    BuildCovarianceMatrix(*gaussian_process.covariance_ptr_, point_to_sample, gaussian_process.dim(), num_to_sample,
+                          derivatives, num_derivatives_gp, gpp_variance);
+    ComputeCholeskyFactorL(1+num_derivatives_gp, gpp_variance);
+    TriangularMatrixVectorMultiply(gpp_variance, 'N', num_derivatives_gp+1, random_sample);
+    for (int i = 0; i < 1+num_derivatives_gp; ++i){
         results[i] += random_sample[i];
     }
-    //return std::sqrt(gpp_variance) * normal_rng_() + std::sqrt(noise_variance_this_point)*normal_rng_();  // first draw has mean 0
   } else {
     int num_derivatives = 0;
-    StateType points_to_sample_state(*this, point_to_sample, num_to_sample, derivatives_.data(), num_derivatives_, num_derivatives);
-
-    ComputeMeanOfPoints(points_to_sample_state, gpp_mean);
-    ComputeVarianceOfPoints(&points_to_sample_state, derivatives_.data(), num_derivatives_, gpp_variance);
-    ComputeCholeskyFactorL(1+num_derivatives_, gpp_variance);
-    TriangularMatrixVectorMultiply(gpp_variance, 'N', 1+num_derivatives_, random_sample);
-    for (int i = 0; i < 1+num_derivatives_; ++i){
+    PointsToSampleState points_to_sample_state(gaussian_process, point_to_sample, num_to_sample, derivatives,
+                                               num_derivatives_gp, num_derivatives);
+
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, gpp_mean);
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, derivatives, num_derivatives_gp, gpp_variance);
+    ComputeCholeskyFactorL(1+num_derivatives_gp, gpp_variance);
+    TriangularMatrixVectorMultiply(gpp_variance, 'N', 1+num_derivatives_gp, random_sample);
+    for (int i = 0; i < 1+num_derivatives_gp; ++i){
         results[i] += gpp_mean[i] + random_sample[i];
     }
-    //return gpp_mean + std::sqrt(gpp_variance) * normal_rng_() + std::sqrt(noise_variance_this_point)*normal_rng_();
   }
-  delete [] random_sample;
-  delete [] gpp_mean;
-  delete [] gpp_variance;
 }
 
 /*!\rst
-  Sample only function values for a list of points
+  Sample only function values for a list of points; returns the index of the smallest sample.
 \endrst*/
-int GaussianProcess::SamplePointsFromGP(double const * restrict points_to_sample,
-                                        int const num_sample,
-                                        double * results) noexcept {
-  double * gpp_variance = new double[Square(num_sample)]();
-  double * gpp_mean = new double[num_sample]();
-
-  double * random_sample = new double[num_sample]();
-  for (int i = 0; i < num_sample; ++i){
-      random_sample[i] = normal_rng_();
-      results[i] = 0;
-  }
-
-  if (unlikely(num_sampled_ == 0)) {
-    BuildCovarianceMatrix(*covariance_ptr_, points_to_sample, dim_, num_sample,
-                          nullptr, 0, gpp_variance);
+int SamplePointsFromGPCore(const GaussianProcess& gaussian_process, double const * restrict points_to_sample,
+                           int num_sample, NormalRNG * normal_rng, std::vector<double> * scratch,
+                           double * results) noexcept {
+  // temporaries live in scratch so repeated sampling does no heap work
+  scratch->resize(Square(num_sample) + 2*num_sample);
+  double * gpp_variance = scratch->data();
+  double * gpp_mean = gpp_variance + Square(num_sample);
+
+  double * random_sample = gpp_mean + num_sample;
+  normal_rng->Fill(random_sample, num_sample);
+  std::fill(results, results + num_sample, 0.0);
+
+  std::vector<int> gradients;  // values only
+  if (unlikely(gaussian_process.num_sampled() == 0)) {
+    BuildCovarianceMatrix(*gaussian_process.covariance_ptr_, points_to_sample, gaussian_process.dim(), num_sample,
+                          gradients.data(), gradients.size(), gpp_variance);
     ComputeCholeskyFactorL(num_sample, gpp_variance);
     TriangularMatrixVectorMultiply(gpp_variance, 'N', num_sample, random_sample);
     for (int i = 0; i < num_sample; ++i){
@@ -1722,21 +2976,20 @@ int GaussianProcess::SamplePointsFromGP(double const * restrict points_to_sample
     }
   } else {
     int num_derivatives = 0;
-    StateType points_to_sample_state(*this, points_to_sample, num_sample, nullptr, 0, num_derivatives);
+    PointsToSampleState points_to_sample_state(gaussian_process, points_to_sample, num_sample, gradients.data(),
+                                               gradients.size(), num_derivatives);
 
-    ComputeMeanOfPoints(points_to_sample_state, gpp_mean);
-    ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, gpp_variance);
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, gpp_mean);
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, points_to_sample_state.gradients.data(),
+                                             points_to_sample_state.num_gradients_to_sample, gpp_variance);
     ComputeCholeskyFactorL(num_sample, gpp_variance);
     TriangularMatrixVectorMultiply(gpp_variance, 'N', num_sample, random_sample);
     for (int i = 0; i < num_sample; ++i){
         results[i] += gpp_mean[i] + random_sample[i];
     }
   }
-  delete [] random_sample;
-  delete [] gpp_mean;
-  delete [] gpp_variance;
 
-  int best_point = -1;
+  int best_point = 0;
   double best = results[0];
   for (int i = 0; i < num_sample; ++i){
       if (results[i] < best){
@@ -1747,28 +3000,173 @@ int GaussianProcess::SamplePointsFromGP(double const * restrict points_to_sample
   return best_point;
 }
 
+/*!\rst
+  Sample only function values for a list of points from a rank ``<= max_rank`` factor of their joint posterior
+  covariance; returns the index of the smallest sample.
+
+  The factor is a pivoted (partial) cholesky decomposition of ``Sigma = Kss - Ks^T K^-1 Ks``: each step takes the
+  point with the largest remaining variance as the pivot, forms that one column of ``Sigma`` from ``Ks`` and
+  ``K^-1 Ks`` (``O(num_sample * num_sampled)``), and stops once the largest remaining variance is at most
+  ``tolerance`` times the largest prior-to-factorization one.  Only the diagonal and the ``rank`` pivot columns of
+  ``Sigma`` are ever formed, so this costs ``O(num_sample * (num_sampled^2 + rank * (num_sampled + rank)))`` instead
+  of the ``O(num_sample^3)`` of a full cholesky.
+
+  The variance the factor leaves out (the remaining diagonal) is added back as independent noise, so every marginal
+  variance is exact and only the correlations are truncated.
+
+  Layout of ``scratch``: ``L[num_sample][max_rank]``, remaining variance, mean, pivot row of ``L``, normal draws.
+\endrst*/
+int SamplePointsFromGPLowRankCore(const GaussianProcess& gaussian_process, double const * restrict points_to_sample,
+                                  int num_sample, int max_rank, double tolerance, NormalRNG * normal_rng,
+                                  std::vector<double> * scratch, double * results) noexcept {
+  const int dim = gaussian_process.dim();
+  max_rank = std::max(0, std::min(max_rank, num_sample));
+  // temporaries live in scratch so repeated sampling does no heap work
+  scratch->resize(num_sample*max_rank + 3*num_sample + 2*max_rank);
+  double * low_rank_factor = scratch->data();
+  double * remaining_variance = low_rank_factor + num_sample*max_rank;
+  double * gpp_mean = remaining_variance + num_sample;
+  double * pivot_row = gpp_mean + num_sample;
+  double * random_sample = pivot_row + max_rank;
+
+  const CovarianceInterface& covariance = *gaussian_process.covariance_ptr_;
+  std::vector<int> gradients;  // values only
+  std::unique_ptr<PointsToSampleState> points_to_sample_state;
+  int num_sampled_rows = 0;
+  if (unlikely(gaussian_process.num_sampled() == 0)) {
+    std::fill(gpp_mean, gpp_mean + num_sample, 0.0);
+  } else {
+    int num_derivatives = 0;
+    points_to_sample_state.reset(new PointsToSampleState(gaussian_process, points_to_sample, num_sample,
+                                                         gradients.data(), gradients.size(), num_derivatives));
+    gaussian_process.ComputeMeanOfPoints(*points_to_sample_state, gpp_mean);
+    num_sampled_rows = gaussian_process.num_sampled()*(1 + gaussian_process.num_derivatives());
+  }
+
+  // diag(Sigma)_i = k(x_i, x_i) - Ks_i^T * (K^-1 Ks)_i
+  double max_variance = 0.0;
+  for (int i = 0; i < num_sample; ++i) {
+    covariance.Covariance(points_to_sample + i*dim, gradients.data(), gradients.size(), points_to_sample + i*dim,
+                          gradients.data(), gradients.size(), remaining_variance + i);
+    if (points_to_sample_state) {
+      remaining_variance[i] -= DotProduct(points_to_sample_state->K_star.data() + i*num_sampled_rows,
+                                          points_to_sample_state->K_inv_times_K_star.data() + i*num_sampled_rows,
+                                          num_sampled_rows);
+    }
+    max_variance = std::max(max_variance, remaining_variance[i]);
+  }
+
+  const double stopping_variance = tolerance*max_variance;
+  int rank = 0;
+  while (rank < max_rank) {
+    const int pivot = std::max_element(remaining_variance, remaining_variance + num_sample) - remaining_variance;
+    const double pivot_variance = remaining_variance[pivot];
+    if (pivot_variance <= stopping_variance || pivot_variance <= 0.0) {
+      break;
+    }
+
+    // column of Sigma through the pivot, minus the part the previous columns already explain
+    double * column = low_rank_factor + rank*num_sample;
+    covariance.CovarianceMatrix(points_to_sample, points_to_sample + pivot*dim, dim, num_sample, 1, gradients.data(),
+                                gradients.size(), gradients.data(), gradients.size(), column);
+    if (points_to_sample_state) {
+      GeneralMatrixVectorMultiply(points_to_sample_state->K_star.data(), 'T',
+                                  points_to_sample_state->K_inv_times_K_star.data() + pivot*num_sampled_rows, -1.0,
+                                  1.0, num_sampled_rows, num_sample, num_sampled_rows, column);
+    }
+    if (rank > 0) {
+      for (int k = 0; k < rank; ++k) {
+        pivot_row[k] = low_rank_factor[k*num_sample + pivot];
+      }
+      GeneralMatrixVectorMultiply(low_rank_factor, 'N', pivot_row, -1.0, 1.0, num_sample, rank, num_sample, column);
+    }
+
+    const double scale = 1.0/std::sqrt(pivot_variance);
+    for (int i = 0; i < num_sample; ++i) {
+      column[i] *= scale;
+      remaining_variance[i] -= Square(column[i]);
+    }
+    remaining_variance[pivot] = 0.0;
+    ++rank;
+  }
+
+  // results = mean + L * z + sqrt(remaining variance) .* w
+  normal_rng->Fill(random_sample, rank);
+  std::copy(gpp_mean, gpp_mean + num_sample, results);
+  if (rank > 0) {
+    GeneralMatrixVectorMultiply(low_rank_factor, 'N', random_sample, 1.0, 1.0, num_sample, rank, num_sample, results);
+  }
+  normal_rng->Fill(random_sample, num_sample);
+  for (int i = 0; i < num_sample; ++i) {
+    results[i] += std::sqrt(std::max(remaining_variance[i], 0.0))*random_sample[i];
+  }
+
+  return std::min_element(results, results + num_sample) - results;
+}
 
 /*!\rst
-  Approximate the global optima of the GP.
+  Approximate the global optima of the GP: each is the smallest of ``inner_number`` joint draws at uniform points,
+  drawn by ``sample_points(points, inner_number, values)`` (which returns the index of the smallest value).
 \endrst*/
-void GaussianProcess::SampleGlobalOptimaFromGP(int const num_optima,
-                              int const inner_number,
-                              const TensorProductDomain& domain,
-                              double * points_optima) noexcept {
-  UniformRandomGenerator uniform_generator(rand()%10000);
-  std::vector<double> inner_points(inner_number*dim_, 0.0);
+template <typename SamplePoints>
+void SampleGlobalOptimaFromGPCore(const GaussianProcess& gaussian_process, int num_optima, int inner_number,
+                                  const TensorProductDomain& domain, UniformRandomGenerator * uniform_generator,
+                                  const SamplePoints& sample_points, double * points_optima) noexcept {
+  const int dim = gaussian_process.dim();
+  std::vector<double> inner_points(inner_number*dim, 0.0);
   std::vector<double> inner_value(inner_number, 0.0);
   int index = -1;
 
   for (int i = 0; i < num_optima; ++i){
-    domain.GenerateUniformPointsInDomain(inner_number, &uniform_generator, inner_points.data());
-    index = SamplePointsFromGP(inner_points.data(), inner_number, inner_value.data());
-    for (int j = 0; j < dim_; ++j){
-        points_optima[i * dim_ + j] = inner_points[index * dim_ + j];
+    domain.GenerateUniformPointsInDomain(inner_number, uniform_generator, inner_points.data());
+    index = sample_points(inner_points.data(), inner_number, inner_value.data());
+    for (int j = 0; j < dim; ++j){
+        points_optima[i * dim + j] = inner_points[index * dim + j];
     }
   }
 }
 
+}  // end unnamed namespace
+
+void GaussianProcess::SamplePointFromGP(double const * restrict point_to_sample,
+//                                      double noise_variance_this_point,
+                                        double * results) noexcept {
+  SamplePointFromGPCore(*this, point_to_sample, &normal_rng_, &sample_scratch_, results);
+}
+
+int GaussianProcess::SamplePointsFromGP(double const * restrict points_to_sample,
+                                        int const num_sample,
+                                        double * results) noexcept {
+  return SamplePointsFromGPCore(*this, points_to_sample, num_sample, &normal_rng_, &sample_scratch_, results);
+}
+
+void GaussianProcess::SampleGlobalOptimaFromGP(int const num_optima,
+                              int const inner_number,
+                              const TensorProductDomain& domain,
+                              double * points_optima) noexcept {
+  UniformRandomGenerator uniform_generator(rand()%10000);
+  SampleGlobalOptimaFromGPCore(*this, num_optima, inner_number, domain, &uniform_generator,
+                               [this](double const * points, int num_points, double * values) {
+    return SamplePointsFromGPCore(*this, points, num_points, &normal_rng_, &sample_scratch_, values);
+  }, points_optima);
+}
+
+int GaussianProcess::SamplePointsFromGP(double const * restrict points_to_sample, int num_sample, int max_rank,
+                                        double tolerance, double * results) noexcept {
+  return SamplePointsFromGPLowRankCore(*this, points_to_sample, num_sample, max_rank, tolerance, &normal_rng_,
+                                       &sample_scratch_, results);
+}
+
+void GaussianProcess::SampleGlobalOptimaFromGP(int num_optima, int inner_number, const TensorProductDomain& domain,
+                                               int max_rank, double tolerance, double * points_optima) noexcept {
+  UniformRandomGenerator uniform_generator(rand()%10000);
+  SampleGlobalOptimaFromGPCore(*this, num_optima, inner_number, domain, &uniform_generator,
+                               [&](double const * points, int num_points, double * values) {
+    return SamplePointsFromGPLowRankCore(*this, points, num_points, max_rank, tolerance, &normal_rng_,
+                                         &sample_scratch_, values);
+  }, points_optima);
+}
+
 void GaussianProcess::SetExplicitSeed(EngineType::result_type seed) noexcept {
   normal_rng_.SetExplicitSeed(seed);
 }
@@ -1785,9 +3183,70 @@ GaussianProcess * GaussianProcess::Clone() const {
   return new GaussianProcess(*this);
 }
 
+GaussianProcessSampler::GaussianProcessSampler(const GaussianProcess& gaussian_process_in,
+                                               EngineType::result_type seed)
+    : gaussian_process_(&gaussian_process_in),
+      normal_rng_(seed) {
+}
+
+GaussianProcessSampler::GaussianProcessSampler(const GaussianProcess& gaussian_process_in,
+                                               EngineType::result_type base_seed, int thread_id)
+    : gaussian_process_(&gaussian_process_in),
+      normal_rng_(base_seed, thread_id) {
+}
+
+void GaussianProcessSampler::SamplePointFromGP(double const * restrict point_to_sample, double * results) noexcept {
+  SamplePointFromGPCore(*gaussian_process_, point_to_sample, &normal_rng_, &scratch_, results);
+}
+
+int GaussianProcessSampler::SamplePointsFromGP(double const * restrict points_to_sample, int num_sample,
+                                               double * results) noexcept {
+  return SamplePointsFromGPCore(*gaussian_process_, points_to_sample, num_sample, &normal_rng_, &scratch_, results);
+}
+
+void GaussianProcessSampler::SampleGlobalOptimaFromGP(int num_optima, int inner_number,
+                                                      const TensorProductDomain& domain,
+                                                      UniformRandomGenerator * uniform_generator,
+                                                      double * points_optima) noexcept {
+  SampleGlobalOptimaFromGPCore(*gaussian_process_, num_optima, inner_number, domain, uniform_generator,
+                               [this](double const * points, int num_points, double * values) {
+    return SamplePointsFromGPCore(*gaussian_process_, points, num_points, &normal_rng_, &scratch_, values);
+  }, points_optima);
+}
+
+int GaussianProcessSampler::SamplePointsFromGP(double const * restrict points_to_sample, int num_sample, int max_rank,
+                                               double tolerance, double * results) noexcept {
+  return SamplePointsFromGPLowRankCore(*gaussian_process_, points_to_sample, num_sample, max_rank, tolerance,
+                                       &normal_rng_, &scratch_, results);
+}
+
+void GaussianProcessSampler::SampleGlobalOptimaFromGP(int num_optima, int inner_number,
+                                                      const TensorProductDomain& domain, int max_rank,
+                                                      double tolerance, UniformRandomGenerator * uniform_generator,
+                                                      double * points_optima) noexcept {
+  SampleGlobalOptimaFromGPCore(*gaussian_process_, num_optima, inner_number, domain, uniform_generator,
+                               [&](double const * points, int num_points, double * values) {
+    return SamplePointsFromGPLowRankCore(*gaussian_process_, points, num_points, max_rank, tolerance, &normal_rng_,
+                                         &scratch_, values);
+  }, points_optima);
+}
+
 void PointsToSampleState::SetupState(const GaussianProcess& gaussian_process, double const * restrict points_to_sample_in,
                                      int num_to_sample_in, int num_gradients_to_sample_in, int num_derivatives_in,
                                      bool precomputed_in /*=true*/, bool precomputed_grad_K_inv_times_K_star_in /*= false*/) {
+  PrepareState(gaussian_process, points_to_sample_in, num_to_sample_in, num_gradients_to_sample_in, num_derivatives_in,
+               precomputed_in, precomputed_grad_K_inv_times_K_star_in);
+  gaussian_process.FillPointsToSampleState(this);
+}
+
+void PointsToSampleState::PrepareState(const GaussianProcess& gaussian_process_in, double const * restrict points_to_sample_in,
+                                       int num_to_sample_in, int num_gradients_to_sample_in, int num_derivatives_in,
+                                       bool precomputed_in /*=true*/,
+                                       bool precomputed_grad_K_inv_times_K_star_in /*= false*/) {
+  // a different column layout, or turning on K^-1 * Ks, invalidates the columns kept from the last fill
+  if (precomputed != precomputed_in || num_gradients_to_sample != num_gradients_to_sample_in) {
+    filled_version = 0;
+  }
   if (precomputed != precomputed_in){
     precomputed = precomputed_in;
   }
@@ -1807,11 +3266,12 @@ void PointsToSampleState::SetupState(const GaussianProcess& gaussian_process, do
     grad_K_inv_times_K_star.resize(num_derivatives*(num_sampled*(num_gradients_sampled+1)*(num_gradients_to_sample+1))*dim);
     V.resize((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1)));
     K_inv_times_K_star.resize((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1)));
+    grad_cov.resize(dim*(num_gradients_to_sample+1)*(num_gradients_sampled+1));
   }
 
   // resize data depending on sampled points
-  if (unlikely(num_sampled != gaussian_process.num_sampled())) {
-    num_sampled = gaussian_process.num_sampled();
+  if (unlikely(num_sampled != gaussian_process_in.num_sampled())) {
+    num_sampled = gaussian_process_in.num_sampled();
     K_star.resize((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1)));
     grad_K_star.resize(num_derivatives*(num_sampled*(num_gradients_sampled+1)*(num_gradients_to_sample+1))*dim);
     grad_K_inv_times_K_star.resize(num_derivatives*(num_sampled*(num_gradients_sampled+1)*(num_gradients_to_sample+1))*dim);
@@ -1821,8 +3281,6 @@ void PointsToSampleState::SetupState(const GaussianProcess& gaussian_process, do
 
   // set new points to sample
   std::copy(points_to_sample_in, points_to_sample_in + dim*num_to_sample, points_to_sample.begin());
-
-  gaussian_process.FillPointsToSampleState(this);
 }
 
 PointsToSampleState::PointsToSampleState(const GaussianProcess& gaussian_process,
@@ -1844,7 +3302,12 @@ PointsToSampleState::PointsToSampleState(const GaussianProcess& gaussian_process
       grad_K_star(num_derivatives*(num_sampled*(num_gradients_sampled+1)*(num_gradients_to_sample+1))*dim),
       grad_K_inv_times_K_star(num_derivatives*(num_sampled*(num_gradients_sampled+1)*(num_gradients_to_sample+1))*dim),
       V((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1))),
-      K_inv_times_K_star((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1))) {
+      K_inv_times_K_star((num_to_sample*(num_gradients_to_sample+1))*(num_sampled*(num_gradients_sampled+1))),
+      grad_cov(dim*(num_gradients_to_sample+1)*(num_gradients_sampled+1)),
+      K_discrete(),
+      cross_differences(nullptr),
+      filled_points_to_sample(),
+      filled_version(0) {
   SetupState(gaussian_process, points_to_sample_in, num_to_sample_in, num_gradients_to_sample_in, num_derivatives_in);
 }
 
@@ -1852,19 +3315,283 @@ PointsToSampleState::PointsToSampleState(PointsToSampleState&& OL_UNUSED(other))
 
 ExpectedImprovementEvaluator::ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in,
                                                            int num_mc_iterations, double best_so_far)
+    : ExpectedImprovementEvaluator(gaussian_process_in, num_mc_iterations, best_so_far, MonteCarloPrecision::kDouble) {
+}
+
+ExpectedImprovementEvaluator::ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in,
+                                                           int num_mc_iterations, double best_so_far,
+                                                           MonteCarloPrecision monte_carlo_precision)
+    : ExpectedImprovementEvaluator(gaussian_process_in,
+                                   AdaptiveMonteCarloParameters(num_mc_iterations, num_mc_iterations, 0.0, 0.0),
+                                   best_so_far, monte_carlo_precision) {
+}
+
+ExpectedImprovementEvaluator::ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in,
+                                                           const AdaptiveMonteCarloParameters& adaptive_parameters,
+                                                           double best_so_far, MonteCarloPrecision monte_carlo_precision)
     : dim_(gaussian_process_in.dim()),
-      num_mc_iterations_(num_mc_iterations),
+      num_mc_iterations_(adaptive_parameters.max_num_mc_iterations),
       best_so_far_(best_so_far),
+      adaptive_parameters_(adaptive_parameters),
+      monte_carlo_precision_(monte_carlo_precision),
       gaussian_process_(&gaussian_process_in) {
+  if (unlikely(adaptive_parameters_.min_num_mc_iterations > adaptive_parameters_.max_num_mc_iterations)) {
+    OL_THROW_EXCEPTION(UpperBoundException<int>, "min_num_mc_iterations must be <= max_num_mc_iterations.",
+                       adaptive_parameters_.min_num_mc_iterations, adaptive_parameters_.max_num_mc_iterations);
+  }
 }
 
 ExpectedImprovementEvaluator::ExpectedImprovementEvaluator(ExpectedImprovementEvaluator&& other)
     : dim_(other.dim()),
       num_mc_iterations_(other.num_mc_iterations()),
       best_so_far_(other.best_so_far()),
+      adaptive_parameters_(other.adaptive_parameters()),
+      monte_carlo_precision_(other.monte_carlo_precision()),
       gaussian_process_(other.gaussian_process()){
 }
 
+namespace {  // Monte-Carlo cores of ExpectedImprovementEvaluator, templated on MonteCarloPrecision's floating point type
+
+//! first jitter tried on a failed pivot of the GP variance of union_of_points, relative to its largest diagonal entry
+constexpr double kVarianceInitialRelativeJitter = 1.0e-10;
+//! largest jitter allowed there
+constexpr double kVarianceMaxRelativeJitter = 1.0e-6;
+
+/*!\rst
+  Adds the fixed ``1.0e-6`` nugget to ``ei_state->cholesky_to_sample_var`` (the GP variance of union_of_points) and
+  factors it in place, escalating jitter from the failed pivot on if the matrix is still numerically singular (e.g.,
+  points_to_sample nearly duplicating each other or points_sampled).  The jitter used is reported in
+  ``ei_state->cholesky_jitter``.
+
+  \raise
+    SingularMatrixException if even ``kVarianceMaxRelativeJitter`` does not make the matrix positive definite
+\endrst*/
+void FactorVarianceOfUnion(ExpectedImprovementState * ei_state) {
+  const int num_union = ei_state->num_union;
+  for (int i = 0; i < num_union; ++i) {
+    ei_state->cholesky_to_sample_var[i + i*num_union] += 1.0e-6;
+  }
+
+  CholeskyJitter jitter = {kVarianceInitialRelativeJitter, kVarianceMaxRelativeJitter, 0.0, 0};
+  const int leading_minor_index = ComputeCholeskyFactorLWithJitter(num_union, 1,
+                                                                   ei_state->cholesky_to_sample_var.data(), &jitter);
+  ei_state->cholesky_jitter = jitter.jitter;
+  if (unlikely(leading_minor_index != 0)) {
+    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample/being_sampled or points_to_sample/being_sampled duplicating points_sampled with 0 noise.", ei_state->cholesky_to_sample_var.data(), num_union, leading_minor_index);
+  }
+}
+
+/*!\rst
+  Draws ``num_normals`` N(0, 1) numbers in one NormalRNGInterface::Fill() call.
+
+  \param
+    :normal_rng[1]: source of N(0, 1) draws
+    :num_normals: number of draws
+  \output
+    :normal_rng[1]: ``num_normals`` draws consumed
+    :normals[num_normals]: the draws
+\endrst*/
+inline OL_NONNULL_POINTERS void FillNormals(NormalRNGInterface * normal_rng, int num_normals, double * restrict normals) {
+  normal_rng->Fill(normals, num_normals);
+}
+
+/*!\rst
+  Single precision overload of FillNormals(): draws in double precision through a small buffer, then rounds.
+\endrst*/
+inline OL_NONNULL_POINTERS void FillNormals(NormalRNGInterface * normal_rng, int num_normals, float * restrict normals) {
+  constexpr int kBufferSize = 128;
+  double buffer[kBufferSize];
+  for (int offset = 0; offset < num_normals; offset += kBufferSize) {
+    int num_this_pass = std::min(kBufferSize, num_normals - offset);
+    normal_rng->Fill(buffer, num_this_pass);
+    std::copy(buffer, buffer + num_this_pass, normals + offset);
+  }
+}
+
+/*!\rst
+  Draws the normals for a block of mc iterations and transforms them into samples of
+  ``GP(union_of_points) - \mu``; i.e., ``EI_this_block = L * normals``.
+
+  \param
+    :cholesky_to_sample_var[num_union][num_union]: cholesky factor of the GP variance
+    :num_union: number of points sampled per mc iteration
+    :block_size: number of mc iterations in this block
+    :normal_rng[1]: source of N(0, 1) draws
+  \output
+    :normal_rng[1]: ``num_union*block_size`` draws consumed
+    :EI_this_block[num_union][block_size]: ``L * normals``
+    :normals[num_union][block_size]: the draws (only written if non-null)
+\endrst*/
+template <typename Scalar>
+void SampleMonteCarloBlock(Scalar const * restrict cholesky_to_sample_var, int num_union, int block_size,
+                           NormalRNGInterface * normal_rng, Scalar * restrict EI_this_block,
+                           Scalar * restrict normals) {
+  OL_PROFILE_SCOPE(ProfilePhase::kMonteCarloSampling);
+  OL_PROFILE_COUNT(ProfileCounter::kMonteCarloSamples, block_size);
+  FillNormals(normal_rng, num_union*block_size, EI_this_block);  // EI_this_block now holds "normals"
+  if (normals != nullptr) {
+    // orig value of normals needed if improvement_this_step > 0.0
+    std::copy(EI_this_block, EI_this_block + num_union*block_size, normals);
+  }
+
+  // compute EI_this_block = cholesky * normals   as  EI = cholesky * EI
+  // b/c normals currently held in EI_this_block
+  TriangularMatrixMatrixMultiply(cholesky_to_sample_var, 'N', num_union, block_size, num_union, EI_this_block);
+}
+
+/*!\rst
+  MC loop of ExpectedImprovementEvaluator::ComputeExpectedImprovement(); samples are ``Scalar``, improvements are
+  accumulated in double.
+
+  The stopping tests of AdaptiveMonteCarloParameters are applied at block boundaries, so every estimate uses a whole
+  number of blocks (or ``max_num_mc_iterations``) and is a prefix of the same fixed-seed draw sequence.
+
+  \param
+    :cholesky_to_sample_var[num_union][num_union]: cholesky factor of the GP variance (as ``Scalar``)
+    :to_sample_mean[num_union]: GP mean at union_of_points
+    :best_so_far: best (minimum) objective function value
+    :num_union: number of points sampled per mc iteration
+    :adaptive_parameters: stopping rule; ``min == max`` runs exactly ``max_num_mc_iterations``
+    :ei_state[1]: state holding ``normal_rng`` (reset to its most recent seed first) and ``prune_threshold``
+    :EI_this_block[num_union][kMonteCarloBlockSize]: scratch space
+  \output
+    :ei_state[1]: ``standard_error``, ``num_mc_iterations_used``, ``pruned`` set
+  \return
+    mean improvement over the mc iterations used
+\endrst*/
+template <typename Scalar>
+double MeanMonteCarloImprovement(Scalar const * restrict cholesky_to_sample_var, double const * restrict to_sample_mean,
+                                 double best_so_far, int num_union,
+                                 const AdaptiveMonteCarloParameters& adaptive_parameters,
+                                 ExpectedImprovementState * ei_state, Scalar * restrict EI_this_block) {
+  // mc iterations are processed kMonteCarloBlockSize at a time: all normals for a block are drawn (in the same order as
+  // drawing them one iteration at a time) and multiplied by the cholesky factor in one call
+  const int max_block_size = ExpectedImprovementState::kMonteCarloBlockSize;
+  const int max_num_mc_iterations = adaptive_parameters.max_num_mc_iterations;
+  double aggregate = 0.0;
+  double aggregate_squares = 0.0;
+  int num_mc_iterations = 0;
+  ei_state->pruned = false;
+  ei_state->normal_rng->ResetToMostRecentSeed();
+  while (num_mc_iterations < max_num_mc_iterations) {
+    const int block_size = std::min(max_block_size, max_num_mc_iterations - num_mc_iterations);
+    SampleMonteCarloBlock(cholesky_to_sample_var, num_union, block_size, ei_state->normal_rng, EI_this_block,
+                          static_cast<Scalar *>(nullptr));
+    for (int i = 0; i < block_size; ++i) {
+      double improvement_this_step = 0.0;
+      for (int j = 0; j < num_union; ++j) {
+        double EI_total = best_so_far - (to_sample_mean[j] + EI_this_block[j + i*num_union]);
+        improvement_this_step = std::max(improvement_this_step, EI_total);
+      }
+      // improvement_this_step >= 0.0, so non-improving iterations add nothing
+      aggregate += improvement_this_step;
+      aggregate_squares += Square(improvement_this_step);
+    }
+    num_mc_iterations += block_size;
+
+    const double mean = aggregate/static_cast<double>(num_mc_iterations);
+    // sample variance of the improvement; clamped since the one-pass formula can round below 0
+    const double variance = num_mc_iterations > 1 ?
+        std::max(0.0, (aggregate_squares - aggregate*mean)/static_cast<double>(num_mc_iterations - 1)) : 0.0;
+    ei_state->standard_error = std::sqrt(variance/static_cast<double>(num_mc_iterations));
+    if (num_mc_iterations >= adaptive_parameters.min_num_mc_iterations && num_mc_iterations < max_num_mc_iterations) {
+      // an all-zero run (mean == 0) is left to the pruning test: rare improvement is not evidence of no improvement
+      if (mean > 0.0 && ei_state->standard_error <= adaptive_parameters.relative_tolerance*mean) {
+        break;
+      }
+      if (mean + adaptive_parameters.confidence_multiplier*ei_state->standard_error < ei_state->prune_threshold) {
+        ei_state->pruned = true;
+        break;
+      }
+    }
+  }
+  ei_state->num_mc_iterations_used = num_mc_iterations;
+  return num_mc_iterations > 0 ? aggregate/static_cast<double>(num_mc_iterations) : 0.0;
+}
+
+/*!\rst
+  MC loop of ExpectedImprovementEvaluator::ComputeGradExpectedImprovement(); samples and normals are ``Scalar``,
+  ``ei_state->aggregate`` (and everything it is built from) is double.
+
+  \param
+    :cholesky_to_sample_var[num_union][num_union]: cholesky factor of the GP variance (as ``Scalar``)
+    :best_so_far: best (minimum) objective function value
+    :num_mc_iterations: number of mc iterations
+    :ei_state[1]: state with to_sample_mean and grad_mu filled
+    :EI_this_block[num_union][kMonteCarloBlockSize]: scratch space
+    :normals[num_union][kMonteCarloBlockSize]: scratch space
+  \output
+    :ei_state[1]: ``aggregate`` holds the sum of the grad improvement through ``grad_mu`` over all mc iterations, and
+      ``chol_adjoint`` the sum of its gradient wrt the cholesky factor (lower triangle); ``normal_rng`` modified
+  \return
+    sum of the improvement over all mc iterations (accumulated in the order MeanMonteCarloImprovement() uses)
+\endrst*/
+template <typename Scalar>
+double SumMonteCarloGradImprovement(Scalar const * restrict cholesky_to_sample_var, double best_so_far,
+                                  int num_mc_iterations, ExpectedImprovementState * ei_state,
+                                  Scalar * restrict EI_this_block, Scalar * restrict normals) {
+  const int dim = ei_state->dim;
+  const int num_union = ei_state->num_union;
+  // winner_normals[num_union][num_union]: column j is the sum of the normals of every iteration won by point j
+  std::vector<double> winner_normals(Square(num_union), 0.0);
+
+  std::fill(ei_state->aggregate.begin(), ei_state->aggregate.end(), 0.0);
+  double aggregate_improvement = 0.0;
+  // see ComputeExpectedImprovement(): mc iterations are processed kMonteCarloBlockSize at a time
+  const int max_block_size = ExpectedImprovementState::kMonteCarloBlockSize;
+  ei_state->normal_rng->ResetToMostRecentSeed();
+  for (int block_start = 0; block_start < num_mc_iterations; block_start += max_block_size) {
+    const int block_size = std::min(max_block_size, num_mc_iterations - block_start);
+    SampleMonteCarloBlock(cholesky_to_sample_var, num_union, block_size, ei_state->normal_rng, EI_this_block, normals);
+
+    for (int i = 0; i < block_size; ++i) {
+      Scalar const * restrict EI_this_step = EI_this_block + i*num_union;
+      double improvement_this_step = 0.0;
+      int winner = num_union + 1;  // an out of-bounds initial value
+      for (int j = 0; j < num_union; ++j) {
+        double EI_total = best_so_far - (ei_state->to_sample_mean[j] + EI_this_step[j]);
+        if (EI_total > improvement_this_step) {
+          improvement_this_step = EI_total;
+          winner = j;
+        }
+      }
+      aggregate_improvement += improvement_this_step;
+
+      if (improvement_this_step > 0.0) {
+        // improvement > 0.0 implies winner will be valid; i.e., in 0:ei_state->num_to_sample
+
+        // recall that grad_mu only stores \frac{d mu_i}{d Xs_i}, since \frac{d mu_j}{d Xs_i} = 0 for i != j.
+        // hence the only relevant term from grad_mu is the one describing the gradient wrt winner-th point,
+        // and this term only arises if the winner (for most improvement) index is less than num_to_sample
+        if (winner < ei_state->num_to_sample) {
+          for (int k = 0; k < dim; ++k) {
+            ei_state->aggregate[winner*dim + k] -= ei_state->grad_mu[winner*dim + k];
+          }
+        }
+
+        // the gradient wrt the cholesky factor is linear in the normals, so only their per-winner sums are needed
+        Scalar const * restrict normals_this_step = normals + i*num_union;
+        double * restrict winner_normals_column = winner_normals.data() + winner*num_union;
+        for (int j = 0; j < num_union; ++j) {
+          winner_normals_column[j] += normals_this_step[j];
+        }
+      }  // end if: improvement_this_step > 0.0
+    }  // end for i: block_size
+  }  // end for block_start: num_mc_iterations
+
+  // each iteration's improvement is best_so_far - mu_{winner} - L_{winner,i} * normals_{mc,i}, so summed over all mc
+  // iterations, the gradient wrt L_{j,i} is \bar{L}_{j,i} = -winner_normals_{i,j} (lower triangle only)
+  double * restrict chol_adjoint = ei_state->chol_adjoint.data();
+  for (int i = 0; i < num_union; ++i) {
+    for (int j = i; j < num_union; ++j) {
+      chol_adjoint[i*num_union + j] = -winner_normals[j*num_union + i];
+    }
+  }
+  return aggregate_improvement;
+}
+
+}  // end unnamed namespace
+
 /*!\rst
   Let ``Ls * Ls^T = Vars`` and ``w`` = vector of IID normal(0,1) variables
   Then:
@@ -1895,41 +3622,19 @@ double ExpectedImprovementEvaluator::ComputeExpectedImprovement(StateType * ei_s
                                              ei_state->points_to_sample_state.gradients.data(),
                                              ei_state->points_to_sample_state.num_gradients_to_sample,
                                              ei_state->cholesky_to_sample_var.data());
-
-  //Adding the variance of measurement noise to the covariance matrix
-  for (int i = 0;i < num_union; i++){
-       ei_state->cholesky_to_sample_var[i + i*num_union] += 1.0e-6;
-  }
-
-  int leading_minor_index = ComputeCholeskyFactorL(num_union, ei_state->cholesky_to_sample_var.data());
-
-  if (unlikely(leading_minor_index != 0)) {
-    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample/being_sampled or points_to_sample/being_sampled duplicating points_sampled with 0 noise.", ei_state->cholesky_to_sample_var.data(), num_union, leading_minor_index);
-  }
-
-  double aggregate = 0.0;
-  ei_state->normal_rng->ResetToMostRecentSeed();
-  for (int i = 0; i < num_mc_iterations_; ++i) {
-    double improvement_this_step = 0.0;
-    for (int j = 0; j < num_union; ++j) {
-      ei_state->EI_this_step_from_var[j] = (*(ei_state->normal_rng))();  // EI_this_step now holds "normals"
-    }
-
-    TriangularMatrixVectorMultiply(ei_state->cholesky_to_sample_var.data(), 'N', num_union,
-                                   ei_state->EI_this_step_from_var.data());
-    for (int j = 0; j < num_union; ++j) {
-      double EI_total = best_so_far_ - (ei_state->to_sample_mean[j] + ei_state->EI_this_step_from_var[j]);
-      if (EI_total > improvement_this_step) {
-        improvement_this_step = EI_total;
-      }
-    }
-
-    if (improvement_this_step > 0.0) {
-      aggregate += improvement_this_step;
-    }
+  FactorVarianceOfUnion(ei_state);
+
+  if (monte_carlo_precision_ == MonteCarloPrecision::kSingle) {
+    std::copy(ei_state->cholesky_to_sample_var.begin(), ei_state->cholesky_to_sample_var.end(),
+              ei_state->cholesky_to_sample_var_single.begin());
+    return MeanMonteCarloImprovement(ei_state->cholesky_to_sample_var_single.data(), ei_state->to_sample_mean.data(),
+                                     best_so_far_, num_union, adaptive_parameters_, ei_state,
+                                     ei_state->EI_this_step_from_var_single.data());
+  } else {
+    return MeanMonteCarloImprovement(ei_state->cholesky_to_sample_var.data(), ei_state->to_sample_mean.data(),
+                                     best_so_far_, num_union, adaptive_parameters_, ei_state,
+                                     ei_state->EI_this_step_from_var.data());
   }
-
-  return aggregate/static_cast<double>(num_mc_iterations_);
 }
 
 /*!\rst
@@ -1941,100 +3646,101 @@ double ExpectedImprovementEvaluator::ComputeExpectedImprovement(StateType * ei_s
 
   Thus ``\nabla(\mu)`` only contributes when the ``winner`` (point w/best improvement this iteration) is the current point.
   That is, the gradient of ``\mu`` at ``x_i`` wrt ``x_j`` is 0 unless ``i == j`` (and only this result is stored in
-  ``ei_state->grad_mu``).  The interaction with ``ei_state->grad_chol_decomp`` is harder to know a priori (like with
-  ``grad_mu``) and has a more complex structure (rank 3 tensor), so the derivative wrt ``x_j`` is computed fully, and
-  the relevant submatrix (indexed by the current ``winner``) is accessed each iteration.
+  ``ei_state->grad_mu``).  The interaction with the cholesky factor ``L`` of the variance is harder to know a priori:
+  each iteration's improvement depends on row ``winner`` of ``L``.  Rather than differentiating ``L`` wrt every
+  coordinate of every point up front (a rank 4 tensor, ``O(dim*num_to_sample*num_union^3)``), the mc loop only sums
+  the gradient wrt ``L`` (which is linear in the normals), and that sum is backpropagated through the cholesky
+  factorization and the GP variance once, in reverse mode (ComputeAdjointGradCholeskyVarianceOfPoints()).
 
   .. Note:: comments here are copied to _compute_grad_expected_improvement_monte_carlo() in python_version/expected_improvement.py
 \endrst*/
-void ExpectedImprovementEvaluator::ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const {
-  const int num_union = ei_state->num_union;
+double ExpectedImprovementEvaluator::ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const {
   gaussian_process_->ComputeMeanOfPoints(ei_state->points_to_sample_state, ei_state->to_sample_mean.data());
   gaussian_process_->ComputeGradMeanOfPoints(ei_state->points_to_sample_state, ei_state->grad_mu.data());
   gaussian_process_->ComputeVarianceOfPoints(&(ei_state->points_to_sample_state),
                                                ei_state->points_to_sample_state.gradients.data(),
                                                ei_state->points_to_sample_state.num_gradients_to_sample,
                                                ei_state->cholesky_to_sample_var.data());
-
-  //Adding the variance of measurement noise to the covariance matrix
-  for (int i = 0;i < num_union; i++){
-       ei_state->cholesky_to_sample_var[i + i*num_union] += 1.0e-6;
+  FactorVarianceOfUnion(ei_state);
+
+  double aggregate_improvement;
+  if (monte_carlo_precision_ == MonteCarloPrecision::kSingle) {
+    std::copy(ei_state->cholesky_to_sample_var.begin(), ei_state->cholesky_to_sample_var.end(),
+              ei_state->cholesky_to_sample_var_single.begin());
+    aggregate_improvement = SumMonteCarloGradImprovement(ei_state->cholesky_to_sample_var_single.data(), best_so_far_,
+                                                         num_mc_iterations_, ei_state,
+                                                         ei_state->EI_this_step_from_var_single.data(),
+                                                         ei_state->normals_single.data());
+  } else {
+    aggregate_improvement = SumMonteCarloGradImprovement(ei_state->cholesky_to_sample_var.data(), best_so_far_,
+                                                         num_mc_iterations_, ei_state,
+                                                         ei_state->EI_this_step_from_var.data(),
+                                                         ei_state->normals.data());
   }
+  // reverse mode: the mc loop only sums the gradient wrt the cholesky factor, which is backpropagated once here
+  gaussian_process_->ComputeAdjointGradCholeskyVarianceOfPoints(&(ei_state->points_to_sample_state),
+                                                                ei_state->cholesky_to_sample_var.data(),
+                                                                ei_state->chol_adjoint.data(),
+                                                                ei_state->aggregate.data());
 
-  int leading_minor_index = ComputeCholeskyFactorL(num_union, ei_state->cholesky_to_sample_var.data());
-  if (unlikely(leading_minor_index != 0)) {
-    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample/being_sampled or points_to_sample/being_sampled duplicating points_sampled with 0 noise.", ei_state->cholesky_to_sample_var.data(), num_union, leading_minor_index);
+  for (int k = 0; k < ei_state->num_to_sample*dim_; ++k) {
+    grad_EI[k] = ei_state->aggregate[k]/static_cast<double>(num_mc_iterations_);
   }
+  return num_mc_iterations_ > 0 ? aggregate_improvement/static_cast<double>(num_mc_iterations_) : 0.0;
+}
 
-  gaussian_process_->ComputeGradCholeskyVarianceOfPoints(&(ei_state->points_to_sample_state),
-                                                         ei_state->cholesky_to_sample_var.data(),
-                                                         ei_state->grad_chol_decomp.data());
-
-
-  std::fill(ei_state->aggregate.begin(), ei_state->aggregate.end(), 0.0);
-  double aggregate_EI = 0.0;
-  ei_state->normal_rng->ResetToMostRecentSeed();
-  for (int i = 0; i < num_mc_iterations_; ++i) {
-    for (int j = 0; j < num_union; ++j) {
-      ei_state->EI_this_step_from_var[j] = (*(ei_state->normal_rng))();  // EI_this_step now holds "normals"
-      ei_state->normals[j] = ei_state->EI_this_step_from_var[j];  // orig value of normals needed if improvement_this_step > 0.0
-    }
-
-    // compute EI_this_step_from_far = cholesky * normals   as  EI = cholesky * EI
-    // b/c normals currently held in EI_this_step_from_var
-    TriangularMatrixVectorMultiply(ei_state->cholesky_to_sample_var.data(), 'N', num_union,
-                                   ei_state->EI_this_step_from_var.data());
-
-    double improvement_this_step = 0.0;
-    int winner = num_union + 1;  // an out of-bounds initial value
-    for (int j = 0; j < num_union; ++j) {
-      double EI_total = best_so_far_ - (ei_state->to_sample_mean[j] + ei_state->EI_this_step_from_var[j]);
-      if (EI_total > improvement_this_step) {
-        improvement_this_step = EI_total;
-        winner = j;
-      }
-    }
-
-    if (improvement_this_step > 0.0) {
-      // improvement > 0.0 implies winner will be valid; i.e., in 0:ei_state->num_to_sample
-      aggregate_EI += improvement_this_step;
-
-      // recall that grad_mu only stores \frac{d mu_i}{d Xs_i}, since \frac{d mu_j}{d Xs_i} = 0 for i != j.
-      // hence the only relevant term from grad_mu is the one describing the gradient wrt winner-th point,
-      // and this term only arises if the winner (for most improvement) index is less than num_to_sample
-      if (winner < ei_state->num_to_sample) {
-        for (int k = 0; k < dim_; ++k) {
-          ei_state->aggregate[winner*dim_ + k] -= ei_state->grad_mu[winner*dim_ + k];
-        }
-      }
-
-      // let L_{d,i,j,k} = grad_chol_decomp, d over dim_, i, j over num_union, k over num_to_sample
-      // we want to compute: agg_dx_{d,k} = L_{d,i,j=winner,k} * normals_i
-      // TODO(GH-92): Form this as one GeneralMatrixVectorMultiply() call by storing data as L_{d,i,k,j} if it's faster.
-      double const * restrict grad_chol_decomp_winner_block = ei_state->grad_chol_decomp.data() + winner*dim_*(num_union);
-      for (int k = 0; k < ei_state->num_to_sample; ++k) {
-        GeneralMatrixVectorMultiply(grad_chol_decomp_winner_block, 'N', ei_state->normals.data(), -1.0, 1.0,
-                                    dim_, num_union, dim_, ei_state->aggregate.data() + k*dim_);
-        grad_chol_decomp_winner_block += dim_*Square(num_union);
-      }
-    }  // end if: improvement_this_step > 0.0
-  }  // end for i: num_mc_iterations_
+double ExpectedImprovementEvaluator::ComputeObjectiveAndGradient(StateType * ei_state, double * restrict grad_EI) const {
+  if (adaptive_parameters_.min_num_mc_iterations < adaptive_parameters_.max_num_mc_iterations) {
+    // the adaptive estimate may stop early (or prune), so it is not the by-product of the full-budget gradient
+    const double EI = ComputeExpectedImprovement(ei_state);
+    ComputeGradExpectedImprovement(ei_state, grad_EI);
+    return EI;
+  }
+  return ComputeGradExpectedImprovement(ei_state, grad_EI);
+}
 
-  for (int k = 0; k < ei_state->num_to_sample*dim_; ++k) {
-    grad_EI[k] = ei_state->aggregate[k]/static_cast<double>(num_mc_iterations_);
+void ExpectedImprovementEvaluator::ComputeGradObjectiveFunctionBatch(StateType * const * ei_states, int num_states,
+                                                                     double const * restrict points_to_sample,
+                                                                     double * restrict grad_EI) const {
+  SetCurrentPointBatch(*this, ei_states, num_states, points_to_sample);
+  for (int k = 0; k < num_states; ++k) {
+    ComputeGradExpectedImprovement(ei_states[k], grad_EI);
+    grad_EI += ei_states[k]->GetProblemSize();
   }
 }
 
 void ExpectedImprovementState::SetCurrentPoint(const EvaluatorType& ei_evaluator,
                                                double const * restrict points_to_sample) {
+  PrepareCurrentPoint(ei_evaluator, points_to_sample);
+  // evaluate derived quantities for the GP
+  ei_evaluator.gaussian_process()->FillPointsToSampleState(&points_to_sample_state);
+}
+
+void ExpectedImprovementState::PrepareCurrentPoint(const EvaluatorType& ei_evaluator,
+                                                   double const * restrict points_to_sample) {
   // update points_to_sample in union_of_points
   std::copy(points_to_sample, points_to_sample + num_to_sample*dim, union_of_points.data());
 
-  // evaluate derived quantities for the GP
-  points_to_sample_state.SetupState(*ei_evaluator.gaussian_process(), union_of_points.data(),
-                                    num_union, 0, num_derivatives, (num_derivatives>0));
+  points_to_sample_state.PrepareState(*ei_evaluator.gaussian_process(), union_of_points.data(),
+                                      num_union, 0, num_derivatives, (num_derivatives>0));
+}
+
+namespace {
+
+/*!\rst
+  Sizes of ExpectedImprovementState's Monte-Carlo buffers: only the buffers of the evaluator's MonteCarloPrecision are allocated.
+\endrst*/
+int DoublePrecisionMonteCarloBufferSize(const ExpectedImprovementEvaluator& ei_evaluator, int num_union) noexcept {
+  const bool is_double = ei_evaluator.monte_carlo_precision() == MonteCarloPrecision::kDouble;
+  return is_double ? num_union*ExpectedImprovementState::kMonteCarloBlockSize : 0;
+}
+
+int SinglePrecisionMonteCarloBufferSize(const ExpectedImprovementEvaluator& ei_evaluator, int size) noexcept {
+  return ei_evaluator.monte_carlo_precision() == MonteCarloPrecision::kSingle ? size : 0;
 }
 
+}  // end unnamed namespace
+
 ExpectedImprovementState::ExpectedImprovementState(const EvaluatorType& ei_evaluator,
                                                    double const * restrict points_to_sample,
                                                    double const * restrict points_being_sampled,
@@ -2049,13 +3755,21 @@ ExpectedImprovementState::ExpectedImprovementState(const EvaluatorType& ei_evalu
       points_to_sample_state(*ei_evaluator.gaussian_process(), union_of_points.data(), num_union,
                              nullptr, 0, num_derivatives, configure_for_gradients),
       normal_rng(normal_rng_in),
+      prune_threshold(-std::numeric_limits<double>::infinity()),
+      standard_error(0.0),
+      num_mc_iterations_used(0),
+      pruned(false),
+      cholesky_jitter(0.0),
       to_sample_mean(num_union),
       grad_mu(dim*num_derivatives),
       cholesky_to_sample_var(Square(num_union)),
-      grad_chol_decomp(dim*Square(num_union)*num_derivatives),
-      EI_this_step_from_var(num_union),
+      chol_adjoint(Square(num_union)),
+      EI_this_step_from_var(DoublePrecisionMonteCarloBufferSize(ei_evaluator, num_union)),
       aggregate(dim*num_derivatives),
-      normals(num_union) {
+      normals(DoublePrecisionMonteCarloBufferSize(ei_evaluator, num_union)),
+      cholesky_to_sample_var_single(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*num_union)),
+      EI_this_step_from_var_single(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*kMonteCarloBlockSize)),
+      normals_single(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*kMonteCarloBlockSize)) {
 }
 
 ExpectedImprovementState::ExpectedImprovementState(ExpectedImprovementState&& OL_UNUSED(other)) = default;
@@ -2066,10 +3780,40 @@ void ExpectedImprovementState::SetupState(const EvaluatorType& ei_evaluator,
     OL_THROW_EXCEPTION(InvalidValueException<int>, "Evaluator's and State's dim do not match!", dim, ei_evaluator.dim());
   }
 
+  // the evaluator's MonteCarloPrecision decides which MC buffers are in use
+  EI_this_step_from_var.resize(DoublePrecisionMonteCarloBufferSize(ei_evaluator, num_union));
+  normals.resize(DoublePrecisionMonteCarloBufferSize(ei_evaluator, num_union));
+  cholesky_to_sample_var_single.resize(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*num_union));
+  EI_this_step_from_var_single.resize(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*kMonteCarloBlockSize));
+  normals_single.resize(SinglePrecisionMonteCarloBufferSize(ei_evaluator, num_union*kMonteCarloBlockSize));
+
   // update quantities derived from points_to_sample
   SetCurrentPoint(ei_evaluator, points_to_sample);
 }
 
+bool ExpectedImprovementState::Reconfigure(const EvaluatorType& ei_evaluator,
+                                           double const * restrict points_to_sample,
+                                           double const * restrict points_being_sampled,
+                                           int num_to_sample_in, int num_being_sampled_in,
+                                           bool configure_for_gradients, NormalRNGInterface * normal_rng_in) {
+  if (dim != ei_evaluator.dim() || num_to_sample != num_to_sample_in || num_being_sampled != num_being_sampled_in ||
+      num_derivatives != (configure_for_gradients ? num_to_sample : 0) ||
+      points_to_sample_state.num_gradients_sampled != ei_evaluator.gaussian_process()->num_derivatives()) {
+    return false;
+  }
+
+  std::copy(points_being_sampled, points_being_sampled + dim*num_being_sampled, union_of_points.data() + dim*num_to_sample);
+  normal_rng = normal_rng_in;
+  prune_threshold = -std::numeric_limits<double>::infinity();
+  standard_error = 0.0;
+  num_mc_iterations_used = 0;
+  pruned = false;
+
+  // sizes the MC buffers for the evaluator and recomputes everything derived from union_of_points
+  SetupState(ei_evaluator, points_to_sample);
+  return true;
+}
+
 OnePotentialSampleExpectedImprovementEvaluator::OnePotentialSampleExpectedImprovementEvaluator(
     const GaussianProcess& gaussian_process_in,
     double best_so_far)
@@ -2152,14 +3896,84 @@ void OnePotentialSampleExpectedImprovementEvaluator::ComputeGradExpectedImprovem
   }
 }
 
+void OnePotentialSampleExpectedImprovementEvaluator::ComputeGradObjectiveFunctionBatch(
+    StateType * const * ei_states, int num_states, double const * restrict points_to_sample,
+    double * restrict grad_EI) const {
+  SetCurrentPointBatch(*this, ei_states, num_states, points_to_sample);
+  for (int k = 0; k < num_states; ++k) {
+    ComputeGradExpectedImprovement(ei_states[k], grad_EI + k*dim_);
+  }
+}
+
+/*!\rst
+  Each block of ``kExpectedImprovementBlockSize`` points goes through four dependency-free loops (standardize, cdf,
+  pdf, combine) over stack arrays, so the compiler can vectorize the arithmetic and the ``erfc``/``exp`` calls stream
+  through L1.  ``cdf(z) = erfc(-z/sqrt(2))/2`` and ``pdf(z) = exp(-z^2/2)/sqrt(2*pi)`` are what boost's normal
+  distribution computes in ComputeExpectedImprovement().
+\endrst*/
+void OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfPoints(
+    double const * restrict points, int num_points, int max_num_threads,
+    double * restrict expected_improvement) const {
+  // expected_improvement holds the GP means until each block overwrites them with EI
+  std::vector<double> to_sample_var(num_points);
+  gaussian_process_->PredictMarginals(points, num_points, max_num_threads, expected_improvement, to_sample_var.data());
+
+  const int block_size = kExpectedImprovementBlockSize;
+  const int num_blocks = (num_points + block_size - 1)/block_size;
+  const int num_threads = std::max(std::min(max_num_threads, num_blocks), 1);
+
+#pragma omp parallel for num_threads(num_threads) schedule(static) if(num_threads > 1)
+  for (int block = 0; block < num_blocks; ++block) {
+    const int first_point = block*block_size;
+    const int this_block_size = std::min(block_size, num_points - first_point);
+    ComputeExpectedImprovementOfMarginals(best_so_far_, expected_improvement + first_point,
+                                          to_sample_var.data() + first_point, this_block_size,
+                                          expected_improvement + first_point);
+  }
+}
+
+void OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfMarginals(
+    double best_so_far, double const * mean, double const * restrict variance, int num_points,
+    double * expected_improvement) noexcept {
+  const double kInverseSqrt2 = 1.0/std::sqrt(2.0);
+  const double kInverseSqrt2Pi = 1.0/std::sqrt(2.0*kPi);
+  double improvement[kExpectedImprovementBlockSize];
+  double sigma[kExpectedImprovementBlockSize];
+  double z[kExpectedImprovementBlockSize];
+  double cdf_z[kExpectedImprovementBlockSize];
+  double pdf_z[kExpectedImprovementBlockSize];
+
+  // mean is fully read before expected_improvement is written, so the two may alias
+  for (int i = 0; i < num_points; ++i) {
+    sigma[i] = std::sqrt(std::fmax(kMinimumVarianceEI, variance[i]));
+    improvement[i] = best_so_far - mean[i];
+    z[i] = improvement[i]/sigma[i];
+  }
+  for (int i = 0; i < num_points; ++i) {
+    cdf_z[i] = 0.5*std::erfc(-z[i]*kInverseSqrt2);
+  }
+  for (int i = 0; i < num_points; ++i) {
+    pdf_z[i] = kInverseSqrt2Pi*std::exp(-0.5*z[i]*z[i]);
+  }
+  for (int i = 0; i < num_points; ++i) {
+    expected_improvement[i] = std::fmax(0.0, improvement[i]*cdf_z[i] + sigma[i]*pdf_z[i]);
+  }
+}
+
 void OnePotentialSampleExpectedImprovementState::SetCurrentPoint(const EvaluatorType& ei_evaluator,
                                                                  double const * restrict point_to_sample_in) {
+  PrepareCurrentPoint(ei_evaluator, point_to_sample_in);
+  // evaluate derived quantities
+  ei_evaluator.gaussian_process()->FillPointsToSampleState(&points_to_sample_state);
+}
+
+void OnePotentialSampleExpectedImprovementState::PrepareCurrentPoint(const EvaluatorType& ei_evaluator,
+                                                                     double const * restrict point_to_sample_in) {
   // update current point in union_of_points
   std::copy(point_to_sample_in, point_to_sample_in + dim, point_to_sample.data());
 
-  // evaluate derived quantities
-  points_to_sample_state.SetupState(*ei_evaluator.gaussian_process(), point_to_sample.data(),
-                                    num_to_sample, 0, num_derivatives, (num_derivatives>0));
+  points_to_sample_state.PrepareState(*ei_evaluator.gaussian_process(), point_to_sample.data(),
+                                      num_to_sample, 0, num_derivatives, (num_derivatives>0));
 }
 
 OnePotentialSampleExpectedImprovementState::OnePotentialSampleExpectedImprovementState(
@@ -2198,14 +4012,28 @@ void OnePotentialSampleExpectedImprovementState::SetupState(const EvaluatorType&
   SetCurrentPoint(ei_evaluator, point_to_sample_in);
 }
 
+bool OnePotentialSampleExpectedImprovementState::Reconfigure(const EvaluatorType& ei_evaluator,
+                                                             double const * restrict point_to_sample_in,
+                                                             bool configure_for_gradients) {
+  if (dim != ei_evaluator.dim() || num_derivatives != (configure_for_gradients ? num_to_sample : 0) ||
+      points_to_sample_state.num_gradients_sampled != ei_evaluator.gaussian_process()->num_derivatives()) {
+    return false;
+  }
+
+  SetCurrentPoint(ei_evaluator, point_to_sample_in);
+  return true;
+}
+
 /*!\rst
   Routes the EI computation through MultistartOptimizer + NullOptimizer to perform EI function evaluations at the list of input
-  points, using the appropriate EI evaluator (e.g., monte carlo vs analytic) depending on inputs.
+  points, using the appropriate EI evaluator (e.g., monte carlo vs analytic) depending on inputs.  The analytic (1,0-EI)
+  case skips the per-point states and evaluates the whole list through
+  OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfPoints().
 \endrst*/
 void EvaluateEIAtPointList(const GaussianProcess& gaussian_process, const ThreadSchedule& thread_schedule,
                            double const * restrict initial_guesses, double const * restrict points_being_sampled,
                            int num_multistarts, int num_to_sample, int num_being_sampled, double best_so_far,
-                           int max_int_steps, bool * restrict found_flag, NormalRNG * normal_rng,
+                           int max_int_steps, bool * restrict found_flag, NormalRNGArray normal_rng,
                            double * restrict function_values, double * restrict best_next_point) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
@@ -2215,24 +4043,27 @@ void EvaluateEIAtPointList(const GaussianProcess& gaussian_process, const Thread
   DomainType dummy_domain;
   bool configure_for_gradients = false;
   if (num_to_sample == 1 && num_being_sampled == 0) {
-    // special analytic case when we are not using (or not accounting for) multiple, simultaneous experiments
+    // special analytic case when we are not using (or not accounting for) multiple, simultaneous experiments:
+    // batched over the whole list, so no per-point state is needed
     OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
-
-    std::vector<typename OnePotentialSampleExpectedImprovementEvaluator::StateType> ei_state_vector;
-    SetupExpectedImprovementState(ei_evaluator, initial_guesses, thread_schedule.max_num_threads,
-                                  configure_for_gradients, &ei_state_vector);
-
-    // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
-    OptimizationIOContainer io_container(ei_state_vector[0].GetProblemSize(), -1.0, initial_guesses);
-
-    NullOptimizer<OnePotentialSampleExpectedImprovementEvaluator, DomainType> null_opt;
-    typename NullOptimizer<OnePotentialSampleExpectedImprovementEvaluator, DomainType>::ParameterStruct null_parameters;
-    MultistartOptimizer<NullOptimizer<OnePotentialSampleExpectedImprovementEvaluator, DomainType> > multistart_optimizer;
-    multistart_optimizer.MultistartOptimize(null_opt, ei_evaluator, null_parameters, dummy_domain,
-                                            thread_schedule, initial_guesses, num_multistarts,
-                                            ei_state_vector.data(), function_values, &io_container);
-    *found_flag = io_container.found_flag;
-    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    std::vector<double> EI_values(function_values == nullptr ? num_multistarts : 0);
+    double * restrict EI = function_values == nullptr ? EI_values.data() : function_values;
+    ei_evaluator.ComputeExpectedImprovementOfPoints(initial_guesses, num_multistarts, thread_schedule.max_num_threads,
+                                                    EI);
+
+    // as in MultistartOptimize(): the winner starts as the first point with a 'forced' value of -1.0, and a later
+    // point must be strictly better to replace it
+    const int dim = gaussian_process.dim();
+    double best_objective_value_so_far = -1.0;
+    int best_index = 0;
+    for (int i = 0; i < num_multistarts; ++i) {
+      if (best_objective_value_so_far < EI[i]) {
+        best_objective_value_so_far = EI[i];
+        best_index = i;
+      }
+    }
+    *found_flag = best_objective_value_so_far > -1.0;
+    std::copy(initial_guesses + best_index*dim, initial_guesses + (best_index+1)*dim, best_next_point);
   } else {
     ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
 
@@ -2255,6 +4086,136 @@ void EvaluateEIAtPointList(const GaussianProcess& gaussian_process, const Thread
   }
 }
 
+void ComputeExpectedImprovementAtPointSets(const GaussianProcess& gaussian_process,
+                                           const ThreadSchedule& thread_schedule,
+                                           double const * restrict point_sets,
+                                           double const * restrict points_being_sampled,
+                                           int num_sets, int num_to_sample, int num_being_sampled,
+                                           double best_so_far, int max_int_steps, NormalRNGArray normal_rng,
+                                           double * restrict function_values, double * restrict gradients) {
+  if (unlikely(num_sets <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_sets must be >= 1", num_sets, 1);
+  }
+
+  const bool configure_for_gradients = gradients != nullptr;
+  const int num_threads = std::max(std::min(thread_schedule.max_num_threads, num_sets), 1);
+  ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
+  std::vector<typename ExpectedImprovementEvaluator::StateType> ei_state_vector;
+  SetupExpectedImprovementState(ei_evaluator, point_sets, points_being_sampled, num_to_sample, num_being_sampled,
+                                num_threads, configure_for_gradients, normal_rng, &ei_state_vector);
+  EvaluateObjectiveAtPointSets(ei_evaluator, point_sets, num_sets, num_threads, ei_state_vector.data(),
+                               function_values, gradients);
+}
+
+/*!\rst
+  Like the MultistartOptimizer + NullOptimizer loop of the fixed-size overload, except that every state's
+  ``prune_threshold`` is the shared best EI found so far.
+\endrst*/
+void EvaluateEIAtPointList(const GaussianProcess& gaussian_process, const ThreadSchedule& thread_schedule,
+                           double const * restrict initial_guesses, double const * restrict points_being_sampled,
+                           int num_multistarts, int num_to_sample, int num_being_sampled, double best_so_far,
+                           const AdaptiveMonteCarloParameters& adaptive_parameters, bool * restrict found_flag,
+                           NormalRNGArray normal_rng, double * restrict function_values,
+                           double * restrict standard_errors, int * restrict num_mc_iterations_used,
+                           double * restrict best_next_point) {
+  if (num_to_sample == 1 && num_being_sampled == 0) {
+    // analytic: nothing to adapt or prune
+    EvaluateEIAtPointList(gaussian_process, thread_schedule, initial_guesses, points_being_sampled, num_multistarts,
+                          num_to_sample, num_being_sampled, best_so_far, adaptive_parameters.max_num_mc_iterations,
+                          found_flag, normal_rng, function_values, best_next_point);
+    if (standard_errors != nullptr) {
+      std::fill(standard_errors, standard_errors + num_multistarts, 0.0);
+    }
+    if (num_mc_iterations_used != nullptr) {
+      std::fill(num_mc_iterations_used, num_mc_iterations_used + num_multistarts, 0);
+    }
+    return;
+  }
+  if (unlikely(num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
+  }
+
+  bool configure_for_gradients = false;
+  ExpectedImprovementEvaluator ei_evaluator(gaussian_process, adaptive_parameters, best_so_far,
+                                            MonteCarloPrecision::kDouble);
+  std::vector<typename ExpectedImprovementEvaluator::StateType> ei_state_vector;
+  SetupExpectedImprovementState(ei_evaluator, initial_guesses, points_being_sampled, num_to_sample,
+                                num_being_sampled, thread_schedule.max_num_threads,
+                                configure_for_gradients, normal_rng, &ei_state_vector);
+  const int problem_size = ei_state_vector[0].GetProblemSize();
+
+  // init winner to be first point in set and 'force' its value to be -1.0; we cannot do worse than this
+  double best_objective_value_so_far = -1.0;
+  std::copy(initial_guesses, initial_guesses + problem_size, best_next_point);
+
+  // guards best_objective_value_so_far and best_next_point
+  std::mutex best_mutex;
+  // evaluates candidate i on the state of the given thread (or task slot)
+  auto evaluate_candidate = [&](int thread_id, int i) {
+    auto& ei_state = ei_state_vector[thread_id];
+    SelectNormalStream(&ei_state, i);
+    ei_state.SetCurrentPoint(ei_evaluator, initial_guesses + i*problem_size);
+    {
+      std::lock_guard<std::mutex> lock(best_mutex);
+      ei_state.prune_threshold = best_objective_value_so_far;
+    }
+
+    const double objective_value = ei_evaluator.ComputeObjectiveFunction(&ei_state);
+    if (function_values != nullptr) {
+      function_values[i] = objective_value;
+    }
+    if (standard_errors != nullptr) {
+      standard_errors[i] = ei_state.standard_error;
+    }
+    if (num_mc_iterations_used != nullptr) {
+      num_mc_iterations_used[i] = ei_state.num_mc_iterations_used;
+    }
+
+    if (!ei_state.pruned) {
+      std::lock_guard<std::mutex> lock(best_mutex);
+      if (best_objective_value_so_far < objective_value) {
+        best_objective_value_so_far = objective_value;
+        std::copy(initial_guesses + i*problem_size, initial_guesses + (i+1)*problem_size, best_next_point);
+      }
+    }
+  };
+
+  if (thread_schedule.backend == ParallelBackend::kWorkStealing) {
+    WorkStealingScheduler::Instance().ParallelFor(num_multistarts, std::max(thread_schedule.max_num_threads, 1),
+                                                  evaluate_candidate);
+    *found_flag = best_objective_value_so_far > -1.0;
+    return;
+  }
+
+  // see MultistartOptimizer::MultistartOptimize() for why exceptions must be captured inside the parallel region
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+  omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
+#pragma omp parallel num_threads(thread_schedule.max_num_threads)
+  {
+    const int thread_id = omp_get_thread_num();
+
+#pragma omp for schedule(runtime)
+    for (int i = 0; i < num_multistarts; ++i) {
+      try {
+        evaluate_candidate(thread_id, i);
+      } catch (const std::exception& except) {
+        OL_ERROR_PRINTF("Thread %d of %d failed on iteration %d of %d. Message:\n%s\n", thread_id,
+                        thread_schedule.max_num_threads, i, num_multistarts, except.what());
+        std::call_once(exception_capture_flag, [&captured_exception]() {
+            captured_exception = std::current_exception();
+          });
+      }
+    }
+  }
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+  *found_flag = best_objective_value_so_far > -1.0;
+}
+
 /*!\rst
   This is a simple wrapper around ComputeOptimalPointsToSampleWithRandomStarts() and
   ComputeOptimalPointsToSampleViaLatinHypercubeSearch(). That is, this method attempts multistart gradient descent
@@ -2274,7 +4235,7 @@ void ComputeOptimalPointsToSample(const GaussianProcess& gaussian_process,
                                   int max_int_steps, bool lhc_search_only,
                                   int num_lhc_samples, bool * restrict found_flag,
                                   UniformRandomGenerator * uniform_generator,
-                                  NormalRNG * normal_rng, double * restrict best_points_to_sample) {
+                                  NormalRNGArray normal_rng, double * restrict best_points_to_sample) {
   if (unlikely(num_to_sample <= 0)) {
     return;
   }
@@ -2292,8 +4253,10 @@ void ComputeOptimalPointsToSample(const GaussianProcess& gaussian_process,
                                                  next_points_to_sample.data());
   }
 
-  // if gradient descent EI optimization failed OR we're only doing latin hypercube searches
-  if (found_flag_local == false || lhc_search_only == true) {
+  // past the optimizer's deadline, return gradient descent's result instead of starting a search
+  const bool out_of_time = optimizer_parameters.deadline.Expired();
+  // if gradient descent EI optimization failed (with time left) OR we're only doing latin hypercube searches
+  if ((found_flag_local == false && !out_of_time) || lhc_search_only == true) {
     if (unlikely(lhc_search_only == false)) {
       OL_WARNING_PRINTF("WARNING: %d,%d-EI opt DID NOT CONVERGE\n", num_to_sample, num_being_sampled);
       OL_WARNING_PRINTF("Attempting latin hypercube search\n");
@@ -2335,13 +4298,20 @@ template void ComputeOptimalPointsToSample(
     double const * restrict points_being_sampled, int num_to_sample,
     int num_being_sampled, double best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 template void ComputeOptimalPointsToSample(
     const GaussianProcess& gaussian_process, const GradientDescentParameters& optimizer_parameters,
     const SimplexIntersectTensorProductDomain& domain, const ThreadSchedule& thread_schedule,
     double const * restrict points_being_sampled,
     int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
     bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+template void ComputeOptimalPointsToSample(
+    const GaussianProcess& gaussian_process, const GradientDescentParameters& optimizer_parameters,
+    const TrustRegionDomain& domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled,
+    int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
+    bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 
 }  // end namespace optimal_learning
@@ -203,8 +203,10 @@
 #define MOE_OPTIMAL_LEARNING_CPP_GPP_MATH_HPP_
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <stdlib.h>
@@ -212,11 +214,14 @@
 
 #include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
 
+#include "gpp_aligned_allocator.hpp"
 #include "gpp_common.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_covariance.hpp"
+#include "gpp_linear_algebra.hpp"
 #include "gpp_logging.hpp"
+#include "gpp_memory_budget.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
 #include "gpp_random.hpp"
@@ -236,6 +241,17 @@ void BuildMixCovarianceMatrix(const CovarianceInterface& covariance,
 struct ThreadSchedule;
 struct PointsToSampleState;
 
+/*!\rst
+  Which points a windowed GaussianProcess (see GaussianProcess::SetSlidingWindow()) evicts once AddPointsToGP() takes
+  it past its maximum number of points.
+\endrst*/
+enum class GaussianProcessWindowPolicy {
+  //! evict the oldest points (first-in, first-out); suits streaming data from a drifting objective
+  kMostRecent = 0,
+  //! evict the points best explained by the rest, i.e., with the smallest leave-one-out predictive variance
+  kMostInformative = 1,
+};
+
 /*!\rst
   Object that encapsulates Gaussian Process Priors (GPPs).  A GPP is defined by a set of
   (sample point, function value, noise variance) triples along with a covariance function that relates the points.
@@ -259,6 +275,12 @@ struct PointsToSampleState;
 
   .. Note:: the preceding comments are copied in Python: interfaces/gaussian_process_interface.py
 
+  For large ``num_sampled`` (especially with gradient observations, where ``K`` has ``num_sampled*(num_derivatives+1)``
+  rows), the inducing-point constructor builds a sparse (FITC) approximation that stores an equivalent GP over a few
+  inducing points instead; all of the mean/variance methods below are shared.  For observations on a full Cartesian
+  grid, the grid constructor keeps ``K`` (a Kronecker product of per-dimension kernels) in eigendecomposed form instead
+  of factoring it, which is exact and costs ``O(N * \sum_d n_d)`` per solve rather than ``O(N^3)`` to fit.
+
   For testing and experimental purposes, this class provides a framework for sampling points from the GP (i.e., given a
   point to sample and predicted measurement noise) as well as adding additional points to an already-formed GP.  Sampling
   points requires drawing from \ms N(0,1)\me so this class also holds PRNG state to do so via the NormalRNG object from gpp_random.
@@ -267,6 +289,12 @@ struct PointsToSampleState;
        Functions that manipulate the PRNG directly or indirectly (changing state, generating points)
        are NOT THREAD-SAFE. All thread-safe functions are marked const.
 
+  The const methods only read the fitted model (``X``, ``y``, ``K_chol_``, ``K^-1 y``, the covariance), writing solely to
+  the caller's PointsToSampleState and outputs, so any number of threads may predict from one shared GaussianProcess at
+  once, each with its own states; there is no need to Clone() it per thread or request.  To sample from a shared GP,
+  give each caller a GaussianProcessSampler (its own PRNG and scratch) instead of the SamplePoint*() methods below.
+  Anything non-const (sampling, seeding, adding/removing points, changing hyperparameters) needs exclusive access.
+
   These mean/variance methods require some external state: namely, the set of potential points to sample.  Additionally,
   temporaries and derived quantities depending on these "points to sample" eliminate redundant computation.  This external
   state is handled through PointsToSampleState objects, which are constructed separately and filled through
@@ -290,6 +318,23 @@ class GaussianProcess final {
   //! and tested for robustness with the setup in EIOnePotentialSampleEdgeCasesTest().
   static constexpr double kMinimumStdDev = std::numeric_limits<double>::epsilon();
 
+  //! Number of candidate points PredictMarginals() handles at once.  Each tile holds ``K(X, Xs)`` for this many
+  //! points, which stays cache-resident for moderate ``num_sampled`` while still giving the triangular solve
+  //! enough right-hand sides to run at matrix-matrix speed.
+  static constexpr int kPredictMarginalsTileSize = 64;
+
+  //! Number of training points whose cross-covariance with the inducing points the sparse (FITC) constructor holds at
+  //! once; memory for the fit is ``O(M^2 + M*kSparseTrainingTileSize)`` (in covariance rows) instead of ``O(N^2)``.
+  static constexpr int kSparseTrainingTileSize = 256;
+  //! Relative jitter added to the diagonal of ``K(U,U)`` (the inducing points' prior covariance) in FITC mode.
+  static constexpr double kInducingPointJitter = 1.0e-10;
+  //! FITC noise floor, relative to the prior variance of each observation; keeps ``\Lambda^{-1}`` finite without noise.
+  static constexpr double kSparseMinimumRelativeNoise = 1.0e-10;
+  //! Diagonal of ``K_chol_`` in the rows of masked derivative observations (see SetDerivativeMask()).  Solves divide
+  //! those rows by it, so their weight in any prediction is ``O(K/kMaskedCholeskyDiagonal^2)``: far below roundoff,
+  //! while its square stays far from overflow.
+  static constexpr double kMaskedCholeskyDiagonal = 1.0e50;
+
   /*!\rst
     Constructs a GaussianProcess object.  All inputs are required; no default constructor nor copy/assignment are allowed.
 
@@ -312,8 +357,139 @@ class GaussianProcess final {
                   int num_derivatives_in,
                   int dim_in, int num_sampled_in) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Constructs a GaussianProcess object that shares (does not copy) its training data with other GaussianProcess objects,
+    e.g., one GP per hyperparameter sample over the same observations.
+
+    The shared data is never modified: AddPointsToGP() gives this GP its own, extended copy.
+
+    \param
+      :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_sampled]: values of the already-sampled points
+      :noise_variance[num_derivatives+1]: the ``\sigma_n^2`` (noise variance) associated w/observation, points_sampled_value
+      :derivatives[num_derivatives]: indices of the dimensions whose derivatives are observed
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+      :training_differences: optional squared differences of ``points_sampled`` (with ``derivatives``), shared by every
+        GP over the same data; ``K(X, X)`` is then built from them (see PairwiseDifferences)
+  \endrst*/
+  GaussianProcess(const CovarianceInterface& covariance_in,
+                  std::shared_ptr<const std::vector<double>> points_sampled_in,
+                  std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                  double const * restrict noise_variance_in,
+                  std::shared_ptr<const std::vector<int>> derivatives_in,
+                  int dim_in, int num_sampled_in,
+                  std::shared_ptr<const PairwiseDifferences> training_differences_in = nullptr);
+
+  /*!\rst
+    Constructs a GaussianProcess from previously computed derived variables (e.g., read from a snapshot, see
+    gpp_model_snapshot.hpp) instead of building and factoring ``K``.  The inputs must come from a GP with the same
+    covariance, data, and noise; they are not checked.  Not for FITC (sparse) GPs.
+
+    \param
+      :covariance...training_differences: as in the shared-data constructor above
+      :mean: the mean of the function values (see get_mean())
+      :K_chol[num_sampled*(num_derivatives+1)][num_sampled*(num_derivatives+1)]: cholesky factor of ``K`` (see get_K_chol())
+      :K_inv_y[num_sampled*(num_derivatives+1)]: ``K^-1 * y`` (see get_K_inv_y())
+  \endrst*/
+  GaussianProcess(const CovarianceInterface& covariance_in,
+                  std::shared_ptr<const std::vector<double>> points_sampled_in,
+                  std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                  double const * restrict noise_variance_in,
+                  std::shared_ptr<const std::vector<int>> derivatives_in,
+                  int dim_in, int num_sampled_in,
+                  double mean_in, double const * restrict K_chol_in, double const * restrict K_inv_y_in,
+                  std::shared_ptr<const PairwiseDifferences> training_differences_in = nullptr) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Constructs a sparse (inducing-point) GaussianProcess for large ``num_sampled``, using the FITC (fully independent
+    training conditional) approximation: the training observations are conditioned only through the latent values at
+    ``M`` inducing points ``U``, with each observation's prior variance left over from that projection treated as extra
+    independent noise:
+
+    | ``Q(A,B) = K(A,U) * K(U,U)^{-1} * K(U,B)``, ``\Lambda = diag(K(X,X) - Q(X,X)) + \sigma_n^2``
+    | ``\Sigma = [K(U,U) + K(U,X) * \Lambda^{-1} * K(X,U)]^{-1}``
+    | mean: ``K(Xs,U) * \Sigma * K(U,X) * \Lambda^{-1} * y``
+    | variance: ``K(Xs,Xs) - K(Xs,U) * [K(U,U)^{-1} - \Sigma] * K(U,Xs)``
+
+    This is exactly the posterior of an ordinary GP conditioned on ``M`` pseudo-observations at ``U`` whose (correlated)
+    noise is ``K(U,U) * [K(U,X) \Lambda^{-1} K(X,U)]^{-1} * K(U,U)``, so the resulting object stores that GP:
+    points_sampled(), num_sampled(), ``K_chol_`` and ``K_inv_y_`` refer to the inducing points, and every mean, variance,
+    and gradient method (hence ExpectedImprovementEvaluator, KnowledgeGradientEvaluator, etc.) works unchanged at
+    ``O(M)`` instead of ``O(N)`` cost per point.  The fit costs ``O(N*M^2)`` time and never forms an ``N x N`` matrix.
+    Both ``N`` and ``M`` count covariance rows, i.e., points times ``1 + num_derivatives``: inducing points carry the
+    same derivative observations as the training data.
+
+    SetHyperparameters(), SetCovarianceHyperparameters(), and AddPointsToGP() refit the approximation against the (full)
+    training data; AddPointsToGP() appends to the training data, not to the inducing points.
+
+    \param
+      :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+      :points_sampled[dim][num_sampled]: points that have already been sampled (training data)
+      :points_sampled_value[num_sampled]: values of the already-sampled points
+      :noise_variance[num_derivatives+1]: the ``\sigma_n^2`` (noise variance) associated w/observation, points_sampled_value
+      :derivatives[num_derivatives]: indices of the dimensions whose derivatives are observed
+      :num_derivatives: number of derivatives observed at each point
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+      :inducing_points[dim][num_inducing]: the inducing points ``U``; e.g., a subset or a space-filling design over the
+        training data.  Must be distinct.
+      :num_inducing: number of inducing points, ``M``; usually much smaller than ``num_sampled``
+  \endrst*/
+  GaussianProcess(const CovarianceInterface& covariance_in,
+                  double const * restrict points_sampled_in,
+                  double const * restrict points_sampled_value_in,
+                  double const * restrict noise_variance_in,
+                  int const * restrict derivatives_in,
+                  int num_derivatives_in,
+                  int dim_in, int num_sampled_in,
+                  double const * restrict inducing_points_in,
+                  int num_inducing_in) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Constructs a GaussianProcess over observations on a full Cartesian grid (e.g., a sweep of fidelity x learning rate),
+    exploiting that a SquareExponential covariance is a product of per-dimension kernels.  Over the grid,
+
+    | ``K = \alpha * (K_{dim-1} \otimes ... \otimes K_0) + \sigma_n^2 I``, ``K_d = Q_d * \Lambda_d * Q_d^T``
+    | ``K^-1 = Q * (\Lambda + \sigma_n^2 I)^{-1} * Q^T``, ``Q = Q_{dim-1} \otimes ... \otimes Q_0``,
+      ``\Lambda = \alpha * (\Lambda_{dim-1} \otimes ... \otimes \Lambda_0)``
+
+    so fitting costs ``O(\sum_d n_d^3)`` (one small eigendecomposition per dimension) and every solve with ``K``,
+    ``O(N * \sum_d n_d)`` per right hand side, never forming an ``N x N`` matrix (``N = \prod_d n_d``).  The model is
+    exactly the dense GP over the same points, and every mean, variance, and gradient method (hence
+    ExpectedImprovementEvaluator, KnowledgeGradientEvaluator, etc.) works unchanged.  points_sampled() holds the
+    (expanded) grid points; get_K_chol() is empty.
+
+    SetHyperparameters() and SetCovarianceHyperparameters() refit the eigendecompositions.  AddPointsToGP() and
+    RemovePointsFromGP() break the grid, so they convert this GP to the ordinary (cholesky-factored) form.
+
+    \param
+      :covariance: a SquareExponential covariance (the only separable covariance here)
+      :grid_coordinates[\sum_d grid_sizes[d]]: the coordinates of the grid along each dimension, concatenated in order
+        of dimension.  Coordinates along each dimension must be distinct.
+      :grid_sizes[dim]: number of coordinates along each dimension, ``n_d``
+      :points_sampled_value[\prod_d grid_sizes[d]]: values at the grid points; the point with coordinate indices
+        ``(i_0, i_1, ...)`` is number ``i_0 + n_0*(i_1 + n_1*(i_2 + ...))`` (dimension 0 fastest)
+      :noise_variance[1]: the ``\sigma_n^2`` (noise variance) associated w/observation, points_sampled_value
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+    \raise
+      OptimalLearningException if covariance is not a SquareExponential;
+      LowerBoundException if some ``grid_sizes[d] < 1``;
+      SingularMatrixException if ``K`` is (numerically) singular, e.g., repeated coordinates without noise
+  \endrst*/
+  GaussianProcess(const CovarianceInterface& covariance_in,
+                  double const * restrict grid_coordinates_in,
+                  int const * restrict grid_sizes_in,
+                  double const * restrict points_sampled_value_in,
+                  double const * restrict noise_variance_in,
+                  int dim_in) OL_NONNULL_POINTERS;
+
+  //! copies share the (immutable) training data of ``source``
   GaussianProcess(const GaussianProcess& source);
 
+  GaussianProcess(GaussianProcess&& source) = default;
+
   int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return dim_;
   }
@@ -322,16 +498,46 @@ class GaussianProcess final {
     return num_sampled_;
   }
 
+  //! true if this GP was built with inducing points (the FITC constructor); points_sampled() etc. are then the inducing points
+  bool is_sparse() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return training_points_ != nullptr;
+  }
+
+  //! number of training points; equal to num_sampled() unless is_sparse()
+  int num_training_points() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return is_sparse() ? num_training_ : num_sampled_;
+  }
+
+  //! true if this GP holds ``K`` in Kronecker-eigendecomposed form (the grid constructor); get_K_chol() is then empty
+  bool is_grid() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return !grid_sizes_.empty();
+  }
+
+  //! number of grid coordinates along each dimension if is_grid(); empty otherwise
+  const std::vector<int>& grid_sizes() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return grid_sizes_;
+  }
+
   int num_derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return num_derivatives_;
   }
 
+  /*!\rst
+    Process-wide unique stamp of this GP's current fit: renewed by every change to the training data or
+    hyperparameters (AddPointsToGP(), SetCovarianceHyperparameters(), ...) and shared by copies.  Results computed
+    against one version stay valid while it is current; e.g., GaussianProcessResultCache (gpp_result_cache.hpp) keys
+    on it.
+  \endrst*/
+  std::uint64_t version() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return version_;
+  }
+
   const std::vector<double>& points_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-    return points_sampled_;
+    return *points_sampled_;
   }
 
   const std::vector<double>& points_sampled_value() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-    return points_sampled_value_;
+    return *points_sampled_value_;
   }
 
   const std::vector<double>& noise_variance() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
@@ -339,17 +545,28 @@ class GaussianProcess final {
   }
 
   const std::vector<int>& derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-    return derivatives_;
+    return *derivatives_;
   }
 
   double get_mean() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return mean_;
   }
 
-  const std::vector<double>& get_K_inv_y() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+  const AlignedVector<double>& get_K_inv_y() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return K_inv_y_;
   }
 
+  //! maximum number of (training) points kept by AddPointsToGP(); 0 if the GP is not windowed
+  int max_num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_num_sampled_;
+  }
+
+  //! cholesky factor of ``K``, ``[num_sampled*(num_derivatives+1)]^2`` (only the lower triangle is meaningful); empty
+  //! if is_grid().  If is_cholesky_packed(), only the lower triangle is held, packed (see PackedTriangleSize()).
+  const AlignedVector<double>& get_K_chol() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return K_chol_;
+  }
+
   /*!\rst
     Change the hyperparameters of this GP's covariance function.
     Also forces recomputation of all derived quantities for GP to remain consistent.
@@ -366,6 +583,24 @@ class GaussianProcess final {
     RecomputeDerivedVariables();
   }
 
+  /*!\rst
+    Change the covariance hyperparameters AND the noise variance of this GP, recomputing derived quantities once.
+    This lets a long-lived GP (e.g., one held across Python calls) follow hyperparameter re-optimization without being
+    rebuilt; the (possibly shared) training data is untouched.
+
+    .. WARNING:: invalidates PointsToSampleState objects created with "this" object; see SetCovarianceHyperparameters().
+
+    \param
+      :hyperparameters_new[covariance_ptr->GetNumberOfHyperparameters]: new hyperparameter array
+      :noise_variance_new[num_derivatives+1]: new \sigma_n^2 for the function value and each observed derivative
+  \endrst*/
+  void SetHyperparameters(double const * restrict hyperparameters_new,
+                          double const * restrict noise_variance_new) OL_NONNULL_POINTERS {
+    covariance_ptr_->SetHyperparameters(hyperparameters_new);
+    std::copy(noise_variance_new, noise_variance_new + num_derivatives_ + 1, noise_variance_.begin());
+    RecomputeDerivedVariables();
+  }
+
   /*!\rst
     Sets up the PointsToSampleState object so that it can be used to compute GP mean, variance, and gradients thereof.
     ASSUMES all needed space is ALREADY ALLOCATED.
@@ -379,10 +614,25 @@ class GaussianProcess final {
   \endrst*/
   void FillPointsToSampleState(StateType * points_to_sample_state) const OL_NONNULL_POINTERS;
 
+  /*!\rst
+    FillPointsToSampleState() for several states at once; used by the evaluators' ComputeGradObjectiveFunctionBatch()
+    so that a batch of points shares one cholesky solve against the training covariance.
+    ASSUMES all needed space is ALREADY ALLOCATED (e.g., via PointsToSampleState::PrepareState()).
+
+    \param
+      :points_to_sample_states[num_states]: pointers to PointsToSampleState objects where all space has been properly allocated
+      :num_states: number of states
+    \output
+      :points_to_sample_states[num_states]: pointers to fully configured PointsToSampleState objects. overwrites input
+  \endrst*/
+  void FillPointsToSampleStateBatch(StateType * const * points_to_sample_states, int num_states) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Add the specified (point, fcn value, noise variance) historical data to this GP.
 
-    Forces recomputation of all derived quantities for GP to remain consistent.
+    Derived quantities are updated by appending the new rows to the existing cholesky factor (``O(N^2*k)``) rather
+    than refactoring; falls back to a full recomputation if the appended block is not SPD.  If a sliding window is set
+    (SetSlidingWindow()), points past the window are then evicted.
 
     \param
       :new_points[dim][num_new_points]: coordinates of each new point to add
@@ -395,6 +645,130 @@ class GaussianProcess final {
                      //double const * restrict new_points_noise_variance,
                      int num_new_points);
 
+  /*!\rst
+    Same as AddPointsToGP() above, except the caller supplies the already-extended training data, which this GP then
+    shares instead of building its own copy. GaussianProcessMCMC uses this to extend its training data once for all of
+    its GPs.
+
+    The first ``num_sampled`` points (and values) of the inputs MUST be this GP's current training data; the last
+    ``num_new_points`` are the points being added.  (If is_sparse(), the training data are the num_training_points()
+    points summarized by the inducing points, and the approximation is refit.)
+
+    \param
+      :points_sampled_in[dim][num_sampled + num_new_points]: current then new point coordinates
+      :points_sampled_value_in[(num_derivatives+1)*(num_sampled + num_new_points)]: current then new function values
+        (and derivatives)
+      :num_new_points: number of new points to add to the GP
+      :training_differences: optional squared differences of ``points_sampled_in`` (see the shared-data constructor);
+        any previously supplied ones are dropped
+  \endrst*/
+  void AddPointsToGP(std::shared_ptr<const std::vector<double>> points_sampled_in,
+                     std::shared_ptr<const std::vector<double>> points_sampled_value_in,
+                     int num_new_points,
+                     std::shared_ptr<const PairwiseDifferences> training_differences_in = nullptr);
+
+  /*!\rst
+    Remove the specified historical data from this GP.  The remaining points keep their relative order.
+
+    Derived quantities are updated by downdating the existing cholesky factor (``O(N^2*k)``) rather than refactoring.
+    If is_sparse(), the points are removed from the training data and the approximation is refit.
+
+    \param
+      :indices[num_points_to_remove]: indices (into points_sampled, or the training points if is_sparse()) of the
+        points to remove; strictly increasing
+      :num_points_to_remove: number of points to remove; must leave at least one point
+  \endrst*/
+  void RemovePointsFromGP(int const * restrict indices, int num_points_to_remove) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Turn this GP into a sliding-window GP: whenever AddPointsToGP() (the overload that builds its own copy of the
+    training data) takes it past ``max_num_sampled_in`` points, the excess is evicted with RemovePointsFromGP(), so
+    streaming observations cost ``O(M^2)`` per update instead of growing without bound.  Points already past the
+    limit are evicted immediately.
+
+    The shared-data AddPointsToGP() overload never evicts: its callers (e.g., GaussianProcessMCMC) manage the shared
+    training data themselves.
+
+    \param
+      :max_num_sampled_in: maximum number of (training) points to keep; 0 turns windowing off
+      :window_policy_in: which points to evict; kMostInformative is not supported if is_sparse()
+  \endrst*/
+  void SetSlidingWindow(int max_num_sampled_in, GaussianProcessWindowPolicy window_policy_in);
+
+  /*!\rst
+    Let later factorizations of ``K`` (AddPointsToGP(), RemovePointsFromGP() fallbacks, SetHyperparameters(), ...)
+    survive a numerically singular ``K`` (e.g., near-duplicate points_sampled with 0 noise): a failed pivot escalates
+    jitter in place and the factorization resumes from it (see ComputeCholeskyFactorLWithJitter()), instead of throwing
+    SingularMatrixException.  The fitted model is then that of ``K + E``, with ``E`` diagonal and at most
+    ``cholesky_jitter().jitter``.  Off (``max_relative_jitter = 0``) by default; does not refactor ``K`` now.
+
+    Only the dense mode's ``K`` is jittered; is_sparse() and is_grid() GPs ignore this.
+
+    \param
+      :initial_relative_jitter: first jitter tried, relative to ``max_i K_ii``; in ``(0, max_relative_jitter]`` if jitter
+        is on
+      :max_relative_jitter: largest jitter allowed, relative to ``max_i K_ii``; 0 turns jitter off
+  \endrst*/
+  void SetCholeskyJitter(double initial_relative_jitter, double max_relative_jitter);
+
+  //! jitter settings, and the jitter used by the most recent (dense) factorization of ``K``
+  const CholeskyJitter& cholesky_jitter() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return cholesky_jitter_;
+  }
+
+  /*!\rst
+    Hold the cholesky factor of ``K`` (get_K_chol()) as a packed lower triangle instead of a square matrix, about halving
+    the resident memory of a fitted model; all solves then use the Packed* kernels of ``gpp_linear_algebra``.  Converts
+    the current factor in place; later refits and updates keep the chosen layout.  Off by default.  No effect if
+    is_grid().
+
+    AddPointsToGP() and RemovePointsFromGP() update the factor in square form, so a packed GP briefly holds both
+    layouts while updating.
+
+    \param
+      :packed: true to pack the factor, false to hold it square
+  \endrst*/
+  void SetPackedCholeskyStorage(bool packed);
+
+  //! true if get_K_chol() is a packed lower triangle (see SetPackedCholeskyStorage())
+  bool is_cholesky_packed() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return packed_cholesky_;
+  }
+
+  /*!\rst
+    Observe only some derivatives at each point (e.g., adjoint runs return gradients, other runs only values): masked
+    entries drop out of the model exactly, as if they were never in points_sampled_value().  Only the observed rows of
+    ``K`` are factored, so a mostly-masked system factors at the cost of its observed size, ``O(num_observed_rows()^3)``.
+
+    ``K_chol_`` keeps its ``[num_sampled*(num_derivatives+1)]^2`` layout (so every prediction path, and every evaluator,
+    works unchanged): its masked rows and columns are 0 except for kMaskedCholeskyDiagonal on the diagonal.  That is the
+    factor of ``K`` with the masked observations given (numerically) infinite noise, which zeroes their weight in every
+    mean, variance, and gradient.
+
+    AddPointsToGP() observes every derivative of the new points; RemovePointsFromGP() drops the removed points' masks.
+    Not supported if is_sparse().  Refactors ``K``.
+
+    \param
+      :derivative_mask[num_derivatives][num_sampled]: 1 if the corresponding derivative observation (in the layout of
+        points_sampled_value(), without the function values) is observed, 0 if it is masked
+    \raise
+      OptimalLearningException if is_sparse()
+  \endrst*/
+  void SetDerivativeMask(int const * restrict derivative_mask) OL_NONNULL_POINTERS;
+
+  //! observe every derivative again (undoes SetDerivativeMask()); refactors ``K`` if a mask was set
+  void ClearDerivativeMask();
+
+  //! the mask set by SetDerivativeMask(), ``[num_derivatives][num_sampled]``; empty if every derivative is observed
+  const std::vector<int>& derivative_mask() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return derivative_mask_;
+  }
+
+  //! number of observed rows of ``K``: ``num_sampled*(num_derivatives+1)`` less the masked derivatives
+  int num_observed_rows() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return derivative_mask_.empty() ? num_sampled_*(num_derivatives_+1) : static_cast<int>(observed_rows_.size());
+  }
+
   /*!\rst
     Sample a function value from a Gaussian Process prior, provided a point at which to sample.
 
@@ -426,12 +800,48 @@ class GaussianProcess final {
 
   /*!\rst
     Approximate the global optima of the GP.
+
+    Each optimum is the best of ``inner_number`` uniform points drawn jointly with SamplePointsFromGP(), which is
+    ``O(inner_number^3)`` per optimum.  SampleGlobalOptimaViaPathwiseSamples() (gpp_posterior_sample.hpp) is much
+    cheaper for large ``inner_number``, refines each optimum with L-BFGS-B, and draws in parallel.
   \endrst*/
   void SampleGlobalOptimaFromGP(int const num_optima,
                                 int const inner_number,
                                 const TensorProductDomain& domain,
                                 double * points_optima) noexcept OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Low-rank variant of SamplePointsFromGP(): samples jointly from a rank ``<= max_rank`` pivoted cholesky factor of the
+    posterior covariance of ``points_to_sample`` (its diagonal plus at most ``max_rank`` columns), so a draw over
+    ``num_sample`` points costs ``O(num_sample * (num_sampled^2 + rank * (num_sampled + rank)))`` instead of
+    ``O(num_sample^3)``.  The factorization stops early once the largest variance it has not explained is at most
+    ``tolerance`` times the largest posterior variance.  The unexplained variance is added back as independent noise,
+    so the marginals are exact and only the correlations are truncated; with ``max_rank >= num_sample`` and
+    ``tolerance = 0``, the draws have the exact joint distribution.
+
+    The factor and its temporaries live in the same scratch as SamplePointsFromGP(), so repeated calls (e.g., from
+    SampleGlobalOptimaFromGP()) do no heap work for them.
+
+    \param
+      :points_to_sample[dim][num_sample]: points at which to sample
+      :num_sample: number of points
+      :max_rank: largest rank of the factor; at most ``num_sample`` is used
+      :tolerance: relative variance below which the factorization stops, e.g., ``1.0e-6``
+    \output
+      :results[num_sample]: the joint draw
+    \return
+      index of the smallest of ``results``
+  \endrst*/
+  int SamplePointsFromGP(double const * restrict points_to_sample, int num_sample, int max_rank, double tolerance,
+                         double * results) noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    SampleGlobalOptimaFromGP() with each of the ``num_optima`` joint draws made by the low-rank SamplePointsFromGP();
+    ``max_rank`` and ``tolerance`` are as there.
+  \endrst*/
+  void SampleGlobalOptimaFromGP(int num_optima, int inner_number, const TensorProductDomain& domain, int max_rank,
+                                double tolerance, double * points_optima) noexcept OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the mean of this GP at each of ``Xs`` (``points_to_sample``).
 
@@ -501,6 +911,46 @@ class GaussianProcess final {
                                int num_gradients_to_sample_part2,
                                double * restrict var_star) const noexcept OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Computes the mean and the marginal (pointwise) variance of this GP at each of ``points``, for screening large
+    candidate sets.  This gives ``mean_of_points`` from ComputeMeanOfPoints() and the diagonal of ``var_star`` from
+    ComputeVarianceOfPoints(), without building a PointsToSampleState or the joint covariance.
+
+    Candidates are processed in tiles of kPredictMarginalsTileSize points: for each tile, one ``K(X, Xs)`` block goes
+    through a matrix-vector product for the means and a triangular solve for ``V = L^-1 * K(X, Xs)``, and then
+    ``Var_i = K(Xs_i, Xs_i) - V_i^T * V_i``.  Tiles are independent and are spread across up to ``max_num_threads``
+    threads.
+
+    Unlike ComputeMeanOfPoints() and ComputeVarianceOfPoints(), ``points`` may contain duplicates.
+
+    \param
+      :points[dim][num_points]: points at which to predict
+      :num_points: number of points
+      :max_num_threads: maximum number of threads to use
+    \output
+      :mean_of_points[num_points]: mean of the GP at each point
+      :variance_of_points[num_points]: variance of the GP at each point
+  \endrst*/
+  void PredictMarginals(double const * restrict points, int num_points, int max_num_threads,
+                        double * restrict mean_of_points, double * restrict variance_of_points) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    PredictMarginals() for one tile, on the calling thread, at the points of ``cross_differences`` (its ``points_two``).
+    When ``cross_differences`` holds the differences to this GP's ``points_sampled``, ``K(X, Xs)`` is built from them
+    (CovarianceInterface::CrossCovarianceMatrix()), so GPs sharing ``points_sampled`` (e.g., the members of a
+    GaussianProcessMCMC) compute the differences once for all of them.
+
+    \param
+      :cross_differences: ``points_sampled`` and the points to predict, filled by CrossPairwiseDifferences::SetPoints()
+    \output
+      :scratch[num_sampled*(num_derivatives+1)][num_points]: overwritten
+      :mean_of_points[num_points]: mean of the GP at each point
+      :variance_of_points[num_points]: variance of the GP at each point
+  \endrst*/
+  void PredictMarginalsOfDifferences(const CrossPairwiseDifferences& cross_differences, double * restrict scratch,
+                                     double * restrict mean_of_points,
+                                     double * restrict variance_of_points) const noexcept OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the covariance (matrix) of this GP at each point of ``Xs`` (``points_to_sample``) and each point of discrete points.
 
@@ -659,6 +1109,71 @@ class GaussianProcess final {
                                                   int num_pts, bool precomputed, double const * ktd,
                                                   double * restrict grad_inverse_chol) const noexcept;
 
+  /*!\rst
+    Reverse mode counterpart of ComputeGradVarianceOfPoints(): contracts the variance's gradient with ``\bar{V}``, the
+    gradient of some scalar ``f`` wrt the (symmetric) variance ``V`` of ``points_to_sample``, without forming the
+    ``[dim][num_to_sample][num_to_sample][num_derivatives]`` tensor.  That is, accumulates::
+
+      grad[k][d] += \sum_{i,j} \bar{V}_{i,j} * \pderiv{V_{i,j}}{x_{d,k}}
+
+    With CholeskyFactorLAdjoint(), this differentiates any function of the cholesky factor of ``V`` in
+    ``O(num_to_sample^3 + num_sampled*num_to_sample*dim)``, instead of one Smith 1995 differentiation (``O(num_to_sample^3)``
+    each) per ``x_{d,k}`` as ComputeGradCholeskyVarianceOfPoints() does.
+
+    \param
+      :points_to_sample_state[1]: ptr to a FULLY CONFIGURED PointsToSampleState (configure via PointsToSampleState::SetupState)
+      :var_adjoint[num_to_sample][num_to_sample]: ``\bar{V}``, symmetric (e.g., from CholeskyFactorLAdjoint())
+      :grad[state->num_derivatives][dim]: gradient to accumulate into (on entry)
+    \output
+      :grad[state->num_derivatives][dim]: ``grad`` plus the contraction above (on exit)
+  \endrst*/
+  void ComputeAdjointGradVarianceOfPoints(StateType * points_to_sample_state, double const * restrict var_adjoint,
+                                          double * restrict grad) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Reverse mode counterpart of ComputeGradCovarianceOfPoints() (without gradient observations at ``discrete_pts``):
+    given ``\bar{C}``, the gradient of some scalar ``f`` wrt the covariance ``C`` between ``points_to_sample`` and
+    ``discrete_pts``, accumulates::
+
+      grad[k][d] += \sum_{i,j} \bar{C}_{i,j} * \pderiv{C_{i,j}}{x_{d,k}}
+
+    in ``O(num_sampled*num_to_sample*(num_pts + dim))`` and without forming the gradient tensor.
+
+    \param
+      :points_to_sample_state[1]: ptr to a FULLY CONFIGURED PointsToSampleState (configure via PointsToSampleState::SetupState)
+      :discrete_pts[dim][num_pts]: the (fixed) points the covariance is taken with
+      :num_pts: number of discrete_pts
+      :cov_adjoint[num_to_sample][num_pts]: ``\bar{C}``
+      :grad[state->num_derivatives][dim]: gradient to accumulate into (on entry)
+    \output
+      :points_to_sample_state[1]: ptr to a FULLY CONFIGURED PointsToSampleState; only temporary state may be mutated
+      :grad[state->num_derivatives][dim]: ``grad`` plus the contraction above (on exit)
+  \endrst*/
+  /*!\rst
+    Reverse mode counterpart of ComputeGradCholeskyVarianceOfPoints(): given ``\bar{L}``, the gradient of some scalar
+    ``f`` wrt the cholesky factor ``L`` of the variance of ``points_to_sample``, accumulates the gradient of ``f`` wrt
+    ``points_to_sample`` (through ``L``).  Runs CholeskyFactorLAdjoint() once, then ComputeAdjointGradVarianceOfPoints().
+
+    If ``L`` has a pivot ``<= kMinimumStdDev``, this prints an error (as ComputeGradCholeskyVarianceOfPoints() does) and
+    leaves ``grad`` unchanged.
+
+    \param
+      :points_to_sample_state[1]: ptr to a FULLY CONFIGURED PointsToSampleState (configure via PointsToSampleState::SetupState)
+      :chol_var[num_to_sample][num_to_sample]: cholesky factor ``L`` of the variance of ``points_to_sample``
+      :chol_adjoint[num_to_sample][num_to_sample]: ``\bar{L}``, in the lower triangle (on entry)
+      :grad[state->num_derivatives][dim]: gradient to accumulate into (on entry)
+    \output
+      :chol_adjoint[num_to_sample][num_to_sample]: overwritten with the variance's adjoint (on exit)
+      :grad[state->num_derivatives][dim]: ``grad`` plus the gradient of ``f`` through ``L`` (on exit)
+  \endrst*/
+  void ComputeAdjointGradCholeskyVarianceOfPoints(StateType * points_to_sample_state, double const * restrict chol_var,
+                                                  double * restrict chol_adjoint,
+                                                  double * restrict grad) const OL_NONNULL_POINTERS;
+
+  void ComputeAdjointGradCovarianceOfPoints(StateType * points_to_sample_state, double const * restrict discrete_pts,
+                                            int num_pts, double const * restrict cov_adjoint,
+                                            double * restrict grad) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Seed the random number generator with the specified seed.
     See gpp_random, struct NormalRNG for details.
@@ -708,13 +1223,54 @@ class GaussianProcess final {
   void BuildMixCovarianceMatrix(double const * restrict points_to_sample, int num_to_sample, int const * restrict derivatives_to_sample,
                                 int num_derivatives_to_sample, double * restrict cov_mat) const noexcept OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Fills the first ``num_points`` points' columns of ``points_to_sample_state->K_star`` via BuildMixCovarianceMatrix(),
+    or all of them from the state's ``cross_differences`` when they hold this GP's ``points_sampled`` against the state's
+    ``points_to_sample``.
+  \endrst*/
+  void BuildMixCovarianceMatrixOfState(StateType * points_to_sample_state, int num_points) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Number of trailing ``points_to_sample`` of ``points_to_sample_state`` (e.g., the fixed ``points_being_sampled`` of
+    q,p-EI/KG) that are unchanged since the state was last filled by this GP (same version_); their ``Ks`` (and
+    ``K^-1 * Ks``) columns are still valid and are not recomputed.
+  \endrst*/
+  int NumReusablePointsOfState(const StateType& points_to_sample_state) const noexcept OL_WARN_UNUSED_RESULT;
+
+  //! Records ``points_to_sample_state``'s current points as filled by this GP (see NumReusablePointsOfState()).
+  void MarkPointsToSampleStateFilled(StateType * points_to_sample_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    The part of FillPointsToSampleState() that depends only on ``points_to_sample_state``'s own ``Ks``: ``grad_K_star`` and,
+    if requested, ``grad_K_inv_times_K_star``.
+  \endrst*/
+  void FillGradientsOfPointsToSampleState(StateType * points_to_sample_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    True if neither this GP's observations nor ``points_to_sample_state`` carry derivatives.  Every (point, derivative)
+    block is then a single entry, so the ``kValuesOnly = true`` instantiations below are used: their block sizes are
+    the compile-time constant 1, so the block loops and index arithmetic fold away and the remaining loops are
+    unit-stride.
+  \endrst*/
+  bool IsValuesOnly(const StateType& points_to_sample_state) const noexcept OL_WARN_UNUSED_RESULT;
+
+  //! Body of FillGradientsOfPointsToSampleState(); ``kValuesOnly`` as in IsValuesOnly().
+  template <bool kValuesOnly>
+  void FillGradientsOfPointsToSampleStateImpl(StateType * points_to_sample_state) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Similar to ComputeGradCholeskyVarianceOfPointsPerPoint() except this does not include the gradient terms from
-    the cholesky factorization.  Description will not be duplicated here.
+    the cholesky factorization.  Description will not be duplicated here.  ``kValuesOnly`` as in IsValuesOnly().
   \endrst*/
+  template <bool kValuesOnly>
   void ComputeGradVarianceOfPointsPerPoint(StateType * points_to_sample_state, int diff_index,
                                            double * restrict grad_var) const noexcept OL_NONNULL_POINTERS;
 
+  //! Body of ComputeAdjointGradVarianceOfPoints(); ``kValuesOnly`` as in IsValuesOnly().
+  template <bool kValuesOnly>
+  void ComputeAdjointGradVarianceOfPointsImpl(StateType * points_to_sample_state, double const * restrict var_adjoint,
+                                              double * restrict grad) const OL_NONNULL_POINTERS;
+
   /*!\rst
     \param
       :points_to_sample_state[1]: ptr to a FULLY CONFIGURED PointsToSampleState (configure via PointsToSampleState::SetupState)
@@ -817,9 +1373,84 @@ class GaussianProcess final {
   /*!\rst
     Recomputes (including resizing as needed) the derived quantities in this class.
     This function should be called any time state variables are changed.
+    Dispatches to RecomputeSparseDerivedVariables() if is_sparse() and to RecomputeGridDerivedVariables() if is_grid().
   \endrst*/
   void RecomputeDerivedVariables();
 
+  /*!\rst
+    Refits the FITC approximation (see the inducing-point constructor) from ``training_points_, training_values_``:
+    recomputes ``mean_``, ``K_chol_``, ``K_inv_y_``, and the inducing points' pseudo-observations,
+    ``points_sampled_value_``.  ``points_sampled_`` (the inducing points) must already be set.
+  \endrst*/
+  void RecomputeSparseDerivedVariables();
+
+  /*!\rst
+    Recomputes the grid form of ``K`` (see the grid constructor): ``grid_eigenvectors_`` and
+    ``grid_inverse_sqrt_eigenvalues_``, then ``mean_`` and ``K_inv_y_``.
+  \endrst*/
+  void RecomputeGridDerivedVariables();
+
+  /*!\rst
+    Drops the grid form of ``K`` (e.g., once the data are no longer a full grid); the caller must then recompute the
+    derived variables.
+  \endrst*/
+  void ClearGridStructure() noexcept;
+
+  /*!\rst
+    Recomputes ``mean_`` and ``K^-1 * y`` from ``points_sampled_value_`` against the current ``K_chol_`` (or grid form).
+  \endrst*/
+  void RecomputeMeanAndKInvY();
+
+  //! Refills scaled_points_sampled_ from points_sampled_ and the covariance's current hyperparameters.
+  void RecomputeScaledPointsSampled();
+
+  //! Converts a freshly computed square ``K_chol_`` to packed storage if packed_cholesky_ (and not is_grid()).
+  void PackCholeskyFactor();
+
+  //! Converts ``K_chol_`` back to square storage if packed_cholesky_, for code that updates it in place.
+  void UnpackCholeskyFactor();
+
+  //! Rebuilds observed_rows_ from derivative_mask_.
+  void RecomputeObservedRows();
+
+  /*!\rst
+    Factors the observed rows of ``K_chol_`` (which holds ``K`` on entry) and expands the factor back to full size
+    (see SetDerivativeMask()), jittering as configured by SetCholeskyJitter().
+
+    \return
+      0 if successful; otherwise ``i``, the (1-based) row of ``K`` whose leading minor is not positive definite
+  \endrst*/
+  int ComputeObservedCholeskyFactor();
+
+  /*!\rst
+    Computes ``W * matrix`` in place for a ``W`` with ``W^T * W = K^-1``: ``L^-1`` (one triangular solve), or
+    ``(\Lambda + \sigma_n^2 I)^{-1/2} * Q^T`` if is_grid().  So ``(W * A)^T * (W * B) = A^T * K^-1 * B``.
+
+    \param
+      :num_columns: number of columns of ``matrix``
+      :matrix[num_sampled*(num_derivatives+1)][num_columns]: matrix to multiply
+    \output
+      :matrix[num_sampled*(num_derivatives+1)][num_columns]: ``W * matrix``
+  \endrst*/
+  void WhitenColumns(int num_columns, double * restrict matrix) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes ``K^-1 * matrix`` in place: two triangular solves with ``K_chol_``, or ``Q * (\Lambda + \sigma_n^2 I)^{-1} * Q^T``
+    if is_grid().
+
+    \param
+      :num_columns: number of columns of ``matrix``
+      :matrix[num_sampled*(num_derivatives+1)][num_columns]: right hand sides
+    \output
+      :matrix[num_sampled*(num_derivatives+1)][num_columns]: ``K^-1 * matrix``
+  \endrst*/
+  void SolveCovariance(int num_columns, double * restrict matrix) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Evicts points (per ``window_policy_``) until at most ``max_num_sampled_`` remain; no-op if not windowed.
+  \endrst*/
+  void EnforceSlidingWindow();
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   int dim_;
@@ -828,28 +1459,162 @@ class GaussianProcess final {
   //! the mean of the ``points_sampled_value_``
   double mean_;
 
-  // state variables for prior
+  // state variables for prior; immutable and possibly shared with other GPs (replaced, never modified, by AddPointsToGP())
   //! coordinates of already-sampled points, ``X``
-  std::vector<double> points_sampled_;
+  std::shared_ptr<const std::vector<double>> points_sampled_;
   //! function values at points_sampled, ``y``
-  std::vector<double> points_sampled_value_;
+  std::shared_ptr<const std::vector<double>> points_sampled_value_;
 
   //! derivatives index
-  std::vector<int> derivatives_;
+  std::shared_ptr<const std::vector<int>> derivatives_;
   //! number of derivatives observations
   int num_derivatives_;
+  //! ``num_derivatives_ == 0``; selects the value-only specializations of the prediction paths (see IsValuesOnly())
+  bool values_only_;
 
   //! ``\sigma_n^2``, the noise variance
   std::vector<double> noise_variance_;
+  //! hyperparameter-independent squared differences of points_sampled_ (possibly shared); nullptr if not supplied
+  std::shared_ptr<const PairwiseDifferences> training_differences_;
+
+  // FITC (sparse) mode only; nullptr/0 otherwise.  points_sampled_ then holds the inducing points and
+  // points_sampled_value_ their pseudo-observations.
+  //! coordinates of the training points summarized by the inducing points
+  std::shared_ptr<const std::vector<double>> training_points_;
+  //! function values (and derivatives) at training_points_
+  std::shared_ptr<const std::vector<double>> training_values_;
+  //! number of points in training_points_
+  int num_training_;
+
+  // sliding window (see SetSlidingWindow())
+  //! maximum number of (training) points AddPointsToGP() keeps; 0 if unbounded
+  int max_num_sampled_;
+  //! which points EnforceSlidingWindow() evicts
+  GaussianProcessWindowPolicy window_policy_;
+  //! jitter escalation settings of the dense factorization of ``K`` (see SetCholeskyJitter()) and its last report
+  CholeskyJitter cholesky_jitter_;
+  //! true if ``K_chol_`` is held as a packed lower triangle (see SetPackedCholeskyStorage())
+  bool packed_cholesky_;
+  //! 1 for each observed derivative of each point, ``[num_derivatives][num_sampled]`` (see SetDerivativeMask()); empty
+  //! if every derivative is observed
+  std::vector<int> derivative_mask_;
+  //! the observed rows of ``K``, increasing; empty if derivative_mask_ is
+  std::vector<int> observed_rows_;
+
+  // grid (Kronecker) mode only; empty otherwise.  points_sampled_ then holds the expanded grid.
+  //! number of grid coordinates along each dimension, ``n_d``
+  std::vector<int> grid_sizes_;
+  //! grid coordinates along each dimension, concatenated
+  std::vector<double> grid_coordinates_;
+  //! ``Q_d``, the eigenvectors of each dimension's kernel ``[n_d][n_d]``, concatenated
+  std::vector<double> grid_eigenvectors_;
+  //! ``(\Lambda + \sigma_n^2 I)^{-1/2}``, one entry per grid point
+  std::vector<double> grid_inverse_sqrt_eigenvalues_;
 
   // derived variables for prior
+  //! length-scaled, structure-of-arrays copy of points_sampled_ for the covariance's current hyperparameters (empty if
+  //! the covariance does not use one); BuildMixCovarianceMatrix() reads it instead of rescaling ``X`` every call
+  ScaledPointsTranspose scaled_points_sampled_;
   //! cholesky factorization of ``K`` (i.e., ``K(X,X)`` covariance matrix (prior), includes noise variance)
-  std::vector<double> K_chol_;
+  AlignedVector<double> K_chol_;
   //! ``K^-1 * y``; computed WITHOUT forming ``K^-1``
-  std::vector<double> K_inv_y_;
+  AlignedVector<double> K_inv_y_;
+  //! process-wide unique stamp of the current derived variables (copies share it); renewed whenever ``K`` or ``X``
+  //! changes, so PointsToSampleState can tell whether the ``Ks`` columns it filled earlier are still valid
+  std::uint64_t version_;
 
   //! Normal PRNG for use with sampling points from GP
   NormalGeneratorType normal_rng_;
+  //! scratch for SamplePointFromGP() and SamplePointsFromGP() (variance or low-rank factor, mean, normal draws); grown
+  //! on demand, not copied
+  std::vector<double> sample_scratch_;
+};
+
+/*!\rst
+  A per-caller context for drawing samples from a shared (const) GaussianProcess: it owns the PRNG and scratch that
+  GaussianProcess::SamplePointFromGP() and friends keep inside the GP, so several threads (or server requests) can
+  sample from one fitted GP at once, each with its own sampler.  Draws match those of a GaussianProcess (or sampler)
+  seeded the same way.
+
+  The GP must outlive the sampler and must not be modified while the sampler is in use.  A single sampler is not
+  thread-safe.
+\endrst*/
+class GaussianProcessSampler final {
+ public:
+  using NormalGeneratorType = NormalRNG;
+  using EngineType = NormalGeneratorType::EngineType;
+
+  /*!\rst
+    \param
+      :gaussian_process: the GP to sample from
+      :seed: seed of this sampler's PRNG
+  \endrst*/
+  explicit GaussianProcessSampler(const GaussianProcess& gaussian_process_in,
+                                  EngineType::result_type seed = GaussianProcess::kDefaultSeed);
+
+  /*!\rst
+    Seeds the PRNG from ``base_seed``, the time, and ``thread_id``; see NormalRNG::SetRandomizedSeed.
+
+    \param
+      :gaussian_process: the GP to sample from
+      :base_seed: base value for the seed
+      :thread_id: id of the thread (or request) using this sampler
+  \endrst*/
+  GaussianProcessSampler(const GaussianProcess& gaussian_process_in, EngineType::result_type base_seed, int thread_id);
+
+  const GaussianProcess& gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return *gaussian_process_;
+  }
+
+  //! see GaussianProcess::SamplePointFromGP(); ``results[num_derivatives+1]``
+  void SamplePointFromGP(double const * restrict point_to_sample, double * results) noexcept OL_NONNULL_POINTERS;
+
+  //! see GaussianProcess::SamplePointsFromGP(); returns the index of the smallest of ``results[num_sample]``
+  int SamplePointsFromGP(double const * restrict points_to_sample, int num_sample,
+                         double * results) noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    See GaussianProcess::SampleGlobalOptimaFromGP(); the uniform points come from ``uniform_generator``.
+
+    \output
+      :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+      :points_optima[dim][num_optima]: the sampled optima
+  \endrst*/
+  void SampleGlobalOptimaFromGP(int num_optima, int inner_number, const TensorProductDomain& domain,
+                                UniformRandomGenerator * uniform_generator,
+                                double * points_optima) noexcept OL_NONNULL_POINTERS;
+
+  //! see the low-rank GaussianProcess::SamplePointsFromGP(); returns the index of the smallest of ``results[num_sample]``
+  int SamplePointsFromGP(double const * restrict points_to_sample, int num_sample, int max_rank, double tolerance,
+                         double * results) noexcept OL_NONNULL_POINTERS;
+
+  //! see the low-rank GaussianProcess::SampleGlobalOptimaFromGP(); the uniform points come from ``uniform_generator``
+  void SampleGlobalOptimaFromGP(int num_optima, int inner_number, const TensorProductDomain& domain, int max_rank,
+                                double tolerance, UniformRandomGenerator * uniform_generator,
+                                double * points_optima) noexcept OL_NONNULL_POINTERS;
+
+  //! see NormalRNG::SetExplicitSeed()
+  void SetExplicitSeed(EngineType::result_type seed) noexcept {
+    normal_rng_.SetExplicitSeed(seed);
+  }
+
+  //! see NormalRNG::SetRandomizedSeed()
+  void SetRandomizedSeed(EngineType::result_type base_seed, int thread_id) noexcept {
+    normal_rng_.SetRandomizedSeed(base_seed, thread_id);
+  }
+
+  //! see NormalRNG::ResetToMostRecentSeed()
+  void ResetToMostRecentSeed() noexcept {
+    normal_rng_.ResetToMostRecentSeed();
+  }
+
+ private:
+  //! the (shared, read-only) GP sampled from
+  const GaussianProcess * gaussian_process_;
+  //! this sampler's normal PRNG
+  NormalGeneratorType normal_rng_;
+  //! scratch for the sampling methods (variance or low-rank factor, mean, normal draws); grown on demand
+  std::vector<double> scratch_;
 };
 
 /*!\rst
@@ -924,6 +1689,18 @@ struct PointsToSampleState final {
                   int num_to_sample_in, int num_gradients_in, int num_derivatives_in,
                   bool precomputed_in = true, bool precomputed_grad_K_inv_times_K_star_in = false) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    SetupState() WITHOUT computing the derived quantities: sizes, flags, and ``points_to_sample`` are updated, and the
+    object is INVALID until GaussianProcess::FillPointsToSampleStateBatch() (or FillPointsToSampleState()) fills it.
+    Lets batched evaluators prepare several states and fill them together.
+
+    \param
+      see SetupState()
+  \endrst*/
+  void PrepareState(const GaussianProcess& gaussian_process_in, double const * restrict points_to_sample_in,
+                    int num_to_sample_in, int num_gradients_in, int num_derivatives_in,
+                    bool precomputed_in = true, bool precomputed_grad_K_inv_times_K_star_in = false) OL_NONNULL_POINTERS;
+
   //! pointer to gaussian process used in EI computations
   const GaussianProcess * gaussian_process;
 
@@ -956,7 +1733,7 @@ struct PointsToSampleState final {
 
   // derived variables for predictive component; these are all *temporary* quantities
   //! the "mixed" covariance matrix: ``Ks, Ks_{ij}, K(X,Xs) = covariance(X_i, Xs_j)``, covariance matrix between training and test inputs (``num_sampled x num_to_sample``)
-  std::vector<double> K_star;
+  AlignedVector<double> K_star;
   //! the gradient of mixed covariance matrix, ``Ks``, wrt ``Xs``, dimension: dim*num_sampled*num_derivatives
   std::vector<double> grad_K_star;
   //! the gradient of K_inv_times_K_star wrt ``Xs``, dimension: dim*num_sampled*derivatives
@@ -965,8 +1742,20 @@ struct PointsToSampleState final {
   std::vector<double> V;
   //! ``K^{-1} Ks`` (computed without taking an inverse)
   std::vector<double> K_inv_times_K_star;
-  //! the gradient of covariance(x_1, x_2) wrt x_1
-  // std::vector<double> grad_cov;
+  //! the gradient of covariance(x_1, x_2) wrt x_1, for one (points_to_sample, points_sampled) pair
+  std::vector<double> grad_cov;
+  //! scratch for ``Kt = K(X, Xt)``, the covariance between ``points_sampled`` and the discrete points passed to
+  //! ComputeCovarianceOfPoints() and friends; grown on demand and reused so repeated calls do no heap work
+  std::vector<double> K_discrete;
+  //! optional (not owned) squared differences between ``points_sampled`` and ``points_to_sample``, shared by the
+  //! states of every GP over the same data (e.g., the GaussianProcessMCMC members); K_star is built from them when they
+  //! match this state's points.  nullptr (the default) means no cache.
+  CrossPairwiseDifferences const * cross_differences;
+  //! ``points_to_sample`` as of the last fill, and the GaussianProcess version it was filled against (0: none); trailing
+  //! points that still match keep their K_star (and K_inv_times_K_star) columns on the next fill
+  std::vector<double> filled_points_to_sample;
+  //! version of the GaussianProcess that filled K_star; see filled_points_to_sample
+  std::uint64_t filled_version;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PointsToSampleState);
 };
@@ -974,6 +1763,69 @@ struct PointsToSampleState final {
 struct ExpectedImprovementState;
 struct OnePotentialSampleExpectedImprovementState;
 
+/*!\rst
+  Enum for the floating point type of the Monte-Carlo stage of ExpectedImprovementEvaluator: the normal draws, the
+  cholesky factor applied to them, and the resulting samples of the GP.
+
+  The MC estimate's own error (``O(1/\sqrt{num\_mc\_iterations})``) is far above float round-off, so single precision
+  costs no accuracy in practice while halving the memory traffic (and doubling the SIMD width) of the sampling loops.
+  Everything feeding those loops (the GP mean/variance, ``K_chol``, the solves, and the cholesky factorization of the
+  GP variance) and every accumulation stays in double.
+\endrst*/
+enum class MonteCarloPrecision {
+  //! all Monte-Carlo work in double
+  kDouble = 0,
+  //! normals, cholesky factor, and GP samples in float; accumulation in double
+  kSingle = 1,
+};
+
+/*!\rst
+  Parameters for the adaptive Monte-Carlo mode of ExpectedImprovementEvaluator::ComputeExpectedImprovement().
+
+  Instead of always running ``max_num_mc_iterations``, the MC loop checks its running estimate at the end of every
+  block of ``ExpectedImprovementState::kMonteCarloBlockSize`` iterations and, once at least ``min_num_mc_iterations`` have
+  been run, stops as soon as
+
+  * the (nonzero) estimate's standard error is at most ``relative_tolerance`` times the estimate, or
+  * the upper confidence bound ``estimate + confidence_multiplier * standard_error`` falls below the state's
+    ``prune_threshold``; e.g., the best EI seen so far while screening a list of candidates (see EvaluateEIAtPointList()).
+
+  The achieved standard error and iteration count are reported on the state. With ``min_num_mc_iterations ==
+  max_num_mc_iterations``, this reduces to the fixed-size estimate.
+
+  The standard error assumes independent draws; with quasi-Monte Carlo (SobolNormalRNG) it overestimates the error, so
+  the stopping rule is conservative.
+\endrst*/
+struct AdaptiveMonteCarloParameters final {
+  AdaptiveMonteCarloParameters() = delete;
+
+  /*!\rst
+    Construct an AdaptiveMonteCarloParameters object.
+
+    \param
+      :min_num_mc_iterations_in: fewest mc iterations before either stopping test is applied
+      :max_num_mc_iterations_in: most mc iterations (the fixed-size ``num_mc_iterations``)
+      :relative_tolerance_in: target standard error, relative to the estimate
+      :confidence_multiplier_in: number of standard errors in the upper confidence bound used for pruning
+  \endrst*/
+  AdaptiveMonteCarloParameters(int min_num_mc_iterations_in, int max_num_mc_iterations_in,
+                               double relative_tolerance_in, double confidence_multiplier_in)
+      : min_num_mc_iterations(min_num_mc_iterations_in),
+        max_num_mc_iterations(max_num_mc_iterations_in),
+        relative_tolerance(relative_tolerance_in),
+        confidence_multiplier(confidence_multiplier_in) {
+  }
+
+  //! fewest mc iterations before either stopping test is applied (suggest: 1024)
+  int min_num_mc_iterations;
+  //! most mc iterations (suggest: 10000 or more; same as the fixed-size ``num_mc_iterations``)
+  int max_num_mc_iterations;
+  //! stop once ``standard_error <= relative_tolerance * estimate`` (suggest: 0.01-0.05)
+  double relative_tolerance;
+  //! prune once ``estimate + confidence_multiplier * standard_error < prune_threshold`` (suggest: 3.0)
+  double confidence_multiplier;
+};
+
 /*!\rst
   A class to encapsulate the computation of expected improvement and its spatial gradient. This class handles the
   general EI computation case using monte carlo integration; it can support q,p-EI optimization. It is designed to work
@@ -996,6 +1848,34 @@ class ExpectedImprovementEvaluator final {
       :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
   \endrst*/
   ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in, int num_mc_iterations, double best_so_far);
+
+  /*!\rst
+    Constructs a ExpectedImprovementEvaluator object whose Monte-Carlo stage runs in the specified precision.
+
+    \param
+      :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+        that describes the underlying GP
+      :num_mc_iterations: number of monte carlo iterations
+      :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :monte_carlo_precision: floating point type of the MC sampling loops; see MonteCarloPrecision
+  \endrst*/
+  ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in, int num_mc_iterations, double best_so_far,
+                               MonteCarloPrecision monte_carlo_precision);
+
+  /*!\rst
+    Constructs a ExpectedImprovementEvaluator object whose EI estimate uses an adaptive number of mc iterations.
+    The gradient of EI always uses ``adaptive_parameters.max_num_mc_iterations``.
+
+    \param
+      :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+        that describes the underlying GP
+      :adaptive_parameters: stopping rule for the MC estimate of EI; see AdaptiveMonteCarloParameters
+      :best_so_far: best (minimum) objective function value (in ``points_sampled_value``)
+      :monte_carlo_precision: floating point type of the MC sampling loops; see MonteCarloPrecision
+  \endrst*/
+  ExpectedImprovementEvaluator(const GaussianProcess& gaussian_process_in,
+                               const AdaptiveMonteCarloParameters& adaptive_parameters, double best_so_far,
+                               MonteCarloPrecision monte_carlo_precision);
   ExpectedImprovementEvaluator(ExpectedImprovementEvaluator&& other);
 
   int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
@@ -1010,6 +1890,14 @@ class ExpectedImprovementEvaluator final {
     return best_so_far_;
   }
 
+  const AdaptiveMonteCarloParameters& adaptive_parameters() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return adaptive_parameters_;
+  }
+
+  MonteCarloPrecision monte_carlo_precision() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return monte_carlo_precision_;
+  }
+
   const GaussianProcess * gaussian_process() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return gaussian_process_;
   }
@@ -1028,6 +1916,39 @@ class ExpectedImprovementEvaluator final {
     ComputeGradExpectedImprovement(ei_state, grad_EI);
   }
 
+  /*!\rst
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp): the MC loop of grad
+    EI also sums the improvements, so EI comes at no extra cost.  In adaptive mode, EI is computed separately (as
+    ComputeExpectedImprovement() would), since the gradient always uses the full ``num_mc_iterations``.
+
+    \param
+      :ei_state[1]: properly configured state object
+    \output
+      :ei_state[1]: state with temporary storage modified; ``normal_rng`` modified
+      :grad_EI[dim][num_to_sample]: gradient of EI (see ComputeGradExpectedImprovement())
+    \return
+      the expected improvement, exactly as ComputeExpectedImprovement() returns it
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Batched ComputeGradObjectiveFunction() for lockstep multistart gradient descent (see
+    GradientDescentOptimizer<...>::OptimizeBatch()): moves ``ei_states[k]`` to the ``k``-th block of ``points_to_sample``
+    (as SetCurrentPoint() would) and computes grad EI there, for every ``k``.  The GP quantities of the whole batch are
+    filled together (SetCurrentPointBatch()), so its ``K^-1 * Ks`` solves are one blocked triangular solve.
+
+    \param
+      :ei_states[num_states]: pointers to distinct, properly configured state objects
+      :num_states: number of states in the batch
+      :points_to_sample[num_states][problem_size]: new point of each state
+    \output
+      :ei_states[num_states]: states moved to their new points; temporary storage modified
+      :grad_EI[num_states][problem_size]: gradient of EI at each state's new point
+  \endrst*/
+  void ComputeGradObjectiveFunctionBatch(StateType * const * ei_states, int num_states,
+                                         double const * restrict points_to_sample,
+                                         double * restrict grad_EI) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the expected improvement ``EI(Xs) = E_n[[f^*_n(X) - min(f(Xs_1),...,f(Xs_m))]^+]``, where ``Xs``
     are potential points to sample (union of ``points_to_sample`` and ``points_being_sampled``) and ``X`` are
@@ -1060,10 +1981,15 @@ class ExpectedImprovementEvaluator final {
 
     .. Note:: These comments were copied into ExpectedImprovementInterface.compute_expected_improvement() in interfaces/expected_improvement_interface.py.
 
+    The number of draws is ``num_mc_iterations`` unless this evaluator was built with AdaptiveMonteCarloParameters, in
+    which case the loop may stop early (see that struct). Either way, the standard error of the estimate and the number
+    of draws used are written to the state.
+
     \param
       :ei_state[1]: properly configured state object
     \output
-      :ei_state[1]: state with temporary storage modified; ``normal_rng`` modified
+      :ei_state[1]: state with temporary storage modified; ``normal_rng`` modified; ``standard_error``,
+        ``num_mc_iterations_used``, and ``pruned`` set
     \return
       the expected improvement from sampling ``points_to_sample`` with ``points_being_sampled`` concurrent experiments
   \endrst*/
@@ -1098,18 +2024,25 @@ class ExpectedImprovementEvaluator final {
       :grad_EI[dim][num_to_sample]: gradient of EI, ``\pderiv{EI(Xq \cup Xp)}{Xq_{d,i}}`` where ``Xq`` is ``points_to_sample``
           and ``Xp`` is ``points_being_sampled`` (grad EI from sampling ``points_to_sample`` with
           ``points_being_sampled`` concurrent experiments wrt each dimension of the points in ``points_to_sample``)
+    \return
+      the MC estimate of EI over all ``num_mc_iterations`` (a by-product; equals ComputeExpectedImprovement() unless
+      the evaluator is adaptive)
   \endrst*/
-  void ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
+  double ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const OL_NONNULL_POINTERS;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ExpectedImprovementEvaluator);
 
  private:
   //! spatial dimension (e.g., entries per point of points_sampled)
   const int dim_;
-  //! number of monte carlo iterations
+  //! number of monte carlo iterations (the maximum, for the adaptive EI estimate)
   int num_mc_iterations_;
   //! best (minimum) objective function value (in points_sampled_value)
   double best_so_far_;
+  //! stopping rule of the EI estimate; ``min == max == num_mc_iterations_`` unless constructed as adaptive
+  AdaptiveMonteCarloParameters adaptive_parameters_;
+  //! floating point type of the MC sampling loops
+  MonteCarloPrecision monte_carlo_precision_;
   //! pointer to gaussian process used in EI computations
   const GaussianProcess * gaussian_process_;
 };
@@ -1157,6 +2090,7 @@ struct ExpectedImprovementState final {
     .. NOTE::
          \* The NormalRNG object must already be seeded.  If multithreaded computation is used for EI, then every state object
          must have a different NormalRNG (different seeds, not just different objects).
+         Passing a SobolNormalRNG of dimension ``num_to_sample + num_being_sampled`` instead switches the MC integration to quasi-Monte Carlo.
   \endrst*/
   ExpectedImprovementState(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample,
                            double const * restrict points_being_sampled, int num_to_sample_in,
@@ -1215,6 +2149,17 @@ struct ExpectedImprovementState final {
   void SetCurrentPoint(const EvaluatorType& ei_evaluator,
                        double const * restrict points_to_sample) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    SetCurrentPoint() without filling the GP-derived quantities; see PointsToSampleState::PrepareState().  The state is
+    INVALID until GaussianProcess::FillPointsToSampleStateBatch() fills ``points_to_sample_state`` (SetCurrentPointBatch()
+    does both).
+
+    \param
+      see SetCurrentPoint()
+  \endrst*/
+  void PrepareCurrentPoint(const EvaluatorType& ei_evaluator,
+                           double const * restrict points_to_sample) OL_NONNULL_POINTERS;
+
   /*!\rst
     Configures this state object with new ``points_to_sample``, the location of the potential samples whose EI is to be evaluated.
     Ensures all state variables & temporaries are properly sized.
@@ -1230,6 +2175,21 @@ struct ExpectedImprovementState final {
   \endrst*/
   void SetupState(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample);
 
+  /*!\rst
+    Reuses this state as if it were newly constructed with these (constructor) arguments, keeping its buffers: the
+    points, RNG, and adaptive MC diagnostics are reset and the derived quantities recomputed.  Only possible if the
+    state's fixed sizes match; see ReuseOrConstructStates() (gpp_optimization.hpp).
+
+    \param
+      see the constructor
+    \return
+      true if the state was reconfigured; false (state unchanged) if ``dim``, ``num_to_sample``, ``num_being_sampled``,
+      ``configure_for_gradients``, or the GP's number of gradient observations differ
+  \endrst*/
+  bool Reconfigure(const EvaluatorType& ei_evaluator, double const * restrict points_to_sample,
+                   double const * restrict points_being_sampled, int num_to_sample_in, int num_being_sampled_in,
+                   bool configure_for_gradients, NormalRNGInterface * normal_rng_in) OL_WARN_UNUSED_RESULT;
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   const int dim;
@@ -1252,6 +2212,20 @@ struct ExpectedImprovementState final {
   //! random number generator
   NormalRNGInterface * normal_rng;
 
+  //! an adaptive EI estimate stops (with ``pruned`` := true) once its upper confidence bound falls below this;
+  //! ``-infinity`` (the default) disables pruning
+  double prune_threshold;
+
+  // diagnostics of the most recent ComputeExpectedImprovement()
+  //! standard error of the MC estimate of EI
+  double standard_error;
+  //! number of mc iterations the estimate used
+  int num_mc_iterations_used;
+  //! true if the estimate stopped because it could not beat ``prune_threshold``
+  bool pruned;
+  //! jitter the GP variance's factorization needed beyond its fixed ``1.0e-6`` nugget; 0 if none
+  double cholesky_jitter;
+
   // temporary storage: preallocated space used by ExpectedImprovementEvaluator's member functions
   //! the mean of the GP evaluated at union_of_points
   std::vector<double> to_sample_mean;
@@ -1259,16 +2233,31 @@ struct ExpectedImprovementState final {
   std::vector<double> grad_mu;
   //! the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points
   std::vector<double> cholesky_to_sample_var;
-  //! the gradient of the cholesky (``LL^T``) factorization of the GP variance evaluated at union_of_points wrt union_of_points[0:num_to_sample]
-  std::vector<double> grad_chol_decomp;
+  //! the gradient of the mc estimate wrt cholesky_to_sample_var (lower triangle), backpropagated in reverse mode
+  std::vector<double> chol_adjoint;
 
-  //! improvement (per mc iteration) evaluated at each of union_of_points
+  //! improvement evaluated at each of union_of_points, for a block of ``kMonteCarloBlockSize`` mc iterations
+  //! (``[num_union][kMonteCarloBlockSize]``; column ``i`` is the ``i``-th iteration of the block)
+  //! empty unless the evaluator's MonteCarloPrecision is kDouble
   std::vector<double> EI_this_step_from_var;
   //! tracks the aggregate grad EI from all mc iterations
   std::vector<double> aggregate;
-  //! normal rng draws
+  //! normal rng draws for a block of mc iterations, same layout as EI_this_step_from_var;
+  //! empty unless the evaluator's MonteCarloPrecision is kDouble
   std::vector<double> normals;
 
+  // single precision copies of the above, used instead when the evaluator's MonteCarloPrecision is kSingle (else empty)
+  //! float copy of cholesky_to_sample_var
+  std::vector<float> cholesky_to_sample_var_single;
+  //! float EI_this_step_from_var
+  std::vector<float> EI_this_step_from_var_single;
+  //! float normals
+  std::vector<float> normals_single;
+
+  //! number of mc iterations whose normals are drawn and multiplied by the cholesky factor at once
+  //! (one TriangularMatrixMatrixMultiply() per block instead of one TriangularMatrixVectorMultiply() per iteration)
+  static constexpr int kMonteCarloBlockSize = 256;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ExpectedImprovementState);
 };
 
@@ -1344,6 +2333,24 @@ class OnePotentialSampleExpectedImprovementEvaluator final {
     ComputeGradExpectedImprovement(ei_state, grad_EI);
   }
 
+  /*!\rst
+    Batched ComputeGradObjectiveFunction() for lockstep multistart gradient descent (see
+    GradientDescentOptimizer<...>::OptimizeBatch()): moves ``ei_states[k]`` to the ``k``-th block of ``points_to_sample``
+    (as SetCurrentPoint() would) and computes grad EI there, for every ``k``.  The GP quantities of the whole batch are
+    filled together (SetCurrentPointBatch()), so its ``K^-1 * Ks`` solves are one blocked triangular solve.
+
+    \param
+      :ei_states[num_states]: pointers to distinct, properly configured state objects
+      :num_states: number of states in the batch
+      :points_to_sample[num_states][problem_size]: new point of each state
+    \output
+      :ei_states[num_states]: states moved to their new points; temporary storage modified
+      :grad_EI[num_states][problem_size]: gradient of EI at each state's new point
+  \endrst*/
+  void ComputeGradObjectiveFunctionBatch(StateType * const * ei_states, int num_states,
+                                         double const * restrict points_to_sample,
+                                         double * restrict grad_EI) const OL_NONNULL_POINTERS;
+
   /*!\rst
     Computes the expected improvement ``EI(Xs) = E_n[[f^*_n(X) - min(f(Xs_1),...,f(Xs_m))]^+]``
 
@@ -1371,6 +2378,42 @@ class OnePotentialSampleExpectedImprovementEvaluator final {
   \endrst*/
   void ComputeGradExpectedImprovement(StateType * ei_state, double * restrict grad_EI) const;
 
+  /*!\rst
+    Computes 1,0-EI at each of ``points``, for screening large candidate lists (see EvaluateEIAtPointList()).
+
+    Matches ComputeExpectedImprovement() at each point (up to round-off) but needs no state: the means and variances come
+    from one GaussianProcess::PredictMarginals() call, and the normal cdf/pdf are evaluated in short loops over
+    contiguous blocks of those arrays (kExpectedImprovementBlockSize points at a time).  So the per-point cost is
+    the GP's ``K(X, x)`` work and a little arithmetic, not a PointsToSampleState and a pair of gemv calls.
+
+    \param
+      :points[dim][num_points]: points at which to compute EI; may contain duplicates
+      :num_points: number of points
+      :max_num_threads: maximum number of threads to use
+    \output
+      :expected_improvement[num_points]: EI at each point of ``points``
+  \endrst*/
+  void ComputeExpectedImprovementOfPoints(double const * restrict points, int num_points, int max_num_threads,
+                                          double * restrict expected_improvement) const OL_NONNULL_POINTERS;
+
+  //! Number of points ComputeExpectedImprovementOfPoints() pushes through each of its cdf/pdf loops at once.
+  static constexpr int kExpectedImprovementBlockSize = 256;
+
+  /*!\rst
+    1,0-EI of a block of marginal predictions, as ComputeExpectedImprovementOfPoints() computes it.
+
+    \param
+      :best_so_far: best (minimum) objective function value
+      :mean[num_points]: mean of the GP at each point; may be the same array as ``expected_improvement``
+      :variance[num_points]: variance of the GP at each point
+      :num_points: number of points, at most kExpectedImprovementBlockSize
+    \output
+      :expected_improvement[num_points]: EI at each point
+  \endrst*/
+  static void ComputeExpectedImprovementOfMarginals(double best_so_far, double const * mean,
+                                                    double const * restrict variance, int num_points,
+                                                    double * expected_improvement) noexcept OL_NONNULL_POINTERS;
+
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OnePotentialSampleExpectedImprovementEvaluator);
 
  private:
@@ -1451,6 +2494,17 @@ struct OnePotentialSampleExpectedImprovementState final {
   void SetCurrentPoint(const EvaluatorType& ei_evaluator,
                        double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    SetCurrentPoint() without filling the GP-derived quantities; see PointsToSampleState::PrepareState().  The state is
+    INVALID until GaussianProcess::FillPointsToSampleStateBatch() fills ``points_to_sample_state`` (SetCurrentPointBatch()
+    does both).
+
+    \param
+      see SetCurrentPoint()
+  \endrst*/
+  void PrepareCurrentPoint(const EvaluatorType& ei_evaluator,
+                           double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
+
   /*!\rst
     Configures this state object with a new ``point_to_sample``, the location of the potential sample whose EI is to be evaluated.
     Ensures all state variables & temporaries are properly sized.
@@ -1467,6 +2521,19 @@ struct OnePotentialSampleExpectedImprovementState final {
   void SetupState(const EvaluatorType& ei_evaluator,
                   double const * restrict point_to_sample_in) OL_NONNULL_POINTERS;
 
+  /*!\rst
+    Reuses this state as if it were newly constructed with these (constructor) arguments, keeping its buffers; see
+    ExpectedImprovementState::Reconfigure().
+
+    \param
+      see the constructor
+    \return
+      true if the state was reconfigured; false (state unchanged) if ``dim``, ``configure_for_gradients``, or the GP's
+      number of gradient observations differ
+  \endrst*/
+  bool Reconfigure(const EvaluatorType& ei_evaluator, double const * restrict point_to_sample_in,
+                   bool configure_for_gradients) OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
   // size information
   //! spatial dimension (e.g., entries per point of ``points_sampled``)
   const int dim;
@@ -1502,7 +2569,8 @@ struct OnePotentialSampleExpectedImprovementState final {
     :starting_point[dim]: initial point to load into state (must be a valid point for the problem)
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
-    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
+    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0); states it already holds are reused
+      where possible (see ReuseOrConstructStates()), so a vector kept across calls acts as a pool
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -1512,10 +2580,12 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementState(
     int max_num_threads,
     bool configure_for_gradients,
     std::vector<typename OnePotentialSampleExpectedImprovementEvaluator::StateType> * state_vector) {
-  state_vector->reserve(max_num_threads);
-  for (int i = 0; i < max_num_threads; ++i) {
-    state_vector->emplace_back(ei_evaluator, starting_point, configure_for_gradients);
-  }
+  using StateType = typename OnePotentialSampleExpectedImprovementEvaluator::StateType;
+  ReuseOrConstructStates(max_num_threads, [&](StateType * state, int OL_UNUSED(i)) {
+      return state->Reconfigure(ei_evaluator, starting_point, configure_for_gradients);
+    }, [&](std::vector<StateType> * states, int OL_UNUSED(i)) {
+      states->emplace_back(ei_evaluator, starting_point, configure_for_gradients);
+    }, state_vector);
 }
 
 /*!\rst
@@ -1532,8 +2602,9 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementState(
     :num_being_sampled: number of points being sampled concurrently (i.e., the p in q,p-EI)
     :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
     :configure_for_gradients: true if these state objects will be used to compute gradients, false otherwise
-    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0)
-    :normal_rng[max_num_threads]: a vector of NormalRNG objects that provide the (pesudo)random source for MC integration
+    :state_vector[arbitrary]: vector of state objects, arbitrary size (usually 0); states it already holds are reused
+      where possible (see ReuseOrConstructStates()), so a vector kept across calls acts as a pool
+    :normal_rng[max_num_threads]: a NormalRNGArray of generators that provide the (pesudo)random source for MC integration
   \output
     :state_vector[max_num_threads]: vector of states containing ``max_num_threads`` properly initialized state objects
 \endrst*/
@@ -1545,13 +2616,42 @@ inline OL_NONNULL_POINTERS void SetupExpectedImprovementState(
     int num_being_sampled,
     int max_num_threads,
     bool configure_for_gradients,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     std::vector<typename ExpectedImprovementEvaluator::StateType> * state_vector) {
-  state_vector->reserve(max_num_threads);
-  for (int i = 0; i < max_num_threads; ++i) {
-    state_vector->emplace_back(ei_evaluator, points_to_sample, points_being_sampled, num_to_sample,
-                               num_being_sampled, configure_for_gradients, normal_rng + i);
+  using StateType = typename ExpectedImprovementEvaluator::StateType;
+  ReuseOrConstructStates(max_num_threads, [&](StateType * state, int i) {
+      return state->Reconfigure(ei_evaluator, points_to_sample, points_being_sampled, num_to_sample,
+                                num_being_sampled, configure_for_gradients, &normal_rng[i]);
+    }, [&](std::vector<StateType> * states, int i) {
+      states->emplace_back(ei_evaluator, points_to_sample, points_being_sampled, num_to_sample,
+                           num_being_sampled, configure_for_gradients, &normal_rng[i]);
+    }, state_vector);
+}
+
+/*!\rst
+  Batched ``State::SetCurrentPoint()``: moves ``states[k]`` to ``points[k]`` for every ``k``, filling the GP quantities of
+  all states together via GaussianProcess::FillPointsToSampleStateBatch().  For evaluators whose states hold a
+  ``points_to_sample_state`` and provide ``PrepareCurrentPoint()``; used by their ComputeGradObjectiveFunctionBatch().
+
+  \param
+    :evaluator: evaluator object associated with the states
+    :states[num_states]: pointers to distinct, properly configured state objects
+    :num_states: number of states
+    :points[num_states][problem_size]: new point of each state
+  \output
+    :states[num_states]: states moved to their new points
+\endrst*/
+template <typename Evaluator>
+OL_NONNULL_POINTERS void SetCurrentPointBatch(const Evaluator& evaluator, typename Evaluator::StateType * const * states,
+                                              int num_states, double const * restrict points) {
+  std::vector<PointsToSampleState *> points_to_sample_states(num_states);
+  double const * point = points;
+  for (int k = 0; k < num_states; ++k) {
+    states[k]->PrepareCurrentPoint(evaluator, point);
+    points_to_sample_states[k] = &states[k]->points_to_sample_state;
+    point += states[k]->GetProblemSize();
   }
+  evaluator.gaussian_process()->FillPointsToSampleStateBatch(points_to_sample_states.data(), num_states);
 }
 
 /*!\rst
@@ -1650,6 +2750,7 @@ void RestartedGradientDescentEIOptimization(const ExpectedImprovementEvaluator&
     :domain: object specifying the domain to optimize over (see ``gpp_domain.hpp``)
     :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
       max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+      Under a process memory budget, max_num_threads may be lowered (see gpp_memory_budget.hpp).
     :start_point_set[dim][num_to_sample][num_multistarts]: set of initial guesses for MGD (one block of num_to_sample points per multistart)
     :points_being_sampled[dim][num_being_sampled]: points that are being sampled in concurrent experiments
     :num_multistarts: number of points in set of initial guesses
@@ -1657,19 +2758,22 @@ void RestartedGradientDescentEIOptimization(const ExpectedImprovementEvaluator&
     :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
+    :top_points[1]: DiverseTopPoints requesting the best distinct results of the multistarts, or nullptr (the default)
   \output
     :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
     :found_flag[1]: true if ``best_next_point`` corresponds to a nonzero EI
     :best_next_point[dim][num_to_sample]: points yielding the best EI according to MGD
+    :top_points[1]: up to ``top_points->num_points`` distinct ``[dim][num_to_sample]`` results and their EI, best first
+      (see DiverseTopPoints); one gradient descent run yields them all
 \endrst*/
 template <typename DomainType>
-OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescent(
+OL_NONNULL_POINTERS_LIST(5, 6, 13, 14) void ComputeOptimalPointsToSampleViaMultistartGradientDescent(
     const GaussianProcess& gaussian_process,
     const GradientDescentParameters& optimizer_parameters,
     const DomainType& domain,
-    const ThreadSchedule& thread_schedule,
+    const ThreadSchedule& thread_schedule_in,
     double const * restrict start_point_set,
     double const * restrict points_being_sampled,
     int num_multistarts,
@@ -1677,12 +2781,16 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
     int num_being_sampled,
     double best_so_far,
     int max_int_steps,
-    NormalRNG * normal_rng,
+    NormalRNGArray normal_rng,
     bool * restrict found_flag,
-    double * restrict best_next_point) {
+    double * restrict best_next_point,
+    DiverseTopPoints * top_points = nullptr) {
   if (unlikely(num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
   }
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateExpectedImprovementMemory(
+      gaussian_process.dim(), gaussian_process.num_sampled(), gaussian_process.num_derivatives(), num_to_sample,
+      num_being_sampled, thread_schedule_in.max_num_threads));
 
   bool configure_for_gradients = true;
   if (num_to_sample == 1 && num_being_sampled == 0) {
@@ -1693,37 +2801,17 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
     SetupExpectedImprovementState(ei_evaluator, start_point_set, thread_schedule.max_num_threads,
                                   configure_for_gradients, &ei_state_vector);
 
-    std::vector<double> EI_starting(num_multistarts);
-    for (int i=0; i<num_multistarts; ++i){
-      ei_state_vector[0].SetCurrentPoint(ei_evaluator, start_point_set + i*num_to_sample*gaussian_process.dim());
-      EI_starting[i] = ei_evaluator.ComputeExpectedImprovement(&ei_state_vector[0]);
-    }
-
-    std::priority_queue<std::pair<double, int>> q;
-    int k = 20; // number of indices we need
-    for (int i = 0; i < EI_starting.size(); ++i) {
-      if (i < k){
-        q.push(std::pair<double, int>(-EI_starting[i], i));
-      }
-      else{
-        if (q.top().first > -EI_starting[i]){
-          q.pop();
-          q.push(std::pair<double, int>(-EI_starting[i], i));
-        }
-      }
-    }
-
+    // screen every start on all threads; descend from the best few
+    int k = std::min(20, num_multistarts); // number of indices we need (at most one per multistart)
     std::vector<double> top_k_starting(k*num_to_sample*gaussian_process.dim());
-    for (int i = 0; i < k; ++i) {
-      int ki = q.top().second;
-      for (int d = 0; d<num_to_sample*gaussian_process.dim(); ++d){
-        top_k_starting[i*num_to_sample*gaussian_process.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process.dim() + d];
-      }
-      q.pop();
-    }
+    SelectBestStartPoints(ei_evaluator, start_point_set, num_multistarts, k, thread_schedule.max_num_threads,
+                          ei_state_vector.data(), top_k_starting.data());
 
     // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
     OptimizationIOContainer io_container(ei_state_vector[0].GetProblemSize(), -1.0, top_k_starting.data());
+    if (top_points != nullptr) {
+      io_container.top_points = *top_points;
+    }
 
     GradientDescentOptimizer<OnePotentialSampleExpectedImprovementEvaluator, DomainType> gd_opt;
     MultistartOptimizer<GradientDescentOptimizer<OnePotentialSampleExpectedImprovementEvaluator, DomainType> > multistart_optimizer;
@@ -1732,6 +2820,9 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
                                             k, ei_state_vector.data(), nullptr, &io_container);
     *found_flag = io_container.found_flag;
     std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    if (top_points != nullptr) {
+      *top_points = std::move(io_container.top_points);
+    }
   } else {
     ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
 
@@ -1740,37 +2831,17 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
                                   num_to_sample, num_being_sampled, thread_schedule.max_num_threads,
                                   configure_for_gradients, normal_rng, &ei_state_vector);
 
-    std::vector<double> EI_starting(num_multistarts);
-    for (int i=0; i<num_multistarts; ++i){
-      ei_state_vector[0].SetCurrentPoint(ei_evaluator, start_point_set + i*num_to_sample*gaussian_process.dim());
-      EI_starting[i] = ei_evaluator.ComputeExpectedImprovement(&ei_state_vector[0]);
-    }
-
-    std::priority_queue<std::pair<double, int>> q;
-    int k = 20; // number of indices we need
-    for (int i = 0; i < EI_starting.size(); ++i) {
-      if (i < k){
-        q.push(std::pair<double, int>(-EI_starting[i], i));
-      }
-      else{
-        if (q.top().first > -EI_starting[i]){
-          q.pop();
-          q.push(std::pair<double, int>(-EI_starting[i], i));
-        }
-      }
-    }
-
+    // screen every start on all threads; descend from the best few
+    int k = std::min(20, num_multistarts); // number of indices we need (at most one per multistart)
     std::vector<double> top_k_starting(k*num_to_sample*gaussian_process.dim());
-    for (int i = 0; i < k; ++i) {
-      int ki = q.top().second;
-      for (int d = 0; d<num_to_sample*gaussian_process.dim(); ++d){
-        top_k_starting[i*num_to_sample*gaussian_process.dim() + d] = start_point_set[ki*num_to_sample*gaussian_process.dim() + d];
-      }
-      q.pop();
-    }
+    SelectBestStartPoints(ei_evaluator, start_point_set, num_multistarts, k, thread_schedule.max_num_threads,
+                          ei_state_vector.data(), top_k_starting.data());
 
     // init winner to be first point in set and 'force' its value to be 0.0; we cannot do worse than this
     OptimizationIOContainer io_container(ei_state_vector[0].GetProblemSize(), -1.0, top_k_starting.data());
+    if (top_points != nullptr) {
+      io_container.top_points = *top_points;
+    }
 
     using RepeatedDomain = RepeatedDomain<DomainType>;
     RepeatedDomain repeated_domain(domain, num_to_sample);
@@ -1783,6 +2854,9 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
 
     *found_flag = io_container.found_flag;
     std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    if (top_points != nullptr) {
+      *top_points = std::move(io_container.top_points);
+    }
   }
 }
 
@@ -1810,7 +2884,7 @@ OL_NONNULL_POINTERS void ComputeOptimalPointsToSampleViaMultistartGradientDescen
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
   \output
     :found_flag[1]: true if best_next_point corresponds to a nonzero EI
@@ -1825,7 +2899,7 @@ void ComputeOptimalPointsToSampleWithRandomStarts(const GaussianProcess& gaussia
                                                   double const * restrict points_being_sampled,
                                                   int num_to_sample, int num_being_sampled, double best_so_far,
                                                   int max_int_steps, bool * restrict found_flag,
-                                                  UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng,
+                                                  UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng,
                                                   double * restrict best_next_point) {
   std::vector<double> starting_points(gaussian_process.dim()*optimizer_parameters.num_multistarts*num_to_sample);
 
@@ -1871,7 +2945,7 @@ void ComputeOptimalPointsToSampleWithRandomStarts(const GaussianProcess& gaussia
     :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
   \output
     :found_flag[1]: true if best_next_point corresponds to a nonzero EI
@@ -1887,8 +2961,93 @@ void EvaluateEIAtPointList(const GaussianProcess& gaussian_process,
                            int num_multistarts, int num_to_sample,
                            int num_being_sampled, double best_so_far,
                            int max_int_steps,
-                           bool * restrict found_flag, NormalRNG * normal_rng,
+                           bool * restrict found_flag, NormalRNGArray normal_rng,
+                           double * restrict function_values,
+                           double * restrict best_next_point);
+
+/*!\rst
+  Evaluates q,p-EI (and optionally its gradient) at each of ``num_sets`` q-sets of points to sample, against the same
+  ``points_being_sampled``.  This is the batched form of looping ExpectedImprovementEvaluator::ComputeObjectiveFunction()
+  (or ComputeObjectiveAndGradient()) over the sets: the evaluator and the per-thread states are built once and the sets
+  are spread over the threads (see EvaluateObjectiveAtPointSets() in gpp_optimization.hpp).
+
+  Set ``i`` is evaluated by state (and NormalRNG) ``i % num_threads``, where ``num_threads`` is the smaller of
+  ``thread_schedule.max_num_threads`` and ``num_sets``; so the results are reproducible for a fixed thread count.
+
+  \param
+    :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+      that describes the underlying GP
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; only ``max_num_threads`` is used
+    :point_sets[dim][num_to_sample][num_sets]: the q-sets at which to compute EI
+    :points_being_sampled[dim][num_being_sampled]: points that are being sampled in concurrent experiments
+    :num_sets: number of q-sets
+    :num_to_sample: number of potential future samples per set; gradients are evaluated wrt these points (i.e., the
+      "q" in q,p-EI)
+    :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
+    :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
+    :max_int_steps: maximum number of MC iterations
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
+      the (pesudo)random source for MC integration
+  \output
+    :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
+    :function_values[num_sets]: EI of each set of ``point_sets``, in the same order
+    :gradients[dim][num_to_sample][num_sets]: gradient of EI of each set wrt its points to sample, in the same order;
+      never dereferenced if nullptr
+\endrst*/
+void ComputeExpectedImprovementAtPointSets(const GaussianProcess& gaussian_process,
+                                           const ThreadSchedule& thread_schedule,
+                                           double const * restrict point_sets,
+                                           double const * restrict points_being_sampled,
+                                           int num_sets, int num_to_sample, int num_being_sampled,
+                                           double best_so_far, int max_int_steps, NormalRNGArray normal_rng,
+                                           double * restrict function_values, double * restrict gradients);
+
+/*!\rst
+  Screening version of EvaluateEIAtPointList(): each candidate's MC estimate of EI uses an adaptive number of draws
+  (see AdaptiveMonteCarloParameters), and a candidate is abandoned as soon as its upper confidence bound falls below
+  the best EI found so far (across all threads). Since most candidates in a random or latin hypercube screen are poor,
+  this spends the MC budget on the competitive ones.
+
+  A pruned candidate reports its partial estimate, which is below the best found; so the winner is unaffected (up to
+  the confidence level of the bound). With more than one thread, the prune threshold each candidate sees depends on
+  the evaluation order, so the values (and draw counts) of pruned candidates may vary from run to run.
+
+  1,0-EI is computed analytically, as in EvaluateEIAtPointList(); its standard errors and draw counts are 0.
+
+  \param
+    :gaussian_process: GaussianProcess object (holds ``points_sampled``, ``values``, ``noise_variance``, derived quantities)
+      that describes the underlying GP
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :initial_guesses[dim][num_to_sample][num_multistarts]: list of points at which to compute EI
+    :points_being_sampled[dim][num_being_sampled]: points that are being sampled in concurrent experiments
+    :num_multistarts: number of points to check
+    :num_to_sample: number of potential future samples; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
+    :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
+    :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
+    :adaptive_parameters: stopping and pruning rule of each candidate's MC estimate
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
+      the (pesudo)random source for MC integration
+  \output
+    :found_flag[1]: true if best_next_point corresponds to a nonzero EI
+    :normal_rng[thread_schedule.max_num_threads]: NormalRNG objects will have their state changed due to random draws
+    :function_values[num_multistarts]: EI evaluated at each point of ``initial_guesses``, in the same order as
+      ``initial_guesses``; never dereferenced if nullptr
+    :standard_errors[num_multistarts]: standard error of each entry of ``function_values``; never dereferenced if nullptr
+    :num_mc_iterations_used[num_multistarts]: number of mc iterations spent on each point; never dereferenced if nullptr
+    :best_next_point[dim][num_to_sample]: points yielding the best EI according to dumb search
+\endrst*/
+void EvaluateEIAtPointList(const GaussianProcess& gaussian_process,
+                           const ThreadSchedule& thread_schedule,
+                           double const * restrict initial_guesses,
+                           double const * restrict points_being_sampled,
+                           int num_multistarts, int num_to_sample,
+                           int num_being_sampled, double best_so_far,
+                           const AdaptiveMonteCarloParameters& adaptive_parameters,
+                           bool * restrict found_flag, NormalRNGArray normal_rng,
                            double * restrict function_values,
+                           double * restrict standard_errors,
+                           int * restrict num_mc_iterations_used,
                            double * restrict best_next_point);
 
 /*!\rst
@@ -1916,8 +3075,11 @@ void EvaluateEIAtPointList(const GaussianProcess& gaussian_process,
     :best_so_far: value of the best sample so far (must be ``min(points_sampled_value)``)
     :max_int_steps: maximum number of MC iterations
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
+    :tile_size: if positive and less than ``num_multistarts``, stream the candidates in tiles of this many q-sets
+      (see StreamingUniformSearch()) instead of materializing all ``num_multistarts`` of them; 0 (default) for the
+      full list
   \output
     found_flag[1]: true if best_next_point corresponds to a nonzero EI
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
@@ -1934,10 +3096,42 @@ void ComputeOptimalPointsToSampleViaLatinHypercubeSearch(const GaussianProcess&
                                                          int max_int_steps,
                                                          bool * restrict found_flag,
                                                          UniformRandomGenerator * uniform_generator,
-                                                         NormalRNG * normal_rng,
-                                                         double * restrict best_next_point) {
-  std::vector<double> initial_guesses(gaussian_process.dim()*num_multistarts*num_to_sample);
+                                                         NormalRNGArray normal_rng,
+                                                         double * restrict best_next_point,
+                                                         int tile_size = 0) {
   RepeatedDomain<DomainType> repeated_domain(domain, num_to_sample);
+  if (tile_size > 0 && tile_size < num_multistarts) {
+    const int problem_size = gaussian_process.dim()*num_to_sample;
+    const int num_tiles = (num_multistarts + tile_size - 1)/tile_size;
+    const int num_threads = std::max(std::min(thread_schedule.max_num_threads, num_tiles), 1);
+    // the states need a valid point to start from; it is also the answer if no candidate is evaluated
+    std::vector<double> initial_point(problem_size);
+    int OL_UNUSED(num_initial_points) = repeated_domain.GenerateUniformPointsInDomain(1, uniform_generator,
+                                                                                      initial_point.data());
+    OptimizationIOContainer io_container(problem_size, -1.0, initial_point.data());
+
+    if (num_to_sample == 1 && num_being_sampled == 0) {
+      // analytic case: each tile goes through the batched 1,0-EI kernel, with no per-point states
+      OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
+      StreamingUniformSearch(repeated_domain, num_multistarts, tile_size, num_threads, uniform_generator,
+                             [&ei_evaluator](int OL_UNUSED(thread_index), double const * points, int num_tile_points,
+                                             double * values) {
+          ei_evaluator.ComputeExpectedImprovementOfPoints(points, num_tile_points, 1, values);
+        }, &io_container);
+    } else {
+      ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
+      std::vector<typename ExpectedImprovementEvaluator::StateType> ei_state_vector;
+      SetupExpectedImprovementState(ei_evaluator, initial_point.data(), points_being_sampled, num_to_sample,
+                                    num_being_sampled, num_threads, false, normal_rng, &ei_state_vector);
+      StreamingUniformSearch(ei_evaluator, repeated_domain, num_multistarts, tile_size, num_threads,
+                             ei_state_vector.data(), uniform_generator, &io_container);
+    }
+    *found_flag = io_container.found_flag;
+    std::copy(io_container.best_point.begin(), io_container.best_point.end(), best_next_point);
+    return;
+  }
+
+  std::vector<double> initial_guesses(gaussian_process.dim()*num_multistarts*num_to_sample);
   num_multistarts = repeated_domain.GenerateUniformPointsInDomain(num_multistarts, uniform_generator,
                                                                   initial_guesses.data());
 
@@ -1983,7 +3177,7 @@ void ComputeOptimalPointsToSampleViaLatinHypercubeSearch(const GaussianProcess&
     :lhc_search_only: whether to ONLY use latin hypercube search (and skip gradient descent EI opt)
     :num_lhc_samples: number of samples to draw if/when doing latin hypercube search
     :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
-    :normal_rng[thread_schedule.max_num_threads]: a vector of NormalRNG objects that provide
+    :normal_rng[thread_schedule.max_num_threads]: a NormalRNGArray of generators that provide
       the (pesudo)random source for MC integration
   \output
     :found_flag[1]: true if best_points_to_sample corresponds to a nonzero EI if sampled simultaneously
@@ -2000,7 +3194,7 @@ void ComputeOptimalPointsToSample(const GaussianProcess& gaussian_process,
                                   int max_int_steps, bool lhc_search_only,
                                   int num_lhc_samples, bool * restrict found_flag,
                                   UniformRandomGenerator * uniform_generator,
-                                  NormalRNG * normal_rng, double * restrict best_points_to_sample);
+                                  NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 
 // template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
 extern template void ComputeOptimalPointsToSample(
@@ -2009,14 +3203,21 @@ extern template void ComputeOptimalPointsToSample(
     double const * restrict points_being_sampled, int num_to_sample,
     int num_being_sampled, double best_so_far, int max_int_steps, bool lhc_search_only,
     int num_lhc_samples, bool * restrict found_flag, UniformRandomGenerator * uniform_generator,
-    NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 extern template void ComputeOptimalPointsToSample(
     const GaussianProcess& gaussian_process, const GradientDescentParameters& optimizer_parameters,
     const SimplexIntersectTensorProductDomain& domain, const ThreadSchedule& thread_schedule,
     double const * restrict points_being_sampled,
     int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
     bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
-    UniformRandomGenerator * uniform_generator, NormalRNG * normal_rng, double * restrict best_points_to_sample);
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
+extern template void ComputeOptimalPointsToSample(
+    const GaussianProcess& gaussian_process, const GradientDescentParameters& optimizer_parameters,
+    const TrustRegionDomain& domain, const ThreadSchedule& thread_schedule,
+    double const * restrict points_being_sampled,
+    int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
+    bool lhc_search_only, int num_lhc_samples, bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator, NormalRNGArray normal_rng, double * restrict best_points_to_sample);
 
 }  // end namespace optimal_learning
 
@@ -31,12 +31,15 @@
 #include "gpp_math_test.hpp"
 
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 
 #include <algorithm>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
@@ -1913,6 +1916,2515 @@ int EIOnePotentialSampleEdgeCasesTest() {
 }*/
 
 
+/*!\rst
+  Checks that GaussianProcess::AddPointsToGP()'s incremental cholesky update produces the same GP as
+  constructing from scratch with all points.  Points are added one at a time and then in a block.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessAddPointsTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled_initial = 6;
+  const int num_sampled = 12;
+  const double tolerance = 1.0e-11;
+
+  std::vector<int> gradients = {0, 2};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  UniformRandomGenerator uniform_generator(3141);
+  boost::uniform_real<double> uniform_double(0.5, 2.5);
+  std::vector<double> lengths(dim);
+
+  for (int i = 0; i < 10; ++i) {
+    EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+    for (int j = 0; j < dim; ++j) {
+      lengths[j] = uniform_double(uniform_generator.engine);
+    }
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+
+    GaussianProcess gaussian_process_truth(sqexp_covariance, EI_environment.points_sampled(),
+                                           EI_environment.points_sampled_value(), noise_variance.data(),
+                                           gradients.data(), num_gradients, dim, num_sampled);
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(),
+                                     gradients.data(), num_gradients, dim, num_sampled_initial);
+
+    // add 2 points one at a time, then the rest as a single block
+    int num_added = num_sampled_initial;
+    for (int num_new_points : {1, 1, num_sampled - num_sampled_initial - 2}) {
+      gaussian_process.AddPointsToGP(EI_environment.points_sampled() + num_added*dim,
+                                     EI_environment.points_sampled_value() + num_added*(num_gradients+1),
+                                     num_new_points);
+      num_added += num_new_points;
+    }
+
+    int errors_this_iteration = 0;
+    if (!CheckDoubleWithinRelative(gaussian_process.get_mean(), gaussian_process_truth.get_mean(), tolerance)) {
+      ++errors_this_iteration;
+    }
+    for (int j = 0; j < num_sampled*(num_gradients+1); ++j) {
+      if (!CheckDoubleWithinRelative(gaussian_process.get_K_inv_y()[j], gaussian_process_truth.get_K_inv_y()[j],
+                                     1.0e-9)) {
+        ++errors_this_iteration;
+      }
+    }
+
+    const int num_outputs = num_to_sample*(num_gradients+1);
+    std::vector<double> mean(num_outputs), mean_truth(num_outputs);
+    std::vector<double> variance(Square(num_outputs)), variance_truth(Square(num_outputs));
+    int num_derivatives = 0;
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample,
+                                                      gradients.data(), num_gradients, num_derivatives);
+    GaussianProcess::StateType points_to_sample_state_truth(gaussian_process_truth, EI_environment.points_to_sample(),
+                                                            num_to_sample, gradients.data(), num_gradients,
+                                                            num_derivatives);
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+    gaussian_process_truth.ComputeMeanOfPoints(points_to_sample_state_truth, mean_truth.data());
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gradients.data(), num_gradients, variance.data());
+    gaussian_process_truth.ComputeVarianceOfPoints(&points_to_sample_state_truth, gradients.data(), num_gradients,
+                                                   variance_truth.data());
+    for (int j = 0; j < num_outputs; ++j) {
+      if (!CheckDoubleWithinRelative(mean[j], mean_truth[j], tolerance)) {
+        ++errors_this_iteration;
+      }
+    }
+    for (int j = 0; j < Square(num_outputs); ++j) {
+      if (!CheckDoubleWithin(variance[j], variance_truth[j], tolerance)) {
+        ++errors_this_iteration;
+      }
+    }
+
+    if (errors_this_iteration != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("on iteration %d\n", i);
+    }
+    total_errors += errors_this_iteration;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP incremental AddPointsToGP failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP incremental AddPointsToGP passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that a GaussianProcess built on shared training data matches one built from the raw arrays, and that
+  AddPointsToGP() on one GP leaves the shared data (and the GPs still using it) untouched.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessSharedTrainingDataTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled = 10;
+  const int num_new_points = 2;
+  const double tolerance = 0.0;
+
+  std::vector<int> gradients = {1};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled + num_new_points, num_gradients);
+  std::vector<double> lengths(dim, 1.1);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+
+  auto points_sampled = std::make_shared<const std::vector<double>>(EI_environment.points_sampled(),
+                                                                    EI_environment.points_sampled() + num_sampled*dim);
+  auto points_sampled_value = std::make_shared<const std::vector<double>>(
+      EI_environment.points_sampled_value(), EI_environment.points_sampled_value() + num_sampled*(num_gradients+1));
+  auto derivatives = std::make_shared<const std::vector<int>>(gradients);
+
+  GaussianProcess gaussian_process_truth(sqexp_covariance, EI_environment.points_sampled(),
+                                         EI_environment.points_sampled_value(), noise_variance.data(),
+                                         gradients.data(), num_gradients, dim, num_sampled);
+  GaussianProcess gaussian_process_shared(sqexp_covariance, points_sampled, points_sampled_value, noise_variance.data(),
+                                          derivatives, dim, num_sampled);
+  GaussianProcess gaussian_process_extended(sqexp_covariance, points_sampled, points_sampled_value,
+                                            noise_variance.data(), derivatives, dim, num_sampled);
+
+  if (&gaussian_process_shared.points_sampled() != points_sampled.get() ||
+      &gaussian_process_extended.points_sampled_value() != points_sampled_value.get()) {
+    ++total_errors;
+  }
+
+  gaussian_process_extended.AddPointsToGP(EI_environment.points_sampled() + num_sampled*dim,
+                                          EI_environment.points_sampled_value() + num_sampled*(num_gradients+1),
+                                          num_new_points);
+  if (gaussian_process_extended.num_sampled() != num_sampled + num_new_points ||
+      &gaussian_process_extended.points_sampled() == points_sampled.get() ||
+      static_cast<int>(points_sampled->size()) != num_sampled*dim ||
+      static_cast<int>(points_sampled_value->size()) != num_sampled*(num_gradients+1) ||
+      gaussian_process_shared.num_sampled() != num_sampled) {
+    ++total_errors;
+  }
+
+  const int num_outputs = num_to_sample*(num_gradients+1);
+  std::vector<double> mean(num_outputs), mean_truth(num_outputs);
+  std::vector<double> variance(Square(num_outputs)), variance_truth(Square(num_outputs));
+  int num_derivatives = 0;
+  GaussianProcess::StateType points_to_sample_state(gaussian_process_shared, EI_environment.points_to_sample(),
+                                                    num_to_sample, gradients.data(), num_gradients, num_derivatives);
+  GaussianProcess::StateType points_to_sample_state_truth(gaussian_process_truth, EI_environment.points_to_sample(),
+                                                          num_to_sample, gradients.data(), num_gradients,
+                                                          num_derivatives);
+  gaussian_process_shared.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+  gaussian_process_truth.ComputeMeanOfPoints(points_to_sample_state_truth, mean_truth.data());
+  gaussian_process_shared.ComputeVarianceOfPoints(&points_to_sample_state, gradients.data(), num_gradients, variance.data());
+  gaussian_process_truth.ComputeVarianceOfPoints(&points_to_sample_state_truth, gradients.data(), num_gradients,
+                                                 variance_truth.data());
+  // same data, same operations: the shared GP must match bit for bit
+  for (int j = 0; j < num_outputs; ++j) {
+    if (!CheckDoubleWithin(mean[j], mean_truth[j], tolerance)) {
+      ++total_errors;
+    }
+  }
+  for (int j = 0; j < Square(num_outputs); ++j) {
+    if (!CheckDoubleWithin(variance[j], variance_truth[j], tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP shared training data failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP shared training data passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that a long-lived GP can follow new hyperparameters and new data without being rebuilt:
+
+  1. SetHyperparameters() on a GP built with other hyperparameters/noise must match a freshly built GP exactly (the
+     derived quantities are recomputed by the same code path).
+  2. AddPointsToGP() with caller-extended shared data must adopt that data (no copy) and match a fresh GP up to the
+     roundoff of the incremental cholesky update.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessInPlaceUpdateTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled_initial = 7;
+  const int num_sampled = 11;
+
+  std::vector<int> gradients = {0, 2};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance_old(num_gradients+1, 1.0e-1);
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+  noise_variance[1] = 3.0e-2;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+  std::vector<double> lengths_old(dim, 0.7);
+  std::vector<double> hyperparameters = {1.3, 1.1, 0.8, 1.6};
+  SquareExponential sqexp_covariance_old(dim, 2.1, lengths_old.data());
+  SquareExponential sqexp_covariance(dim, hyperparameters[0], hyperparameters.data() + 1);
+
+  auto points_sampled = std::make_shared<const std::vector<double>>(EI_environment.points_sampled(),
+                                                                    EI_environment.points_sampled() + num_sampled*dim);
+  auto points_sampled_value = std::make_shared<const std::vector<double>>(
+      EI_environment.points_sampled_value(), EI_environment.points_sampled_value() + num_sampled*(num_gradients+1));
+
+  GaussianProcess gaussian_process_truth(sqexp_covariance, EI_environment.points_sampled(),
+                                         EI_environment.points_sampled_value(), noise_variance.data(),
+                                         gradients.data(), num_gradients, dim, num_sampled);
+  GaussianProcess gaussian_process_rehyper(sqexp_covariance_old, EI_environment.points_sampled(),
+                                           EI_environment.points_sampled_value(), noise_variance_old.data(),
+                                           gradients.data(), num_gradients, dim, num_sampled);
+  gaussian_process_rehyper.SetHyperparameters(hyperparameters.data(), noise_variance.data());
+
+  GaussianProcess gaussian_process_extended(sqexp_covariance, EI_environment.points_sampled(),
+                                            EI_environment.points_sampled_value(), noise_variance.data(),
+                                            gradients.data(), num_gradients, dim, num_sampled_initial);
+  gaussian_process_extended.AddPointsToGP(points_sampled, points_sampled_value, num_sampled - num_sampled_initial);
+  if (gaussian_process_extended.num_sampled() != num_sampled ||
+      &gaussian_process_extended.points_sampled() != points_sampled.get() ||
+      &gaussian_process_extended.points_sampled_value() != points_sampled_value.get()) {
+    ++total_errors;
+  }
+
+  const int num_outputs = num_to_sample*(num_gradients+1);
+  std::vector<double> mean_truth(num_outputs), variance_truth(Square(num_outputs));
+  int num_derivatives = 0;
+  GaussianProcess::StateType points_to_sample_state_truth(gaussian_process_truth, EI_environment.points_to_sample(),
+                                                          num_to_sample, gradients.data(), num_gradients,
+                                                          num_derivatives);
+  gaussian_process_truth.ComputeMeanOfPoints(points_to_sample_state_truth, mean_truth.data());
+  gaussian_process_truth.ComputeVarianceOfPoints(&points_to_sample_state_truth, gradients.data(), num_gradients,
+                                                 variance_truth.data());
+
+  std::vector<double> mean(num_outputs), variance(Square(num_outputs));
+  for (auto test_case : {std::make_pair(&gaussian_process_rehyper, 0.0),
+                         std::make_pair(&gaussian_process_extended, 1.0e-11)}) {
+    GaussianProcess& gaussian_process = *test_case.first;
+    const double tolerance = test_case.second;
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, EI_environment.points_to_sample(),
+                                                      num_to_sample, gradients.data(), num_gradients, num_derivatives);
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gradients.data(), num_gradients,
+                                             variance.data());
+    for (int j = 0; j < num_outputs; ++j) {
+      if (!CheckDoubleWithinRelative(mean[j], mean_truth[j], tolerance)) {
+        ++total_errors;
+      }
+    }
+    for (int j = 0; j < Square(num_outputs); ++j) {
+      if (!CheckDoubleWithin(variance[j], variance_truth[j], tolerance)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP in-place update failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP in-place update passed\n");
+  }
+
+  return total_errors;
+}
+
+namespace {  // helper for the GP remove points, packed cholesky, derivative mask, and grid tests
+
+/*!\rst
+  Counts mismatches between ``gaussian_process`` and ``gaussian_process_truth``: mean, ``K^-1 * y``, and (if neither
+  is sparse or grid, and ``gaussian_process`` is not packed) the lower triangle of ``K_chol``, then the posterior mean
+  and variance at ``points_to_sample``.
+\endrst*/
+int CheckGaussianProcessesMatch(GaussianProcess& gaussian_process, GaussianProcess& gaussian_process_truth,
+                                double const * points_to_sample, int num_to_sample, double tolerance) {
+  int num_errors = 0;
+  if (gaussian_process.num_sampled() != gaussian_process_truth.num_sampled() ||
+      gaussian_process.num_training_points() != gaussian_process_truth.num_training_points()) {
+    return 1;
+  }
+  if (!CheckDoubleWithinRelative(gaussian_process.get_mean(), gaussian_process_truth.get_mean(), tolerance)) {
+    ++num_errors;
+  }
+  const int size = gaussian_process.num_sampled()*(gaussian_process.num_derivatives()+1);
+  for (int j = 0; j < size; ++j) {
+    if (!CheckDoubleWithinRelative(gaussian_process.get_K_inv_y()[j], gaussian_process_truth.get_K_inv_y()[j],
+                                   100.0*tolerance)) {
+      ++num_errors;
+    }
+  }
+  if (!gaussian_process.is_sparse() && !gaussian_process.is_grid() && !gaussian_process_truth.is_grid() &&
+      !gaussian_process.is_cholesky_packed()) {
+    for (int j = 0; j < size; ++j) {
+      for (int i = j; i < size; ++i) {
+        if (!CheckDoubleWithin(gaussian_process.get_K_chol()[j*size + i], gaussian_process_truth.get_K_chol()[j*size + i],
+                               tolerance)) {
+          ++num_errors;
+        }
+      }
+    }
+  }
+
+  const int num_outputs = num_to_sample*(gaussian_process.num_derivatives()+1);
+  std::vector<double> mean(num_outputs), mean_truth(num_outputs);
+  std::vector<double> variance(Square(num_outputs)), variance_truth(Square(num_outputs));
+  int num_derivatives = 0;
+  GaussianProcess::StateType points_to_sample_state(gaussian_process, points_to_sample, num_to_sample,
+                                                    gaussian_process.derivatives().data(),
+                                                    gaussian_process.num_derivatives(), num_derivatives);
+  GaussianProcess::StateType points_to_sample_state_truth(gaussian_process_truth, points_to_sample, num_to_sample,
+                                                          gaussian_process.derivatives().data(),
+                                                          gaussian_process.num_derivatives(), num_derivatives);
+  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+  gaussian_process_truth.ComputeMeanOfPoints(points_to_sample_state_truth, mean_truth.data());
+  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
+                                           gaussian_process.num_derivatives(), variance.data());
+  gaussian_process_truth.ComputeVarianceOfPoints(&points_to_sample_state_truth, gaussian_process.derivatives().data(),
+                                                 gaussian_process.num_derivatives(), variance_truth.data());
+  for (int j = 0; j < num_outputs; ++j) {
+    if (!CheckDoubleWithinRelative(mean[j], mean_truth[j], tolerance)) {
+      ++num_errors;
+    }
+  }
+  for (int j = 0; j < Square(num_outputs); ++j) {
+    if (!CheckDoubleWithin(variance[j], variance_truth[j], tolerance)) {
+      ++num_errors;
+    }
+  }
+  return num_errors;
+}
+
+}  // end unnamed namespace
+
+/*!\rst
+  Checks GaussianProcess::RemovePointsFromGP() and the sliding window built on it:
+
+  1. Removing points (first, adjacent, and last; with gradient observations) by cholesky downdating must match a GP
+     constructed from scratch with the remaining points, up to roundoff.
+  2. A kMostRecent window fed one point at a time must end up matching a GP built from the last max_num_sampled points.
+  3. A kMostInformative window must evict one of a pair of (nearly) duplicated points.
+  4. Removing points from a sparse (FITC) GP must refit like a sparse GP built from the remaining training points.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessRemovePointsTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled = 12;
+  const double tolerance = 1.0e-10;
+
+  std::vector<int> gradients = {0, 2};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  UniformRandomGenerator uniform_generator(2718);
+  boost::uniform_real<double> uniform_double(0.5, 2.5);
+  std::vector<double> lengths(dim);
+
+  // 1. remove points from a GP with gradient observations
+  const std::vector<int> indices_to_remove = {0, 4, 5, num_sampled - 1};
+  for (int i = 0; i < 5; ++i) {
+    EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+    for (int j = 0; j < dim; ++j) {
+      lengths[j] = uniform_double(uniform_generator.engine);
+    }
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+
+    std::vector<double> points_kept, values_kept;
+    for (int k = 0; k < num_sampled; ++k) {
+      if (std::find(indices_to_remove.begin(), indices_to_remove.end(), k) == indices_to_remove.end()) {
+        points_kept.insert(points_kept.end(), EI_environment.points_sampled() + k*dim,
+                           EI_environment.points_sampled() + (k+1)*dim);
+        values_kept.insert(values_kept.end(), EI_environment.points_sampled_value() + k*(num_gradients+1),
+                           EI_environment.points_sampled_value() + (k+1)*(num_gradients+1));
+      }
+    }
+    const int num_kept = num_sampled - indices_to_remove.size();
+    GaussianProcess gaussian_process_truth(sqexp_covariance, points_kept.data(), values_kept.data(),
+                                           noise_variance.data(), gradients.data(), num_gradients, dim, num_kept);
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(),
+                                     gradients.data(), num_gradients, dim, num_sampled);
+    gaussian_process.RemovePointsFromGP(indices_to_remove.data(), indices_to_remove.size());
+
+    const int errors_this_iteration = CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth,
+                                                                  EI_environment.points_to_sample(), num_to_sample,
+                                                                  tolerance);
+    if (errors_this_iteration != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("remove points: on iteration %d\n", i);
+    }
+    total_errors += errors_this_iteration;
+  }
+
+  // 2. kMostRecent window over streaming points
+  {
+    const int max_num_sampled = 5;
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(),
+                                     gradients.data(), num_gradients, dim, max_num_sampled + 2);
+    gaussian_process.SetSlidingWindow(max_num_sampled, GaussianProcessWindowPolicy::kMostRecent);
+    for (int k = max_num_sampled + 2; k < num_sampled; ++k) {
+      gaussian_process.AddPointsToGP(EI_environment.points_sampled() + k*dim,
+                                     EI_environment.points_sampled_value() + k*(num_gradients+1), 1);
+    }
+    const int first_kept = num_sampled - max_num_sampled;
+    GaussianProcess gaussian_process_truth(sqexp_covariance, EI_environment.points_sampled() + first_kept*dim,
+                                           EI_environment.points_sampled_value() + first_kept*(num_gradients+1),
+                                           noise_variance.data(), gradients.data(), num_gradients, dim,
+                                           max_num_sampled);
+    const int current_errors = CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth,
+                                                           EI_environment.points_to_sample(), num_to_sample,
+                                                           tolerance);
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("kMostRecent window failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  // 3. kMostInformative window with a nearly duplicated point
+  {
+    const int num_unique = 7;
+    const int duplicated_index = 2;
+    EI_environment.Initialize(dim, num_to_sample, 0, num_unique, 0);
+    std::vector<double> points(EI_environment.points_sampled(), EI_environment.points_sampled() + num_unique*dim);
+    std::vector<double> values(EI_environment.points_sampled_value(),
+                               EI_environment.points_sampled_value() + num_unique);
+    for (int d = 0; d < dim; ++d) {
+      points.push_back(points[duplicated_index*dim + d] + 1.0e-4);
+    }
+    values.push_back(values[duplicated_index]);
+
+    std::vector<double> lengths_informative(dim, 1.0);
+    SquareExponential sqexp_covariance(dim, 1.0, lengths_informative.data());
+    GaussianProcess gaussian_process(sqexp_covariance, points.data(), values.data(), noise_variance.data(), nullptr,
+                                     0, dim, num_unique + 1);
+    gaussian_process.SetSlidingWindow(num_unique, GaussianProcessWindowPolicy::kMostInformative);
+
+    // the kept points are all distinct iff one of the duplicates was evicted
+    const std::vector<double>& points_kept = gaussian_process.points_sampled();
+    const bool kept_original = std::equal(points_kept.begin() + duplicated_index*dim,
+                                          points_kept.begin() + (duplicated_index+1)*dim,
+                                          points.begin() + duplicated_index*dim);
+    const bool kept_duplicate = std::equal(points_kept.end() - dim, points_kept.end(), points.end() - dim);
+    if (gaussian_process.num_sampled() != num_unique || gaussian_process.max_num_sampled() != num_unique ||
+        kept_original == kept_duplicate) {
+      OL_PARTIAL_FAILURE_PRINTF("kMostInformative window kept the wrong points\n");
+      ++total_errors;
+    }
+  }
+
+  // 4. sparse GP: points are removed from the training data, then the approximation is refit
+  {
+    const int num_inducing = 5;
+    const std::vector<int> indices_to_remove_sparse = {1, 7};
+    EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, 0);
+    std::vector<double> inducing_points(EI_environment.points_sampled() + 2*dim,
+                                        EI_environment.points_sampled() + (2+num_inducing)*dim);
+    std::vector<double> points_kept, values_kept;
+    for (int k = 0; k < num_sampled; ++k) {
+      if (k != indices_to_remove_sparse[0] && k != indices_to_remove_sparse[1]) {
+        points_kept.insert(points_kept.end(), EI_environment.points_sampled() + k*dim,
+                           EI_environment.points_sampled() + (k+1)*dim);
+        values_kept.push_back(EI_environment.points_sampled_value()[k]);
+      }
+    }
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                     num_sampled, inducing_points.data(), num_inducing);
+    GaussianProcess gaussian_process_truth(sqexp_covariance, points_kept.data(), values_kept.data(),
+                                           noise_variance.data(), nullptr, 0, dim,
+                                           num_sampled - indices_to_remove_sparse.size(), inducing_points.data(),
+                                           num_inducing);
+    gaussian_process.RemovePointsFromGP(indices_to_remove_sparse.data(), indices_to_remove_sparse.size());
+    const int current_errors = CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth,
+                                                           EI_environment.points_to_sample(), num_to_sample, 0.0);
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("sparse GP point removal failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP point removal failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP point removal passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks GaussianProcess::SetCholeskyJitter():
+
+  1. Without jitter, adding a duplicate of a noise-free point must throw SingularMatrixException.
+  2. With jitter on, the same update must succeed with a jitter in ``(0, max_relative_jitter * \alpha]``, and the
+     posterior mean must still (nearly) interpolate the sampled values.
+  3. Invalid settings are rejected.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessCholeskyJitterTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 10;
+  const double alpha = 1.7;
+  const double initial_relative_jitter = 1.0e-12;
+  const double max_relative_jitter = 1.0e-6;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, 1, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 0.8);
+  SquareExponential sqexp_covariance(dim, alpha, lengths.data());
+  std::vector<double> noise_variance(1, 0.0);
+  const int duplicated_index = 3;
+  double const * duplicated_point = EI_environment.points_sampled() + duplicated_index*dim;
+  const double duplicated_value = EI_environment.points_sampled_value()[duplicated_index];
+
+  // 1. jitter off (default): a duplicated noise-free point makes K singular
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                     num_sampled);
+    bool caught_singular = false;
+    try {
+      gaussian_process.AddPointsToGP(duplicated_point, &duplicated_value, 1);
+    } catch (const SingularMatrixException& exception) {
+      caught_singular = true;
+    }
+    if (!caught_singular || gaussian_process.cholesky_jitter().jitter != 0.0) {
+      OL_PARTIAL_FAILURE_PRINTF("singular K without jitter did not throw\n");
+      ++total_errors;
+    }
+  }
+
+  // 2. jitter on: the factorization absorbs the duplicate
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                     num_sampled);
+    gaussian_process.SetCholeskyJitter(initial_relative_jitter, max_relative_jitter);
+    try {
+      gaussian_process.AddPointsToGP(duplicated_point, &duplicated_value, 1);
+    } catch (const SingularMatrixException& exception) {
+      OL_PARTIAL_FAILURE_PRINTF("jittered cholesky threw on a duplicated point\n");
+      ++total_errors;
+    }
+    const CholeskyJitter& jitter = gaussian_process.cholesky_jitter();
+    if (!(jitter.jitter > 0.0 && jitter.jitter <= max_relative_jitter*alpha) || jitter.num_jittered_pivots < 1) {
+      OL_PARTIAL_FAILURE_PRINTF("jitter %.18E (%d pivots) out of range\n", jitter.jitter, jitter.num_jittered_pivots);
+      ++total_errors;
+    }
+
+    PointsToSampleState points_to_sample_state(gaussian_process, duplicated_point, 1, nullptr, 0, 0);
+    double mean;
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, &mean);
+    if (!CheckDoubleWithinRelative(mean, duplicated_value, 1.0e-4)) {
+      OL_PARTIAL_FAILURE_PRINTF("jittered GP mean %.18E does not interpolate %.18E\n", mean, duplicated_value);
+      ++total_errors;
+    }
+  }
+
+  // 3. invalid settings
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                     num_sampled);
+    const double invalid_settings[3][2] = {{0.0, 1.0e-6}, {1.0e-6, 1.0e-8}, {1.0e-8, -1.0}};
+    for (int i = 0; i < 3; ++i) {
+      bool caught_invalid = false;
+      try {
+        gaussian_process.SetCholeskyJitter(invalid_settings[i][0], invalid_settings[i][1]);
+      } catch (const OptimalLearningException& exception) {
+        caught_invalid = true;
+      }
+      if (!caught_invalid) {
+        OL_PARTIAL_FAILURE_PRINTF("invalid jitter settings %d were accepted\n", i);
+        ++total_errors;
+      }
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP cholesky jitter failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP cholesky jitter succeeded\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the reverse mode (adjoint) GP gradients against contractions of the forward mode tensors, with and without
+  gradient observations (at the sampled points and at points_to_sample), for random adjoints ``\bar{V}``,
+  ``\bar{C}``, ``\bar{L}``:
+
+  1. ComputeAdjointGradVarianceOfPoints() vs ``\bar{V} : `` ComputeGradVarianceOfPoints()
+  2. ComputeAdjointGradCovarianceOfPoints() vs ``\bar{C} : `` ComputeGradCovarianceOfPoints()
+  3. ComputeAdjointGradCholeskyVarianceOfPoints() vs ``\bar{L} : `` ComputeGradCholeskyVarianceOfPoints()
+
+  Each adjoint accumulates into a nonzero ``grad``.  Differentiating only the first points (``num_derivatives <
+  num_to_sample`` in PointsToSampleState) must leave the gradients wrt the others untouched.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessAdjointGradientTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 9;
+  const int num_to_sample = 4;
+  const int num_pts = 6;
+  const double tolerance = 1.0e-12;
+
+  UniformRandomGenerator uniform_generator(9431);
+  boost::uniform_real<double> uniform_double(-1.0, 1.0);
+  const int derivatives[2] = {0, 2};
+  const int gradients_to_sample[1] = {1};
+  for (int num_derivatives = 0; num_derivatives < 3; num_derivatives += 2) {
+    for (int num_gradients_to_sample = 0; num_gradients_to_sample < 2; ++num_gradients_to_sample) {
+      for (int num_moving = 2; num_moving <= num_to_sample; num_moving += 2) {
+        MockExpectedImprovementEnvironment EI_environment;
+        EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_derivatives);
+        std::vector<double> lengths(dim, 1.1);
+        SquareExponential sqexp_covariance(dim, 1.6, lengths.data());
+        std::vector<double> noise_variance(1 + num_derivatives, 0.01);
+        GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                         EI_environment.points_sampled_value(), noise_variance.data(), derivatives,
+                                         num_derivatives, dim, num_sampled);
+        PointsToSampleState points_to_sample_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample,
+                                                   gradients_to_sample, num_gradients_to_sample, num_moving);
+
+        const int size = num_to_sample*(1 + num_gradients_to_sample);
+        std::vector<double> discrete_pts(dim*num_pts);
+        for (auto& entry : discrete_pts) {
+          entry = 2.0*uniform_double(uniform_generator.engine);
+        }
+        std::vector<double> grad_start(dim*num_to_sample);
+        for (auto& entry : grad_start) {
+          entry = uniform_double(uniform_generator.engine);
+        }
+
+        // forward tensors, [num_to_sample][rows][cols][dim], and the adjoints contracted with them
+        std::vector<double> grad_var(dim*Square(size)*num_to_sample);
+        gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, grad_var.data());
+        std::vector<double> var_adjoint(Square(size));
+        for (int col = 0; col < size; ++col) {
+          for (int row = col; row < size; ++row) {
+            var_adjoint[col*size + row] = var_adjoint[row*size + col] = uniform_double(uniform_generator.engine);
+          }
+        }
+
+        std::vector<double> grad_cov(dim*size*num_pts*num_to_sample);
+        gaussian_process.ComputeGradCovarianceOfPoints(&points_to_sample_state, discrete_pts.data(), num_pts, nullptr,
+                                                       0, false, nullptr, grad_cov.data());
+        std::vector<double> cov_adjoint(size*num_pts);
+        for (auto& entry : cov_adjoint) {
+          entry = uniform_double(uniform_generator.engine);
+        }
+
+        std::vector<double> chol_var(Square(size));
+        gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gradients_to_sample, num_gradients_to_sample,
+                                                 chol_var.data());
+        for (int i = 0; i < size; ++i) {
+          chol_var[i*size + i] += 1.0;
+        }
+        if (ComputeCholeskyFactorL(size, chol_var.data()) != 0) {
+          ++total_errors;
+          continue;
+        }
+        std::vector<double> grad_chol(dim*Square(size)*num_to_sample);
+        gaussian_process.ComputeGradCholeskyVarianceOfPoints(&points_to_sample_state, chol_var.data(),
+                                                             grad_chol.data());
+        std::vector<double> chol_adjoint(Square(size));
+        for (auto& entry : chol_adjoint) {
+          entry = uniform_double(uniform_generator.engine);
+        }
+
+        std::vector<double> expected[3] = {grad_start, grad_start, grad_start};
+        std::vector<double> scale[3] = {std::vector<double>(dim*num_to_sample, 1.0),
+                                        std::vector<double>(dim*num_to_sample, 1.0),
+                                        std::vector<double>(dim*num_to_sample, 1.0)};
+        for (int k = 0; k < num_moving; ++k) {
+          for (int d = 0; d < dim; ++d) {
+            for (int col = 0; col < size; ++col) {
+              for (int row = 0; row < size; ++row) {
+                const double term = var_adjoint[col*size + row]*
+                    grad_var[k*dim*Square(size) + d + row*dim + col*dim*size];
+                expected[0][k*dim + d] += term;
+                scale[0][k*dim + d] += std::fabs(term);
+              }
+              // grad_chol[k][b][a][d] is dL_{b,a}, a <= b
+              for (int row = col; row < size; ++row) {
+                const double term = chol_adjoint[col*size + row]*
+                    grad_chol[k*dim*Square(size) + row*size*dim + col*dim + d];
+                expected[2][k*dim + d] += term;
+                scale[2][k*dim + d] += std::fabs(term);
+              }
+            }
+            for (int col = 0; col < num_pts; ++col) {
+              for (int row = 0; row < size; ++row) {
+                const double term = cov_adjoint[col*size + row]*
+                    grad_cov[k*dim*size*num_pts + d + row*dim + col*dim*size];
+                expected[1][k*dim + d] += term;
+                scale[1][k*dim + d] += std::fabs(term);
+              }
+            }
+          }
+        }
+
+        std::vector<double> adjoint_grad[3] = {grad_start, grad_start, grad_start};
+        gaussian_process.ComputeAdjointGradVarianceOfPoints(&points_to_sample_state, var_adjoint.data(),
+                                                            adjoint_grad[0].data());
+        gaussian_process.ComputeAdjointGradCovarianceOfPoints(&points_to_sample_state, discrete_pts.data(), num_pts,
+                                                              cov_adjoint.data(), adjoint_grad[1].data());
+        gaussian_process.ComputeAdjointGradCholeskyVarianceOfPoints(&points_to_sample_state, chol_var.data(),
+                                                                    chol_adjoint.data(), adjoint_grad[2].data());
+
+        for (int j = 0; j < 3; ++j) {
+          for (int i = 0; i < dim*num_to_sample; ++i) {
+            if (std::fabs(adjoint_grad[j][i] - expected[j][i]) > tolerance*scale[j][i]) {
+              OL_PARTIAL_FAILURE_PRINTF("adjoint %d (derivatives %d, gradients %d, moving %d) entry %d: %.18E vs "
+                                        "forward %.18E\n", j, num_derivatives, num_gradients_to_sample, num_moving, i,
+                                        adjoint_grad[j][i], expected[j][i]);
+              ++total_errors;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP adjoint gradients failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP adjoint gradients succeeded\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  A GP without gradient observations takes the value-only paths for a PointsToSampleState without gradients and the
+  generic (block-strided) paths for one with gradients at points_to_sample.  The value entries of the latter (every
+  ``(1 + num_gradients_to_sample)``-th row and column) must match the former: mean, grad mean, grad variance, and the
+  adjoint grad variance (with ``\bar{V}`` zero on the gradient rows and columns).
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessValuesOnlyTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 11;
+  const int num_to_sample = 4;
+  const double tolerance = 1.0e-13;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  const double noise_variance = 0.02;
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), &noise_variance, nullptr, 0, dim,
+                                   num_sampled);
+
+  const int gradients_to_sample[2] = {0, 2};
+  const int num_gradients_to_sample = 2;
+  const int block_size = num_gradients_to_sample + 1;
+  const int size = num_to_sample*block_size;
+  PointsToSampleState values_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample, nullptr, 0,
+                                   num_to_sample);
+  PointsToSampleState generic_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample,
+                                    gradients_to_sample, num_gradients_to_sample, num_to_sample);
+
+  auto check = [&total_errors, tolerance](const char * name, int index, double value, double generic_value) {
+    if (!CheckDoubleWithinRelative(value, generic_value, tolerance)) {
+      OL_PARTIAL_FAILURE_PRINTF("values-only %s entry %d: %.18E vs generic %.18E\n", name, index, value, generic_value);
+      ++total_errors;
+    }
+  };
+
+  std::vector<double> mean(num_to_sample), generic_mean(size);
+  gaussian_process.ComputeMeanOfPoints(values_state, mean.data());
+  gaussian_process.ComputeMeanOfPoints(generic_state, generic_mean.data());
+  std::vector<double> grad_mu(dim*num_to_sample), generic_grad_mu(dim*size);
+  gaussian_process.ComputeGradMeanOfPoints(values_state, grad_mu.data());
+  gaussian_process.ComputeGradMeanOfPoints(generic_state, generic_grad_mu.data());
+  for (int i = 0; i < num_to_sample; ++i) {
+    check("mean", i, mean[i], generic_mean[i*block_size]);
+    for (int d = 0; d < dim; ++d) {
+      check("grad mean", i*dim + d, grad_mu[i*dim + d], generic_grad_mu[i*block_size*dim + d]);
+    }
+  }
+
+  std::vector<double> grad_var(dim*Square(num_to_sample)*num_to_sample);
+  std::vector<double> generic_grad_var(dim*Square(size)*num_to_sample);
+  gaussian_process.ComputeGradVarianceOfPoints(&values_state, grad_var.data());
+  gaussian_process.ComputeGradVarianceOfPoints(&generic_state, generic_grad_var.data());
+  for (int k = 0; k < num_to_sample; ++k) {
+    for (int col = 0; col < num_to_sample; ++col) {
+      for (int row = 0; row < num_to_sample; ++row) {
+        for (int d = 0; d < dim; ++d) {
+          const int index = k*dim*Square(num_to_sample) + d + row*dim + col*dim*num_to_sample;
+          check("grad variance", index, grad_var[index], generic_grad_var[k*dim*Square(size) + d +
+                                                                          row*block_size*dim +
+                                                                          col*block_size*dim*size]);
+        }
+      }
+    }
+  }
+
+  UniformRandomGenerator uniform_generator(3271);
+  boost::uniform_real<double> uniform_double(-1.0, 1.0);
+  std::vector<double> var_adjoint(Square(num_to_sample)), generic_var_adjoint(Square(size), 0.0);
+  for (int col = 0; col < num_to_sample; ++col) {
+    for (int row = col; row < num_to_sample; ++row) {
+      var_adjoint[col*num_to_sample + row] = var_adjoint[row*num_to_sample + col] =
+          uniform_double(uniform_generator.engine);
+      generic_var_adjoint[col*block_size*size + row*block_size] =
+          generic_var_adjoint[row*block_size*size + col*block_size] = var_adjoint[col*num_to_sample + row];
+    }
+  }
+  std::vector<double> adjoint_grad(dim*num_to_sample, 0.0), generic_adjoint_grad(dim*num_to_sample, 0.0);
+  gaussian_process.ComputeAdjointGradVarianceOfPoints(&values_state, var_adjoint.data(), adjoint_grad.data());
+  gaussian_process.ComputeAdjointGradVarianceOfPoints(&generic_state, generic_var_adjoint.data(),
+                                                      generic_adjoint_grad.data());
+  for (int i = 0; i < dim*num_to_sample; ++i) {
+    check("adjoint grad variance", i, adjoint_grad[i], generic_adjoint_grad[i]);
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP values-only paths failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP values-only paths succeeded\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks GaussianProcess::SetPackedCholeskyStorage(): a GP holding its cholesky factor packed must match the same GP
+  holding it square (mean, ``K^-1 * y``, posterior mean and variance) after packing, AddPointsToGP(),
+  RemovePointsFromGP(), and SetCovarianceHyperparameters(), with gradient observations; its factor must be
+  PackedTriangleSize() long throughout and unpack back to the square factor.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessPackedCholeskyTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled = 14;
+  const int num_initial = 9;
+  const double tolerance = 1.0e-12;
+
+  std::vector<int> gradients = {0, 2};
+  const int num_gradients = gradients.size();
+  const int block_size = num_gradients + 1;
+  std::vector<double> noise_variance(block_size, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+  std::vector<double> lengths = {0.8, 1.1, 1.4};
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process_square(sqexp_covariance, EI_environment.points_sampled(),
+                                          EI_environment.points_sampled_value(), noise_variance.data(),
+                                          gradients.data(), num_gradients, dim, num_initial);
+  GaussianProcess gaussian_process_packed(gaussian_process_square);
+  gaussian_process_packed.SetPackedCholeskyStorage(true);
+
+  auto check = [&](const char * stage) {
+    int errors = CheckGaussianProcessesMatch(gaussian_process_packed, gaussian_process_square,
+                                             EI_environment.points_to_sample(), num_to_sample, tolerance);
+    const int size = gaussian_process_packed.num_sampled()*block_size;
+    if (!gaussian_process_packed.is_cholesky_packed() ||
+        static_cast<int>(gaussian_process_packed.get_K_chol().size()) != PackedTriangleSize(size)) {
+      ++errors;
+    }
+    if (errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("packed cholesky: %d errors after %s\n", errors, stage);
+    }
+    total_errors += errors;
+  };
+  check("packing");
+
+  gaussian_process_square.AddPointsToGP(EI_environment.points_sampled() + num_initial*dim,
+                                        EI_environment.points_sampled_value() + num_initial*block_size,
+                                        num_sampled - num_initial);
+  gaussian_process_packed.AddPointsToGP(EI_environment.points_sampled() + num_initial*dim,
+                                        EI_environment.points_sampled_value() + num_initial*block_size,
+                                        num_sampled - num_initial);
+  check("adding points");
+
+  const std::vector<int> indices_to_remove = {0, 6, num_sampled - 1};
+  gaussian_process_square.RemovePointsFromGP(indices_to_remove.data(), indices_to_remove.size());
+  gaussian_process_packed.RemovePointsFromGP(indices_to_remove.data(), indices_to_remove.size());
+  check("removing points");
+
+  std::vector<double> hyperparameters = {0.9, 1.2, 0.7, 1.0};
+  gaussian_process_square.SetCovarianceHyperparameters(hyperparameters.data());
+  gaussian_process_packed.SetCovarianceHyperparameters(hyperparameters.data());
+  check("changing hyperparameters");
+
+  gaussian_process_packed.SetPackedCholeskyStorage(false);
+  const int size = gaussian_process_square.num_sampled()*block_size;
+  // only the lower triangle of the square factor is meaningful; unpacking zeroes the upper one
+  AlignedVector<double> K_chol_square(gaussian_process_square.get_K_chol());
+  ZeroUpperTriangle(size, K_chol_square.data());
+  if (gaussian_process_packed.is_cholesky_packed() ||
+      !CheckMatrixNormWithin(gaussian_process_packed.get_K_chol().data(), K_chol_square.data(), size, size,
+                             tolerance)) {
+    OL_PARTIAL_FAILURE_PRINTF("packed cholesky: unpacked factor differs from the square one\n");
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP packed cholesky storage failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP packed cholesky storage succeeded\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks GaussianProcess::SetDerivativeMask():
+
+  1. Masked derivative observations must not matter: a GP whose masked values are NaN must match one holding the true
+     values (mean, ``K^-1 * y``, ``K_chol``, posterior mean and variance).
+  2. Masking every derivative must give the posterior of the GP built from the function values alone.
+  3. AddPointsToGP() and RemovePointsFromGP() on a masked GP must match a masked GP built from scratch with the final
+     data (the added points observe every derivative).
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GaussianProcessDerivativeMaskTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const int num_sampled = 12;
+  const int num_initial = 9;
+  const double tolerance = 1.0e-12;
+
+  std::vector<int> gradients = {0, 1, 2};
+  const int num_gradients = gradients.size();
+  const int block_size = num_gradients + 1;
+  std::vector<double> noise_variance(block_size, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+  std::vector<double> lengths = {0.8, 1.1, 1.4};
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+
+  // point 0 observes every derivative, point 1 none, the rest a rotating subset
+  std::vector<int> derivative_mask(num_sampled*num_gradients);
+  for (int i = 0; i < num_sampled; ++i) {
+    for (int m = 0; m < num_gradients; ++m) {
+      derivative_mask[i*num_gradients + m] = (i == 0) || (i != 1 && (i + m) % 3 != 0);
+    }
+  }
+  std::vector<double> values_garbage(EI_environment.points_sampled_value(),
+                                     EI_environment.points_sampled_value() + num_sampled*block_size);
+  for (int i = 0; i < num_sampled; ++i) {
+    for (int m = 0; m < num_gradients; ++m) {
+      if (derivative_mask[i*num_gradients + m] == 0) {
+        values_garbage[i*block_size + 1 + m] = std::numeric_limits<double>::quiet_NaN();
+      }
+    }
+  }
+
+  // 1. masked values do not matter
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                     num_gradients, dim, num_sampled);
+    GaussianProcess gaussian_process_garbage(sqexp_covariance, EI_environment.points_sampled(), values_garbage.data(),
+                                             noise_variance.data(), gradients.data(), num_gradients, dim,
+                                             num_sampled);
+    gaussian_process.SetDerivativeMask(derivative_mask.data());
+    gaussian_process_garbage.SetDerivativeMask(derivative_mask.data());
+    int errors = CheckGaussianProcessesMatch(gaussian_process_garbage, gaussian_process,
+                                             EI_environment.points_to_sample(), num_to_sample, tolerance);
+    const int num_masked = std::count(derivative_mask.begin(), derivative_mask.end(), 0);
+    if (gaussian_process.num_observed_rows() != num_sampled*block_size - num_masked) {
+      ++errors;
+    }
+    if (errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("derivative mask: %d errors from masked values\n", errors);
+    }
+    total_errors += errors;
+  }
+
+  // 2. masking every derivative leaves the function values alone
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(), values_garbage.data(),
+                                     noise_variance.data(), gradients.data(), num_gradients, dim, num_sampled);
+    std::vector<int> mask_all(num_sampled*num_gradients, 0);
+    gaussian_process.SetDerivativeMask(mask_all.data());
+    std::vector<double> values_only(num_sampled);
+    for (int i = 0; i < num_sampled; ++i) {
+      values_only[i] = EI_environment.points_sampled_value()[i*block_size];
+    }
+    GaussianProcess gaussian_process_values(sqexp_covariance, EI_environment.points_sampled(), values_only.data(),
+                                            noise_variance.data(), nullptr, 0, dim, num_sampled);
+
+    PointsToSampleState points_to_sample_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample,
+                                               nullptr, 0, 0);
+    PointsToSampleState points_to_sample_state_values(gaussian_process_values, EI_environment.points_to_sample(),
+                                                      num_to_sample, nullptr, 0, 0);
+    std::vector<double> mean(num_to_sample), mean_values(num_to_sample);
+    std::vector<double> variance(Square(num_to_sample)), variance_values(Square(num_to_sample));
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+    gaussian_process_values.ComputeMeanOfPoints(points_to_sample_state_values, mean_values.data());
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, variance.data());
+    gaussian_process_values.ComputeVarianceOfPoints(&points_to_sample_state_values, nullptr, 0,
+                                                    variance_values.data());
+    int errors = 0;
+    for (int i = 0; i < num_to_sample; ++i) {
+      errors += !CheckDoubleWithinRelative(mean[i], mean_values[i], tolerance);
+    }
+    for (int i = 0; i < Square(num_to_sample); ++i) {
+      errors += !CheckDoubleWithin(variance[i], variance_values[i], tolerance);
+    }
+    if (errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("derivative mask: %d errors with every derivative masked\n", errors);
+    }
+    total_errors += errors;
+  }
+
+  // 3. updates
+  {
+    GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(), values_garbage.data(),
+                                     noise_variance.data(), gradients.data(), num_gradients, dim, num_initial);
+    gaussian_process.SetDerivativeMask(derivative_mask.data());
+    gaussian_process.AddPointsToGP(EI_environment.points_sampled() + num_initial*dim,
+                                   EI_environment.points_sampled_value() + num_initial*block_size,
+                                   num_sampled - num_initial);
+    const std::vector<int> indices_to_remove = {1, 4, num_sampled - 1};
+    gaussian_process.RemovePointsFromGP(indices_to_remove.data(), indices_to_remove.size());
+
+    std::vector<double> points_kept, values_kept;
+    std::vector<int> mask_kept;
+    for (int i = 0, next_removed = 0; i < num_sampled; ++i) {
+      if (next_removed < static_cast<int>(indices_to_remove.size()) && indices_to_remove[next_removed] == i) {
+        ++next_removed;
+        continue;
+      }
+      points_kept.insert(points_kept.end(), EI_environment.points_sampled() + i*dim,
+                         EI_environment.points_sampled() + (i+1)*dim);
+      values_kept.insert(values_kept.end(), values_garbage.begin() + i*block_size,
+                         values_garbage.begin() + (i+1)*block_size);
+      for (int m = 0; m < num_gradients; ++m) {
+        mask_kept.push_back(i >= num_initial || derivative_mask[i*num_gradients + m] != 0);
+        if (i >= num_initial) {  // added with their true values
+          values_kept[values_kept.size() - block_size + 1 + m] =
+              EI_environment.points_sampled_value()[i*block_size + 1 + m];
+        }
+      }
+    }
+    const int num_kept = num_sampled - indices_to_remove.size();
+    GaussianProcess gaussian_process_truth(sqexp_covariance, points_kept.data(), values_kept.data(),
+                                           noise_variance.data(), gradients.data(), num_gradients, dim, num_kept);
+    gaussian_process_truth.SetDerivativeMask(mask_kept.data());
+    int errors = CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth,
+                                             EI_environment.points_to_sample(), num_to_sample, 1.0e-10);
+    if (gaussian_process.derivative_mask() != gaussian_process_truth.derivative_mask()) {
+      ++errors;
+    }
+    if (errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("derivative mask: %d errors after updates\n", errors);
+    }
+    total_errors += errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP derivative mask failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP derivative mask succeeded\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the inducing-point (FITC) GaussianProcess:
+
+  1. With the inducing points equal to the training points, FITC is exact: mean and variance (with gradient
+     observations, over more than one kSparseTrainingTileSize tile) and one-point EI (and its gradient) must match
+     the dense GP up to the inducing-point jitter.
+  2. With fewer inducing points, AddPointsToGP() and SetHyperparameters() must refit against the training data, i.e.,
+     match a sparse GP built from scratch with the final data and hyperparameters, and leave the inducing points alone.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int SparseGaussianProcessTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  // U = X is the worst conditioned K(U,U) (no noise on the inducing points), which amplifies the jitter's effect
+  const double tolerance_exact = 1.0e-6;
+  int num_derivatives = 0;
+
+  // 1a. U = X, with gradient observations: mean and variance
+  {
+    const int num_sampled = GaussianProcess::kSparseTrainingTileSize + 9;
+    std::vector<int> gradients = {1};
+    const int num_gradients = gradients.size();
+    std::vector<double> noise_variance = {1.0e-2, 2.0e-2};
+
+    MockExpectedImprovementEnvironment EI_environment;
+    EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+    std::vector<double> lengths(dim, 0.9);
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+    GaussianProcess gaussian_process_dense(sqexp_covariance, EI_environment.points_sampled(),
+                                           EI_environment.points_sampled_value(), noise_variance.data(),
+                                           gradients.data(), num_gradients, dim, num_sampled);
+    GaussianProcess gaussian_process_sparse(sqexp_covariance, EI_environment.points_sampled(),
+                                            EI_environment.points_sampled_value(), noise_variance.data(),
+                                            gradients.data(), num_gradients, dim, num_sampled,
+                                            EI_environment.points_sampled(), num_sampled);
+    if (!gaussian_process_sparse.is_sparse() || gaussian_process_dense.is_sparse() ||
+        gaussian_process_sparse.num_training_points() != num_sampled) {
+      ++total_errors;
+    }
+
+    const int num_outputs = num_to_sample*(num_gradients+1);
+    std::vector<double> mean_truth(num_outputs), variance_truth(Square(num_outputs));
+    std::vector<double> mean(num_outputs), variance(Square(num_outputs));
+    GaussianProcess::StateType points_to_sample_state_dense(gaussian_process_dense, EI_environment.points_to_sample(),
+                                                            num_to_sample, gradients.data(), num_gradients,
+                                                            num_derivatives);
+    gaussian_process_dense.ComputeMeanOfPoints(points_to_sample_state_dense, mean_truth.data());
+    gaussian_process_dense.ComputeVarianceOfPoints(&points_to_sample_state_dense, gradients.data(), num_gradients,
+                                                   variance_truth.data());
+    GaussianProcess::StateType points_to_sample_state_sparse(gaussian_process_sparse,
+                                                             EI_environment.points_to_sample(), num_to_sample,
+                                                             gradients.data(), num_gradients, num_derivatives);
+    gaussian_process_sparse.ComputeMeanOfPoints(points_to_sample_state_sparse, mean.data());
+    gaussian_process_sparse.ComputeVarianceOfPoints(&points_to_sample_state_sparse, gradients.data(), num_gradients,
+                                                    variance.data());
+    for (int j = 0; j < num_outputs; ++j) {
+      if (!CheckDoubleWithinRelative(mean[j], mean_truth[j], tolerance_exact)) {
+        ++total_errors;
+      }
+    }
+    for (int j = 0; j < Square(num_outputs); ++j) {
+      if (!CheckDoubleWithin(variance[j], variance_truth[j], tolerance_exact)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // 1b. U = X: EI and its gradient
+  {
+    const int num_sampled = 30;
+    std::vector<double> noise_variance = {1.0e-2};
+
+    MockExpectedImprovementEnvironment EI_environment;
+    EI_environment.Initialize(dim, 1, 0, num_sampled, 0);
+    std::vector<double> lengths(dim, 0.9);
+    SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+    GaussianProcess gaussian_process_dense(sqexp_covariance, EI_environment.points_sampled(),
+                                           EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0,
+                                           dim, num_sampled);
+    GaussianProcess gaussian_process_sparse(sqexp_covariance, EI_environment.points_sampled(),
+                                            EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0,
+                                            dim, num_sampled, EI_environment.points_sampled(), num_sampled);
+    const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                                 EI_environment.points_sampled_value() + num_sampled);
+
+    std::vector<double> grad_ei_truth(dim), grad_ei(dim);
+    OnePotentialSampleExpectedImprovementEvaluator ei_evaluator_dense(gaussian_process_dense, best_so_far);
+    OnePotentialSampleExpectedImprovementState ei_state_dense(ei_evaluator_dense, EI_environment.points_to_sample(),
+                                                              true);
+    const double ei_truth = ei_evaluator_dense.ComputeExpectedImprovement(&ei_state_dense);
+    ei_evaluator_dense.ComputeGradExpectedImprovement(&ei_state_dense, grad_ei_truth.data());
+
+    OnePotentialSampleExpectedImprovementEvaluator ei_evaluator_sparse(gaussian_process_sparse, best_so_far);
+    OnePotentialSampleExpectedImprovementState ei_state_sparse(ei_evaluator_sparse, EI_environment.points_to_sample(),
+                                                               true);
+    const double ei = ei_evaluator_sparse.ComputeExpectedImprovement(&ei_state_sparse);
+    ei_evaluator_sparse.ComputeGradExpectedImprovement(&ei_state_sparse, grad_ei.data());
+
+    if (!CheckDoubleWithin(ei, ei_truth, tolerance_exact)) {
+      ++total_errors;
+    }
+    for (int d = 0; d < dim; ++d) {
+      if (!CheckDoubleWithin(grad_ei[d], grad_ei_truth[d], tolerance_exact)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // 2. M < N: updates refit against the training data
+  {
+    const int num_sampled_initial = 31;
+    const int num_sampled = 40;
+    const int num_inducing = 12;
+    std::vector<int> gradients = {0};
+    const int num_gradients = gradients.size();
+    std::vector<double> noise_variance_old = {1.0e-1, 1.0e-1};
+    std::vector<double> noise_variance = {1.0e-2, 3.0e-2};
+
+    MockExpectedImprovementEnvironment EI_environment;
+    EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+    std::vector<double> lengths_old(dim, 0.7);
+    std::vector<double> hyperparameters = {1.3, 1.1, 0.8, 1.6};
+    SquareExponential sqexp_covariance_old(dim, 2.1, lengths_old.data());
+    SquareExponential sqexp_covariance(dim, hyperparameters[0], hyperparameters.data() + 1);
+    // inducing points: every third training point
+    std::vector<double> inducing_points(num_inducing*dim);
+    for (int i = 0; i < num_inducing; ++i) {
+      std::copy(EI_environment.points_sampled() + 3*i*dim, EI_environment.points_sampled() + (3*i+1)*dim,
+                inducing_points.begin() + i*dim);
+    }
+
+    GaussianProcess gaussian_process_truth(sqexp_covariance, EI_environment.points_sampled(),
+                                           EI_environment.points_sampled_value(), noise_variance.data(),
+                                           gradients.data(), num_gradients, dim, num_sampled,
+                                           inducing_points.data(), num_inducing);
+    GaussianProcess gaussian_process_rehyper(sqexp_covariance_old, EI_environment.points_sampled(),
+                                             EI_environment.points_sampled_value(), noise_variance_old.data(),
+                                             gradients.data(), num_gradients, dim, num_sampled,
+                                             inducing_points.data(), num_inducing);
+    gaussian_process_rehyper.SetHyperparameters(hyperparameters.data(), noise_variance.data());
+    GaussianProcess gaussian_process_extended(sqexp_covariance, EI_environment.points_sampled(),
+                                              EI_environment.points_sampled_value(), noise_variance.data(),
+                                              gradients.data(), num_gradients, dim, num_sampled_initial,
+                                              inducing_points.data(), num_inducing);
+    gaussian_process_extended.AddPointsToGP(EI_environment.points_sampled() + num_sampled_initial*dim,
+                                            EI_environment.points_sampled_value() +
+                                            num_sampled_initial*(num_gradients+1),
+                                            num_sampled - num_sampled_initial);
+    if (gaussian_process_extended.num_sampled() != num_inducing ||
+        gaussian_process_extended.num_training_points() != num_sampled ||
+        gaussian_process_extended.points_sampled() != inducing_points) {
+      ++total_errors;
+    }
+
+    const int num_outputs = num_to_sample*(num_gradients+1);
+    std::vector<double> mean_truth(num_outputs), variance_truth(Square(num_outputs));
+    GaussianProcess::StateType points_to_sample_state_truth(gaussian_process_truth, EI_environment.points_to_sample(),
+                                                            num_to_sample, gradients.data(), num_gradients,
+                                                            num_derivatives);
+    gaussian_process_truth.ComputeMeanOfPoints(points_to_sample_state_truth, mean_truth.data());
+    gaussian_process_truth.ComputeVarianceOfPoints(&points_to_sample_state_truth, gradients.data(), num_gradients,
+                                                   variance_truth.data());
+
+    std::vector<double> mean(num_outputs), variance(Square(num_outputs));
+    for (GaussianProcess * gaussian_process : {&gaussian_process_rehyper, &gaussian_process_extended}) {
+      GaussianProcess::StateType points_to_sample_state(*gaussian_process, EI_environment.points_to_sample(),
+                                                        num_to_sample, gradients.data(), num_gradients,
+                                                        num_derivatives);
+      gaussian_process->ComputeMeanOfPoints(points_to_sample_state, mean.data());
+      gaussian_process->ComputeVarianceOfPoints(&points_to_sample_state, gradients.data(), num_gradients,
+                                                variance.data());
+      for (int j = 0; j < num_outputs; ++j) {
+        if (!CheckDoubleWithinRelative(mean[j], mean_truth[j], 0.0)) {
+          ++total_errors;
+        }
+      }
+      for (int j = 0; j < Square(num_outputs); ++j) {
+        if (!CheckDoubleWithin(variance[j], variance_truth[j], 0.0)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("sparse (FITC) GP failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("sparse (FITC) GP passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the grid (Kronecker) GaussianProcess against the dense GP over the same (expanded) grid points:
+
+  1. Mean, ``K^-1 * y``, posterior mean/variance (through PointsToSampleState), PredictMarginals(), and one-point EI
+     (and its gradient) must match up to roundoff, including a grid dimension with a single coordinate.
+  2. SetCovarianceHyperparameters() must refit the grid form.
+  3. AddPointsToGP() and RemovePointsFromGP() must convert to an ordinary GP matching one built from scratch.
+  4. Non-separable covariances are rejected.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int GridGaussianProcessTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 4;
+  const double tolerance = 1.0e-11;
+  const std::vector<int> grid_sizes = {4, 1, 5};
+  const int num_sampled = 20;
+  std::vector<double> noise_variance = {1.0e-2};
+  std::vector<double> lengths = {0.6, 0.9, 1.2};
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+
+  UniformRandomGenerator uniform_generator(31415);
+  boost::uniform_real<double> uniform_double(-1.0, 1.0);
+  std::vector<double> grid_coordinates(10), points_sampled_value(num_sampled), points_to_sample(num_to_sample*dim);
+  for (auto& entry : grid_coordinates) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+  for (auto& entry : points_sampled_value) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+  for (auto& entry : points_to_sample) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+
+  GaussianProcess gaussian_process_grid(sqexp_covariance, grid_coordinates.data(), grid_sizes.data(),
+                                        points_sampled_value.data(), noise_variance.data(), dim);
+  const std::vector<double> points_sampled(gaussian_process_grid.points_sampled());
+  GaussianProcess gaussian_process_dense(sqexp_covariance, points_sampled.data(), points_sampled_value.data(),
+                                         noise_variance.data(), nullptr, 0, dim, num_sampled);
+  if (!gaussian_process_grid.is_grid() || gaussian_process_dense.is_grid() ||
+      gaussian_process_grid.num_sampled() != num_sampled || gaussian_process_grid.grid_sizes() != grid_sizes ||
+      !gaussian_process_grid.get_K_chol().empty()) {
+    ++total_errors;
+  }
+  // the last grid point takes the last coordinate along every dimension
+  if (points_sampled[(num_sampled-1)*dim + 0] != grid_coordinates[3] ||
+      points_sampled[(num_sampled-1)*dim + 1] != grid_coordinates[4] ||
+      points_sampled[(num_sampled-1)*dim + 2] != grid_coordinates[9]) {
+    ++total_errors;
+  }
+
+  // 1. predictions
+  total_errors += CheckGaussianProcessesMatch(gaussian_process_grid, gaussian_process_dense, points_to_sample.data(),
+                                              num_to_sample, tolerance);
+
+  std::vector<double> mean(num_to_sample), variance(num_to_sample);
+  std::vector<double> mean_truth(num_to_sample), variance_truth(num_to_sample);
+  gaussian_process_grid.PredictMarginals(points_to_sample.data(), num_to_sample, 1, mean.data(), variance.data());
+  gaussian_process_dense.PredictMarginals(points_to_sample.data(), num_to_sample, 1, mean_truth.data(),
+                                          variance_truth.data());
+  for (int i = 0; i < num_to_sample; ++i) {
+    if (!CheckDoubleWithinRelative(mean[i], mean_truth[i], tolerance) ||
+        !CheckDoubleWithin(variance[i], variance_truth[i], tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  const double best_so_far = *std::min_element(points_sampled_value.begin(), points_sampled_value.end());
+  std::vector<double> grad_ei(dim), grad_ei_truth(dim);
+  OnePotentialSampleExpectedImprovementEvaluator ei_evaluator_grid(gaussian_process_grid, best_so_far);
+  OnePotentialSampleExpectedImprovementState ei_state_grid(ei_evaluator_grid, points_to_sample.data(), true);
+  const double ei = ei_evaluator_grid.ComputeExpectedImprovement(&ei_state_grid);
+  ei_evaluator_grid.ComputeGradExpectedImprovement(&ei_state_grid, grad_ei.data());
+  OnePotentialSampleExpectedImprovementEvaluator ei_evaluator_dense(gaussian_process_dense, best_so_far);
+  OnePotentialSampleExpectedImprovementState ei_state_dense(ei_evaluator_dense, points_to_sample.data(), true);
+  const double ei_truth = ei_evaluator_dense.ComputeExpectedImprovement(&ei_state_dense);
+  ei_evaluator_dense.ComputeGradExpectedImprovement(&ei_state_dense, grad_ei_truth.data());
+  if (!CheckDoubleWithin(ei, ei_truth, tolerance)) {
+    ++total_errors;
+  }
+  for (int d = 0; d < dim; ++d) {
+    if (!CheckDoubleWithin(grad_ei[d], grad_ei_truth[d], tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  // 2. new hyperparameters
+  {
+    std::vector<double> hyperparameters = {0.7, 0.4, 2.0, 0.8};
+    SquareExponential sqexp_covariance_new(dim, hyperparameters[0], hyperparameters.data() + 1);
+    GaussianProcess gaussian_process_truth(sqexp_covariance_new, points_sampled.data(), points_sampled_value.data(),
+                                           noise_variance.data(), nullptr, 0, dim, num_sampled);
+    GaussianProcess gaussian_process(gaussian_process_grid);
+    gaussian_process.SetCovarianceHyperparameters(hyperparameters.data());
+    if (!gaussian_process.is_grid()) {
+      ++total_errors;
+    }
+    total_errors += CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth, points_to_sample.data(),
+                                                num_to_sample, tolerance);
+  }
+
+  // 3. updates leave the grid
+  {
+    std::vector<double> points_extended(points_sampled);
+    points_extended.insert(points_extended.end(), points_to_sample.begin(), points_to_sample.begin() + dim);
+    std::vector<double> values_extended(points_sampled_value);
+    values_extended.push_back(0.25);
+    GaussianProcess gaussian_process_truth(sqexp_covariance, points_extended.data(), values_extended.data(),
+                                           noise_variance.data(), nullptr, 0, dim, num_sampled + 1);
+    GaussianProcess gaussian_process(gaussian_process_grid);
+    gaussian_process.AddPointsToGP(points_to_sample.data(), values_extended.data() + num_sampled, 1);
+    if (gaussian_process.is_grid() || gaussian_process.get_K_chol().empty()) {
+      ++total_errors;
+    }
+    total_errors += CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth, points_to_sample.data(),
+                                                num_to_sample, tolerance);
+  }
+  {
+    const int removed_index = 7;
+    std::vector<double> points_reduced(points_sampled);
+    points_reduced.erase(points_reduced.begin() + removed_index*dim, points_reduced.begin() + (removed_index+1)*dim);
+    std::vector<double> values_reduced(points_sampled_value);
+    values_reduced.erase(values_reduced.begin() + removed_index);
+    GaussianProcess gaussian_process_truth(sqexp_covariance, points_reduced.data(), values_reduced.data(),
+                                           noise_variance.data(), nullptr, 0, dim, num_sampled - 1);
+    GaussianProcess gaussian_process(gaussian_process_grid);
+    gaussian_process.RemovePointsFromGP(&removed_index, 1);
+    if (gaussian_process.is_grid()) {
+      ++total_errors;
+    }
+    total_errors += CheckGaussianProcessesMatch(gaussian_process, gaussian_process_truth, points_to_sample.data(),
+                                                num_to_sample, tolerance);
+  }
+
+  // 4. only SquareExponential factors over dimensions
+  try {
+    MaternNu2p5 matern_covariance(dim, 1.3, lengths.data());
+    GaussianProcess gaussian_process(matern_covariance, grid_coordinates.data(), grid_sizes.data(),
+                                     points_sampled_value.data(), noise_variance.data(), dim);
+    ++total_errors;
+  } catch (const OptimalLearningException& exception) {
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("grid (Kronecker) GP failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("grid (Kronecker) GP passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that GaussianProcess::PredictMarginals() matches ComputeMeanOfPoints() and the diagonal of
+  ComputeVarianceOfPoints(), over enough points to span several tiles, and that its output does not depend on the
+  number of threads.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int PredictMarginalsTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 2*GaussianProcess::kPredictMarginalsTileSize + 22;
+  const int num_sampled = 20;
+  const double tolerance = 1.0e-12;
+
+  std::vector<int> gradients = {1};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+
+  std::vector<double> mean_truth(num_to_sample);
+  std::vector<double> variance_truth(Square(num_to_sample));
+  int num_derivatives = 0;
+  GaussianProcess::StateType points_to_sample_state(gaussian_process, EI_environment.points_to_sample(), num_to_sample,
+                                                    gradients.data(), 0, num_derivatives);
+  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean_truth.data());
+  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gradients.data(), 0, variance_truth.data());
+
+  std::vector<double> mean_single(num_to_sample), variance_single(num_to_sample);
+  std::vector<double> mean_multi(num_to_sample), variance_multi(num_to_sample);
+  gaussian_process.PredictMarginals(EI_environment.points_to_sample(), num_to_sample, 1, mean_single.data(),
+                                    variance_single.data());
+  gaussian_process.PredictMarginals(EI_environment.points_to_sample(), num_to_sample, 4, mean_multi.data(),
+                                    variance_multi.data());
+
+  for (int i = 0; i < num_to_sample; ++i) {
+    if (!CheckDoubleWithin(mean_single[i], mean_truth[i], tolerance)) {
+      ++total_errors;
+    }
+    if (!CheckDoubleWithin(variance_single[i], variance_truth[i*num_to_sample + i], tolerance)) {
+      ++total_errors;
+    }
+    // tiles are computed independently, so the thread count cannot change the result
+    if (!CheckDoubleWithin(mean_multi[i], mean_single[i], 0.0) ||
+        !CheckDoubleWithin(variance_multi[i], variance_single[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("GP predict marginals failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("GP predict marginals passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfPoints() matches
+  ComputeExpectedImprovement() point by point, over several blocks (one of them partial) and for 1 and 4 threads.
+  Some of the points are training points (variance ~ noise), so the small-variance clamp is exercised too.  Also checks
+  that the analytic EvaluateEIAtPointList() reports these values and the best of them.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int OnePotentialSampleExpectedImprovementOfPointsTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_to_sample = 2*OnePotentialSampleExpectedImprovementEvaluator::kExpectedImprovementBlockSize + 37;
+  const double tolerance = 1.0e-10;
+
+  std::vector<int> gradients = {1};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-6);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  std::vector<double> points(EI_environment.points_to_sample(), EI_environment.points_to_sample() + dim*num_to_sample);
+  std::copy(EI_environment.points_sampled(), EI_environment.points_sampled() + dim*num_sampled, points.begin());
+
+  OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
+  OnePotentialSampleExpectedImprovementState ei_state(ei_evaluator, points.data(), false);
+  std::vector<double> ei_truth(num_to_sample);
+  for (int i = 0; i < num_to_sample; ++i) {
+    ei_state.SetCurrentPoint(ei_evaluator, points.data() + i*dim);
+    ei_truth[i] = ei_evaluator.ComputeExpectedImprovement(&ei_state);
+  }
+
+  std::vector<double> ei_single(num_to_sample), ei_multi(num_to_sample);
+  ei_evaluator.ComputeExpectedImprovementOfPoints(points.data(), num_to_sample, 1, ei_single.data());
+  ei_evaluator.ComputeExpectedImprovementOfPoints(points.data(), num_to_sample, 4, ei_multi.data());
+  for (int i = 0; i < num_to_sample; ++i) {
+    if (!CheckDoubleWithinRelativeWithThreshold(ei_single[i], ei_truth[i], tolerance, 1.0e-10)) {
+      ++total_errors;
+    }
+    if (!CheckDoubleWithin(ei_multi[i], ei_single[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  ThreadSchedule thread_schedule(2, omp_sched_static);
+  NormalRNG normal_rng(3141);
+  std::vector<double> function_values(num_to_sample);
+  std::vector<double> best_next_point(dim);
+  bool found_flag = false;
+  EvaluateEIAtPointList(gaussian_process, thread_schedule, points.data(), nullptr, num_to_sample, 1, 0, best_so_far,
+                        1000, &found_flag, &normal_rng, function_values.data(), best_next_point.data());
+  const int best_index = std::max_element(ei_single.begin(), ei_single.end()) - ei_single.begin();
+  if (!found_flag || !std::equal(best_next_point.begin(), best_next_point.end(), points.begin() + best_index*dim) ||
+      !std::equal(function_values.begin(), function_values.end(), ei_single.begin())) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("batched 1,0-EI failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("batched 1,0-EI passed\n");
+  }
+
+  return total_errors;
+}
+
+namespace {  // helper for PointsToSampleStateReuseTest()
+
+/*!\rst
+  \return
+    number of entries of ``K_star``, ``K_inv_times_K_star`` and the variance of ``state`` that differ from those of a fresh
+    state at the same points
+\endrst*/
+OL_WARN_UNUSED_RESULT int CheckPointsToSampleStateAgainstFresh(const GaussianProcess& gaussian_process,
+                                                               PointsToSampleState * state) {
+  const double tolerance = 1.0e-12;
+  PointsToSampleState fresh_state(gaussian_process, state->points_to_sample.data(), state->num_to_sample, nullptr, 0,
+                                  state->num_derivatives);
+  int total_errors = 0;
+  for (int i = 0; i < static_cast<int>(fresh_state.K_star.size()); ++i) {
+    if (!CheckDoubleWithinRelative(state->K_star[i], fresh_state.K_star[i], tolerance)) {
+      ++total_errors;
+    }
+    if (!CheckDoubleWithinRelativeWithThreshold(state->K_inv_times_K_star[i], fresh_state.K_inv_times_K_star[i],
+                                                tolerance, 1.0e-12)) {
+      ++total_errors;
+    }
+  }
+
+  std::vector<double> variance(Square(state->num_to_sample)), fresh_variance(Square(state->num_to_sample));
+  gaussian_process.ComputeVarianceOfPoints(state, nullptr, 0, variance.data());
+  gaussian_process.ComputeVarianceOfPoints(&fresh_state, nullptr, 0, fresh_variance.data());
+  for (int i = 0; i < Square(state->num_to_sample); ++i) {
+    if (!CheckDoubleWithinRelativeWithThreshold(variance[i], fresh_variance[i], tolerance, 1.0e-12)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int PointsToSampleStateReuseTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 25;
+  const int num_to_sample = 1;
+  const int num_being_sampled = 6;
+  const int num_union = num_to_sample + num_being_sampled;
+
+  std::vector<int> gradients = {0, 2};
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-4);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample + 2, num_being_sampled, num_sampled + 2, num_gradients);
+  std::vector<double> lengths(dim, 1.1);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+
+  // union_of_points[k] = [moving point k, points_being_sampled]
+  std::vector<std::vector<double>> union_of_points(3, std::vector<double>(dim*num_union));
+  for (int k = 0; k < 3; ++k) {
+    std::copy(EI_environment.points_to_sample() + k*dim, EI_environment.points_to_sample() + (k+1)*dim,
+              union_of_points[k].begin());
+    std::copy(EI_environment.points_being_sampled(), EI_environment.points_being_sampled() + dim*num_being_sampled,
+              union_of_points[k].begin() + dim*num_to_sample);
+  }
+
+  PointsToSampleState state(gaussian_process, union_of_points[0].data(), num_union, nullptr, 0, num_to_sample);
+  // only the moving point changes
+  state.SetupState(gaussian_process, union_of_points[1].data(), num_union, 0, num_to_sample);
+  total_errors += CheckPointsToSampleStateAgainstFresh(gaussian_process, &state);
+
+  // the GP changes: nothing may be kept
+  std::vector<double> hyperparameters = {1.7, 0.8, 1.4, 0.9};
+  gaussian_process.SetCovarianceHyperparameters(hyperparameters.data());
+  state.SetupState(gaussian_process, union_of_points[2].data(), num_union, 0, num_to_sample);
+  total_errors += CheckPointsToSampleStateAgainstFresh(gaussian_process, &state);
+
+  gaussian_process.AddPointsToGP(EI_environment.points_sampled() + dim*num_sampled,
+                                 EI_environment.points_sampled_value() + num_sampled*(num_gradients+1), 2);
+  state.SetupState(gaussian_process, union_of_points[0].data(), num_union, 0, num_to_sample);
+  total_errors += CheckPointsToSampleStateAgainstFresh(gaussian_process, &state);
+
+  // batched fill of two states, one moved and one not
+  PointsToSampleState other_state(gaussian_process, union_of_points[1].data(), num_union, nullptr, 0, num_to_sample);
+  state.PrepareState(gaussian_process, union_of_points[2].data(), num_union, 0, num_to_sample);
+  other_state.PrepareState(gaussian_process, union_of_points[1].data(), num_union, 0, num_to_sample);
+  PointsToSampleState * states[2] = {&state, &other_state};
+  gaussian_process.FillPointsToSampleStateBatch(states, 2);
+  total_errors += CheckPointsToSampleStateAgainstFresh(gaussian_process, &state);
+  total_errors += CheckPointsToSampleStateAgainstFresh(gaussian_process, &other_state);
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("PointsToSampleState column reuse failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("PointsToSampleState column reuse passed\n");
+  }
+
+  return total_errors;
+}
+
+int SharedGaussianProcessConcurrencyTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 40;
+  const int num_to_sample = 2;
+  const int num_predictions = 64;
+  const int num_samplers = 4;
+  const int num_sample = 5;
+  const int max_num_threads = 4;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample*num_predictions, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-3);
+  const GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                         EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0,
+                                         dim, num_sampled);
+
+  // mean, variance, and gradients of prediction i at points_to_sample[i*num_to_sample, (i+1)*num_to_sample)
+  const int prediction_size = num_to_sample + Square(num_to_sample) + dim*num_to_sample*(1 + Square(num_to_sample));
+  auto predict = [&](int i, double * result) {
+    PointsToSampleState state(gaussian_process, EI_environment.points_to_sample() + i*dim*num_to_sample,
+                              num_to_sample, nullptr, 0, num_to_sample);
+    double * mean = result;
+    double * variance = mean + num_to_sample;
+    double * grad_mean = variance + Square(num_to_sample);
+    double * grad_variance = grad_mean + dim*num_to_sample;
+    gaussian_process.ComputeMeanOfPoints(state, mean);
+    gaussian_process.ComputeVarianceOfPoints(&state, nullptr, 0, variance);
+    gaussian_process.ComputeGradMeanOfPoints(state, grad_mean);
+    gaussian_process.ComputeGradVarianceOfPoints(&state, grad_variance);
+  };
+
+  std::vector<double> serial(num_predictions*prediction_size);
+  for (int i = 0; i < num_predictions; ++i) {
+    predict(i, serial.data() + i*prediction_size);
+  }
+  std::vector<double> concurrent(num_predictions*prediction_size);
+#pragma omp parallel for num_threads(max_num_threads) schedule(dynamic, 1)
+  for (int i = 0; i < num_predictions; ++i) {
+    predict(i, concurrent.data() + i*prediction_size);
+  }
+  if (serial != concurrent) {
+    ++total_errors;
+  }
+
+  // sampler k, seeded with 1000 + k, against a GP copy seeded the same way
+  const int num_draws = 8;
+  std::vector<double> expected(num_samplers*num_draws*num_sample);
+  for (int k = 0; k < num_samplers; ++k) {
+    GaussianProcess gaussian_process_copy(gaussian_process);
+    gaussian_process_copy.SetExplicitSeed(1000 + k);
+    for (int j = 0; j < num_draws; ++j) {
+      gaussian_process_copy.SamplePointsFromGP(EI_environment.points_to_sample(), num_sample,
+                                               expected.data() + (k*num_draws + j)*num_sample);
+    }
+  }
+  std::vector<double> drawn(num_samplers*num_draws*num_sample);
+#pragma omp parallel for num_threads(max_num_threads) schedule(static, 1)
+  for (int k = 0; k < num_samplers; ++k) {
+    GaussianProcessSampler sampler(gaussian_process, 1000 + k);
+    for (int j = 0; j < num_draws; ++j) {
+      sampler.SamplePointsFromGP(EI_environment.points_to_sample(), num_sample,
+                                 drawn.data() + (k*num_draws + j)*num_sample);
+    }
+  }
+  if (drawn != expected) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("shared GaussianProcess concurrency failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("shared GaussianProcess concurrency passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the low-rank SamplePointsFromGP(): with full rank, the sample mean and covariance of many draws match the
+  GP's posterior mean and variance; with a truncated rank, the marginal variances still match (the unexplained
+  variance is added back as noise); and a GaussianProcessSampler draws exactly what the GP draws with the same seed.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int LowRankSamplePointsFromGPTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_sample = 6;
+  const int num_draws = 40000;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_sample, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-3);
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0,
+                                   dim, num_sampled);
+
+  std::vector<double> mean(num_sample);
+  std::vector<double> variance(Square(num_sample));
+  {
+    int num_derivatives = 0;
+    PointsToSampleState state(gaussian_process, EI_environment.points_to_sample(), num_sample, nullptr, 0,
+                              num_derivatives);
+    gaussian_process.ComputeMeanOfPoints(state, mean.data());
+    gaussian_process.ComputeVarianceOfPoints(&state, nullptr, 0, variance.data());
+  }
+  double max_variance = 0.0;
+  for (int i = 0; i < num_sample; ++i) {
+    max_variance = std::max(max_variance, variance[i*num_sample + i]);
+  }
+  // a few standard errors of the sample moments
+  const double mean_tolerance = 5.0e-2*std::sqrt(max_variance);
+  const double variance_tolerance = 5.0e-2*max_variance;
+
+  // sample mean and covariance of num_draws draws at the given rank
+  std::vector<double> draw(num_sample);
+  std::vector<double> sample_mean(num_sample);
+  std::vector<double> sample_covariance(Square(num_sample));
+  auto sample_moments = [&](int max_rank) {
+    std::fill(sample_mean.begin(), sample_mean.end(), 0.0);
+    std::fill(sample_covariance.begin(), sample_covariance.end(), 0.0);
+    for (int k = 0; k < num_draws; ++k) {
+      gaussian_process.SamplePointsFromGP(EI_environment.points_to_sample(), num_sample, max_rank, 0.0, draw.data());
+      for (int i = 0; i < num_sample; ++i) {
+        sample_mean[i] += draw[i];
+        for (int j = 0; j < num_sample; ++j) {
+          sample_covariance[i*num_sample + j] += (draw[i] - mean[i])*(draw[j] - mean[j]);
+        }
+      }
+    }
+    for (auto& entry : sample_mean) {
+      entry /= num_draws;
+    }
+    for (auto& entry : sample_covariance) {
+      entry /= num_draws;
+    }
+  };
+
+  gaussian_process.SetExplicitSeed(3141);
+  sample_moments(num_sample);
+  for (int i = 0; i < num_sample; ++i) {
+    if (std::fabs(sample_mean[i] - mean[i]) > mean_tolerance) {
+      ++total_errors;
+    }
+    for (int j = 0; j < num_sample; ++j) {
+      if (std::fabs(sample_covariance[i*num_sample + j] - variance[i*num_sample + j]) > variance_tolerance) {
+        ++total_errors;
+      }
+    }
+  }
+
+  sample_moments(2);
+  for (int i = 0; i < num_sample; ++i) {
+    if (std::fabs(sample_covariance[i*num_sample + i] - variance[i*num_sample + i]) > variance_tolerance) {
+      ++total_errors;
+    }
+  }
+
+  // the sampler and the GP share the sampling core
+  const int num_check_draws = 8;
+  std::vector<double> expected(num_check_draws*num_sample);
+  std::vector<double> drawn(num_check_draws*num_sample);
+  gaussian_process.SetExplicitSeed(2718);
+  GaussianProcessSampler sampler(gaussian_process, 2718);
+  for (int k = 0; k < num_check_draws; ++k) {
+    const int expected_index = gaussian_process.SamplePointsFromGP(EI_environment.points_to_sample(), num_sample, 3,
+                                                                   1.0e-6, expected.data() + k*num_sample);
+    const int drawn_index = sampler.SamplePointsFromGP(EI_environment.points_to_sample(), num_sample, 3, 1.0e-6,
+                                                       drawn.data() + k*num_sample);
+    if (expected_index != drawn_index) {
+      ++total_errors;
+    }
+  }
+  if (drawn != expected) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("low-rank GP sampling failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("low-rank GP sampling passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that single precision Monte-Carlo EI (MonteCarloPrecision::kSingle) reproduces double precision EI and grad EI.
+  Both evaluators see the same normals, so they differ only by float round-off in the samples (and the rare
+  iteration whose winner flips because of it); that is far below the MC error itself.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int ExpectedImprovementSinglePrecisionTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 3;
+  const int num_being_sampled = 2;
+  const int num_sampled = 20;
+  const int num_mc_iterations = 10000;
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  // improvement over the best observation is then neither rare nor certain
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  ExpectedImprovementEvaluator ei_evaluator_double(gaussian_process, num_mc_iterations, best_so_far,
+                                                   MonteCarloPrecision::kDouble);
+  ExpectedImprovementEvaluator ei_evaluator_single(gaussian_process, num_mc_iterations, best_so_far,
+                                                   MonteCarloPrecision::kSingle);
+  NormalRNG normal_rng_double(3141);
+  NormalRNG normal_rng_single(3141);
+  ExpectedImprovementState ei_state_double(ei_evaluator_double, EI_environment.points_to_sample(),
+                                           EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                           true, &normal_rng_double);
+  ExpectedImprovementState ei_state_single(ei_evaluator_single, EI_environment.points_to_sample(),
+                                           EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                           true, &normal_rng_single);
+
+  const double EI_double = ei_evaluator_double.ComputeExpectedImprovement(&ei_state_double);
+  const double EI_single = ei_evaluator_single.ComputeExpectedImprovement(&ei_state_single);
+  if (!CheckDoubleWithinRelative(EI_single, EI_double, 1.0e-5)) {
+    ++total_errors;
+  }
+
+  std::vector<double> grad_EI_double(dim*num_to_sample);
+  std::vector<double> grad_EI_single(dim*num_to_sample);
+  ei_evaluator_double.ComputeGradExpectedImprovement(&ei_state_double, grad_EI_double.data());
+  ei_evaluator_single.ComputeGradExpectedImprovement(&ei_state_single, grad_EI_single.data());
+  const double grad_EI_norm = VectorNorm(grad_EI_double.data(), dim*num_to_sample);
+  for (int i = 0; i < dim*num_to_sample; ++i) {
+    if (!CheckDoubleWithin(grad_EI_single[i], grad_EI_double[i], 1.0e-3*grad_EI_norm)) {
+      ++total_errors;
+    }
+  }
+
+  // only the buffers of the evaluator's precision are allocated
+  if (!ei_state_single.EI_this_step_from_var.empty() || !ei_state_single.normals.empty() ||
+      !ei_state_double.EI_this_step_from_var_single.empty() || !ei_state_double.normals_single.empty()) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("single precision MC EI failed with %d errors: EI %.18E vs %.18E\n", total_errors,
+                              EI_single, EI_double);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("single precision MC EI passed\n");
+  }
+
+  return total_errors;
+}
+
+int ExpectedImprovementAdaptiveMonteCarloTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int num_sampled = 20;
+  const int max_num_mc_iterations = 10000;
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  // EI is then large enough for the error target to be met well before max_num_mc_iterations
+  const double best_so_far = *std::max_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  // early stop: the estimate meets its error target and equals the fixed-size estimate over the same prefix of draws
+  const int min_num_mc_iterations = 512;
+  const double relative_tolerance = 0.05;
+  AdaptiveMonteCarloParameters adaptive_parameters(min_num_mc_iterations, max_num_mc_iterations, relative_tolerance, 3.0);
+  ExpectedImprovementEvaluator ei_evaluator_adaptive(gaussian_process, adaptive_parameters, best_so_far,
+                                                     MonteCarloPrecision::kDouble);
+  NormalRNG normal_rng(3141);
+  ExpectedImprovementState ei_state(ei_evaluator_adaptive, EI_environment.points_to_sample(),
+                                    EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                    false, &normal_rng);
+  const double EI_adaptive = ei_evaluator_adaptive.ComputeExpectedImprovement(&ei_state);
+  const int num_mc_iterations_used = ei_state.num_mc_iterations_used;
+  if (ei_state.pruned || num_mc_iterations_used < min_num_mc_iterations ||
+      num_mc_iterations_used >= max_num_mc_iterations ||
+      num_mc_iterations_used % ExpectedImprovementState::kMonteCarloBlockSize != 0 ||
+      ei_state.standard_error > relative_tolerance*EI_adaptive) {
+    ++total_errors;
+  }
+
+  ExpectedImprovementEvaluator ei_evaluator_prefix(gaussian_process, num_mc_iterations_used, best_so_far);
+  if (!CheckDoubleWithinRelative(ei_evaluator_prefix.ComputeExpectedImprovement(&ei_state), EI_adaptive, 0.0)) {
+    ++total_errors;
+  }
+
+  ExpectedImprovementEvaluator ei_evaluator_fixed(gaussian_process, max_num_mc_iterations, best_so_far);
+  const double EI_fixed = ei_evaluator_fixed.ComputeExpectedImprovement(&ei_state);
+  if (ei_state.num_mc_iterations_used != max_num_mc_iterations ||
+      !CheckDoubleWithin(EI_adaptive, EI_fixed, 5.0*relative_tolerance*EI_adaptive)) {
+    ++total_errors;
+  }
+
+  // pruning: a threshold far above EI stops after the minimum number of draws
+  ei_state.prune_threshold = 10.0*EI_fixed + 1.0;
+  AdaptiveMonteCarloParameters pruning_parameters(min_num_mc_iterations, max_num_mc_iterations, 0.0, 3.0);
+  ExpectedImprovementEvaluator ei_evaluator_pruning(gaussian_process, pruning_parameters, best_so_far,
+                                                    MonteCarloPrecision::kDouble);
+  ei_evaluator_pruning.ComputeExpectedImprovement(&ei_state);
+  if (!ei_state.pruned || ei_state.num_mc_iterations_used != min_num_mc_iterations) {
+    ++total_errors;
+  }
+
+  // screening: pruning never discards the fixed-size winner, and skips most of the draws; without a relative
+  // tolerance, unpruned candidates use every draw and so match the fixed-size values exactly
+  const int num_candidates = 30;
+  const int problem_size = dim*num_to_sample;
+  UniformRandomGenerator uniform_generator(2718);
+  boost::uniform_real<double> uniform_double(MockExpectedImprovementEnvironment::range_min,
+                                             MockExpectedImprovementEnvironment::range_max);
+  std::vector<double> candidates(problem_size*num_candidates);
+  for (auto& entry : candidates) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+  ThreadSchedule thread_schedule(1, omp_sched_static);
+  std::vector<NormalRNG> normal_rng_vector(1, NormalRNG(3141));
+  bool found_flag_fixed = false;
+  bool found_flag_pruning = false;
+  std::vector<double> function_values_fixed(num_candidates);
+  std::vector<double> function_values_pruning(num_candidates);
+  std::vector<double> standard_errors(num_candidates);
+  std::vector<int> num_mc_iterations_list(num_candidates);
+  std::vector<double> best_point_fixed(problem_size);
+  std::vector<double> best_point_pruning(problem_size);
+  EvaluateEIAtPointList(gaussian_process, thread_schedule, candidates.data(), EI_environment.points_being_sampled(),
+                        num_candidates, num_to_sample, num_being_sampled, best_so_far, max_num_mc_iterations,
+                        &found_flag_fixed, normal_rng_vector.data(), function_values_fixed.data(),
+                        best_point_fixed.data());
+  EvaluateEIAtPointList(gaussian_process, thread_schedule, candidates.data(), EI_environment.points_being_sampled(),
+                        num_candidates, num_to_sample, num_being_sampled, best_so_far, pruning_parameters,
+                        &found_flag_pruning, normal_rng_vector.data(), function_values_pruning.data(),
+                        standard_errors.data(), num_mc_iterations_list.data(), best_point_pruning.data());
+  if (!found_flag_fixed || !found_flag_pruning) {
+    ++total_errors;
+  }
+  for (int i = 0; i < problem_size; ++i) {
+    if (!CheckDoubleWithin(best_point_pruning[i], best_point_fixed[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+  int total_num_mc_iterations = 0;
+  for (int i = 0; i < num_candidates; ++i) {
+    total_num_mc_iterations += num_mc_iterations_list[i];
+    if (num_mc_iterations_list[i] == max_num_mc_iterations &&
+        !CheckDoubleWithinRelative(function_values_pruning[i], function_values_fixed[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+  if (total_num_mc_iterations >= num_candidates*max_num_mc_iterations/2) {
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("adaptive MC EI failed with %d errors: EI %.18E vs %.18E, %d of %d draws in screen\n",
+                              total_errors, EI_adaptive, EI_fixed, total_num_mc_iterations,
+                              num_candidates*max_num_mc_iterations);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("adaptive MC EI passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the lockstep batched multistart path (MultistartOptimizer::MultistartOptimizeBatch()):
+
+  * ComputeGradObjectiveFunctionBatch() (one blocked K^-1 * K_star solve for the batch) matches per-state gradients
+    for q,p-EI (MC; every state's NormalRNG has the same seed) and 1,0-EI (analytic),
+  * batched gradient descent reaches the same optima and values as MultistartOptimize() for 1,0-EI, under both
+    ParallelBackend values and with a batch_size that does not divide num_multistarts,
+  * ``batch_size < 1`` throws.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int ExpectedImprovementBatchGradientTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_states = 7;
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, 1, 0, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  UniformRandomGenerator uniform_generator(8128);
+  boost::uniform_real<double> uniform_double(MockExpectedImprovementEnvironment::range_min,
+                                             MockExpectedImprovementEnvironment::range_max);
+
+  // q,p-EI: batched vs one state at a time
+  {
+    const int num_to_sample = 2;
+    const int num_being_sampled = 1;
+    const int problem_size = dim*num_to_sample;
+    std::vector<double> points(problem_size*num_states);
+    std::vector<double> points_being_sampled(dim*num_being_sampled);
+    for (auto& entry : points) {
+      entry = uniform_double(uniform_generator.engine);
+    }
+    for (auto& entry : points_being_sampled) {
+      entry = uniform_double(uniform_generator.engine);
+    }
+    ExpectedImprovementEvaluator ei_evaluator(gaussian_process, 1000, best_so_far);
+    std::vector<NormalRNG> normal_rng_batch(num_states, NormalRNG(3141));
+    std::vector<NormalRNG> normal_rng_single(num_states, NormalRNG(3141));
+    std::vector<ExpectedImprovementState> ei_states;
+    std::vector<ExpectedImprovementState> ei_states_single;
+    for (int k = 0; k < num_states; ++k) {
+      // start every state elsewhere so the batch hook has to move them
+      ei_states.emplace_back(ei_evaluator, points.data() + ((k+1) % num_states)*problem_size,
+                             points_being_sampled.data(), num_to_sample, num_being_sampled, true,
+                             normal_rng_batch.data() + k);
+      ei_states_single.emplace_back(ei_evaluator, points.data() + k*problem_size, points_being_sampled.data(),
+                                    num_to_sample, num_being_sampled, true, normal_rng_single.data() + k);
+    }
+    std::vector<ExpectedImprovementState *> state_pointers(num_states);
+    for (int k = 0; k < num_states; ++k) {
+      state_pointers[k] = ei_states.data() + k;
+    }
+    std::vector<double> grad_batch(problem_size*num_states);
+    std::vector<double> grad_single(problem_size);
+    ei_evaluator.ComputeGradObjectiveFunctionBatch(state_pointers.data(), num_states, points.data(), grad_batch.data());
+    for (int k = 0; k < num_states; ++k) {
+      ei_evaluator.ComputeGradObjectiveFunction(ei_states_single.data() + k, grad_single.data());
+      for (int j = 0; j < problem_size; ++j) {
+        if (!CheckDoubleWithinRelative(grad_batch[k*problem_size + j], grad_single[j], 1.0e-12)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  // 1,0-EI: batched gradients, then batched multistart gradient descent
+  {
+    const int num_multistarts = 23;
+    const int batch_size = 5;
+    const int max_num_threads = 2;
+    OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
+    std::vector<double> initial_guesses(dim*num_multistarts);
+    for (auto& entry : initial_guesses) {
+      entry = uniform_double(uniform_generator.engine);
+    }
+
+    std::vector<OnePotentialSampleExpectedImprovementState> ei_states;
+    for (int k = 0; k < max_num_threads*batch_size; ++k) {
+      ei_states.emplace_back(ei_evaluator, initial_guesses.data() + (k+1)*dim, true);
+    }
+    std::vector<OnePotentialSampleExpectedImprovementState *> state_pointers(num_states);
+    for (int k = 0; k < num_states; ++k) {
+      state_pointers[k] = ei_states.data() + k;
+    }
+    std::vector<double> grad_batch(dim*num_states);
+    std::vector<double> grad_single(dim);
+    ei_evaluator.ComputeGradObjectiveFunctionBatch(state_pointers.data(), num_states, initial_guesses.data(),
+                                                   grad_batch.data());
+    for (int k = 0; k < num_states; ++k) {
+      OnePotentialSampleExpectedImprovementState ei_state(ei_evaluator, initial_guesses.data() + k*dim, true);
+      ei_evaluator.ComputeGradObjectiveFunction(&ei_state, grad_single.data());
+      for (int j = 0; j < dim; ++j) {
+        if (!CheckDoubleWithinRelative(grad_batch[k*dim + j], grad_single[j], 1.0e-12)) {
+          ++total_errors;
+        }
+      }
+    }
+
+    std::vector<ClosedInterval> domain_bounds(dim, {MockExpectedImprovementEnvironment::range_min,
+                                                    MockExpectedImprovementEnvironment::range_max});
+    TensorProductDomain domain(domain_bounds.data(), dim);
+    GradientDescentParameters gd_parameters(num_multistarts, 200, 5, 10, 0.7, 1.0, 0.5, 1.0e-7);
+    using OptimizerType = GradientDescentOptimizer<OnePotentialSampleExpectedImprovementEvaluator, TensorProductDomain>;
+    OptimizerType gd_optimizer;
+    MultistartOptimizer<OptimizerType> multistart_optimizer;
+
+    std::vector<double> function_values(num_multistarts);
+    OptimizationIOContainer io_container(dim, 0.0, initial_guesses.data());
+    ThreadSchedule single_thread_schedule(1, omp_sched_static);
+    multistart_optimizer.MultistartOptimize(gd_optimizer, ei_evaluator, gd_parameters, domain, single_thread_schedule,
+                                            initial_guesses.data(), num_multistarts, ei_states.data(),
+                                            function_values.data(), &io_container);
+
+    for (auto backend : {ParallelBackend::kOpenMP, ParallelBackend::kWorkStealing}) {
+      ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic, 1, backend);
+      std::vector<double> function_values_batch(num_multistarts);
+      OptimizationIOContainer io_container_batch(dim, 0.0, initial_guesses.data());
+      multistart_optimizer.MultistartOptimizeBatch(gd_optimizer, ei_evaluator, gd_parameters, domain, thread_schedule,
+                                                   batch_size, initial_guesses.data(), num_multistarts,
+                                                   ei_states.data(), function_values_batch.data(),
+                                                   &io_container_batch);
+      if (io_container_batch.found_flag != io_container.found_flag ||
+          !CheckDoubleWithinRelative(io_container_batch.best_objective_value_so_far,
+                                     io_container.best_objective_value_so_far, 1.0e-10)) {
+        ++total_errors;
+      }
+      for (int i = 0; i < num_multistarts; ++i) {
+        if (!CheckDoubleWithinRelative(function_values_batch[i], function_values[i], 1.0e-10)) {
+          ++total_errors;
+        }
+      }
+      for (int j = 0; j < dim; ++j) {
+        if (!CheckDoubleWithin(io_container_batch.best_point[j], io_container.best_point[j], 1.0e-8)) {
+          ++total_errors;
+        }
+      }
+    }
+
+    bool caught = false;
+    try {
+      multistart_optimizer.MultistartOptimizeBatch(gd_optimizer, ei_evaluator, gd_parameters, domain,
+                                                   single_thread_schedule, 0, initial_guesses.data(),
+                                                   num_multistarts, ei_states.data(), nullptr, &io_container);
+    } catch (const LowerBoundException<int>&) {
+      caught = true;
+    }
+    if (!caught) {
+      ++total_errors;
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("batched EI gradients and multistart failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("batched EI gradients and multistart passed\n");
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the fused ExpectedImprovementEvaluator::ComputeObjectiveAndGradient() (see gpp_optimization.hpp): for q,p-EI
+  (MC; states with same-seeded NormalRNGs), its value and gradient match ComputeObjectiveFunction() and
+  ComputeGradObjectiveFunction() exactly, and HasComputeObjectiveAndGradient detects the hook.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int ExpectedImprovementFusedGradientTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int problem_size = dim*num_to_sample;
+
+  if (!HasComputeObjectiveAndGradient<ExpectedImprovementEvaluator>::value ||
+      HasComputeObjectiveAndGradient<OnePotentialSampleExpectedImprovementEvaluator>::value) {
+    ++total_errors;
+  }
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  ExpectedImprovementEvaluator ei_evaluator(gaussian_process, 1000, best_so_far);
+  NormalRNG normal_rng_fused(2718);
+  NormalRNG normal_rng_value(2718);
+  NormalRNG normal_rng_gradient(2718);
+  ExpectedImprovementState ei_state_fused(ei_evaluator, EI_environment.points_to_sample(),
+                                          EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                          true, &normal_rng_fused);
+  ExpectedImprovementState ei_state_value(ei_evaluator, EI_environment.points_to_sample(),
+                                          EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                          false, &normal_rng_value);
+  ExpectedImprovementState ei_state_gradient(ei_evaluator, EI_environment.points_to_sample(),
+                                             EI_environment.points_being_sampled(), num_to_sample, num_being_sampled,
+                                             true, &normal_rng_gradient);
+
+  std::vector<double> grad_fused(problem_size);
+  std::vector<double> grad_separate(problem_size);
+  const double value_fused = ComputeObjectiveAndGradient(ei_evaluator, &ei_state_fused, grad_fused.data());
+  const double value_separate = ei_evaluator.ComputeObjectiveFunction(&ei_state_value);
+  ei_evaluator.ComputeGradObjectiveFunction(&ei_state_gradient, grad_separate.data());
+  if (!CheckDoubleWithinRelative(value_fused, value_separate, 0.0)) {
+    ++total_errors;
+  }
+  for (int k = 0; k < problem_size; ++k) {
+    if (!CheckDoubleWithinRelative(grad_fused[k], grad_separate[k], 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks ComputeExpectedImprovementAtPointSets(): for q,p-EI (MC) on 2 threads, its values (and gradients) match
+  evaluating the sets in turn on per-thread states with same-seeded NormalRNGs, set ``i`` on thread ``i % 2``.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int ExpectedImprovementAtPointSetsTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int num_sets = 5;
+  const int problem_size = dim*num_to_sample;
+  const int max_int_steps = 500;
+  static const int kMaxNumThreads = 2;
+  const int seeds[kMaxNumThreads] = {2718, 27182};
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  // shifted copies of the environment's points to sample
+  std::vector<double> point_sets(problem_size*num_sets);
+  for (int i = 0; i < num_sets; ++i) {
+    for (int k = 0; k < problem_size; ++k) {
+      point_sets[i*problem_size + k] = EI_environment.points_to_sample()[k] + 0.15*i*(k % 2 == 0 ? 1.0 : -1.0);
+    }
+  }
+
+  ThreadSchedule thread_schedule(kMaxNumThreads, omp_sched_static);
+  ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
+  for (const bool compute_gradients : {false, true}) {
+    std::vector<NormalRNG> normal_rng_vec(kMaxNumThreads);
+    for (int j = 0; j < kMaxNumThreads; ++j) {
+      normal_rng_vec[j].SetExplicitSeed(seeds[j]);
+    }
+    std::vector<double> values(num_sets);
+    std::vector<double> grad_EI(compute_gradients ? problem_size*num_sets : 0);
+    ComputeExpectedImprovementAtPointSets(gaussian_process, thread_schedule, point_sets.data(),
+                                          EI_environment.points_being_sampled(), num_sets, num_to_sample,
+                                          num_being_sampled, best_so_far, max_int_steps, normal_rng_vec.data(),
+                                          values.data(), compute_gradients ? grad_EI.data() : nullptr);
+
+    std::vector<double> grad_expected(problem_size);
+    for (int j = 0; j < kMaxNumThreads; ++j) {
+      NormalRNG normal_rng(seeds[j]);
+      ExpectedImprovementState ei_state(ei_evaluator, point_sets.data(), EI_environment.points_being_sampled(),
+                                        num_to_sample, num_being_sampled, compute_gradients, &normal_rng);
+      for (int i = j; i < num_sets; i += kMaxNumThreads) {
+        ei_state.SetCurrentPoint(ei_evaluator, point_sets.data() + i*problem_size);
+        double value_expected;
+        if (compute_gradients) {
+          value_expected = ComputeObjectiveAndGradient(ei_evaluator, &ei_state, grad_expected.data());
+          for (int k = 0; k < problem_size; ++k) {
+            if (!CheckDoubleWithinRelative(grad_EI[i*problem_size + k], grad_expected[k], 0.0)) {
+              ++total_errors;
+            }
+          }
+        } else {
+          value_expected = ei_evaluator.ComputeObjectiveFunction(&ei_state);
+        }
+        if (!CheckDoubleWithinRelative(values[i], value_expected, 0.0)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that with PhiloxNormalRNGs, q,p-EI (MC) results do not depend on the number of threads: identically seeded
+  generators draw for start ``i`` from stream ``i`` (SelectNormalStream()) whichever thread runs it, so
+
+  * ComputeExpectedImprovementAtPointSets() gives the same values on 1 and 3 threads, and a repeated set gets a
+    different estimate (its own stream); and
+  * ComputeOptimalPointsToSampleViaMultistartGradientDescent() finds the same point on 1 thread and on 4 threads
+    with a dynamic schedule.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+int ExpectedImprovementPhiloxThreadCountTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_to_sample = 2;
+  const int num_being_sampled = 1;
+  const int num_sets = 6;
+  const int problem_size = dim*num_to_sample;
+  const int max_int_steps = 500;
+  const std::uint64_t seed = 2718;
+
+  std::vector<int> gradients;
+  const int num_gradients = gradients.size();
+  std::vector<double> noise_variance(num_gradients+1, 1.0e-2);
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, num_being_sampled, num_sampled, num_gradients);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), gradients.data(),
+                                   num_gradients, dim, num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  // shifted copies of the environment's points to sample; set 1 repeats set 0
+  std::vector<double> point_sets(problem_size*num_sets);
+  for (int i = 0; i < num_sets; ++i) {
+    for (int k = 0; k < problem_size; ++k) {
+      const double shift = 0.15*std::max(i - 1, 0);
+      point_sets[i*problem_size + k] = EI_environment.points_to_sample()[k] + shift*(k % 2 == 0 ? 1.0 : -1.0);
+    }
+  }
+
+  std::vector<double> values_single_thread(num_sets);
+  for (const int num_threads : {1, 3}) {
+    ThreadSchedule thread_schedule(num_threads, omp_sched_static);
+    std::vector<PhiloxNormalRNG> normal_rng_vec(num_threads, PhiloxNormalRNG(seed));
+    std::vector<double> values(num_sets);
+    ComputeExpectedImprovementAtPointSets(gaussian_process, thread_schedule, point_sets.data(),
+                                          EI_environment.points_being_sampled(), num_sets, num_to_sample,
+                                          num_being_sampled, best_so_far, max_int_steps, normal_rng_vec.data(),
+                                          values.data(), nullptr);
+    if (num_threads == 1) {
+      values_single_thread = values;
+      if (values[0] == values[1]) {
+        ++total_errors;
+      }
+    } else if (values != values_single_thread) {
+      ++total_errors;
+    }
+  }
+
+  // multistart gradient descent from the sets, over a box around them
+  std::vector<ClosedInterval> domain_bounds(dim);
+  for (int d = 0; d < dim; ++d) {
+    domain_bounds[d] = {-1.5, 3.5};
+  }
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  GradientDescentParameters gd_params(num_sets, 40, 1, 0, 0.5, 0.5, 1.0, 1.0e-7);
+  std::vector<double> best_next_point_single_thread(problem_size);
+  for (const int num_threads : {1, 4}) {
+    ThreadSchedule thread_schedule(num_threads, omp_sched_dynamic, 1);
+    std::vector<PhiloxNormalRNG> normal_rng_vec(num_threads, PhiloxNormalRNG(seed));
+    std::vector<double> best_next_point(problem_size);
+    bool found_flag = false;
+    ComputeOptimalPointsToSampleViaMultistartGradientDescent(gaussian_process, gd_params, domain, thread_schedule,
+                                                             point_sets.data(), EI_environment.points_being_sampled(),
+                                                             num_sets, num_to_sample, num_being_sampled,
+                                                             best_so_far, max_int_steps, normal_rng_vec.data(),
+                                                             &found_flag, best_next_point.data());
+    if (!found_flag) {
+      ++total_errors;
+    }
+    if (num_threads == 1) {
+      best_next_point_single_thread = best_next_point;
+    } else if (best_next_point != best_next_point_single_thread) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
 int RunGPTests() {
   int total_errors = 0;
   int current_errors = 0;
@@ -1991,6 +4503,134 @@ int RunGPTests() {
   }
 
 
+  {
+    current_errors = GaussianProcessAddPointsTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP incremental point addition failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessSharedTrainingDataTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP shared training data failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessInPlaceUpdateTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP in-place update failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessRemovePointsTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP point removal failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessCholeskyJitterTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP cholesky jitter failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessAdjointGradientTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP adjoint gradients failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessValuesOnlyTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP values-only paths failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessPackedCholeskyTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP packed cholesky storage failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GaussianProcessDerivativeMaskTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP derivative mask failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = SparseGaussianProcessTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("sparse GP failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = GridGaussianProcessTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("grid GP failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = PredictMarginalsTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("GP predict marginals failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = OnePotentialSampleExpectedImprovementOfPointsTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("batched 1,0-EI failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = PointsToSampleStateReuseTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("PointsToSampleState column reuse failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = SharedGaussianProcessConcurrencyTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("shared GaussianProcess concurrency failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = LowRankSamplePointsFromGPTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("low-rank GP sampling failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
   {
     current_errors = PingEIGeneralTest();
     if (current_errors != 0) {
@@ -1999,6 +4639,54 @@ int RunGPTests() {
     total_errors += current_errors;
   }
 
+  {
+    current_errors = ExpectedImprovementSinglePrecisionTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("single precision MC EI failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = ExpectedImprovementAdaptiveMonteCarloTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("adaptive MC EI failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = ExpectedImprovementBatchGradientTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("batched EI gradients failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = ExpectedImprovementFusedGradientTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("fused EI value and gradient failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = ExpectedImprovementAtPointSetsTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("EI over point sets failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    current_errors = ExpectedImprovementPhiloxThreadCountTest();
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("EI with Philox generators on 1 vs. N threads failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
 /*
   {
     current_errors = PingEIOnePotentialSampleTest();
@@ -2147,20 +4835,27 @@ int MultithreadedEIOptimizationTest(ExpectedImprovementEvaluationMode ei_mode) {
     }
   }
 
-  // now multithreaded to generate test data
+  // now multithreaded to generate test data; also keep every start's result (no distance requirement)
   std::vector<double> best_next_point_multithread(kDim*num_to_sample);
   thread_schedule.max_num_threads = kMaxNumThreads;
   found_flag = false;
+  DiverseTopPoints top_points(kMaxNumThreads, 0.0);
   ComputeOptimalPointsToSampleViaMultistartGradientDescent(*mock_gp_data.gaussian_process_ptr, gd_params,
                                                            domain, thread_schedule, starting_points.data(),
                                                            points_being_sampled.data(), kMaxNumThreads,
                                                            num_to_sample, num_being_sampled,
                                                            mock_gp_data.best_so_far,
                                                            max_mc_iterations, normal_rng_vec.data(),
-                                                           &found_flag, best_next_point_multithread.data());
+                                                           &found_flag, best_next_point_multithread.data(),
+                                                           &top_points);
   if (!found_flag) {
     ++total_errors;
   }
+  // the best of the top points is the result
+  if (top_points.num_found() != kMaxNumThreads || top_points.values[0] < top_points.values[1] ||
+      !std::equal(best_next_point_multithread.begin(), best_next_point_multithread.end(), top_points.points.begin())) {
+    ++total_errors;
+  }
 
   // best_next_point_multithread must be PRECISELY one of the points determined by single threaded runs
   double error[kMaxNumThreads*kMaxNumThreads];
@@ -2961,6 +5656,49 @@ int EvaluateEIAtPointListTest() {
     }
   }
 
+  // streaming latin hypercube search: same answer on 1 and 4 threads, inside the domain, analytic and MC
+  {
+    const int tile_size = 1000;
+    const UniformRandomGenerator uniform_generator_start(uniform_generator);
+    std::vector<double> streamed_best_point(dim*num_to_sample);
+    UniformRandomGenerator uniform_generator_streamed(uniform_generator_start);
+    ComputeOptimalPointsToSampleViaLatinHypercubeSearch(*mock_gp_data.gaussian_process_ptr, *mock_gp_data.domain_ptr,
+                                                        thread_schedule, points_being_sampled.data(),
+                                                        num_grid_search_points, num_to_sample, num_being_sampled,
+                                                        mock_gp_data.best_so_far, max_int_steps, &found_flag,
+                                                        &uniform_generator_streamed, normal_rng_vec.data(),
+                                                        streamed_best_point.data(), tile_size);
+    if (!found_flag || !mock_gp_data.domain_ptr->CheckPointInside(streamed_best_point.data())) {
+      ++total_errors;
+    }
+
+    std::vector<double> streamed_best_point_single_thread(dim*num_to_sample);
+    uniform_generator_streamed = uniform_generator_start;
+    ComputeOptimalPointsToSampleViaLatinHypercubeSearch(*mock_gp_data.gaussian_process_ptr, *mock_gp_data.domain_ptr,
+                                                        ThreadSchedule(1, omp_sched_static),
+                                                        points_being_sampled.data(), num_grid_search_points,
+                                                        num_to_sample, num_being_sampled, mock_gp_data.best_so_far,
+                                                        max_int_steps, &found_flag, &uniform_generator_streamed,
+                                                        normal_rng_vec.data(),
+                                                        streamed_best_point_single_thread.data(), tile_size);
+    if (streamed_best_point != streamed_best_point_single_thread) {
+      ++total_errors;
+    }
+
+    const int num_to_sample_mc = 2;
+    std::vector<double> streamed_best_point_mc(dim*num_to_sample_mc);
+    ComputeOptimalPointsToSampleViaLatinHypercubeSearch(*mock_gp_data.gaussian_process_ptr, *mock_gp_data.domain_ptr,
+                                                        thread_schedule, points_being_sampled.data(), 200,
+                                                        num_to_sample_mc, num_being_sampled,
+                                                        mock_gp_data.best_so_far, max_int_steps, &found_flag,
+                                                        &uniform_generator_streamed, normal_rng_vec.data(),
+                                                        streamed_best_point_mc.data(), 32);
+    if (!found_flag || !mock_gp_data.domain_ptr->CheckPointInside(streamed_best_point_mc.data()) ||
+        !mock_gp_data.domain_ptr->CheckPointInside(streamed_best_point_mc.data() + dim)) {
+      ++total_errors;
+    }
+  }
+
   delete [] gradients;
   return total_errors;
 }
@@ -114,6 +114,178 @@ enum class ExpectedImprovementEvaluationMode {
 // OL_WARN_UNUSED_RESULT int PingEIOnePotentialSampleTest();
 
 
+/*!\rst
+  Checks that adding points to a GP (incremental cholesky update) matches building the GP from scratch.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+ OL_WARN_UNUSED_RESULT int GaussianProcessAddPointsTest();
+
+/*!\rst
+  Checks that GPs sharing their training data match a GP built from the raw arrays, and that adding points to one of
+  them does not modify the shared data.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessSharedTrainingDataTest();
+
+/*!\rst
+  Checks that a GP updated in place (SetHyperparameters(), and AddPointsToGP() adopting caller-extended shared data)
+  matches a GP constructed from scratch with the final hyperparameters and data.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessInPlaceUpdateTest();
+
+/*!\rst
+  Checks that removing points from a GP (cholesky downdate), and the sliding window built on it, match a GP
+  constructed from scratch with the remaining points.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessRemovePointsTest();
+
+/*!\rst
+  Checks GaussianProcess::SetCholeskyJitter(): a duplicated noise-free point makes ``K`` singular, which throws
+  SingularMatrixException by default and is absorbed by a small, reported jitter when jitter is on.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessCholeskyJitterTest();
+
+/*!\rst
+  Checks GaussianProcess's reverse mode gradients (ComputeAdjointGrad*OfPoints()) against contractions of the forward
+  mode gradient tensors, with and without gradient observations.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessAdjointGradientTest();
+
+/*!\rst
+  Checks that GaussianProcess's value-only specializations (no gradient observations; see
+  GaussianProcess::IsValuesOnly()) match the generic derivative-aware paths.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessValuesOnlyTest();
+
+/*!\rst
+  Checks that a GaussianProcess holding its cholesky factor packed (SetPackedCholeskyStorage()) matches one holding it
+  square, through updates and refits.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessPackedCholeskyTest();
+
+/*!\rst
+  Checks that masked derivative observations (GaussianProcess::SetDerivativeMask()) drop out of the GP, through
+  updates.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GaussianProcessDerivativeMaskTest();
+
+/*!\rst
+  Checks the inducing-point (FITC) GaussianProcess: it must be exact (match the dense GP, including EI) when the
+  inducing points are the training points, and its in-place updates must refit against the training data.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int SparseGaussianProcessTest();
+
+/*!\rst
+  Checks the grid (Kronecker) GaussianProcess: it must match the dense GP over the same grid points (including EI), refit
+  on new hyperparameters, and turn into an ordinary GP when points are added or removed.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int GridGaussianProcessTest();
+
+/*!\rst
+  Checks that GaussianProcess::PredictMarginals() matches the mean and the diagonal of the variance computed through
+  PointsToSampleState, independent of the number of threads.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int PredictMarginalsTest();
+
+/*!\rst
+  Checks that OnePotentialSampleExpectedImprovementEvaluator::ComputeExpectedImprovementOfPoints() matches the
+  per-point analytic EI, independent of the number of threads, and that EvaluateEIAtPointList()'s 1,0-EI path uses it.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int OnePotentialSampleExpectedImprovementOfPointsTest();
+
+/*!\rst
+  Checks that refilling a PointsToSampleState whose trailing points did not move (so their ``Ks`` and ``K^-1 * Ks``
+  columns are kept) matches a freshly built state, through FillPointsToSampleState() and FillPointsToSampleStateBatch(),
+  and that changing the GP (hyperparameters, new points) invalidates the kept columns.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int PointsToSampleStateReuseTest();
+
+/*!\rst
+  Checks concurrent use of one shared (const) GaussianProcess: threads predicting mean, variance, and their gradients
+  (each with its own PointsToSampleState) get exactly the serial results, and GaussianProcessSampler objects sampling
+  from it in parallel draw exactly what GaussianProcess::SamplePointsFromGP() draws with the same seed.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int SharedGaussianProcessConcurrencyTest();
+
+/*!\rst
+  Checks the low-rank GaussianProcess::SamplePointsFromGP(): full-rank draws have the posterior mean and covariance,
+  truncated-rank draws keep the posterior variances, and GaussianProcessSampler matches the GP for a common seed.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int LowRankSamplePointsFromGPTest();
+
+/*!\rst
+  Checks that MonteCarloPrecision::kSingle EI and grad EI match MonteCarloPrecision::kDouble (same normals).
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int ExpectedImprovementSinglePrecisionTest();
+
+/*!\rst
+  Checks the adaptive MC mode of ExpectedImprovementEvaluator (AdaptiveMonteCarloParameters): the early-stopped
+  estimate is a prefix of the fixed-size one and meets its error target, pruning triggers below the threshold, and the
+  pruning EvaluateEIAtPointList() picks the same winner as the fixed-size screen with fewer draws.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int ExpectedImprovementAdaptiveMonteCarloTest();
+
+/*!\rst
+  Checks ComputeGradObjectiveFunctionBatch() of the EI evaluators against per-state gradients, and that
+  MultistartOptimizer::MultistartOptimizeBatch() matches MultistartOptimize() for 1,0-EI gradient descent.
+
+  \return
+    number of test failures: 0 if all is working well.
+\endrst*/
+OL_WARN_UNUSED_RESULT int ExpectedImprovementBatchGradientTest();
+
 /*!\rst
   Runs a battery of tests for the GP and EI functions, including ping tests for:
 
@@ -143,7 +315,8 @@ enum class ExpectedImprovementEvaluationMode {
 // OL_WARN_UNUSED_RESULT int RunEIConsistencyTests();
 
 /*!\rst
-  Checks that multithreaded EI optimization behaves the same way that single threaded does.
+  Checks that multithreaded EI optimization behaves the same way that single threaded does, and that the diverse top
+  points it returns (see DiverseTopPoints) are led by its result.
 
   \param
     :ei_mode: ei evaluation mode to test (analytic or monte carlo)
@@ -180,7 +353,7 @@ enum class ExpectedImprovementEvaluationMode {
 /*!\rst
   Tests EvaluateEIAtPointList (computes EI at a specified list of points, multithreaded).
   Checks that the returned best point is in fact the best.
-  Verifies multithreaded consistency.
+  Verifies multithreaded consistency, also of the streaming mode of ComputeOptimalPointsToSampleViaLatinHypercubeSearch().
 
   \return
     number of test failures: 0 if function evaluation is working properly
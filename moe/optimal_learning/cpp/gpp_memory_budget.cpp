@@ -0,0 +1,220 @@
+/*!
+  \file gpp_memory_budget.cpp
+  \rst
+  Implementations of the memory estimates and the process memory budget in gpp_memory_budget.hpp.
+
+  The byte counts mirror the buffers the evaluator states allocate (see PointsToSampleState,
+  ExpectedImprovementState, KnowledgeGradientState, and LogMarginalLikelihoodState); keep them in sync when those change.
+\endrst*/
+
+#include "gpp_memory_budget.hpp"
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "gpp_common.hpp"
+#include "gpp_optimization.hpp"
+
+// same default as gpp_model_selection.cpp: with OL_USE_INVERSE == 0, states also store every dK/dtheta_k
+#ifndef OL_USE_INVERSE
+#define OL_USE_INVERSE 1
+#endif
+
+namespace optimal_learning {
+
+namespace {
+
+//! 0 means no budget
+std::atomic<std::size_t> process_memory_budget(0);
+
+//! size of the MC blocks (normals, improvements) of ExpectedImprovementState
+constexpr std::size_t kExpectedImprovementMonteCarloBlockSize = 256;
+
+/*!\rst
+  Doubles held by a PointsToSampleState configured for gradients (``K_star``, ``V``, ``K^-1 * K_star``, and their
+  spatial gradients).
+
+  \param
+    :num_union: rows of ``K_star`` (the points being predicted, with their gradient observations)
+    :num_gradient_points: points whose spatial gradients are kept (0 if not configured for gradients)
+\endrst*/
+std::size_t PointsToSampleStateDoubles(std::size_t dim, std::size_t num_sampled_gradients, std::size_t num_union,
+                                       std::size_t num_gradient_points, std::size_t num_derivatives) noexcept {
+  return 3*num_union*num_sampled_gradients + 2*num_gradient_points*num_sampled_gradients*(1 + num_derivatives)*dim;
+}
+
+}  // end unnamed namespace
+
+MemoryEstimate EstimateExpectedImprovementMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                 int num_being_sampled, int max_num_threads) noexcept {
+  const std::size_t d = dim;
+  const std::size_t q = num_to_sample;
+  const std::size_t num_union = num_to_sample + num_being_sampled;
+  const std::size_t num_sampled_gradients = static_cast<std::size_t>(num_sampled)*(1 + num_derivatives);
+
+  std::size_t doubles = PointsToSampleStateDoubles(d, num_sampled_gradients, num_union, q, 0);
+  doubles += d*(1 + num_derivatives);  // grad_cov
+  doubles += 2*num_union*num_union;  // cholesky_to_sample_var and its adjoint
+  doubles += 2*num_union*kExpectedImprovementMonteCarloBlockSize;  // normals and improvements of one MC block
+  doubles += d*num_union + num_union + 2*d*q;  // union_of_points, to_sample_mean, grad_mu, aggregate
+
+  MemoryEstimate estimate;
+  estimate.shared_bytes = 0;
+  estimate.per_thread_bytes = sizeof(double)*doubles;
+  estimate.num_threads = max_num_threads;
+  return estimate;
+}
+
+MemoryEstimate EstimateExpectedImprovementMCMCMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                     int num_being_sampled, int num_mcmc_hypers,
+                                                     int max_num_threads) noexcept {
+  MemoryEstimate estimate = EstimateExpectedImprovementMemory(dim, num_sampled, num_derivatives, num_to_sample,
+                                                              num_being_sampled, max_num_threads);
+  estimate.per_thread_bytes *= static_cast<std::size_t>(std::max(num_mcmc_hypers, 1));
+  return estimate;
+}
+
+MemoryEstimate EstimateKnowledgeGradientMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                               int num_being_sampled, int num_pts, int num_mc_iterations,
+                                               bool discrete_inner_mode, int num_warm_starts,
+                                               std::size_t grad_memory_budget, int max_num_threads) noexcept {
+  const std::size_t d = dim;
+  const std::size_t q = num_to_sample;
+  const std::size_t g = num_derivatives;
+  const std::size_t num_union = num_to_sample + num_being_sampled;
+  const std::size_t num_union_gradients = num_union*(1 + g);
+  const std::size_t num_sampled_gradients = static_cast<std::size_t>(num_sampled)*(1 + g);
+  const std::size_t num_discrete = num_union + num_pts;
+  const std::size_t num_iterations = std::max(num_mc_iterations, 1);
+  const std::size_t num_warm = discrete_inner_mode ? 0 : std::max(num_warm_starts, 0);
+
+  std::size_t doubles = PointsToSampleStateDoubles(d, num_sampled_gradients, num_union_gradients, q, g);
+  doubles += 2*num_union_gradients*num_union_gradients;  // cholesky_to_sample_var and chol_adjoint
+  doubles += num_union_gradients*num_iterations;  // normals
+  doubles += (d + 2)*num_iterations;  // best_point, best_function_value, discrete_winner
+  doubles += num_sampled_gradients*num_union;  // discrete_K_star
+  doubles += num_discrete;  // discrete_mean
+  doubles += num_union_gradients*num_discrete;  // discrete_chol_inverse_cov
+  if (discrete_inner_mode) {
+    doubles += num_discrete*num_iterations;  // discrete_future_mean
+  } else {
+    doubles += d*num_warm*num_iterations;  // warm_start_points
+    doubles += num_iterations*((1 + d)*num_sampled_gradients + d*(1 + g));  // one inner (posterior mean) state each
+  }
+  // gradient MC blocks: chol_inverse_cov and cov_adjoint, as KnowledgeGradientState::GradMonteCarloBlockSize()
+  const std::size_t bytes_per_iteration = sizeof(double)*2*num_union_gradients;
+  const std::size_t block_size = std::max<std::size_t>(1, std::min<std::size_t>(
+      grad_memory_budget/std::max<std::size_t>(bytes_per_iteration, 1), num_iterations));
+  doubles += 2*block_size*num_union_gradients;
+
+  MemoryEstimate estimate;
+  // discretized points (and their non-fidelity copy), K(X, discrete_pts), and K^-1 * y's projection on them
+  estimate.shared_bytes = sizeof(double)*(2*d*num_pts + num_sampled_gradients*num_pts + num_pts);
+  estimate.per_thread_bytes = sizeof(double)*doubles;
+  estimate.num_threads = max_num_threads;
+  return estimate;
+}
+
+MemoryEstimate EstimateKnowledgeGradientMCMCMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                   int num_being_sampled, int num_pts, int num_mc_iterations,
+                                                   bool discrete_inner_mode, int num_warm_starts,
+                                                   std::size_t grad_memory_budget, int num_mcmc_hypers,
+                                                   int max_num_threads) noexcept {
+  MemoryEstimate estimate = EstimateKnowledgeGradientMemory(dim, num_sampled, num_derivatives, num_to_sample,
+                                                            num_being_sampled, num_pts, num_mc_iterations,
+                                                            discrete_inner_mode, num_warm_starts, grad_memory_budget,
+                                                            max_num_threads);
+  const std::size_t num_hypers = std::max(num_mcmc_hypers, 1);
+  estimate.shared_bytes *= num_hypers;
+  estimate.per_thread_bytes *= num_hypers;
+  return estimate;
+}
+
+MemoryEstimate EstimateLogLikelihoodMemory(int num_sampled, int num_derivatives, int num_hyperparameters,
+                                           bool uses_hessian, int max_num_threads) noexcept {
+  const std::size_t n = static_cast<std::size_t>(num_sampled)*(1 + num_derivatives);
+  const std::size_t num_hypers = num_hyperparameters;
+
+  std::size_t doubles = 2*n*n + 3*n;  // K_chol, the W = alpha*alpha^T - K^-1 temporary; K_inv_y, y_centered, scratch
+#if OL_USE_INVERSE == 0
+  doubles += num_hypers*n*n;  // grad_hyperparameter_cov_matrix
+#endif
+  if (uses_hessian) {
+    doubles += 2*num_hypers*n*n + 2*num_hypers*n;  // dK/dtheta_k and K^-1 * dK/dtheta_k * K^-1 * y, every k
+  }
+
+  MemoryEstimate estimate;
+  estimate.shared_bytes = 0;
+  estimate.per_thread_bytes = sizeof(double)*doubles;
+  estimate.num_threads = max_num_threads;
+  return estimate;
+}
+
+void SetProcessMemoryBudget(std::size_t num_bytes) noexcept {
+  process_memory_budget.store(num_bytes);
+}
+
+std::size_t GetProcessMemoryBudget() noexcept {
+  return process_memory_budget.load();
+}
+
+ThreadSchedule AdmitThreadSchedule(const ThreadSchedule& thread_schedule, const MemoryEstimate& estimate) noexcept {
+  const std::size_t budget = GetProcessMemoryBudget();
+  if (budget == 0) {
+    return thread_schedule;
+  }
+
+  const int requested_threads = thread_schedule.max_num_threads > 0 ? thread_schedule.max_num_threads :
+      omp_get_max_threads();
+  int num_threads = 1;
+  if (estimate.shared_bytes + estimate.per_thread_bytes > budget) {
+    OL_WARNING_PRINTF("WARNING: one thread needs %zu bytes, over the process memory budget of %zu; running serially.\n",
+                      estimate.shared_bytes + estimate.per_thread_bytes, budget);
+  } else if (estimate.per_thread_bytes == 0) {
+    num_threads = requested_threads;
+  } else {
+    const std::size_t max_fit = (budget - estimate.shared_bytes)/estimate.per_thread_bytes;
+    num_threads = static_cast<int>(std::min<std::size_t>(max_fit, requested_threads));
+  }
+
+  ThreadSchedule admitted(thread_schedule);
+  if (num_threads < requested_threads) {
+    admitted.max_num_threads = num_threads;
+  }
+  return admitted;
+}
+
+void AdmitKnowledgeGradientMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                  int num_being_sampled, int num_pts, int num_mc_iterations, bool discrete_inner_mode,
+                                  int num_warm_starts, int * max_num_threads,
+                                  std::size_t * grad_memory_budget) noexcept {
+  const std::size_t budget = GetProcessMemoryBudget();
+  if (budget == 0) {
+    return;
+  }
+
+  const int requested_threads = *max_num_threads > 0 ? *max_num_threads : omp_get_max_threads();
+  auto total_bytes = [&](std::size_t grad_budget) {
+    return EstimateKnowledgeGradientMemory(dim, num_sampled, num_derivatives, num_to_sample, num_being_sampled,
+                                           num_pts, num_mc_iterations, discrete_inner_mode, num_warm_starts,
+                                           grad_budget, requested_threads).total_bytes();
+  };
+
+  // halve the gradient MC block until the request fits; one iteration per block is the floor
+  const std::size_t min_grad_budget = sizeof(double)*2*(num_to_sample + num_being_sampled)*(1 + num_derivatives);
+  while (*grad_memory_budget > min_grad_budget && total_bytes(*grad_memory_budget) > budget) {
+    *grad_memory_budget = std::max(*grad_memory_budget/2, min_grad_budget);
+  }
+
+  const MemoryEstimate estimate = EstimateKnowledgeGradientMemory(dim, num_sampled, num_derivatives, num_to_sample,
+                                                                  num_being_sampled, num_pts, num_mc_iterations,
+                                                                  discrete_inner_mode, num_warm_starts,
+                                                                  *grad_memory_budget, requested_threads);
+  ThreadSchedule thread_schedule(*max_num_threads, omp_sched_auto, 0);
+  *max_num_threads = AdmitThreadSchedule(thread_schedule, estimate).max_num_threads;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,194 @@
+/*!
+  \file gpp_memory_budget.hpp
+  \rst
+  1. OVERVIEW
+  2. ESTIMATES
+  3. PROCESS MEMORY BUDGET
+
+  **1. OVERVIEW**
+
+  The multistart drivers give every thread its own evaluator state, and a state's buffers grow with the problem: a
+  q,p-KG state holds normals, best points, and inner optimization states for every MC iteration, plus covariances
+  against every training point and discretization point.  One oversized request (many MC iterations, a large ``q`` or
+  ``num_pts``, gradient observations) times dozens of threads can ask for tens of GB.
+
+  The Estimate*Memory() functions predict, from the same size parameters the drivers take, how much memory a call
+  allocates beyond the GaussianProcess(es) it is handed; SetProcessMemoryBudget() caps that.
+
+  **2. ESTIMATES**
+
+  Each estimate splits into ``shared_bytes`` (evaluator precomputations that all threads read, e.g., KG's covariance
+  of the training data with the discretized set) and ``per_thread_bytes`` (one thread's state, sized as the drivers
+  configure it: for gradients, with the GP's gradient observations).  Only the large buffers are counted; every
+  ``O(dim)`` or ``O(num_to_sample)`` scratch vector is left out, so estimates run a little low for tiny problems and
+  are accurate to a few percent once the sizes matter.
+
+  **3. PROCESS MEMORY BUDGET**
+
+  SetProcessMemoryBudget() sets a process-wide limit (0, the default, means none).  Under a budget, the EI, KG, and
+  log likelihood multistart drivers admit their request before building states: AdmitThreadSchedule() lowers the
+  number of threads until the estimate fits, and for KG AdmitKnowledgeGradientMemory() first shrinks the gradient's MC
+  block size (KnowledgeGradientEvaluator's ``grad_memory_budget``), which costs nothing in accuracy.  Neither ever goes
+  below one thread or one MC iteration per block: a request that does not fit even then runs serially (with a warning)
+  rather than failing.  Results do not depend on the thread count or block size (up to roundoff).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_HPP_
+
+#include <cstddef>
+
+#include "gpp_common.hpp"
+#include "gpp_optimization.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Predicted peak memory of one multistart driver call; see the file comments.
+\endrst*/
+struct MemoryEstimate {
+  //! bytes allocated once and read by every thread
+  std::size_t shared_bytes;
+  //! bytes of one thread's state(s)
+  std::size_t per_thread_bytes;
+  //! number of threads (states) the estimate is for
+  int num_threads;
+
+  //! ``shared_bytes + num_threads*per_thread_bytes``
+  std::size_t total_bytes() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return shared_bytes + static_cast<std::size_t>(num_threads)*per_thread_bytes;
+  }
+};
+
+/*!\rst
+  Memory of ComputeOptimalPointsToSampleViaMultistartGradientDescent() (q,p-EI by MC; ``num_to_sample = 1`` and
+  ``num_being_sampled = 0`` is the analytic case, which is estimated the same way and is tiny).
+
+  \param
+    :dim: spatial dimension
+    :num_sampled: number of points in the GaussianProcess
+    :num_derivatives: number of gradient observations per point in the GaussianProcess
+    :num_to_sample: "q" in q,p-EI
+    :num_being_sampled: "p" in q,p-EI
+    :max_num_threads: number of threads (states)
+  \return
+    the estimate
+\endrst*/
+MemoryEstimate EstimateExpectedImprovementMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                 int num_being_sampled, int max_num_threads) noexcept
+    OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Memory of the EI-MCMC driver: every thread holds one EI state per hyperparameter sample.
+
+  \param
+    :num_mcmc_hypers: number of hyperparameter samples (GaussianProcesses)
+    (all other parameters are as in EstimateExpectedImprovementMemory())
+  \return
+    the estimate
+\endrst*/
+MemoryEstimate EstimateExpectedImprovementMCMCMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                     int num_being_sampled, int num_mcmc_hypers,
+                                                     int max_num_threads) noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Memory of ComputeKGOptimalPointsToSampleViaMultistartGradientDescent() (q,p-KG by MC).
+
+  \param
+    :dim: spatial dimension
+    :num_sampled: number of points in the GaussianProcess
+    :num_derivatives: number of gradient observations per point in the GaussianProcess
+    :num_to_sample: "q" in q,p-KG
+    :num_being_sampled: "p" in q,p-KG
+    :num_pts: number of points in the discretized set
+    :num_mc_iterations: number of MC iterations (``max_int_steps``)
+    :discrete_inner_mode: true if the inner problem is solved on the discretized set only
+      (KnowledgeGradientInnerMode::kDiscrete); false for the drivers' gradient descent
+    :num_warm_starts: warm starts kept per MC iteration (ignored if ``discrete_inner_mode``)
+    :grad_memory_budget: KnowledgeGradientEvaluator's bytes per state for the gradient's MC blocks
+    :max_num_threads: number of threads (states)
+  \return
+    the estimate
+\endrst*/
+MemoryEstimate EstimateKnowledgeGradientMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                               int num_being_sampled, int num_pts, int num_mc_iterations,
+                                               bool discrete_inner_mode, int num_warm_starts,
+                                               std::size_t grad_memory_budget, int max_num_threads) noexcept
+    OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Memory of the KG-MCMC driver: one KG evaluator per hyperparameter sample, and every thread holds one KG state per
+  hyperparameter sample.
+
+  \param
+    :num_mcmc_hypers: number of hyperparameter samples (GaussianProcesses)
+    (all other parameters are as in EstimateKnowledgeGradientMemory())
+  \return
+    the estimate
+\endrst*/
+MemoryEstimate EstimateKnowledgeGradientMCMCMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                                   int num_being_sampled, int num_pts, int num_mc_iterations,
+                                                   bool discrete_inner_mode, int num_warm_starts,
+                                                   std::size_t grad_memory_budget, int num_mcmc_hypers,
+                                                   int max_num_threads) noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Memory of the log likelihood multistart drivers (MultistartGradientDescentHyperparameterOptimization() etc.).
+
+  \param
+    :num_sampled: number of training points
+    :num_derivatives: number of gradient observations per training point
+    :num_hyperparameters: covariance hyperparameters plus noise variances
+    :uses_hessian: true for MultistartNewtonHyperparameterOptimization(), whose hessian holds every ``\pderiv{K}{\theta_k}``
+    :max_num_threads: number of threads (states)
+  \return
+    the estimate
+\endrst*/
+MemoryEstimate EstimateLogLikelihoodMemory(int num_sampled, int num_derivatives, int num_hyperparameters,
+                                           bool uses_hessian, int max_num_threads) noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Sets the process-wide memory budget for the multistart drivers (see the file comments).  Thread-safe; calls already
+  admitted keep their configuration.
+
+  \param
+    :num_bytes: the budget; 0 for none (the default)
+\endrst*/
+void SetProcessMemoryBudget(std::size_t num_bytes) noexcept;
+
+//! the process-wide memory budget, in bytes; 0 if none
+std::size_t GetProcessMemoryBudget() noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Fits ``thread_schedule`` to the process memory budget: the largest number of threads, at most
+  ``thread_schedule.max_num_threads`` and at least 1, whose ``estimate`` fits.  Unchanged if there is no budget.
+
+  \param
+    :thread_schedule: the requested schedule
+    :estimate: the request's estimate; ``num_threads`` is ignored (the per-thread cost is what matters)
+  \return
+    ``thread_schedule`` with ``max_num_threads`` lowered as needed
+\endrst*/
+ThreadSchedule AdmitThreadSchedule(const ThreadSchedule& thread_schedule, const MemoryEstimate& estimate) noexcept
+    OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Fits a KG request to the process memory budget: shrinks ``grad_memory_budget`` (down to one MC iteration per block)
+  before lowering ``max_num_threads`` (down to 1).  Unchanged if there is no budget.
+
+  \param
+    :max_num_threads[1]: requested number of threads; <= 0 means OpenMP's default
+    :grad_memory_budget[1]: requested KnowledgeGradientEvaluator ``grad_memory_budget``
+    (all other parameters are as in EstimateKnowledgeGradientMemory())
+  \output
+    :max_num_threads[1]: admitted number of threads
+    :grad_memory_budget[1]: admitted ``grad_memory_budget``
+\endrst*/
+void AdmitKnowledgeGradientMemory(int dim, int num_sampled, int num_derivatives, int num_to_sample,
+                                  int num_being_sampled, int num_pts, int num_mc_iterations, bool discrete_inner_mode,
+                                  int num_warm_starts, int * max_num_threads,
+                                  std::size_t * grad_memory_budget) noexcept OL_NONNULL_POINTERS;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_HPP_
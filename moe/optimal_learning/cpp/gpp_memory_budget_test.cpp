@@ -0,0 +1,190 @@
+/*!
+  \file gpp_memory_budget_test.cpp
+  \rst
+  Routines to test the functions in gpp_memory_budget.cpp:
+
+  * the EI and log likelihood estimates match hand counts for a small problem,
+  * every estimate grows with the number of training points, and the MCMC estimates scale with the number of
+    hyperparameter samples,
+  * AdmitThreadSchedule() keeps the schedule without a budget, fits the thread count under one, and never goes below 1
+    thread, and
+  * AdmitKnowledgeGradientMemory() shrinks the gradient's MC block before the thread count.
+\endrst*/
+
+#include "gpp_memory_budget_test.hpp"
+
+#include <cstddef>
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_memory_budget.hpp"
+#include "gpp_optimization.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks EstimateExpectedImprovementMemory() and EstimateLogLikelihoodMemory() against hand counts and that every
+  estimate grows with ``num_sampled`` (and the MCMC ones with ``num_mcmc_hypers``).
+
+  \return
+    number of test failures
+\endrst*/
+int MemoryEstimateTest() {
+  int total_errors = 0;
+
+  // q = 2, p = 1 EI in dim 3 with 10 points: 3*3*10 (K_star etc.) + 2*2*10*3 (gradients) + 3 (grad_cov) + 2*9
+  // (cholesky, adjoint) + 2*3*256 (MC block) + 3*3 + 3 + 2*3*2 (union_of_points, mean, grad_mu, aggregate)
+  const MemoryEstimate ei_estimate = EstimateExpectedImprovementMemory(3, 10, 0, 2, 1, 4);
+  const std::size_t ei_doubles = 90 + 120 + 3 + 18 + 1536 + 9 + 3 + 12;
+  if (ei_estimate.shared_bytes != 0 || ei_estimate.per_thread_bytes != sizeof(double)*ei_doubles ||
+      ei_estimate.total_bytes() != 4*sizeof(double)*ei_doubles) {
+    OL_ERROR_PRINTF("EI estimate: %zu per thread, expected %zu\n", ei_estimate.per_thread_bytes,
+                    sizeof(double)*ei_doubles);
+    ++total_errors;
+  }
+
+  // 20 points, 3 hyperparameters: K_chol, W, 3 vectors; the hessian adds 2*3 matrices and 2*3 vectors
+  const MemoryEstimate ll_estimate = EstimateLogLikelihoodMemory(20, 0, 3, false, 2);
+  const MemoryEstimate newton_estimate = EstimateLogLikelihoodMemory(20, 0, 3, true, 2);
+  if (ll_estimate.per_thread_bytes < sizeof(double)*(2*400 + 60) ||
+      newton_estimate.per_thread_bytes != ll_estimate.per_thread_bytes + sizeof(double)*(6*400 + 6*20)) {
+    OL_ERROR_PRINTF("log likelihood estimate: %zu (newton %zu) per thread\n", ll_estimate.per_thread_bytes,
+                    newton_estimate.per_thread_bytes);
+    ++total_errors;
+  }
+
+  const std::size_t grad_memory_budget = static_cast<std::size_t>(64) << 20;
+  const MemoryEstimate kg_small = EstimateKnowledgeGradientMemory(3, 10, 0, 2, 1, 50, 100, false, 1,
+                                                                  grad_memory_budget, 4);
+  const MemoryEstimate kg_large = EstimateKnowledgeGradientMemory(3, 40, 0, 2, 1, 50, 100, false, 1,
+                                                                  grad_memory_budget, 4);
+  const MemoryEstimate kg_gradients = EstimateKnowledgeGradientMemory(3, 10, 3, 2, 1, 50, 100, false, 1,
+                                                                      grad_memory_budget, 4);
+  const MemoryEstimate kg_mcmc = EstimateKnowledgeGradientMCMCMemory(3, 10, 0, 2, 1, 50, 100, false, 1,
+                                                                     grad_memory_budget, 5, 4);
+  if (!(kg_large.per_thread_bytes > kg_small.per_thread_bytes && kg_large.shared_bytes > kg_small.shared_bytes &&
+        kg_gradients.per_thread_bytes > kg_small.per_thread_bytes) ||
+      kg_mcmc.per_thread_bytes != 5*kg_small.per_thread_bytes || kg_mcmc.shared_bytes != 5*kg_small.shared_bytes) {
+    OL_ERROR_PRINTF("KG estimates do not grow with the problem\n");
+    ++total_errors;
+  }
+
+  const MemoryEstimate ei_large = EstimateExpectedImprovementMemory(3, 40, 0, 2, 1, 4);
+  const MemoryEstimate ei_mcmc = EstimateExpectedImprovementMCMCMemory(3, 10, 0, 2, 1, 5, 4);
+  const MemoryEstimate ll_large = EstimateLogLikelihoodMemory(40, 0, 3, false, 2);
+  if (!(ei_large.per_thread_bytes > ei_estimate.per_thread_bytes &&
+        ll_large.per_thread_bytes > ll_estimate.per_thread_bytes) ||
+      ei_mcmc.per_thread_bytes != 5*ei_estimate.per_thread_bytes) {
+    OL_ERROR_PRINTF("EI/log likelihood estimates do not grow with the problem\n");
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks AdmitThreadSchedule() and AdmitKnowledgeGradientMemory() with no budget, a budget that fits a few threads,
+  and a budget below one thread.  Leaves the process budget unset.
+
+  \return
+    number of test failures
+\endrst*/
+int MemoryBudgetAdmissionTest() {
+  int total_errors = 0;
+  const std::size_t previous_budget = GetProcessMemoryBudget();
+
+  MemoryEstimate estimate;
+  estimate.shared_bytes = 1000;
+  estimate.per_thread_bytes = 100;
+  estimate.num_threads = 16;
+  const ThreadSchedule thread_schedule(16, omp_sched_dynamic, 2);
+
+  SetProcessMemoryBudget(0);
+  if (AdmitThreadSchedule(thread_schedule, estimate).max_num_threads != 16) {
+    OL_ERROR_PRINTF("no budget changed the thread count\n");
+    ++total_errors;
+  }
+
+  SetProcessMemoryBudget(1450);
+  const ThreadSchedule admitted = AdmitThreadSchedule(thread_schedule, estimate);
+  if (admitted.max_num_threads != 4 || admitted.schedule != omp_sched_dynamic || admitted.chunk_size != 2) {
+    OL_ERROR_PRINTF("admitted %d threads under the budget, expected 4\n", admitted.max_num_threads);
+    ++total_errors;
+  }
+
+  SetProcessMemoryBudget(500);
+  if (AdmitThreadSchedule(thread_schedule, estimate).max_num_threads != 1) {
+    OL_ERROR_PRINTF("an oversized request was not run serially\n");
+    ++total_errors;
+  }
+
+  // KG: 4 threads whose gradient blocks hold all 1000 MC iterations; a budget fitting 4 threads with 1 iteration per
+  // block shrinks the block and keeps the threads
+  const int dim = 3, num_sampled = 20, num_to_sample = 2, num_being_sampled = 1, num_pts = 30, num_iterations = 1000;
+  const std::size_t full_grad_budget = static_cast<std::size_t>(64) << 20;
+  const std::size_t min_grad_budget = sizeof(double)*2*(num_to_sample + num_being_sampled);
+  const MemoryEstimate kg_min = EstimateKnowledgeGradientMemory(dim, num_sampled, 0, num_to_sample, num_being_sampled,
+                                                                num_pts, num_iterations, false, 1, min_grad_budget, 4);
+  const MemoryEstimate kg_full = EstimateKnowledgeGradientMemory(dim, num_sampled, 0, num_to_sample,
+                                                                 num_being_sampled, num_pts, num_iterations, false, 1,
+                                                                 full_grad_budget, 4);
+  if (!(kg_min.total_bytes() < kg_full.total_bytes())) {
+    OL_ERROR_PRINTF("KG gradient block does not change the estimate\n");
+    ++total_errors;
+  }
+
+  int num_threads = 4;
+  std::size_t grad_memory_budget = full_grad_budget;
+  SetProcessMemoryBudget(kg_min.total_bytes());
+  AdmitKnowledgeGradientMemory(dim, num_sampled, 0, num_to_sample, num_being_sampled, num_pts, num_iterations, false, 1,
+                               &num_threads, &grad_memory_budget);
+  if (num_threads != 4 || grad_memory_budget >= full_grad_budget) {
+    OL_ERROR_PRINTF("KG admission: %d threads, grad budget %zu\n", num_threads, grad_memory_budget);
+    ++total_errors;
+  }
+
+  // half of that budget also needs fewer threads
+  num_threads = 4;
+  grad_memory_budget = full_grad_budget;
+  SetProcessMemoryBudget(kg_min.total_bytes()/2);
+  AdmitKnowledgeGradientMemory(dim, num_sampled, 0, num_to_sample, num_being_sampled, num_pts, num_iterations, false, 1,
+                               &num_threads, &grad_memory_budget);
+  if (num_threads >= 4 || num_threads < 1 || grad_memory_budget != min_grad_budget) {
+    OL_ERROR_PRINTF("KG admission (tight): %d threads, grad budget %zu\n", num_threads, grad_memory_budget);
+    ++total_errors;
+  }
+
+  SetProcessMemoryBudget(previous_budget);
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunMemoryBudgetTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = MemoryEstimateTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("memory estimates failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("memory estimates\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = MemoryBudgetAdmissionTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("memory budget admission failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("memory budget admission\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,25 @@
+/*!
+  \file gpp_memory_budget_test.hpp
+  \rst
+  Functions for testing gpp_memory_budget's functionality: the estimates match hand counts and grow with the problem
+  sizes, and a process memory budget lowers the thread count (and KG's gradient block size) without ever going to 0.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the memory budget tests.
+
+  \return
+    number of test failures: 0 if the estimates and admission are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunMemoryBudgetTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_MEMORY_BUDGET_TEST_HPP_
@@ -269,12 +269,11 @@
     This class contains member fucntions for computing the LOO-CV measure.  Its structure is essentially the same as
     LogMarginalLikelihoodEvaluator.  Its members require LeaveOneOutLogLikelihoodState, just as before.
 
-    In the discussion of LOO-CV, we indicated two possible methods to compute the quantities ``\mu_i, \sigma_i^2``.
-    Both are implemented in the code, although it is currently configured to use the faster computation:
-
-    * LeaveOneOutCoreAccurate() computes \mu_i, \sigma_i^2 the direct way by forming a new GP.  This is slow but well-conditioned.
-    * LeaveOneOutCoreWithMatrixInverse() computes \mu_i, \sigma_i^2 using the described "trick".  This is fast but the results
-      may be heavily affected by numerical error (if K is poorly conditioned).
+    ``\mu_i, \sigma_i^2`` come from the closed-form ``K^-1``-diagonal identities (Rasmussen & Williams 5.4.2; see
+    LeaveOneOutCoreWithMatrixInverse()) instead of ``N`` refits, so the likelihood costs one ``O(N^3)`` factorization and
+    inversion.  The gradient folds its ``K^-1 \pderiv{K}{\theta} K^-1`` diagonals into one weight matrix and then streams
+    ``\pderiv{K}{\theta}`` like the LML gradient, at ``O(N^2)`` per hyperparameter.  The explicit inverse may be affected by
+    numerical error if ``K`` is poorly conditioned.
 \endrst*/
 
 #include "gpp_model_selection.hpp"
@@ -282,11 +281,14 @@
 #include <cmath>
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
@@ -297,6 +299,7 @@
 #include "gpp_mock_optimization_objective_functions.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
 
 namespace optimal_learning {
 
@@ -315,46 +318,30 @@ namespace {  // utilities for building covariance matrix and its hyperparameter
   Point list cannot contain duplicates.  Doing so (or providing nearly duplicate points) can lead to
   semi-definite matrices or very poor numerical conditioning.
 
+  The hyperparameter-independent part of the work (squared coordinate differences) comes precomputed in
+  ``pairwise_differences``; see CovarianceInterface::SymmetricCovarianceMatrix().
+
   \param
     :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
-    :noise_variance[num_sampled]: i-th entry is amt of noise variance to add to i-th diagonal entry; i.e., noise measuring i-th point
-    :points_sampled[dim][num_sampled]: list of points
-    :dim: spatial dimension of a point
-    :num_sampled: number of points
+    :pairwise_differences: the list of points, ``X_i``, (and observed derivatives) with their cached squared differences
+    :noise_variance[num_derivatives+1]: m-th entry is amt of noise variance to add to the diagonal entries of the m-th
+      observation (function value, then each derivative) of every point
   \output
-    :cov_matrix[num_sampled*(length+1)][num_sampled*(length+1)]: computed covariance matrix
+    :cov_matrix[num_sampled*(num_derivatives+1)][num_sampled*(num_derivatives+1)]: computed covariance matrix
 \endrst*/
 OL_NONNULL_POINTERS void BuildCovarianceMatrixWithNoiseVariance(const CovarianceInterface& covariance,
-                                                                double const * restrict points_sampled,
-                                                                int dim, int num_sampled,
+                                                                const PairwiseDifferences& pairwise_differences,
                                                                 double const * restrict noise_variance,
-                                                                int const * derivatives,
-                                                                int num_derivatives,
                                                                 double * restrict cov_matrix) noexcept {
-    // we only work with lower triangular parts of symmetric matrices, so only fill half of it
-    double * cov_temp = new double [(num_derivatives+1)*(num_derivatives+1)]();
-    for (int i = 0; i < num_sampled; ++i) {//col
-        for (int j = i; j < num_sampled; ++j) {//row
-            covariance.Covariance(points_sampled + j*dim, derivatives, num_derivatives,
-                                  points_sampled + i*dim, derivatives, num_derivatives,
-                                  cov_temp);
-            for (int m = 0; m < num_derivatives+1; ++m){//col
-                for (int n = 0; n < num_derivatives+1; ++n){//row
-                    int row = j*(num_derivatives+1) + n;
-                    int col = i*(num_derivatives+1) + m;
-                    if (row>=col){
-                        cov_matrix[row + col*num_sampled*(num_derivatives+1)] = cov_temp[n];
-                    }
-                    if (row == col){
-                        cov_matrix[row + col*num_sampled*(num_derivatives+1)] += noise_variance[m];
-                    }
-                }
-                cov_temp += num_derivatives+1;
-            }
-            cov_temp -= Square(num_derivatives+1);
-        }
+  covariance.SymmetricCovarianceMatrix(pairwise_differences, cov_matrix);
+  const int num_derivatives = pairwise_differences.num_derivatives;
+  const int num_rows = pairwise_differences.num_points*(num_derivatives+1);
+  for (int i = 0; i < pairwise_differences.num_points; ++i) {
+    for (int m = 0; m < num_derivatives+1; ++m) {
+      const int row = i*(num_derivatives+1) + m;
+      cov_matrix[row + row*num_rows] += noise_variance[m];
     }
-    delete [] cov_temp;
+  }
 }
 
 /*!\rst
@@ -444,67 +431,209 @@ OL_NONNULL_POINTERS void BuildHyperparameterGradCovarianceMatrix(const Covarianc
 }
 
 /*!\rst
-  Builds ``A_{jikl} = \mixpderiv{K_{ij}}{\theta_k}{\theta_l}``, the Hessian matrix of the covariance function wrt the hyperparameters.
-  Hence the outer loop structure is identical to BuildCovarianceMatrix().
+  Zeroes the rows and columns of ``matrix`` that are not in ``observed_rows`` (the masked derivative observations; see
+  LogMarginalLikelihoodEvaluator::SetDerivativeMask()).  No-op if ``observed_rows`` is empty (nothing is masked).
 
-  Note the structure of the resulting tensor is ``Square(num_hyperparameters)`` blocks of size
-  ``num_sampled X num_sampled``.  Consumers of this want ``d^2K/(d\theta_k d\theta_l)`` located sequentially.
-  However, for a given pair of points ``(x, y)``, it is more efficient to compute all
-  hyperparameter derivatives at once.  Thus the innermost loop writes to all
-  num_hyperparameters blocks at once.
+  \param
+    :num_rows: dimension of ``matrix``
+    :observed_rows: observed rows, increasing
+    :matrix[num_rows][num_rows]: matrix to mask
+  \output
+    :matrix[num_rows][num_rows]: ``matrix`` with its masked rows and columns zeroed
+\endrst*/
+OL_NONNULL_POINTERS void ZeroMaskedRowsAndColumns(int num_rows, const std::vector<int>& observed_rows,
+                                                  double * restrict matrix) noexcept {
+  if (observed_rows.empty()) {
+    return;
+  }
+  std::vector<char> observed(num_rows, 0);
+  for (int row : observed_rows) {
+    observed[row] = 1;
+  }
+  for (int j = 0; j < num_rows; ++j) {
+    if (observed[j] == 0) {
+      std::fill(matrix + j*num_rows, matrix + (j+1)*num_rows, 0.0);
+      continue;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+      if (observed[i] == 0) {
+        matrix[i + j*num_rows] = 0.0;
+      }
+    }
+  }
+}
 
-  Consumers of this result generally require complete storage (i.e., will not take advantage
-  of its symmetry), so instead of ignoring the upper triangles, we copy them from the
-  (already-computed) lower triangles to avoid redundant work.
+/*!\rst
+  Builds and factors ``K`` and solves for ``K^-1 * (y - mean)``; shared by the log marginal and LOO-CV states.
 
-  Since CovarianceInterface.HyperparameterHessianCovariance() returns an array of size
-  ``Square(|\theta_k|)``, the inner loop writes all relevant entries of ``A_{jikl}`` simultaneously
-  to prevent recomputation.
+  ``K`` is the covariance matrix plus measurement noise and a ``10^{-6}`` jitter on the diagonal.  ``mean`` is the sample mean of
+  the function values (not the derivative observations), so it does not depend on the hyperparameters.
 
   \param
     :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
-    :points_sampled[dim][num_sampled]: list of points
-    :dim: spatial dimension of a point
-    :num_sampled: number of points
+    :pairwise_differences: the training points (and observed derivatives) with their cached squared differences
+    :noise_variance[num_derivatives+1]: noise variance of the function value, then of each observed derivative
+    :points_sampled_value[num_derivatives+1][num_sampled]: values (and observed derivatives) of the already-sampled points
+    :observed_rows: observed rows of ``K``, increasing; empty if every derivative is observed.  Only these rows are
+      factored; the others are decoupled (0 except for a unit diagonal in ``K_chol``) and 0 in ``y``, so they drop out
+      of every term of the likelihood.
   \output
-    :hessian_cov_matrix[num_sampled][num_sampled][n_hyper][n_hyper]: hessian of covariance matrix wrt hyperparameters
+    :K_chol[N][N]: cholesky factor (lower triangle) of ``K``, where ``N = num_sampled*(num_derivatives+1)``
+    :y[N]: points_sampled_value with the mean subtracted from each function value
+    :K_inv_y[N]: ``K^-1 * y``
 \endrst*/
-/*
-OL_NONNULL_POINTERS void BuildHyperparameterHessianCovarianceMatrix(const CovarianceInterface& covariance,
-                                                                    double const * restrict points_sampled,
-                                                                    int dim, int num_sampled,
-                                                                    double * restrict hessian_cov_matrix) noexcept {
-  const int num_hyperparameters = covariance.GetNumberOfHyperparameters();
-  const int offset = num_sampled*num_sampled;
+OL_NONNULL_POINTERS void BuildCenteredCovarianceSolve(const CovarianceInterface& covariance,
+                                                      const PairwiseDifferences& pairwise_differences,
+                                                      double const * restrict noise_variance,
+                                                      double const * restrict points_sampled_value,
+                                                      const std::vector<int>& observed_rows,
+                                                      double * restrict K_chol, double * restrict y,
+                                                      double * restrict K_inv_y) noexcept {
+  const int num_sampled = pairwise_differences.num_points;
+  const int num_derivatives = pairwise_differences.num_derivatives;
+  const int num_rows = num_sampled*(num_derivatives+1);
+  BuildCovarianceMatrixWithNoiseVariance(covariance, pairwise_differences, noise_variance, K_chol);
 
-  const int num_hessian_elem = Square(num_hyperparameters);
-  std::vector<double> hessian_hyperparameters(num_hessian_elem);
+  // Adding the variance of measurement noise to the covariance matrix
+  for (int i = 0; i < num_rows; i++) {
+    K_chol[i + i*num_rows] += 1.0e-6;
+  }
 
-  // pointer to row that we're copying from
-  double const * restrict hessian_cov_matrix_row = hessian_cov_matrix;
-  // operator is symmetric, so we compute just the lower triangle & copy into the upper triangle
+  // TODO(GH-211): Re-examine ignoring singular covariance matrices here
+  if (observed_rows.empty()) {
+    int OL_UNUSED(chol_info) = ComputeBlockCholeskyFactorL(num_rows, num_derivatives+1, K_chol);
+  } else {
+    const int num_observed = observed_rows.size();
+    std::vector<double> observed_chol(Square(num_observed));
+    GatherSymmetricSubmatrix(num_rows, K_chol, observed_rows.data(), num_observed, observed_chol.data());
+    int OL_UNUSED(chol_info) = ComputeCholeskyFactorL(num_observed, observed_chol.data());
+    ScatterSubmatrixCholeskyFactor(num_rows, observed_chol.data(), observed_rows.data(), num_observed, 1.0, K_chol);
+  }
+
+  // K_inv_y
+  double mean = 0.0;
+  for (int i = 0; i < num_sampled; ++i) {
+    mean += points_sampled_value[i*(num_derivatives+1)];
+  }
+  mean /= num_sampled;
+  std::copy(points_sampled_value, points_sampled_value + num_rows, y);
   for (int i = 0; i < num_sampled; ++i) {
-    for (int j = 0; j < i; ++j) {
-      for (int i_hyper = 0; i_hyper < num_hessian_elem; ++i_hyper) {
-        hessian_cov_matrix[i_hyper*offset + j] = hessian_cov_matrix_row[i_hyper*offset];
+    y[i*(num_derivatives+1)] -= mean;
+  }
+  if (!observed_rows.empty()) {
+    // masked derivatives carry no information (and may hold anything, e.g., NaN)
+    std::vector<double> y_observed(observed_rows.size());
+    for (int i = 0; i < static_cast<int>(observed_rows.size()); ++i) {
+      y_observed[i] = y[observed_rows[i]];
+    }
+    std::fill(y, y + num_rows, 0.0);
+    for (int i = 0; i < static_cast<int>(observed_rows.size()); ++i) {
+      y[observed_rows[i]] = y_observed[i];
+    }
+  }
+  std::copy(y, y + num_rows, K_inv_y);
+  CholeskyFactorLMatrixVectorSolve(K_chol, num_rows, K_inv_y);
+}
+
+/*!\rst
+  Computes ``W = \alpha\alpha^T - K^-1``, ``\alpha = K^-1 * y``, the weight of ``\pderiv{K}{\theta_k}`` in the gradient
+  (and hessian) of the log marginal likelihood.  With masked rows (see BuildCenteredCovarianceSolve()), only the
+  observed block of ``K^-1`` is formed (``O(num_observed^3)``) and the masked rows and columns of ``W`` are 0.
+
+  \param
+    :K_chol[N][N]: cholesky factor of ``K`` from BuildCenteredCovarianceSolve()
+    :alpha[N]: ``K^-1 * y``
+    :num_rows: ``N``
+    :observed_rows: observed rows of ``K``, increasing; empty if every derivative is observed
+  \output
+    :W[N][N]: ``\alpha\alpha^T - K^-1`` (full, symmetric), 0 in masked rows and columns
+\endrst*/
+OL_NONNULL_POINTERS void BuildLikelihoodGradientWeights(double const * restrict K_chol, double const * restrict alpha,
+                                                        int num_rows, const std::vector<int>& observed_rows,
+                                                        double * restrict W) noexcept {
+  if (observed_rows.empty()) {
+    SPDMatrixInverse(K_chol, num_rows, W);
+  } else {
+    const int num_observed = observed_rows.size();
+    std::vector<double> observed_chol(Square(num_observed));
+    std::vector<double> observed_inverse(Square(num_observed));
+    GatherSymmetricSubmatrix(num_rows, K_chol, observed_rows.data(), num_observed, observed_chol.data());
+    SPDMatrixInverse(observed_chol.data(), num_observed, observed_inverse.data());
+    std::fill(W, W + Square(num_rows), 0.0);
+    for (int j = 0; j < num_observed; ++j) {
+      for (int i = 0; i < num_observed; ++i) {
+        W[observed_rows[i] + observed_rows[j]*num_rows] = observed_inverse[i + j*num_observed];
       }
-      hessian_cov_matrix_row += num_sampled;
     }
-    hessian_cov_matrix_row -= i*num_sampled;
-    for (int j = i; j < num_sampled; ++j) {
-      // compute all hyperparameter derivs at once for efficiency
-      covariance.HyperparameterHessianCovariance(points_sampled + i*dim, points_sampled+j*dim,
-                                                 hessian_hyperparameters.data());
-      for (int i_hyper = 0; i_hyper < num_hessian_elem; ++i_hyper) {
-        // have to write each deriv to the correct block, due to the block structure of the output
-        hessian_cov_matrix[i_hyper*offset + j] = hessian_hyperparameters[i_hyper];
+  }
+  // masked entries of alpha are 0, so W stays 0 there
+  for (int j = 0; j < num_rows; ++j) {
+    for (int i = 0; i < num_rows; ++i) {
+      W[j*num_rows + i] = alpha[i]*alpha[j] - W[j*num_rows + i];
+    }
+  }
+}
+
+/*!\rst
+  Computes ``trace(W * \pderiv{K}{\theta_k}) = \sum_{ij} W_{ij} \pderiv{K_{ij}}{\theta_k}`` for every hyperparameter
+  (covariance hyperparameters, then noise variances) and a symmetric ``W``.
+
+  ``\pderiv{K}{\theta_k}`` is never stored: we stream over the lower triangle of point pairs, generating each pair's
+  ``[num_derivatives+1][num_derivatives+1]`` tile (for all hyperparameters at once) and folding it into the sum.  So this costs
+  ``O(n_hyper * N^2)`` time and ``O(1)`` extra memory.
+
+  \param
+    :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+    :points_sampled[dim][num_sampled]: list of points
+    :dim: spatial dimension of a point
+    :num_sampled: number of points
+    :derivatives[num_derivatives]: indices of the observed derivative components
+    :num_derivatives: number of observed derivative components
+    :W[N][N]: symmetric weight matrix, ``N = num_sampled*(num_derivatives+1)``
+  \output
+    :trace[n_hyper]: ``trace(W * \pderiv{K}{\theta_k})`` for each hyperparameter
+\endrst*/
+OL_NONNULL_POINTERS void StreamHyperparameterGradCovarianceTrace(const CovarianceInterface& covariance,
+                                                                 double const * restrict points_sampled,
+                                                                 int dim, int num_sampled,
+                                                                 int const * derivatives, int num_derivatives,
+                                                                 double const * restrict W,
+                                                                 double * restrict trace) noexcept {
+  const int num_covariance_hyperparameters = covariance.GetNumberOfHyperparameters();
+  const int block_size = num_derivatives+1;
+  const int num_rows = num_sampled*block_size;
+  std::vector<double> grad_covariance(num_covariance_hyperparameters*Square(block_size));
+  std::fill(trace, trace + num_covariance_hyperparameters + block_size, 0.0);
+  for (int i = 0; i < num_sampled; ++i) {  // col
+    for (int j = i; j < num_sampled; ++j) {  // row
+      covariance.HyperparameterGradCovariance(points_sampled + j*dim, derivatives, num_derivatives,
+                                              points_sampled + i*dim, derivatives, num_derivatives,
+                                              grad_covariance.data());
+      // off-diagonal tiles also stand in for their (unvisited) mirror image in the upper triangle
+      const double symmetry_factor = (i == j) ? 1.0 : 2.0;
+      for (int n = 0; n < block_size; ++n) {
+        for (int m = 0; m < block_size; ++m) {
+          const int row = j*block_size + m;
+          const int col = i*block_size + n;
+          const double weight = symmetry_factor*W[row + col*num_rows];
+          double const * restrict grad_covariance_ptr = grad_covariance.data() + (m + n*block_size)*num_covariance_hyperparameters;
+          for (int i_hyper = 0; i_hyper < num_covariance_hyperparameters; ++i_hyper) {
+            trace[i_hyper] += weight*grad_covariance_ptr[i_hyper];
+          }
+        }
       }
     }
-    hessian_cov_matrix += num_sampled;
-    hessian_cov_matrix_row += 1;
+  }
+
+  // the m-th noise hyperparameter's dK/d\theta is 1 on the diagonal entries of the m-th derivative block and 0 elsewhere
+  for (int i = 0; i < num_sampled; ++i) {
+    for (int m = 0; m < block_size; ++m) {
+      const int row = i*block_size + m;
+      trace[num_covariance_hyperparameters + m] += W[row + row*num_rows];
+    }
   }
 }
-*/
+
 }  // end unnamed namespace
 
 LogMarginalLikelihoodEvaluator::LogMarginalLikelihoodEvaluator(double const * restrict points_sampled_in,
@@ -517,7 +646,26 @@ LogMarginalLikelihoodEvaluator::LogMarginalLikelihoodEvaluator(double const * re
       num_derivatives_(num_derivatives_in),
       derivatives_(derivatives_in, derivatives_in + num_derivatives_in),
       points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
-      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + (num_derivatives_in+1)*num_sampled_in) {
+      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + (num_derivatives_in+1)*num_sampled_in),
+      pairwise_differences_(points_sampled_in, dim_in, num_sampled_in, derivatives_in, num_derivatives_in) {
+}
+
+void LogMarginalLikelihoodEvaluator::SetDerivativeMask(int const * restrict derivative_mask) {
+  derivative_mask_.clear();
+  observed_rows_.clear();
+  if (num_derivatives_ == 0) {
+    return;
+  }
+  derivative_mask_.resize(num_sampled_*num_derivatives_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    observed_rows_.push_back(i*(num_derivatives_+1));
+    for (int m = 0; m < num_derivatives_; ++m) {
+      derivative_mask_[i*num_derivatives_ + m] = derivative_mask[i*num_derivatives_ + m] != 0;
+      if (derivative_mask_[i*num_derivatives_ + m] != 0) {
+        observed_rows_.push_back(i*(num_derivatives_+1) + 1 + m);
+      }
+    }
+  }
 }
 
 void LogMarginalLikelihoodEvaluator::BuildHyperparameterGradCovarianceMatrix(
@@ -527,45 +675,19 @@ void LogMarginalLikelihoodEvaluator::BuildHyperparameterGradCovarianceMatrix(
                                                             log_likelihood_state->noise_variance.data(),
                                                             derivatives_.data(), num_derivatives_,
                                                             log_likelihood_state->grad_hyperparameter_cov_matrix.data());
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  for (int i_hyper = 0; i_hyper < log_likelihood_state->num_hyperparameters; ++i_hyper) {
+    ZeroMaskedRowsAndColumns(num_rows, observed_rows_,
+                             log_likelihood_state->grad_hyperparameter_cov_matrix.data() + i_hyper*Square(num_rows));
+  }
 }
 
-/*void LogMarginalLikelihoodEvaluator::BuildHyperparameterHessianCovarianceMatrix(
-    LogMarginalLikelihoodState * log_likelihood_state,
-    double * hessian_hyperparameter_cov_matrix) const noexcept {
-  optimal_learning::BuildHyperparameterHessianCovarianceMatrix(*log_likelihood_state->covariance_ptr,
-                                                               points_sampled_.data(), dim_, num_sampled_,
-                                                               hessian_hyperparameter_cov_matrix);
-}*/
 
 void LogMarginalLikelihoodEvaluator::FillLogLikelihoodState(LogMarginalLikelihoodState * log_likelihood_state) const {
-  // K_chol
-  optimal_learning::BuildCovarianceMatrixWithNoiseVariance(*log_likelihood_state->covariance_ptr, points_sampled_.data(),
-                                                           dim_, num_sampled_, log_likelihood_state->noise_variance.data(),
-                                                           derivatives_.data(), num_derivatives_, log_likelihood_state->K_chol.data());
-
-  // Adding the variance of measurement noise to the covariance matrix
-  for (int i = 0; i < num_sampled_ * (1+num_derivatives_); i++){
-     log_likelihood_state->K_chol[i + i*num_sampled_ * (1+num_derivatives_)] += 1.0e-6;
-  }
-
-  // TODO(GH-211): Re-examine ignoring singular covariance matrices here
-  int OL_UNUSED(chol_info) = ComputeCholeskyFactorL(num_sampled_*(num_derivatives_+1),
-                                                    log_likelihood_state->K_chol.data());
-
-  // K_inv_y
-  double mean_ = 0.0;
-  for (int i=0; i<num_sampled_; ++i){
-     mean_ += points_sampled_value_[i*(num_derivatives_+1)];
-  }
-  mean_ /= num_sampled_;
-  std::copy(points_sampled_value_.begin(), points_sampled_value_.end(), log_likelihood_state->y.begin());
-  std::copy(points_sampled_value_.begin(), points_sampled_value_.end(), log_likelihood_state->K_inv_y.begin());
-  for (int i=0; i<num_sampled_; ++i){
-    log_likelihood_state->K_inv_y[i*(num_derivatives_+1)] -= mean_;
-    log_likelihood_state->y[i*(num_derivatives_+1)] -= mean_;
-  }
-  CholeskyFactorLMatrixVectorSolve(log_likelihood_state->K_chol.data(), num_sampled_*(num_derivatives_+1),
-                                   log_likelihood_state->K_inv_y.data());
+  BuildCenteredCovarianceSolve(*log_likelihood_state->covariance_ptr, pairwise_differences_,
+                               log_likelihood_state->noise_variance.data(), points_sampled_value_.data(),
+                               observed_rows_, log_likelihood_state->K_chol.data(), log_likelihood_state->y.data(),
+                               log_likelihood_state->K_inv_y.data());
 }
 
 /*!\rst
@@ -605,8 +727,8 @@ double LogMarginalLikelihoodEvaluator::ComputeLogLikelihood(
   // term1 = y^T * K_inv_y
   double log_marginal_term1 = -0.5*DotProduct(log_likelihood_state.y.data(),
                                               log_likelihood_state.K_inv_y.data(), num_sampled_*(num_derivatives_+1));
-  // compute term3 = -\frac{n}{2} * \log(2*pi), where log(2*pi) has been precomputed
-  double log_marginal_term3 = -0.5*static_cast<double>(num_sampled_*(num_derivatives_+1))*kLog2Pi;
+  // compute term3 = -\frac{n}{2} * \log(2*pi), where log(2*pi) has been precomputed; masked rows are not observations
+  double log_marginal_term3 = -0.5*static_cast<double>(num_observed_rows())*kLog2Pi;
 
   return log_marginal_term1 + log_marginal_term2 + log_marginal_term3;
 }
@@ -624,25 +746,41 @@ double LogMarginalLikelihoodEvaluator::ComputeLogLikelihood(
     = \frac{1}{2} * trace([\alpha_i \alpha_j - K^{-1}_{ij}]*\pderiv{K_{ij}}{\theta_k}),
 
   where ``\alpha_i = K^{-1}_{ij} * y_j``
+
+  This second form is what we evaluate by default (``OL_USE_INVERSE == 1``): ``W = \alpha\alpha^T - K^{-1}`` is
+  formed ONCE from ``K_chol`` (``O(N^3)``, shared by all hyperparameters). Since ``W`` and every ``\pderiv{K}{\theta_k}``
+  are symmetric, ``trace(W * \pderiv{K}{\theta_k}) = \sum_{ij} W_{ij} \pderiv{K_{ij}}{\theta_k}``, so each gradient
+  entry costs ``O(N^2)`` (no matrix product, matrix-vector product, or solve). The sum is streamed: each point pair's
+  tile of ``\pderiv{K}{\theta_k}`` (all hyperparameters at once) is generated, accumulated, and discarded, so
+  peak memory is ``O(N^2)`` (``K_chol`` and ``W``) instead of ``O(n_hyper * N^2)``.
+
+  Building with ``OL_USE_INVERSE == 0`` instead stores every ``\pderiv{K}{\theta_k}``
+  (``state->grad_hyperparameter_cov_matrix``) and computes ``K^{-1} * \pderiv{K}{\theta_k}`` with triangular solves
+  for every hyperparameter. That never forms ``K^{-1}`` explicitly (see SPDMatrixInverse() for why that can lose
+  precision on badly conditioned ``K``) but costs ``O(N^3)`` per hyperparameter.
 \endrst*/
-#define OL_USE_INVERSE 0
+#ifndef OL_USE_INVERSE
+#define OL_USE_INVERSE 1
+#endif
 void LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood(LogMarginalLikelihoodState * log_likelihood_state,
                                                               double * restrict grad_log_marginal) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  const int num_hyperparameters = log_likelihood_state->num_hyperparameters;
 
 #if OL_USE_INVERSE == 1
-  std::vector<double> K_inv(num_sampled_*(num_derivatives_+1)*num_sampled_*(num_derivatives_+1));
-  SPDMatrixInverse(log_likelihood_state->K_chol.data(), num_sampled_, K_inv.data());
-#endif
-
-  // TODO(GH-156): is it more stable to compute:
-  //  tr(\alpha\alpha^T dK/d\theta) - tr( K \ dK/d\theta)
-  //  OR tr((\alpha\alpha^T - K^-1) dK/d\theta) (UNLIKELY...)
-  //  OR tr(\alpha\alpha^T dK/d\theta - K \ dK/d\theta)
-
+  // W := \alpha\alpha^T - K^-1, where \alpha = K^-1 * y (aka K_inv_y); symmetric and stored as a full matrix
+  std::vector<double> W(Square(num_rows));
+  BuildLikelihoodGradientWeights(log_likelihood_state->K_chol.data(), log_likelihood_state->K_inv_y.data(), num_rows,
+                                 observed_rows_, W.data());
+
+  // compute gradient as 0.5 * tr(W * dK/d\theta) = 0.5 * \sum_{ij} W_{ij} * (dK/d\theta)_{ij} (both are symmetric)
+  StreamHyperparameterGradCovarianceTrace(*log_likelihood_state->covariance_ptr, points_sampled_.data(), dim_, num_sampled_,
+                                          derivatives_.data(), num_derivatives_, W.data(), grad_log_marginal);
+  VectorScale(num_hyperparameters, 0.5, grad_log_marginal);
+#else
   BuildHyperparameterGradCovarianceMatrix(log_likelihood_state);
-
   double * restrict grad_hyperparameter_cov_matrix_ptr = log_likelihood_state->grad_hyperparameter_cov_matrix.data();
-  const int num_hyperparameters = log_likelihood_state->num_hyperparameters;
+
   // compute gradient  as 0.5 * \alpha^T * (dK/d\theta) * \alpha - 0.5 * tr(K^-1 * dK/d\theta)
   for (int i_hyper = 0; i_hyper < num_hyperparameters; ++i_hyper) {
     // grad_hyperparameter_cov_matrix for the i_hyper-th hyperparameter is not needed after the
@@ -651,149 +789,130 @@ void LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood(LogMarginalLikelih
     // computing 0.5 * \alpha^T * grad_hyperparameter_cov_matrix * \alpha, where \alpha = K^-1 * y (aka K_inv_y)
     // temp_vec := grad_hyperparameter_cov_matrix * K_inv_y
     GeneralMatrixVectorMultiply(grad_hyperparameter_cov_matrix_ptr, 'N', log_likelihood_state->K_inv_y.data(),
-                                1.0, 0.0, num_sampled_*(num_derivatives_+1), num_sampled_*(num_derivatives_+1),
-                                num_sampled_*(num_derivatives_+1), log_likelihood_state->temp_vec.data());
+                                1.0, 0.0, num_rows, num_rows, num_rows, log_likelihood_state->temp_vec.data());
     // could use dsymv here but it appears to be slightly slower in practice
     // SymmetricMatrixVectorMultiply(grad_hyperparameter_cov_matrix_ptr, K_inv_y.data(), num_sampled_, temp_vec.data());
     // computes 0.5 * K_inv_y^T * temp_vec
     grad_log_marginal[i_hyper] = 0.5*DotProduct(log_likelihood_state->K_inv_y.data(),
-                                                log_likelihood_state->temp_vec.data(), num_sampled_*(num_derivatives_+1));
+                                                log_likelihood_state->temp_vec.data(), num_rows);
 
     // compute -0.5 * tr(K^-1 * dK/d\theta)
-#if OL_USE_INVERSE == 1
-    // avoid performing the matrix product; only calculate terms needed for trace
-    grad_log_marginal[i_hyper] -= 0.5*TraceOfGeneralMatrixMatrixMultiply(K_inv.data(), grad_hyperparameter_cov_matrix_ptr,
-                                                                         num_sampled_*(num_derivatives_+1));
-#else
-    // avoid forming the matrix inverse explicitly; improves numerical accuracy
+    // avoid forming the matrix inverse explicitly
     // overwrites grad_hyperparameter_cov_matrix := K^-1 * grad_hyperparameter_cov_matrix
-    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_sampled_*(num_derivatives_+1),
-                                     num_sampled_*(num_derivatives_+1), grad_hyperparameter_cov_matrix_ptr);
-    grad_log_marginal[i_hyper] -= 0.5*MatrixTrace(grad_hyperparameter_cov_matrix_ptr, num_sampled_*(num_derivatives_+1));
-#endif
+    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_rows, num_rows,
+                                     grad_hyperparameter_cov_matrix_ptr);
+    grad_log_marginal[i_hyper] -= 0.5*MatrixTrace(grad_hyperparameter_cov_matrix_ptr, num_rows);
 
-    grad_hyperparameter_cov_matrix_ptr += Square(num_sampled_*(num_derivatives_+1));
+    grad_hyperparameter_cov_matrix_ptr += Square(num_rows);
   }
+#endif
 }
 
 /*!\rst
   Computes the Hessian matrix of the log (marginal) likelihood wrt the hyperparameters::
 
-    \mixpderiv{log(p(y | X, \theta_k))}{\theta_i}{\theta_j} =
-        (-\alpha * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j} * \alpha)
-      + (\alpha * \mixpderiv{K}{\theta_i}{\theta_j} * \alpha)
-      - 0.5 * tr(-K^-1 * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j} + K^-1 * \mixpderiv{K}{\theta_i}{\theta_j})
+    \mixpderiv{log(p(y | X, \theta))}{\theta_i}{\theta_j} =
+        - \alpha^T * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j} * \alpha
+        + \frac{1}{2} * tr(K^-1 * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j})
+        + \frac{1}{2} * tr([\alpha\alpha^T - K^-1] * \mixpderiv{K}{\theta_i}{\theta_j})
 
-  Note that as usual, ``K`` is the covariance matrix (bearing its own two indices, say ``K_{k,l}``) which are omitted here.
+  where ``\alpha = K^-1 * y``.  Note that as usual, ``K`` is the covariance matrix (bearing its own two indices, say
+  ``K_{k,l}``) which are omitted here.
 
   This expression arises from differentating each entry of the gradient (see function comments for
-  LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood for expression) of the log marginal wrt each hyperparameter.
-
-  We use the identity: ``\pderiv{K^-1}{X} = -K^-1 * \pderiv{K}{X} * K^-1``;
-  as well as the fact that ``\partial tr(A) = tr(\partial A)``.  That is, since trace is linear, the order can be interchanged
-  with the differential operator;
-  and the various symmetries of the gradient/hessians of K (see function declaration comments for details on symmetry).
+  LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood for expression) of the log marginal wrt each hyperparameter,
+  using the identity: ``\pderiv{K^-1}{X} = -K^-1 * \pderiv{K}{X} * K^-1`` and the fact that trace is linear.
+
+  The first two terms need every ``\pderiv{K}{\theta_i}`` (``O(n_hyper * N^2)`` memory) and ``K^-1 * \pderiv{K}{\theta_i}``,
+  formed with triangular solves (``O(N^3)`` per hyperparameter).  The last term is streamed exactly like the gradient in
+  ComputeGradLogLikelihood(): ``\alpha\alpha^T - K^-1`` and ``\mixpderiv{K}{\theta_i}{\theta_j}`` are symmetric, so the trace
+  is a sum over the lower triangle of point pairs, one ``[n_hyper][n_hyper]`` tile per derivative-block entry
+  (CovarianceInterface::HyperparameterHessianCovariance()); no ``n_hyper^2 * N^2`` tensor is stored.
+  The noise variances enter ``K`` linearly and separately from the covariance hyperparameters, so all of their mixed
+  second derivatives of ``K`` vanish.
 \endrst*/
-/*
 void LogMarginalLikelihoodEvaluator::ComputeHessianLogLikelihood(LogMarginalLikelihoodState * log_likelihood_state,
                                                                  double * restrict hessian_log_marginal) const noexcept {
-#if OL_USE_INVERSE == 1
-  std::vector<double> K_inv(num_sampled_*num_sampled_);
-  SPDMatrixInverse(log_likelihood_state->K_chol.data(), num_sampled_, K_inv.data());
-#endif
-
+  const int num_rows = num_sampled_*(num_derivatives_+1);
   const int num_hyperparameters = log_likelihood_state->num_hyperparameters;
-  std::vector<double> hessian_hyperparameter_cov_matrix(num_sampled_*num_sampled_*Square(num_hyperparameters));
-  BuildHyperparameterGradCovarianceMatrix(log_likelihood_state);
-  BuildHyperparameterHessianCovarianceMatrix(log_likelihood_state, hessian_hyperparameter_cov_matrix.data());
-
-  std::vector<double> grad_K_K_inv_y(num_sampled_*num_hyperparameters);
-  double * restrict grad_hyperparameter_cov_matrix_ptr = log_likelihood_state->grad_hyperparameter_cov_matrix.data();
-  // precompute some quantities relating to grad_hyperparameter_cov_matrix that we will need repeatedly
+  const CovarianceInterface& covariance = *log_likelihood_state->covariance_ptr;
+  const int num_covariance_hyperparameters = covariance.GetNumberOfHyperparameters();
+  const int block_size = num_derivatives_+1;
+  double const * restrict alpha = log_likelihood_state->K_inv_y.data();
+
+  // grad_K holds dK/d\theta_i; K_inv_grad_K holds K^-1 * dK/d\theta_i (one N x N block per hyperparameter)
+  std::vector<double> grad_K(num_hyperparameters*Square(num_rows));
+  optimal_learning::BuildHyperparameterGradCovarianceMatrix(covariance, points_sampled_.data(), dim_, num_sampled_,
+                                                            log_likelihood_state->noise_variance.data(),
+                                                            derivatives_.data(), num_derivatives_, grad_K.data());
   for (int i_hyper = 0; i_hyper < num_hyperparameters; ++i_hyper) {
-    // grad_K_K_inv_y stores |\theta_k| blocks, each block containing \pderiv{K}{\theta_k} * (K^-1 * y)
-    // where K^-1*y has been precomputed in K_inv_y
-    GeneralMatrixVectorMultiply(grad_hyperparameter_cov_matrix_ptr, 'N', log_likelihood_state->K_inv_y.data(),
-                                1.0, 0.0, num_sampled_, num_sampled_, num_sampled_,
-                                grad_K_K_inv_y.data() + i_hyper*num_sampled_);
+    ZeroMaskedRowsAndColumns(num_rows, observed_rows_, grad_K.data() + i_hyper*Square(num_rows));
+  }
+  std::vector<double> K_inv_grad_K(grad_K);
+  // grad_K_alpha holds dK/d\theta_i * \alpha; K_inv_grad_K_alpha holds K^-1 * dK/d\theta_i * \alpha
+  std::vector<double> grad_K_alpha(num_hyperparameters*num_rows);
+  std::vector<double> K_inv_grad_K_alpha(num_hyperparameters*num_rows);
+  for (int i_hyper = 0; i_hyper < num_hyperparameters; ++i_hyper) {
+    double * restrict K_inv_grad_K_ptr = K_inv_grad_K.data() + i_hyper*Square(num_rows);
+    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_rows, num_rows, K_inv_grad_K_ptr);
+    GeneralMatrixVectorMultiply(grad_K.data() + i_hyper*Square(num_rows), 'N', alpha, 1.0, 0.0,
+                                num_rows, num_rows, num_rows, grad_K_alpha.data() + i_hyper*num_rows);
+    GeneralMatrixVectorMultiply(K_inv_grad_K_ptr, 'N', alpha, 1.0, 0.0, num_rows, num_rows, num_rows,
+                                K_inv_grad_K_alpha.data() + i_hyper*num_rows);
+  }
 
-    // previous line is the only other use of grad_hyperparameter_cov_matrix, so we can safely overwite each block with
-    // K^-1 * grad_hyperparameter_cov_matrix
-    // as usual, do not form K^-1 explicitly
-    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_sampled_, num_sampled_,
-                                     grad_hyperparameter_cov_matrix_ptr);
-    grad_hyperparameter_cov_matrix_ptr += Square(num_sampled_);
+  // first two terms; the hessian is symmetric so compute the lower triangle and mirror it
+  for (int j_hyper = 0; j_hyper < num_hyperparameters; ++j_hyper) {
+    double const * restrict K_inv_grad_K_j = K_inv_grad_K.data() + j_hyper*Square(num_rows);
+    for (int i_hyper = j_hyper; i_hyper < num_hyperparameters; ++i_hyper) {
+      double const * restrict K_inv_grad_K_i = K_inv_grad_K.data() + i_hyper*Square(num_rows);
+      // tr(A * B) = \sum_{rs} A_{rs} * B_{sr}; only the diagonal of the product is needed
+      double trace = 0.0;
+      for (int col = 0; col < num_rows; ++col) {
+        for (int row = 0; row < num_rows; ++row) {
+          trace += K_inv_grad_K_i[row + col*num_rows]*K_inv_grad_K_j[col + row*num_rows];
+        }
+      }
+      const double entry = -DotProduct(grad_K_alpha.data() + i_hyper*num_rows,
+                                       K_inv_grad_K_alpha.data() + j_hyper*num_rows, num_rows) + 0.5*trace;
+      hessian_log_marginal[i_hyper + j_hyper*num_hyperparameters] = entry;
+      hessian_log_marginal[j_hyper + i_hyper*num_hyperparameters] = entry;
+    }
   }
 
-  double * restrict hessian_hyperparameter_cov_matrix_ptr = hessian_hyperparameter_cov_matrix.data();
-  double * restrict hessian_log_marginal_ptr = hessian_log_marginal;
-  double const * restrict hessian_log_marginal_row = hessian_log_marginal;
-  // now compute the hessian of the log marginal: \mixpderiv{log(p(y | X, \theta_k))}{\theta_i}{\theta_j}
-  // the matrix is symmetric so we compute the lower triangle and copy into the upper triangle
-  // see BuildHyperparameter.*Matrix() functions for simpler examples of this
-  for (int i_hyper = 0; i_hyper < num_hyperparameters; ++i_hyper) {
-    for (int j_hyper = 0; j_hyper < i_hyper; ++j_hyper) {
-      hessian_log_marginal_ptr[j_hyper] = hessian_log_marginal_row[0];
-      hessian_log_marginal_row += num_hyperparameters;
+  // W := \alpha\alpha^T - K^-1, as in ComputeGradLogLikelihood()
+  std::vector<double> W(Square(num_rows));
+  BuildLikelihoodGradientWeights(log_likelihood_state->K_chol.data(), alpha, num_rows, observed_rows_, W.data());
+
+  // last term: 0.5 * \sum_{rs} W_{rs} * (d^2K/d\theta_i d\theta_j)_{rs}, streamed over point pairs (covariance hypers only)
+  const int hessian_size = Square(num_covariance_hyperparameters);
+  std::vector<double> hessian_covariance(hessian_size*Square(block_size));
+  std::vector<double> hessian_trace(hessian_size, 0.0);
+  for (int i = 0; i < num_sampled_; ++i) {  // col
+    for (int j = i; j < num_sampled_; ++j) {  // row
+      covariance.HyperparameterHessianCovariance(points_sampled_.data() + j*dim_, derivatives_.data(), num_derivatives_,
+                                                 points_sampled_.data() + i*dim_, derivatives_.data(), num_derivatives_,
+                                                 hessian_covariance.data());
+      // off-diagonal tiles also stand in for their (unvisited) mirror image in the upper triangle
+      const double symmetry_factor = (i == j) ? 1.0 : 2.0;
+      for (int n = 0; n < block_size; ++n) {
+        for (int m = 0; m < block_size; ++m) {
+          const double weight = symmetry_factor*W[(j*block_size + m) + (i*block_size + n)*num_rows];
+          double const * restrict hessian_covariance_ptr = hessian_covariance.data() + (m + n*block_size)*hessian_size;
+          for (int k = 0; k < hessian_size; ++k) {
+            hessian_trace[k] += weight*hessian_covariance_ptr[k];
+          }
+        }
+      }
     }
-    hessian_log_marginal_row -= i_hyper*num_hyperparameters;
-    hessian_hyperparameter_cov_matrix_ptr += i_hyper*Square(num_sampled_);
-
-    for (int j_hyper = i_hyper; j_hyper < num_hyperparameters; ++j_hyper) {
-      // (-\alpha * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j} * \alpha)
-      // view this as -\beta_i * K^-1 * \beta_j, where \beta_i = \pderiv{K}{\theta_j} * \alpha
-      //  is precomputed in grad_K_K_inv_y
-      // Note: since K^-1 is symmetric (SPD in fact), we equivalently compute -\beta_j * K^-1 * \beta_i
-
-      // TODO(GH-185): the first step computes K^-1 * \beta_i, which is constant over j_hyper and should be lifted out
-      // of this loop. OR this whole block computing -\beta_j * K^-1 * \beta_i should be split into a separate loop over j_hyper.
-      std::copy(grad_K_K_inv_y.data() + i_hyper*num_sampled_, grad_K_K_inv_y.data() + (i_hyper+1)*num_sampled_,
-                log_likelihood_state->temp_vec.data());
-      CholeskyFactorLMatrixVectorSolve(log_likelihood_state->K_chol.data(), num_sampled_,
-                                       log_likelihood_state->temp_vec.data());
-      hessian_log_marginal_ptr[j_hyper] = -DotProduct(grad_K_K_inv_y.data() + j_hyper*num_sampled_,
-                                                      log_likelihood_state->temp_vec.data(), num_sampled_);
-
-      // (\alpha * \mixpderiv{K}{\theta_i}{\theta_j} * \alpha)
-      // mixed deriv term has already been computed, so we first multiply by \alpha
-      GeneralMatrixVectorMultiply(hessian_hyperparameter_cov_matrix_ptr, 'N', log_likelihood_state->K_inv_y.data(),
-                                  1.0, 0.0, num_sampled_, num_sampled_, num_sampled_,
-                                  log_likelihood_state->temp_vec.data());
-      // and then dot the result with \alpha
-      hessian_log_marginal_ptr[j_hyper] += 0.5*DotProduct(log_likelihood_state->K_inv_y.data(),
-                                                          log_likelihood_state->temp_vec.data(), num_sampled_);
-
-      // 0.5*tr(K^-1 * \pderiv{K}{\theta_i} * K^-1 * \pderiv{K}{\theta_j})
-      // note that since tr(A) = tr(A^T), the order of multiplication is irrelevant
-      // we do not need to form the full matrix product first, since only the diagonal of that result is required
-      // finally, recall that grad_hyperparameter_cov_matrix has already been premultiplied by K^-1
-      hessian_log_marginal_ptr[j_hyper] += 0.5*TraceOfGeneralMatrixMatrixMultiply(
-          log_likelihood_state->grad_hyperparameter_cov_matrix.data() + i_hyper*Square(num_sampled_),
-          log_likelihood_state->grad_hyperparameter_cov_matrix.data() + j_hyper*Square(num_sampled_),
-          num_sampled_);
-
-      // - 0.5 * tr(K^-1 * \mixpderiv{K}{\theta_i}{\theta_j})
-#if OL_USE_INVERSE == 1
-      // avoid performing the matrix product (as in previous trace step); only calculate terms needed for trace
-      hessian_log_marginal_ptr[j_hyper] -= 0.5*TraceOfGeneralMatrixMatrixMultiply(
-          K_inv.data(),
-          hessian_hyperparameter_cov_matrix_ptr,
-          num_sampled_);
-#else
-      // overwrites i,j-th block of hessian_hyperparameter_cov_matrix, which we do not need anymore
-      // for maximum numerical stability, we form K^-1*\mixpderiv{K}{\theta_i}{\theta_j} explicitly using backsolves first
-      // then take the trace of the resulting matrix
-      CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_sampled_, num_sampled_,
-                                       hessian_hyperparameter_cov_matrix_ptr);
-      hessian_log_marginal_ptr[j_hyper] -= 0.5*MatrixTrace(hessian_hyperparameter_cov_matrix_ptr, num_sampled_);
-#endif
-      hessian_hyperparameter_cov_matrix_ptr += Square(num_sampled_);
+  }
+  for (int j_hyper = 0; j_hyper < num_covariance_hyperparameters; ++j_hyper) {
+    for (int i_hyper = 0; i_hyper < num_covariance_hyperparameters; ++i_hyper) {
+      hessian_log_marginal[i_hyper + j_hyper*num_hyperparameters] +=
+          0.5*hessian_trace[i_hyper + j_hyper*num_covariance_hyperparameters];
     }
-    hessian_log_marginal_ptr += num_hyperparameters;
-    hessian_log_marginal_row += 1;
   }
 }
-*/
 
 void LogMarginalLikelihoodState::SetHyperparameters(const EvaluatorType& log_likelihood_eval,
                                                     double const * restrict hyperparameters) {
@@ -810,6 +929,24 @@ void LogMarginalLikelihoodState::SetHyperparameters(const EvaluatorType& log_lik
   log_likelihood_eval.FillLogLikelihoodState(this);
 }
 
+namespace {
+
+/*!\rst
+  ``state->grad_hyperparameter_cov_matrix`` is only read when ComputeGradLogLikelihood() is built with
+  ``OL_USE_INVERSE == 0``; the default build streams ``\pderiv{K}{\theta_k}`` and leaves it empty.
+\endrst*/
+int GradHyperparameterCovMatrixSize(int num_hyperparameters, int num_rows) noexcept {
+#if OL_USE_INVERSE == 1
+  (void) num_hyperparameters;
+  (void) num_rows;
+  return 0;
+#else
+  return num_hyperparameters*Square(num_rows);
+#endif
+}
+
+}  // end unnamed namespace
+
 void LogMarginalLikelihoodState::SetupState(const EvaluatorType& log_likelihood_eval,
                                             double const * restrict hyperparameters) {
   if (unlikely(num_sampled != log_likelihood_eval.num_sampled()) || unlikely(num_derivatives != log_likelihood_eval.num_derivatives())) {
@@ -819,7 +956,8 @@ void LogMarginalLikelihoodState::SetupState(const EvaluatorType& log_likelihood_
     K_chol.resize(Square(num_sampled*(num_derivatives+1)));
     K_inv_y.resize(num_sampled*(num_derivatives+1));
     y.resize(num_sampled*(num_derivatives+1));
-    grad_hyperparameter_cov_matrix.resize(num_hyperparameters*Square(num_sampled*(num_derivatives+1)));
+    grad_hyperparameter_cov_matrix.resize(GradHyperparameterCovMatrixSize(num_hyperparameters,
+                                                                          num_sampled*(num_derivatives+1)));
     temp_vec.resize(num_sampled*(num_derivatives+1));
   }
 
@@ -839,7 +977,7 @@ LogMarginalLikelihoodState::LogMarginalLikelihoodState(const EvaluatorType& log_
       K_chol(Square(num_sampled*(num_derivatives+1))),
       K_inv_y(num_sampled*(num_derivatives+1)),
       y(num_sampled*(num_derivatives+1)),
-      grad_hyperparameter_cov_matrix(num_hyperparameters*Square(num_sampled*(num_derivatives+1))),
+      grad_hyperparameter_cov_matrix(GradHyperparameterCovMatrixSize(num_hyperparameters, num_sampled*(num_derivatives+1))),
       temp_vec(num_sampled*(num_derivatives+1)) {
   std::vector<double> hyperparameters(num_hyperparameters);
   covariance_ptr->GetHyperparameters(hyperparameters.data());
@@ -851,295 +989,262 @@ LogMarginalLikelihoodState::LogMarginalLikelihoodState(const EvaluatorType& log_
 
 LogMarginalLikelihoodState::LogMarginalLikelihoodState(LogMarginalLikelihoodState&& OL_UNUSED(other)) = default;
 
-//namespace {  // utilities for Leave One Out log pseudo-likelihood computations
-//
-///*!\rst
-//  Computes ``\sigma^2_i(X_{-i}, \theta), \mu_i(X_{-i}, y_{-i}, \theta)``,
-//  where ``X_{-i}`` and ``y_{-i}`` are the training data with the ``i``-th point removed.  Then ``X_i`` is taken as the point to sample.
-//  ``\sigma_i^2`` and ``\mu_i`` are the GP (predicted) variance/mean at the point to sample.
-//
-//  This function builds ``X_{-i}, y_{-i}, \sigma_n^2_{-i}``, and ``X_i``, then computes the GP (predictive) mean/variance.
-//
-//  \param
-//    :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
-//    :points_sampled[dim][num_sampled]: points that have already been sampled
-//    :points_sampled_value[num_sampled]: values of the already-sampled points
-//    :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
-//    :num_sampled: number of already-sampled points
-//    :index: ``i``, the index of the point to leave out
-//  \output
-//    :mean[1]: the GP mean evaluated at ``X_i, y_i``
-//    :variance[1]: the GP variance evaluated at ``X_i``
-//\endrst*/
-//OL_NONNULL_POINTERS void LeaveOneOutCoreAccurate(const CovarianceInterface& covariance,
-//                                                 double const * restrict noise_variance,
-//                                                 double const * restrict points_sampled,
-//                                                 double const * restrict points_sampled_value,
-//                                                 int dim, int num_sampled, int index,
-//                                                 double * restrict mean, double * restrict variance) noexcept {
-//  // strip out index-th training point, value
-//  std::vector<double> point_to_sample(points_sampled + index*dim, points_sampled + (index+1)*dim);
-//  const int num_to_sample = 1;
-//  std::vector<double> points_sampled_loo((num_sampled-1)*dim);
-//  std::copy(points_sampled, points_sampled + index*dim, points_sampled_loo.begin());
-//  std::copy(points_sampled + (index+1)*dim, points_sampled + num_sampled*dim,
-//            points_sampled_loo.begin() + index*dim);
-//
-//  std::vector<double> points_sampled_value_loo(num_sampled-1);
-//  std::copy(points_sampled_value, points_sampled_value + index, points_sampled_value_loo.begin());
-//  std::copy(points_sampled_value + (index+1), points_sampled_value + num_sampled,
-//            points_sampled_value_loo.begin() + index);
-//
-//  std::vector<double> noise_variance_loo(num_sampled-1);
-//  std::copy(noise_variance, noise_variance + index, noise_variance_loo.begin());
-//  std::copy(noise_variance + (index+1), noise_variance + num_sampled, noise_variance_loo.begin() + index);
-//
-//  // TODO(GH-191): Update the GP by removing one point. Each GP build is O(N_{sampled}^3) and we do it
-//  // N_{sampled} times. This would instead be N applications of an O(N^2) transformation to the covariance matrix,
-//  // available through LeaveOneOutLogLikelihoodState.
-//  GaussianProcess gaussian_process(covariance, points_sampled_loo.data(), points_sampled_value_loo.data(),
-//                                   noise_variance_loo.data(), dim, num_sampled - 1);
-//  int num_derivatives = 0;
-//  GaussianProcess::StateType points_to_sample_state(gaussian_process, point_to_sample.data(), num_to_sample,
-//                                                    num_derivatives);
-//  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean);
-//  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, variance);
-//}
-//
-///*!\rst
-//  Computes ``\sigma^2_i(X_{-i}, \theta), \mu_i(X_{-i}, y_{-i}, \theta)``,
-//  where ``X_{-i}`` and ``y_{-i}`` are the training data with the ``i``-th point removed.  Then ``X_i`` is taken as the point to sample.
-//  ``\sigma_i^2`` and ``\mu_i`` are the GP (predicted) variance/mean at the point to sample.
-//
-//  By exploiting the properties of the inverse of the covariance matrix, we can compute:
-//
-//  * ``\mu_i = y_i - (K^-1 * y)/(K^-1)_ii``
-//  * ``\sigma^2_i = 1/(K^-1)_ii``
-//
-//  Note that ``(K^-1)_ii`` denotes the ``i``-th diagonal entry of the inverse of ``K``.
-//
-//  See Rasmussen & Williams 5.4.2 for details.
-//
-//  This operation is potentially ill-conditioned but the computation is *very* fast compared to LeaveOneOutCoreAccurate().
-//  Thus we should use this unless a loss of precision is feared.
-//
-//  \param
-//    :K_inv[num_sampled]: i-th column of inverse of the covariance matrix over all training points ``X``
-//    :K_inv_y[num_sampled]: ``K^-1 * y``
-//    :points_sampled_value[num_sampled]: y, values of the already-sampled points
-//    :index: ``i``, the index of the point to leave out
-//  \output
-//    :mean[1]: the GP mean evaluated at ``X_i, y_i``
-//    :variance[1]: the GP variance evaluated at ``X_i``
-//\endrst*/
-//OL_NONNULL_POINTERS void LeaveOneOutCoreWithMatrixInverse(double const * restrict K_inv,
-//                                                          double const * restrict K_inv_y,
-//                                                          double const * restrict points_sampled_value,
-//                                                          int index, double * restrict mean,
-//                                                          double * restrict variance) noexcept {
-//  *mean = points_sampled_value[index] - K_inv_y[index]/K_inv[index];
-//  *variance = 1.0/K_inv[index];
-//}
-//
-//}  // end unnamed namespace
-//
-//LeaveOneOutLogLikelihoodEvaluator::LeaveOneOutLogLikelihoodEvaluator(double const * restrict points_sampled_in,
-//                                                                     double const * restrict points_sampled_value_in,
-//                                                                     double const * restrict noise_variance_in,
-//                                                                     int dim_in, int num_sampled_in)
-//    : dim_(dim_in),
-//      num_sampled_(num_sampled_in),
-//      points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
-//      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + num_sampled_in),
-//      noise_variance_(noise_variance_in, noise_variance_in + num_sampled_) {
-//}
-//
-//void LeaveOneOutLogLikelihoodEvaluator::BuildHyperparameterGradCovarianceMatrix(
-//    LeaveOneOutLogLikelihoodState * log_likelihood_state) const noexcept {
-//  optimal_learning::BuildHyperparameterGradCovarianceMatrix(*log_likelihood_state->covariance_ptr,
-//                                                            points_sampled_.data(), dim_, num_sampled_,
-//                                                            log_likelihood_state->grad_hyperparameter_cov_matrix.data());
-//}
-//
-//void LeaveOneOutLogLikelihoodEvaluator::FillLogLikelihoodState(
-//    LeaveOneOutLogLikelihoodState * log_likelihood_state) const {
-//  // K_chol
-//  optimal_learning::BuildCovarianceMatrixWithNoiseVariance(*log_likelihood_state->covariance_ptr,
-//                                                           noise_variance_.data(), points_sampled_.data(),
-//                                                           dim_, num_sampled_, log_likelihood_state->K_chol.data());
-//  // TODO(GH-211): Re-examine ignoring singular covariance matrices here
-//  int OL_UNUSED(chol_info) = ComputeCholeskyFactorL(num_sampled_, log_likelihood_state->K_chol.data());
-//
-//  // K_inv
-//  SPDMatrixInverse(log_likelihood_state->K_chol.data(), num_sampled_, log_likelihood_state->K_inv.data());
-//
-//  // K_inv_y
-//  std::copy(points_sampled_value_.begin(), points_sampled_value_.end(),
-//            log_likelihood_state->K_inv_y.begin());
-//  CholeskyFactorLMatrixVectorSolve(log_likelihood_state->K_chol.data(), num_sampled_,
-//                                   log_likelihood_state->K_inv_y.data());
-//}
-//
-///*!\rst
-//  Computes the Leave-One-Out Cross Validation log pseudo-likelihood.
-//
-//  Let ``\log p(y_i | X_{-i}, y_{-i}, \theta) = -0.5\log(\sigma_i^2) - 0.5*(y_i - \mu_i)^2/\sigma_i^2 - 0.5\log(2\pi)``
-//
-//  Then we compute:
-//
-//  ``L_{LOO}(X, y, \theta) = \sum_{i = 1}^n \log p(y_i | X_{-i}, y_{-i}.``
-//
-//  where ``X_{-i}`` and ``y_{-i}`` are the training data with the ``i``-th point removed.  Then ``X_i`` is taken as the point to sample.
-//  ``\sigma_i^2`` and ``\mu_i`` are the GP (predicted) variance/mean at the point to sample.
-//
-//  This function currently uses LeaveOneOutCoreWithMatrixInverse() to compute ``\sigma_i^2`` and ``\mu_i``, which is potentially
-//  ill-conditioned.  This has not proven to be an issue in testing, but _accurate() is preferred when loss of prescision is
-//  suspected.
-//
-//  See Rasmussen & Williams 5.4.2 for more details.
-//\endrst*/
-//double LeaveOneOutLogLikelihoodEvaluator::ComputeLogLikelihood(
-//    const LeaveOneOutLogLikelihoodState& log_likelihood_state) const noexcept {
-//  double mean_fast, variance_fast;
-//  double loo_fast = 0.0;
-//  // double mean_accurate, variance_accurate;
-//  // double loo_accurate = 0.0;
-//  for (int i = 0; i < num_sampled_; ++i) {
-//    // compute \mu_i, \sigma_i^2 using explicit matrix inverse
-//    LeaveOneOutCoreWithMatrixInverse(log_likelihood_state.K_inv.data() + i*num_sampled_,
-//                                     log_likelihood_state.K_inv_y.data(), points_sampled_value_.data(), i,
-//                                     &mean_fast, &variance_fast);
-//    double probability_fast = -0.5*std::log(variance_fast) -
-//        0.5*Square(points_sampled_value_[i] - mean_fast)/variance_fast - 0.5*kLog2Pi;
-//    loo_fast += probability_fast;
-//
-//    // LeaveOneOutCoreAccurate(covariance_, noise_variance.data(), points_sampled.data(), points_sampled_value.data(), dim_, num_sampled_, i, &mean_accurate, &variance_accurate);
-//    // double probability_accurate = -0.5*log(variance_accurate) - 0.5*Square(points_sampled_value[i] - mean_accurate)/variance_accurate - 0.5*kLog2Pi;
-//    // loo_accurate += probability_accurate;
-//    // printf("mean_accurate = %.18E, mean_fast = %.18E, diff = %.18E\n", mean_accurate, mean_fast, mean_accurate-mean_fast);
-//    // printf("var_accurate  = %.18E, var_fast  = %.18E, diff = %.18E\n", variance_accurate, variance_fast, variance_accurate-variance_fast);
-//    // printf("prob_accurate = %.18E, prob_fast = %.18E, diff = %.18E\n", probability_accurate, probability_fast, probability_accurate-probability_fast);
-//  }
-//  // printf("loo_accurate = %.18E, loo_fast = %.18E, diff = %.18E\n", loo_accurate, loo_fast, loo_accurate-loo_fast);
-//
-//  // return loo_accurate;
-//  return loo_fast;
-//}
-//
-///*!\rst
-//  Computes the gradients (wrt hyperparameters, ``\theta``) of the Leave-One-Out Cross Validation log pseudo-likelihood, ``L_{LOO}``.
-//
-//  See function definition get_leave_one_out_likelihood() function defn docs for definition of ``L_{LOO}``.  We compute::
-//
-//    \pderiv{L_{LOO}}{\theta_j} = \sum_{i = 1}^n \frac{1}{(K^-1)_ii} *
-//                 \left(\alpha_i[Z_j\alpha]_i - 0.5(1 + \frac{\alpha_i^2}{(K^-1)_ii})[Z_j K^-1]_ii \right)
-//
-//  where ``\alpha = K^-1 * y``, and ``Z_j = K^-1 * \pderiv{K}{\theta_j}``.
-//
-//  Note that formation of ``[Z_j * K^-1] = K^-1 * \pderiv{K}{\theta_j} * K^-1`` requires some care.  We prefer not to use the explicit
-//  inverse whenever possible.  But we are readily able to compute ``A^-1 * B`` via "backsolve" (of a factored ``A``), so we do:
-//
-//  | ``A := K^-1 * Z^T``
-//  | ``result := A^T`` gives us the desired ``[Z_j * K^-1]`` without forming ``K^-1``.
-//
-//  Note that this formulation uses ``(K^-1)_ii`` directly to avoid the (very high) expense of evaluating the GP mean, variance n times.
-//  This is analogous to using LeaveOneOutCoreWithMatrixInverse() over LeaveOneOutCoreAccurate(), which is an assumption
-//  that seems reasonable now but may need revisiting later.
-//
-//  See Rasmussen & Williams 5.4.2 for details.
-//\endrst*/
-//void LeaveOneOutLogLikelihoodEvaluator::ComputeGradLogLikelihood(LeaveOneOutLogLikelihoodState * log_likelihood_state,
-//                                                                 double * restrict grad_loo) const noexcept {
-//  BuildHyperparameterGradCovarianceMatrix(log_likelihood_state);
-//
-//  double * restrict grad_hyperparameter_cov_matrix_ptr = log_likelihood_state->grad_hyperparameter_cov_matrix.data();
-//  double const * restrict K_inv_ptr;
-//  const int num_hyperparameters = log_likelihood_state->num_hyperparameters;
-//  for (int i_hyper = 0; i_hyper < num_hyperparameters; ++i_hyper) {
-//    // overwrite grad_hyperparameter_cov_matrix := K^-1 * grad_hyperparameter_cov_matrix, aka Z
-//    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_sampled_, num_sampled_,
-//                                     grad_hyperparameter_cov_matrix_ptr);
-//    // Z_alpha := K^-1 * grad_hyperparameter_cov_matrix * alpha = Z * alpha = Z * K^-1 * y
-//    GeneralMatrixVectorMultiply(grad_hyperparameter_cov_matrix_ptr, 'N', log_likelihood_state->K_inv_y.data(),
-//                                1.0, 0.0, num_sampled_, num_sampled_, num_sampled_,
-//                                log_likelihood_state->Z_alpha.data());
-//
-//    // TODO(GH-180): Consider using the explicit inverse so that we only have to form the diagonal of Z * K^-1 here.
-//
-//    // Z_K_inv := Z^T
-//    MatrixTranspose(grad_hyperparameter_cov_matrix_ptr, num_sampled_, num_sampled_,
-//                    log_likelihood_state->Z_K_inv.data());
-//    // Z_K_inv := K^-1 * Z^T
-//    CholeskyFactorLMatrixMatrixSolve(log_likelihood_state->K_chol.data(), num_sampled_, num_sampled_,
-//                                     log_likelihood_state->Z_K_inv.data());
-//    // overwrite grad_hyperparameter_cov_matrix := (K^-1 * Z^T)^T = Z * K^-1 (recall: K^-1 is SPD)
-//    MatrixTranspose(log_likelihood_state->Z_K_inv.data(), num_sampled_, num_sampled_,
-//                    grad_hyperparameter_cov_matrix_ptr);
-//
-//    grad_loo[i_hyper] = 0.0;
-//    K_inv_ptr = log_likelihood_state->K_inv.data();
-//    for (int i = 0; i < num_sampled_; ++i) {
-//      grad_loo[i_hyper] += (log_likelihood_state->K_inv_y[i]*log_likelihood_state->Z_alpha[i] -
-//                            0.5*(1.0 + Square(log_likelihood_state->K_inv_y[i])/K_inv_ptr[i]) *
-//                            grad_hyperparameter_cov_matrix_ptr[i]) / K_inv_ptr[i];
-//      K_inv_ptr += num_sampled_;
-//      grad_hyperparameter_cov_matrix_ptr += num_sampled_;
-//    }
-//  }
-//}
-//
-///*!\rst
-//  NOT IMPLEMENTED
-//  Kludge to make it so that I can use general template code w/o special casing LeaveOneOutLogLikelihoodEvaluator.
-//\endrst*/
-//void LeaveOneOutLogLikelihoodEvaluator::ComputeHessianLogLikelihood(
-//    LeaveOneOutLogLikelihoodState * OL_UNUSED(log_likelihood_state),
-//    double * restrict OL_UNUSED(hessian_loo)) const {
-//  OL_THROW_EXCEPTION(OptimalLearningException, "LeaveOneOutLogLikelihoodEvaluator::ComputeHessianLogLikelihood is NOT IMPLEMENTED. Try using Gradient Descent instead of Newton.");
-//}
-//
-//void LeaveOneOutLogLikelihoodState::SetHyperparameters(const EvaluatorType& log_likelihood_eval,
-//                                                        double const * restrict hyperparameters) {
-//  // update hyperparameters
-//  covariance_ptr->SetHyperparameters(hyperparameters);
-//
-//  // evaluate derived quantities
-//  log_likelihood_eval.FillLogLikelihoodState(this);
-//}
-//
-//void LeaveOneOutLogLikelihoodState::SetupState(const EvaluatorType& log_likelihood_eval,
-//                                               double const * restrict hyperparameters) {
-//  if (unlikely(num_sampled != log_likelihood_eval.num_sampled())) {
-//    num_sampled = log_likelihood_eval.num_sampled();
-//    K_chol.resize(num_sampled*num_sampled);
-//    K_inv.resize(num_sampled*num_sampled);
-//    K_inv_y.resize(num_sampled);
-//    grad_hyperparameter_cov_matrix.resize(num_hyperparameters*num_sampled*num_sampled);
-//    Z_alpha.resize(num_sampled);
-//    Z_K_inv.resize(num_sampled*num_sampled);
-//  }
-//
-//  // set hyperparameters and derived quantities
-//  SetHyperparameters(log_likelihood_eval, hyperparameters);
-//}
-//
-//LeaveOneOutLogLikelihoodState::LeaveOneOutLogLikelihoodState(const EvaluatorType& log_likelihood_eval,
-//                                                             const CovarianceInterface& covariance_in)
-//    : dim(log_likelihood_eval.dim()),
-//      num_sampled(log_likelihood_eval.num_sampled()),
-//      num_hyperparameters(covariance_in.GetNumberOfHyperparameters()),
-//      covariance_ptr(covariance_in.Clone()),
-//      K_chol(num_sampled*num_sampled),
-//      K_inv(num_sampled*num_sampled),
-//      K_inv_y(num_sampled),
-//      grad_hyperparameter_cov_matrix(num_hyperparameters*num_sampled*num_sampled),
-//      Z_alpha(num_sampled),
-//      Z_K_inv(num_sampled*num_sampled) {
-//  std::vector<double> hyperparameters(num_hyperparameters);
-//  covariance_ptr->GetHyperparameters(hyperparameters.data());
-//  SetupState(log_likelihood_eval, hyperparameters.data());
-//}
-//
-//LeaveOneOutLogLikelihoodState::LeaveOneOutLogLikelihoodState(LeaveOneOutLogLikelihoodState&& OL_UNUSED(other)) = default;
+namespace {  // utilities for Leave One Out log pseudo-likelihood computations
+
+/*!\rst
+  Computes ``\sigma^2_i(X_{-i}, \theta), \mu_i(X_{-i}, y_{-i}, \theta)``,
+  where ``X_{-i}`` and ``y_{-i}`` are the training data with the ``i``-th observation removed.  Then the ``i``-th observation
+  is taken as the point to sample.  ``\sigma_i^2`` and ``\mu_i`` are the GP (predicted) variance/mean at the point to sample.
+
+  By exploiting the properties of the inverse of the covariance matrix, we can compute:
+
+  * ``\mu_i = y_i - (K^-1 * y)_i/(K^-1)_ii``
+  * ``\sigma^2_i = 1/(K^-1)_ii``
+
+  Note that ``(K^-1)_ii`` denotes the ``i``-th diagonal entry of the inverse of ``K``.
+
+  See Rasmussen & Williams 5.4.2 for details.
+
+  This operation is potentially ill-conditioned but the computation is *very* fast compared to building ``N`` new GPs.
+
+  \param
+    :K_inv_ii: ``i``-th diagonal entry of the inverse of the covariance matrix over all training observations
+    :K_inv_y_i: ``(K^-1 * y)_i``
+    :y_i: ``i``-th observed value
+  \output
+    :mean[1]: the GP mean evaluated at the ``i``-th observation
+    :variance[1]: the GP variance evaluated at the ``i``-th observation
+\endrst*/
+OL_NONNULL_POINTERS void LeaveOneOutCoreWithMatrixInverse(double K_inv_ii, double K_inv_y_i, double y_i,
+                                                          double * restrict mean, double * restrict variance) noexcept {
+  *mean = y_i - K_inv_y_i/K_inv_ii;
+  *variance = 1.0/K_inv_ii;
+}
+
+}  // end unnamed namespace
+
+LeaveOneOutLogLikelihoodEvaluator::LeaveOneOutLogLikelihoodEvaluator(double const * restrict points_sampled_in,
+                                                                     double const * restrict points_sampled_value_in,
+                                                                     int const * derivatives_in,
+                                                                     int num_derivatives_in,
+                                                                     int dim_in, int num_sampled_in)
+    : dim_(dim_in),
+      num_sampled_(num_sampled_in),
+      num_derivatives_(num_derivatives_in),
+      derivatives_(derivatives_in, derivatives_in + num_derivatives_in),
+      points_sampled_(points_sampled_in, points_sampled_in + num_sampled_in*dim_in),
+      points_sampled_value_(points_sampled_value_in, points_sampled_value_in + (num_derivatives_in+1)*num_sampled_in),
+      pairwise_differences_(points_sampled_in, dim_in, num_sampled_in, derivatives_in, num_derivatives_in) {
+}
+
+void LeaveOneOutLogLikelihoodEvaluator::FillLogLikelihoodState(
+    LeaveOneOutLogLikelihoodState * log_likelihood_state) const {
+  // K_chol, y, K_inv_y: identical to the log marginal likelihood
+  BuildCenteredCovarianceSolve(*log_likelihood_state->covariance_ptr, pairwise_differences_,
+                               log_likelihood_state->noise_variance.data(), points_sampled_value_.data(),
+                               std::vector<int>(), log_likelihood_state->K_chol.data(),
+                               log_likelihood_state->y.data(), log_likelihood_state->K_inv_y.data());
+
+  // K_inv
+  SPDMatrixInverse(log_likelihood_state->K_chol.data(), num_sampled_*(num_derivatives_+1),
+                   log_likelihood_state->K_inv.data());
+}
+
+/*!\rst
+  Computes the Leave-One-Out Cross Validation log pseudo-likelihood.
+
+  Let ``\log p(y_i | X_{-i}, y_{-i}, \theta) = -0.5\log(\sigma_i^2) - 0.5*(y_i - \mu_i)^2/\sigma_i^2 - 0.5\log(2\pi)``
+
+  Then we compute:
+
+  ``L_{LOO}(X, y, \theta) = \sum_{i = 1}^n \log p(y_i | X_{-i}, y_{-i}).``
+
+  where ``X_{-i}`` and ``y_{-i}`` are the training data with the ``i``-th observation removed.
+  ``\sigma_i^2`` and ``\mu_i`` are the GP (predicted) variance/mean at the left-out observation, computed with
+  LeaveOneOutCoreWithMatrixInverse().
+
+  See Rasmussen & Williams 5.4.2 for more details.
+\endrst*/
+double LeaveOneOutLogLikelihoodEvaluator::ComputeLogLikelihood(
+    const LeaveOneOutLogLikelihoodState& log_likelihood_state) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  double mean, variance;
+  double loo = 0.0;
+  for (int i = 0; i < num_rows; ++i) {
+    const double y_i = log_likelihood_state.y[i];
+    LeaveOneOutCoreWithMatrixInverse(log_likelihood_state.K_inv[i*num_rows + i], log_likelihood_state.K_inv_y[i], y_i,
+                                     &mean, &variance);
+    loo += -0.5*std::log(variance) - 0.5*Square(y_i - mean)/variance - 0.5*kLog2Pi;
+  }
+  return loo;
+}
+
+/*!\rst
+  Computes the gradients (wrt hyperparameters, ``\theta``) of the Leave-One-Out Cross Validation log pseudo-likelihood, ``L_{LOO}``.
+
+  See LeaveOneOutLogLikelihoodEvaluator::ComputeLogLikelihood() for the definition of ``L_{LOO}``.  We compute::
+
+    \pderiv{L_{LOO}}{\theta_j} = \sum_{i = 1}^n \frac{1}{(K^-1)_ii} *
+                 \left(\alpha_i[Z_j\alpha]_i - 0.5(1 + \frac{\alpha_i^2}{(K^-1)_ii})[Z_j K^-1]_ii \right)
+
+  where ``\alpha = K^-1 * y``, and ``Z_j = K^-1 * \pderiv{K}{\theta_j}``.  (Rasmussen & Williams 5.4.2)
+
+  Forming ``Z_j`` costs ``O(N^3)`` per hyperparameter.  Instead note that both terms are linear in ``\pderiv{K}{\theta_j}``:
+  with ``u_i = \alpha_i/(K^-1)_ii``, ``v = K^-1 * u``, and ``D = diag((1 + \alpha_i^2/(K^-1)_ii)/(K^-1)_ii)``,
+
+  | ``\sum_i u_i [K^-1 \pderiv{K}{\theta_j} \alpha]_i = v^T \pderiv{K}{\theta_j} \alpha``
+  | ``\sum_i D_ii [K^-1 \pderiv{K}{\theta_j} K^-1]_ii = trace(K^-1 D K^-1 \pderiv{K}{\theta_j})``
+
+  So ``\pderiv{L_{LOO}}{\theta_j} = trace(W \pderiv{K}{\theta_j})`` for the symmetric
+  ``W = 0.5*(v\alpha^T + \alpha v^T) - 0.5*K^-1 D K^-1``.  ``W`` is formed once (``O(N^3)``) and the trace is streamed
+  tile by tile exactly as in LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood() (``O(N^2)`` per hyperparameter).
+\endrst*/
+void LeaveOneOutLogLikelihoodEvaluator::ComputeGradLogLikelihood(LeaveOneOutLogLikelihoodState * log_likelihood_state,
+                                                                 double * restrict grad_loo) const noexcept {
+  const int num_rows = num_sampled_*(num_derivatives_+1);
+  double const * restrict K_inv = log_likelihood_state->K_inv.data();
+  double const * restrict alpha = log_likelihood_state->K_inv_y.data();
+
+  // W := -0.5 * K^-1 * D * K^-1; first scale the columns of K^-1 by D
+  std::vector<double> K_inv_D(Square(num_rows));
+  std::vector<double> u(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    const double K_inv_ii = K_inv[i*num_rows + i];
+    u[i] = alpha[i]/K_inv_ii;
+    const double D_ii = (1.0 + alpha[i]*u[i])/K_inv_ii;
+    for (int r = 0; r < num_rows; ++r) {
+      K_inv_D[i*num_rows + r] = D_ii*K_inv[i*num_rows + r];
+    }
+  }
+  std::vector<double> W(Square(num_rows));
+  GeneralMatrixMatrixMultiply(K_inv_D.data(), 'N', K_inv, -0.5, 0.0, num_rows, num_rows, num_rows, W.data());
+
+  // W += 0.5 * (v\alpha^T + \alpha v^T), v = K^-1 * u
+  std::vector<double> v(num_rows);
+  SymmetricMatrixVectorMultiply(K_inv, u.data(), num_rows, v.data());
+  for (int j = 0; j < num_rows; ++j) {
+    for (int i = 0; i < num_rows; ++i) {
+      W[j*num_rows + i] += 0.5*(v[i]*alpha[j] + alpha[i]*v[j]);
+    }
+  }
+
+  StreamHyperparameterGradCovarianceTrace(*log_likelihood_state->covariance_ptr, points_sampled_.data(), dim_, num_sampled_,
+                                          derivatives_.data(), num_derivatives_, W.data(), grad_loo);
+}
+
+/*!\rst
+  NOT IMPLEMENTED
+  Kludge to make it so that I can use general template code w/o special casing LeaveOneOutLogLikelihoodEvaluator.
+\endrst*/
+void LeaveOneOutLogLikelihoodEvaluator::ComputeHessianLogLikelihood(
+    LeaveOneOutLogLikelihoodState * OL_UNUSED(log_likelihood_state),
+    double * restrict OL_UNUSED(hessian_loo)) const {
+  OL_THROW_EXCEPTION(OptimalLearningException, "LeaveOneOutLogLikelihoodEvaluator::ComputeHessianLogLikelihood is NOT IMPLEMENTED. Try using Gradient Descent or L-BFGS-B instead of Newton.");
+}
+
+void LeaveOneOutLogLikelihoodState::SetHyperparameters(const EvaluatorType& log_likelihood_eval,
+                                                       double const * restrict hyperparameters) {
+  // update hyperparameters
+  covariance_ptr->SetHyperparameters(hyperparameters);
+  hyperparameters += covariance_ptr->GetNumberOfHyperparameters();
+  std::copy(hyperparameters, hyperparameters + num_derivatives + 1, noise_variance.begin());
+
+  // evaluate derived quantities
+  log_likelihood_eval.FillLogLikelihoodState(this);
+}
+
+void LeaveOneOutLogLikelihoodState::SetupState(const EvaluatorType& log_likelihood_eval,
+                                               double const * restrict hyperparameters) {
+  if (unlikely(num_sampled != log_likelihood_eval.num_sampled()) || unlikely(num_derivatives != log_likelihood_eval.num_derivatives())) {
+    num_sampled = log_likelihood_eval.num_sampled();
+    num_derivatives = log_likelihood_eval.num_derivatives();
+    num_hyperparameters = covariance_ptr->GetNumberOfHyperparameters() + num_derivatives + 1;
+    noise_variance.resize(num_derivatives+1);
+    K_chol.resize(Square(num_sampled*(num_derivatives+1)));
+    K_inv.resize(Square(num_sampled*(num_derivatives+1)));
+    K_inv_y.resize(num_sampled*(num_derivatives+1));
+    y.resize(num_sampled*(num_derivatives+1));
+  }
+
+  // set hyperparameters and derived quantities
+  SetHyperparameters(log_likelihood_eval, hyperparameters);
+}
+
+LeaveOneOutLogLikelihoodState::LeaveOneOutLogLikelihoodState(const EvaluatorType& log_likelihood_eval,
+                                                             const CovarianceInterface& covariance_in,
+                                                             const std::vector<double> noise_variance_in)
+    : dim(log_likelihood_eval.dim()),
+      num_sampled(log_likelihood_eval.num_sampled()),
+      num_derivatives(log_likelihood_eval.num_derivatives()),
+      num_hyperparameters(covariance_in.GetNumberOfHyperparameters() + num_derivatives + 1),
+      covariance_ptr(covariance_in.Clone()),
+      noise_variance(noise_variance_in),
+      K_chol(Square(num_sampled*(num_derivatives+1))),
+      K_inv(Square(num_sampled*(num_derivatives+1))),
+      K_inv_y(num_sampled*(num_derivatives+1)),
+      y(num_sampled*(num_derivatives+1)) {
+  std::vector<double> hyperparameters(num_hyperparameters);
+  GetHyperparameters(hyperparameters.data());
+  SetupState(log_likelihood_eval, hyperparameters.data());
+}
+
+LeaveOneOutLogLikelihoodState::LeaveOneOutLogLikelihoodState(LeaveOneOutLogLikelihoodState&& OL_UNUSED(other)) = default;
+
+HyperparameterRefitState::HyperparameterRefitState(const HyperparameterRefitParameters& refit_parameters)
+    : full_search_interval_(refit_parameters.full_search_interval),
+      num_warm_starts_(refit_parameters.num_warm_starts),
+      perturbation_radius_(refit_parameters.perturbation_radius),
+      max_log_likelihood_drop_(refit_parameters.max_log_likelihood_drop),
+      num_refits_(0),
+      num_full_searches_(0),
+      num_warm_refits_since_full_search_(0),
+      last_refit_was_full_search_(false),
+      log_likelihood_per_point_(-std::numeric_limits<double>::infinity()) {
+  if (unlikely(full_search_interval_ < 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "full_search_interval must be nonnegative (0 = drops only).",
+                       full_search_interval_, 0);
+  }
+}
+
+bool HyperparameterRefitState::UseFullSearch(double log_likelihood_per_point) const noexcept {
+  if (num_refits_ == 0 || num_warm_starts_ <= 0) {
+    return true;
+  }
+  if (full_search_interval_ > 0 && num_warm_refits_since_full_search_ + 1 >= full_search_interval_) {
+    return true;
+  }
+  // written so that a NaN likelihood also falls back
+  return !(log_likelihood_per_point_ - log_likelihood_per_point <= max_log_likelihood_drop_);
+}
+
+void HyperparameterRefitState::RecordRefit(bool full_search, double log_likelihood_per_point) noexcept {
+  ++num_refits_;
+  if (full_search) {
+    ++num_full_searches_;
+    num_warm_refits_since_full_search_ = 0;
+  } else {
+    ++num_warm_refits_since_full_search_;
+  }
+  last_refit_was_full_search_ = full_search;
+  log_likelihood_per_point_ = log_likelihood_per_point;
+}
+
+void BuildWarmStartHyperparameterGuesses(double const * restrict previous_hyperparameters,
+                                         ClosedInterval const * restrict domain, int num_hyperparameters,
+                                         int num_guesses, double perturbation_radius,
+                                         UniformRandomGenerator * uniform_generator,
+                                         double * restrict initial_guesses) {
+  boost::uniform_real<double> uniform_perturbation(-perturbation_radius, perturbation_radius);
+  for (int k = 0; k < num_guesses; ++k) {
+    for (int i = 0; i < num_hyperparameters; ++i) {
+      double log_coordinate = std::log10(previous_hyperparameters[i]);
+      if (k > 0) {
+        log_coordinate += uniform_perturbation(uniform_generator->engine);
+      }
+      log_coordinate = std::min(std::max(log_coordinate, domain[i].min), domain[i].max);
+      initial_guesses[k*num_hyperparameters + i] = std::pow(10.0, log_coordinate);
+    }
+  }
+}
 
 }  // end namespace optimal_learning
@@ -36,10 +36,12 @@
 
   both of which follow the Evaluator/State "idiom" described in gpp_common.hpp.
 
-  For selecting the best hyperparameters, this file provides two multistart optimization wrappers
-  for gradient descent and Newton, that maximize the previous log likelihood measures:
+  For selecting the best hyperparameters, this file provides multistart optimization wrappers
+  for gradient descent, L-BFGS-B, line search gradient descent, and Newton, that maximize the previous log likelihood measures:
 
   * MultistartGradientDescentHyperparameterOptimization<LogLikelihoodEvaluator, Domain>()
+  * MultistartLBFGSBHyperparameterOptimization<LogLikelihoodEvaluator>()
+  * MultistartLineSearchGradientDescentHyperparameterOptimization<LogLikelihoodEvaluator>()
   * MultistartNewtonHyperparameterOptimization<LogLikelihoodEvaluator, Domain>()
 
   These functions are wrappers for templated code in gpp_optimization.hpp.  The wrappers just set up inputs for use
@@ -50,6 +52,9 @@
   * LatinHypercubeSearchHyperparameterOptimization<LogLikelihoodEvaluator>()  (eval log-likelihood at random points)
   * EvaluateLogLikelihoodAtPointList<LogLikelihoodEvaluator, Domain>()  (eval log-likelihood at specified points)
 
+  Ensemble MCMC samplers (e.g., emcee) need the log likelihood of every walker at each step (no best point, no
+  abort on bad proposals); EvaluateLogLikelihoodOfEnsemble<LogLikelihoodEvaluator>() computes these in parallel.
+
   This file also provides single-start versions of each optimization technique:
 
   * RestartedGradientDescentHyperparameterOptimization<LogLikelihoodEvaluator, Domain>()
@@ -186,7 +191,19 @@
 
          Single start version available in: RestartedGradientDescentHyperparameterOptimization<>().
 
-     iii. MultistartNewtonHyperparameterOptimization<>() (Recommended):
+     iii. MultistartLBFGSBHyperparameterOptimization<>():
+
+          Same as ii., but each run is L-BFGS-B (quasi-Newton, box-constrained); needs far fewer log likelihood
+          evaluations than gradient descent and no Hessian.
+
+          MultistartLineSearchGradientDescentHyperparameterOptimization<>() is the same again with gradient descent
+          whose step size is chosen by a backtracking line search instead of a fixed schedule.
+
+          For a loop that refits after every new observation, ii. and iii. have refit overloads taking a
+          HyperparameterRefitState: they start from the previous optimum (plus a few perturbations) and only run the
+          full search periodically or when the fit has degraded.
+
+     iv. MultistartNewtonHyperparameterOptimization<>() (Recommended):
 
           Takes in a ``log_likelihood_evaluator`` describing the prior, covariance, domain, config, etc.;
           searches for the best hyperparameters (of covariance) using multiple Newton runs.
@@ -206,15 +223,22 @@
 #include <cmath>
 
 #include <algorithm>
+#include <exception>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
 #include <vector>
 
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include "gpp_aligned_allocator.hpp"
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_logging.hpp"
+#include "gpp_memory_budget.hpp"
 #include "gpp_mock_optimization_objective_functions.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
@@ -232,11 +256,13 @@ enum class LogLikelihoodTypes {
   kLogMarginalLikelihood = 0,
   //! LeaveOneOutLogLikelihoodEvaluator
   kLeaveOneOutLogLikelihood = 1,
+  //! ApproximateLogMarginalLikelihoodEvaluator (gpp_approximate_log_likelihood.hpp)
+  kApproximateLogMarginalLikelihood = 2,
 };
 
 struct UniformRandomGenerator;
 struct LogMarginalLikelihoodState;
-//struct LeaveOneOutLogLikelihoodState;
+struct LeaveOneOutLogLikelihoodState;
 
 /*!\rst
   This serves as a quick summary of the Log Marginal Likelihood (LML).  Please see the file comments here and
@@ -294,6 +320,29 @@ class LogMarginalLikelihoodEvaluator final {
     return num_derivatives_;
   }
 
+  /*!\rst
+    Observe only some derivatives at each point: masked entries drop out of the likelihood (and its gradient and
+    hessian) exactly, as in GaussianProcess::SetDerivativeMask().  Only the observed rows of ``K`` are factored and
+    inverted, so ComputeLogLikelihood() and ComputeGradLogLikelihood() cost ``O(num_observed_rows()^3)``.
+
+    .. WARNING:: invalidates states built with this evaluator; call SetupState() on them again.
+
+    \param
+      :derivative_mask[num_derivatives][num_sampled]: 1 if the corresponding derivative observation (in the layout of
+        points_sampled_value, without the function values) is observed, 0 if it is masked
+  \endrst*/
+  void SetDerivativeMask(int const * restrict derivative_mask) OL_NONNULL_POINTERS;
+
+  //! the mask set by SetDerivativeMask(), ``[num_derivatives][num_sampled]``; empty if every derivative is observed
+  const std::vector<int>& derivative_mask() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return derivative_mask_;
+  }
+
+  //! number of observed rows of ``K``: ``num_sampled*(num_derivatives+1)`` less the masked derivatives
+  int num_observed_rows() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return derivative_mask_.empty() ? num_sampled_*(num_derivatives_+1) : static_cast<int>(observed_rows_.size());
+  }
+
   /*!\rst
     Wrapper for ComputeLogLikelihood(); see that function for details.
   \endrst*/
@@ -309,13 +358,33 @@ class LogMarginalLikelihoodEvaluator final {
     ComputeGradLogLikelihood(log_likelihood_state, grad_log_marginal);
   }
 
+  /*!\rst
+    Fused ComputeObjectiveFunction() and ComputeGradObjectiveFunction() (see gpp_optimization.hpp).  Both reuse the
+    Cholesky factor and ``K^-1 * y`` built by SetCurrentPoint(), so the log marginal adds only ``O(num_sampled)``
+    work to the gradient.
+
+    \param
+      :log_likelihood_state[1]: properly configured state object
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+      :grad_log_marginal[num_hyperparameters]: gradient of the log marginal (see ComputeGradLogLikelihood())
+    \return
+      natural log of the marginal likelihood of the GP model
+  \endrst*/
+  double ComputeObjectiveAndGradient(StateType * log_likelihood_state,
+                                     double * restrict grad_log_marginal) const noexcept OL_NONNULL_POINTERS {
+    const double log_likelihood = ComputeLogLikelihood(*log_likelihood_state);
+    ComputeGradLogLikelihood(log_likelihood_state, grad_log_marginal);
+    return log_likelihood;
+  }
+
   /*!\rst
     Wrapper for ComputeHessianLogLikelihood(); see that function for details.
   \endrst*/
-/*  void ComputeHessianObjectiveFunction(StateType * log_likelihood_state,
+  void ComputeHessianObjectiveFunction(StateType * log_likelihood_state,
                                        double * restrict hessian_log_marginal) const noexcept OL_NONNULL_POINTERS {
     ComputeHessianLogLikelihood(log_likelihood_state, hessian_log_marginal);
-  }*/
+  }
 
   /*!\rst
     Sets up the LogMarginalLikelihoodState object so that it can be used to compute log marginal and its gradients.
@@ -349,6 +418,10 @@ class LogMarginalLikelihoodEvaluator final {
 
     Let ``n_hyper = covariance_ptr->GetNumberOfHyperparameters();``
 
+    Forms ``\alpha\alpha^T - K^-1`` once and then spends ``O(N^2)`` per hyperparameter, streaming ``\pderiv{K}{\theta_k}``
+    tile by tile so peak memory is ``O(N^2)``; see the implementation for the (``O(N^3)`` per hyperparameter,
+    ``O(n_hyper * N^2)`` memory) ``OL_USE_INVERSE == 0`` alternative.
+
     \param
       :log_likelihood_state[1]: properly configured state oboject
     \output
@@ -362,8 +435,12 @@ class LogMarginalLikelihoodEvaluator final {
     Constructs the Hessian matrix of the log marginal likelihood function.  This matrix is symmetric.  It is also
     negative definite near maxima of the log marginal.
 
-    See HyperparameterHessianCovariance() docs in CovarianceInterface (gpp_covariance.hpp) for details on the structure
-    of the Hessian matrix.
+    Let ``n_hyper`` be the number of covariance hyperparameters plus the number of noise variances (as in
+    ComputeGradLogLikelihood()).  The covariance blocks come from CovarianceInterface::HyperparameterHessianCovariance()
+    (gpp_covariance.hpp), which is closed form for SquareExponential, gradient-observation blocks included.
+
+    Costs ``O(n_hyper * N^3)`` time and ``O(n_hyper * N^2)`` memory (for ``\pderiv{K}{\theta_i}`` and
+    ``K^-1 * \pderiv{K}{\theta_i}``), so it is meant for the low-dimensional hyperparameter spaces where Newton pays off.
 
     \param
       :log_likelihood_state[1]: properly configured state oboject
@@ -371,8 +448,8 @@ class LogMarginalLikelihoodEvaluator final {
       :log_likelihood_state[1]: state with temporary storage modified
       :hessian_log_marginal[n_hyper][n_hyper]: ``(i,j)``-th entry is ``\mixpderiv{LML}{\theta_i}{\theta_j}``, where ``LML = log(p(y | X, \theta))``
   \endrst*/
-/*  void ComputeHessianLogLikelihood(StateType * log_likelihood_state,
-                                   double * restrict hessian_log_marginal) const noexcept OL_NONNULL_POINTERS;*/
+  void ComputeHessianLogLikelihood(StateType * log_likelihood_state,
+                                   double * restrict hessian_log_marginal) const noexcept OL_NONNULL_POINTERS;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LogMarginalLikelihoodEvaluator);
 
@@ -392,22 +469,6 @@ class LogMarginalLikelihoodEvaluator final {
   \endrst*/
   void BuildHyperparameterGradCovarianceMatrix(StateType * log_likelihood_state) const noexcept;
 
-  /*!\rst
-    Constructs the tensor of hessians (wrt hyperparameters) of the covariance function at all pairs of ``points_sampled_``.
-    The result is ``\mixpderiv{cov(X_i, X_j)}{\theta_k}{\theta_l}``, stored in ``hessian_hyperparameter_cov_matrix[i][j][k][l]``.
-
-    .. Note:: this tensor has several symmetries: ``A[i][j][k][l] == A[j][i][k][l]`` and ``A[i][j][k][l] == A[i][j][l][k]``.
-
-    \param
-      :log_likelihood_state[1]: properly configured state object
-    \output
-      :log_likelihood_state[1]: state object with temporary storage modified
-      :hessian_hyperparameter_cov_matrix[num_sampled][num_sampled][n_hyper][n_hyper]:
-        ``(i,j,k,l)``-th entry is ``\mixpderiv{cov(X_i, X_j)}{\theta_k}{\theta_l}``
-  \endrst*/
-/*  void BuildHyperparameterHessianCovarianceMatrix(StateType * log_likelihood_state,
-                                                  double * hessian_hyperparameter_cov_matrix) const noexcept;*/
-
   // size information
   //! spatial dimension (e.g., entries per point of points_sampled)
   const int dim_;
@@ -427,6 +488,12 @@ class LogMarginalLikelihoodEvaluator final {
   std::vector<double> points_sampled_value_;
   //! ``\sigma_n^2``, the noise variance
   //std::vector<double> noise_variance_;
+  //! 1 for each observed derivative of each point (see SetDerivativeMask()); empty if every derivative is observed
+  std::vector<int> derivative_mask_;
+  //! the observed rows of ``K``, increasing; empty if derivative_mask_ is
+  std::vector<int> observed_rows_;
+  //! squared coordinate differences of points_sampled; built once and shared by every state (thread, hyperparameter)
+  PairwiseDifferences pairwise_differences_;
 };
 
 /*!\rst
@@ -530,15 +597,16 @@ struct LogMarginalLikelihoodState final {
 
   // derived variables
   //! cholesky factorization of ``K``
-  std::vector<double> K_chol;
+  AlignedVector<double> K_chol;
   //! ``K^-1 * (y-mean)``; computed WITHOUT forming ``K^-1``
-  std::vector<double> K_inv_y;
+  AlignedVector<double> K_inv_y;
   //! y-mean
   std::vector<double> y;
 
   // temporary storage: preallocated space used by LogMarginalLikelihoodEvaluator's member functions
   //! ``\pderiv{K_{ij}}{\theta_k}``; temporary b/c it is overwritten with each computation of GradLikelihood
-  std::vector<double> grad_hyperparameter_cov_matrix;
+  //! (empty unless built with ``OL_USE_INVERSE == 0``; by default GradLikelihood streams these values instead)
+  AlignedVector<double> grad_hyperparameter_cov_matrix;
   //! temporary storage space of size ``num_sampled``
   std::vector<double> temp_vec;
 
@@ -572,249 +640,268 @@ struct LogMarginalLikelihoodState final {
 
   .. Note:: These class comments are duplicated in Python: cpp_wrappers.log_likelihood.LeaveOneOutLogLikelihood
 \endrst*/
-//class LeaveOneOutLogLikelihoodEvaluator final {
-// public:
-//  //! string name of this log likelihood evaluator for logging
-//  constexpr static char const * kName = "leave_one_out_log_likelihood";
-//
-//  using StateType = LeaveOneOutLogLikelihoodState;
-//
-//  /*!\rst
-//    Constructs a LeaveOneOutLogLikelihoodEvaluator object.  All inputs are required; no default constructor nor copy/assignment are allowed.
-//
-//    \param
-//      :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
-//      :points_sampled[dim][num_sampled]: points that have already been sampled
-//      :points_sampled_value[num_sampled]: values of the already-sampled points
-//      :noise_variance[num_sampled]: the ``\sigma_n^2`` (noise variance) associated w/observation, points_sampled_value
-//      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
-//      :num_sampled: number of already-sampled points
-//  \endrst*/
-//  LeaveOneOutLogLikelihoodEvaluator(double const * restrict points_sampled_in,
-//                                    double const * restrict points_sampled_value_in,
-//                                    double const * restrict noise_variance_in,
-//                                    int dim_in, int num_sampled_in) OL_NONNULL_POINTERS;
-//
-//  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-//    return dim_;
-//  }
-//
-//  int num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-//    return num_sampled_;
-//  }
-//
-//  /*!\rst
-//    Wrapper for ComputeLogLikelihood(); see that function for details.
-//  \endrst*/
-//  double ComputeObjectiveFunction(StateType * log_likelihood_state) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
-//    return ComputeLogLikelihood(*log_likelihood_state);
-//  }
-//
-//  /*!\rst
-//    Wrapper for ComputeGradLogLikelihood(); see that function for details.
-//  \endrst*/
-//  void ComputeGradObjectiveFunction(StateType * log_likelihood_state,
-//                                    double * restrict grad_loo) const noexcept OL_NONNULL_POINTERS {
-//    ComputeGradLogLikelihood(log_likelihood_state, grad_loo);
-//  }
-//
-//  /*!\rst
-//    Wrapper for ComputeHessianLogLikelihood(); see that function for details.
-//  \endrst*/
-//  void ComputeHessianObjectiveFunction(StateType * log_likelihood_state,
-//                                       double * restrict hessian_loo) const OL_NONNULL_POINTERS {
-//    ComputeHessianLogLikelihood(log_likelihood_state, hessian_loo);
-//  }
-//
-//  /*!\rst
-//    Sets up the LeaveOneOutLogLikelihoodState object so that it can be used to compute log marginal and its gradients.
-//    ASSUMES all needed space is ALREADY ALLOCATED.
-//
-//    This function should not be called directly; instead use LeaveOneOutLogLikelihoodState::SetupState.
-//
-//    \param
-//      :log_likelihood_state[1]: constructed state object with appropriate sized allocations
-//    \output
-//      :log_likelihood_state[1]: fully configured state object, ready for use by this class's member functions
-//  \endrst*/
-//  void FillLogLikelihoodState(StateType * log_likelihood_state) const OL_NONNULL_POINTERS;
-//
-//  /*!\rst
-//    Computes the log LOO-CV pseudo-likelihood
-//    That is, split the training data ``(X, y)`` into ``|y|`` training set groups, where in the i-th group, the validation set is
-//    the ``i``-th point of ``(X, y)`` and the training set is ``(X, y)`` with the ``i``-th point removed.
-//    Then this likelihood measures the aggregate performance of the ability of a model built on each "leave one out"
-//    training set to predict the corresponding validation set.  So in some sense it is a measure of model consitency, ensuring
-//    that we do not perform well on a few points while doing horribly on the others.
-//
-//    \param
-//      :log_likelihood_state: properly configured state oboject
-//    \return
-//      natural log of the leave one out cross validation pseudo-likelihood of the GP model
-//  \endrst*/
-//  double ComputeLogLikelihood(const StateType& log_likelihood_state) const noexcept OL_WARN_UNUSED_RESULT;
-//
-//  /*!\rst
-//    Computes the (partial) derivatives of the leave-one-out cross validation log pseudo-likelihood with respect to each hyperparameter of our covariance function.
-//
-//    Let ``n_hyper = covariance_ptr->GetNumberOfHyperparameters();``
-//
-//    \param
-//      :log_likelihood_state[1]: properly configured state oboject
-//    \output
-//      :log_likelihood_state[1]: state with temporary storage modified
-//      :grad_loo[n_hyper]: gradient of leave one out cross validation log likelihood wrt each hyperparameter of covariance
-//  \endrst*/
-//  void ComputeGradLogLikelihood(StateType * log_likelihood_state,
-//                                double * restrict grad_loo) const noexcept OL_NONNULL_POINTERS;
-//
-//  /*!\rst
-//    NOT IMPLEMENTED.
-//    Kludge to make it so that I can instantiate MultistartNewtonOptimization<> with LeaveOneOutLogLikelihoodEvaluator in
-//    gpp_python.cpp. It is an error to select NewtonOptimization with LeaveOneOutLogLikelihoodEvaluator, but I can't find a nicer
-//    way to generate this error while still being able to treat MultistartNewtonOptimization<> generically.
-//  \endrst*/
-//  void ComputeHessianLogLikelihood(StateType * log_likelihood_state,
-//                                   double * restrict hessian_loo) const OL_NONNULL_POINTERS;
-//
-//  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LeaveOneOutLogLikelihoodEvaluator);
-//
-// private:
-//  /*!\rst
-//    Constructs the tensor of gradients (wrt hyperparameters) of the covariance function at all pairs of ``points_sampled_``.
-//
-//    The result is stored in ``state->grad_hyperparameter_cov_matrix``.  So we are computing ``\pderiv{cov(X_i, X_j)}{\theta_k``}.  These
-//    data are ordered as: ``grad_hyperparameter_cov_matrix[i][j][k]`` (i.e., ``num_hyperparmeters`` matrices of size ``Square(num_sampled_)``).
-//
-//    .. Note:: ``grad_hyperparameter_cov_matrix[i][j][k] == grad_hyperparameter_cov_matrix[j][i][k]``
-//
-//    \param
-//      :log_likelihood_state[1]: properly configured state object
-//    \output
-//      :log_likelihood_state[1]: state with grad_hyperparameter_cov_matrix filled
-//  \endrst*/
-//  void BuildHyperparameterGradCovarianceMatrix(StateType * log_likelihood_state) const noexcept;
-//
-//  // size information
-//  //! spatial dimension (e.g., entries per point of points_sampled)
-//  const int dim_;
-//  //! number of points in points_sampled
-//  int num_sampled_;
-//
-//  // state variables
-//  //! coordinates of already-sampled points, ``X``
-//  std::vector<double> points_sampled_;
-//  //! function values at points_sampled, ``y``
-//  std::vector<double> points_sampled_value_;
-//  //! ``\sigma_n^2``, the noise variance
-//  std::vector<double> noise_variance_;
-//};
-//
-///*!\rst
-//  State object for LeaveOneOutLogLikelihoodEvaluator.  This object tracks the covariance object as well as derived quantities
-//  that (along with the training points/values in the Evaluator class) fully specify the log marginal likelihood.  Since this
-//  is used to optimize the log marginal likelihood, the covariance's hyperparameters are variable.
-//
-//  See general comments on State structs in gpp_common.hpp's header docs.
-//\endrst*/
-//struct LeaveOneOutLogLikelihoodState final {
-//  using EvaluatorType = LeaveOneOutLogLikelihoodEvaluator;
-//
-//  /*!\rst
-//    Constructs a LeaveOneOutLogLikelihoodState object with a specified covariance object (in particular, new hyperparameters).
-//    Ensures all state variables & temporaries are properly sized.
-//    Properly sets all state variables so that the Evaluator can be used to compute log marginal likelihood, gradients, etc.
-//
-//    .. WARNING:: This object's state is INVALIDATED if the log_likelihood_eval used in construction is mutated!
-//      SetupState() should be called again in such a situation.
-//
-//    \param
-//      :log_likelihood_eval: LogMarginalLikelihoodEvaluator object that this state is being used with
-//      :covariance_in: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
-//  \endrst*/
-//  LeaveOneOutLogLikelihoodState(const EvaluatorType& log_likelihood_eval, const CovarianceInterface& covariance_in);
-//
-//  LeaveOneOutLogLikelihoodState(LeaveOneOutLogLikelihoodState&& other);
-//
-//  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
-//    return num_hyperparameters;
-//  }
-//
-//  void SetCurrentPoint(const EvaluatorType& log_likelihood_eval,
-//                          double const * restrict hyperparameters) OL_NONNULL_POINTERS {
-//    SetHyperparameters(log_likelihood_eval, hyperparameters);
-//  }
-//
-//  void GetCurrentPoint(double * restrict hyperparameters) OL_NONNULL_POINTERS {
-//    GetHyperparameters(hyperparameters);
-//  }
-//
-//  /*!\rst
-//    Get hyperparameters of underlying covariance function.
-//
-//    \output
-//      :hyperparameters[num_hyperparameters]: covariance's hyperparameters
-//  \endrst*/
-//  void GetHyperparameters(double * restrict hyperparameters) const noexcept OL_NONNULL_POINTERS {
-//    covariance_ptr->GetHyperparameters(hyperparameters);
-//  }
-//
-//  /*!\rst
-//    Change the hyperparameters of the underlying covariance function.
-//    Update the state's derived quantities to be consistent with the new hyperparameters.
-//
-//    \param
-//      :log_likelihood_eval: LeaveOneOutLogLikelihoodEvaluator object that this state is being used with
-//      :hyperparameters[num_hyperparameters]: hyperparameters to change to
-//  \endrst*/
-//  void SetHyperparameters(const EvaluatorType& log_likelihood_eval,
-//                             double const * restrict hyperparameters) OL_NONNULL_POINTERS;
-//
-//  /*!\rst
-//    Configures this state object with new hyperparameters.
-//    Ensures all state variables & temporaries are properly sized.
-//    Properly sets all state variables for log likelihood (+ gradient) evaluation.
-//
-//    .. WARNING:: This object's state is INVALIDATED if the log_likelihood used in SetupState is mutated!
-//      SetupState() should be called again in such a situation.
-//
-//    \param
-//      :log_likelihood_eval: log likelihood evaluator object that describes the training/already-measured data
-//      :hyperparameters[num_hyperparameters]: hyperparameters to change to
-//  \endrst*/
-//  void SetupState(const EvaluatorType& log_likelihood_eval,
-//                  double const * restrict hyperparameters) OL_NONNULL_POINTERS;
-//
-//  // size information
-//  //! spatial dimension (e.g., entries per point of points_sampled)
-//  const int dim;
-//  //! number of points in points_sampled
-//  int num_sampled;
-//  //! number of hyperparameters of covariance; i.e., covariance_ptr->GetNumberOfHyperparameters()
-//  int num_hyperparameters;
-//
-//  // state variables
-//  //! covariance class (for computing covariance and its gradients)
-//  std::unique_ptr<CovarianceInterface> covariance_ptr;
-//
-//  // derived variables
-//  //! cholesky factorization of ``K``
-//  std::vector<double> K_chol;
-//  //! ``K^-1``
-//  std::vector<double> K_inv;
-//  //! ``K^-1 * y``; computed WITHOUT forming ``K^-1``
-//  std::vector<double> K_inv_y;
-//
-//  // temporary storage: preallocated space used by LeaveOneOutLogLikelihoodEvaluator's member functions
-//  //! ``\pderiv{K_{ij}}{\theta_k}``; temporary b/c it is overwritten with each computation of GradLikelihood
-//  std::vector<double> grad_hyperparameter_cov_matrix;
-//  //! temporary: ``K^-1 * grad_hyperparameter_cov_matrix * K^-1 * y``
-//  std::vector<double> Z_alpha;
-//  //! temporary: ``K^-1 * grad_hyperparameter_cov_matrix * K^-1``
-//  std::vector<double> Z_K_inv;
-//
-//  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LeaveOneOutLogLikelihoodState);
-//};
+class LeaveOneOutLogLikelihoodEvaluator final {
+ public:
+  //! string name of this log likelihood evaluator for logging
+  constexpr static char const * kName = "leave_one_out_log_likelihood";
+
+  using StateType = LeaveOneOutLogLikelihoodState;
+
+  /*!\rst
+    Constructs a LeaveOneOutLogLikelihoodEvaluator object.  All inputs are required; no default constructor nor copy/assignment are allowed.
+    Inputs are the same as for LogMarginalLikelihoodEvaluator.
+
+    Each *observation* (function value or observed derivative component; i.e., each row of ``K``) takes a turn as the
+    validation set, so ``|y| = num_sampled*(num_derivatives+1)``.
+
+    \param
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_derivatives+1][num_sampled]: values (and observed derivatives) of the already-sampled points
+      :derivatives[num_derivatives]: indices of the observed derivative components
+      :num_derivatives: number of observed derivative components
+      :dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+      :num_sampled: number of already-sampled points
+  \endrst*/
+  LeaveOneOutLogLikelihoodEvaluator(double const * restrict points_sampled_in,
+                                    double const * restrict points_sampled_value_in,
+                                    int const * derivatives_in,
+                                    int num_derivatives_in,
+                                    int dim_in, int num_sampled_in) OL_NONNULL_POINTERS;
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_sampled_;
+  }
+
+  int num_derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_derivatives_;
+  }
+
+  /*!\rst
+    Wrapper for ComputeLogLikelihood(); see that function for details.
+  \endrst*/
+  double ComputeObjectiveFunction(StateType * log_likelihood_state) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return ComputeLogLikelihood(*log_likelihood_state);
+  }
+
+  /*!\rst
+    Wrapper for ComputeGradLogLikelihood(); see that function for details.
+  \endrst*/
+  void ComputeGradObjectiveFunction(StateType * log_likelihood_state,
+                                    double * restrict grad_loo) const noexcept OL_NONNULL_POINTERS {
+    ComputeGradLogLikelihood(log_likelihood_state, grad_loo);
+  }
+
+  /*!\rst
+    Wrapper for ComputeHessianLogLikelihood(); see that function for details.
+  \endrst*/
+  void ComputeHessianObjectiveFunction(StateType * log_likelihood_state,
+                                       double * restrict hessian_loo) const OL_NONNULL_POINTERS {
+    ComputeHessianLogLikelihood(log_likelihood_state, hessian_loo);
+  }
+
+  /*!\rst
+    Sets up the LeaveOneOutLogLikelihoodState object so that it can be used to compute log LOO-CV and its gradients.
+    ASSUMES all needed space is ALREADY ALLOCATED.
+
+    This function should not be called directly; instead use LeaveOneOutLogLikelihoodState::SetupState.
+
+    \param
+      :log_likelihood_state[1]: constructed state object with appropriate sized allocations
+    \output
+      :log_likelihood_state[1]: fully configured state object, ready for use by this class's member functions
+  \endrst*/
+  void FillLogLikelihoodState(StateType * log_likelihood_state) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Computes the log LOO-CV pseudo-likelihood
+    That is, split the training data ``(X, y)`` into ``|y|`` training set groups, where in the i-th group, the validation set is
+    the ``i``-th point of ``(X, y)`` and the training set is ``(X, y)`` with the ``i``-th point removed.
+    Then this likelihood measures the aggregate performance of the ability of a model built on each "leave one out"
+    training set to predict the corresponding validation set.  So in some sense it is a measure of model consitency, ensuring
+    that we do not perform well on a few points while doing horribly on the others.
+
+    Costs ``O(N)`` given the state (the ``O(N^3)`` work happens once, in FillLogLikelihoodState()).
+
+    \param
+      :log_likelihood_state: properly configured state oboject
+    \return
+      natural log of the leave one out cross validation pseudo-likelihood of the GP model
+  \endrst*/
+  double ComputeLogLikelihood(const StateType& log_likelihood_state) const noexcept OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Computes the (partial) derivatives of the leave-one-out cross validation log pseudo-likelihood with respect to each hyperparameter of our covariance function.
+
+    Let ``n_hyper`` be the number of covariance hyperparameters plus the number of noise variances (as in
+    LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood()).
+
+    Forms one symmetric weight matrix in ``O(N^3)`` and then spends ``O(N^2)`` per hyperparameter, streaming
+    ``\pderiv{K}{\theta_k}`` exactly like LogMarginalLikelihoodEvaluator::ComputeGradLogLikelihood().
+
+    \param
+      :log_likelihood_state[1]: properly configured state oboject
+    \output
+      :log_likelihood_state[1]: state with temporary storage modified
+      :grad_loo[n_hyper]: gradient of leave one out cross validation log likelihood wrt each hyperparameter of covariance
+  \endrst*/
+  void ComputeGradLogLikelihood(StateType * log_likelihood_state,
+                                double * restrict grad_loo) const noexcept OL_NONNULL_POINTERS;
+
+  /*!\rst
+    NOT IMPLEMENTED.
+    Kludge to make it so that I can instantiate MultistartNewtonOptimization<> with LeaveOneOutLogLikelihoodEvaluator in
+    gpp_python.cpp. It is an error to select NewtonOptimization with LeaveOneOutLogLikelihoodEvaluator, but I can't find a nicer
+    way to generate this error while still being able to treat MultistartNewtonOptimization<> generically.
+
+    \raise
+      OptimalLearningException: always
+  \endrst*/
+  void ComputeHessianLogLikelihood(StateType * log_likelihood_state,
+                                   double * restrict hessian_loo) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LeaveOneOutLogLikelihoodEvaluator);
+
+ private:
+  // size information
+  //! spatial dimension (e.g., entries per point of points_sampled)
+  const int dim_;
+  //! number of points in points_sampled
+  int num_sampled_;
+
+  //! number of derivatives' observations
+  int num_derivatives_;
+
+  // the index of the derivatives observed.
+  std::vector<int> derivatives_;
+
+  // state variables
+  //! coordinates of already-sampled points, ``X``
+  std::vector<double> points_sampled_;
+  //! function values at points_sampled, ``y``
+  std::vector<double> points_sampled_value_;
+  //! squared coordinate differences of points_sampled; built once and shared by every state (thread, hyperparameter)
+  PairwiseDifferences pairwise_differences_;
+};
+
+/*!\rst
+  State object for LeaveOneOutLogLikelihoodEvaluator.  This object tracks the covariance object as well as derived quantities
+  that (along with the training points/values in the Evaluator class) fully specify the log LOO-CV pseudo-likelihood.  Since this
+  is used to optimize the log LOO-CV pseudo-likelihood, the covariance's hyperparameters are variable.
+
+  The layout matches LogMarginalLikelihoodState (hyperparameters are the covariance's followed by the noise variances),
+  plus the explicit inverse ``K^-1``, whose diagonal gives the closed-form leave-one-out predictions.
+
+  See general comments on State structs in gpp_common.hpp's header docs.
+\endrst*/
+struct LeaveOneOutLogLikelihoodState final {
+  using EvaluatorType = LeaveOneOutLogLikelihoodEvaluator;
+
+  /*!\rst
+    Constructs a LeaveOneOutLogLikelihoodState object with a specified covariance object (in particular, new hyperparameters).
+    Ensures all state variables & temporaries are properly sized.
+    Properly sets all state variables so that the Evaluator can be used to compute log LOO-CV likelihood, gradients, etc.
+
+    .. WARNING:: This object's state is INVALIDATED if the log_likelihood_eval used in construction is mutated!
+      SetupState() should be called again in such a situation.
+
+    \param
+      :log_likelihood_eval: LeaveOneOutLogLikelihoodEvaluator object that this state is being used with
+      :covariance_in: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+      :noise_variance_in[num_derivatives+1]: noise variance of the function value, then of each observed derivative
+  \endrst*/
+  LeaveOneOutLogLikelihoodState(const EvaluatorType& log_likelihood_eval, const CovarianceInterface& covariance_in,
+                                const std::vector<double> noise_variance_in);
+
+  LeaveOneOutLogLikelihoodState(LeaveOneOutLogLikelihoodState&& other);
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_hyperparameters;
+  }
+
+  void SetCurrentPoint(const EvaluatorType& log_likelihood_eval,
+                          double const * restrict hyperparameters) OL_NONNULL_POINTERS {
+    SetHyperparameters(log_likelihood_eval, hyperparameters);
+  }
+
+  void GetCurrentPoint(double * restrict hyperparameters) OL_NONNULL_POINTERS {
+    GetHyperparameters(hyperparameters);
+  }
+
+  /*!\rst
+    Get hyperparameters of underlying covariance function.
+
+    \output
+      :hyperparameters[num_hyperparameters]: covariance's hyperparameters, then the noise variances
+  \endrst*/
+  void GetHyperparameters(double * restrict hyperparameters) const noexcept OL_NONNULL_POINTERS {
+    covariance_ptr->GetHyperparameters(hyperparameters);
+    hyperparameters += covariance_ptr->GetNumberOfHyperparameters();
+    for (int i = 0; i < num_derivatives+1; ++i) {
+      hyperparameters[i] = noise_variance[i];
+    }
+  }
+
+  /*!\rst
+    Change the hyperparameters of the underlying covariance function.
+    Update the state's derived quantities to be consistent with the new hyperparameters.
+
+    \param
+      :log_likelihood_eval: LeaveOneOutLogLikelihoodEvaluator object that this state is being used with
+      :hyperparameters[num_hyperparameters]: hyperparameters to change to
+  \endrst*/
+  void SetHyperparameters(const EvaluatorType& log_likelihood_eval,
+                          double const * restrict hyperparameters) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Configures this state object with new hyperparameters.
+    Ensures all state variables & temporaries are properly sized.
+    Properly sets all state variables for log likelihood (+ gradient) evaluation.
+
+    .. WARNING:: This object's state is INVALIDATED if the log_likelihood used in SetupState is mutated!
+      SetupState() should be called again in such a situation.
+
+    \param
+      :log_likelihood_eval: log likelihood evaluator object that describes the training/already-measured data
+      :hyperparameters[num_hyperparameters]: hyperparameters to change to
+  \endrst*/
+  void SetupState(const EvaluatorType& log_likelihood_eval,
+                  double const * restrict hyperparameters) OL_NONNULL_POINTERS;
+
+  // size information
+  //! spatial dimension (e.g., entries per point of points_sampled)
+  const int dim;
+  //! number of points in points_sampled
+  int num_sampled;
+
+  //! number of derivatives' observations
+  int num_derivatives;
+
+  //! number of hyperparameters of covariance; i.e., covariance_ptr->GetNumberOfHyperparameters()
+  // + the number of variances
+  int num_hyperparameters;
+
+  // state variables
+  //! covariance class (for computing covariance and its gradients)
+  std::unique_ptr<CovarianceInterface> covariance_ptr;
+
+  std::vector<double> noise_variance;
+
+  // derived variables
+  //! cholesky factorization of ``K``
+  std::vector<double> K_chol;
+  //! ``K^-1``
+  std::vector<double> K_inv;
+  //! ``K^-1 * (y-mean)``; computed WITHOUT forming ``K^-1``
+  std::vector<double> K_inv_y;
+  //! y-mean
+  std::vector<double> y;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(LeaveOneOutLogLikelihoodState);
+};
 
 /*!\rst
   Converts ``domain_bounds`` input from ``log10``-space to linear-space.
@@ -929,6 +1016,110 @@ OL_NONNULL_POINTERS void InitializeBestKnownPoint(const LogLikelihoodEvaluator&
   }
 }
 
+/*!\rst
+  Tracks a sequence of hyperparameter refits (e.g., one after every AddPointsToGP()) and decides, per
+  HyperparameterRefitParameters, whether the next one may be warm-started from the previous optimum or needs the full
+  multistart search.  Used by the refit overloads of MultistartGradientDescentHyperparameterOptimization() and
+  MultistartLBFGSBHyperparameterOptimization(); keep one per model.
+\endrst*/
+class HyperparameterRefitState final {
+ public:
+  /*!\rst
+    Constructs a refit state with no history: the first refit is a full search.
+
+    \param
+      :refit_parameters: HyperparameterRefitParameters controlling warm refits and full-search fallbacks
+  \endrst*/
+  explicit HyperparameterRefitState(const HyperparameterRefitParameters& refit_parameters);
+
+  /*!\rst
+    Whether the next refit must be a full search (see HyperparameterRefitParameters).
+
+    \param
+      :log_likelihood_per_point: log likelihood of the current data at the previous optimum, divided by the number of
+        sampled points
+    \return
+      true for a full search, false for a warm refit
+  \endrst*/
+  bool UseFullSearch(double log_likelihood_per_point) const noexcept OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Records a finished refit.
+
+    \param
+      :full_search: whether the refit was a full search
+      :log_likelihood_per_point: log likelihood at the refit's optimum, divided by the number of sampled points
+  \endrst*/
+  void RecordRefit(bool full_search, double log_likelihood_per_point) noexcept;
+
+  //! number of starts of a warm refit
+  int num_warm_starts() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_warm_starts_;
+  }
+
+  //! half-width, in ``log10`` units, of the perturbations of the previous optimum
+  double perturbation_radius() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return perturbation_radius_;
+  }
+
+  //! number of refits recorded so far
+  int num_refits() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_refits_;
+  }
+
+  //! number of those refits that were full searches
+  int num_full_searches() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_full_searches_;
+  }
+
+  //! true if the most recent refit was a full search
+  bool last_refit_was_full_search() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return last_refit_was_full_search_;
+  }
+
+ private:
+  //! run a full search at least once every this many refits (0: only on likelihood drops)
+  int full_search_interval_;
+  //! number of starts of a warm refit, including the previous optimum
+  int num_warm_starts_;
+  //! half-width, in ``log10`` units, of the perturbations of the previous optimum
+  double perturbation_radius_;
+  //! largest tolerated drop of the log likelihood per point at the previous optimum
+  double max_log_likelihood_drop_;
+
+  //! number of refits recorded so far
+  int num_refits_;
+  //! number of those refits that were full searches
+  int num_full_searches_;
+  //! warm refits since the last full search
+  int num_warm_refits_since_full_search_;
+  //! true if the most recent refit was a full search
+  bool last_refit_was_full_search_;
+  //! log likelihood per point at the most recent refit's optimum
+  double log_likelihood_per_point_;
+};
+
+/*!\rst
+  Builds the initial guesses of a warm refit: the previous optimum, then ``num_guesses - 1`` points drawn uniformly
+  within ``perturbation_radius`` of it in each ``log10`` coordinate.  Every guess is clamped to the domain.
+
+  \param
+    :previous_hyperparameters[num_hyperparameters]: the previous optimum (linear space)
+    :domain[num_hyperparameters]: boundaries of the tensor-product domain, in LOG-10 SPACE
+    :num_hyperparameters: dimension of the domain
+    :num_guesses: number of guesses to build (>= 1)
+    :perturbation_radius: half-width of the perturbations, in ``log10`` units
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :initial_guesses[num_hyperparameters][num_guesses]: the guesses (linear space)
+\endrst*/
+void BuildWarmStartHyperparameterGuesses(double const * restrict previous_hyperparameters,
+                                         ClosedInterval const * restrict domain, int num_hyperparameters,
+                                         int num_guesses, double perturbation_radius,
+                                         UniformRandomGenerator * uniform_generator,
+                                         double * restrict initial_guesses) OL_NONNULL_POINTERS;
+
 /*!\rst
   Optimize a log likelihood measure of model fit (as a function of the hyperparameters
   of a covariance function) using the prior (i.e., sampled points, values).  Optimization is done
@@ -1070,11 +1261,45 @@ OL_NONNULL_POINTERS void MultistartGradientDescentHyperparameterOptimization(
     bool * restrict found_flag,
     UniformRandomGenerator * uniform_generator,
     double * restrict next_hyperparameters) {
+  std::vector<OptimizationTrace> start_traces;
+  MultistartGradientDescentHyperparameterOptimization(log_likelihood_evaluator, covariance, noise_variance,
+                                                      gd_parameters, domain, thread_schedule, found_flag,
+                                                      uniform_generator, &start_traces, next_hyperparameters);
+}
+
+/*!\rst
+  MultistartGradientDescentHyperparameterOptimization() that also returns the per-start OptimizationTrace of every
+  multistart if ``gd_parameters.record_traces`` (see MultistartOptimizer::MultistartOptimize()).
+
+  \param
+    (all parameters are as in MultistartGradientDescentHyperparameterOptimization())
+  \output
+    :found_flag[1]: true if next_hyperparameters corresponds to a converged solution
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :start_traces[1]: one trace per multistart (final points in linear space) if ``gd_parameters.record_traces``;
+      empty otherwise
+    :next_hyperparameters[n_hyper]: the new hyperparameters found by gradient descent
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void MultistartGradientDescentHyperparameterOptimization(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const GradientDescentParameters& gd_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule_in,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    std::vector<OptimizationTrace> * start_traces,
+    double * restrict next_hyperparameters) {
   if (unlikely(gd_parameters.num_multistarts <= 0)) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", gd_parameters.num_multistarts, 1);
   }
 
   const int num_hyperparameters = covariance.GetNumberOfHyperparameters() + noise_variance.size();
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateLogLikelihoodMemory(
+      log_likelihood_evaluator.num_sampled(), log_likelihood_evaluator.num_derivatives(), num_hyperparameters,
+      false, thread_schedule_in.max_num_threads));
 
   std::vector<double> initial_guesses(num_hyperparameters*gd_parameters.num_multistarts);
   std::vector<ClosedInterval> domain_linearspace_bounds(domain, domain + num_hyperparameters);
@@ -1100,6 +1325,300 @@ OL_NONNULL_POINTERS void MultistartGradientDescentHyperparameterOptimization(
                                           nullptr, &io_container);
   *found_flag = io_container.found_flag;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
+  *start_traces = std::move(io_container.start_traces);
+}
+
+/*!\rst
+  Function to add multistarting on top of L-BFGS-B for hyperparameter optimization; the counterpart of
+  MultistartGradientDescentHyperparameterOptimization() with LBFGSBOptimizer<...> (see gpp_optimization.hpp) in place of
+  restarted gradient descent.  L-BFGS-B needs no step size schedule and handles the domain boundaries exactly; on
+  log likelihood it typically needs 10-30x fewer evaluations than gradient descent.
+
+  .. Note:: the domain here must be specified in LOG-10 SPACE!
+
+  .. WARNING:: this function fails if NO improvement can be found!  In that case,
+    ``best_next_point`` will always be the first randomly chosen point.
+    ``found_flag`` will be set to false in this case.
+
+  Let ``n_hyper = covariance_ptr->GetNumberOfHyperparameters();``
+
+  \param
+    :log_likelihood_evaluator: object supporting evaluation of log likelihood and its gradient
+    :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+    :noise_variance[num_derivatives+1]: initial noise hyperparameters
+    :lbfgsb_parameters: LBFGSBParameters object that describes the parameters controlling hyperparameter optimization (e.g., number
+      of iterations, history size, tolerance)
+    :domain[n_hyper]: array of ClosedInterval specifying the boundaries of a n_hyper-dimensional tensor-product domain.
+      Specify in LOG-10 SPACE!
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :found_flag[1]: true if next_hyperparameters corresponds to a converged solution
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :next_hyperparameters[n_hyper]: the new hyperparameters found by L-BFGS-B
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void MultistartLBFGSBHyperparameterOptimization(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const LBFGSBParameters& lbfgsb_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule_in,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    double * restrict next_hyperparameters) {
+  if (unlikely(lbfgsb_parameters.num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", lbfgsb_parameters.num_multistarts, 1);
+  }
+
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters() + noise_variance.size();
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateLogLikelihoodMemory(
+      log_likelihood_evaluator.num_sampled(), log_likelihood_evaluator.num_derivatives(), num_hyperparameters,
+      false, thread_schedule_in.max_num_threads));
+
+  std::vector<double> initial_guesses(num_hyperparameters*lbfgsb_parameters.num_multistarts);
+  std::vector<ClosedInterval> domain_linearspace_bounds(domain, domain + num_hyperparameters);
+  ConvertFromLogToLinearDomainAndBuildInitialGuesses(num_hyperparameters, lbfgsb_parameters.num_multistarts,
+                                                     uniform_generator, &domain_linearspace_bounds, &initial_guesses);
+  TensorProductDomain domain_linearspace(domain_linearspace_bounds.data(), num_hyperparameters);
+
+  // we need 1 state object per thread
+  std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
+  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, noise_variance, thread_schedule.max_num_threads,
+                          &log_likelihood_state_vector);
+  OptimizationIOContainer io_container(log_likelihood_state_vector[0].GetProblemSize());
+  InitializeBestKnownPoint(log_likelihood_evaluator, initial_guesses.data(), num_hyperparameters,
+                           lbfgsb_parameters.num_multistarts, log_likelihood_state_vector.data(), &io_container);
+
+  LBFGSBOptimizer<LogLikelihoodEvaluator, TensorProductDomain> lbfgsb_opt;
+  MultistartOptimizer<LBFGSBOptimizer<LogLikelihoodEvaluator, TensorProductDomain> > multistart_optimizer;
+
+  multistart_optimizer.MultistartOptimize(lbfgsb_opt, log_likelihood_evaluator, lbfgsb_parameters,
+                                          domain_linearspace, thread_schedule,
+                                          initial_guesses.data(), lbfgsb_parameters.num_multistarts,
+                                          log_likelihood_state_vector.data(),
+                                          nullptr, &io_container);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
+}
+
+/*!\rst
+  Refit core shared by the refit overloads of MultistartGradientDescentHyperparameterOptimization() and
+  MultistartLBFGSBHyperparameterOptimization(); see those.  ``Optimizer`` is the single-start optimizer over a
+  TensorProductDomain (e.g., ``GradientDescentOptimizer<LogLikelihoodEvaluator, TensorProductDomain>``).
+
+  The per-thread states are built at the previous optimum (``covariance``, ``noise_variance``) anyway, so the
+  likelihood check that picks warm vs. full costs one ``O(n^2)`` solve against a factor that is already computed.
+\endrst*/
+template <typename Optimizer, typename LogLikelihoodEvaluator, typename ParameterStruct>
+OL_NONNULL_POINTERS void MultistartHyperparameterRefit(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const ParameterStruct& optimizer_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule_in,
+    HyperparameterRefitState * refit_state,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    double * restrict next_hyperparameters) {
+  if (unlikely(optimizer_parameters.num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", optimizer_parameters.num_multistarts,
+                       1);
+  }
+
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters() + noise_variance.size();
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateLogLikelihoodMemory(
+      log_likelihood_evaluator.num_sampled(), log_likelihood_evaluator.num_derivatives(), num_hyperparameters,
+      false, thread_schedule_in.max_num_threads));
+
+  // we need 1 state object per thread; all start at the previous optimum
+  std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
+  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, noise_variance, thread_schedule.max_num_threads,
+                          &log_likelihood_state_vector);
+  std::vector<double> previous_hyperparameters(num_hyperparameters);
+  log_likelihood_state_vector[0].GetCurrentPoint(previous_hyperparameters.data());
+  const double num_points = log_likelihood_evaluator.num_sampled();
+  const double previous_log_likelihood =
+      log_likelihood_evaluator.ComputeObjectiveFunction(log_likelihood_state_vector.data());
+  const bool full_search = refit_state->UseFullSearch(previous_log_likelihood/num_points);
+
+  const int num_multistarts = full_search ? optimizer_parameters.num_multistarts : refit_state->num_warm_starts();
+  std::vector<double> initial_guesses(num_hyperparameters*num_multistarts);
+  std::vector<ClosedInterval> domain_linearspace_bounds(domain, domain + num_hyperparameters);
+  if (full_search) {
+    ConvertFromLogToLinearDomainAndBuildInitialGuesses(num_hyperparameters, num_multistarts, uniform_generator,
+                                                       &domain_linearspace_bounds, &initial_guesses);
+  } else {
+    BuildWarmStartHyperparameterGuesses(previous_hyperparameters.data(), domain, num_hyperparameters, num_multistarts,
+                                        refit_state->perturbation_radius(), uniform_generator,
+                                        initial_guesses.data());
+    ConvertFromLogToLinearDomain(num_hyperparameters, &domain_linearspace_bounds);
+  }
+  TensorProductDomain domain_linearspace(domain_linearspace_bounds.data(), num_hyperparameters);
+
+  OptimizationIOContainer io_container(log_likelihood_state_vector[0].GetProblemSize());
+  InitializeBestKnownPoint(log_likelihood_evaluator, initial_guesses.data(), num_hyperparameters, num_multistarts,
+                           log_likelihood_state_vector.data(), &io_container);
+
+  Optimizer optimizer;
+  MultistartOptimizer<Optimizer> multistart_optimizer;
+  multistart_optimizer.MultistartOptimize(optimizer, log_likelihood_evaluator, optimizer_parameters,
+                                          domain_linearspace, thread_schedule,
+                                          initial_guesses.data(), num_multistarts,
+                                          log_likelihood_state_vector.data(),
+                                          nullptr, &io_container);
+  refit_state->RecordRefit(full_search, io_container.best_objective_value_so_far/num_points);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
+}
+
+/*!\rst
+  Refit mode of MultistartGradientDescentHyperparameterOptimization(), for re-optimizing after new observations (e.g.,
+  after every AddPointsToGP()).  ``covariance`` and ``noise_variance`` must hold the previous optimum (what the last
+  refit returned).  Per ``refit_state`` (see HyperparameterRefitParameters), this either runs the usual full search
+  (``gd_parameters.num_multistarts`` Latin hypercube starts over ``domain``) or a warm refit: gradient descent from the
+  previous optimum and ``refit_state->num_warm_starts() - 1`` nearby perturbations.
+
+  .. Note:: the domain here must be specified in LOG-10 SPACE!
+
+  \param
+    :refit_state[1]: the model's HyperparameterRefitState
+    (all other parameters are as in MultistartGradientDescentHyperparameterOptimization())
+  \output
+    :refit_state[1]: updated with this refit
+    :found_flag[1]: true if next_hyperparameters corresponds to a converged solution
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :next_hyperparameters[n_hyper]: the new hyperparameters found by gradient descent
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void MultistartGradientDescentHyperparameterOptimization(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const GradientDescentParameters& gd_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule,
+    HyperparameterRefitState * refit_state,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    double * restrict next_hyperparameters) {
+  MultistartHyperparameterRefit<GradientDescentOptimizer<LogLikelihoodEvaluator, TensorProductDomain> >(
+      log_likelihood_evaluator, covariance, noise_variance, gd_parameters, domain, thread_schedule, refit_state,
+      found_flag, uniform_generator, next_hyperparameters);
+}
+
+/*!\rst
+  Refit mode of MultistartLBFGSBHyperparameterOptimization(); same as the refit mode of
+  MultistartGradientDescentHyperparameterOptimization(), with L-BFGS-B runs.
+
+  .. Note:: the domain here must be specified in LOG-10 SPACE!
+
+  \param
+    :refit_state[1]: the model's HyperparameterRefitState
+    (all other parameters are as in MultistartLBFGSBHyperparameterOptimization())
+  \output
+    :refit_state[1]: updated with this refit
+    :found_flag[1]: true if next_hyperparameters corresponds to a converged solution
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :next_hyperparameters[n_hyper]: the new hyperparameters found by L-BFGS-B
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void MultistartLBFGSBHyperparameterOptimization(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const LBFGSBParameters& lbfgsb_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule,
+    HyperparameterRefitState * refit_state,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    double * restrict next_hyperparameters) {
+  MultistartHyperparameterRefit<LBFGSBOptimizer<LogLikelihoodEvaluator, TensorProductDomain> >(
+      log_likelihood_evaluator, covariance, noise_variance, lbfgsb_parameters, domain, thread_schedule, refit_state,
+      found_flag, uniform_generator, next_hyperparameters);
+}
+
+/*!\rst
+  Optimize a log likelihood measure of model fit (as a function of the hyperparameters of a covariance function) using
+  multistarted gradient descent with a backtracking line search (see LineSearchGradientDescentOptimization() in
+  gpp_optimization.hpp and LineSearchGradientDescentParameters in gpp_optimizer_parameters.hpp).
+
+  This is a drop-in alternative to MultistartGradientDescentHyperparameterOptimization<>() that replaces the
+  ``pre_mult * (i+1)^{-\gamma}`` step size schedule (and its restarts) with an Armijo line search, so every accepted step
+  improves the log likelihood and no learning rate needs tuning.
+
+  .. Note:: the domain here must be specified in LOG-10 SPACE!
+
+  .. WARNING:: this function fails if NO improvement can be found!  In that case,
+    ``best_next_point`` will always be the first randomly chosen point.
+    ``found_flag`` will be set to false in this case.
+
+  Let ``n_hyper = covariance_ptr->GetNumberOfHyperparameters();``
+
+  \param
+    :log_likelihood_evaluator: object supporting evaluation of log likelihood and its gradient
+    :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+    :noise_variance[num_derivatives+1]: initial noise hyperparameters
+    :ls_parameters: LineSearchGradientDescentParameters object that describes the parameters controlling hyperparameter
+      optimization (e.g., number of iterations, initial step size, tolerance)
+    :domain[n_hyper]: array of ClosedInterval specifying the boundaries of a n_hyper-dimensional tensor-product domain.
+      Specify in LOG-10 SPACE!
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_dynamic), chunk_size (0).
+    :uniform_generator[1]: a UniformRandomGenerator object providing the random engine for uniform random numbers
+  \output
+    :found_flag[1]: true if next_hyperparameters corresponds to a converged solution
+    :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
+    :next_hyperparameters[n_hyper]: the new hyperparameters found by line search gradient descent
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void MultistartLineSearchGradientDescentHyperparameterOptimization(
+    const LogLikelihoodEvaluator& log_likelihood_evaluator,
+    const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
+    const LineSearchGradientDescentParameters& ls_parameters,
+    ClosedInterval const * restrict domain,
+    const ThreadSchedule& thread_schedule_in,
+    bool * restrict found_flag,
+    UniformRandomGenerator * uniform_generator,
+    double * restrict next_hyperparameters) {
+  if (unlikely(ls_parameters.num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", ls_parameters.num_multistarts, 1);
+  }
+
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters() + noise_variance.size();
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateLogLikelihoodMemory(
+      log_likelihood_evaluator.num_sampled(), log_likelihood_evaluator.num_derivatives(), num_hyperparameters,
+      false, thread_schedule_in.max_num_threads));
+
+  std::vector<double> initial_guesses(num_hyperparameters*ls_parameters.num_multistarts);
+  std::vector<ClosedInterval> domain_linearspace_bounds(domain, domain + num_hyperparameters);
+  ConvertFromLogToLinearDomainAndBuildInitialGuesses(num_hyperparameters, ls_parameters.num_multistarts,
+                                                     uniform_generator, &domain_linearspace_bounds, &initial_guesses);
+  TensorProductDomain domain_linearspace(domain_linearspace_bounds.data(), num_hyperparameters);
+
+  // we need 1 state object per thread
+  std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
+  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, noise_variance, thread_schedule.max_num_threads,
+                          &log_likelihood_state_vector);
+  OptimizationIOContainer io_container(log_likelihood_state_vector[0].GetProblemSize());
+  InitializeBestKnownPoint(log_likelihood_evaluator, initial_guesses.data(), num_hyperparameters,
+                           ls_parameters.num_multistarts, log_likelihood_state_vector.data(), &io_container);
+
+  LineSearchGradientDescentOptimizer<LogLikelihoodEvaluator, TensorProductDomain> ls_opt;
+  MultistartOptimizer<LineSearchGradientDescentOptimizer<LogLikelihoodEvaluator, TensorProductDomain> > multistart_optimizer;
+
+  multistart_optimizer.MultistartOptimize(ls_opt, log_likelihood_evaluator, ls_parameters,
+                                          domain_linearspace, thread_schedule,
+                                          initial_guesses.data(), ls_parameters.num_multistarts,
+                                          log_likelihood_state_vector.data(),
+                                          nullptr, &io_container);
+  *found_flag = io_container.found_flag;
+  std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
 }
 
 /*!\rst
@@ -1124,22 +1643,24 @@ OL_NONNULL_POINTERS void MultistartGradientDescentHyperparameterOptimization(
   | ``gamma = 1.01, time_factor = 1.0e-3`` should lead to good robustness at reasonable speed.  This should be a fairly safe default.
   | ``gamma = 1.05, time_factor = 1.0e-1`` will be several times faster but not as robust.
 
-  Let ``n_hyper = covariance.GetNumberOfHyperparameters();``
+  Let ``n_hyper = covariance.GetNumberOfHyperparameters() + noise_variance.size();``
 
   \param
     :log_likelihood_evaluator: object supporting evaluation of gradient + hessian of log likelihood
     :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
       covariance.GetCurrentHyperparameters() will be used to obtain the initial guess
+    :noise_variance[num_derivatives+1]: initial noise hyperparameters (the rest of the initial guess)
     :newton_parameters: NewtonParameters object that describes the parameters controlling hyperparameter optimization (e.g., number
       of iterations, tolerances, diagonal dominance)
     :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
   \output
     :next_hyperparameters[n_hyper]: the new hyperparameters found by newton
 \endrst*/
-/*template <typename LogLikelihoodEvaluator, typename DomainType>
+template <typename LogLikelihoodEvaluator, typename DomainType>
 OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonHyperparameterOptimization(
     const LogLikelihoodEvaluator& log_likelihood_evaluator,
     const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
     const NewtonParameters& newton_parameters,
     const DomainType& domain,
     double * restrict next_hyperparameters) {
@@ -1148,13 +1669,13 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonHyperparameterOptimization(
   }
 
   OL_VERBOSE_PRINTF("Hyperparameter Optimization via %s\n", OL_CURRENT_FUNCTION_NAME);
-  typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_evaluator, covariance);
+  typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_evaluator, covariance, noise_variance);
 
   NewtonOptimizer<LogLikelihoodEvaluator, DomainType> newton_opt;
   int errors = newton_opt.Optimize(log_likelihood_evaluator, newton_parameters, domain, &log_likelihood_state);
   log_likelihood_state.GetCurrentPoint(next_hyperparameters);
   return errors;
-}*/
+}
 
 /*!\rst
   Function to add multistarting on top of newton hyperparameter optimization.
@@ -1184,11 +1705,12 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonHyperparameterOptimization(
 
   .. Note:: the domain here must be specified in LOG-10 SPACE!
 
-  Let ``n_hyper = covariance.GetNumberOfHyperparameters();``
+  Let ``n_hyper = covariance.GetNumberOfHyperparameters() + noise_variance.size();``
 
   \param
     :log_likelihood_evaluator: object supporting evaluation of gradient + hessian of log likelihood
     :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data
+    :noise_variance[num_derivatives+1]: initial noise hyperparameters
     :newton_parameters: NewtonParameters object that describes the parameters controlling hyperparameter optimization (e.g., number
       of iterations, tolerances, diagonal dominance)
     :domain[n_hyper]: array of ClosedInterval specifying the boundaries of a n_hyper-dimensional tensor-product domain.
@@ -1201,13 +1723,14 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonHyperparameterOptimization(
     :uniform_generator[1]: UniformRandomGenerator object will have its state changed due to random draws
     :next_hyperparameters[n_hyper]: the new hyperparameters found by newton
 \endrst*/
-/*template <typename LogLikelihoodEvaluator>
+template <typename LogLikelihoodEvaluator>
 OL_NONNULL_POINTERS void MultistartNewtonHyperparameterOptimization(
     const LogLikelihoodEvaluator& log_likelihood_evaluator,
     const CovarianceInterface& covariance,
+    const std::vector<double> noise_variance,
     const NewtonParameters& newton_parameters,
     ClosedInterval const * restrict domain,
-    const ThreadSchedule& thread_schedule,
+    const ThreadSchedule& thread_schedule_in,
     bool * restrict found_flag,
     UniformRandomGenerator * uniform_generator,
     double * restrict next_hyperparameters) {
@@ -1215,7 +1738,10 @@ OL_NONNULL_POINTERS void MultistartNewtonHyperparameterOptimization(
     OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", newton_parameters.num_multistarts, 1);
   }
 
-  const int num_hyperparameters = covariance.GetNumberOfHyperparameters();
+  const int num_hyperparameters = covariance.GetNumberOfHyperparameters() + noise_variance.size();
+  const ThreadSchedule thread_schedule = AdmitThreadSchedule(thread_schedule_in, EstimateLogLikelihoodMemory(
+      log_likelihood_evaluator.num_sampled(), log_likelihood_evaluator.num_derivatives(), num_hyperparameters,
+      true, thread_schedule_in.max_num_threads));
   std::vector<double> initial_guesses(num_hyperparameters*newton_parameters.num_multistarts);
   std::vector<ClosedInterval> domain_linearspace_bounds(domain, domain + num_hyperparameters);
   ConvertFromLogToLinearDomainAndBuildInitialGuesses(num_hyperparameters, newton_parameters.num_multistarts,
@@ -1225,7 +1751,7 @@ OL_NONNULL_POINTERS void MultistartNewtonHyperparameterOptimization(
 
   // we need 1 state object per thread
   std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
-  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, thread_schedule.max_num_threads,
+  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, noise_variance, thread_schedule.max_num_threads,
                           &log_likelihood_state_vector);
 
   OptimizationIOContainer io_container(log_likelihood_state_vector[0].GetProblemSize());
@@ -1242,7 +1768,7 @@ OL_NONNULL_POINTERS void MultistartNewtonHyperparameterOptimization(
 
   *found_flag = io_container.found_flag;
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
-}*/
+}
 
 /*!\rst
   Function to evaluate various log likelihood measures over a specified list of num_multistarts hyperparameters.
@@ -1255,6 +1781,11 @@ OL_NONNULL_POINTERS void MultistartNewtonHyperparameterOptimization(
   This function is just a wrapper that builds the required state objects and a NullOptimizer object and calls
   MultistartOptimizer<...>::MultistartOptimize(...); see gpp_optimization.hpp.
 
+  Every state (one per thread) shares ``log_likelihood_evaluator``, which caches the hyperparameter-independent squared
+  coordinate differences of the training points (see PairwiseDifferences); so each of the num_multistarts evaluations
+  only rescales and exponentiates that cache (for covariances that override SymmetricCovarianceMatrix()) before its
+  Cholesky factorization.
+
   Let ``n_hyper = covariance.GetNumberOfHyperparameters();``
 
   \param
@@ -1308,6 +1839,89 @@ void EvaluateLogLikelihoodAtPointList(
   std::copy(io_container.best_point.begin(), io_container.best_point.end(), next_hyperparameters);
 }
 
+/*!\rst
+  Evaluates the log likelihood of every walker of an ensemble (e.g., the ``num_walkers`` proposals of one step of an
+  affine-invariant ensemble sampler), in parallel.
+
+  Unlike EvaluateLogLikelihoodAtPointList(), there is no best point bookkeeping and an unusable walker does not stop
+  the others: walkers with any non-positive or non-finite hyperparameter are not evaluated, and they and walkers whose
+  log likelihood is not finite (e.g., singular covariance matrix) get ``-infinity``, which samplers treat as zero
+  density.
+
+  One state object per thread is built once and reused by all of that thread's walkers (only SetHyperparameters() is
+  called per walker), and all states share ``log_likelihood_evaluator``'s cache of training point differences (see
+  EvaluateLogLikelihoodAtPointList()).  Results do not depend on the number of threads.
+
+  Let ``n_hyper = covariance.GetNumberOfHyperparameters() + num_derivatives + 1`` (noise variances last).
+
+  \param
+    :log_likelihood_evaluator: object supporting evaluation of log likelihood
+    :covariance: the CovarianceFunction object encoding assumptions about the GP's behavior on our data; only its
+      type (and size) is used, its hyperparameters are overwritten per walker
+    :noise_variance[num_derivatives+1]: initial noise variances of the states; overwritten per walker
+    :thread_schedule: struct instructing OpenMP on how to schedule threads; i.e., (suggestions in parens)
+      max_num_threads (num cpu cores), schedule type (omp_sched_static), chunk_size (0).
+    :hyperparameters[num_walkers][n_hyper]: hyperparameters (in linear space) of each walker
+    :num_walkers: number of walkers
+  \output
+    :log_likelihood[num_walkers]: log likelihood of each walker, ``-infinity`` as described above
+  \raise
+    if evaluating any walker throws, the first such exception is rethrown after all walkers are processed
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_NONNULL_POINTERS void EvaluateLogLikelihoodOfEnsemble(const LogLikelihoodEvaluator& log_likelihood_evaluator,
+                                                         const CovarianceInterface& covariance,
+                                                         const std::vector<double>& noise_variance,
+                                                         const ThreadSchedule& thread_schedule,
+                                                         double const * restrict hyperparameters, int num_walkers,
+                                                         double * restrict log_likelihood) {
+  if (unlikely(num_walkers <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_walkers must be > 0", num_walkers, 1);
+  }
+
+  std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
+  SetupLogLikelihoodState(log_likelihood_evaluator, covariance, noise_variance, thread_schedule.max_num_threads,
+                          &log_likelihood_state_vector);
+  const int num_hyperparameters = log_likelihood_state_vector[0].GetProblemSize();
+
+  // see MultistartOptimizer<...>::MultistartOptimize() for why exceptions must be captured inside the parallel region
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+  omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
+#pragma omp parallel num_threads(thread_schedule.max_num_threads)
+  {
+    typename LogLikelihoodEvaluator::StateType& log_likelihood_state = log_likelihood_state_vector[omp_get_thread_num()];
+
+#pragma omp for schedule(runtime)
+    for (int i = 0; i < num_walkers; ++i) {
+      double const * walker = hyperparameters + i*num_hyperparameters;
+      log_likelihood[i] = -std::numeric_limits<double>::infinity();
+      if (!std::all_of(walker, walker + num_hyperparameters, [](double value) {
+            return value > 0.0 && value < std::numeric_limits<double>::infinity();
+          })) {
+        continue;
+      }
+
+      try {
+        log_likelihood_state.SetHyperparameters(log_likelihood_evaluator, walker);
+        const double value = log_likelihood_evaluator.ComputeLogLikelihood(log_likelihood_state);
+        if (likely(std::isfinite(value))) {
+          log_likelihood[i] = value;
+        }
+      } catch (...) {
+        std::call_once(exception_capture_flag, [&captured_exception]() {
+          captured_exception = std::current_exception();
+        });
+      }
+    }
+  }  // end omp parallel
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+}
+
 /*!\rst
   Function to do a "dumb" search over num_multistarts points (generated on a Latin Hypercube) for the optimal set of
   hyperparameters (largest log likelihood).
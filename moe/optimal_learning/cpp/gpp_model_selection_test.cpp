@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -37,6 +38,7 @@
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
+#include "gpp_linear_algebra.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
 #include "gpp_mock_optimization_objective_functions.hpp"
@@ -387,15 +389,16 @@ class PingLogLikelihood final : public PingableMatrixInputVectorOutputInterface
 
   Hessians are tested against gradients, so ``GetOutputSize`` returns ``num_hyperparameters``.
 \endrst*/
-/*template <typename LogLikelihoodEvaluator, typename CovarianceClass>
+template <typename LogLikelihoodEvaluator, typename CovarianceClass>
 class PingHessianLogLikelihood final : public PingableMatrixInputVectorOutputInterface {
  public:
   using CovarianceType = CovarianceClass;
 
-  PingHessianLogLikelihood(const CovarianceClass& covariance, double const * restrict points_sampled, double const * restrict points_sampled_value, double const * restrict noise_variance, int dim, int num_sampled) OL_NONNULL_POINTERS
-      : num_hyperparameters_(covariance.GetNumberOfHyperparameters()),
+  PingHessianLogLikelihood(const CovarianceClass& covariance, double const * restrict points_sampled, double const * restrict points_sampled_value,
+                           int const * derivatives, int num_derivatives, int dim, int num_sampled) OL_NONNULL_POINTERS
+      : num_hyperparameters_(covariance.GetNumberOfHyperparameters()+1+num_derivatives),
         gradients_already_computed_(false),
-        log_likelihood_eval_(points_sampled, points_sampled_value, noise_variance, dim, num_sampled),
+        log_likelihood_eval_(points_sampled, points_sampled_value, derivatives, num_derivatives, dim, num_sampled),
         hessian_log_marginal_likelihood_(Square(num_hyperparameters_)) {
   }
 
@@ -419,7 +422,9 @@ class PingHessianLogLikelihood final : public PingableMatrixInputVectorOutputInt
     gradients_already_computed_ = true;
 
     CovarianceClass covariance_local(log_likelihood_eval_.dim(), hyperparameters[0], hyperparameters + 1);
-    typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval_, covariance_local);
+    std::vector<double> noise_variance(hyperparameters+log_likelihood_eval_.dim()+1,
+                                       hyperparameters+log_likelihood_eval_.dim()+2+log_likelihood_eval_.num_derivatives());
+    typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval_, covariance_local, noise_variance);
     log_likelihood_eval_.ComputeHessianLogLikelihood(&log_likelihood_state, hessian_log_marginal_likelihood_.data());
 
     if (gradients != nullptr) {
@@ -437,13 +442,15 @@ class PingHessianLogLikelihood final : public PingableMatrixInputVectorOutputInt
 
   virtual void EvaluateFunction(double const * restrict hyperparameters, double * restrict function_values) const noexcept override OL_NONNULL_POINTERS {
     CovarianceClass covariance_local(log_likelihood_eval_.dim(), hyperparameters[0], hyperparameters + 1);
-    typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval_, covariance_local);
+    std::vector<double> noise_variance(hyperparameters+log_likelihood_eval_.dim()+1,
+                                       hyperparameters+log_likelihood_eval_.dim()+2+log_likelihood_eval_.num_derivatives());
+    typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval_, covariance_local, noise_variance);
 
     log_likelihood_eval_.ComputeGradLogLikelihood(&log_likelihood_state, function_values);
   }
 
  private:
-  //! number of hyperparameters of the underlying covariance function
+  //! number of hyperparameters of the underlying covariance function plus the noise variances
   int num_hyperparameters_;
   //! whether gradients been computed and stored--whether this class is ready for use
   bool gradients_already_computed_;
@@ -455,7 +462,8 @@ class PingHessianLogLikelihood final : public PingableMatrixInputVectorOutputInt
   std::vector<double> hessian_log_marginal_likelihood_;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PingHessianLogLikelihood);
-};*/
+};
+
 
 
 
@@ -577,6 +585,257 @@ OL_WARN_UNUSED_RESULT int PingLogLikelihoodTest(char const * class_name, int num
   return total_errors;
 }
 
+/*!\rst
+  Checks the closed-form (``K^-1``-diagonal) leave-one-out pseudo-likelihood against brute force: for each observation,
+  the GP mean/variance are recomputed from ``K`` and ``y`` with that observation's row and column removed.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int LeaveOneOutLogLikelihoodBruteForceTest() {
+  const int dim = 3;
+  const int num_sampled = 7;
+  int derivatives[3] = {0, 1, 2};
+  const int num_derivatives = 3;
+  const int num_rows = num_sampled*(num_derivatives+1);
+  const double tolerance = 1.0e-9;
+  int total_errors = 0;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  UniformRandomGenerator uniform_generator(8675309);
+  boost::uniform_real<double> uniform_double(3.0, 5.0);
+  std::vector<double> lengths(dim);
+  std::vector<double> noise_variance(num_derivatives+1);
+  std::vector<double> K(Square(num_rows));
+  std::vector<double> K_loo(Square(num_rows-1));
+  std::vector<double> k_loo(num_rows-1);
+  std::vector<double> y_loo(num_rows-1);
+  std::vector<double> K_loo_inv_k(num_rows-1);
+  for (int trial = 0; trial < 10; ++trial) {
+    EI_environment.Initialize(dim, 1, 0, num_sampled, num_derivatives);
+    for (auto& length : lengths) {
+      length = uniform_double(uniform_generator.engine);
+    }
+    for (auto& noise : noise_variance) {
+      noise = 0.1*uniform_double(uniform_generator.engine);
+    }
+    SquareExponential sqexp(dim, uniform_double(uniform_generator.engine), lengths);
+    LeaveOneOutLogLikelihoodEvaluator log_likelihood_eval(EI_environment.points_sampled(),
+                                                          EI_environment.points_sampled_value(), derivatives,
+                                                          num_derivatives, dim, num_sampled);
+    LeaveOneOutLogLikelihoodState log_likelihood_state(log_likelihood_eval, sqexp, noise_variance);
+
+    // K = L * L^T, from the lower triangle of the state's cholesky factor
+    double const * restrict L = log_likelihood_state.K_chol.data();
+    for (int col = 0; col < num_rows; ++col) {
+      for (int row = 0; row < num_rows; ++row) {
+        double sum = 0.0;
+        for (int k = 0; k <= std::min(row, col); ++k) {
+          sum += L[k*num_rows + row]*L[k*num_rows + col];
+        }
+        K[col*num_rows + row] = sum;
+      }
+    }
+
+    double loo_brute_force = 0.0;
+    for (int i = 0; i < num_rows; ++i) {
+      // strip out row & column i
+      for (int col = 0, col_loo = 0; col < num_rows; ++col) {
+        if (col == i) {
+          continue;
+        }
+        for (int row = 0, row_loo = 0; row < num_rows; ++row) {
+          if (row == i) {
+            continue;
+          }
+          K_loo[col_loo*(num_rows-1) + row_loo] = K[col*num_rows + row];
+          ++row_loo;
+        }
+        k_loo[col_loo] = K[i*num_rows + col];
+        y_loo[col_loo] = log_likelihood_state.y[col];
+        ++col_loo;
+      }
+      if (ComputeCholeskyFactorL(num_rows-1, K_loo.data()) != 0) {
+        ++total_errors;
+        continue;
+      }
+      std::copy(k_loo.begin(), k_loo.end(), K_loo_inv_k.begin());
+      CholeskyFactorLMatrixVectorSolve(K_loo.data(), num_rows-1, K_loo_inv_k.data());
+      const double mean = DotProduct(K_loo_inv_k.data(), y_loo.data(), num_rows-1);
+      const double variance = K[i*num_rows + i] - DotProduct(K_loo_inv_k.data(), k_loo.data(), num_rows-1);
+      loo_brute_force += -0.5*std::log(variance) - 0.5*Square(log_likelihood_state.y[i] - mean)/variance - 0.5*kLog2Pi;
+    }
+
+    const double loo = log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state);
+    if (!CheckDoubleWithinRelative(loo, loo_brute_force, tolerance)) {
+      ++total_errors;
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("closed-form leave one out vs brute force failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("closed-form leave one out vs brute force passed\n");
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks LogMarginalLikelihoodEvaluator::SetDerivativeMask(): the masked log marginal likelihood must match brute force
+  (the likelihood of the observed rows of ``K`` and ``y`` alone) even with NaN in the masked values, and its gradient
+  and hessian must match central differences of the likelihood and gradient.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MaskedLogMarginalLikelihoodTest() {
+  const int dim = 3;
+  const int num_sampled = 7;
+  int derivatives[3] = {0, 1, 2};
+  const int num_derivatives = 3;
+  const int block_size = num_derivatives + 1;
+  const int num_rows = num_sampled*block_size;
+  const int num_hyperparameters = 1 + dim + block_size;
+  const double tolerance = 1.0e-10;
+  const double tolerance_difference = 1.0e-5;
+  const double epsilon = 1.0e-5;
+  int total_errors = 0;
+
+  // point 0 observes every derivative, point 1 none, the rest a rotating subset
+  std::vector<int> derivative_mask(num_sampled*num_derivatives);
+  std::vector<int> observed_rows;
+  for (int i = 0; i < num_sampled; ++i) {
+    observed_rows.push_back(i*block_size);
+    for (int m = 0; m < num_derivatives; ++m) {
+      derivative_mask[i*num_derivatives + m] = (i == 0) || (i != 1 && (i + m) % 3 != 0);
+      if (derivative_mask[i*num_derivatives + m] != 0) {
+        observed_rows.push_back(i*block_size + 1 + m);
+      }
+    }
+  }
+  const int num_observed = observed_rows.size();
+
+  MockExpectedImprovementEnvironment EI_environment;
+  UniformRandomGenerator uniform_generator(31415);
+  boost::uniform_real<double> uniform_double(3.0, 5.0);
+  std::vector<double> hyperparameters(num_hyperparameters);
+  std::vector<double> K(Square(num_rows));
+  std::vector<double> K_observed(Square(num_observed));
+  std::vector<double> y_observed(num_observed);
+  for (int trial = 0; trial < 5; ++trial) {
+    EI_environment.Initialize(dim, 1, 0, num_sampled, num_derivatives);
+    std::vector<double> values_garbage(EI_environment.points_sampled_value(),
+                                       EI_environment.points_sampled_value() + num_rows);
+    for (int i = 0; i < num_sampled; ++i) {
+      for (int m = 0; m < num_derivatives; ++m) {
+        if (derivative_mask[i*num_derivatives + m] == 0) {
+          values_garbage[i*block_size + 1 + m] = std::numeric_limits<double>::quiet_NaN();
+        }
+      }
+    }
+    for (int i = 0; i < num_hyperparameters; ++i) {
+      hyperparameters[i] = uniform_double(uniform_generator.engine)*(i <= dim ? 1.0 : 0.1);
+    }
+
+    LogMarginalLikelihoodEvaluator log_likelihood_eval(EI_environment.points_sampled(),
+                                                       EI_environment.points_sampled_value(), derivatives,
+                                                       num_derivatives, dim, num_sampled);
+    LogMarginalLikelihoodEvaluator log_likelihood_eval_masked(EI_environment.points_sampled(), values_garbage.data(),
+                                                              derivatives, num_derivatives, dim, num_sampled);
+    log_likelihood_eval_masked.SetDerivativeMask(derivative_mask.data());
+    if (log_likelihood_eval_masked.num_observed_rows() != num_observed) {
+      ++total_errors;
+    }
+
+    auto build_state = [&](const LogMarginalLikelihoodEvaluator& log_likelihood_eval_local,
+                           double const * hyperparameters_local) {
+      SquareExponential sqexp(dim, hyperparameters_local[0], hyperparameters_local + 1);
+      std::vector<double> noise_variance(hyperparameters_local + 1 + dim,
+                                         hyperparameters_local + num_hyperparameters);
+      return LogMarginalLikelihoodState(log_likelihood_eval_local, sqexp, noise_variance);
+    };
+
+    // brute force: K = L * L^T from the unmasked state, restricted to the observed rows
+    LogMarginalLikelihoodState log_likelihood_state = build_state(log_likelihood_eval, hyperparameters.data());
+    double const * restrict L = log_likelihood_state.K_chol.data();
+    for (int col = 0; col < num_rows; ++col) {
+      for (int row = 0; row < num_rows; ++row) {
+        double sum = 0.0;
+        for (int k = 0; k <= std::min(row, col); ++k) {
+          sum += L[k*num_rows + row]*L[k*num_rows + col];
+        }
+        K[col*num_rows + row] = sum;
+      }
+    }
+    for (int j = 0; j < num_observed; ++j) {
+      for (int i = 0; i < num_observed; ++i) {
+        K_observed[j*num_observed + i] = K[observed_rows[j]*num_rows + observed_rows[i]];
+      }
+      y_observed[j] = log_likelihood_state.y[observed_rows[j]];
+    }
+    if (ComputeCholeskyFactorL(num_observed, K_observed.data()) != 0) {
+      ++total_errors;
+      continue;
+    }
+    std::vector<double> K_inv_y_observed(y_observed);
+    CholeskyFactorLMatrixVectorSolve(K_observed.data(), num_observed, K_inv_y_observed.data());
+    double log_likelihood_brute_force = -0.5*DotProduct(y_observed.data(), K_inv_y_observed.data(), num_observed) -
+        0.5*static_cast<double>(num_observed)*kLog2Pi;
+    for (int i = 0; i < num_observed; ++i) {
+      log_likelihood_brute_force -= std::log(K_observed[i*num_observed + i]);
+    }
+
+    LogMarginalLikelihoodState log_likelihood_state_masked = build_state(log_likelihood_eval_masked,
+                                                                         hyperparameters.data());
+    const double log_likelihood = log_likelihood_eval_masked.ComputeLogLikelihood(log_likelihood_state_masked);
+    if (!CheckDoubleWithinRelative(log_likelihood, log_likelihood_brute_force, tolerance)) {
+      OL_PARTIAL_FAILURE_PRINTF("masked log marginal %.18E vs brute force %.18E\n", log_likelihood,
+                                log_likelihood_brute_force);
+      ++total_errors;
+    }
+
+    // gradient and hessian vs central differences
+    std::vector<double> gradient(num_hyperparameters);
+    std::vector<double> hessian(Square(num_hyperparameters));
+    log_likelihood_eval_masked.ComputeGradLogLikelihood(&log_likelihood_state_masked, gradient.data());
+    log_likelihood_eval_masked.ComputeHessianLogLikelihood(&log_likelihood_state_masked, hessian.data());
+    std::vector<double> gradient_plus(num_hyperparameters), gradient_minus(num_hyperparameters);
+    for (int k = 0; k < num_hyperparameters; ++k) {
+      const double h = epsilon*hyperparameters[k];
+      std::vector<double> hyperparameters_plus(hyperparameters), hyperparameters_minus(hyperparameters);
+      hyperparameters_plus[k] += h;
+      hyperparameters_minus[k] -= h;
+      LogMarginalLikelihoodState state_plus = build_state(log_likelihood_eval_masked, hyperparameters_plus.data());
+      LogMarginalLikelihoodState state_minus = build_state(log_likelihood_eval_masked, hyperparameters_minus.data());
+      const double gradient_difference = (log_likelihood_eval_masked.ComputeLogLikelihood(state_plus) -
+                                          log_likelihood_eval_masked.ComputeLogLikelihood(state_minus))/(2.0*h);
+      if (!CheckDoubleWithinRelative(gradient[k], gradient_difference, tolerance_difference)) {
+        OL_PARTIAL_FAILURE_PRINTF("masked log marginal gradient %d: %.18E vs difference %.18E\n", k, gradient[k],
+                                  gradient_difference);
+        ++total_errors;
+      }
+      log_likelihood_eval_masked.ComputeGradLogLikelihood(&state_plus, gradient_plus.data());
+      log_likelihood_eval_masked.ComputeGradLogLikelihood(&state_minus, gradient_minus.data());
+      for (int j = 0; j < num_hyperparameters; ++j) {
+        const double hessian_difference = (gradient_plus[j] - gradient_minus[j])/(2.0*h);
+        if (!CheckDoubleWithinRelative(hessian[k*num_hyperparameters + j], hessian_difference,
+                                       tolerance_difference)) {
+          OL_PARTIAL_FAILURE_PRINTF("masked log marginal hessian (%d, %d): %.18E vs difference %.18E\n", j, k,
+                                    hessian[k*num_hyperparameters + j], hessian_difference);
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("masked log marginal likelihood failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("masked log marginal likelihood passed\n");
+  }
+  return total_errors;
+}
+
 }  // end unnamed namespace
 
 int RunLogLikelihoodPingTests() {
@@ -604,6 +863,30 @@ int RunLogLikelihoodPingTests() {
     total_errors += current_errors;
   }
 
+  {
+    double epsilon_log_marginal[2] = {1.0e-2, 2.0e-3};
+    current_errors = PingLogLikelihoodTest<PingHessianLogLikelihood<LogMarginalLikelihoodEvaluator, SquareExponential> >("Log Marginal Likelihood Hessian sqexp", 4, epsilon_log_marginal, 5.0e-4, 1.0e-3, 1.0e-18);
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("pinging log marginal hessian failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  {
+    double epsilon_leave_one_out[2] = {1.0e-2, 2.0e-3};
+    current_errors = PingLogLikelihoodTest<PingLogLikelihood<LeaveOneOutLogLikelihoodEvaluator, SquareExponential> >("Leave One Out Log Likelihood sqexp", 4, epsilon_leave_one_out, 5.0e-4, 1.0e-3, 1.0e-18);
+    if (current_errors != 0) {
+      OL_PARTIAL_FAILURE_PRINTF("pinging leave one out failed with %d errors\n", current_errors);
+    }
+    total_errors += current_errors;
+  }
+
+  current_errors = LeaveOneOutLogLikelihoodBruteForceTest();
+  total_errors += current_errors;
+
+  current_errors = MaskedLogMarginalLikelihoodTest();
+  total_errors += current_errors;
+
 /*
   {
     double epsilon_log_marginal[2] = {1.0e-2, 2.0e-3};
@@ -641,12 +924,6 @@ int RunLogLikelihoodPingTests() {
     total_errors += current_errors;
   }
 
-  {
-    double epsilon_log_marginal[2] = {1.0e-2, 2.0e-3};
-    current_errors = PingLogLikelihoodTest<PingHessianLogLikelihood<LogMarginalLikelihoodEvaluator, MaternNu2p5> >("Log Marginal Likelihood Hessian sqexp", 4, epsilon_log_marginal, 3.0e-2, 3.0e-2, 1.0e-18);
-    if (current_errors != 0) {
-      OL_PARTIAL_FAILURE_PRINTF("pinging log marginal hessian failed with %d errors\n", current_errors);
-    }
     total_errors += current_errors;
   }
 */
@@ -1236,26 +1513,32 @@ OL_WARN_UNUSED_RESULT int HyperparameterLikelihoodNewtonOptimizationTestCore(Log
     6. Verify that the log marginal likelihood after multistart optimization is better than the likelihood at the
        hyperparameters from step 0 (since these are not optimal)
 \endrst*/
-/*template <typename LogLikelihoodEvaluator, typename CovarianceClass>
+template <typename LogLikelihoodEvaluator, typename CovarianceClass>
 OL_WARN_UNUSED_RESULT int MultistartHyperparameterLikelihoodNewtonOptimizationTestCore(LogLikelihoodTypes OL_UNUSED(objective_mode)) {
   using DomainType = TensorProductDomain;
   using HyperparameterDomainType = TensorProductDomain;
   const int num_sampled = 42;
   const int dim = 2;
 
+
+  int * derivatives = new int[2]{0,1};
+  int num_derivatives = 2;
+  std::vector<int> input_derivatives(derivatives, derivatives+num_derivatives);
+
+
   double initial_likelihood;
   double final_likelihood;
 
-  // gradient descent parameters
-  const double gamma = 1.1;
-  const double pre_mult = 1.0e-1;
+  // newton parameters; the robust defaults recommended in NewtonHyperparameterOptimization()'s docs
+  const double gamma = 1.01;
+  const double time_factor = 1.0e-3;
   const double max_relative_change = 1.0;
-  const double tolerance = 1.0e-14;
-  const int max_newton_steps = 100;
+  const double tolerance = 1.0e-13;
+  const int max_newton_steps = 1000;
   const int num_multistarts = 16;
-  NewtonParameters newton_parameters(num_multistarts, max_newton_steps, gamma, pre_mult, max_relative_change, tolerance);
+  NewtonParameters newton_parameters(num_multistarts, max_newton_steps, gamma, time_factor, max_relative_change, tolerance);
 
-  const int max_num_threads = 4;
+  const int max_num_threads = 16;
   ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
 
   int total_errors = 0;
@@ -1267,36 +1550,45 @@ OL_WARN_UNUSED_RESULT int MultistartHyperparameterLikelihoodNewtonOptimizationTe
   boost::uniform_real<double> uniform_double_lower_bound(-2.0, 0.5);
   boost::uniform_real<double> uniform_double_upper_bound(2.0, 3.5);
 
-  std::vector<double> noise_variance(num_sampled, 0.1);
-  MockGaussianProcessPriorData<DomainType> mock_gp_data(CovarianceClass(dim, 1.0, 1.0), noise_variance, dim,
-                                                        num_sampled, uniform_double_lower_bound,
-                                                        uniform_double_upper_bound,
+  //std::vector<double> noise_variance(num_sampled, 0.1);
+
+  MockGaussianProcessPriorData<DomainType> mock_gp_data(CovarianceClass(dim, 1.0, 1.0), input_derivatives, num_derivatives, dim, num_sampled,
+                                                        uniform_double_lower_bound, uniform_double_upper_bound,
                                                         uniform_double_hyperparameter, &uniform_generator);
-  int num_hyperparameters = mock_gp_data.covariance_ptr->GetNumberOfHyperparameters();
+
+  int num_hyperparameters = mock_gp_data.covariance_ptr->GetNumberOfHyperparameters() + num_derivatives + 1;
 
   std::vector<double> hyperparameters_truth(num_hyperparameters);  // truth hyperparameters
   std::vector<double> hyperparameters_optimized(num_hyperparameters);  // optimized hyperparameters
   std::vector<double> hyperparameters_temp(num_hyperparameters);  // temp hyperparameters
 
+
+  std::vector<double> noise_variance_truth(num_derivatives+1, 1.0);  // optimized hyperparameters
+  std::vector<double> noise_variance_optimizzed(num_derivatives+1, 1.0);  // temp hyperparameters
+  std::vector<double> noise_variance_temp(num_derivatives+1, 1.0);  // wrong hyperparameters to start gradient descent
+
+
   // set up domain; allows initial guesses to range over [0.01, 10]
   std::vector<ClosedInterval> hyperparameter_log_domain_bounds(num_hyperparameters, {-2.0, 1.0});
   std::vector<ClosedInterval> hyperparameter_domain_bounds(hyperparameter_log_domain_bounds);
   for (auto& interval : hyperparameter_domain_bounds) {
     interval = {std::pow(10.0, interval.min), std::pow(10.0, interval.max)};
   }
+
   HyperparameterDomainType hyperparameter_domain(hyperparameter_domain_bounds.data(), num_hyperparameters);
 
   LogLikelihoodEvaluator log_likelihood_eval(mock_gp_data.gaussian_process_ptr->points_sampled().data(),
                                              mock_gp_data.gaussian_process_ptr->points_sampled_value().data(),
-                                             mock_gp_data.gaussian_process_ptr->noise_variance().data(),
-                                             dim, num_sampled);
-  typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval, *mock_gp_data.covariance_ptr);
+                                             derivatives, num_derivatives, dim, num_sampled);
+
+  typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance);
 
   initial_likelihood = log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state);
   OL_VERBOSE_PRINTF("initial likelihood: %.18E\n", initial_likelihood);
 
   bool found_flag = false;
-  MultistartNewtonHyperparameterOptimization(log_likelihood_eval, *mock_gp_data.covariance_ptr,
+
+  MultistartNewtonHyperparameterOptimization(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance,
                                              newton_parameters, hyperparameter_log_domain_bounds.data(),
                                              thread_schedule, &found_flag, &uniform_generator,
                                              hyperparameters_optimized.data());
@@ -1329,7 +1621,8 @@ OL_WARN_UNUSED_RESULT int MultistartHyperparameterLikelihoodNewtonOptimizationTe
   total_errors += current_errors;
 
   // verify that convergence occurred, start from the hyperparameters used to generate data (real solution should be nearby)
-  total_errors += NewtonHyperparameterOptimization(log_likelihood_eval, *mock_gp_data.covariance_ptr, newton_parameters, hyperparameter_domain, hyperparameters_truth.data());
+  total_errors += NewtonHyperparameterOptimization(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance,
+                                                   newton_parameters, hyperparameter_domain, hyperparameters_truth.data());
 #ifdef OL_VERBOSE_PRINT
   PrintMatrix(hyperparameters_truth.data(), 1, num_hyperparameters);
 #endif
@@ -1373,13 +1666,12 @@ OL_WARN_UNUSED_RESULT int MultistartHyperparameterLikelihoodNewtonOptimizationTe
 
     // build state vector
     std::vector<typename LogLikelihoodEvaluator::StateType> log_likelihood_state_vector;
-    SetupLogLikelihoodState(log_likelihood_eval, *mock_gp_data.covariance_ptr,
+    SetupLogLikelihoodState(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance,
                             thread_schedule.max_num_threads, &log_likelihood_state_vector);
 
     OptimizationIOContainer io_container(log_likelihood_state_vector[0].GetProblemSize());
     InitializeBestKnownPoint(log_likelihood_eval, initial_guesses.data(), num_hyperparameters,
-                             newton_parameters.num_multistarts,
-                             log_likelihood_state_vector.data(), &io_container);
+                             newton_parameters.num_multistarts, log_likelihood_state_vector.data(), &io_container);
 
     io_container.found_flag = true;  // want to see that this flag is flipped to false
 
@@ -1407,8 +1699,10 @@ OL_WARN_UNUSED_RESULT int MultistartHyperparameterLikelihoodNewtonOptimizationTe
     }
   }
 
+  delete [] derivatives;
+
   return total_errors;
-}*/
+}
 
 
 }  // end unnamed namespace
@@ -1462,6 +1756,9 @@ int HyperparameterLikelihoodOptimizationTest(OptimizerTypes optimizer_type, LogL
 int HyperparameterLikelihoodOptimizationTest(OptimizerTypes optimizer_type, LogLikelihoodTypes objective_mode) {
     int current_errors = 0;
     int total_errors = 0;
+    if (optimizer_type == OptimizerTypes::kNewton) {
+      return MultistartHyperparameterLikelihoodNewtonOptimizationTestCore<LogMarginalLikelihoodEvaluator, SquareExponential>(objective_mode);
+    }
     current_errors = HyperparameterLikelihoodOptimizationTestCore<LogMarginalLikelihoodEvaluator, SquareExponential>(objective_mode);
     total_errors += current_errors;
 
@@ -1470,6 +1767,135 @@ int HyperparameterLikelihoodOptimizationTest(OptimizerTypes optimizer_type, LogL
     return total_errors;
 }
 
+int HyperparameterRefitTest() {
+  const int dim = 2;
+  const int num_sampled = 24;
+  int derivatives[1] = {0};
+  const int num_derivatives = 1;
+  std::vector<int> input_derivatives(derivatives, derivatives + num_derivatives);
+  const double tolerance = 1.0e-6;
+  int total_errors = 0;
+
+  LBFGSBParameters lbfgsb_parameters(16, 200, 10, 40, 1.0e-10);
+  GradientDescentParameters gd_parameters(16, 1000, 5, 0, 0.5, 0.5, 0.02, 1.0e-10);
+  // a full search at least every 3rd refit
+  HyperparameterRefitParameters refit_parameters(3, 4, 0.2, 0.5);
+  HyperparameterRefitState refit_state(refit_parameters);
+  ThreadSchedule thread_schedule(4, omp_sched_dynamic);
+
+  UniformRandomGenerator uniform_generator(4181);
+  boost::uniform_real<double> uniform_double_hyperparameter(1.0, 2.5);
+  boost::uniform_real<double> uniform_double_lower_bound(-2.0, 0.5);
+  boost::uniform_real<double> uniform_double_upper_bound(2.0, 3.5);
+  MockGaussianProcessPriorData<TensorProductDomain> mock_gp_data(SquareExponential(dim, 1.0, 1.0), input_derivatives,
+                                                                 num_derivatives, dim, num_sampled,
+                                                                 uniform_double_lower_bound,
+                                                                 uniform_double_upper_bound,
+                                                                 uniform_double_hyperparameter, &uniform_generator);
+  double const * points_sampled = mock_gp_data.gaussian_process_ptr->points_sampled().data();
+  double const * points_sampled_value = mock_gp_data.gaussian_process_ptr->points_sampled_value().data();
+
+  const int num_hyperparameters = 1 + dim + num_derivatives + 1;
+  std::vector<ClosedInterval> hyperparameter_log_domain_bounds(num_hyperparameters, {-2.0, 1.0});
+  std::vector<double> hyperparameters(num_hyperparameters);
+  std::vector<double> hyperparameters_full(num_hyperparameters);
+  std::vector<double> hyperparameters_previous(num_hyperparameters);
+  mock_gp_data.covariance_ptr->GetHyperparameters(hyperparameters.data());
+  std::copy(mock_gp_data.noise_variance.begin(), mock_gp_data.noise_variance.end(), hyperparameters.begin() + 1 + dim);
+
+  auto log_likelihood_at = [&](const LogMarginalLikelihoodEvaluator& log_likelihood_eval,
+                               const std::vector<double>& hyperparameters_local) {
+    SquareExponential sqexp(dim, hyperparameters_local[0], hyperparameters_local.data() + 1);
+    std::vector<double> noise_variance(hyperparameters_local.begin() + 1 + dim, hyperparameters_local.end());
+    LogMarginalLikelihoodState log_likelihood_state(log_likelihood_eval, sqexp, noise_variance);
+    return log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state);
+  };
+  // one refit from the current hyperparameters; lbfgsb selects the L-BFGS-B path, else gradient descent
+  auto refit = [&](const LogMarginalLikelihoodEvaluator& log_likelihood_eval, bool lbfgsb) {
+    SquareExponential sqexp(dim, hyperparameters[0], hyperparameters.data() + 1);
+    std::vector<double> noise_variance(hyperparameters.begin() + 1 + dim, hyperparameters.end());
+    hyperparameters_previous = hyperparameters;
+    bool found_flag = false;
+    if (lbfgsb) {
+      MultistartLBFGSBHyperparameterOptimization(log_likelihood_eval, sqexp, noise_variance, lbfgsb_parameters,
+                                                 hyperparameter_log_domain_bounds.data(), thread_schedule,
+                                                 &refit_state, &found_flag, &uniform_generator,
+                                                 hyperparameters.data());
+    } else {
+      MultistartGradientDescentHyperparameterOptimization(log_likelihood_eval, sqexp, noise_variance, gd_parameters,
+                                                          hyperparameter_log_domain_bounds.data(), thread_schedule,
+                                                          &refit_state, &found_flag, &uniform_generator,
+                                                          hyperparameters.data());
+    }
+    return found_flag;
+  };
+
+  // 1. the first refit is a full search
+  LogMarginalLikelihoodEvaluator log_likelihood_eval_first(points_sampled, points_sampled_value, derivatives,
+                                                           num_derivatives, dim, num_sampled - 2);
+  if (!refit(log_likelihood_eval_first, true) || !refit_state.last_refit_was_full_search()) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit: first refit was not a converged full search\n");
+    ++total_errors;
+  }
+
+  // 2. one more point: a warm refit, which must improve on the previous optimum and match a full search
+  LogMarginalLikelihoodEvaluator log_likelihood_eval_second(points_sampled, points_sampled_value, derivatives,
+                                                            num_derivatives, dim, num_sampled - 1);
+  refit(log_likelihood_eval_second, true);
+  {
+    bool found_flag = false;
+    SquareExponential sqexp(dim, hyperparameters_previous[0], hyperparameters_previous.data() + 1);
+    std::vector<double> noise_variance(hyperparameters_previous.begin() + 1 + dim, hyperparameters_previous.end());
+    MultistartLBFGSBHyperparameterOptimization(log_likelihood_eval_second, sqexp, noise_variance, lbfgsb_parameters,
+                                               hyperparameter_log_domain_bounds.data(), thread_schedule, &found_flag,
+                                               &uniform_generator, hyperparameters_full.data());
+  }
+  const double log_likelihood_warm = log_likelihood_at(log_likelihood_eval_second, hyperparameters);
+  const double log_likelihood_full = log_likelihood_at(log_likelihood_eval_second, hyperparameters_full);
+  if (refit_state.last_refit_was_full_search() ||
+      log_likelihood_warm < log_likelihood_at(log_likelihood_eval_second, hyperparameters_previous) ||
+      !CheckDoubleWithinRelative(log_likelihood_warm, log_likelihood_full, tolerance)) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit: warm refit %.18E vs full search %.18E\n", log_likelihood_warm,
+                              log_likelihood_full);
+    ++total_errors;
+  }
+
+  // 3. gradient descent path: one more warm refit, then the interval forces a full search
+  LogMarginalLikelihoodEvaluator log_likelihood_eval_all(points_sampled, points_sampled_value, derivatives,
+                                                         num_derivatives, dim, num_sampled);
+  refit(log_likelihood_eval_all, false);
+  if (refit_state.last_refit_was_full_search()) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit: gradient descent refit was not warm\n");
+    ++total_errors;
+  }
+  refit(log_likelihood_eval_all, false);
+  if (!refit_state.last_refit_was_full_search()) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit: full_search_interval did not force a full search\n");
+    ++total_errors;
+  }
+
+  // 4. data the previous optimum fits badly (values scaled up) force a full search
+  std::vector<double> values_scaled(points_sampled_value, points_sampled_value + num_sampled*(1 + num_derivatives));
+  for (auto& value : values_scaled) {
+    value *= 30.0;
+  }
+  LogMarginalLikelihoodEvaluator log_likelihood_eval_scaled(points_sampled, values_scaled.data(), derivatives,
+                                                            num_derivatives, dim, num_sampled);
+  refit(log_likelihood_eval_scaled, true);
+  if (!refit_state.last_refit_was_full_search() || refit_state.num_refits() != 5 ||
+      refit_state.num_full_searches() != 3) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit: a likelihood drop did not force a full search\n");
+    ++total_errors;
+  }
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("hyperparameter refit failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("hyperparameter refit passed\n");
+  }
+  return total_errors;
+}
+
 int EvaluateLogLikelihoodAtPointListTest() {
   using DomainType = TensorProductDomain;
   using HyperparameterDomainType = TensorProductDomain;
@@ -1580,4 +2006,99 @@ int EvaluateLogLikelihoodAtPointListTest() {
   return total_errors;
 }
 
+namespace {  // EvaluateLogLikelihoodOfEnsembleTest() core
+
+/*!\rst
+  EvaluateLogLikelihoodOfEnsemble() with a LogLikelihoodEvaluator on random walkers, some of them invalid.
+
+  \return
+    number of walkers whose log likelihood is wrong
+\endrst*/
+template <typename LogLikelihoodEvaluator>
+OL_WARN_UNUSED_RESULT int EvaluateLogLikelihoodOfEnsembleTestCore() {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+  const int num_sampled = 14;
+  const int num_walkers = 37;
+  const double tolerance = 1.0e-13;
+  std::vector<int> derivatives = {1};
+  const int num_derivatives = derivatives.size();
+
+  UniformRandomGenerator uniform_generator(8219);
+  boost::uniform_real<double> uniform_double_hyperparameter(0.4, 1.3);
+  boost::uniform_real<double> uniform_double_lower_bound(-2.0, 0.5);
+  boost::uniform_real<double> uniform_double_upper_bound(2.0, 3.5);
+  MockGaussianProcessPriorData<DomainType> mock_gp_data(SquareExponential(dim, 1.0, 1.0), derivatives, num_derivatives,
+                                                        dim, num_sampled, uniform_double_lower_bound,
+                                                        uniform_double_upper_bound, uniform_double_hyperparameter,
+                                                        &uniform_generator);
+  LogLikelihoodEvaluator log_likelihood_eval(mock_gp_data.gaussian_process_ptr->points_sampled().data(),
+                                             mock_gp_data.gaussian_process_ptr->points_sampled_value().data(),
+                                             derivatives.data(), num_derivatives, dim, num_sampled);
+
+  const int num_hyperparameters = mock_gp_data.covariance_ptr->GetNumberOfHyperparameters() + num_derivatives + 1;
+  boost::uniform_real<double> uniform_double_walker(0.1, 2.0);
+  std::vector<double> hyperparameters(num_walkers*num_hyperparameters);
+  for (auto& entry : hyperparameters) {
+    entry = uniform_double_walker(uniform_generator.engine);
+  }
+  // invalid walkers: a negative length, a zero noise variance, an infinite signal variance
+  hyperparameters[3*num_hyperparameters + 1] = -0.5;
+  hyperparameters[10*num_hyperparameters + num_hyperparameters - 1] = 0.0;
+  hyperparameters[(num_walkers - 1)*num_hyperparameters] = std::numeric_limits<double>::infinity();
+  const std::vector<int> invalid_walkers = {3, 10, num_walkers - 1};
+
+  static const int kMaxNumThreads = 4;
+  std::vector<double> log_likelihood(num_walkers);
+  EvaluateLogLikelihoodOfEnsemble(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance,
+                                  ThreadSchedule(kMaxNumThreads, omp_sched_dynamic), hyperparameters.data(),
+                                  num_walkers, log_likelihood.data());
+  std::vector<double> log_likelihood_single_thread(num_walkers);
+  EvaluateLogLikelihoodOfEnsemble(log_likelihood_eval, *mock_gp_data.covariance_ptr, mock_gp_data.noise_variance,
+                                  ThreadSchedule(1, omp_sched_static), hyperparameters.data(), num_walkers,
+                                  log_likelihood_single_thread.data());
+
+  int total_errors = 0;
+  for (int i = 0; i < num_walkers; ++i) {
+    // reused states must give exactly the same result in any order
+    if (log_likelihood[i] != log_likelihood_single_thread[i]) {
+      ++total_errors;
+    }
+
+    if (std::find(invalid_walkers.begin(), invalid_walkers.end(), i) != invalid_walkers.end()) {
+      if (log_likelihood[i] != -std::numeric_limits<double>::infinity()) {
+        ++total_errors;
+      }
+      continue;
+    }
+    typename LogLikelihoodEvaluator::StateType log_likelihood_state(log_likelihood_eval,
+                                                                    *mock_gp_data.covariance_ptr,
+                                                                    mock_gp_data.noise_variance);
+    log_likelihood_state.SetHyperparameters(log_likelihood_eval, hyperparameters.data() + i*num_hyperparameters);
+    const double log_likelihood_truth = log_likelihood_eval.ComputeLogLikelihood(log_likelihood_state);
+    if (!CheckDoubleWithinRelative(log_likelihood[i], log_likelihood_truth, tolerance)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int EvaluateLogLikelihoodOfEnsembleTest() {
+  int total_errors = 0;
+  int current_errors = EvaluateLogLikelihoodOfEnsembleTestCore<LogMarginalLikelihoodEvaluator>();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("log marginal likelihood of ensemble failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = EvaluateLogLikelihoodOfEnsembleTestCore<LeaveOneOutLogLikelihoodEvaluator>();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("leave one out log likelihood of ensemble failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+  return total_errors;
+}
+
 }  // end namespace optimal_learning
@@ -58,6 +58,17 @@ OL_WARN_UNUSED_RESULT int RunLogLikelihoodPingTests();
 \endrst*/
 OL_WARN_UNUSED_RESULT int HyperparameterLikelihoodOptimizationTest(OptimizerTypes optimizer_type, LogLikelihoodTypes objective_mode);
 
+/*!\rst
+  Tests the refit overloads of MultistartLBFGSBHyperparameterOptimization() and
+  MultistartGradientDescentHyperparameterOptimization(): the first refit is a full search, a refit after one new point
+  is warm-started and matches a full search, and ``full_search_interval`` and a likelihood drop both force full
+  searches.
+
+  \return
+    number of test failures: 0 if warm-started refits are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int HyperparameterRefitTest();
+
 /*!\rst
   Tests EvaluateLogLikelihoodAtPointList (computes log likelihood at a specified list of hyperparameters, multithreaded).
   Checks that the returned best point is in fact the best.
@@ -68,6 +79,15 @@ OL_WARN_UNUSED_RESULT int HyperparameterLikelihoodOptimizationTest(OptimizerType
 \endrst*/
 OL_WARN_UNUSED_RESULT int EvaluateLogLikelihoodAtPointListTest();
 
+/*!\rst
+  Tests EvaluateLogLikelihoodOfEnsemble (log likelihood of every walker of an ensemble, multithreaded).
+  Checks each walker against a single evaluation, that invalid walkers get ``-infinity``, and multithreaded consistency.
+
+  \return
+    number of test failures: 0 if ensemble evaluation is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int EvaluateLogLikelihoodOfEnsembleTest();
+
 }  // end namespace optimal_learning
 
 #endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SELECTION_TEST_HPP_
@@ -0,0 +1,325 @@
+/*!
+  \file gpp_model_snapshot.cpp
+  \rst
+  Implementation of the snapshot writer and of ModelSnapshot; see gpp_model_snapshot.hpp for the file layout.
+
+  Writing goes through std::ofstream; reading maps the whole file with POSIX ``mmap`` (``PROT_READ``, ``MAP_SHARED``)
+  and checks, before any accessor can be used, that every section lies inside the file.
+\endrst*/
+
+#include "gpp_model_snapshot.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_math.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+constexpr char kModelSnapshotMagic[8] = {'O', 'L', 'G', 'P', 'S', 'N', 'A', 'P'};
+
+std::uint64_t AlignSnapshotOffset(std::uint64_t offset) noexcept OL_CONST_FUNCTION OL_WARN_UNUSED_RESULT;
+
+std::uint64_t AlignSnapshotOffset(std::uint64_t offset) noexcept {
+  return (offset + kModelSnapshotAlignment - 1)/kModelSnapshotAlignment*kModelSnapshotAlignment;
+}
+
+/*!\rst
+  Identifies the type of ``covariance``.
+
+  \raise
+    OptimalLearningException if it is none of the types a snapshot can describe
+\endrst*/
+ModelSnapshotCovariance SnapshotCovarianceOf(const CovarianceInterface& covariance) OL_WARN_UNUSED_RESULT;
+
+ModelSnapshotCovariance SnapshotCovarianceOf(const CovarianceInterface& covariance) {
+  if (dynamic_cast<const SquareExponential *>(&covariance) != nullptr) {
+    return ModelSnapshotCovariance::kSquareExponential;
+  } else if (dynamic_cast<const MaternNu1p5 *>(&covariance) != nullptr) {
+    return ModelSnapshotCovariance::kMaternNu1p5;
+  } else if (dynamic_cast<const MaternNu2p5 *>(&covariance) != nullptr) {
+    return ModelSnapshotCovariance::kMaternNu2p5;
+  }
+  OL_THROW_EXCEPTION(OptimalLearningException, "Covariance type cannot be stored in a model snapshot.");
+}
+
+/*!\rst
+  Writes ``gaussian_processes`` (all over the same training data, which is taken from the first) to ``filename``.
+\endrst*/
+void WriteModelSnapshotOfGaussianProcesses(GaussianProcess const * const * gaussian_processes, int num_models,
+                                           ModelSnapshotKind kind, const std::string& filename) {
+  const GaussianProcess& first = *gaussian_processes[0];
+  const ModelSnapshotCovariance covariance = SnapshotCovarianceOf(*first.covariance_ptr_);
+  for (int i = 0; i < num_models; ++i) {
+    if (unlikely(gaussian_processes[i]->is_sparse())) {
+      OL_THROW_EXCEPTION(OptimalLearningException, "FITC (sparse) GPs cannot be stored in a model snapshot.");
+    }
+    if (unlikely(gaussian_processes[i]->is_grid())) {
+      OL_THROW_EXCEPTION(OptimalLearningException, "Grid (Kronecker) GPs cannot be stored in a model snapshot.");
+    }
+    if (unlikely(SnapshotCovarianceOf(*gaussian_processes[i]->covariance_ptr_) != covariance)) {
+      OL_THROW_EXCEPTION(OptimalLearningException, "Every GP of a model snapshot must have the same covariance type.");
+    }
+  }
+
+  ModelSnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kModelSnapshotMagic, sizeof(header.magic));
+  header.format_version = kModelSnapshotFormatVersion;
+  header.byte_order_mark = kModelSnapshotByteOrderMark;
+  header.kind = static_cast<std::uint32_t>(kind);
+  header.covariance = static_cast<std::uint32_t>(covariance);
+  header.dim = first.dim();
+  header.num_sampled = first.num_sampled();
+  header.num_derivatives = first.num_derivatives();
+  header.num_models = num_models;
+  header.num_hyperparameters = first.covariance_ptr_->GetNumberOfHyperparameters();
+
+  const std::uint64_t num_rows = static_cast<std::uint64_t>(header.num_sampled)*(header.num_derivatives + 1);
+  const std::uint64_t num_values = static_cast<std::uint64_t>(header.num_derivatives) + 1;
+  std::uint64_t offset = sizeof(header);
+  auto next_section = [&offset](std::uint64_t size_in_bytes) {
+    const std::uint64_t section_offset = AlignSnapshotOffset(offset);
+    offset = section_offset + size_in_bytes;
+    return section_offset;
+  };
+  header.points_sampled_offset = next_section(sizeof(double)*header.num_sampled*header.dim);
+  header.points_sampled_value_offset = next_section(sizeof(double)*num_rows);
+  header.derivatives_offset = next_section(sizeof(std::int32_t)*header.num_derivatives);
+  header.hyperparameters_offset = next_section(sizeof(double)*num_models*header.num_hyperparameters);
+  header.noise_variance_offset = next_section(sizeof(double)*num_models*num_values);
+  header.mean_offset = next_section(sizeof(double)*num_models);
+  header.K_chol_offset = next_section(sizeof(double)*num_models*Square(num_rows));
+  header.K_inv_y_offset = next_section(sizeof(double)*num_models*num_rows);
+  header.file_size = offset;
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (unlikely(!file)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Cannot open model snapshot for writing: " + filename).c_str());
+  }
+  std::uint64_t position = 0;
+  auto write_section = [&file, &position](std::uint64_t section_offset, void const * data, std::uint64_t size_in_bytes) {
+    static const char padding[kModelSnapshotAlignment] = {0};
+    file.write(padding, section_offset - position);
+    file.write(static_cast<char const *>(data), size_in_bytes);
+    position = section_offset + size_in_bytes;
+  };
+
+  write_section(0, &header, sizeof(header));
+  write_section(header.points_sampled_offset, first.points_sampled().data(),
+                sizeof(double)*first.points_sampled().size());
+  write_section(header.points_sampled_value_offset, first.points_sampled_value().data(),
+                sizeof(double)*first.points_sampled_value().size());
+  const std::vector<std::int32_t> derivatives(first.derivatives().begin(), first.derivatives().end());
+  write_section(header.derivatives_offset, derivatives.data(), sizeof(std::int32_t)*derivatives.size());
+
+  // per-model sections, each in model order
+  std::vector<double> hyperparameters(num_models*header.num_hyperparameters);
+  std::vector<double> noise_variance(num_models*num_values);
+  std::vector<double> mean(num_models);
+  for (int i = 0; i < num_models; ++i) {
+    gaussian_processes[i]->covariance_ptr_->GetHyperparameters(hyperparameters.data() + i*header.num_hyperparameters);
+    std::copy(gaussian_processes[i]->noise_variance().begin(), gaussian_processes[i]->noise_variance().end(),
+              noise_variance.begin() + i*num_values);
+    mean[i] = gaussian_processes[i]->get_mean();
+  }
+  write_section(header.hyperparameters_offset, hyperparameters.data(), sizeof(double)*hyperparameters.size());
+  write_section(header.noise_variance_offset, noise_variance.data(), sizeof(double)*noise_variance.size());
+  write_section(header.mean_offset, mean.data(), sizeof(double)*mean.size());
+  // snapshots always hold square factors, so packed models are expanded on the way out
+  std::vector<double> K_chol_square;
+  for (int i = 0; i < num_models; ++i) {
+    double const * K_chol = gaussian_processes[i]->get_K_chol().data();
+    if (gaussian_processes[i]->is_cholesky_packed()) {
+      K_chol_square.resize(Square(num_rows));
+      UnpackLowerTriangle(num_rows, K_chol, K_chol_square.data());
+      K_chol = K_chol_square.data();
+    }
+    write_section(header.K_chol_offset + sizeof(double)*i*Square(num_rows), K_chol, sizeof(double)*Square(num_rows));
+  }
+  for (int i = 0; i < num_models; ++i) {
+    write_section(header.K_inv_y_offset + sizeof(double)*i*num_rows, gaussian_processes[i]->get_K_inv_y().data(),
+                  sizeof(double)*num_rows);
+  }
+
+  file.close();
+  if (unlikely(!file)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Failed writing model snapshot: " + filename).c_str());
+  }
+}
+
+/*!\rst
+  Builds a covariance of type ``covariance`` from its hyperparameters.
+\endrst*/
+std::unique_ptr<CovarianceInterface> MakeSnapshotCovariance(ModelSnapshotCovariance covariance, int dim,
+                                                            double const * restrict hyperparameters) {
+  switch (covariance) {
+    case ModelSnapshotCovariance::kSquareExponential: {
+      return std::unique_ptr<CovarianceInterface>(new SquareExponential(dim, hyperparameters[0], hyperparameters + 1));
+    }
+    case ModelSnapshotCovariance::kMaternNu1p5: {
+      return std::unique_ptr<CovarianceInterface>(new MaternNu1p5(dim, hyperparameters[0], hyperparameters + 1));
+    }
+    case ModelSnapshotCovariance::kMaternNu2p5: {
+      return std::unique_ptr<CovarianceInterface>(new MaternNu2p5(dim, hyperparameters[0], hyperparameters + 1));
+    }
+    default: {
+      break;
+    }
+  }
+  OL_THROW_EXCEPTION(OptimalLearningException, "Unknown covariance type in model snapshot.");
+}
+
+}  // end unnamed namespace
+
+void WriteModelSnapshot(const GaussianProcess& gaussian_process, const std::string& filename) {
+  GaussianProcess const * gaussian_processes[1] = {&gaussian_process};
+  WriteModelSnapshotOfGaussianProcesses(gaussian_processes, 1, ModelSnapshotKind::kGaussianProcess, filename);
+}
+
+void WriteModelSnapshot(const GaussianProcessMCMC& gaussian_process_mcmc, const std::string& filename) {
+  std::vector<GaussianProcess const *> gaussian_processes;
+  for (const auto& gaussian_process : gaussian_process_mcmc.gaussian_process_lst) {
+    gaussian_processes.push_back(&gaussian_process);
+  }
+  if (unlikely(gaussian_processes.empty())) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "A model snapshot needs at least one GP.", 0, 1);
+  }
+  WriteModelSnapshotOfGaussianProcesses(gaussian_processes.data(), static_cast<int>(gaussian_processes.size()),
+                                        ModelSnapshotKind::kGaussianProcessMCMC, filename);
+}
+
+ModelSnapshot::ModelSnapshot(const std::string& filename)
+    : mapping_(MAP_FAILED),
+      mapping_size_(0),
+      header_(nullptr) {
+  const int file_descriptor = open(filename.c_str(), O_RDONLY);
+  if (unlikely(file_descriptor < 0)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Cannot open model snapshot " + filename + ": " +
+                                                  std::strerror(errno)).c_str());
+  }
+  struct stat file_status;
+  if (unlikely(fstat(file_descriptor, &file_status) != 0)) {
+    close(file_descriptor);
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Cannot stat model snapshot " + filename).c_str());
+  }
+  mapping_size_ = static_cast<std::size_t>(file_status.st_size);
+  if (unlikely(mapping_size_ < sizeof(ModelSnapshotHeader))) {
+    close(file_descriptor);
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Model snapshot is truncated: " + filename).c_str());
+  }
+  // the mapping stays valid after the descriptor is closed
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, file_descriptor, 0);
+  close(file_descriptor);
+  if (unlikely(mapping_ == MAP_FAILED)) {
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Cannot map model snapshot " + filename + ": " +
+                                                  std::strerror(errno)).c_str());
+  }
+  header_ = static_cast<ModelSnapshotHeader const *>(mapping_);
+
+  // validate before any accessor can be used; the destructor does not run if the constructor throws
+  char const * error = nullptr;
+  const std::uint64_t num_rows = static_cast<std::uint64_t>(header_->num_sampled)*(header_->num_derivatives + 1);
+  const std::uint64_t num_models = header_->num_models;
+  auto section_fits = [this](std::uint64_t section_offset, std::uint64_t size_in_bytes) {
+    return section_offset % kModelSnapshotAlignment == 0 && section_offset <= mapping_size_ &&
+        size_in_bytes <= mapping_size_ - section_offset;
+  };
+  if (std::memcmp(header_->magic, kModelSnapshotMagic, sizeof(header_->magic)) != 0) {
+    error = "not a model snapshot";
+  } else if (header_->byte_order_mark != kModelSnapshotByteOrderMark) {
+    error = "written on a host of different byte order";
+  } else if (header_->format_version != kModelSnapshotFormatVersion) {
+    error = "unsupported format version";
+  } else if (header_->file_size != mapping_size_) {
+    error = "file size does not match the header";
+  } else if (header_->kind != static_cast<std::uint32_t>(ModelSnapshotKind::kGaussianProcess) &&
+             header_->kind != static_cast<std::uint32_t>(ModelSnapshotKind::kGaussianProcessMCMC)) {
+    error = "unknown model kind";
+  } else if (header_->dim < 1 || header_->num_sampled < 1 || header_->num_derivatives < 0 ||
+             header_->num_models < 1 || header_->num_hyperparameters != header_->dim + 1) {
+    error = "invalid sizes";
+  } else if (!section_fits(header_->points_sampled_offset, sizeof(double)*header_->num_sampled*header_->dim) ||
+             !section_fits(header_->points_sampled_value_offset, sizeof(double)*num_rows) ||
+             !section_fits(header_->derivatives_offset, sizeof(std::int32_t)*header_->num_derivatives) ||
+             !section_fits(header_->hyperparameters_offset, sizeof(double)*num_models*header_->num_hyperparameters) ||
+             !section_fits(header_->noise_variance_offset, sizeof(double)*num_models*(header_->num_derivatives + 1)) ||
+             !section_fits(header_->mean_offset, sizeof(double)*num_models) ||
+             !section_fits(header_->K_chol_offset, sizeof(double)*num_models*Square(num_rows)) ||
+             !section_fits(header_->K_inv_y_offset, sizeof(double)*num_models*num_rows)) {
+    error = "section out of bounds";
+  }
+  if (unlikely(error != nullptr)) {
+    munmap(mapping_, mapping_size_);
+    OL_THROW_EXCEPTION(OptimalLearningException, ("Invalid model snapshot " + filename + ": " + error).c_str());
+  }
+}
+
+ModelSnapshot::~ModelSnapshot() {
+  munmap(mapping_, mapping_size_);
+}
+
+typename ModelSnapshot::TrainingData ModelSnapshot::CopyTrainingData() const {
+  TrainingData training_data;
+  training_data.points_sampled = std::make_shared<const std::vector<double>>(
+      points_sampled(), points_sampled() + num_sampled()*dim());
+  training_data.points_sampled_value = std::make_shared<const std::vector<double>>(
+      points_sampled_value(), points_sampled_value() + num_rows());
+  training_data.derivatives = std::make_shared<const std::vector<int>>(derivatives(),
+                                                                       derivatives() + num_derivatives());
+  return training_data;
+}
+
+GaussianProcess ModelSnapshot::BuildModel(const TrainingData& training_data, int index,
+                                          std::shared_ptr<const PairwiseDifferences> training_differences) const {
+  std::unique_ptr<CovarianceInterface> covariance = MakeSnapshotCovariance(
+      static_cast<ModelSnapshotCovariance>(header_->covariance), dim(), hyperparameters(index));
+  return GaussianProcess(*covariance, training_data.points_sampled, training_data.points_sampled_value,
+                         noise_variance(index), training_data.derivatives, dim(), num_sampled(), mean(index),
+                         K_chol(index), K_inv_y(index), std::move(training_differences));
+}
+
+std::unique_ptr<GaussianProcess> ModelSnapshot::BuildGaussianProcess(int index) const {
+  if (unlikely(index < 0 || index >= num_models())) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "Model index out of range.", index, 0, num_models() - 1);
+  }
+  return std::unique_ptr<GaussianProcess>(new GaussianProcess(BuildModel(CopyTrainingData(), index, nullptr)));
+}
+
+std::unique_ptr<GaussianProcessMCMC> ModelSnapshot::BuildGaussianProcessMCMC() const {
+  if (unlikely(header_->covariance != static_cast<std::uint32_t>(ModelSnapshotCovariance::kSquareExponential))) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "GaussianProcessMCMC requires a SquareExponential covariance.");
+  }
+  const TrainingData training_data = CopyTrainingData();
+  auto training_differences = std::make_shared<const PairwiseDifferences>(
+      training_data.points_sampled->data(), dim(), num_sampled(), training_data.derivatives->data(), num_derivatives());
+
+  std::vector<GaussianProcess> gaussian_processes;
+  gaussian_processes.reserve(num_models());
+  for (int i = 0; i < num_models(); ++i) {
+    gaussian_processes.emplace_back(BuildModel(training_data, i, training_differences));
+  }
+  return std::unique_ptr<GaussianProcessMCMC>(new GaussianProcessMCMC(
+      training_data.points_sampled, training_data.points_sampled_value, training_data.derivatives, dim(),
+      num_sampled(), std::move(training_differences), std::move(gaussian_processes)));
+}
+
+}  // end namespace optimal_learning
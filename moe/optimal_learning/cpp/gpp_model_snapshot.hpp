@@ -0,0 +1,296 @@
+/*!
+  \file gpp_model_snapshot.hpp
+  \rst
+  1. OVERVIEW
+  2. FILE LAYOUT
+  3. COMPATIBILITY
+
+  **1. OVERVIEW**
+
+  A fitted GaussianProcess (or GaussianProcessMCMC) is expensive to rebuild: the hyperparameters are fit and ``K`` is
+  built and factored (``O(N^3)``).  WriteModelSnapshot() saves everything a fitted model consists of (training data,
+  derivative indices, covariance type and hyperparameters, noise variance, mean, ``K_chol``, ``K^-1 * y``) to a binary
+  file; ModelSnapshot maps such a file into memory (read-only ``mmap``) and rebuilds the model from it without any
+  factorization:
+
+  .. code-block:: cpp
+
+    WriteModelSnapshot(gaussian_process_mcmc, "model.olgp");
+    ...
+    ModelSnapshot snapshot("model.olgp");  // e.g., in another process
+    std::unique_ptr<GaussianProcessMCMC> restored = snapshot.BuildGaussianProcessMCMC();
+
+  The mapping is shared by every process on the host that opens the same file, and the raw accessors (points_sampled(),
+  K_chol(), etc.) read straight from it.  BuildGaussianProcess() and BuildGaussianProcessMCMC() copy the arrays out
+  (GaussianProcess owns its storage), which is ``O(N^2)`` memory traffic instead of the ``O(N^3)`` refit.
+
+  FITC (sparse) and grid (Kronecker) GPs are not supported.
+
+  **2. FILE LAYOUT**
+
+  A fixed-size ModelSnapshotHeader, then the sections below, each starting at a multiple of kModelSnapshotAlignment
+  bytes (so every array is aligned in the mapping) at the offset recorded in the header.  ``N := num_sampled*(num_derivatives+1)``
+  and ``M := num_models`` (1 for a GaussianProcess, num_mcmc for a GaussianProcessMCMC):
+
+  =============================  ======================================  =======
+  section                        size                                    type
+  =============================  ======================================  =======
+  points_sampled                 ``[num_sampled][dim]``                  double
+  points_sampled_value           ``[num_sampled][num_derivatives+1]``    double
+  derivatives                    ``[num_derivatives]``                   int32
+  hyperparameters                ``[M][num_hyperparameters]``            double
+  noise_variance                 ``[M][num_derivatives+1]``              double
+  mean                           ``[M]``                                 double
+  K_chol                         ``[M][N][N]``                           double
+  K_inv_y                        ``[M][N]``                              double
+  =============================  ======================================  =======
+
+  Each model's ``K_chol`` is contiguous, so loading one model touches only its own pages.
+
+  **3. COMPATIBILITY**
+
+  Numbers are stored in the writer's native representation; the header's byte order mark rejects files from hosts
+  of the other endianness.  kModelSnapshotFormatVersion is bumped whenever the layout changes; ModelSnapshot rejects
+  versions it does not know.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_math.hpp"
+
+namespace optimal_learning {
+
+//! current version of the snapshot file layout
+constexpr std::uint32_t kModelSnapshotFormatVersion = 1;
+//! written in the writer's byte order; reads back differently on a host of the other endianness
+constexpr std::uint32_t kModelSnapshotByteOrderMark = 0x01020304;
+//! every section of a snapshot file starts at a multiple of this many bytes
+constexpr std::uint64_t kModelSnapshotAlignment = 64;
+
+//! kind of model stored in a snapshot
+enum class ModelSnapshotKind : std::uint32_t {
+  //! a single GaussianProcess
+  kGaussianProcess = 1,
+  //! a GaussianProcessMCMC (one GP per hyperparameter sample)
+  kGaussianProcessMCMC = 2,
+};
+
+//! covariance function of the stored model(s)
+enum class ModelSnapshotCovariance : std::uint32_t {
+  kSquareExponential = 1,
+  kMaternNu1p5 = 2,
+  kMaternNu2p5 = 3,
+};
+
+/*!\rst
+  Fixed-size header at the start of every snapshot file; see the file comments, item 2.  Section offsets are in bytes
+  from the start of the file.
+\endrst*/
+struct ModelSnapshotHeader {
+  //! "OLGPSNAP"
+  char magic[8];
+  //! kModelSnapshotFormatVersion of the writer
+  std::uint32_t format_version;
+  //! kModelSnapshotByteOrderMark in the writer's byte order
+  std::uint32_t byte_order_mark;
+  //! a ModelSnapshotKind
+  std::uint32_t kind;
+  //! a ModelSnapshotCovariance
+  std::uint32_t covariance;
+
+  // size information
+  std::int32_t dim;
+  std::int32_t num_sampled;
+  std::int32_t num_derivatives;
+  std::int32_t num_models;
+  std::int32_t num_hyperparameters;
+  std::int32_t reserved;
+
+  // section offsets
+  std::uint64_t points_sampled_offset;
+  std::uint64_t points_sampled_value_offset;
+  std::uint64_t derivatives_offset;
+  std::uint64_t hyperparameters_offset;
+  std::uint64_t noise_variance_offset;
+  std::uint64_t mean_offset;
+  std::uint64_t K_chol_offset;
+  std::uint64_t K_inv_y_offset;
+  //! total size of the file
+  std::uint64_t file_size;
+};
+
+/*!\rst
+  Writes a snapshot of ``gaussian_process`` to ``filename`` (overwriting it).
+
+  \param
+    :gaussian_process: the (non-sparse, non-grid) GP to save
+    :filename: path of the snapshot file
+  \raise
+    OptimalLearningException if the file cannot be written, the GP is sparse or grid, or its covariance type is unknown
+\endrst*/
+void WriteModelSnapshot(const GaussianProcess& gaussian_process, const std::string& filename);
+
+/*!\rst
+  Writes a snapshot of every GP in ``gaussian_process_mcmc`` to ``filename`` (overwriting it).
+
+  \param
+    :gaussian_process_mcmc: the GPs (one per hyperparameter sample) to save
+    :filename: path of the snapshot file
+  \raise
+    OptimalLearningException if the file cannot be written, or as in the GaussianProcess overload
+\endrst*/
+void WriteModelSnapshot(const GaussianProcessMCMC& gaussian_process_mcmc, const std::string& filename);
+
+/*!\rst
+  A snapshot file mapped (read-only) into memory.  The header and section sizes are validated on construction; the
+  accessors then point into the mapping, which lives as long as this object.
+\endrst*/
+class ModelSnapshot final {
+ public:
+  /*!\rst
+    Maps ``filename`` and validates it.
+
+    \param
+      :filename: path of a file written by WriteModelSnapshot()
+    \raise
+      OptimalLearningException if the file cannot be mapped or is not a valid snapshot of a known version
+  \endrst*/
+  explicit ModelSnapshot(const std::string& filename);
+
+  ~ModelSnapshot();
+
+  ModelSnapshotKind kind() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return static_cast<ModelSnapshotKind>(header_->kind);
+  }
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->dim;
+  }
+
+  int num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->num_sampled;
+  }
+
+  int num_derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->num_derivatives;
+  }
+
+  //! 1 for a GaussianProcess, num_mcmc for a GaussianProcessMCMC
+  int num_models() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->num_models;
+  }
+
+  int num_hyperparameters() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->num_hyperparameters;
+  }
+
+  //! ``[num_sampled][dim]``
+  double const * points_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->points_sampled_offset);
+  }
+
+  //! ``[num_sampled][num_derivatives+1]``
+  double const * points_sampled_value() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->points_sampled_value_offset);
+  }
+
+  //! ``[num_derivatives]``
+  std::int32_t const * derivatives() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<std::int32_t>(header_->derivatives_offset);
+  }
+
+  //! ``[num_hyperparameters]`` of model ``index``
+  double const * hyperparameters(int index) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->hyperparameters_offset) + index*header_->num_hyperparameters;
+  }
+
+  //! ``[num_derivatives+1]`` of model ``index``
+  double const * noise_variance(int index) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->noise_variance_offset) + index*(header_->num_derivatives + 1);
+  }
+
+  double mean(int index) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->mean_offset)[index];
+  }
+
+  //! ``[N][N]`` of model ``index``; see the file comments, item 2
+  double const * K_chol(int index) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->K_chol_offset) + static_cast<std::size_t>(index)*Square(num_rows());
+  }
+
+  //! ``[N]`` of model ``index``
+  double const * K_inv_y(int index) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return Section<double>(header_->K_inv_y_offset) + static_cast<std::size_t>(index)*num_rows();
+  }
+
+  /*!\rst
+    Rebuilds model ``index`` (no factorization).  Works for both kinds; for a GaussianProcessMCMC snapshot, this is
+    the GP of hyperparameter sample ``index``.
+
+    \param
+      :index: which model, in ``[0, num_models)``
+    \return
+      the restored GP
+    \raise
+      BoundsException if ``index`` is out of range
+  \endrst*/
+  std::unique_ptr<GaussianProcess> BuildGaussianProcess(int index) const OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Rebuilds every model as a GaussianProcessMCMC (no factorization); a GaussianProcess snapshot gives ``num_mcmc = 1``.
+
+    \return
+      the restored GaussianProcessMCMC
+    \raise
+      OptimalLearningException if the covariance is not SquareExponential (GaussianProcessMCMC's only covariance)
+  \endrst*/
+  std::unique_ptr<GaussianProcessMCMC> BuildGaussianProcessMCMC() const OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ModelSnapshot);
+
+ private:
+  //! shared training data in the form GaussianProcess holds it
+  struct TrainingData {
+    std::shared_ptr<const std::vector<double>> points_sampled;
+    std::shared_ptr<const std::vector<double>> points_sampled_value;
+    std::shared_ptr<const std::vector<int>> derivatives;
+  };
+
+  //! ``N``, the number of rows of ``K``
+  int num_rows() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return header_->num_sampled*(header_->num_derivatives + 1);
+  }
+
+  template <typename ValueType>
+  ValueType const * Section(std::uint64_t offset) const noexcept {
+    return reinterpret_cast<ValueType const *>(static_cast<char const *>(mapping_) + offset);
+  }
+
+  //! copies the training data out of the mapping
+  TrainingData CopyTrainingData() const OL_WARN_UNUSED_RESULT;
+
+  //! builds model ``index`` over ``training_data``
+  GaussianProcess BuildModel(const TrainingData& training_data, int index,
+                             std::shared_ptr<const PairwiseDifferences> training_differences) const OL_WARN_UNUSED_RESULT;
+
+  //! start of the mapping
+  void * mapping_;
+  //! size of the mapping in bytes
+  std::size_t mapping_size_;
+  //! the header, at the start of the mapping
+  ModelSnapshotHeader const * header_;
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_HPP_
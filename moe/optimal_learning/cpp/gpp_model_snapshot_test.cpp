@@ -0,0 +1,310 @@
+/*!
+  \file gpp_model_snapshot_test.cpp
+  \rst
+  Routines to test the functions in gpp_model_snapshot.cpp:
+
+  * a GaussianProcess (with derivative observations, for each covariance type) and a GaussianProcessMCMC rebuilt from
+    their snapshots have bitwise identical derived variables and posterior mean/variance, and the restored GPs still
+    accept AddPointsToGP(),
+  * missing, truncated, and corrupted files are rejected.
+\endrst*/
+
+#include "gpp_model_snapshot_test.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_model_snapshot.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! a fresh (empty) temporary file, removed on destruction
+class TemporarySnapshotFile final {
+ public:
+  TemporarySnapshotFile() {
+    char path[] = "/tmp/gpp_model_snapshot_testXXXXXX";
+    const int file_descriptor = mkstemp(path);
+    if (file_descriptor >= 0) {
+      close(file_descriptor);
+    }
+    path_ = path;
+  }
+
+  ~TemporarySnapshotFile() {
+    std::remove(path_.c_str());
+  }
+
+  const std::string& path() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return path_;
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(TemporarySnapshotFile);
+
+ private:
+  std::string path_;
+};
+
+/*!\rst
+  Checks that ``restored`` has the same data, derived variables, and posterior mean/variance (at ``points_to_sample``)
+  as ``original``, exactly.
+
+  \return
+    number of mismatches
+\endrst*/
+OL_WARN_UNUSED_RESULT int CheckRestoredGaussianProcess(const GaussianProcess& original, const GaussianProcess& restored,
+                                                       double const * restrict points_to_sample, int num_to_sample) {
+  int total_errors = 0;
+  if (restored.dim() != original.dim() || restored.num_sampled() != original.num_sampled() ||
+      restored.derivatives() != original.derivatives() || restored.points_sampled() != original.points_sampled() ||
+      restored.points_sampled_value() != original.points_sampled_value() ||
+      restored.noise_variance() != original.noise_variance() || restored.get_K_chol() != original.get_K_chol() ||
+      restored.get_K_inv_y() != original.get_K_inv_y() || restored.get_mean() != original.get_mean()) {
+    ++total_errors;
+  }
+
+  std::vector<double> hyperparameters_original(original.covariance_ptr_->GetNumberOfHyperparameters());
+  std::vector<double> hyperparameters_restored(restored.covariance_ptr_->GetNumberOfHyperparameters());
+  original.covariance_ptr_->GetHyperparameters(hyperparameters_original.data());
+  restored.covariance_ptr_->GetHyperparameters(hyperparameters_restored.data());
+  if (hyperparameters_restored != hyperparameters_original) {
+    ++total_errors;
+  }
+
+  PointsToSampleState state_original(original, points_to_sample, num_to_sample, nullptr, 0, 0);
+  PointsToSampleState state_restored(restored, points_to_sample, num_to_sample, nullptr, 0, 0);
+  std::vector<double> mean_original(num_to_sample), mean_restored(num_to_sample);
+  std::vector<double> variance_original(Square(num_to_sample)), variance_restored(Square(num_to_sample));
+  original.ComputeMeanOfPoints(state_original, mean_original.data());
+  restored.ComputeMeanOfPoints(state_restored, mean_restored.data());
+  original.ComputeVarianceOfPoints(&state_original, nullptr, 0, variance_original.data());
+  restored.ComputeVarianceOfPoints(&state_restored, nullptr, 0, variance_restored.data());
+  for (int i = 0; i < num_to_sample; ++i) {
+    if (!CheckDoubleWithin(mean_restored[i], mean_original[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+  for (int i = 0; i < Square(num_to_sample); ++i) {
+    if (!CheckDoubleWithin(variance_restored[i], variance_original[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Round trips GaussianProcess (each covariance type, with derivatives) and GaussianProcessMCMC snapshots.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ModelSnapshotRoundTripTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 15;
+  const int num_to_sample = 4;
+  const int num_mcmc = 3;
+  std::vector<int> derivatives = {0, 2};
+  const int num_derivatives = derivatives.size();
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled + 1, num_derivatives);
+  std::vector<double> noise_variance(num_derivatives + 1, 1.0e-3);
+  std::vector<double> lengths(dim, 2.1);
+
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  MaternNu1p5 matern_15_covariance(dim, 1.3, lengths.data());
+  MaternNu2p5 matern_25_covariance(dim, 1.3, lengths.data());
+  CovarianceInterface const * covariances[3] = {&sqexp_covariance, &matern_15_covariance, &matern_25_covariance};
+  for (auto covariance : covariances) {
+    GaussianProcess gaussian_process(*covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), derivatives.data(),
+                                     num_derivatives, dim, num_sampled);
+    TemporarySnapshotFile file;
+    WriteModelSnapshot(gaussian_process, file.path());
+    ModelSnapshot snapshot(file.path());
+    if (snapshot.kind() != ModelSnapshotKind::kGaussianProcess || snapshot.num_models() != 1) {
+      ++total_errors;
+    }
+    std::unique_ptr<GaussianProcess> restored = snapshot.BuildGaussianProcess(0);
+    total_errors += CheckRestoredGaussianProcess(gaussian_process, *restored, EI_environment.points_to_sample(),
+                                                 num_to_sample);
+
+    // the restored GP keeps working as a GP: extending it matches extending the original
+    const int new_point_index = num_sampled;
+    gaussian_process.AddPointsToGP(EI_environment.points_sampled() + new_point_index*dim,
+                                   EI_environment.points_sampled_value() + new_point_index*(num_derivatives + 1), 1);
+    restored->AddPointsToGP(EI_environment.points_sampled() + new_point_index*dim,
+                            EI_environment.points_sampled_value() + new_point_index*(num_derivatives + 1), 1);
+    total_errors += CheckRestoredGaussianProcess(gaussian_process, *restored, EI_environment.points_to_sample(),
+                                                 num_to_sample);
+  }
+
+  std::vector<double> hypers_mcmc((dim + 1)*num_mcmc);
+  std::vector<double> noises_mcmc((num_derivatives + 1)*num_mcmc);
+  for (int i = 0; i < num_mcmc; ++i) {
+    hypers_mcmc[i*(dim + 1)] = 1.0 + 0.2*i;
+    for (int d = 0; d < dim; ++d) {
+      hypers_mcmc[i*(dim + 1) + 1 + d] = 1.5 + 0.3*i + 0.1*d;
+    }
+    for (int j = 0; j < num_derivatives + 1; ++j) {
+      noises_mcmc[i*(num_derivatives + 1) + j] = 1.0e-3*(i + 1);
+    }
+  }
+  GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc,
+                                            EI_environment.points_sampled(), EI_environment.points_sampled_value(),
+                                            derivatives.data(), num_derivatives, dim, num_sampled, 1);
+  TemporarySnapshotFile file;
+  WriteModelSnapshot(gaussian_process_mcmc, file.path());
+  ModelSnapshot snapshot(file.path());
+  std::unique_ptr<GaussianProcessMCMC> restored = snapshot.BuildGaussianProcessMCMC();
+  if (snapshot.kind() != ModelSnapshotKind::kGaussianProcessMCMC || restored->num_mcmc() != num_mcmc ||
+      restored->num_sampled() != num_sampled || restored->num_derivatives() != num_derivatives) {
+    ++total_errors;
+  } else {
+    for (int i = 0; i < num_mcmc; ++i) {
+      total_errors += CheckRestoredGaussianProcess(gaussian_process_mcmc.gaussian_process_lst[i],
+                                                   restored->gaussian_process_lst[i],
+                                                   EI_environment.points_to_sample(), num_to_sample);
+    }
+  }
+
+  return total_errors;
+}
+
+//! true if opening ``path`` as a snapshot throws
+bool SnapshotIsRejected(const std::string& path) {
+  try {
+    ModelSnapshot snapshot(path);
+  } catch (const OptimalLearningException&) {
+    return true;
+  }
+  return false;
+}
+
+/*!\rst
+  Checks that missing, truncated, and corrupted snapshot files are rejected.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ModelSnapshotValidationTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 6;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, 1, 0, num_sampled, 0);
+  std::vector<double> lengths(dim, 1.2);
+  SquareExponential sqexp_covariance(dim, 1.0, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-3);
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                   num_sampled);
+  TemporarySnapshotFile good_file;
+  WriteModelSnapshot(gaussian_process, good_file.path());
+  std::vector<char> contents;
+  {
+    std::ifstream input(good_file.path(), std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  }
+
+  if (SnapshotIsRejected(good_file.path())) {
+    ++total_errors;
+  }
+  if (!SnapshotIsRejected(good_file.path() + ".missing")) {
+    ++total_errors;
+  }
+
+  auto write_contents = [](const std::string& path, const std::vector<char>& data) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(data.data(), data.size());
+  };
+  // truncated: header only, and header plus part of the data
+  for (std::size_t size : {sizeof(ModelSnapshotHeader)/2, sizeof(ModelSnapshotHeader), contents.size() - 8}) {
+    TemporarySnapshotFile file;
+    write_contents(file.path(), std::vector<char>(contents.begin(), contents.begin() + size));
+    if (!SnapshotIsRejected(file.path())) {
+      ++total_errors;
+    }
+  }
+  // corrupted magic, version, and section offset
+  {
+    std::vector<char> corrupted(contents);
+    corrupted[0] = 'X';
+    TemporarySnapshotFile file;
+    write_contents(file.path(), corrupted);
+    if (!SnapshotIsRejected(file.path())) {
+      ++total_errors;
+    }
+  }
+  {
+    std::vector<char> corrupted(contents);
+    ModelSnapshotHeader header;
+    std::copy(corrupted.begin(), corrupted.begin() + sizeof(header), reinterpret_cast<char *>(&header));
+    header.format_version = kModelSnapshotFormatVersion + 1;
+    std::copy(reinterpret_cast<char const *>(&header), reinterpret_cast<char const *>(&header) + sizeof(header),
+              corrupted.begin());
+    TemporarySnapshotFile file;
+    write_contents(file.path(), corrupted);
+    if (!SnapshotIsRejected(file.path())) {
+      ++total_errors;
+    }
+  }
+  {
+    std::vector<char> corrupted(contents);
+    ModelSnapshotHeader header;
+    std::copy(corrupted.begin(), corrupted.begin() + sizeof(header), reinterpret_cast<char *>(&header));
+    header.K_chol_offset = header.file_size;
+    std::copy(reinterpret_cast<char const *>(&header), reinterpret_cast<char const *>(&header) + sizeof(header),
+              corrupted.begin());
+    TemporarySnapshotFile file;
+    write_contents(file.path(), corrupted);
+    if (!SnapshotIsRejected(file.path())) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunModelSnapshotTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = ModelSnapshotRoundTripTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("model snapshot round trip failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("model snapshot round trip\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = ModelSnapshotValidationTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("model snapshot validation failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("model snapshot validation\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,25 @@
+/*!
+  \file gpp_model_snapshot_test.hpp
+  \rst
+  Functions for testing gpp_model_snapshot's functionality: models rebuilt from a snapshot match the originals, and
+  malformed files are rejected.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the model snapshot tests.
+
+  \return
+    number of test failures: 0 if snapshots are written and restored properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunModelSnapshotTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_MODEL_SNAPSHOT_TEST_HPP_
@@ -41,7 +41,9 @@
   state otherwise, "optima" and "optimization" refer to "maxima" and "maximization," respectively.  (Note that
   minimizing ``g(x)`` is equivalent to maximizing ``f(x) = -1 * g(x)``.)
 
-  This file contains templates for some common optimization techniques: gradient descent (GD) and Newton's method.
+  This file contains templates for some common optimization techniques: gradient descent (GD), Newton's method,
+  L-BFGS-B (limited-memory quasi-Newton with box constraints; see LBFGSBOptimization()), and GD with an adaptive,
+  Armijo-backtracked step size (see LineSearchGradientDescentOptimization()).
   We provide constrained implementations (constraint via heuristics like restricting updates to 50% of the distance
   to the nearest wall) of these optimizers.  For unconstrained, just set the domain to be huge: ``[-DBL_MAX, DBL_MAX]``.
 
@@ -212,6 +214,15 @@
     void ComputeGradObjectiveFunction(State * state, double * grad_objective);  // compute f'(current_point)
     void ComputeHessianObjectiveFunction(State * state, double * hessian_objective);  // compute f''(current_point)
 
+  Optionally, an Evaluator whose gradient computation produces ``f`` as a by-product (e.g., the MC loops of EI and KG)
+  should also provide::
+
+    // compute f(current_point) and f'(current_point) together; returns f (the estimate ComputeObjectiveFunction() makes)
+    double ComputeObjectiveAndGradient(State * state, double * grad_objective);
+
+  Optimizers that need both at the same point call the free function ComputeObjectiveAndGradient(), which uses this
+  hook when the Evaluator has it (see HasComputeObjectiveAndGradient) and two separate calls otherwise.
+
   State::
 
     int GetProblemSize();  // how many dimensions to optimize
@@ -299,6 +310,11 @@
       * Ensures (heuristically by modifying steps) that solutions remain in the specified domain
       * Calls out to ObjectiveFunctionEvaluator::ComputeObjectiveFunction() and ComputeGradObjectiveFunction()
 
+  class FixedSizeGradientDescentOptimizer<ObjectiveFunctionEvaluator, Domain, kProblemSize>:
+
+    * GradientDescentOptimizer with the problem size as a template parameter (FixedSizeGradientDescentOptimization());
+      same results, stack-allocated buffers and unrolled coordinate loops, for tiny problems in hot loops
+
   class NewtonOptimizer<ObjectiveFunctionEvaluator, Domain>:
   NewtonOptimizer<...>::Optimize() (Newton's method with refinement step)
 
@@ -315,12 +331,35 @@
         and ComputeHessianObjectiveFunction()
       * Inner loop also calls ComputePLUFactorization() and PLUMatrixVectorSolve() from gpp_linear_algebra
 
+  class LBFGSBOptimizer<ObjectiveFunctionEvaluator, Domain>:
+  LBFGSBOptimizer<...>::Optimize() (limited-memory BFGS with box constraints)
+
+    * This calls:
+      LBFGSBOptimization<ObjectiveFunctionEvaluator, Domain>() (projected quasi-Newton iteration)
+
+      * Builds quasi-Newton steps from the most recent (step, change in gradient) pairs; no Hessian needed
+      * Handles box constraints exactly: bound-active variables are held fixed and trial points are clipped onto the domain
+      * Calls out to ObjectiveFunctionEvaluator::ComputeObjectiveFunction() and ComputeGradObjectiveFunction(), or
+        ComputeObjectiveAndGradient() where both are needed at the same point
+
+  class LineSearchGradientDescentOptimizer<ObjectiveFunctionEvaluator, Domain>:
+  LineSearchGradientDescentOptimizer<...>::Optimize() (steepest ascent with a backtracking line search)
+
+    * This calls:
+      LineSearchGradientDescentOptimization<ObjectiveFunctionEvaluator, Domain>() (adaptive step size GD)
+
+      * Backtracks from the current step size until the Armijo (sufficient increase) condition holds; grows the
+        step size after steps accepted on the first trial
+      * Ensures (heuristically by modifying steps) that solutions remain in the specified domain, as GD does
+      * Calls out to ObjectiveFunctionEvaluator::ComputeObjectiveFunction() and ComputeGradObjectiveFunction(), or
+        ComputeObjectiveAndGradient() where both are needed at the same point
+
    **3b, iii. MULTISTART OPTIMIZATION**
    class MultistartOptimizer<Optimizer<ObjectiveFunctionEvaluator, Domain> >:
    MultistartOptimizer<...>::MultistartOptimize() (multistarts any Optimizer from section 3b, ii.)
 
      * Calls Optimizer::Optimize() once for each point in the provided list of initial guesses
-     * Multithreaded using OpenMP for performance
+     * Multithreaded using OpenMP (or tasks on the shared WorkStealingScheduler, per ThreadSchedule) for performance
      * Reports the best result overall (and optionally each individual result)
      * Proxy for finding the global maximum since it is difficult/impossible to guarantee an optimum is global
        in general. See function comments (below) and header comments (above, 2c) for details.
@@ -341,17 +380,29 @@
 #include <cmath>
 
 #include <algorithm>
+#include <array>
 #include <exception>
+#include <functional>
+#include <limits>
 #include <mutex>
+#include <numeric>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 #include <omp.h>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
 #include "gpp_linear_algebra.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
 
 namespace optimal_learning {
 
@@ -436,7 +487,34 @@ struct ThreadSchedule {
         Zero or negative chunk_size ask OpenMP to use its default behavior. See class comments for details.
   \endrst*/
   ThreadSchedule(int max_num_threads_in, omp_sched_t schedule_in, int chunk_size_in)
-      : max_num_threads(max_num_threads_in), schedule(schedule_in), chunk_size(chunk_size_in) {
+      : ThreadSchedule(max_num_threads_in, schedule_in, chunk_size_in, ParallelBackend::kOpenMP) {
+  }
+
+  /*!\rst
+    Construct a ThreadSchedule using the specified number of threads, schedule type, chunk_size, and backend.
+
+    \param
+      :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores); under
+        ``ParallelBackend::kWorkStealing``, the maximum number of concurrent tasks (one per state object)
+      :schedule: static, dynamic, guided, or auto. See class comments for more details. Ignored by kWorkStealing.
+      :chunk_size: how to distribute work to threads; the precise meaning depends on schedule.
+        Zero or negative chunk_size ask OpenMP to use its default behavior. See class comments for details.
+        Ignored by kWorkStealing.
+      :backend: OpenMP parallel regions or tasks on the shared WorkStealingScheduler (see gpp_task_scheduler.hpp)
+  \endrst*/
+  ThreadSchedule(int max_num_threads_in, omp_sched_t schedule_in, int chunk_size_in, ParallelBackend backend_in)
+      : max_num_threads(max_num_threads_in), schedule(schedule_in), chunk_size(chunk_size_in), backend(backend_in) {
+  }
+
+  /*!\rst
+    Construct a ThreadSchedule using the specified number of threads and backend with default schedule type and chunk_size.
+
+    \param
+      :max_num_threads: maximum number of threads (OpenMP) or concurrent tasks (kWorkStealing)
+      :backend: OpenMP parallel regions or tasks on the shared WorkStealingScheduler (see gpp_task_scheduler.hpp)
+  \endrst*/
+  ThreadSchedule(int max_num_threads_in, ParallelBackend backend_in)
+      : ThreadSchedule(max_num_threads_in, omp_sched_auto, 0, backend_in) {
   }
 
   /*!\rst
@@ -464,6 +542,19 @@ struct ThreadSchedule {
   ThreadSchedule() : ThreadSchedule(0) {
   }
 
+  /*!\rst
+    Construct a ThreadSchedule that lets MultistartOptimizer::MultistartOptimize() choose the schedule type,
+    chunk_size, and number of threads (up to ``max_num_threads``) from a calibration run; see LoopScheduleTuner.
+
+    \param
+      :max_num_threads: maximum number of threads for use by OpenMP (generally should be <= # cores)
+  \endrst*/
+  static ThreadSchedule Autotuned(int max_num_threads_in) {
+    ThreadSchedule thread_schedule(max_num_threads_in, omp_sched_dynamic);
+    thread_schedule.autotune = true;
+    return thread_schedule;
+  }
+
   //! The maximum number of threads for use by OpenMP (generally should be <= # cores).
   //! The (default) value of 0 results in omp_get_num_procs() threads; note that this
   //! is limited by omp_get_thread_limit() (set in OMP_THREAD_LIMIT).
@@ -475,8 +566,200 @@ struct ThreadSchedule {
   //! Chunk size to use when distributing work to threads; the precise meaning depends on schedule.
   //! Zero or negative chunk_size ask OpenMP to use its default behavior. See class comments for details.
   int chunk_size;
+
+  //! Whether parallel loops open OpenMP parallel regions (default) or run as tasks on the shared WorkStealingScheduler.
+  ParallelBackend backend;
+
+  //! Whether MultistartOptimize() replaces schedule, chunk_size, and max_num_threads (as an upper bound) by the choice of
+  //! LoopScheduleTuner (see gpp_task_scheduler.hpp); only the OpenMP backend is tuned.
+  bool autotune = false;
+};
+
+/*!\rst
+  Splits a thread budget between an outer parallel loop (e.g., multistarts) and an inner one nested inside it
+  (e.g., a reduction over MCMC hyperparameter samples).  The outer loop is saturated first, since its tasks are
+  independent and need no reduction; any cores it cannot use are handed to the inner loop.
+
+  \param
+    :max_num_threads: total thread budget; 0 means ``omp_get_num_procs()`` (as in ThreadSchedule)
+    :num_outer_tasks: number of iterations of the outer loop
+  \output
+    :num_outer_threads[1]: number of threads for the outer loop, ``>= 1``
+    :num_inner_threads[1]: number of threads each outer thread may use for the inner loop, ``>= 1``
+\endrst*/
+inline OL_NONNULL_POINTERS void SplitThreadBudget(int max_num_threads, int num_outer_tasks, int * num_outer_threads,
+                                                  int * num_inner_threads) noexcept {
+  const int total_threads = std::max(max_num_threads > 0 ? max_num_threads : omp_get_num_procs(), 1);
+  *num_outer_threads = std::max(std::min(num_outer_tasks, total_threads), 1);
+  *num_inner_threads = total_threads / *num_outer_threads;
+}
+
+/*!\rst
+  RAII guard enabling one level of nested OpenMP parallelism for its lifetime.  OpenMP serializes nested parallel
+  regions by default, so an inner ``#pragma omp parallel`` launched from inside a multistart would run on one thread
+  regardless of its ``num_threads`` clause.  The previous setting is restored on destruction.
+
+  Must be constructed outside of any active parallel region (``omp_set_max_active_levels()`` has no effect there).
+\endrst*/
+class ScopedNestedParallelism final {
+ public:
+  /*!\rst
+    \param
+      :enable: true to allow two active levels of parallelism; false leaves the OpenMP setting untouched
+  \endrst*/
+  explicit ScopedNestedParallelism(bool enable) noexcept
+      : previous_max_active_levels_(omp_get_max_active_levels()), enabled_(enable && previous_max_active_levels_ < 2) {
+    if (enabled_) {
+      omp_set_max_active_levels(2);
+    }
+  }
+
+  ~ScopedNestedParallelism() {
+    if (enabled_) {
+      omp_set_max_active_levels(previous_max_active_levels_);
+    }
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ScopedNestedParallelism);
+
+ private:
+  //! value of ``omp_get_max_active_levels()`` before this guard was constructed
+  const int previous_max_active_levels_;
+  //! whether this guard changed the OpenMP setting (and so must restore it)
+  const bool enabled_;
+};
+
+/*!\rst
+  Per-start record of one multistart run (see MultistartOptimizer::MultistartOptimize()), collected when the optimizer
+  parameters ask for it (see GetRecordTraces()).  Use these to size ``num_multistarts``, ``max_num_steps``,
+  ``max_num_restarts``, etc.: e.g., many starts sharing an ``optimum_index`` means the multistarts are redundant, and
+  starts that never converge within ``max_num_steps`` mean the step budget (or learning rate) is too small.
+
+  Optimizers that do not report their iterations (everything except GradientDescentOptimizer) leave ``num_restarts``,
+  ``num_steps``, and ``num_boundary_steps`` at -1 and ``final_gradient_norm`` at NaN; ``converged`` is then false.
+\endrst*/
+struct OptimizationTrace final {
+  OptimizationTrace()
+      : num_restarts(-1),
+        num_steps(-1),
+        num_boundary_steps(-1),
+        final_gradient_norm(std::numeric_limits<double>::quiet_NaN()),
+        objective_value(-std::numeric_limits<double>::infinity()),
+        converged(false),
+        optimum_index(-1),
+        final_point() {
+  }
+
+  //! number of (restarted) GD runs performed
+  int num_restarts;
+  //! total number of GD steps over all restarts
+  int num_steps;
+  //! number of steps that ``domain.LimitUpdate()`` shortened, i.e., that would have left the domain or moved more than
+  //! ``max_relative_change`` of the way to its boundary
+  int num_boundary_steps;
+  //! norm of the objective's gradient at ``final_point``
+  double final_gradient_norm;
+  //! objective value at ``final_point``; ``-infinity`` if the start was skipped (deadline) or threw
+  double objective_value;
+  //! true if the run met the optimizer's tolerance (rather than exhausting its budget or the deadline)
+  bool converged;
+  //! starts with the same index ended at the same optimum (see OptimizationIOContainer::trace_optimum_tolerance);
+  //! -1 if the start was skipped or threw
+  int optimum_index;
+  //! the point the run ended at; empty if the start was skipped or threw
+  std::vector<double> final_point;
+};
+
+/*!\rst
+  Request for, and result of, the diverse top-k reduction of MultistartOptimizer::MultistartOptimize(): the
+  ``num_points`` best end points of the multistarts, at least ``min_distance`` apart, so that one multistart run yields
+  several distinct good candidates (e.g., fallbacks, or the members of a greedily built batch).
+
+  The reduction is deterministic (independent of threading): the finished starts are ranked by objective value (ties
+  by start order) and each is kept unless it lies within ``min_distance`` (Euclidean) of a better kept point.  Fewer
+  than ``num_points`` are returned if the starts did not reach that many distinct optima.  ``num_points = 0`` (the
+  default) disables the reduction.
+\endrst*/
+struct DiverseTopPoints final {
+  DiverseTopPoints() : DiverseTopPoints(0, 0.0) {
+  }
+
+  /*!\rst
+    \param
+      :num_points_in: maximum number of points to keep (k); 0 disables the reduction
+      :min_distance_in: kept points are at least this far apart
+  \endrst*/
+  DiverseTopPoints(int num_points_in, double min_distance_in)
+      : num_points(num_points_in),
+        min_distance(min_distance_in),
+        points(),
+        values() {
+  }
+
+  //! number of points found (``values.size() <= num_points``)
+  int num_found() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return values.size();
+  }
+
+  //! maximum number of points to keep
+  int num_points;
+  //! minimum (Euclidean) distance between kept points
+  double min_distance;
+  //! ``points[problem_size][num_found()]``: the kept points, best first
+  std::vector<double> points;
+  //! ``values[num_found()]``: objective values of ``points``, in decreasing order
+  std::vector<double> values;
 };
 
+/*!\rst
+  The diverse top-k reduction of DiverseTopPoints over a list of finished starts.
+
+  \param
+    :start_values[num_starts]: objective value reached by each start; ``-infinity`` (or NaN) marks starts to ignore
+    :start_points[problem_size][num_starts]: point reached by each start
+    :num_starts: number of starts
+    :problem_size: number of dimensions of a point
+    :top_points[1]: DiverseTopPoints with ``num_points`` and ``min_distance`` set
+  \output
+    :top_points[1]: ``points`` and ``values`` hold the kept points, best first
+\endrst*/
+inline OL_NONNULL_POINTERS void SelectDiverseTopPoints(double const * restrict start_values,
+                                                       double const * restrict start_points, int num_starts,
+                                                       int problem_size, DiverseTopPoints * top_points) {
+  top_points->points.clear();
+  top_points->values.clear();
+  std::vector<int> order;
+  order.reserve(num_starts);
+  for (int i = 0; i < num_starts; ++i) {
+    if (start_values[i] > -std::numeric_limits<double>::infinity()) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [start_values](int i, int j) {
+      return start_values[i] > start_values[j];
+    });
+
+  const double min_distance_squared = top_points->min_distance*top_points->min_distance;
+  for (const int i : order) {
+    if (top_points->num_found() >= top_points->num_points) {
+      break;
+    }
+    double const * restrict point = start_points + i*problem_size;
+    bool distinct = true;
+    for (int k = 0; k < top_points->num_found() && distinct; ++k) {
+      double distance_squared = 0.0;
+      for (int j = 0; j < problem_size; ++j) {
+        distance_squared += Square(point[j] - top_points->points[k*problem_size + j]);
+      }
+      distinct = distance_squared >= min_distance_squared;
+    }
+    if (distinct) {
+      top_points->points.insert(top_points->points.end(), point, point + problem_size);
+      top_points->values.push_back(start_values[i]);
+    }
+  }
+}
+
 /*!\rst
   This object holds the input/output fields for optimizers (maximization).  On input, this can be used to specify the current
   best known point (i.e., the optimizer will indicate no new optima found if it cannot beat this value).
@@ -517,7 +800,15 @@ struct OptimizationIOContainer final {
       :problem_size: number of dimensions in the optimization problem (e.g., size of best_point)
   \endrst*/
   explicit OptimizationIOContainer(int problem_size_in)
-      : problem_size(problem_size_in), best_objective_value_so_far(0.0), best_point(problem_size), found_flag(false) {
+      : problem_size(problem_size_in),
+        best_objective_value_so_far(0.0),
+        best_point(problem_size),
+        found_flag(false),
+        deadline_reached(false),
+        start_traces(),
+        num_distinct_optima(0),
+        trace_optimum_tolerance(kDefaultTraceOptimumTolerance),
+        top_points() {
   }
 
   /*!\rst
@@ -532,7 +823,12 @@ struct OptimizationIOContainer final {
       : problem_size(problem_size_in),
         best_objective_value_so_far(best_objective_value),
         best_point(best_point_in, best_point_in + problem_size),
-        found_flag(false) {
+        found_flag(false),
+        deadline_reached(false),
+        start_traces(),
+        num_distinct_optima(0),
+        trace_optimum_tolerance(kDefaultTraceOptimumTolerance),
+        top_points() {
   }
 
   OptimizationIOContainer(OptimizationIOContainer&& OL_UNUSED(other)) = default;
@@ -546,10 +842,560 @@ struct OptimizationIOContainer final {
   std::vector<double> best_point;
   //! true if the optimizer found improvement
   bool found_flag;
+  //! true if the optimizer parameters' OptimizationDeadline passed before every start ran to completion: the result is
+  //! the best over the starts that ran (some possibly cut short), and may be worse than a full run's
+  bool deadline_reached;
+  //! one OptimizationTrace per multistart, in the order of the initial guesses, if the optimizer parameters asked for
+  //! traces (see GetRecordTraces()); empty otherwise.  Filled by MultistartOptimizer::MultistartOptimize() only.  Filled by MultistartOptimizer::MultistartOptimize() only
+  std::vector<OptimizationTrace> start_traces;
+  //! number of distinct optima among ``start_traces`` (one more than the largest ``optimum_index``)
+  int num_distinct_optima;
+  //! two final points are the same optimum if they are within this distance, relative to ``max(1, ||point||)``
+  double trace_optimum_tolerance;
+  //! on input, how many diverse top points to keep (default: none); on output, the points (see DiverseTopPoints).
+  //! Filled by MultistartOptimizer::MultistartOptimize() only
+  DiverseTopPoints top_points;
+
+  //! default value of ``trace_optimum_tolerance``
+  static constexpr double kDefaultTraceOptimumTolerance = 1.0e-4;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(OptimizationIOContainer);
 };
 
+/*!\rst
+  The OptimizationDeadline of an optimizer parameter struct; NullParameters (evaluation only) has none.
+\endrst*/
+template <typename ParameterStruct>
+OptimizationDeadline GetOptimizationDeadline(const ParameterStruct& optimizer_parameters) noexcept {
+  return optimizer_parameters.deadline;
+}
+
+inline OptimizationDeadline GetOptimizationDeadline(const NullParameters& OL_UNUSED(optimizer_parameters)) noexcept {
+  return OptimizationDeadline();
+}
+
+/*!\rst
+  Whether MultistartOptimizer::MultistartOptimize() should fill OptimizationIOContainer::start_traces.  Only
+  GradientDescentParameters can ask for traces (see its ``record_traces``).
+\endrst*/
+template <typename ParameterStruct>
+bool GetRecordTraces(const ParameterStruct& OL_UNUSED(optimizer_parameters)) noexcept {
+  return false;
+}
+
+inline bool GetRecordTraces(const GradientDescentParameters& optimizer_parameters) noexcept {
+  return optimizer_parameters.record_traces;
+}
+
+/*!\rst
+  Groups the finished starts of ``start_traces`` by the optimum they reached: in start order, each start joins the first
+  earlier group whose first member's ``final_point`` is within ``tolerance * max(1, ||final_point||)`` of its own, or
+  opens a new group.  Sets every ``optimum_index`` (-1 for starts with no ``final_point``).
+
+  \param
+    :tolerance: relative distance below which two final points are the same optimum
+    :start_traces[1]: traces whose ``final_point`` fields are set
+  \output
+    :start_traces[1]: ``optimum_index`` set in every trace
+  \return
+    number of distinct optima found
+\endrst*/
+inline OL_NONNULL_POINTERS int ClusterOptimizationTraces(double tolerance,
+                                                         std::vector<OptimizationTrace> * start_traces) noexcept {
+  std::vector<int> representatives;
+  std::vector<double> difference;
+  for (auto& trace : *start_traces) {
+    trace.optimum_index = -1;
+    if (trace.final_point.empty()) {
+      continue;
+    }
+    const int size = trace.final_point.size();
+    difference.resize(size);
+    const double scale = std::fmax(1.0, VectorNorm(trace.final_point.data(), size));
+    for (int k = 0, num_optima = representatives.size(); k < num_optima; ++k) {
+      const std::vector<double>& representative = (*start_traces)[representatives[k]].final_point;
+      for (int j = 0; j < size; ++j) {
+        difference[j] = trace.final_point[j] - representative[j];
+      }
+      if (VectorNorm(difference.data(), size) <= tolerance*scale) {
+        trace.optimum_index = k;
+        break;
+      }
+    }
+    if (trace.optimum_index == -1) {
+      trace.optimum_index = representatives.size();
+      representatives.push_back(&trace - start_traces->data());
+    }
+  }
+  return representatives.size();
+}
+
+/*!\rst
+  ``value`` is true if ``ObjectiveFunctionEvaluator`` provides the optional fused hook
+  ``double ComputeObjectiveAndGradient(StateType *, double *) const`` (see the file comments, section 3a).
+\endrst*/
+template <typename ObjectiveFunctionEvaluator>
+struct HasComputeObjectiveAndGradient {
+  template <typename Evaluator>
+  static auto Test(int) -> decltype(std::declval<const Evaluator&>().ComputeObjectiveAndGradient(
+      std::declval<typename Evaluator::StateType *>(), std::declval<double *>()), std::true_type());
+
+  template <typename Evaluator>
+  static std::false_type Test(...);
+
+  static constexpr bool value = decltype(Test<ObjectiveFunctionEvaluator>(0))::value;
+};
+
+/*!\rst
+  Overloads of ComputeObjectiveAndGradient() (below) with and without the evaluator's fused hook.
+\endrst*/
+template <typename ObjectiveFunctionEvaluator>
+double ComputeObjectiveAndGradient(const ObjectiveFunctionEvaluator& objective_evaluator,
+                                   typename ObjectiveFunctionEvaluator::StateType * objective_state,
+                                   double * restrict grad_objective, std::true_type OL_UNUSED(has_hook)) {
+  return objective_evaluator.ComputeObjectiveAndGradient(objective_state, grad_objective);
+}
+
+template <typename ObjectiveFunctionEvaluator>
+double ComputeObjectiveAndGradient(const ObjectiveFunctionEvaluator& objective_evaluator,
+                                   typename ObjectiveFunctionEvaluator::StateType * objective_state,
+                                   double * restrict grad_objective, std::false_type OL_UNUSED(has_hook)) {
+  const double objective_value = objective_evaluator.ComputeObjectiveFunction(objective_state);
+  objective_evaluator.ComputeGradObjectiveFunction(objective_state, grad_objective);
+  return objective_value;
+}
+
+/*!\rst
+  ``value`` is true if ``StateType`` draws its normals from a ``NormalRNGInterface * normal_rng`` member (e.g., the EI and
+  KG states and their MCMC variants).
+\endrst*/
+template <typename StateType>
+struct HasNormalRNG {
+  template <typename State>
+  static auto Test(int) -> decltype(std::declval<State&>().normal_rng->SetStream(0), std::true_type());
+
+  template <typename State>
+  static std::false_type Test(...);
+
+  static constexpr bool value = decltype(Test<StateType>(0))::value;
+};
+
+/*!\rst
+  Overloads of SelectNormalStream() (below) for states with and without a normal generator.
+\endrst*/
+template <typename StateType>
+void SelectNormalStream(StateType * state, int stream, std::true_type OL_UNUSED(has_normal_rng)) noexcept {
+  state->normal_rng->SetStream(stream);
+}
+
+template <typename StateType>
+void SelectNormalStream(StateType * OL_UNUSED(state), int OL_UNUSED(stream),
+                        std::false_type OL_UNUSED(has_normal_rng)) noexcept {
+}
+
+/*!\rst
+  Moves the normal generator of ``state``, if it has one (see HasNormalRNG), to stream ``stream``; see
+  NormalRNGInterface::SetStream().  The multistart drivers in this file call this with the index of each start
+  before setting its point, so with identically seeded PhiloxNormalRNGs start ``i`` draws from stream ``i`` whichever
+  thread (or state) runs it, and the results do not depend on the number of threads.  NormalRNG ignores the call.
+
+  \param
+    :state[1]: a state object
+    :stream: index of the stream, usually the index of the start
+  \output
+    :state[1]: its generator (if any) moved to the first draw of ``stream``
+\endrst*/
+template <typename StateType>
+OL_NONNULL_POINTERS void SelectNormalStream(StateType * state, int stream) noexcept {
+  SelectNormalStream(state, stream, std::integral_constant<bool, HasNormalRNG<StateType>::value>());
+}
+
+/*!\rst
+  Computes the objective and its gradient at ``objective_state``'s current point, in one evaluation if the evaluator
+  provides ``ComputeObjectiveAndGradient()`` (see HasComputeObjectiveAndGradient), else as
+  ``ComputeObjectiveFunction()`` followed by ``ComputeGradObjectiveFunction()``.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its gradient
+    :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator
+  \output
+    :objective_state[1]: a state object whose temporary data members may have been modified
+    :grad_objective[problem_size]: gradient of the objective at the current point
+  \return
+    the objective at the current point
+\endrst*/
+template <typename ObjectiveFunctionEvaluator>
+OL_NONNULL_POINTERS double ComputeObjectiveAndGradient(const ObjectiveFunctionEvaluator& objective_evaluator,
+                                                       typename ObjectiveFunctionEvaluator::StateType * objective_state,
+                                                       double * restrict grad_objective) {
+  return ComputeObjectiveAndGradient(objective_evaluator, objective_state, grad_objective,
+                                     std::integral_constant<bool, HasComputeObjectiveAndGradient<ObjectiveFunctionEvaluator>::value>());
+}
+
+/*!\rst
+  Makes ``state_vector`` hold exactly ``num_states`` configured states, reusing the ones it already holds.  This is what
+  lets a ``std::vector`` of states serve as a pool: a caller that keeps the vector alive across calls (e.g., one inner
+  optimization per KG MC iteration) pays for the states' buffers once instead of on every call.
+
+  Existing states are tried in order with ``reconfigure(&state, i)``, which must reset ``state`` for the new problem
+  and return true, or return false (leaving the state untouched) if the state cannot be reused (e.g., its fixed sizes
+  differ).  States from the first refusal on are destroyed and rebuilt with ``construct(state_vector, i)``, which must
+  ``emplace_back()`` exactly one state.  (States are not assignable, so only the tail of the vector can be replaced.)
+
+  New states are built on their own threads: state ``i`` by thread ``i`` of an OpenMP team of ``num_states`` (see
+  ForEachOwningThread()), so that its buffers are allocated on the NUMA node of the thread that will use it, and then
+  moved (buffers and all) into ``state_vector``.  So ``construct`` may run concurrently for different ``i``.
+
+  The Setup*State() helpers (e.g., SetupExpectedImprovementState()) are built on this; states implement ``Reconfigure()``
+  with the arguments of their constructors.
+
+  \param
+    :num_states: number of states wanted
+    :reconfigure: ``bool(StateType *, int)`` functor; see above
+    :construct: ``void(std::vector<StateType> *, int)`` functor; see above
+    :state_vector[arbitrary]: states left from earlier calls (possibly none)
+  \output
+    :state_vector[num_states]: ``num_states`` states configured for the new problem
+\endrst*/
+template <typename StateType, typename Reconfigure, typename Construct>
+OL_NONNULL_POINTERS void ReuseOrConstructStates(int num_states, Reconfigure reconfigure, Construct construct,
+                                                std::vector<StateType> * state_vector) {
+  const int num_existing = std::min(static_cast<int>(state_vector->size()), num_states);
+  int num_reused = 0;
+  while (num_reused < num_existing && reconfigure(state_vector->data() + num_reused, num_reused)) {
+    ++num_reused;
+  }
+  while (static_cast<int>(state_vector->size()) > num_reused) {
+    state_vector->pop_back();
+  }
+  state_vector->reserve(num_states);
+  if (num_states - num_reused > 1) {
+    std::vector<std::vector<StateType>> new_states(num_states - num_reused);
+    ForEachOwningThread(num_states, [&](int i) {
+        if (i >= num_reused) {
+          construct(&new_states[i - num_reused], i);
+        }
+      });
+    for (auto& new_state : new_states) {
+      state_vector->push_back(std::move(new_state.front()));
+    }
+  } else {
+    for (int i = num_reused; i < num_states; ++i) {
+      construct(state_vector, i);
+    }
+  }
+}
+
+/*!\rst
+  Screens ``num_multistarts`` initial guesses by their objective value and keeps the best ``num_selected``, the usual
+  way to seed MultistartOptimize() with a few promising starts when every descent is expensive (e.g., EI/KG
+  optimization).  The selected starts are ordered by decreasing value; ties go to the earlier start.
+
+  The values are computed on ``num_states`` threads: start ``i`` is evaluated on ``states[i % num_states]``, in
+  increasing order of ``i`` per state.  So the selection depends on ``num_states`` (states may carry history, e.g., a
+  KG state's inner-optimization warm starts and each state's own NormalRNG; start ``i`` draws from stream ``i`` of a
+  PhiloxNormalRNG, see SelectNormalStream()) but not on timing.  Parallelism inside the evaluator (e.g., KG's MC loop)
+  is nested in these threads; see ParallelForEachIndex().
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function
+    :start_point_set[problem_size][num_multistarts]: initial guesses
+    :num_multistarts: number of initial guesses
+    :num_selected: number of starts to keep, ``1 <= num_selected <= num_multistarts``
+    :num_states: number of states (and threads) to screen with
+    :states[num_states]: properly configured state objects for the ObjectiveFunctionEvaluator
+  \output
+    :states[num_states]: states whose current point and temporary data members may have been modified
+    :selected_start_points[problem_size][num_selected]: the ``num_selected`` starts with the largest objective values
+\endrst*/
+template <typename ObjectiveFunctionEvaluator>
+OL_NONNULL_POINTERS void SelectBestStartPoints(const ObjectiveFunctionEvaluator& objective_evaluator,
+                                               double const * restrict start_point_set, int num_multistarts,
+                                               int num_selected, int num_states,
+                                               typename ObjectiveFunctionEvaluator::StateType * states,
+                                               double * restrict selected_start_points) {
+  const int problem_size = states[0].GetProblemSize();
+  std::vector<double> start_values(num_multistarts);
+  ParallelForEachIndex(num_states, num_states, [&](int state_index) {
+      for (int i = state_index; i < num_multistarts; i += num_states) {
+        SelectNormalStream(states + state_index, i);
+        states[state_index].SetCurrentPoint(objective_evaluator, start_point_set + i*problem_size);
+        start_values[i] = objective_evaluator.ComputeObjectiveFunction(states + state_index);
+      }
+    });
+
+  std::vector<int> order(num_multistarts);
+  std::iota(order.begin(), order.end(), 0);
+  std::partial_sort(order.begin(), order.begin() + num_selected, order.end(), [&start_values](int i, int j) {
+      return start_values[i] > start_values[j] || (start_values[i] == start_values[j] && i < j);
+    });
+  for (int i = 0; i < num_selected; ++i) {
+    std::copy(start_point_set + order[i]*problem_size, start_point_set + (order[i] + 1)*problem_size,
+              selected_start_points + i*problem_size);
+  }
+}
+
+/*!\rst
+  Evaluates the objective (and optionally its gradient) at each of ``num_sets`` points; e.g., the candidate q-sets of a
+  batch heuristic, which would otherwise pay for building the states once per candidate.
+
+  As in SelectBestStartPoints(), the work runs on ``num_states`` threads: point ``i`` is evaluated on
+  ``states[i % num_states]``, in increasing order of ``i`` per state.  So the results depend on ``num_states`` (unless
+  the states draw from PhiloxNormalRNGs, which SelectNormalStream() moves to stream ``i``) but not on timing.  Gradients are computed with ComputeObjectiveAndGradient(), so the states must be configured for gradients
+  when ``gradients`` is not nullptr.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its gradient
+    :point_sets[problem_size][num_sets]: points at which to evaluate the objective
+    :num_sets: number of points
+    :num_states: number of states (and threads) to evaluate with
+    :states[num_states]: properly configured state objects for the ObjectiveFunctionEvaluator
+  \output
+    :states[num_states]: states whose current point and temporary data members may have been modified
+    :values[num_sets]: objective at each point of ``point_sets``, in the same order
+    :gradients[problem_size][num_sets]: gradient of the objective at each point of ``point_sets``, in the same order;
+      never dereferenced if nullptr
+\endrst*/
+template <typename ObjectiveFunctionEvaluator>
+OL_NONNULL_POINTERS_LIST(2, 5, 6) void EvaluateObjectiveAtPointSets(
+    const ObjectiveFunctionEvaluator& objective_evaluator, double const * restrict point_sets, int num_sets,
+    int num_states, typename ObjectiveFunctionEvaluator::StateType * states, double * restrict values,
+    double * restrict gradients) {
+  const int problem_size = states[0].GetProblemSize();
+  ParallelForEachIndex(num_states, num_states, [&](int state_index) {
+      for (int i = state_index; i < num_sets; i += num_states) {
+        SelectNormalStream(states + state_index, i);
+        states[state_index].SetCurrentPoint(objective_evaluator, point_sets + i*problem_size);
+        if (gradients != nullptr) {
+          values[i] = ComputeObjectiveAndGradient(objective_evaluator, states + state_index,
+                                                  gradients + i*problem_size);
+        } else {
+          values[i] = objective_evaluator.ComputeObjectiveFunction(states + state_index);
+        }
+      }
+    });
+}
+
+/*!\rst
+  Streaming random search: evaluates the objective at ``num_points`` points drawn uniformly from ``domain`` (e.g., the
+  latin hypercube fallback of EI/KG optimization) without ever holding the whole point list.  The points are drawn and
+  evaluated in tiles of ``tile_size``: tile ``t`` is drawn from its own UniformRandomGenerator (seeded with a base seed
+  drawn from ``uniform_generator``, plus ``t``) by thread ``t % num_threads``, which evaluates it immediately and keeps
+  only its running best (and, if requested, its ``io_container->top_points.num_points`` best).  So memory is
+  ``O(num_threads*tile_size)`` rather than ``O(num_points)``, and the result depends on ``num_threads`` and ``tile_size``
+  but not on timing.
+
+  Each tile is a separate draw (e.g., its own latin hypercube), so the points are not one latin hypercube of
+  ``num_points``.  Ties go to the earlier point (in tile order).  The top points are the diverse top-k (see
+  DiverseTopPoints) of the threads' ``num_points`` best, so with ``min_distance > 0`` fewer may be found than over
+  the whole list.
+
+  ``evaluate_tile(thread_index, points, num_tile_points, values)`` must write the objective at each of
+  ``points[problem_size][num_tile_points]`` into ``values[num_tile_points]``; calls with different ``thread_index``
+  run concurrently, so each thread must use its own state (e.g., ``states[thread_index]``).
+
+  \param
+    :domain: domain to draw the points from, of ``problem_size`` coordinates per point (e.g., a RepeatedDomain)
+    :num_points: number of points to draw and evaluate
+    :tile_size: number of points per tile
+    :num_threads: number of threads to evaluate with
+    :uniform_generator[1]: source of the base seed
+    :evaluate_tile: tile evaluator (see above)
+    :io_container[1]: properly constructed OptimizationIOContainer (``problem_size`` coordinates per point)
+  \output
+    :uniform_generator[1]: one draw consumed
+    :io_container[1]: updated as by MultistartOptimize() (see OptimizationIOContainer); ``top_points`` filled if requested
+  \return
+    number of points actually evaluated (domains may generate fewer points than requested)
+  \raise
+    LowerBoundException<int> if ``tile_size < 1`` or ``num_threads < 1``
+\endrst*/
+template <typename DomainType, typename EvaluateTile>
+OL_NONNULL_POINTERS int StreamingUniformSearch(const DomainType& domain, int num_points, int tile_size,
+                                               int num_threads, UniformRandomGenerator * uniform_generator,
+                                               const EvaluateTile& evaluate_tile,
+                                               OptimizationIOContainer * io_container) {
+  if (unlikely(tile_size < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "tile_size must be >= 1.", tile_size, 1);
+  }
+  if (unlikely(num_threads < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_threads must be >= 1.", num_threads, 1);
+  }
+  const int problem_size = io_container->problem_size;
+  const int num_tiles = (num_points + tile_size - 1)/tile_size;
+  const int num_kept = io_container->top_points.num_points;
+  const UniformRandomGenerator::EngineType::result_type base_seed = uniform_generator->engine();
+
+  // per thread: best point, its index (for tie-breaking), and the num_kept best (value, index, point), best first
+  struct ThreadResult {
+    double best_value = -std::numeric_limits<double>::infinity();
+    int best_index = -1;
+    std::vector<double> best_point;
+    std::vector<double> kept_values;
+    std::vector<int> kept_indices;
+    std::vector<double> kept_points;
+    int num_evaluated = 0;
+  };
+  std::vector<ThreadResult> thread_results(num_threads);
+  ParallelForEachIndex(num_threads, num_threads, [&](int thread_index) {
+      ThreadResult& result = thread_results[thread_index];
+      result.best_point.resize(problem_size);
+      std::vector<double> tile_points(tile_size*problem_size);
+      std::vector<double> tile_values(tile_size);
+      for (int t = thread_index; t < num_tiles; t += num_threads) {
+        UniformRandomGenerator tile_generator(base_seed + t);
+        const int num_tile_points = domain.GenerateUniformPointsInDomain(
+            std::min(tile_size, num_points - t*tile_size), &tile_generator, tile_points.data());
+        evaluate_tile(thread_index, static_cast<double const *>(tile_points.data()), num_tile_points,
+                      tile_values.data());
+        result.num_evaluated += num_tile_points;
+
+        for (int i = 0; i < num_tile_points; ++i) {
+          // later points only replace on strict improvement, so ties go to the earlier point
+          double const * restrict point = tile_points.data() + i*problem_size;
+          const int index = t*tile_size + i;
+          if (tile_values[i] > result.best_value) {
+            result.best_value = tile_values[i];
+            result.best_index = index;
+            std::copy(point, point + problem_size, result.best_point.begin());
+          }
+          if (num_kept > 0 && (static_cast<int>(result.kept_values.size()) < num_kept ||
+                               tile_values[i] > result.kept_values.back())) {
+            int position = std::upper_bound(result.kept_values.begin(), result.kept_values.end(), tile_values[i],
+                                            std::greater<double>()) - result.kept_values.begin();
+            result.kept_values.insert(result.kept_values.begin() + position, tile_values[i]);
+            result.kept_indices.insert(result.kept_indices.begin() + position, index);
+            result.kept_points.insert(result.kept_points.begin() + position*problem_size, point,
+                                      point + problem_size);
+            if (static_cast<int>(result.kept_values.size()) > num_kept) {
+              result.kept_values.pop_back();
+              result.kept_indices.pop_back();
+              result.kept_points.resize(num_kept*problem_size);
+            }
+          }
+        }
+      }
+    });
+
+  int num_evaluated = 0;
+  int winner = -1;
+  for (int j = 0; j < num_threads; ++j) {
+    const ThreadResult& result = thread_results[j];
+    num_evaluated += result.num_evaluated;
+    if (result.best_index >= 0 &&
+        (winner < 0 || result.best_value > thread_results[winner].best_value ||
+         (result.best_value == thread_results[winner].best_value &&
+          result.best_index < thread_results[winner].best_index))) {
+      winner = j;
+    }
+  }
+  io_container->found_flag = false;
+  if (winner >= 0 && thread_results[winner].best_value > io_container->best_objective_value_so_far) {
+    io_container->found_flag = true;
+    io_container->best_objective_value_so_far = thread_results[winner].best_value;
+    io_container->best_point = thread_results[winner].best_point;
+  }
+
+  if (num_kept > 0) {
+    // in point order, so that SelectDiverseTopPoints() breaks ties toward the earlier point
+    std::vector<std::pair<int, int> > kept_order;  // (index, thread)
+    for (int j = 0; j < num_threads; ++j) {
+      for (int k = 0; k < static_cast<int>(thread_results[j].kept_indices.size()); ++k) {
+        kept_order.emplace_back(thread_results[j].kept_indices[k], j*num_kept + k);
+      }
+    }
+    std::sort(kept_order.begin(), kept_order.end());
+    std::vector<double> kept_values(kept_order.size());
+    std::vector<double> kept_points(kept_order.size()*problem_size);
+    for (int i = 0; i < static_cast<int>(kept_order.size()); ++i) {
+      const ThreadResult& result = thread_results[kept_order[i].second/num_kept];
+      const int k = kept_order[i].second % num_kept;
+      kept_values[i] = result.kept_values[k];
+      std::copy(result.kept_points.begin() + k*problem_size, result.kept_points.begin() + (k + 1)*problem_size,
+                kept_points.begin() + i*problem_size);
+    }
+    SelectDiverseTopPoints(kept_values.data(), kept_points.data(), kept_order.size(), problem_size,
+                           &io_container->top_points);
+  }
+  return num_evaluated;
+}
+
+/*!\rst
+  StreamingUniformSearch() for an objective evaluated one point at a time on per-thread states: thread ``j`` evaluates
+  its tiles on ``states[j]``, as SelectBestStartPoints() does.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function
+    :num_states: number of states (and threads) to evaluate with
+    :states[num_states]: properly configured state objects for the ObjectiveFunctionEvaluator
+    (the rest as in StreamingUniformSearch())
+  \output
+    :states[num_states]: states whose current point and temporary data members may have been modified
+    (the rest as in StreamingUniformSearch())
+  \return
+    number of points actually evaluated
+\endrst*/
+template <typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS int StreamingUniformSearch(const ObjectiveFunctionEvaluator& objective_evaluator,
+                                               const DomainType& domain, int num_points, int tile_size,
+                                               int num_states, typename ObjectiveFunctionEvaluator::StateType * states,
+                                               UniformRandomGenerator * uniform_generator,
+                                               OptimizationIOContainer * io_container) {
+  const int problem_size = io_container->problem_size;
+  return StreamingUniformSearch(domain, num_points, tile_size, num_states, uniform_generator,
+                                [&](int thread_index, double const * points, int num_tile_points, double * values) {
+      for (int i = 0; i < num_tile_points; ++i) {
+        states[thread_index].SetCurrentPoint(objective_evaluator, points + i*problem_size);
+        values[i] = objective_evaluator.ComputeObjectiveFunction(states + thread_index);
+      }
+    }, io_container);
+}
+
+/*!\rst
+  Successive-halving screen of ``num_multistarts`` initial guesses whose objective can be estimated at several
+  budgets (e.g., the number of MC iterations of EI/KG): every start is ranked at ``initial_budget``, the best half
+  survive, the budget doubles (capped at ``max_budget``), and so on until ``num_selected`` starts remain.  Once the
+  budget reaches ``max_budget``, the remaining starts are cut to ``num_selected`` in one step, so no estimate is ever
+  made at more than ``max_budget``.
+
+  With ``n`` starts, round ``r`` ranks about ``n/2^r`` starts at ``2^r*initial_budget``, so each round costs about
+  ``n*initial_budget`` evaluation units, versus ``n*max_budget`` for screening every start at full budget.
+
+  Each round is delegated to ``select_at_budget(budget, candidates, num_candidates, num_keep, kept)``, which must
+  write the ``num_keep`` best of the ``num_candidates`` ``candidates`` (estimated at ``budget``) to ``kept``; usually
+  SelectBestStartPoints() on states built for an objective at that budget.
+
+  \param
+    :select_at_budget: callable ranking a set of starts at a given budget (see above)
+    :start_point_set[problem_size][num_multistarts]: initial guesses
+    :problem_size: number of entries per start
+    :num_multistarts: number of initial guesses
+    :num_selected: number of starts to keep, ``1 <= num_selected <= num_multistarts``
+    :initial_budget: budget of the first round, ``>= 1``
+    :max_budget: largest budget used
+  \output
+    :selected_start_points[problem_size][num_selected]: the surviving starts, in the order of the final round
+\endrst*/
+template <typename SelectAtBudget>
+OL_NONNULL_POINTERS void SuccessiveHalvingSelectStartPoints(SelectAtBudget select_at_budget,
+                                                            double const * restrict start_point_set, int problem_size,
+                                                            int num_multistarts, int num_selected, int initial_budget,
+                                                            int max_budget, double * restrict selected_start_points) {
+  std::vector<double> candidates(start_point_set, start_point_set + num_multistarts*problem_size);
+  std::vector<double> survivors;
+  int num_candidates = num_multistarts;
+  int budget = std::min(std::max(initial_budget, 1), max_budget);
+  while (num_candidates > num_selected) {
+    const int num_keep = budget >= max_budget ? num_selected : std::max(num_selected, (num_candidates + 1)/2);
+    survivors.resize(num_keep*problem_size);
+    select_at_budget(budget, candidates.data(), num_candidates, num_keep, survivors.data());
+    candidates.swap(survivors);
+    num_candidates = num_keep;
+    budget = std::min(2*budget, max_budget);
+  }
+  std::copy(candidates.begin(), candidates.begin() + num_selected*problem_size, selected_start_points);
+}
+
 /*!\rst
   TODO(GH-390): Implement Polyak-Ruppert Averaging for Gradient Descent
 
@@ -611,21 +1457,26 @@ struct OptimizationIOContainer final {
     :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
     :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator template parameter
                          objective_state.GetCurrentPoint() will be used to obtain the initial guess
+    :trace[1]: OptimizationTrace to accumulate into, or nullptr (the default) not to trace
   \output
     :objective_state[1]: a state object whose temporary data members may have been modified
                          objective_state.GetCurrentPoint() will return the point yielding the best objective function value
                          according to gradient descent
+    :trace[1]: ``num_steps`` and ``num_boundary_steps`` incremented by the steps taken (and shortened by the domain)
 \endrst*/
 template <typename ObjectiveFunctionEvaluator, typename DomainType>
-OL_NONNULL_POINTERS void GradientDescentOptimization(
+OL_NONNULL_POINTERS_LIST(4) void GradientDescentOptimization(
     const ObjectiveFunctionEvaluator& objective_evaluator,
     const GradientDescentParameters& gd_parameters,
     const DomainType& domain,
-    typename ObjectiveFunctionEvaluator::StateType * objective_state) {
+    typename ObjectiveFunctionEvaluator::StateType * objective_state,
+    OptimizationTrace * trace = nullptr) {
   const int problem_size = objective_state->GetProblemSize();
   std::vector<double> grad_objective(problem_size);
   std::vector<double> step(problem_size);
   std::vector<double> next_point(problem_size);
+  // the unlimited step, to detect when the domain shortens it (only if tracing)
+  std::vector<double> requested_step(trace != nullptr ? problem_size : 0);
 
   // read out starting point coordinates
   objective_state->GetCurrentPoint(next_point.data());
@@ -640,6 +1491,9 @@ OL_NONNULL_POINTERS void GradientDescentOptimization(
 
   const double step_tolerance = gd_parameters.tolerance / static_cast<double>(gd_parameters.max_num_steps);
   for (int i = 0; i < gd_parameters.max_num_steps; ++i) {
+    if (unlikely(gd_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
     double alpha_n = gd_parameters.pre_mult*std::pow(static_cast<double>(i+1), -gd_parameters.gamma);
     objective_evaluator.ComputeGradObjectiveFunction(objective_state, grad_objective.data());
 #ifdef OL_VERBOSE_PRINT
@@ -653,8 +1507,17 @@ OL_NONNULL_POINTERS void GradientDescentOptimization(
     for (int j = 0; j < problem_size; ++j) {
       step[j] = alpha_n*grad_objective[j];
     }
+    if (unlikely(trace != nullptr)) {
+      std::copy(step.begin(), step.end(), requested_step.begin());
+    }
     // limit step size to ensure we stay inside the domain
     domain.LimitUpdate(gd_parameters.max_relative_change, next_point.data(), step.data());
+    if (unlikely(trace != nullptr)) {
+      ++trace->num_steps;
+      if (!std::equal(step.begin(), step.end(), requested_step.begin())) {
+        ++trace->num_boundary_steps;
+      }
+    }
     // take the step
     for (int j = 0; j < problem_size; ++j) {
       //printf("dim %d, step %f\n", j, step[j]);
@@ -705,14 +1568,164 @@ OL_NONNULL_POINTERS void GradientDescentOptimization(
 }
 
 /*!\rst
-  Uses Newton's Method to optimize the value of an objective function, f (e.g., log marginal likelihood).  Newton's method is
-  a root-finding technique, so for optimization, we are searching for points where gradient = 0.
-  http://en.wikipedia.org/wiki/Newton%27s_method_in_optimization
-  has some basic details.  Additional high-level discussion is provided in section 2b) in the header docs of this file.
+  GradientDescentOptimization() for a problem size fixed at compile time.  The iterates are exactly those of
+  GradientDescentOptimization() (same operations in the same order), but the point, gradient, and step live in
+  ``std::array<double, kProblemSize>`` on the stack, the per-coordinate loops have compile-time trip counts (so the
+  compiler unrolls them), and the GradientDescentParameters fields are read once instead of every step.
 
-  Each newton step is given by:
-  ``\theta_{n+1} = \theta_n - \bar{H}_f^-1(\theta_n) * \nabla f(\theta_n)``,
-  where ``\bar{H} = H_f(\theta_n) - 1/time_factor * I``, and
+  This targets small problems solved very many times, e.g., the inner optimization of knowledge gradient
+  (ComputeOptimalFuturePosteriorMean()), which optimizes a single point in ``dim`` variables once per MC iteration.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its gradient
+    :gd_parameters: GradientDescentParameters object that describes the parameters controlling gradient descent optimization
+    :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+    :objective_state[1]: a properly configured state object with ``GetProblemSize() == kProblemSize``
+  \output
+    :objective_state[1]: a state object whose temporary data members may have been modified
+                         objective_state.GetCurrentPoint() will return the point yielding the best objective function value
+                         according to gradient descent
+\endrst*/
+template <int kProblemSize, typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS void FixedSizeGradientDescentOptimization(
+    const ObjectiveFunctionEvaluator& objective_evaluator,
+    const GradientDescentParameters& gd_parameters,
+    const DomainType& domain,
+    typename ObjectiveFunctionEvaluator::StateType * objective_state) {
+  static_assert(kProblemSize > 0, "kProblemSize must be positive");
+  std::array<double, kProblemSize> grad_objective;
+  std::array<double, kProblemSize> step;
+  std::array<double, kProblemSize> next_point;
+
+  objective_state->GetCurrentPoint(next_point.data());
+
+  const int max_num_steps = gd_parameters.max_num_steps;
+  const double pre_mult = gd_parameters.pre_mult;
+  const double gamma = gd_parameters.gamma;
+  const double max_relative_change = gd_parameters.max_relative_change;
+  const double step_tolerance = gd_parameters.tolerance / static_cast<double>(max_num_steps);
+  for (int i = 0; i < max_num_steps; ++i) {
+    if (unlikely(gd_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
+    double alpha_n = pre_mult*std::pow(static_cast<double>(i+1), -gamma);
+    objective_evaluator.ComputeGradObjectiveFunction(objective_state, grad_objective.data());
+
+    for (int j = 0; j < kProblemSize; ++j) {
+      step[j] = alpha_n*grad_objective[j];
+    }
+    domain.LimitUpdate(max_relative_change, next_point.data(), step.data());
+    for (int j = 0; j < kProblemSize; ++j) {
+      next_point[j] += step[j];
+    }
+
+    objective_state->SetCurrentPoint(objective_evaluator, next_point.data());
+
+    if (VectorNorm(step.data(), kProblemSize) < step_tolerance) {
+      break;
+    }
+  }
+}
+
+/*!\rst
+  Lockstep GradientDescentOptimization() over a batch of states: every state takes step ``i`` at the same time, and the
+  gradients of step ``i`` come from ONE call to the evaluator's batch hook::
+
+    objective_evaluator.ComputeGradObjectiveFunctionBatch(states, num_states, points, grad_objective)
+
+  which moves each state to its point and returns all gradients (so GP evaluators can share the linear algebra across
+  the batch; see e.g., ExpectedImprovementEvaluator::ComputeGradObjectiveFunctionBatch()).  Step sizes, domain limiting,
+  and the per-state stopping rule are exactly those of GradientDescentOptimization(); a state that meets the step
+  tolerance leaves the batch, so later calls to the hook see only the states still moving.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its batched gradient
+    :gd_parameters: GradientDescentParameters object that describes the parameters controlling gradient descent optimization
+    :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+    :num_states: number of states in the batch
+    :objective_states[num_states]: pointers to distinct, properly configured state objects; their current points are
+      the initial guesses
+  \output
+    :objective_states[num_states]: each state's current point is the result of gradient descent from its initial guess
+\endrst*/
+template <typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS void BatchGradientDescentOptimization(
+    const ObjectiveFunctionEvaluator& objective_evaluator,
+    const GradientDescentParameters& gd_parameters,
+    const DomainType& domain,
+    int num_states,
+    typename ObjectiveFunctionEvaluator::StateType * const * objective_states) {
+  using StateType = typename ObjectiveFunctionEvaluator::StateType;
+  if (num_states <= 0) {
+    return;
+  }
+  const int problem_size = objective_states[0]->GetProblemSize();
+  std::vector<double> next_points(num_states*problem_size);
+  for (int k = 0; k < num_states; ++k) {
+    objective_states[k]->GetCurrentPoint(next_points.data() + k*problem_size);
+  }
+
+  // states still moving, and their positions in next_points; compacted as states converge
+  std::vector<StateType *> active_states(objective_states, objective_states + num_states);
+  std::vector<int> active_indices(num_states);
+  std::iota(active_indices.begin(), active_indices.end(), 0);
+  std::vector<double> active_points(num_states*problem_size);
+  std::vector<double> grad_objective(num_states*problem_size);
+  std::vector<double> step(problem_size);
+
+  const double step_tolerance = gd_parameters.tolerance / static_cast<double>(gd_parameters.max_num_steps);
+  for (int i = 0; i < gd_parameters.max_num_steps && !active_states.empty(); ++i) {
+    if (unlikely(gd_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
+    double alpha_n = gd_parameters.pre_mult*std::pow(static_cast<double>(i+1), -gd_parameters.gamma);
+    const int num_active = active_states.size();
+    for (int a = 0; a < num_active; ++a) {
+      std::copy(next_points.data() + active_indices[a]*problem_size,
+                next_points.data() + (active_indices[a]+1)*problem_size, active_points.data() + a*problem_size);
+    }
+    objective_evaluator.ComputeGradObjectiveFunctionBatch(active_states.data(), num_active, active_points.data(),
+                                                          grad_objective.data());
+
+    int num_still_active = 0;
+    for (int a = 0; a < num_active; ++a) {
+      double * restrict next_point = next_points.data() + active_indices[a]*problem_size;
+      // set up desired step size
+      for (int j = 0; j < problem_size; ++j) {
+        step[j] = alpha_n*grad_objective[a*problem_size + j];
+      }
+      // limit step size to ensure we stay inside the domain
+      domain.LimitUpdate(gd_parameters.max_relative_change, next_point, step.data());
+      // take the step
+      for (int j = 0; j < problem_size; ++j) {
+        next_point[j] += step[j];
+      }
+
+      if (VectorNorm(step.data(), problem_size) >= step_tolerance) {
+        active_states[num_still_active] = active_states[a];
+        active_indices[num_still_active] = active_indices[a];
+        ++num_still_active;
+      }
+    }
+    active_states.resize(num_still_active);
+    active_indices.resize(num_still_active);
+  }  // end loop over i (gradient descent)
+
+  // update states; every state's point changed on its final step
+  for (int k = 0; k < num_states; ++k) {
+    objective_states[k]->SetCurrentPoint(objective_evaluator, next_points.data() + k*problem_size);
+  }
+}
+
+/*!\rst
+  Uses Newton's Method to optimize the value of an objective function, f (e.g., log marginal likelihood).  Newton's method is
+  a root-finding technique, so for optimization, we are searching for points where gradient = 0.
+  http://en.wikipedia.org/wiki/Newton%27s_method_in_optimization
+  has some basic details.  Additional high-level discussion is provided in section 2b) in the header docs of this file.
+
+  Each newton step is given by:
+  ``\theta_{n+1} = \theta_n - \bar{H}_f^-1(\theta_n) * \nabla f(\theta_n)``,
+  where ``\bar{H} = H_f(\theta_n) - 1/time_factor * I``, and
   ``\nabla f`` and ``H`` are the gradient and Hessian of the objective function, respectively,
   ``time_factor = time_factor_0 * gamma^n``, and ``I`` is the identity matrix.
 
@@ -845,6 +1858,9 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonOptimization(
   int error = 0;
   int newton_iter;  // track the number of newton iterations
   for (newton_iter = 0; newton_iter < newton_parameters.max_num_steps; ++newton_iter) {
+    if (unlikely(newton_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
     objective_evaluator.ComputeGradObjectiveFunction(objective_state, gradient_objective.data());
 
     double norm_gradient_objective = VectorNorm(gradient_objective.data(), problem_size);
@@ -928,6 +1944,346 @@ OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT int NewtonOptimization(
   return error;
 }
 
+/*!\rst
+  Uses L-BFGS-B (limited-memory BFGS with box constraints) to optimize the value of an objective function, f
+  (e.g., log marginal likelihood), over a TensorProductDomain.
+
+  We maximize f by minimizing ``\phi = -f``.  Each iteration:
+
+  1. Computes the projected gradient of ``\phi``; components pushing against an active bound are dropped (those variables
+     stay fixed this iteration).  Stop if its infinity-norm is at most ``lbfgsb_parameters.tolerance``.
+  2. Builds a quasi-Newton direction on the free variables, ``d = -H * \nabla\phi``, where ``H`` is the limited-memory
+     BFGS inverse Hessian approximation from the ``history_size`` most recent ``(s_k, y_k)`` pairs (two-loop recursion,
+     scaled by ``s_k^T y_k / y_k^T y_k``).  If ``d`` is not a descent direction, the history is discarded and ``d`` falls
+     back to steepest descent.
+  3. Backtracks along the projected path ``x(t) = P(x + t*d)`` (``P`` clips onto the domain) from ``t = 1`` until the
+     Armijo condition ``\phi(x(t)) <= \phi(x) + c_1 \nabla\phi^T (x(t) - x)`` holds.  Non-finite objective values are
+     rejected like any other failed trial.
+  4. Stores ``(s, y) = (x_{new} - x, \nabla\phi_{new} - \nabla\phi)`` if the curvature ``s^T y`` is safely positive.
+
+  If the line search fails along a steepest descent direction (no better point can be found), we stop.
+
+  This is the projected-path variant of L-BFGS-B: it uses the same limited-memory update and active-set logic but
+  takes the free-variable quasi-Newton step directly instead of computing a generalized Cauchy point and solving the
+  subspace problem.  Iterates never leave the domain.
+
+  .. Note:: in general, you should not call/instantiate this function directly.  Instead, create a LBFGSBOptimizer object
+         and call its ::Optimize() function.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its gradient
+    :lbfgsb_parameters: LBFGSBParameters object that describes the parameters controlling L-BFGS-B
+      (e.g., number of iterations, history size, tolerance)
+    :domain: TensorProductDomain (or a type providing ``dim()`` and ``GetInterval()``) to optimize over
+    :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator template parameter
+                         objective_state.GetCurrentPoint() will be used to obtain the initial guess
+  \output
+    :objective_state[1]: a state object whose temporary data members may have been modified
+                         objective_state.GetCurrentPoint() will return the point yielding the best objective function value
+                         according to L-BFGS-B
+\endrst*/
+template <typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS void LBFGSBOptimization(
+    const ObjectiveFunctionEvaluator& objective_evaluator,
+    const LBFGSBParameters& lbfgsb_parameters,
+    const DomainType& domain,
+    typename ObjectiveFunctionEvaluator::StateType * objective_state) {
+  // sufficient decrease constant for the Armijo condition
+  const double armijo_constant = 1.0e-4;
+  // only keep (s, y) pairs with s^T y > curvature_epsilon * y^T y
+  const double curvature_epsilon = 1.0e-10;
+
+  const int problem_size = objective_state->GetProblemSize();
+  const int history_size = std::max(1, lbfgsb_parameters.history_size);
+  std::vector<double> point(problem_size);
+  std::vector<double> next_point(problem_size);
+  std::vector<double> gradient(problem_size);  // gradient of \phi = -f
+  std::vector<double> next_gradient(problem_size);
+  std::vector<double> direction(problem_size);
+  std::vector<bool> is_free(problem_size);
+  // history of (s_k, y_k), stored as a ring buffer; s_history[history_size][problem_size]
+  std::vector<double> s_history(history_size*problem_size);
+  std::vector<double> y_history(history_size*problem_size);
+  std::vector<double> rho_history(history_size);
+  std::vector<double> alpha_temp(history_size);
+  int num_stored = 0;
+  int newest = -1;
+
+  // start inside the domain
+  objective_state->GetCurrentPoint(point.data());
+  for (int j = 0; j < problem_size; ++j) {
+    const ClosedInterval& interval = domain.GetInterval(j);
+    point[j] = std::min(std::max(point[j], interval.min), interval.max);
+  }
+  objective_state->SetCurrentPoint(objective_evaluator, point.data());
+
+  double value = -ComputeObjectiveAndGradient(objective_evaluator, objective_state, gradient.data());
+  VectorScale(problem_size, -1.0, gradient.data());
+
+  for (int iter = 0; iter < lbfgsb_parameters.max_num_steps; ++iter) {
+    if (unlikely(lbfgsb_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
+    // free variables & projected gradient norm
+    double norm_projected_gradient = 0.0;
+    for (int j = 0; j < problem_size; ++j) {
+      const ClosedInterval& interval = domain.GetInterval(j);
+      is_free[j] = !((point[j] <= interval.min && gradient[j] > 0.0) || (point[j] >= interval.max && gradient[j] < 0.0));
+      if (is_free[j]) {
+        norm_projected_gradient = std::max(norm_projected_gradient, std::fabs(gradient[j]));
+      }
+    }
+    OL_VERBOSE_PRINTF("iter %d: objective fcn: %.18E, norm projected gradient: %.18E\n", iter, -value,
+                      norm_projected_gradient);
+    if (norm_projected_gradient <= lbfgsb_parameters.tolerance) {
+      break;
+    }
+
+    bool steepest_descent = false;
+    while (true) {
+      // direction := -H * gradient, restricted to the free variables (two-loop recursion)
+      for (int j = 0; j < problem_size; ++j) {
+        direction[j] = is_free[j] ? -gradient[j] : 0.0;
+      }
+      for (int k = 0; k < num_stored; ++k) {
+        const int index = (newest - k + history_size) % history_size;
+        double const * restrict s_k = s_history.data() + index*problem_size;
+        double const * restrict y_k = y_history.data() + index*problem_size;
+        double s_dot_direction = 0.0;
+        for (int j = 0; j < problem_size; ++j) {
+          s_dot_direction += is_free[j] ? s_k[j]*direction[j] : 0.0;
+        }
+        alpha_temp[k] = rho_history[index]*s_dot_direction;
+        for (int j = 0; j < problem_size; ++j) {
+          direction[j] -= is_free[j] ? alpha_temp[k]*y_k[j] : 0.0;
+        }
+      }
+      if (num_stored > 0) {
+        double const * restrict s_k = s_history.data() + newest*problem_size;
+        double const * restrict y_k = y_history.data() + newest*problem_size;
+        const double initial_scale = DotProduct(s_k, y_k, problem_size)/DotProduct(y_k, y_k, problem_size);
+        VectorScale(problem_size, initial_scale, direction.data());
+      }
+      for (int k = num_stored - 1; k >= 0; --k) {
+        const int index = (newest - k + history_size) % history_size;
+        double const * restrict s_k = s_history.data() + index*problem_size;
+        double const * restrict y_k = y_history.data() + index*problem_size;
+        double y_dot_direction = 0.0;
+        for (int j = 0; j < problem_size; ++j) {
+          y_dot_direction += is_free[j] ? y_k[j]*direction[j] : 0.0;
+        }
+        const double beta = rho_history[index]*y_dot_direction;
+        for (int j = 0; j < problem_size; ++j) {
+          direction[j] += is_free[j] ? (alpha_temp[k] - beta)*s_k[j] : 0.0;
+        }
+      }
+
+      steepest_descent = num_stored == 0;
+      if (DotProduct(direction.data(), gradient.data(), problem_size) < 0.0 || steepest_descent) {
+        break;
+      }
+      num_stored = 0;  // not a descent direction: discard the curvature history and use steepest descent
+    }
+
+    // the first steepest descent step has no curvature information for scaling; limit it to unit length
+    double step_length = 1.0;
+    if (steepest_descent) {
+      step_length = std::min(1.0, 1.0/VectorNorm(direction.data(), problem_size));
+    }
+
+    // backtracking line search along the projected path.  With a fused evaluator, the first (usually accepted) trial
+    // also computes the gradient, so an accepted first step costs one evaluation instead of two.
+    bool accepted = false;
+    bool have_next_gradient = false;
+    double next_value = value;
+    for (int i = 0; i < lbfgsb_parameters.max_num_line_search_steps; ++i, step_length *= 0.5) {
+      double directional_change = 0.0;
+      for (int j = 0; j < problem_size; ++j) {
+        const ClosedInterval& interval = domain.GetInterval(j);
+        next_point[j] = std::min(std::max(point[j] + step_length*direction[j], interval.min), interval.max);
+        directional_change += gradient[j]*(next_point[j] - point[j]);
+      }
+      if (!(directional_change < 0.0)) {
+        break;  // the projected step does not move (or goes uphill): no progress possible along this direction
+      }
+      objective_state->SetCurrentPoint(objective_evaluator, next_point.data());
+      have_next_gradient = i == 0 && HasComputeObjectiveAndGradient<ObjectiveFunctionEvaluator>::value;
+      if (have_next_gradient) {
+        next_value = -ComputeObjectiveAndGradient(objective_evaluator, objective_state, next_gradient.data());
+      } else {
+        next_value = -objective_evaluator.ComputeObjectiveFunction(objective_state);
+      }
+      if (next_value <= value + armijo_constant*directional_change) {  // false for NaN
+        accepted = true;
+        break;
+      }
+    }
+
+    if (!accepted) {
+      objective_state->SetCurrentPoint(objective_evaluator, point.data());
+      if (steepest_descent) {
+        break;  // cannot improve, even along steepest descent
+      }
+      num_stored = 0;  // retry from the same point along steepest descent
+      continue;
+    }
+
+    if (!have_next_gradient) {
+      objective_evaluator.ComputeGradObjectiveFunction(objective_state, next_gradient.data());
+    }
+    VectorScale(problem_size, -1.0, next_gradient.data());
+
+    // update the curvature history
+    const int slot = (newest + 1) % history_size;
+    double * restrict s_new = s_history.data() + slot*problem_size;
+    double * restrict y_new = y_history.data() + slot*problem_size;
+    for (int j = 0; j < problem_size; ++j) {
+      s_new[j] = next_point[j] - point[j];
+      y_new[j] = next_gradient[j] - gradient[j];
+    }
+    const double s_dot_y = DotProduct(s_new, y_new, problem_size);
+    if (s_dot_y > curvature_epsilon*DotProduct(y_new, y_new, problem_size)) {
+      rho_history[slot] = 1.0/s_dot_y;
+      newest = slot;
+      num_stored = std::min(num_stored + 1, history_size);
+    }
+
+    std::swap(point, next_point);
+    std::swap(gradient, next_gradient);
+    value = next_value;
+  }  // end loop over iter
+}
+
+/*!\rst
+  Gradient descent (steepest ascent) with an adaptive step size chosen by backtracking line search.  Each iteration:
+
+  1. Computes ``\nabla f(x)``.  Stop if its 2-norm is at most ``ls_parameters.tolerance``.
+  2. Proposes ``u = t * \nabla f(x)`` and restricts it with ``domain.LimitUpdate()`` (exactly as GradientDescentOptimization()
+     does) so that ``x + u`` stays inside the domain.
+  3. Accepts ``x + u`` if the Armijo condition ``f(x + u) >= f(x) + c_1 \nabla f(x)^T u`` holds; otherwise halves ``t`` and
+     retries, up to ``max_num_line_search_steps`` times.  Non-finite objective values are rejected like any other failed
+     trial.
+  4. Picks the next iteration's first trial ``t`` from the Barzilai-Borwein formula ``t = -s^T s / s^T y`` with
+     ``(s, y) = (x_{new} - x, \nabla f(x_{new}) - \nabla f(x))``, the step size that fits the curvature seen along the
+     last step.  If ``s^T y >= 0`` (no concave curvature along ``s``), ``t`` is doubled instead.
+
+  We also stop when the accepted step is shorter than ``tolerance`` (e.g., when pinned against a boundary) or when the
+  line search fails (no point along the gradient direction improves the objective enough).
+
+  Compared to GradientDescentOptimization(), the step size needs no ``pre_mult``/``gamma`` schedule: it tracks the local
+  curvature, and every accepted step satisfies the sufficient increase condition.  Because the
+  line search compares objective values, this is intended for deterministic objectives (for Monte-Carlo estimates,
+  fix the random draws or use GradientDescentOptimization()).
+
+  .. Note:: in general, you should not call/instantiate this function directly.  Instead, create a
+         LineSearchGradientDescentOptimizer object and call its ::Optimize() function.
+
+  \param
+    :objective_evaluator: reference to object that can compute the objective function and its gradient
+    :ls_parameters: LineSearchGradientDescentParameters object that describes the parameters controlling the optimization
+      (e.g., number of iterations, initial step size, tolerance)
+    :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+    :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator template parameter
+                         objective_state.GetCurrentPoint() will be used to obtain the initial guess
+  \output
+    :objective_state[1]: a state object whose temporary data members may have been modified
+                         objective_state.GetCurrentPoint() will return the point yielding the best objective function value
+                         according to line search gradient descent
+\endrst*/
+template <typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS void LineSearchGradientDescentOptimization(
+    const ObjectiveFunctionEvaluator& objective_evaluator,
+    const LineSearchGradientDescentParameters& ls_parameters,
+    const DomainType& domain,
+    typename ObjectiveFunctionEvaluator::StateType * objective_state) {
+  // sufficient increase constant for the Armijo condition
+  const double armijo_constant = 1.0e-4;
+  // step size multiplier when the last step saw no concave curvature
+  const double step_size_growth = 2.0;
+
+  const int problem_size = objective_state->GetProblemSize();
+  std::vector<double> point(problem_size);
+  std::vector<double> next_point(problem_size);
+  std::vector<double> gradient(problem_size);
+  std::vector<double> next_gradient(problem_size);
+  std::vector<double> step(problem_size);
+
+  objective_state->GetCurrentPoint(point.data());
+  double value = ComputeObjectiveAndGradient(objective_evaluator, objective_state, gradient.data());
+  double step_size = ls_parameters.initial_step_size;
+
+  for (int iter = 0; iter < ls_parameters.max_num_steps; ++iter) {
+    if (unlikely(ls_parameters.deadline.Expired())) {
+      break;  // out of time: keep the current point
+    }
+    const double norm_gradient = VectorNorm(gradient.data(), problem_size);
+    OL_VERBOSE_PRINTF("iter %d: objective fcn: %.18E, norm gradient: %.18E, step size: %.18E\n", iter, value,
+                      norm_gradient, step_size);
+    if (norm_gradient <= ls_parameters.tolerance) {
+      break;
+    }
+
+    // backtracking line search along the (domain-limited) gradient.  With a fused evaluator, the first trial also
+    // computes the gradient, so a step accepted on the first trial costs one evaluation instead of two.
+    bool accepted = false;
+    bool have_next_gradient = false;
+    double next_value = value;
+    for (int i = 0; i < ls_parameters.max_num_line_search_steps; ++i, step_size *= 0.5) {
+      for (int j = 0; j < problem_size; ++j) {
+        step[j] = step_size*gradient[j];
+      }
+      domain.LimitUpdate(ls_parameters.max_relative_change, point.data(), step.data());
+      const double directional_change = DotProduct(gradient.data(), step.data(), problem_size);
+      if (!(directional_change > 0.0)) {
+        break;  // the limited step does not move (or goes downhill): no progress possible
+      }
+      for (int j = 0; j < problem_size; ++j) {
+        next_point[j] = point[j] + step[j];
+      }
+      objective_state->SetCurrentPoint(objective_evaluator, next_point.data());
+      have_next_gradient = i == 0 && HasComputeObjectiveAndGradient<ObjectiveFunctionEvaluator>::value;
+      if (have_next_gradient) {
+        next_value = ComputeObjectiveAndGradient(objective_evaluator, objective_state, next_gradient.data());
+      } else {
+        next_value = objective_evaluator.ComputeObjectiveFunction(objective_state);
+      }
+      if (next_value >= value + armijo_constant*directional_change) {  // false for NaN
+        accepted = true;
+        break;
+      }
+    }
+
+    if (!accepted) {
+      objective_state->SetCurrentPoint(objective_evaluator, point.data());
+      break;
+    }
+
+    if (!have_next_gradient) {
+      objective_evaluator.ComputeGradObjectiveFunction(objective_state, next_gradient.data());
+    }
+
+    // Barzilai-Borwein step size for the next iteration (s = step, y = change in gradient); for maximization,
+    // concave curvature along s means s^T y < 0
+    double s_dot_y = 0.0;
+    for (int j = 0; j < problem_size; ++j) {
+      s_dot_y += step[j]*(next_gradient[j] - gradient[j]);
+    }
+    if (s_dot_y < 0.0) {
+      step_size = -DotProduct(step.data(), step.data(), problem_size)/s_dot_y;
+    } else {
+      step_size *= step_size_growth;
+    }
+
+    std::swap(point, next_point);
+    std::swap(gradient, next_gradient);
+    value = next_value;
+
+    if (VectorNorm(step.data(), problem_size) < ls_parameters.tolerance) {
+      break;
+    }
+  }  // end loop over iter
+}
+
 /*!\rst
   The "null" or identity optimizer: it does nothing, giving the same output its inputs
   This is useful to allow the multistart optimizer template to be reused for 'dumb' searches and
@@ -1021,6 +2377,24 @@ class GradientDescentOptimizer final {
   int Optimize(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& gd_parameters,
                const DomainType& domain, typename ObjectiveFunctionEvaluator::StateType * objective_state)
       const OL_NONNULL_POINTERS {
+    return Optimize(objective_evaluator, gd_parameters, domain, objective_state, nullptr);
+  }
+
+  /*!\rst
+    Optimize() that also fills ``trace`` (if not nullptr): the number of restarts and steps, the steps shortened by the
+    domain, whether the restarts converged (the last one moved the point by at most ``tolerance``), and the gradient
+    norm at the result (one extra gradient evaluation).  The other OptimizationTrace fields are left to the caller.
+    The iterates are those of Optimize().
+  \endrst*/
+  int Optimize(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& gd_parameters,
+               const DomainType& domain, typename ObjectiveFunctionEvaluator::StateType * objective_state,
+               OptimizationTrace * trace) const OL_NONNULL_POINTERS_LIST(5) {
+    if (trace != nullptr) {
+      trace->num_restarts = 0;
+      trace->num_steps = 0;
+      trace->num_boundary_steps = 0;
+      trace->converged = false;
+    }
     if (unlikely(gd_parameters.max_num_restarts <= 0)) {
       return 0;
     }
@@ -1032,11 +2406,17 @@ class GradientDescentOptimizer final {
     objective_state->GetCurrentPoint(next_point.data());
 
     for (int i = 0; i < gd_parameters.max_num_restarts; ++i) {
+      if (unlikely(gd_parameters.deadline.Expired())) {
+        break;
+      }
       // save off current location so we can compute the update norm
       std::copy(next_point.begin(), next_point.end(), current_point.begin());
       // get next gradient descent update
-      GradientDescentOptimization(objective_evaluator, gd_parameters, domain, objective_state);
+      GradientDescentOptimization(objective_evaluator, gd_parameters, domain, objective_state, trace);
       objective_state->GetCurrentPoint(next_point.data());
+      if (trace != nullptr) {
+        ++trace->num_restarts;
+      }
 
       // compute norm of the update
       for (int j = 0; j < problem_size; ++j) {
@@ -1047,10 +2427,19 @@ class GradientDescentOptimizer final {
       OL_VERBOSE_PRINTF("^Step %d^\n", i+1);
 
       if (norm_delta_coord <= gd_parameters.tolerance) {
+        if (trace != nullptr) {
+          trace->converged = true;
+        }
         break;  // point are no longer changing notably, so stop
       }
     }
 
+    if (trace != nullptr) {
+      // current_point is free; reuse it for the gradient
+      objective_evaluator.ComputeGradObjectiveFunction(objective_state, current_point.data());
+      trace->final_gradient_norm = VectorNorm(current_point.data(), problem_size);
+    }
+
 #ifdef OL_OPTIMIZATION_VERBOSE_PRINT
     if (norm_delta_coord > gd_parameters.tolerance) {
       // we didn't converge to a sufficient degree
@@ -1061,33 +2450,141 @@ class GradientDescentOptimizer final {
     return 0;
   }
 
+  /*!\rst
+    Optimize() for a batch of states in lockstep: the restarts of every state run together, and each restart is a
+    BatchGradientDescentOptimization() over the states that have not yet converged (by the same rule as Optimize()).
+    Each state follows exactly the iterates Optimize() would produce for it (up to rounding in the batched evaluator),
+    but the objective's gradients are requested for the whole batch at once.
+
+    See Optimize() for the meaning of the other parameters.  Requires
+    ``ObjectiveFunctionEvaluator::ComputeGradObjectiveFunctionBatch()``.
+
+    \param
+      :num_states: number of states in the batch
+      :objective_states[num_states]: pointers to distinct, properly configured state objects; their current points are
+        the initial guesses
+    \output
+      :objective_states[num_states]: each state's current point is the result of restarted gradient descent
+    \return
+      number of errors, always 0
+  \endrst*/
+  int OptimizeBatch(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& gd_parameters,
+                    const DomainType& domain, int num_states,
+                    typename ObjectiveFunctionEvaluator::StateType * const * objective_states) const OL_NONNULL_POINTERS {
+    using StateType = typename ObjectiveFunctionEvaluator::StateType;
+    if (unlikely(gd_parameters.max_num_restarts <= 0 || num_states <= 0)) {
+      return 0;
+    }
+    const int problem_size = objective_states[0]->GetProblemSize();
+    std::vector<StateType *> active_states(objective_states, objective_states + num_states);
+    std::vector<double> current_point(problem_size);
+    std::vector<double> next_point(problem_size);
+    std::vector<double> restart_points(num_states*problem_size);
+
+    for (int i = 0; i < gd_parameters.max_num_restarts && !active_states.empty(); ++i) {
+      if (unlikely(gd_parameters.deadline.Expired())) {
+        break;
+      }
+      const int num_active = active_states.size();
+      // save off current locations so we can compute the update norms
+      for (int a = 0; a < num_active; ++a) {
+        active_states[a]->GetCurrentPoint(restart_points.data() + a*problem_size);
+      }
+      BatchGradientDescentOptimization(objective_evaluator, gd_parameters, domain, num_active, active_states.data());
+
+      int num_still_active = 0;
+      for (int a = 0; a < num_active; ++a) {
+        active_states[a]->GetCurrentPoint(next_point.data());
+        for (int j = 0; j < problem_size; ++j) {
+          current_point[j] = restart_points[a*problem_size + j] - next_point[j];
+        }
+        // states whose points are no longer changing notably are done
+        if (VectorNorm(current_point.data(), problem_size) > gd_parameters.tolerance) {
+          active_states[num_still_active++] = active_states[a];
+        }
+      }
+      active_states.resize(num_still_active);
+    }
+
+    return 0;
+  }
+
   OL_DISALLOW_COPY_AND_ASSIGN(GradientDescentOptimizer);
 };
 
 /*!\rst
-  Newton optimization.  This class optimizes using Newton's method with a refinement step (see comments on the Optimize()) function.
+  GradientDescentOptimizer for a problem size fixed at compile time: the same restarted gradient descent, built on
+  FixedSizeGradientDescentOptimization(), so it produces exactly the results of GradientDescentOptimizer.  Use it
+  (through MultistartOptimizer, like any Optimizer) for tiny problems solved in hot loops; dispatch on the runtime
+  problem size to pick ``kProblemSize``.
 \endrst*/
-template <typename ObjectiveFunctionEvaluator_, typename DomainType_>
-class NewtonOptimizer final {
+template <typename ObjectiveFunctionEvaluator_, typename DomainType_, int kProblemSize>
+class FixedSizeGradientDescentOptimizer final {
  public:
   using ObjectiveFunctionEvaluator = ObjectiveFunctionEvaluator_;
   using DomainType = DomainType_;
-  using ParameterStruct = NewtonParameters;
+  using ParameterStruct = GradientDescentParameters;
 
-  NewtonOptimizer() = default;
+  FixedSizeGradientDescentOptimizer() = default;
 
   /*!\rst
-    Uses Newton's Method to optimize the value of an objective function, f (e.g., log marginal likelihood).
-
-    .. NOTE:: this function wraps NewtonOptimization(), see above.  It first calls that function directly, then calls it again
-        with a modified newton_parameters struct: the param struct is modified to run newton with a small number
-        of iterations at a huge time_factor (to remove the diagonal dominance adjustment entirely).  We do this
-        to ensure that Newton has converged.
+    See GradientDescentOptimizer::Optimize(); requires ``objective_state->GetProblemSize() == kProblemSize``.
 
-    See section 2b) and 3b, ii) in the header docs and the docs for NewtonOptimization() for more details.
+    \return
+      number of errors, always 0
+  \endrst*/
+  int Optimize(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& gd_parameters,
+               const DomainType& domain, typename ObjectiveFunctionEvaluator::StateType * objective_state)
+      const OL_NONNULL_POINTERS {
+    std::array<double, kProblemSize> current_point;
+    std::array<double, kProblemSize> next_point;
+    objective_state->GetCurrentPoint(next_point.data());
 
-    Solution is guaranteed to lie within the region specified by "domain"; note that this may not be a
-    true optima (i.e., the gradient may be substantially nonzero).
+    for (int i = 0; i < gd_parameters.max_num_restarts; ++i) {
+      if (unlikely(gd_parameters.deadline.Expired())) {
+        break;
+      }
+      current_point = next_point;
+      FixedSizeGradientDescentOptimization<kProblemSize>(objective_evaluator, gd_parameters, domain, objective_state);
+      objective_state->GetCurrentPoint(next_point.data());
+
+      for (int j = 0; j < kProblemSize; ++j) {
+        current_point[j] -= next_point[j];
+      }
+      if (VectorNorm(current_point.data(), kProblemSize) <= gd_parameters.tolerance) {
+        break;  // point are no longer changing notably, so stop
+      }
+    }
+    return 0;
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(FixedSizeGradientDescentOptimizer);
+};
+
+/*!\rst
+  Newton optimization.  This class optimizes using Newton's method with a refinement step (see comments on the Optimize()) function.
+\endrst*/
+template <typename ObjectiveFunctionEvaluator_, typename DomainType_>
+class NewtonOptimizer final {
+ public:
+  using ObjectiveFunctionEvaluator = ObjectiveFunctionEvaluator_;
+  using DomainType = DomainType_;
+  using ParameterStruct = NewtonParameters;
+
+  NewtonOptimizer() = default;
+
+  /*!\rst
+    Uses Newton's Method to optimize the value of an objective function, f (e.g., log marginal likelihood).
+
+    .. NOTE:: this function wraps NewtonOptimization(), see above.  It first calls that function directly, then calls it again
+        with a modified newton_parameters struct: the param struct is modified to run newton with a small number
+        of iterations at a huge time_factor (to remove the diagonal dominance adjustment entirely).  We do this
+        to ensure that Newton has converged.
+
+    See section 2b) and 3b, ii) in the header docs and the docs for NewtonOptimization() for more details.
+
+    Solution is guaranteed to lie within the region specified by "domain"; note that this may not be a
+    true optima (i.e., the gradient may be substantially nonzero).
 
     problem_size refers to objective_state->GetProblemSize(), the number of dimensions in a "point" aka the number of
     variables being optimized.  (This might be the spatial dimension for EI or the number of hyperparameters for log likelihood.)
@@ -1130,9 +2627,131 @@ class NewtonOptimizer final {
   OL_DISALLOW_COPY_AND_ASSIGN(NewtonOptimizer);
 };
 
+/*!\rst
+  L-BFGS-B optimization.  This class optimizes using limited-memory BFGS with box constraints (see comments on
+  LBFGSBOptimization()).  DomainType must expose its per-coordinate bounds through ``GetInterval()`` (e.g., TensorProductDomain).
+\endrst*/
+template <typename ObjectiveFunctionEvaluator_, typename DomainType_>
+class LBFGSBOptimizer final {
+ public:
+  using ObjectiveFunctionEvaluator = ObjectiveFunctionEvaluator_;
+  using DomainType = DomainType_;
+  using ParameterStruct = LBFGSBParameters;
+
+  LBFGSBOptimizer() = default;
+
+  /*!\rst
+    Optimize a given objective function (represented by ObjectiveFunctionEvaluator; see file comments for what this must provide)
+    using L-BFGS-B.  See LBFGSBOptimization() for details.
+
+    Solution is guaranteed to lie within the region specified by "domain"; at a solution on the boundary, only the
+    gradient components along non-active bounds are (near) zero.
+
+    \param
+      :objective_evaluator: reference to object that can compute the objective function and its gradient
+      :lbfgsb_parameters: LBFGSBParameters object that describes the parameters controlling L-BFGS-B
+        (e.g., number of iterations, history size, tolerance)
+      :domain: object specifying the (box) domain to optimize over (see gpp_domain.hpp)
+      :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator template parameter
+                           objective_state.GetCurrentPoint() will be used to obtain the initial guess
+    \output
+      :objective_state[1]: a state object whose temporary data members may have been modified
+                           objective_state.GetCurrentPoint() will return the point yielding the best objective function value
+                           according to L-BFGS-B
+    \return
+      number of errors, always 0
+  \endrst*/
+  int Optimize(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& lbfgsb_parameters,
+               const DomainType& domain, typename ObjectiveFunctionEvaluator::StateType * objective_state)
+      const OL_NONNULL_POINTERS {
+    if (unlikely(lbfgsb_parameters.max_num_steps <= 0)) {
+      return 0;
+    }
+    LBFGSBOptimization(objective_evaluator, lbfgsb_parameters, domain, objective_state);
+    return 0;
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(LBFGSBOptimizer);
+};
+
+/*!\rst
+  Line search gradient descent optimization.  This class optimizes using steepest ascent with an adaptive step size
+  chosen by Armijo backtracking (see comments on LineSearchGradientDescentOptimization()).  It accepts the same domains
+  as GradientDescentOptimizer.
+\endrst*/
+template <typename ObjectiveFunctionEvaluator_, typename DomainType_>
+class LineSearchGradientDescentOptimizer final {
+ public:
+  using ObjectiveFunctionEvaluator = ObjectiveFunctionEvaluator_;
+  using DomainType = DomainType_;
+  using ParameterStruct = LineSearchGradientDescentParameters;
+
+  LineSearchGradientDescentOptimizer() = default;
+
+  /*!\rst
+    Optimize a given objective function (represented by ObjectiveFunctionEvaluator; see file comments for what this must provide)
+    using gradient descent with a backtracking line search.  See LineSearchGradientDescentOptimization() for details.
+
+    Solution is guaranteed to lie within the region specified by "domain"; note that this may not be a
+    true optima (i.e., the gradient may be substantially nonzero).
+
+    \param
+      :objective_evaluator: reference to object that can compute the objective function and its gradient
+      :ls_parameters: LineSearchGradientDescentParameters object that describes the parameters controlling the optimization
+        (e.g., number of iterations, initial step size, tolerance)
+      :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+      :objective_state[1]: a properly configured state object for the ObjectiveFunctionEvaluator template parameter
+                           objective_state.GetCurrentPoint() will be used to obtain the initial guess
+    \output
+      :objective_state[1]: a state object whose temporary data members may have been modified
+                           objective_state.GetCurrentPoint() will return the point yielding the best objective function value
+                           according to line search gradient descent
+    \return
+      number of errors, always 0
+  \endrst*/
+  int Optimize(const ObjectiveFunctionEvaluator& objective_evaluator, const ParameterStruct& ls_parameters,
+               const DomainType& domain, typename ObjectiveFunctionEvaluator::StateType * objective_state)
+      const OL_NONNULL_POINTERS {
+    if (unlikely(ls_parameters.max_num_steps <= 0)) {
+      return 0;
+    }
+    LineSearchGradientDescentOptimization(objective_evaluator, ls_parameters, domain, objective_state);
+    return 0;
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(LineSearchGradientDescentOptimizer);
+};
+
+/*!\rst
+  ``optimizer.Optimize()``, filling ``trace`` (if not nullptr) with whatever the optimizer reports about its run.
+  Optimizers other than GradientDescentOptimizer report nothing (see OptimizationTrace).
+\endrst*/
+template <typename Optimizer>
+OL_NONNULL_POINTERS_LIST(5) int OptimizeAndTrace(
+    const Optimizer& optimizer,
+    const typename Optimizer::ObjectiveFunctionEvaluator& objective_evaluator,
+    const typename Optimizer::ParameterStruct& optimizer_parameters,
+    const typename Optimizer::DomainType& domain,
+    typename Optimizer::ObjectiveFunctionEvaluator::StateType * objective_state,
+    OptimizationTrace * OL_UNUSED(trace)) {
+  return optimizer.Optimize(objective_evaluator, optimizer_parameters, domain, objective_state);
+}
+
+template <typename ObjectiveFunctionEvaluator, typename DomainType>
+OL_NONNULL_POINTERS_LIST(5) int OptimizeAndTrace(
+    const GradientDescentOptimizer<ObjectiveFunctionEvaluator, DomainType>& optimizer,
+    const ObjectiveFunctionEvaluator& objective_evaluator,
+    const GradientDescentParameters& gd_parameters,
+    const DomainType& domain,
+    typename ObjectiveFunctionEvaluator::StateType * objective_state,
+    OptimizationTrace * trace) {
+  return optimizer.Optimize(objective_evaluator, gd_parameters, domain, objective_state, trace);
+}
+
 /*!\rst
   This is a general, template class for multistart optimization.  It is designed to be used with the various Optimizer
-  classes in this file (e.g., NullOptimizer, GradientDescentOptimizer, NewtonOptimizer).  The multistart process is
+  classes in this file (e.g., NullOptimizer, GradientDescentOptimizer, NewtonOptimizer, LBFGSBOptimizer,
+  LineSearchGradientDescentOptimizer).  The multistart process is
   multithreaded using OpenMP so that we can start from multiple initial guesses across multiple threads simultaneously.
   See section 2c) and 3b, iii) in the header docs at the top of the file for more details.
 
@@ -1150,7 +2769,9 @@ class NewtonOptimizer final {
   to use the same code as multistart optimization.  'Dumb' search is inaccurate but it never fails, so we often use it as a
   fall-back when more advanced (e.g., gradient descent) techniques fail.
 
-  This class provides just one method (for now), MultistartOptimize(); see below.
+  This class provides three methods: MultistartOptimize(), which runs every start to completion, MultistartRace(),
+  which advances all starts in short rounds and drops the worst after each round, and MultistartOptimizeBatch(),
+  which advances starts in lockstep batches through a batched gradient hook; see below.
 
   .. Note:: comments copied to MultistartOptimizer in python_version/optimization.py.
 \endrst*/
@@ -1218,10 +2839,16 @@ class MultistartOptimizer final {
         optimization run, in the same order as initial_guesses. Can be used to check
         what each optimization run converged to.
         More commonly used only with NullOptimizer to get a list of objective values  at each point of initial_guesses.
+        Starts skipped because the deadline passed get ``-infinity``.
         Never dereferenced if nullptr.
       :io_container[1]: object container new best_objective_value_so_far and corresponding
         best_point IF found_flag is true.
         Unchanged from input otherwise. See struct docs in gpp_optimization.hpp for details.
+        ``deadline_reached`` is set if ``optimizer_parameters.deadline`` passed before every start finished: starts
+        not yet begun are skipped and running ones stop at their current point (see OptimizationDeadline).
+        ``start_traces`` and ``num_distinct_optima`` describe every start if GetRecordTraces(optimizer_parameters)
+        (see OptimizationTrace); ``start_traces`` is emptied otherwise.
+        ``top_points`` holds the best distinct end points if ``top_points.num_points > 0`` (see DiverseTopPoints).
     \raise
       if any of objective_state_vector->SetCurrentPoint(), optimizer.Optimize(), or
       objective_evaluator.ComputeObjectiveFunction() throws, the exception (or one of the exceptions in the
@@ -1233,6 +2860,13 @@ class MultistartOptimizer final {
                           const ThreadSchedule& thread_schedule, double const * restrict initial_guesses,
                           int num_multistarts, typename ObjectiveFunctionEvaluator::StateType * objective_state_vector,
                           double * restrict function_values, OptimizationIOContainer * restrict io_container) {
+    if (thread_schedule.backend == ParallelBackend::kWorkStealing) {
+      MultistartOptimizeWorkStealing(optimizer, objective_evaluator, optimizer_parameters, domain, thread_schedule,
+                                     initial_guesses, num_multistarts, objective_state_vector, function_values,
+                                     io_container);
+      return;
+    }
+
     const int problem_size = objective_state_vector[0].GetProblemSize();
 
     // exception_capture_flag "guards" captured_exception. std::called_once() guarantees that will only execute
@@ -1245,19 +2879,50 @@ class MultistartOptimizer final {
     std::exception_ptr captured_exception;
 
     io_container->found_flag = false;
+    io_container->deadline_reached = false;
     const double best_objective_value_so_far_init = io_container->best_objective_value_so_far;
+    const OptimizationDeadline deadline = GetOptimizationDeadline(optimizer_parameters);
     int total_errors = 0;
+    bool deadline_reached = false;
+    const bool record_traces = GetRecordTraces(optimizer_parameters);
+    ResetTraces(record_traces, num_multistarts, io_container);
+    // every start's result, for the diverse top-k reduction (if requested)
+    std::vector<double> start_values;
+    std::vector<double> start_points;
+    ResetTopPoints(num_multistarts, problem_size, &start_values, &start_points, io_container);
+
+    // autotuned loops use their calibrated schedule; the first one of each kind calibrates (see LoopScheduleTuner)
+    ThreadSchedule loop_schedule(thread_schedule);
+    const std::type_index loop_type(typeid(Optimizer));
+    std::vector<double> iteration_seconds;
+    if (thread_schedule.autotune || LoopScheduleTuner::Instance().autotune_by_default()) {
+      LoopCostProfile profile;
+      if (LoopScheduleTuner::Instance().Lookup(loop_type, problem_size, &profile)) {
+        const TunedLoopSchedule tuned = LoopScheduleTuner::ChooseSchedule(profile, num_multistarts,
+                                                                          thread_schedule.max_num_threads);
+        loop_schedule.schedule = tuned.schedule;
+        loop_schedule.chunk_size = tuned.chunk_size;
+        loop_schedule.max_num_threads = tuned.num_threads;
+      } else {
+        // dynamic scheduling is safe for any distribution of iteration costs
+        loop_schedule.schedule = omp_sched_dynamic;
+        loop_schedule.chunk_size = 1;
+        iteration_seconds.resize(num_multistarts);
+      }
+    }
+    const bool calibrating = !iteration_seconds.empty();
 
-    omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
-#pragma omp parallel num_threads(thread_schedule.max_num_threads)
+    omp_set_schedule(loop_schedule.schedule, loop_schedule.chunk_size);
+#pragma omp parallel num_threads(loop_schedule.max_num_threads)
     {
       double best_objective_value_so_far_local = best_objective_value_so_far_init;
       double objective_value;
       std::vector<double> next_point_local(problem_size);
       std::vector<double> best_next_point_local(problem_size);
       int thread_id = omp_get_thread_num();
+      ThreadPlacement::Instance().PinCurrentThread(thread_id);
 
-#pragma omp for nowait schedule(runtime) reduction(+:total_errors)
+#pragma omp for nowait schedule(runtime) reduction(+:total_errors) reduction(||:deadline_reached)
       for (int i = 0; i < num_multistarts; ++i) {
         // It is illegal for exceptions to leave OpenMP blocks. Violating this condition leads to undefined behavior
         // (usually program termination). See:
@@ -1272,19 +2937,43 @@ class MultistartOptimizer final {
         // Thus, we must catch and handle *all* exceptions within this ``omp for`` region. To propagate an
         // exception out of this structured block, we will capture an active exception into a std::exception_ptr.
         // Typically, the *first* exception thrown (temporally) will be captured.
+        // out of time: skip the remaining starts (an OpenMP loop cannot break)
+        if (unlikely(deadline.Expired())) {
+          deadline_reached = true;
+          if (unlikely(function_values != nullptr)) {
+            function_values[i] = -std::numeric_limits<double>::infinity();
+          }
+          continue;
+        }
         try {
+          const double start_time = calibrating ? omp_get_wtime() : 0.0;
+          SelectNormalStream(objective_state_vector + thread_id, i);
           objective_state_vector[thread_id].SetCurrentPoint(objective_evaluator, initial_guesses + i*problem_size);
 
-          if (unlikely(optimizer.Optimize(objective_evaluator, optimizer_parameters, domain, objective_state_vector + thread_id) != 0)) {
+          OptimizationTrace * trace = record_traces ? io_container->start_traces.data() + i : nullptr;
+          if (unlikely(OptimizeAndTrace(optimizer, objective_evaluator, optimizer_parameters, domain,
+                                        objective_state_vector + thread_id, trace) != 0)) {
             ++total_errors;
           }
 
+          // the run may have been cut short
+          deadline_reached = deadline_reached || deadline.Expired();
+
           // compute objective at the new potential optimum; note Optimize() guarantees optimum point is already in state
           objective_value = objective_evaluator.ComputeObjectiveFunction(objective_state_vector + thread_id);
 
           if (unlikely(function_values != nullptr)) {
             function_values[i] = objective_value;
           }
+          if (trace != nullptr) {
+            trace->objective_value = objective_value;
+            trace->final_point.resize(problem_size);
+            objective_state_vector[thread_id].GetCurrentPoint(trace->final_point.data());
+          }
+          if (!start_values.empty()) {
+            start_values[i] = objective_value;
+            objective_state_vector[thread_id].GetCurrentPoint(start_points.data() + i*problem_size);
+          }
 
           // update thread-locally if we found improvement
           if (best_objective_value_so_far_local < objective_value) {
@@ -1299,8 +2988,11 @@ class MultistartOptimizer final {
             }
 #endif
           }
+          if (calibrating) {
+            iteration_seconds[i] = omp_get_wtime() - start_time;
+          }
         } catch (const std::exception& except) {
-          OL_ERROR_PRINTF("Thread %d of %d failed on iteration %d of %d. Message:\n%s\n", thread_id, thread_schedule.max_num_threads, i, num_multistarts, except.what());
+          OL_ERROR_PRINTF("Thread %d of %d failed on iteration %d of %d. Message:\n%s\n", thread_id, loop_schedule.max_num_threads, i, num_multistarts, except.what());
           // std::call_once() ensures that the code body here is executed *once* for each unique std::once_flag (we
           // only have 1 instance). Additionally, the operations inside are "atomic" in the sense that no invocation of
           // call_once() will return before the aforementioned single execution is complete (so no risk of partially
@@ -1327,6 +3019,22 @@ class MultistartOptimizer final {
     if (unlikely(total_errors != 0)) {
       OL_WARNING_PRINTF("WARNING: %d newton runs exited due to singular Hessian matrices.\n", total_errors);
     }
+    io_container->deadline_reached = deadline_reached;
+    if (record_traces) {
+      io_container->num_distinct_optima = ClusterOptimizationTraces(io_container->trace_optimum_tolerance,
+                                                                    &io_container->start_traces);
+    }
+    if (!start_values.empty()) {
+      SelectDiverseTopPoints(start_values.data(), start_points.data(), num_multistarts, problem_size,
+                             &io_container->top_points);
+    }
+
+    // a run cut short by an exception or the deadline does not represent the loop's costs
+    if (calibrating && captured_exception == nullptr && !deadline_reached) {
+      LoopScheduleTuner::Instance().Record(loop_type, problem_size,
+                                           LoopScheduleTuner::ProfileIterations(iteration_seconds.data(),
+                                                                                num_multistarts));
+    }
 
 #ifdef OL_OPTIMIZATION_VERBOSE_PRINT
     if (false == io_container->found_flag) {
@@ -1342,7 +3050,546 @@ class MultistartOptimizer final {
     }
   }
 
+  /*!\rst
+    MultistartOptimize() over the ranks of a DistributedContext (see gpp_distributed.hpp): each rank optimizes its
+    block of ``initial_guesses`` (see DistributedContext::BlockRange()) on its own threads, then the ranks combine their
+    results.  This is a collective: every rank calls it with the same inputs (the same problem, ``initial_guesses``,
+    and ``io_container``), and every rank receives the same best point and value and ``function_values``.
+
+    The winner is the best point over the ranks, ties going to the lowest rank (so to the earliest start, as in
+    MultistartOptimize()).  The per-start diagnostics (``start_traces``, ``num_distinct_optima``, ``top_points``)
+    describe this rank's block only.
+
+    \param
+      :distributed_context: the ranks to spread the starts over
+      :others: see MultistartOptimize()
+    \output
+      see MultistartOptimize(); ``function_values`` covers every start, and ``deadline_reached`` is set if the deadline
+      passed on any rank
+    \raise
+      if MultistartOptimize() throws on any rank, every rank throws (see DistributedContext::RethrowIfAnyFailed())
+  \endrst*/
+  void MultistartOptimizeDistributed(const Optimizer& optimizer, const ObjectiveFunctionEvaluator& objective_evaluator,
+                                     const ParameterStruct& optimizer_parameters, const DomainType& domain,
+                                     const DistributedContext& distributed_context,
+                                     const ThreadSchedule& thread_schedule, double const * restrict initial_guesses,
+                                     int num_multistarts,
+                                     typename ObjectiveFunctionEvaluator::StateType * objective_state_vector,
+                                     double * restrict function_values, OptimizationIOContainer * restrict io_container) {
+    const int problem_size = objective_state_vector[0].GetProblemSize();
+    int begin, end;
+    distributed_context.BlockRange(num_multistarts, &begin, &end);
+
+    // captured so that this rank still joins the collectives below
+    std::exception_ptr captured_exception;
+    io_container->found_flag = false;
+    io_container->deadline_reached = false;
+    if (end > begin) {
+      try {
+        MultistartOptimize(optimizer, objective_evaluator, optimizer_parameters, domain, thread_schedule,
+                           initial_guesses + begin*problem_size, end - begin, objective_state_vector,
+                           function_values != nullptr ? function_values + begin : nullptr, io_container);
+      } catch (const std::exception&) {
+        captured_exception = std::current_exception();
+      }
+    }
+
+    distributed_context.RethrowIfAnyFailed(captured_exception);
+
+    if (function_values != nullptr) {
+      distributed_context.AllGatherBlocks(num_multistarts, 1, function_values);
+    }
+    io_container->deadline_reached = distributed_context.AnyOf(io_container->deadline_reached);
+    const bool found_flag = distributed_context.AnyOf(io_container->found_flag);
+    // ranks that did not beat the initial best do not compete
+    const int winner = distributed_context.ArgMaxRank(io_container->found_flag ?
+                                                      io_container->best_objective_value_so_far : -INFINITY);
+    if (found_flag) {
+      distributed_context.Broadcast(winner, &io_container->best_objective_value_so_far, 1);
+      distributed_context.Broadcast(winner, io_container->best_point.data(), problem_size);
+      io_container->found_flag = true;
+    }
+  }
+
+  /*!\rst
+    Races the multistarts instead of running each to completion.  All starts advance in rounds: each round runs
+    ``optimizer.Optimize()`` with ``round_parameters`` (a SHORT run, e.g., one gradient descent restart of a few steps)
+    from where the start's previous round stopped.  After each round the survivors are ranked (see RacingParameters)
+    and the bottom ``racing_parameters.drop_fraction`` is dropped, so later rounds spend the threads on fewer,
+    better starts.  Starts heading to poor local optima are abandoned after a few steps instead of being optimized to
+    convergence.
+
+    Each round is parallelized over the survivors with at most ``min(thread_schedule.max_num_threads, num_survivors)``
+    outer threads.  With ``ParallelBackend::kWorkStealing``, the workers that the dropped starts free up pick up the
+    survivors' nested loops (e.g., the MC iterations of a KG evaluation).  With OpenMP, the outer region goes inactive
+    once one start is left, so that start's nested loops can fork.
+
+    The start with the best current value always survives (the optimistic bound could otherwise rank a start that
+    has already converged to the best optimum below faster-climbing ones).  Rankings break ties by start index, so the result does not depend on the thread schedule or backend whenever
+    the objective itself does not.
+
+    Racing only screens: callers typically continue with MultistartOptimize() over the returned ``survivor_points``
+    with the full ParameterStruct.
+
+    \param
+      :optimizer: object with the desired Optimize() functionality
+      :objective_evaluator: reference to object that can compute the objective function and its derivatives
+      :round_parameters: Optimizer::ParameterStruct object for ONE round (num_multistarts is ignored)
+      :racing_parameters: RacingParameters object controlling rounds and dropping
+      :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+      :thread_schedule: struct instructing OpenMP on how to schedule threads; see MultistartOptimize()
+      :initial_guesses[problem_size][num_multistarts]: list of points at which to start optimization runs; all points
+        must lie INSIDE the specified domain
+      :num_multistarts: number of points in initial_guesses
+      :objective_state_vector[thread_schedule.max_num_threads]: properly constructed/configured
+        ObjectiveFunctionEvaluator::State objects, at least one per thread
+      :io_container[1]: object with best_objective_value_so_far and corresponding best_point properly initialized
+    \output
+      :objective_state_vector[thread_schedule.max_num_threads]: internal states of state objects may be modified
+      :function_values[num_multistarts]: objective fcn value of each start at the end of the last round it took part
+        in, in the same order as initial_guesses.  Never dereferenced if nullptr.
+      :survivor_points[problem_size][num_multistarts]: the first ``num_survivors`` (return value) rows hold the points
+        reached by the surviving starts, best-ranked first; the remaining rows are unspecified
+      :io_container[1]: best point reached by ANY start in any round, if it beats the input value; otherwise
+        unchanged from input.  See struct docs in gpp_optimization.hpp for details.  If ``round_parameters.deadline``
+        passes, racing stops after the current round with ``deadline_reached`` set.
+    \return
+      number of surviving starts, in ``[1, num_multistarts]`` (0 if num_multistarts is 0)
+    \raise
+      LowerBoundException if ``racing_parameters.num_rounds < 1`` or ``racing_parameters.min_num_survivors < 1``;
+      BoundsException if ``racing_parameters.drop_fraction`` is not in ``[0, 1)``.
+      If any of objective_state_vector->SetCurrentPoint(), optimizer.Optimize(), or
+      objective_evaluator.ComputeObjectiveFunction() throws, the round finishes, ``io_container`` is updated with the
+      results so far, and one of the exceptions is rethrown; ``function_values`` and ``survivor_points`` may not be valid.
+  \endrst*/
+  int MultistartRace(const Optimizer& optimizer, const ObjectiveFunctionEvaluator& objective_evaluator,
+                     const ParameterStruct& round_parameters, const RacingParameters& racing_parameters,
+                     const DomainType& domain, const ThreadSchedule& thread_schedule,
+                     double const * restrict initial_guesses, int num_multistarts,
+                     typename ObjectiveFunctionEvaluator::StateType * objective_state_vector,
+                     double * restrict function_values, double * restrict survivor_points,
+                     OptimizationIOContainer * restrict io_container) {
+    if (unlikely(racing_parameters.num_rounds < 1)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "num_rounds must be >= 1.", racing_parameters.num_rounds, 1);
+    }
+    if (unlikely(racing_parameters.min_num_survivors < 1)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "min_num_survivors must be >= 1.",
+                         racing_parameters.min_num_survivors, 1);
+    }
+    if (unlikely(!(racing_parameters.drop_fraction >= 0.0 && racing_parameters.drop_fraction < 1.0))) {
+      OL_THROW_EXCEPTION(BoundsException<double>, "drop_fraction must be in [0, 1).",
+                         racing_parameters.drop_fraction, 0.0, 1.0);
+    }
+
+    io_container->found_flag = false;
+    io_container->deadline_reached = false;
+    if (num_multistarts <= 0) {
+      return 0;
+    }
+    const OptimizationDeadline deadline = GetOptimizationDeadline(round_parameters);
+
+    const int problem_size = objective_state_vector[0].GetProblemSize();
+    const bool use_optimistic_bound = racing_parameters.criterion == RacingCriterion::kOptimisticBound;
+    std::vector<double> points(initial_guesses, initial_guesses + num_multistarts*problem_size);
+    std::vector<double> values(num_multistarts);
+    std::vector<double> previous_values(num_multistarts);
+    std::vector<int> optimizer_errors(num_multistarts, 0);
+    std::vector<double> scores(num_multistarts);
+    std::vector<int> survivors(num_multistarts);
+    std::iota(survivors.begin(), survivors.end(), 0);
+
+    std::exception_ptr captured_exception;
+    for (int round = 0; round < racing_parameters.num_rounds && captured_exception == nullptr; ++round) {
+      const int num_survivors = survivors.size();
+      const int num_threads = std::max(std::min(thread_schedule.max_num_threads, num_survivors), 1);
+
+      auto advance_start = [&](int thread_id, int k) {
+        const int i = survivors[k];
+        SelectNormalStream(objective_state_vector + thread_id, i);
+        objective_state_vector[thread_id].SetCurrentPoint(objective_evaluator, points.data() + i*problem_size);
+        if (round == 0) {
+          // only the optimistic bound needs a starting value
+          previous_values[i] = use_optimistic_bound ?
+              objective_evaluator.ComputeObjectiveFunction(objective_state_vector + thread_id) : -INFINITY;
+        } else {
+          previous_values[i] = values[i];
+        }
+
+        optimizer_errors[i] += optimizer.Optimize(objective_evaluator, round_parameters, domain,
+                                                  objective_state_vector + thread_id) != 0;
+        values[i] = objective_evaluator.ComputeObjectiveFunction(objective_state_vector + thread_id);
+        objective_state_vector[thread_id].GetCurrentPoint(points.data() + i*problem_size);
+      };
+
+      if (thread_schedule.backend == ParallelBackend::kWorkStealing) {
+        try {
+          WorkStealingScheduler::Instance().ParallelFor(num_survivors, num_threads, advance_start);
+        } catch (const std::exception&) {
+          captured_exception = std::current_exception();
+        }
+      } else {
+        // see MultistartOptimize() for why exceptions must be captured inside the parallel region
+        std::once_flag exception_capture_flag;
+        omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
+#pragma omp parallel for num_threads(num_threads) schedule(runtime) if(num_threads > 1)
+        for (int k = 0; k < num_survivors; ++k) {
+          try {
+            advance_start(omp_get_thread_num(), k);
+          } catch (const std::exception&) {
+            std::call_once(exception_capture_flag, [&captured_exception]() {
+                captured_exception = std::current_exception();
+              });
+          }
+        }
+      }
+
+      int leader = survivors[0];
+      for (int k = 0; k < num_survivors; ++k) {
+        const int i = survivors[k];
+        if (values[leader] < values[i] || (values[leader] == values[i] && i < leader)) {
+          leader = i;
+        }
+        if (io_container->best_objective_value_so_far < values[i]) {
+          io_container->found_flag = true;
+          io_container->best_objective_value_so_far = values[i];
+          std::copy(points.data() + i*problem_size, points.data() + (i+1)*problem_size, io_container->best_point.begin());
+        }
+        const int num_rounds_remaining = racing_parameters.num_rounds - 1 - round;
+        scores[i] = values[i];
+        if (use_optimistic_bound) {
+          scores[i] += std::max(values[i] - previous_values[i], 0.0) * num_rounds_remaining;
+        }
+      }
+      // whatever the criterion, never drop the best point found so far
+      scores[leader] = INFINITY;
+
+      std::sort(survivors.begin(), survivors.end(), [&scores](int i, int j) {
+          return scores[i] > scores[j] || (scores[i] == scores[j] && i < j);
+        });
+      const int num_kept = std::ceil(num_survivors * (1.0 - racing_parameters.drop_fraction));
+      survivors.resize(std::min(std::max(num_kept, racing_parameters.min_num_survivors), num_survivors));
+
+      // out of time: the survivors so far are the result
+      if (unlikely(deadline.Expired())) {
+        io_container->deadline_reached = true;
+        break;
+      }
+    }
+
+    const int total_errors = std::accumulate(optimizer_errors.begin(), optimizer_errors.end(), 0);
+    if (unlikely(total_errors != 0)) {
+      OL_WARNING_PRINTF("WARNING: %d newton runs exited due to singular Hessian matrices.\n", total_errors);
+    }
+
+    if (captured_exception != nullptr) {
+      std::rethrow_exception(captured_exception);
+    }
+
+    if (function_values != nullptr) {
+      std::copy(values.begin(), values.end(), function_values);
+    }
+    const int num_survivors = survivors.size();
+    for (int k = 0; k < num_survivors; ++k) {
+      std::copy(points.data() + survivors[k]*problem_size, points.data() + (survivors[k]+1)*problem_size,
+                survivor_points + k*problem_size);
+    }
+    return num_survivors;
+  }
+
+  /*!\rst
+    MultistartOptimize() with the starts advanced in lockstep batches of ``batch_size``: each thread (or task slot)
+    owns ``batch_size`` states and moves a whole batch at once with ``optimizer.OptimizeBatch()``, so the objective's
+    batched gradient hook (``ComputeGradObjectiveFunctionBatch()``) can share linear algebra across the batch (e.g.,
+    one blocked triangular solve instead of ``batch_size`` separate ones for GP-based objectives).  Batches are
+    distributed over threads like single starts are in MultistartOptimize(); both ParallelBackend values are supported.
+
+    With ``batch_size = 1`` this computes the same iterates as MultistartOptimize() (only the call pattern differs).
+    Larger batches trade parallelism over starts for locality within each thread; ``batch_size`` around 4-16 is
+    typical.
+
+    \param
+      :optimizer: object with the desired OptimizeBatch() functionality (e.g., GradientDescentOptimizer)
+      :objective_evaluator: reference to object that can compute the objective function and its batched gradient
+      :optimizer_parameters: Optimizer::ParameterStruct object that describes the parameters for optimization
+      :domain: object specifying the domain to optimize over (see gpp_domain.hpp)
+      :thread_schedule: struct instructing OpenMP on how to schedule threads; see MultistartOptimize()
+      :batch_size: number of starts each thread advances together; must be >= 1
+      :initial_guesses[problem_size][num_multistarts]: list of points at which to start optimization runs; all points
+        must lie INSIDE the specified domain
+      :num_multistarts: number of points in initial_guesses
+      :objective_state_vector[thread_schedule.max_num_threads*batch_size]: properly constructed/configured
+        ObjectiveFunctionEvaluator::State objects; states ``[t*batch_size, (t+1)*batch_size)`` belong to thread t
+      :io_container[1]: object with best_objective_value_so_far and corresponding best_point properly initialized
+    \output
+      :objective_state_vector[thread_schedule.max_num_threads*batch_size]: internal states may be modified
+      :function_values[num_multistarts]: objective fcn value at the end of each optimization run, in the same order as
+        initial_guesses.  Never dereferenced if nullptr.
+      :io_container[1]: see MultistartOptimize()
+    \raise
+      LowerBoundException if ``batch_size < 1``.
+      Exceptions from the states, optimizer, or evaluator are handled as in MultistartOptimize().
+  \endrst*/
+  void MultistartOptimizeBatch(const Optimizer& optimizer, const ObjectiveFunctionEvaluator& objective_evaluator,
+                               const ParameterStruct& optimizer_parameters, const DomainType& domain,
+                               const ThreadSchedule& thread_schedule, int batch_size,
+                               double const * restrict initial_guesses, int num_multistarts,
+                               typename ObjectiveFunctionEvaluator::StateType * objective_state_vector,
+                               double * restrict function_values, OptimizationIOContainer * restrict io_container) {
+    using StateType = typename ObjectiveFunctionEvaluator::StateType;
+    if (unlikely(batch_size < 1)) {
+      OL_THROW_EXCEPTION(LowerBoundException<int>, "batch_size must be positive.", batch_size, 1);
+    }
+
+    const int problem_size = objective_state_vector[0].GetProblemSize();
+    const int num_slots = std::max(thread_schedule.max_num_threads, 1);
+    const int num_batches = (num_multistarts + batch_size - 1) / batch_size;
+
+    io_container->found_flag = false;
+    const OptimizationDeadline deadline = GetOptimizationDeadline(optimizer_parameters);
+    std::vector<double> best_objective_value_so_far_local(num_slots, io_container->best_objective_value_so_far);
+    std::vector<double> best_next_point_local(num_slots*problem_size);
+    std::vector<int> total_errors_local(num_slots, 0);
+    // char, not bool: slots write their own entries concurrently
+    std::vector<char> deadline_reached_local(num_slots, 0);
+
+    // optimizes starts [batch*batch_size, min((batch+1)*batch_size, num_multistarts)) with slot's states
+    auto optimize_batch = [&](int slot, int batch) {
+      const int start_begin = batch*batch_size;
+      const int current_batch_size = std::min(batch_size, num_multistarts - start_begin);
+      if (unlikely(deadline.Expired())) {
+        deadline_reached_local[slot] = 1;
+        if (unlikely(function_values != nullptr)) {
+          std::fill(function_values + start_begin, function_values + start_begin + current_batch_size,
+                    -std::numeric_limits<double>::infinity());
+        }
+        return;
+      }
+      StateType * slot_states = objective_state_vector + slot*batch_size;
+      std::vector<StateType *> batch_states(current_batch_size);
+      for (int k = 0; k < current_batch_size; ++k) {
+        batch_states[k] = slot_states + k;
+        SelectNormalStream(slot_states + k, start_begin + k);
+        slot_states[k].SetCurrentPoint(objective_evaluator, initial_guesses + (start_begin + k)*problem_size);
+      }
+
+      if (unlikely(optimizer.OptimizeBatch(objective_evaluator, optimizer_parameters, domain, current_batch_size,
+                                           batch_states.data()) != 0)) {
+        ++total_errors_local[slot];
+      }
+      if (deadline.Expired()) {
+        deadline_reached_local[slot] = 1;
+      }
+
+      for (int k = 0; k < current_batch_size; ++k) {
+        // OptimizeBatch() guarantees each optimum point is already in its state
+        const double objective_value = objective_evaluator.ComputeObjectiveFunction(slot_states + k);
+        if (unlikely(function_values != nullptr)) {
+          function_values[start_begin + k] = objective_value;
+        }
+        if (best_objective_value_so_far_local[slot] < objective_value) {
+          best_objective_value_so_far_local[slot] = objective_value;
+          slot_states[k].GetCurrentPoint(best_next_point_local.data() + slot*problem_size);
+        }
+      }
+    };
+
+    std::exception_ptr captured_exception;
+    if (thread_schedule.backend == ParallelBackend::kWorkStealing) {
+      try {
+        WorkStealingScheduler::Instance().ParallelFor(num_batches, num_slots, [&](int slot, int batch) {
+            try {
+              optimize_batch(slot, batch);
+            } catch (const std::exception& except) {
+              OL_ERROR_PRINTF("Slot %d of %d failed on batch %d of %d. Message:\n%s\n", slot, num_slots, batch,
+                              num_batches, except.what());
+              throw;
+            }
+          });
+      } catch (const std::exception&) {
+        // io_container must still be updated with the results of the successful batches
+        captured_exception = std::current_exception();
+      }
+    } else {
+      // see MultistartOptimize() for why exceptions are captured this way
+      std::once_flag exception_capture_flag;
+      omp_set_schedule(thread_schedule.schedule, thread_schedule.chunk_size);
+#pragma omp parallel for num_threads(num_slots) schedule(runtime)
+      for (int batch = 0; batch < num_batches; ++batch) {
+        const int thread_id = omp_get_thread_num();
+        try {
+          optimize_batch(thread_id, batch);
+        } catch (const std::exception& except) {
+          OL_ERROR_PRINTF("Thread %d of %d failed on batch %d of %d. Message:\n%s\n", thread_id, num_slots, batch,
+                          num_batches, except.what());
+          std::call_once(exception_capture_flag, [&captured_exception]() {
+              captured_exception = std::current_exception();
+            });
+        }
+      }
+    }
+
+    int total_errors = 0;
+    io_container->deadline_reached = false;
+    for (int slot = 0; slot < num_slots; ++slot) {
+      total_errors += total_errors_local[slot];
+      io_container->deadline_reached = io_container->deadline_reached || deadline_reached_local[slot] != 0;
+      if (io_container->best_objective_value_so_far < best_objective_value_so_far_local[slot]) {
+        io_container->found_flag = true;
+        io_container->best_objective_value_so_far = best_objective_value_so_far_local[slot];
+        std::copy(best_next_point_local.data() + slot*problem_size, best_next_point_local.data() + (slot+1)*problem_size,
+                  io_container->best_point.begin());
+      }
+    }
+
+    if (unlikely(total_errors != 0)) {
+      OL_WARNING_PRINTF("WARNING: %d batched runs reported errors.\n", total_errors);
+    }
+
+    if (captured_exception != nullptr) {
+      std::rethrow_exception(captured_exception);
+    }
+  }
+
   OL_DISALLOW_COPY_AND_ASSIGN(MultistartOptimizer);
+
+ private:
+  /*!\rst
+    MultistartOptimize() for ``ParallelBackend::kWorkStealing``: each multistart is a WorkStealingScheduler task (so
+    long-running starts do not leave the other slots idle), and ``objective_state_vector`` is indexed by task slot.
+    Per-slot results are reduced in slot order.  Same inputs, outputs, and exception guarantees as MultistartOptimize().
+  \endrst*/
+  void MultistartOptimizeWorkStealing(const Optimizer& optimizer, const ObjectiveFunctionEvaluator& objective_evaluator,
+                                      const ParameterStruct& optimizer_parameters, const DomainType& domain,
+                                      const ThreadSchedule& thread_schedule, double const * restrict initial_guesses,
+                                      int num_multistarts,
+                                      typename ObjectiveFunctionEvaluator::StateType * objective_state_vector,
+                                      double * restrict function_values, OptimizationIOContainer * restrict io_container) {
+    const int problem_size = objective_state_vector[0].GetProblemSize();
+    const int num_slots = std::max(thread_schedule.max_num_threads, 1);
+
+    io_container->found_flag = false;
+    const OptimizationDeadline deadline = GetOptimizationDeadline(optimizer_parameters);
+    const bool record_traces = GetRecordTraces(optimizer_parameters);
+    ResetTraces(record_traces, num_multistarts, io_container);
+    std::vector<double> start_values;
+    std::vector<double> start_points;
+    ResetTopPoints(num_multistarts, problem_size, &start_values, &start_points, io_container);
+    std::vector<double> best_objective_value_so_far_local(num_slots, io_container->best_objective_value_so_far);
+    std::vector<double> best_next_point_local(num_slots*problem_size);
+    std::vector<int> total_errors_local(num_slots, 0);
+    // char, not bool: slots write their own entries concurrently
+    std::vector<char> deadline_reached_local(num_slots, 0);
+
+    std::exception_ptr captured_exception;
+    try {
+      WorkStealingScheduler::Instance().ParallelFor(num_multistarts, num_slots, [&](int slot, int i) {
+          if (unlikely(deadline.Expired())) {
+            deadline_reached_local[slot] = 1;
+            if (unlikely(function_values != nullptr)) {
+              function_values[i] = -std::numeric_limits<double>::infinity();
+            }
+            return;
+          }
+          try {
+            SelectNormalStream(objective_state_vector + slot, i);
+            objective_state_vector[slot].SetCurrentPoint(objective_evaluator, initial_guesses + i*problem_size);
+
+            OptimizationTrace * trace = record_traces ? io_container->start_traces.data() + i : nullptr;
+            if (unlikely(OptimizeAndTrace(optimizer, objective_evaluator, optimizer_parameters, domain,
+                                          objective_state_vector + slot, trace) != 0)) {
+              ++total_errors_local[slot];
+            }
+            if (deadline.Expired()) {
+              deadline_reached_local[slot] = 1;
+            }
+
+            // compute objective at the new potential optimum; note Optimize() guarantees optimum point is already in state
+            const double objective_value = objective_evaluator.ComputeObjectiveFunction(objective_state_vector + slot);
+
+            if (unlikely(function_values != nullptr)) {
+              function_values[i] = objective_value;
+            }
+            if (trace != nullptr) {
+              trace->objective_value = objective_value;
+              trace->final_point.resize(problem_size);
+              objective_state_vector[slot].GetCurrentPoint(trace->final_point.data());
+            }
+            if (!start_values.empty()) {
+              start_values[i] = objective_value;
+              objective_state_vector[slot].GetCurrentPoint(start_points.data() + i*problem_size);
+            }
+
+            if (best_objective_value_so_far_local[slot] < objective_value) {
+              best_objective_value_so_far_local[slot] = objective_value;
+              objective_state_vector[slot].GetCurrentPoint(best_next_point_local.data() + slot*problem_size);
+            }
+          } catch (const std::exception& except) {
+            OL_ERROR_PRINTF("Slot %d of %d failed on iteration %d of %d. Message:\n%s\n", slot, num_slots, i,
+                            num_multistarts, except.what());
+            throw;
+          }
+        });
+    } catch (const std::exception&) {
+      // io_container must still be updated with the results of the successful starts
+      captured_exception = std::current_exception();
+    }
+
+    int total_errors = 0;
+    io_container->deadline_reached = false;
+    for (int slot = 0; slot < num_slots; ++slot) {
+      total_errors += total_errors_local[slot];
+      io_container->deadline_reached = io_container->deadline_reached || deadline_reached_local[slot] != 0;
+      if (io_container->best_objective_value_so_far < best_objective_value_so_far_local[slot]) {
+        io_container->found_flag = true;
+        io_container->best_objective_value_so_far = best_objective_value_so_far_local[slot];
+        std::copy(best_next_point_local.data() + slot*problem_size, best_next_point_local.data() + (slot+1)*problem_size,
+                  io_container->best_point.begin());
+      }
+    }
+
+    if (unlikely(total_errors != 0)) {
+      OL_WARNING_PRINTF("WARNING: %d newton runs exited due to singular Hessian matrices.\n", total_errors);
+    }
+    if (record_traces) {
+      io_container->num_distinct_optima = ClusterOptimizationTraces(io_container->trace_optimum_tolerance,
+                                                                    &io_container->start_traces);
+    }
+    if (!start_values.empty()) {
+      SelectDiverseTopPoints(start_values.data(), start_points.data(), num_multistarts, problem_size,
+                             &io_container->top_points);
+    }
+
+    if (captured_exception != nullptr) {
+      std::rethrow_exception(captured_exception);
+    }
+  }
+
+  /*!\rst
+    Clears ``io_container->top_points`` and, if it requests points, sizes the per-start result buffers (every value
+    ``-infinity`` until its start finishes); leaves them empty otherwise.
+  \endrst*/
+  static OL_NONNULL_POINTERS void ResetTopPoints(int num_multistarts, int problem_size,
+                                                 std::vector<double> * start_values, std::vector<double> * start_points,
+                                                 OptimizationIOContainer * io_container) {
+    io_container->top_points.points.clear();
+    io_container->top_points.values.clear();
+    if (io_container->top_points.num_points > 0) {
+      start_values->assign(num_multistarts, -std::numeric_limits<double>::infinity());
+      start_points->resize(num_multistarts*problem_size);
+    }
+  }
+
+  /*!\rst
+    Sizes ``io_container->start_traces`` for ``num_multistarts`` fresh traces if ``record_traces``; empties it otherwise.
+  \endrst*/
+  static OL_NONNULL_POINTERS void ResetTraces(bool record_traces, int num_multistarts,
+                                              OptimizationIOContainer * io_container) {
+    io_container->start_traces.clear();
+    io_container->num_distinct_optima = 0;
+    if (record_traces) {
+      io_container->start_traces.resize(num_multistarts);
+    }
+  }
 };
 
 }  // end namespace optimal_learning
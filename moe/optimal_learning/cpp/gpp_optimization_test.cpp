@@ -5,6 +5,12 @@
 
   1. restarted gradient descent (which uses gradient descent)
   2. newton
+  3. l-bfgs-b (projected limited-memory quasi-newton)
+  4. multistart racing (MultistartOptimizer<...>::MultistartRace()) against a multimodal objective function
+  5. successive-halving start point screening (SuccessiveHalvingSelectStartPoints())
+  6. the optional fused ComputeObjectiveAndGradient() hook, as used by l-bfgs-b
+  7. line search gradient descent (adaptive step size with armijo backtracking)
+  8. wall-clock deadlines (OptimizationDeadline) in gradient descent and the multistart drivers
 
   And each optimizer is tested against:
 
@@ -57,16 +63,21 @@
 #include <cmath>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gpp_common.hpp"
+#include "gpp_distributed.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_mock_optimization_objective_functions.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
 #include "gpp_test_utils.hpp"
 
 namespace optimal_learning {
@@ -193,6 +204,110 @@ class SimpleQuadraticEvaluator final : public SimpleObjectiveFunctionEvaluator {
   std::vector<double> maxima_point_;
 };
 
+/*!\rst
+  Class to evaluate the separable multimodal function ``f(x_1,...,x_{dim}) = \sum_i \cos(3\pi x_i) - x_i^2``.
+  On ``[-1, 1]^{dim}``, each coordinate has local maxima near ``0`` and ``\pm 2/3``; the global maximum is ``f(0) = dim``.
+  Counts gradient evaluations so that tests can compare the work done by different multistart strategies.
+\endrst*/
+class MultimodalEvaluator final : public SimpleObjectiveFunctionEvaluator {
+ public:
+  explicit MultimodalEvaluator(int dim_in) : num_gradient_evaluations(0), dim_(dim_in) {
+  }
+
+  virtual int dim() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  virtual double GetOptimumValue() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return static_cast<double>(dim_);
+  }
+
+  virtual void GetOptimumPoint(double * restrict point) const noexcept OL_NONNULL_POINTERS {
+    std::fill(point, point + dim_, 0.0);
+  }
+
+  virtual double ComputeObjectiveFunction(StateType * quadratic_dummy_state) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    double sum = 0.0;
+    for (int i = 0; i < dim_; ++i) {
+      const double x = quadratic_dummy_state->current_point[i];
+      sum += std::cos(3.0*M_PI*x) - Square(x);
+    }
+    return sum;
+  }
+
+  virtual void ComputeGradObjectiveFunction(StateType * quadratic_dummy_state, double * restrict grad_objective) const noexcept override OL_NONNULL_POINTERS {
+    ++num_gradient_evaluations;
+    for (int i = 0; i < dim_; ++i) {
+      const double x = quadratic_dummy_state->current_point[i];
+      grad_objective[i] = -3.0*M_PI*std::sin(3.0*M_PI*x) - 2.0*x;
+    }
+  }
+
+  virtual void ComputeHessianObjectiveFunction(StateType * quadratic_dummy_state, double * restrict hessian_objective) const OL_NONNULL_POINTERS {
+    std::fill(hessian_objective, hessian_objective + dim_*dim_, 0.0);
+    for (int i = 0; i < dim_; ++i) {
+      const double x = quadratic_dummy_state->current_point[i];
+      hessian_objective[i*dim_ + i] = -Square(3.0*M_PI)*std::cos(3.0*M_PI*x) - 2.0;
+    }
+  }
+
+  //! number of ComputeGradObjectiveFunction() calls so far
+  mutable std::atomic<int> num_gradient_evaluations;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(MultimodalEvaluator);
+
+ private:
+  int dim_;
+};
+
+/*!\rst
+  MultimodalEvaluator with the optional fused ComputeObjectiveAndGradient() hook (see gpp_optimization.hpp), counting
+  how often the hook is used.
+\endrst*/
+class FusedMultimodalEvaluator final : public SimpleObjectiveFunctionEvaluator {
+ public:
+  explicit FusedMultimodalEvaluator(int dim_in) : num_fused_evaluations(0), multimodal_evaluator_(dim_in) {
+  }
+
+  virtual int dim() const noexcept override OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return multimodal_evaluator_.dim();
+  }
+
+  virtual double GetOptimumValue() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return multimodal_evaluator_.GetOptimumValue();
+  }
+
+  virtual void GetOptimumPoint(double * restrict point) const noexcept OL_NONNULL_POINTERS {
+    multimodal_evaluator_.GetOptimumPoint(point);
+  }
+
+  virtual double ComputeObjectiveFunction(StateType * quadratic_dummy_state) const noexcept override OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT {
+    return multimodal_evaluator_.ComputeObjectiveFunction(quadratic_dummy_state);
+  }
+
+  virtual void ComputeGradObjectiveFunction(StateType * quadratic_dummy_state, double * restrict grad_objective) const noexcept override OL_NONNULL_POINTERS {
+    multimodal_evaluator_.ComputeGradObjectiveFunction(quadratic_dummy_state, grad_objective);
+  }
+
+  virtual void ComputeHessianObjectiveFunction(StateType * quadratic_dummy_state, double * restrict hessian_objective) const OL_NONNULL_POINTERS {
+    multimodal_evaluator_.ComputeHessianObjectiveFunction(quadratic_dummy_state, hessian_objective);
+  }
+
+  double ComputeObjectiveAndGradient(StateType * quadratic_dummy_state, double * restrict grad_objective) const noexcept OL_NONNULL_POINTERS {
+    ++num_fused_evaluations;
+    ComputeGradObjectiveFunction(quadratic_dummy_state, grad_objective);
+    return ComputeObjectiveFunction(quadratic_dummy_state);
+  }
+
+  //! number of ComputeObjectiveAndGradient() calls so far
+  mutable std::atomic<int> num_fused_evaluations;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(FusedMultimodalEvaluator);
+
+ private:
+  MultimodalEvaluator multimodal_evaluator_;
+};
+
 /*!\rst
   Test gradient descent's ability to optimize the function represented by MockEvaluator in an unconstrained setting.
 
@@ -592,6 +707,214 @@ OL_WARN_UNUSED_RESULT int MockObjectiveNewtonOptimizationTestCore() {
   return total_errors;
 }
 
+/*!\rst
+  Test L-BFGS-B's ability to optimize the function represented by MockEvaluator.  Runs once on a domain
+  containing the true optimum (unconstrained) and once on a domain that excludes it in two coordinates
+  (constrained), in which case the optimizer must land on the bound-clipped optimum and the free gradient
+  component must vanish.
+
+  \param
+    :constrained: true to use a domain that excludes the true optimum
+  \return
+    number of test failures (invalid results, non-convergence, etc.)
+\endrst*/
+template <typename MockEvaluator>
+OL_WARN_UNUSED_RESULT int MockObjectiveLBFGSBOptimizationTestCore(bool constrained) {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+
+  // l-bfgs-b parameters
+  const int max_num_steps = 200;
+  const int history_size = 5;
+  const int max_num_line_search_steps = 40;
+  const double tolerance = 1.0e-13;
+  LBFGSBParameters lbfgsb_parameters(1, max_num_steps, history_size, max_num_line_search_steps, tolerance);
+
+  int total_errors = 0;
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  if (constrained) {
+    domain_bounds = {
+      {0.05, 0.32},
+      {0.05, 0.6},
+      {0.05, 0.32}};
+  }
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> maxima_point_input(dim, 0.5);
+
+  std::vector<double> wrong_point(dim, 0.2);
+
+  std::vector<double> point_optimized(dim);
+  std::vector<double> temp_point(dim);
+
+  MockEvaluator objective_eval(maxima_point_input.data(), dim);
+
+  // get optima data
+  objective_eval.GetOptimumPoint(temp_point.data());
+  const std::vector<double> maxima_point(temp_point);
+
+  // work out what the maxima point would be given the domain constraints
+  std::vector<double> best_in_domain_point(maxima_point);
+  for (int i = 0; i < dim; ++i) {
+    best_in_domain_point[i] = std::fmin(std::fmax(best_in_domain_point[i], domain_bounds[i].min),
+                                        domain_bounds[i].max);
+  }
+
+  typename MockEvaluator::StateType objective_state(objective_eval, best_in_domain_point.data());
+
+  LBFGSBOptimizer<MockEvaluator, DomainType> lbfgsb_opt;
+
+  // verify that l-bfgs-b does not move from the optima if we start it there
+  total_errors += lbfgsb_opt.Optimize(objective_eval, lbfgsb_parameters, domain, &objective_state);
+  objective_state.GetCurrentPoint(point_optimized.data());
+  for (int i = 0; i < dim; ++i) {
+    if (!CheckDoubleWithinRelative(point_optimized[i], best_in_domain_point[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  // store initial objective function
+  objective_state.SetCurrentPoint(objective_eval, wrong_point.data());
+  const double initial_objective = objective_eval.ComputeObjectiveFunction(&objective_state);
+
+  // verify that l-bfgs-b can find the optima
+  total_errors += lbfgsb_opt.Optimize(objective_eval, lbfgsb_parameters, domain, &objective_state);
+  objective_state.GetCurrentPoint(point_optimized.data());
+#ifdef OL_VERBOSE_PRINT
+  PrintMatrix(point_optimized.data(), 1, dim);
+#endif
+
+  for (int i = 0; i < dim; ++i) {
+    if (!CheckDoubleWithinRelative(point_optimized[i], best_in_domain_point[i], 1.0e-12)) {
+      ++total_errors;
+    }
+  }
+  const double final_objective = objective_eval.ComputeObjectiveFunction(&objective_state);
+  // objective function cannot get worse
+  if (final_objective < initial_objective) {
+    ++total_errors;
+  }
+
+  // gradients vanish in every coordinate where the true optimum lies inside the domain
+  std::vector<double> grad_objective(dim);
+  objective_eval.ComputeGradObjectiveFunction(&objective_state, grad_objective.data());
+  for (int i = 0; i < dim; ++i) {
+    if (domain_bounds[i].IsInside(maxima_point[i])) {
+      if (!CheckDoubleWithinRelative(grad_objective[i], 0.0, 1.0e-12)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Test line search gradient descent's ability to optimize the function represented by MockEvaluator.  Runs once on
+  a domain containing the true optimum (unconstrained) and once on a domain that excludes it in two coordinates
+  (constrained), in which case the optimizer must approach the bound-clipped optimum and the free gradient
+  component must vanish.
+
+  \param
+    :constrained: true to use a domain that excludes the true optimum
+  \return
+    number of test failures (invalid results, non-convergence, etc.)
+\endrst*/
+template <typename MockEvaluator>
+OL_WARN_UNUSED_RESULT int MockObjectiveLineSearchGradientDescentOptimizationTestCore(bool constrained) {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+
+  // line search gradient descent parameters
+  const int max_num_steps = 500;
+  const int max_num_line_search_steps = 40;
+  const double initial_step_size = 0.1;
+  const double max_relative_change = 0.8;
+  const double tolerance = 1.0e-13;
+  LineSearchGradientDescentParameters ls_parameters(1, max_num_steps, max_num_line_search_steps, initial_step_size,
+                                                    max_relative_change, tolerance);
+
+  int total_errors = 0;
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  if (constrained) {
+    domain_bounds = {
+      {0.05, 0.32},
+      {0.05, 0.6},
+      {0.05, 0.32}};
+  }
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> maxima_point_input(dim, 0.5);
+
+  std::vector<double> wrong_point(dim, 0.2);
+
+  std::vector<double> point_optimized(dim);
+  std::vector<double> temp_point(dim);
+
+  MockEvaluator objective_eval(maxima_point_input.data(), dim);
+
+  // get optima data
+  objective_eval.GetOptimumPoint(temp_point.data());
+  const std::vector<double> maxima_point(temp_point);
+
+  // work out what the maxima point would be given the domain constraints
+  std::vector<double> best_in_domain_point(maxima_point);
+  for (int i = 0; i < dim; ++i) {
+    best_in_domain_point[i] = std::fmin(std::fmax(best_in_domain_point[i], domain_bounds[i].min),
+                                        domain_bounds[i].max);
+  }
+
+  typename MockEvaluator::StateType objective_state(objective_eval, best_in_domain_point.data());
+
+  LineSearchGradientDescentOptimizer<MockEvaluator, DomainType> ls_opt;
+
+  // verify that line search gradient descent does not move from the optima if we start it there
+  total_errors += ls_opt.Optimize(objective_eval, ls_parameters, domain, &objective_state);
+  objective_state.GetCurrentPoint(point_optimized.data());
+  for (int i = 0; i < dim; ++i) {
+    if (!CheckDoubleWithinRelative(point_optimized[i], best_in_domain_point[i], 0.0)) {
+      ++total_errors;
+    }
+  }
+
+  // store initial objective function
+  objective_state.SetCurrentPoint(objective_eval, wrong_point.data());
+  const double initial_objective = objective_eval.ComputeObjectiveFunction(&objective_state);
+
+  // verify that line search gradient descent can find the optima
+  total_errors += ls_opt.Optimize(objective_eval, ls_parameters, domain, &objective_state);
+  objective_state.GetCurrentPoint(point_optimized.data());
+#ifdef OL_VERBOSE_PRINT
+  PrintMatrix(point_optimized.data(), 1, dim);
+#endif
+
+  for (int i = 0; i < dim; ++i) {
+    if (!CheckDoubleWithinRelative(point_optimized[i], best_in_domain_point[i], 1.0e-12)) {
+      ++total_errors;
+    }
+  }
+  const double final_objective = objective_eval.ComputeObjectiveFunction(&objective_state);
+  // objective function cannot get worse
+  if (final_objective < initial_objective) {
+    ++total_errors;
+  }
+
+  // gradients vanish in every coordinate where the true optimum lies inside the domain
+  std::vector<double> grad_objective(dim);
+  objective_eval.ComputeGradObjectiveFunction(&objective_state, grad_objective.data());
+  for (int i = 0; i < dim; ++i) {
+    if (domain_bounds[i].IsInside(maxima_point[i])) {
+      if (!CheckDoubleWithinRelative(grad_objective[i], 0.0, 1.0e-12)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
 /*!\rst
   Test newton's ability to optimize the function represented by MockEvaluator in a constrained setting.
 
@@ -734,42 +1057,734 @@ OL_WARN_UNUSED_RESULT int MockObjectiveNewtonConstrainedOptimizationTestCore() {
   return total_errors;
 }
 
-int MultistartOptimizeExceptionHandlingTest() {
-  using DomainType = DummyDomain;
-  DomainType dummy_domain;
-  NullOptimizer<ExceptionEvaluator, DomainType> null_opt;
-  typename NullOptimizer<ExceptionEvaluator, DomainType>::ParameterStruct null_parameters;
-  MultistartOptimizer<NullOptimizer<ExceptionEvaluator, DomainType> > multistart_optimizer;
+/*!\rst
+  Checks that FixedSizeGradientDescentOptimizer follows exactly the iterates of GradientDescentOptimizer: from a grid of
+  starts on MultimodalEvaluator, inside a domain that clips many of the steps, both must end at bitwise identical points.
 
-  int num_multistarts = 100;
-  int max_num_threads = 4;
-  std::vector<double> initial_guesses(num_multistarts);
-  std::iota(initial_guesses.begin(), initial_guesses.end(), -20.0);
-  auto max_value = *std::max_element(initial_guesses.begin(), initial_guesses.end());
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int FixedSizeGradientDescentTest() {
+  using DomainType = TensorProductDomain;
+  constexpr int dim = 3;
+  const int num_starts = 27;
+  GradientDescentParameters gd_parameters(1, 100, 4, 0, 0.5, 0.05, 0.8, 1.0e-10);
 
-  double current_point = 0.0;
-  ExceptionEvaluator exception_eval("x == 1");
-  std::vector<typename ExceptionEvaluator::StateType> state_vector;
-  state_vector.reserve(max_num_threads);
-  for (int i = 0; i < max_num_threads; ++i) {
-    state_vector.emplace_back(exception_eval, &current_point);
-  }
+  std::vector<ClosedInterval> domain_bounds = {{-1.0, 0.5}, {-0.3, 1.0}, {-1.0, 1.0}};
+  DomainType domain(domain_bounds.data(), dim);
+  MultimodalEvaluator objective_eval(dim);
 
+  GradientDescentOptimizer<MultimodalEvaluator, DomainType> gd_opt;
+  FixedSizeGradientDescentOptimizer<MultimodalEvaluator, DomainType, dim> fixed_size_gd_opt;
   int total_errors = 0;
+  std::vector<double> initial_guess(dim);
+  std::vector<double> point(dim);
+  std::vector<double> fixed_size_point(dim);
+  for (int i = 0; i < num_starts; ++i) {
+    initial_guess[0] = -0.9 + 0.7*(i % 3);
+    initial_guess[1] = -0.2 + 0.55*((i / 3) % 3);
+    initial_guess[2] = -0.95 + 0.9*(i / 9);
+
+    typename MultimodalEvaluator::StateType state(objective_eval, initial_guess.data());
+    gd_opt.Optimize(objective_eval, gd_parameters, domain, &state);
+    state.GetCurrentPoint(point.data());
+
+    typename MultimodalEvaluator::StateType fixed_size_state(objective_eval, initial_guess.data());
+    fixed_size_gd_opt.Optimize(objective_eval, gd_parameters, domain, &fixed_size_state);
+    fixed_size_state.GetCurrentPoint(fixed_size_point.data());
+
+    if (point != fixed_size_point || !domain.CheckPointInside(fixed_size_point.data())) {
+      ++total_errors;
+    }
+  }
 
-  // test case where only 1 exception is thrown, when current_point is 1.0
-  {
-    double dummy_value = -100.0;
-    OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), dummy_value, &dummy_value);
+  return total_errors;
+}
 
-    exception_eval.exception_condition = "x == 1";
-    try {
-      // increment errors: we must catch an exception to decrement
-      total_errors += 1;
-      multistart_optimizer.MultistartOptimize(null_opt, exception_eval, null_parameters, dummy_domain,
-                                              ThreadSchedule(max_num_threads), initial_guesses.data(),
-                                              num_multistarts, state_vector.data(), nullptr, &io_container);
-    } catch (const InvalidValueException<double>& except) {
+/*!\rst
+  Checks the optional fused ComputeObjectiveAndGradient() hook: HasComputeObjectiveAndGradient detects it, and
+  L-BFGS-B uses it while following exactly the iterates it takes with separate value and gradient calls (from a grid
+  of starts on MultimodalEvaluator, inside a domain that clips many of the steps).
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int FusedObjectiveAndGradientTest() {
+  using DomainType = TensorProductDomain;
+  const int dim = 3;
+  const int num_starts = 27;
+  LBFGSBParameters lbfgsb_parameters(1, 100, 5, 40, 1.0e-10);
+
+  int total_errors = 0;
+  if (HasComputeObjectiveAndGradient<MultimodalEvaluator>::value ||
+      !HasComputeObjectiveAndGradient<FusedMultimodalEvaluator>::value) {
+    ++total_errors;
+  }
+
+  std::vector<ClosedInterval> domain_bounds = {{-1.0, 0.5}, {-0.3, 1.0}, {-1.0, 1.0}};
+  DomainType domain(domain_bounds.data(), dim);
+  MultimodalEvaluator objective_eval(dim);
+  FusedMultimodalEvaluator fused_objective_eval(dim);
+
+  LBFGSBOptimizer<MultimodalEvaluator, DomainType> lbfgsb_opt;
+  LBFGSBOptimizer<FusedMultimodalEvaluator, DomainType> fused_lbfgsb_opt;
+  std::vector<double> initial_guess(dim);
+  std::vector<double> point(dim);
+  std::vector<double> fused_point(dim);
+  for (int i = 0; i < num_starts; ++i) {
+    initial_guess[0] = -0.9 + 0.7*(i % 3);
+    initial_guess[1] = -0.2 + 0.55*((i / 3) % 3);
+    initial_guess[2] = -0.95 + 0.9*(i / 9);
+
+    typename MultimodalEvaluator::StateType state(objective_eval, initial_guess.data());
+    lbfgsb_opt.Optimize(objective_eval, lbfgsb_parameters, domain, &state);
+    state.GetCurrentPoint(point.data());
+
+    typename FusedMultimodalEvaluator::StateType fused_state(fused_objective_eval, initial_guess.data());
+    fused_lbfgsb_opt.Optimize(fused_objective_eval, lbfgsb_parameters, domain, &fused_state);
+    fused_state.GetCurrentPoint(fused_point.data());
+
+    if (point != fused_point) {
+      ++total_errors;
+    }
+  }
+  // at least the initial point of every start
+  if (fused_objective_eval.num_fused_evaluations < num_starts) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks MultistartRace() on MultimodalEvaluator (many local maxima) from a grid of starts:
+
+  * racing followed by full gradient descent on the survivors finds the same best value as full multistart gradient
+    descent, with both ranking criteria, using less than half the gradient evaluations,
+  * OpenMP and work stealing backends produce identical survivors and function values,
+  * invalid RacingParameters throw.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultistartRaceTest() {
+  using DomainType = TensorProductDomain;
+  using Optimizer = GradientDescentOptimizer<MultimodalEvaluator, DomainType>;
+  const int dim = 2;
+  const int num_grid_points_per_dim = 8;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int max_num_threads = 4;
+  const double tolerance = 1.0e-8;
+
+  const double gamma = 0.5;
+  const double pre_mult = 0.01;
+  const double max_relative_change = 0.8;
+  const double gd_tolerance = 1.0e-10;
+  GradientDescentParameters gd_parameters(num_multistarts, 200, 5, 0, gamma, pre_mult, max_relative_change,
+                                          gd_tolerance);
+  const int num_steps_per_round = 10;
+  GradientDescentParameters round_parameters(1, num_steps_per_round, 1, 0, gamma, pre_mult, max_relative_change,
+                                             gd_tolerance);
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<typename MultimodalEvaluator::StateType> state_vector;
+  state_vector.reserve(max_num_threads);
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(objective_eval, initial_guesses.data());
+  }
+  Optimizer gd_opt;
+  MultistartOptimizer<Optimizer> multistart_optimizer;
+  int total_errors = 0;
+
+  // reference: every start runs to completion
+  OptimizationIOContainer full_io_container(dim, -INFINITY, initial_guesses.data());
+  objective_eval.num_gradient_evaluations = 0;
+  multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, ThreadSchedule(max_num_threads),
+                                          initial_guesses.data(), num_multistarts, state_vector.data(), nullptr,
+                                          &full_io_container);
+  const int full_num_gradient_evaluations = objective_eval.num_gradient_evaluations;
+  if (!CheckDoubleWithinRelative(full_io_container.best_objective_value_so_far, objective_eval.GetOptimumValue(),
+                                 tolerance)) {
+    ++total_errors;
+  }
+
+  const RacingCriterion criteria[] = {RacingCriterion::kCurrentValue, RacingCriterion::kOptimisticBound};
+  for (const auto criterion : criteria) {
+    RacingParameters racing_parameters(3, num_steps_per_round, 0.5, 2, criterion);
+    std::vector<double> function_values[2];
+    std::vector<double> survivor_points[2];
+    int num_survivors[2];
+    const ParallelBackend backends[2] = {ParallelBackend::kOpenMP, ParallelBackend::kWorkStealing};
+    for (int b = 0; b < 2; ++b) {
+      const ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic, 0, backends[b]);
+      function_values[b].resize(num_multistarts);
+      survivor_points[b].resize(dim*num_multistarts);
+      OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+      objective_eval.num_gradient_evaluations = 0;
+      num_survivors[b] = multistart_optimizer.MultistartRace(gd_opt, objective_eval, round_parameters,
+                                                             racing_parameters, domain, thread_schedule,
+                                                             initial_guesses.data(), num_multistarts,
+                                                             state_vector.data(), function_values[b].data(),
+                                                             survivor_points[b].data(), &io_container);
+      // 64 -> 32 -> 16 -> 8
+      if (num_survivors[b] != num_multistarts/8) {
+        ++total_errors;
+      }
+      multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                              survivor_points[b].data(), num_survivors[b], state_vector.data(),
+                                              nullptr, &io_container);
+
+      if (!CheckDoubleWithinRelative(io_container.best_objective_value_so_far,
+                                     full_io_container.best_objective_value_so_far, tolerance)) {
+        ++total_errors;
+      }
+      if (2*objective_eval.num_gradient_evaluations >= full_num_gradient_evaluations) {
+        OL_ERROR_PRINTF("racing used %d gradient evaluations; full multistart used %d\n",
+                        objective_eval.num_gradient_evaluations.load(), full_num_gradient_evaluations);
+        ++total_errors;
+      }
+    }
+
+    if (num_survivors[0] != num_survivors[1] || function_values[0] != function_values[1] ||
+        !std::equal(survivor_points[0].begin(), survivor_points[0].begin() + dim*num_survivors[0],
+                    survivor_points[1].begin())) {
+      ++total_errors;
+    }
+  }
+
+  // invalid racing parameters
+  {
+    RacingParameters bad_rounds(0, num_steps_per_round, 0.5, 1, RacingCriterion::kCurrentValue);
+    RacingParameters bad_fraction(3, num_steps_per_round, 1.0, 1, RacingCriterion::kCurrentValue);
+    std::vector<double> survivor_points(dim*num_multistarts);
+    OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+    const RacingParameters * const invalid_parameters[] = {&bad_rounds, &bad_fraction};
+    for (const auto * racing_parameters : invalid_parameters) {
+      try {
+        multistart_optimizer.MultistartRace(gd_opt, objective_eval, round_parameters, *racing_parameters, domain,
+                                            ThreadSchedule(max_num_threads), initial_guesses.data(), num_multistarts,
+                                            state_vector.data(), nullptr, survivor_points.data(), &io_container);
+        ++total_errors;
+      } catch (const BoundsException<int>&) {
+      } catch (const BoundsException<double>&) {
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks wall-clock deadlines (OptimizationDeadline) on MultimodalEvaluator from a grid of starts:
+
+  * a deadline far in the future changes nothing: the results equal those without a deadline and
+    ``deadline_reached`` stays false, with both parallel backends,
+  * a deadline that has already passed skips every start (value ``-infinity``, no gradient evaluations,
+    ``found_flag`` false, ``deadline_reached`` true) in MultistartOptimize() and MultistartRace(),
+  * gradient descent past its deadline leaves the point where it started.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultistartDeadlineTest() {
+  using DomainType = TensorProductDomain;
+  using Optimizer = GradientDescentOptimizer<MultimodalEvaluator, DomainType>;
+  const int dim = 2;
+  const int num_grid_points_per_dim = 5;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int max_num_threads = 4;
+
+  GradientDescentParameters gd_parameters(num_multistarts, 200, 5, 0, 0.5, 0.01, 0.8, 1.0e-10);
+  GradientDescentParameters far_parameters(num_multistarts, 200, 5, 0, 0.5, 0.01, 0.8, 1.0e-10);
+  far_parameters.deadline = OptimizationDeadline::After(3600.0);
+  GradientDescentParameters expired_parameters(num_multistarts, 200, 5, 0, 0.5, 0.01, 0.8, 1.0e-10);
+  expired_parameters.deadline = OptimizationDeadline::After(-1.0);
+
+  int total_errors = 0;
+  if (gd_parameters.deadline.is_set() || gd_parameters.deadline.Expired() || !far_parameters.deadline.is_set() ||
+      far_parameters.deadline.Expired() || !expired_parameters.deadline.Expired()) {
+    ++total_errors;
+  }
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<typename MultimodalEvaluator::StateType> state_vector;
+  state_vector.reserve(max_num_threads);
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(objective_eval, initial_guesses.data());
+  }
+  Optimizer gd_opt;
+  MultistartOptimizer<Optimizer> multistart_optimizer;
+
+  const ParallelBackend backends[2] = {ParallelBackend::kOpenMP, ParallelBackend::kWorkStealing};
+  for (const auto backend : backends) {
+    const ThreadSchedule thread_schedule(max_num_threads, omp_sched_static, 1, backend);
+    std::vector<double> function_values(num_multistarts);
+    std::vector<double> far_function_values(num_multistarts);
+
+    OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            function_values.data(), &io_container);
+    OptimizationIOContainer far_io_container(dim, -INFINITY, initial_guesses.data());
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, far_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            far_function_values.data(), &far_io_container);
+    if (io_container.deadline_reached || far_io_container.deadline_reached ||
+        function_values != far_function_values ||
+        far_io_container.best_objective_value_so_far != io_container.best_objective_value_so_far) {
+      ++total_errors;
+    }
+
+    OptimizationIOContainer expired_io_container(dim, -INFINITY, initial_guesses.data());
+    objective_eval.num_gradient_evaluations = 0;
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, expired_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            function_values.data(), &expired_io_container);
+    if (!expired_io_container.deadline_reached || expired_io_container.found_flag ||
+        objective_eval.num_gradient_evaluations != 0) {
+      ++total_errors;
+    }
+    for (const auto value : function_values) {
+      if (value != -INFINITY) {
+        ++total_errors;
+      }
+    }
+
+    // racing stops after the first round
+    RacingParameters racing_parameters(3, 10, 0.5, 2, RacingCriterion::kCurrentValue);
+    GradientDescentParameters round_parameters(1, 10, 1, 0, 0.5, 0.01, 0.8, 1.0e-10);
+    round_parameters.deadline = OptimizationDeadline::After(-1.0);
+    std::vector<double> survivor_points(dim*num_multistarts);
+    OptimizationIOContainer race_io_container(dim, -INFINITY, initial_guesses.data());
+    multistart_optimizer.MultistartRace(gd_opt, objective_eval, round_parameters, racing_parameters, domain,
+                                        thread_schedule, initial_guesses.data(), num_multistarts, state_vector.data(),
+                                        nullptr, survivor_points.data(), &race_io_container);
+    if (!race_io_container.deadline_reached) {
+      ++total_errors;
+    }
+  }
+
+  // a single optimization past its deadline does not move
+  {
+    typename MultimodalEvaluator::StateType state(objective_eval, initial_guesses.data());
+    gd_opt.Optimize(objective_eval, expired_parameters, domain, &state);
+    std::vector<double> point(dim);
+    state.GetCurrentPoint(point.data());
+    if (!std::equal(point.begin(), point.end(), initial_guesses.begin())) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the per-start traces of MultistartOptimize() (``GradientDescentParameters::record_traces``):
+
+  * on MultimodalEvaluator from a grid of starts, tracing does not change the results, every trace matches its
+    start's result, starts grouped into one optimum ended close together (and different optima far apart), and both
+    parallel backends record the same traces,
+  * with the maximum of SimpleQuadraticEvaluator outside the domain, every start is pushed against the boundary and all of them
+    reach the same (constrained) optimum,
+  * without ``record_traces``, ``start_traces`` is emptied.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultistartTraceTest() {
+  using DomainType = TensorProductDomain;
+  const int dim = 2;
+  const int num_grid_points_per_dim = 5;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int max_num_threads = 4;
+  const int max_num_steps = 200;
+  const int max_num_restarts = 5;
+
+  GradientDescentParameters gd_parameters(num_multistarts, max_num_steps, max_num_restarts, 0, 0.5, 0.01, 0.8, 1.0e-10);
+  GradientDescentParameters traced_parameters(num_multistarts, max_num_steps, max_num_restarts, 0, 0.5, 0.01, 0.8,
+                                              1.0e-10);
+  traced_parameters.record_traces = true;
+
+  int total_errors = 0;
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  {
+    MultimodalEvaluator objective_eval(dim);
+    std::vector<typename MultimodalEvaluator::StateType> state_vector;
+    state_vector.reserve(max_num_threads);
+    for (int i = 0; i < max_num_threads; ++i) {
+      state_vector.emplace_back(objective_eval, initial_guesses.data());
+    }
+    GradientDescentOptimizer<MultimodalEvaluator, DomainType> gd_opt;
+    MultistartOptimizer<GradientDescentOptimizer<MultimodalEvaluator, DomainType> > multistart_optimizer;
+
+    std::vector<OptimizationTrace> openmp_traces;
+    const ParallelBackend backends[2] = {ParallelBackend::kOpenMP, ParallelBackend::kWorkStealing};
+    for (const auto backend : backends) {
+      const ThreadSchedule thread_schedule(max_num_threads, omp_sched_static, 1, backend);
+      std::vector<double> function_values(num_multistarts);
+      std::vector<double> traced_function_values(num_multistarts);
+
+      OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+      multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                              initial_guesses.data(), num_multistarts, state_vector.data(),
+                                              function_values.data(), &io_container);
+      OptimizationIOContainer traced_io_container(dim, -INFINITY, initial_guesses.data());
+      multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, traced_parameters, domain, thread_schedule,
+                                              initial_guesses.data(), num_multistarts, state_vector.data(),
+                                              traced_function_values.data(), &traced_io_container);
+      if (!io_container.start_traces.empty() || io_container.num_distinct_optima != 0 ||
+          function_values != traced_function_values || io_container.best_point != traced_io_container.best_point ||
+          static_cast<int>(traced_io_container.start_traces.size()) != num_multistarts) {
+        ++total_errors;
+        continue;
+      }
+
+      // separable with 3 local maxima per coordinate
+      const int num_distinct_optima = traced_io_container.num_distinct_optima;
+      if (num_distinct_optima < 2 || num_distinct_optima > 9) {
+        ++total_errors;
+      }
+      const std::vector<OptimizationTrace>& traces = traced_io_container.start_traces;
+      for (int i = 0; i < num_multistarts; ++i) {
+        const OptimizationTrace& trace = traces[i];
+        if (trace.num_restarts < 1 || trace.num_restarts > max_num_restarts || trace.num_steps < trace.num_restarts ||
+            trace.num_steps > max_num_steps*max_num_restarts || trace.num_boundary_steps < 0 ||
+            trace.num_boundary_steps > trace.num_steps || !(trace.final_gradient_norm >= 0.0) ||
+            trace.objective_value != function_values[i] || static_cast<int>(trace.final_point.size()) != dim ||
+            trace.optimum_index < 0 || trace.optimum_index >= num_distinct_optima) {
+          ++total_errors;
+          continue;
+        }
+        // at an interior local maximum
+        if (trace.converged && trace.final_gradient_norm > 1.0e-3) {
+          ++total_errors;
+        }
+        for (int j = 0; j < i; ++j) {
+          double distance = 0.0;
+          for (int d = 0; d < dim; ++d) {
+            distance += Square(trace.final_point[d] - traces[j].final_point[d]);
+          }
+          distance = std::sqrt(distance);
+          if ((trace.optimum_index == traces[j].optimum_index) != (distance < 0.1)) {
+            ++total_errors;
+          }
+        }
+      }
+
+      if (backend == ParallelBackend::kOpenMP) {
+        openmp_traces = traces;
+      } else {
+        for (int i = 0; i < num_multistarts && i < static_cast<int>(openmp_traces.size()); ++i) {
+          if (traces[i].num_steps != openmp_traces[i].num_steps ||
+              traces[i].optimum_index != openmp_traces[i].optimum_index ||
+              traces[i].final_point != openmp_traces[i].final_point) {
+            ++total_errors;
+          }
+        }
+      }
+
+      // a run without traces empties them
+      multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                              initial_guesses.data(), num_multistarts, state_vector.data(),
+                                              nullptr, &traced_io_container);
+      if (!traced_io_container.start_traces.empty() || traced_io_container.num_distinct_optima != 0) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // maximum at (0.5, 0.5), outside the domain: every start ends in the corner (0.32, 0.32)
+  {
+    std::vector<double> maxima_point(dim, 0.5);
+    SimpleQuadraticEvaluator objective_eval(maxima_point.data(), dim);
+    std::vector<ClosedInterval> constrained_bounds(dim, {0.05, 0.32});
+    DomainType constrained_domain(constrained_bounds.data(), dim);
+    std::vector<double> constrained_guesses(dim*num_multistarts);
+    for (int i = 0; i < dim*num_multistarts; ++i) {
+      constrained_guesses[i] = 0.06 + 0.25*(initial_guesses[i] + 0.9)/1.8;
+    }
+
+    GradientDescentParameters constrained_parameters(num_multistarts, 1000, 10, 0, 0.9, 1.0, 0.8, 1.0e-12);
+    constrained_parameters.record_traces = true;
+    std::vector<typename SimpleQuadraticEvaluator::StateType> state_vector;
+    state_vector.reserve(max_num_threads);
+    for (int i = 0; i < max_num_threads; ++i) {
+      state_vector.emplace_back(objective_eval, constrained_guesses.data());
+    }
+    GradientDescentOptimizer<SimpleQuadraticEvaluator, DomainType> gd_opt;
+    MultistartOptimizer<GradientDescentOptimizer<SimpleQuadraticEvaluator, DomainType> > multistart_optimizer;
+    const ThreadSchedule thread_schedule(max_num_threads, omp_sched_static);
+    OptimizationIOContainer io_container(dim, -INFINITY, constrained_guesses.data());
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, constrained_parameters, constrained_domain,
+                                            thread_schedule, constrained_guesses.data(), num_multistarts,
+                                            state_vector.data(), nullptr, &io_container);
+    if (io_container.num_distinct_optima != 1 ||
+        static_cast<int>(io_container.start_traces.size()) != num_multistarts) {
+      ++total_errors;
+    }
+    for (const auto& trace : io_container.start_traces) {
+      if (trace.num_boundary_steps < 1 || trace.optimum_index != 0 ||
+          !CheckDoubleWithinRelative(trace.final_gradient_norm, std::sqrt(2.0)*2.0*(0.5 - 0.32), 1.0e-6)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the diverse top-k reduction of MultistartOptimize() (OptimizationIOContainer::top_points) on
+  MultimodalEvaluator from a grid of starts, with both parallel backends:
+
+  * without a distance requirement, the top points are every start's result, best first,
+  * with one, the kept points are pairwise at least that far apart, led by the overall best point; a distance larger
+    than the domain keeps only the best point,
+  * the reduction does not change the optimization results and is the same for both backends,
+  * without a request, ``top_points`` is emptied.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultistartDiverseTopPointsTest() {
+  using DomainType = TensorProductDomain;
+  using Optimizer = GradientDescentOptimizer<MultimodalEvaluator, DomainType>;
+  const int dim = 2;
+  const int num_grid_points_per_dim = 5;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int max_num_threads = 4;
+  const int num_top_points = 5;
+  const double min_distance = 0.1;
+
+  GradientDescentParameters gd_parameters(num_multistarts, 200, 5, 0, 0.5, 0.01, 0.8, 1.0e-10);
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<typename MultimodalEvaluator::StateType> state_vector;
+  state_vector.reserve(max_num_threads);
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(objective_eval, initial_guesses.data());
+  }
+  Optimizer gd_opt;
+  MultistartOptimizer<Optimizer> multistart_optimizer;
+
+  int total_errors = 0;
+  std::vector<double> openmp_points;
+  const ParallelBackend backends[2] = {ParallelBackend::kOpenMP, ParallelBackend::kWorkStealing};
+  for (const auto backend : backends) {
+    const ThreadSchedule thread_schedule(max_num_threads, omp_sched_static, 1, backend);
+    std::vector<double> function_values(num_multistarts);
+    std::vector<double> top_function_values(num_multistarts);
+
+    OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            function_values.data(), &io_container);
+    if (io_container.top_points.num_found() != 0 || !io_container.top_points.points.empty()) {
+      ++total_errors;
+    }
+
+    // every result, best first
+    OptimizationIOContainer all_io_container(dim, -INFINITY, initial_guesses.data());
+    all_io_container.top_points = DiverseTopPoints(num_multistarts, 0.0);
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            top_function_values.data(), &all_io_container);
+    std::vector<double> sorted_function_values(function_values);
+    std::sort(sorted_function_values.begin(), sorted_function_values.end(), std::greater<double>());
+    if (top_function_values != function_values || all_io_container.best_point != io_container.best_point ||
+        all_io_container.top_points.values != sorted_function_values ||
+        static_cast<int>(all_io_container.top_points.points.size()) != dim*num_multistarts) {
+      ++total_errors;
+    }
+
+    // distinct results
+    OptimizationIOContainer top_io_container(dim, -INFINITY, initial_guesses.data());
+    top_io_container.top_points = DiverseTopPoints(num_top_points, min_distance);
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            nullptr, &top_io_container);
+    const DiverseTopPoints& top_points = top_io_container.top_points;
+    // separable with 3 local maxima per coordinate: at least num_top_points distinct optima
+    if (top_points.num_found() != num_top_points || top_points.values[0] != io_container.best_objective_value_so_far ||
+        !std::equal(io_container.best_point.begin(), io_container.best_point.end(), top_points.points.begin())) {
+      ++total_errors;
+    }
+    for (int i = 0; i < top_points.num_found(); ++i) {
+      if (i > 0 && top_points.values[i] > top_points.values[i - 1]) {
+        ++total_errors;
+      }
+      for (int j = 0; j < i; ++j) {
+        double distance = 0.0;
+        for (int d = 0; d < dim; ++d) {
+          distance += Square(top_points.points[i*dim + d] - top_points.points[j*dim + d]);
+        }
+        if (std::sqrt(distance) < min_distance) {
+          ++total_errors;
+        }
+      }
+    }
+    if (backend == ParallelBackend::kOpenMP) {
+      openmp_points = top_points.points;
+    } else if (top_points.points != openmp_points) {
+      ++total_errors;
+    }
+
+    // farther apart than the domain allows: only the best point
+    top_io_container.top_points = DiverseTopPoints(num_top_points, 10.0);
+    multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                            initial_guesses.data(), num_multistarts, state_vector.data(),
+                                            nullptr, &top_io_container);
+    if (top_io_container.top_points.num_found() != 1 ||
+        !std::equal(io_container.best_point.begin(), io_container.best_point.end(),
+                    top_io_container.top_points.points.begin())) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks SuccessiveHalvingSelectStartPoints() on MultimodalEvaluator from a grid of starts, with a budget that does not
+  change the (exact) objective:
+
+  * each round halves the candidates and doubles the budget, jumping straight to ``num_selected`` at ``max_budget``,
+  * the selected starts equal those of SelectBestStartPoints() screening every start at once.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SuccessiveHalvingSelectTest() {
+  const int dim = 2;
+  const int num_grid_points_per_dim = 8;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int num_selected = 4;
+  const int max_num_threads = 4;
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<typename MultimodalEvaluator::StateType> state_vector;
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(objective_eval, initial_guesses.data());
+  }
+  std::vector<double> best_start_points(dim*num_selected);
+  SelectBestStartPoints(objective_eval, initial_guesses.data(), num_multistarts, num_selected, max_num_threads,
+                        state_vector.data(), best_start_points.data());
+
+  int total_errors = 0;
+  // (initial budget, max budget) -> expected (budget, num_candidates) of every round
+  const std::vector<std::pair<int, int>> budgets = {{8, 64}, {32, 64}, {64, 64}};
+  const std::vector<std::vector<std::pair<int, int>>> expected_rounds = {
+    {{8, 64}, {16, 32}, {32, 16}, {64, 8}},
+    {{32, 64}, {64, 32}},
+    {{64, 64}},
+  };
+  for (int b = 0; b < static_cast<int>(budgets.size()); ++b) {
+    std::vector<std::pair<int, int>> rounds;
+    auto select_at_budget = [&](int budget, double const * candidates, int num_candidates, int num_keep,
+                                double * kept) {
+      rounds.emplace_back(budget, num_candidates);
+      SelectBestStartPoints(objective_eval, candidates, num_candidates, num_keep, max_num_threads,
+                            state_vector.data(), kept);
+    };
+    std::vector<double> selected_start_points(dim*num_selected);
+    SuccessiveHalvingSelectStartPoints(select_at_budget, initial_guesses.data(), dim, num_multistarts, num_selected,
+                                       budgets[b].first, budgets[b].second, selected_start_points.data());
+    if (rounds != expected_rounds[b] || selected_start_points != best_start_points) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+int MultistartOptimizeExceptionHandlingTest() {
+  using DomainType = DummyDomain;
+  DomainType dummy_domain;
+  NullOptimizer<ExceptionEvaluator, DomainType> null_opt;
+  typename NullOptimizer<ExceptionEvaluator, DomainType>::ParameterStruct null_parameters;
+  MultistartOptimizer<NullOptimizer<ExceptionEvaluator, DomainType> > multistart_optimizer;
+
+  int num_multistarts = 100;
+  int max_num_threads = 4;
+  std::vector<double> initial_guesses(num_multistarts);
+  std::iota(initial_guesses.begin(), initial_guesses.end(), -20.0);
+  auto max_value = *std::max_element(initial_guesses.begin(), initial_guesses.end());
+
+  double current_point = 0.0;
+  ExceptionEvaluator exception_eval("x == 1");
+  std::vector<typename ExceptionEvaluator::StateType> state_vector;
+  state_vector.reserve(max_num_threads);
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(exception_eval, &current_point);
+  }
+
+  int total_errors = 0;
+
+  // test case where only 1 exception is thrown, when current_point is 1.0
+  {
+    double dummy_value = -100.0;
+    OptimizationIOContainer io_container(state_vector[0].GetProblemSize(), dummy_value, &dummy_value);
+
+    exception_eval.exception_condition = "x == 1";
+    try {
+      // increment errors: we must catch an exception to decrement
+      total_errors += 1;
+      multistart_optimizer.MultistartOptimize(null_opt, exception_eval, null_parameters, dummy_domain,
+                                              ThreadSchedule(max_num_threads), initial_guesses.data(),
+                                              num_multistarts, state_vector.data(), nullptr, &io_container);
+    } catch (const InvalidValueException<double>& except) {
       // only x == 1.0 would have thrown an exception and it would set the value to 1.0.
       if (except.value() != 1.0) {
         ++total_errors;
@@ -822,6 +1837,8 @@ int MultistartOptimizeExceptionHandlingTest() {
 
   * kGradientDescent
   * kNewton
+  * kLBFGSB
+  * kLineSearchGradientDescent
 
   Checks unconstrained and constrained optimization against polynomial
   objective function(s).
@@ -845,6 +1862,18 @@ int RunSimpleObjectiveOptimizationTests(OptimizerTypes optimizer_type) {
       errors += MockObjectiveNewtonConstrainedOptimizationTestCore<SimpleQuadraticEvaluator>();
       return errors;
     }
+    case OptimizerTypes::kLBFGSB: {  // l-bfgs-b tests
+      int errors = 0;
+      errors += MockObjectiveLBFGSBOptimizationTestCore<SimpleQuadraticEvaluator>(false);
+      errors += MockObjectiveLBFGSBOptimizationTestCore<SimpleQuadraticEvaluator>(true);
+      return errors;
+    }
+    case OptimizerTypes::kLineSearchGradientDescent: {  // line search gradient descent tests
+      int errors = 0;
+      errors += MockObjectiveLineSearchGradientDescentOptimizationTestCore<SimpleQuadraticEvaluator>(false);
+      errors += MockObjectiveLineSearchGradientDescentOptimizationTestCore<SimpleQuadraticEvaluator>(true);
+      return errors;
+    }
     default: {
       OL_ERROR_PRINTF("%s: INVALID optimizer_type choice: %d\n", OL_CURRENT_FUNCTION_NAME, optimizer_type);
       return 1;
@@ -852,13 +1881,264 @@ int RunSimpleObjectiveOptimizationTests(OptimizerTypes optimizer_type) {
   }
 }
 
+/*!\rst
+  Checks EvaluateObjectiveAtPointSets() on MultimodalEvaluator: for 1 state and for more states than sets, the values
+  and gradients match evaluating each point on its own, and without a gradient buffer the values are unchanged.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int EvaluateObjectiveAtPointSetsTest() {
+  const int dim = 2;
+  const int num_sets = 7;
+
+  std::vector<double> point_sets(dim*num_sets);
+  for (int i = 0; i < num_sets; ++i) {
+    point_sets[i*dim + 0] = -0.9 + 0.3*i;
+    point_sets[i*dim + 1] = 0.8 - 0.25*i;
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<double> expected_values(num_sets);
+  std::vector<double> expected_gradients(dim*num_sets);
+  {
+    typename MultimodalEvaluator::StateType state(objective_eval, point_sets.data());
+    for (int i = 0; i < num_sets; ++i) {
+      state.SetCurrentPoint(objective_eval, point_sets.data() + i*dim);
+      expected_values[i] = objective_eval.ComputeObjectiveFunction(&state);
+      objective_eval.ComputeGradObjectiveFunction(&state, expected_gradients.data() + i*dim);
+    }
+  }
+
+  int total_errors = 0;
+  const int num_states_list[2] = {1, num_sets + 2};
+  for (const int num_states : num_states_list) {
+    std::vector<typename MultimodalEvaluator::StateType> state_vector;
+    state_vector.reserve(num_states);
+    for (int i = 0; i < num_states; ++i) {
+      state_vector.emplace_back(objective_eval, point_sets.data());
+    }
+
+    std::vector<double> values(num_sets);
+    std::vector<double> gradients(dim*num_sets);
+    EvaluateObjectiveAtPointSets(objective_eval, point_sets.data(), num_sets, num_states, state_vector.data(),
+                                 values.data(), gradients.data());
+    for (int i = 0; i < num_sets; ++i) {
+      if (!CheckDoubleWithinRelative(values[i], expected_values[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+    for (int i = 0; i < dim*num_sets; ++i) {
+      if (!CheckDoubleWithinRelative(gradients[i], expected_gradients[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+
+    std::vector<double> values_only(num_sets);
+    EvaluateObjectiveAtPointSets(objective_eval, point_sets.data(), num_sets, num_states, state_vector.data(),
+                                 values_only.data(), nullptr);
+    if (values_only != values) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks MultistartOptimizer::MultistartOptimizeDistributed() on MultimodalEvaluator from a grid of starts, over the
+  world context (see gpp_distributed.hpp):
+
+  * the best value and every start's function value equal those of MultistartOptimize(), as does the best point (up
+    to roundoff),
+  * an initial best that no start beats is kept, with ``found_flag`` false.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int MultistartOptimizeDistributedTest() {
+  using DomainType = TensorProductDomain;
+  using Optimizer = GradientDescentOptimizer<MultimodalEvaluator, DomainType>;
+  const int dim = 2;
+  const int num_grid_points_per_dim = 6;
+  const int num_multistarts = num_grid_points_per_dim*num_grid_points_per_dim;
+  const int max_num_threads = 4;
+
+  GradientDescentParameters gd_parameters(num_multistarts, 200, 5, 0, 0.5, 0.01, 0.8, 1.0e-10);
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  DomainType domain(domain_bounds.data(), dim);
+
+  std::vector<double> initial_guesses(dim*num_multistarts);
+  for (int i = 0; i < num_grid_points_per_dim; ++i) {
+    for (int j = 0; j < num_grid_points_per_dim; ++j) {
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 0] = -0.9 + 1.8*i/(num_grid_points_per_dim - 1);
+      initial_guesses[(i*num_grid_points_per_dim + j)*dim + 1] = -0.9 + 1.8*j/(num_grid_points_per_dim - 1);
+    }
+  }
+
+  MultimodalEvaluator objective_eval(dim);
+  std::vector<typename MultimodalEvaluator::StateType> state_vector;
+  state_vector.reserve(max_num_threads);
+  for (int i = 0; i < max_num_threads; ++i) {
+    state_vector.emplace_back(objective_eval, initial_guesses.data());
+  }
+  Optimizer gd_opt;
+  MultistartOptimizer<Optimizer> multistart_optimizer;
+  const ThreadSchedule thread_schedule(max_num_threads);
+  const DistributedContext distributed_context = DistributedContext::World();
+  int total_errors = 0;
+
+  std::vector<double> function_values(num_multistarts);
+  OptimizationIOContainer io_container(dim, -INFINITY, initial_guesses.data());
+  multistart_optimizer.MultistartOptimize(gd_opt, objective_eval, gd_parameters, domain, thread_schedule,
+                                          initial_guesses.data(), num_multistarts, state_vector.data(),
+                                          function_values.data(), &io_container);
+
+  std::vector<double> distributed_function_values(num_multistarts);
+  OptimizationIOContainer distributed_io_container(dim, -INFINITY, initial_guesses.data());
+  multistart_optimizer.MultistartOptimizeDistributed(gd_opt, objective_eval, gd_parameters, domain,
+                                                     distributed_context, thread_schedule, initial_guesses.data(),
+                                                     num_multistarts, state_vector.data(),
+                                                     distributed_function_values.data(), &distributed_io_container);
+  if (!distributed_io_container.found_flag || distributed_function_values != function_values ||
+      distributed_io_container.best_objective_value_so_far != io_container.best_objective_value_so_far) {
+    ++total_errors;
+  }
+  // starts converging to the same optimum tie up to roundoff, and which of them wins depends on thread timing
+  for (int d = 0; d < dim; ++d) {
+    if (!CheckDoubleWithinRelativeWithThreshold(distributed_io_container.best_point[d], io_container.best_point[d],
+                                                1.0e-8, 1.0e-8)) {
+      ++total_errors;
+    }
+  }
+
+  // no start beats the initial best
+  const double unbeatable_point[dim] = {2.0, 2.0};
+  OptimizationIOContainer unbeaten_io_container(dim, INFINITY, unbeatable_point);
+  multistart_optimizer.MultistartOptimizeDistributed(gd_opt, objective_eval, gd_parameters, domain,
+                                                     distributed_context, thread_schedule, initial_guesses.data(),
+                                                     num_multistarts, state_vector.data(), nullptr,
+                                                     &unbeaten_io_container);
+  if (unbeaten_io_container.found_flag || unbeaten_io_container.best_objective_value_so_far != INFINITY ||
+      unbeaten_io_container.best_point[0] != 2.0 || unbeaten_io_container.best_point[1] != 2.0) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks StreamingUniformSearch() on MultimodalEvaluator against evaluating the same tiles (regenerated from the
+  documented seeds) as one list:
+
+  * for 1, 3, and more threads than tiles, every point is evaluated and the best point and value, and the top points
+    (with ``min_distance = 0``), are exactly those of the full list,
+  * an initial best that no point beats is kept, with ``found_flag`` false,
+  * ``tile_size < 1`` throws.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int StreamingUniformSearchTest() {
+  const int dim = 2;
+  const int num_points = 1000;
+  const int tile_size = 64;
+  const int num_kept = 5;
+  const UniformRandomGenerator::EngineType::result_type seed = 314;
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  MultimodalEvaluator objective_eval(dim);
+
+  // the full list: tile t is drawn from a generator seeded with (base seed + t)
+  std::vector<double> points(dim*num_points);
+  std::vector<double> values(num_points);
+  {
+    UniformRandomGenerator uniform_generator(seed);
+    const UniformRandomGenerator::EngineType::result_type base_seed = uniform_generator.engine();
+    for (int t = 0; t*tile_size < num_points; ++t) {
+      UniformRandomGenerator tile_generator(base_seed + t);
+      int OL_UNUSED(num_generated) = domain.GenerateUniformPointsInDomain(std::min(tile_size, num_points - t*tile_size),
+                                                                          &tile_generator,
+                                                                          points.data() + t*tile_size*dim);
+    }
+    typename MultimodalEvaluator::StateType state(objective_eval, points.data());
+    for (int i = 0; i < num_points; ++i) {
+      state.SetCurrentPoint(objective_eval, points.data() + i*dim);
+      values[i] = objective_eval.ComputeObjectiveFunction(&state);
+    }
+  }
+  const int best_index = std::max_element(values.begin(), values.end()) - values.begin();
+  DiverseTopPoints expected_top_points(num_kept, 0.0);
+  SelectDiverseTopPoints(values.data(), points.data(), num_points, dim, &expected_top_points);
+
+  int total_errors = 0;
+  const int num_threads_list[3] = {1, 3, 20};
+  for (const int num_threads : num_threads_list) {
+    std::vector<typename MultimodalEvaluator::StateType> state_vector;
+    state_vector.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      state_vector.emplace_back(objective_eval, points.data());
+    }
+    UniformRandomGenerator uniform_generator(seed);
+    OptimizationIOContainer io_container(dim, -INFINITY, points.data());
+    io_container.top_points = DiverseTopPoints(num_kept, 0.0);
+    const int num_evaluated = StreamingUniformSearch(objective_eval, domain, num_points, tile_size, num_threads,
+                                                     state_vector.data(), &uniform_generator, &io_container);
+    if (num_evaluated != num_points || !io_container.found_flag ||
+        io_container.best_objective_value_so_far != values[best_index] ||
+        !std::equal(io_container.best_point.begin(), io_container.best_point.end(),
+                    points.begin() + best_index*dim)) {
+      ++total_errors;
+    }
+    if (io_container.top_points.values != expected_top_points.values ||
+        io_container.top_points.points != expected_top_points.points) {
+      ++total_errors;
+    }
+  }
+
+  // no point beats the initial best
+  typename MultimodalEvaluator::StateType state(objective_eval, points.data());
+  const double unbeatable_point[dim] = {2.0, 2.0};
+  UniformRandomGenerator uniform_generator(seed);
+  OptimizationIOContainer unbeaten_io_container(dim, INFINITY, unbeatable_point);
+  int OL_UNUSED(num_evaluated) = StreamingUniformSearch(objective_eval, domain, num_points, tile_size, 1, &state,
+                                                        &uniform_generator, &unbeaten_io_container);
+  if (unbeaten_io_container.found_flag || unbeaten_io_container.best_point[0] != 2.0 ||
+      unbeaten_io_container.best_point[1] != 2.0) {
+    ++total_errors;
+  }
+
+  try {
+    OptimizationIOContainer io_container(dim, -INFINITY, points.data());
+    int OL_UNUSED(bad_num_evaluated) = StreamingUniformSearch(objective_eval, domain, num_points, 0, 1, &state,
+                                                              &uniform_generator, &io_container);
+    ++total_errors;
+  } catch (const LowerBoundException<int>& exception) {
+  }
+
+  return total_errors;
+}
+
 }  // end unnamed namespace
 
 int RunOptimizationTests() {
   int total_errors = 0;
   total_errors += RunSimpleObjectiveOptimizationTests(OptimizerTypes::kGradientDescent);
   total_errors += RunSimpleObjectiveOptimizationTests(OptimizerTypes::kNewton);
+  total_errors += RunSimpleObjectiveOptimizationTests(OptimizerTypes::kLBFGSB);
+  total_errors += RunSimpleObjectiveOptimizationTests(OptimizerTypes::kLineSearchGradientDescent);
   total_errors += MultistartOptimizeExceptionHandlingTest();
+  total_errors += MultistartRaceTest();
+  total_errors += FixedSizeGradientDescentTest();
+  total_errors += FusedObjectiveAndGradientTest();
+  total_errors += SuccessiveHalvingSelectTest();
+  total_errors += MultistartDeadlineTest();
+  total_errors += MultistartTraceTest();
+  total_errors += MultistartDiverseTopPointsTest();
+  total_errors += EvaluateObjectiveAtPointSetsTest();
+  total_errors += MultistartOptimizeDistributedTest();
+  total_errors += StreamingUniformSearchTest();
   return total_errors;
 }
 
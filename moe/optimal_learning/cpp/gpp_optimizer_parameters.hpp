@@ -1,7 +1,7 @@
 /*!
   \file gpp_optimizer_parameters.hpp
   \rst
-  This file specifies OptimizerParameters structs (e.g., GradientDescent, Newton) for holding values that control the behavior
+  This file specifies OptimizerParameters structs (e.g., GradientDescent, Newton, L-BFGS-B) for holding values that control the behavior
   of the optimizers in gpp_optimization.hpp.  For example, max step sizes, number of iterations, step size control, etc. are all
   specified through these structs.
 
@@ -12,6 +12,8 @@
 #ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_PARAMETERS_HPP_
 #define MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_PARAMETERS_HPP_
 
+#include <chrono>
+
 #include "gpp_common.hpp"
 
 namespace optimal_learning {
@@ -28,6 +30,10 @@ enum class OptimizerTypes {
   kGradientDescent = 1,
   //! NewtonOptimizer<>
   kNewton = 2,
+  //! LBFGSBOptimizer<>
+  kLBFGSB = 3,
+  //! LineSearchGradientDescentOptimizer<>
+  kLineSearchGradientDescent = 4,
 };
 
 // TODO(GH-167): Remove num_multistarts from ALL OptimizerParameter structs. num_multistarts doesn't
@@ -40,6 +46,53 @@ enum class OptimizerTypes {
 struct NullParameters {
 };
 
+/*!\rst
+  A wall-clock deadline for an optimization, e.g., to keep a suggestion request within its latency budget.  Every
+  optimizer parameter struct (except NullParameters) holds one; the default is no deadline.
+
+  Optimizers check it once per step (and MultistartOptimizer<...>::MultistartOptimize() before each start).  Once it has
+  passed, the running optimizations return the point they have reached, the remaining starts are skipped, and the
+  OptimizationIOContainer reports the best point found so far with ``deadline_reached`` set.  A step already underway
+  is finished, so a call may overrun the deadline by up to one step (one objective and gradient evaluation).
+
+  Uses ``std::chrono::steady_clock``, so it is immune to system clock adjustments.
+\endrst*/
+struct OptimizationDeadline {
+  using Clock = std::chrono::steady_clock;
+
+  //! no deadline
+  OptimizationDeadline() noexcept : time(Clock::time_point::max()) {
+  }
+
+  //! a deadline at ``time_in``
+  explicit OptimizationDeadline(Clock::time_point time_in) noexcept : time(time_in) {
+  }
+
+  /*!\rst
+    \param
+      :seconds: wall-clock budget from now, in seconds
+    \return
+      a deadline ``seconds`` from now
+  \endrst*/
+  static OptimizationDeadline After(double seconds) noexcept {
+    return OptimizationDeadline(Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds)));
+  }
+
+  //! true if this is a deadline (not the default "none")
+  bool is_set() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return time != Clock::time_point::max();
+  }
+
+  //! true if the deadline is set and has passed; reads the clock only if it is set
+  bool Expired() const noexcept OL_WARN_UNUSED_RESULT {
+    return is_set() && Clock::now() >= time;
+  }
+
+  //! the deadline; ``Clock::time_point::max()`` means none
+  Clock::time_point time;
+};
+
 /*!\rst
   Container to hold parameters that specify the behavior of Gradient Descent.
 
@@ -99,7 +152,8 @@ struct GradientDescentParameters {
         gamma(gamma_in),
         pre_mult(pre_mult_in),
         max_relative_change(max_relative_change_in),
-        tolerance(tolerance_in) {
+        tolerance(tolerance_in),
+        record_traces(false) {
   }
 
   GradientDescentParameters(GradientDescentParameters&& OL_UNUSED(other)) = default;
@@ -130,6 +184,15 @@ struct GradientDescentParameters {
   //! when the magnitude of the gradient falls below this value OR we will not move farther than tolerance
   //! (e.g., at a boundary), stop.  (suggest: 1.0e-7)
   double tolerance;
+
+  // deadline control
+  //! wall-clock deadline; stop (returning the best point so far) once it passes.  Default: none
+  OptimizationDeadline deadline;
+
+  // diagnostics
+  //! record a per-start OptimizationTrace (steps, final gradient norm, boundary hits, convergence) in the
+  //! OptimizationIOContainer of multistart runs; costs one extra gradient evaluation per start.  Default: false
+  bool record_traces;
 };
 
 /*!\rst
@@ -193,6 +256,250 @@ struct NewtonParameters {
   double max_relative_change;
   //! when the magnitude of the gradient falls below this value, stop (suggest: 1.0e-10)
   double tolerance;
+
+  // deadline control
+  //! wall-clock deadline; stop (returning the best point so far) once it passes.  Default: none
+  OptimizationDeadline deadline;
+};
+
+/*!\rst
+  Container to hold parameters that specify the behavior of L-BFGS-B (limited-memory BFGS with box constraints).
+
+  **Iterations**
+
+  Each iteration costs one gradient evaluation plus one objective evaluation per line search trial (usually just one).
+  Quasi-Newton steps adapt to the local curvature, so on smooth problems like hyperparameter optimization this typically
+  needs 10-30x fewer evaluations than gradient descent's fixed ``pre_mult * (i+1)^{-\gamma}`` schedule.
+
+  **Memory**
+
+  ``history_size`` (``m``) is the number of recent ``(step, change in gradient)`` pairs kept to approximate the
+  (inverse) Hessian; each iteration costs ``O(m * problem_size)`` on top of the function evaluations.
+
+  **Tolerances**
+
+  We stop when the infinity-norm of the projected gradient (the gradient with components that push against an active
+  bound removed) falls below ``tolerance``, or when the line search cannot make progress even along the (projected)
+  steepest ascent direction.
+\endrst*/
+struct LBFGSBParameters {
+  // Users must set parameters explicitly.
+  LBFGSBParameters() = delete;
+
+  /*!\rst
+    Construct a LBFGSBParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  LBFGSBParameters(int num_multistarts_in, int max_num_steps_in, int history_size_in,
+                   int max_num_line_search_steps_in, double tolerance_in)
+      : num_multistarts(num_multistarts_in),
+        max_num_steps(max_num_steps_in),
+        history_size(history_size_in),
+        max_num_line_search_steps(max_num_line_search_steps_in),
+        tolerance(tolerance_in) {
+  }
+
+  LBFGSBParameters(LBFGSBParameters&& OL_UNUSED(other)) = default;
+
+  // iteration control
+  //! number of initial guesses for multistarting (suggest: a few hundred)
+  int num_multistarts;
+  //! maximum number of L-BFGS-B iterations (per initial guess) (suggest: 100-200)
+  int max_num_steps;
+  //! maximum number of L-BFGS-B restarts (fixed; not used by L-BFGS-B)
+  const int max_num_restarts = 1;
+
+  // quasi-Newton control
+  //! number of correction pairs stored to approximate the inverse Hessian (suggest: 5-20)
+  int history_size;
+  //! maximum number of backtracking steps per line search (suggest: 20-40)
+  int max_num_line_search_steps;
+
+  // tolerance control
+  //! when the infinity-norm of the projected gradient falls below this value, stop (suggest: 1.0e-10)
+  double tolerance;
+
+  // deadline control
+  //! wall-clock deadline; stop (returning the best point so far) once it passes.  Default: none
+  OptimizationDeadline deadline;
+};
+
+/*!\rst
+  Container to hold parameters that specify the behavior of line search gradient descent (steepest ascent with an
+  adaptive, Armijo-backtracked step size).
+
+  **Iterations**
+
+  Each iteration costs one gradient evaluation plus one objective evaluation per line search trial.  Unlike gradient
+  descent's fixed ``pre_mult * (i+1)^{-\gamma}`` schedule, the step size adapts: each iteration's first trial comes from
+  the curvature seen along the previous step (Barzilai-Borwein) and is halved on every rejected trial, so it needs no
+  tuning beyond a rough ``initial_step_size``.
+
+  **Tolerances**
+
+  We stop when the 2-norm of the gradient falls below ``tolerance``, when the accepted step is shorter than
+  ``tolerance`` (e.g., at a boundary), or when the line search cannot find a point satisfying the Armijo condition.
+\endrst*/
+struct LineSearchGradientDescentParameters {
+  // Users must set parameters explicitly.
+  LineSearchGradientDescentParameters() = delete;
+
+  /*!\rst
+    Construct a LineSearchGradientDescentParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  LineSearchGradientDescentParameters(int num_multistarts_in, int max_num_steps_in,
+                                      int max_num_line_search_steps_in, double initial_step_size_in,
+                                      double max_relative_change_in, double tolerance_in)
+      : num_multistarts(num_multistarts_in),
+        max_num_steps(max_num_steps_in),
+        max_num_line_search_steps(max_num_line_search_steps_in),
+        initial_step_size(initial_step_size_in),
+        max_relative_change(max_relative_change_in),
+        tolerance(tolerance_in) {
+  }
+
+  LineSearchGradientDescentParameters(LineSearchGradientDescentParameters&& OL_UNUSED(other)) = default;
+
+  // iteration control
+  //! number of initial guesses for multistarting (suggest: a few hundred)
+  int num_multistarts;
+  //! maximum number of gradient descent iterations (per initial guess) (suggest: 100-500)
+  int max_num_steps;
+  //! maximum number of line search restarts (fixed; not used by line search gradient descent)
+  const int max_num_restarts = 1;
+
+  // step size control
+  //! maximum number of backtracking (step halving) trials per line search (suggest: 20-40)
+  int max_num_line_search_steps;
+  //! step size (multiplier on the gradient) tried on the first iteration (suggest: 0.1-1.0)
+  double initial_step_size;
+
+  // tolerance control
+  //! max change allowed per update (as a relative fraction of current distance to wall) (suggest: 0.5-1.0)
+  double max_relative_change;
+  //! when the magnitude of the gradient OR of the accepted step falls below this value, stop (suggest: 1.0e-10)
+  double tolerance;
+
+  // deadline control
+  //! wall-clock deadline; stop (returning the best point so far) once it passes.  Default: none
+  OptimizationDeadline deadline;
+};
+
+/*!\rst
+  Enum for how MultistartOptimizer<...>::MultistartRace() ranks the surviving starts after each round.
+\endrst*/
+enum class RacingCriterion {
+  //! the objective value at the end of the round
+  kCurrentValue = 0,
+  //! the objective value plus the last round's improvement extrapolated over the remaining rounds
+  kOptimisticBound = 1,
+};
+
+/*!\rst
+  Container to hold parameters that specify the behavior of multistart racing (see
+  MultistartOptimizer<...>::MultistartRace() in gpp_optimization.hpp).
+
+  **Rounds**
+
+  Every surviving start advances by one short optimizer run per round (for gradient descent, one restart of
+  ``num_steps_per_round`` steps); then the survivors are ranked and the bottom ``drop_fraction`` of them is dropped,
+  keeping at least ``min_num_survivors``.  After ``num_rounds`` rounds, at most
+  ``max(min_num_survivors, num_multistarts * (1 - drop_fraction)^num_rounds)`` starts remain; wrappers run the full
+  optimizer on those.
+
+  **Ranking**
+
+  ``kCurrentValue`` ranks by the objective at the end of the round.  ``kOptimisticBound`` adds
+  ``max(0, last round's improvement) * (rounds remaining)``, so a start that is still climbing quickly survives a round
+  in which it trails a start that has already stalled.  With either criterion, the start with the best current value
+  is never dropped.
+\endrst*/
+struct RacingParameters {
+  // Users must set parameters explicitly.
+  RacingParameters() = delete;
+
+  /*!\rst
+    Construct a RacingParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  RacingParameters(int num_rounds_in, int num_steps_per_round_in, double drop_fraction_in, int min_num_survivors_in,
+                   RacingCriterion criterion_in)
+      : num_rounds(num_rounds_in),
+        num_steps_per_round(num_steps_per_round_in),
+        drop_fraction(drop_fraction_in),
+        min_num_survivors(min_num_survivors_in),
+        criterion(criterion_in) {
+  }
+
+  RacingParameters(RacingParameters&& OL_UNUSED(other)) = default;
+
+  //! number of ranking rounds (suggest: 3-6)
+  int num_rounds;
+  //! optimizer iterations per round, used by wrappers to build the per-round optimizer parameters (suggest: 5-20)
+  int num_steps_per_round;
+  //! fraction of the survivors dropped after each round, in [0, 1) (suggest: 0.5)
+  double drop_fraction;
+  //! never drop below this many survivors (suggest: 1-4)
+  int min_num_survivors;
+  //! how survivors are ranked
+  RacingCriterion criterion;
+};
+
+/*!\rst
+  Container to hold parameters that specify warm-started hyperparameter refits (see HyperparameterRefitState and the
+  refit overloads of MultistartGradientDescentHyperparameterOptimization() and
+  MultistartLBFGSBHyperparameterOptimization() in gpp_model_selection.hpp).
+
+  **Warm refits**
+
+  After one or a few new observations, the log likelihood optimum rarely moves far.  A warm refit starts the optimizer
+  from the previous optimum and ``num_warm_starts - 1`` points drawn uniformly within ``perturbation_radius`` of it
+  (per coordinate, in ``log10`` space), instead of from ``num_multistarts`` Latin hypercube points over the whole domain.
+
+  **Full searches**
+
+  A refit falls back to the full (Latin hypercube multistart) search if it is the first one, if
+  ``full_search_interval - 1`` warm refits have run since the last full search, or if the log likelihood per sampled
+  point at the previous optimum has dropped by more than ``max_log_likelihood_drop`` since that optimum was found
+  (the new data disagree with the old fit).
+\endrst*/
+struct HyperparameterRefitParameters {
+  // Users must set parameters explicitly.
+  HyperparameterRefitParameters() = delete;
+
+  /*!\rst
+    Construct a HyperparameterRefitParameters object.  Default, copy, and assignment constructor are disallowed.
+
+    INPUTS:
+    See member declarations below for a description of each parameter.
+  \endrst*/
+  HyperparameterRefitParameters(int full_search_interval_in, int num_warm_starts_in, double perturbation_radius_in,
+                                double max_log_likelihood_drop_in)
+      : full_search_interval(full_search_interval_in),
+        num_warm_starts(num_warm_starts_in),
+        perturbation_radius(perturbation_radius_in),
+        max_log_likelihood_drop(max_log_likelihood_drop_in) {
+  }
+
+  HyperparameterRefitParameters(HyperparameterRefitParameters&& OL_UNUSED(other)) = default;
+
+  //! run a full search at least once every this many refits; 1 disables warm refits, 0 leaves only the drop test
+  //! (suggest: 10-20)
+  int full_search_interval;
+  //! number of starts of a warm refit, including the previous optimum; <= 0 disables warm refits (suggest: 4-8)
+  int num_warm_starts;
+  //! half-width, in ``log10`` units, of the perturbations of the previous optimum (suggest: 0.1-0.3)
+  double perturbation_radius;
+  //! fall back to a full search if the log likelihood per sampled point at the previous optimum dropped by more than
+  //! this (suggest: 0.1-0.5)
+  double max_log_likelihood_drop;
 };
 
 }  // end namespace optimal_learning
@@ -0,0 +1,248 @@
+/*!
+  \file gpp_optimizer_session.cpp
+  \rst
+  Implementation of ExpectedImprovementOptimizerSession; see gpp_optimizer_session.hpp for details.
+\endrst*/
+
+#include "gpp_optimizer_session.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_math.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+template <typename DomainType>
+ExpectedImprovementOptimizerSession<DomainType>::ExpectedImprovementOptimizerSession(
+    const CovarianceInterface& covariance, double const * restrict noise_variance,
+    double const * restrict points_sampled, double const * restrict points_sampled_value, int dim, int num_sampled,
+    const DomainType& domain, const GradientDescentParameters& optimizer_parameters,
+    const ThreadSchedule& thread_schedule, int max_int_steps, int num_warm_starts, bool precompute_in_background,
+    EngineType::result_type seed)
+    : dim_(dim),
+      domain_(domain),
+      // GradientDescentParameters is move-only, so the copy is built field by field
+      optimizer_parameters_(optimizer_parameters.num_multistarts, optimizer_parameters.max_num_steps,
+                            optimizer_parameters.max_num_restarts, optimizer_parameters.num_steps_averaged,
+                            optimizer_parameters.gamma, optimizer_parameters.pre_mult,
+                            optimizer_parameters.max_relative_change, optimizer_parameters.tolerance),
+      thread_schedule_(thread_schedule),
+      max_int_steps_(max_int_steps),
+      num_warm_starts_(std::min(num_warm_starts, optimizer_parameters.num_multistarts)),
+      seed_(seed),
+      mutex_(),
+      gaussian_process_(nullptr),
+      points_being_sampled_(),
+      warm_starts_(),
+      best_so_far_(0.0),
+      generation_(0),
+      suggestion_(),
+      suggestion_generation_(0),
+      stop_(false),
+      state_changed_(),
+      suggestion_ready_(),
+      worker_() {
+  if (unlikely(num_sampled < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_sampled must be >= 1.", num_sampled, 1);
+  }
+  if (unlikely(optimizer_parameters.num_multistarts < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be >= 1.", optimizer_parameters.num_multistarts, 1);
+  }
+
+  // only function values are observed
+  const int derivatives_unused = 0;
+  const int no_derivatives = 0;
+  gaussian_process_.reset(new GaussianProcess(covariance, points_sampled, points_sampled_value, noise_variance,
+                                              &derivatives_unused, no_derivatives, dim_, num_sampled));
+  best_so_far_ = *std::min_element(points_sampled_value, points_sampled_value + num_sampled);
+
+  // no generation ever reaches this, so there is no suggestion until one is computed
+  suggestion_generation_ = std::numeric_limits<std::uint64_t>::max();
+  if (precompute_in_background) {
+    worker_ = std::thread(&ExpectedImprovementOptimizerSession::WorkerLoop, this);
+  }
+}
+
+template <typename DomainType>
+ExpectedImprovementOptimizerSession<DomainType>::~ExpectedImprovementOptimizerSession() {
+  if (worker_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    state_changed_.notify_all();
+    worker_.join();
+  }
+}
+
+template <typename DomainType>
+bool ExpectedImprovementOptimizerSession<DomainType>::Suggest(double * restrict next_point) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (worker_.joinable()) {
+    suggestion_ready_.wait(lock, [this]() { return suggestion_generation_ == generation_; });
+  } else if (suggestion_generation_ != generation_) {
+    suggestion_ = ComputeSuggestion(TakeSnapshot());
+    suggestion_generation_ = generation_;
+  }
+  if (suggestion_.exception != nullptr) {
+    std::rethrow_exception(suggestion_.exception);
+  }
+
+  const std::vector<double>& point = suggestion_.point;
+  std::copy(point.begin(), point.end(), next_point);
+  points_being_sampled_.insert(points_being_sampled_.end(), point.begin(), point.end());
+  warm_starts_.push_front(point);
+  if (static_cast<int>(warm_starts_.size()) > num_warm_starts_) {
+    warm_starts_.pop_back();
+  }
+  const bool found_flag = suggestion_.found_flag;
+  AdvanceGeneration();
+  return found_flag;
+}
+
+template <typename DomainType>
+void ExpectedImprovementOptimizerSession<DomainType>::MarkPending(double const * restrict point) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  points_being_sampled_.insert(points_being_sampled_.end(), point, point + dim_);
+  AdvanceGeneration();
+}
+
+template <typename DomainType>
+void ExpectedImprovementOptimizerSession<DomainType>::Observe(double const * restrict point, double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const int num_pending = static_cast<int>(points_being_sampled_.size())/dim_;
+  for (int i = 0; i < num_pending; ++i) {
+    auto pending_point = points_being_sampled_.begin() + i*dim_;
+    if (std::equal(point, point + dim_, pending_point)) {
+      points_being_sampled_.erase(pending_point, pending_point + dim_);
+      break;
+    }
+  }
+
+  // the worker only ever reads its own copy, so the GP can be extended in place
+  gaussian_process_->AddPointsToGP(point, &value, 1);
+  best_so_far_ = std::min(best_so_far_, value);
+  AdvanceGeneration();
+}
+
+template <typename DomainType>
+int ExpectedImprovementOptimizerSession<DomainType>::num_sampled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return gaussian_process_->num_sampled();
+}
+
+template <typename DomainType>
+int ExpectedImprovementOptimizerSession<DomainType>::num_pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(points_being_sampled_.size())/dim_;
+}
+
+template <typename DomainType>
+double ExpectedImprovementOptimizerSession<DomainType>::best_so_far() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return best_so_far_;
+}
+
+template <typename DomainType>
+typename ExpectedImprovementOptimizerSession<DomainType>::Snapshot
+ExpectedImprovementOptimizerSession<DomainType>::TakeSnapshot() const {
+  Snapshot snapshot;
+  snapshot.gaussian_process.reset(gaussian_process_->Clone());
+  snapshot.points_being_sampled = points_being_sampled_;
+  for (const auto& warm_start : warm_starts_) {
+    snapshot.warm_starts.insert(snapshot.warm_starts.end(), warm_start.begin(), warm_start.end());
+  }
+  snapshot.best_so_far = best_so_far_;
+  snapshot.generation = generation_;
+  return snapshot;
+}
+
+template <typename DomainType>
+typename ExpectedImprovementOptimizerSession<DomainType>::Suggestion
+ExpectedImprovementOptimizerSession<DomainType>::ComputeSuggestion(const Snapshot& snapshot) const {
+  Suggestion suggestion;
+  suggestion.point.resize(dim_);
+  suggestion.found_flag = false;
+  try {
+    // seeded from the state number alone (see file comments, item 4)
+    const int num_threads = thread_schedule_.max_num_threads;
+    UniformRandomGenerator uniform_generator(seed_ + static_cast<EngineType::result_type>(snapshot.generation));
+    std::vector<NormalRNG> normal_rng;
+    normal_rng.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      normal_rng.emplace_back(seed_ + static_cast<EngineType::result_type>(snapshot.generation*(num_threads + 1) + i + 1));
+    }
+
+    // warm starts first, then uniform draws
+    const int num_warm_starts = static_cast<int>(snapshot.warm_starts.size())/dim_;
+    std::vector<double> start_point_set(snapshot.warm_starts);
+    start_point_set.resize(optimizer_parameters_.num_multistarts*dim_);
+    int num_multistarts = num_warm_starts;
+    if (optimizer_parameters_.num_multistarts > num_warm_starts) {
+      num_multistarts += domain_.GenerateUniformPointsInDomain(optimizer_parameters_.num_multistarts - num_warm_starts,
+                                                               &uniform_generator,
+                                                               start_point_set.data() + num_warm_starts*dim_);
+    }
+
+    const int num_to_sample = 1;
+    const int num_being_sampled = static_cast<int>(snapshot.points_being_sampled.size())/dim_;
+    // the pending set may be empty (data() is then possibly null); any valid pointer does
+    double const * points_being_sampled = num_being_sampled > 0 ? snapshot.points_being_sampled.data() :
+        start_point_set.data();
+    ComputeOptimalPointsToSampleViaMultistartGradientDescent(*snapshot.gaussian_process, optimizer_parameters_, domain_,
+                                                             thread_schedule_, start_point_set.data(),
+                                                             points_being_sampled, num_multistarts,
+                                                             num_to_sample, num_being_sampled, snapshot.best_so_far,
+                                                             max_int_steps_, normal_rng.data(), &suggestion.found_flag,
+                                                             suggestion.point.data());
+  } catch (...) {
+    suggestion.exception = std::current_exception();
+  }
+  return suggestion;
+}
+
+template <typename DomainType>
+void ExpectedImprovementOptimizerSession<DomainType>::AdvanceGeneration() {
+  ++generation_;
+  state_changed_.notify_one();
+}
+
+template <typename DomainType>
+void ExpectedImprovementOptimizerSession<DomainType>::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    state_changed_.wait(lock, [this]() { return stop_ || suggestion_generation_ != generation_; });
+    if (stop_) {
+      return;
+    }
+
+    Snapshot snapshot = TakeSnapshot();
+    lock.unlock();
+    Suggestion suggestion = ComputeSuggestion(snapshot);
+    lock.lock();
+
+    // a suggestion for a superseded state is dropped; the loop then starts on the current one
+    if (snapshot.generation == generation_) {
+      suggestion_ = std::move(suggestion);
+      suggestion_generation_ = snapshot.generation;
+      suggestion_ready_.notify_all();
+    }
+  }
+}
+
+template class ExpectedImprovementOptimizerSession<TensorProductDomain>;
+template class ExpectedImprovementOptimizerSession<SimplexIntersectTensorProductDomain>;
+
+}  // end namespace optimal_learning
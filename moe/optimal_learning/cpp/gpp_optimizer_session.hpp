@@ -0,0 +1,244 @@
+/*!
+  \file gpp_optimizer_session.hpp
+  \rst
+  1. OVERVIEW
+  2. STATE AND UPDATES
+  3. BACKGROUND PRECOMPUTATION
+  4. REPRODUCIBILITY
+
+  **1. OVERVIEW**
+
+  In an asynchronous deployment, the next point is requested while many evaluations are still running.  Calling
+  ComputeOptimalPointsToSample() per request rebuilds (and refactors) the GP from the full history and starts the q,p-EI
+  optimization from scratch every time.  ExpectedImprovementOptimizerSession instead keeps the fitted GP, the set of
+  pending (suggested or otherwise running, but not yet observed) points, and a pool of warm starts across requests:
+
+  * Suggest() returns the point maximizing 1,p-EI, with the pending points as ``points_being_sampled``, and marks it pending.
+  * MarkPending() adds a point that is being evaluated without having been suggested (e.g., a user-chosen experiment).
+  * Observe() records an evaluation: the point leaves the pending set and joins the GP via GaussianProcess::AddPointsToGP(),
+    which extends the cholesky factor instead of refactoring it.
+
+  **2. STATE AND UPDATES**
+
+  The hyperparameters (in ``covariance``) and noise variance are fixed at construction; refit them (e.g., with
+  gpp_model_selection) and build a new session when they drift.  Only function values are observed (no derivatives).
+
+  Every Suggest() starts gradient descent from ``optimizer_parameters.num_multistarts`` points: the most recent
+  ``num_warm_starts`` suggestions (the optimum usually moves little between requests), then uniform draws from the
+  domain.  ``best_so_far`` is the smallest observed value.
+
+  **3. BACKGROUND PRECOMPUTATION**
+
+  With ``precompute_in_background`` set, a worker thread owned by the session computes the suggestion for the current
+  state (GP, pending set, warm starts) whenever that state changes, so the optimization overlaps the caller's own work and
+  Suggest() usually returns at once.  The worker optimizes over a copy of the GP (training data are shared, see
+  GaussianProcess's shared-data constructor), so MarkPending() and Observe() never wait for it.  A suggestion started
+  before the latest change is discarded on completion and the worker starts over; Suggest() waits until the suggestion
+  for the current state is ready.
+
+  All public member functions are thread-safe.
+
+  **4. REPRODUCIBILITY**
+
+  Each state of the session is numbered by the count of calls that changed it; the random numbers behind a suggestion
+  (multistart draws, MC normals) are seeded from ``seed`` and that number alone.  So a session produces the same
+  suggestions for the same sequence of calls, with or without background precomputation and independent of timing
+  (provided the EI optimization itself is deterministic under ``thread_schedule``, e.g., a single thread; with several
+  threads, which thread's NormalRNG serves which multistart varies from run to run when points are pending).
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_HPP_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Stateful q=1 EI suggestion loop for asynchronous experiments; see the file comments.
+\endrst*/
+template <typename DomainType>
+class ExpectedImprovementOptimizerSession final {
+ public:
+  using EngineType = UniformRandomGenerator::EngineType;
+
+  /*!\rst
+    Builds the GP from the initial history and, if ``precompute_in_background``, starts the worker (which begins
+    computing the first suggestion right away).
+
+    \param
+      :covariance: the covariance (with fitted hyperparameters) of the GP
+      :noise_variance[1]: ``\sigma_n^2``, the noise variance of each observation
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_sampled]: function values at points_sampled
+      :dim: the spatial dimension of a point
+      :num_sampled: number of already-sampled points (at least 1)
+      :domain: domain the suggestions are optimized over
+      :optimizer_parameters: gradient descent parameters of the EI optimization (``num_multistarts`` starts per suggestion)
+      :thread_schedule: threading of the EI optimization
+      :max_int_steps: maximum number of MC iterations of q,p-EI (used when points are pending)
+      :num_warm_starts: number of recent suggestions used as initial guesses (at most ``num_multistarts``)
+      :precompute_in_background: true to compute suggestions on a worker thread as soon as the state changes
+      :seed: base seed of every suggestion's random numbers
+  \endrst*/
+  ExpectedImprovementOptimizerSession(const CovarianceInterface& covariance, double const * restrict noise_variance,
+                                      double const * restrict points_sampled,
+                                      double const * restrict points_sampled_value, int dim, int num_sampled,
+                                      const DomainType& domain, const GradientDescentParameters& optimizer_parameters,
+                                      const ThreadSchedule& thread_schedule, int max_int_steps, int num_warm_starts,
+                                      bool precompute_in_background, EngineType::result_type seed) OL_NONNULL_POINTERS;
+
+  //! stops (and joins) the worker; a suggestion in progress is finished first
+  ~ExpectedImprovementOptimizerSession();
+
+  /*!\rst
+    Returns the next point to sample and marks it pending.
+
+    \output
+      :next_point[dim]: the point with the best 1,p-EI found, ``p`` = num_pending() before this call
+    \return
+      true if ``next_point`` has nonzero EI (see ComputeOptimalPointsToSampleViaMultistartGradientDescent()'s ``found_flag``)
+    \raise
+      rethrows anything thrown while computing the suggestion
+  \endrst*/
+  bool Suggest(double * restrict next_point) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Adds a point that is being evaluated (but was not returned by Suggest()) to the pending set.
+
+    \param
+      :point[dim]: the point being evaluated
+  \endrst*/
+  void MarkPending(double const * restrict point) OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Records an evaluation: the first pending point equal to ``point`` (if any) leaves the pending set, and
+    ``(point, value)`` is added to the GP.
+
+    \param
+      :point[dim]: the evaluated point
+      :value: the (noisy) function value at ``point``
+    \raise
+      SingularMatrixException if the extended covariance matrix cannot be factored (see GaussianProcess::AddPointsToGP())
+  \endrst*/
+  void Observe(double const * restrict point, double value) OL_NONNULL_POINTERS;
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  //! number of observed points
+  int num_sampled() const OL_WARN_UNUSED_RESULT;
+
+  //! number of pending points
+  int num_pending() const OL_WARN_UNUSED_RESULT;
+
+  //! smallest observed value
+  double best_so_far() const OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ExpectedImprovementOptimizerSession);
+
+ private:
+  //! everything a suggestion depends on; copied out under the lock so the optimization runs without it
+  struct Snapshot {
+    //! the GP (a copy; training data are shared with the session's GP)
+    std::unique_ptr<GaussianProcess> gaussian_process;
+    //! pending points, ``[num_pending][dim]``
+    std::vector<double> points_being_sampled;
+    //! warm starts, most recent first, ``[num_warm_starts][dim]``
+    std::vector<double> warm_starts;
+    //! smallest observed value
+    double best_so_far;
+    //! number of the state this snapshot was taken in
+    std::uint64_t generation;
+  };
+
+  //! result of a suggestion computation
+  struct Suggestion {
+    //! the suggested point
+    std::vector<double> point;
+    //! whether ``point`` has nonzero EI
+    bool found_flag;
+    //! anything thrown while computing it
+    std::exception_ptr exception;
+  };
+
+  //! copies the current state; requires ``mutex_``
+  Snapshot TakeSnapshot() const;
+
+  //! runs the EI optimization of ``snapshot``; does not touch any member state but the (immutable) parameters
+  Suggestion ComputeSuggestion(const Snapshot& snapshot) const;
+
+  //! marks the state changed and wakes the worker; requires ``mutex_``
+  void AdvanceGeneration();
+
+  //! body of the worker thread
+  void WorkerLoop();
+
+  // immutable parameters
+  //! spatial dimension of a point
+  const int dim_;
+  //! domain the suggestions are optimized over
+  const DomainType domain_;
+  //! gradient descent parameters of the EI optimization
+  const GradientDescentParameters optimizer_parameters_;
+  //! threading of the EI optimization
+  const ThreadSchedule thread_schedule_;
+  //! maximum number of MC iterations of q,p-EI
+  const int max_int_steps_;
+  //! number of recent suggestions kept as warm starts
+  const int num_warm_starts_;
+  //! base seed of every suggestion's random numbers
+  const EngineType::result_type seed_;
+
+  // session state; guarded by mutex_
+  //! guards the session state
+  mutable std::mutex mutex_;
+  //! the GP over every observation
+  std::unique_ptr<GaussianProcess> gaussian_process_;
+  //! pending points, ``[num_pending][dim]``
+  std::vector<double> points_being_sampled_;
+  //! recent suggestions, most recent first, each ``[dim]``
+  std::deque<std::vector<double>> warm_starts_;
+  //! smallest observed value
+  double best_so_far_;
+  //! number of the current state (count of state-changing calls)
+  std::uint64_t generation_;
+  //! the most recently completed suggestion, and the state it was computed in
+  Suggestion suggestion_;
+  //! generation of suggestion_; differs from generation_ while it is stale (or missing)
+  std::uint64_t suggestion_generation_;
+
+  // worker (only if precompute_in_background)
+  //! true once the destructor asks the worker to exit
+  bool stop_;
+  //! signals the worker that the state changed (or stop_ was set)
+  std::condition_variable state_changed_;
+  //! signals Suggest() that a suggestion completed
+  std::condition_variable suggestion_ready_;
+  //! precomputes suggestions; not joinable if precompute_in_background is false
+  std::thread worker_;
+};
+
+// template explicit instantiation declarations, see gpp_common.hpp header comments, item 6
+extern template class ExpectedImprovementOptimizerSession<TensorProductDomain>;
+extern template class ExpectedImprovementOptimizerSession<SimplexIntersectTensorProductDomain>;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_HPP_
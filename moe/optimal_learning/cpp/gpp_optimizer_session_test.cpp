@@ -0,0 +1,161 @@
+/*!
+  \file gpp_optimizer_session_test.cpp
+  \rst
+  Routines to test the functions in gpp_optimizer_session.cpp.  A session with background precomputation and one
+  without are driven through the same sequence of Suggest(), MarkPending(), and Observe() calls (observing a test
+  function between requests, so the GP grows and the pending set both grows and shrinks).  Checks:
+
+  * both sessions return bitwise identical suggestions (see gpp_optimizer_session.hpp, item 4),
+  * every suggestion lies in the domain,
+  * num_sampled(), num_pending(), and best_so_far() track the calls.
+\endrst*/
+
+#include "gpp_optimizer_session_test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_optimizer_session.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! smooth test function with its minimum inside [-1, 1]^dim
+double SessionTestFunction(double const * restrict point, int dim) noexcept {
+  double value = 0.0;
+  for (int i = 0; i < dim; ++i) {
+    value += (point[i] - 0.3)*(point[i] - 0.3) + 0.1*std::sin(3.0*point[i]);
+  }
+  return value;
+}
+
+/*!\rst
+  Drives an inline and a background session side by side; see the file comments.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int OptimizerSessionTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 8;
+  const int num_rounds = 4;
+  const int max_int_steps = 500;
+  const int num_warm_starts = 2;
+
+  std::vector<ClosedInterval> domain_bounds(dim, {-1.0, 1.0});
+  TensorProductDomain domain(domain_bounds.data(), dim);
+
+  UniformRandomGenerator uniform_generator(8371);
+  std::vector<double> points_sampled(dim*num_sampled);
+  domain.GenerateUniformPointsInDomain(num_sampled, &uniform_generator, points_sampled.data());
+  std::vector<double> points_sampled_value(num_sampled);
+  for (int i = 0; i < num_sampled; ++i) {
+    points_sampled_value[i] = SessionTestFunction(points_sampled.data() + i*dim, dim);
+  }
+
+  std::vector<double> lengths(dim, 0.6);
+  SquareExponential sqexp_covariance(dim, 1.0, lengths.data());
+  const double noise_variance = 1.0e-4;
+  GradientDescentParameters gd_parameters(8, 50, 2, 0, 0.7, 0.5, 0.8, 1.0e-7);
+  // single-threaded, so the MC EI optimization is deterministic
+  ThreadSchedule thread_schedule(1, omp_sched_static);
+
+  ExpectedImprovementOptimizerSession<TensorProductDomain> session_inline(
+      sqexp_covariance, &noise_variance, points_sampled.data(), points_sampled_value.data(), dim, num_sampled, domain,
+      gd_parameters, thread_schedule, max_int_steps, num_warm_starts, false, 2871);
+  ExpectedImprovementOptimizerSession<TensorProductDomain> session_background(
+      sqexp_covariance, &noise_variance, points_sampled.data(), points_sampled_value.data(), dim, num_sampled, domain,
+      gd_parameters, thread_schedule, max_int_steps, num_warm_starts, true, 2871);
+  ExpectedImprovementOptimizerSession<TensorProductDomain> * sessions[2] = {&session_inline, &session_background};
+
+  // a point evaluated outside of the session's suggestions
+  std::vector<double> manual_point(dim, -0.5);
+  for (auto session : sessions) {
+    session->MarkPending(manual_point.data());
+  }
+
+  double best_so_far = *std::min_element(points_sampled_value.begin(), points_sampled_value.end());
+  int expected_num_sampled = num_sampled;
+  int expected_num_pending = 1;
+  std::vector<double> suggestion_inline(dim);
+  std::vector<double> suggestion_background(dim);
+  for (int round = 0; round < num_rounds; ++round) {
+    // two requests in flight, then the older one completes
+    for (int request = 0; request < 2; ++request) {
+      bool found_inline = session_inline.Suggest(suggestion_inline.data());
+      bool found_background = session_background.Suggest(suggestion_background.data());
+      ++expected_num_pending;
+      if (found_inline != found_background) {
+        ++total_errors;
+      }
+      for (int i = 0; i < dim; ++i) {
+        if (!CheckDoubleWithin(suggestion_background[i], suggestion_inline[i], 0.0)) {
+          ++total_errors;
+        }
+      }
+      if (!domain.CheckPointInside(suggestion_inline.data())) {
+        ++total_errors;
+      }
+    }
+
+    const double value = SessionTestFunction(suggestion_inline.data(), dim);
+    for (auto session : sessions) {
+      session->Observe(suggestion_inline.data(), value);
+    }
+    ++expected_num_sampled;
+    --expected_num_pending;
+    best_so_far = std::min(best_so_far, value);
+
+    for (auto session : sessions) {
+      if (session->num_sampled() != expected_num_sampled || session->num_pending() != expected_num_pending) {
+        ++total_errors;
+      }
+      if (!CheckDoubleWithin(session->best_so_far(), best_so_far, 0.0)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // observing a point that was never pending only grows the history
+  const double manual_value = SessionTestFunction(manual_point.data(), dim);
+  std::vector<double> unrelated_point(dim, 0.9);
+  for (auto session : sessions) {
+    session->Observe(manual_point.data(), manual_value);
+    session->Observe(unrelated_point.data(), SessionTestFunction(unrelated_point.data(), dim));
+    if (session->num_sampled() != expected_num_sampled + 2 || session->num_pending() != expected_num_pending - 1) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunOptimizerSessionTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = OptimizerSessionTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("ExpectedImprovementOptimizerSession failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("ExpectedImprovementOptimizerSession\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,25 @@
+/*!
+  \file gpp_optimizer_session_test.hpp
+  \rst
+  Functions for testing gpp_optimizer_session's functionality: bookkeeping of the pending set and history, suggestions
+  lying in the domain, and agreement of sessions with and without background precomputation.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the optimizer session tests.
+
+  \return
+    number of test failures: 0 if ExpectedImprovementOptimizerSession is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunOptimizerSessionTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_OPTIMIZER_SESSION_TEST_HPP_
@@ -0,0 +1,284 @@
+/*!
+  \file gpp_partitioned_gaussian_process.cpp
+  \rst
+  Implementation of PartitionedGaussianProcess (see gpp_partitioned_gaussian_process.hpp).  Experts are plain
+  GaussianProcess objects; every per-expert prediction goes through PointsToSampleState and the GaussianProcess
+  mean/variance methods, as the EI evaluators do.
+\endrst*/
+
+#include "gpp_partitioned_gaussian_process.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_math.hpp"
+#include "gpp_task_scheduler.hpp"
+
+namespace optimal_learning {
+
+PartitionedGaussianProcess::PartitionedGaussianProcess(const CovarianceInterface& covariance,
+                                                       double const * restrict points_sampled,
+                                                       double const * restrict points_sampled_value,
+                                                       double const * restrict noise_variance,
+                                                       int const * restrict derivatives, int num_derivatives,
+                                                       int dim, int num_sampled, int max_region_size,
+                                                       int max_num_threads)
+    : dim_(dim),
+      num_sampled_(num_sampled),
+      nodes_(),
+      region_point_indices_(),
+      region_lower_(),
+      region_upper_(),
+      experts_() {
+  if (unlikely(num_sampled_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Need at least one sampled point.", num_sampled_, 1);
+  }
+  if (unlikely(max_region_size < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Regions need room for at least one point.", max_region_size, 1);
+  }
+
+  std::vector<int> indices(num_sampled_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    indices[i] = i;
+  }
+  BuildNode(points_sampled, max_region_size, 0, num_sampled_, &indices);
+
+  const int num_regions = region_point_indices_.size();
+  experts_.resize(num_regions);
+  ParallelForEachIndex(max_num_threads, num_regions, [&](int region) {
+      const std::vector<int>& point_indices = region_point_indices_[region];
+      const int region_size = point_indices.size();
+      const int values_per_point = 1 + num_derivatives;
+      std::vector<double> region_points(region_size*dim_);
+      std::vector<double> region_values(region_size*values_per_point);
+      for (int i = 0; i < region_size; ++i) {
+        std::copy(points_sampled + point_indices[i]*dim_, points_sampled + (point_indices[i] + 1)*dim_,
+                  region_points.begin() + i*dim_);
+        std::copy(points_sampled_value + point_indices[i]*values_per_point,
+                  points_sampled_value + (point_indices[i] + 1)*values_per_point,
+                  region_values.begin() + i*values_per_point);
+      }
+      experts_[region].reset(new GaussianProcess(covariance, region_points.data(), region_values.data(),
+                                                 noise_variance, derivatives, num_derivatives, dim_, region_size));
+    });
+}
+
+/*!\rst
+  Splits along the widest dimension of the node's bounding box, at the median point (``std::nth_element``); the median
+  and everything past it go right.  Leaves record their points and bounding box as a new region.
+\endrst*/
+int PartitionedGaussianProcess::BuildNode(double const * restrict points_sampled, int max_region_size, int begin,
+                                          int end, std::vector<int> * indices) {
+  std::vector<double> lower(dim_, std::numeric_limits<double>::max());
+  std::vector<double> upper(dim_, std::numeric_limits<double>::lowest());
+  for (int i = begin; i < end; ++i) {
+    double const * restrict point = points_sampled + (*indices)[i]*dim_;
+    for (int d = 0; d < dim_; ++d) {
+      lower[d] = std::fmin(lower[d], point[d]);
+      upper[d] = std::fmax(upper[d], point[d]);
+    }
+  }
+
+  const int node = nodes_.size();
+  nodes_.push_back(Node{0, 0.0, -1, -1, -1});
+  if (end - begin <= max_region_size) {
+    nodes_[node].region = region_point_indices_.size();
+    region_point_indices_.emplace_back(indices->begin() + begin, indices->begin() + end);
+    region_lower_.insert(region_lower_.end(), lower.begin(), lower.end());
+    region_upper_.insert(region_upper_.end(), upper.begin(), upper.end());
+    return node;
+  }
+
+  int split_dim = 0;
+  for (int d = 1; d < dim_; ++d) {
+    if (upper[d] - lower[d] > upper[split_dim] - lower[split_dim]) {
+      split_dim = d;
+    }
+  }
+  const int middle = begin + (end - begin)/2;
+  std::nth_element(indices->begin() + begin, indices->begin() + middle, indices->begin() + end,
+                   [&](int i, int j) {
+                     return points_sampled[i*dim_ + split_dim] < points_sampled[j*dim_ + split_dim];
+                   });
+  const double split_value = points_sampled[(*indices)[middle]*dim_ + split_dim];
+
+  const int left = BuildNode(points_sampled, max_region_size, begin, middle, indices);
+  const int right = BuildNode(points_sampled, max_region_size, middle, end, indices);
+  nodes_[node].split_dim = split_dim;
+  nodes_[node].split_value = split_value;
+  nodes_[node].left = left;
+  nodes_[node].right = right;
+  return node;
+}
+
+int PartitionedGaussianProcess::FindRegion(double const * restrict point) const noexcept {
+  int node = 0;
+  while (nodes_[node].region < 0) {
+    node = point[nodes_[node].split_dim] < nodes_[node].split_value ? nodes_[node].left : nodes_[node].right;
+  }
+  return nodes_[node].region;
+}
+
+double PartitionedGaussianProcess::DistanceSquaredToRegion(double const * restrict point, int region) const noexcept {
+  double const * restrict lower = region_lower_.data() + region*dim_;
+  double const * restrict upper = region_upper_.data() + region*dim_;
+  double distance_sq = 0.0;
+  for (int d = 0; d < dim_; ++d) {
+    const double outside = std::fmax(lower[d] - point[d], 0.0) + std::fmax(point[d] - upper[d], 0.0);
+    distance_sq += outside*outside;
+  }
+  return distance_sq;
+}
+
+/*!\rst
+  Ties in distance go to the lower region index, so the selection does not depend on the sort's implementation.
+\endrst*/
+void PartitionedGaussianProcess::SelectExperts(double const * restrict point, int num_experts,
+                                               int * restrict regions) const {
+  regions[0] = FindRegion(point);
+  if (num_experts == 1) {
+    return;
+  }
+
+  std::vector<std::pair<double, int>> distances;
+  distances.reserve(num_regions() - 1);
+  for (int region = 0; region < num_regions(); ++region) {
+    if (region != regions[0]) {
+      distances.emplace_back(DistanceSquaredToRegion(point, region), region);
+    }
+  }
+  std::partial_sort(distances.begin(), distances.begin() + (num_experts - 1), distances.end());
+  for (int k = 1; k < num_experts; ++k) {
+    regions[k] = distances[k - 1].second;
+  }
+}
+
+/*!\rst
+  With ``\beta = 1/M`` and expert predictions ``\mu_k, \sigma_k^2`` (gradients ``\mu_k', \sigma_k^{2'}``):
+
+  | ``P = \sum_k \beta / \sigma_k^2``,  ``P' = -\sum_k \beta \sigma_k^{2'} / \sigma_k^4``
+  | ``a = \sum_k \beta \mu_k / \sigma_k^2``,  ``a' = \sum_k \beta (\mu_k' / \sigma_k^2 - \mu_k \sigma_k^{2'} / \sigma_k^4)``
+  | ``\mu = a / P``, ``\mu' = (a' - \mu P') / P``; ``\sigma^2 = 1 / P``, ``\sigma^{2'} = -P' / P^2``
+
+  Expert variances are floored at ``GaussianProcess::kMinimumStdDev^2`` so noise-free experts at their own data stay
+  finite.  A single expert's prediction is returned as is.
+\endrst*/
+void PartitionedGaussianProcess::PredictPoint(double const * restrict point, ExpertCombinationRule rule,
+                                              int num_experts, double * restrict mean, double * restrict variance,
+                                              double * restrict grad_mean, double * restrict grad_variance) const {
+  const bool compute_gradients = grad_mean != nullptr || grad_variance != nullptr;
+  const int num_combined = rule == ExpertCombinationRule::kNearestRegion ? 1 :
+      std::max(1, std::min(num_experts, num_regions()));
+  std::vector<int> regions(num_combined);
+  SelectExperts(point, num_combined, regions.data());
+
+  double precision = 0.0;
+  double weighted_mean = 0.0;
+  std::vector<double> grad_precision(compute_gradients ? dim_ : 0, 0.0);
+  std::vector<double> grad_weighted_mean(compute_gradients ? dim_ : 0, 0.0);
+  std::vector<double> expert_grad_mean(compute_gradients ? dim_ : 0);
+  std::vector<double> expert_grad_variance(compute_gradients ? dim_ : 0);
+  const double beta = 1.0/num_combined;
+  for (int k = 0; k < num_combined; ++k) {
+    const GaussianProcess& gaussian_process = *experts_[regions[k]];
+    PointsToSampleState points_to_sample_state(gaussian_process, point, 1, nullptr, 0, compute_gradients ? 1 : 0,
+                                               compute_gradients);
+    double expert_mean;
+    double expert_variance;
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, &expert_mean);
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, &expert_variance);
+    if (num_combined == 1) {
+      *mean = expert_mean;
+      *variance = expert_variance;
+      if (grad_mean != nullptr) {
+        gaussian_process.ComputeGradMeanOfPoints(points_to_sample_state, grad_mean);
+      }
+      if (grad_variance != nullptr) {
+        gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, grad_variance);
+      }
+      return;
+    }
+    expert_variance = std::fmax(expert_variance, Square(GaussianProcess::kMinimumStdDev));
+
+    precision += beta/expert_variance;
+    weighted_mean += beta*expert_mean/expert_variance;
+    if (compute_gradients) {
+      gaussian_process.ComputeGradMeanOfPoints(points_to_sample_state, expert_grad_mean.data());
+      gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, expert_grad_variance.data());
+      const double inverse_variance_sq = 1.0/Square(expert_variance);
+      for (int d = 0; d < dim_; ++d) {
+        grad_precision[d] -= beta*expert_grad_variance[d]*inverse_variance_sq;
+        grad_weighted_mean[d] += beta*(expert_grad_mean[d]/expert_variance -
+                                       expert_mean*expert_grad_variance[d]*inverse_variance_sq);
+      }
+    }
+  }
+
+  *mean = weighted_mean/precision;
+  *variance = 1.0/precision;
+  for (int d = 0; d < (compute_gradients ? dim_ : 0); ++d) {
+    if (grad_mean != nullptr) {
+      grad_mean[d] = (grad_weighted_mean[d] - (*mean)*grad_precision[d])/precision;
+    }
+    if (grad_variance != nullptr) {
+      grad_variance[d] = -grad_precision[d]/Square(precision);
+    }
+  }
+}
+
+void PartitionedGaussianProcess::ComputeMeanAndVariance(double const * restrict points, int num_points,
+                                                        ExpertCombinationRule rule, int num_experts,
+                                                        int max_num_threads, double * restrict mean,
+                                                        double * restrict variance, double * restrict grad_mean,
+                                                        double * restrict grad_variance) const {
+  ParallelForEachIndex(max_num_threads, num_points, [&](int i) {
+      PredictPoint(points + i*dim_, rule, num_experts, mean + i, variance + i,
+                   grad_mean == nullptr ? nullptr : grad_mean + i*dim_,
+                   grad_variance == nullptr ? nullptr : grad_variance + i*dim_);
+    });
+}
+
+/*!\rst
+  ``EI = (best - \mu) \Phi(z) + \sigma \phi(z)``, ``z = (best - \mu) / \sigma``, so
+  ``EI' = -\Phi(z) \mu' + \phi(z) \sigma^{2'} / (2 \sigma)``.  The variance is floored as in
+  OnePotentialSampleExpectedImprovementEvaluator's gradient.
+\endrst*/
+void PartitionedGaussianProcess::ComputeExpectedImprovement(double const * restrict points, int num_points,
+                                                            double best_so_far, ExpertCombinationRule rule,
+                                                            int num_experts, int max_num_threads,
+                                                            double * restrict expected_improvement,
+                                                            double * restrict grad_expected_improvement) const {
+  ParallelForEachIndex(max_num_threads, num_points, [&](int i) {
+      const bool compute_gradients = grad_expected_improvement != nullptr;
+      std::vector<double> grad_mean(compute_gradients ? dim_ : 0);
+      std::vector<double> grad_variance(compute_gradients ? dim_ : 0);
+      double mean;
+      double variance;
+      PredictPoint(points + i*dim_, rule, num_experts, &mean, &variance,
+                   compute_gradients ? grad_mean.data() : nullptr, compute_gradients ? grad_variance.data() : nullptr);
+      variance = std::fmax(variance, OnePotentialSampleExpectedImprovementEvaluator::kMinimumVarianceGradEI);
+
+      const boost::math::normal_distribution<double> normal(0.0, 1.0);
+      const double sigma = std::sqrt(variance);
+      const double mu_diff = best_so_far - mean;
+      const double z = mu_diff/sigma;
+      const double cdf_z = boost::math::cdf(normal, z);
+      const double pdf_z = boost::math::pdf(normal, z);
+      expected_improvement[i] = mu_diff*cdf_z + sigma*pdf_z;
+      for (int d = 0; d < (compute_gradients ? dim_ : 0); ++d) {
+        grad_expected_improvement[i*dim_ + d] = -cdf_z*grad_mean[d] + pdf_z*grad_variance[d]/(2.0*sigma);
+      }
+    });
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,236 @@
+/*!
+  \file gpp_partitioned_gaussian_process.hpp
+  \rst
+  1. OVERVIEW
+  2. PARTITION
+  3. COMBINING EXPERTS
+
+  **1. OVERVIEW**
+
+  A GaussianProcess over ``N`` points costs ``O(N^3)`` to factor, ``O(N^2)`` memory, and ``O(N)`` (mean) to ``O(N^2)``
+  (variance) per prediction, which rules out the dense model somewhere past ``N ~ 10^4``.  PartitionedGaussianProcess
+  ("local experts") splits ``points_sampled`` into spatial regions of at most ``max_region_size`` points and fits one
+  small GaussianProcess per region (same covariance, noise, and derivative observations), so fitting costs
+  ``O(N * max_region_size^2)`` and a prediction touches only a few regions.
+
+  Each expert is an ordinary GaussianProcess, so ``expert(FindRegion(x))`` can be handed to the existing evaluators
+  (ExpectedImprovementEvaluator, PosteriorMeanEvaluator, ...) for a nearest-region model around ``x``.  The combined
+  predictions below are for callers that range over several regions.
+
+  Each expert has its own constant prior mean (the mean of its region's values), so far from its region an expert
+  reverts to a local mean with the prior variance; the combination rule below weights it out accordingly.
+
+  **2. PARTITION**
+
+  Regions are the leaves of a k-d tree: a node with more than ``max_region_size`` points is split at the median of its
+  points along the dimension in which their bounding box is widest.  Regions hold between ``max_region_size/2`` and
+  ``max_region_size`` points (unless ``num_sampled`` is smaller), and FindRegion() descends the tree in ``O(log N)``.
+  Every region also keeps its points' bounding box, for finding the regions nearest to a point.
+
+  **3. COMBINING EXPERTS**
+
+  With ExpertCombinationRule::kNearestRegion, a prediction at ``x`` is the prediction of the expert whose region
+  contains ``x`` (the tree's leaf; outside the data, the leaf on ``x``'s side of every split).  The mean jumps across
+  region boundaries, so gradients are those of that expert alone.
+
+  With ExpertCombinationRule::kProductOfExperts, the ``num_experts`` regions nearest ``x`` (its own region first, then by
+  distance to their bounding boxes) are combined by a generalized product of experts with equal weights
+  ``\beta = 1/num_experts``:
+
+  | ``P = \sum_k \beta / \sigma_k^2``,  ``\sigma^2 = 1 / P``
+  | ``\mu = \sigma^2 * \sum_k \beta * \mu_k / \sigma_k^2``
+
+  so confident (nearby) experts dominate and an expert far from its data, with variance near the prior's, contributes
+  little.  With one region this reduces to the single GaussianProcess.  The set of experts changes where the
+  nearest-region ordering does, so the combined mean is smooth only between such switches; gradients hold the set
+  fixed.
+
+  Predictions at different points are independent and are spread over threads; results do not depend on the number of
+  threads.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_math.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  How PartitionedGaussianProcess combines its experts' predictions; see gpp_partitioned_gaussian_process.hpp, section 3.
+\endrst*/
+enum class ExpertCombinationRule {
+  //! the expert of the region containing the point
+  kNearestRegion = 0,
+  //! generalized product of the ``num_experts`` nearest experts
+  kProductOfExperts = 1,
+};
+
+/*!\rst
+  A GP over a large ``points_sampled``, as a k-d tree of regions with one small GaussianProcess ("expert") per region;
+  see the file comments.  Immutable after construction, so the const methods may be called concurrently.
+\endrst*/
+class PartitionedGaussianProcess final {
+ public:
+  PartitionedGaussianProcess() = delete;
+
+  /*!\rst
+    Partitions ``points_sampled`` and builds (factors) every region's GaussianProcess.
+
+    \param
+      :covariance: the covariance shared by every expert
+      :points_sampled[dim][num_sampled]: points that have already been sampled
+      :points_sampled_value[num_sampled*(num_derivatives+1)]: values (and observed derivatives) at points_sampled
+      :noise_variance[num_derivatives+1]: the ``\sigma_n^2`` (noise variance) of the values and of each derivative
+      :derivatives[num_derivatives]: indices of the dimensions whose derivatives are observed
+      :num_derivatives: number of derivatives observed at each point
+      :dim: the spatial dimension of a point
+      :num_sampled: number of already-sampled points, >= 1
+      :max_region_size: largest number of points per region, >= 1
+      :max_num_threads: maximum number of threads to build the experts with
+    \raise
+      LowerBoundException if ``num_sampled < 1`` or ``max_region_size < 1``;
+      SingularMatrixException if some region's covariance matrix is singular
+  \endrst*/
+  PartitionedGaussianProcess(const CovarianceInterface& covariance, double const * restrict points_sampled,
+                             double const * restrict points_sampled_value, double const * restrict noise_variance,
+                             int const * restrict derivatives, int num_derivatives, int dim, int num_sampled,
+                             int max_region_size, int max_num_threads);
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_sampled() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_sampled_;
+  }
+
+  int num_regions() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return static_cast<int>(experts_.size());
+  }
+
+  //! the GaussianProcess of ``region``, over that region's points
+  const GaussianProcess& expert(int region) const noexcept OL_WARN_UNUSED_RESULT {
+    return *experts_[region];
+  }
+
+  //! indices (into the constructor's ``points_sampled``) of the points of ``region``
+  const std::vector<int>& region_point_indices(int region) const noexcept OL_WARN_UNUSED_RESULT {
+    return region_point_indices_[region];
+  }
+
+  /*!\rst
+    \param
+      :point[dim]: any point
+    \return
+      the region containing ``point`` (the k-d tree leaf it descends to)
+  \endrst*/
+  int FindRegion(double const * restrict point) const noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Computes the combined mean and variance (and optionally their gradients) at each of ``points``.
+
+    \param
+      :points[dim][num_points]: points at which to predict
+      :num_points: number of points
+      :rule: how to combine the experts
+      :num_experts: number of experts combined by ExpertCombinationRule::kProductOfExperts (clamped to
+        ``[1, num_regions()]``); ignored by kNearestRegion
+      :max_num_threads: maximum number of threads
+    \output
+      :mean[num_points]: mean at each point
+      :variance[num_points]: variance at each point
+      :grad_mean[num_points][dim]: gradient of each mean wrt its point; nullptr to skip
+      :grad_variance[num_points][dim]: gradient of each variance wrt its point; nullptr to skip
+  \endrst*/
+  void ComputeMeanAndVariance(double const * restrict points, int num_points, ExpertCombinationRule rule,
+                              int num_experts, int max_num_threads, double * restrict mean,
+                              double * restrict variance, double * restrict grad_mean,
+                              double * restrict grad_variance) const;
+
+  /*!\rst
+    Computes analytic 1,0-EI (and optionally its gradient) of the combined prediction at each of ``points``, as
+    OnePotentialSampleExpectedImprovementEvaluator does for a GaussianProcess.
+
+    \param
+      :points[dim][num_points]: points at which to evaluate EI
+      :num_points: number of points
+      :best_so_far: best (smallest) objective value seen so far
+      :rule: how to combine the experts
+      :num_experts: see ComputeMeanAndVariance()
+      :max_num_threads: maximum number of threads
+    \output
+      :expected_improvement[num_points]: EI at each point
+      :grad_expected_improvement[num_points][dim]: gradient of each EI wrt its point; nullptr to skip
+  \endrst*/
+  void ComputeExpectedImprovement(double const * restrict points, int num_points, double best_so_far,
+                                  ExpertCombinationRule rule, int num_experts, int max_num_threads,
+                                  double * restrict expected_improvement,
+                                  double * restrict grad_expected_improvement) const;
+
+ private:
+  //! a k-d tree node: a split (``region < 0``) or a leaf holding ``region``
+  struct Node {
+    //! dimension of the split
+    int split_dim;
+    //! points with ``x[split_dim] < split_value`` go to ``left``, the rest to ``right``
+    double split_value;
+    //! index of the left child node
+    int left;
+    //! index of the right child node
+    int right;
+    //! index of the region of a leaf; -1 for splits
+    int region;
+  };
+
+  /*!\rst
+    Builds the subtree over ``indices[begin, end)`` (reordering them) and returns its root node's index.
+  \endrst*/
+  int BuildNode(double const * restrict points_sampled, int max_region_size, int begin, int end,
+                std::vector<int> * indices);
+
+  /*!\rst
+    Squared euclidean distance from ``point`` to the bounding box of ``region``'s points (0 inside it).
+  \endrst*/
+  double DistanceSquaredToRegion(double const * restrict point, int region) const noexcept OL_PURE_FUNCTION
+      OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    The experts combined at ``point``: its own region, then the ``num_experts - 1`` regions with the nearest bounding boxes.
+
+    \output
+      :regions[num_experts]: the regions, own region first
+  \endrst*/
+  void SelectExperts(double const * restrict point, int num_experts, int * restrict regions) const;
+
+  /*!\rst
+    Combined mean and variance (and optionally their gradients) at one point; see ComputeMeanAndVariance().
+  \endrst*/
+  void PredictPoint(double const * restrict point, ExpertCombinationRule rule, int num_experts,
+                    double * restrict mean, double * restrict variance, double * restrict grad_mean,
+                    double * restrict grad_variance) const;
+
+  //! spatial dimension
+  int dim_;
+  //! total number of points over all regions
+  int num_sampled_;
+  //! k-d tree nodes; the root is node 0
+  std::vector<Node> nodes_;
+  //! ``[num_regions]`` indices of each region's points
+  std::vector<std::vector<int>> region_point_indices_;
+  //! ``[num_regions][dim]`` lower corners of the regions' bounding boxes
+  std::vector<double> region_lower_;
+  //! ``[num_regions][dim]`` upper corners of the regions' bounding boxes
+  std::vector<double> region_upper_;
+  //! ``[num_regions]`` one GaussianProcess per region
+  std::vector<std::unique_ptr<GaussianProcess>> experts_;
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_HPP_
@@ -0,0 +1,363 @@
+/*!
+  \file gpp_partitioned_gaussian_process_test.cpp
+  \rst
+  Routines to test the functions in gpp_partitioned_gaussian_process.cpp:
+
+  * with one region, PartitionedGaussianProcess's mean, variance, EI, and their gradients match the GaussianProcess
+    (and OnePotentialSampleExpectedImprovementEvaluator) over the same data, under both combination rules;
+  * the k-d tree assigns every point to exactly one region of at most ``max_region_size`` points, each expert holds its
+    region's data (points, values, and derivative observations), FindRegion() finds the region of every training
+    point, and nearest-region predictions are that expert's; and
+  * product-of-experts gradients (mean, variance, EI) match finite differences, and no result depends on the number of
+    threads.
+\endrst*/
+
+#include "gpp_partitioned_gaussian_process_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_partitioned_gaussian_process.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Training data in ``[-2, 2]^dim``: values of ``f(x) = \sum_d sin(x_d + d)`` and, if ``num_derivatives = 1``, observations
+  of ``\partial f / \partial x_0``; plus ``num_points`` random prediction points in the same box.
+\endrst*/
+struct PartitionedProblem {
+  PartitionedProblem(int dim_in, int num_sampled_in, int num_derivatives_in, int num_points_in,
+                     UniformRandomGenerator * uniform_generator)
+      : dim(dim_in),
+        num_sampled(num_sampled_in),
+        num_derivatives(num_derivatives_in),
+        num_points(num_points_in),
+        derivatives(num_derivatives, 0),
+        noise_variance(1 + num_derivatives, 1.0e-2),
+        lengths(dim),
+        points_sampled(num_sampled*dim),
+        points_sampled_value(num_sampled*(1 + num_derivatives)),
+        points(num_points*dim) {
+    boost::uniform_real<double> uniform_double(-2.0, 2.0);
+    for (int d = 0; d < dim; ++d) {
+      lengths[d] = 0.6 + 0.2*d;
+    }
+    for (auto& coordinate : points_sampled) {
+      coordinate = uniform_double(uniform_generator->engine);
+    }
+    for (auto& coordinate : points) {
+      coordinate = uniform_double(uniform_generator->engine);
+    }
+    for (int i = 0; i < num_sampled; ++i) {
+      double value = 0.0;
+      for (int d = 0; d < dim; ++d) {
+        value += std::sin(points_sampled[i*dim + d] + d);
+      }
+      points_sampled_value[i*(1 + num_derivatives)] = value;
+      if (num_derivatives == 1) {
+        points_sampled_value[i*(1 + num_derivatives) + 1] = std::cos(points_sampled[i*dim]);
+      }
+    }
+  }
+
+  PartitionedGaussianProcess BuildPartitionedGaussianProcess(int max_region_size, int max_num_threads) const {
+    SquareExponential covariance(dim, 1.5, lengths.data());
+    return PartitionedGaussianProcess(covariance, points_sampled.data(), points_sampled_value.data(),
+                                      noise_variance.data(), derivatives.data(), num_derivatives, dim, num_sampled,
+                                      max_region_size, max_num_threads);
+  }
+
+  int dim;
+  int num_sampled;
+  int num_derivatives;
+  int num_points;
+  std::vector<int> derivatives;
+  std::vector<double> noise_variance;
+  std::vector<double> lengths;
+  std::vector<double> points_sampled;
+  std::vector<double> points_sampled_value;
+  std::vector<double> points;
+};
+
+/*!\rst
+  Checks a one-region PartitionedGaussianProcess (``max_region_size >= num_sampled``) against the GaussianProcess over
+  the same data: mean, variance, and their gradients against PointsToSampleState, and EI and its gradient against
+  OnePotentialSampleExpectedImprovementEvaluator.  Both combination rules, 1 and several threads.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int PartitionedSingleRegionTest() {
+  int total_errors = 0;
+  const double tolerance = 1.0e-12;
+  UniformRandomGenerator uniform_generator(8128);
+  PartitionedProblem problem(3, 30, 1, 12, &uniform_generator);
+  const int dim = problem.dim;
+  const int num_points = problem.num_points;
+  const double best_so_far = 0.5;
+
+  SquareExponential covariance(dim, 1.5, problem.lengths.data());
+  GaussianProcess gaussian_process(covariance, problem.points_sampled.data(), problem.points_sampled_value.data(),
+                                   problem.noise_variance.data(), problem.derivatives.data(), problem.num_derivatives,
+                                   dim, problem.num_sampled);
+  OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
+
+  for (int max_num_threads : {1, 4}) {
+    PartitionedGaussianProcess partitioned_gaussian_process =
+        problem.BuildPartitionedGaussianProcess(problem.num_sampled, max_num_threads);
+    if (partitioned_gaussian_process.num_regions() != 1) {
+      OL_ERROR_PRINTF("expected 1 region, got %d\n", partitioned_gaussian_process.num_regions());
+      ++total_errors;
+      continue;
+    }
+
+    for (auto rule : {ExpertCombinationRule::kNearestRegion, ExpertCombinationRule::kProductOfExperts}) {
+      std::vector<double> mean(num_points), variance(num_points);
+      std::vector<double> grad_mean(num_points*dim), grad_variance(num_points*dim);
+      std::vector<double> expected_improvement(num_points), grad_expected_improvement(num_points*dim);
+      partitioned_gaussian_process.ComputeMeanAndVariance(problem.points.data(), num_points, rule, 3, max_num_threads,
+                                                          mean.data(), variance.data(), grad_mean.data(),
+                                                          grad_variance.data());
+      partitioned_gaussian_process.ComputeExpectedImprovement(problem.points.data(), num_points, best_so_far, rule, 3,
+                                                              max_num_threads, expected_improvement.data(),
+                                                              grad_expected_improvement.data());
+
+      for (int i = 0; i < num_points; ++i) {
+        double const * point = problem.points.data() + i*dim;
+        PointsToSampleState points_to_sample_state(gaussian_process, point, 1, nullptr, 0, 1, true);
+        double mean_truth, variance_truth;
+        std::vector<double> grad_mean_truth(dim), grad_variance_truth(dim);
+        gaussian_process.ComputeMeanOfPoints(points_to_sample_state, &mean_truth);
+        gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, &variance_truth);
+        gaussian_process.ComputeGradMeanOfPoints(points_to_sample_state, grad_mean_truth.data());
+        gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, grad_variance_truth.data());
+
+        OnePotentialSampleExpectedImprovementState ei_state(ei_evaluator, point, true);
+        std::vector<double> grad_ei_truth(dim);
+        const double ei_truth = ei_evaluator.ComputeExpectedImprovement(&ei_state);
+        ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_ei_truth.data());
+
+        if (!CheckDoubleWithinRelative(mean[i], mean_truth, tolerance) ||
+            !CheckDoubleWithinRelative(variance[i], variance_truth, tolerance) ||
+            !CheckDoubleWithinRelative(expected_improvement[i], ei_truth, tolerance)) {
+          OL_ERROR_PRINTF("point %d: mean %.18E (truth %.18E), variance %.18E (truth %.18E), EI %.18E (truth %.18E)\n",
+                          i, mean[i], mean_truth, variance[i], variance_truth, expected_improvement[i], ei_truth);
+          ++total_errors;
+        }
+        for (int d = 0; d < dim; ++d) {
+          if (!CheckDoubleWithinRelative(grad_mean[i*dim + d], grad_mean_truth[d], tolerance) ||
+              !CheckDoubleWithinRelative(grad_variance[i*dim + d], grad_variance_truth[d], tolerance) ||
+              !CheckDoubleWithinRelative(grad_expected_improvement[i*dim + d], grad_ei_truth[d], 1.0e-10)) {
+            ++total_errors;
+          }
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the partition of a multi-region PartitionedGaussianProcess (with derivative observations), its nearest-region
+  predictions, and that no prediction depends on the number of threads.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int PartitionedRegionTest() {
+  int total_errors = 0;
+  const int max_region_size = 40;
+  UniformRandomGenerator uniform_generator(4096);
+  PartitionedProblem problem(3, 300, 1, 25, &uniform_generator);
+  const int dim = problem.dim;
+  const int num_points = problem.num_points;
+  const int values_per_point = 1 + problem.num_derivatives;
+  PartitionedGaussianProcess partitioned_gaussian_process =
+      problem.BuildPartitionedGaussianProcess(max_region_size, 4);
+  const int num_regions = partitioned_gaussian_process.num_regions();
+  if (num_regions < problem.num_sampled/max_region_size) {
+    OL_ERROR_PRINTF("only %d regions\n", num_regions);
+    ++total_errors;
+  }
+
+  std::vector<int> num_times_assigned(problem.num_sampled, 0);
+  for (int region = 0; region < num_regions; ++region) {
+    const std::vector<int>& point_indices = partitioned_gaussian_process.region_point_indices(region);
+    const GaussianProcess& expert = partitioned_gaussian_process.expert(region);
+    const int region_size = point_indices.size();
+    if (region_size < max_region_size/2 || region_size > max_region_size || expert.num_sampled() != region_size) {
+      OL_ERROR_PRINTF("region %d has %d points\n", region, region_size);
+      ++total_errors;
+    }
+    for (int i = 0; i < region_size; ++i) {
+      const int index = point_indices[i];
+      ++num_times_assigned[index];
+      for (int d = 0; d < dim; ++d) {
+        if (expert.points_sampled()[i*dim + d] != problem.points_sampled[index*dim + d]) {
+          ++total_errors;
+        }
+      }
+      for (int m = 0; m < values_per_point; ++m) {
+        if (expert.points_sampled_value()[i*values_per_point + m] !=
+            problem.points_sampled_value[index*values_per_point + m]) {
+          ++total_errors;
+        }
+      }
+      if (partitioned_gaussian_process.FindRegion(problem.points_sampled.data() + index*dim) != region) {
+        OL_ERROR_PRINTF("point %d is in region %d but FindRegion() gives %d\n", index, region,
+                        partitioned_gaussian_process.FindRegion(problem.points_sampled.data() + index*dim));
+        ++total_errors;
+      }
+    }
+  }
+  for (int i = 0; i < problem.num_sampled; ++i) {
+    if (num_times_assigned[i] != 1) {
+      OL_ERROR_PRINTF("point %d is in %d regions\n", i, num_times_assigned[i]);
+      ++total_errors;
+    }
+  }
+
+  std::vector<double> mean(num_points), variance(num_points);
+  partitioned_gaussian_process.ComputeMeanAndVariance(problem.points.data(), num_points,
+                                                      ExpertCombinationRule::kNearestRegion, 1, 4, mean.data(),
+                                                      variance.data(), nullptr, nullptr);
+  for (int i = 0; i < num_points; ++i) {
+    double const * point = problem.points.data() + i*dim;
+    const GaussianProcess& expert = partitioned_gaussian_process.expert(partitioned_gaussian_process.FindRegion(point));
+    PointsToSampleState points_to_sample_state(expert, point, 1, nullptr, 0, 0, false);
+    double mean_truth, variance_truth;
+    expert.ComputeMeanOfPoints(points_to_sample_state, &mean_truth);
+    expert.ComputeVarianceOfPoints(&points_to_sample_state, nullptr, 0, &variance_truth);
+    if (!CheckDoubleWithinRelative(mean[i], mean_truth, 0.0) ||
+        !CheckDoubleWithinRelative(variance[i], variance_truth, 0.0)) {
+      OL_ERROR_PRINTF("point %d: nearest-region mean %.18E (expert %.18E), variance %.18E (expert %.18E)\n", i,
+                      mean[i], mean_truth, variance[i], variance_truth);
+      ++total_errors;
+    }
+  }
+
+  for (auto rule : {ExpertCombinationRule::kNearestRegion, ExpertCombinationRule::kProductOfExperts}) {
+    std::vector<double> expected_improvement(num_points), grad_expected_improvement(num_points*dim);
+    std::vector<double> expected_improvement_threaded(num_points), grad_expected_improvement_threaded(num_points*dim);
+    partitioned_gaussian_process.ComputeExpectedImprovement(problem.points.data(), num_points, -1.0, rule, 4, 1,
+                                                            expected_improvement.data(),
+                                                            grad_expected_improvement.data());
+    partitioned_gaussian_process.ComputeExpectedImprovement(problem.points.data(), num_points, -1.0, rule, 4, 4,
+                                                            expected_improvement_threaded.data(),
+                                                            grad_expected_improvement_threaded.data());
+    if (expected_improvement_threaded != expected_improvement ||
+        grad_expected_improvement_threaded != grad_expected_improvement) {
+      OL_ERROR_PRINTF("partitioned EI depends on the number of threads\n");
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the product-of-experts gradients of the mean, variance, and EI against central finite differences.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int PartitionedProductOfExpertsGradientTest() {
+  int total_errors = 0;
+  const double h = 1.0e-6;
+  const double tolerance = 1.0e-5;
+  const int num_experts = 3;
+  const double best_so_far = -0.5;
+  UniformRandomGenerator uniform_generator(65537);
+  PartitionedProblem problem(2, 160, 0, 20, &uniform_generator);
+  const int dim = problem.dim;
+  PartitionedGaussianProcess partitioned_gaussian_process = problem.BuildPartitionedGaussianProcess(20, 4);
+  const ExpertCombinationRule rule = ExpertCombinationRule::kProductOfExperts;
+
+  for (int i = 0; i < problem.num_points; ++i) {
+    std::vector<double> point(problem.points.begin() + i*dim, problem.points.begin() + (i + 1)*dim);
+    double mean, variance, expected_improvement;
+    std::vector<double> grad_mean(dim), grad_variance(dim), grad_expected_improvement(dim);
+    partitioned_gaussian_process.ComputeMeanAndVariance(point.data(), 1, rule, num_experts, 1, &mean, &variance,
+                                                        grad_mean.data(), grad_variance.data());
+    partitioned_gaussian_process.ComputeExpectedImprovement(point.data(), 1, best_so_far, rule, num_experts, 1,
+                                                            &expected_improvement, grad_expected_improvement.data());
+
+    for (int d = 0; d < dim; ++d) {
+      double mean_p, mean_m, variance_p, variance_m, ei_p, ei_m;
+      const double coordinate = point[d];
+      point[d] = coordinate + h;
+      partitioned_gaussian_process.ComputeMeanAndVariance(point.data(), 1, rule, num_experts, 1, &mean_p,
+                                                          &variance_p, nullptr, nullptr);
+      partitioned_gaussian_process.ComputeExpectedImprovement(point.data(), 1, best_so_far, rule, num_experts, 1,
+                                                              &ei_p, nullptr);
+      point[d] = coordinate - h;
+      partitioned_gaussian_process.ComputeMeanAndVariance(point.data(), 1, rule, num_experts, 1, &mean_m,
+                                                          &variance_m, nullptr, nullptr);
+      partitioned_gaussian_process.ComputeExpectedImprovement(point.data(), 1, best_so_far, rule, num_experts, 1,
+                                                              &ei_m, nullptr);
+      point[d] = coordinate;
+
+      const double grad_mean_fd = (mean_p - mean_m)/(2.0*h);
+      const double grad_variance_fd = (variance_p - variance_m)/(2.0*h);
+      const double grad_ei_fd = (ei_p - ei_m)/(2.0*h);
+      if (!CheckDoubleWithinRelative(grad_mean[d], grad_mean_fd, tolerance) ||
+          !CheckDoubleWithinRelative(grad_variance[d], grad_variance_fd, tolerance) ||
+          !CheckDoubleWithinRelative(grad_expected_improvement[d], grad_ei_fd, tolerance)) {
+        OL_ERROR_PRINTF("point %d, dim %d: grad mean %.18E (fd %.18E), grad var %.18E (fd %.18E), "
+                        "grad EI %.18E (fd %.18E)\n", i, d, grad_mean[d], grad_mean_fd, grad_variance[d],
+                        grad_variance_fd, grad_expected_improvement[d], grad_ei_fd);
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunPartitionedGaussianProcessTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = PartitionedSingleRegionTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("partitioned GP single region failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("partitioned GP single region\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = PartitionedRegionTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("partitioned GP regions failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("partitioned GP regions\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = PartitionedProductOfExpertsGradientTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("partitioned GP product of experts gradients failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("partitioned GP product of experts gradients\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
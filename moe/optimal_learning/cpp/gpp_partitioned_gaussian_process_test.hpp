@@ -0,0 +1,26 @@
+/*!
+  \file gpp_partitioned_gaussian_process_test.hpp
+  \rst
+  Functions for testing gpp_partitioned_gaussian_process's functionality: the k-d tree partition is consistent, a
+  one-region PartitionedGaussianProcess matches the plain GaussianProcess, and the combined predictions' gradients match
+  finite differences, independent of the number of threads.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the partitioned GP tests.
+
+  \return
+    number of test failures: 0 if PartitionedGaussianProcess is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunPartitionedGaussianProcessTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PARTITIONED_GAUSSIAN_PROCESS_TEST_HPP_
@@ -0,0 +1,345 @@
+/*!
+  \file gpp_posterior_sample.cpp
+  \rst
+  Implementation of PosteriorSamplePath, SampleGlobalOptimaViaPathwiseSamples() and
+  ComputeThompsonSamplingPointsToSample(); see gpp_posterior_sample.hpp for the math.  All of the optima searches go
+  through SampleOptimaOfPosteriorSamplePaths(), which draws each path from one of a list of GPs.
+
+  The L-BFGS-B refinement goes through a small (Evaluator, State) pair local to this file that negates the path, since
+  the optimizers in gpp_optimization.hpp maximize and sampled optima are minima.
+\endrst*/
+
+#include "gpp_posterior_sample.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_linear_algebra.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! number of points per CovarianceInterface::CovarianceMatrix() call in PosteriorSamplePath::EvaluateAtPointList()
+constexpr int kPosteriorSampleBlockSize = 64;
+
+struct PosteriorSamplePathState;
+
+/*!\rst
+  Objective ``-f(x)`` for a PosteriorSamplePath ``f``, so that the (maximizing) optimizers find minima of the path.
+\endrst*/
+class NegatedPosteriorSamplePathEvaluator final {
+ public:
+  using StateType = PosteriorSamplePathState;
+
+  explicit NegatedPosteriorSamplePathEvaluator(const PosteriorSamplePath& sample_path)
+      : sample_path_(sample_path) {
+  }
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return sample_path_.dim();
+  }
+
+  double ComputeObjectiveFunction(StateType * sample_path_state) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  void ComputeGradObjectiveFunction(StateType * sample_path_state,
+                                    double * restrict grad_objective) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(NegatedPosteriorSamplePathEvaluator);
+
+ private:
+  //! the path being minimized
+  const PosteriorSamplePath& sample_path_;
+};
+
+//! the point at which NegatedPosteriorSamplePathEvaluator is evaluated
+struct PosteriorSamplePathState final {
+  using EvaluatorType = NegatedPosteriorSamplePathEvaluator;
+
+  PosteriorSamplePathState(const EvaluatorType& sample_path_eval, double const * restrict current_point_in)
+      : dim(sample_path_eval.dim()),
+        current_point(current_point_in, current_point_in + dim) {
+  }
+
+  PosteriorSamplePathState(PosteriorSamplePathState&& OL_UNUSED(other)) = default;
+
+  int GetProblemSize() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim;
+  }
+
+  void GetCurrentPoint(double * restrict current_point_in) const noexcept OL_NONNULL_POINTERS {
+    std::copy(current_point.begin(), current_point.end(), current_point_in);
+  }
+
+  void SetCurrentPoint(const EvaluatorType& OL_UNUSED(sample_path_eval),
+                       double const * restrict current_point_in) noexcept OL_NONNULL_POINTERS {
+    std::copy(current_point_in, current_point_in + dim, current_point.begin());
+  }
+
+  //! spatial dimension
+  const int dim;
+  //! the point at which to evaluate the path
+  std::vector<double> current_point;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PosteriorSamplePathState);
+};
+
+double NegatedPosteriorSamplePathEvaluator::ComputeObjectiveFunction(StateType * sample_path_state) const {
+  return -sample_path_.Evaluate(sample_path_state->current_point.data());
+}
+
+void NegatedPosteriorSamplePathEvaluator::ComputeGradObjectiveFunction(StateType * sample_path_state,
+                                                                       double * restrict grad_objective) const {
+  sample_path_.EvaluateGradient(sample_path_state->current_point.data(), grad_objective);
+  for (int d = 0; d < sample_path_state->dim; ++d) {
+    grad_objective[d] = -grad_objective[d];
+  }
+}
+
+/*!\rst
+  Draws ``num_optima`` posterior sample paths and finds the minimum of each; draw ``i`` samples
+  ``gaussian_processes[i % num_gaussian_processes]``.  See SampleGlobalOptimaViaPathwiseSamples() for the search and
+  for the parameters.
+
+  \param
+    :gaussian_processes[num_gaussian_processes]: GPs to sample, all with the same dim
+    :num_gaussian_processes: number of GPs, >= 1
+    (the rest as in SampleGlobalOptimaViaPathwiseSamples())
+  \output
+    :points_optima[dim][num_optima]: one sampled optimum per draw
+\endrst*/
+void SampleOptimaOfPosteriorSamplePaths(GaussianProcess const * const * gaussian_processes, int num_gaussian_processes,
+                                        int num_optima, int num_features, int num_candidates,
+                                        const LBFGSBParameters& lbfgsb_parameters, const TensorProductDomain& domain,
+                                        int max_num_threads, UniformRandomGenerator::EngineType::result_type seed,
+                                        double * restrict points_optima) {
+  if (unlikely(num_gaussian_processes < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Sampling optima needs at least one GP.", num_gaussian_processes, 1);
+  }
+  if (unlikely(num_candidates < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Sampling optima needs at least one candidate point.",
+                       num_candidates, 1);
+  }
+  const int dim = gaussian_processes[0]->dim();
+  const int num_refined = std::max(1, std::min(lbfgsb_parameters.num_multistarts, num_candidates));
+
+  ParallelForEachIndex(max_num_threads, num_optima, [&](int i) {
+      // every draw owns its generators, so results do not depend on which thread runs it
+      UniformRandomGenerator uniform_generator(seed + i);
+      NormalRNG normal_rng(uniform_generator.GetEngine()());
+      PosteriorSamplePath sample_path(*gaussian_processes[i % num_gaussian_processes], num_features, &normal_rng);
+
+      std::vector<double> candidates(num_candidates*dim);
+      std::vector<double> candidate_values(num_candidates);
+      domain.GenerateUniformPointsInDomain(num_candidates, &uniform_generator, candidates.data());
+      sample_path.EvaluateAtPointList(candidates.data(), num_candidates, candidate_values.data());
+
+      std::vector<int> order(num_candidates);
+      std::iota(order.begin(), order.end(), 0);
+      std::partial_sort(order.begin(), order.begin() + num_refined, order.end(), [&candidate_values](int a, int b) {
+          return candidate_values[a] < candidate_values[b];
+        });
+
+      double * restrict optimum = points_optima + i*dim;
+      std::copy(candidates.begin() + order[0]*dim, candidates.begin() + (order[0] + 1)*dim, optimum);
+      double best_value = candidate_values[order[0]];
+      if (lbfgsb_parameters.max_num_steps > 0) {
+        NegatedPosteriorSamplePathEvaluator sample_path_evaluator(sample_path);
+        LBFGSBOptimizer<NegatedPosteriorSamplePathEvaluator, TensorProductDomain> lbfgsb_optimizer;
+        for (int k = 0; k < num_refined; ++k) {
+          PosteriorSamplePathState sample_path_state(sample_path_evaluator, candidates.data() + order[k]*dim);
+          lbfgsb_optimizer.Optimize(sample_path_evaluator, lbfgsb_parameters, domain, &sample_path_state);
+          const double value = sample_path.Evaluate(sample_path_state.current_point.data());
+          if (value < best_value) {
+            best_value = value;
+            std::copy(sample_path_state.current_point.begin(), sample_path_state.current_point.end(), optimum);
+          }
+        }
+      }
+    });
+}
+
+}  // end unnamed namespace
+
+PosteriorSamplePath::PosteriorSamplePath(const GaussianProcess& gaussian_process, int num_features,
+                                         NormalRNGInterface * normal_rng)
+    : dim_(gaussian_process.dim()),
+      num_features_(num_features),
+      num_sampled_(gaussian_process.num_sampled()),
+      num_derivatives_(gaussian_process.num_derivatives()),
+      mean_(gaussian_process.get_mean()),
+      covariance_ptr_(gaussian_process.covariance_ptr_->Clone()),
+      points_sampled_(gaussian_process.points_sampled()),
+      derivatives_(gaussian_process.derivatives()),
+      update_weights_(num_sampled_*(1 + num_derivatives_)) {
+  if (unlikely(num_features < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Posterior sample paths need at least one feature.", num_features, 1);
+  }
+  if (unlikely(gaussian_process.is_sparse())) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Posterior sample paths do not support sparse (FITC) GPs.");
+  }
+  if (unlikely(gaussian_process.is_grid())) {
+    OL_THROW_EXCEPTION(OptimalLearningException, "Posterior sample paths do not support grid (Kronecker) GPs.");
+  }
+
+  frequencies_.resize(dim_*num_features_);
+  feature_weights_.resize(2*num_features_);
+  const double alpha = covariance_ptr_->SampleSpectralFrequencies(num_features_, normal_rng, frequencies_.data());
+  normal_rng->Fill(feature_weights_.data(), 2*num_features_);
+  const double feature_scale = std::sqrt(alpha/num_features_);
+  for (auto& weight : feature_weights_) {
+    weight *= feature_scale;
+  }
+
+  // residual of the prior draw against the (noise-perturbed) observations: y - \mu - \phi(X)^T \theta - \epsilon
+  const std::vector<double>& points_sampled_value = gaussian_process.points_sampled_value();
+  const std::vector<double>& noise_variance = gaussian_process.noise_variance();
+  std::vector<double> grad_prior(dim_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    double const * restrict observation = points_sampled_value.data() + i*(1 + num_derivatives_);
+    double * restrict residual = update_weights_.data() + i*(1 + num_derivatives_);
+    const double prior = EvaluatePrior(points_sampled_.data() + i*dim_,
+                                       num_derivatives_ > 0 ? grad_prior.data() : nullptr);
+    residual[0] = observation[0] - mean_ - prior;
+    for (int k = 0; k < num_derivatives_; ++k) {
+      residual[k + 1] = observation[k + 1] - grad_prior[derivatives_[k]];
+    }
+    for (int m = 0; m < 1 + num_derivatives_; ++m) {
+      residual[m] -= std::sqrt(noise_variance[m])*(*normal_rng)();
+    }
+  }
+  // masked derivatives (see GaussianProcess::SetDerivativeMask()) carry no information and may hold anything
+  const std::vector<int>& derivative_mask = gaussian_process.derivative_mask();
+  for (int i = 0; i < static_cast<int>(derivative_mask.size()); ++i) {
+    if (derivative_mask[i] == 0) {
+      update_weights_[(i/num_derivatives_)*(1 + num_derivatives_) + 1 + i % num_derivatives_] = 0.0;
+    }
+  }
+  if (num_sampled_ > 0) {
+    if (gaussian_process.is_cholesky_packed()) {
+      PackedCholeskyFactorLMatrixVectorSolve(gaussian_process.get_K_chol().data(), update_weights_.size(),
+                                             update_weights_.data());
+    } else {
+      CholeskyFactorLMatrixVectorSolve(gaussian_process.get_K_chol().data(), update_weights_.size(),
+                                       update_weights_.data());
+    }
+  }
+}
+
+double PosteriorSamplePath::EvaluatePrior(double const * restrict point, double * restrict grad_prior) const {
+  if (grad_prior != nullptr) {
+    std::fill(grad_prior, grad_prior + dim_, 0.0);
+  }
+  double const * restrict cosine_weights = feature_weights_.data();
+  double const * restrict sine_weights = cosine_weights + num_features_;
+  double prior = 0.0;
+  for (int j = 0; j < num_features_; ++j) {
+    double const * restrict frequency = frequencies_.data() + j*dim_;
+    double phase = 0.0;
+    for (int d = 0; d < dim_; ++d) {
+      phase += frequency[d]*point[d];
+    }
+    const double cosine = std::cos(phase);
+    const double sine = std::sin(phase);
+    prior += cosine_weights[j]*cosine + sine_weights[j]*sine;
+    if (grad_prior != nullptr) {
+      const double grad_coefficient = sine_weights[j]*cosine - cosine_weights[j]*sine;
+      for (int d = 0; d < dim_; ++d) {
+        grad_prior[d] += grad_coefficient*frequency[d];
+      }
+    }
+  }
+  return prior;
+}
+
+double PosteriorSamplePath::Evaluate(double const * restrict point) const {
+  double value;
+  EvaluateAtPointList(point, 1, &value);
+  return value;
+}
+
+void PosteriorSamplePath::EvaluateAtPointList(double const * restrict points, int num_points,
+                                              double * restrict values) const {
+  const int num_observations = update_weights_.size();
+  std::vector<double> cross_covariance(std::min(num_points, kPosteriorSampleBlockSize)*num_observations);
+  for (int begin = 0; begin < num_points; begin += kPosteriorSampleBlockSize) {
+    const int block_size = std::min(kPosteriorSampleBlockSize, num_points - begin);
+    for (int p = 0; p < block_size; ++p) {
+      values[begin + p] = mean_ + EvaluatePrior(points + (begin + p)*dim_, nullptr);
+    }
+    if (num_observations > 0) {
+      // values += k(points, X) * update_weights
+      covariance_ptr_->CovarianceMatrix(points + begin*dim_, points_sampled_.data(), dim_, block_size, num_sampled_,
+                                        derivatives_.data(), 0, derivatives_.data(), num_derivatives_,
+                                        cross_covariance.data());
+      GeneralMatrixVectorMultiply(cross_covariance.data(), 'N', update_weights_.data(), 1.0, 1.0, block_size,
+                                  num_observations, block_size, values + begin);
+    }
+  }
+}
+
+void PosteriorSamplePath::EvaluateGradient(double const * restrict point, double * restrict grad_value) const {
+  EvaluatePrior(point, grad_value);
+  std::vector<double> grad_covariance(dim_*(1 + num_derivatives_));
+  for (int i = 0; i < num_sampled_; ++i) {
+    covariance_ptr_->GradCovariance(point, derivatives_.data(), 0, points_sampled_.data() + i*dim_,
+                                    derivatives_.data(), num_derivatives_, grad_covariance.data());
+    double const * restrict update_weights = update_weights_.data() + i*(1 + num_derivatives_);
+    for (int n = 0; n < 1 + num_derivatives_; ++n) {
+      for (int d = 0; d < dim_; ++d) {
+        grad_value[d] += grad_covariance[d + n*dim_]*update_weights[n];
+      }
+    }
+  }
+}
+
+void SampleGlobalOptimaViaPathwiseSamples(const GaussianProcess& gaussian_process, int num_optima, int num_features,
+                                          int num_candidates, const LBFGSBParameters& lbfgsb_parameters,
+                                          const TensorProductDomain& domain, int max_num_threads,
+                                          UniformRandomGenerator::EngineType::result_type seed,
+                                          double * restrict points_optima) {
+  GaussianProcess const * gaussian_processes[1] = {&gaussian_process};
+  SampleOptimaOfPosteriorSamplePaths(gaussian_processes, 1, num_optima, num_features, num_candidates,
+                                     lbfgsb_parameters, domain, max_num_threads, seed, points_optima);
+}
+
+void ComputeThompsonSamplingPointsToSample(const GaussianProcess& gaussian_process, int num_to_sample,
+                                           int num_features, int num_candidates,
+                                           const LBFGSBParameters& lbfgsb_parameters,
+                                           const TensorProductDomain& domain, int max_num_threads,
+                                           UniformRandomGenerator::EngineType::result_type seed,
+                                           double * restrict best_points_to_sample) {
+  SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_to_sample, num_features, num_candidates,
+                                       lbfgsb_parameters, domain, max_num_threads, seed, best_points_to_sample);
+}
+
+void ComputeThompsonSamplingPointsToSample(const GaussianProcessMCMC& gaussian_process_mcmc, int num_to_sample,
+                                           int num_features, int num_candidates,
+                                           const LBFGSBParameters& lbfgsb_parameters,
+                                           const TensorProductDomain& domain, int max_num_threads,
+                                           UniformRandomGenerator::EngineType::result_type seed,
+                                           double * restrict best_points_to_sample) {
+  std::vector<GaussianProcess const *> gaussian_processes(gaussian_process_mcmc.num_mcmc());
+  for (int k = 0; k < gaussian_process_mcmc.num_mcmc(); ++k) {
+    gaussian_processes[k] = &gaussian_process_mcmc.gaussian_process_lst[k];
+  }
+  SampleOptimaOfPosteriorSamplePaths(gaussian_processes.data(), gaussian_processes.size(), num_to_sample,
+                                     num_features, num_candidates, lbfgsb_parameters, domain, max_num_threads, seed,
+                                     best_points_to_sample);
+}
+
+}  // end namespace optimal_learning
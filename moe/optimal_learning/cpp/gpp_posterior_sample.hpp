@@ -0,0 +1,259 @@
+/*!
+  \file gpp_posterior_sample.hpp
+  \rst
+  1. OVERVIEW
+  2. PATHWISE UPDATES
+  3. SAMPLING GLOBAL OPTIMA
+  4. THOMPSON SAMPLING
+
+  **1. OVERVIEW**
+
+  GaussianProcess::SamplePointsFromGP() draws the GP posterior jointly at a fixed list of ``n`` points, which builds and
+  factors the ``n x n`` posterior covariance: ``O(n^3)`` per draw, and the draw exists only at those ``n`` points.
+  PosteriorSamplePath instead draws a whole sample *function* ``f ~ GP | data``, approximately, that can be evaluated
+  (and differentiated) anywhere in ``O(M*dim + N)`` per point, with ``M`` random Fourier features and ``N`` training
+  observations.  So the optimum of one draw can be found on a huge candidate set and refined with a gradient-based
+  optimizer; see SampleGlobalOptimaViaPathwiseSamples().
+
+  **2. PATHWISE UPDATES**
+
+  By Bochner's theorem a stationary covariance is ``k(x, x') = \alpha E_w[\cos(w^T (x - x'))]`` where ``w`` is drawn
+  from its (normalized) spectral density (CovarianceInterface::SampleSpectralFrequencies()).  With ``M`` draws
+  ``w_1, ..., w_M``, the features ``\phi(x) = \sqrt{\alpha/M} [\cos(w_j^T x), \sin(w_j^T x)]_{j=1..M}`` and
+  ``\theta ~ N(0, I_{2M})``, the function ``\phi(x)^T \theta`` is a draw from a GP whose covariance converges to ``k``
+  as ``M`` grows.
+
+  Matheron's rule turns such a prior draw into a posterior draw (Wilson et al. 2020, "decoupled sampling"):
+
+  ``f(x) = \mu + \phi(x)^T \theta + k(x, X) K^{-1} (y - \mu - \phi(X)^T \theta - \epsilon)``, ``\epsilon ~ N(0, \Sigma_n)``
+
+  where ``K = K(X, X) + \Sigma_n`` is the GP's (noisy) training covariance, ``\mu`` its constant mean, and for gradient
+  observations ``y``, ``\phi(X)^T \theta`` and ``k(x, X)`` include the observed derivatives.  The prior term carries the
+  feature approximation only far from the data; near the data the exact ``k(x, X)`` takes over, so the draw does not
+  suffer the variance starvation of a pure feature-space posterior.  Building a PosteriorSamplePath reuses the GP's
+  cholesky factor: ``O(N*M*dim + N^2)``.
+
+  **3. SAMPLING GLOBAL OPTIMA**
+
+  SampleGlobalOptimaViaPathwiseSamples() draws one path per requested optimum, evaluates it on a set of uniform
+  candidates, and polishes the best few candidates with L-BFGS-B.  Draws are independent and run in parallel; draw
+  ``i`` seeds its own generators from ``seed + i``, so the result does not depend on the number of threads.
+
+  As in GaussianProcess::SampleGlobalOptimaFromGP(), "optima" are MINIMA (the optimal_learning convention for
+  objective values).
+
+  **4. THOMPSON SAMPLING**
+
+  Thompson sampling picks the next experiment as the optimum of one posterior draw; a batch of ``q`` experiments is ``q``
+  independent draws (Kandasamy et al. 2018).  So ComputeThompsonSamplingPointsToSample() is the q-point analogue of
+  ComputeOptimalPointsToSample()/ComputeKGOptimalPointsToSample() whose cost is LINEAR in ``q``: there is no joint
+  ``q``-point integral, unlike q-EI and q-KG whose Monte Carlo cost and optimization dimension grow with
+  ``num_union``.  The draws are embarrassingly parallel, so batches of 50+ points are cheap.
+
+  The GaussianProcessMCMC overload averages over hyperparameters the same way the MCMC acquisition functions do: draw
+  ``i`` samples the posterior under hyperparameter sample ``i % num_mcmc``, i.e., a stratified draw from the
+  hyperparameter-marginalized posterior.
+
+  Points being sampled are not conditioned on: the batch diversity comes from the independence of the draws.
+
+  **CITATIONS**
+
+  (1) Rahimi & Recht, Random Features for Large-Scale Kernel Machines, NIPS 2007
+  (2) Wilson et al., Efficiently Sampling Functions from Gaussian Process Posteriors, ICML 2020
+  (3) Kandasamy et al., Parallelised Bayesian Optimisation via Thompson Sampling, AISTATS 2018
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+struct GaussianProcessMCMC;
+
+/*!\rst
+  One (approximate) draw ``f`` from the posterior of a GaussianProcess, represented analytically with random Fourier
+  features and a pathwise update; see the file comments.
+
+  The path is self-contained: it copies what it needs from the GP (training points, covariance), so it remains valid
+  after the GP changes or is destroyed.  Evaluation is const and thread-safe.
+\endrst*/
+class PosteriorSamplePath final {
+ public:
+  /*!\rst
+    Draws a posterior sample path of ``gaussian_process``.
+
+    \param
+      :gaussian_process: the GP to sample; must not be sparse (FITC) or grid (Kronecker)
+      :num_features: number of spectral frequencies ``M`` (the path has ``2M`` Fourier features)
+      :normal_rng[1]: a NormalRNGInterface object that will provide the ~N(0,1) random numbers
+    \output
+      :normal_rng[1]: NormalRNGInterface object will have its state changed due to random draws
+    \raise
+      LowerBoundException if ``num_features < 1``; OptimalLearningException if ``gaussian_process.is_sparse()`` or ``is_grid()``
+  \endrst*/
+  PosteriorSamplePath(const GaussianProcess& gaussian_process, int num_features,
+                      NormalRNGInterface * normal_rng) OL_NONNULL_POINTERS;
+
+  PosteriorSamplePath(PosteriorSamplePath&& OL_UNUSED(other)) = default;
+
+  int dim() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dim_;
+  }
+
+  int num_features() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return num_features_;
+  }
+
+  /*!\rst
+    \param
+      :point[dim]: point at which to evaluate the path
+    \return
+      ``f(point)``
+  \endrst*/
+  double Evaluate(double const * restrict point) const OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Evaluates the path at a list of points.  Points are processed in blocks so that the cross covariance with the
+    training data goes through the batched CovarianceInterface::CovarianceMatrix().
+
+    \param
+      :points[dim][num_points]: points at which to evaluate the path
+      :num_points: number of points
+    \output
+      :values[num_points]: ``f(points_i)``
+  \endrst*/
+  void EvaluateAtPointList(double const * restrict points, int num_points,
+                           double * restrict values) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    \param
+      :point[dim]: point at which to differentiate the path
+    \output
+      :grad_value[dim]: ``\nabla f(point)``
+  \endrst*/
+  void EvaluateGradient(double const * restrict point, double * restrict grad_value) const OL_NONNULL_POINTERS;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(PosteriorSamplePath);
+
+ private:
+  /*!\rst
+    Computes ``\phi(x)^T \theta`` and, if ``grad_prior`` is not nullptr, its gradient.
+
+    \param
+      :point[dim]: point at which to evaluate the prior draw
+    \output
+      :grad_prior[dim]: gradient of the prior draw (skipped if nullptr)
+    \return
+      the prior draw at ``point``
+  \endrst*/
+  double EvaluatePrior(double const * restrict point, double * restrict grad_prior) const OL_NONNULL_POINTERS_LIST(2);
+
+  //! spatial dimension
+  int dim_;
+  //! number of spectral frequencies ``M``
+  int num_features_;
+  //! number of training points
+  int num_sampled_;
+  //! number of derivatives observed at each training point
+  int num_derivatives_;
+  //! the GP's constant mean, ``\mu``
+  double mean_;
+
+  //! covariance of the GP (for ``k(x, X)``)
+  std::unique_ptr<CovarianceInterface> covariance_ptr_;
+  //! coordinates of the training points, ``X``
+  std::vector<double> points_sampled_;
+  //! derivatives observed at each training point
+  std::vector<int> derivatives_;
+
+  //! spectral frequencies ``w_j``, ``[dim][M]``
+  std::vector<double> frequencies_;
+  //! feature weights ``\sqrt{\alpha/M} \theta``: ``M`` cosine weights then ``M`` sine weights
+  std::vector<double> feature_weights_;
+  //! pathwise update weights ``K^{-1} (y - \mu - \phi(X)^T \theta - \epsilon)``, ``[num_sampled*(1+num_derivatives)]``
+  std::vector<double> update_weights_;
+};
+
+/*!\rst
+  Approximate draws of the global optima (minima) of ``gaussian_process`` over ``domain``, one per posterior sample path.
+
+  For each of the ``num_optima`` draws: build a PosteriorSamplePath, evaluate it at ``num_candidates`` uniform points
+  in ``domain``, then run L-BFGS-B from the ``min(lbfgsb_parameters.num_multistarts, num_candidates)`` best candidates
+  and keep the best point found.  ``lbfgsb_parameters.max_num_steps = 0`` skips the refinement (candidate search only).
+
+  Compared to GaussianProcess::SampleGlobalOptimaFromGP(), each draw costs ``O(num_candidates*(M*dim + N))`` instead of
+  ``O(num_candidates^3)``, draws run on ``max_num_threads`` threads (via ParallelForEachIndex()), and the output
+  depends only on ``seed``.
+
+  \param
+    :gaussian_process: the GP to sample; must not be sparse (FITC) or grid (Kronecker)
+    :num_optima: number of optima to draw
+    :num_features: number of spectral frequencies per sample path (suggest: 500-2000)
+    :num_candidates: number of uniform candidate points per sample path
+    :lbfgsb_parameters: refinement settings; ``num_multistarts`` is the number of candidates refined per path
+    :domain: the domain to search
+    :max_num_threads: maximum number of threads to use, >= 1
+    :seed: base seed; draw ``i`` uses ``seed + i``
+  \output
+    :points_optima[dim][num_optima]: one sampled optimum per draw
+\endrst*/
+void SampleGlobalOptimaViaPathwiseSamples(const GaussianProcess& gaussian_process, int num_optima, int num_features,
+                                          int num_candidates, const LBFGSBParameters& lbfgsb_parameters,
+                                          const TensorProductDomain& domain, int max_num_threads,
+                                          UniformRandomGenerator::EngineType::result_type seed,
+                                          double * restrict points_optima) OL_NONNULL_POINTERS;
+
+/*!\rst
+  Thompson sampling: chooses the ``num_to_sample`` points to sample next as the optima (minima) of as many independent
+  posterior sample paths of ``gaussian_process``, searched in parallel.  This is SampleGlobalOptimaViaPathwiseSamples()
+  under its acquisition-function name; see the file comments.
+
+  \param
+    :gaussian_process: the GP to sample; must not be sparse (FITC) or grid (Kronecker)
+    :num_to_sample: number of points to choose (i.e., the "q" of a batch)
+    :num_features: number of spectral frequencies per sample path (suggest: 500-2000)
+    :num_candidates: number of uniform candidate points per sample path
+    :lbfgsb_parameters: refinement settings; ``num_multistarts`` is the number of candidates refined per path
+    :domain: the domain to search
+    :max_num_threads: maximum number of threads to use, >= 1
+    :seed: base seed; point ``i`` uses ``seed + i``
+  \output
+    :best_points_to_sample[dim][num_to_sample]: points to sample next
+\endrst*/
+void ComputeThompsonSamplingPointsToSample(const GaussianProcess& gaussian_process, int num_to_sample,
+                                           int num_features, int num_candidates,
+                                           const LBFGSBParameters& lbfgsb_parameters,
+                                           const TensorProductDomain& domain, int max_num_threads,
+                                           UniformRandomGenerator::EngineType::result_type seed,
+                                           double * restrict best_points_to_sample) OL_NONNULL_POINTERS;
+
+/*!\rst
+  Thompson sampling averaged over hyperparameters: as above, except point ``i`` is the optimum of a sample path of
+  ``gaussian_process_mcmc.gaussian_process_lst[i % num_mcmc]``.
+
+  \param
+    :gaussian_process_mcmc: GPs to sample, one per hyperparameter sample; none may be sparse (FITC) or grid (Kronecker)
+    (the rest as in the GaussianProcess overload)
+  \output
+    :best_points_to_sample[dim][num_to_sample]: points to sample next
+\endrst*/
+void ComputeThompsonSamplingPointsToSample(const GaussianProcessMCMC& gaussian_process_mcmc, int num_to_sample,
+                                           int num_features, int num_candidates,
+                                           const LBFGSBParameters& lbfgsb_parameters,
+                                           const TensorProductDomain& domain, int max_num_threads,
+                                           UniformRandomGenerator::EngineType::result_type seed,
+                                           double * restrict best_points_to_sample) OL_NONNULL_POINTERS;
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_HPP_
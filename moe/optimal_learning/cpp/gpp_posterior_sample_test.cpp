@@ -0,0 +1,356 @@
+/*!
+  \file gpp_posterior_sample_test.cpp
+  \rst
+  Routines to test the functions in gpp_posterior_sample.cpp:
+
+  * for each covariance type, ``\alpha E_w[\cos(w^T r)]`` over SampleSpectralFrequencies() draws matches ``k(r)``,
+  * PosteriorSamplePath (with derivative observations) stays near the posterior mean at the data, EvaluateAtPointList()
+    matches Evaluate(), and EvaluateGradient() matches finite differences,
+  * SampleGlobalOptimaViaPathwiseSamples() returns points in the domain, near the minimum of a well-sampled bowl,
+    and the same points for any number of threads,
+  * ComputeThompsonSamplingPointsToSample() matches SampleGlobalOptimaViaPathwiseSamples() on each GP it draws from,
+    for a GaussianProcess and a GaussianProcessMCMC.
+\endrst*/
+
+#include "gpp_posterior_sample_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_posterior_sample.hpp"
+#include "gpp_random.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks that random Fourier features built from SampleSpectralFrequencies() reproduce each covariance:
+  ``\alpha/M \sum_j \cos(w_j^T (x - x'))`` is within Monte Carlo error of ``k(x, x')``.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SpectralFrequencyTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_frequencies = 40000;
+  const double alpha = 1.7;
+  std::vector<double> lengths = {0.8, 1.9};
+  std::vector<int> no_derivatives;
+  // offsets x - x' from 0 to a few length scales
+  const std::vector<double> offsets = {0.0, 0.0, 0.3, -0.5, 0.9, 1.4, -1.6, 2.5};
+  const int num_offsets = offsets.size()/dim;
+
+  SquareExponential sqexp_covariance(dim, alpha, lengths.data());
+  MaternNu1p5 matern_15_covariance(dim, alpha, lengths.data());
+  MaternNu2p5 matern_25_covariance(dim, alpha, lengths.data());
+  CovarianceInterface const * covariances[3] = {&sqexp_covariance, &matern_15_covariance, &matern_25_covariance};
+  std::vector<double> frequencies(dim*num_frequencies);
+  std::vector<double> origin(dim, 0.0);
+  for (auto covariance : covariances) {
+    NormalRNG normal_rng(3141);
+    const double signal_variance = covariance->SampleSpectralFrequencies(num_frequencies, &normal_rng,
+                                                                         frequencies.data());
+    if (!CheckDoubleWithin(signal_variance, alpha, 0.0)) {
+      ++total_errors;
+    }
+    for (int i = 0; i < num_offsets; ++i) {
+      double feature_covariance = 0.0;
+      for (int j = 0; j < num_frequencies; ++j) {
+        feature_covariance += std::cos(frequencies[j*dim]*offsets[i*dim] + frequencies[j*dim + 1]*offsets[i*dim + 1]);
+      }
+      feature_covariance *= signal_variance/num_frequencies;
+
+      double truth;
+      covariance->Covariance(offsets.data() + i*dim, no_derivatives.data(), 0, origin.data(), no_derivatives.data(), 0,
+                             &truth);
+      // Monte Carlo standard error is at most alpha/sqrt(2*num_frequencies) ~ 0.006
+      if (!CheckDoubleWithin(feature_covariance, truth, 0.04)) {
+        ++total_errors;
+      }
+    }
+  }
+  return total_errors;
+}
+
+/*!\rst
+  Checks that sample paths of a low-noise GP with derivative observations (each covariance type) are within a few
+  posterior standard deviations of the posterior mean at the training points, that block evaluation matches pointwise
+  evaluation, and that gradients match finite differences.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int PosteriorSamplePathTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 12;
+  const int num_features = 300;
+  // more than one block of PosteriorSamplePath::EvaluateAtPointList()
+  const int num_to_sample = 150;
+  std::vector<int> derivatives = {0, 2};
+  const int num_derivatives = derivatives.size();
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, num_derivatives);
+  std::vector<double> noise_variance(num_derivatives + 1, 1.0e-4);
+  std::vector<double> lengths(dim, 2.1);
+
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  MaternNu1p5 matern_15_covariance(dim, 1.3, lengths.data());
+  MaternNu2p5 matern_25_covariance(dim, 1.3, lengths.data());
+  CovarianceInterface const * covariances[3] = {&sqexp_covariance, &matern_15_covariance, &matern_25_covariance};
+  std::vector<double> mean(num_sampled);
+  std::vector<double> variance(Square(num_sampled));
+  std::vector<double> values(num_to_sample);
+  std::vector<double> grad_value(dim);
+  std::vector<double> point(dim);
+  for (auto covariance : covariances) {
+    GaussianProcess gaussian_process(*covariance, EI_environment.points_sampled(),
+                                     EI_environment.points_sampled_value(), noise_variance.data(), derivatives.data(),
+                                     num_derivatives, dim, num_sampled);
+    NormalRNG normal_rng(2718);
+    PosteriorSamplePath sample_path(gaussian_process, num_features, &normal_rng);
+
+    // at the data, the posterior is tight: the draw must be within a few posterior standard deviations of the mean
+    PointsToSampleState points_sampled_state(gaussian_process, EI_environment.points_sampled(), num_sampled, nullptr,
+                                             0, 0);
+    gaussian_process.ComputeMeanOfPoints(points_sampled_state, mean.data());
+    gaussian_process.ComputeVarianceOfPoints(&points_sampled_state, nullptr, 0, variance.data());
+    for (int i = 0; i < num_sampled; ++i) {
+      const double value = sample_path.Evaluate(EI_environment.points_sampled() + i*dim);
+      if (!CheckDoubleWithin(value, mean[i], 5.0*std::sqrt(variance[i + i*num_sampled]))) {
+        ++total_errors;
+      }
+    }
+
+    sample_path.EvaluateAtPointList(EI_environment.points_to_sample(), num_to_sample, values.data());
+    for (int i = 0; i < num_to_sample; ++i) {
+      if (!CheckDoubleWithinRelative(values[i], sample_path.Evaluate(EI_environment.points_to_sample() + i*dim),
+                                     1.0e-12)) {
+        ++total_errors;
+      }
+    }
+
+    // gradient vs central differences
+    const double epsilon = 1.0e-6;
+    for (int i = 0; i < 5; ++i) {
+      std::copy(EI_environment.points_to_sample() + i*dim, EI_environment.points_to_sample() + (i + 1)*dim,
+                point.begin());
+      sample_path.EvaluateGradient(point.data(), grad_value.data());
+      for (int d = 0; d < dim; ++d) {
+        point[d] += epsilon;
+        const double value_plus = sample_path.Evaluate(point.data());
+        point[d] -= 2.0*epsilon;
+        const double value_minus = sample_path.Evaluate(point.data());
+        point[d] += epsilon;
+        const double finite_difference = (value_plus - value_minus)/(2.0*epsilon);
+        if (!CheckDoubleWithinRelativeWithThreshold(grad_value[d], finite_difference, 1.0e-5, 1.0e-4)) {
+          ++total_errors;
+        }
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Samples optima of a GP fit to the bowl ``\|x - c\|_2^2``: every optimum must lie in the domain, they must cluster
+  around ``c``, and they must not depend on the number of threads.  Also checks the candidate-only mode
+  (``max_num_steps = 0``) returns candidates in the domain.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int SampleGlobalOptimaTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 40;
+  const int num_optima = 12;
+  const int num_features = 500;
+  const int num_candidates = 1000;
+  const double minimum[dim] = {0.5, -0.3};
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-2.0, 2.0));
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  UniformRandomGenerator uniform_generator(1618);
+  std::vector<double> points_sampled(num_sampled*dim);
+  std::vector<double> points_sampled_value(num_sampled);
+  domain.GenerateUniformPointsInDomain(num_sampled, &uniform_generator, points_sampled.data());
+  for (int i = 0; i < num_sampled; ++i) {
+    points_sampled_value[i] = Square(points_sampled[i*dim] - minimum[0]) + Square(points_sampled[i*dim + 1] - minimum[1]);
+  }
+  std::vector<double> noise_variance(1, 1.0e-4);
+  std::vector<double> lengths(dim, 1.5);
+  std::vector<int> no_derivatives;
+  SquareExponential sqexp_covariance(dim, 5.0, lengths.data());
+  GaussianProcess gaussian_process(sqexp_covariance, points_sampled.data(), points_sampled_value.data(),
+                                   noise_variance.data(), no_derivatives.data(), 0, dim, num_sampled);
+
+  LBFGSBParameters lbfgsb_parameters(3, 100, 10, 30, 1.0e-10);
+  const UniformRandomGenerator::EngineType::result_type seed = 271;
+  std::vector<double> points_optima(num_optima*dim);
+  std::vector<double> points_optima_threaded(num_optima*dim);
+  SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_optima, num_features, num_candidates, lbfgsb_parameters,
+                                       domain, 1, seed, points_optima.data());
+  SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_optima, num_features, num_candidates, lbfgsb_parameters,
+                                       domain, 4, seed, points_optima_threaded.data());
+  if (points_optima_threaded != points_optima) {
+    ++total_errors;
+  }
+
+  double mean_distance = 0.0;
+  for (int i = 0; i < num_optima; ++i) {
+    if (!domain.CheckPointInside(points_optima.data() + i*dim)) {
+      ++total_errors;
+    }
+    mean_distance += std::sqrt(Square(points_optima[i*dim] - minimum[0]) +
+                               Square(points_optima[i*dim + 1] - minimum[1]));
+  }
+  mean_distance /= num_optima;
+  if (mean_distance > 0.3) {
+    ++total_errors;
+  }
+
+  lbfgsb_parameters.max_num_steps = 0;
+  SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_optima, num_features, num_candidates, lbfgsb_parameters,
+                                       domain, 2, seed, points_optima.data());
+  for (int i = 0; i < num_optima; ++i) {
+    if (!domain.CheckPointInside(points_optima.data() + i*dim)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that Thompson sampling with a GaussianProcess is SampleGlobalOptimaViaPathwiseSamples(), and that with a
+  GaussianProcessMCMC, point ``i`` is the sampled optimum of hyperparameter sample ``i % num_mcmc`` (same seed), for
+  any number of threads.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ThompsonSamplingTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 20;
+  const int num_mcmc = 2;
+  const int num_to_sample = 6;
+  const int num_features = 200;
+  const int num_candidates = 300;
+
+  std::vector<ClosedInterval> domain_bounds(dim, ClosedInterval(-1.0, 1.0));
+  TensorProductDomain domain(domain_bounds.data(), dim);
+  UniformRandomGenerator uniform_generator(4242);
+  std::vector<double> points_sampled(num_sampled*dim);
+  std::vector<double> points_sampled_value(num_sampled);
+  domain.GenerateUniformPointsInDomain(num_sampled, &uniform_generator, points_sampled.data());
+  for (int i = 0; i < num_sampled; ++i) {
+    points_sampled_value[i] = std::sin(3.0*points_sampled[i*dim]) + Square(points_sampled[i*dim + 1]);
+  }
+  std::vector<int> no_derivatives;
+  // [dim+1][num_mcmc] hyperparameters and [1][num_mcmc] noise variances
+  std::vector<double> hypers_mcmc = {1.0, 0.5, 0.7, 2.0, 0.9, 0.4};
+  std::vector<double> noises_mcmc = {1.0e-3, 1.0e-2};
+  GaussianProcessMCMC gaussian_process_mcmc(hypers_mcmc.data(), noises_mcmc.data(), num_mcmc, points_sampled.data(),
+                                            points_sampled_value.data(), no_derivatives.data(), 0, dim, num_sampled,
+                                            1);
+
+  LBFGSBParameters lbfgsb_parameters(2, 50, 10, 20, 1.0e-10);
+  const UniformRandomGenerator::EngineType::result_type seed = 97;
+  std::vector<double> points_to_sample(num_to_sample*dim);
+  std::vector<double> points_optima(num_to_sample*dim);
+
+  const GaussianProcess& gaussian_process = gaussian_process_mcmc.gaussian_process_lst[0];
+  ComputeThompsonSamplingPointsToSample(gaussian_process, num_to_sample, num_features, num_candidates,
+                                        lbfgsb_parameters, domain, 3, seed, points_to_sample.data());
+  SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_to_sample, num_features, num_candidates,
+                                       lbfgsb_parameters, domain, 1, seed, points_optima.data());
+  if (points_to_sample != points_optima) {
+    ++total_errors;
+  }
+
+  std::vector<double> points_to_sample_threaded(num_to_sample*dim);
+  ComputeThompsonSamplingPointsToSample(gaussian_process_mcmc, num_to_sample, num_features, num_candidates,
+                                        lbfgsb_parameters, domain, 1, seed, points_to_sample.data());
+  ComputeThompsonSamplingPointsToSample(gaussian_process_mcmc, num_to_sample, num_features, num_candidates,
+                                        lbfgsb_parameters, domain, 4, seed, points_to_sample_threaded.data());
+  if (points_to_sample_threaded != points_to_sample) {
+    ++total_errors;
+  }
+  for (int k = 0; k < num_mcmc; ++k) {
+    SampleGlobalOptimaViaPathwiseSamples(gaussian_process_mcmc.gaussian_process_lst[k], num_to_sample, num_features,
+                                         num_candidates, lbfgsb_parameters, domain, 2, seed, points_optima.data());
+    for (int i = k; i < num_to_sample; i += num_mcmc) {
+      if (!std::equal(points_optima.begin() + i*dim, points_optima.begin() + (i + 1)*dim,
+                      points_to_sample.begin() + i*dim)) {
+        ++total_errors;
+      }
+    }
+  }
+  for (int i = 0; i < num_to_sample; ++i) {
+    if (!domain.CheckPointInside(points_to_sample.data() + i*dim)) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunPosteriorSampleTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = SpectralFrequencyTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("spectral frequency draws failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("spectral frequency draws\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = PosteriorSamplePathTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("posterior sample path failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("posterior sample path\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = SampleGlobalOptimaTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("pathwise global optima sampling failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("pathwise global optima sampling\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = ThompsonSamplingTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("thompson sampling failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("thompson sampling\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
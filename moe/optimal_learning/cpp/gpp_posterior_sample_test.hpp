@@ -0,0 +1,25 @@
+/*!
+  \file gpp_posterior_sample_test.hpp
+  \rst
+  Functions for testing gpp_posterior_sample's functionality: spectral frequency draws reproduce their covariances,
+  posterior sample paths interpolate the data and have correct gradients, and sampled optima are deterministic.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the posterior sample path tests.
+
+  \return
+    number of test failures: 0 if posterior sample paths are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunPosteriorSampleTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_POSTERIOR_SAMPLE_TEST_HPP_
@@ -0,0 +1,229 @@
+/*!
+  \file gpp_profiling.cpp
+  \rst
+  Thread-local profile accumulators and the global registry that sums them; see gpp_profiling.hpp.
+
+  Each thread owns a ThreadProfileAccumulator. Only the owner writes to it (with relaxed atomic load/store pairs, no
+  read-modify-write), so recording is lock-free; readers take the registry mutex (which protects the list of live
+  accumulators) and sum the relaxed loads. ResetProfile() never writes to a live accumulator: it saves the current
+  totals as a baseline that GetProfileTotals() subtracts.
+\endrst*/
+
+#include "gpp_profiling.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+ProfileReport ZeroProfileReport() noexcept {
+  ProfileReport report;
+  for (int i = 0; i < kNumProfilePhases; ++i) {
+    report.nanoseconds[i] = 0;
+    report.calls[i] = 0;
+  }
+  for (int i = 0; i < kNumProfileCounters; ++i) {
+    report.counters[i] = 0;
+  }
+  report.num_top_level_calls = 0;
+  return report;
+}
+
+ProfileReport SubtractProfileReports(const ProfileReport& left, const ProfileReport& right) noexcept {
+  ProfileReport difference;
+  for (int i = 0; i < kNumProfilePhases; ++i) {
+    difference.nanoseconds[i] = left.nanoseconds[i] - right.nanoseconds[i];
+    difference.calls[i] = left.calls[i] - right.calls[i];
+  }
+  for (int i = 0; i < kNumProfileCounters; ++i) {
+    difference.counters[i] = left.counters[i] - right.counters[i];
+  }
+  difference.num_top_level_calls = left.num_top_level_calls - right.num_top_level_calls;
+  return difference;
+}
+
+struct ThreadProfileAccumulator;
+
+/*!\rst
+  Global state; every member is protected by ``mutex``.
+\endrst*/
+struct ProfileRegistry {
+  std::mutex mutex;
+  //! head of the intrusive list of live thread accumulators
+  ThreadProfileAccumulator * head = nullptr;
+  //! totals from threads that have exited
+  ProfileReport retired = ZeroProfileReport();
+  //! totals at the last ResetProfile()
+  ProfileReport baseline = ZeroProfileReport();
+  //! profile of the most recently completed top-level call
+  ProfileReport last_top_level = ZeroProfileReport();
+  //! number of completed top-level calls
+  std::int64_t num_top_level_calls = 0;
+};
+
+/*!\rst
+  Deliberately leaked: worker threads may exit (and fold their accumulators in) after static destructors have run.
+\endrst*/
+ProfileRegistry& GetProfileRegistry() {
+  static ProfileRegistry * const registry = new ProfileRegistry();
+  return *registry;
+}
+
+struct ThreadProfileAccumulator {
+  ThreadProfileAccumulator() {
+    for (int i = 0; i < kNumProfilePhases; ++i) {
+      nanoseconds[i].store(0, std::memory_order_relaxed);
+      calls[i].store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < kNumProfileCounters; ++i) {
+      counters[i].store(0, std::memory_order_relaxed);
+    }
+    ProfileRegistry& registry = GetProfileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    next = registry.head;
+    if (next != nullptr) {
+      next->previous = this;
+    }
+    registry.head = this;
+  }
+
+  ~ThreadProfileAccumulator() {
+    ProfileRegistry& registry = GetProfileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    AddTo(&registry.retired);
+    if (previous != nullptr) {
+      previous->next = next;
+    } else {
+      registry.head = next;
+    }
+    if (next != nullptr) {
+      next->previous = previous;
+    }
+  }
+
+  //! adds this accumulator's values into ``report``
+  void AddTo(ProfileReport * report) const noexcept {
+    for (int i = 0; i < kNumProfilePhases; ++i) {
+      report->nanoseconds[i] += nanoseconds[i].load(std::memory_order_relaxed);
+      report->calls[i] += calls[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < kNumProfileCounters; ++i) {
+      report->counters[i] += counters[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  //! adds ``value`` to ``*slot``; only called by the owning thread
+  static void Add(std::atomic<std::int64_t> * slot, std::int64_t value) noexcept {
+    slot->store(slot->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  std::atomic<std::int64_t> nanoseconds[kNumProfilePhases];
+  std::atomic<std::int64_t> calls[kNumProfilePhases];
+  std::atomic<std::int64_t> counters[kNumProfileCounters];
+  ThreadProfileAccumulator * previous = nullptr;
+  ThreadProfileAccumulator * next = nullptr;
+
+  OL_DISALLOW_COPY_AND_ASSIGN(ThreadProfileAccumulator);
+};
+
+ThreadProfileAccumulator& GetThreadProfileAccumulator() {
+  thread_local ThreadProfileAccumulator accumulator;
+  return accumulator;
+}
+
+//! nesting depth of ScopedTopLevelProfile on this thread
+thread_local int top_level_profile_depth = 0;
+
+/*!\rst
+  Sum of every accumulator (live and retired) since program start, ignoring ResetProfile(); caller must hold
+  ``registry.mutex``.
+\endrst*/
+ProfileReport GetAbsoluteTotalsLocked(const ProfileRegistry& registry) noexcept {
+  ProfileReport totals = registry.retired;
+  for (ThreadProfileAccumulator const * accumulator = registry.head; accumulator != nullptr;
+       accumulator = accumulator->next) {
+    accumulator->AddTo(&totals);
+  }
+  totals.num_top_level_calls = registry.num_top_level_calls;
+  return totals;
+}
+
+}  // end unnamed namespace
+
+const char * ProfilePhaseName(ProfilePhase phase) noexcept {
+  switch (phase) {
+    case ProfilePhase::kGaussianProcessFit: return "gaussian_process_fit";
+    case ProfilePhase::kCholeskyFactorization: return "cholesky_factorization";
+    case ProfilePhase::kCovarianceMatrixBuild: return "covariance_matrix_build";
+    case ProfilePhase::kMonteCarloSampling: return "monte_carlo_sampling";
+    case ProfilePhase::kKnowledgeGradientInnerOptimization: return "knowledge_gradient_inner_optimization";
+    case ProfilePhase::kPythonConversion: return "python_conversion";
+    default: return "unknown";
+  }
+}
+
+const char * ProfileCounterName(ProfileCounter counter) noexcept {
+  switch (counter) {
+    case ProfileCounter::kMonteCarloSamples: return "monte_carlo_samples";
+    case ProfileCounter::kKnowledgeGradientInnerSolves: return "knowledge_gradient_inner_solves";
+    case ProfileCounter::kPythonValuesConverted: return "python_values_converted";
+    case ProfileCounter::kResultCacheHits: return "result_cache_hits";
+    case ProfileCounter::kResultCacheMisses: return "result_cache_misses";
+    default: return "unknown";
+  }
+}
+
+void AddProfileElapsed(ProfilePhase phase, std::int64_t nanoseconds) noexcept {
+  ThreadProfileAccumulator& accumulator = GetThreadProfileAccumulator();
+  ThreadProfileAccumulator::Add(accumulator.nanoseconds + static_cast<int>(phase), nanoseconds);
+  ThreadProfileAccumulator::Add(accumulator.calls + static_cast<int>(phase), 1);
+}
+
+void AddProfileCount(ProfileCounter counter, std::int64_t count) noexcept {
+  ThreadProfileAccumulator::Add(GetThreadProfileAccumulator().counters + static_cast<int>(counter), count);
+}
+
+ProfileReport GetProfileTotals() noexcept {
+  ProfileRegistry& registry = GetProfileRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return SubtractProfileReports(GetAbsoluteTotalsLocked(registry), registry.baseline);
+}
+
+ProfileReport GetLastTopLevelProfile() noexcept {
+  ProfileRegistry& registry = GetProfileRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.last_top_level;
+}
+
+void ResetProfile() noexcept {
+  ProfileRegistry& registry = GetProfileRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.baseline = GetAbsoluteTotalsLocked(registry);
+}
+
+ScopedTopLevelProfile::ScopedTopLevelProfile() noexcept : outermost_(top_level_profile_depth == 0) {
+  ++top_level_profile_depth;
+  if (outermost_) {
+    ProfileRegistry& registry = GetProfileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    start_ = GetAbsoluteTotalsLocked(registry);
+  }
+}
+
+ScopedTopLevelProfile::~ScopedTopLevelProfile() {
+  --top_level_profile_depth;
+  if (outermost_) {
+    ProfileRegistry& registry = GetProfileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.last_top_level = SubtractProfileReports(GetAbsoluteTotalsLocked(registry), start_);
+    registry.last_top_level.num_top_level_calls = 1;
+    registry.num_top_level_calls += 1;
+  }
+}
+
+}  // end namespace optimal_learning
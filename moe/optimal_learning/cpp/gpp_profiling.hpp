@@ -0,0 +1,210 @@
+/*!
+  \file gpp_profiling.hpp
+  \rst
+  Tools for measuring where the time in a call goes: scoped phase timers, event counters, and a registry that sums
+  them across threads and per top-level call.
+
+  Instrumented code uses the macros::
+
+    OL_PROFILE_SCOPE(ProfilePhase::kCholeskyFactorization);  // times the rest of the enclosing block
+    OL_PROFILE_COUNT(ProfileCounter::kMonteCarloSamples, block_size);  // adds to a counter
+    OL_PROFILE_TOP_LEVEL_CALL();  // at an entry point (e.g., a Python wrapper); records that call's totals
+
+  The macros compile to nothing unless the compiler option ``OL_PROFILE_ENABLED`` is defined (cmake ``-D
+  MOE_USE_PROFILING=1``), so the default build pays nothing and the arguments to ``OL_PROFILE_COUNT`` are not even
+  evaluated. The classes and functions below exist in every build; without ``OL_PROFILE_ENABLED`` the reports are
+  simply all zeros (unless something uses the classes directly, as the tests do).
+
+  When enabled, each timed scope costs two ``std::chrono::steady_clock::now()`` calls and a couple of stores into a
+  thread-local accumulator; no locks are taken on the hot path. A thread's accumulator is registered with a global
+  list the first time that thread records anything and is folded into a "retired" total when the thread exits.
+  Reports (GetProfileTotals(), GetLastTopLevelProfile()) sum every registered accumulator, so work done by OpenMP
+  worker threads inside a call is attributed to that call.
+
+  Phase times are inclusive: e.g., the Cholesky inside a GP fit is counted in both kGaussianProcessFit and
+  kCholeskyFactorization. Times from multiple threads add (so a phase can exceed wall-clock time).
+
+  .. NOTE:: top-level profiles are the difference of the global totals at the start and end of the outermost
+    ScopedTopLevelProfile on the calling thread. Work from other, unrelated top-level calls running concurrently
+    (e.g., two Python threads) is included in both calls' profiles.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Timed phases of the C++ hot paths.
+\endrst*/
+enum class ProfilePhase {
+  //! GaussianProcess::RecomputeDerivedVariables(): construction, AddPointsToGP(), SetCovarianceHyperparameters(), etc.
+  kGaussianProcessFit = 0,
+  //! ComputeCholeskyFactorL()
+  kCholeskyFactorization = 1,
+  //! covariance (kernel) matrix builds: ``K + \sigma^2 I`` of the training data and the "mix" matrices
+  kCovarianceMatrixBuild = 2,
+  //! drawing normals and forming ``L * normals`` for MC estimates of EI and KG
+  kMonteCarloSampling = 3,
+  //! the inner (future posterior mean) optimization solved for each KG MC sample
+  kKnowledgeGradientInnerOptimization = 4,
+  //! copying between Python objects and C++ containers in the ``gpp_python_*`` layer
+  kPythonConversion = 5,
+};
+
+//! number of ProfilePhase values
+constexpr int kNumProfilePhases = 6;
+
+/*!\rst
+  Event counters.
+\endrst*/
+enum class ProfileCounter {
+  //! number of MC samples (normal vectors) drawn for EI and KG
+  kMonteCarloSamples = 0,
+  //! number of KG inner optimization problems solved (one per MC sample each time an inner method runs)
+  kKnowledgeGradientInnerSolves = 1,
+  //! number of scalars copied between Python objects and C++ containers
+  kPythonValuesConverted = 2,
+  //! number of GaussianProcessResultCache lookups that found a result
+  kResultCacheHits = 3,
+  //! number of GaussianProcessResultCache lookups that did not
+  kResultCacheMisses = 4,
+};
+
+//! number of ProfileCounter values
+constexpr int kNumProfileCounters = 5;
+
+//! true if the OL_PROFILE_* macros are compiled in
+#ifdef OL_PROFILE_ENABLED
+constexpr bool kProfilingEnabled = true;
+#else
+constexpr bool kProfilingEnabled = false;
+#endif
+
+/*!\rst
+  Aggregated profile: per-phase time and scope counts, counters, and the number of top-level calls covered.
+  Arrays are indexed by ``static_cast<int>(ProfilePhase)`` and ``static_cast<int>(ProfileCounter)``.
+\endrst*/
+struct ProfileReport {
+  //! \return total seconds spent in ``phase``
+  double seconds(ProfilePhase phase) const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return 1.0e-9 * static_cast<double>(nanoseconds[static_cast<int>(phase)]);
+  }
+
+  //! total nanoseconds spent in each phase (summed over threads)
+  std::int64_t nanoseconds[kNumProfilePhases];
+  //! number of times each phase's scope was entered
+  std::int64_t calls[kNumProfilePhases];
+  //! value of each counter
+  std::int64_t counters[kNumProfileCounters];
+  //! number of completed (outermost) top-level calls
+  std::int64_t num_top_level_calls;
+};
+
+/*!\rst
+  \return
+    name of the phase (e.g., ``"cholesky_factorization"``); used as the key in Python reports
+\endrst*/
+const char * ProfilePhaseName(ProfilePhase phase) noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  \return
+    name of the counter (e.g., ``"monte_carlo_samples"``); used as the key in Python reports
+\endrst*/
+const char * ProfileCounterName(ProfileCounter counter) noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Adds ``nanoseconds`` to ``phase``'s time and 1 to its scope count, on the calling thread's accumulator.
+  Usually called through ScopedProfileTimer.
+\endrst*/
+void AddProfileElapsed(ProfilePhase phase, std::int64_t nanoseconds) noexcept;
+
+/*!\rst
+  Adds ``count`` to ``counter`` on the calling thread's accumulator. Usually called through ``OL_PROFILE_COUNT``.
+\endrst*/
+void AddProfileCount(ProfileCounter counter, std::int64_t count) noexcept;
+
+/*!\rst
+  \return
+    everything recorded (by all threads, live or exited) since the last ResetProfile()
+\endrst*/
+ProfileReport GetProfileTotals() noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  \return
+    the profile of the most recently completed top-level call (by any thread); all zeros if none has completed
+\endrst*/
+ProfileReport GetLastTopLevelProfile() noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Zeros the totals reported by GetProfileTotals(). Top-level calls in progress are not affected, and neither is
+  GetLastTopLevelProfile().
+\endrst*/
+void ResetProfile() noexcept;
+
+/*!\rst
+  RAII timer: adds the time from construction to destruction to ``phase``.
+\endrst*/
+class ScopedProfileTimer final {
+ public:
+  explicit ScopedProfileTimer(ProfilePhase phase) noexcept : phase_(phase), start_(std::chrono::steady_clock::now()) {
+  }
+
+  ~ScopedProfileTimer() {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    AddProfileElapsed(phase_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ScopedProfileTimer);
+
+ private:
+  //! phase being timed
+  const ProfilePhase phase_;
+  //! time at construction
+  const std::chrono::steady_clock::time_point start_;
+};
+
+/*!\rst
+  RAII marker for a top-level call. Only the outermost instance on each thread counts: when it is destroyed, the
+  change in the global totals since its construction is stored as the "last top-level profile" (see
+  GetLastTopLevelProfile()). Nested instances (e.g., one Python wrapper calling another) do nothing.
+\endrst*/
+class ScopedTopLevelProfile final {
+ public:
+  ScopedTopLevelProfile() noexcept;
+
+  ~ScopedTopLevelProfile();
+
+  OL_DISALLOW_COPY_AND_ASSIGN(ScopedTopLevelProfile);
+
+ private:
+  //! true if this is the outermost instance on its thread
+  bool outermost_;
+  //! global totals (not offset by ResetProfile()) at construction; unused unless outermost_
+  ProfileReport start_;
+};
+
+#ifdef OL_PROFILE_ENABLED
+#define OL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define OL_PROFILE_CONCAT(a, b) OL_PROFILE_CONCAT_IMPL(a, b)
+/*!\rst
+  Macro wrappers for the profiling tools so they can be compiled out via the compiler option OL_PROFILE_ENABLED.
+  ``OL_PROFILE_SCOPE`` and ``OL_PROFILE_TOP_LEVEL_CALL`` declare an object that lives to the end of the enclosing block.
+\endrst*/
+#define OL_PROFILE_SCOPE(phase) ::optimal_learning::ScopedProfileTimer OL_PROFILE_CONCAT(ol_profile_timer_, __LINE__)(phase)
+#define OL_PROFILE_COUNT(counter, count) ::optimal_learning::AddProfileCount(counter, count)
+#define OL_PROFILE_TOP_LEVEL_CALL() ::optimal_learning::ScopedTopLevelProfile OL_PROFILE_CONCAT(ol_profile_call_, __LINE__)
+#else
+#define OL_PROFILE_SCOPE(phase) (void)0
+#define OL_PROFILE_COUNT(counter, count) (void)0
+#define OL_PROFILE_TOP_LEVEL_CALL() (void)0
+#endif
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_HPP_
@@ -0,0 +1,194 @@
+/*!
+  \file gpp_profiling_test.cpp
+  \rst
+  Routines to test the functions in gpp_profiling.cpp:
+
+  * ScopedProfileTimer and AddProfileCount() accumulate into GetProfileTotals(), and ResetProfile() zeros the totals,
+  * work recorded by other threads (OpenMP workers and a std::thread that has exited) is included in the totals,
+  * only the outermost ScopedTopLevelProfile records GetLastTopLevelProfile(), and it holds just that call's work,
+  * with ``OL_PROFILE_ENABLED``, constructing a GaussianProcess records its fit, covariance build, and Cholesky phases.
+
+  These tests use the classes directly, so they run the same with or without ``OL_PROFILE_ENABLED``.
+\endrst*/
+
+#include "gpp_profiling_test.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_profiling.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks accumulation, cross-thread aggregation, reset, and top-level call profiles.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ProfileRegistryTest() {
+  int total_errors = 0;
+  const int cholesky = static_cast<int>(ProfilePhase::kCholeskyFactorization);
+  const int samples = static_cast<int>(ProfileCounter::kMonteCarloSamples);
+  const int inner_solves = static_cast<int>(ProfileCounter::kKnowledgeGradientInnerSolves);
+
+  ResetProfile();
+  ProfileReport totals = GetProfileTotals();
+  if (totals.calls[cholesky] != 0 || totals.nanoseconds[cholesky] != 0 || totals.counters[samples] != 0) {
+    ++total_errors;
+  }
+
+  const std::int64_t num_top_level_calls_before = totals.num_top_level_calls;
+  {
+    ScopedTopLevelProfile top_level_call;
+    {
+      ScopedProfileTimer timer(ProfilePhase::kCholeskyFactorization);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    AddProfileCount(ProfileCounter::kMonteCarloSamples, 5);
+
+    // nested top-level calls are folded into the outermost one
+    {
+      ScopedTopLevelProfile nested_call;
+      AddProfileCount(ProfileCounter::kMonteCarloSamples, 2);
+    }
+
+    // OpenMP workers: each thread adds 1 per iteration
+    const int num_iterations = 64;
+#pragma omp parallel for num_threads(4) schedule(static)
+    for (int i = 0; i < num_iterations; ++i) {
+      AddProfileCount(ProfileCounter::kKnowledgeGradientInnerSolves, 1);
+    }
+
+    // a thread that exits before we read: its accumulator is folded into the retired totals
+    std::thread worker([]() {
+        ScopedProfileTimer timer(ProfilePhase::kCholeskyFactorization);
+        AddProfileCount(ProfileCounter::kMonteCarloSamples, 10);
+      });
+    worker.join();
+  }
+
+  // outside any top-level call; shows up in the totals but not in the last top-level profile
+  AddProfileCount(ProfileCounter::kMonteCarloSamples, 100);
+
+  totals = GetProfileTotals();
+  if (totals.calls[cholesky] != 2) {
+    ++total_errors;
+  }
+  if (totals.seconds(ProfilePhase::kCholeskyFactorization) < 2.0e-3) {
+    ++total_errors;
+  }
+  if (totals.counters[samples] != 117 || totals.counters[inner_solves] != 64) {
+    ++total_errors;
+  }
+  if (totals.num_top_level_calls - num_top_level_calls_before != 1) {
+    ++total_errors;
+  }
+
+  ProfileReport last_call = GetLastTopLevelProfile();
+  if (last_call.num_top_level_calls != 1 || last_call.calls[cholesky] != 2 || last_call.counters[samples] != 17 ||
+      last_call.counters[inner_solves] != 64) {
+    ++total_errors;
+  }
+  if (last_call.nanoseconds[cholesky] > totals.nanoseconds[cholesky]) {
+    ++total_errors;
+  }
+
+  // reset zeros the totals but not the last top-level profile
+  ResetProfile();
+  totals = GetProfileTotals();
+  for (int i = 0; i < kNumProfilePhases; ++i) {
+    if (totals.nanoseconds[i] != 0 || totals.calls[i] != 0) {
+      ++total_errors;
+    }
+  }
+  for (int i = 0; i < kNumProfileCounters; ++i) {
+    if (totals.counters[i] != 0) {
+      ++total_errors;
+    }
+  }
+  if (GetLastTopLevelProfile().counters[samples] != 17) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  With ``OL_PROFILE_ENABLED``, checks that building a GaussianProcess is timed under kGaussianProcessFit,
+  kCovarianceMatrixBuild, and kCholeskyFactorization. Without it, checks that the instrumentation records nothing.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ProfileInstrumentationTest() {
+  int total_errors = 0;
+  const int dim = 2;
+  const int num_sampled = 6;
+  std::vector<double> points_sampled(dim*num_sampled);
+  std::vector<double> points_sampled_value(num_sampled);
+  for (int i = 0; i < num_sampled; ++i) {
+    points_sampled[i*dim + 0] = 0.3*i;
+    points_sampled[i*dim + 1] = 1.0 - 0.1*i;
+    points_sampled_value[i] = 0.5*i - 1.0;
+  }
+  std::vector<double> noise_variance = {0.01};
+  SquareExponential covariance(dim, 1.0, 0.7);
+
+  ResetProfile();
+  {
+    ScopedTopLevelProfile top_level_call;
+    GaussianProcess gaussian_process(covariance, points_sampled.data(), points_sampled_value.data(),
+                                     noise_variance.data(), nullptr, 0, dim, num_sampled);
+  }
+  const ProfileReport last_call = GetLastTopLevelProfile();
+  const std::int64_t expected_calls = kProfilingEnabled ? 1 : 0;
+  for (auto phase : {ProfilePhase::kGaussianProcessFit, ProfilePhase::kCovarianceMatrixBuild,
+                     ProfilePhase::kCholeskyFactorization}) {
+    if (last_call.calls[static_cast<int>(phase)] != expected_calls) {
+      OL_ERROR_PRINTF("%s: %ld calls, expected %ld\n", ProfilePhaseName(phase),
+                      static_cast<long>(last_call.calls[static_cast<int>(phase)]), static_cast<long>(expected_calls));
+      ++total_errors;
+    }
+  }
+  ResetProfile();
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunProfilingTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = ProfileRegistryTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("profile registry failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = ProfileInstrumentationTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("profile instrumentation failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("profiling tests failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("profiling tests passed\n");
+  }
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
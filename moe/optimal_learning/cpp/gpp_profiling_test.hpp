@@ -0,0 +1,25 @@
+/*!
+  \file gpp_profiling_test.hpp
+  \rst
+  Functions for testing gpp_profiling's functionality: timer and counter accumulation, aggregation across threads,
+  top-level call profiles, ResetProfile(), and (when ``OL_PROFILE_ENABLED``) the instrumented GP fit.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the profiling tests.
+
+  \return
+    number of test failures: 0 if the profiling registry is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunProfilingTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PROFILING_TEST_HPP_
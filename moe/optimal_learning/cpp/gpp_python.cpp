@@ -34,8 +34,10 @@
 #include "gpp_python_expected_improvement_mcmc.hpp"
 #include "gpp_python_knowledge_gradient.hpp"
 #include "gpp_python_knowledge_gradient_mcmc.hpp"
+#include "gpp_python_lower_confidence_bound.hpp"
 #include "gpp_python_gaussian_process.hpp"
 #include "gpp_python_model_selection.hpp"
+#include "gpp_python_profiling.hpp"
 #include "gpp_python_test.hpp"
 
 namespace optimal_learning {
@@ -550,6 +552,8 @@ BOOST_PYTHON_MODULE(GPP) {
       * GaussianProcess: for one set of historical data (and hyperparameters), this represents the GP model. It is fairly
         expensive to create, so the intention is that users create it once and pass it to all functions in this module
         that need it (as opposed to recreating it every time).  Constructing the GP is noted as step 2 of MOE above.
+        It may be shared between Python threads: computations read it under a shared lock, and its mutators
+        (add_sampled_points, set_hyperparameters, sampling, reseeding) wait for them and take the lock exclusively.
       * GradientDescentParameters, NewtonParameters: structs that hold tolerances, max step counts, learning rates, etc.
         that control the behavior of the derivative-based optimizers
       * RandomnessSourceContainer: container for a uniform RNG and a normal (gaussian) RNG. These are needed by the C++ to
@@ -584,6 +588,12 @@ BOOST_PYTHON_MODULE(GPP) {
         hyperparameters. Equivalent to but much faster than calling compute_log_likelihood() in a loop.
       * evaluate_EI_at_point_list: compute expected improvement for each point (cohort parameters) in an input list.
         Equivalent to but much faster than calling compute_expected_improvement in a loop.
+
+    * Profiling:
+      With the instrumentation compiled in (cmake ``-D MOE_USE_PROFILING=1``), time spent in the GP fit, cholesky,
+      covariance builds, MC sampling, KG inner optimization, and python conversion is recorded per phase.
+
+      * profiling_enabled, get_profile_totals, get_last_profile, reset_profile
     )%%";
 
   ExportCppTestFunctions();
@@ -593,9 +603,11 @@ BOOST_PYTHON_MODULE(GPP) {
   ExportExpectedImprovementMCMCFunctions();
   ExportKnowldegeGradientFunctions();
   ExportKnowldegeGradientMCMCFunctions();
+  ExportLowerConfidenceBoundFunctions();
   ExportGaussianProcessFunctions();
   ExportModelSelectionFunctions();
   ExportOptimizerParameterStructs();
+  ExportProfilingFunctions();
   ExportRandomnessContainer();
 }  // end BOOST_PYTHON_MODULE(GPP) definition
 
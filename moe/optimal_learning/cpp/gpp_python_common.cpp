@@ -16,7 +16,9 @@
 
 // NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
 #include <cstdio>  // NOLINT(build/include_order)
+#include <cstring>  // NOLINT(build/include_order)
 
+#include <algorithm>  // NOLINT(build/include_order)
 #include <vector>  // NOLINT(build/include_order)
 
 #include <boost/python/args.hpp>  // NOLINT(build/include_order)
@@ -24,41 +26,164 @@
 #include <boost/python/enum.hpp>  // NOLINT(build/include_order)
 #include <boost/python/extract.hpp>  // NOLINT(build/include_order)
 #include <boost/python/list.hpp>  // NOLINT(build/include_order)
+#include <boost/python/object.hpp>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
 #include "gpp_domain.hpp"
+#include "gpp_hyperparameter_mcmc.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_model_selection.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_random.hpp"
 
 namespace optimal_learning {
 
-void CopyPylistToVector(const boost::python::list& input, int size, std::vector<double>& output) {
+namespace {  // utilities for reading Python buffers
+
+/*!\rst
+  RAII wrapper around a C-contiguous ``Py_buffer`` view of a Python object (e.g., a numpy array).
+  ``valid()`` is false if the object does not export such a buffer; no Python error is left set in that case.
+\endrst*/
+class ScopedPyBuffer {
+ public:
+  ScopedPyBuffer(const boost::python::object& input, bool writable) : valid_(false) {
+    const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_CheckBuffer(input.ptr())) {
+      if (PyObject_GetBuffer(input.ptr(), &view_, flags) == 0) {
+        valid_ = true;
+      } else {
+        PyErr_Clear();
+      }
+    }
+  }
+
+  ~ScopedPyBuffer() {
+    if (valid_) {
+      PyBuffer_Release(&view_);
+    }
+  }
+
+  bool valid() const noexcept {
+    return valid_;
+  }
+
+  /*!\rst
+    \return
+      struct-module type code of the buffer elements (e.g., 'd' for double) if they are in native byte order; '\\0' otherwise
+  \endrst*/
+  char type_code() const noexcept {
+    const char * format = (view_.format == nullptr) ? "B" : view_.format;
+    if (*format == '@' || *format == '=') {
+      ++format;
+    }
+    return (format[0] != '\0' && format[1] == '\0') ? format[0] : '\0';
+  }
+
+  int item_size() const noexcept {
+    return view_.itemsize;
+  }
+
+  //! number of elements in the buffer
+  Py_ssize_t size() const noexcept {
+    return view_.len/view_.itemsize;
+  }
+
+  void * data() const noexcept {
+    return view_.buf;
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ScopedPyBuffer);
+
+ private:
+  //! whether view_ holds a buffer that must be released
+  bool valid_;
+  //! buffer exported by the wrapped object
+  Py_buffer view_;
+};
+
+/*!\rst
+  Copies (and converts) the first size integers held in buffer into output, if the buffer holds at least size integers.
+
+  \return
+    true if the copy succeeded; false if buffer does not hold (enough) native integers
+\endrst*/
+template <typename IntegerType>
+bool CopyIntegerPybufferToIntVector(const ScopedPyBuffer& buffer, int size, std::vector<int>& output) {
+  if (buffer.item_size() != sizeof(IntegerType) || buffer.size() < size) {
+    return false;
+  }
+  IntegerType const * const input = static_cast<IntegerType const *>(buffer.data());
+  std::copy(input, input + size, output.begin());
+  return true;
+}
+
+}  // end unnamed namespace
+
+void CopyPylistToVector(const boost::python::object& input, int size, std::vector<double>& output) {
+  OL_PROFILE_SCOPE(ProfilePhase::kPythonConversion);
+  OL_PROFILE_COUNT(ProfileCounter::kPythonValuesConverted, size);
   output.resize(size);
+  ScopedPyBuffer buffer(input, false);
+  if (buffer.valid() && buffer.type_code() == 'd' && buffer.item_size() == sizeof(double) && buffer.size() >= size) {
+    std::memcpy(output.data(), buffer.data(), size*sizeof(double));
+    return;
+  }
+
   for (int i = 0; i < size; ++i) {
     output[i] = boost::python::extract<double>(input[i]);
   }
 }
 
 
-void CopyPylistToIntVector(const boost::python::list& input, int size, std::vector<int>& output) {
+void CopyPylistToIntVector(const boost::python::object& input, int size, std::vector<int>& output) {
+  OL_PROFILE_SCOPE(ProfilePhase::kPythonConversion);
+  OL_PROFILE_COUNT(ProfileCounter::kPythonValuesConverted, size);
   output.resize(size);
+  ScopedPyBuffer buffer(input, false);
+  if (buffer.valid()) {
+    bool copied = false;
+    switch (buffer.type_code()) {
+      case 'i': {
+        copied = CopyIntegerPybufferToIntVector<int>(buffer, size, output);
+        break;
+      }
+      case 'l': {
+        copied = CopyIntegerPybufferToIntVector<long>(buffer, size, output);  // NOLINT(runtime/int): matches Python's 'l'
+        break;
+      }
+      case 'q': {
+        copied = CopyIntegerPybufferToIntVector<long long>(buffer, size, output);  // NOLINT(runtime/int): matches Python's 'q'
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    if (copied) {
+      return;
+    }
+  }
+
   for (int i = 0; i < size; ++i) {
     output[i] = boost::python::extract<int>(input[i]);
   }
 }
 
-void CopyPylistToClosedIntervalVector(const boost::python::list& input, int size, std::vector<ClosedInterval>& output) {
+void CopyPylistToClosedIntervalVector(const boost::python::object& input, int size, std::vector<ClosedInterval>& output) {
+  std::vector<double> bounds;
+  CopyPylistToVector(input, 2*size, bounds);
   output.resize(size);
   for (int i = 0; i < size; ++i) {
-    output[i].min = boost::python::extract<double>(input[2*i + 0]);
-    output[i].max = boost::python::extract<double>(input[2*i + 1]);
+    output[i].min = bounds[2*i + 0];
+    output[i].max = bounds[2*i + 1];
   }
 }
 
 
 boost::python::list VectorToPylist(const std::vector<double>& input) {
+  OL_PROFILE_SCOPE(ProfilePhase::kPythonConversion);
+  OL_PROFILE_COUNT(ProfileCounter::kPythonValuesConverted, input.size());
   boost::python::list result;
   for (const auto& entry : input) {
     result.append(entry);
@@ -68,6 +193,8 @@ boost::python::list VectorToPylist(const std::vector<double>& input) {
 
 
 boost::python::list IntVectorToPylist(const std::vector<int>& input) {
+  OL_PROFILE_SCOPE(ProfilePhase::kPythonConversion);
+  OL_PROFILE_COUNT(ProfileCounter::kPythonValuesConverted, input.size());
   boost::python::list result;
   for (const auto& entry : input) {
     result.append(entry);
@@ -76,7 +203,25 @@ boost::python::list IntVectorToPylist(const std::vector<int>& input) {
 }
 
 
-PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::list& points_to_sample_in, const boost::python::list& derivatives_in,
+void CopyVectorToPybuffer(const std::vector<double>& input, boost::python::object output) {
+  OL_PROFILE_SCOPE(ProfilePhase::kPythonConversion);
+  OL_PROFILE_COUNT(ProfileCounter::kPythonValuesConverted, input.size());
+  {
+    ScopedPyBuffer buffer(output, true);
+    if (buffer.valid() && buffer.type_code() == 'd' && buffer.item_size() == sizeof(double) &&
+        buffer.size() == static_cast<Py_ssize_t>(input.size())) {
+      std::memcpy(buffer.data(), input.data(), input.size()*sizeof(double));
+      return;
+    }
+  }
+
+  for (std::vector<double>::size_type i = 0, size = input.size(); i < size; ++i) {
+    output[i] = input[i];
+  }
+}
+
+
+PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::object& points_to_sample_in, const boost::python::object& derivatives_in,
                                                              int dim_in, int num_to_sample_in, int num_derivatives_in)
     : dim(dim_in),
       num_to_sample(num_to_sample_in),
@@ -87,9 +232,9 @@ PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python
   CopyPylistToIntVector(derivatives_in, num_derivatives, derivatives);
 }
 
-PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::list& points_to_sample_in,
-                                                             const boost::python::list& points_being_sampled_in,
-                                                             const boost::python::list& derivatives_in,
+PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::object& points_to_sample_in,
+                                                             const boost::python::object& points_being_sampled_in,
+                                                             const boost::python::object& derivatives_in,
                                                              int dim_in, int num_to_sample_in, int num_being_sampled_in, int num_derivatives_in)
     : dim(dim_in),
       num_to_sample(num_to_sample_in),
@@ -104,9 +249,9 @@ PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python
 
 }
 
-PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::list& hyperparameters_in, const boost::python::list& points_sampled_in,
-                              const boost::python::list& points_sampled_value_in, const boost::python::list& noise_variance_in,
-                              const boost::python::list& points_to_sample_in, const boost::python::list& derivatives_in,
+PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python::object& hyperparameters_in, const boost::python::object& points_sampled_in,
+                              const boost::python::object& points_sampled_value_in, const boost::python::object& noise_variance_in,
+                              const boost::python::object& points_to_sample_in, const boost::python::object& derivatives_in,
                               int num_derivatives_in, int dim_in, int num_sampled_in, int num_to_sample_in)
     : dim(dim_in),
       num_sampled(num_sampled_in),
@@ -119,7 +264,7 @@ PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python
       noise_variance(1+num_derivatives_in),
       points_to_sample(dim*num_to_sample),
       derivatives(num_derivatives) {
-  const boost::python::list& lengths_in = boost::python::extract<boost::python::list>(hyperparameters_in[1]);
+  const boost::python::object lengths_in = hyperparameters_in[1];
   CopyPylistToVector(lengths_in, dim, lengths);
   CopyPylistToVector(points_sampled_in, dim*num_sampled, points_sampled);
   CopyPylistToVector(points_sampled_value_in, num_sampled*(1+num_derivatives_in), points_sampled_value);
@@ -128,6 +273,39 @@ PythonInterfaceInputContainer::PythonInterfaceInputContainer(const boost::python
   CopyPylistToIntVector(derivatives_in, num_derivatives, derivatives);
 }
 
+void SharedMutex::lock() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++num_waiting_writers_;
+  released_.wait(lock, [this]() { return !writer_active_ && num_readers_ == 0; });
+  --num_waiting_writers_;
+  writer_active_ = true;
+}
+
+void SharedMutex::unlock() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writer_active_ = false;
+  }
+  released_.notify_all();
+}
+
+void SharedMutex::lock_shared() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [this]() { return !writer_active_ && num_waiting_writers_ == 0; });
+  ++num_readers_;
+}
+
+void SharedMutex::unlock_shared() {
+  bool last_reader;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_reader = --num_readers_ == 0;
+  }
+  if (last_reader) {
+    released_.notify_all();
+  }
+}
+
 RandomnessSourceContainer::RandomnessSourceContainer(int num_threads)
     : uniform_generator(kUniformDefaultSeed),
       normal_rng_vec(num_threads),
@@ -136,30 +314,35 @@ RandomnessSourceContainer::RandomnessSourceContainer(int num_threads)
 }
 
 void RandomnessSourceContainer::SetExplicitUniformGeneratorSeed(NormalRNG::EngineType::result_type seed) {
+  std::lock_guard<std::mutex> lock(mutex);
   uniform_generator.SetExplicitSeed(seed);
 }
 
 void RandomnessSourceContainer::SetRandomizedUniformGeneratorSeed(NormalRNG::EngineType::result_type seed) {
+  std::lock_guard<std::mutex> lock(mutex);
   uniform_generator.SetRandomizedSeed(seed, 0);  // single instance, so thread_id = 0
 }
 
 void RandomnessSourceContainer::ResetUniformGeneratorState() {
+  std::lock_guard<std::mutex> lock(mutex);
   uniform_generator.ResetToMostRecentSeed();
 }
 
 void RandomnessSourceContainer::SetExplicitNormalRNGSeed(NormalRNG::EngineType::result_type seed) {
+  std::lock_guard<std::mutex> lock(mutex);
   for (IdentifyType<decltype(normal_rng_vec)>::type::size_type i = 0, size = normal_rng_vec.size(); i < size; ++i) {
     normal_rng_vec[i].SetExplicitSeed(seed + i);
   }
 }
 
 void RandomnessSourceContainer::SetRandomizedNormalRNGSeed(NormalRNG::EngineType::result_type seed) {
+  std::lock_guard<std::mutex> lock(mutex);
   for (IdentifyType<decltype(normal_rng_vec)>::type::size_type i = 0, size = normal_rng_vec.size(); i < size; ++i) {
     normal_rng_vec[i].SetRandomizedSeed(seed, i);
   }
 }
 
-bool RandomnessSourceContainer::SetNormalRNGSeedPythonList(const boost::python::list& seed_list, const boost::python::list& seed_flag_list) {
+bool RandomnessSourceContainer::SetNormalRNGSeedPythonList(const boost::python::object& seed_list, const boost::python::object& seed_flag_list) {
   auto seed_list_len = boost::python::len(seed_list);
   auto seed_flag_list_len = boost::python::len(seed_flag_list);
   IdentifyType<decltype(seed_flag_list_len)>::type num_threads = normal_rng_vec.size();
@@ -170,25 +353,34 @@ bool RandomnessSourceContainer::SetNormalRNGSeedPythonList(const boost::python::
     return false;
   }
 
-  NormalRNG::EngineType::result_type seed_value;
-  int flag_value;
+  // read the python lists first: they must not be touched while holding the mutex (see ScopedGILRelease)
+  std::vector<int> flag_values(num_threads);
+  std::vector<NormalRNG::EngineType::result_type> seed_values(num_threads);
+  for (auto i = 0l, size = num_threads; i < size; ++i) {
+    flag_values[i] = boost::python::extract<int>(seed_flag_list[i]);
+    if (flag_values[i]) {
+      seed_values[i] = boost::python::extract<int>(seed_list[i]);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
   for (auto i = 0l, size = num_threads; i < size; ++i) {
-    flag_value = boost::python::extract<int>(seed_flag_list[i]);
-    if (flag_value) {
-      seed_value = boost::python::extract<int>(seed_list[i]);
-      normal_rng_vec[i].SetExplicitSeed(seed_value);
+    if (flag_values[i]) {
+      normal_rng_vec[i].SetExplicitSeed(seed_values[i]);
     }
   }
   return true;
 }
 
 void RandomnessSourceContainer::ResetNormalRNGState() {
+  std::lock_guard<std::mutex> lock(mutex);
   for (auto& entry : normal_rng_vec) {
     entry.ResetToMostRecentSeed();
   }
 }
 
 void RandomnessSourceContainer::PrintState() {
+  std::lock_guard<std::mutex> lock(mutex);
   std::printf("Uniform:\n");
   uniform_generator.PrintState(&std::cout);
   for (IdentifyType<decltype(normal_rng_vec)>::type::size_type i = 0, size = normal_rng_vec.size(); i < size; ++i) {
@@ -204,10 +396,14 @@ void ExportEnumTypes() {
     * ``kNull``: null optimizer (use for 'dumb' search)
     * ``kGradientDescent``: gradient descent
     * ``kNewton``: Newton's Method
+    * ``kLBFGSB``: L-BFGS-B (limited-memory quasi-Newton with box constraints)
+    * ``kLineSearchGradientDescent``: gradient descent with an adaptive, Armijo-backtracked step size
       )%%")
       .value("null", OptimizerTypes::kNull)
       .value("gradient_descent", OptimizerTypes::kGradientDescent)
       .value("newton", OptimizerTypes::kNewton)
+      .value("l_bfgs_b", OptimizerTypes::kLBFGSB)
+      .value("line_search_gradient_descent", OptimizerTypes::kLineSearchGradientDescent)
       ;  // NOLINT, this is boost style
 
   boost::python::enum_<DomainTypes>("DomainTypes", R"%%(
@@ -234,9 +430,12 @@ void ExportEnumTypes() {
     * ``kLeaveOneOutLogLikelihood``: cross-validation based measure, this indicates how well
       the model explains itself by computing successive log likelihoods, leaving one
       training point out each time.
+    * ``kApproximateLogMarginalLikelihood``: matrix-free stochastic (Lanczos quadrature, conjugate gradient) estimate
+      of the log marginal likelihood for training sets too large to factor the covariance matrix.
       )%%")
       .value("log_marginal_likelihood", LogLikelihoodTypes::kLogMarginalLikelihood)
       .value("leave_one_out_log_likelihood", LogLikelihoodTypes::kLeaveOneOutLogLikelihood)
+      .value("approximate_log_marginal_likelihood", LogLikelihoodTypes::kApproximateLogMarginalLikelihood)
       ;  // NOLINT, this is boost style
 }
 
@@ -272,6 +471,7 @@ void ExportOptimizerParameterStructs() {
       .def_readwrite("pre_mult", &GradientDescentParameters::pre_mult, "scaling factor for step size (see struct docs or GradientDescentOptimizer) (suggest: 0.1-1.0)")
       .def_readwrite("max_relative_change", &GradientDescentParameters::max_relative_change, "max change allowed per GD iteration (as a relative fraction of current distance to wall), see ctor docstring")
       .def_readwrite("tolerance", &GradientDescentParameters::tolerance, "when the magnitude of the gradient falls below this value OR we will not move farther than tolerance")
+      .def_readwrite("record_traces", &GradientDescentParameters::record_traces, "record per-multistart traces (steps, final gradient norm, boundary hits, convergence, optimum reached) in the status dict (default: False)")
       ;  // NOLINT, this is boost style
 
   boost::python::class_<NewtonParameters, boost::noncopyable>("NewtonParameters", boost::python::init<int, int, double, double, double, double>(
@@ -298,6 +498,72 @@ void ExportOptimizerParameterStructs() {
       .def_readwrite("max_relative_change", &NewtonParameters::max_relative_change, "max change allowed per update (as a relative fraction of current distance to wall) (Newton may ignore this) (suggest: 1.0)")
       .def_readwrite("tolerance", &NewtonParameters::tolerance, "when the magnitude of the gradient falls below this value, stop (suggest: 1.0e-10)")
       ;  // NOLINT, this is boost style
+
+  boost::python::class_<LBFGSBParameters, boost::noncopyable>("LBFGSBParameters", boost::python::init<int, int, int, int, double>(
+      (boost::python::arg("num_multistarts"), "max_num_steps", "history_size", "max_num_line_search_steps", "tolerance"), R"%%(
+    Constructor for a LBFGSBParameters object.
+
+    :param num_multistarts: number of initial guesses to try in multistarted L-BFGS-B (suggest: a few hundred)
+    :type num_multistarts: int > 0
+    :param max_num_steps: maximum number of L-BFGS-B iterations (per initial guess) (suggest: 100-200)
+    :type max_num_steps: int > 0
+    :param history_size: number of correction pairs stored to approximate the inverse Hessian (suggest: 5-20)
+    :type history_size: int > 0
+    :param max_num_line_search_steps: maximum number of backtracking steps per line search (suggest: 20-40)
+    :type max_num_line_search_steps: int > 0
+    :param tolerance: when the infinity-norm of the projected gradient falls below this value, stop (suggest: 1.0e-10)
+    :type tolerance: float64 >= 0.0
+    )%%"))
+      .def_readwrite("num_multistarts", &LBFGSBParameters::num_multistarts, "number of initial guesses to try in multistarted L-BFGS-B (suggest: a few hundred)")
+      .def_readwrite("max_num_steps", &LBFGSBParameters::max_num_steps, "maximum number of L-BFGS-B iterations per initial guess (suggest: 100-200)")
+      .def_readwrite("history_size", &LBFGSBParameters::history_size, "number of correction pairs stored to approximate the inverse Hessian (suggest: 5-20)")
+      .def_readwrite("max_num_line_search_steps", &LBFGSBParameters::max_num_line_search_steps, "maximum number of backtracking steps per line search (suggest: 20-40)")
+      .def_readwrite("tolerance", &LBFGSBParameters::tolerance, "when the infinity-norm of the projected gradient falls below this value, stop (suggest: 1.0e-10)")
+      ;  // NOLINT, this is boost style
+
+  boost::python::class_<LineSearchGradientDescentParameters, boost::noncopyable>("LineSearchGradientDescentParameters", boost::python::init<int, int, int, double, double, double>(
+      (boost::python::arg("num_multistarts"), "max_num_steps", "max_num_line_search_steps", "initial_step_size", "max_relative_change", "tolerance"), R"%%(
+    Constructor for a LineSearchGradientDescentParameters object.
+
+    :param num_multistarts: number of initial guesses to try in multistarted line search gradient descent (suggest: a few hundred)
+    :type num_multistarts: int > 0
+    :param max_num_steps: maximum number of gradient descent iterations (per initial guess) (suggest: 100-500)
+    :type max_num_steps: int > 0
+    :param max_num_line_search_steps: maximum number of backtracking (step halving) trials per line search (suggest: 20-40)
+    :type max_num_line_search_steps: int > 0
+    :param initial_step_size: step size (multiplier on the gradient) tried on the first iteration (suggest: 0.1-1.0)
+    :type initial_step_size: float64 > 0.0
+    :param max_relative_change: max change allowed per update (as a relative fraction of current distance to wall) (suggest: 0.5-1.0)
+    :type max_relative_change: float64 in [0, 1]
+    :param tolerance: when the magnitude of the gradient OR of the accepted step falls below this value, stop (suggest: 1.0e-10)
+    :type tolerance: float64 >= 0.0
+    )%%"))
+      .def_readwrite("num_multistarts", &LineSearchGradientDescentParameters::num_multistarts, "number of initial guesses to try in multistarted line search gradient descent (suggest: a few hundred)")
+      .def_readwrite("max_num_steps", &LineSearchGradientDescentParameters::max_num_steps, "maximum number of gradient descent iterations per initial guess (suggest: 100-500)")
+      .def_readwrite("max_num_line_search_steps", &LineSearchGradientDescentParameters::max_num_line_search_steps, "maximum number of backtracking (step halving) trials per line search (suggest: 20-40)")
+      .def_readwrite("initial_step_size", &LineSearchGradientDescentParameters::initial_step_size, "step size (multiplier on the gradient) tried on the first iteration (suggest: 0.1-1.0)")
+      .def_readwrite("max_relative_change", &LineSearchGradientDescentParameters::max_relative_change, "max change allowed per update (as a relative fraction of current distance to wall) (suggest: 0.5-1.0)")
+      .def_readwrite("tolerance", &LineSearchGradientDescentParameters::tolerance, "when the magnitude of the gradient OR of the accepted step falls below this value, stop (suggest: 1.0e-10)")
+      ;  // NOLINT, this is boost style
+
+  boost::python::class_<SliceSamplerParameters, boost::noncopyable>("SliceSamplerParameters", boost::python::init<int, int, double, int>(
+      (boost::python::arg("num_burnin_sweeps"), "num_sweeps", "step_width", "max_num_stepping_out"), R"%%(
+    Constructor for a SliceSamplerParameters object (hyperparameter MCMC; see gpp_hyperparameter_mcmc.hpp).
+
+    :param num_burnin_sweeps: number of sweeps to discard before sampling (suggest: a few hundred on the first call, 0 when warm-starting)
+    :type num_burnin_sweeps: int >= 0
+    :param num_sweeps: number of sweeps after burn-in; the last one produces the sample (suggest: 10-50)
+    :type num_sweeps: int >= 0
+    :param step_width: initial width of the slice bracketing interval, in log-hyperparameter units (suggest: 1.0)
+    :type step_width: float64 > 0.0
+    :param max_num_stepping_out: maximum number of times the bracket is grown on each side (suggest: 10-50)
+    :type max_num_stepping_out: int > 0
+    )%%"))
+      .def_readwrite("num_burnin_sweeps", &SliceSamplerParameters::num_burnin_sweeps, "number of sweeps to discard before sampling")
+      .def_readwrite("num_sweeps", &SliceSamplerParameters::num_sweeps, "number of sweeps after burn-in; the last one produces the sample")
+      .def_readwrite("step_width", &SliceSamplerParameters::step_width, "initial width of the slice bracketing interval, in log-hyperparameter units")
+      .def_readwrite("max_num_stepping_out", &SliceSamplerParameters::max_num_stepping_out, "maximum number of times the bracket is grown on each side")
+      ;  // NOLINT, this is boost style
 }
 
 void ExportRandomnessContainer() {
@@ -8,9 +8,10 @@
   1. Tools for translating between C++ and Python data sources
 
      a. PythonInterfaceInputContainer: captures the most common set of inputs used in gpp_python
-     b. utilities for copying between std::vector and boost::python::list
+     b. utilities for copying between std::vector and Python sequences (boost::python::list, numpy arrays, etc.)
 
-  2. A RandomnessSourceContainer for moving consistent RNG state between C++, Python
+  2. A RandomnessSourceContainer for moving consistent RNG state between C++, Python, and the GIL release and locks
+     that make it and the Python GP handles (PythonModelHandle) safe to share between Python threads
   3. Export*() functions for giving Python access to various C++ calls via boost::python.
 
      a. enum classes
@@ -19,8 +20,9 @@
 
   Functions callable from Python generally have the following form:
 
-  1. Copy vector inputs from references of Python structures to C++ (e.g., boost::python::list to std::vector).
-     Items 1a) and 1b) are helpful for this.
+  1. Copy vector inputs from references of Python structures to C++ (e.g., boost::python::list or numpy.ndarray
+     to std::vector). Items 1a) and 1b) are helpful for this. Inputs are taken as ``boost::python::object`` so
+     that callers may pass either lists or arrays; see CopyPylistToVector() for the fast path for arrays.
   2. Construct any temporary objects needed by C++ (e.g., Evaluator/State pairs).
   3. Compute the desired result with C++ calls.
   4. Copy/return the desired result from C++ container back into a boost::python::list (or return directly for primitive types)
@@ -51,16 +53,23 @@
 #ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_COMMON_HPP_
 #define MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_COMMON_HPP_
 
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
 #include <vector>
 
 #include <boost/python/extract.hpp>  // NOLINT(build/include_order)
 #include <boost/python/list.hpp>  // NOLINT(build/include_order)
+#include <boost/python/object.hpp>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
 #include "gpp_random.hpp"
 
 namespace optimal_learning {
 
+class GaussianProcess;
+class GaussianProcessMCMC;
+
 /*!\rst
   Container class for translating a standard set of python (list) inputs into std::vector.
 \endrst*/
@@ -74,7 +83,7 @@ struct PythonInterfaceInputContainer {
       :dim: number of spatial dimension (independent parameters)
       :num_to_sample: number of points being sampled from the GP
   \endrst*/
-  PythonInterfaceInputContainer(const boost::python::list& points_to_sample_in, const boost::python::list& derivatives_in,
+  PythonInterfaceInputContainer(const boost::python::object& points_to_sample_in, const boost::python::object& derivatives_in,
                                 int dim_in, int num_to_sample_in, int num_derivatives_in);
 
   /*!\rst
@@ -88,9 +97,9 @@ struct PythonInterfaceInputContainer {
       :num_to_sample: number of potential future samples; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
       :num_being_sampled: number of points being sampled concurrently (i.e., the "p" in q,p-EI)
   \endrst*/
-  PythonInterfaceInputContainer(const boost::python::list& points_to_sample_in,
-                                const boost::python::list& points_being_sampled_in,
-                                const boost::python::list& derivatives_in,
+  PythonInterfaceInputContainer(const boost::python::object& points_to_sample_in,
+                                const boost::python::object& points_being_sampled_in,
+                                const boost::python::object& derivatives_in,
                                 int dim_in, int num_to_sample_in, int num_being_sampled_in, int num_derivatives_in);
 
   /*!\rst
@@ -108,9 +117,9 @@ struct PythonInterfaceInputContainer {
       :num_sampled: number of already-sampled points
       :num_to_sample: number of points being sampled from the GP
   \endrst*/
-  PythonInterfaceInputContainer(const boost::python::list& hyperparameters_in, const boost::python::list& points_sampled_in,
-                                const boost::python::list& points_sampled_value_in, const boost::python::list& noise_variance_in,
-                                const boost::python::list& points_to_sample_in, const boost::python::list& derivatives_in,
+  PythonInterfaceInputContainer(const boost::python::object& hyperparameters_in, const boost::python::object& points_sampled_in,
+                                const boost::python::object& points_sampled_value_in, const boost::python::object& noise_variance_in,
+                                const boost::python::object& points_to_sample_in, const boost::python::object& derivatives_in,
                                 int num_derivatives_in, int dim_in, int num_sampled_in, int num_to_sample_in);
 
   int dim;
@@ -130,6 +139,122 @@ struct PythonInterfaceInputContainer {
   std::vector<int> derivatives;
 };
 
+/*!\rst
+  RAII guard that releases the Python GIL for its lifetime so that other Python threads (e.g., threaded workers in
+  the REST service) can run while this thread computes in C++. The GIL is re-acquired on destruction, including
+  during stack unwinding, so exceptions still reach boost::python with the GIL held.
+
+  Wrappers should convert all inputs before constructing a guard and build their (python) outputs after it is
+  destroyed. Objects shared between Python threads must be locked while the GIL is released: a PythonModelHandle
+  by its ``mutex`` (shared to read the model, exclusive to change it), and a RandomnessSourceContainer by its
+  ``mutex`` before drawing from it. Lock after constructing the guard (so the locks are dropped before the GIL is
+  re-acquired) to avoid lock-order inversion; take a handle's lock before the randomness source's.
+
+  .. WARNING:: no Python API calls (including boost::python::object, list, dict, and extract operations) are allowed
+    while an instance is alive.
+\endrst*/
+class ScopedGILRelease {
+ public:
+  ScopedGILRelease() : thread_state_(PyEval_SaveThread()) {
+  }
+
+  ~ScopedGILRelease() {
+    PyEval_RestoreThread(thread_state_);
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(ScopedGILRelease);
+
+ private:
+  //! state of the calling thread, saved when the GIL was released
+  PyThreadState * thread_state_;
+};
+
+/*!\rst
+  Reader/writer lock (C++11 has no ``std::shared_mutex``): held by any number of readers (lock_shared()) or by one
+  writer (lock()). A waiting writer blocks new readers, so a steady stream of reads cannot starve it.
+
+  Lock readers with ScopedSharedLock and writers with ``std::lock_guard<SharedMutex>``.
+\endrst*/
+class SharedMutex {
+ public:
+  SharedMutex() : num_readers_(0), num_waiting_writers_(0), writer_active_(false) {
+  }
+
+  //! acquires exclusive ownership, waiting for the current readers or writer to leave
+  void lock();
+
+  //! releases exclusive ownership
+  void unlock();
+
+  //! acquires shared ownership, waiting while a writer holds or waits for the lock
+  void lock_shared();
+
+  //! releases shared ownership
+  void unlock_shared();
+
+  OL_DISALLOW_COPY_AND_ASSIGN(SharedMutex);
+
+ private:
+  //! guards the members below
+  std::mutex mutex_;
+  //! signaled whenever the lock is released
+  std::condition_variable released_;
+  //! number of readers holding the lock
+  int num_readers_;
+  //! number of writers waiting in lock()
+  int num_waiting_writers_;
+  //! true while a writer holds the lock
+  bool writer_active_;
+};
+
+//! RAII guard holding shared (reader) ownership of a SharedMutex for its lifetime
+class ScopedSharedLock {
+ public:
+  explicit ScopedSharedLock(SharedMutex& shared_mutex) : shared_mutex_(shared_mutex) {
+    shared_mutex_.lock_shared();
+  }
+
+  ~ScopedSharedLock() {
+    shared_mutex_.unlock_shared();
+  }
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ScopedSharedLock);
+
+ private:
+  SharedMutex& shared_mutex_;
+};
+
+/*!\rst
+  A C++ model exposed to Python as a long-lived handle (``GPP.GaussianProcess``, ``GPP.GaussianProcessMCMC``),
+  together with the lock that makes it safe to share between Python threads.
+
+  Wrappers release the GIL (ScopedGILRelease) and then lock ``mutex``: shared (ScopedSharedLock) to read ``model``,
+  exclusive (``std::lock_guard<SharedMutex>``) for anything that changes it (adding points, setting hyperparameters,
+  drawing from or reseeding its internal RNG). A mutator therefore waits for the computations in flight to finish and
+  never frees state (e.g., a Cholesky factor) out from under them. The model's dimensions (``dim()``,
+  ``num_derivatives()``, ``num_mcmc()``) are fixed at construction, so wrappers may read them without the lock to
+  convert their inputs.
+\endrst*/
+template <typename Model>
+struct PythonModelHandle {
+  //! constructs ``model`` from ``model_args``
+  template <typename... ModelArgs>
+  explicit PythonModelHandle(ModelArgs&&... model_args) : model(std::forward<ModelArgs>(model_args)...) {
+  }
+
+  //! the C++ model
+  Model model;
+  //! shared to read ``model``, exclusive to change it; see the class comments
+  mutable SharedMutex mutex;
+
+  OL_DISALLOW_COPY_AND_ASSIGN(PythonModelHandle);
+};
+
+//! Python handle of a GaussianProcess (``GPP.GaussianProcess``)
+using PythonGaussianProcess = PythonModelHandle<GaussianProcess>;
+//! Python handle of a GaussianProcessMCMC (``GPP.GaussianProcessMCMC``)
+using PythonGaussianProcessMCMC = PythonModelHandle<GaussianProcessMCMC>;
+
 /*!\rst
   Container for randomness sources to be used with the python interface.  Python should create a singleton of this object
   and then pass it back to any C++ function requiring randomness sources.  Outside of testing, we only want a single version
@@ -214,7 +339,7 @@ class RandomnessSourceContainer {
     \return
       true if successful, false otherwise (due to invalid sizes)
   \endrst*/
-  bool SetNormalRNGSeedPythonList(const boost::python::list& seed_list, const boost::python::list& seed_flag_list);
+  bool SetNormalRNGSeedPythonList(const boost::python::object& seed_list, const boost::python::object& seed_flag_list);
 
   /*!\rst
     Resets all threads' RNGs to the seed values they were initialized with.  Useful for testing.
@@ -227,6 +352,9 @@ class RandomnessSourceContainer {
   UniformRandomGenerator uniform_generator;
   //! The normal random generators (one per thread) that will be used by C++ to make N(0, 1)-distributed draws.
   std::vector<NormalRNG> normal_rng_vec;
+  //! Serializes access to the randomness sources across Python threads; hold it (after releasing the GIL, see
+  //! ScopedGILRelease) whenever C++ draws from this container, and in every member function that reseeds it.
+  std::mutex mutex;
 
   OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(RandomnessSourceContainer);
 
@@ -236,20 +364,28 @@ class RandomnessSourceContainer {
 };
 
 /*!\rst
-  Copies the first doubles elements of a python list (input) into a std::vector (output)
+  Copies the first size elements of a python sequence (input) into a std::vector (output)
   Resizes output if needed.
 
-  .. WARNING:: undefined behavior if the python list contains anything except type ``double``!
+  If input exports a C-contiguous buffer of native doubles (e.g., a flat or C-ordered ``numpy.float64`` array), the
+  buffer is copied directly with no per-element Python calls. Otherwise (e.g., python lists), elements are extracted
+  one at a time.
+
+  .. WARNING:: undefined behavior if the python sequence contains anything except type ``double``!
 
   \param
-    :input: python list to copy from
+    :input: python sequence (list, numpy array, etc.) to copy from
     :size: number of elements to copy
   \output
     :output: std::vector with copies of the first size items of input
 \endrst*/
-void CopyPylistToVector(const boost::python::list& input, int size, std::vector<double>& output);
+void CopyPylistToVector(const boost::python::object& input, int size, std::vector<double>& output);
 
-void CopyPylistToIntVector(const boost::python::list& input, int size, std::vector<int>& output);
+/*!\rst
+  Same as CopyPylistToVector(), for integers. The buffer fast path accepts native ``int``, ``long``, and ``long long``
+  elements (e.g., ``numpy.int32`` and ``numpy.int64`` arrays).
+\endrst*/
+void CopyPylistToIntVector(const boost::python::object& input, int size, std::vector<int>& output);
 
 /*!\rst
   Copies the first size [min, max] pairs from input to output.
@@ -263,7 +399,7 @@ void CopyPylistToIntVector(const boost::python::list& input, int size, std::vect
   \output
     :output: std::vector with copies of the first size items of input
 \endrst*/
-void CopyPylistToClosedIntervalVector(const boost::python::list& input, int size, std::vector<ClosedInterval>& output);
+void CopyPylistToClosedIntervalVector(const boost::python::object& input, int size, std::vector<ClosedInterval>& output);
 
 /*!\rst
   Produces a PyList with the same size as the input vector and that is
@@ -278,6 +414,19 @@ boost::python::list VectorToPylist(const std::vector<double>& input);
 
 boost::python::list IntVectorToPylist(const std::vector<int>& input);
 
+/*!\rst
+  Copies input into a caller-provided python sequence of the same size (e.g., a ``numpy.float64`` array), so that
+  results can be written in place instead of being returned as a new python list.
+
+  Writable C-contiguous buffers of native doubles are filled directly; other sequences are assigned element-wise.
+
+  \param
+    :input: std::vector to be copied
+  \output
+    :output: python sequence with ``len(output) == input.size()``, element-wise equal to input on exit
+\endrst*/
+void CopyVectorToPybuffer(const std::vector<double>& input, boost::python::object output);
+
 /*!\rst
   Export C++'s enum classes to Python; e.g., DomainTypes, OptimizerTypes, etc. Includes docstrings.
 \endrst*/
@@ -16,6 +16,7 @@
 #include "gpp_python_expected_improvement.hpp"
 
 // NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
+#include <mutex>  // NOLINT(build/include_order)
 #include <string>  // NOLINT(build/include_order)
 #include <vector>  // NOLINT(build/include_order)
 
@@ -30,10 +31,12 @@
 #include "gpp_common.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
+#include "gpp_expected_improvement_gpu.hpp"
 #include "gpp_geometry.hpp"
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 //#include "gpp_knowledge_gradient_optimization.hpp"
@@ -41,19 +44,24 @@
 namespace optimal_learning {
 
 namespace {
-double ComputeExpectedImprovementWrapper(const GaussianProcess& gaussian_process,
-                                         const boost::python::list& points_to_sample,
-                                         const boost::python::list& points_being_sampled,
+double ComputeExpectedImprovementWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                         const boost::python::object& points_to_sample,
+                                         const boost::python::object& points_being_sampled,
                                          int num_to_sample, int num_being_sampled,
                                          int max_int_steps, double best_so_far,
                                          bool force_monte_carlo,
                                          RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
   PythonInterfaceInputContainer input_container(points_to_sample, points_being_sampled, gradients, gaussian_process.dim(),
                                                 num_to_sample, num_being_sampled, num_derivatives_input);
 
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+  std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
   bool configure_for_gradients = false;
 /*  if ((num_to_sample == 1) && (num_being_sampled == 0) && (force_monte_carlo == false)) {
     OnePotentialSampleExpectedImprovementEvaluator ei_evaluator(gaussian_process, best_so_far);
@@ -73,13 +81,15 @@ double ComputeExpectedImprovementWrapper(const GaussianProcess& gaussian_process
 //  }
 }
 
-boost::python::list ComputeGradExpectedImprovementWrapper(const GaussianProcess& gaussian_process,
-                                                          const boost::python::list& points_to_sample,
-                                                          const boost::python::list& points_being_sampled,
+boost::python::list ComputeGradExpectedImprovementWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                                          const boost::python::object& points_to_sample,
+                                                          const boost::python::object& points_being_sampled,
                                                           int num_to_sample, int num_being_sampled,
                                                           int max_int_steps, double best_so_far,
                                                           bool force_monte_carlo,
                                                           RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -95,19 +105,65 @@ boost::python::list ComputeGradExpectedImprovementWrapper(const GaussianProcess&
                                                                        configure_for_gradients);
     ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
   } else {*/
-    ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
-    ExpectedImprovementEvaluator::StateType ei_state(ei_evaluator, input_container.points_to_sample.data(),
-                                                     input_container.points_being_sampled.data(),
-                                                     input_container.num_to_sample,
-                                                     input_container.num_being_sampled,
-                                                     configure_for_gradients,
-                                                     randomness_source.normal_rng_vec.data());
-    ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
+    {
+      ScopedGILRelease gil_release;
+      ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+      std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+      ExpectedImprovementEvaluator ei_evaluator(gaussian_process, max_int_steps, best_so_far);
+      ExpectedImprovementEvaluator::StateType ei_state(ei_evaluator, input_container.points_to_sample.data(),
+                                                       input_container.points_being_sampled.data(),
+                                                       input_container.num_to_sample,
+                                                       input_container.num_being_sampled,
+                                                       configure_for_gradients,
+                                                       randomness_source.normal_rng_vec.data());
+      ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
+    }
 //  }
 
   return VectorToPylist(grad_EI);
 }
 
+void ComputeExpectedImprovementBatchWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                            const boost::python::object& point_sets,
+                                            const boost::python::object& points_being_sampled,
+                                            int num_sets, int num_to_sample, int num_being_sampled,
+                                            int max_int_steps, double best_so_far, int max_num_threads,
+                                            RandomnessSourceContainer& randomness_source,
+                                            boost::python::object values,
+                                            boost::python::object gradients) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  // abort if we do not have enough sources of randomness to run with max_num_threads
+  if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
+  }
+
+  int num_derivatives_input = 0;
+  const boost::python::list derivatives;
+  PythonInterfaceInputContainer input_container(point_sets, points_being_sampled, derivatives, gaussian_process.dim(),
+                                                num_to_sample*num_sets, num_being_sampled, num_derivatives_input);
+
+  const bool compute_gradients = !gradients.is_none();
+  std::vector<double> values_C(num_sets);
+  std::vector<double> gradients_C(compute_gradients ? input_container.points_to_sample.size() : 0);
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_static);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    ComputeExpectedImprovementAtPointSets(gaussian_process, thread_schedule, input_container.points_to_sample.data(),
+                                          input_container.points_being_sampled.data(), num_sets, num_to_sample,
+                                          input_container.num_being_sampled, best_so_far, max_int_steps,
+                                          randomness_source.normal_rng_vec.data(), values_C.data(),
+                                          compute_gradients ? gradients_C.data() : nullptr);
+  }
+
+  CopyVectorToPybuffer(values_C, values);
+  if (compute_gradients) {
+    CopyVectorToPybuffer(gradients_C, gradients);
+  }
+}
+
 /*!\rst
   Utility that dispatches EI optimization based on optimizer type and num_to_sample.
   This is just used to reduce copy-pasted code.
@@ -135,7 +191,7 @@ boost::python::list ComputeGradExpectedImprovementWrapper(const GaussianProcess&
 \endrst*/
 template <typename DomainType>
 void DispatchExpectedImprovementOptimization(const boost::python::object& optimizer_parameters,
-                                             const GaussianProcess& gaussian_process,
+                                             const PythonGaussianProcess& gaussian_process_handle,
                                              const PythonInterfaceInputContainer& input_container,
                                              const DomainType& domain,
                                              OptimizerTypes optimizer_type,
@@ -145,10 +201,7 @@ void DispatchExpectedImprovementOptimization(const boost::python::object& optimi
                                              RandomnessSourceContainer& randomness_source,
                                              boost::python::dict& status,
                                              double * restrict best_points_to_sample) {
-#ifndef OL_GPU_ENABLED
-  (void) which_gpu;  // quiet the compiler warning (unused variable)
-#endif
-
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   bool found_flag = false;
   switch (optimizer_type) {
     case OptimizerTypes::kNull: {
@@ -156,28 +209,30 @@ void DispatchExpectedImprovementOptimization(const boost::python::object& optimi
       // optimizer_parameters must contain an int num_random_samples field, extract it
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
-/*      if (use_gpu == true) {
-#ifdef OL_GPU_ENABLED
-        CudaComputeOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, domain, thread_schedule,
-                                                                input_container.points_being_sampled.data(),
-                                                                num_random_samples, num_to_sample,
-                                                                input_container.num_being_sampled,
-                                                                best_so_far, max_int_steps, which_gpu, &found_flag,
-                                                                &randomness_source.uniform_generator,
-                                                                best_points_to_sample);
-#else
-        OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
-#endif
-      } else {*/
-        ComputeOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, domain, thread_schedule,
-                                                            input_container.points_being_sampled.data(),
-                                                            num_random_samples, num_to_sample,
-                                                            input_container.num_being_sampled,
-                                                            best_so_far, max_int_steps,
-                                                            &found_flag, &randomness_source.uniform_generator,
-                                                            randomness_source.normal_rng_vec.data(),
-                                                            best_points_to_sample);
-//      }
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        if (use_gpu == true) {
+          // throws if built without OL_GPU_ENABLED
+          CudaComputeOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, domain, thread_schedule,
+                                                                  input_container.points_being_sampled.data(),
+                                                                  num_random_samples, num_to_sample,
+                                                                  input_container.num_being_sampled,
+                                                                  best_so_far, max_int_steps, which_gpu, &found_flag,
+                                                                  &randomness_source.uniform_generator,
+                                                                  best_points_to_sample);
+        } else {
+          ComputeOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, domain, thread_schedule,
+                                                              input_container.points_being_sampled.data(),
+                                                              num_random_samples, num_to_sample,
+                                                              input_container.num_being_sampled,
+                                                              best_so_far, max_int_steps,
+                                                              &found_flag, &randomness_source.uniform_generator,
+                                                              randomness_source.normal_rng_vec.data(),
+                                                              best_points_to_sample);
+        }
+      }
       status[std::string("lhc_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
     }  // end case kNull optimizer_type
@@ -189,24 +244,26 @@ void DispatchExpectedImprovementOptimization(const boost::python::object& optimi
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
       bool random_search_only = false;
-/*      if (use_gpu == true) {
-#ifdef OL_GPU_ENABLED
-        CudaComputeOptimalPointsToSample(gaussian_process, gradient_descent_parameters, domain, thread_schedule,
-                                         input_container.points_being_sampled.data(), num_to_sample,
-                                         input_container.num_being_sampled, best_so_far, max_int_steps,
-                                         random_search_only, num_random_samples, which_gpu, &found_flag,
-                                         &randomness_source.uniform_generator, best_points_to_sample);
-#else
-        OL_THROW_EXCEPTION(OptimalLearningException, "GPU is not installed or enabled!");
-#endif
-      } else {*/
-        ComputeOptimalPointsToSample(gaussian_process, gradient_descent_parameters, domain, thread_schedule,
-                                     input_container.points_being_sampled.data(), num_to_sample,
-                                     input_container.num_being_sampled, best_so_far, max_int_steps,
-                                     random_search_only, num_random_samples, &found_flag,
-                                     &randomness_source.uniform_generator,
-                                     randomness_source.normal_rng_vec.data(), best_points_to_sample);
-//      }
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        if (use_gpu == true) {
+          // throws if built without OL_GPU_ENABLED
+          CudaComputeOptimalPointsToSample(gaussian_process, gradient_descent_parameters, domain, thread_schedule,
+                                           input_container.points_being_sampled.data(), num_to_sample,
+                                           input_container.num_being_sampled, best_so_far, max_int_steps,
+                                           random_search_only, num_random_samples, which_gpu, &found_flag,
+                                           &randomness_source.uniform_generator, best_points_to_sample);
+        } else {
+          ComputeOptimalPointsToSample(gaussian_process, gradient_descent_parameters, domain, thread_schedule,
+                                       input_container.points_being_sampled.data(), num_to_sample,
+                                       input_container.num_being_sampled, best_so_far, max_int_steps,
+                                       random_search_only, num_random_samples, &found_flag,
+                                       &randomness_source.uniform_generator,
+                                       randomness_source.normal_rng_vec.data(), best_points_to_sample);
+        }
+      }
       status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
     }  // end case kGradientDescent optimizer_type
@@ -219,14 +276,16 @@ void DispatchExpectedImprovementOptimization(const boost::python::object& optimi
 }
 
 boost::python::list MultistartExpectedImprovementOptimizationWrapper(const boost::python::object& optimizer_parameters,
-                                                                     const GaussianProcess& gaussian_process,
-                                                                     const boost::python::list& domain_bounds,
-                                                                     const boost::python::list& points_being_sampled,
+                                                                     const PythonGaussianProcess& gaussian_process_handle,
+                                                                     const boost::python::object& domain_bounds,
+                                                                     const boost::python::object& points_being_sampled,
                                                                      int num_to_sample, int num_being_sampled,
                                                                      double best_so_far, int max_int_steps,
                                                                      int max_num_threads, bool use_gpu, int which_gpu,
                                                                      RandomnessSourceContainer& randomness_source,
                                                                      boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   // TODO(GH-131): make domain objects constructible from python; and pass them in through
   // the optimizer_parameters python object
 
@@ -251,7 +310,7 @@ boost::python::list MultistartExpectedImprovementOptimizationWrapper(const boost
   switch (domain_type) {
     case DomainTypes::kTensorProduct: {
       TensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
-      DispatchExpectedImprovementOptimization(optimizer_parameters, gaussian_process, input_container,
+      DispatchExpectedImprovementOptimization(optimizer_parameters, gaussian_process_handle, input_container,
                                               domain, optimizer_type, num_to_sample, best_so_far,
                                               max_int_steps, max_num_threads, use_gpu, which_gpu,
                                               randomness_source, status, best_points_to_sample_C.data());
@@ -260,7 +319,7 @@ boost::python::list MultistartExpectedImprovementOptimizationWrapper(const boost
     case DomainTypes::kSimplex: {
       SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
 
-      DispatchExpectedImprovementOptimization(optimizer_parameters, gaussian_process, input_container,
+      DispatchExpectedImprovementOptimization(optimizer_parameters, gaussian_process_handle, input_container,
                                               domain, optimizer_type, num_to_sample, best_so_far,
                                               max_int_steps, max_num_threads, use_gpu, which_gpu,
                                               randomness_source, status, best_points_to_sample_C.data());
@@ -355,7 +414,7 @@ void DispatchHeuristicExpectedImprovementOptimization(const boost::python::objec
 
 boost::python::list HeuristicExpectedImprovementOptimizationWrapper(const boost::python::object& optimizer_parameters,
                                                                     const GaussianProcess& gaussian_process,
-                                                                    const boost::python::list& domain_bounds,
+                                                                    const boost::python::object& domain_bounds,
                                                                     const ObjectiveEstimationPolicyInterface& estimation_policy,
                                                                     int num_to_sample, double best_so_far, int max_num_threads,
                                                                     RandomnessSourceContainer& randomness_source,
@@ -399,14 +458,16 @@ boost::python::list HeuristicExpectedImprovementOptimizationWrapper(const boost:
   return VectorToPylist(best_points_to_sample_C);
 }
 */
-boost::python::list EvaluateEIAtPointListWrapper(const GaussianProcess& gaussian_process,
-                                                 const boost::python::list& initial_guesses,
-                                                 const boost::python::list& points_being_sampled,
+boost::python::list EvaluateEIAtPointListWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                                 const boost::python::object& initial_guesses,
+                                                 const boost::python::object& points_being_sampled,
                                                  int num_multistarts, int num_to_sample,
                                                  int num_being_sampled, double best_so_far,
                                                  int max_int_steps, int max_num_threads,
                                                  RandomnessSourceContainer& randomness_source,
                                                  boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   // abort if we do not have enough sources of randomness to run with max_num_threads
   if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
@@ -430,11 +491,16 @@ boost::python::list EvaluateEIAtPointListWrapper(const GaussianProcess& gaussian
 
   ThreadSchedule thread_schedule(max_num_threads, omp_sched_static);
   bool found_flag = false;
-  EvaluateEIAtPointList(gaussian_process, thread_schedule, initial_guesses_C.data(),
-                        input_container.points_being_sampled.data(), num_multistarts,
-                        num_to_sample, input_container.num_being_sampled, best_so_far,
-                        max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
-                        result_function_values_C.data(), result_point_C.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    EvaluateEIAtPointList(gaussian_process, thread_schedule, initial_guesses_C.data(),
+                          input_container.points_being_sampled.data(), num_multistarts,
+                          num_to_sample, input_container.num_being_sampled, best_so_far,
+                          max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
+                          result_function_values_C.data(), result_point_C.data());
+  }
 
   status["evaluate_EI_at_point_list"] = found_flag;
 
@@ -545,6 +611,47 @@ void ExportExpectedImprovementFunctions() {
     :rtype: list of float64 with shape (num_to_sample, dim)
     )%%");
 
+  boost::python::def("compute_expected_improvement_batch", ComputeExpectedImprovementBatchWrapper, R"%%(
+    Compute expected improvement, and optionally its gradient, of each of ``num_sets`` q-sets of points to sample.
+    Monte carlo-based EI computation is used (as in compute_expected_improvement() with force_monte_carlo).
+
+    Equivalent to::
+
+      for i, point_set in enumerate(point_sets):
+          values[i] = compute_expected_improvement(point_set, ...)
+          gradients[i] = compute_grad_expected_improvement(point_set, ...)
+
+    But the GP is converted and the EI states are built once, the loop runs in C++ on up to max_num_threads threads,
+    and the results are written into caller-provided arrays (e.g., preallocated ``numpy.float64`` arrays) instead of
+    being returned. Set ``i`` uses randomness source ``i % min(max_num_threads, num_sets)``.
+
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param point_sets: q-sets of points at which to evaluate EI and/or its gradient
+    :type point_sets: list of float64 with shape (num_sets, num_to_sample, dim)
+    :param points_being_sampled: points that are being sampled in concurrently experiments
+    :type points_being_sampled: list of float64 with shape (num_being_sampled, dim)
+    :param num_sets: number of q-sets in point_sets
+    :type num_sets: int > 0
+    :param num_to_sample: number of potential future samples per set; gradients are evaluated wrt these points (i.e., the "q" in q,p-EI)
+    :type num_to_sample: int > 0
+    :param num_being_sampled: number of points being sampled concurrently (i.e., the p in q,p-EI)
+    :type num_being_sampled: int >= 0
+    :param max_int_steps: number of MC integration points in EI
+    :type max_int_steps: int >= 0
+    :param best_so_far: best known value of objective so far
+    :type best_so_far: float64
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources (must hold at least max_num_threads sources)
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :param values: output, EI of each set of point_sets, in the same order
+    :type values: writable array of float64 with shape (num_sets)
+    :param gradients: output, gradient of EI of each set wrt its points to sample, in the same order; None to skip
+      the gradients
+    :type gradients: writable array of float64 with shape (num_sets, num_to_sample, dim), or None
+    )%%");
+
   boost::python::def("multistart_expected_improvement_optimization", MultistartExpectedImprovementOptimizationWrapper, R"%%(
     Optimize expected improvement (i.e., solve q,p-EI) over the specified domain using the specified optimization method.
     Can optimize for num_to_sample new points to sample (i.e., aka "q", experiments to run) simultaneously.
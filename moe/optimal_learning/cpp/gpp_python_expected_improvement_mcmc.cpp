@@ -27,6 +27,8 @@
 #include <boost/python/list.hpp>  // NOLINT(build/include_order)
 #include <boost/python/object.hpp>  // NOLINT(build/include_order)
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
@@ -37,18 +39,21 @@
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 namespace optimal_learning {
 
 namespace {
 
-double ComputeExpectedImprovementMCMCWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
-                                             const boost::python::list& points_to_sample,
-                                             const boost::python::list& points_being_sampled,
+double ComputeExpectedImprovementMCMCWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                             const boost::python::object& points_to_sample,
+                                             const boost::python::object& points_being_sampled,
                                              int num_to_sample, int num_being_sampled,
-                                             int max_int_steps, const boost::python::list& best_so_far,
+                                             int max_int_steps, const boost::python::object& best_so_far,
                                              RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -60,9 +65,12 @@ double ComputeExpectedImprovementMCMCWrapper(GaussianProcessMCMC& gaussian_proce
   std::vector<double> best_so_far_list(gaussian_process_mcmc.num_mcmc());
   CopyPylistToVector(best_so_far, gaussian_process_mcmc.num_mcmc(), best_so_far_list);
 
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+  std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
   std::vector<typename ExpectedImprovementState::EvaluatorType> evaluator_vector;
   ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps,
-                                                best_so_far_list.data(), &evaluator_vector);
+                                                best_so_far_list.data(), &evaluator_vector, omp_get_max_threads());
 
   std::vector<typename ExpectedImprovementEvaluator::StateType> state_vector;
   ExpectedImprovementMCMCEvaluator::StateType ei_state(ei_evaluator, input_container.points_to_sample.data(),
@@ -75,12 +83,14 @@ double ComputeExpectedImprovementMCMCWrapper(GaussianProcessMCMC& gaussian_proce
   return ei_evaluator.ComputeExpectedImprovement(&ei_state);
 }
 
-boost::python::list ComputeGradExpectedImprovementMCMCWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
-                                                              const boost::python::list& points_to_sample,
-                                                              const boost::python::list& points_being_sampled,
+boost::python::list ComputeGradExpectedImprovementMCMCWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                              const boost::python::object& points_to_sample,
+                                                              const boost::python::object& points_being_sampled,
                                                               int num_to_sample, int num_being_sampled,
-                                                              int max_int_steps, const boost::python::list& best_so_far,
+                                                              int max_int_steps, const boost::python::object& best_so_far,
                                                               RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -93,19 +103,24 @@ boost::python::list ComputeGradExpectedImprovementMCMCWrapper(GaussianProcessMCM
   std::vector<double> best_so_far_list(gaussian_process_mcmc.num_mcmc());
   CopyPylistToVector(best_so_far, gaussian_process_mcmc.num_mcmc(), best_so_far_list);
 
-  std::vector<typename ExpectedImprovementState::EvaluatorType> evaluator_vector;
-  ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps,
-                                                best_so_far_list.data(), &evaluator_vector);
-
-  std::vector<typename ExpectedImprovementEvaluator::StateType> state_vector;
-  ExpectedImprovementMCMCEvaluator::StateType ei_state(ei_evaluator, input_container.points_to_sample.data(),
-                                                       input_container.points_being_sampled.data(),
-                                                       input_container.num_to_sample,
-                                                       input_container.num_being_sampled,
-                                                       gaussian_process_mcmc.derivatives().data(),
-                                                       gaussian_process_mcmc.num_derivatives(), configure_for_gradients,
-                                                       randomness_source.normal_rng_vec.data(), &state_vector);
-  ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    std::vector<typename ExpectedImprovementState::EvaluatorType> evaluator_vector;
+    ExpectedImprovementMCMCEvaluator ei_evaluator(gaussian_process_mcmc, max_int_steps,
+                                                  best_so_far_list.data(), &evaluator_vector, omp_get_max_threads());
+
+    std::vector<typename ExpectedImprovementEvaluator::StateType> state_vector;
+    ExpectedImprovementMCMCEvaluator::StateType ei_state(ei_evaluator, input_container.points_to_sample.data(),
+                                                         input_container.points_being_sampled.data(),
+                                                         input_container.num_to_sample,
+                                                         input_container.num_being_sampled,
+                                                         gaussian_process_mcmc.derivatives().data(),
+                                                         gaussian_process_mcmc.num_derivatives(), configure_for_gradients,
+                                                         randomness_source.normal_rng_vec.data(), &state_vector);
+    ei_evaluator.ComputeGradExpectedImprovement(&ei_state, grad_EI.data());
+  }
 
   return VectorToPylist(grad_EI);
 }
@@ -137,7 +152,7 @@ boost::python::list ComputeGradExpectedImprovementMCMCWrapper(GaussianProcessMCM
 \endrst*/
 template <typename DomainType>
 void DispatchExpectedImprovementMCMCOptimization(const boost::python::object& optimizer_parameters,
-                                                 GaussianProcessMCMC& gaussian_process_mcmc,
+                                                 PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
                                                  const PythonInterfaceInputContainer& input_container,
                                                  const DomainType& domain, OptimizerTypes optimizer_type,
                                                  int num_to_sample, std::vector<double> best_so_far_list,
@@ -145,6 +160,7 @@ void DispatchExpectedImprovementMCMCOptimization(const boost::python::object& op
                                                  RandomnessSourceContainer& randomness_source,
                                                  boost::python::dict& status,
                                                  double * restrict best_points_to_sample) {
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
 
   bool found_flag = false;
 
@@ -154,14 +170,19 @@ void DispatchExpectedImprovementMCMCOptimization(const boost::python::object& op
       // optimizer_parameters must contain an int num_random_samples field, extract it
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
-      ComputeEIMCMCOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process_mcmc, domain, thread_schedule,
-                                                                input_container.points_being_sampled.data(),
-                                                                num_random_samples, num_to_sample,
-                                                                input_container.num_being_sampled,
-                                                                best_so_far_list.data(), max_int_steps,
-                                                                &found_flag, &randomness_source.uniform_generator,
-                                                                randomness_source.normal_rng_vec.data(),
-                                                                best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeEIMCMCOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process_mcmc, domain, thread_schedule,
+                                                                  input_container.points_being_sampled.data(),
+                                                                  num_random_samples, num_to_sample,
+                                                                  input_container.num_being_sampled,
+                                                                  best_so_far_list.data(), max_int_steps,
+                                                                  &found_flag, &randomness_source.uniform_generator,
+                                                                  randomness_source.normal_rng_vec.data(),
+                                                                  best_points_to_sample);
+      }
       status[std::string("lhc_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
     }  // end case kNull optimizer_type
@@ -173,11 +194,16 @@ void DispatchExpectedImprovementMCMCOptimization(const boost::python::object& op
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
       bool random_search_only = false;
-      ComputeEIMCMCOptimalPointsToSample(gaussian_process_mcmc, gradient_descent_parameters, domain, thread_schedule,
-                                         input_container.points_being_sampled.data(),
-                                         num_to_sample, input_container.num_being_sampled,
-                                         best_so_far_list.data(), max_int_steps, random_search_only, num_random_samples, &found_flag,
-                                         &randomness_source.uniform_generator, randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeEIMCMCOptimalPointsToSample(gaussian_process_mcmc, gradient_descent_parameters, domain, thread_schedule,
+                                           input_container.points_being_sampled.data(),
+                                           num_to_sample, input_container.num_being_sampled,
+                                           best_so_far_list.data(), max_int_steps, random_search_only, num_random_samples, &found_flag,
+                                           &randomness_source.uniform_generator, randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      }
 
       status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
@@ -191,13 +217,15 @@ void DispatchExpectedImprovementMCMCOptimization(const boost::python::object& op
 }
 
 boost::python::list MultistartExpectedImprovementMCMCOptimizationWrapper(const boost::python::object& optimizer_parameters,
-                                                                       GaussianProcessMCMC& gaussian_process_mcmc,
-                                                                       const boost::python::list& domain_bounds,
-                                                                       const boost::python::list& points_being_sampled,
+                                                                       PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                                       const boost::python::object& domain_bounds,
+                                                                       const boost::python::object& points_being_sampled,
                                                                        int num_to_sample, int num_being_sampled,
-                                                                       const boost::python::list& best_so_far, int max_int_steps, int max_num_threads,
+                                                                       const boost::python::object& best_so_far, int max_int_steps, int max_num_threads,
                                                                        RandomnessSourceContainer& randomness_source,
                                                                        boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   // TODO(GH-131): make domain objects constructible from python; and pass them in through
   // the optimizer_parameters python object
 
@@ -229,7 +257,7 @@ boost::python::list MultistartExpectedImprovementMCMCOptimizationWrapper(const b
     case DomainTypes::kTensorProduct: {
       TensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
 
-      DispatchExpectedImprovementMCMCOptimization(optimizer_parameters, gaussian_process_mcmc,
+      DispatchExpectedImprovementMCMCOptimization(optimizer_parameters, gaussian_process_mcmc_handle,
                                                   input_container, domain, optimizer_type, num_to_sample, best_so_far_list,
                                                   max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -237,7 +265,7 @@ boost::python::list MultistartExpectedImprovementMCMCOptimizationWrapper(const b
     case DomainTypes::kSimplex: {
       SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
 
-      DispatchExpectedImprovementMCMCOptimization(optimizer_parameters, gaussian_process_mcmc,
+      DispatchExpectedImprovementMCMCOptimization(optimizer_parameters, gaussian_process_mcmc_handle,
                                                   input_container, domain, optimizer_type, num_to_sample, best_so_far_list,
                                                   max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -252,14 +280,16 @@ boost::python::list MultistartExpectedImprovementMCMCOptimizationWrapper(const b
   return VectorToPylist(best_points_to_sample_C);
 }
 
-boost::python::list EvaluateEIMCMCAtPointListWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
-                                                     const boost::python::list& initial_guesses,
-                                                     const boost::python::list& points_being_sampled,
+boost::python::list EvaluateEIMCMCAtPointListWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                     const boost::python::object& initial_guesses,
+                                                     const boost::python::object& points_being_sampled,
                                                      int num_multistarts, int num_to_sample,
-                                                     int num_being_sampled, const boost::python::list& best_so_far,
+                                                     int num_being_sampled, const boost::python::object& best_so_far,
                                                      int max_int_steps, int max_num_threads,
                                                      RandomnessSourceContainer& randomness_source,
                                                      boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   // abort if we do not have enough sources of randomness to run with max_num_threads
   if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
@@ -286,11 +316,16 @@ boost::python::list EvaluateEIMCMCAtPointListWrapper(GaussianProcessMCMC& gaussi
   std::vector<double> best_so_far_list(gaussian_process_mcmc.num_mcmc());
   CopyPylistToVector(best_so_far, gaussian_process_mcmc.num_mcmc(), best_so_far_list);
 
-  EvaluateEIMCMCAtPointList(gaussian_process_mcmc, thread_schedule, initial_guesses_C.data(),
-                            input_container.points_being_sampled.data(),
-                            num_multistarts, num_to_sample, input_container.num_being_sampled,
-                            best_so_far_list.data(), max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
-                            result_function_values_C.data(), result_point_C.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    EvaluateEIMCMCAtPointList(gaussian_process_mcmc, thread_schedule, initial_guesses_C.data(),
+                              input_container.points_being_sampled.data(),
+                              num_multistarts, num_to_sample, input_container.num_being_sampled,
+                              best_so_far_list.data(), max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
+                              result_function_values_C.data(), result_point_C.data());
+  }
 
   status["evaluate_EI_at_point_list"] = found_flag;
 
@@ -16,6 +16,8 @@
 #include "gpp_python_gaussian_process.hpp"
 
 // NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
+#include <algorithm>  // NOLINT(build/include_order)
+#include <mutex>  // NOLINT(build/c++11)
 #include <vector>  // NOLINT(build/include_order)
 
 #include <boost/python/def.hpp>  // NOLINT(build/include_order)
@@ -29,6 +31,9 @@
 #include "gpp_linear_algebra.hpp"
 #include "gpp_logging.hpp"
 #include "gpp_math.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_posterior_sample.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 namespace optimal_learning {
@@ -37,31 +42,37 @@ namespace {
 
 /*!\rst
   Surrogate "constructor" for GaussianProcess intended only for use by boost::python.  This aliases the normal C++ constructor,
-  replacing ``double const * restrict`` arguments with ``const boost::python::list&`` arguments.
+  replacing ``double const * restrict`` arguments with ``const boost::python::object&`` arguments, and wraps the GP in a
+  PythonGaussianProcess handle (see gpp_python_common.hpp).
 \endrst*/
-GaussianProcess * make_gaussian_process(const boost::python::list& hyperparameters,
-                                        const boost::python::list& points_sampled,
-                                        const boost::python::list& points_sampled_value,
-                                        const boost::python::list& noise_variance,
-                                        const boost::python::list& derivatives,
+PythonGaussianProcess * make_gaussian_process(const boost::python::object& hyperparameters,
+                                        const boost::python::object& points_sampled,
+                                        const boost::python::object& points_sampled_value,
+                                        const boost::python::object& noise_variance,
+                                        const boost::python::object& derivatives,
                                         int num_derivatives, int dim, int num_sampled) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   const int num_to_sample = 0;
   const boost::python::list points_to_sample_dummy;
   PythonInterfaceInputContainer input_container(hyperparameters, points_sampled, points_sampled_value, noise_variance,
                                                 points_to_sample_dummy, derivatives, num_derivatives, dim, num_sampled, num_to_sample);
 
+  ScopedGILRelease gil_release;
   SquareExponential sqexp(input_container.dim, input_container.alpha, input_container.lengths.data());
 
-  GaussianProcess * new_gp = new GaussianProcess(sqexp, input_container.points_sampled.data(),
-                                                 input_container.points_sampled_value.data(),
-                                                 input_container.noise_variance.data(),
-                                                 input_container.derivatives.data(), input_container.num_derivatives,
-                                                 input_container.dim, input_container.num_sampled);
-  new_gp->SetRandomizedSeed(0);
+  PythonGaussianProcess * new_gp = new PythonGaussianProcess(sqexp, input_container.points_sampled.data(),
+                                                             input_container.points_sampled_value.data(),
+                                                             input_container.noise_variance.data(),
+                                                             input_container.derivatives.data(),
+                                                             input_container.num_derivatives, input_container.dim,
+                                                             input_container.num_sampled);
+  new_gp->model.SetRandomizedSeed(0);
   return new_gp;
 }
 
-boost::python::list GetMeanWrapper(const GaussianProcess& gaussian_process, const boost::python::list& points_to_sample, int num_to_sample) {
+boost::python::list GetMeanWrapper(const PythonGaussianProcess& gaussian_process_handle, const boost::python::object& points_to_sample, int num_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -70,17 +81,71 @@ boost::python::list GetMeanWrapper(const GaussianProcess& gaussian_process, cons
 
   std::vector<double> to_sample_mean(input_container.num_to_sample);
   int num_derivatives = 0;
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, nullptr, 0, num_derivatives);
-  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, to_sample_mean.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, nullptr, 0, num_derivatives);
+    gaussian_process.ComputeMeanOfPoints(points_to_sample_state, to_sample_mean.data());
+  }
 
   return VectorToPylist(to_sample_mean);
 }
 
 
-boost::python::list GetAdditionalMeanWrapper(const GaussianProcess& gaussian_process,
-                                             const boost::python::list& discrete_pts,
+boost::python::list PredictMarginalsWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                            const boost::python::object& points_to_sample,
+                                            int num_to_sample, int max_num_threads) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process.dim(),
+                                                num_to_sample, num_derivatives_input);
+
+  // means first, then variances
+  std::vector<double> marginals(2*input_container.num_to_sample);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    gaussian_process.PredictMarginals(input_container.points_to_sample.data(), input_container.num_to_sample, max_num_threads,
+                                      marginals.data(), marginals.data() + input_container.num_to_sample);
+  }
+
+  return VectorToPylist(marginals);
+}
+
+void PredictMarginalsInPlaceWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                    const boost::python::object& points_to_sample, int num_to_sample,
+                                    int max_num_threads, boost::python::object mean_of_points,
+                                    boost::python::object variance_of_points) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process.dim(),
+                                                num_to_sample, num_derivatives_input);
+
+  std::vector<double> mean(input_container.num_to_sample);
+  std::vector<double> variance(input_container.num_to_sample);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    gaussian_process.PredictMarginals(input_container.points_to_sample.data(), input_container.num_to_sample, max_num_threads,
+                                      mean.data(), variance.data());
+  }
+
+  CopyVectorToPybuffer(mean, mean_of_points);
+  CopyVectorToPybuffer(variance, variance_of_points);
+}
+
+boost::python::list GetAdditionalMeanWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                             const boost::python::object& discrete_pts,
                                              int num_pts) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -89,15 +154,21 @@ boost::python::list GetAdditionalMeanWrapper(const GaussianProcess& gaussian_pro
 
   std::vector<double> to_sample_mean(input_container.num_to_sample);
 
-  gaussian_process.ComputeMeanOfAdditionalPoints(input_container.points_to_sample.data(), input_container.num_to_sample,
-                                                 nullptr, 0, to_sample_mean.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    gaussian_process.ComputeMeanOfAdditionalPoints(input_container.points_to_sample.data(), input_container.num_to_sample,
+                                                   nullptr, 0, to_sample_mean.data());
+  }
 
   return VectorToPylist(to_sample_mean);
 }
 
-boost::python::list GetGradMeanWrapper(const GaussianProcess& gaussian_process,
-                                       const boost::python::list& points_to_sample,
+boost::python::list GetGradMeanWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                       const boost::python::object& points_to_sample,
                                        int num_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -106,18 +177,24 @@ boost::python::list GetGradMeanWrapper(const GaussianProcess& gaussian_process,
 
   std::vector<double> to_sample_grad_mean(input_container.dim * input_container.num_to_sample * (1+gaussian_process.num_derivatives()));
   int num_derivatives = num_to_sample;
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, gaussian_process.derivatives().data(),
-                                                    gaussian_process.num_derivatives(), num_derivatives);
-
-  gaussian_process.ComputeGradMeanOfPoints(points_to_sample_state, to_sample_grad_mean.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, gaussian_process.derivatives().data(),
+                                                      gaussian_process.num_derivatives(), num_derivatives);
+
+    gaussian_process.ComputeGradMeanOfPoints(points_to_sample_state, to_sample_grad_mean.data());
+  }
 
   return VectorToPylist(to_sample_grad_mean);
 }
 
-boost::python::list GetVarWrapper(const GaussianProcess& gaussian_process,
-                                  const boost::python::list& points_to_sample,
+boost::python::list GetVarWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                  const boost::python::object& points_to_sample,
                                   int num_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -126,12 +203,16 @@ boost::python::list GetVarWrapper(const GaussianProcess& gaussian_process,
 
   std::vector<double> to_sample_var(Square(input_container.num_to_sample * (1+gaussian_process.num_derivatives())));
   int num_derivatives = 0;
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, gaussian_process.derivatives().data(),
-                                                    gaussian_process.num_derivatives(), num_derivatives);
-
-  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
-                                           gaussian_process.num_derivatives(), to_sample_var.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, gaussian_process.derivatives().data(),
+                                                      gaussian_process.num_derivatives(), num_derivatives);
+
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
+                                             gaussian_process.num_derivatives(), to_sample_var.data());
+  }
 
   boost::python::list result;
 
@@ -153,9 +234,11 @@ boost::python::list GetVarWrapper(const GaussianProcess& gaussian_process,
 }
 
 
-boost::python::list GetCholVarWrapper(const GaussianProcess& gaussian_process,
-                                      const boost::python::list& points_to_sample,
+boost::python::list GetCholVarWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                      const boost::python::object& points_to_sample,
                                       int num_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
   PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process.dim(),
@@ -163,15 +246,19 @@ boost::python::list GetCholVarWrapper(const GaussianProcess& gaussian_process,
 
   std::vector<double> chol_var(Square(input_container.num_to_sample * (1+gaussian_process.num_derivatives())));
   int num_derivatives = 0;
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, gaussian_process.derivatives().data(),
-                                                    gaussian_process.num_derivatives(), num_derivatives);
-
-  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
-                                           gaussian_process.num_derivatives(), chol_var.data());
-  int leading_minor = ComputeCholeskyFactorL(num_to_sample * (1+gaussian_process.num_derivatives()), chol_var.data());
-  if (unlikely(leading_minor != 0)) {
-    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample or points_to_sample duplicating points_sampled with 0 noise.", chol_var.data(), num_to_sample, leading_minor);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, gaussian_process.derivatives().data(),
+                                                      gaussian_process.num_derivatives(), num_derivatives);
+
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
+                                             gaussian_process.num_derivatives(), chol_var.data());
+    int leading_minor = ComputeCholeskyFactorL(num_to_sample * (1+gaussian_process.num_derivatives()), chol_var.data());
+    if (unlikely(leading_minor != 0)) {
+      OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample or points_to_sample duplicating points_sampled with 0 noise.", chol_var.data(), num_to_sample, leading_minor);
+    }
   }
 
   boost::python::list result;
@@ -186,9 +273,11 @@ boost::python::list GetCholVarWrapper(const GaussianProcess& gaussian_process,
 }
 
 
-boost::python::list GetGradVarWrapper(const GaussianProcess& gaussian_process,
-                                      const boost::python::list& points_to_sample,
+boost::python::list GetGradVarWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                      const boost::python::object& points_to_sample,
                                       int num_to_sample, int num_derivatives) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input =0;
   const boost::python::list gradients;
 
@@ -197,18 +286,24 @@ boost::python::list GetGradVarWrapper(const GaussianProcess& gaussian_process,
 
   std::vector<double> to_sample_grad_var(input_container.dim*Square(input_container.num_to_sample * (1+gaussian_process.num_derivatives()))*num_derivatives);
 
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, gaussian_process.derivatives().data(),
-                                                    gaussian_process.num_derivatives(), num_derivatives);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, gaussian_process.derivatives().data(),
+                                                      gaussian_process.num_derivatives(), num_derivatives);
 
-  gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, to_sample_grad_var.data());
+    gaussian_process.ComputeGradVarianceOfPoints(&points_to_sample_state, to_sample_grad_var.data());
+  }
 
   return VectorToPylist(to_sample_grad_var);
 }
 
-boost::python::list GetGradCholVarWrapper(const GaussianProcess& gaussian_process,
-                                          const boost::python::list& points_to_sample,
+boost::python::list GetGradCholVarWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                          const boost::python::object& points_to_sample,
                                           int num_to_sample, int num_derivatives) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -218,28 +313,34 @@ boost::python::list GetGradCholVarWrapper(const GaussianProcess& gaussian_proces
   std::vector<double> to_sample_grad_var(input_container.dim*Square(input_container.num_to_sample * (1+gaussian_process.num_derivatives()))*num_derivatives);
   std::vector<double> chol_var(Square(input_container.num_to_sample * (1+gaussian_process.num_derivatives())));
 
-  GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
-                                                    input_container.num_to_sample, gaussian_process.derivatives().data(),
-                                                    gaussian_process.num_derivatives(), num_derivatives);
-
-  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
-                                           gaussian_process.num_derivatives(), chol_var.data());
-  int leading_minor = ComputeCholeskyFactorL(input_container.num_to_sample * (1+gaussian_process.num_derivatives()), chol_var.data());
-  if (unlikely(leading_minor != 0)) {
-    OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample or points_to_sample duplicating points_sampled with 0 noise.",
-                       chol_var.data(), num_to_sample * (1+gaussian_process.num_derivatives()), leading_minor);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    GaussianProcess::StateType points_to_sample_state(gaussian_process, input_container.points_to_sample.data(),
+                                                      input_container.num_to_sample, gaussian_process.derivatives().data(),
+                                                      gaussian_process.num_derivatives(), num_derivatives);
+
+    gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, gaussian_process.derivatives().data(),
+                                             gaussian_process.num_derivatives(), chol_var.data());
+    int leading_minor = ComputeCholeskyFactorL(input_container.num_to_sample * (1+gaussian_process.num_derivatives()), chol_var.data());
+    if (unlikely(leading_minor != 0)) {
+      OL_THROW_EXCEPTION(SingularMatrixException, "GP-Variance matrix singular. Check for duplicate points_to_sample or points_to_sample duplicating points_sampled with 0 noise.",
+                         chol_var.data(), num_to_sample * (1+gaussian_process.num_derivatives()), leading_minor);
+    }
+    gaussian_process.ComputeGradCholeskyVarianceOfPoints(&points_to_sample_state, chol_var.data(),
+                                                         to_sample_grad_var.data());
   }
-  gaussian_process.ComputeGradCholeskyVarianceOfPoints(&points_to_sample_state, chol_var.data(),
-                                                       to_sample_grad_var.data());
 
   return VectorToPylist(to_sample_grad_var);
 }
 
-void AddPointsToGPWrapper(GaussianProcess * gaussian_process,
-                          const boost::python::list& new_points,
-                          const boost::python::list& new_points_value,
-                          //const boost::python::list& new_points_noise_variance,
+void AddPointsToGPWrapper(PythonGaussianProcess * gaussian_process_handle,
+                          const boost::python::object& new_points,
+                          const boost::python::object& new_points_value,
+                          //const boost::python::object& new_points_noise_variance,
                           int num_new_points) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcess * gaussian_process = &gaussian_process_handle->model;
   int dim = gaussian_process->dim();
   std::vector<double> new_points_C(dim*num_new_points);
   std::vector<double> new_points_value_C(num_new_points * (1 + gaussian_process->num_derivatives()));
@@ -249,11 +350,36 @@ void AddPointsToGPWrapper(GaussianProcess * gaussian_process,
   CopyPylistToVector(new_points_value, num_new_points * (1 + gaussian_process->num_derivatives()), new_points_value_C);
   //CopyPylistToVector(new_points_noise_variance, num_new_points, new_points_noise_variance_C);
 
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
   gaussian_process->AddPointsToGP(new_points_C.data(), new_points_value_C.data(), num_new_points);
 }
 
-boost::python::list SamplePointFromGPWrapper(GaussianProcess * gaussian_process,
-                                             const boost::python::list& point_to_sample) {
+void SetHyperparametersWrapper(PythonGaussianProcess * gaussian_process_handle,
+                               const boost::python::object& hyperparameters,
+                               const boost::python::object& noise_variance) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcess * gaussian_process = &gaussian_process_handle->model;
+  const int dim = gaussian_process->dim();
+  std::vector<double> hyperparameters_C(1 + dim);
+  hyperparameters_C[0] = boost::python::extract<double>(hyperparameters[0]);
+  std::vector<double> lengths_C(dim);
+  const boost::python::object lengths = hyperparameters[1];
+  CopyPylistToVector(lengths, dim, lengths_C);
+  std::copy(lengths_C.begin(), lengths_C.end(), hyperparameters_C.begin() + 1);
+
+  std::vector<double> noise_variance_C(1 + gaussian_process->num_derivatives());
+  CopyPylistToVector(noise_variance, 1 + gaussian_process->num_derivatives(), noise_variance_C);
+
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+  gaussian_process->SetHyperparameters(hyperparameters_C.data(), noise_variance_C.data());
+}
+
+boost::python::list SamplePointFromGPWrapper(PythonGaussianProcess * gaussian_process_handle,
+                                             const boost::python::object& point_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcess * gaussian_process = &gaussian_process_handle->model;
   int num_to_sample = 1;  // we're only drawing 1 point at a time here
 
   int num_derivatives_input = 0;
@@ -264,14 +390,21 @@ boost::python::list SamplePointFromGPWrapper(GaussianProcess * gaussian_process,
 
   std::vector<double> results(input_container.num_to_sample * (1+gaussian_process->num_derivatives()));
 
-  gaussian_process->SamplePointFromGP(input_container.points_to_sample.data(), results.data());
+  {
+    ScopedGILRelease gil_release;
+    // draws from (so changes) the GP's internal RNG
+    std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+    gaussian_process->SamplePointFromGP(input_container.points_to_sample.data(), results.data());
+  }
   return VectorToPylist(results);
 }
 
-boost::python::list SampleGlobalOptimaFromGPWrapper(GaussianProcess * gaussian_process,
+boost::python::list SampleGlobalOptimaFromGPWrapper(PythonGaussianProcess * gaussian_process_handle,
                                                     int const num_optima,
                                                     int const inner_number,
-                                                    const boost::python::list& domain_bounds){
+                                                    const boost::python::object& domain_bounds){
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcess * gaussian_process = &gaussian_process_handle->model;
   int dim = gaussian_process->dim();
   std::vector<ClosedInterval> gp_domain(dim);
   CopyPylistToClosedIntervalVector(domain_bounds, dim, gp_domain);
@@ -279,20 +412,84 @@ boost::python::list SampleGlobalOptimaFromGPWrapper(GaussianProcess * gaussian_p
   TensorProductDomain tensor_domain(gp_domain.data(), dim);
 
   std::vector<double> points_optima(num_optima * dim);
-  gaussian_process->SampleGlobalOptimaFromGP(num_optima, inner_number, tensor_domain, points_optima.data());
+  {
+    ScopedGILRelease gil_release;
+    // draws from (so changes) the GP's internal RNG
+    std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+    gaussian_process->SampleGlobalOptimaFromGP(num_optima, inner_number, tensor_domain, points_optima.data());
+  }
+  return VectorToPylist(points_optima);
+}
+
+boost::python::list SampleGlobalOptimaViaPathwiseSamplesWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                                                int const num_optima,
+                                                                int const num_features,
+                                                                int const num_candidates,
+                                                                const LBFGSBParameters& lbfgsb_parameters,
+                                                                const boost::python::object& domain_bounds,
+                                                                int max_num_threads,
+                                                                UniformRandomGenerator::EngineType::result_type seed) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  int dim = gaussian_process.dim();
+  std::vector<ClosedInterval> gp_domain(dim);
+  CopyPylistToClosedIntervalVector(domain_bounds, dim, gp_domain);
+
+  TensorProductDomain tensor_domain(gp_domain.data(), dim);
+
+  std::vector<double> points_optima(num_optima * dim);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    SampleGlobalOptimaViaPathwiseSamples(gaussian_process, num_optima, num_features, num_candidates,
+                                         lbfgsb_parameters, tensor_domain, max_num_threads, seed,
+                                         points_optima.data());
+  }
   return VectorToPylist(points_optima);
 }
 
-void PrintHistoricalData(const GaussianProcess& gaussian_process) {
+int GetDimWrapper(const PythonGaussianProcess& gaussian_process_handle) {
+  return gaussian_process_handle.model.dim();  // fixed at construction
+}
+
+int GetNumSampledWrapper(const PythonGaussianProcess& gaussian_process_handle) {
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+  return gaussian_process_handle.model.num_sampled();
+}
+
+void PrintHistoricalData(const PythonGaussianProcess& gaussian_process_handle) {
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_handle.mutex);
   PrintMatrixTrans(gaussian_process.points_sampled().data(), gaussian_process.num_sampled(), gaussian_process.dim());
   PrintMatrix(gaussian_process.points_sampled_value().data(), 1, gaussian_process.num_sampled());
   //PrintMatrix(gaussian_process.noise_variance().data(), 1, gaussian_process.num_sampled());
 }
 
+void SetExplicitSeedWrapper(PythonGaussianProcess * gaussian_process_handle,
+                            GaussianProcess::EngineType::result_type seed) {
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+  gaussian_process_handle->model.SetExplicitSeed(seed);
+}
+
+void SetRandomizedSeedWrapper(PythonGaussianProcess * gaussian_process_handle,
+                              GaussianProcess::EngineType::result_type seed) {
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+  gaussian_process_handle->model.SetRandomizedSeed(seed);
+}
+
+void ResetToMostRecentSeedWrapper(PythonGaussianProcess * gaussian_process_handle) {
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_handle->mutex);
+  gaussian_process_handle->model.ResetToMostRecentSeed();
+}
 }  // end unnamed namespace
 
 void ExportGaussianProcessFunctions() {
-  boost::python::class_<GaussianProcess, boost::noncopyable>("GaussianProcess", boost::python::no_init)
+  boost::python::class_<PythonGaussianProcess, boost::noncopyable>("GaussianProcess", boost::python::no_init)
       .def("__init__", boost::python::make_constructor(&make_gaussian_process), R"%%(
     Constructor for a ``GPP.GaussianProcess`` object.
 
@@ -311,8 +508,8 @@ void ExportGaussianProcessFunctions() {
     :param num_sampled: number of already-sampled points
     :type num_sampled: int > 0
           )%%")
-      .add_property("dim", &GaussianProcess::dim, "Return the number of spatial dimensions.")
-      .add_property("num_sampled", &GaussianProcess::num_sampled, "Return the number of sampled points.")
+      .add_property("dim", GetDimWrapper, "Return the number of spatial dimensions.")
+      .add_property("num_sampled", GetNumSampledWrapper, "Return the number of sampled points.")
       .def("compute_mean_of_points", GetMeanWrapper, R"%%(
         Compute the (predicted) mean, mus, of the Gaussian Process posterior.
         ``mus_i = Ks_{i,k} * K^-1_{k,l} * y_l = Ks^T * K^-1 * y``
@@ -324,6 +521,35 @@ void ExportGaussianProcessFunctions() {
         :return: GP mean evaluated at each of ``points_to_sample``
         :rtype: list of float64 with shape (num_to_sample, )
         )%%")
+      .def("predict_marginals", PredictMarginalsWrapper, R"%%(
+        Compute the (predicted) mean and the marginal variance of the Gaussian Process posterior at each point,
+        without forming the joint covariance; for screening large candidate sets.
+        ``mus_i = Ks_{i,k} * K^-1_{k,l} * y_l``, ``Vars_i = Kss_{i,i} - Ks_{i,l} * K^-1_{l,k} * Ks_{k,i}``
+
+        :param points_to_sample: points at which to make predictions; may contain duplicates
+        :type points_to_sample: list of float64 with shape (num_to_sample, dim)
+        :param num_to_sample: number of points to predict
+        :type num_to_sample: int > 0
+        :param max_num_threads: maximum number of threads to use
+        :type max_num_threads: int > 0
+        :return: GP means at each of ``points_to_sample``, followed by the GP variances
+        :rtype: list of float64 with shape (2, num_to_sample)
+        )%%")
+      .def("predict_marginals", PredictMarginalsInPlaceWrapper, R"%%(
+        Same as the 3-argument predict_marginals(), except the means and variances are written into caller-provided
+        arrays instead of being returned; e.g., pass preallocated ``numpy.float64`` arrays to avoid building python lists.
+
+        :param points_to_sample: points at which to make predictions; may contain duplicates
+        :type points_to_sample: list of float64 with shape (num_to_sample, dim)
+        :param num_to_sample: number of points to predict
+        :type num_to_sample: int > 0
+        :param max_num_threads: maximum number of threads to use
+        :type max_num_threads: int > 0
+        :param mean_of_points: output, GP means at each of ``points_to_sample``
+        :type mean_of_points: writable array of float64 with shape (num_to_sample)
+        :param variance_of_points: output, GP variances at each of ``points_to_sample``
+        :type variance_of_points: writable array of float64 with shape (num_to_sample)
+        )%%")
       .def("compute_mean_of_additional_points", GetAdditionalMeanWrapper, R"%%(
         Compute the (predicted) mean, mus, of the Gaussian Process posterior.
         ``mus_i = Ks_{i,k} * K^-1_{k,l} * y_l = Ks^T * K^-1 * y``
@@ -414,7 +640,8 @@ void ExportGaussianProcessFunctions() {
       .def("add_sampled_points", AddPointsToGPWrapper, R"%%(
         Add the specified (point, fcn value, noise variance) historical data to this GP.
 
-        Forces recomputation of all derived quantities for GP to remain consistent.
+        Forces recomputation of all derived quantities for GP to remain consistent. Waits for computations using this
+        GP in other threads to finish.
 
         :param new_points: coordinates of each new point to add
         :type new_points: list of float64 with shape (num_new_points, dim)
@@ -425,6 +652,17 @@ void ExportGaussianProcessFunctions() {
         :param num_new_points: number of new points to add to the GP
         :type num_new_points: int
       )%%")
+      .def("set_hyperparameters", SetHyperparametersWrapper, R"%%(
+        Replace the covariance hyperparameters and noise variance of this GP, keeping its historical data.
+
+        Refactors the covariance matrix once; cheaper than constructing a new ``GPP.GaussianProcess``. Waits for
+        computations using this GP in other threads to finish.
+
+        :param hyperparameters: covariance hyperparameters; see "Details on ..." section at the top of ``BOOST_PYTHON_MODULE``
+        :type hyperparameters: list of len 2; index 0 is a float64 ``\alpha`` (signal variance) and index 1 is the length scales (list of floa64 of length ``dim``)
+        :param noise_variance: the ``\sigma_n^2`` (noise variance) of the function value and each observed derivative
+        :type noise_variance: list of float64 with shape (num_derivatives + 1, )
+      )%%")
       .def("sample_point_from_gp", SamplePointFromGPWrapper, R"%%(
         Sample a function value from a Gaussian Process prior, provided a point at which to sample.
 
@@ -453,13 +691,38 @@ void ExportGaussianProcessFunctions() {
         :return: function value drawn from this GP
         :rtype: float64
       )%%")
-      .def("set_explicit_seed", &GaussianProcess::SetExplicitSeed, "Seed the internal RNG with the specified seed.")
-      .def("set_randomized_seed", &GaussianProcess::SetRandomizedSeed, R"%%(
+      .def("sample_global_optima_pathwise", SampleGlobalOptimaViaPathwiseSamplesWrapper, R"%%(
+        Approximate draws of the global optima (minima) of this GP, one per posterior sample path.
+
+        Each path is an analytic posterior draw (random Fourier features plus a pathwise update), evaluated at
+        num_candidates uniform points and refined with L-BFGS-B from the best lbfgsb_parameters.num_multistarts of
+        them (max_num_steps = 0 skips the refinement).  Draw i is seeded from seed + i, so the result does not depend
+        on max_num_threads.  See gpp_posterior_sample.hpp.
+
+        :param num_optima: number of optima to draw
+        :type num_optima: int > 0
+        :param num_features: number of spectral frequencies per sample path (suggest: 500-2000)
+        :type num_features: int > 0
+        :param num_candidates: number of uniform candidate points per sample path
+        :type num_candidates: int > 0
+        :param lbfgsb_parameters: refinement settings
+        :type lbfgsb_parameters: LBFGSBParameters
+        :param domain_bounds: [min, max] bounds of the search domain, one pair per dimension
+        :type domain_bounds: list of list of float64 with shape (dim, 2)
+        :param max_num_threads: maximum number of threads to use, >= 1
+        :type max_num_threads: int > 0
+        :param seed: base seed
+        :type seed: int >= 0
+        :return: one sampled optimum per draw
+        :rtype: list of float64 with shape (num_optima, dim)
+      )%%")
+      .def("set_explicit_seed", SetExplicitSeedWrapper, "Seed the internal RNG with the specified seed.")
+      .def("set_randomized_seed", SetRandomizedSeedWrapper, R"%%(
         Seed the internal RNG with a combination of the specified seed and other factors.
 
         See gpp_random, struct NormalRNG for details.
       )%%")
-      .def("reset_to_most_recent_seed", &GaussianProcess::ResetToMostRecentSeed, "Seed the internal RNG with the last used seed.")
+      .def("reset_to_most_recent_seed", ResetToMostRecentSeedWrapper, "Seed the internal RNG with the last used seed.")
       .def("print_historical_data", PrintHistoricalData)
       ;  // NOLINT, this is boost style
 }
@@ -16,6 +16,7 @@
 #include "gpp_python_knowledge_gradient.hpp"
 
 // NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
+#include <mutex>  // NOLINT(build/include_order)
 #include <string>  // NOLINT(build/include_order)
 #include <vector>  // NOLINT(build/include_order)
 
@@ -35,20 +36,26 @@
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_posterior_sample.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 namespace optimal_learning {
 
 namespace {
 
-double ComputePosteriorMeanWrapper(const GaussianProcess& gaussian_process,
+double ComputePosteriorMeanWrapper(const PythonGaussianProcess& gaussian_process_handle,
                                    const int num_fidelity,
-                                   const boost::python::list& points_to_sample) {
+                                   const boost::python::object& points_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
   PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process.dim()-num_fidelity, 1, num_derivatives_input);
 
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_handle.mutex);
   bool configure_for_gradients = false;
   PosteriorMeanEvaluator ps_evaluator(gaussian_process);
   PosteriorMeanEvaluator::StateType ps_state(ps_evaluator, num_fidelity, input_container.points_to_sample.data(), configure_for_gradients);
@@ -56,9 +63,11 @@ double ComputePosteriorMeanWrapper(const GaussianProcess& gaussian_process,
   return ps_evaluator.ComputePosteriorMean(&ps_state);
 }
 
-boost::python::list ComputeGradPosteriorMeanWrapper(const GaussianProcess& gaussian_process,
+boost::python::list ComputeGradPosteriorMeanWrapper(const PythonGaussianProcess& gaussian_process_handle,
                                                     const int num_fidelity,
-                                                    const boost::python::list& points_to_sample) {
+                                                    const boost::python::object& points_to_sample) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -67,22 +76,29 @@ boost::python::list ComputeGradPosteriorMeanWrapper(const GaussianProcess& gauss
   std::vector<double> grad_PS(input_container.dim);
   bool configure_for_gradients = true;
 
-  PosteriorMeanEvaluator ps_evaluator(gaussian_process);
-  PosteriorMeanEvaluator::StateType ps_state(ps_evaluator, num_fidelity, input_container.points_to_sample.data(), configure_for_gradients);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    PosteriorMeanEvaluator ps_evaluator(gaussian_process);
+    PosteriorMeanEvaluator::StateType ps_state(ps_evaluator, num_fidelity, input_container.points_to_sample.data(), configure_for_gradients);
 
-  ps_evaluator.ComputeGradPosteriorMean(&ps_state, grad_PS.data());
+    ps_evaluator.ComputeGradPosteriorMean(&ps_state, grad_PS.data());
+  }
   return VectorToPylist(grad_PS);
 }
 
-double ComputeKnowledgeGradientWrapper(const GaussianProcess& gaussian_process,
+double ComputeKnowledgeGradientWrapper(const PythonGaussianProcess& gaussian_process_handle,
                                        const int num_fidelity,
                                        const boost::python::object& optimizer_parameters,
-                                       const boost::python::list& domain_bounds,
-                                       const boost::python::list& discrete_pts,
-                                       const boost::python::list& points_to_sample,
-                                       const boost::python::list& points_being_sampled,
+                                       const boost::python::object& domain_bounds,
+                                       const boost::python::object& discrete_pts,
+                                       const boost::python::object& points_to_sample,
+                                       const boost::python::object& points_being_sampled,
                                        int num_pts, int num_to_sample, int num_being_sampled,
-                                       int max_int_steps, double best_so_far, RandomnessSourceContainer& randomness_source) {
+                                       int max_int_steps, double best_so_far, RandomnessSourceContainer& randomness_source,
+                                       bool use_gpu, int which_gpu) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -99,8 +115,13 @@ double ComputeKnowledgeGradientWrapper(const GaussianProcess& gaussian_process,
 
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+  std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
   KnowledgeGradientEvaluator<TensorProductDomain> kg_evaluator(gaussian_process, num_fidelity, input_container_discrete.points_to_sample.data(),
-                                                               num_pts, max_int_steps, inner_domain, gradient_descent_parameters, best_so_far);
+                                                               num_pts, max_int_steps, inner_domain, gradient_descent_parameters, best_so_far,
+                                                               KnowledgeGradientInnerMode::kGradientDescent, 0, 1,
+                                                               use_gpu ? which_gpu : kNoGpu);
   KnowledgeGradientEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
                                                                       input_container.points_being_sampled.data(),
                                                                       input_container.num_to_sample,
@@ -112,15 +133,18 @@ double ComputeKnowledgeGradientWrapper(const GaussianProcess& gaussian_process,
   return kg_evaluator.ComputeKnowledgeGradient(&kg_state);
 }
 
-boost::python::list ComputeGradKnowledgeGradientWrapper(const GaussianProcess& gaussian_process,
+boost::python::list ComputeGradKnowledgeGradientWrapper(const PythonGaussianProcess& gaussian_process_handle,
                                                         const int num_fidelity,
                                                         const boost::python::object& optimizer_parameters,
-                                                        const boost::python::list& domain_bounds,
-                                                        const boost::python::list& discrete_pts,
-                                                        const boost::python::list& points_to_sample,
-                                                        const boost::python::list& points_being_sampled,
+                                                        const boost::python::object& domain_bounds,
+                                                        const boost::python::object& discrete_pts,
+                                                        const boost::python::object& points_to_sample,
+                                                        const boost::python::object& points_being_sampled,
                                                         int num_pts, int num_to_sample, int num_being_sampled,
-                                                        int max_int_steps, double best_so_far, RandomnessSourceContainer& randomness_source) {
+                                                        int max_int_steps, double best_so_far, RandomnessSourceContainer& randomness_source,
+                                                        bool use_gpu, int which_gpu) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -139,20 +163,82 @@ boost::python::list ComputeGradKnowledgeGradientWrapper(const GaussianProcess& g
 
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
-  KnowledgeGradientEvaluator<TensorProductDomain> kg_evaluator(gaussian_process, num_fidelity, input_container_discrete.points_to_sample.data(),
-                                                               num_pts, max_int_steps, inner_domain, gradient_descent_parameters, best_so_far);
-  KnowledgeGradientEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
-                                                                      input_container.points_being_sampled.data(),
-                                                                      input_container.num_to_sample,
-                                                                      input_container.num_being_sampled,
-                                                                      input_container_discrete.num_to_sample,
-                                                                      gaussian_process.derivatives().data(), gaussian_process.num_derivatives(),
-                                                                      configure_for_gradients, randomness_source.normal_rng_vec.data());
-  kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad_KG.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    KnowledgeGradientEvaluator<TensorProductDomain> kg_evaluator(gaussian_process, num_fidelity, input_container_discrete.points_to_sample.data(),
+                                                                 num_pts, max_int_steps, inner_domain, gradient_descent_parameters, best_so_far,
+                                                                 KnowledgeGradientInnerMode::kGradientDescent, 0, 1,
+                                                                 use_gpu ? which_gpu : kNoGpu);
+    KnowledgeGradientEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
+                                                                        input_container.points_being_sampled.data(),
+                                                                        input_container.num_to_sample,
+                                                                        input_container.num_being_sampled,
+                                                                        input_container_discrete.num_to_sample,
+                                                                        gaussian_process.derivatives().data(), gaussian_process.num_derivatives(),
+                                                                        configure_for_gradients, randomness_source.normal_rng_vec.data());
+    kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad_KG.data());
+  }
 
   return VectorToPylist(grad_KG);
 }
 
+void ComputeKnowledgeGradientBatchWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                          const int num_fidelity,
+                                          const boost::python::object& optimizer_parameters,
+                                          const boost::python::object& domain_bounds,
+                                          const boost::python::object& discrete_pts,
+                                          const boost::python::object& point_sets,
+                                          const boost::python::object& points_being_sampled,
+                                          int num_pts, int num_sets, int num_to_sample, int num_being_sampled,
+                                          int max_int_steps, double best_so_far, int max_num_threads,
+                                          RandomnessSourceContainer& randomness_source,
+                                          boost::python::object values,
+                                          boost::python::object gradients) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  // abort if we do not have enough sources of randomness to run with max_num_threads
+  if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
+  }
+
+  int num_derivatives_input = 0;
+  const boost::python::list derivatives;
+
+  PythonInterfaceInputContainer input_container_discrete(discrete_pts, derivatives, gaussian_process.dim()-num_fidelity, num_pts, num_derivatives_input);
+  PythonInterfaceInputContainer input_container(point_sets, points_being_sampled, derivatives, gaussian_process.dim(),
+                                                num_to_sample*num_sets, num_being_sampled, num_derivatives_input);
+
+  std::vector<ClosedInterval> domain_bounds_C(input_container.dim-num_fidelity);
+  CopyPylistToClosedIntervalVector(domain_bounds, input_container.dim-num_fidelity, domain_bounds_C);
+  TensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim-num_fidelity);
+
+  const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
+
+  const bool compute_gradients = !gradients.is_none();
+  std::vector<double> values_C(num_sets);
+  std::vector<double> gradients_C(compute_gradients ? input_container.points_to_sample.size() : 0);
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_static);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    ComputeKnowledgeGradientAtPointSets(gaussian_process, num_fidelity, gradient_descent_parameters, inner_domain,
+                                        thread_schedule, input_container.points_to_sample.data(),
+                                        input_container.points_being_sampled.data(),
+                                        input_container_discrete.points_to_sample.data(), num_sets, num_to_sample,
+                                        input_container.num_being_sampled, input_container_discrete.num_to_sample,
+                                        best_so_far, max_int_steps, randomness_source.normal_rng_vec.data(),
+                                        values_C.data(), compute_gradients ? gradients_C.data() : nullptr);
+  }
+
+  CopyVectorToPybuffer(values_C, values);
+  if (compute_gradients) {
+    CopyVectorToPybuffer(gradients_C, gradients);
+  }
+}
+
 /*!\rst
   Utility that dispatches KG optimization based on optimizer type and num_to_sample.
   This is just used to reduce copy-pasted code.
@@ -182,7 +268,7 @@ boost::python::list ComputeGradKnowledgeGradientWrapper(const GaussianProcess& g
 template <typename DomainType>
 void DispatchKnowledgeGradientOptimization(const boost::python::object& optimizer_parameters,
                                            const boost::python::object& optimizer_parameters_inner,
-                                           const GaussianProcess& gaussian_process, const int num_fidelity,
+                                           const PythonGaussianProcess& gaussian_process_handle, const int num_fidelity,
                                            const PythonInterfaceInputContainer& input_container_discrete,
                                            const PythonInterfaceInputContainer& input_container,
                                            const DomainType& domain, const DomainType& inner_domain,
@@ -191,6 +277,7 @@ void DispatchKnowledgeGradientOptimization(const boost::python::object& optimize
                                            RandomnessSourceContainer& randomness_source,
                                            boost::python::dict& status,
                                            double * restrict best_points_to_sample) {
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
 
   bool found_flag = false;
   switch (optimizer_type) {
@@ -200,16 +287,21 @@ void DispatchKnowledgeGradientOptimization(const boost::python::object& optimize
       const GradientDescentParameters& gradient_descent_parameters_inner = boost::python::extract<GradientDescentParameters&>(optimizer_parameters_inner.attr("optimizer_parameters"));
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
-      ComputeKGOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, num_fidelity, gradient_descent_parameters_inner, domain, inner_domain,
-                                                            thread_schedule, input_container.points_being_sampled.data(),
-                                                            input_container_discrete.points_to_sample.data(),
-                                                            num_random_samples, num_to_sample,
-                                                            input_container.num_being_sampled,
-                                                            input_container_discrete.num_to_sample,
-                                                            best_so_far, max_int_steps,
-                                                            &found_flag, &randomness_source.uniform_generator,
-                                                            randomness_source.normal_rng_vec.data(),
-                                                            best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeKGOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process, num_fidelity, gradient_descent_parameters_inner, domain, inner_domain,
+                                                              thread_schedule, input_container.points_being_sampled.data(),
+                                                              input_container_discrete.points_to_sample.data(),
+                                                              num_random_samples, num_to_sample,
+                                                              input_container.num_being_sampled,
+                                                              input_container_discrete.num_to_sample,
+                                                              best_so_far, max_int_steps,
+                                                              &found_flag, &randomness_source.uniform_generator,
+                                                              randomness_source.normal_rng_vec.data(),
+                                                              best_points_to_sample);
+      }
       status[std::string("lhc_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
     }  // end case kNull optimizer_type
@@ -222,12 +314,17 @@ void DispatchKnowledgeGradientOptimization(const boost::python::object& optimize
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
       bool random_search_only = false;
-      ComputeKGOptimalPointsToSample(gaussian_process, num_fidelity, gradient_descent_parameters, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
-                                     input_container.points_being_sampled.data(), input_container_discrete.points_to_sample.data(),
-                                     num_to_sample, input_container.num_being_sampled, input_container_discrete.num_to_sample,
-                                     best_so_far, max_int_steps, random_search_only, num_random_samples, &found_flag,
-                                     &randomness_source.uniform_generator,
-                                     randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeKGOptimalPointsToSample(gaussian_process, num_fidelity, gradient_descent_parameters, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
+                                       input_container.points_being_sampled.data(), input_container_discrete.points_to_sample.data(),
+                                       num_to_sample, input_container.num_being_sampled, input_container_discrete.num_to_sample,
+                                       best_so_far, max_int_steps, random_search_only, num_random_samples, &found_flag,
+                                       &randomness_source.uniform_generator,
+                                       randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      }
 
       status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
@@ -242,14 +339,16 @@ void DispatchKnowledgeGradientOptimization(const boost::python::object& optimize
 
 boost::python::list MultistartKnowledgeGradientOptimizationWrapper(const boost::python::object& optimizer_parameters,
                                                                    const boost::python::object& optimizer_parameters_inner,
-                                                                   const GaussianProcess& gaussian_process, const int num_fidelity,
-                                                                   const boost::python::list& domain_bounds,
-                                                                   const boost::python::list& discrete_pts,
-                                                                   const boost::python::list& points_being_sampled,
+                                                                   const PythonGaussianProcess& gaussian_process_handle, const int num_fidelity,
+                                                                   const boost::python::object& domain_bounds,
+                                                                   const boost::python::object& discrete_pts,
+                                                                   const boost::python::object& points_being_sampled,
                                                                    int num_pts, int num_to_sample, int num_being_sampled,
                                                                    double best_so_far, int max_int_steps, int max_num_threads,
                                                                    RandomnessSourceContainer& randomness_source,
                                                                    boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   // TODO(GH-131): make domain objects constructible from python; and pass them in through
   // the optimizer_parameters python object
 
@@ -280,7 +379,7 @@ boost::python::list MultistartKnowledgeGradientOptimizationWrapper(const boost::
       TensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
       TensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim- num_fidelity);
 
-      DispatchKnowledgeGradientOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process, num_fidelity, input_container_discrete,
+      DispatchKnowledgeGradientOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_handle, num_fidelity, input_container_discrete,
                                             input_container, domain, inner_domain, optimizer_type, num_to_sample, best_so_far,
                                             max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -289,7 +388,7 @@ boost::python::list MultistartKnowledgeGradientOptimizationWrapper(const boost::
       SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
       SimplexIntersectTensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim- num_fidelity);
 
-      DispatchKnowledgeGradientOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process, num_fidelity, input_container_discrete,
+      DispatchKnowledgeGradientOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_handle, num_fidelity, input_container_discrete,
                                             input_container, domain, inner_domain, optimizer_type, num_to_sample, best_so_far,
                                             max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -303,11 +402,13 @@ boost::python::list MultistartKnowledgeGradientOptimizationWrapper(const boost::
   return VectorToPylist(best_points_to_sample_C);
 }
 
-boost::python::list ComputeOptimalPosteriorMeanWrapper(const GaussianProcess& gaussian_process, const int num_fidelity,
+boost::python::list ComputeOptimalPosteriorMeanWrapper(const PythonGaussianProcess& gaussian_process_handle, const int num_fidelity,
                                                        const boost::python::object& optimizer_parameters,
-                                                       const boost::python::list& domain_bounds,
-                                                       const boost::python::list& initial_guess,
+                                                       const boost::python::object& domain_bounds,
+                                                       const boost::python::object& initial_guess,
                                                        boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
     int dim = gaussian_process.dim();
 
     int num_derivatives_input = 0;
@@ -328,15 +429,23 @@ boost::python::list ComputeOptimalPosteriorMeanWrapper(const GaussianProcess& ga
       case DomainTypes::kTensorProduct: {
         TensorProductDomain inner_domain(domain_bounds_C.data(), dim - num_fidelity);
 
-        ComputeOptimalPosteriorMean(gaussian_process, num_fidelity, gradient_descent_parameters, inner_domain, input_container.points_to_sample.data(),
-                                    &found_flag, best_points_to_sample_C.data());
+        {
+          ScopedGILRelease gil_release;
+          ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+          ComputeOptimalPosteriorMean(gaussian_process, num_fidelity, gradient_descent_parameters, inner_domain, input_container.points_to_sample.data(),
+                                      &found_flag, best_points_to_sample_C.data());
+        }
         break;
       }  // end case OptimizerTypes::kTensorProduct
       case DomainTypes::kSimplex: {
         SimplexIntersectTensorProductDomain inner_domain(domain_bounds_C.data(), dim - num_fidelity);
 
-        ComputeOptimalPosteriorMean(gaussian_process, num_fidelity, gradient_descent_parameters, inner_domain, input_container.points_to_sample.data(),
-                                    &found_flag, best_points_to_sample_C.data());
+        {
+          ScopedGILRelease gil_release;
+          ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+          ComputeOptimalPosteriorMean(gaussian_process, num_fidelity, gradient_descent_parameters, inner_domain, input_container.points_to_sample.data(),
+                                      &found_flag, best_points_to_sample_C.data());
+        }
         break;
       }  // end case OptimizerTypes::kSimplex
       default: {
@@ -348,16 +457,18 @@ boost::python::list ComputeOptimalPosteriorMeanWrapper(const GaussianProcess& ga
     return VectorToPylist(best_points_to_sample_C);
 }
 
-boost::python::list EvaluateKGAtPointListWrapper(const GaussianProcess& gaussian_process,
+boost::python::list EvaluateKGAtPointListWrapper(const PythonGaussianProcess& gaussian_process_handle,
                                                  const int num_fidelity, const boost::python::object& optimizer_parameters,
-                                                 const boost::python::list& domain_bounds,
-                                                 const boost::python::list& discrete_being_sampled,
-                                                 const boost::python::list& initial_guesses,
+                                                 const boost::python::object& domain_bounds,
+                                                 const boost::python::object& discrete_being_sampled,
+                                                 const boost::python::object& initial_guesses,
                                                  int num_multistarts, int num_pts, int num_to_sample,
                                                  int num_being_sampled, double best_so_far,
                                                  int max_int_steps, int max_num_threads,
                                                  RandomnessSourceContainer& randomness_source,
                                                  boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
   // abort if we do not have enough sources of randomness to run with max_num_threads
   if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
@@ -384,16 +495,50 @@ boost::python::list EvaluateKGAtPointListWrapper(const GaussianProcess& gaussian
 
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
-  EvaluateKGAtPointList(gaussian_process, num_fidelity, gradient_descent_parameters, domain, inner_domain, thread_schedule, initial_guesses_C.data(),
-                        input_container.points_to_sample.data() + input_container.dim*num_pts, input_container.points_to_sample.data(),
-                        num_multistarts, num_to_sample, num_being_sampled,
-                        num_pts, best_so_far, max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
-                        result_function_values_C.data(), result_point_C.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    EvaluateKGAtPointList(gaussian_process, num_fidelity, gradient_descent_parameters, domain, inner_domain, thread_schedule, initial_guesses_C.data(),
+                          input_container.points_to_sample.data() + input_container.dim*num_pts, input_container.points_to_sample.data(),
+                          num_multistarts, num_to_sample, num_being_sampled,
+                          num_pts, best_so_far, max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
+                          result_function_values_C.data(), result_point_C.data());
+  }
 
   status["evaluate_KG_at_point_list"] = found_flag;
 
   return VectorToPylist(result_function_values_C);
 }
+
+boost::python::list ThompsonSamplingOptimizationWrapper(const LBFGSBParameters& optimizer_parameters,
+                                                        const PythonGaussianProcess& gaussian_process_handle,
+                                                        const boost::python::object& domain_bounds,
+                                                        int num_to_sample, int num_features, int num_candidates,
+                                                        int max_num_threads, RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  const int dim = gaussian_process.dim();
+  std::vector<ClosedInterval> domain_bounds_C(dim);
+  CopyPylistToClosedIntervalVector(domain_bounds, dim, domain_bounds_C);
+  TensorProductDomain domain(domain_bounds_C.data(), dim);
+
+  std::vector<double> best_points_to_sample_C(dim*num_to_sample);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    UniformRandomGenerator::EngineType::result_type seed;
+    {
+      // the draws seed themselves from one base seed, so the lock is only held to advance the shared generator
+      std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+      seed = randomness_source.uniform_generator.GetEngine()();
+    }
+    ComputeThompsonSamplingPointsToSample(gaussian_process, num_to_sample, num_features, num_candidates,
+                                          optimizer_parameters, domain, max_num_threads, seed,
+                                          best_points_to_sample_C.data());
+  }
+  return VectorToPylist(best_points_to_sample_C);
+}
 }  // end unnamed namespace
 
 void ExportKnowldegeGradientFunctions() {
@@ -480,6 +625,10 @@ void ExportKnowldegeGradientFunctions() {
     :type force_monte_carlo: bool
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
+    :param use_gpu: true to draw the MC normals on a GPU; throws if MOE was built without its GPU components
+    :type use_gpu: bool
+    :param which_gpu: GPU device ID; ignored unless use_gpu
+    :type which_gpu: int >= 0
     :return: computed EI
     :rtype: float64 >= 0.0
     )%%");
@@ -509,10 +658,66 @@ void ExportKnowldegeGradientFunctions() {
     :type force_monte_carlo: bool
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
+    :param use_gpu: true to draw the MC normals on a GPU; throws if MOE was built without its GPU components
+    :type use_gpu: bool
+    :param which_gpu: GPU device ID; ignored unless use_gpu
+    :type which_gpu: int >= 0
     :return: gradient of EI (computed at points_to_sample + points_being_sampled, wrt points_to_sample)
     :rtype: list of float64 with shape (num_to_sample, dim)
     )%%");
 
+  boost::python::def("compute_knowledge_gradient_batch", ComputeKnowledgeGradientBatchWrapper, R"%%(
+    Compute knowledge gradient, and optionally its gradient, of each of ``num_sets`` q-sets of points to sample.
+
+    Equivalent to::
+
+      for i, point_set in enumerate(point_sets):
+          values[i] = compute_knowledge_gradient(point_set, ...)
+          gradients[i] = compute_grad_knowledge_gradient(point_set, ...)
+
+    But the GP, discrete points and domain are converted and the KG states are built once, the loop runs in C++ on up
+    to max_num_threads threads, and the results are written into caller-provided arrays (e.g., preallocated
+    ``numpy.float64`` arrays) instead of being returned. Set ``i`` uses randomness source
+    ``i % min(max_num_threads, num_sets)``.
+
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param num_fidelity: number of fidelity dimensions
+    :type num_fidelity: int >= 0
+    :param optimizer_parameters: python/cpp_wrappers/optimization._CppOptimizerParameters; its optimizer_parameters
+      (GradientDescentParameters) control the inner optimization of KG
+    :type optimizer_parameters: _CppOptimizerParameters
+    :param domain_bounds: [min, max] pairs of the inner optimization's domain
+    :type domain_bounds: list of float64 with shape (dim - num_fidelity, 2)
+    :param discrete_pts: points to approximate KG
+    :type discrete_pts: list of float64 with shape (num_pts, dim - num_fidelity)
+    :param point_sets: q-sets of points at which to evaluate KG and/or its gradient
+    :type point_sets: list of float64 with shape (num_sets, num_to_sample, dim)
+    :param points_being_sampled: points that are being sampled in concurrently experiments
+    :type points_being_sampled: list of float64 with shape (num_being_sampled, dim)
+    :param num_pts: number of points in discrete_pts
+    :type num_pts: int > 0
+    :param num_sets: number of q-sets in point_sets
+    :type num_sets: int > 0
+    :param num_to_sample: number of potential future samples per set; gradients are evaluated wrt these points (i.e., the "q" in q,p-KG)
+    :type num_to_sample: int > 0
+    :param num_being_sampled: number of points being sampled concurrently (i.e., the p in q,p-KG)
+    :type num_being_sampled: int >= 0
+    :param max_int_steps: number of MC integration points in KG
+    :type max_int_steps: int >= 0
+    :param best_so_far: best known mean value of the GP over discrete_pts
+    :type best_so_far: float64
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources (must hold at least max_num_threads sources)
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :param values: output, KG of each set of point_sets, in the same order
+    :type values: writable array of float64 with shape (num_sets)
+    :param gradients: output, gradient of KG of each set wrt its points to sample, in the same order; None to skip
+      the gradients
+    :type gradients: writable array of float64 with shape (num_sets, num_to_sample, dim), or None
+    )%%");
+
   boost::python::def("multistart_knowledge_gradient_optimization", MultistartKnowledgeGradientOptimizationWrapper, R"%%(
     Optimize expected improvement (i.e., solve q,p-EI) over the specified domain using the specified optimization method.
     Can optimize for num_to_sample new points to sample (i.e., aka "q", experiments to run) simultaneously.
@@ -531,9 +736,6 @@ void ExportKnowldegeGradientFunctions() {
     * optimizer_parameters (*Parameters struct (gpp_optimizer_parameters.hpp) where * matches optimizer_type
       unused if optimizer_type == kNull)
 
-    This function also has the option of using GPU to compute general q,p-EI via MC simulation. To enable it,
-    make sure you have installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     .. WARNING:: this function FAILS and returns an EMPTY LIST if the number of random sources < max_num_threads
 
     :param optimizer_parameters: python object containing the DomainTypes domain_type and
@@ -556,10 +758,6 @@ void ExportKnowldegeGradientFunctions() {
     :type max_int_steps: int >= 0
     :param max_num_threads: max number of threads to use during EI optimization
     :type max_num_threads: int >= 1
-    :param use_gpu: set to 1 if user wants to use GPU for MC computation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
     :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
@@ -568,6 +766,37 @@ void ExportKnowldegeGradientFunctions() {
     :rtype: list of float64 with shape (num_to_sample, dim)
     )%%");
 
+  boost::python::def("thompson_sampling_optimization", ThompsonSamplingOptimizationWrapper, R"%%(
+    Choose num_to_sample points to sample next by Thompson sampling: each point is the minimum of an
+    independent posterior sample path (random Fourier features + pathwise update, see gpp_posterior_sample.hpp),
+    found by a uniform candidate search polished with L-BFGS-B. The paths are drawn and optimized in parallel and the
+    cost is linear in num_to_sample, so this scales to large batches where q,p-EI and q-KG do not.
+    points_being_sampled are not conditioned on. Only tensor product domains are supported.
+
+    The base seed is drawn from randomness_source's uniform generator; for a fixed seed, the result does not depend on
+    max_num_threads.
+
+    :param optimizer_parameters: L-BFGS-B refinement settings; num_multistarts is the number of candidates refined
+      per sample path, max_num_steps = 0 skips refinement
+    :type optimizer_parameters: LBFGSBParameters
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param domain: [lower, upper] bound pairs for each dimension
+    :type domain: list of float64 with shape (dim, 2)
+    :param num_to_sample: number of points to choose (i.e., the "q" of the batch)
+    :type num_to_sample: int > 0
+    :param num_features: number of spectral frequencies per sample path (suggest: 500-2000)
+    :type num_features: int > 0
+    :param num_candidates: number of uniform candidate points per sample path
+    :type num_candidates: int > 0
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources; only the uniform generator is used
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :return: next set of points to eval
+    :rtype: list of float64 with shape (num_to_sample, dim)
+    )%%");
+
   boost::python::def("posterior_mean_optimization", ComputeOptimalPosteriorMeanWrapper, R"%%(
     Optimize expected improvement (i.e., solve q,p-EI) over the specified domain using the specified optimization method.
     Can optimize for num_to_sample new points to sample (i.e., aka "q", experiments to run) simultaneously.
@@ -586,9 +815,6 @@ void ExportKnowldegeGradientFunctions() {
     * optimizer_parameters (*Parameters struct (gpp_optimizer_parameters.hpp) where * matches optimizer_type
       unused if optimizer_type == kNull)
 
-    This function also has the option of using GPU to compute general q,p-EI via MC simulation. To enable it,
-    make sure you have installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     .. WARNING:: this function FAILS and returns an EMPTY LIST if the number of random sources < max_num_threads
 
     :param optimizer_parameters: python object containing the DomainTypes domain_type and
@@ -611,10 +837,6 @@ void ExportKnowldegeGradientFunctions() {
     :type max_int_steps: int >= 0
     :param max_num_threads: max number of threads to use during EI optimization
     :type max_num_threads: int >= 1
-    :param use_gpu: set to 1 if user wants to use GPU for MC computation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
     :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
@@ -16,6 +16,7 @@
 #include "gpp_python_knowledge_gradient_mcmc.hpp"
 
 // NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
+#include <mutex>  // NOLINT(build/include_order)
 #include <string>  // NOLINT(build/include_order)
 #include <vector>  // NOLINT(build/include_order)
 
@@ -28,6 +29,8 @@
 #include <boost/python/object.hpp>  // NOLINT(build/include_order)
 #include <boost/python/make_constructor.hpp>  // NOLINT(build/include_order)
 
+#include <omp.h>  // NOLINT(build/include_order)
+
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
@@ -37,6 +40,8 @@
 #include "gpp_math.hpp"
 #include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_posterior_sample.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 namespace optimal_learning {
@@ -44,14 +49,16 @@ namespace optimal_learning {
 namespace {
 /*!\rst
   Surrogate "constructor" for GaussianProcess intended only for use by boost::python.  This aliases the normal C++ constructor,
-  replacing ``double const * restrict`` arguments with ``const boost::python::list&`` arguments.
+  replacing ``double const * restrict`` arguments with ``const boost::python::object&`` arguments, and wraps the GPs in a
+  PythonGaussianProcessMCMC handle (see gpp_python_common.hpp).
 \endrst*/
-GaussianProcessMCMC * make_gaussian_process_mcmc(const boost::python::list& hyperparameters_list,
-                                                 const boost::python::list& noise_variance_list,
-                                                 const boost::python::list& points_sampled,
-                                                 const boost::python::list& points_sampled_value,
-                                                 const boost::python::list& derivatives,
+PythonGaussianProcessMCMC * make_gaussian_process_mcmc(const boost::python::object& hyperparameters_list,
+                                                 const boost::python::object& noise_variance_list,
+                                                 const boost::python::object& points_sampled,
+                                                 const boost::python::object& points_sampled_value,
+                                                 const boost::python::object& derivatives,
                                                  int num_mcmc, int num_derivatives, int dim, int num_sampled) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   std::vector<double> hyperparameters_list_vector(num_mcmc*(dim+1));
   CopyPylistToVector(hyperparameters_list, num_mcmc*(dim+1), hyperparameters_list_vector);
 
@@ -67,26 +74,70 @@ GaussianProcessMCMC * make_gaussian_process_mcmc(const boost::python::list& hype
   std::vector<int> derivatives_vector(num_derivatives);
   CopyPylistToIntVector(derivatives, num_derivatives, derivatives_vector);
 
-  GaussianProcessMCMC * new_gp_mcmc = new GaussianProcessMCMC(hyperparameters_list_vector.data(), noise_variance_list_vector.data(),
-                                                              num_mcmc, points_sampled_vector.data(), points_sampled_value_vector.data(),
-                                                              derivatives_vector.data(), num_derivatives,
-                                                              dim, num_sampled);
+  ScopedGILRelease gil_release;
+  PythonGaussianProcessMCMC * new_gp_mcmc = new PythonGaussianProcessMCMC(hyperparameters_list_vector.data(), noise_variance_list_vector.data(),
+                                                                          num_mcmc, points_sampled_vector.data(), points_sampled_value_vector.data(),
+                                                                          derivatives_vector.data(), num_derivatives,
+                                                                          dim, num_sampled, omp_get_max_threads());
   for (int i=0;i<num_mcmc;i++){
-      new_gp_mcmc->gaussian_process_lst[i].SetRandomizedSeed(0);
+      new_gp_mcmc->model.gaussian_process_lst[i].SetRandomizedSeed(0);
   }
   return new_gp_mcmc;
 }
 
-double ComputeKnowledgeGradientMCMCWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
+void AddPointsToGPMCMCWrapper(PythonGaussianProcessMCMC * gaussian_process_mcmc_handle,
+                              const boost::python::object& new_points,
+                              const boost::python::object& new_points_value,
+                              int num_new_points) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC * gaussian_process_mcmc = &gaussian_process_mcmc_handle->model;
+  const int dim = gaussian_process_mcmc->dim();
+  const int num_derivatives = gaussian_process_mcmc->num_derivatives();
+  std::vector<double> new_points_C(dim*num_new_points);
+  CopyPylistToVector(new_points, dim*num_new_points, new_points_C);
+
+  std::vector<double> new_points_value_C(num_new_points*(1+num_derivatives));
+  CopyPylistToVector(new_points_value, num_new_points*(1+num_derivatives), new_points_value_C);
+
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_mcmc_handle->mutex);
+  gaussian_process_mcmc->AddPointsToGP(new_points_C.data(), new_points_value_C.data(), num_new_points,
+                                       omp_get_max_threads());
+}
+
+void SetHyperparametersMCMCWrapper(PythonGaussianProcessMCMC * gaussian_process_mcmc_handle,
+                                   const boost::python::object& hyperparameters_list,
+                                   const boost::python::object& noise_variance_list) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC * gaussian_process_mcmc = &gaussian_process_mcmc_handle->model;
+  const int num_mcmc = gaussian_process_mcmc->num_mcmc();
+  const int dim = gaussian_process_mcmc->dim();
+  const int num_derivatives = gaussian_process_mcmc->num_derivatives();
+  std::vector<double> hyperparameters_list_vector(num_mcmc*(dim+1));
+  CopyPylistToVector(hyperparameters_list, num_mcmc*(dim+1), hyperparameters_list_vector);
+
+  std::vector<double> noise_variance_list_vector(num_mcmc*(1+num_derivatives));
+  CopyPylistToVector(noise_variance_list, num_mcmc*(1+num_derivatives), noise_variance_list_vector);
+
+  ScopedGILRelease gil_release;
+  std::lock_guard<SharedMutex> model_lock(gaussian_process_mcmc_handle->mutex);
+  gaussian_process_mcmc->SetHyperparameters(hyperparameters_list_vector.data(), noise_variance_list_vector.data(),
+                                            omp_get_max_threads());
+}
+
+double ComputeKnowledgeGradientMCMCWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
                                            const int num_fidelity,
                                            const boost::python::object& optimizer_parameters,
-                                           const boost::python::list& domain_bounds,
-                                           const boost::python::list& discrete_pts,
-                                           const boost::python::list& points_to_sample,
-                                           const boost::python::list& points_being_sampled,
+                                           const boost::python::object& domain_bounds,
+                                           const boost::python::object& discrete_pts,
+                                           const boost::python::object& points_to_sample,
+                                           const boost::python::object& points_being_sampled,
                                            int num_pts, int num_to_sample, int num_being_sampled,
-                                           int max_int_steps, const boost::python::list& best_so_far,
-                                           RandomnessSourceContainer& randomness_source) {
+                                           int max_int_steps, const boost::python::object& best_so_far,
+                                           RandomnessSourceContainer& randomness_source,
+                                           bool use_gpu, int which_gpu) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -106,10 +157,14 @@ double ComputeKnowledgeGradientMCMCWrapper(GaussianProcessMCMC& gaussian_process
   TensorProductDomain domain(domain_bounds_C.data(), input_container.dim-num_fidelity);
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
+  ScopedGILRelease gil_release;
+  ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+  std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
   std::vector<typename KnowledgeGradientState<TensorProductDomain>::EvaluatorType> evaluator_vector;
   KnowledgeGradientMCMCEvaluator<TensorProductDomain> kg_evaluator(gaussian_process_mcmc, num_fidelity, input_container_discrete.points_to_sample.data(),
                                                                    num_pts, max_int_steps, domain, gradient_descent_parameters,
-                                                                   best_so_far_list.data(), &evaluator_vector);
+                                                                   best_so_far_list.data(), &evaluator_vector,
+                                                                   omp_get_max_threads(), use_gpu ? which_gpu : kNoGpu);
 
   std::vector<typename KnowledgeGradientEvaluator<TensorProductDomain>::StateType> state_vector;
   KnowledgeGradientMCMCEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
@@ -122,16 +177,19 @@ double ComputeKnowledgeGradientMCMCWrapper(GaussianProcessMCMC& gaussian_process
   return kg_evaluator.ComputeKnowledgeGradient(&kg_state);
 }
 
-boost::python::list ComputeGradKnowledgeGradientMCMCWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
+boost::python::list ComputeGradKnowledgeGradientMCMCWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
                                                             const int num_fidelity,
                                                             const boost::python::object& optimizer_parameters,
-                                                            const boost::python::list& domain_bounds,
-                                                            const boost::python::list& discrete_pts,
-                                                            const boost::python::list& points_to_sample,
-                                                            const boost::python::list& points_being_sampled,
+                                                            const boost::python::object& domain_bounds,
+                                                            const boost::python::object& discrete_pts,
+                                                            const boost::python::object& points_to_sample,
+                                                            const boost::python::object& points_being_sampled,
                                                             int num_pts, int num_to_sample, int num_being_sampled,
-                                                            int max_int_steps, const boost::python::list& best_so_far,
-                                                            RandomnessSourceContainer& randomness_source) {
+                                                            int max_int_steps, const boost::python::object& best_so_far,
+                                                            RandomnessSourceContainer& randomness_source,
+                                                            bool use_gpu, int which_gpu) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   int num_derivatives_input = 0;
   const boost::python::list gradients;
 
@@ -152,20 +210,26 @@ boost::python::list ComputeGradKnowledgeGradientMCMCWrapper(GaussianProcessMCMC&
   TensorProductDomain domain(domain_bounds_C.data(), input_container.dim-num_fidelity);
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
-  std::vector<typename KnowledgeGradientState<TensorProductDomain>::EvaluatorType> evaluator_vector;
-  KnowledgeGradientMCMCEvaluator<TensorProductDomain> kg_evaluator(gaussian_process_mcmc, num_fidelity, input_container_discrete.points_to_sample.data(),
-                                                                   num_pts, max_int_steps, domain, gradient_descent_parameters,
-                                                                   best_so_far_list.data(), &evaluator_vector);
-
-  std::vector<typename KnowledgeGradientEvaluator<TensorProductDomain>::StateType> state_vector;
-  KnowledgeGradientMCMCEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
-                                                                          input_container.points_being_sampled.data(),
-                                                                          input_container.num_to_sample,
-                                                                          input_container.num_being_sampled,
-                                                                          num_pts, gaussian_process_mcmc.derivatives().data(),
-                                                                          gaussian_process_mcmc.num_derivatives(), configure_for_gradients,
-                                                                          randomness_source.normal_rng_vec.data(), &state_vector);
-  kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad_KG.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    std::vector<typename KnowledgeGradientState<TensorProductDomain>::EvaluatorType> evaluator_vector;
+    KnowledgeGradientMCMCEvaluator<TensorProductDomain> kg_evaluator(gaussian_process_mcmc, num_fidelity, input_container_discrete.points_to_sample.data(),
+                                                                     num_pts, max_int_steps, domain, gradient_descent_parameters,
+                                                                     best_so_far_list.data(), &evaluator_vector,
+                                                                     omp_get_max_threads(), use_gpu ? which_gpu : kNoGpu);
+
+    std::vector<typename KnowledgeGradientEvaluator<TensorProductDomain>::StateType> state_vector;
+    KnowledgeGradientMCMCEvaluator<TensorProductDomain>::StateType kg_state(kg_evaluator, input_container.points_to_sample.data(),
+                                                                            input_container.points_being_sampled.data(),
+                                                                            input_container.num_to_sample,
+                                                                            input_container.num_being_sampled,
+                                                                            num_pts, gaussian_process_mcmc.derivatives().data(),
+                                                                            gaussian_process_mcmc.num_derivatives(), configure_for_gradients,
+                                                                            randomness_source.normal_rng_vec.data(), &state_vector);
+    kg_evaluator.ComputeGradKnowledgeGradient(&kg_state, grad_KG.data());
+  }
 
   return VectorToPylist(grad_KG);
 }
@@ -199,7 +263,7 @@ boost::python::list ComputeGradKnowledgeGradientMCMCWrapper(GaussianProcessMCMC&
 template <typename DomainType>
 void DispatchKnowledgeGradientMCMCOptimization(const boost::python::object& optimizer_parameters,
                                                const boost::python::object& optimizer_parameters_inner,
-                                               GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
+                                               PythonGaussianProcessMCMC& gaussian_process_mcmc_handle, const int num_fidelity,
                                                const PythonInterfaceInputContainer& input_container_discrete,
                                                const PythonInterfaceInputContainer& input_container,
                                                const DomainType& domain, const DomainType& inner_domain, OptimizerTypes optimizer_type,
@@ -208,6 +272,7 @@ void DispatchKnowledgeGradientMCMCOptimization(const boost::python::object& opti
                                                RandomnessSourceContainer& randomness_source,
                                                boost::python::dict& status,
                                                double * restrict best_points_to_sample) {
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
 
   bool found_flag = false;
 
@@ -218,15 +283,20 @@ void DispatchKnowledgeGradientMCMCOptimization(const boost::python::object& opti
       const GradientDescentParameters& gradient_descent_parameters_inner = boost::python::extract<GradientDescentParameters&>(optimizer_parameters_inner.attr("optimizer_parameters"));
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
-      ComputeKGMCMCOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
-                                                                input_container.points_being_sampled.data(),
-                                                                input_container_discrete.points_to_sample.data(),
-                                                                num_random_samples, num_to_sample,
-                                                                input_container.num_being_sampled,
-                                                                num_pts, best_so_far_list.data(), max_int_steps,
-                                                                &found_flag, &randomness_source.uniform_generator,
-                                                                randomness_source.normal_rng_vec.data(),
-                                                                best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeKGMCMCOptimalPointsToSampleViaLatinHypercubeSearch(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
+                                                                  input_container.points_being_sampled.data(),
+                                                                  input_container_discrete.points_to_sample.data(),
+                                                                  num_random_samples, num_to_sample,
+                                                                  input_container.num_being_sampled,
+                                                                  num_pts, best_so_far_list.data(), max_int_steps,
+                                                                  &found_flag, &randomness_source.uniform_generator,
+                                                                  randomness_source.normal_rng_vec.data(),
+                                                                  best_points_to_sample);
+      }
       status[std::string("lhc_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
     }  // end case kNull optimizer_type
@@ -239,11 +309,16 @@ void DispatchKnowledgeGradientMCMCOptimization(const boost::python::object& opti
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
 
       bool random_search_only = false;
-      ComputeKGMCMCOptimalPointsToSample(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
-                                         input_container.points_being_sampled.data(), input_container_discrete.points_to_sample.data(),
-                                         num_to_sample, input_container.num_being_sampled, num_pts,
-                                         best_so_far_list.data(), max_int_steps, random_search_only, num_random_samples, &found_flag,
-                                         &randomness_source.uniform_generator, randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeKGMCMCOptimalPointsToSample(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters, gradient_descent_parameters_inner, domain, inner_domain, thread_schedule,
+                                           input_container.points_being_sampled.data(), input_container_discrete.points_to_sample.data(),
+                                           num_to_sample, input_container.num_being_sampled, num_pts,
+                                           best_so_far_list.data(), max_int_steps, random_search_only, num_random_samples, &found_flag,
+                                           &randomness_source.uniform_generator, randomness_source.normal_rng_vec.data(), best_points_to_sample);
+      }
 
       status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
       break;
@@ -258,14 +333,16 @@ void DispatchKnowledgeGradientMCMCOptimization(const boost::python::object& opti
 
 boost::python::list MultistartKnowledgeGradientMCMCOptimizationWrapper(const boost::python::object& optimizer_parameters,
                                                                        const boost::python::object& optimizer_parameters_inner,
-                                                                       GaussianProcessMCMC& gaussian_process_mcmc, const int num_fidelity,
-                                                                       const boost::python::list& domain_bounds,
-                                                                       const boost::python::list& discrete_pts,
-                                                                       const boost::python::list& points_being_sampled,
+                                                                       PythonGaussianProcessMCMC& gaussian_process_mcmc_handle, const int num_fidelity,
+                                                                       const boost::python::object& domain_bounds,
+                                                                       const boost::python::object& discrete_pts,
+                                                                       const boost::python::object& points_being_sampled,
                                                                        int num_pts, int num_to_sample, int num_being_sampled,
-                                                                       const boost::python::list& best_so_far, int max_int_steps, int max_num_threads,
+                                                                       const boost::python::object& best_so_far, int max_int_steps, int max_num_threads,
                                                                        RandomnessSourceContainer& randomness_source,
                                                                        boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   // TODO(GH-131): make domain objects constructible from python; and pass them in through
   // the optimizer_parameters python object
 
@@ -300,7 +377,7 @@ boost::python::list MultistartKnowledgeGradientMCMCOptimizationWrapper(const boo
       TensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
       TensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim-num_fidelity);
 
-      DispatchKnowledgeGradientMCMCOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_mcmc, num_fidelity, input_container_discrete,
+      DispatchKnowledgeGradientMCMCOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_mcmc_handle, num_fidelity, input_container_discrete,
                                                 input_container, domain, inner_domain, optimizer_type, num_pts, num_to_sample, best_so_far_list,
                                                 max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -309,7 +386,7 @@ boost::python::list MultistartKnowledgeGradientMCMCOptimizationWrapper(const boo
       SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), input_container.dim);
       SimplexIntersectTensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim-num_fidelity);
 
-      DispatchKnowledgeGradientMCMCOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_mcmc, num_fidelity, input_container_discrete,
+      DispatchKnowledgeGradientMCMCOptimization(optimizer_parameters, optimizer_parameters_inner, gaussian_process_mcmc_handle, num_fidelity, input_container_discrete,
                                                 input_container, domain, inner_domain, optimizer_type, num_pts, num_to_sample, best_so_far_list,
                                                 max_int_steps, max_num_threads, randomness_source, status, best_points_to_sample_C.data());
       break;
@@ -324,17 +401,19 @@ boost::python::list MultistartKnowledgeGradientMCMCOptimizationWrapper(const boo
   return VectorToPylist(best_points_to_sample_C);
 }
 
-boost::python::list EvaluateKGMCMCAtPointListWrapper(GaussianProcessMCMC& gaussian_process_mcmc,
+boost::python::list EvaluateKGMCMCAtPointListWrapper(PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
                                                      const int num_fidelity,
                                                      const boost::python::object& optimizer_parameters,
-                                                     const boost::python::list& domain_bounds,
-                                                     const boost::python::list& initial_guesses,
-                                                     const boost::python::list& discrete_being_sampled,
+                                                     const boost::python::object& domain_bounds,
+                                                     const boost::python::object& initial_guesses,
+                                                     const boost::python::object& discrete_being_sampled,
                                                      int num_multistarts, int num_pts, int num_to_sample,
-                                                     int num_being_sampled, const boost::python::list& best_so_far,
+                                                     int num_being_sampled, const boost::python::object& best_so_far,
                                                      int max_int_steps, int max_num_threads,
                                                      RandomnessSourceContainer& randomness_source,
                                                      boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
   // abort if we do not have enough sources of randomness to run with max_num_threads
   if (unlikely(max_num_threads > static_cast<int>(randomness_source.normal_rng_vec.size()))) {
     OL_THROW_EXCEPTION(LowerBoundException<int>, "Fewer randomness_sources than max_num_threads.", randomness_source.normal_rng_vec.size(), max_num_threads);
@@ -372,20 +451,54 @@ boost::python::list EvaluateKGMCMCAtPointListWrapper(GaussianProcessMCMC& gaussi
   TensorProductDomain inner_domain(domain_bounds_C.data(), input_container.dim- num_fidelity);
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
 
-  EvaluateKGMCMCAtPointList(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters, domain, inner_domain, thread_schedule, initial_guesses_C.data(),
-                            discrete_pts_and_pts_being_sampled.data() + num_pts*gaussian_process_mcmc.num_mcmc()*(gaussian_process_mcmc.dim()-num_fidelity),
-                            discrete_pts_and_pts_being_sampled.data(), num_multistarts, num_to_sample, input_container.num_being_sampled,
-                            num_pts, best_so_far_list.data(), max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
-                            result_function_values_C.data(), result_point_C.data());
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    EvaluateKGMCMCAtPointList(gaussian_process_mcmc, num_fidelity, gradient_descent_parameters, domain, inner_domain, thread_schedule, initial_guesses_C.data(),
+                              discrete_pts_and_pts_being_sampled.data() + num_pts*gaussian_process_mcmc.num_mcmc()*(gaussian_process_mcmc.dim()-num_fidelity),
+                              discrete_pts_and_pts_being_sampled.data(), num_multistarts, num_to_sample, input_container.num_being_sampled,
+                              num_pts, best_so_far_list.data(), max_int_steps, &found_flag, randomness_source.normal_rng_vec.data(),
+                              result_function_values_C.data(), result_point_C.data());
+  }
 
   status["evaluate_KG_at_point_list"] = found_flag;
 
   return VectorToPylist(result_function_values_C);
 }
+
+boost::python::list ThompsonSamplingMCMCOptimizationWrapper(const LBFGSBParameters& optimizer_parameters,
+                                                            const PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                            const boost::python::object& domain_bounds,
+                                                            int num_to_sample, int num_features, int num_candidates,
+                                                            int max_num_threads, RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
+  const int dim = gaussian_process_mcmc.dim();
+  std::vector<ClosedInterval> domain_bounds_C(dim);
+  CopyPylistToClosedIntervalVector(domain_bounds, dim, domain_bounds_C);
+  TensorProductDomain domain(domain_bounds_C.data(), dim);
+
+  std::vector<double> best_points_to_sample_C(dim*num_to_sample);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    UniformRandomGenerator::EngineType::result_type seed;
+    {
+      // the draws seed themselves from one base seed, so the lock is only held to advance the shared generator
+      std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+      seed = randomness_source.uniform_generator.GetEngine()();
+    }
+    ComputeThompsonSamplingPointsToSample(gaussian_process_mcmc, num_to_sample, num_features, num_candidates,
+                                          optimizer_parameters, domain, max_num_threads, seed,
+                                          best_points_to_sample_C.data());
+  }
+  return VectorToPylist(best_points_to_sample_C);
+}
 }  // end unnamed namespace
 
 void ExportKnowldegeGradientMCMCFunctions() {
-  boost::python::class_<GaussianProcessMCMC, boost::noncopyable>("GaussianProcessMCMC", boost::python::no_init)
+  boost::python::class_<PythonGaussianProcessMCMC, boost::noncopyable>("GaussianProcessMCMC", boost::python::no_init)
       .def("__init__", boost::python::make_constructor(&make_gaussian_process_mcmc), R"%%(
     Constructor for a ``GPP.GaussianProcess`` object.
 
@@ -403,6 +516,26 @@ void ExportKnowldegeGradientMCMCFunctions() {
     :type param: int > 0
     :param num_sampled: number of already-sampled points
     :type num_sampled: int > 0
+          )%%")
+      .def("add_sampled_points", AddPointsToGPMCMCWrapper, R"%%(
+    Add the specified (point, fcn value) historical data to every GP, updating their cholesky factors incrementally.
+    Waits for computations using these GPs in other threads to finish.
+
+    :param new_points: coordinates of each new point to add
+    :type new_points: list of float64 with shape (num_new_points, dim)
+    :param new_points_value: function value (and observed derivatives) at each new point
+    :type new_points_value: list of float64 with shape (num_new_points, num_derivatives + 1)
+    :param num_new_points: number of new points to add
+    :type num_new_points: int
+          )%%")
+      .def("set_hyperparameters", SetHyperparametersMCMCWrapper, R"%%(
+    Replace the hyperparameter samples, keeping the historical data; the number of samples cannot change.
+    Waits for computations using these GPs in other threads to finish.
+
+    :param hyperparameters_list: covariance hyperparameters (signal variance, then length scales) of each sample
+    :type hyperparameters_list: list of float64 with shape (num_mcmc, dim + 1)
+    :param noise_variance_list: noise variances of each sample
+    :type noise_variance_list: list of float64 with shape (num_mcmc, num_derivatives + 1)
           )%%");
 
   boost::python::def("compute_knowledge_gradient_mcmc", ComputeKnowledgeGradientMCMCWrapper, R"%%(
@@ -430,6 +563,10 @@ void ExportKnowldegeGradientMCMCFunctions() {
     :type force_monte_carlo: bool
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
+    :param use_gpu: true to draw the MC normals on a GPU; throws if MOE was built without its GPU components
+    :type use_gpu: bool
+    :param which_gpu: GPU device ID; ignored unless use_gpu
+    :type which_gpu: int >= 0
     :return: computed EI
     :rtype: float64 >= 0.0
     )%%");
@@ -459,6 +596,10 @@ void ExportKnowldegeGradientMCMCFunctions() {
     :type force_monte_carlo: bool
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
+    :param use_gpu: true to draw the MC normals on a GPU; throws if MOE was built without its GPU components
+    :type use_gpu: bool
+    :param which_gpu: GPU device ID; ignored unless use_gpu
+    :type which_gpu: int >= 0
     :return: gradient of EI (computed at points_to_sample + points_being_sampled, wrt points_to_sample)
     :rtype: list of float64 with shape (num_to_sample, dim)
     )%%");
@@ -481,9 +622,6 @@ void ExportKnowldegeGradientMCMCFunctions() {
     * optimizer_parameters (*Parameters struct (gpp_optimizer_parameters.hpp) where * matches optimizer_type
       unused if optimizer_type == kNull)
 
-    This function also has the option of using GPU to compute general q,p-EI via MC simulation. To enable it,
-    make sure you have installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     .. WARNING:: this function FAILS and returns an EMPTY LIST if the number of random sources < max_num_threads
 
     :param optimizer_parameters: python object containing the DomainTypes domain_type and
@@ -506,10 +644,6 @@ void ExportKnowldegeGradientMCMCFunctions() {
     :type max_int_steps: int >= 0
     :param max_num_threads: max number of threads to use during EI optimization
     :type max_num_threads: int >= 1
-    :param use_gpu: set to 1 if user wants to use GPU for MC computation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
     :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
@@ -518,6 +652,38 @@ void ExportKnowldegeGradientMCMCFunctions() {
     :rtype: list of float64 with shape (num_to_sample, dim)
     )%%");
 
+  boost::python::def("thompson_sampling_mcmc_optimization", ThompsonSamplingMCMCOptimizationWrapper, R"%%(
+    Choose num_to_sample points to sample next by Thompson sampling averaged over hyperparameter samples: each point is the minimum of an
+    independent posterior sample path (random Fourier features + pathwise update, see gpp_posterior_sample.hpp),
+    found by a uniform candidate search polished with L-BFGS-B. The paths are drawn and optimized in parallel and the
+    cost is linear in num_to_sample, so this scales to large batches where q,p-EI and q-KG do not.
+    points_being_sampled are not conditioned on. Only tensor product domains are supported.
+
+    The base seed is drawn from randomness_source's uniform generator; for a fixed seed, the result does not depend on
+    max_num_threads.
+
+    :param optimizer_parameters: L-BFGS-B refinement settings; num_multistarts is the number of candidates refined
+      per sample path, max_num_steps = 0 skips refinement
+    :type optimizer_parameters: LBFGSBParameters
+    :param gaussian_process_mcmc: GaussianProcessMCMC object (one GP per hyperparameter sample); point i is drawn
+      from the GP of hyperparameter sample i % num_mcmc
+    :type gaussian_process_mcmc: GPP.GaussianProcessMCMC
+    :param domain: [lower, upper] bound pairs for each dimension
+    :type domain: list of float64 with shape (dim, 2)
+    :param num_to_sample: number of points to choose (i.e., the "q" of the batch)
+    :type num_to_sample: int > 0
+    :param num_features: number of spectral frequencies per sample path (suggest: 500-2000)
+    :type num_features: int > 0
+    :param num_candidates: number of uniform candidate points per sample path
+    :type num_candidates: int > 0
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources; only the uniform generator is used
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :return: next set of points to eval
+    :rtype: list of float64 with shape (num_to_sample, dim)
+    )%%");
+
   boost::python::def("evaluate_KG_mcmc_at_point_list", EvaluateKGMCMCAtPointListWrapper, R"%%(
     Evaluates the expected improvement at each point in initial_guesses; can handle q,p-EI.
     Useful for plotting.
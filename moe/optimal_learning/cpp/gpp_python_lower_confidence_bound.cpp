@@ -0,0 +1,384 @@
+/*!
+  \file gpp_python_lower_confidence_bound.cpp
+  \rst
+  This file has the logic to invoke C++ functions pertaining to the lower confidence bound from Python.
+  The data flow follows the basic 4 step from gpp_python_common.hpp.
+
+  .. Note:: several internal functions of this source file are only called from ``Export*()`` functions,
+  so their description, inputs, outputs, etc. comments have been moved. These comments exist in
+  ``Export*()`` as Python docstrings, so we saw no need to repeat ourselves.
+\endrst*/
+// This include violates the Google Style Guide by placing an "other" system header ahead of C and C++ system headers.  However,
+// it needs to be at the top, otherwise compilation fails on some systems with some versions of python: OS X, python 2.7.3.
+// Putting this include first prevents pyport from doing something illegal in C++; reference: http://bugs.python.org/issue10910
+#include "Python.h"  // NOLINT(build/include)
+
+#include "gpp_python_lower_confidence_bound.hpp"
+
+// NOLINT-ing the C, C++ header includes as well; otherwise cpplint gets confused
+#include <algorithm>  // NOLINT(build/include_order)
+#include <mutex>  // NOLINT(build/include_order)
+#include <string>  // NOLINT(build/include_order)
+#include <vector>  // NOLINT(build/include_order)
+
+#include <boost/python/def.hpp>  // NOLINT(build/include_order)
+#include <boost/python/dict.hpp>  // NOLINT(build/include_order)
+#include <boost/python/extract.hpp>  // NOLINT(build/include_order)
+#include <boost/python/list.hpp>  // NOLINT(build/include_order)
+#include <boost/python/object.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_knowledge_gradient_mcmc_optimization.hpp"
+#include "gpp_lower_confidence_bound.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_python_common.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+boost::python::list ComputeLowerConfidenceBoundWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                                       const boost::python::object& points_to_sample,
+                                                       int num_to_sample, double exploration_weight,
+                                                       int max_num_threads) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process.dim(), num_to_sample,
+                                                num_derivatives_input);
+
+  std::vector<double> lower_confidence_bound(num_to_sample);
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    LowerConfidenceBoundEvaluator lcb_evaluator(gaussian_process, exploration_weight);
+    lcb_evaluator.ComputeLowerConfidenceBoundOfPoints(input_container.points_to_sample.data(), num_to_sample,
+                                                      max_num_threads, lower_confidence_bound.data());
+  }
+  return VectorToPylist(lower_confidence_bound);
+}
+
+boost::python::list ComputeGradLowerConfidenceBoundWrapper(const PythonGaussianProcess& gaussian_process_handle,
+                                                           const boost::python::object& point_to_sample,
+                                                           double exploration_weight) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(point_to_sample, gradients, gaussian_process.dim(), 1,
+                                                num_derivatives_input);
+
+  std::vector<double> grad_LCB(input_container.dim);
+  bool configure_for_gradients = true;
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+    LowerConfidenceBoundEvaluator lcb_evaluator(gaussian_process, exploration_weight);
+    LowerConfidenceBoundEvaluator::StateType lcb_state(lcb_evaluator, input_container.points_to_sample.data(),
+                                                       configure_for_gradients);
+    lcb_evaluator.ComputeGradLowerConfidenceBound(&lcb_state, grad_LCB.data());
+  }
+  return VectorToPylist(grad_LCB);
+}
+
+boost::python::list ComputeLowerConfidenceBoundMCMCWrapper(const PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                           const boost::python::object& points_to_sample,
+                                                           int num_to_sample, double exploration_weight) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(points_to_sample, gradients, gaussian_process_mcmc.dim(),
+                                                num_to_sample, num_derivatives_input);
+
+  std::vector<double> lower_confidence_bound(num_to_sample);
+  bool configure_for_gradients = false;
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    LowerConfidenceBoundMCMCEvaluator lcb_evaluator(gaussian_process_mcmc, exploration_weight);
+    LowerConfidenceBoundMCMCEvaluator::StateType lcb_state(lcb_evaluator, input_container.points_to_sample.data(),
+                                                           configure_for_gradients);
+    for (int i = 0; i < num_to_sample; ++i) {
+      lcb_state.SetCurrentPoint(lcb_evaluator, input_container.points_to_sample.data() + i*input_container.dim);
+      lower_confidence_bound[i] = lcb_evaluator.ComputeLowerConfidenceBound(&lcb_state);
+    }
+  }
+  return VectorToPylist(lower_confidence_bound);
+}
+
+boost::python::list ComputeGradLowerConfidenceBoundMCMCWrapper(const PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+                                                               const boost::python::object& point_to_sample,
+                                                               double exploration_weight) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
+  int num_derivatives_input = 0;
+  const boost::python::list gradients;
+
+  PythonInterfaceInputContainer input_container(point_to_sample, gradients, gaussian_process_mcmc.dim(), 1,
+                                                num_derivatives_input);
+
+  std::vector<double> grad_LCB(input_container.dim);
+  bool configure_for_gradients = true;
+  {
+    ScopedGILRelease gil_release;
+    ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+    LowerConfidenceBoundMCMCEvaluator lcb_evaluator(gaussian_process_mcmc, exploration_weight);
+    LowerConfidenceBoundMCMCEvaluator::StateType lcb_state(lcb_evaluator, input_container.points_to_sample.data(),
+                                                           configure_for_gradients);
+    lcb_evaluator.ComputeGradLowerConfidenceBound(&lcb_state, grad_LCB.data());
+  }
+  return VectorToPylist(grad_LCB);
+}
+
+boost::python::list MultistartLowerConfidenceBoundOptimizationWrapper(const boost::python::object& optimizer_parameters,
+                                                                      const PythonGaussianProcess& gaussian_process_handle,
+                                                                      const boost::python::object& domain_bounds,
+                                                                      double exploration_weight, int num_refined_starts,
+                                                                      int max_num_threads,
+                                                                      RandomnessSourceContainer& randomness_source,
+                                                                      boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcess& gaussian_process = gaussian_process_handle.model;
+  const int dim = gaussian_process.dim();
+  std::vector<ClosedInterval> domain_bounds_C(dim);
+  CopyPylistToClosedIntervalVector(domain_bounds, dim, domain_bounds_C);
+
+  std::vector<double> best_point_to_sample_C(dim);
+
+  bool found_flag = false;
+  const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+
+  DomainTypes domain_type = boost::python::extract<DomainTypes>(optimizer_parameters.attr("domain_type"));
+  switch (domain_type) {
+    case DomainTypes::kTensorProduct: {
+      TensorProductDomain domain(domain_bounds_C.data(), dim);
+
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeLCBOptimalPointToSample(gaussian_process, exploration_weight, gradient_descent_parameters, domain,
+                                       thread_schedule, num_refined_starts, &found_flag,
+                                       &randomness_source.uniform_generator, best_point_to_sample_C.data());
+      }
+      status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
+      break;
+    }  // end case DomainTypes::kTensorProduct
+    case DomainTypes::kSimplex: {
+      SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), dim);
+
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeLCBOptimalPointToSample(gaussian_process, exploration_weight, gradient_descent_parameters, domain,
+                                       thread_schedule, num_refined_starts, &found_flag,
+                                       &randomness_source.uniform_generator, best_point_to_sample_C.data());
+      }
+      status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
+      break;
+    }  // end case DomainTypes::kSimplex
+    default: {
+      std::fill(best_point_to_sample_C.begin(), best_point_to_sample_C.end(), 0.0);
+      OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid domain choice. Setting all coordinates to 0.0.");
+      break;
+    }
+  }  // end switch over domain_type
+
+  return VectorToPylist(best_point_to_sample_C);
+}
+
+boost::python::list MultistartLowerConfidenceBoundMCMCOptimizationWrapper(
+    const boost::python::object& optimizer_parameters, const PythonGaussianProcessMCMC& gaussian_process_mcmc_handle,
+    const boost::python::object& domain_bounds, double exploration_weight, int num_refined_starts,
+    int max_num_threads, RandomnessSourceContainer& randomness_source, boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const GaussianProcessMCMC& gaussian_process_mcmc = gaussian_process_mcmc_handle.model;
+  const int dim = gaussian_process_mcmc.dim();
+  std::vector<ClosedInterval> domain_bounds_C(dim);
+  CopyPylistToClosedIntervalVector(domain_bounds, dim, domain_bounds_C);
+
+  std::vector<double> best_point_to_sample_C(dim);
+
+  bool found_flag = false;
+  const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+
+  DomainTypes domain_type = boost::python::extract<DomainTypes>(optimizer_parameters.attr("domain_type"));
+  switch (domain_type) {
+    case DomainTypes::kTensorProduct: {
+      TensorProductDomain domain(domain_bounds_C.data(), dim);
+
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeLCBMCMCOptimalPointToSample(gaussian_process_mcmc, exploration_weight, gradient_descent_parameters,
+                                           domain, thread_schedule, num_refined_starts, &found_flag,
+                                           &randomness_source.uniform_generator, best_point_to_sample_C.data());
+      }
+      status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
+      break;
+    }  // end case DomainTypes::kTensorProduct
+    case DomainTypes::kSimplex: {
+      SimplexIntersectTensorProductDomain domain(domain_bounds_C.data(), dim);
+
+      {
+        ScopedGILRelease gil_release;
+        ScopedSharedLock model_lock(gaussian_process_mcmc_handle.mutex);
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        ComputeLCBMCMCOptimalPointToSample(gaussian_process_mcmc, exploration_weight, gradient_descent_parameters,
+                                           domain, thread_schedule, num_refined_starts, &found_flag,
+                                           &randomness_source.uniform_generator, best_point_to_sample_C.data());
+      }
+      status[std::string("gradient_descent_") + domain.kName + "_domain_found_update"] = found_flag;
+      break;
+    }  // end case DomainTypes::kSimplex
+    default: {
+      std::fill(best_point_to_sample_C.begin(), best_point_to_sample_C.end(), 0.0);
+      OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid domain choice. Setting all coordinates to 0.0.");
+      break;
+    }
+  }  // end switch over domain_type
+
+  return VectorToPylist(best_point_to_sample_C);
+}
+
+}  // end unnamed namespace
+
+void ExportLowerConfidenceBoundFunctions() {
+  boost::python::def("compute_lower_confidence_bound", ComputeLowerConfidenceBoundWrapper, R"%%(
+    Compute the lower confidence bound ``LCB(x) = \mu(x) - \beta \sigma(x)`` at each point of points_to_sample.
+    Lower is better: optimization MINIMIZES LCB.
+
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param points_to_sample: points at which to evaluate LCB
+    :type points_to_sample: list of float64 with shape (num_to_sample, dim)
+    :param num_to_sample: number of points to evaluate
+    :type num_to_sample: int > 0
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :return: LCB at each point
+    :rtype: list of float64 with shape (num_to_sample, )
+    )%%");
+
+  boost::python::def("compute_grad_lower_confidence_bound", ComputeGradLowerConfidenceBoundWrapper, R"%%(
+    Compute the gradient of the lower confidence bound wrt point_to_sample.
+
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param point_to_sample: point at which to differentiate LCB
+    :type point_to_sample: list of float64 with shape (1, dim)
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :return: gradient of LCB
+    :rtype: list of float64 with shape (dim, )
+    )%%");
+
+  boost::python::def("compute_lower_confidence_bound_mcmc", ComputeLowerConfidenceBoundMCMCWrapper, R"%%(
+    Compute the lower confidence bound averaged over hyperparameter samples,
+    ``\frac{1}{M}\sum_k (\mu_k(x) - \beta \sigma_k(x))``, at each point of points_to_sample.
+
+    :param gaussian_process_mcmc: GaussianProcessMCMC object (one GP per hyperparameter sample)
+    :type gaussian_process_mcmc: GPP.GaussianProcessMCMC
+    :param points_to_sample: points at which to evaluate LCB
+    :type points_to_sample: list of float64 with shape (num_to_sample, dim)
+    :param num_to_sample: number of points to evaluate
+    :type num_to_sample: int > 0
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :return: averaged LCB at each point
+    :rtype: list of float64 with shape (num_to_sample, )
+    )%%");
+
+  boost::python::def("compute_grad_lower_confidence_bound_mcmc", ComputeGradLowerConfidenceBoundMCMCWrapper, R"%%(
+    Compute the gradient of the hyperparameter-averaged lower confidence bound wrt point_to_sample.
+
+    :param gaussian_process_mcmc: GaussianProcessMCMC object (one GP per hyperparameter sample)
+    :type gaussian_process_mcmc: GPP.GaussianProcessMCMC
+    :param point_to_sample: point at which to differentiate LCB
+    :type point_to_sample: list of float64 with shape (1, dim)
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :return: gradient of the averaged LCB
+    :rtype: list of float64 with shape (dim, )
+    )%%");
+
+  boost::python::def("multistart_lower_confidence_bound_optimization", MultistartLowerConfidenceBoundOptimizationWrapper, R"%%(
+    Minimize the lower confidence bound over the specified domain with multistart gradient descent.
+    optimizer_parameters.num_multistarts uniform start points are screened and gradient descent runs from the
+    num_refined_starts best of them; the result is never worse than the best start.
+
+    The _CppOptimizerParameters object is a python class defined in:
+    python/cpp_wrappers/optimization._CppOptimizerParameters
+    See that class definition for more details.
+
+    This function expects it to have the fields:
+
+    * domain_type (DomainTypes enum from this file)
+    * optimizer_type (must be kGradientDescent)
+    * optimizer_parameters (GradientDescentParameters struct)
+
+    :param optimizer_parameters: python object containing the DomainTypes domain_type and
+      GradientDescentParameters optimizer_parameters to use
+    :type optimizer_parameters: _CppOptimizerParameters
+    :param gaussian_process: GaussianProcess object (holds points_sampled, values, noise_variance, derived quantities)
+    :type gaussian_process: GPP.GaussianProcess (boost::python ctor wrapper around optimal_learning::GaussianProcess)
+    :param domain: [lower, upper] bound pairs for each dimension
+    :type domain: list of float64 with shape (dim, 2)
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :param num_refined_starts: number of screened start points to run gradient descent from
+    :type num_refined_starts: int >= 1
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources; only the uniform generator is used
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
+    :type status: dict
+    :return: next point to eval
+    :rtype: list of float64 with shape (dim, )
+    )%%");
+
+  boost::python::def("multistart_lower_confidence_bound_mcmc_optimization", MultistartLowerConfidenceBoundMCMCOptimizationWrapper, R"%%(
+    Minimize the hyperparameter-averaged lower confidence bound over the specified domain with multistart gradient
+    descent; see multistart_lower_confidence_bound_optimization.
+
+    :param optimizer_parameters: python object containing the DomainTypes domain_type and
+      GradientDescentParameters optimizer_parameters to use
+    :type optimizer_parameters: _CppOptimizerParameters
+    :param gaussian_process_mcmc: GaussianProcessMCMC object (one GP per hyperparameter sample)
+    :type gaussian_process_mcmc: GPP.GaussianProcessMCMC
+    :param domain: [lower, upper] bound pairs for each dimension
+    :type domain: list of float64 with shape (dim, 2)
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :param num_refined_starts: number of screened start points to run gradient descent from
+    :type num_refined_starts: int >= 1
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources; only the uniform generator is used
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
+    :type status: dict
+    :return: next point to eval
+    :rtype: list of float64 with shape (dim, )
+    )%%");
+}
+
+}  // end namespace optimal_learning
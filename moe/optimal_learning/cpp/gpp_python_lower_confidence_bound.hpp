@@ -0,0 +1,27 @@
+/*!
+  \file gpp_python_lower_confidence_bound.hpp
+  \rst
+  This file registers the translation layer for invoking LowerConfidenceBound functions
+  (e.g., computing/optimizing LCB; see gpp_lower_confidence_bound.hpp) from Python.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_LOWER_CONFIDENCE_BOUND_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_LOWER_CONFIDENCE_BOUND_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Exports functions (with docstrings) for lower confidence bound operations, for a GaussianProcess and a
+  GaussianProcessMCMC:
+
+  1. LCB evaluation at a list of points (useful for testing, plotting)
+  2. gradient of LCB at a point (useful for testing)
+  3. multistart LCB optimization (main entry-point)
+\endrst*/
+void ExportLowerConfidenceBoundFunctions();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_LOWER_CONFIDENCE_BOUND_HPP_
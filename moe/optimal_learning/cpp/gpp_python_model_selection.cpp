@@ -27,27 +27,70 @@
 #include <boost/python/list.hpp>  // NOLINT(build/include_order)
 #include <boost/python/object.hpp>  // NOLINT(build/include_order)
 
+#include "gpp_approximate_log_likelihood.hpp"
 #include "gpp_common.hpp"
 #include "gpp_covariance.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_exception.hpp"
 #include "gpp_geometry.hpp"
+#include "gpp_hyperparameter_mcmc.hpp"
 #include "gpp_model_selection.hpp"
+#include "gpp_optimization.hpp"
 #include "gpp_optimizer_parameters.hpp"
+#include "gpp_profiling.hpp"
 #include "gpp_python_common.hpp"
 
 namespace optimal_learning {
 
 namespace {
 
-double ComputeLogLikelihoodWrapper(const boost::python::list& points_sampled,
-                                   const boost::python::list& points_sampled_value,
+/*!\rst
+  Estimator settings for LogLikelihoodTypes::kApproximateLogMarginalLikelihood requests from Python: the suggested
+  defaults in ApproximateLogLikelihoodParameters.
+\endrst*/
+ApproximateLogLikelihoodParameters DefaultApproximateLogLikelihoodParameters() {
+  return ApproximateLogLikelihoodParameters(ApproximateLogLikelihoodParameters::kDefaultNumProbes,
+                                            ApproximateLogLikelihoodParameters::kDefaultNumLanczosSteps,
+                                            ApproximateLogLikelihoodParameters::kDefaultMaxNumCGSteps,
+                                            ApproximateLogLikelihoodParameters::kDefaultCGTolerance,
+                                            ApproximateLogLikelihoodParameters::kDefaultProbeSeed);
+}
+
+/*!\rst
+  Converts per-start optimization traces into a list (one entry per multistart) of dicts keyed by the
+  OptimizationTrace field names.
+
+  \param
+    :start_traces: traces to convert
+  \return
+    python list of dicts, element-wise equivalent to start_traces
+\endrst*/
+boost::python::list OptimizationTracesToPylist(const std::vector<OptimizationTrace>& start_traces) {
+  boost::python::list result;
+  for (const auto& trace : start_traces) {
+    boost::python::dict trace_dict;
+    trace_dict["num_restarts"] = trace.num_restarts;
+    trace_dict["num_steps"] = trace.num_steps;
+    trace_dict["num_boundary_steps"] = trace.num_boundary_steps;
+    trace_dict["final_gradient_norm"] = trace.final_gradient_norm;
+    trace_dict["objective_value"] = trace.objective_value;
+    trace_dict["converged"] = trace.converged;
+    trace_dict["optimum_index"] = trace.optimum_index;
+    trace_dict["final_point"] = VectorToPylist(trace.final_point);
+    result.append(trace_dict);
+  }
+  return result;
+}
+
+double ComputeLogLikelihoodWrapper(const boost::python::object& points_sampled,
+                                   const boost::python::object& points_sampled_value,
                                    int dim, int num_sampled,
                                    LogLikelihoodTypes objective_type,
-                                   const boost::python::list& hyperparameters,
-                                   const boost::python::list& derivatives,
+                                   const boost::python::object& hyperparameters,
+                                   const boost::python::object& derivatives,
                                    int num_derivatives,
-                                   const boost::python::list& noise_variance) {
+                                   const boost::python::object& noise_variance) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   const int num_to_sample = 0;
   const boost::python::list points_to_sample_dummy;
 
@@ -56,6 +99,7 @@ double ComputeLogLikelihoodWrapper(const boost::python::list& points_sampled,
 
   SquareExponential sqexp(input_container.dim, input_container.alpha, input_container.lengths.data());
 
+  ScopedGILRelease gil_release;
   switch (objective_type) {
     case LogLikelihoodTypes::kLogMarginalLikelihood: {
       LogMarginalLikelihoodEvaluator log_marginal_eval(input_container.points_sampled.data(),
@@ -67,17 +111,27 @@ double ComputeLogLikelihoodWrapper(const boost::python::list& points_sampled,
       double log_likelihood = log_marginal_eval.ComputeLogLikelihood(log_marginal_state);
       return log_likelihood;
     }  // end case LogLikelihoodTypes::kLogMarginalLikelihood
-/*    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
+    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
       LeaveOneOutLogLikelihoodEvaluator leave_one_out_eval(input_container.points_sampled.data(),
                                                            input_container.points_sampled_value.data(),
-                                                           input_container.noise_variance.data(),
-                                                           input_container.dim,
-                                                           input_container.num_sampled);
-      LeaveOneOutLogLikelihoodState leave_one_out_state(leave_one_out_eval, matern_25);
+                                                           input_container.derivatives.data(), input_container.num_derivatives,
+                                                           input_container.dim, input_container.num_sampled);
+      LeaveOneOutLogLikelihoodState leave_one_out_state(leave_one_out_eval, sqexp, input_container.noise_variance);
 
       double loo_likelihood = leave_one_out_eval.ComputeLogLikelihood(leave_one_out_state);
       return loo_likelihood;
-    }*/
+    }  // end case LogLikelihoodTypes::kLeaveOneOutLogLikelihood
+    case LogLikelihoodTypes::kApproximateLogMarginalLikelihood: {
+      ApproximateLogMarginalLikelihoodEvaluator approximate_eval(input_container.points_sampled.data(),
+                                                                 input_container.points_sampled_value.data(),
+                                                                 input_container.derivatives.data(), input_container.num_derivatives,
+                                                                 input_container.dim, input_container.num_sampled,
+                                                                 DefaultApproximateLogLikelihoodParameters());
+      ApproximateLogMarginalLikelihoodState approximate_state(approximate_eval, sqexp, input_container.noise_variance);
+
+      double log_likelihood = approximate_eval.ComputeLogLikelihood(approximate_state);
+      return log_likelihood;
+    }  // end case LogLikelihoodTypes::kApproximateLogMarginalLikelihood
     default: {
       double log_likelihood = -std::numeric_limits<double>::max();
       OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid objective mode choice. Setting log likelihood to -DBL_MAX.");
@@ -86,14 +140,15 @@ double ComputeLogLikelihoodWrapper(const boost::python::list& points_sampled,
   }  // end switch over objective_type
 }
 
-boost::python::list ComputeHyperparameterGradLogLikelihoodWrapper(const boost::python::list& points_sampled,
-                                                                  const boost::python::list& points_sampled_value,
+boost::python::list ComputeHyperparameterGradLogLikelihoodWrapper(const boost::python::object& points_sampled,
+                                                                  const boost::python::object& points_sampled_value,
                                                                   int dim, int num_sampled,
                                                                   LogLikelihoodTypes objective_type,
-                                                                  const boost::python::list& hyperparameters,
-                                                                  const boost::python::list& derivatives,
+                                                                  const boost::python::object& hyperparameters,
+                                                                  const boost::python::object& derivatives,
                                                                   int num_derivatives,
-                                                                  const boost::python::list& noise_variance) {
+                                                                  const boost::python::object& noise_variance) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   const int num_to_sample = 0;
   const boost::python::list points_to_sample_dummy;
 
@@ -103,34 +158,47 @@ boost::python::list ComputeHyperparameterGradLogLikelihoodWrapper(const boost::p
   SquareExponential sqexp(input_container.dim, input_container.alpha, input_container.lengths.data());
 
   std::vector<double> grad_log_likelihood(sqexp.GetNumberOfHyperparameters() + 1 + num_derivatives);
-  switch (objective_type) {
-    case LogLikelihoodTypes::kLogMarginalLikelihood: {
-      LogMarginalLikelihoodEvaluator log_marginal_eval(input_container.points_sampled.data(),
-                                                       input_container.points_sampled_value.data(),
-                                                       input_container.derivatives.data(), input_container.num_derivatives,
-                                                       input_container.dim, input_container.num_sampled);
-      LogMarginalLikelihoodState log_marginal_state(log_marginal_eval, sqexp, input_container.noise_variance);
-
-      log_marginal_eval.ComputeGradLogLikelihood(&log_marginal_state, grad_log_likelihood.data());
-      break;
-    }  // end case LogLikelihoodTypes::kLogMarginalLikelihood
-/*    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
-      LeaveOneOutLogLikelihoodEvaluator leave_one_out_eval(input_container.points_sampled.data(),
-                                                           input_container.points_sampled_value.data(),
-                                                           input_container.noise_variance.data(),
-                                                           input_container.dim,
-                                                           input_container.num_sampled);
-      LeaveOneOutLogLikelihoodState leave_one_out_state(leave_one_out_eval, matern_25);
-
-      leave_one_out_eval.ComputeGradLogLikelihood(&leave_one_out_state, grad_log_likelihood.data());
-      break;
-    }*/
-    default: {
-      std::fill(grad_log_likelihood.begin(), grad_log_likelihood.end(), std::numeric_limits<double>::max());
-      OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid objective mode choice. Setting all gradients to DBL_MAX.");
-      break;
-    }
-  }  // end switch over objective_type
+  {
+    ScopedGILRelease gil_release;
+    switch (objective_type) {
+      case LogLikelihoodTypes::kLogMarginalLikelihood: {
+        LogMarginalLikelihoodEvaluator log_marginal_eval(input_container.points_sampled.data(),
+                                                         input_container.points_sampled_value.data(),
+                                                         input_container.derivatives.data(), input_container.num_derivatives,
+                                                         input_container.dim, input_container.num_sampled);
+        LogMarginalLikelihoodState log_marginal_state(log_marginal_eval, sqexp, input_container.noise_variance);
+
+        log_marginal_eval.ComputeGradLogLikelihood(&log_marginal_state, grad_log_likelihood.data());
+        break;
+      }  // end case LogLikelihoodTypes::kLogMarginalLikelihood
+      case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
+        LeaveOneOutLogLikelihoodEvaluator leave_one_out_eval(input_container.points_sampled.data(),
+                                                             input_container.points_sampled_value.data(),
+                                                             input_container.derivatives.data(), input_container.num_derivatives,
+                                                             input_container.dim, input_container.num_sampled);
+        LeaveOneOutLogLikelihoodState leave_one_out_state(leave_one_out_eval, sqexp, input_container.noise_variance);
+
+        leave_one_out_eval.ComputeGradLogLikelihood(&leave_one_out_state, grad_log_likelihood.data());
+        break;
+      }  // end case LogLikelihoodTypes::kLeaveOneOutLogLikelihood
+      case LogLikelihoodTypes::kApproximateLogMarginalLikelihood: {
+        ApproximateLogMarginalLikelihoodEvaluator approximate_eval(input_container.points_sampled.data(),
+                                                                   input_container.points_sampled_value.data(),
+                                                                   input_container.derivatives.data(), input_container.num_derivatives,
+                                                                   input_container.dim, input_container.num_sampled,
+                                                                   DefaultApproximateLogLikelihoodParameters());
+        ApproximateLogMarginalLikelihoodState approximate_state(approximate_eval, sqexp, input_container.noise_variance);
+
+        approximate_eval.ComputeGradLogLikelihood(&approximate_state, grad_log_likelihood.data());
+        break;
+      }  // end case LogLikelihoodTypes::kApproximateLogMarginalLikelihood
+      default: {
+        std::fill(grad_log_likelihood.begin(), grad_log_likelihood.end(), std::numeric_limits<double>::max());
+        OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid objective mode choice. Setting all gradients to DBL_MAX.");
+        break;
+      }
+    }  // end switch over objective_type
+  }
   return VectorToPylist(grad_log_likelihood);
 }
 
@@ -175,9 +243,13 @@ void DispatchHyperparameterOptimization(const boost::python::object& optimizer_p
       // optimizer_parameters must contain an int num_random_samples field, extract it
       int num_random_samples = boost::python::extract<int>(optimizer_parameters.attr("num_random_samples"));
       ThreadSchedule thread_schedule(max_num_threads, omp_sched_guided);
-      LatinHypercubeSearchHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance, hyperparameter_domain,
-                                                     thread_schedule, num_random_samples, &found_flag,
-                                                     &randomness_source.uniform_generator, new_hyperparameters);
+      {
+        ScopedGILRelease gil_release;
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        LatinHypercubeSearchHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance, hyperparameter_domain,
+                                                       thread_schedule, num_random_samples, &found_flag,
+                                                       &randomness_source.uniform_generator, new_hyperparameters);
+      }
       status[std::string(log_likelihood_eval.kName) + "_lhc_found_update"] = found_flag;
       break;
     }  // end case kNull for optimizer_type
@@ -186,28 +258,75 @@ void DispatchHyperparameterOptimization(const boost::python::object& optimizer_p
       // of type GradientDescentParameters. extract it
       const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
       ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
-      MultistartGradientDescentHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance,
-                                                          gradient_descent_parameters,
-                                                          hyperparameter_domain,
-                                                          thread_schedule, &found_flag,
-                                                          &randomness_source.uniform_generator,
-                                                          new_hyperparameters);
+      std::vector<OptimizationTrace> start_traces;
+      {
+        ScopedGILRelease gil_release;
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        MultistartGradientDescentHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance,
+                                                            gradient_descent_parameters,
+                                                            hyperparameter_domain,
+                                                            thread_schedule, &found_flag,
+                                                            &randomness_source.uniform_generator,
+                                                            &start_traces, new_hyperparameters);
+      }
       status[std::string(log_likelihood_eval.kName) + "_gradient_descent_found_update"] = found_flag;
+      if (gradient_descent_parameters.record_traces) {
+        status[std::string(log_likelihood_eval.kName) + "_gradient_descent_start_traces"] =
+            OptimizationTracesToPylist(start_traces);
+      }
       break;
     }  // end case kGradientDescent for optimizer_type
-/*    case OptimizerTypes::kNewton: {
+    case OptimizerTypes::kLBFGSB: {
+      // optimizer_parameters must contain a optimizer_parameters field
+      // of type LBFGSBParameters. extract it
+      const LBFGSBParameters& lbfgsb_parameters = boost::python::extract<LBFGSBParameters&>(optimizer_parameters.attr("optimizer_parameters"));
+      ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+      {
+        ScopedGILRelease gil_release;
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        MultistartLBFGSBHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance,
+                                                   lbfgsb_parameters, hyperparameter_domain,
+                                                   thread_schedule, &found_flag,
+                                                   &randomness_source.uniform_generator,
+                                                   new_hyperparameters);
+      }
+      status[std::string(log_likelihood_eval.kName) + "_l_bfgs_b_found_update"] = found_flag;
+      break;
+    }  // end case kLBFGSB for optimizer_type
+    case OptimizerTypes::kLineSearchGradientDescent: {
+      // optimizer_parameters must contain a optimizer_parameters field
+      // of type LineSearchGradientDescentParameters. extract it
+      const LineSearchGradientDescentParameters& ls_parameters = boost::python::extract<LineSearchGradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
+      ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+      {
+        ScopedGILRelease gil_release;
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        MultistartLineSearchGradientDescentHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance,
+                                                                      ls_parameters, hyperparameter_domain,
+                                                                      thread_schedule, &found_flag,
+                                                                      &randomness_source.uniform_generator,
+                                                                      new_hyperparameters);
+      }
+      status[std::string(log_likelihood_eval.kName) + "_line_search_gradient_descent_found_update"] = found_flag;
+      break;
+    }  // end case kLineSearchGradientDescent for optimizer_type
+    case OptimizerTypes::kNewton: {
       // optimizer_parameters must contain a optimizer_parameters field
       // of type NewtonParameters. extract it
       const NewtonParameters& newton_parameters = boost::python::extract<NewtonParameters&>(optimizer_parameters.attr("optimizer_parameters"));
       ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
-      MultistartNewtonHyperparameterOptimization(log_likelihood_eval, covariance,
-                                                 newton_parameters, hyperparameter_domain,
-                                                 thread_schedule, &found_flag,
-                                                 &randomness_source.uniform_generator,
-                                                 new_hyperparameters);
+      {
+        ScopedGILRelease gil_release;
+        std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+        MultistartNewtonHyperparameterOptimization(log_likelihood_eval, covariance, noise_variance,
+                                                   newton_parameters, hyperparameter_domain,
+                                                   thread_schedule, &found_flag,
+                                                   &randomness_source.uniform_generator,
+                                                   new_hyperparameters);
+      }
       status[std::string(log_likelihood_eval.kName) + "_newton_found_update"] = found_flag;
       break;
-    }  // end case kNewton for optimizer_type */
+    }  // end case kNewton for optimizer_type
     default: {
       std::fill(new_hyperparameters, new_hyperparameters + covariance.GetNumberOfHyperparameters() + noise_variance.size(), 1.0);
       OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid optimizer choice. Setting all hyperparameters to 1.0.");
@@ -217,16 +336,17 @@ void DispatchHyperparameterOptimization(const boost::python::object& optimizer_p
 }
 
 boost::python::list MultistartHyperparameterOptimizationWrapper(const boost::python::object& optimizer_parameters,
-                                                                const boost::python::list& hyperparameter_domain,
-                                                                const boost::python::list& points_sampled,
-                                                                const boost::python::list& points_sampled_value,
+                                                                const boost::python::object& hyperparameter_domain,
+                                                                const boost::python::object& points_sampled,
+                                                                const boost::python::object& points_sampled_value,
                                                                 int dim, int num_sampled,
-                                                                const boost::python::list& hyperparameters,
-                                                                const boost::python::list& noise_variance,
-                                                                const boost::python::list& derivatives,
+                                                                const boost::python::object& hyperparameters,
+                                                                const boost::python::object& noise_variance,
+                                                                const boost::python::object& derivatives,
                                                                 int num_derivatives, int max_num_threads,
                                                                 RandomnessSourceContainer& randomness_source,
                                                                 boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   // TODO(GH-131): make domain objects constructible from python; and pass them in through
   // the optimizer_parameters python object
   const int num_to_sample = 0;
@@ -257,17 +377,29 @@ boost::python::list MultistartHyperparameterOptimizationWrapper(const boost::pyt
                                          randomness_source, status, new_hyperparameters.data());
       break;
     }  // end case LogLikelihoodTypes::kLogMarginalLikelihood
-/*    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
+    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
       LeaveOneOutLogLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
                                                             input_container.points_sampled_value.data(),
-                                                            input_container.noise_variance.data(),
+                                                            input_container.derivatives.data(), input_container.num_derivatives,
                                                             input_container.dim, input_container.num_sampled);
 
-      DispatchHyperparameterOptimization(optimizer_parameters, log_likelihood_eval, matern_25,
+      DispatchHyperparameterOptimization(optimizer_parameters, log_likelihood_eval, sqexp, input_container.noise_variance,
+                                         hyperparameter_domain_C.data(), optimizer_type, max_num_threads,
+                                         randomness_source, status, new_hyperparameters.data());
+      break;
+    }  // end case LogLikelihoodTypes::kLeaveOneOutLogLikelihood
+    case LogLikelihoodTypes::kApproximateLogMarginalLikelihood: {
+      ApproximateLogMarginalLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                                    input_container.points_sampled_value.data(),
+                                                                    input_container.derivatives.data(), input_container.num_derivatives,
+                                                                    input_container.dim, input_container.num_sampled,
+                                                                    DefaultApproximateLogLikelihoodParameters());
+
+      DispatchHyperparameterOptimization(optimizer_parameters, log_likelihood_eval, sqexp, input_container.noise_variance,
                                          hyperparameter_domain_C.data(), optimizer_type, max_num_threads,
                                          randomness_source, status, new_hyperparameters.data());
       break;
-    }  // end case LogLikelihoodTypes::kLeaveOneOutLogLikelihood*/
+    }  // end case LogLikelihoodTypes::kApproximateLogMarginalLikelihood
     default: {
       std::fill(new_hyperparameters.begin(), new_hyperparameters.end(), 1.0);
       OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid objective type choice. Setting all hyperparameters to 1.0.");
@@ -278,17 +410,18 @@ boost::python::list MultistartHyperparameterOptimizationWrapper(const boost::pyt
   return VectorToPylist(new_hyperparameters);
 }
 
-boost::python::list EvaluateLogLikelihoodAtHyperparameterListWrapper(const boost::python::list& hyperparameter_list,
-                                                                     const boost::python::list& points_sampled,
-                                                                     const boost::python::list& points_sampled_value,
+boost::python::list EvaluateLogLikelihoodAtHyperparameterListWrapper(const boost::python::object& hyperparameter_list,
+                                                                     const boost::python::object& points_sampled,
+                                                                     const boost::python::object& points_sampled_value,
                                                                      int dim, int num_sampled,
                                                                      LogLikelihoodTypes objective_mode,
-                                                                     const boost::python::list& hyperparameters,
-                                                                     const boost::python::list& noise_variance,
-                                                                     const boost::python::list& derivatives,
+                                                                     const boost::python::object& hyperparameters,
+                                                                     const boost::python::object& noise_variance,
+                                                                     const boost::python::object& derivatives,
                                                                      int num_derivatives,
                                                                      int num_multistarts, int max_num_threads,
                                                                      boost::python::dict& status) {
+  OL_PROFILE_TOP_LEVEL_CALL();
   const int num_to_sample = 0;
   const boost::python::list points_to_sample_dummy;
   PythonInterfaceInputContainer input_container(hyperparameters, points_sampled, points_sampled_value, noise_variance,
@@ -312,23 +445,44 @@ boost::python::list EvaluateLogLikelihoodAtHyperparameterListWrapper(const boost
                                                          input_container.points_sampled_value.data(),
                                                          input_container.derivatives.data(), input_container.num_derivatives,
                                                          input_container.dim, input_container.num_sampled);
-      EvaluateLogLikelihoodAtPointList(log_likelihood_eval, sqexp, input_container.noise_variance, dummy_domain, thread_schedule,
-                                       initial_guesses_C.data(), num_multistarts, &found_flag,
-                                       result_function_values_C.data(), new_hyperparameters_C.data());
+      {
+        ScopedGILRelease gil_release;
+        EvaluateLogLikelihoodAtPointList(log_likelihood_eval, sqexp, input_container.noise_variance, dummy_domain, thread_schedule,
+                                         initial_guesses_C.data(), num_multistarts, &found_flag,
+                                         result_function_values_C.data(), new_hyperparameters_C.data());
+      }
       status[std::string("evaluate_") + log_likelihood_eval.kName + "_at_hyperparameter_list"] = found_flag;
       break;
     }
-/*    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
+    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
       LeaveOneOutLogLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
                                                             input_container.points_sampled_value.data(),
-                                                            input_container.noise_variance.data(),
+                                                            input_container.derivatives.data(), input_container.num_derivatives,
                                                             input_container.dim, input_container.num_sampled);
-      EvaluateLogLikelihoodAtPointList(log_likelihood_eval, matern_25, dummy_domain, thread_schedule,
-                                       initial_guesses_C.data(), num_multistarts, &found_flag,
-                                       result_function_values_C.data(), new_hyperparameters_C.data());
+      {
+        ScopedGILRelease gil_release;
+        EvaluateLogLikelihoodAtPointList(log_likelihood_eval, sqexp, input_container.noise_variance, dummy_domain, thread_schedule,
+                                         initial_guesses_C.data(), num_multistarts, &found_flag,
+                                         result_function_values_C.data(), new_hyperparameters_C.data());
+      }
       status[std::string("evaluate_") + log_likelihood_eval.kName + "_at_hyperparameter_list"] = found_flag;
       break;
-    }*/
+    }
+    case LogLikelihoodTypes::kApproximateLogMarginalLikelihood: {
+      ApproximateLogMarginalLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                                    input_container.points_sampled_value.data(),
+                                                                    input_container.derivatives.data(), input_container.num_derivatives,
+                                                                    input_container.dim, input_container.num_sampled,
+                                                                    DefaultApproximateLogLikelihoodParameters());
+      {
+        ScopedGILRelease gil_release;
+        EvaluateLogLikelihoodAtPointList(log_likelihood_eval, sqexp, input_container.noise_variance, dummy_domain, thread_schedule,
+                                         initial_guesses_C.data(), num_multistarts, &found_flag,
+                                         result_function_values_C.data(), new_hyperparameters_C.data());
+      }
+      status[std::string("evaluate_") + log_likelihood_eval.kName + "_at_hyperparameter_list"] = found_flag;
+      break;
+    }
     default: {
       std::fill(result_function_values_C.begin(), result_function_values_C.end(), -std::numeric_limits<double>::max());
       status["evaluate_invalid_log_likelihood_at_hyperparameter_list"] = found_flag;
@@ -340,16 +494,94 @@ boost::python::list EvaluateLogLikelihoodAtHyperparameterListWrapper(const boost
   return VectorToPylist(result_function_values_C);
 }
 
+boost::python::list EvaluateLogLikelihoodOfEnsembleWrapper(const boost::python::object& hyperparameter_ensemble,
+                                                           const boost::python::object& points_sampled,
+                                                           const boost::python::object& points_sampled_value,
+                                                           int dim, int num_sampled,
+                                                           LogLikelihoodTypes objective_mode,
+                                                           const boost::python::object& derivatives,
+                                                           int num_derivatives, int num_walkers,
+                                                           int max_num_threads) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const int num_to_sample = 0;
+  const boost::python::list points_to_sample_dummy;
+  // every walker sets its own hyperparameters; the values here only size the containers
+  const int num_noise = num_derivatives + 1;
+  boost::python::list hyperparameters_dummy;
+  boost::python::list lengths_dummy;
+  for (int i = 0; i < dim; ++i) {
+    lengths_dummy.append(1.0);
+  }
+  hyperparameters_dummy.append(1.0);
+  hyperparameters_dummy.append(lengths_dummy);
+  boost::python::list noise_variance_dummy;
+  for (int i = 0; i < num_noise; ++i) {
+    noise_variance_dummy.append(1.0);
+  }
+  PythonInterfaceInputContainer input_container(hyperparameters_dummy, points_sampled, points_sampled_value,
+                                                noise_variance_dummy, points_to_sample_dummy, derivatives,
+                                                num_derivatives, dim, num_sampled, num_to_sample);
+
+  SquareExponential sqexp(input_container.dim, input_container.alpha, input_container.lengths.data());
+  const int num_hyperparameters = sqexp.GetNumberOfHyperparameters() + num_noise;
+  std::vector<double> hyperparameter_ensemble_C(num_hyperparameters*num_walkers);
+  CopyPylistToVector(hyperparameter_ensemble, num_hyperparameters*num_walkers, hyperparameter_ensemble_C);
+  std::vector<double> log_likelihood_C(num_walkers);
+
+  // walkers cost the same, so a static schedule keeps each thread on one contiguous range
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_static);
+  switch (objective_mode) {
+    case LogLikelihoodTypes::kLogMarginalLikelihood: {
+      LogMarginalLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                         input_container.points_sampled_value.data(),
+                                                         input_container.derivatives.data(), input_container.num_derivatives,
+                                                         input_container.dim, input_container.num_sampled);
+      ScopedGILRelease gil_release;
+      EvaluateLogLikelihoodOfEnsemble(log_likelihood_eval, sqexp, input_container.noise_variance, thread_schedule,
+                                      hyperparameter_ensemble_C.data(), num_walkers, log_likelihood_C.data());
+      break;
+    }
+    case LogLikelihoodTypes::kLeaveOneOutLogLikelihood: {
+      LeaveOneOutLogLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                            input_container.points_sampled_value.data(),
+                                                            input_container.derivatives.data(), input_container.num_derivatives,
+                                                            input_container.dim, input_container.num_sampled);
+      ScopedGILRelease gil_release;
+      EvaluateLogLikelihoodOfEnsemble(log_likelihood_eval, sqexp, input_container.noise_variance, thread_schedule,
+                                      hyperparameter_ensemble_C.data(), num_walkers, log_likelihood_C.data());
+      break;
+    }
+    case LogLikelihoodTypes::kApproximateLogMarginalLikelihood: {
+      ApproximateLogMarginalLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                                    input_container.points_sampled_value.data(),
+                                                                    input_container.derivatives.data(), input_container.num_derivatives,
+                                                                    input_container.dim, input_container.num_sampled,
+                                                                    DefaultApproximateLogLikelihoodParameters());
+      ScopedGILRelease gil_release;
+      EvaluateLogLikelihoodOfEnsemble(log_likelihood_eval, sqexp, input_container.noise_variance, thread_schedule,
+                                      hyperparameter_ensemble_C.data(), num_walkers, log_likelihood_C.data());
+      break;
+    }
+    default: {
+      OL_THROW_EXCEPTION(OptimalLearningException, "ERROR: invalid objective mode choice.");
+      break;
+    }
+  }
+
+  return VectorToPylist(log_likelihood_C);
+}
+
 boost::python::list RestartedGradientDescentHyperparameterOptimizationWrapper(const boost::python::object& optimizer_parameters,
-                                                                              const boost::python::list& hyperparameter_domain,
-                                                                              const boost::python::list& points_sampled,
-                                                                              const boost::python::list& points_sampled_value,
+                                                                              const boost::python::object& hyperparameter_domain,
+                                                                              const boost::python::object& points_sampled,
+                                                                              const boost::python::object& points_sampled_value,
                                                                               int dim, int num_sampled,
-                                                                              const boost::python::list& hyperparameters,
-                                                                              const boost::python::list& noise_variance,
-                                                                              const boost::python::list& derivatives,
+                                                                              const boost::python::object& hyperparameters,
+                                                                              const boost::python::object& noise_variance,
+                                                                              const boost::python::object& derivatives,
                                                                               int num_derivatives,
                                                                               boost::python::dict& status){
+  OL_PROFILE_TOP_LEVEL_CALL();
   // the optimizer_parameters python object
   const int num_to_sample = 0;
   const boost::python::list points_to_sample_dummy;
@@ -370,12 +602,79 @@ boost::python::list RestartedGradientDescentHyperparameterOptimizationWrapper(co
                                                      input_container.derivatives.data(), input_container.num_derivatives,
                                                      input_container.dim, input_container.num_sampled);
   const GradientDescentParameters& gradient_descent_parameters = boost::python::extract<GradientDescentParameters&>(optimizer_parameters.attr("optimizer_parameters"));
-  RestartedGradientDescentHyperparameterOptimizationTensor(log_likelihood_eval, sqexp, input_container.noise_variance, gradient_descent_parameters,
-                                                           hyperparameter_domain_C.data(), new_hyperparameters.data());
+  {
+    ScopedGILRelease gil_release;
+    RestartedGradientDescentHyperparameterOptimizationTensor(log_likelihood_eval, sqexp, input_container.noise_variance, gradient_descent_parameters,
+                                                             hyperparameter_domain_C.data(), new_hyperparameters.data());
+  }
   return VectorToPylist(new_hyperparameters);
 }
 
 
+boost::python::list SliceSampleHyperparametersWrapper(const boost::python::object& log_hyperparameters,
+                                                       const boost::python::object& points_sampled,
+                                                       const boost::python::object& points_sampled_value,
+                                                       int dim, int num_sampled,
+                                                       const boost::python::object& derivatives,
+                                                       int num_derivatives,
+                                                       const boost::python::object& prior_parameters,
+                                                       const SliceSamplerParameters& sampler_parameters,
+                                                       int num_chains, bool sample_noise, bool initialize_from_prior,
+                                                       int max_num_threads,
+                                                       RandomnessSourceContainer& randomness_source) {
+  OL_PROFILE_TOP_LEVEL_CALL();
+  const int num_to_sample = 0;
+  const boost::python::list points_to_sample_dummy;
+  // covariance hyperparameters and noise are sampled; the values here only size the containers
+  const int num_covariance_hyperparameters = dim + 1;
+  const int num_noise = num_derivatives + 1;
+  const int num_hyperparameters = num_covariance_hyperparameters + num_noise;
+  boost::python::list hyperparameters_dummy;
+  boost::python::list lengths_dummy;
+  for (int i = 0; i < dim; ++i) {
+    lengths_dummy.append(1.0);
+  }
+  hyperparameters_dummy.append(1.0);
+  hyperparameters_dummy.append(lengths_dummy);
+  boost::python::list noise_variance_dummy;
+  for (int i = 0; i < num_noise; ++i) {
+    noise_variance_dummy.append(1.0);
+  }
+  PythonInterfaceInputContainer input_container(hyperparameters_dummy, points_sampled, points_sampled_value,
+                                                noise_variance_dummy, points_to_sample_dummy, derivatives,
+                                                num_derivatives, dim, num_sampled, num_to_sample);
+
+  SquareExponential sqexp(input_container.dim, input_container.alpha, input_container.lengths.data());
+  std::vector<double> prior_parameters_C(5);
+  CopyPylistToVector(prior_parameters, 5, prior_parameters_C);
+  HyperparameterPrior prior(num_covariance_hyperparameters, num_noise, prior_parameters_C[0], prior_parameters_C[1],
+                            prior_parameters_C[2], prior_parameters_C[3], prior_parameters_C[4]);
+
+  std::vector<double> log_hyperparameters_C(num_chains*num_hyperparameters);
+  CopyPylistToVector(log_hyperparameters, num_chains*num_hyperparameters, log_hyperparameters_C);
+  std::vector<double> hypers_mcmc(num_chains*num_covariance_hyperparameters);
+  std::vector<double> noises_mcmc(num_chains*num_noise);
+
+  LogMarginalLikelihoodEvaluator log_likelihood_eval(input_container.points_sampled.data(),
+                                                     input_container.points_sampled_value.data(),
+                                                     input_container.derivatives.data(), input_container.num_derivatives,
+                                                     input_container.dim, input_container.num_sampled);
+  ThreadSchedule thread_schedule(max_num_threads, omp_sched_dynamic);
+  {
+    ScopedGILRelease gil_release;
+    std::lock_guard<std::mutex> randomness_lock(randomness_source.mutex);
+    SliceSampleHyperparameters(log_likelihood_eval, sqexp, prior, sampler_parameters, num_chains, sample_noise,
+                               initialize_from_prior, thread_schedule, &randomness_source.uniform_generator,
+                               log_hyperparameters_C.data(), hypers_mcmc.data(), noises_mcmc.data());
+  }
+
+  boost::python::list result;
+  result.append(VectorToPylist(log_hyperparameters_C));
+  result.append(VectorToPylist(hypers_mcmc));
+  result.append(VectorToPylist(noises_mcmc));
+  return result;
+}
+
 }  // end unnamed namespace
 
 void ExportModelSelectionFunctions() {
@@ -465,7 +764,10 @@ void ExportModelSelectionFunctions() {
     :type max_num_threads: int >= 1
     :param randomness_source: object containing randomness sources; only thread 0's source is used
     :type randomness_source: GPP.RandomnessSourceContainer
-    :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred
+    :param status: pydict object (cannot be None!); modified on exit to describe whether convergence occurred.
+        With gradient descent and ``GradientDescentParameters.record_traces``, ``status["<log likelihood>_gradient_descent_start_traces"]``
+        holds one dict per multistart (keys: num_restarts, num_steps, num_boundary_steps, final_gradient_norm,
+        objective_value, converged, optimum_index, final_point).
     :type status: dict
     :return: optimized hyperparameters
     :rtype: list of float64 with shape (num_hyperparameters, )
@@ -556,6 +858,84 @@ void ExportModelSelectionFunctions() {
     :return: log likelihood values at each point of the hyperparameter_list list, in the same order
     :rtype: list of float64 with shape (num_multistarts, )
     )%%");
+
+  boost::python::def("evaluate_log_likelihood_of_ensemble", EvaluateLogLikelihoodOfEnsembleWrapper, R"%%(
+    Evaluates the specified log likelihood measure of model fit at every walker of an ensemble, e.g., all proposals
+    of one step of an ensemble MCMC sampler (emcee and the like).
+
+    Equivalent to calling compute_log_likelihood() once per walker, but the loop runs in C++ (multithreaded, one
+    reused state per thread). Unlike evaluate_log_likelihood_at_hyperparameter_list(), a bad walker does not abort
+    the call: walkers with a non-positive hyperparameter or a non-finite log likelihood get ``-inf``.
+
+    ``n_hyper`` denotes the number of hyperparameters: ``dim + 1`` covariance hyperparameters followed by
+    ``num_derivatives + 1`` noise variances, all in linear space.
+
+    :param hyperparameter_ensemble: hyperparameters of each walker
+    :type hyperparameter_ensemble: list of float64 with shape (num_walkers, n_hyper)
+    :param points_sampled: points that have already been sampled
+    :type points_sampled: list of float64 with shape (num_sampled, dim)
+    :param points_sampled_value: values (and gradients) of the already-sampled points
+    :type points_sampled_value: list of float64 with shape (num_sampled, num_derivatives + 1)
+    :param dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+    :type dim: int > 0
+    :param num_sampled: number of already-sampled points
+    :type num_sampled: int > 0
+    :param objective_mode: describes which log likelihood measure to compute (e.g., kLogMarginalLikelihood)
+    :type objective_mode: GPP.LogLikelihoodTypes (enum)
+    :param derivatives: indices of the dimensions whose gradients are observed
+    :type derivatives: list of int with shape (num_derivatives, )
+    :param num_derivatives: number of observed gradient components
+    :type num_derivatives: int >= 0
+    :param num_walkers: number of walkers
+    :type num_walkers: int > 0
+    :param max_num_threads: max number of threads to use
+    :type max_num_threads: int >= 1
+    :return: log likelihood of each walker, in the same order
+    :rtype: list of float64 with shape (num_walkers, )
+    )%%");
+
+  boost::python::def("slice_sample_hyperparameters", SliceSampleHyperparametersWrapper, R"%%(
+    Draws samples of the (squared exponential) covariance hyperparameters and noise variances from their posterior
+    under the log marginal likelihood, by running num_chains independent slice sampling chains in C++
+    (multithreaded). See gpp_hyperparameter_mcmc.hpp for details on the sampler and the prior.
+
+    ``n_hyper`` denotes the number of hyperparameters: ``dim + 1`` covariance hyperparameters followed by
+    ``num_derivatives + 1`` noise variances. Chain states are natural logs of the hyperparameters.
+
+    :param log_hyperparameters: initial state of each chain; noise entries must be set when sample_noise is False,
+      and every entry must be set unless initialize_from_prior is True
+    :type log_hyperparameters: list of float64 with shape (num_chains, n_hyper)
+    :param points_sampled: points that have already been sampled
+    :type points_sampled: list of float64 with shape (num_sampled, dim)
+    :param points_sampled_value: values (and gradients) of the already-sampled points
+    :type points_sampled_value: list of float64 with shape (num_sampled, num_derivatives + 1)
+    :param dim: the spatial dimension of a point (i.e., number of independent params in experiment)
+    :type dim: int > 0
+    :param num_sampled: number of already-sampled points
+    :type num_sampled: int > 0
+    :param derivatives: indices of the dimensions whose gradients are observed
+    :type derivatives: list of int with shape (num_derivatives, )
+    :param num_derivatives: number of observed gradient components
+    :type num_derivatives: int >= 0
+    :param prior_parameters: [amplitude_mean, amplitude_sigma, length_scale_min, length_scale_max, noise_scale]:
+      mean and standard deviation of the normal prior on the log signal variance, bounds of the tophat prior on the
+      log length scales, and scale of the horseshoe prior on the noise variances
+    :type prior_parameters: list of 5 float64
+    :param sampler_parameters: burn-in, chain length, and slice step control
+    :type sampler_parameters: GPP.SliceSamplerParameters
+    :param num_chains: number of chains (and samples)
+    :type num_chains: int > 0
+    :param sample_noise: whether to sample the noise variances (False holds them at their input values)
+    :type sample_noise: bool
+    :param initialize_from_prior: whether to initialize the sampled coordinates of each chain from the prior
+    :type initialize_from_prior: bool
+    :param max_num_threads: max number of threads to use during sampling
+    :type max_num_threads: int >= 1
+    :param randomness_source: object containing randomness sources; only the uniform generator is used
+    :type randomness_source: GPP.RandomnessSourceContainer
+    :return: [final chain states, hypers_mcmc, noises_mcmc]; the last two are ready for GaussianProcessMCMC
+    :rtype: list of 3 lists of float64 with shapes (num_chains, n_hyper), (num_chains, dim + 1), (num_chains, num_derivatives + 1)
+    )%%");
 }
 
 }  // end namespace optimal_learning
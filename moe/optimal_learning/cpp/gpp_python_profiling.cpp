@@ -0,0 +1,165 @@
+/*!
+  \file gpp_python_profiling.cpp
+  \rst
+  This file has the logic to read the C++ profile registry (gpp_profiling.hpp) from Python. Reports are converted to
+  nested dicts keyed by ProfilePhaseName() and ProfileCounterName().  It also exposes the process-wide switches of
+  LoopScheduleTuner (gpp_task_scheduler.hpp), which autotunes OpenMP schedules, and of ThreadPlacement.
+
+  .. Note:: several internal functions of this source file are only called from ``Export*()`` functions,
+    so their description, inputs, outputs, etc. comments have been moved. These comments exist in
+    ``Export*()`` as Python docstrings, so we saw no need to repeat ourselves.
+\endrst*/
+// This include violates the Google Style Guide by placing an "other" system header ahead of C and C++ system headers.  However,
+// it needs to be at the top, otherwise compilation fails on some systems with some versions of python: OS X, python 2.7.3.
+// Putting this include first prevents pyport from doing something illegal in C++; reference: http://bugs.python.org/issue10910
+#include "Python.h"  // NOLINT(build/include)
+
+#include "gpp_python_profiling.hpp"
+
+#include <boost/python/def.hpp>  // NOLINT(build/include_order)
+#include <boost/python/dict.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_task_scheduler.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+boost::python::dict ProfileReportToPydict(const ProfileReport& report) {
+  boost::python::dict phases;
+  for (int i = 0; i < kNumProfilePhases; ++i) {
+    const ProfilePhase phase = static_cast<ProfilePhase>(i);
+    boost::python::dict phase_entry;
+    phase_entry["seconds"] = report.seconds(phase);
+    phase_entry["calls"] = report.calls[i];
+    phases[ProfilePhaseName(phase)] = phase_entry;
+  }
+
+  boost::python::dict counters;
+  for (int i = 0; i < kNumProfileCounters; ++i) {
+    counters[ProfileCounterName(static_cast<ProfileCounter>(i))] = report.counters[i];
+  }
+
+  boost::python::dict result;
+  result["phases"] = phases;
+  result["counters"] = counters;
+  result["num_top_level_calls"] = report.num_top_level_calls;
+  return result;
+}
+
+bool ProfilingEnabledWrapper() {
+  return kProfilingEnabled;
+}
+
+boost::python::dict GetProfileTotalsWrapper() {
+  return ProfileReportToPydict(GetProfileTotals());
+}
+
+boost::python::dict GetLastProfileWrapper() {
+  return ProfileReportToPydict(GetLastTopLevelProfile());
+}
+
+void SetThreadScheduleAutotuningWrapper(bool enabled) {
+  LoopScheduleTuner::Instance().set_autotune_by_default(enabled);
+}
+
+bool ThreadScheduleAutotuningWrapper() {
+  return LoopScheduleTuner::Instance().autotune_by_default();
+}
+
+void ResetThreadScheduleAutotuningWrapper() {
+  LoopScheduleTuner::Instance().Reset();
+}
+
+void SetThreadPlacementWrapper(bool first_touch_states, bool pin_threads) {
+  ThreadPlacement::Instance().set_first_touch_states(first_touch_states);
+  ThreadPlacement::Instance().set_pin_threads(pin_threads);
+}
+
+boost::python::dict GetThreadPlacementWrapper() {
+  boost::python::dict result;
+  result["first_touch_states"] = ThreadPlacement::Instance().first_touch_states();
+  result["pin_threads"] = ThreadPlacement::Instance().pin_threads();
+  return result;
+}
+
+}  // end unnamed namespace
+
+void ExportProfilingFunctions() {
+  boost::python::def("profiling_enabled", ProfilingEnabledWrapper, R"%%(
+    Whether the C++ profiling instrumentation is compiled in (cmake ``-D MOE_USE_PROFILING=1``).
+    If False, the profile functions below still work but report zeros.
+
+    :return: True if ``OL_PROFILE_ENABLED`` was defined at build time
+    :rtype: bool
+    )%%");
+
+  boost::python::def("get_profile_totals", GetProfileTotalsWrapper, R"%%(
+    Get the time and counts recorded (by all threads) since the last ``reset_profile()``.
+
+    Phase times are inclusive (e.g., ``cholesky_factorization`` time inside a fit is also in ``gaussian_process_fit``)
+    and are summed over threads, so they can exceed wall-clock time.
+
+    :return: ``{'phases': {phase_name: {'seconds': float64, 'calls': int}}, 'counters': {counter_name: int},
+      'num_top_level_calls': int}``. Phases: gaussian_process_fit, cholesky_factorization, covariance_matrix_build,
+      monte_carlo_sampling, knowledge_gradient_inner_optimization, python_conversion. Counters: monte_carlo_samples,
+      knowledge_gradient_inner_solves, python_values_converted, result_cache_hits, result_cache_misses.
+    :rtype: dict
+    )%%");
+
+  boost::python::def("get_last_profile", GetLastProfileWrapper, R"%%(
+    Get the profile of the most recently completed top-level call, i.e., one of the main entry points
+    (GaussianProcess construction, compute/multistart EI and KG (+MCMC), hyperparameter optimization, etc.).
+
+    Includes the work of the OpenMP threads that call used. Calls made concurrently from other Python threads are
+    included as well.
+
+    :return: same format as ``get_profile_totals()``; ``num_top_level_calls`` is 1 (0 if no call has completed)
+    :rtype: dict
+    )%%");
+
+  boost::python::def("reset_profile", ResetProfile, R"%%(
+    Zero the totals reported by ``get_profile_totals()``. Does not change ``get_last_profile()``.
+    )%%");
+
+  boost::python::def("set_thread_schedule_autotuning", SetThreadScheduleAutotuningWrapper, R"%%(
+    Enable or disable OpenMP schedule autotuning for every multistart/evaluation loop in this process (default off).
+
+    When enabled, the first call for each (optimizer/evaluator type, problem size) times its iterations under dynamic
+    scheduling; later calls pick static, dynamic, or guided scheduling, a chunk size, and a thread count (never more
+    than the requested ``max_num_threads``) from those timings. Results do not change, only run times.
+
+    :param enabled: whether to autotune
+    :type enabled: bool
+    )%%");
+
+  boost::python::def("thread_schedule_autotuning", ThreadScheduleAutotuningWrapper, R"%%(
+    :return: whether ``set_thread_schedule_autotuning(True)`` is in effect
+    :rtype: bool
+    )%%");
+
+  boost::python::def("reset_thread_schedule_autotuning", ResetThreadScheduleAutotuningWrapper, R"%%(
+    Forget all calibrations, so each loop recalibrates on its next autotuned call (e.g., after changing the
+    machine's load or the GP size substantially).
+    )%%");
+
+  boost::python::def("set_thread_placement", SetThreadPlacementWrapper, R"%%(
+    Configure where per-thread data and OpenMP threads live (process-wide). Results never change, only run times.
+
+    :param first_touch_states: build each thread's state (EI, KG, log likelihood, ...) on that thread, so its memory is
+      on the thread's NUMA node (default True)
+    :type first_touch_states: bool
+    :param pin_threads: pin OpenMP worker threads to one CPU each (default False; ``OMP_PROC_BIND``/``OMP_PLACES``
+      are usually preferable). Pinned threads stay pinned for the life of the process.
+    :type pin_threads: bool
+    )%%");
+
+  boost::python::def("get_thread_placement", GetThreadPlacementWrapper, R"%%(
+    :return: ``{'first_touch_states': bool, 'pin_threads': bool}``, see ``set_thread_placement()``
+    :rtype: dict
+    )%%");
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,25 @@
+/*!
+  \file gpp_python_profiling.hpp
+  \rst
+  This file registers the translation layer for reading the profile registry (see gpp_profiling.hpp) from Python.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_PROFILING_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_PROFILING_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Exports functions (with docstrings) for profiling:
+
+  1. whether the ``OL_PROFILE_*`` instrumentation is compiled in
+  2. the totals since the last reset, and the profile of the last top-level call (as dicts)
+  3. resetting the totals
+\endrst*/
+void ExportProfilingFunctions();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_PYTHON_PROFILING_HPP_
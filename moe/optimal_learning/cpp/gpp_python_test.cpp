@@ -13,17 +13,33 @@
 
 #include <boost/python/def.hpp>  // NOLINT(build/include_order)
 
+#include "gpp_approximate_log_likelihood_test.hpp"
+#include "gpp_batched_gaussian_process_test.hpp"
 #include "gpp_common.hpp"
+#include "gpp_cost_model_test.hpp"
 #include "gpp_covariance_test.hpp"
+#include "gpp_distributed_test.hpp"
 #include "gpp_domain.hpp"
 #include "gpp_domain_test.hpp"
+#include "gpp_expected_improvement_gpu_test.hpp"
 #include "gpp_geometry_test.hpp"
+#include "gpp_hyperparameter_mcmc_test.hpp"
 #include "gpp_linear_algebra_test.hpp"
+#include "gpp_lower_confidence_bound_test.hpp"
 #include "gpp_math_test.hpp"
+#include "gpp_memory_budget_test.hpp"
 #include "gpp_model_selection.hpp"
 #include "gpp_model_selection_test.hpp"
+#include "gpp_model_snapshot_test.hpp"
 #include "gpp_optimization_test.hpp"
+#include "gpp_optimizer_session_test.hpp"
+#include "gpp_partitioned_gaussian_process_test.hpp"
+#include "gpp_posterior_sample_test.hpp"
+#include "gpp_profiling_test.hpp"
+#include "gpp_python_common.hpp"
 #include "gpp_random_test.hpp"
+#include "gpp_result_cache_test.hpp"
+#include "gpp_task_scheduler_test.hpp"
 #include "gpp_knowledge_gradient_optimization_test.hpp"
 #include "gpp_knowledge_gradient_inner_optimization_test.hpp"
 #include "gpp_test_utils_test.hpp"
@@ -33,6 +49,7 @@ namespace optimal_learning {
 namespace {
 
 int RunCppTestsWrapper() {
+  ScopedGILRelease gil_release;
   int total_errors = 0;
   int error = 0;
 
@@ -75,7 +92,7 @@ int RunCppTestsWrapper() {
     OL_SUCCESS_PRINTF("KG inner tests\n");
   }
   total_errors += error;
-/*
+
   error = RunKGTests();
   if (error != 0) {
     OL_FAILURE_PRINTF("KG tests failed\n");
@@ -83,7 +100,7 @@ int RunCppTestsWrapper() {
     OL_SUCCESS_PRINTF("KG tests\n");
   }
   total_errors += error;
-
+/*
   error = RunEIConsistencyTests();
   if (error != 0) {
     OL_FAILURE_PRINTF("analytic, MC EI do not match for 1 potential sample case\n");
@@ -107,6 +124,126 @@ int RunCppTestsWrapper() {
     OL_SUCCESS_PRINTF("LogLikelihood ping tests\n");
   }
   total_errors += error;
+
+  error = RunHyperparameterMCMCTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("hyperparameter MCMC tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("hyperparameter MCMC tests\n");
+  }
+  total_errors += error;
+
+  error = RunApproximateLogLikelihoodTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("approximate log likelihood tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("approximate log likelihood tests\n");
+  }
+  total_errors += error;
+
+  error = RunTaskSchedulerTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("task scheduler tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("task scheduler tests\n");
+  }
+  total_errors += error;
+
+  error = RunOptimizerSessionTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("optimizer session tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("optimizer session tests\n");
+  }
+  total_errors += error;
+
+  error = RunModelSnapshotTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("model snapshot tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("model snapshot tests\n");
+  }
+  total_errors += error;
+
+  error = RunPosteriorSampleTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("posterior sample tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("posterior sample tests\n");
+  }
+  total_errors += error;
+
+  error = RunLowerConfidenceBoundTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("lower confidence bound tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("lower confidence bound tests\n");
+  }
+  total_errors += error;
+
+  error = RunCostModelTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("cost model tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("cost model tests\n");
+  }
+  total_errors += error;
+
+  error = RunBatchedGaussianProcessTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("batched GP tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("batched GP tests\n");
+  }
+  total_errors += error;
+
+  error = RunDistributedTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("distributed context tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("distributed context tests\n");
+  }
+  total_errors += error;
+
+  error = RunMemoryBudgetTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("memory budget tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("memory budget tests\n");
+  }
+  total_errors += error;
+
+  error = RunPartitionedGaussianProcessTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("partitioned GP tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("partitioned GP tests\n");
+  }
+  total_errors += error;
+
+  error = RunProfilingTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("profiling tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("profiling tests\n");
+  }
+  total_errors += error;
+
+  error = RunResultCacheTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("result cache tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("result cache tests\n");
+  }
+  total_errors += error;
+
+  error = RunGPUTests();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("GPU tests failed\n");
+  } else {
+    OL_SUCCESS_PRINTF("GPU tests\n");
+  }
+  total_errors += error;
 /*
   error = RunRandomPointGeneratorTests();
   if (error != 0) {
@@ -188,6 +325,14 @@ int RunCppTestsWrapper() {
   }
   total_errors += error;
 
+  error = HyperparameterRefitTest();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("warm-started hyperparameter refits\n");
+  } else {
+    OL_SUCCESS_PRINTF("warm-started hyperparameter refits\n");
+  }
+  total_errors += error;
+
   error = EvaluateLogLikelihoodAtPointListTest();
   if (error != 0) {
     OL_FAILURE_PRINTF("log likelihood evaluation at point list\n");
@@ -196,6 +341,14 @@ int RunCppTestsWrapper() {
   }
   total_errors += error;
 
+  error = EvaluateLogLikelihoodOfEnsembleTest();
+  if (error != 0) {
+    OL_FAILURE_PRINTF("log likelihood evaluation of ensemble\n");
+  } else {
+    OL_SUCCESS_PRINTF("log likelihood evaluation of ensemble\n");
+  }
+  total_errors += error;
+
   error = EvaluateEIAtPointListTest();
   if (error != 0) {
     OL_FAILURE_PRINTF("EI evaluation at point list\n");
@@ -13,11 +13,17 @@
 #include <cmath>
 
 #include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <ostream>  // NOLINT(readability/streams): streams are the only way pull state data out of boost's PRNG engines
+#include <utility>
 #include <vector>
 
 #include <boost/functional/hash.hpp>  // NOLINT(build/include_order)
+#include <boost/math/constants/constants.hpp>  // NOLINT(build/include_order)
+#include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
 #include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
 
 #include "gpp_common.hpp"
@@ -26,6 +32,133 @@
 
 namespace optimal_learning {
 
+namespace {
+
+/*!\rst
+  Primitive polynomial and initial direction numbers for one Sobol coordinate; from Joe & Kuo,
+  "Constructing Sobol sequences with better two-dimensional projections" (new-joe-kuo-6.21201).
+  Coordinate 0 (the van der Corput sequence) is not listed.
+\endrst*/
+struct SobolDirectionInitializer {
+  //! degree of the primitive polynomial
+  int degree;
+  //! interior coefficients of the primitive polynomial, packed as bits
+  std::uint32_t coefficients;
+  //! initial direction numbers ``m_1, ..., m_degree``
+  std::uint32_t initial_numbers[7];
+};
+
+const SobolDirectionInitializer kSobolDirectionTable[SobolNormalRNG::kMaxDimension - 1] = {
+  {1, 0, {1}},
+  {2, 1, {1, 3}},
+  {3, 1, {1, 3, 1}},
+  {3, 2, {1, 1, 1}},
+  {4, 1, {1, 1, 3, 3}},
+  {4, 4, {1, 3, 5, 13}},
+  {5, 2, {1, 1, 5, 5, 17}},
+  {5, 4, {1, 1, 5, 5, 5}},
+  {5, 7, {1, 1, 7, 11, 19}},
+  {5, 11, {1, 1, 5, 1, 1}},
+  {5, 13, {1, 1, 1, 3, 11}},
+  {5, 14, {1, 3, 5, 5, 31}},
+  {6, 1, {1, 3, 3, 9, 7, 49}},
+  {6, 13, {1, 1, 1, 15, 21, 21}},
+  {6, 16, {1, 3, 1, 13, 27, 49}},
+  {6, 19, {1, 1, 1, 15, 7, 5}},
+  {6, 22, {1, 3, 1, 15, 13, 25}},
+  {6, 25, {1, 1, 5, 5, 19, 61}},
+  {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+  {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+/*!\rst
+  Fills the (unscrambled) direction numbers of one Sobol coordinate, with the most significant bit first.
+
+  \param
+    :coordinate: index of the coordinate, ``0 <= coordinate < SobolNormalRNG::kMaxDimension``
+  \output
+    :direction_numbers[SobolNormalRNG::kNumBits]: direction numbers ``v_k = m_k / 2^k`` as 32-bit fixed point
+\endrst*/
+void ComputeSobolDirectionNumbers(int coordinate, std::uint32_t * restrict direction_numbers) noexcept {
+  constexpr int num_bits = SobolNormalRNG::kNumBits;
+  if (coordinate == 0) {
+    for (int k = 0; k < num_bits; ++k) {
+      direction_numbers[k] = std::uint32_t(1) << (num_bits - 1 - k);
+    }
+    return;
+  }
+
+  const SobolDirectionInitializer& initializer = kSobolDirectionTable[coordinate - 1];
+  const int degree = initializer.degree;
+  for (int k = 0; k < degree; ++k) {
+    direction_numbers[k] = initializer.initial_numbers[k] << (num_bits - 1 - k);
+  }
+  for (int k = degree; k < num_bits; ++k) {
+    std::uint32_t value = direction_numbers[k - degree] ^ (direction_numbers[k - degree] >> degree);
+    for (int l = 1; l < degree; ++l) {
+      if ((initializer.coefficients >> (degree - 1 - l)) & 1) {
+        value ^= direction_numbers[k - l];
+      }
+    }
+    direction_numbers[k] = value;
+  }
+}
+
+/*!\rst
+  Fills the scrambled direction numbers and digital shift of one Sobol coordinate.  The direction numbers are multiplied
+  (over GF(2), digit-wise) by a random lower unit-triangular matrix; see SobolNormalRNG::SetExplicitSeed().
+
+  \param
+    :coordinate: index of the coordinate, ``0 <= coordinate < SobolNormalRNG::kMaxDimension``
+    :uniform_generator[1]: source of the random scramble
+  \output
+    :uniform_generator[1]: ``SobolNormalRNG::kNumBits`` draws consumed
+    :direction_numbers[SobolNormalRNG::kNumBits]: scrambled direction numbers as 32-bit fixed point
+    :digital_shift[1]: random shift to XOR into every point
+\endrst*/
+void ComputeScrambledSobolDirectionNumbers(int coordinate, UniformRandomGenerator * uniform_generator,
+                                           std::uint32_t * restrict direction_numbers,
+                                           std::uint32_t * restrict digital_shift) noexcept {
+  constexpr int num_bits = SobolNormalRNG::kNumBits;
+  std::uint32_t unscrambled[num_bits];
+  std::uint32_t scramble_rows[num_bits];
+  ComputeSobolDirectionNumbers(coordinate, unscrambled);
+
+  // row l of the scrambling matrix acts on digit l (bit num_bits-1-l): unit diagonal, random entries for digits < l
+  for (int l = 0; l < num_bits; ++l) {
+    std::uint32_t random_bits = (l == 0) ? 0 : (uniform_generator->engine() & (~std::uint32_t(0) << (num_bits - l)));
+    scramble_rows[l] = random_bits | (std::uint32_t(1) << (num_bits - 1 - l));
+  }
+
+  for (int k = 0; k < num_bits; ++k) {
+    std::uint32_t scrambled = 0;
+    for (int l = 0; l < num_bits; ++l) {
+      std::uint32_t digit = std::bitset<num_bits>(scramble_rows[l] & unscrambled[k]).count() & 1;
+      scrambled |= digit << (num_bits - 1 - l);
+    }
+    direction_numbers[k] = scrambled;
+  }
+  *digital_shift = uniform_generator->engine();
+}
+
+/*!\rst
+  Box-Muller transform: maps a pair of uniforms ``(u_0, u_1)``, ``u_0`` in (0, 1], to the independent N(0, 1) pair
+  ``sqrt(-2 log u_0) * (cos(2 pi u_1), sin(2 pi u_1))``.
+
+  \param
+    :pair[2]: the uniforms ``(u_0, u_1)``
+  \output
+    :pair[2]: the normals
+\endrst*/
+inline OL_NONNULL_POINTERS void BoxMullerInPlace(double * restrict pair) noexcept {
+  double radius = std::sqrt(-2.0*std::log(pair[0]));
+  double angle = 2.0*boost::math::constants::pi<double>()*pair[1];
+  pair[0] = radius*std::cos(angle);
+  pair[1] = radius*std::sin(angle);
+}
+
+}  // end unnamed namespace
+
 UniformRandomGenerator::UniformRandomGenerator(EngineType::result_type seed) noexcept
     : engine(seed), last_seed_(seed) {
   SetExplicitSeed(seed);
@@ -80,6 +213,15 @@ void UniformRandomGenerator::PrintState(std::ostream * out_stream) const {
   (*out_stream) << engine << "\n";  // NOLINT(readability/streams): this is the only way pull state data out of boost's PRNG engines
 }
 
+void NormalRNGInterface::Fill(double * restrict out, int n) {
+  for (int i = 0; i < n; ++i) {
+    out[i] = (*this)();
+  }
+}
+
+void NormalRNGInterface::SetStream(std::uint64_t OL_UNUSED(stream)) noexcept {
+}
+
 bool UniformRandomGenerator::operator==(const UniformRandomGenerator& other) const {
   return (engine == other.engine) && (last_seed_ == other.last_seed_);
 }
@@ -105,10 +247,31 @@ NormalRNG::NormalRNG(EngineType::result_type seed, int thread_id) noexcept
   SetRandomizedSeed(seed, thread_id);
 }
 
+/*!\rst
+  ``normal_random_variable_`` holds a reference to the engine, so the implicit copy would keep drawing from ``other``'s
+  engine.  Rebind it to the copied engine, and take the distribution from ``other.normal_random_variable_`` since that
+  is the copy carrying any cached normal.
+\endrst*/
+NormalRNG::NormalRNG(const NormalRNG& other) noexcept
+    : uniform_generator(other.uniform_generator),
+      normal_distribution_(other.normal_distribution_),
+      normal_random_variable_(uniform_generator.engine, other.normal_random_variable_.distribution()) {
+}
+
 double NormalRNG::operator()() {
   return normal_random_variable_();
 }
 
+void NormalRNG::Fill(double * restrict out, int n) {
+  for (int i = 0; i < n; ++i) {
+    out[i] = normal_random_variable_();
+  }
+}
+
+std::unique_ptr<NormalRNGInterface> NormalRNG::Clone() const {
+  return std::unique_ptr<NormalRNGInterface>(new NormalRNG(*this));
+}
+
 void NormalRNG::ResetGenerator() noexcept {
   normal_random_variable_.distribution().reset();
 }
@@ -157,6 +320,211 @@ void NormalRNGSimulator::ResetToMostRecentSeed() noexcept {
   index_ = 0;
 }
 
+std::unique_ptr<NormalRNGInterface> NormalRNGSimulator::Clone() const {
+  std::unique_ptr<NormalRNGSimulator> clone(new NormalRNGSimulator(random_number_table_));
+  clone->index_ = index_;
+  return clone;
+}
+
+SobolNormalRNG::SobolNormalRNG(int dimension, EngineType::result_type seed)
+    : dimension_(dimension),
+      last_seed_(seed),
+      direction_numbers_(dimension*kNumBits),
+      digital_shift_(dimension),
+      current_point_(dimension),
+      point_index_(0),
+      coordinate_index_(0) {
+  if (unlikely(dimension < 1 || dimension > kMaxDimension)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "SobolNormalRNG dimension out of range.", dimension, 1, kMaxDimension);
+  }
+  SetExplicitSeed(seed);
+}
+
+/*!\rst
+  Randomizes the sequence with a linear matrix scramble followed by a digital shift (Matousek 1998).  Each coordinate's
+  direction numbers are multiplied (over GF(2), digit-wise) by a random lower unit-triangular matrix, then every point is
+  XOR'd with a random shift.  Both operations preserve the (t, m, s)-net structure of the sequence.
+\endrst*/
+void SobolNormalRNG::SetExplicitSeed(EngineType::result_type seed) noexcept {
+  last_seed_ = seed;
+  UniformRandomGenerator uniform_generator(seed);
+  for (int j = 0; j < dimension_; ++j) {
+    ComputeScrambledSobolDirectionNumbers(j, &uniform_generator, direction_numbers_.data() + j*kNumBits, digital_shift_.data() + j);
+  }
+
+  ResetToMostRecentSeed();
+}
+
+void SobolNormalRNG::Fill(double * restrict out, int n) {
+  for (int i = 0; i < n; ++i) {
+    out[i] = SobolNormalRNG::operator()();
+  }
+}
+
+std::unique_ptr<NormalRNGInterface> SobolNormalRNG::Clone() const {
+  return std::unique_ptr<NormalRNGInterface>(new SobolNormalRNG(*this));
+}
+
+void SobolNormalRNG::ResetToMostRecentSeed() noexcept {
+  std::fill(current_point_.begin(), current_point_.end(), 0);
+  point_index_ = 0;
+  coordinate_index_ = 0;
+}
+
+/*!\rst
+  Points are generated in Gray-code order: point ``n+1`` differs from point ``n`` by XOR with the direction numbers
+  indexed by the number of trailing 1 bits of ``n``.  Uniforms are taken at the midpoint of their ``2^-32`` cell, so they
+  lie strictly inside (0, 1) and the inverse CDF is finite.
+\endrst*/
+double SobolNormalRNG::operator()() {
+  if (coordinate_index_ == dimension_) {
+    int bit = 0;
+    while (bit < kNumBits && ((point_index_ >> bit) & 1)) {
+      ++bit;
+    }
+    if (unlikely(bit == kNumBits)) {
+      // exhausted all 2^32 points; start over
+      ResetToMostRecentSeed();
+    } else {
+      for (int j = 0; j < dimension_; ++j) {
+        current_point_[j] ^= direction_numbers_[j*kNumBits + bit];
+      }
+      ++point_index_;
+    }
+    coordinate_index_ = 0;
+  }
+
+  std::uint32_t value = current_point_[coordinate_index_] ^ digital_shift_[coordinate_index_];
+  ++coordinate_index_;
+  double uniform = (static_cast<double>(value) + 0.5) * (1.0 / 4294967296.0);
+  boost::math::normal_distribution<double> normal(0.0, 1.0);
+  return boost::math::quantile(normal, uniform);
+}
+
+PhiloxNormalRNG::PhiloxNormalRNG(std::uint64_t seed, std::uint64_t stream) noexcept
+    : seed_(seed),
+      stream_(stream),
+      substream_(0),
+      index_(0),
+      normals_{0.0, 0.0} {
+}
+
+void PhiloxNormalRNG::Philox4x32(std::uint32_t const * restrict counter, std::uint32_t const * restrict key, std::uint32_t * restrict output) noexcept {
+  constexpr std::uint32_t kMultiplier0 = 0xD2511F53;
+  constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57;
+  constexpr std::uint32_t kWeyl0 = 0x9E3779B9;  // golden ratio
+  constexpr std::uint32_t kWeyl1 = 0xBB67AE85;  // sqrt(3) - 1
+  constexpr int kNumRounds = 10;
+
+  std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  std::uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < kNumRounds; ++round) {
+    std::uint64_t product0 = static_cast<std::uint64_t>(kMultiplier0) * c0;
+    std::uint64_t product1 = static_cast<std::uint64_t>(kMultiplier1) * c2;
+    c0 = static_cast<std::uint32_t>(product1 >> 32) ^ c1 ^ k0;
+    c2 = static_cast<std::uint32_t>(product0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<std::uint32_t>(product1);
+    c3 = static_cast<std::uint32_t>(product0);
+    k0 += kWeyl0;
+    k1 += kWeyl1;
+  }
+  output[0] = c0;
+  output[1] = c1;
+  output[2] = c2;
+  output[3] = c3;
+}
+
+/*!\rst
+  The 4 output words form two 53-bit uniforms: ``u_0`` in (0, 1] (so the log in BoxMullerInPlace() is finite) and
+  ``u_1`` in [0, 1).
+\endrst*/
+void PhiloxNormalRNG::ComputeUniforms(std::uint64_t block, double * restrict uniforms) const noexcept {
+  const std::uint32_t counter[4] = {static_cast<std::uint32_t>(block), substream_,
+                                    static_cast<std::uint32_t>(stream_), static_cast<std::uint32_t>(stream_ >> 32)};
+  const std::uint32_t key[2] = {static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32)};
+  std::uint32_t bits[4];
+  Philox4x32(counter, key, bits);
+
+  constexpr double kTwoToMinus53 = 1.0 / 9007199254740992.0;
+  std::uint64_t bits0 = (static_cast<std::uint64_t>(bits[1]) << 32) | bits[0];
+  std::uint64_t bits1 = (static_cast<std::uint64_t>(bits[3]) << 32) | bits[2];
+  uniforms[0] = static_cast<double>((bits0 >> 11) + 1) * kTwoToMinus53;
+  uniforms[1] = static_cast<double>(bits1 >> 11) * kTwoToMinus53;
+}
+
+void PhiloxNormalRNG::GenerateBlock(std::uint64_t block) noexcept {
+  ComputeUniforms(block, normals_);
+  BoxMullerInPlace(normals_);
+}
+
+double PhiloxNormalRNG::operator()() {
+  if ((index_ & 1) == 0) {
+    GenerateBlock(index_ >> 1);
+  }
+  double value = normals_[index_ & 1];
+  index_ = (index_ + 1) & kIndexMask;
+  return value;
+}
+
+std::unique_ptr<NormalRNGInterface> PhiloxNormalRNG::Clone() const {
+  return std::unique_ptr<NormalRNGInterface>(new PhiloxNormalRNG(*this));
+}
+
+/*!\rst
+  Splits the work into two passes over whole counter blocks: first the Philox rounds (pure 32-bit integer multiply/xor
+  with no branches or dependence between blocks, so the compiler can vectorize across blocks) write uniform pairs
+  straight into ``out``; then Box-Muller transforms them in place.  A leading or trailing half block goes through the
+  scalar path, so the output matches ``n`` calls to operator() exactly.
+\endrst*/
+void PhiloxNormalRNG::Fill(double * restrict out, int n) {
+  if (n <= 0) {
+    return;
+  }
+  int num_filled = 0;
+  if ((index_ & 1) != 0) {
+    out[num_filled++] = normals_[1];
+    index_ = (index_ + 1) & kIndexMask;
+  }
+
+  const int num_blocks = (n - num_filled) / 2;
+  const std::uint64_t first_block = index_ >> 1;
+  double * restrict pairs = out + num_filled;
+  for (int i = 0; i < num_blocks; ++i) {
+    ComputeUniforms(first_block + i, pairs + 2*i);
+  }
+  for (int i = 0; i < num_blocks; ++i) {
+    BoxMullerInPlace(pairs + 2*i);
+  }
+  num_filled += 2*num_blocks;
+  index_ = (index_ + 2*static_cast<std::uint64_t>(num_blocks)) & kIndexMask;
+
+  if (num_filled < n) {
+    out[num_filled] = (*this)();
+  }
+}
+
+void PhiloxNormalRNG::SetStream(std::uint64_t stream, std::uint32_t substream) noexcept {
+  stream_ = stream;
+  substream_ = substream;
+  index_ = 0;
+}
+
+void PhiloxNormalRNG::SetExplicitSeed(std::uint64_t seed) noexcept {
+  seed_ = seed;
+  SetStream(0, 0);
+}
+
+void PhiloxNormalRNG::ResetToMostRecentSeed() noexcept {
+  index_ = 0;
+}
+
+double PhiloxNormalRNG::Normal(std::uint64_t seed, std::uint64_t stream, std::uint32_t substream, std::uint64_t index) noexcept {
+  PhiloxNormalRNG generator(seed, stream);
+  generator.substream_ = substream;
+  generator.GenerateBlock(index >> 1);
+  return generator.normals_[index & 1];
+}
+
 /*!\rst
   domain specifies a domain from which to draw points at uniformly at random; it is a bounding box specification in
   dim pairs of (domain_min, domain_max) values, defining edge-lengths of the hypercube domain.
@@ -193,6 +561,52 @@ void ComputeLatinHypercubePointsInDomain(ClosedInterval const * restrict domain,
   }
 }
 
+/*!\rst
+  Point ``n`` of the Gray-code ordered sequence is the XOR of the direction numbers selected by the bits of ``n ^ (n >> 1)``,
+  so the first requested point is computed directly and the rest follow one XOR per coordinate, as in SobolNormalRNG.
+\endrst*/
+void ComputeSobolPointsInDomain(ClosedInterval const * restrict domain, int dim, int num_samples, std::uint32_t first_index,
+                                UniformRandomGenerator::EngineType::result_type scramble_seed, double * restrict random_points) {
+  if (unlikely(dim < 1 || dim > SobolNormalRNG::kMaxDimension)) {
+    OL_THROW_EXCEPTION(BoundsException<int>, "Sobol point dimension out of range.", dim, 1, SobolNormalRNG::kMaxDimension);
+  }
+  constexpr int num_bits = SobolNormalRNG::kNumBits;
+  UniformRandomGenerator uniform_generator(scramble_seed);
+  std::vector<std::uint32_t> direction_numbers(dim*num_bits);
+  std::vector<std::uint32_t> digital_shift(dim);
+  for (int j = 0; j < dim; ++j) {
+    ComputeScrambledSobolDirectionNumbers(j, &uniform_generator, direction_numbers.data() + j*num_bits, digital_shift.data() + j);
+  }
+
+  std::vector<std::uint32_t> current_point(dim, 0);
+  std::uint32_t gray_code = first_index ^ (first_index >> 1);
+  for (int k = 0; k < num_bits; ++k) {
+    if ((gray_code >> k) & 1) {
+      for (int j = 0; j < dim; ++j) {
+        current_point[j] ^= direction_numbers[j*num_bits + k];
+      }
+    }
+  }
+
+  std::uint32_t point_index = first_index;
+  for (int i = 0; i < num_samples; ++i) {
+    for (int j = 0; j < dim; ++j) {
+      std::uint32_t value = current_point[j] ^ digital_shift[j];
+      double uniform = (static_cast<double>(value) + 0.5) * (1.0 / 4294967296.0);
+      random_points[i*dim + j] = domain[j].min + domain[j].Length()*uniform;
+    }
+
+    int bit = 0;
+    while (bit < num_bits - 1 && ((point_index >> bit) & 1)) {
+      ++bit;
+    }
+    for (int j = 0; j < dim; ++j) {
+      current_point[j] ^= direction_numbers[j*num_bits + bit];
+    }
+    ++point_index;
+  }
+}
+
 /*!\rst
   We need to draw a set of points, ``x_i``, (uniformly distributed by volume) such that ``x_i >= 0 \forall i`` and
   ``\sum_i x_i <= 1``, also implying that ``x_i <= 1 \forall i``.
@@ -25,12 +25,24 @@
   NormalRNG is a functor for generating ``mean = 0, variance = 1``, normally distributed (pseudo) random numbers.  In addition
   to UniformRandomGenerator, NormalRNG also implements operator() to draw from the aforementioned distribution.  N(0, 1) is
   a common choice (and the only one used in gpp_* so far), so NormalRNG wraps the entire number generation process.
+
+  SobolNormalRNG is a quasi-random drop-in for NormalRNG: it walks a scrambled Sobol sequence and maps each coordinate
+  through the inverse normal CDF.  Monte Carlo integrands (q-EI, KG) converge noticeably faster with it, so fewer
+  ``num_mc_iterations`` are needed for the same accuracy.
+
+  PhiloxNormalRNG is a counter-based drop-in for NormalRNG: every draw is a pure function of (seed, stream, substream,
+  index), so e.g. one stream per multistart and one substream per MC iteration gives results that do not depend on
+  how the work is split across threads.  The multithreaded EI/KG routines take their per-thread generators as a
+  NormalRNGArray, which holds either kind; with identically seeded PhiloxNormalRNGs, start ``i`` draws from stream
+  ``i`` on whichever thread runs it.
 \endrst*/
 
 #ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_RANDOM_HPP_
 #define MOE_OPTIMAL_LEARNING_CPP_GPP_RANDOM_HPP_
 
+#include <cstdint>
 #include <iosfwd>
+#include <memory>
 #include <vector>
 
 #include <boost/random/mersenne_twister.hpp>  // NOLINT(build/include_order)
@@ -49,7 +61,7 @@ namespace optimal_learning {
   This interface currently does not specify many facilities for seeding the underlying RNG as these 
   (particularly variable width) can vary by implementation.
 
-  This class *only* has pure virtual functions.
+  Apart from Fill() and SetStream(), which have generic defaults, this class *only* has pure virtual functions.
 \endrst*/
 class NormalRNGInterface {
  public:
@@ -61,12 +73,48 @@ class NormalRNGInterface {
   \endrst*/
   virtual double operator()() = 0;
 
+  /*!\rst
+    Generate ``n`` random numbers from the standard normal distribution; equivalent to (and produces the same values as)
+    ``n`` calls to operator(), but implementations can skip the per-draw virtual dispatch and work on the whole batch.
+    Monte Carlo loops that consume a known number of normals per iteration should prefer this.
+
+    The default implementation just calls operator() ``n`` times.
+
+    \param
+      :n: number of draws
+    \output
+      :out[n]: the draws
+  \endrst*/
+  virtual void Fill(double * restrict out, int n);
+
+  /*!\rst
+    Moves to the first draw of stream ``stream``, for generators whose draws are addressed by stream (PhiloxNormalRNG).
+    The multistart drivers call this with the index of each start (see SelectNormalStream() in gpp_optimization.hpp),
+    so a start draws the same numbers whichever thread runs it.
+
+    The default implementation does nothing: generators without streams keep drawing from their own sequence.
+
+    \param
+      :stream: index of the stream to draw from
+  \endrst*/
+  virtual void SetStream(std::uint64_t stream) noexcept;
+
   /*!\rst
     Reseeds the generator with its most recently specified seed value.
     Useful for testing--e.g., can conduct multiple runs with the same initial conditions
   \endrst*/
   virtual void ResetToMostRecentSeed() noexcept = 0;
 
+  /*!\rst
+    Create an independent copy of this generator: same seed and same position in the stream, so the copy
+    produces exactly the draws this object would produce next (and the same draws after ResetToMostRecentSeed()).
+    Lets one generator be shared out to concurrent consumers that must each see the same stream.
+
+    \return
+      a new generator in the same state as this one
+  \endrst*/
+  virtual std::unique_ptr<NormalRNGInterface> Clone() const OL_WARN_UNUSED_RESULT = 0;
+
   virtual ~NormalRNGInterface() = default;
 };
 
@@ -233,6 +281,15 @@ class NormalRNG final : public NormalRNGInterface {
   \endrst*/
   NormalRNG(EngineType::result_type seed, int thread_id) noexcept;
 
+  /*!\rst
+    Copy-construct a NormalRNG: the engine and the cached state of the normal distribution are copied, and the
+    copy draws from its *own* engine.
+
+    \param
+      :other: generator to copy
+  \endrst*/
+  NormalRNG(const NormalRNG& other) noexcept;
+
   /*!\rst
     Get a reference to the RNG engine used by this class.
 
@@ -245,6 +302,10 @@ class NormalRNG final : public NormalRNGInterface {
 
   virtual double operator()();
 
+  virtual void Fill(double * restrict out, int n);
+
+  virtual std::unique_ptr<NormalRNGInterface> Clone() const;
+
   EngineType::result_type last_seed() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
     return uniform_generator.last_seed();
   }
@@ -326,6 +387,8 @@ class NormalRNGSimulator final : public NormalRNGInterface {
 
   virtual void ResetToMostRecentSeed() noexcept;
 
+  virtual std::unique_ptr<NormalRNGInterface> Clone() const;
+
   int index() const {
     return index_;
   }
@@ -339,6 +402,286 @@ class NormalRNGSimulator final : public NormalRNGInterface {
   int index_;
 };
 
+/*!\rst
+  Functor for computing quasi-random, N(0, 1)-distributed numbers from a scrambled Sobol sequence.
+
+  The generator walks the points ``u_0, u_1, ...`` of a ``dimension``-dimensional Sobol sequence (Joe & Kuo direction
+  numbers, Gray-code ordering) and returns their coordinates one at a time, in order ``u_0[0], ..., u_0[dimension-1],
+  u_1[0], ...``; each coordinate is mapped through the inverse standard normal CDF.  The sequence is randomized with a
+  linear matrix scramble plus a digital shift (Matousek), both drawn from ``seed``, so estimates stay unbiased and
+  different seeds give independent replicates.
+
+  To get the variance reduction, consumers must draw exactly ``dimension`` numbers per Monte Carlo sample.  For example,
+  ExpectedImprovementEvaluator draws ``num_union`` normals per iteration (``num_union = num_to_sample + num_being_sampled``)
+  and KnowledgeGradientEvaluator draws ``num_union*(1 + num_gradients_to_sample)`` per (non-antithetic) iteration.
+  Balance properties are best when the number of samples is a power of 2.
+
+  .. Note:: seed values take type ``EngineType::result_type``. Do not pass in a wider integer type!
+
+  .. WARNING:: this class is NOT THREAD-SAFE. You must construct one object per thread (and
+    ensure that the seeds are different for practical computations).
+\endrst*/
+class SobolNormalRNG final : public NormalRNGInterface {
+ public:
+  using EngineType = UniformRandomGenerator::EngineType;
+
+  //! Default seed value to make reproducing test results simple.
+  static constexpr EngineType::result_type kDefaultSeed = 314;
+  //! Largest supported dimension (size of the built-in direction number table).
+  static constexpr int kMaxDimension = 21;
+  //! Number of bits of resolution in each coordinate.
+  static constexpr int kNumBits = 32;
+
+  /*!\rst
+    Construct a SobolNormalRNG of the specified dimension, scrambling with the specified seed.
+
+    \param
+      :dimension: number of coordinates in each Sobol point, ``1 <= dimension <= kMaxDimension``
+      :seed: seed for the randomized scrambling
+  \endrst*/
+  SobolNormalRNG(int dimension, EngineType::result_type seed);
+
+  /*!\rst
+    Construct a SobolNormalRNG of the specified dimension, scrambling with kDefaultSeed.
+
+    \param
+      :dimension: number of coordinates in each Sobol point, ``1 <= dimension <= kMaxDimension``
+  \endrst*/
+  explicit SobolNormalRNG(int dimension) : SobolNormalRNG(dimension, kDefaultSeed) {
+  }
+
+  virtual double operator()();
+
+  virtual void Fill(double * restrict out, int n);
+
+  virtual std::unique_ptr<NormalRNGInterface> Clone() const;
+
+  int dimension() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return dimension_;
+  }
+
+  EngineType::result_type last_seed() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return last_seed_;
+  }
+
+  /*!\rst
+    Draw a new scramble from the input seed and restart the sequence at its first point.
+
+    \param
+      :seed: new seed to set
+  \endrst*/
+  void SetExplicitSeed(EngineType::result_type seed) noexcept;
+
+  /*!\rst
+    Restarts the sequence at its first point; the scramble is unchanged.
+    Useful for testing--e.g., can conduct multiple runs with the same initial conditions
+  \endrst*/
+  virtual void ResetToMostRecentSeed() noexcept;
+
+ private:
+  //! Number of coordinates in each Sobol point.
+  int dimension_;
+  //! Seed used to draw the current scramble.
+  EngineType::result_type last_seed_;
+  //! Scrambled direction numbers, ``direction_numbers_[dimension][kNumBits]``.
+  std::vector<std::uint32_t> direction_numbers_;
+  //! Random digital shift applied to every point, ``digital_shift_[dimension]``.
+  std::vector<std::uint32_t> digital_shift_;
+  //! Current (unshifted) Sobol point, ``current_point_[dimension]``.
+  std::vector<std::uint32_t> current_point_;
+  //! Index of the current point in the sequence.
+  std::uint32_t point_index_;
+  //! Index of the next coordinate of the current point to return.
+  int coordinate_index_;
+};
+
+/*!\rst
+  Functor for computing N(0, 1)-distributed numbers from the Philox4x32-10 counter-based generator (Salmon et al.,
+  "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11).
+
+  Instead of advancing a hidden state, Philox encrypts a 128-bit counter with a 64-bit key (the seed) through 10 rounds of
+  multiply/xor.  Each counter value yields 4 32-bit words, which Box-Muller turns into 2 normals.  Here the counter is
+  split into ``(block, substream, stream)`` (32, 32 and 64 bits), so draw ``index`` of any ``(stream, substream)``
+  pair can be computed directly by Normal() with no warm-up and no shared state.
+
+  The intended addressing is one stream per independent unit of parallel work (e.g., multistart index) and one substream
+  per Monte Carlo iteration inside it.  Then the numbers consumed by each unit are fixed regardless of thread count or
+  scheduling, and two runs with the same seed agree bit for bit.  Each substream holds ``2^33`` normals; operator() wraps
+  around to the start of the substream after that.
+
+  .. WARNING:: this class is NOT THREAD-SAFE. You must construct one object per thread; give each thread its own
+    stream (not its own seed) to keep results reproducible.
+\endrst*/
+class PhiloxNormalRNG final : public NormalRNGInterface {
+ public:
+  //! Default seed value to make reproducing test results simple.
+  static constexpr std::uint64_t kDefaultSeed = 314;
+
+  /*!\rst
+    Construct a PhiloxNormalRNG positioned at the first draw of substream 0 of the specified stream.
+
+    \param
+      :seed: key of the generator; different seeds give independent families of streams
+      :stream: index of the stream to draw from
+  \endrst*/
+  PhiloxNormalRNG(std::uint64_t seed, std::uint64_t stream) noexcept;
+
+  /*!\rst
+    Construct a PhiloxNormalRNG positioned at the first draw of stream 0.
+
+    \param
+      :seed: key of the generator
+  \endrst*/
+  explicit PhiloxNormalRNG(std::uint64_t seed) noexcept : PhiloxNormalRNG(seed, 0) {
+  }
+
+  PhiloxNormalRNG() noexcept : PhiloxNormalRNG(kDefaultSeed) {
+  }
+
+  virtual double operator()();
+
+  virtual void Fill(double * restrict out, int n);
+
+  virtual std::unique_ptr<NormalRNGInterface> Clone() const;
+
+  std::uint64_t seed() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return seed_;
+  }
+
+  std::uint64_t stream() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return stream_;
+  }
+
+  std::uint32_t substream() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return substream_;
+  }
+
+  //! Index (within the current substream) of the next draw operator() will return.
+  std::uint64_t position() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return index_;
+  }
+
+  /*!\rst
+    Move to the first draw of substream ``substream`` of stream ``stream``.
+
+    \param
+      :stream: index of the stream to draw from
+      :substream: index of the substream (e.g., MC iteration) within ``stream``
+  \endrst*/
+  void SetStream(std::uint64_t stream, std::uint32_t substream) noexcept;
+
+  virtual void SetStream(std::uint64_t stream) noexcept {
+    SetStream(stream, 0);
+  }
+
+  /*!\rst
+    Move to the first draw of substream ``substream`` of the current stream.
+
+    \param
+      :substream: index of the substream (e.g., MC iteration) within the current stream
+  \endrst*/
+  void SetSubstream(std::uint32_t substream) noexcept {
+    SetStream(stream_, substream);
+  }
+
+  /*!\rst
+    Change the key and move to the first draw of substream 0 of stream 0.
+
+    \param
+      :seed: new seed to set
+  \endrst*/
+  void SetExplicitSeed(std::uint64_t seed) noexcept;
+
+  /*!\rst
+    Restarts the current substream at its first draw; seed, stream and substream are unchanged.
+    Useful for testing--e.g., can conduct multiple runs with the same initial conditions
+  \endrst*/
+  virtual void ResetToMostRecentSeed() noexcept;
+
+  /*!\rst
+    Computes draw ``index`` of substream ``substream`` of stream ``stream`` directly; equals the value the
+    ``index``-th call to operator() returns after ``SetStream(stream, substream)`` on a generator keyed by ``seed``.
+
+    \param
+      :seed: key of the generator
+      :stream: index of the stream
+      :substream: index of the substream within ``stream``
+      :index: index of the draw within the substream, ``index < 2^33``
+    \return
+      the requested N(0, 1) draw
+  \endrst*/
+  static double Normal(std::uint64_t seed, std::uint64_t stream, std::uint32_t substream, std::uint64_t index) noexcept OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    The raw Philox4x32-10 bijection: encrypts ``counter`` under ``key``.
+
+    \param
+      :counter[4]: 128-bit counter, least significant word first
+      :key[2]: 64-bit key, least significant word first
+    \output
+      :output[4]: 128 pseudo-random bits
+  \endrst*/
+  static OL_NONNULL_POINTERS void Philox4x32(std::uint32_t const * restrict counter, std::uint32_t const * restrict key, std::uint32_t * restrict output) noexcept;
+
+ private:
+  /*!\rst
+    Fills ``normals_`` with the pair of normals computed from counter block ``block`` of the current (stream, substream).
+  \endrst*/
+  void GenerateBlock(std::uint64_t block) noexcept;
+
+  /*!\rst
+    Computes the pair of uniforms (first in (0, 1], second in [0, 1)) that counter block ``block`` of the current
+    (stream, substream) maps to.
+  \endrst*/
+  OL_NONNULL_POINTERS void ComputeUniforms(std::uint64_t block, double * restrict uniforms) const noexcept;
+
+  //! Mask applied to ``index_``: the block part of the counter is 32 bits wide, so a substream holds ``2^33`` draws.
+  static constexpr std::uint64_t kIndexMask = (std::uint64_t(1) << 33) - 1;
+
+  //! Key of the generator.
+  std::uint64_t seed_;
+  //! Index of the current stream.
+  std::uint64_t stream_;
+  //! Index of the current substream within ``stream_``.
+  std::uint32_t substream_;
+  //! Index (within the current substream) of the next draw.
+  std::uint64_t index_;
+  //! The two normals of the counter block holding draws ``2*floor(index_/2)`` and ``2*floor(index_/2) + 1``; valid when ``index_`` is odd.
+  double normals_[2];
+};
+
+/*!\rst
+  The per-thread normal generators of the multithreaded EI/KG routines: an array of NormalRNG or of PhiloxNormalRNG,
+  with element ``i`` going to the state (and so the thread) with index ``i``.  Converts implicitly from a pointer to
+  the first element of either, so callers pass e.g. ``normal_rng_vec.data()``.  Does not own the generators.
+\endrst*/
+class NormalRNGArray final {
+ public:
+  NormalRNGArray(NormalRNG * first) noexcept  // NOLINT(runtime/explicit)
+      : first_(first), element_(&Element<NormalRNG>) {
+  }
+
+  NormalRNGArray(PhiloxNormalRNG * first) noexcept  // NOLINT(runtime/explicit)
+      : first_(first), element_(&Element<PhiloxNormalRNG>) {
+  }
+
+  //! the ``i``-th generator
+  NormalRNGInterface& operator[](int i) const noexcept OL_WARN_UNUSED_RESULT {
+    return element_(first_, i);
+  }
+
+ private:
+  template <typename Generator>
+  static NormalRNGInterface& Element(void * first, int i) noexcept {
+    return static_cast<Generator *>(first)[i];
+  }
+
+  //! the first generator
+  void * first_;
+  //! ``Element<Generator>`` for the generators' type
+  NormalRNGInterface& (*element_)(void * first, int i) noexcept;
+};
+
 /*!\rst
   Computes a set of random points inside some domain that lie in a latin hypercube.  In 2D, a latin hypercube is a latin
   square--a checkerboard--such that there is exactly one sample in each row and each column.  This notion is generalized
@@ -358,6 +701,26 @@ class NormalRNGSimulator final : public NormalRNGInterface {
 \endrst*/
 OL_NONNULL_POINTERS void ComputeLatinHypercubePointsInDomain(ClosedInterval const * restrict domain, int dim, int num_samples, UniformRandomGenerator * uniform_generator, double * restrict random_points);
 
+/*!\rst
+  Computes points ``first_index, ..., first_index + num_samples - 1`` of a scrambled Sobol sequence (same construction
+  as SobolNormalRNG), scaled into a tensor-product domain.  Every 1D projection of any aligned block of ``2^m`` points is
+  stratified into ``2^m`` equal cells, so these fill the domain more evenly than a latin hypercube for the same count.
+
+  The sequence is a deterministic function of ``scramble_seed``, so callers can split it into disjoint blocks: e.g.,
+  thread ``t`` asks for ``first_index = t*block_size`` with a shared seed.  Aligning blocks to powers of 2 keeps each
+  block's own balance properties.
+
+  \param
+    :domain[dim]: array of ClosedInterval specifying the boundaries of a dim-dimensional tensor-product domain.
+    :dim: the number of spatial dimensions, ``1 <= dim <= SobolNormalRNG::kMaxDimension``
+    :num_samples: number of points desired
+    :first_index: index (in the sequence) of the first point to compute
+    :scramble_seed: seed for the randomized scrambling
+  \output
+    :random_points[num_samples][dim]: array containing the points inside the domain
+\endrst*/
+OL_NONNULL_POINTERS void ComputeSobolPointsInDomain(ClosedInterval const * restrict domain, int dim, int num_samples, std::uint32_t first_index, UniformRandomGenerator::EngineType::result_type scramble_seed, double * restrict random_points);
+
 /*!\rst
   Computes a set of random points that lie inside a dim-dimensional simplex or d-simplex.
   The points are uniformly-distributed by volume.
@@ -7,11 +7,16 @@
 
 #include "gpp_random_test.hpp"
 
+#include <cmath>
+
 #include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <unordered_set>
 #include <vector>
 
+#include <boost/math/distributions/normal.hpp>  // NOLINT(build/include_order)
 #include <boost/random/uniform_int.hpp>  // NOLINT(build/include_order)
 #include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
 
@@ -413,6 +418,242 @@ int NormalRNGSimulatorTest() {
   return total_errors;
 }
 
+/*!\rst
+  Checks that SobolNormalRNG is behaving correctly:
+
+  * Tests that invalid dimensions are rejected
+  * Tests that every 1D projection of the first ``2^m`` points is stratified: mapping the normals back through the
+    normal CDF, each interval ``[k/2^m, (k+1)/2^m)`` holds exactly one point
+  * Tests that the first two coordinates form a (0, m, 2)-net: every elementary interval of area ``2^-m`` holds exactly one point
+  * Tests ResetToMostRecentSeed replays the sequence and different seeds give different sequences
+
+  \return
+    number of test failures: 0 if SobolNormalRNG behaving correctly
+\endrst*/
+int SobolNormalRNGTest() {
+  int total_errors = 0;
+
+  for (int dimension : {0, SobolNormalRNG::kMaxDimension + 1}) {
+    ++total_errors;
+    try {
+      SobolNormalRNG invalid_rng(dimension);
+    } catch (const BoundsException<int>&) {
+      --total_errors;
+    }
+  }
+
+  const int dim = SobolNormalRNG::kMaxDimension;
+  const int log_num_points = 10;
+  const int num_points = 1 << log_num_points;
+  SobolNormalRNG sobol_rng(dim, 8731);
+  boost::math::normal_distribution<double> normal(0.0, 1.0);
+
+  std::vector<double> normals(num_points*dim);
+  std::vector<int> cells(num_points*dim);
+  for (int i = 0; i < num_points*dim; ++i) {
+    normals[i] = sobol_rng();
+    cells[i] = static_cast<int>(boost::math::cdf(normal, normals[i]) * num_points);
+  }
+
+  std::vector<int> counts(num_points);
+  for (int j = 0; j < dim; ++j) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int i = 0; i < num_points; ++i) {
+      ++counts[cells[i*dim + j]];
+    }
+    for (int k = 0; k < num_points; ++k) {
+      if (counts[k] != 1) {
+        OL_ERROR_PRINTF("coordinate %d, cell %d has %d points\n", j, k, counts[k]);
+        ++total_errors;
+        break;
+      }
+    }
+  }
+
+  for (int log_rows = 0; log_rows <= log_num_points; ++log_rows) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int i = 0; i < num_points; ++i) {
+      int row = cells[i*dim + 0] >> (log_num_points - log_rows);
+      int column = cells[i*dim + 1] >> log_rows;
+      ++counts[(row << (log_num_points - log_rows)) + column];
+    }
+    for (int k = 0; k < num_points; ++k) {
+      if (counts[k] != 1) {
+        OL_ERROR_PRINTF("2^%d x 2^%d elementary interval %d has %d points\n", log_rows, log_num_points - log_rows, k, counts[k]);
+        ++total_errors;
+        break;
+      }
+    }
+  }
+
+  sobol_rng.ResetToMostRecentSeed();
+  for (int i = 0; i < num_points*dim; ++i) {
+    if (sobol_rng() != normals[i]) {
+      ++total_errors;
+      break;
+    }
+  }
+
+  sobol_rng.SetExplicitSeed(8732);
+  int num_identical = 0;
+  for (int i = 0; i < num_points*dim; ++i) {
+    if (sobol_rng() == normals[i]) {
+      ++num_identical;
+    }
+  }
+  if (num_identical > num_points/10) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that PhiloxNormalRNG is behaving correctly:
+
+  * Tests Philox4x32 against the known-answer vectors published with Random123
+  * Tests that Normal() (direct addressing) matches the sequential draws of operator(), across streams and substreams
+  * Tests Clone, SetSubstream and ResetToMostRecentSeed continue/replay the right draws and distinct streams differ
+  * Tests the sample mean and variance are consistent with N(0, 1)
+
+  \return
+    number of test failures: 0 if PhiloxNormalRNG behaving correctly
+\endrst*/
+int PhiloxNormalRNGTest() {
+  int total_errors = 0;
+
+  struct PhiloxKnownAnswer {
+    std::uint32_t counter[4];
+    std::uint32_t key[2];
+    std::uint32_t output[4];
+  };
+  const PhiloxKnownAnswer known_answers[] = {
+    {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000},
+     {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+    {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+  };
+  for (const auto& known_answer : known_answers) {
+    std::uint32_t output[4];
+    PhiloxNormalRNG::Philox4x32(known_answer.counter, known_answer.key, output);
+    if (!std::equal(output, output + 4, known_answer.output)) {
+      OL_ERROR_PRINTF("Philox4x32 output %08x %08x %08x %08x does not match the known answer\n", output[0], output[1], output[2], output[3]);
+      ++total_errors;
+    }
+  }
+
+  const std::uint64_t seed = 0x123456789abcdefULL;
+  const int num_draws = 5001;  // odd so the last draw is the first half of a block
+  PhiloxNormalRNG philox_rng(seed);
+  std::vector<double> normals(num_draws);
+  for (std::uint64_t stream : {std::uint64_t(0), std::uint64_t(7), std::uint64_t(1) << 40}) {
+    for (std::uint32_t substream : {0u, 3u}) {
+      philox_rng.SetStream(stream, substream);
+      for (int i = 0; i < num_draws; ++i) {
+        normals[i] = philox_rng();
+        if (PhiloxNormalRNG::Normal(seed, stream, substream, i) != normals[i]) {
+          OL_ERROR_PRINTF("stream %lu, substream %u, draw %d: direct value differs from sequential value\n", static_cast<unsigned long>(stream), substream, i);  // NOLINT(runtime/int)
+          ++total_errors;
+          break;
+        }
+      }
+    }
+  }
+
+  // philox_rng is now at the end of (1 << 40, 3); its clone must continue from there
+  std::unique_ptr<NormalRNGInterface> clone = philox_rng.Clone();
+  for (int i = num_draws; i < num_draws + 10; ++i) {
+    if ((*clone)() != PhiloxNormalRNG::Normal(seed, std::uint64_t(1) << 40, 3, i)) {
+      ++total_errors;
+    }
+  }
+
+  philox_rng.ResetToMostRecentSeed();
+  if (philox_rng.position() != 0 || philox_rng() != normals[0]) {
+    ++total_errors;
+  }
+
+  philox_rng.SetSubstream(0);
+  double mean = 0.0;
+  double second_moment = 0.0;
+  int num_identical = 0;
+  for (int i = 0; i < num_draws; ++i) {
+    normals[i] = philox_rng();
+    mean += normals[i];
+    second_moment += Square(normals[i]);
+    if (normals[i] == PhiloxNormalRNG::Normal(seed, (std::uint64_t(1) << 40) + 1, 0, i)) {
+      ++num_identical;
+    }
+  }
+  if (num_identical > 0) {
+    ++total_errors;
+  }
+  mean /= num_draws;
+  double variance = second_moment/num_draws - Square(mean);
+  // 5 standard errors
+  if (std::fabs(mean) > 5.0/std::sqrt(static_cast<double>(num_draws)) ||
+      std::fabs(variance - 1.0) > 5.0*std::sqrt(2.0/num_draws)) {
+    OL_ERROR_PRINTF("sample mean %.18E, variance %.18E inconsistent with N(0, 1)\n", mean, variance);
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks that Fill() produces exactly the draws that repeated calls to operator() would, for every NormalRNGInterface
+  implementation.  Fill sizes are mixed (including 0 and odd sizes) so the generator's position ends up at every
+  alignment that matters (e.g., halfway through a PhiloxNormalRNG block).
+
+  \return
+    number of test failures: 0 if Fill() behaving correctly
+\endrst*/
+int NormalRNGFillTest() {
+  int total_errors = 0;
+  const int fill_sizes[] = {1, 0, 2, 7, 64, 3, 128, 1, 255};
+  int num_draws = 0;
+  for (int size : fill_sizes) {
+    num_draws += size;
+  }
+
+  std::vector<double> simulator_table(num_draws + 1);  // +1 for the final position check
+  NormalRNG table_rng(5417);
+  for (auto& entry : simulator_table) {
+    entry = table_rng();
+  }
+
+  std::vector<std::unique_ptr<NormalRNGInterface>> generators;
+  generators.emplace_back(new NormalRNG(3141));
+  generators.emplace_back(new NormalRNGSimulator(simulator_table));
+  generators.emplace_back(new SobolNormalRNG(5, 3141));
+  generators.emplace_back(new PhiloxNormalRNG(3141, 12));
+
+  std::vector<double> filled(num_draws);
+  for (auto& generator : generators) {
+    std::unique_ptr<NormalRNGInterface> sequential = generator->Clone();
+    int offset = 0;
+    for (int size : fill_sizes) {
+      generator->Fill(filled.data() + offset, size);
+      offset += size;
+    }
+    for (int i = 0; i < num_draws; ++i) {
+      if (filled[i] != (*sequential)()) {
+        OL_ERROR_PRINTF("draw %d from Fill() differs from operator()\n", i);
+        ++total_errors;
+        break;
+      }
+    }
+    // both must end in the same position
+    if ((*generator)() != (*sequential)()) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
 }  // end unnamed namespace
 
 /*!\rst
@@ -447,6 +688,30 @@ int RandomNumberGeneratorContainerTest() {
   }
   total_errors += current_errors;
 
+  current_errors = SobolNormalRNGTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("SobolNormalRNG failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("SobolNormalRNG passed all tests\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = PhiloxNormalRNGTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("PhiloxNormalRNG failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("PhiloxNormalRNG passed all tests\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = NormalRNGFillTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("NormalRNGInterface::Fill failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("NormalRNGInterface::Fill passed all tests\n");
+  }
+  total_errors += current_errors;
+
   return total_errors;
 }
 
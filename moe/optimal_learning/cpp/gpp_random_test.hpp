@@ -36,6 +36,9 @@ int RunRandomPointGeneratorTests() OL_WARN_UNUSED_RESULT;
   * Tests manual seed setting
   * Tests last_seed and reset
   * Tests that in multithreaded environemnts, each thread gets a different seed
+  * Tests NormalRNGSimulator and the stratification of SobolNormalRNG
+  * Tests PhiloxNormalRNG known answers and direct stream addressing
+  * Tests that bulk Fill() matches one-at-a-time draws
 
   \return
     number of test failures: 0 if PRNG containers are behaving correctly
@@ -0,0 +1,240 @@
+/*!
+  \file gpp_result_cache.cpp
+  \rst
+  Implementation of GaussianProcessResultCache and the cached entry points (see gpp_result_cache.hpp).
+\endrst*/
+
+#include "gpp_result_cache.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#include "gpp_common.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_profiling.hpp"
+#include "gpp_random.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! the kinds of result cached by the entry points in this file
+enum ResultCacheKind {
+  //! posterior mean and variance at one point
+  kMeanAndVarianceOfPoint = 0,
+  //! q,p-EI of one q-set
+  kExpectedImprovementOfPoints = 1,
+};
+
+}  // end unnamed namespace
+
+ResultCacheKey::ResultCacheKey(std::uint64_t version, int kind)
+    : words_{static_cast<std::int64_t>(version), kind} {
+}
+
+void ResultCacheKey::AppendInt(std::int64_t value) {
+  words_.push_back(value);
+}
+
+void ResultCacheKey::AppendDouble(double value) {
+  std::int64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  words_.push_back(bits);
+}
+
+void ResultCacheKey::AppendPoints(double const * restrict points, int size, double quantum) {
+  if (quantum > 0.0) {
+    for (int i = 0; i < size; ++i) {
+      words_.push_back(std::llround(points[i]/quantum));
+    }
+  } else {
+    for (int i = 0; i < size; ++i) {
+      AppendDouble(points[i] + 0.0);  // + 0.0 maps -0.0 to 0.0
+    }
+  }
+}
+
+std::size_t ResultCacheKeyHash::operator()(const ResultCacheKey& key) const noexcept {
+  // FNV-1a over the words
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::int64_t word : key.words()) {
+    hash ^= static_cast<std::uint64_t>(word);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+GaussianProcessResultCache::GaussianProcessResultCache(int max_entries, double quantum)
+    : max_entries_(max_entries), quantum_(quantum), hits_(0), misses_(0) {
+  if (unlikely(max_entries_ < 1)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "max_entries must be >= 1.", max_entries_, 1);
+  }
+  if (unlikely(quantum_ < 0.0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<double>, "quantum must be >= 0.", quantum_, 0.0);
+  }
+}
+
+bool GaussianProcessResultCache::Lookup(const ResultCacheKey& key, std::vector<double> * values) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    ++misses_;
+    OL_PROFILE_COUNT(ProfileCounter::kResultCacheMisses, 1);
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+  *values = found->second->second;
+  ++hits_;
+  OL_PROFILE_COUNT(ProfileCounter::kResultCacheHits, 1);
+  return true;
+}
+
+void GaussianProcessResultCache::Insert(const ResultCacheKey& key, std::vector<double> values) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    found->second->second = std::move(values);
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+  if (static_cast<int>(entries_.size()) >= max_entries_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, std::move(values));
+  index_.emplace(key, entries_.begin());
+}
+
+void GaussianProcessResultCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+}
+
+int GaussianProcessResultCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::int64_t GaussianProcessResultCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::int64_t GaussianProcessResultCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void ComputeMeanAndVarianceOfPointsCached(const GaussianProcess& gaussian_process,
+                                          double const * restrict points_to_sample, int num_to_sample,
+                                          GaussianProcessResultCache * cache, double * restrict mean_of_points,
+                                          double * restrict variance_of_points) {
+  const int dim = gaussian_process.dim();
+  std::vector<ResultCacheKey> keys;
+  keys.reserve(num_to_sample);
+  std::vector<int> misses;
+  std::vector<double> miss_points;
+  std::vector<double> values;
+  for (int i = 0; i < num_to_sample; ++i) {
+    keys.emplace_back(gaussian_process.version(), kMeanAndVarianceOfPoint);
+    keys.back().AppendPoints(points_to_sample + i*dim, dim, cache->quantum());
+    if (cache->Lookup(keys.back(), &values)) {
+      mean_of_points[i] = values[0];
+      variance_of_points[i] = values[1];
+    } else {
+      misses.push_back(i);
+      miss_points.insert(miss_points.end(), points_to_sample + i*dim, points_to_sample + (i+1)*dim);
+    }
+  }
+  if (misses.empty()) {
+    return;
+  }
+
+  const int num_misses = misses.size();
+  int num_derivatives = 0;
+  std::vector<int> gradients;  // values only
+  PointsToSampleState points_to_sample_state(gaussian_process, miss_points.data(), num_misses, gradients.data(),
+                                             gradients.size(), num_derivatives);
+  std::vector<double> mean(num_misses);
+  std::vector<double> variance(Square(num_misses));
+  gaussian_process.ComputeMeanOfPoints(points_to_sample_state, mean.data());
+  gaussian_process.ComputeVarianceOfPoints(&points_to_sample_state, points_to_sample_state.gradients.data(),
+                                           points_to_sample_state.num_gradients_to_sample, variance.data());
+  for (int j = 0; j < num_misses; ++j) {
+    const int i = misses[j];
+    mean_of_points[i] = mean[j];
+    variance_of_points[i] = variance[j*num_misses + j];
+    cache->Insert(keys[i], {mean_of_points[i], variance_of_points[i]});
+  }
+}
+
+void EvaluateEIAtPointListCached(const GaussianProcess& gaussian_process, const ThreadSchedule& thread_schedule,
+                                 double const * restrict initial_guesses,
+                                 double const * restrict points_being_sampled, int num_multistarts,
+                                 int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
+                                 GaussianProcessResultCache * cache, bool * restrict found_flag,
+                                 NormalRNGArray normal_rng, double * restrict function_values,
+                                 double * restrict best_next_point) {
+  if (unlikely(num_multistarts <= 0)) {
+    OL_THROW_EXCEPTION(LowerBoundException<int>, "num_multistarts must be > 1", num_multistarts, 1);
+  }
+
+  const int set_size = gaussian_process.dim()*num_to_sample;
+  ResultCacheKey settings(gaussian_process.version(), kExpectedImprovementOfPoints);
+  settings.AppendInt(num_to_sample);
+  settings.AppendInt(num_being_sampled);
+  settings.AppendInt(max_int_steps);
+  settings.AppendDouble(best_so_far);
+  settings.AppendPoints(points_being_sampled, gaussian_process.dim()*num_being_sampled, cache->quantum());
+
+  std::vector<double> EI_values(function_values == nullptr ? num_multistarts : 0);
+  double * restrict EI = function_values == nullptr ? EI_values.data() : function_values;
+  std::vector<ResultCacheKey> keys(num_multistarts, settings);
+  std::vector<int> misses;
+  std::vector<double> miss_points;
+  std::vector<double> values;
+  for (int i = 0; i < num_multistarts; ++i) {
+    keys[i].AppendPoints(initial_guesses + i*set_size, set_size, cache->quantum());
+    if (cache->Lookup(keys[i], &values)) {
+      EI[i] = values[0];
+    } else {
+      misses.push_back(i);
+      miss_points.insert(miss_points.end(), initial_guesses + i*set_size, initial_guesses + (i+1)*set_size);
+    }
+  }
+
+  if (!misses.empty()) {
+    const int num_misses = misses.size();
+    std::vector<double> miss_EI(num_misses);
+    std::vector<double> miss_best_point(set_size);
+    bool miss_found_flag = false;
+    EvaluateEIAtPointList(gaussian_process, thread_schedule, miss_points.data(), points_being_sampled, num_misses,
+                          num_to_sample, num_being_sampled, best_so_far, max_int_steps, &miss_found_flag,
+                          normal_rng, miss_EI.data(), miss_best_point.data());
+    for (int j = 0; j < num_misses; ++j) {
+      EI[misses[j]] = miss_EI[j];
+      cache->Insert(keys[misses[j]], {miss_EI[j]});
+    }
+  }
+
+  // as in EvaluateEIAtPointList(): the winner starts as the first set with a 'forced' value of -1.0, and a later set
+  // must be strictly better to replace it
+  double best_objective_value_so_far = -1.0;
+  int best_index = 0;
+  for (int i = 0; i < num_multistarts; ++i) {
+    if (best_objective_value_so_far < EI[i]) {
+      best_objective_value_so_far = EI[i];
+      best_index = i;
+    }
+  }
+  *found_flag = best_objective_value_so_far > -1.0;
+  std::copy(initial_guesses + best_index*set_size, initial_guesses + (best_index+1)*set_size, best_next_point);
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,230 @@
+/*!
+  \file gpp_result_cache.hpp
+  \rst
+  1. OVERVIEW
+  2. KEYS
+  3. CACHED ENTRY POINTS
+
+  **1. OVERVIEW**
+
+  A suggestion service sees many repeated queries against an unchanged model: dashboard refreshes, client retries,
+  and EI screens of the same candidate grid.  GaussianProcessResultCache remembers the results of such queries so a
+  repeat costs a hash lookup instead of new GP predictions and MC estimates.  It is optional: nothing in the library
+  creates or consults one unless the caller passes it to one of the cached entry points below.
+
+  The cache is bounded (``max_entries`` results, least recently used evicted first) and thread-safe: lookups and
+  inserts take a lock, the computations on a miss do not.  Its hit and miss counts are available from hits() and
+  misses(), and are also recorded as ProfileCounter::kResultCacheHits and kResultCacheMisses (gpp_profiling.hpp).
+
+  **2. KEYS**
+
+  A result is keyed by
+
+  a. the GaussianProcess::version() it was computed against.  Versions are unique within the process and renewed by
+     every change to the training data or hyperparameters (AddPointsToGP(), SetCovarianceHyperparameters(), ...), so
+     results of an older model are never returned; they simply age out of the cache.
+  b. the kind of result and the settings that affect it (e.g., ``best_so_far``, the MC iteration count, and the
+     points being sampled for EI).
+  c. the query points, quantized: each coordinate is rounded to the nearest multiple of ``quantum``.  With
+     ``quantum = 0`` (the default) points must match bit for bit; with ``quantum > 0``, points closer than about
+     ``quantum`` share a result, which is the value computed at whichever of them was queried first.
+
+  MC estimates (q,p-EI) are cached like everything else: a repeated query returns the earlier estimate rather than a
+  fresh draw.
+
+  **3. CACHED ENTRY POINTS**
+
+  * ComputeMeanAndVarianceOfPointsCached(): posterior mean and variance, cached per point.
+  * EvaluateEIAtPointListCached(): EvaluateEIAtPointList() (gpp_math.hpp), cached per q-set of points to sample.
+
+  Both look up every query first and compute only the misses, in one batch, so a partially repeated list costs only
+  its new points.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+class GaussianProcess;
+class NormalRNGArray;
+struct ThreadSchedule;
+
+/*!\rst
+  Key of a GaussianProcessResultCache entry: the GP version, the kind of result, its settings, and the quantized
+  query points (see the file comments).  Built with the Append*() functions; equal keys have equal words.
+\endrst*/
+class ResultCacheKey final {
+ public:
+  /*!\rst
+    \param
+      :version: GaussianProcess::version() of the model the result is computed against
+      :kind: what the result is; distinct kinds of result must use distinct values
+  \endrst*/
+  ResultCacheKey(std::uint64_t version, int kind);
+
+  //! appends a setting that must match exactly (e.g., a count)
+  void AppendInt(std::int64_t value);
+
+  //! appends a setting that must match exactly, bit for bit (e.g., ``best_so_far``)
+  void AppendDouble(double value);
+
+  /*!\rst
+    Appends points, each coordinate rounded to the nearest multiple of ``quantum`` (bit for bit if ``quantum = 0``).
+
+    \param
+      :points[size]: the coordinates
+      :size: number of coordinates
+      :quantum: quantization step; 0 for exact matching
+  \endrst*/
+  void AppendPoints(double const * restrict points, int size, double quantum);
+
+  //! the key's words
+  const std::vector<std::int64_t>& words() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return words_;
+  }
+
+  bool operator==(const ResultCacheKey& other) const noexcept {
+    return words_ == other.words_;
+  }
+
+ private:
+  //! version, kind, settings, and points, in order of appending
+  std::vector<std::int64_t> words_;
+};
+
+//! hash of a ResultCacheKey, for std::unordered_map
+struct ResultCacheKeyHash final {
+  std::size_t operator()(const ResultCacheKey& key) const noexcept OL_WARN_UNUSED_RESULT;
+};
+
+/*!\rst
+  Bounded, thread-safe least-recently-used map from ResultCacheKey to a vector of doubles; see the file comments.
+  Not copyable.
+\endrst*/
+class GaussianProcessResultCache final {
+ public:
+  /*!\rst
+    \param
+      :max_entries: largest number of results held; the least recently used is evicted beyond it
+      :quantum: quantization step of the query points in the keys built by the cached entry points; 0 for exact matching
+    \raise
+      LowerBoundException<int> if ``max_entries < 1``; LowerBoundException<double> if ``quantum < 0``
+  \endrst*/
+  explicit GaussianProcessResultCache(int max_entries, double quantum = 0.0);
+
+  int max_entries() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return max_entries_;
+  }
+
+  double quantum() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return quantum_;
+  }
+
+  /*!\rst
+    Looks up ``key``; a hit makes the entry the most recently used.  Counts a hit or a miss.
+
+    \param
+      :key: the key to look up
+    \output
+      :values[1]: the cached result on a hit; unchanged on a miss
+    \return
+      true on a hit
+  \endrst*/
+  bool Lookup(const ResultCacheKey& key, std::vector<double> * values) OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Stores (or replaces) the result of ``key`` as the most recently used entry, evicting the least recently used
+    entry if the cache is full.
+
+    \param
+      :key: the key of the result
+      :values: the result
+  \endrst*/
+  void Insert(const ResultCacheKey& key, std::vector<double> values);
+
+  //! removes every entry; the hit and miss counts are kept
+  void Clear();
+
+  //! number of entries held
+  int size() const OL_WARN_UNUSED_RESULT;
+
+  //! number of Lookup() calls that hit
+  std::int64_t hits() const OL_WARN_UNUSED_RESULT;
+
+  //! number of Lookup() calls that missed
+  std::int64_t misses() const OL_WARN_UNUSED_RESULT;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(GaussianProcessResultCache);
+
+ private:
+  using EntryList = std::list<std::pair<ResultCacheKey, std::vector<double>>>;
+
+  //! largest number of entries
+  int max_entries_;
+  //! quantization step of the query points
+  double quantum_;
+  //! guards every member below
+  mutable std::mutex mutex_;
+  //! the entries, most recently used first
+  EntryList entries_;
+  //! position of each key's entry in entries_
+  std::unordered_map<ResultCacheKey, EntryList::iterator, ResultCacheKeyHash> index_;
+  //! number of hits
+  std::int64_t hits_;
+  //! number of misses
+  std::int64_t misses_;
+};
+
+/*!\rst
+  Computes the posterior mean and variance of ``gaussian_process`` at each of ``points_to_sample`` (the diagonal of
+  GaussianProcess::ComputeVarianceOfPoints()), reusing the cached results of points seen before against the same
+  model.  The misses are computed together, with one PointsToSampleState.
+
+  \param
+    :gaussian_process: the GP
+    :points_to_sample[dim][num_to_sample]: points at which to predict
+    :num_to_sample: number of points
+  \output
+    :cache[1]: holds the results of the misses on return
+    :mean_of_points[num_to_sample]: posterior mean at each point
+    :variance_of_points[num_to_sample]: posterior variance at each point
+\endrst*/
+void ComputeMeanAndVarianceOfPointsCached(const GaussianProcess& gaussian_process,
+                                          double const * restrict points_to_sample, int num_to_sample,
+                                          GaussianProcessResultCache * cache, double * restrict mean_of_points,
+                                          double * restrict variance_of_points) OL_NONNULL_POINTERS;
+
+/*!\rst
+  EvaluateEIAtPointList() (gpp_math.hpp), reusing the cached EI of q-sets seen before against the same model and
+  settings (``points_being_sampled``, ``best_so_far``, ``max_int_steps``).  The misses are evaluated together, by one
+  EvaluateEIAtPointList() call over just them; the best point is then chosen over all ``num_multistarts`` sets (ties
+  to the earlier set), and ``found_flag`` is set as there.
+
+  \param
+    see EvaluateEIAtPointList()
+  \output
+    :cache[1]: holds the EI of the misses on return
+    others: see EvaluateEIAtPointList(); ``normal_rng`` draws only for the misses
+\endrst*/
+void EvaluateEIAtPointListCached(const GaussianProcess& gaussian_process, const ThreadSchedule& thread_schedule,
+                                 double const * restrict initial_guesses,
+                                 double const * restrict points_being_sampled, int num_multistarts,
+                                 int num_to_sample, int num_being_sampled, double best_so_far, int max_int_steps,
+                                 GaussianProcessResultCache * cache, bool * restrict found_flag,
+                                 NormalRNGArray normal_rng, double * restrict function_values,
+                                 double * restrict best_next_point);
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_HPP_
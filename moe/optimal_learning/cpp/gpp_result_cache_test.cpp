@@ -0,0 +1,252 @@
+/*!
+  \file gpp_result_cache_test.cpp
+  \rst
+  Routines to test the functions in gpp_result_cache.cpp:
+
+  * GaussianProcessResultCache evicts the least recently used entry, counts hits and misses, and rejects bad sizes,
+  * ResultCacheKey matches points within the quantum and only bit-identical points without one,
+  * ComputeMeanAndVarianceOfPointsCached() reproduces the GP's mean and variance, computes only new points on a
+    partially repeated list, and misses after AddPointsToGP(), and
+  * EvaluateEIAtPointListCached() reproduces EvaluateEIAtPointList() and answers a repeated list (analytic and MC)
+    from the cache without drawing.
+\endrst*/
+
+#include "gpp_result_cache_test.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_exception.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_random.hpp"
+#include "gpp_result_cache.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks eviction order, hit/miss counts, replacement, Clear(), key quantization, and the constructor's checks.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ResultCacheLruTest() {
+  int total_errors = 0;
+  const double point_a[2] = {0.25, 0.5};
+  const double point_b[2] = {0.75, 0.5};
+  const double point_c[2] = {0.25, 0.0};
+  auto make_key = [](double const * point, double quantum) {
+    ResultCacheKey key(7, 0);
+    key.AppendPoints(point, 2, quantum);
+    return key;
+  };
+
+  GaussianProcessResultCache cache(2);
+  std::vector<double> values;
+  cache.Insert(make_key(point_a, 0.0), {1.0});
+  cache.Insert(make_key(point_b, 0.0), {2.0});
+  // a becomes the most recently used, so c evicts b
+  if (!cache.Lookup(make_key(point_a, 0.0), &values) || values != std::vector<double>{1.0}) {
+    ++total_errors;
+  }
+  cache.Insert(make_key(point_c, 0.0), {3.0});
+  if (cache.Lookup(make_key(point_b, 0.0), &values) || cache.size() != 2) {
+    ++total_errors;
+  }
+  cache.Insert(make_key(point_a, 0.0), {4.0});
+  if (!cache.Lookup(make_key(point_a, 0.0), &values) || values != std::vector<double>{4.0} ||
+      !cache.Lookup(make_key(point_c, 0.0), &values) || values != std::vector<double>{3.0}) {
+    ++total_errors;
+  }
+  if (cache.hits() != 3 || cache.misses() != 1) {
+    ++total_errors;
+  }
+  cache.Clear();
+  if (cache.size() != 0 || cache.Lookup(make_key(point_a, 0.0), &values) || cache.misses() != 2) {
+    ++total_errors;
+  }
+
+  // versions, kinds, and settings all separate keys
+  ResultCacheKey other_version(8, 0);
+  other_version.AppendPoints(point_a, 2, 0.0);
+  ResultCacheKey other_kind(7, 1);
+  other_kind.AppendPoints(point_a, 2, 0.0);
+  ResultCacheKey with_setting(7, 0);
+  with_setting.AppendDouble(0.5);
+  with_setting.AppendPoints(point_a, 2, 0.0);
+  if (other_version == make_key(point_a, 0.0) || other_kind == make_key(point_a, 0.0) ||
+      with_setting == make_key(point_a, 0.0)) {
+    ++total_errors;
+  }
+
+  const double near_a[2] = {0.25 + 1.0e-9, 0.5 - 1.0e-9};
+  if (make_key(near_a, 0.0) == make_key(point_a, 0.0) || !(make_key(near_a, 1.0e-6) == make_key(point_a, 1.0e-6))) {
+    ++total_errors;
+  }
+  if (ResultCacheKeyHash()(make_key(near_a, 1.0e-6)) != ResultCacheKeyHash()(make_key(point_a, 1.0e-6))) {
+    ++total_errors;
+  }
+
+  try {
+    GaussianProcessResultCache bad_cache(0);
+    ++total_errors;
+  } catch (const LowerBoundException<int>&) {
+  }
+  try {
+    GaussianProcessResultCache bad_cache(1, -1.0);
+    ++total_errors;
+  } catch (const LowerBoundException<double>&) {
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks the cached GP mean/variance and EI entry points against the uncached ones.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int ResultCacheGaussianProcessTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 15;
+  const int num_points = 12;
+  const double tolerance = 1.0e-13;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_points, 0, num_sampled + 2, 0);
+  std::vector<double> lengths(dim, 0.8);
+  SquareExponential sqexp_covariance(dim, 1.1, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-2);
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                   num_sampled);
+  double const * points = EI_environment.points_to_sample();
+
+  // reference mean and variance of the points, one at a time
+  auto check_predictions = [&](double const * mean, double const * variance, int begin, int end) {
+    int errors = 0;
+    for (int i = begin; i < end; ++i) {
+      int num_derivatives = 0;
+      PointsToSampleState state(gaussian_process, points + i*dim, 1, nullptr, 0, num_derivatives);
+      double mean_truth, variance_truth;
+      gaussian_process.ComputeMeanOfPoints(state, &mean_truth);
+      gaussian_process.ComputeVarianceOfPoints(&state, nullptr, 0, &variance_truth);
+      if (!CheckDoubleWithinRelative(mean[i - begin], mean_truth, tolerance) ||
+          !CheckDoubleWithinRelative(variance[i - begin], variance_truth, tolerance)) {
+        ++errors;
+      }
+    }
+    return errors;
+  };
+
+  GaussianProcessResultCache cache(100);
+  std::vector<double> mean(num_points);
+  std::vector<double> variance(num_points);
+  ComputeMeanAndVarianceOfPointsCached(gaussian_process, points, num_points/2, &cache, mean.data(), variance.data());
+  total_errors += check_predictions(mean.data(), variance.data(), 0, num_points/2);
+  // a list overlapping the first one computes only its new half
+  ComputeMeanAndVarianceOfPointsCached(gaussian_process, points + (num_points/4)*dim, num_points/2, &cache,
+                                       mean.data(), variance.data());
+  total_errors += check_predictions(mean.data(), variance.data(), num_points/4, num_points/4 + num_points/2);
+  if (cache.hits() != num_points/4 || cache.misses() != num_points/2 + num_points/4) {
+    ++total_errors;
+  }
+
+  // a new version misses every point
+  const std::uint64_t old_version = gaussian_process.version();
+  gaussian_process.AddPointsToGP(EI_environment.points_sampled() + num_sampled*dim,
+                                 EI_environment.points_sampled_value() + num_sampled, 2);
+  if (gaussian_process.version() == old_version) {
+    ++total_errors;
+  }
+  const std::int64_t hits_before = cache.hits();
+  ComputeMeanAndVarianceOfPointsCached(gaussian_process, points, num_points/2, &cache, mean.data(), variance.data());
+  total_errors += check_predictions(mean.data(), variance.data(), 0, num_points/2);
+  if (cache.hits() != hits_before) {
+    ++total_errors;
+  }
+
+  // EI: analytic 1,0-EI and MC 2,1-EI, each evaluated twice through the cache
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled + 2);
+  // one thread: with more, which generator draws for which set (and so the MC values) may vary from call to call
+  ThreadSchedule thread_schedule(1, omp_sched_static);
+  for (int num_to_sample : {1, 2}) {
+    const int num_being_sampled = num_to_sample - 1;
+    const int num_sets = (num_points - num_being_sampled)/num_to_sample;
+    double const * points_being_sampled = points + num_sets*num_to_sample*dim;
+    const int max_int_steps = 500;
+
+    std::vector<NormalRNG> normal_rng(thread_schedule.max_num_threads, NormalRNG(3141));
+    std::vector<double> function_values(num_sets);
+    std::vector<double> best_next_point(dim*num_to_sample);
+    bool found_flag = false;
+    EvaluateEIAtPointList(gaussian_process, thread_schedule, points, points_being_sampled, num_sets, num_to_sample,
+                          num_being_sampled, best_so_far, max_int_steps, &found_flag, normal_rng.data(),
+                          function_values.data(), best_next_point.data());
+
+    std::vector<NormalRNG> cached_normal_rng(thread_schedule.max_num_threads, NormalRNG(3141));
+    std::vector<double> cached_function_values(num_sets);
+    std::vector<double> cached_best_next_point(dim*num_to_sample);
+    for (int repeat = 0; repeat < 2; ++repeat) {
+      bool cached_found_flag = false;
+      const std::int64_t misses_before = cache.misses();
+      EvaluateEIAtPointListCached(gaussian_process, thread_schedule, points, points_being_sampled, num_sets,
+                                  num_to_sample, num_being_sampled, best_so_far, max_int_steps, &cache,
+                                  &cached_found_flag, cached_normal_rng.data(), cached_function_values.data(),
+                                  cached_best_next_point.data());
+      if (cached_function_values != function_values || cached_best_next_point != best_next_point ||
+          cached_found_flag != found_flag) {
+        ++total_errors;
+      }
+      if (cache.misses() - misses_before != (repeat == 0 ? num_sets : 0)) {
+        ++total_errors;
+      }
+    }
+    // the repeat drew nothing: the generators are where the first (uncached) call left them
+    for (int i = 0; i < thread_schedule.max_num_threads; ++i) {
+      if (cached_normal_rng[i]() != normal_rng[i]()) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunResultCacheTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = ResultCacheLruTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("result cache LRU and keys failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("result cache LRU and keys\n");
+  }
+  total_errors += current_errors;
+
+  current_errors = ResultCacheGaussianProcessTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("result cache GP and EI entry points failed with %d errors\n", current_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("result cache GP and EI entry points\n");
+  }
+  total_errors += current_errors;
+
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
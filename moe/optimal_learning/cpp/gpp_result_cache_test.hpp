@@ -0,0 +1,25 @@
+/*!
+  \file gpp_result_cache_test.hpp
+  \rst
+  Functions for testing gpp_result_cache's functionality: GaussianProcessResultCache's bounded LRU map and key
+  quantization, and the cached GP mean/variance and EI entry points against their uncached counterparts.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the result cache tests.
+
+  \return
+    number of test failures: 0 if the cache and the cached entry points are working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunResultCacheTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_RESULT_CACHE_TEST_HPP_
@@ -0,0 +1,480 @@
+/*!
+  \file gpp_suggestion_server.cpp
+  \rst
+  ``moe/optimal_learning/cpp/gpp_suggestion_server.cpp``
+
+  A standalone suggestion service: the suggest/observe loop of the REST interface (``moe/views``) without the Python
+  stack.  Fitted GPs stay resident between requests, each in an ExpectedImprovementOptimizerSession (see
+  gpp_optimizer_session.hpp), so a request costs one native EI optimization (or nothing, with background
+  precomputation) instead of interpreter startup, JSON -> Python list -> C++ conversions, and a GP rebuild.
+
+  Usage::
+
+    gpp_server [--port=N] [--bind=ADDRESS] [--max-connections=N] [--threads=N]
+
+  * ``--port``: listen for TCP connections on port N (each connection is served by its own thread; sessions are shared
+    by all connections); default: serve stdin/stdout (e.g., under inetd, socat, or a parent process)
+  * ``--bind``: IPv4 address to listen on; default 127.0.0.1.  The server has no authentication: anyone who can reach
+    the port can create, read, and delete every session, so only bind a non-loopback address on a trusted network.
+  * ``--max-connections``: most connections served at once; beyond it, a new connection gets an error response and is
+    closed; default 64
+  * ``--threads``: max_num_threads of each EI optimization; default 1
+
+  Request lines longer than 1 MiB get an error response and end the connection (or, on stdin, the server).
+
+  **Protocol**
+
+  One JSON object per line in, one JSON object per line out.  Every request names its ``op`` and ``session``.
+  Responses are ``{"ok": true, ...}`` or ``{"ok": false, "error": "message"}``.
+
+  * ``create``: builds a session from the history and hyperparameters (replacing any session of the same name)::
+
+      {"op": "create", "session": "s", "domain": [[min, max], ...], "hyperparameters": [alpha, length_0, ...],
+       "noise_variance": 0.01, "points_sampled": [[x_0, ...], ...], "values": [y_0, ...]}
+
+    optional fields (defaults match ``DEFAULT_GRADIENT_DESCENT_PARAMETERS_EI_MC`` in ``moe/optimal_learning/python/constant.py``):
+    ``num_multistarts`` (200), ``max_num_steps`` (500), ``max_num_restarts`` (4), ``num_steps_averaged`` (100),
+    ``gamma`` (0.6), ``pre_mult`` (1.0), ``max_relative_change`` (1.0), ``tolerance`` (1.0e-5),
+    ``max_int_steps`` (10000), ``num_warm_starts`` (4), ``precompute`` (true), ``seed`` (0).
+    Counts must be positive and are clamped to the server's limits (see ServerOptions); ``num_warm_starts`` is also
+    clamped to ``num_multistarts``.  ``gamma``, ``pre_mult``, and ``max_relative_change`` must be positive and
+    ``tolerance`` nonnegative.
+    The covariance is SquareExponential.  Response: ``{"ok": true, "dim": d, "num_sampled": n}``.
+  * ``suggest``: ``{"op": "suggest", "session": "s"}`` -> ``{"ok": true, "point": [...], "found": true}``; the point
+    becomes pending
+  * ``pending``: ``{"op": "pending", "session": "s", "point": [...]}`` marks a point that is being evaluated without
+    having been suggested
+  * ``observe``: ``{"op": "observe", "session": "s", "point": [...], "value": y}`` ->
+    ``{"ok": true, "num_sampled": n, "num_pending": p, "best_so_far": y_min}``
+  * ``status``: ``{"op": "status", "session": "s"}`` -> the same fields as ``observe``
+  * ``delete``: ``{"op": "delete", "session": "s"}`` drops the session
+
+  Minimization, as everywhere in this library: observe the negated objective to maximize.
+\endrst*/
+
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>  // NOLINT(build/c++11)
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>  // NOLINT(build/include_order)
+#include <boost/property_tree/ptree.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_domain.hpp"
+#include "gpp_geometry.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_optimizer_parameters.hpp"
+#include "gpp_optimizer_session.hpp"
+
+using namespace optimal_learning;  // NOLINT, i'm lazy in this file which has no external linkage anyway
+
+namespace {
+
+using Session = ExpectedImprovementOptimizerSession<TensorProductDomain>;
+using Request = boost::property_tree::ptree;
+
+//! maximum number of pending TCP connections
+constexpr int kListenBacklog = 16;
+//! longest request line read, in bytes (without the newline)
+constexpr std::size_t kMaxLineLength = 1 << 20;
+
+struct ServerOptions {
+  int port = 0;
+  std::string bind_address = "127.0.0.1";
+  int max_connections = 64;
+  int max_num_threads = 1;
+
+  // upper limits on the optimizer settings of a ``create`` request; larger values are clamped to these so one request
+  // cannot tie up a thread (or the precomputation) for hours
+  //! most multistarts of an EI optimization
+  int max_num_multistarts = 2000;
+  //! most gradient descent steps per restart (also bounds ``num_steps_averaged``)
+  int max_num_steps = 5000;
+  //! most gradient descent restarts
+  int max_num_restarts = 20;
+  //! most MC iterations of q,p-EI
+  int max_int_steps = 100000;
+};
+
+/*!\rst
+  The resident sessions, by name.  Sessions are thread-safe and held by shared_ptr, so a request keeps its session
+  alive (and does not hold the registry lock) while it runs, even if another connection deletes or replaces it.
+\endrst*/
+class SessionRegistry {
+ public:
+  std::shared_ptr<Session> Find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto session = sessions_.find(name);
+    if (session == sessions_.end()) {
+      throw std::runtime_error("no session named " + name);
+    }
+    return session->second;
+  }
+
+  void Insert(const std::string& name, std::shared_ptr<Session> session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[name] = std::move(session);
+  }
+
+  bool Erase(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.erase(name) != 0;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<Session>> sessions_;
+};
+
+//! the entries of a JSON array of numbers
+std::vector<double> GetVector(const Request& request, const std::string& key) {
+  std::vector<double> values;
+  for (const auto& entry : request.get_child(key)) {
+    values.push_back(entry.second.get_value<double>());
+  }
+  return values;
+}
+
+//! the entries of a JSON array of arrays of numbers, flattened row by row; each row must have ``row_size`` entries
+std::vector<double> GetMatrix(const Request& request, const std::string& key, int row_size) {
+  std::vector<double> values;
+  for (const auto& row : request.get_child(key)) {
+    int num_entries = 0;
+    for (const auto& entry : row.second) {
+      values.push_back(entry.second.get_value<double>());
+      ++num_entries;
+    }
+    if (num_entries != row_size) {
+      throw std::runtime_error(key + ": every row must have " + std::to_string(row_size) + " entries");
+    }
+  }
+  return values;
+}
+
+//! a point of the session's dimension
+std::vector<double> GetPoint(const Request& request, const Session& session) {
+  std::vector<double> point = GetVector(request, "point");
+  if (static_cast<int>(point.size()) != session.dim()) {
+    throw std::runtime_error("point must have " + std::to_string(session.dim()) + " entries");
+  }
+  return point;
+}
+
+//! ``request[key]`` (``default_value`` if absent), which must be positive, clamped to ``max_value``
+int GetCount(const Request& request, const std::string& key, int default_value, int max_value) {
+  const int value = request.get<int>(key, default_value);
+  if (value <= 0) {
+    throw std::runtime_error(key + " must be positive");
+  }
+  return std::min(value, max_value);
+}
+
+//! ``request[key]`` (``default_value`` if absent), which must be finite and positive (or nonnegative, if ``allow_zero``)
+double GetNonnegativeDouble(const Request& request, const std::string& key, double default_value, bool allow_zero) {
+  const double value = request.get<double>(key, default_value);
+  if (!std::isfinite(value) || value < 0.0 || (!allow_zero && value == 0.0)) {
+    throw std::runtime_error(key + (allow_zero ? " must be finite and nonnegative" : " must be finite and positive"));
+  }
+  return value;
+}
+
+//! appends ``value``, or ``null`` if it is not finite (JSON has no nan or inf)
+void AppendNumber(double value, std::string * response) {
+  if (!std::isfinite(value)) {
+    response->append("null");
+    return;
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  response->append(buffer);
+}
+
+void AppendArray(const std::vector<double>& values, std::string * response) {
+  response->push_back('[');
+  for (int i = 0; i < static_cast<int>(values.size()); ++i) {
+    if (i > 0) {
+      response->append(", ");
+    }
+    AppendNumber(values[i], response);
+  }
+  response->push_back(']');
+}
+
+void AppendString(const std::string& value, std::string * response) {
+  response->push_back('"');
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      response->push_back('\\');
+      response->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      response->push_back(' ');
+    } else {
+      response->push_back(c);
+    }
+  }
+  response->push_back('"');
+}
+
+//! ``"num_sampled": n, "num_pending": p, "best_so_far": y`` of a session
+void AppendStatus(const Session& session, std::string * response) {
+  response->append(", \"num_sampled\": " + std::to_string(session.num_sampled()));
+  response->append(", \"num_pending\": " + std::to_string(session.num_pending()));
+  response->append(", \"best_so_far\": ");
+  AppendNumber(session.best_so_far(), response);
+}
+
+std::shared_ptr<Session> CreateSession(const Request& request, const ServerOptions& options) {
+  std::vector<ClosedInterval> domain_bounds;
+  for (const auto& bounds : request.get_child("domain")) {
+    std::vector<double> interval;
+    for (const auto& entry : bounds.second) {
+      interval.push_back(entry.second.get_value<double>());
+    }
+    if (interval.size() != 2) {
+      throw std::runtime_error("domain: every interval must be [min, max]");
+    }
+    domain_bounds.emplace_back(interval[0], interval[1]);
+  }
+  const int dim = domain_bounds.size();
+  if (dim == 0) {
+    throw std::runtime_error("domain must have at least one interval");
+  }
+  TensorProductDomain domain(domain_bounds.data(), dim);
+
+  std::vector<double> hyperparameters = GetVector(request, "hyperparameters");
+  if (static_cast<int>(hyperparameters.size()) != dim + 1) {
+    throw std::runtime_error("hyperparameters must be [alpha, length_0, ..., length_{dim-1}]");
+  }
+  SquareExponential covariance(dim, hyperparameters[0], hyperparameters.data() + 1);
+  const double noise_variance = request.get<double>("noise_variance");
+
+  std::vector<double> points_sampled = GetMatrix(request, "points_sampled", dim);
+  std::vector<double> points_sampled_value = GetVector(request, "values");
+  const int num_sampled = points_sampled_value.size();
+  if (num_sampled == 0 || static_cast<int>(points_sampled.size()) != num_sampled*dim) {
+    throw std::runtime_error("points_sampled and values must be nonempty and of the same length");
+  }
+
+  GradientDescentParameters optimizer_parameters(
+      GetCount(request, "num_multistarts", 200, options.max_num_multistarts),
+      GetCount(request, "max_num_steps", 500, options.max_num_steps),
+      GetCount(request, "max_num_restarts", 4, options.max_num_restarts),
+      GetCount(request, "num_steps_averaged", 100, options.max_num_steps),
+      GetNonnegativeDouble(request, "gamma", 0.6, false), GetNonnegativeDouble(request, "pre_mult", 1.0, false),
+      GetNonnegativeDouble(request, "max_relative_change", 1.0, false),
+      GetNonnegativeDouble(request, "tolerance", 1.0e-5, true));
+  ThreadSchedule thread_schedule(options.max_num_threads, omp_sched_dynamic);
+  const int max_int_steps = GetCount(request, "max_int_steps", 10000, options.max_int_steps);
+  const int num_warm_starts = GetCount(request, "num_warm_starts", 4, optimizer_parameters.num_multistarts);
+
+  return std::make_shared<Session>(covariance, &noise_variance, points_sampled.data(), points_sampled_value.data(), dim,
+                                   num_sampled, domain, optimizer_parameters, thread_schedule,
+                                   max_int_steps, num_warm_starts,
+                                   request.get<bool>("precompute", true),
+                                   request.get<Session::EngineType::result_type>("seed", 0));
+}
+
+/*!\rst
+  Parses one request line, runs it, and returns the response line (without the newline).  Never throws: malformed
+  requests and errors from the library become ``{"ok": false, ...}``.
+\endrst*/
+std::string HandleRequest(const std::string& line, const ServerOptions& options, SessionRegistry * registry) {
+  std::string response = "{\"ok\": true";
+  try {
+    Request request;
+    std::istringstream stream(line);
+    boost::property_tree::read_json(stream, request);
+    const std::string op = request.get<std::string>("op");
+    const std::string name = request.get<std::string>("session");
+
+    if (op == "create") {
+      std::shared_ptr<Session> session = CreateSession(request, options);
+      response.append(", \"dim\": " + std::to_string(session->dim()));
+      response.append(", \"num_sampled\": " + std::to_string(session->num_sampled()));
+      registry->Insert(name, std::move(session));
+    } else if (op == "suggest") {
+      std::shared_ptr<Session> session = registry->Find(name);
+      std::vector<double> point(session->dim());
+      const bool found_flag = session->Suggest(point.data());
+      response.append(", \"point\": ");
+      AppendArray(point, &response);
+      response.append(found_flag ? ", \"found\": true" : ", \"found\": false");
+    } else if (op == "pending") {
+      std::shared_ptr<Session> session = registry->Find(name);
+      session->MarkPending(GetPoint(request, *session).data());
+      AppendStatus(*session, &response);
+    } else if (op == "observe") {
+      std::shared_ptr<Session> session = registry->Find(name);
+      session->Observe(GetPoint(request, *session).data(), request.get<double>("value"));
+      AppendStatus(*session, &response);
+    } else if (op == "status") {
+      AppendStatus(*registry->Find(name), &response);
+    } else if (op == "delete") {
+      if (!registry->Erase(name)) {
+        throw std::runtime_error("no session named " + name);
+      }
+    } else {
+      throw std::runtime_error("unknown op " + op);
+    }
+  } catch (const std::exception& exception) {
+    response = "{\"ok\": false, \"error\": ";
+    AppendString(exception.what(), &response);
+  }
+  response.push_back('}');
+  return response;
+}
+
+enum class ReadLineResult {
+  kLine,
+  kEndOfInput,
+  //! the line exceeds kMaxLineLength; the rest of it is left unread
+  kTooLong,
+};
+
+//! reads one line (without the newline) from ``file``, reading no more than kMaxLineLength bytes of it
+ReadLineResult ReadLine(std::FILE * file, std::string * line) {
+  line->clear();
+  int c;
+  while ((c = std::fgetc(file)) != EOF && c != '\n') {
+    if (line->size() >= kMaxLineLength) {
+      return ReadLineResult::kTooLong;
+    }
+    line->push_back(static_cast<char>(c));
+  }
+  return (c != EOF || !line->empty()) ? ReadLineResult::kLine : ReadLineResult::kEndOfInput;
+}
+
+//! answers requests from ``input`` on ``output`` until end of input or an overlong line
+void Serve(std::FILE * input, std::FILE * output, const ServerOptions& options, SessionRegistry * registry) {
+  std::string line;
+  ReadLineResult result;
+  while ((result = ReadLine(input, &line)) == ReadLineResult::kLine) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    const std::string response = HandleRequest(line, options, registry);
+    std::fprintf(output, "%s\n", response.c_str());
+    std::fflush(output);
+  }
+  if (result == ReadLineResult::kTooLong) {
+    std::fprintf(output, "{\"ok\": false, \"error\": \"request line longer than %zu bytes\"}\n", kMaxLineLength);
+    std::fflush(output);
+  }
+}
+
+//! accepts TCP connections on ``options.bind_address:port`` forever, serving up to ``max_connections`` at once, each
+//! on its own thread
+int ServeTcp(const ServerOptions& options, SessionRegistry * registry) {
+  const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    std::perror("socket");
+    return EXIT_FAILURE;
+  }
+  const int reuse = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  if (inet_pton(AF_INET, options.bind_address.c_str(), &address.sin_addr) != 1) {
+    std::fprintf(stderr, "invalid --bind address %s\n", options.bind_address.c_str());
+    close(listen_fd);
+    return EXIT_FAILURE;
+  }
+  address.sin_port = htons(static_cast<uint16_t>(options.port));
+  if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+      listen(listen_fd, kListenBacklog) != 0) {
+    std::perror("bind/listen");
+    close(listen_fd);
+    return EXIT_FAILURE;
+  }
+
+  // only this thread increments, so checking before incrementing cannot overshoot
+  std::atomic<int> num_connections(0);
+  while (true) {
+    const int connection_fd = accept(listen_fd, nullptr, nullptr);
+    if (connection_fd < 0) {
+      continue;
+    }
+    if (num_connections.load() >= options.max_connections) {
+      static const char kBusy[] = "{\"ok\": false, \"error\": \"too many connections\"}\n";
+      send(connection_fd, kBusy, sizeof(kBusy) - 1, MSG_NOSIGNAL);  // best effort: the client may be gone already
+      close(connection_fd);
+      continue;
+    }
+    ++num_connections;
+    std::thread([connection_fd, &options, registry, &num_connections]() {
+      // separate streams for each direction; closing both closes the socket
+      std::FILE * input = fdopen(connection_fd, "r");
+      std::FILE * output = fdopen(dup(connection_fd), "w");
+      if (input != nullptr && output != nullptr) {
+        Serve(input, output, options, registry);
+      }
+      if (input != nullptr) {
+        std::fclose(input);
+      } else {
+        close(connection_fd);
+      }
+      if (output != nullptr) {
+        std::fclose(output);
+      }
+      --num_connections;
+    }).detach();
+  }
+}
+
+bool ParseFlag(char const * argument, char const * name, std::string * value) {
+  const std::size_t length = std::strlen(name);
+  if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') {
+    return false;
+  }
+  *value = argument + length + 1;
+  return true;
+}
+
+}  // end unnamed namespace
+
+int main(int argc, char ** argv) {
+  ServerOptions options;
+  for (int i = 1; i < argc; ++i) {
+    std::string value;
+    if (ParseFlag(argv[i], "--port", &value) && std::atoi(value.c_str()) > 0) {
+      options.port = std::atoi(value.c_str());
+    } else if (ParseFlag(argv[i], "--bind", &value) && !value.empty()) {
+      options.bind_address = value;
+    } else if (ParseFlag(argv[i], "--max-connections", &value) && std::atoi(value.c_str()) > 0) {
+      options.max_connections = std::atoi(value.c_str());
+    } else if (ParseFlag(argv[i], "--threads", &value) && std::atoi(value.c_str()) > 0) {
+      options.max_num_threads = std::atoi(value.c_str());
+    } else {
+      std::fprintf(stderr, "usage: %s [--port=N] [--bind=ADDRESS] [--max-connections=N] [--threads=N]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  SessionRegistry registry;
+  if (options.port > 0) {
+    return ServeTcp(options, &registry);
+  }
+  Serve(stdin, stdout, options, &registry);
+  return EXIT_SUCCESS;
+}
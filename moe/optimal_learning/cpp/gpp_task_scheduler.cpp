@@ -0,0 +1,356 @@
+/*!
+  \file gpp_task_scheduler.cpp
+  \rst
+  Implementation of the process-wide WorkStealingScheduler, ParallelForEachIndex(), ForEachOwningThread(),
+  ThreadPlacement, and LoopScheduleTuner; see gpp_task_scheduler.hpp.
+\endrst*/
+
+#include "gpp_task_scheduler.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include <omp.h>  // NOLINT(build/include_order)
+#if defined(__linux__)
+#include <sched.h>  // NOLINT(build/include_order)
+#endif
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+//! index of the calling thread among WorkStealingScheduler's workers; -1 on every other thread
+thread_local int worker_index_of_this_thread = -1;
+
+}  // end unnamed namespace
+
+WorkStealingScheduler& WorkStealingScheduler::Instance() {
+  // never destroyed: see class docs
+  static WorkStealingScheduler * scheduler = new WorkStealingScheduler(std::max(omp_get_num_procs(), 1));
+  return *scheduler;
+}
+
+bool WorkStealingScheduler::OnWorkerThread() noexcept {
+  return worker_index_of_this_thread >= 0;
+}
+
+WorkStealingScheduler::WorkStealingScheduler(int num_workers)
+    : queues_(),
+      workers_(),
+      num_queued_tasks_(0),
+      next_queue_(0) {
+  for (int i = 0; i < num_workers; ++i) {
+    queues_.emplace_back(new TaskQueue());
+  }
+  // queues_ must be complete before any worker starts stealing from it
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&WorkStealingScheduler::WorkerLoop, this, i);
+  }
+}
+
+void WorkStealingScheduler::Submit(Task task) {
+  const int num_queues = queues_.size();
+  const int queue_index = OnWorkerThread() ? worker_index_of_this_thread : next_queue_++ % num_queues;
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+    queues_[queue_index]->tasks.push_back(std::move(task));
+  }
+  {
+    // incremented under sleep_mutex_ so that a worker checking for work cannot miss the notification
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    ++num_queued_tasks_;
+  }
+  task_available_.notify_one();
+}
+
+bool WorkStealingScheduler::TryRunOneTask(int home_queue) {
+  const int num_queues = queues_.size();
+  Task task;
+  bool found_task = false;
+  if (home_queue >= 0) {
+    // own work: newest first, i.e., the inner loop this thread just submitted
+    std::lock_guard<std::mutex> lock(queues_[home_queue]->mutex);
+    if (!queues_[home_queue]->tasks.empty()) {
+      task = std::move(queues_[home_queue]->tasks.back());
+      queues_[home_queue]->tasks.pop_back();
+      found_task = true;
+    }
+  }
+  // steal: oldest first, i.e., the outermost (largest) pending work of the victim
+  const int first_victim = std::max(home_queue + 1, 0);
+  for (int k = 0; k < num_queues && !found_task; ++k) {
+    const int victim = (first_victim + k) % num_queues;
+    if (victim == home_queue) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(queues_[victim]->mutex);
+    if (!queues_[victim]->tasks.empty()) {
+      task = std::move(queues_[victim]->tasks.front());
+      queues_[victim]->tasks.pop_front();
+      found_task = true;
+    }
+  }
+
+  if (!found_task) {
+    return false;
+  }
+  --num_queued_tasks_;
+  task();
+  return true;
+}
+
+void WorkStealingScheduler::WorkerLoop(int worker_index) {
+  worker_index_of_this_thread = worker_index;
+  while (true) {
+    if (TryRunOneTask(worker_index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    task_available_.wait(lock, [this]() { return num_queued_tasks_.load() > 0; });
+  }
+}
+
+void WorkStealingScheduler::ParallelFor(int num_iterations, int max_concurrency, const LoopBody& body) {
+  if (num_iterations <= 0) {
+    return;
+  }
+  const int num_slots = max_concurrency > 0 ? max_concurrency : num_workers() + 1;
+  const int num_runners = std::min(num_slots, num_iterations);
+
+  // every runner finishes before this function returns, so they may reference its locals
+  std::atomic<int> next_iteration(0);
+  std::atomic<int> num_active_runners(num_runners);
+  // see MultistartOptimizer::MultistartOptimize() for the exception capture idiom
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+  auto runner = [&](int slot) {
+    // claim one iteration at a time so that uneven iteration costs balance across whichever runners are active
+    for (int i = next_iteration++; i < num_iterations; i = next_iteration++) {
+      try {
+        body(slot, i);
+      } catch (...) {
+        std::call_once(exception_capture_flag, [&captured_exception]() {
+            captured_exception = std::current_exception();
+          });
+      }
+    }
+    // last access to this frame's locals; under sleep_mutex_ so that the waiter below cannot miss the last one
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    if (--num_active_runners == 0) {
+      task_available_.notify_all();
+    }
+  };
+
+  for (int slot = 1; slot < num_runners; ++slot) {
+    Submit([&runner, slot]() { runner(slot); });
+  }
+  runner(0);
+
+  // help with queued tasks (this is what makes nested ParallelFor() calls safe); sleep, rather than spin, while
+  // there are none and runners are still active
+  while (true) {
+    if (TryRunOneTask(worker_index_of_this_thread)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    task_available_.wait(lock, [this, &num_active_runners]() {
+        return num_active_runners.load() == 0 || num_queued_tasks_.load() > 0;
+      });
+    if (num_active_runners.load() == 0) {
+      break;
+    }
+  }
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+}
+
+void ParallelForEachIndex(int max_num_threads, int num_iterations, const std::function<void(int)>& body) {
+  if (WorkStealingScheduler::OnWorkerThread()) {
+    WorkStealingScheduler::Instance().ParallelFor(num_iterations, 0, [&body](int, int i) { body(i); });
+    return;
+  }
+
+  // see MultistartOptimizer::MultistartOptimize() for why exceptions must be captured inside the parallel region
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+#pragma omp parallel for num_threads(max_num_threads) schedule(dynamic) if(max_num_threads > 1)
+  for (int i = 0; i < num_iterations; ++i) {
+    try {
+      body(i);
+    } catch (const std::exception&) {
+      std::call_once(exception_capture_flag, [&captured_exception]() {
+          captured_exception = std::current_exception();
+        });
+    }
+  }
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+}
+
+int NumThreadsForInnerLoops() noexcept {
+  return omp_in_parallel() ? 1 : omp_get_max_threads();
+}
+
+void ForEachOwningThread(int num_threads, const std::function<void(int)>& body) {
+  if (num_threads <= 1 || !ThreadPlacement::Instance().first_touch_states() || omp_in_parallel() ||
+      WorkStealingScheduler::OnWorkerThread()) {
+    for (int i = 0; i < num_threads; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  // see MultistartOptimizer::MultistartOptimize() for why exceptions must be captured inside the parallel region
+  std::once_flag exception_capture_flag;
+  std::exception_ptr captured_exception;
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    const int thread_id = omp_get_thread_num();
+    ThreadPlacement::Instance().PinCurrentThread(thread_id);
+    try {
+      body(thread_id);
+    } catch (const std::exception&) {
+      std::call_once(exception_capture_flag, [&captured_exception]() {
+          captured_exception = std::current_exception();
+        });
+    }
+  }
+
+  if (captured_exception != nullptr) {
+    std::rethrow_exception(captured_exception);
+  }
+}
+
+ThreadPlacement& ThreadPlacement::Instance() {
+  // never destroyed, like WorkStealingScheduler::Instance()
+  static ThreadPlacement * placement = new ThreadPlacement();
+  return *placement;
+}
+
+ThreadPlacement::ThreadPlacement() : first_touch_states_(true), pin_threads_(false) {
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) {
+        allowed_cpus_.push_back(cpu);
+      }
+    }
+  }
+#endif
+}
+
+void ThreadPlacement::PinCurrentThread(int thread_id) noexcept {
+  static thread_local bool pinned = false;
+  if (thread_id <= 0 || pinned || !pin_threads() || allowed_cpus_.empty()) {
+    return;
+  }
+  pinned = true;
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(allowed_cpus_[thread_id % allowed_cpus_.size()], &cpu_set);
+  // best effort: a failure (e.g., the CPU was since removed from our cpuset) leaves the thread unpinned
+  sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+}
+
+LoopScheduleTuner& LoopScheduleTuner::Instance() {
+  // never destroyed, like WorkStealingScheduler::Instance()
+  static LoopScheduleTuner * tuner = new LoopScheduleTuner();
+  return *tuner;
+}
+
+LoopScheduleTuner::LoopScheduleTuner() : autotune_by_default_(false) {
+}
+
+LoopCostProfile LoopScheduleTuner::ProfileIterations(double const * restrict iteration_seconds,
+                                                     int num_iterations) noexcept {
+  LoopCostProfile profile = {0.0, 0.0};
+  if (num_iterations <= 0) {
+    return profile;
+  }
+  for (int i = 0; i < num_iterations; ++i) {
+    profile.mean_seconds += iteration_seconds[i];
+  }
+  profile.mean_seconds /= static_cast<double>(num_iterations);
+  if (num_iterations > 1 && profile.mean_seconds > 0.0) {
+    double variance = 0.0;
+    for (int i = 0; i < num_iterations; ++i) {
+      variance += Square(iteration_seconds[i] - profile.mean_seconds);
+    }
+    variance /= static_cast<double>(num_iterations - 1);
+    profile.coefficient_of_variation = std::sqrt(variance)/profile.mean_seconds;
+  }
+  return profile;
+}
+
+TunedLoopSchedule LoopScheduleTuner::ChooseSchedule(const LoopCostProfile& profile, int num_iterations,
+                                                    int max_num_threads) noexcept {
+  const int total_threads = std::max(max_num_threads > 0 ? max_num_threads : omp_get_num_procs(), 1);
+  const double total_seconds = profile.mean_seconds*std::max(num_iterations, 0);
+  // compare in double: the ratio overflows int for long loops
+  const double useful_threads = std::floor(total_seconds/kMinSecondsPerThread);
+  TunedLoopSchedule tuned;
+  tuned.num_threads = static_cast<int>(std::max(std::min({useful_threads, static_cast<double>(total_threads),
+                                                          static_cast<double>(num_iterations)}), 1.0));
+
+  if (profile.coefficient_of_variation < kUniformCoefficientOfVariation) {
+    tuned.schedule = omp_sched_static;
+    tuned.chunk_size = 0;
+  } else if (profile.coefficient_of_variation > kHeavyTailedCoefficientOfVariation) {
+    tuned.schedule = omp_sched_dynamic;
+    const double iterations_per_chunk = profile.mean_seconds > 0.0 ?
+        std::ceil(kMinSecondsPerChunk/profile.mean_seconds) : static_cast<double>(num_iterations);
+    const int max_chunk_size = std::max(num_iterations/(4*tuned.num_threads), 1);
+    tuned.chunk_size = static_cast<int>(std::max(std::min(iterations_per_chunk, static_cast<double>(max_chunk_size)),
+                                                 1.0));
+  } else {
+    tuned.schedule = omp_sched_guided;
+    tuned.chunk_size = 1;
+  }
+  return tuned;
+}
+
+bool LoopScheduleTuner::Lookup(std::type_index loop_type, int problem_size, LoopCostProfile * profile) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto entry = profiles_.find(std::make_pair(loop_type, problem_size));
+  if (entry == profiles_.end()) {
+    return false;
+  }
+  *profile = entry->second;
+  return true;
+}
+
+void LoopScheduleTuner::Record(std::type_index loop_type, int problem_size, const LoopCostProfile& profile) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  profiles_[std::make_pair(loop_type, problem_size)] = profile;
+}
+
+void LoopScheduleTuner::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  profiles_.clear();
+}
+
+}  // end namespace optimal_learning
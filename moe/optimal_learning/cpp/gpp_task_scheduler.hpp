@@ -0,0 +1,393 @@
+/*!
+  \file gpp_task_scheduler.hpp
+  \rst
+  1. OVERVIEW
+  2. SCHEDULING
+  3. NESTING
+  4. SCHEDULE AUTOTUNING
+
+  **1. OVERVIEW**
+
+  optimal_learning parallelizes at several levels: multistarts (MultistartOptimizer::MultistartOptimize()), points of a
+  list (EvaluateEIAtPointList(), ...), and loops inside a single objective evaluation (the MC iterations of
+  KnowledgeGradientEvaluator, the hyperparameter samples of the MCMC evaluators).  With OpenMP, every one of these opens
+  its own ``#pragma omp parallel`` region sized by its own thread count, so nested levels either serialize (OpenMP's
+  default) or oversubscribe the machine, and concurrent calls (e.g., from several Python threads) each bring their own team.
+
+  WorkStealingScheduler is the alternative: ONE process-wide pool with a fixed number of workers that every level
+  submits tasks to.  ThreadSchedule selects it with ``ParallelBackend::kWorkStealing``; the OpenMP path is unchanged and
+  remains the default.
+
+  **2. SCHEDULING**
+
+  ParallelFor() runs ``body(slot, i)`` for every ``i`` in ``[0, num_iterations)``.  It submits one "runner" task per
+  slot (at most ``max_concurrency``), and each runner claims iterations ONE at a time from a shared counter.  So the
+  tail of a loop whose iterations vary in cost (multistarts often differ by 10x) is spread over every runner still
+  active, instead of waiting on a statically or chunk-assigned thread.  ``slot`` is in ``[0, max_concurrency)`` and no
+  two concurrently running iterations share a slot; it indexes per-thread state (e.g., ``objective_state_vector``)
+  exactly like ``omp_get_thread_num()`` does in the OpenMP path.
+
+  Each worker owns a deque: it pushes and pops its own tasks at the back (LIFO, cache-warm) and steals from the front
+  of the other workers' deques when its own is empty.  Threads that are not workers (the caller) push round-robin.
+
+  **3. NESTING**
+
+  The calling thread runs the first runner itself and then, until the loop is done, executes any queued task (its own
+  loop's runners or anyone else's) instead of blocking.  So a ParallelFor() issued from inside a task (e.g., the MC
+  loop of a KG evaluation inside a multistart) never deadlocks and never adds threads: the inner runners go to the
+  submitting worker's deque and idle workers steal them.  ParallelForEachIndex() is the entry point for such inner
+  loops: on a worker thread it submits to the pool, anywhere else it is a plain OpenMP loop, so existing OpenMP callers
+  see no change.
+
+  Iterations must not depend on the order or the thread they run on; every loop in the library reduces its results in
+  index order, so results do not depend on the backend.
+
+  **4. SCHEDULE AUTOTUNING**
+
+  The best OpenMP schedule depends on the loop: screening EI at thousands of points has cheap, uniform iterations
+  (static scheduling, few threads if the whole loop is short), while KG multistarts are expensive and heavy-tailed
+  (dynamic scheduling, one start per chunk).  With ``ThreadSchedule::autotune`` (or process-wide, see
+  LoopScheduleTuner::set_autotune_by_default()), MultistartOptimizer::MultistartOptimize() calibrates on the first
+  call for each (optimizer/evaluator type, problem size): that call runs with ``omp_sched_dynamic`` (safe for any cost
+  distribution) and times every iteration.  LoopScheduleTuner caches the resulting LoopCostProfile for the rest of the
+  process, and later calls use ChooseSchedule() to derive the schedule, chunk size, and thread count from it and their
+  own number of iterations.  Autotuning only changes which thread runs which iteration, so results do not change.
+
+  **5. THREAD PLACEMENT**
+
+  Linux places a page on the NUMA node of the thread that first writes it.  Per-thread states (EI, KG, log likelihood,
+  etc.) are large, and if the calling thread built all of them, every state would live on its node and the threads on
+  other sockets would read theirs remotely.  So ReuseOrConstructStates() (behind every Setup*State() helper) builds
+  state ``i`` on thread ``i`` of an OpenMP team of the same size (ForEachOwningThread()); OpenMP runtimes reuse their
+  pool, so that is the thread that later runs with ``omp_get_thread_num() == i``.  This only helps if threads stay on
+  their node: set ``OMP_PROC_BIND``/``OMP_PLACES`` or enable ThreadPlacement::pin_threads().  Both switches live in
+  ThreadPlacement; placement never changes results.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_HPP_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include <omp.h>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Enum for the threading backend of a ThreadSchedule.
+\endrst*/
+enum class ParallelBackend {
+  //! a ``#pragma omp parallel`` region per call, sized by ThreadSchedule::max_num_threads
+  kOpenMP = 0,
+  //! tasks on the shared WorkStealingScheduler; ThreadSchedule::max_num_threads bounds the concurrency of each loop
+  kWorkStealing = 1,
+};
+
+/*!\rst
+  Process-wide work-stealing thread pool; see the file comments.
+
+  The pool is created on first use with ``omp_get_num_procs()`` workers and lives until process exit (it is
+  intentionally never destroyed, so no worker is joined during static destruction, e.g., at Python interpreter shutdown).
+\endrst*/
+class WorkStealingScheduler final {
+ public:
+  //! signature of loop bodies: ``body(slot, iteration)``
+  using LoopBody = std::function<void(int, int)>;
+
+  /*!\rst
+    \return
+      the process-wide scheduler
+  \endrst*/
+  static WorkStealingScheduler& Instance();
+
+  /*!\rst
+    \return
+      true if the calling thread is one of this scheduler's workers (i.e., it is inside a task)
+  \endrst*/
+  static bool OnWorkerThread() noexcept OL_WARN_UNUSED_RESULT;
+
+  int num_workers() const noexcept OL_PURE_FUNCTION OL_WARN_UNUSED_RESULT {
+    return static_cast<int>(workers_.size());
+  }
+
+  /*!\rst
+    Runs ``body(slot, i)`` for ``i = 0, ..., num_iterations - 1``; blocks until all are done, executing queued tasks
+    meanwhile and sleeping (not spinning) when there are none.
+
+    \param
+      :num_iterations: number of loop iterations
+      :max_concurrency: number of slots (at most this many iterations run at once); ``<= 0`` means ``num_workers() + 1``
+      :body: loop body; ``slot`` is in ``[0, max_concurrency)``, never shared by two running iterations
+    \raise
+      if any ``body`` invocation throws, the first exception captured is rethrown after all iterations finish
+  \endrst*/
+  void ParallelFor(int num_iterations, int max_concurrency, const LoopBody& body);
+
+  OL_DISALLOW_COPY_AND_ASSIGN(WorkStealingScheduler);
+
+ private:
+  using Task = std::function<void()>;
+
+  //! a worker's deque of pending tasks
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  explicit WorkStealingScheduler(int num_workers);
+
+  //! queue a task: on the calling worker's own deque, else round-robin
+  void Submit(Task task);
+
+  //! pop a task from ``home_queue`` (back), else steal one from another queue (front); false if every queue is empty
+  bool TryRunOneTask(int home_queue);
+
+  //! body of each worker thread
+  void WorkerLoop(int worker_index);
+
+  //! one deque per worker
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  //! the workers
+  std::vector<std::thread> workers_;
+  //! number of queued (not yet started) tasks, across all queues
+  std::atomic<int> num_queued_tasks_;
+  //! round-robin cursor for tasks submitted from outside the pool
+  std::atomic<unsigned> next_queue_;
+  //! guards sleeping on ``task_available_``
+  std::mutex sleep_mutex_;
+  //! signaled when a task is queued and when the last runner of a ParallelFor() finishes
+  std::condition_variable task_available_;
+};
+
+/*!\rst
+  Runs ``body(i)`` for ``i = 0, ..., num_iterations - 1`` in parallel.  For loops nested inside other parallel work
+  (e.g., the iterations of one objective evaluation) whose iterations write disjoint outputs.
+
+  On a WorkStealingScheduler worker (i.e., inside a ``ParallelBackend::kWorkStealing`` multistart), the iterations are
+  submitted to the pool with its full width; ``max_num_threads`` is ignored since the pool already bounds the total.
+  Anywhere else this is ``#pragma omp parallel for num_threads(max_num_threads) schedule(dynamic)``.
+
+  \param
+    :max_num_threads: number of OpenMP threads; ``<= 1`` runs serially
+    :num_iterations: number of loop iterations
+    :body: loop body
+  \raise
+    if any ``body`` invocation throws, one of the exceptions (usually the first temporally) is rethrown after all
+    iterations finish
+\endrst*/
+void ParallelForEachIndex(int max_num_threads, int num_iterations, const std::function<void(int)>& body);
+
+/*!\rst
+  Thread count for ParallelForEachIndex() loops inside calls that take no thread count of their own (e.g., building and
+  factoring one GP's covariance matrix): ``omp_get_max_threads()`` when called from serial code, where the rest of the
+  machine is idle, and 1 inside an OpenMP parallel region, whose threads are already busy.
+
+  \return
+    ``max_num_threads`` for ParallelForEachIndex()
+\endrst*/
+int NumThreadsForInnerLoops() noexcept OL_WARN_UNUSED_RESULT;
+
+/*!\rst
+  Runs ``body(i)`` for ``i = 0, ..., num_threads - 1``, each on thread ``i`` of an OpenMP team of ``num_threads`` (pinned
+  first, see ThreadPlacement::PinCurrentThread()).  For first-touch construction of per-thread data; see the file
+  comments, section 5.
+
+  Runs serially on the calling thread if ThreadPlacement::first_touch_states() is off, ``num_threads <= 1``, or the
+  caller is already inside a parallel region or on a WorkStealingScheduler worker (which has no thread ``i``).
+
+  \param
+    :num_threads: number of threads (and ``body`` calls)
+    :body: function of the thread index
+  \raise
+    if any ``body`` invocation throws, one of the exceptions (usually the first temporally) is rethrown after all
+    invocations finish
+\endrst*/
+void ForEachOwningThread(int num_threads, const std::function<void(int)>& body);
+
+/*!\rst
+  Process-wide switches for where per-thread data and threads live; see the file comments, section 5.  Thread-safe.
+\endrst*/
+class ThreadPlacement final {
+ public:
+  /*!\rst
+    \return
+      the process-wide instance
+  \endrst*/
+  static ThreadPlacement& Instance();
+
+  //! true (the default) if ForEachOwningThread() runs in parallel, i.e., per-thread states are built by their threads
+  bool first_touch_states() const noexcept OL_WARN_UNUSED_RESULT {
+    return first_touch_states_.load();
+  }
+
+  void set_first_touch_states(bool first_touch) noexcept {
+    first_touch_states_.store(first_touch);
+  }
+
+  //! true if PinCurrentThread() pins; off by default, since ``OMP_PROC_BIND``/``OMP_PLACES`` are usually preferable
+  bool pin_threads() const noexcept OL_WARN_UNUSED_RESULT {
+    return pin_threads_.load();
+  }
+
+  void set_pin_threads(bool pin) noexcept {
+    pin_threads_.store(pin);
+  }
+
+  /*!\rst
+    If pin_threads(), pins the calling OpenMP worker thread to CPU ``thread_id % n`` of the ``n`` CPUs the process was
+    allowed to run on when this object was created.  Each OS thread is pinned at most once (later calls are a
+    thread-local check).  The master thread (``thread_id == 0``) is never pinned: it belongs to the caller (e.g., the
+    Python interpreter).  Does nothing on platforms without ``sched_setaffinity()``.
+
+    \param
+      :thread_id: the calling thread's ``omp_get_thread_num()``
+  \endrst*/
+  void PinCurrentThread(int thread_id) noexcept;
+
+  OL_DISALLOW_COPY_AND_ASSIGN(ThreadPlacement);
+
+ private:
+  ThreadPlacement();
+
+  //! see first_touch_states()
+  std::atomic<bool> first_touch_states_;
+  //! see pin_threads()
+  std::atomic<bool> pin_threads_;
+  //! CPUs in the process's affinity mask at construction, in increasing order
+  std::vector<int> allowed_cpus_;
+};
+
+/*!\rst
+  Wall time statistics of the iterations of one calibration run of a parallel loop; see LoopScheduleTuner.
+\endrst*/
+struct LoopCostProfile {
+  //! mean wall time of one iteration, in seconds
+  double mean_seconds;
+  //! standard deviation of the iteration wall times divided by their mean (0 for fewer than 2 iterations)
+  double coefficient_of_variation;
+};
+
+/*!\rst
+  An OpenMP schedule chosen by LoopScheduleTuner::ChooseSchedule().
+\endrst*/
+struct TunedLoopSchedule {
+  //! static, dynamic, or guided
+  omp_sched_t schedule;
+  //! chunk size for ``schedule``; 0 for OpenMP's default
+  int chunk_size;
+  //! number of threads, in ``[1, max_num_threads]``
+  int num_threads;
+};
+
+/*!\rst
+  Process-wide cache of the LoopCostProfile of each autotuned loop (see the file comments, section 4), keyed by the
+  loop's type (e.g., ``typeid(Optimizer)``, which identifies both the optimizer and the objective evaluator) and
+  problem size.  All member functions are thread-safe.
+\endrst*/
+class LoopScheduleTuner final {
+ public:
+  //! iterations with a coefficient of variation below this are "uniform": static scheduling wastes little
+  static constexpr double kUniformCoefficientOfVariation = 0.25;
+  //! iterations with a coefficient of variation above this are "heavy-tailed": only dynamic scheduling balances them
+  static constexpr double kHeavyTailedCoefficientOfVariation = 1.0;
+  //! minimum work (seconds) worth waking a thread for; shorter loops run on fewer threads
+  static constexpr double kMinSecondsPerThread = 1.0e-4;
+  //! minimum work (seconds) per dynamically scheduled chunk, so that chunk dispatch overhead stays negligible
+  static constexpr double kMinSecondsPerChunk = 2.0e-5;
+
+  /*!\rst
+    \return
+      the process-wide tuner
+  \endrst*/
+  static LoopScheduleTuner& Instance();
+
+  /*!\rst
+    \param
+      :iteration_seconds[num_iterations]: wall time of each iteration of a calibration run
+      :num_iterations: number of iterations
+    \return
+      the mean and coefficient of variation of ``iteration_seconds``
+  \endrst*/
+  static LoopCostProfile ProfileIterations(double const * restrict iteration_seconds,
+                                           int num_iterations) noexcept OL_NONNULL_POINTERS OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    Chooses a schedule for a loop of ``num_iterations`` iterations with the given cost profile:
+
+    * threads: enough that each gets at least kMinSecondsPerThread of work, at most ``max_num_threads``
+    * uniform iterations: ``omp_sched_static`` with the default (even) split; repeatable and lowest overhead
+    * heavy-tailed iterations: ``omp_sched_dynamic`` with chunks of at least kMinSecondsPerChunk (1 iteration for
+      expensive iterations), at most a quarter of each thread's share
+    * in between: ``omp_sched_guided`` with a minimum chunk of 1
+
+    \param
+      :profile: cost profile of the loop's iterations
+      :num_iterations: number of iterations of the loop to schedule
+      :max_num_threads: maximum number of threads; ``<= 0`` means ``omp_get_num_procs()``
+    \return
+      the chosen schedule
+  \endrst*/
+  static TunedLoopSchedule ChooseSchedule(const LoopCostProfile& profile, int num_iterations,
+                                          int max_num_threads) noexcept OL_WARN_UNUSED_RESULT;
+
+  /*!\rst
+    \param
+      :loop_type: type identifying the loop
+      :problem_size: problem size of the loop's iterations
+    \output
+      :profile[1]: cached profile of the loop, if any; unchanged otherwise
+    \return
+      true if the loop has been calibrated
+  \endrst*/
+  bool Lookup(std::type_index loop_type, int problem_size, LoopCostProfile * profile) const OL_NONNULL_POINTERS;
+
+  /*!\rst
+    Caches the profile of a calibration run (replacing any previous one).
+
+    \param
+      :loop_type: type identifying the loop
+      :problem_size: problem size of the loop's iterations
+      :profile: measured profile
+  \endrst*/
+  void Record(std::type_index loop_type, int problem_size, const LoopCostProfile& profile);
+
+  //! forgets every cached profile, so each loop recalibrates on its next autotuned call
+  void Reset();
+
+  //! true if every MultistartOptimize() call autotunes, regardless of ThreadSchedule::autotune
+  bool autotune_by_default() const noexcept OL_WARN_UNUSED_RESULT {
+    return autotune_by_default_.load();
+  }
+
+  void set_autotune_by_default(bool autotune) noexcept {
+    autotune_by_default_.store(autotune);
+  }
+
+  OL_DISALLOW_COPY_AND_ASSIGN(LoopScheduleTuner);
+
+ private:
+  LoopScheduleTuner();
+
+  //! guards ``profiles_``
+  mutable std::mutex mutex_;
+  //! profile of each calibrated (loop type, problem size)
+  std::map<std::pair<std::type_index, int>, LoopCostProfile> profiles_;
+  //! see autotune_by_default()
+  std::atomic<bool> autotune_by_default_;
+};
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_HPP_
@@ -0,0 +1,491 @@
+/*!
+  \file gpp_task_scheduler_test.cpp
+  \rst
+  Routines to test the functions in gpp_task_scheduler.cpp:
+
+  * WorkStealingScheduler::ParallelFor() runs every iteration exactly once, and no two concurrently running iterations
+    share a slot,
+  * ParallelFor() and ParallelForEachIndex() calls nested inside tasks complete (the waiting thread helps instead of
+    blocking) and cover their iterations,
+  * an exception thrown by one iteration is rethrown after the others finish,
+  * EvaluateEIAtPointList() (i.e., MultistartOptimizer with NullOptimizer) returns identical values and winners under
+    ``ParallelBackend::kOpenMP`` and ``ParallelBackend::kWorkStealing``,
+  * LoopScheduleTuner summarizes iteration times correctly and picks static/guided/dynamic scheduling for uniform,
+    moderately varying, and heavy-tailed iteration costs (and few threads for short loops),
+  * an autotuned EvaluateEIAtPointList() calibrates on its first call and returns the same values as an untuned one,
+  * ForEachOwningThread() runs index ``i`` on OpenMP thread ``i``, and ReuseOrConstructStates() builds each new state on
+    its own thread, in order, after the reused ones.
+\endrst*/
+
+#include "gpp_task_scheduler_test.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#include <boost/random/uniform_real.hpp>  // NOLINT(build/include_order)
+
+#include "gpp_common.hpp"
+#include "gpp_covariance.hpp"
+#include "gpp_logging.hpp"
+#include "gpp_math.hpp"
+#include "gpp_optimization.hpp"
+#include "gpp_random.hpp"
+#include "gpp_task_scheduler.hpp"
+#include "gpp_test_utils.hpp"
+
+namespace optimal_learning {
+
+namespace {
+
+/*!\rst
+  Checks coverage, slot exclusivity, nesting, and exception propagation of the scheduler's loops.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int WorkStealingParallelForTest() {
+  int total_errors = 0;
+  WorkStealingScheduler& scheduler = WorkStealingScheduler::Instance();
+  const int num_slots = 4;
+
+  // coverage and slot exclusivity
+  {
+    const int num_iterations = 1000;
+    std::vector<std::atomic<int>> visits(num_iterations);
+    std::vector<std::atomic<int>> slot_in_use(num_slots);
+    std::atomic<int> num_slot_errors(0);
+    for (auto& count : visits) {
+      count = 0;
+    }
+    for (auto& in_use : slot_in_use) {
+      in_use = 0;
+    }
+    scheduler.ParallelFor(num_iterations, num_slots, [&](int slot, int i) {
+        if (slot < 0 || slot >= num_slots || slot_in_use[slot]++ != 0) {
+          ++num_slot_errors;
+        }
+        ++visits[i];
+        if (slot >= 0 && slot < num_slots) {
+          --slot_in_use[slot];
+        }
+      });
+    total_errors += num_slot_errors;
+    for (auto& count : visits) {
+      if (count != 1) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // nesting: inner loops submitted from inside tasks, through both entry points
+  {
+    const int num_outer = 16;
+    const int num_inner = 200;
+    std::vector<std::atomic<int>> visits(num_outer*num_inner);
+    for (auto& count : visits) {
+      count = 0;
+    }
+    scheduler.ParallelFor(num_outer, num_slots, [&](int, int i) {
+        if (i % 2 == 0) {
+          WorkStealingScheduler::Instance().ParallelFor(num_inner, 0, [&](int, int j) {
+              ++visits[i*num_inner + j];
+            });
+        } else {
+          ParallelForEachIndex(1, num_inner, [&](int j) {
+              ++visits[i*num_inner + j];
+            });
+        }
+      });
+    for (auto& count : visits) {
+      if (count != 1) {
+        ++total_errors;
+      }
+    }
+  }
+
+  // exceptions: rethrown once every other iteration has run
+  {
+    const int num_iterations = 100;
+    std::atomic<int> num_visits(0);
+    bool caught = false;
+    try {
+      scheduler.ParallelFor(num_iterations, num_slots, [&](int, int i) {
+          ++num_visits;
+          if (i == 37) {
+            throw std::runtime_error("iteration 37");
+          }
+        });
+    } catch (const std::runtime_error&) {
+      caught = true;
+    }
+    if (!caught || num_visits != num_iterations) {
+      ++total_errors;
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Evaluates 1,0-EI (analytic) and 2,1-EI (MC; every thread's NormalRNG has the same seed, so values do not depend on
+  which thread evaluates which point) at a list of points with both backends; results must be identical.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int WorkStealingMultistartTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_points = 40;
+  const int max_num_threads = 4;
+  const int max_int_steps = 1000;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, 2, 1, num_sampled, 0);
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-2);
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                   num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  UniformRandomGenerator uniform_generator(31415);
+  boost::uniform_real<double> uniform_double(MockExpectedImprovementEnvironment::range_min,
+                                             MockExpectedImprovementEnvironment::range_max);
+  std::vector<double> points(2*dim*num_points);
+  for (auto& entry : points) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+
+  ThreadSchedule openmp_schedule(max_num_threads, omp_sched_dynamic);
+  ThreadSchedule work_stealing_schedule(max_num_threads, ParallelBackend::kWorkStealing);
+  for (int num_to_sample = 1; num_to_sample <= 2; ++num_to_sample) {
+    const int num_being_sampled = num_to_sample - 1;
+    const int num_multistarts = num_points/num_to_sample;
+    std::vector<NormalRNG> normal_rng_openmp(max_num_threads, NormalRNG(2718));
+    std::vector<NormalRNG> normal_rng_work_stealing(max_num_threads, NormalRNG(2718));
+    std::vector<double> function_values_openmp(num_multistarts);
+    std::vector<double> function_values_work_stealing(num_multistarts);
+    std::vector<double> best_point_openmp(dim*num_to_sample);
+    std::vector<double> best_point_work_stealing(dim*num_to_sample);
+    bool found_flag_openmp = false;
+    bool found_flag_work_stealing = false;
+
+    EvaluateEIAtPointList(gaussian_process, openmp_schedule, points.data(), EI_environment.points_being_sampled(),
+                          num_multistarts, num_to_sample, num_being_sampled, best_so_far, max_int_steps,
+                          &found_flag_openmp, normal_rng_openmp.data(), function_values_openmp.data(),
+                          best_point_openmp.data());
+    EvaluateEIAtPointList(gaussian_process, work_stealing_schedule, points.data(),
+                          EI_environment.points_being_sampled(), num_multistarts, num_to_sample, num_being_sampled,
+                          best_so_far, max_int_steps, &found_flag_work_stealing, normal_rng_work_stealing.data(),
+                          function_values_work_stealing.data(), best_point_work_stealing.data());
+
+    if (found_flag_openmp != found_flag_work_stealing) {
+      ++total_errors;
+    }
+    for (int i = 0; i < num_multistarts; ++i) {
+      if (!CheckDoubleWithin(function_values_work_stealing[i], function_values_openmp[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+    for (int i = 0; i < dim*num_to_sample; ++i) {
+      if (!CheckDoubleWithin(best_point_work_stealing[i], best_point_openmp[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Checks LoopScheduleTuner::ProfileIterations() on known data and the schedules ChooseSchedule() picks for
+  representative profiles.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int LoopScheduleChoiceTest() {
+  int total_errors = 0;
+  const double tolerance = 4.0*std::numeric_limits<double>::epsilon();
+
+  // mean 2.5, sample standard deviation sqrt(5/3)
+  const double iteration_seconds[] = {1.0, 2.0, 3.0, 4.0};
+  LoopCostProfile profile = LoopScheduleTuner::ProfileIterations(iteration_seconds, 4);
+  if (!CheckDoubleWithinRelative(profile.mean_seconds, 2.5, tolerance)) {
+    ++total_errors;
+  }
+  if (!CheckDoubleWithinRelative(profile.coefficient_of_variation, std::sqrt(5.0/3.0)/2.5, tolerance)) {
+    ++total_errors;
+  }
+  profile = LoopScheduleTuner::ProfileIterations(iteration_seconds, 1);
+  if (!CheckDoubleWithinRelative(profile.mean_seconds, 1.0, 0.0) || profile.coefficient_of_variation != 0.0) {
+    ++total_errors;
+  }
+
+  const int num_iterations = 1000;
+  const int max_num_threads = 8;
+  // uniform, expensive iterations: static, all threads
+  TunedLoopSchedule tuned = LoopScheduleTuner::ChooseSchedule({1.0e-3, 0.1}, num_iterations, max_num_threads);
+  if (tuned.schedule != omp_sched_static || tuned.num_threads != max_num_threads) {
+    ++total_errors;
+  }
+  // moderately varying: guided
+  tuned = LoopScheduleTuner::ChooseSchedule({1.0e-3, 0.5}, num_iterations, max_num_threads);
+  if (tuned.schedule != omp_sched_guided || tuned.chunk_size != 1) {
+    ++total_errors;
+  }
+  // heavy-tailed, expensive iterations: dynamic, one iteration per chunk
+  tuned = LoopScheduleTuner::ChooseSchedule({1.0e-3, 2.0}, num_iterations, max_num_threads);
+  if (tuned.schedule != omp_sched_dynamic || tuned.chunk_size != 1) {
+    ++total_errors;
+  }
+  // heavy-tailed, cheap iterations: dynamic, chunks of several iterations
+  tuned = LoopScheduleTuner::ChooseSchedule({1.0e-6, 2.0}, num_iterations, max_num_threads);
+  if (tuned.schedule != omp_sched_dynamic || tuned.chunk_size <= 1) {
+    ++total_errors;
+  }
+  // total work too small to split
+  tuned = LoopScheduleTuner::ChooseSchedule({1.0e-8, 0.1}, num_iterations, max_num_threads);
+  if (tuned.num_threads != 1) {
+    ++total_errors;
+  }
+  // never more threads than iterations
+  tuned = LoopScheduleTuner::ChooseSchedule({1.0, 0.1}, 3, max_num_threads);
+  if (tuned.num_threads != 3) {
+    ++total_errors;
+  }
+
+  return total_errors;
+}
+
+/*!\rst
+  Evaluates 2,0-EI (MC; every thread's NormalRNG has the same seed) at a list of points with and without autotuning: the
+  first autotuned call must record a calibration and all values and winners must be identical.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int AutotunedMultistartTest() {
+  int total_errors = 0;
+  const int dim = 3;
+  const int num_sampled = 20;
+  const int num_multistarts = 40;
+  const int num_to_sample = 2;
+  const int max_num_threads = 4;
+  const int max_int_steps = 1000;
+
+  MockExpectedImprovementEnvironment EI_environment;
+  EI_environment.Initialize(dim, num_to_sample, 0, num_sampled, 0);
+  const std::type_index loop_type(typeid(NullOptimizer<ExpectedImprovementEvaluator, DummyDomain>));
+  std::vector<double> lengths(dim, 0.9);
+  SquareExponential sqexp_covariance(dim, 1.3, lengths.data());
+  std::vector<double> noise_variance(1, 1.0e-2);
+  GaussianProcess gaussian_process(sqexp_covariance, EI_environment.points_sampled(),
+                                   EI_environment.points_sampled_value(), noise_variance.data(), nullptr, 0, dim,
+                                   num_sampled);
+  const double best_so_far = *std::min_element(EI_environment.points_sampled_value(),
+                                               EI_environment.points_sampled_value() + num_sampled);
+
+  UniformRandomGenerator uniform_generator(31415);
+  boost::uniform_real<double> uniform_double(MockExpectedImprovementEnvironment::range_min,
+                                             MockExpectedImprovementEnvironment::range_max);
+  std::vector<double> points(dim*num_to_sample*num_multistarts);
+  for (auto& entry : points) {
+    entry = uniform_double(uniform_generator.engine);
+  }
+
+  LoopScheduleTuner& tuner = LoopScheduleTuner::Instance();
+  tuner.Reset();
+  ThreadSchedule fixed_schedule(max_num_threads, omp_sched_static);
+  ThreadSchedule autotuned_schedule = ThreadSchedule::Autotuned(max_num_threads);
+  std::vector<NormalRNG> normal_rng_fixed(max_num_threads, NormalRNG(2718));
+  std::vector<double> function_values_fixed(num_multistarts);
+  std::vector<double> best_point_fixed(dim*num_to_sample);
+  bool found_flag_fixed = false;
+  EvaluateEIAtPointList(gaussian_process, fixed_schedule, points.data(), nullptr, num_multistarts, num_to_sample, 0,
+                        best_so_far, max_int_steps, &found_flag_fixed, normal_rng_fixed.data(),
+                        function_values_fixed.data(), best_point_fixed.data());
+  // only autotuned loops calibrate
+  LoopCostProfile profile;
+  if (tuner.Lookup(loop_type, dim*num_to_sample, &profile)) {
+    ++total_errors;
+  }
+
+  // first call calibrates, second uses the calibration
+  for (int call = 0; call < 2; ++call) {
+    std::vector<NormalRNG> normal_rng(max_num_threads, NormalRNG(2718));
+    std::vector<double> function_values(num_multistarts);
+    std::vector<double> best_point(dim*num_to_sample);
+    bool found_flag = false;
+    EvaluateEIAtPointList(gaussian_process, autotuned_schedule, points.data(), nullptr, num_multistarts,
+                          num_to_sample, 0, best_so_far, max_int_steps, &found_flag, normal_rng.data(),
+                          function_values.data(), best_point.data());
+    if (!tuner.Lookup(loop_type, dim*num_to_sample, &profile) || !(profile.mean_seconds > 0.0)) {
+      ++total_errors;
+    }
+
+    if (found_flag != found_flag_fixed) {
+      ++total_errors;
+    }
+    for (int i = 0; i < num_multistarts; ++i) {
+      if (!CheckDoubleWithin(function_values[i], function_values_fixed[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+    for (int i = 0; i < dim*num_to_sample; ++i) {
+      if (!CheckDoubleWithin(best_point[i], best_point_fixed[i], 0.0)) {
+        ++total_errors;
+      }
+    }
+  }
+  tuner.Reset();
+
+  return total_errors;
+}
+
+
+/*!\rst
+  State recording which thread constructed it; for FirstTouchStateTest().
+\endrst*/
+struct ThreadRecordingState {
+  ThreadRecordingState(int index_in, int constructing_thread_in)
+      : index(index_in), constructing_thread(constructing_thread_in), buffer(1000, static_cast<double>(index_in)) {
+  }
+
+  ThreadRecordingState(ThreadRecordingState&& OL_UNUSED(other)) = default;
+
+  //! state index
+  int index;
+  //! ``omp_get_thread_num()`` of the constructing thread
+  int constructing_thread;
+  //! stands in for a state's buffers; must survive moves
+  std::vector<double> buffer;
+
+  OL_DISALLOW_DEFAULT_AND_COPY_AND_ASSIGN(ThreadRecordingState);
+};
+
+/*!\rst
+  Checks that ForEachOwningThread() runs each index on the matching OpenMP thread (serially if first touch is off) and
+  that ReuseOrConstructStates() keeps reused states and builds the new ones on their own threads.
+
+  \return
+    number of test failures
+\endrst*/
+OL_WARN_UNUSED_RESULT int FirstTouchStateTest() {
+  int total_errors = 0;
+  const int num_threads = 4;
+  ThreadPlacement& placement = ThreadPlacement::Instance();
+  const bool first_touch_init = placement.first_touch_states();
+
+  placement.set_first_touch_states(true);
+  std::vector<int> thread_of_index(num_threads, -1);
+  ForEachOwningThread(num_threads, [&thread_of_index](int i) {
+      thread_of_index[i] = omp_get_thread_num();
+    });
+  for (int i = 0; i < num_threads; ++i) {
+    if (thread_of_index[i] != i) {
+      ++total_errors;
+    }
+  }
+
+  // exceptions reach the caller
+  bool caught = false;
+  try {
+    ForEachOwningThread(num_threads, [](int i) {
+        if (i == 2) {
+          throw std::runtime_error("expected");
+        }
+      });
+  } catch (const std::runtime_error&) {
+    caught = true;
+  }
+  if (!caught) {
+    ++total_errors;
+  }
+
+  // 1 reused state (index 0 accepts reconfiguration), 3 rebuilt
+  for (int first_touch = 0; first_touch < 2; ++first_touch) {
+    placement.set_first_touch_states(first_touch != 0);
+    std::vector<ThreadRecordingState> states;
+    states.emplace_back(0, -1);
+    states.emplace_back(1, -1);
+    ReuseOrConstructStates(num_threads, [](ThreadRecordingState * OL_UNUSED(state), int i) {
+        return i == 0;
+      }, [](std::vector<ThreadRecordingState> * new_states, int i) {
+        new_states->emplace_back(i, omp_get_thread_num());
+      }, &states);
+
+    if (static_cast<int>(states.size()) != num_threads || states[0].constructing_thread != -1) {
+      ++total_errors;
+      continue;
+    }
+    for (int i = 0; i < num_threads; ++i) {
+      if (states[i].index != i || states[i].buffer.size() != 1000 || states[i].buffer[999] != i) {
+        ++total_errors;
+      }
+      if (i > 0 && states[i].constructing_thread != (first_touch ? i : 0)) {
+        ++total_errors;
+      }
+    }
+  }
+
+  placement.set_first_touch_states(first_touch_init);
+  return total_errors;
+}
+
+}  // end unnamed namespace
+
+int RunTaskSchedulerTests() {
+  int total_errors = 0;
+  int current_errors = 0;
+
+  current_errors = WorkStealingParallelForTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("work stealing ParallelFor failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = WorkStealingMultistartTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("work stealing multistart failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = LoopScheduleChoiceTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("loop schedule choice failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = AutotunedMultistartTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("autotuned multistart failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  current_errors = FirstTouchStateTest();
+  if (current_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("first touch states failed with %d errors\n", current_errors);
+  }
+  total_errors += current_errors;
+
+  if (total_errors != 0) {
+    OL_PARTIAL_FAILURE_PRINTF("task scheduler tests failed with %d errors\n", total_errors);
+  } else {
+    OL_PARTIAL_SUCCESS_PRINTF("task scheduler tests passed\n");
+  }
+  return total_errors;
+}
+
+}  // end namespace optimal_learning
@@ -0,0 +1,26 @@
+/*!
+  \file gpp_task_scheduler_test.hpp
+  \rst
+  Functions for testing gpp_task_scheduler's functionality: coverage and slot exclusivity of
+  WorkStealingScheduler::ParallelFor(), nested submission, exception propagation, and agreement of
+  ``ParallelBackend::kWorkStealing`` multistarts with the OpenMP backend.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_TEST_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_TEST_HPP_
+
+#include "gpp_common.hpp"
+
+namespace optimal_learning {
+
+/*!\rst
+  Runs the task scheduler tests.
+
+  \return
+    number of test failures: 0 if the task scheduler is working properly
+\endrst*/
+OL_WARN_UNUSED_RESULT int RunTaskSchedulerTests();
+
+}  // end namespace optimal_learning
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPP_TASK_SCHEDULER_TEST_HPP_
@@ -0,0 +1,324 @@
+/*!
+  \file gpp_cuda_math.cu
+  \rst
+  CUDA kernels and their host-side launchers; see gpp_cuda_math.hpp for the interface.
+
+  Each monte-carlo iteration (for KG: each antithetic pair) initializes its own Philox generator with
+  ``curand_init(seed, iteration, 0, &state)``. Philox skips to a subsequence in O(1), so this is cheap, and the draws
+  for a given seed depend only on the iteration index, not on how iterations are spread over device threads.
+
+  Matrices follow the library's column-major conventions: ``L(j, i) = chol_var[j + i*num_union]``, and
+  ``grad_chol_var[d + dim*(i + num_union*(j + num_union*k))] = \pderiv{L(j, i)}{Xs_{k,d}}``.
+\endrst*/
+
+#include "gpp_cuda_math.hpp"
+
+#include <cuda_runtime.h>
+#include <curand_kernel.h>
+
+#include <vector>
+
+namespace {
+
+#define OL_CUDA_STRINGIFY_EXPANSION_INNER(x) #x
+#define OL_CUDA_STRINGIFY_EXPANSION(x) OL_CUDA_STRINGIFY_EXPANSION_INNER(x)
+#define OL_CUDA_STRINGIFY_FILE_AND_LINE "(" __FILE__ ": " OL_CUDA_STRINGIFY_EXPANSION(__LINE__) ")"
+
+/*!\rst
+  Evaluates the cuda call ``X``; on failure, returns a CudaError describing it from the enclosing function.
+\endrst*/
+#define OL_CUDA_ERROR_RETURN(X) do {                                          \
+    cudaError_t _error_code = (X);                                            \
+    if (_error_code != cudaSuccess) {                                         \
+      CudaError _error = {static_cast<int>(_error_code), OL_CUDA_STRINGIFY_FILE_AND_LINE, __func__}; \
+      return _error;                                                          \
+    }                                                                         \
+  } while (0)
+
+CudaError CudaSuccess() {
+  CudaError success = {static_cast<int>(cudaSuccess), "", ""};
+  return success;
+}
+
+//! threads per block for the EI kernels; must divide kCudaEINumThreads
+const int kEIThreadsPerBlock = 256;
+//! threads per block for the KG kernels
+const int kKGThreadsPerBlock = 128;
+
+/*!\rst
+  Draws the normals of monte-carlo iteration ``mc`` into ``normals[0:num_union]``.
+\endrst*/
+__device__ void DrawNormals(uint64_t seed, int mc, int num_union, double * __restrict__ normals) {
+  curandStatePhilox4_32_10_t state;
+  curand_init(seed, mc, 0, &state);
+  for (int i = 0; i < num_union; ++i) {
+    normals[i] = curand_normal_double(&state);
+  }
+}
+
+/*!\rst
+  Computes ``\mu + L * normals`` and returns the improvement ``max(0, best - min_j y_j)``; writes the index of the
+  minimizing ``j`` to ``winner`` (-1 if the improvement is 0).
+\endrst*/
+__device__ double ImprovementThisStep(double const * __restrict__ chol_var, double const * __restrict__ mu,
+                                      double const * __restrict__ normals, int num_union, double best,
+                                      int * __restrict__ winner) {
+  double improvement = 0.0;
+  *winner = -1;
+  for (int j = 0; j < num_union; ++j) {
+    double y = mu[j];
+    for (int i = 0; i <= j; ++i) {
+      y += chol_var[j + i*num_union]*normals[i];
+    }
+    if (best - y > improvement) {
+      improvement = best - y;
+      *winner = j;
+    }
+  }
+  return improvement;
+}
+
+__global__ void CudaComputeEIGpu(double const * __restrict__ chol_var, double const * __restrict__ mu, int num_union,
+                                 int num_mc, uint64_t seed, double best, int configure_for_test,
+                                 double * __restrict__ random_number_ei, double * __restrict__ ei_storage) {
+  const int thread_id = blockIdx.x*blockDim.x + threadIdx.x;
+  const int num_threads = gridDim.x*blockDim.x;
+  double normals[kCudaMaxNumUnion];
+  double aggregate = 0.0;
+  for (int mc = thread_id; mc < num_mc; mc += num_threads) {
+    DrawNormals(seed, mc, num_union, normals);
+    if (configure_for_test) {
+      for (int i = 0; i < num_union; ++i) {
+        random_number_ei[mc*num_union + i] = normals[i];
+      }
+    }
+    int winner;
+    aggregate += ImprovementThisStep(chol_var, mu, normals, num_union, best, &winner);
+  }
+  ei_storage[thread_id] = aggregate;
+}
+
+__global__ void CudaComputeGradEIGpu(double const * __restrict__ mu, double const * __restrict__ grad_mu,
+                                     double const * __restrict__ chol_var, double const * __restrict__ grad_chol_var,
+                                     int num_union, int num_to_sample, int dim, int num_mc, uint64_t seed, double best,
+                                     int configure_for_test, double * __restrict__ random_number_grad_ei,
+                                     double * __restrict__ grad_ei_storage) {
+  const int thread_id = blockIdx.x*blockDim.x + threadIdx.x;
+  const int num_threads = gridDim.x*blockDim.x;
+  double * __restrict__ grad_ei = grad_ei_storage + thread_id*dim*num_to_sample;
+  for (int k = 0; k < dim*num_to_sample; ++k) {
+    grad_ei[k] = 0.0;
+  }
+
+  double normals[kCudaMaxNumUnion];
+  for (int mc = thread_id; mc < num_mc; mc += num_threads) {
+    DrawNormals(seed, mc, num_union, normals);
+    if (configure_for_test) {
+      for (int i = 0; i < num_union; ++i) {
+        random_number_grad_ei[mc*num_union + i] = normals[i];
+      }
+    }
+    int winner;
+    const double improvement = ImprovementThisStep(chol_var, mu, normals, num_union, best, &winner);
+    if (improvement > 0.0) {
+      // grad_mu only holds d mu_i / d Xs_i; see SumMonteCarloGradImprovement() in gpp_math.cpp
+      if (winner < num_to_sample) {
+        for (int d = 0; d < dim; ++d) {
+          grad_ei[winner*dim + d] -= grad_mu[winner*dim + d];
+        }
+      }
+      for (int k = 0; k < num_to_sample; ++k) {
+        double const * __restrict__ grad_chol_winner = grad_chol_var + dim*num_union*(winner + num_union*k);
+        for (int i = 0; i <= winner; ++i) {
+          for (int d = 0; d < dim; ++d) {
+            grad_ei[k*dim + d] -= grad_chol_winner[d + i*dim]*normals[i];
+          }
+        }
+      }
+    }
+  }
+}
+
+__global__ void CudaComputeKnowledgeGradientNormalsGpu(int num_normals, int num_mc, uint64_t seed,
+                                                       double * __restrict__ normals) {
+  const int pair = blockIdx.x*blockDim.x + threadIdx.x;
+  const int mc = 2*pair;
+  if (mc >= num_mc) {
+    return;
+  }
+  curandStatePhilox4_32_10_t state;
+  curand_init(seed, pair, 0, &state);
+  const bool has_antithetic = mc + 1 < num_mc;
+  for (int k = 0; k < num_normals; ++k) {
+    const double normal = curand_normal_double(&state);
+    normals[mc*num_normals + k] = normal;
+    if (has_antithetic) {
+      normals[(mc + 1)*num_normals + k] = -normal;
+    }
+  }
+}
+
+__global__ void CudaComputeDiscreteFutureMeanWinnersGpu(double const * __restrict__ chol_inverse_cov,
+                                                        double const * __restrict__ discrete_mean,
+                                                        double const * __restrict__ normals, int num_normals,
+                                                        int num_discrete, int num_mc,
+                                                        double * __restrict__ best_value,
+                                                        int * __restrict__ winner) {
+  const int mc = blockIdx.x*blockDim.x + threadIdx.x;
+  if (mc >= num_mc) {
+    return;
+  }
+  double const * __restrict__ normals_this_step = normals + mc*num_normals;
+  int best_index = 0;
+  double best_future_mean = 0.0;
+  for (int j = 0; j < num_discrete; ++j) {
+    double future_mean = discrete_mean[j];
+    for (int k = 0; k < num_normals; ++k) {
+      future_mean += chol_inverse_cov[k + j*num_normals]*normals_this_step[k];
+    }
+    if (j == 0 || future_mean < best_future_mean) {
+      best_future_mean = future_mean;
+      best_index = j;
+    }
+  }
+  best_value[mc] = -best_future_mean;
+  winner[mc] = best_index;
+}
+
+int NumBlocks(int num_work_items, int threads_per_block) {
+  return (num_work_items + threads_per_block - 1)/threads_per_block;
+}
+
+}  // end unnamed namespace
+
+extern "C" char const * CudaGetErrorString(int err) {
+  return cudaGetErrorString(static_cast<cudaError_t>(err));
+}
+
+extern "C" CudaError CudaGetEI(double const * mu, double const * chol_var, int num_union, int num_mc, uint64_t seed,
+                               double best, int configure_for_test, double * gpu_mu, double * gpu_chol_var,
+                               double * random_number_ei, double * gpu_random_number_ei, double * gpu_ei_storage,
+                               double * ei_val) {
+  if (num_union > kCudaMaxNumUnion) {
+    OL_CUDA_ERROR_RETURN(cudaErrorInvalidValue);
+  }
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_mu, mu, num_union*sizeof(double), cudaMemcpyHostToDevice));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_chol_var, chol_var, num_union*num_union*sizeof(double), cudaMemcpyHostToDevice));
+
+  CudaComputeEIGpu<<<kCudaEINumThreads/kEIThreadsPerBlock, kEIThreadsPerBlock>>>(
+      gpu_chol_var, gpu_mu, num_union, num_mc, seed, best, configure_for_test, gpu_random_number_ei, gpu_ei_storage);
+  OL_CUDA_ERROR_RETURN(cudaPeekAtLastError());
+
+  // cudaMemcpy waits for the kernel
+  std::vector<double> ei_storage(kCudaEINumThreads);
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(ei_storage.data(), gpu_ei_storage, kCudaEINumThreads*sizeof(double),
+                                  cudaMemcpyDeviceToHost));
+  double aggregate = 0.0;
+  for (int i = 0; i < kCudaEINumThreads; ++i) {
+    aggregate += ei_storage[i];
+  }
+  *ei_val = aggregate/static_cast<double>(num_mc);
+
+  if (configure_for_test) {
+    OL_CUDA_ERROR_RETURN(cudaMemcpy(random_number_ei, gpu_random_number_ei, num_union*num_mc*sizeof(double),
+                                    cudaMemcpyDeviceToHost));
+  }
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaGetGradEI(double const * mu, double const * grad_mu, double const * chol_var,
+                                   double const * grad_chol_var, int num_union, int num_to_sample, int dim, int num_mc,
+                                   uint64_t seed, double best, int configure_for_test, double * gpu_mu,
+                                   double * gpu_grad_mu, double * gpu_chol_var, double * gpu_grad_chol_var,
+                                   double * random_number_grad_ei, double * gpu_random_number_grad_ei,
+                                   double * gpu_grad_ei_storage, double * grad_ei) {
+  if (num_union > kCudaMaxNumUnion) {
+    OL_CUDA_ERROR_RETURN(cudaErrorInvalidValue);
+  }
+  const int num_grad_entries = dim*num_to_sample;
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_mu, mu, num_union*sizeof(double), cudaMemcpyHostToDevice));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_grad_mu, grad_mu, num_grad_entries*sizeof(double), cudaMemcpyHostToDevice));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_chol_var, chol_var, num_union*num_union*sizeof(double), cudaMemcpyHostToDevice));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_grad_chol_var, grad_chol_var,
+                                  num_union*num_union*num_grad_entries*sizeof(double), cudaMemcpyHostToDevice));
+
+  CudaComputeGradEIGpu<<<kCudaEINumThreads/kEIThreadsPerBlock, kEIThreadsPerBlock>>>(
+      gpu_mu, gpu_grad_mu, gpu_chol_var, gpu_grad_chol_var, num_union, num_to_sample, dim, num_mc, seed, best,
+      configure_for_test, gpu_random_number_grad_ei, gpu_grad_ei_storage);
+  OL_CUDA_ERROR_RETURN(cudaPeekAtLastError());
+
+  std::vector<double> grad_ei_storage(num_grad_entries*kCudaEINumThreads);
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(grad_ei_storage.data(), gpu_grad_ei_storage,
+                                  grad_ei_storage.size()*sizeof(double), cudaMemcpyDeviceToHost));
+  for (int k = 0; k < num_grad_entries; ++k) {
+    grad_ei[k] = 0.0;
+  }
+  for (int i = 0; i < kCudaEINumThreads; ++i) {
+    for (int k = 0; k < num_grad_entries; ++k) {
+      grad_ei[k] += grad_ei_storage[i*num_grad_entries + k];
+    }
+  }
+  for (int k = 0; k < num_grad_entries; ++k) {
+    grad_ei[k] /= static_cast<double>(num_mc);
+  }
+
+  if (configure_for_test) {
+    OL_CUDA_ERROR_RETURN(cudaMemcpy(random_number_grad_ei, gpu_random_number_grad_ei,
+                                    num_union*num_mc*sizeof(double), cudaMemcpyDeviceToHost));
+  }
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaGetKnowledgeGradientNormals(int num_normals, int num_mc, uint64_t seed, double * gpu_normals,
+                                                     double * normals) {
+  const int num_pairs = (num_mc + 1)/2;
+  if (num_pairs > 0) {
+    CudaComputeKnowledgeGradientNormalsGpu<<<NumBlocks(num_pairs, kKGThreadsPerBlock), kKGThreadsPerBlock>>>(
+        num_normals, num_mc, seed, gpu_normals);
+    OL_CUDA_ERROR_RETURN(cudaPeekAtLastError());
+  }
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(normals, gpu_normals, num_normals*num_mc*sizeof(double), cudaMemcpyDeviceToHost));
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaGetDiscreteFutureMeanWinners(double const * chol_inverse_cov, double const * discrete_mean,
+                                                      int num_normals, int num_discrete, int num_mc,
+                                                      double const * gpu_normals, double * gpu_chol_inverse_cov,
+                                                      double * gpu_discrete_mean, double * gpu_best_value,
+                                                      int * gpu_winner, double * best_value, int * winner) {
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_chol_inverse_cov, chol_inverse_cov, num_normals*num_discrete*sizeof(double),
+                                  cudaMemcpyHostToDevice));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(gpu_discrete_mean, discrete_mean, num_discrete*sizeof(double),
+                                  cudaMemcpyHostToDevice));
+  if (num_mc > 0) {
+    CudaComputeDiscreteFutureMeanWinnersGpu<<<NumBlocks(num_mc, kKGThreadsPerBlock), kKGThreadsPerBlock>>>(
+        gpu_chol_inverse_cov, gpu_discrete_mean, gpu_normals, num_normals, num_discrete, num_mc, gpu_best_value,
+        gpu_winner);
+    OL_CUDA_ERROR_RETURN(cudaPeekAtLastError());
+  }
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(best_value, gpu_best_value, num_mc*sizeof(double), cudaMemcpyDeviceToHost));
+  OL_CUDA_ERROR_RETURN(cudaMemcpy(winner, gpu_winner, num_mc*sizeof(int), cudaMemcpyDeviceToHost));
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaMallocDeviceMemory(size_t size, void ** address_of_ptr_to_gpu_memory) {
+  OL_CUDA_ERROR_RETURN(cudaMalloc(address_of_ptr_to_gpu_memory, size));
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaFreeDeviceMemory(void * ptr_to_gpu_memory) {
+  OL_CUDA_ERROR_RETURN(cudaFree(ptr_to_gpu_memory));
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaSetDevice(int devID) {
+  OL_CUDA_ERROR_RETURN(cudaSetDevice(devID));
+  // cudaSetDevice does not create a context; force it now so later failures point at the real culprit
+  OL_CUDA_ERROR_RETURN(cudaFree(0));
+  return CudaSuccess();
+}
+
+extern "C" CudaError CudaGetDeviceCount(int * num_devices) {
+  OL_CUDA_ERROR_RETURN(cudaGetDeviceCount(num_devices));
+  return CudaSuccess();
+}
@@ -0,0 +1,163 @@
+/*!
+  \file gpp_cuda_math.hpp
+  \rst
+  This file contains the C-linkage entry points into the CUDA kernels (``gpp_cuda_math.cu``) used by the GPU
+  evaluators in ``gpp_expected_improvement_gpu.hpp`` and ``gpp_knowledge_gradient_gpu.hpp``:
+
+  1. q,p-EI and its gradient via monte-carlo: each device thread draws its own normals (cuRAND Philox), forms
+     ``\mu + L * normals``, and accumulates the improvement (and its gradient); the host sums the per-thread results.
+  2. The KG normals: all ``num_mc`` draws at once, in antithetic pairs (odd iterations negate the preceding draw),
+     the same layout the CPU path produces.
+  3. The KG discrete step: for every monte-carlo iteration, the future posterior mean on the discrete set
+     ``\mu_n(D) + (L^{-1} \Sigma_n(U, D))^T z`` and its minimum (winner), one device thread per iteration.
+
+  This header deliberately uses no CUDA types, so it can be included by translation units built with the host
+  compiler; cuda error codes travel as ``int`` (a ``cudaError_t``). Matrices are column-major, as in the rest of the
+  library. All device pointers passed in must have been allocated with CudaMallocDeviceMemory() and be large enough
+  for the documented sizes.
+
+  The device normals are keyed by ``seed`` and by the monte-carlo iteration (or antithetic pair) index, so for a fixed
+  seed the draws do not depend on the launch configuration.
+\endrst*/
+
+#ifndef MOE_OPTIMAL_LEARNING_CPP_GPU_GPP_CUDA_MATH_HPP_
+#define MOE_OPTIMAL_LEARNING_CPP_GPU_GPP_CUDA_MATH_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!\rst
+  Status of a call into the CUDA layer: ``err`` is a ``cudaError_t`` (``0 == cudaSuccess``); on failure the other
+  fields locate the failing CUDA call.
+\endrst*/
+struct CudaError {
+  //! the cudaError_t returned by the failing call, 0 (cudaSuccess) otherwise
+  int err;
+  //! file and line of the failing call
+  char const * file_and_line_info;
+  //! name of the function containing the failing call
+  char const * func_info;
+};
+
+//! number of device threads used by the EI kernels (per-thread partial sums are reduced on the host)
+static const int kCudaEINumThreads = 4096;
+//! largest ``num_union`` the EI kernels accept (each device thread keeps one iteration's normals in registers/local memory)
+static const int kCudaMaxNumUnion = 64;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\rst
+  \return
+    description of a cuda error code (cudaGetErrorString())
+\endrst*/
+char const * CudaGetErrorString(int err);
+
+/*!\rst
+  Computes q,p-EI by monte-carlo on the device. Fails with ``cudaErrorInvalidValue`` if ``num_union > kCudaMaxNumUnion``.
+
+  \param
+    :mu[num_union]: GP mean at union_of_points
+    :chol_var[num_union][num_union]: cholesky factor (lower triangle) of the GP variance at union_of_points
+    :num_union: number of points in union_of_points
+    :num_mc: number of monte-carlo iterations
+    :seed: seed for the device normals
+    :best: best (minimum) objective function value so far
+    :configure_for_test: true to copy the normals used back to ``random_number_ei``
+    :gpu_mu[num_union], gpu_chol_var[num_union][num_union]: device scratch
+    :gpu_random_number_ei[num_union][num_mc]: device scratch (only used if configure_for_test)
+    :gpu_ei_storage[kCudaEINumThreads]: device scratch
+  \output
+    :random_number_ei[num_union][num_mc]: normals used, in iteration order (only written if configure_for_test)
+    :ei_val[1]: the EI estimate
+\endrst*/
+struct CudaError CudaGetEI(double const * mu, double const * chol_var, int num_union, int num_mc, uint64_t seed,
+                           double best, int configure_for_test, double * gpu_mu, double * gpu_chol_var,
+                           double * random_number_ei, double * gpu_random_number_ei, double * gpu_ei_storage,
+                           double * ei_val);
+
+/*!\rst
+  Computes the gradient of q,p-EI wrt points_to_sample by monte-carlo on the device.
+
+  \param
+    :mu[num_union], chol_var[num_union][num_union]: as in CudaGetEI()
+    :grad_mu[dim][num_to_sample]: gradient of the GP mean; only ``d mu_i / d Xs_i`` (see ExpectedImprovementState)
+    :grad_chol_var[dim][num_union][num_union][num_to_sample]: gradient of the cholesky factor
+    :num_union, num_to_sample, dim, num_mc, seed, best, configure_for_test: see CudaGetEI()
+    :gpu_*: device scratch of the same sizes as the matching host arrays;
+      ``gpu_grad_ei_storage[dim][num_to_sample][kCudaEINumThreads]``
+  \output
+    :random_number_grad_ei[num_union][num_mc]: normals used (only written if configure_for_test)
+    :grad_ei[dim][num_to_sample]: the gradient estimate
+\endrst*/
+struct CudaError CudaGetGradEI(double const * mu, double const * grad_mu, double const * chol_var,
+                               double const * grad_chol_var, int num_union, int num_to_sample, int dim, int num_mc,
+                               uint64_t seed, double best, int configure_for_test, double * gpu_mu,
+                               double * gpu_grad_mu, double * gpu_chol_var, double * gpu_grad_chol_var,
+                               double * random_number_grad_ei, double * gpu_random_number_grad_ei,
+                               double * gpu_grad_ei_storage, double * grad_ei);
+
+/*!\rst
+  Draws the KG normals for all monte-carlo iterations: iteration ``2m`` gets fresh normals and iteration ``2m + 1``
+  their negation. The normals stay on the device (for CudaGetDiscreteFutureMeanWinners()) and are copied to the host.
+
+  \param
+    :num_normals: number of normals per iteration
+    :num_mc: number of monte-carlo iterations
+    :seed: seed for the device normals
+    :gpu_normals[num_normals][num_mc]: device storage
+  \output
+    :gpu_normals[num_normals][num_mc]: the normals
+    :normals[num_normals][num_mc]: copy of the normals
+\endrst*/
+struct CudaError CudaGetKnowledgeGradientNormals(int num_normals, int num_mc, uint64_t seed, double * gpu_normals,
+                                                 double * normals);
+
+/*!\rst
+  For each monte-carlo iteration ``i``, minimizes the future posterior mean
+  ``discrete_mean[j] + \sum_k chol_inverse_cov[k][j] * normals[k][i]`` over the discrete points ``j``.
+  Ties go to the lowest index.
+
+  \param
+    :chol_inverse_cov[num_normals][num_discrete]: ``L^{-1} \Sigma_n(U, D)``
+    :discrete_mean[num_discrete]: ``\mu_n(D)``
+    :num_normals, num_discrete, num_mc: sizes
+    :gpu_normals[num_normals][num_mc]: device normals from CudaGetKnowledgeGradientNormals()
+    :gpu_*: device scratch of the same sizes as the matching host arrays
+  \output
+    :best_value[num_mc]: ``-min_j`` future posterior mean (the inner problem maximizes the negated mean)
+    :winner[num_mc]: minimizing index ``j``
+\endrst*/
+struct CudaError CudaGetDiscreteFutureMeanWinners(double const * chol_inverse_cov, double const * discrete_mean,
+                                                  int num_normals, int num_discrete, int num_mc,
+                                                  double const * gpu_normals, double * gpu_chol_inverse_cov,
+                                                  double * gpu_discrete_mean, double * gpu_best_value,
+                                                  int * gpu_winner, double * best_value, int * winner);
+
+/*!\rst
+  Allocates ``size`` bytes of device memory.
+\endrst*/
+struct CudaError CudaMallocDeviceMemory(size_t size, void ** address_of_ptr_to_gpu_memory);
+
+/*!\rst
+  Frees device memory from CudaMallocDeviceMemory(); nullptr is a no-op.
+\endrst*/
+struct CudaError CudaFreeDeviceMemory(void * ptr_to_gpu_memory);
+
+/*!\rst
+  Selects the device used by subsequent calls from the calling host thread.
+\endrst*/
+struct CudaError CudaSetDevice(int devID);
+
+/*!\rst
+  \output
+    :num_devices[1]: number of CUDA devices visible
+\endrst*/
+struct CudaError CudaGetDeviceCount(int * num_devices);
+
+#ifdef __cplusplus
+}  // end extern "C"
+#endif
+
+#endif  // MOE_OPTIMAL_LEARNING_CPP_GPU_GPP_CUDA_MATH_HPP_
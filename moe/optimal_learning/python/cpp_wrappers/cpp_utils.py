@@ -4,17 +4,18 @@ import numpy
 
 
 def cppify(array):
-    """Flatten a numpy array and copies it to a list for C++ consumption.
+    """Flatten a numpy array into a C-contiguous array for C++ consumption.
 
-    TODO(GH-159): This function will be unnecessary when C++ accepts numpy arrays.
+    C++ reads C-contiguous float64 (and native int) arrays through the buffer protocol without per-element conversion,
+    so no copy is made when ``array`` is already C-contiguous. Lists are still accepted by C++, but are much slower.
 
     :param array: array to convert
     :type array: array-like (e.g., ndarray, list, etc.) of float64
-    :return: list copied from flattened array
-    :rtype: list
+    :return: flattened view (or copy, if ``array`` is not C-contiguous) of array
+    :rtype: 1d ndarray
 
     """
-    return list(numpy.ravel(array))
+    return numpy.ascontiguousarray(numpy.ravel(array))
 
 
 def uncppify(array, expected_shape):
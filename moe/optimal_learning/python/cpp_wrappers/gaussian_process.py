@@ -12,6 +12,7 @@ import numpy
 
 import moe.build.GPP as C_GP
 import moe.optimal_learning.python.cpp_wrappers.cpp_utils as cpp_utils
+from moe.optimal_learning.python.constant import DEFAULT_MAX_NUM_THREADS
 from moe.optimal_learning.python.interfaces.gaussian_process_interface import GaussianProcessInterface
 
 
@@ -232,6 +233,32 @@ class GaussianProcess(GaussianProcessInterface):
         )
         return cpp_utils.uncppify(variance, (num_to_sample*(1 + self._num_derivatives), num_to_sample*(1 + self._num_derivatives)))
 
+    def predict_marginals(self, points_to_sample, max_num_threads=DEFAULT_MAX_NUM_THREADS):
+        r"""Compute the mean and the marginal variance of this GP at each point of ``Xs`` (``points_to_sample``).
+
+        Equivalent to ``compute_mean_of_points`` and the diagonal of ``compute_variance_of_points``, but the joint
+        covariance is never formed, so this scales to large candidate sets. ``points_to_sample`` may contain duplicates.
+
+        :param points_to_sample: num_to_sample points (in dim dimensions) at which to make predictions
+        :type points_to_sample: array of float64 with shape (num_to_sample, dim)
+        :param max_num_threads: maximum number of threads to use, >= 1
+        :type max_num_threads: int > 0
+        :return: (mean, variance): where mean[i] and variance[i] are the GP mean and variance at points_to_sample[i]
+        :rtype: tuple of two arrays of float64 with shape (num_to_sample)
+
+        """
+        num_to_sample = points_to_sample.shape[0]
+        mean = numpy.empty(num_to_sample)
+        variance = numpy.empty(num_to_sample)
+        self._gaussian_process.predict_marginals(
+            cpp_utils.cppify(points_to_sample),
+            num_to_sample,
+            max_num_threads,
+            mean,
+            variance,
+        )
+        return mean, variance
+
     def compute_cholesky_variance_of_points(self, points_to_sample):
         r"""Compute the cholesky factorization of the variance (matrix) of this GP at each point of ``Xs`` (``points_to_sample``).
 
@@ -338,6 +365,25 @@ class GaussianProcess(GaussianProcessInterface):
             num_to_add,
         )
 
+    def set_hyperparameters(self, hyperparameters, noise_variance):
+        r"""Replace the covariance hyperparameters and noise variance, keeping the C++ GP (and its historical data) alive.
+
+        Cheaper than constructing a new GaussianProcess: the training data is not re-sent to C++ and the covariance
+        matrix is refactored once.
+
+        :param hyperparameters: new covariance hyperparameters; ordering must match ``self._covariance.hyperparameters``
+        :type hyperparameters: array of float64 with shape (num_hyperparameters)
+        :param noise_variance: new noise variance of the function value and each observed derivative
+        :type noise_variance: array of float64 with shape (num_derivatives + 1)
+
+        """
+        self._covariance.hyperparameters = hyperparameters
+        self._noise_variance = copy.deepcopy(noise_variance)
+        self._gaussian_process.set_hyperparameters(
+            cpp_utils.cppify_hyperparameters(self._covariance.hyperparameters),
+            cpp_utils.cppify(self._noise_variance),
+        )
+
     def sample_point_from_gp(self, point_to_sample, noise_variance=0.0):
         r"""Sample a function value from a Gaussian Process prior, provided a point at which to sample.
 
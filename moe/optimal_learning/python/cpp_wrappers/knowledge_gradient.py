@@ -43,19 +43,12 @@ def posterior_mean_optimization(
 
     If ``num_to_sample = 1``, this is the same as ComputeOptimalPointsToSampleWithRandomStarts().
 
-    The option of using GPU to compute general q,p-EI via MC simulation is also available. To enable it, make sure you have
-    installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     :param kg_optimizer: object that optimizes (e.g., gradient descent, newton) EI over a domain
     :type kg_optimizer: cpp_wrappers.optimization.*Optimizer object
     :param num_multistarts: number of times to multistart ``ei_optimizer`` (UNUSED, data is in ei_optimizer.optimizer_parameters)
     :type num_multistarts: int > 0
     :param num_to_sample: how many simultaneous experiments you would like to run (i.e., the q in q,p-EI)
     :type num_to_sample: int >= 1
-    :param use_gpu: set to True if user wants to use GPU for MC simulation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness: RNGs used by C++ to generate initial guesses and as the source of normal random numbers when monte-carlo is used
     :type randomness: RandomnessSourceContainer (C++ object; e.g., from C_GP.RandomnessSourceContainer())
     :param max_num_threads: maximum number of threads to use, >= 1
@@ -252,19 +245,12 @@ def multistart_knowledge_gradient_optimization(
 
     If ``num_to_sample = 1``, this is the same as ComputeOptimalPointsToSampleWithRandomStarts().
 
-    The option of using GPU to compute general q,p-EI via MC simulation is also available. To enable it, make sure you have
-    installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     :param kg_optimizer: object that optimizes (e.g., gradient descent, newton) EI over a domain
     :type kg_optimizer: cpp_wrappers.optimization.*Optimizer object
     :param num_multistarts: number of times to multistart ``ei_optimizer`` (UNUSED, data is in ei_optimizer.optimizer_parameters)
     :type num_multistarts: int > 0
     :param num_to_sample: how many simultaneous experiments you would like to run (i.e., the q in q,p-EI)
     :type num_to_sample: int >= 1
-    :param use_gpu: set to True if user wants to use GPU for MC simulation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness: RNGs used by C++ to generate initial guesses and as the source of normal random numbers when monte-carlo is used
     :type randomness: RandomnessSourceContainer (C++ object; e.g., from C_GP.RandomnessSourceContainer())
     :param max_num_threads: maximum number of threads to use, >= 1
@@ -331,6 +317,8 @@ class KnowledgeGradient(OptimizableInterface):
             points_being_sampled=None,
             num_mc_iterations=DEFAULT_EXPECTED_IMPROVEMENT_MC_ITERATIONS,
             randomness=None,
+            use_gpu=False,
+            which_gpu=0,
     ):
         """Construct a KnowledgeGradient object that supports q,p-KG.
         TODO(GH-56): Allow callers to pass in a source of randomness.
@@ -348,9 +336,15 @@ class KnowledgeGradient(OptimizableInterface):
         :type num_mc_iterations: int > 0
         :param randomness: random source(s) used for monte-carlo integration (when applicable) (UNUSED)
         :type randomness: (UNUSED)
+        :param use_gpu: set to True to draw the monte-carlo normals of compute_knowledge_gradient and its gradient on a GPU
+        :type use_gpu: bool
+        :param which_gpu: GPU device ID
+        :type which_gpu: int >= 0
         """
         self._num_mc_iterations = num_mc_iterations
         self._gaussian_process = gaussian_process
+        self._use_gpu = use_gpu
+        self._which_gpu = which_gpu
         self._num_fidelity = num_fidelity
         self._inner_optimizer = inner_optimizer
 
@@ -541,6 +535,8 @@ class KnowledgeGradient(OptimizableInterface):
             self._num_mc_iterations,
             self._best_so_far,
             self._randomness,
+            self._use_gpu,
+            self._which_gpu,
         )
 
     compute_objective_function = compute_knowledge_gradient
@@ -586,6 +582,8 @@ class KnowledgeGradient(OptimizableInterface):
             self._num_mc_iterations,
             self._best_so_far,
             self._randomness,
+            self._use_gpu,
+            self._which_gpu,
         )
         return cpp_utils.uncppify(grad_kg, (self.num_to_sample, self.dim))
 
@@ -240,6 +240,42 @@ class GaussianProcessMCMC(object):
         """
         return copy.deepcopy(self._historical_data)
 
+    def add_sampled_points(self, sampled_points):
+        r"""Add sampled point(s) (point, value, noise) to the prior data of every GP.
+
+        The C++ GPs are updated in place (incrementally), so evaluators built later see the new data.
+
+        :param sampled_points: :class:`moe.optimal_learning.python.SamplePoint` objects to load
+          into the GPs (containing point, function value, and noise variance)
+        :type sampled_points: list of :class:`~moe.optimal_learning.python.SamplePoint` objects (or SamplePoint-like iterables)
+
+        """
+        num_sampled_prev = self.num_sampled
+        num_to_add = len(sampled_points)
+        self._historical_data.append_sample_points(sampled_points)
+
+        self._gaussian_process_mcmc.add_sampled_points(
+            cpp_utils.cppify(self._historical_data.points_sampled[num_sampled_prev:, ...]),
+            cpp_utils.cppify(self._historical_data.points_sampled_value[num_sampled_prev:]),
+            num_to_add,
+        )
+
+    def set_hyperparameters(self, hyperparameters_list, noise_variance_list):
+        r"""Replace the hyperparameter samples, keeping the C++ GPs (and their historical data) alive.
+
+        :param hyperparameters_list: covariance hyperparameters of each sample; the number of samples cannot change
+        :type hyperparameters_list: array of float64 with shape (num_mcmc, dim + 1)
+        :param noise_variance_list: noise variances of each sample
+        :type noise_variance_list: array of float64 with shape (num_mcmc, num_derivatives + 1)
+
+        """
+        self._hyperparameters_list = copy.deepcopy(hyperparameters_list)
+        self._noise_variance_list = copy.deepcopy(noise_variance_list)
+        self._gaussian_process_mcmc.set_hyperparameters(
+            cpp_utils.cppify(self._hyperparameters_list),
+            cpp_utils.cppify(self._noise_variance_list),
+        )
+
 def multistart_knowledge_gradient_mcmc_optimization(
         kg_optimizer,
         inner_optimizer,
@@ -271,19 +307,12 @@ def multistart_knowledge_gradient_mcmc_optimization(
 
     If ``num_to_sample = 1``, this is the same as ComputeOptimalPointsToSampleWithRandomStarts().
 
-    The option of using GPU to compute general q,p-EI via MC simulation is also available. To enable it, make sure you have
-    installed GPU components of MOE, otherwise, it will throw Runtime excpetion.
-
     :param kg_optimizer: object that optimizes (e.g., gradient descent, newton) EI over a domain
     :type kg_optimizer: cpp_wrappers.optimization.*Optimizer object
     :param num_multistarts: number of times to multistart ``ei_optimizer`` (UNUSED, data is in ei_optimizer.optimizer_parameters)
     :type num_multistarts: int > 0
     :param num_to_sample: how many simultaneous experiments you would like to run (i.e., the q in q,p-EI)
     :type num_to_sample: int >= 1
-    :param use_gpu: set to True if user wants to use GPU for MC simulation
-    :type use_gpu: bool
-    :param which_gpu: GPU device ID
-    :type which_gpu: int >= 0
     :param randomness: RNGs used by C++ to generate initial guesses and as the source of normal random numbers when monte-carlo is used
     :type randomness: RandomnessSourceContainer (C++ object; e.g., from C_GP.RandomnessSourceContainer())
     :param max_num_threads: maximum number of threads to use, >= 1
@@ -352,6 +381,8 @@ class KnowledgeGradientMCMC(OptimizableInterface):
             points_being_sampled=None,
             num_mc_iterations=DEFAULT_EXPECTED_IMPROVEMENT_MC_ITERATIONS,
             randomness=None,
+            use_gpu=False,
+            which_gpu=0,
     ):
         """Construct a KnowledgeGradient object that supports q,p-KG.
         TODO(GH-56): Allow callers to pass in a source of randomness.
@@ -369,9 +400,15 @@ class KnowledgeGradientMCMC(OptimizableInterface):
         :type num_mc_iterations: int > 0
         :param randomness: random source(s) used for monte-carlo integration (when applicable) (UNUSED)
         :type randomness: (UNUSED)
+        :param use_gpu: set to True to draw the monte-carlo normals of compute_knowledge_gradient and its gradient on a GPU
+        :type use_gpu: bool
+        :param which_gpu: GPU device ID
+        :type which_gpu: int >= 0
         """
         self._num_mc_iterations = num_mc_iterations
         self._gaussian_process_mcmc = gaussian_process_mcmc
+        self._use_gpu = use_gpu
+        self._which_gpu = which_gpu
         self._gaussian_process_list = gaussian_process_list
         self._num_fidelity = num_fidelity
         self._num_to_sample = num_to_sample
@@ -562,6 +599,8 @@ class KnowledgeGradientMCMC(OptimizableInterface):
             self._num_mc_iterations,
             cpp_utils.cppify(self._best_so_far_list),
             self._randomness,
+            self._use_gpu,
+            self._which_gpu,
         )
         return knowledge_gradient_mcmc
 
@@ -608,6 +647,8 @@ class KnowledgeGradientMCMC(OptimizableInterface):
             self._num_mc_iterations,
             cpp_utils.cppify(self._best_so_far_list),
             self._randomness,
+            self._use_gpu,
+            self._which_gpu,
         )
         return grad_knowledge_gradient_mcmc
 
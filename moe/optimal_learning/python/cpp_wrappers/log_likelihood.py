@@ -225,6 +225,44 @@ def evaluate_log_likelihood_at_hyperparameter_list(
     return numpy.array(log_likelihood_list)
 
 
+def evaluate_log_likelihood_of_ensemble(
+        log_likelihood_evaluator,
+        hyperparameter_ensemble,
+        max_num_threads=DEFAULT_MAX_NUM_THREADS,
+):
+    """Compute the specified log likelihood measure at every walker of an ensemble (e.g., one step of emcee).
+
+    Unlike :func:`evaluate_log_likelihood_at_hyperparameter_list`, walkers with a non-positive hyperparameter or a
+    non-finite log likelihood get ``-inf`` instead of aborting the call, so the result can be handed to an ensemble
+    sampler directly (e.g., as a vectorized log probability).
+
+    Calls into evaluate_log_likelihood_of_ensemble() in cpp/GPP_python_model_selection.cpp.
+
+    :param log_likelihood_evaluator: object specifying which log likelihood measure to evaluate (and the training data)
+    :type log_likelihood_evaluator: cpp_wrappers.log_likelihood.LogLikelihood
+    :param hyperparameter_ensemble: hyperparameters (linear space) of each walker
+    :type hyperparameter_ensemble: array of float64 with shape (num_walkers, log_likelihood_evaluator.num_hyperparameters)
+    :param max_num_threads: maximum number of threads to use, >= 1
+    :type max_num_threads: int > 0
+    :return: log likelihood value of each walker
+    :rtype: array of float64 with shape (hyperparameter_ensemble.shape[0])
+
+    """
+    log_likelihood_list = C_GP.evaluate_log_likelihood_of_ensemble(
+        cpp_utils.cppify(hyperparameter_ensemble),
+        cpp_utils.cppify(log_likelihood_evaluator._points_sampled),
+        cpp_utils.cppify(log_likelihood_evaluator._points_sampled_value),
+        log_likelihood_evaluator.dim,
+        log_likelihood_evaluator._num_sampled,
+        log_likelihood_evaluator.objective_type,
+        cpp_utils.cppify(log_likelihood_evaluator.derivatives),
+        log_likelihood_evaluator.num_derivatives,
+        hyperparameter_ensemble.shape[0],
+        max_num_threads,
+    )
+    return numpy.array(log_likelihood_list)
+
+
 class GaussianProcessLogLikelihood(GaussianProcessLogLikelihoodInterface, OptimizableInterface):
 
     r"""Class for computing log likelihood-like measures of model fit via C++ wrappers (currently log marginal and leave one out cross validation).
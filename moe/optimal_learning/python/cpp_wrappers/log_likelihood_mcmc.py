@@ -58,10 +58,12 @@ import emcee
 from scipy import optimize
 
 import moe.build.GPP as C_GP
+from moe.optimal_learning.python.constant import DEFAULT_MAX_NUM_THREADS
 from moe.optimal_learning.python.cpp_wrappers import cpp_utils
 from moe.optimal_learning.python.cpp_wrappers.covariance import SquareExponential
 from moe.optimal_learning.python.cpp_wrappers.gaussian_process import GaussianProcess
 from moe.optimal_learning.python.cpp_wrappers.knowledge_gradient_mcmc import GaussianProcessMCMC
+from moe.optimal_learning.python.default_priors import DefaultPrior
 
 class GaussianProcessLogLikelihoodMCMC:
 
@@ -183,33 +185,13 @@ class GaussianProcessLogLikelihoodMCMC:
         """
 
         if do_optimize:
-          # We have one walker for each hyperparameter configuration
-          sampler = emcee.EnsembleSampler(self.n_chains, 1 + self.dim + self._num_derivatives + 1,
-                                            self.compute_log_likelihood)
-
-          # Do a burn-in in the first iteration
-          if not self.burned:
-            # Initialize the walkers by sampling from the prior
-            if self.prior is None:
-                self.p0 = numpy.random.rand(self.n_chains, 1 + self.dim + self._num_derivatives + 1)
-            else:
-                self.p0 = self.prior.sample_from_prior(self.n_chains)
-            # Run MCMC sampling
-            self.p0, _, _ = sampler.run_mcmc(self.p0, self.burnin_steps,
-                                             rstate0=self.rng)
-
-            self.burned = True
-
-          # Start sampling
-          pos, _, _ = sampler.run_mcmc(self.p0, self.chain_length,
-                                       rstate0=self.rng)
-
-          # Save the current position, it will be the start point in
-          # the next iteration
-          self.p0 = pos
-
-          # Take the last samples from each walker
-          self.hypers = sampler.chain[numpy.random.choice(self.n_chains, self.n_hypers), -1]
+          # The native sampler (gpp_hyperparameter_mcmc.hpp) hard-codes the log marginal likelihood and DefaultPrior's
+          # form; other objectives and priors (or no prior) go through emcee and compute_log_likelihood
+          if (self.objective_type == C_GP.LogLikelihoodTypes.log_marginal_likelihood and
+                  isinstance(self.prior, DefaultPrior)):
+            self._slice_sample_hypers(kwargs.get('max_num_threads', 1))
+          else:
+            self._emcee_sample_hypers()
 
         self.is_trained = True
         self._models = []
@@ -236,6 +218,81 @@ class GaussianProcessLogLikelihoodMCMC:
         self._gaussian_process_mcmc = GaussianProcessMCMC(numpy.array(hypers_list), numpy.array(noises_list),
                                                           self._historical_data, self.derivatives)
 
+    def _slice_sample_hypers(self, max_num_threads):
+        """Sample self.hypers with the native slice sampler; requires the log marginal likelihood and a DefaultPrior."""
+        num_hyperparameters = 1 + self.dim + self._num_derivatives + 1
+        prior_parameters = [self.prior.ln_prior.mean, self.prior.ln_prior.sigma, self.prior.tophat.min,
+                            self.prior.tophat.max, self.prior.horseshoe.scale]
+        randomness = C_GP.RandomnessSourceContainer(max_num_threads)
+        randomness.SetExplicitUniformGeneratorSeed(self.rng.randint(0, 2**31 - 1))
+
+        # Do a burn-in (from prior draws) in the first iteration; afterward, continue from the current positions
+        if not self.burned:
+          self.p0 = numpy.zeros((self.n_chains, num_hyperparameters))
+          burnin_steps = self.burnin_steps
+          initialize_from_prior = True
+        else:
+          burnin_steps = 0
+          initialize_from_prior = False
+        if not self.noisy:
+          self.p0[:, (self.dim+1):] = numpy.log(1.e-8)
+
+        sampler_parameters = C_GP.SliceSamplerParameters(burnin_steps, self.chain_length, 1.0, 20)
+        positions, _, _ = C_GP.slice_sample_hyperparameters(
+            cpp_utils.cppify(self.p0),
+            cpp_utils.cppify(self._points_sampled),
+            cpp_utils.cppify(self._points_sampled_value),
+            self.dim,
+            self._num_sampled,
+            cpp_utils.cppify(self.derivatives),
+            self._num_derivatives,
+            prior_parameters,
+            sampler_parameters,
+            self.n_chains,
+            self.noisy,
+            initialize_from_prior,
+            max_num_threads,
+            randomness,
+        )
+        self.burned = True
+
+        # Save the current position, it will be the start point in
+        # the next iteration
+        self.p0 = numpy.array(positions).reshape(self.n_chains, num_hyperparameters)
+
+        # Take the last samples from each chain
+        self.hypers = self.p0[self.rng.choice(self.n_chains, self.n_hypers)]
+
+    def _emcee_sample_hypers(self):
+        """Sample self.hypers with emcee, for any objective_type and prior (``None``: no prior term)."""
+        # We have one walker for each hyperparameter configuration
+        sampler = emcee.EnsembleSampler(self.n_chains, 1 + self.dim + self._num_derivatives + 1,
+                                        self.compute_log_likelihood)
+
+        # Do a burn-in in the first iteration
+        if not self.burned:
+          # Initialize the walkers by sampling from the prior
+          if self.prior is None:
+              self.p0 = numpy.random.rand(self.n_chains, 1 + self.dim + self._num_derivatives + 1)
+          else:
+              self.p0 = self.prior.sample_from_prior(self.n_chains)
+          # Run MCMC sampling
+          self.p0, _, _ = sampler.run_mcmc(self.p0, self.burnin_steps,
+                                           rstate0=self.rng)
+
+          self.burned = True
+
+        # Start sampling
+        pos, _, _ = sampler.run_mcmc(self.p0, self.chain_length,
+                                     rstate0=self.rng)
+
+        # Save the current position, it will be the start point in
+        # the next iteration
+        self.p0 = pos
+
+        # Take the last samples from each walker
+        self.hypers = sampler.chain[numpy.random.choice(self.n_chains, self.n_hypers), -1]
+
     def optimize(self, do_optimize=True, **kwargs):
 
         if self.prior is None:
@@ -309,6 +366,49 @@ class GaussianProcessLogLikelihoodMCMC:
                     )
             return val
 
+    def compute_log_likelihood_of_ensemble(self, ensemble, max_num_threads=DEFAULT_MAX_NUM_THREADS):
+        r"""Vectorized :meth:`compute_log_likelihood`: the log posterior of every walker of an ensemble.
+
+        The likelihoods are evaluated in one multithreaded C++ call (see evaluate_log_likelihood_of_ensemble() in
+        gpp_python_model_selection.cpp) instead of one call per walker, e.g., for emcee's ``vectorize=True``.
+
+        :param ensemble: log hyperparameters of each walker (covariance hyperparameters, then noise variances)
+        :type ensemble: array of float64 with shape (num_walkers, dim + 1 + num_derivatives + 1)
+        :param max_num_threads: maximum number of threads to use, >= 1
+        :type max_num_threads: int > 0
+        :return: value of log_likelihood (plus log prior, if any) of each walker; ``-inf`` outside the support
+        :rtype: array of float64 with shape (num_walkers, )
+
+        """
+        ensemble = numpy.array(ensemble, dtype=numpy.float64, ndmin=2)
+        if not self.noisy:
+          ensemble[:, (self.dim+1):] = numpy.log(1.e-8)
+
+        # Bound the hyperparameter space to keep things sane (see compute_log_likelihood)
+        in_bounds = numpy.all((-20 <= ensemble) * (ensemble <= 20), axis=1)
+        posterior = numpy.ones(ensemble.shape[0])
+        if self.prior is not None:
+          posterior = numpy.array([self.prior.lnprob(walker) if ok else -numpy.inf
+                                   for walker, ok in zip(ensemble, in_bounds)])
+        valid = in_bounds * (posterior > -numpy.inf)
+
+        result = numpy.full(ensemble.shape[0], -numpy.inf)
+        if numpy.any(valid):
+          log_likelihood = C_GP.evaluate_log_likelihood_of_ensemble(
+              cpp_utils.cppify(numpy.exp(ensemble[valid])),
+              cpp_utils.cppify(self._points_sampled),
+              cpp_utils.cppify(self._points_sampled_value),
+              self.dim,
+              self._num_sampled,
+              self.objective_type,
+              cpp_utils.cppify(self._derivatives),
+              self._num_derivatives,
+              int(numpy.count_nonzero(valid)),
+              max_num_threads,
+          )
+          result[valid] = posterior[valid] + numpy.array(log_likelihood)
+        return result
+
     def nll(self, hyps):
         result = self.compute_log_likelihood(hyps)
         return -result
@@ -10,6 +10,10 @@ See gpp_knowledge_gradient_optimization.hpp/cpp for further details on knowledge
 """
 import numpy
 
+import moe.build.GPP as C_GP
+from moe.optimal_learning.python.constant import DEFAULT_MAX_NUM_THREADS
+import moe.optimal_learning.python.cpp_wrappers.cpp_utils as cpp_utils
+from moe.optimal_learning.python.cpp_wrappers.optimization import _CppOptimizerParameters
 from moe.optimal_learning.python.data_containers import SamplePoint
 
 
@@ -78,3 +82,107 @@ def lower_confidence_bound_optimization(
 
     return results, 0.0
 
+
+
+def _lcb_cpp_optimizer_parameters(domain, optimizer_parameters):
+    """Build the _CppOptimizerParameters that the C++ LCB optimizers read domain_type and optimizer_parameters from."""
+    return _CppOptimizerParameters(
+        domain_type=domain._domain_type,
+        optimizer_type=C_GP.OptimizerTypes.gradient_descent,
+        optimizer_parameters=optimizer_parameters,
+    )
+
+
+def multistart_lower_confidence_bound_optimization(
+        gaussian_process,
+        domain,
+        optimizer_parameters,
+        exploration_weight,
+        num_refined_starts=4,
+        randomness=None,
+        max_num_threads=DEFAULT_MAX_NUM_THREADS,
+        status=None,
+):
+    r"""Minimize ``LCB(x) = \mu(x) - \beta \sigma(x)`` over ``domain`` entirely in C++ (see gpp_lower_confidence_bound.hpp).
+
+    ``optimizer_parameters.num_multistarts`` uniform start points are screened and gradient descent runs from the
+    ``num_refined_starts`` best of them, using the analytic gradient of LCB.
+
+    :param gaussian_process: GaussianProcess to compute LCB on
+    :type gaussian_process: cpp_wrappers.gaussian_process.GaussianProcess
+    :param domain: domain to optimize over
+    :type domain: cpp_wrappers.domain.TensorProductDomain or SimplexIntersectTensorProductDomain
+    :param optimizer_parameters: gradient descent settings
+    :type optimizer_parameters: C_GP.GradientDescentParameters
+    :param exploration_weight: ``\beta``, the number of standard deviations subtracted from the mean
+    :type exploration_weight: float64 >= 0.0
+    :param num_refined_starts: number of screened start points to run gradient descent from
+    :type num_refined_starts: int >= 1
+    :param randomness: RNGs used by C++ to generate start points
+    :type randomness: RandomnessSourceContainer (C++ object; e.g., from C_GP.RandomnessSourceContainer())
+    :param max_num_threads: maximum number of threads to use, >= 1
+    :type max_num_threads: int > 0
+    :param status: (output) status messages from C++ (e.g., reporting on optimizer success, etc.)
+    :type status: dict
+    :return: point that minimizes LCB
+    :rtype: array of float64 with shape (dim, )
+
+    """
+    if randomness is None:
+        randomness = C_GP.RandomnessSourceContainer(max_num_threads)
+        randomness.SetRandomizedUniformGeneratorSeed(0)
+
+    # status must be an initialized dict for the call to C++.
+    if status is None:
+        status = {}
+
+    best_point_to_sample = C_GP.multistart_lower_confidence_bound_optimization(
+        _lcb_cpp_optimizer_parameters(domain, optimizer_parameters),
+        gaussian_process._gaussian_process,
+        cpp_utils.cppify(domain.domain_bounds),
+        exploration_weight,
+        num_refined_starts,
+        max_num_threads,
+        randomness,
+        status,
+    )
+    return numpy.array(best_point_to_sample)
+
+
+def multistart_lower_confidence_bound_mcmc_optimization(
+        gaussian_process_mcmc,
+        domain,
+        optimizer_parameters,
+        exploration_weight,
+        num_refined_starts=4,
+        randomness=None,
+        max_num_threads=DEFAULT_MAX_NUM_THREADS,
+        status=None,
+):
+    r"""Minimize LCB averaged over hyperparameter samples; see :func:`multistart_lower_confidence_bound_optimization`.
+
+    :param gaussian_process_mcmc: GaussianProcessMCMC to compute LCB on
+    :type gaussian_process_mcmc: cpp_wrappers.knowledge_gradient_mcmc.GaussianProcessMCMC
+    :return: point that minimizes the averaged LCB
+    :rtype: array of float64 with shape (dim, )
+
+    """
+    if randomness is None:
+        randomness = C_GP.RandomnessSourceContainer(max_num_threads)
+        randomness.SetRandomizedUniformGeneratorSeed(0)
+
+    # status must be an initialized dict for the call to C++.
+    if status is None:
+        status = {}
+
+    best_point_to_sample = C_GP.multistart_lower_confidence_bound_mcmc_optimization(
+        _lcb_cpp_optimizer_parameters(domain, optimizer_parameters),
+        gaussian_process_mcmc._gaussian_process_mcmc,
+        cpp_utils.cppify(domain.domain_bounds),
+        exploration_weight,
+        num_refined_starts,
+        max_num_threads,
+        randomness,
+        status,
+    )
+    return numpy.array(best_point_to_sample)
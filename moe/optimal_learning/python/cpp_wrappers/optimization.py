@@ -47,7 +47,8 @@ First, the functions in this file are all MAXIMIZERS.  We also use the term "opt
 state otherwise, "optima" and "optimization" refer to "maxima" and "maximization," respectively.  (Note that
 minimizing ``g(x)`` is equivalent to maximizing ``f(x) = -1 * g(x)``.)
 
-This file contains templates for some common optimization techniques: gradient descent (GD) and Newton's method.
+This file contains templates for some common optimization techniques: gradient descent (GD), Newton's method, L-BFGS-B,
+and GD with an adaptive, Armijo-backtracked step size (line search gradient descent).
 We provide constrained implementations (constraint via heuristics like restricting updates to 50% of the distance
 to the nearest wall) of these optimizers.  For unconstrained, just set the domain to be huge: ``[-DBL_MAX, DBL_MAX]``.
 
@@ -246,6 +247,68 @@ class NewtonParameters(C_GP.NewtonParameters, EqualityComparisonMixin):
         super(NewtonParameters, self).__init__(*args, **kwargs)
 
 
+class LBFGSBParameters(C_GP.LBFGSBParameters, EqualityComparisonMixin):
+
+    """Container to hold parameters that specify the behavior of L-BFGS-B in a C++-readable form.
+
+    See :func:`~moe.optimal_learning.python.cpp_wrappers.optimization.LBFGSBParameters.__init__` docstring for more information.
+
+    """
+
+    __slots__ = ()
+
+    def __init__(self, *args, **kwargs):
+        r"""Build a LBFGSBParameters (C++ object) via its ctor; this object specifies multistarted L-BFGS-B behavior and is required by C++ L-BFGS-B optimization.
+
+        .. Note:: See gpp_optimizer_parameters.hpp for more details.
+
+        :param num_multistarts: number of initial guesses to try in multistarted L-BFGS-B (suggest: a few hundred)
+        :type num_multistarts: int > 0
+        :param max_num_steps: maximum number of L-BFGS-B iterations (per initial guess) (suggest: 100-200)
+        :type max_num_steps: int > 0
+        :param history_size: number of correction pairs stored to approximate the inverse Hessian (suggest: 5-20)
+        :type history_size: int > 0
+        :param max_num_line_search_steps: maximum number of backtracking steps per line search (suggest: 20-40)
+        :type max_num_line_search_steps: int > 0
+        :param tolerance: when the infinity-norm of the projected gradient falls below this value, stop (suggest: 1.0e-10)
+        :type tolerance: float64 >= 0.0
+
+        """
+        super(LBFGSBParameters, self).__init__(*args, **kwargs)
+
+
+class LineSearchGradientDescentParameters(C_GP.LineSearchGradientDescentParameters, EqualityComparisonMixin):
+
+    """Container to hold parameters that specify the behavior of line search gradient descent in a C++-readable form.
+
+    See :func:`~moe.optimal_learning.python.cpp_wrappers.optimization.LineSearchGradientDescentParameters.__init__` docstring for more information.
+
+    """
+
+    __slots__ = ()
+
+    def __init__(self, *args, **kwargs):
+        r"""Build a LineSearchGradientDescentParameters (C++ object) via its ctor; this object specifies multistarted line search gradient descent behavior and is required by C++ line search gradient descent optimization.
+
+        .. Note:: See gpp_optimizer_parameters.hpp for more details.
+
+        :param num_multistarts: number of initial guesses to try in multistarted line search gradient descent (suggest: a few hundred)
+        :type num_multistarts: int > 0
+        :param max_num_steps: maximum number of gradient descent iterations (per initial guess) (suggest: 100-500)
+        :type max_num_steps: int > 0
+        :param max_num_line_search_steps: maximum number of backtracking (step halving) trials per line search (suggest: 20-40)
+        :type max_num_line_search_steps: int > 0
+        :param initial_step_size: step size (multiplier on the gradient) tried on the first iteration (suggest: 0.1-1.0)
+        :type initial_step_size: float64 > 0.0
+        :param max_relative_change: max change allowed per update (as a relative fraction of current distance to wall) (suggest: 0.5-1.0)
+        :type max_relative_change: float64 in [0, 1]
+        :param tolerance: when the magnitude of the gradient OR of the accepted step falls below this value, stop (suggest: 1.0e-10)
+        :type tolerance: float64 >= 0.0
+
+        """
+        super(LineSearchGradientDescentParameters, self).__init__(*args, **kwargs)
+
+
 class GradientDescentParameters(C_GP.GradientDescentParameters, EqualityComparisonMixin):
 
     """Container to hold parameters that specify the behavior of Gradient Descent in a C++-readable form.
@@ -474,3 +537,77 @@ class NewtonOptimizer(OptimizerInterface):
     def optimize(self, **kwargs):
         """C++ does not expose this endpoint."""
         raise NotImplementedError("C++ wrapper currently does not support optimization member functions.")
+
+
+class LBFGSBOptimizer(OptimizerInterface):
+
+    """Simple container for telling C++ to use L-BFGS-B for optimization.
+
+    See the comments in gpp_optimization.hpp (LBFGSBOptimization) for full details on L-BFGS-B.
+
+    """
+
+    def __init__(self, domain, optimizable, optimizer_parameters, num_random_samples=None):
+        """Construct a LBFGSBOptimizer.
+
+        :param domain: the domain that this optimizer operates over
+        :type domain: interfaces.domain_interface.DomainInterface subclass from cpp_wrappers
+        :param optimizable: object representing the objective function being optimized
+        :type optimizable: interfaces.optimization_interface.OptimizableInterface subclass from cpp_wrappers
+        :param optimizer_parameters: parameters describing how to perform optimization (tolerances, iterations, etc.)
+        :type optimizer_parameters: cpp_wrappers.optimization.LBFGSBParameters object
+        :params num_random_samples: number of random samples to use if performing 'dumb' search
+        :type num_random_sampes: int >= 0
+
+        """
+        self.domain = domain
+        self.objective_function = optimizable
+        self.optimizer_type = C_GP.OptimizerTypes.l_bfgs_b
+        self.optimizer_parameters = _CppOptimizerParameters(
+            domain_type=domain._domain_type,
+            objective_type=optimizable.objective_type,
+            optimizer_type=self.optimizer_type,
+            num_random_samples=num_random_samples,
+            optimizer_parameters=optimizer_parameters,
+        )
+
+    def optimize(self, **kwargs):
+        """C++ does not expose this endpoint."""
+        raise NotImplementedError("C++ wrapper currently does not support optimization member functions.")
+
+
+class LineSearchGradientDescentOptimizer(OptimizerInterface):
+
+    """Simple container for telling C++ to use line search gradient descent for optimization.
+
+    See the comments in gpp_optimization.hpp (LineSearchGradientDescentOptimization) for full details.
+
+    """
+
+    def __init__(self, domain, optimizable, optimizer_parameters, num_random_samples=None):
+        """Construct a LineSearchGradientDescentOptimizer.
+
+        :param domain: the domain that this optimizer operates over
+        :type domain: interfaces.domain_interface.DomainInterface subclass from cpp_wrappers
+        :param optimizable: object representing the objective function being optimized
+        :type optimizable: interfaces.optimization_interface.OptimizableInterface subclass from cpp_wrappers
+        :param optimizer_parameters: parameters describing how to perform optimization (tolerances, iterations, etc.)
+        :type optimizer_parameters: cpp_wrappers.optimization.LineSearchGradientDescentParameters object
+        :params num_random_samples: number of random samples to use if performing 'dumb' search
+        :type num_random_sampes: int >= 0
+
+        """
+        self.domain = domain
+        self.objective_function = optimizable
+        self.optimizer_type = C_GP.OptimizerTypes.line_search_gradient_descent
+        self.optimizer_parameters = _CppOptimizerParameters(
+            domain_type=domain._domain_type,
+            objective_type=optimizable.objective_type,
+            optimizer_type=self.optimizer_type,
+            num_random_samples=num_random_samples,
+            optimizer_parameters=optimizer_parameters,
+        )
+
+    def optimize(self, **kwargs):
+        """C++ does not expose this endpoint."""
+        raise NotImplementedError("C++ wrapper currently does not support optimization member functions.")